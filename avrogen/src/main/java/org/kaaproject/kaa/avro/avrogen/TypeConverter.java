@@ -197,6 +197,58 @@ public class TypeConverter {
     return false;
   }
 
+  /**
+   * Get the size of the Avro encoding that is the same for any value of the schema.
+   *
+   * @param   schema the schema
+   * @return  the encoded size in bytes, 0 if it depends on the value
+   */
+  public static int getFixedEncodedSize(Schema schema) {
+    switch (schema.getType()) {
+      case BOOLEAN:
+        return 1;
+      case FLOAT:
+        return 4;
+      case DOUBLE:
+        return 8;
+      default:
+        return 0;
+    }
+  }
+
+  /**
+   * Check if all the record fields have a fixed encoded size, so the record is serialized
+   * with no calls per field.
+   *
+   * @param   schema the input schema
+   * @return  boolean 'true' if the record has a fixed encoded size
+   */
+  public static boolean isFixedSizeRecord(Schema schema) {
+    if (schema.getType() != Type.RECORD || schema.getFields().isEmpty()) {
+      return false;
+    }
+    for (Field f : schema.getFields()) {
+      if (getFixedEncodedSize(f.schema()) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Get the encoded size of a record with fixed-size fields.
+   *
+   * @param   schema the record schema, see {@link #isFixedSizeRecord(Schema)}
+   * @return  the encoded size in bytes
+   */
+  public static int getFixedRecordSize(Schema schema) {
+    int size = 0;
+    for (Field f : schema.getFields()) {
+      size += getFixedEncodedSize(f.schema());
+    }
+    return size;
+  }
+
   /**
    * Check is schema an Avro primitive.
    *
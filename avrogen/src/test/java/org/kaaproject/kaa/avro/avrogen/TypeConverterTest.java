@@ -94,4 +94,26 @@ public class TypeConverterTest {
   public void testIsRecordNeedDeallocator() {
     Assert.assertFalse(TypeConverter.isRecordNeedDeallocator(Schema.create(Type.INT)));
   }
+
+  @Test
+  public void testFixedSizeRecord() {
+    Schema fixedSchema = Schema.createRecord("test1", "doc", "namespace", false);
+    fixedSchema.setFields(Arrays.asList(
+        new Schema.Field("flag", Schema.create(Type.BOOLEAN), "doc", null),
+        new Schema.Field("temperature", Schema.create(Type.FLOAT), "doc", null),
+        new Schema.Field("value", Schema.create(Type.DOUBLE), "doc", null)));
+
+    Assert.assertTrue(TypeConverter.isFixedSizeRecord(fixedSchema));
+    Assert.assertEquals(13, TypeConverter.getFixedRecordSize(fixedSchema));
+
+    // Integers are varint encoded
+    Schema varSchema = Schema.createRecord("test2", "doc", "namespace", false);
+    varSchema.setFields(Arrays.asList(
+        new Schema.Field("value", Schema.create(Type.DOUBLE), "doc", null),
+        new Schema.Field("count", Schema.create(Type.INT), "doc", null)));
+
+    Assert.assertFalse(TypeConverter.isFixedSizeRecord(varSchema));
+    Assert.assertFalse(TypeConverter.isFixedSizeRecord(Schema.createRecord("test3", "doc", "namespace", false)));
+    Assert.assertFalse(TypeConverter.isFixedSizeRecord(Schema.create(Type.DOUBLE)));
+  }
 }
@@ -84,16 +84,76 @@ configure_file("${CMAKE_CURRENT_SOURCE_DIR}/sonar-project.properties.in"
         "${CMAKE_CURRENT_SOURCE_DIR}/sonar-project.properties")
 
 
-if(WITH_EXTENSION_LOGGING)
-    kaa_add_unit_test(NAME test_ext_log_storage_memory
+if(KAA_PLATFORM STREQUAL "posix")
+    kaa_add_unit_test(NAME test_kaa_reactor
         SOURCES
-        test/platform-impl/test_ext_log_storage_memory.c
-        test/kaa_test_external.c
+        test/platform-impl/test_kaa_reactor.c
         DEPENDS
         kaac
         INC_DIRS
         test)
 
+    if(NOT KAA_WITHOUT_TCP_CHANNEL)
+        kaa_add_unit_test(NAME test_tcp_utils
+            SOURCES
+            test/platform-impl/test_tcp_utils.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    endif()
+
+    if(WITH_SHM_CHANNEL)
+        kaa_add_unit_test(NAME test_kaa_shm_channel
+            SOURCES
+            test/platform-impl/test_kaa_shm_channel.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    endif()
+
+    if(WITH_UDP_CHANNEL)
+        kaa_add_unit_test(NAME test_kaa_udp_channel
+            SOURCES
+            test/platform-impl/test_kaa_udp_channel.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    endif()
+endif()
+
+if(WITH_EXTENSION_LOGGING)
+    if(WITH_RING_LOG_STORAGE)
+        kaa_add_unit_test(NAME test_ext_log_storage_ring
+            SOURCES
+            test/platform-impl/test_ext_log_storage_ring.c
+            test/kaa_test_external.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    elseif(WITH_FILE_LOG_STORAGE)
+        kaa_add_unit_test(NAME test_ext_log_storage_file
+            SOURCES
+            test/platform-impl/test_ext_log_storage_file.c
+            test/kaa_test_external.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    else()
+        kaa_add_unit_test(NAME test_ext_log_storage_memory
+            SOURCES
+            test/platform-impl/test_ext_log_storage_memory.c
+            test/kaa_test_external.c
+            DEPENDS
+            kaac
+            INC_DIRS
+            test)
+    endif()
+
     kaa_add_unit_test(NAME test_ext_log_upload_strategy_by_volume
         SOURCES
         test/platform-impl/test_ext_log_upload_strategies.c
@@ -124,6 +184,12 @@ kaa_add_unit_test(NAME test_platform_utils
         DEPENDS
         kaac)
 
+kaa_add_unit_test(NAME test_kaa_bank_storage
+        SOURCES
+        test/platform-impl/test_kaa_bank_storage.c
+        DEPENDS
+        kaac)
+
 kaa_add_unit_test(NAME test_context
         SOURCES
         test/test_kaa_context.c
@@ -151,6 +217,26 @@ kaa_add_unit_test(NAME test_list
         INC_DIRS
         src/kaa ${KAA_INCLUDE_PATHS} test)
 
+kaa_add_unit_test(NAME benchmark_list_sort
+        SOURCES
+        test/collections/benchmark_kaa_list_sort.c
+        src/kaa/collections/kaa_list.c
+        INC_DIRS
+        src/kaa ${KAA_INCLUDE_PATHS} test)
+
+kaa_add_unit_test(NAME test_hash_map
+        SOURCES
+        test/collections/test_kaa_hash_map.c
+        src/kaa/collections/kaa_hash_map.c
+        INC_DIRS
+        src/kaa ${KAA_INCLUDE_PATHS} test)
+
+kaa_add_unit_test(NAME test_intrusive_list
+        SOURCES
+        test/collections/test_kaa_intrusive_list.c
+        INC_DIRS
+        src/kaa ${KAA_INCLUDE_PATHS} test)
+
 kaa_add_unit_test(NAME test_kaatcp_parser
         SOURCES
         test/kaatcp/kaatcp_parser_test.c
@@ -193,6 +279,41 @@ kaa_add_unit_test(NAME test_kaa_reallocation
         INC_DIRS
         test)
 
+kaa_add_unit_test(NAME test_kaa_scratch
+        SOURCES
+        test/utilities/test_kaa_scratch.c
+        DEPENDS
+        kaac
+        INC_DIRS
+        test)
+
+kaa_add_unit_test(NAME test_kaa_base64
+        SOURCES
+        test/utilities/test_kaa_base64.c
+        DEPENDS
+        kaac
+        INC_DIRS
+        test)
+
+kaa_add_unit_test(NAME test_kaa_mem_pool
+        SOURCES
+        test/utilities/test_kaa_mem_pool.c
+        src/kaa/utilities/kaa_mem_pool.c
+        DEPENDS
+        kaac
+        INC_DIRS
+        test)
+
+if(WITH_MEMORY_TRACING)
+    kaa_add_unit_test(NAME test_kaa_mem_trace
+        SOURCES
+        test/utilities/test_kaa_mem_trace.c
+        DEPENDS
+        kaac
+        INC_DIRS
+        test)
+endif()
+
 kaa_add_unit_test(NAME test_kaa_extension
         SOURCES
         test/test_kaa_extension.c src/kaa/kaa_extension.c
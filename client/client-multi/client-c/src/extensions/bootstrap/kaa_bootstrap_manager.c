@@ -254,6 +254,103 @@ static kaa_error_t add_operations_access_point(kaa_bootstrap_manager_t *self
     return KAA_ERR_NONE;
 }
 
+static kaa_status_t *get_status(kaa_bootstrap_manager_t *self)
+{
+    return self->kaa_context->status ? self->kaa_context->status->status_instance : NULL;
+}
+
+static kaa_error_t read_operations_access_points(kaa_bootstrap_manager_t *self
+                                               , kaa_platform_message_reader_t *reader
+                                               , uint16_t access_point_count)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+    kaa_transport_protocol_id_t protocol_id;
+
+    while (access_point_count--) {
+        kaa_access_point_t *new_access_point = (kaa_access_point_t *)KAA_MALLOC(sizeof(kaa_access_point_t));
+        KAA_RETURN_IF_NIL(new_access_point, KAA_ERR_NOMEM);
+
+        error_code = kaa_platform_message_read(reader, &new_access_point->id, sizeof(uint32_t));
+        KAA_RETURN_IF_ERR(error_code);
+        new_access_point->id = KAA_NTOHL(new_access_point->id);
+
+        error_code = kaa_platform_message_read(reader, &protocol_id.id, sizeof(uint32_t));
+        KAA_RETURN_IF_ERR(error_code);
+        protocol_id.id = KAA_NTOHL(protocol_id.id);
+
+        error_code = kaa_platform_message_read(reader, &protocol_id.version, sizeof(uint16_t));
+        KAA_RETURN_IF_ERR(error_code);
+        protocol_id.version = KAA_NTOHS(protocol_id.version);
+
+        error_code = kaa_platform_message_read(reader, &new_access_point->connection_data_len, sizeof(uint16_t));
+        KAA_RETURN_IF_ERR(error_code);
+        new_access_point->connection_data_len = KAA_NTOHS(new_access_point->connection_data_len);
+
+        new_access_point->connection_data = (char *)KAA_MALLOC(new_access_point->connection_data_len);
+
+        if (!new_access_point->connection_data || !new_access_point->connection_data_len) {
+            KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to allocate buffer for connection data, size %u"
+                                                                        , new_access_point->connection_data_len);
+            destroy_access_point(new_access_point);
+            return KAA_ERR_NOMEM;
+        }
+
+        error_code = kaa_platform_message_read_aligned(reader
+                                                     , new_access_point->connection_data
+                                                     , new_access_point->connection_data_len);
+        if (error_code) {
+            destroy_access_point(new_access_point);
+            KAA_LOG_ERROR(self->logger, error_code, "Failed to read connection data");
+            return error_code;
+        }
+
+        error_code = add_operations_access_point(self, &protocol_id, new_access_point);
+        if (error_code) {
+            destroy_access_point(new_access_point);
+            KAA_LOG_WARN(self->logger, error_code, "Failed to add new access point "
+                    "to channel (protocol: id=0x%08X, version=%u)", protocol_id.id, protocol_id.version);
+            error_code = KAA_ERR_NONE;
+            continue;
+        }
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Added access point: access point id '%u', protocol id '0x%08X', protocol version '%u', connection data length '%u'"
+                    , new_access_point->id, protocol_id.id, protocol_id.version, new_access_point->connection_data_len);
+    }
+
+    return error_code;
+}
+
+/*
+ * Restores the operations access points received by the last bootstrap sync
+ * unless they are expired, so the client doesn't have to ask the bootstrap servers again.
+ */
+static void restore_operations_access_points(kaa_bootstrap_manager_t *self)
+{
+    kaa_status_t *status = get_status(self);
+    if (!status || !status->operations_access_points) {
+        return;
+    }
+
+    if (KAA_BOOTSTRAP_ACCESS_POINTS_TTL > 0 && status->operations_access_points_expiry > (uint64_t)KAA_TIME()) {
+        kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(status->operations_access_points
+                                                                , status->operations_access_points_size);
+        uint16_t access_point_count = 0;
+        kaa_error_t error_code = kaa_platform_message_read(&reader, &access_point_count, sizeof(uint16_t));
+        if (!error_code) {
+            access_point_count = KAA_NTOHS(access_point_count);
+            error_code = read_operations_access_points(self, &reader, access_point_count);
+        }
+        if (!error_code) {
+            KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Restored %u stored operations access points", access_point_count);
+            return;
+        }
+
+        KAA_LOG_WARN(self->logger, error_code, "Failed to restore stored operations access points");
+        kaa_list_clear(self->operations_access_points, destroy_operations_access_points);
+    }
+
+    kaa_status_set_operations_access_points(status, NULL, 0, 0);
+}
+
 /** @deprecated Use kaa_extension_manager_init(). */
 kaa_error_t kaa_bootstrap_manager_create(kaa_bootstrap_manager_t **bootstrap_manager_p, kaa_context_t *kaa_context)
 {
@@ -272,9 +369,17 @@ kaa_error_t kaa_bootstrap_manager_create(kaa_bootstrap_manager_t **bootstrap_man
     (*bootstrap_manager_p)->operations_access_points = kaa_list_create();
     KAA_RETURN_IF_NIL((*bootstrap_manager_p)->operations_access_points, KAA_ERR_NOMEM);
 
+    restore_operations_access_points(*bootstrap_manager_p);
+
     return KAA_ERR_NONE;
 }
 
+bool kaa_bootstrap_manager_has_operations_access_points(kaa_bootstrap_manager_t *self)
+{
+    KAA_RETURN_IF_NIL(self, false);
+    return kaa_list_get_size(self->operations_access_points) > 0;
+}
+
 /** @deprecated Use kaa_extension_manager_deinit(). */
 void kaa_bootstrap_manager_destroy(kaa_bootstrap_manager_t *self)
 {
@@ -435,6 +540,8 @@ kaa_error_t kaa_bootstrap_manager_handle_server_sync(kaa_bootstrap_manager_t *se
     KAA_RETURN_IF_ERR(error_code);
     request_id = KAA_NTOHS(request_id);
 
+    // The access point count and the access points are stored as they are received
+    const uint8_t *access_points = reader->current;
     uint16_t access_point_count;
     error_code = kaa_platform_message_read(reader, &access_point_count, sizeof(uint16_t));
     KAA_RETURN_IF_ERR(error_code);
@@ -444,6 +551,10 @@ kaa_error_t kaa_bootstrap_manager_handle_server_sync(kaa_bootstrap_manager_t *se
                                                         , access_point_count, request_id);
 
     if (!access_point_count) {
+        if (get_status(self)) {
+            kaa_status_set_operations_access_points(get_status(self), NULL, 0, 0);
+        }
+
         kaa_transport_channel_interface_t *channel = kaa_channel_manager_get_transport_channel(self->channel_manager, KAA_EXTENSION_BOOTSTRAP);
         kaa_transport_protocol_id_t protocol_id  = {0, 0};
         error_code = channel->get_protocol_id(channel->context, &protocol_id);
@@ -472,54 +583,17 @@ kaa_error_t kaa_bootstrap_manager_handle_server_sync(kaa_bootstrap_manager_t *se
         return KAA_ERR_EVENT_NOT_ATTACHED;
     }
 
-    kaa_transport_protocol_id_t protocol_id;
-
-    while (access_point_count--) {
-        kaa_access_point_t *new_access_point = (kaa_access_point_t *)KAA_MALLOC(sizeof(kaa_access_point_t));
-        KAA_RETURN_IF_NIL(new_access_point, KAA_ERR_NOMEM);
-
-        error_code = kaa_platform_message_read(reader, &new_access_point->id, sizeof(uint32_t));
-        KAA_RETURN_IF_ERR(error_code);
-        new_access_point->id = KAA_NTOHL(new_access_point->id);
-
-        error_code = kaa_platform_message_read(reader, &protocol_id.id, sizeof(uint32_t));
-        KAA_RETURN_IF_ERR(error_code);
-        protocol_id.id = KAA_NTOHL(protocol_id.id);
-
-        error_code = kaa_platform_message_read(reader, &protocol_id.version, sizeof(uint16_t));
-        KAA_RETURN_IF_ERR(error_code);
-        protocol_id.version = KAA_NTOHS(protocol_id.version);
-
-        error_code = kaa_platform_message_read(reader, &new_access_point->connection_data_len, sizeof(uint16_t));
-        KAA_RETURN_IF_ERR(error_code);
-        new_access_point->connection_data_len = KAA_NTOHS(new_access_point->connection_data_len);
-
-        new_access_point->connection_data = (char *)KAA_MALLOC(new_access_point->connection_data_len);
-
-        if (!new_access_point->connection_data || !new_access_point->connection_data_len) {
-            KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to allocate buffer for connection data, size %u"
-                                                                        , new_access_point->connection_data_len);
-            destroy_access_point(new_access_point);
-            return KAA_ERR_NOMEM;
-        }
+    error_code = read_operations_access_points(self, reader, access_point_count);
+    KAA_RETURN_IF_ERR(error_code);
 
-        error_code = kaa_platform_message_read_aligned(reader
-                                                     , new_access_point->connection_data
-                                                     , new_access_point->connection_data_len);
+    if (KAA_BOOTSTRAP_ACCESS_POINTS_TTL > 0 && get_status(self)) {
+        error_code = kaa_status_set_operations_access_points(get_status(self), access_points
+                                                           , reader->current - access_points
+                                                           , (uint64_t)KAA_TIME() + KAA_BOOTSTRAP_ACCESS_POINTS_TTL);
         if (error_code) {
-            destroy_access_point(new_access_point);
-            KAA_LOG_ERROR(self->logger, error_code, "Failed to read connection data");
-            return error_code;
+            KAA_LOG_WARN(self->logger, error_code, "Failed to store operations access points");
+            error_code = KAA_ERR_NONE;
         }
-
-        error_code = add_operations_access_point(self, &protocol_id, new_access_point);
-        if (error_code) {
-            destroy_access_point(new_access_point);
-            KAA_LOG_WARN(self->logger, error_code, "Failed to add new access point "
-                    "to channel (protocol: id=0x%08X, version=%u)", protocol_id.id, protocol_id.version);
-        }
-        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Added access point: access point id '%u', protocol id '0x%08X', protocol version '%u', connection data length '%u'"
-                    , new_access_point->id, protocol_id.id, protocol_id.version, new_access_point->connection_data_len);
     }
 
     kaa_bootstrap_manager_on_server_sync(self);
@@ -583,8 +657,13 @@ kaa_error_t kaa_bootstrap_manager_on_access_point_failed(kaa_bootstrap_manager_t
 
         access_point = (kaa_access_point_t *)kaa_list_get_data(operations_access_points->current_access_points);
 
-        if (!access_point)
+        if (!access_point) {
             execute_failover = true;
+            // None of the stored access points is good anymore, ask the bootstrap servers on the next start
+            if (get_status(self)) {
+                kaa_status_set_operations_access_points(get_status(self), NULL, 0, 0);
+            }
+        }
     }
 
     if (execute_failover) {
@@ -674,6 +753,22 @@ bool kaa_bootstrap_manager_process_failover(kaa_bootstrap_manager_t *self)
     return true;
 }
 
+size_t kaa_bootstrap_manager_get_failover_timeout(kaa_bootstrap_manager_t *self)
+{
+    KAA_RETURN_IF_NIL(self, SIZE_MAX);
+
+    if (!self->failover_meta_info.is_failover) {
+        return SIZE_MAX;
+    }
+
+    kaa_time_t current_time = KAA_TIME();
+    if (current_time >= self->failover_meta_info.next_execution_time) {
+        return 0;
+    }
+
+    return self->failover_meta_info.next_execution_time - current_time;
+}
+
 kaa_error_t kaa_bootstrap_manager_bootstrap_request_serialize(kaa_bootstrap_manager_t *self, kaa_platform_message_writer_t* writer)
 {
     KAA_RETURN_IF_NIL2(self, writer, KAA_ERR_BADPARAM);
@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 #include "platform/stdio.h"
 #include "platform/sock.h"
@@ -37,6 +38,7 @@
 #include "kaa_channel_manager.h"
 #include "utilities/kaa_mem.h"
 #include "utilities/kaa_log.h"
+#include "utilities/kaa_scratch.h"
 #include "avro_src/avro/io.h"
 
 #define KAA_CONFIGURATION_RECEIVE_UPDATES_FLAG   0x01
@@ -47,12 +49,28 @@
 
 #define KAA_CONFIGURATION_BODY_PRESENT           0x02
 
+#ifdef KAA_AVRO_ARENA_READER
+/* First chunk of the arena the root record is decoded into, grown to fit on demand. */
+#ifndef KAA_CONFIGURATION_ARENA_SIZE
+#define KAA_CONFIGURATION_ARENA_SIZE             256
+#endif
+#endif
+
 static kaa_extension_id configuration_sync_services[1] = { KAA_EXTENSION_CONFIGURATION };
 
 struct kaa_configuration_manager_t {
     kaa_digest                           configuration_hash;
     kaa_configuration_root_receiver_t    root_receiver;
     kaa_root_configuration_t            *root_record;
+#ifdef KAA_AVRO_BORROWED_READER
+    char                                *root_record_buffer;    /**< The root record points into it */
+#endif
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_t                       *root_record_arena;     /**< The root record is allocated from it */
+#endif
+    char                                *stored_buffer;         /**< Configuration not decoded yet */
+    size_t                               stored_buffer_size;
+    bool                                 stored_buffer_owned;
     kaa_channel_manager_t               *channel_manager;
     kaa_status_t                        *status;
     kaa_logger_t                        *logger;
@@ -129,17 +147,106 @@ kaa_error_t kaa_extension_configuration_server_sync(void *context, uint32_t requ
     return kaa_configuration_manager_handle_server_sync(context, &reader, extension_options, size);
 }
 
-static kaa_root_configuration_t *kaa_configuration_manager_deserialize(const char *buffer, size_t buffer_size)
+static kaa_root_configuration_t *kaa_configuration_manager_decode(kaa_configuration_manager_t *self, avro_reader_t reader)
+{
+#ifdef KAA_AVRO_ARENA_READER
+    // The whole record tree goes to one arena, released at once with the next configuration
+    if (!self->root_record_arena
+            && kaa_scratch_create(&self->root_record_arena, KAA_CONFIGURATION_ARENA_SIZE)) {
+        return NULL;
+    }
+    return KAA_CONFIGURATION_DESERIALIZE_INTO_ARENA(reader, self->root_record_arena);
+#else
+    (void)self;
+    return KAA_CONFIGURATION_DESERIALIZE(reader);
+#endif
+}
+
+static kaa_root_configuration_t *kaa_configuration_manager_deserialize(kaa_configuration_manager_t *self,
+        const char *buffer, size_t buffer_size)
 {
     KAA_RETURN_IF_NIL2(buffer, buffer_size, NULL);
 
     avro_reader_t reader = avro_reader_memory(buffer, buffer_size);
     KAA_RETURN_IF_NIL(reader, NULL);
-    kaa_root_configuration_t *result = KAA_CONFIGURATION_DESERIALIZE(reader);
+    kaa_root_configuration_t *result = kaa_configuration_manager_decode(self, reader);
     avro_reader_free(reader);
     return result;
 }
 
+#ifdef KAA_AVRO_BORROWED_READER
+/*
+ * The root record borrows its strings and bytes from @p buffer, which the
+ * manager takes over on success. The buffer is modified while decoding.
+ */
+static kaa_error_t kaa_configuration_manager_deserialize_borrowed(kaa_configuration_manager_t *self,
+        char *buffer, size_t buffer_size)
+{
+    avro_reader_t reader = avro_reader_memory_borrowed(buffer, buffer_size);
+    KAA_RETURN_IF_NIL(reader, KAA_ERR_NOMEM);
+    self->root_record = kaa_configuration_manager_decode(self, reader);
+    avro_reader_free(reader);
+    KAA_RETURN_IF_NIL(self->root_record, KAA_ERR_READ_FAILED);
+
+    self->root_record_buffer = buffer;
+    return KAA_ERR_NONE;
+}
+#endif
+
+static void kaa_configuration_manager_release(kaa_configuration_manager_t *self)
+{
+    if (self->stored_buffer_owned) {
+        KAA_FREE(self->stored_buffer);
+    }
+    self->stored_buffer = NULL;
+    self->stored_buffer_owned = false;
+
+    if (self->root_record) {
+        self->root_record->destroy(self->root_record);
+        self->root_record = NULL;
+    }
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_reset(self->root_record_arena);
+#endif
+#ifdef KAA_AVRO_BORROWED_READER
+    KAA_FREE(self->root_record_buffer);
+    self->root_record_buffer = NULL;
+#endif
+}
+
+
+/*
+ * The configuration read on startup is decoded once it is asked for: until
+ * then only its hash is needed, for the sync requests.
+ */
+static void kaa_configuration_manager_decode_stored(kaa_configuration_manager_t *self)
+{
+    char *buffer = self->stored_buffer;
+    size_t buffer_size = self->stored_buffer_size;
+    bool owned = self->stored_buffer_owned;
+    self->stored_buffer = NULL;
+    self->stored_buffer_owned = false;
+
+#ifdef KAA_AVRO_BORROWED_READER
+    // The stored configuration is kept as read rather than copied field by field
+    if (owned) {
+        if (!kaa_configuration_manager_deserialize_borrowed(self, buffer, buffer_size))
+            return;
+    } else
+#endif
+    self->root_record = kaa_configuration_manager_deserialize(self, buffer, buffer_size);
+
+    if (owned)
+        KAA_FREE(buffer);
+
+    if (!self->root_record) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to deserialize stored configuration, size %zu", buffer_size);
+        // Let the server send it again
+        memset(self->configuration_hash, 0, SHA_1_DIGEST_LENGTH);
+        self->status->has_configuration_hash = false;
+        self->status->dirty_fields |= KAA_STATUS_CONFIGURATION_HASH;
+    }
+}
 
 /** @deprecated Use kaa_extension_configuration_init(). */
 kaa_error_t kaa_configuration_manager_create(kaa_configuration_manager_t **configuration_manager_p, kaa_channel_manager_t *channel_manager, kaa_status_t *status, kaa_logger_t *logger)
@@ -152,6 +259,16 @@ kaa_error_t kaa_configuration_manager_create(kaa_configuration_manager_t **confi
     manager->status = status;
     manager->logger = logger;
     manager->root_receiver = (kaa_configuration_root_receiver_t) { NULL, NULL };
+    manager->root_record = NULL;
+#ifdef KAA_AVRO_BORROWED_READER
+    manager->root_record_buffer = NULL;
+#endif
+#ifdef KAA_AVRO_ARENA_READER
+    manager->root_record_arena = NULL;
+#endif
+    manager->stored_buffer = NULL;
+    manager->stored_buffer_size = 0;
+    manager->stored_buffer_owned = false;
 
     char *buffer = NULL;
     size_t buffer_size = 0;
@@ -160,7 +277,8 @@ kaa_error_t kaa_configuration_manager_create(kaa_configuration_manager_t **confi
         ext_configuration_read(&buffer, &buffer_size, &need_deallocation);
     else
         ext_configuration_delete();
-    if (!buffer || !buffer_size) {
+    bool is_stored = buffer && buffer_size;
+    if (!is_stored) {
         need_deallocation = false;
 #if KAA_CONFIGURATION_DATA_LENGTH > 0
         buffer = (char *)KAA_CONFIGURATION_DATA;
@@ -169,18 +287,20 @@ kaa_error_t kaa_configuration_manager_create(kaa_configuration_manager_t **confi
     }
 
     if (buffer && buffer_size > 0) {
-        ext_calculate_sha_hash(buffer, buffer_size, manager->configuration_hash);
-        manager->root_record = kaa_configuration_manager_deserialize(buffer, buffer_size);
-
-        if (!manager->root_record) {
-            KAA_FREE(manager);
-            if (need_deallocation && buffer)
-                KAA_FREE(buffer);
-            return KAA_ERR_NOMEM;
+        if (is_stored && status->has_configuration_hash) {
+            memcpy(manager->configuration_hash, status->configuration_hash, SHA_1_DIGEST_LENGTH);
+        } else {
+            ext_calculate_sha_hash(buffer, buffer_size, manager->configuration_hash);
+            if (is_stored) {
+                memcpy(status->configuration_hash, manager->configuration_hash, SHA_1_DIGEST_LENGTH);
+                status->has_configuration_hash = true;
+                status->dirty_fields |= KAA_STATUS_CONFIGURATION_HASH;
+            }
         }
 
-        if (need_deallocation)
-            KAA_FREE(buffer);
+        manager->stored_buffer = buffer;
+        manager->stored_buffer_size = buffer_size;
+        manager->stored_buffer_owned = need_deallocation;
     }
 
     *configuration_manager_p = manager;
@@ -193,8 +313,10 @@ kaa_error_t kaa_configuration_manager_create(kaa_configuration_manager_t **confi
 void kaa_configuration_manager_destroy(kaa_configuration_manager_t *self)
 {
     if (self) {
-        if (self->root_record)
-            self->root_record->destroy(self->root_record);
+        kaa_configuration_manager_release(self);
+#ifdef KAA_AVRO_ARENA_READER
+        kaa_scratch_destroy(self->root_record_arena);
+#endif
         KAA_FREE(self);
     }
 }
@@ -260,21 +382,39 @@ kaa_error_t kaa_configuration_manager_handle_server_sync(kaa_configuration_manag
                  return error;
             }
 
-            if (self->root_record)
-                self->root_record->destroy(self->root_record);
+            kaa_error_t err = ext_calculate_sha_hash((const char *)body, body_size, self->configuration_hash);
+            if (err) {
+                KAA_LOG_WARN(self->logger, err, "Failed to calculate configuration body hash");
+                return err;
+            }
+
+            // The old configuration is gone before the new one is decoded
+            kaa_configuration_manager_release(self);
 
-            self->root_record = kaa_configuration_manager_deserialize((const char *)body, body_size);
+#ifdef KAA_AVRO_BORROWED_READER
+            // One copy of the body instead of a heap block per string and bytes field
+            char *buffer = (char *)KAA_MALLOC(body_size);
+            if (!buffer) {
+                KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to allocate configuration body, size %u", body_size);
+                return KAA_ERR_NOMEM;
+            }
+            memcpy(buffer, body, body_size);
+            err = kaa_configuration_manager_deserialize_borrowed(self, buffer, body_size);
+            if (err) {
+                KAA_FREE(buffer);
+            }
+#else
+            self->root_record = kaa_configuration_manager_deserialize(self, (const char *)body, body_size);
+#endif
             if (!self->root_record) {
                 KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to deserialize configuration body, size %u", body_size);
                 return KAA_ERR_READ_FAILED;
             }
 
-            kaa_error_t err = ext_calculate_sha_hash((const char *)body, body_size, self->configuration_hash);
-            if (err) {
-                KAA_LOG_WARN(self->logger, err, "Failed to calculate configuration body hash");
-                return err;
-            }
             ext_configuration_store((const char *)body, body_size);
+            memcpy(self->status->configuration_hash, self->configuration_hash, SHA_1_DIGEST_LENGTH);
+            self->status->has_configuration_hash = true;
+            self->status->dirty_fields |= KAA_STATUS_CONFIGURATION_HASH;
 
             if (self->root_receiver.on_configuration_updated)
                 self->root_receiver.on_configuration_updated(self->root_receiver.context, self->root_record);
@@ -292,7 +432,13 @@ kaa_error_t kaa_configuration_manager_handle_server_sync(kaa_configuration_manag
 
 const kaa_root_configuration_t *kaa_configuration_manager_get_configuration(kaa_configuration_manager_t *self)
 {
-    return self ? self->root_record : NULL;
+    KAA_RETURN_IF_NIL(self, NULL);
+
+    if (self->stored_buffer) {
+        kaa_configuration_manager_decode_stored(self);
+    }
+
+    return self->root_record;
 }
 
 
@@ -30,6 +30,8 @@ typedef struct kaa_configuration_manager_t kaa_configuration_manager_t;
 /**
  * @brief Retrieves the current configuration data.
  *
+ * The configuration restored on startup is decoded on the first call.
+ *
  * @param[in] self      The valid pointer to @link kaa_configuration_manager_t @endlink instance.
  *
  * @return  The current configuration data (NOTE: don't modify this instance), or NULL if something went wrong.
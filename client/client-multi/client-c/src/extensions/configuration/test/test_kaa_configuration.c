@@ -114,9 +114,54 @@ void test_response(void **state)
     ASSERT_EQUAL(uuid->size, CONFIG_UUID_SIZE);
     ASSERT_EQUAL(memcmp(uuid->buffer, CONFIG_UUID, uuid->size), 0);
 
+    /* Persisted along with the status, so it isn't computed on the next start */
+    kaa_digest check_hash;
+    ext_calculate_sha_hash(KAA_CONFIGURATION_DATA, KAA_CONFIGURATION_DATA_LENGTH, check_hash);
+    ASSERT_TRUE(status->has_configuration_hash);
+    ASSERT_EQUAL(memcmp(status->configuration_hash, check_hash, SHA_1_DIGEST_LENGTH), 0);
+
     kaa_platform_message_reader_destroy(reader);
 }
 
+void test_configuration_decoded_on_first_use(void **state)
+{
+    (void)state;
+
+    kaa_configuration_manager_t *manager = NULL;
+    ASSERT_EQUAL(kaa_configuration_manager_create(&manager, NULL, status, logger), KAA_ERR_NONE);
+
+    const kaa_root_configuration_t *root_config = kaa_configuration_manager_get_configuration(manager);
+    ASSERT_NOT_NULL(root_config);
+    ASSERT_EQUAL(strcmp(root_config->data->data, CONFIG_DATA_FIELD), 0);
+    ASSERT_EQUAL(kaa_configuration_manager_get_configuration(manager), root_config);
+
+    kaa_configuration_manager_destroy(manager);
+}
+
+void test_response_outlives_sync_buffer(void **state)
+{
+    (void)state;
+    const size_t response_size = kaa_aligned_size_get(KAA_CONFIGURATION_DATA_LENGTH) + sizeof(uint32_t);
+    uint8_t response[response_size];
+
+    *((uint32_t *) response) = KAA_HTONL(KAA_CONFIGURATION_DATA_LENGTH);
+    memcpy(response + sizeof(uint32_t), KAA_CONFIGURATION_DATA, KAA_CONFIGURATION_DATA_LENGTH);
+
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(response, response_size);
+    ASSERT_EQUAL(kaa_configuration_manager_handle_server_sync(config_manager, &reader, CONFIG_RESPONSE_FLAGS, response_size), KAA_ERR_NONE);
+
+    /* The body is left as received */
+    ASSERT_EQUAL(memcmp(response + sizeof(uint32_t), KAA_CONFIGURATION_DATA, KAA_CONFIGURATION_DATA_LENGTH), 0);
+    memset(response, 0, response_size);
+
+    const kaa_root_configuration_t *root_config = kaa_configuration_manager_get_configuration(config_manager);
+    ASSERT_EQUAL(strcmp(root_config->data->data, CONFIG_DATA_FIELD), 0);
+
+    kaa_bytes_t *uuid = (kaa_bytes_t *) root_config->__uuid->data;
+    ASSERT_EQUAL(uuid->size, CONFIG_UUID_SIZE);
+    ASSERT_EQUAL(memcmp(uuid->buffer, CONFIG_UUID, uuid->size), 0);
+}
+
 int test_init(void)
 {
     kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -147,4 +192,6 @@ int test_deinit(void)
 
 KAA_SUITE_MAIN(Log, test_init, test_deinit,
        KAA_TEST_CASE(create_request, test_create_request)
-       KAA_TEST_CASE(process_response, test_response))
+       KAA_TEST_CASE(process_response, test_response)
+       KAA_TEST_CASE(response_outlives_sync_buffer, test_response_outlives_sync_buffer)
+       KAA_TEST_CASE(configuration_decoded_on_first_use, test_configuration_decoded_on_first_use))
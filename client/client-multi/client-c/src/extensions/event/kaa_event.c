@@ -26,15 +26,19 @@
 #include <sys/types.h>
 #include "platform/stdio.h"
 #include "platform/sock.h"
+#include "platform/time.h"
 #include "platform/ext_sha.h"
+#include "kaa_defaults.h"
 #include "kaa_status.h"
 #include "kaa_channel_manager.h"
 #include "kaa_platform_utils.h"
 #include "kaa_platform_common.h"
 #include "kaa_common_schema.h"
 #include "collections/kaa_list.h"
+#include "collections/kaa_hash_map.h"
 #include "utilities/kaa_mem.h"
 #include "utilities/kaa_log.h"
+#include "avro_src/avro/io.h"
 #include "platform/ext_system_logger.h"
 #include "gen/kaa_event_fqn_definitions.h"
 
@@ -59,12 +63,16 @@ typedef enum {
 typedef struct {
     int32_t          seq_num;
     /**
-     * Use kaa_bytes_t for the fqn parameter (string type) to reduce strlen overhead.
-     * The kaa_bytes_t buffer will be null terminated.
+     * The static string for the events sent by FQN id, otherwise a null-terminated
+     * copy owned by the event.
      */
-    kaa_bytes_t*    event_class_fqn;
-    kaa_bytes_t*    event_data;
+    const char      *event_class_fqn;
+    uint16_t         event_class_fqn_length;
+    bool             event_class_fqn_owned;
+    uint8_t         *event_data;        /**< Either inline_data or a buffer owned by the event */
+    size_t           event_data_size;
     kaa_bytes_t*    target;
+    uint8_t          inline_data[];     /**< Records are serialized right here */
 } kaa_event_t;
 
 typedef struct {
@@ -73,7 +81,8 @@ typedef struct {
 } sent_events_tuple_t;
 
 typedef struct {
-    char *fqn;
+    const char           *fqn;
+    bool                  fqn_owned;    /**< Not a static FQN */
     kaa_event_callback_t  cb;
 } event_callback_pair_t;
 
@@ -96,17 +105,29 @@ typedef struct {
     kaa_event_listeners_callback_t  callback;
 } kaa_event_listeners_request_t;
 
+/* The listeners found for a list of FQNs, the FQNs are taken over from the request */
+typedef struct {
+    kaa_bytes_t                   **fqns;
+    size_t                          fqns_count;
+    kaa_endpoint_id                *listeners;
+    size_t                          listeners_count;
+    kaa_time_t                      expiry;
+    uint32_t                        user_endpoints_epoch;   /**< kaa_status_t::user_endpoints_epoch when found */
+} kaa_event_listeners_cache_entry_t;
+
 /* Public stuff */
 struct kaa_event_manager_t {
     sent_events_tuple_t         events_awaiting_response;
     kaa_list_t                 *pending_events;
-    kaa_list_t                 *event_callbacks;
+    kaa_hash_map_t             *event_callbacks;          /**< event_callback_pair_t by fqn */
     kaa_list_t                 *transactions;
     kaa_list_t                 *event_listeners_requests;
+    kaa_list_t                 *event_listeners_cache;      /**< kaa_event_listeners_cache_entry_t, most recent first */
     kaa_event_block_id          trx_counter;
     kaa_event_callback_t        global_event_callback;
     size_t                      event_sequence_number;
     size_t                      extension_payload_size;
+    bool                        extension_payload_size_valid;   /**< extension_payload_size matches the lists */
     kaa_event_sequence_number_status_t sequence_number_status;
 
     kaa_status_t                *status;
@@ -116,6 +137,14 @@ struct kaa_event_manager_t {
     uint16_t                     event_listeners_request_id;
 
     kaa_endpoint_id_p            event_source;
+
+    size_t                       coalescing_window;         /**< Seconds, 0 if events are synced right away */
+    size_t                       coalescing_max_events;     /**< 0 if not limited */
+    kaa_event_block_id           coalescing_trx;            /**< The block of the coalesced events, 0 if none */
+    size_t                       coalesced_events_count;
+    kaa_time_t                   coalescing_deadline;
+
+    size_t                       listeners_cache_ttl;       /**< Seconds, 0 if found listeners aren't cached */
 };
 
 static kaa_extension_id event_sync_services[1] = { KAA_EXTENSION_EVENT };
@@ -139,8 +168,8 @@ kaa_error_t kaa_extension_event_request_get_size(void *context, size_t *expected
     return kaa_event_request_get_size(context, expected_size);
 }
 
-kaa_error_t kaa_extension_event_request_serialize(void *context, uint32_t request_id,
-        uint8_t *buffer, size_t *size, bool *need_resync)
+static kaa_error_t event_request_serialize(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync)
 {
     // TODO(KAA-982): Use asserts
     if (!context || !size || !need_resync) {
@@ -149,10 +178,18 @@ kaa_error_t kaa_extension_event_request_serialize(void *context, uint32_t reques
 
     *need_resync = true;
 
-    size_t size_needed;
-    kaa_error_t error = kaa_extension_event_request_get_size(context, &size_needed);
-    if (error) {
-        return error;
+    /*
+     * The size is usually computed just before, when the platform protocol sizes
+     * the sync, so the event lists aren't walked again unless they have changed.
+     */
+    kaa_event_manager_t *self = context;
+    size_t size_needed = self->extension_payload_size + KAA_EXTENSION_HEADER_SIZE;
+    kaa_error_t error = KAA_ERR_NONE;
+    if (!buffer || !self->extension_payload_size_valid) {
+        error = kaa_extension_event_request_get_size(context, &size_needed);
+        if (error) {
+            return error;
+        }
     }
 
     if (!buffer || *size < size_needed) {
@@ -163,6 +200,7 @@ kaa_error_t kaa_extension_event_request_serialize(void *context, uint32_t reques
     *size = size_needed;
 
     kaa_platform_message_writer_t writer = KAA_MESSAGE_WRITER(buffer, *size);
+    writer.splices = splices;
     error = kaa_event_request_serialize(context, request_id, &writer);
     if (error) {
         return error;
@@ -172,6 +210,22 @@ kaa_error_t kaa_extension_event_request_serialize(void *context, uint32_t reques
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_extension_event_request_serialize(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, bool *need_resync)
+{
+    return event_request_serialize(context, request_id, buffer, size, NULL, need_resync);
+}
+
+/*
+ * The sent events are kept until the server acknowledges them, so their data
+ * may be written straight from the events.
+ */
+kaa_error_t kaa_extension_event_request_serialize_spliced(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync)
+{
+    return event_request_serialize(context, request_id, buffer, size, splices, need_resync);
+}
+
 kaa_error_t kaa_extension_event_server_sync(void *context, uint32_t request_id,
         uint16_t extension_options, const uint8_t *buffer, size_t size)
 {
@@ -184,18 +238,22 @@ kaa_error_t kaa_extension_event_server_sync(void *context, uint32_t request_id,
     return kaa_event_handle_server_sync(context, &reader, extension_options, size, request_id);
 }
 
+static void destroy_fqns(kaa_bytes_t **fqns, size_t fqns_count)
+{
+    for (size_t i = 0; i < fqns_count; ++i) {
+        if (fqns[i]) {
+            kaa_bytes_destroy(fqns[i]);
+        }
+    }
+    KAA_FREE(fqns);
+}
+
 static void destroy_event_listener_request(void *request_p)
 {
     KAA_RETURN_IF_NIL(request_p,);
     kaa_event_listeners_request_t *subscriber = (kaa_event_listeners_request_t *) request_p;
     if (subscriber->fqns) {
-        size_t i = 0;
-        for (; i < subscriber->fqns_count; ++i) {
-            if (subscriber->fqns[i]) {
-                kaa_bytes_destroy(subscriber->fqns[i]);
-            }
-        }
-        KAA_FREE(subscriber->fqns);
+        destroy_fqns(subscriber->fqns, subscriber->fqns_count);
     }
     KAA_FREE(subscriber);
 }
@@ -231,6 +289,105 @@ static kaa_event_listeners_request_t *create_event_listener_request(kaa_event_ma
     return result;
 }
 
+static void destroy_listeners_cache_entry(void *entry_p)
+{
+    KAA_RETURN_IF_NIL(entry_p,);
+    kaa_event_listeners_cache_entry_t *entry = (kaa_event_listeners_cache_entry_t *) entry_p;
+    if (entry->fqns) {
+        destroy_fqns(entry->fqns, entry->fqns_count);
+    }
+    if (entry->listeners) {
+        KAA_FREE(entry->listeners);
+    }
+    KAA_FREE(entry);
+}
+
+/* The FQNs may come in any order */
+static bool listeners_cache_entry_matches(const kaa_event_listeners_cache_entry_t *entry, const char *fqns[], size_t fqns_count)
+{
+    if (entry->fqns_count != fqns_count) {
+        return false;
+    }
+
+    for (size_t i = 0; i < fqns_count; ++i) {
+        size_t fqn_length = strlen(fqns[i]);
+        bool is_found = false;
+        for (size_t j = 0; j < entry->fqns_count && !is_found; ++j) {
+            is_found = (size_t) entry->fqns[j]->size == fqn_length
+                    && !memcmp(entry->fqns[j]->buffer, fqns[i], fqn_length);
+        }
+        if (!is_found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Drops the entries which are expired or were found before the user's endpoints changed,
+ * then returns the entry of the FQNs if any.
+ */
+static kaa_event_listeners_cache_entry_t *find_cached_listeners(kaa_event_manager_t *self, const char *fqns[], size_t fqns_count)
+{
+    kaa_event_listeners_cache_entry_t *result = NULL;
+    kaa_time_t now = KAA_TIME();
+
+    kaa_list_node_t *it = kaa_list_begin(self->event_listeners_cache);
+    while (it) {
+        kaa_event_listeners_cache_entry_t *entry = (kaa_event_listeners_cache_entry_t *) kaa_list_get_data(it);
+        if (now >= entry->expiry || entry->user_endpoints_epoch != self->status->user_endpoints_epoch) {
+            it = kaa_list_remove_at(self->event_listeners_cache, it, &destroy_listeners_cache_entry);
+            continue;
+        }
+
+        if (!result && listeners_cache_entry_matches(entry, fqns, fqns_count)) {
+            result = entry;
+        }
+        it = kaa_list_next(it);
+    }
+
+    return result;
+}
+
+/* Takes over the FQNs of the request. A failure to cache isn't an error. */
+static void cache_listeners(kaa_event_manager_t *self, kaa_event_listeners_request_t *request,
+        const kaa_endpoint_id listeners[], size_t listeners_count)
+{
+    if (!self->listeners_cache_ttl || !KAA_EVENT_LISTENERS_CACHE_SIZE) {
+        return;
+    }
+
+    kaa_event_listeners_cache_entry_t *entry = (kaa_event_listeners_cache_entry_t *) KAA_CALLOC(1, sizeof(kaa_event_listeners_cache_entry_t));
+    KAA_RETURN_IF_NIL(entry,);
+
+    if (listeners_count) {
+        entry->listeners = (kaa_endpoint_id *) KAA_MALLOC(listeners_count * KAA_ENDPOINT_ID_LENGTH);
+        if (!entry->listeners) {
+            KAA_FREE(entry);
+            return;
+        }
+        memcpy(entry->listeners, listeners, listeners_count * KAA_ENDPOINT_ID_LENGTH);
+    }
+    entry->listeners_count = listeners_count;
+    entry->expiry = KAA_TIME() + (kaa_time_t)self->listeners_cache_ttl;
+    entry->user_endpoints_epoch = self->status->user_endpoints_epoch;
+
+    if (!kaa_list_push_front(self->event_listeners_cache, entry)) {
+        destroy_listeners_cache_entry(entry);
+        return;
+    }
+
+    entry->fqns = request->fqns;
+    entry->fqns_count = request->fqns_count;
+    request->fqns = NULL;
+    request->fqns_count = 0;
+
+    if (kaa_list_get_size(self->event_listeners_cache) > KAA_EVENT_LISTENERS_CACHE_SIZE) {
+        kaa_list_remove_at(self->event_listeners_cache, kaa_list_back(self->event_listeners_cache), &destroy_listeners_cache_entry);
+    }
+}
+
 static bool find_listeners_request_by_id(void *request_p, void *context)
 {
     kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) request_p;
@@ -243,8 +400,12 @@ static void kaa_event_destroy(void* data)
     if (data) {
         kaa_event_t* record = (kaa_event_t*)data;
 
-        kaa_bytes_destroy(record->event_class_fqn);
-        kaa_bytes_destroy(record->event_data);
+        if (record->event_class_fqn_owned) {
+            KAA_FREE((char *)record->event_class_fqn);
+        }
+        if (record->event_data != record->inline_data) {
+            KAA_FREE(record->event_data);
+        }
         kaa_bytes_destroy(record->target);
 
         KAA_FREE(record);
@@ -252,18 +413,24 @@ static void kaa_event_destroy(void* data)
 }
 
 static event_callback_pair_t *create_event_callback_pair(const char *fqn
+                                                       , bool copy_fqn
                                                        , kaa_event_callback_t callback)
 {
     event_callback_pair_t *pair = (event_callback_pair_t *) KAA_MALLOC(sizeof(event_callback_pair_t));
     KAA_RETURN_IF_NIL(pair, NULL);
 
-    size_t fqn_length = strlen(fqn);
-    pair->fqn = (char *) KAA_MALLOC((fqn_length + 1) * sizeof(char));
-    if (!pair->fqn) {
-        KAA_FREE(pair);
-        return NULL;
+    pair->fqn = fqn;
+    pair->fqn_owned = copy_fqn;
+    if (copy_fqn) {
+        size_t fqn_length = strlen(fqn);
+        char *fqn_copy = (char *) KAA_MALLOC((fqn_length + 1) * sizeof(char));
+        if (!fqn_copy) {
+            KAA_FREE(pair);
+            return NULL;
+        }
+        strcpy(fqn_copy, fqn);
+        pair->fqn = fqn_copy;
     }
-    strcpy(pair->fqn, fqn);
     pair->cb = callback;
     return pair;
 }
@@ -272,20 +439,16 @@ static void kaa_event_destroy_callback_pair(void *pair_p)
 {
     KAA_RETURN_IF_NIL(pair_p, );
     event_callback_pair_t *pair = (event_callback_pair_t *) pair_p;
-    KAA_FREE(pair->fqn);
+    if (pair->fqn_owned) {
+        KAA_FREE((char *)pair->fqn);
+    }
     KAA_FREE(pair);
 }
 
-static kaa_event_callback_t find_event_callback(kaa_list_t *head, const char *fqn)
+static kaa_event_callback_t find_event_callback(kaa_hash_map_t *callbacks, const char *fqn)
 {
-    kaa_list_node_t *it = kaa_list_begin(head);
-    while (it) {
-        event_callback_pair_t *pair = (event_callback_pair_t *) kaa_list_get_data(it);
-        if (strcmp(fqn, pair->fqn) == 0)
-            return pair->cb;
-        it = kaa_list_next(it);
-    }
-    return NULL;
+    event_callback_pair_t *pair = kaa_hash_map_get(callbacks, fqn);
+    return pair ? pair->cb : NULL;
 }
 
 static event_transaction_t *create_transaction(kaa_event_block_id id)
@@ -324,9 +487,10 @@ void kaa_event_manager_destroy(kaa_event_manager_t *self)
     if (self) {
         kaa_list_destroy(self->pending_events, &kaa_event_destroy);
         kaa_list_destroy(self->events_awaiting_response.sent_events, &kaa_event_destroy);
-        kaa_list_destroy(self->event_callbacks, &kaa_event_destroy_callback_pair);
+        kaa_hash_map_destroy(self->event_callbacks, &kaa_event_destroy_callback_pair);
         kaa_list_destroy(self->transactions, &destroy_transaction);
         kaa_list_destroy(self->event_listeners_requests, &destroy_event_listener_request);
+        kaa_list_destroy(self->event_listeners_cache, &destroy_listeners_cache_entry);
 
         if (self->event_source) {
             KAA_FREE((void*)self->event_source);
@@ -352,6 +516,14 @@ kaa_error_t kaa_event_manager_create(kaa_event_manager_t **context, kaa_status_t
     (*event_manager_p)->event_sequence_number = status->event_seq_n;
 
     (*event_manager_p)->sequence_number_status = KAA_EVENT_SEQUENCE_NUMBER_UNSYNCHRONIZED;
+    (*event_manager_p)->extension_payload_size = 0;
+    (*event_manager_p)->extension_payload_size_valid = false;
+
+    (*event_manager_p)->coalescing_window = KAA_EVENT_COALESCING_WINDOW;
+    (*event_manager_p)->coalescing_max_events = KAA_EVENT_COALESCING_MAX_EVENTS;
+    (*event_manager_p)->coalescing_trx = 0;
+    (*event_manager_p)->coalesced_events_count = 0;
+    (*event_manager_p)->listeners_cache_ttl = KAA_EVENT_LISTENERS_CACHE_TTL;
 
     (*event_manager_p)->status = status;
     (*event_manager_p)->channel_manager = channel_manager;
@@ -362,13 +534,15 @@ kaa_error_t kaa_event_manager_create(kaa_event_manager_t **context, kaa_status_t
 
     (*event_manager_p)->pending_events = kaa_list_create();
     (*event_manager_p)->events_awaiting_response.sent_events = kaa_list_create();
-    (*event_manager_p)->event_callbacks = kaa_list_create();
+    (*event_manager_p)->event_callbacks = kaa_hash_map_create(&kaa_hash_map_string_hash,
+            &kaa_hash_map_string_equals);
     (*event_manager_p)->transactions = kaa_list_create();
     (*event_manager_p)->event_listeners_requests = kaa_list_create();
+    (*event_manager_p)->event_listeners_cache = kaa_list_create();
 
     if (!(*event_manager_p)->pending_events || !(*event_manager_p)->events_awaiting_response.sent_events ||
         !(*event_manager_p)->event_callbacks || !(*event_manager_p)->transactions ||
-        !(*event_manager_p)->event_listeners_requests)
+        !(*event_manager_p)->event_listeners_requests || !(*event_manager_p)->event_listeners_cache)
     {
         kaa_event_manager_destroy(*event_manager_p);
         return KAA_ERR_NOMEM;
@@ -377,32 +551,127 @@ kaa_error_t kaa_event_manager_create(kaa_event_manager_t **context, kaa_status_t
     return KAA_ERR_NONE;
 }
 
-static kaa_error_t kaa_fill_event_structure(kaa_event_t *event
-                                          , size_t sequence_number
-                                          , const char *fqn
-                                          , const char *event_data
-                                          , size_t event_data_size
-                                          , kaa_endpoint_id_p target)
+/*
+ * A static FQN (of a known id) is referred to, any other is copied. The event
+ * has room for @p inline_data_size bytes of the payload.
+ */
+static kaa_event_t *kaa_event_create(const char *fqn
+                                   , size_t fqn_length
+                                   , bool copy_fqn
+                                   , size_t inline_data_size
+                                   , kaa_endpoint_id_p target)
 {
-    KAA_RETURN_IF_NIL2(event, fqn, KAA_ERR_BADPARAM);
+    /**
+     * KAA_CALLOC is really needed there.
+     */
+    kaa_event_t *event = (kaa_event_t *)KAA_CALLOC(1, sizeof(kaa_event_t) + inline_data_size);
+    KAA_RETURN_IF_NIL(event, NULL);
+
+    event->event_data = event->inline_data;
+    event->event_class_fqn = fqn;
+    event->event_class_fqn_length = fqn_length;
+    if (copy_fqn) {
+        char *fqn_copy = (char *) KAA_MALLOC(fqn_length + 1);
+        if (!fqn_copy) {
+            kaa_event_destroy(event);
+            return NULL;
+        }
+        memcpy(fqn_copy, fqn, fqn_length + 1);
+        event->event_class_fqn = fqn_copy;
+        event->event_class_fqn_owned = true;
+    }
+
+    if (target) {
+        event->target = kaa_bytes_copy_create(target, KAA_ENDPOINT_ID_LENGTH);
+        if (!event->target) {
+            kaa_event_destroy(event);
+            return NULL;
+        }
+    }
 
-    event->seq_num = sequence_number;
-    event->event_class_fqn = kaa_bytes_copy_create((const uint8_t *)fqn
-                                                 , strlen(fqn) + 1);
-    --event->event_class_fqn->size;
-    KAA_RETURN_IF_NIL(event->event_class_fqn, KAA_ERR_NOMEM);
+    return event;
+}
+
+/*
+ * Takes the ownership of @p event_data, unless an error is returned.
+ */
+static kaa_event_t *kaa_event_create_raw(const char *fqn
+                                       , size_t fqn_length
+                                       , bool copy_fqn
+                                       , const char *event_data
+                                       , size_t event_data_size
+                                       , kaa_endpoint_id_p target)
+{
+    kaa_event_t *event = kaa_event_create(fqn, fqn_length, copy_fqn, 0, target);
+    KAA_RETURN_IF_NIL(event, NULL);
 
     if (event_data && event_data_size > 0) {
-        event->event_data = kaa_bytes_move_create((const uint8_t *) event_data
-                                                , event_data_size
-                                                , &kaa_data_destroy);
-        KAA_RETURN_IF_NIL(event->event_data, KAA_ERR_NOMEM);
+        event->event_data = (uint8_t *)event_data;
+        event->event_data_size = event_data_size;
     }
 
-    if (target) {
-        event->target = kaa_bytes_copy_create(target, KAA_ENDPOINT_ID_LENGTH);
-        KAA_RETURN_IF_NIL(event->target, KAA_ERR_NOMEM);
+    return event;
+}
+
+/*
+ * Serializes the record in the event itself, rather than in a buffer to be copied.
+ */
+static kaa_event_t *kaa_event_create_from_record(const kaa_event_fqn_t *fqn
+                                               , void *record
+                                               , serialize_fn serialize
+                                               , size_t record_size
+                                               , kaa_endpoint_id_p target)
+{
+    kaa_event_t *event = kaa_event_create(fqn->fqn, fqn->fqn_length, false, record_size, target);
+    KAA_RETURN_IF_NIL(event, NULL);
+
+    if (record_size > 0) {
+        struct avro_writer_t_ writer = {
+            .buf = (const char *)event->inline_data,
+            .len = record_size,
+            .written = 0,
+        };
+        serialize(&writer, record);
+        if ((size_t)writer.written != record_size) {
+            kaa_event_destroy(event);
+            return NULL;
+        }
+        event->event_data_size = record_size;
+    }
+
+    return event;
+}
+
+static kaa_error_t kaa_event_manager_queue_event(kaa_event_manager_t *self, kaa_event_t *event)
+{
+    event->seq_num = (self->sequence_number_status == KAA_EVENT_SEQUENCE_NUMBER_SYNCHRONIZED ?
+                                        ++self->event_sequence_number :
+                                        (size_t) -1);
+
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding a new event \"%s\" with data size %zu",
+            event->event_class_fqn, event->event_data_size);
+# ifdef KAA_LOG_LEVEL_TRACE_ENABLED
+    if (event->target) {
+        char target_string[2 * KAA_ENDPOINT_ID_LENGTH + 1];
+        int i = 0;
+        for (; i < KAA_ENDPOINT_ID_LENGTH; ++i) {
+            ext_snpintf(&target_string[2 * i], 3, "%02X", event->target->buffer[i]);
+        }
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Event target = %s", target_string);
     }
+# endif
+
+    if (!kaa_list_push_back(self->pending_events, event)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to save a new event");
+        kaa_event_destroy(event);
+        return KAA_ERR_NOMEM;
+    }
+    self->extension_payload_size_valid = false;
+
+    kaa_transport_channel_interface_t *channel =
+            kaa_channel_manager_get_transport_channel(self->channel_manager, event_sync_services[0]);
+    if (channel)
+        channel->sync_handler(channel->context, event_sync_services, 1);
 
     return KAA_ERR_NONE;
 }
@@ -423,6 +692,8 @@ static kaa_error_t kaa_fill_event_structure(kaa_event_t *event
  *
  * @return Error code.
  */
+static kaa_error_t kaa_event_manager_coalesce_event(kaa_event_manager_t *self, kaa_event_t *event);
+
 kaa_error_t kaa_event_manager_send_event(kaa_event_manager_t *self
                                        , const char *fqn
                                        , const char *event_data
@@ -435,58 +706,56 @@ kaa_error_t kaa_event_manager_send_event(kaa_event_manager_t *self
     KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
     KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding a new event \"%s\"", fqn);
-
-    /**
-     * KAA_CALLOC is really needed there.
-     */
-    kaa_event_t *event = (kaa_event_t*)KAA_CALLOC(1, sizeof(kaa_event_t));
+    kaa_event_t *event = kaa_event_create_raw(fqn, strlen(fqn), true, event_data, event_data_size, target);
     if (!event) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to allocate a new event structure");
         return KAA_ERR_NOMEM;
     }
 
-    size_t new_sequence_number = (self->sequence_number_status == KAA_EVENT_SEQUENCE_NUMBER_SYNCHRONIZED ?
-                                        ++self->event_sequence_number :
-                                        (size_t) -1);
+    return kaa_event_manager_coalesce_event(self, event);
+}
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Filling a new event with data size %u", event_data_size);
-# ifdef KAA_LOG_LEVEL_TRACE_ENABLED
-    if (target) {
-        char target_string[2 * KAA_ENDPOINT_ID_LENGTH + 1];
-        int i = 0;
-        for (; i < KAA_ENDPOINT_ID_LENGTH; ++i) {
-            ext_snpintf(&target_string[2 * i], 3, "%02X", target[i]);
-        }
-        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Event target = %s", target_string);
-    }
-# endif
-    kaa_error_t error = kaa_fill_event_structure(event
-                                                    , new_sequence_number
-                                                    , fqn
-                                                    , event_data
-                                                    , event_data_size
-                                                    , target);
-    if (error) {
-        KAA_LOG_ERROR(self->logger, error, "Failed to fill a new event (size=%u)", event_data_size);
-        kaa_event_destroy(event);
-        return error;
-    }
+kaa_error_t kaa_event_manager_send_event_by_id(kaa_event_manager_t *self
+                                             , kaa_event_fqn_id_t fqn_id
+                                             , const char *event_data
+                                             , size_t event_data_size
+                                             , kaa_endpoint_id_p target)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(fqn_id);
+    KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    if (!kaa_list_push_back(self->pending_events, event)) {
-        KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to save a new event");
-        kaa_event_destroy(event);
+    kaa_event_t *event = kaa_event_create_raw(fqn->fqn, fqn->fqn_length, false, event_data, event_data_size, target);
+    if (!event) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to allocate a new event structure");
         return KAA_ERR_NOMEM;
     }
 
-    kaa_transport_channel_interface_t *channel =
-            kaa_channel_manager_get_transport_channel(self->channel_manager, event_sync_services[0]);
-    if (channel)
-        channel->sync_handler(channel->context, event_sync_services, 1);
+    return kaa_event_manager_coalesce_event(self, event);
+}
 
-    return KAA_ERR_NONE;
+kaa_error_t kaa_event_manager_send_record_by_id(kaa_event_manager_t *self
+                                              , kaa_event_fqn_id_t fqn_id
+                                              , void *record
+                                              , serialize_fn serialize
+                                              , size_t record_size
+                                              , kaa_endpoint_id_p target)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+    KAA_RETURN_IF_NIL2(record, serialize, KAA_ERR_BADPARAM);
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(fqn_id);
+    KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
+
+    kaa_event_t *event = kaa_event_create_from_record(fqn, record, serialize, record_size, target);
+    if (!event) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to create a new event \"%s\"", fqn->fqn);
+        return KAA_ERR_NOMEM;
+    }
+
+    return kaa_event_manager_coalesce_event(self, event);
 }
 
+
 static size_t kaa_event_list_get_request_size(kaa_list_t *events)
 {
     size_t expected_size = 0;
@@ -499,7 +768,7 @@ static size_t kaa_event_list_get_request_size(kaa_list_t *events)
                         + sizeof(uint16_t) /*Event options*/
                         + sizeof(uint16_t); /*Event class FQN length */
 
-        if (event->event_data) {
+        if (event->event_data_size) {
             expected_size  += sizeof(uint32_t); /*Event data size*/
         }
 
@@ -507,10 +776,10 @@ static size_t kaa_event_list_get_request_size(kaa_list_t *events)
             expected_size += KAA_ENDPOINT_ID_LENGTH; /*Target Endpoint ID*/
         }
 
-        expected_size += kaa_aligned_size_get(event->event_class_fqn->size); /*Event class FQN + padding */
+        expected_size += kaa_aligned_size_get(event->event_class_fqn_length); /*Event class FQN + padding */
 
-        if (event->event_data) {
-            expected_size += kaa_aligned_size_get(event->event_data->size);/*Event data + padding*/
+        if (event->event_data_size) {
+            expected_size += kaa_aligned_size_get(event->event_data_size);/*Event data + padding*/
         }
 
         it = kaa_list_next(it);
@@ -565,6 +834,7 @@ kaa_error_t kaa_event_request_get_size(kaa_event_manager_t *self, size_t *expect
     }
 
     self->extension_payload_size = *expected_size;
+    self->extension_payload_size_valid = true;
     *expected_size += KAA_EXTENSION_HEADER_SIZE;
 
     return KAA_ERR_NONE;
@@ -572,9 +842,7 @@ kaa_error_t kaa_event_request_get_size(kaa_event_manager_t *self, size_t *expect
 
 static kaa_error_t kaa_event_list_serialize(kaa_event_manager_t *self, kaa_list_t *events, kaa_platform_message_writer_t *writer)
 {
-    uint16_t temp_network_order_16 = 0;
-    uint16_t options = 0;
-    uint32_t temp_network_order_32 = 0;
+    kaa_error_t error = KAA_ERR_NONE;
 
     kaa_list_node_t *it = kaa_list_begin(events);
     while (it) {
@@ -584,40 +852,25 @@ static kaa_error_t kaa_event_list_serialize(kaa_event_manager_t *self, kaa_list_
             event->seq_num = ++self->event_sequence_number;
         }
 
-        temp_network_order_32 = KAA_HTONL(event->seq_num);
-        kaa_error_t error = kaa_platform_message_write(writer, &temp_network_order_32, sizeof(uint32_t));
-        if (error) {
-            KAA_LOG_ERROR(self->logger, error, "Failed to write event sequence number");
-            return error;
-        }
-
         /**
          * Event options
          */
-        options = (!event->target ? 0 : KAA_EVENT_OPTION_TARGET_ID_PRESENT)
-                   | (event->event_data ? KAA_EVENT_OPTION_EVENT_HAS_DATA : 0);
-        options = KAA_HTONS(options);
-
-        error = kaa_platform_message_write(writer, &options, sizeof(uint16_t));
-        if (error) {
-            KAA_LOG_ERROR(self->logger, error, "Failed to write event options");
-            return error;
+        uint16_t options = (!event->target ? 0 : KAA_EVENT_OPTION_TARGET_ID_PRESENT)
+                         | (event->event_data_size ? KAA_EVENT_OPTION_EVENT_HAS_DATA : 0);
+
+        /* Sequence number, options, class FQN length and the optional data size */
+        size_t header_size = sizeof(uint32_t) + 2 * sizeof(uint16_t)
+                           + (event->event_data_size ? sizeof(uint32_t) : 0);
+        if (!kaa_platform_message_writer_reserve(writer, header_size)) {
+            KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to write event header");
+            return KAA_ERR_WRITE_FAILED;
         }
 
-        temp_network_order_16 = KAA_HTONS(event->event_class_fqn->size);
-        error = kaa_platform_message_write(writer, &temp_network_order_16, sizeof(uint16_t));
-        if (error) {
-            KAA_LOG_ERROR(self->logger, error, "Failed to write event class fqn length");
-            return error;
-        }
-
-        if (event->event_data) {
-            temp_network_order_32 = KAA_HTONL(event->event_data->size);
-            error = kaa_platform_message_write(writer, &temp_network_order_32, sizeof(uint32_t));
-            if (error) {
-                KAA_LOG_ERROR(self->logger, error, "Failed to write event data size");
-                return error;
-            }
+        kaa_platform_message_put_uint32(writer, event->seq_num);
+        kaa_platform_message_put_uint16(writer, options);
+        kaa_platform_message_put_uint16(writer, event->event_class_fqn_length);
+        if (event->event_data_size) {
+            kaa_platform_message_put_uint32(writer, event->event_data_size);
         }
 
         if (event->target) {
@@ -631,25 +884,27 @@ static kaa_error_t kaa_event_list_serialize(kaa_event_manager_t *self, kaa_list_
         }
 
         error = kaa_platform_message_write_aligned(writer
-                                                      , event->event_class_fqn->buffer
-                                                      , event->event_class_fqn->size);
+                                                      , event->event_class_fqn
+                                                      , event->event_class_fqn_length);
         if (error) {
             KAA_LOG_ERROR(self->logger, error, "Failed to write event class fqn aligned");
             return error;
         }
 
 
-        if (event->event_data) {
-            error = kaa_platform_message_write_aligned(writer
-                                                          , event->event_data->buffer
-                                                          , event->event_data->size);
+        if (event->event_data_size) {
+            bool spliced = false;
+            error = kaa_platform_message_write_aligned_spliced(writer
+                                                          , event->event_data
+                                                          , event->event_data_size
+                                                          , &spliced);
             if (error) {
                 KAA_LOG_ERROR(self->logger, error, "Failed to write event data aligned");
                 return error;
             }
         }
         KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Serialized event: sqn '%u', options '%u', data size '%u', fqn '%s'"
-                    , event->seq_num, KAA_NTOHS(options), event->event_data ? event->event_data->size : 0, event->event_class_fqn->buffer);
+                    , event->seq_num, options, event->event_data_size, event->event_class_fqn);
         it = kaa_list_next(it);
     }
     return KAA_ERR_NONE;
@@ -662,16 +917,14 @@ static kaa_error_t kaa_event_listeners_request_serialize(kaa_event_manager_t *se
     while (it) {
         kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) kaa_list_get_data(it);
         if (!request->is_sent) {
-            *((uint16_t *) writer->current) = KAA_HTONS(request->request_id);
-            writer->current += sizeof(uint16_t);
-            *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) request->fqns_count);
-            writer->current += sizeof(uint16_t);
+            kaa_platform_message_put_uint16(writer, request->request_id);
+            kaa_platform_message_put_uint16(writer, (uint16_t) request->fqns_count);
             KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to serialize event listeners: request id '%u', fqn count '%u'"
                         , request->request_id, request->fqns_count);
             for (size_t i = 0; i < request->fqns_count; ++i) {
                 size_t fqn_length = request->fqns[i]->size;
-                *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) fqn_length);
-                writer->current += sizeof(uint32_t); // fqn length + reserved
+                kaa_platform_message_put_uint16(writer, (uint16_t) fqn_length);
+                kaa_platform_message_put_padding(writer, sizeof(uint16_t)); // reserved
                 kaa_error_t error = kaa_platform_message_write_aligned(writer, request->fqns[i]->buffer, fqn_length);
                 if (error) {
                     KAA_LOG_ERROR(self->logger, error, "Failed to write event listener request");
@@ -694,6 +947,9 @@ kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t reques
 
     KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to serialize client event sync");
 
+    // Serialized events move to the awaiting response list, listener requests are marked sent.
+    self->extension_payload_size_valid = false;
+
     /* write extension header */
     uint16_t extension_options = 0;
     if (self->sequence_number_status != KAA_EVENT_SEQUENCE_NUMBER_SYNCHRONIZED) {
@@ -721,10 +977,9 @@ kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t reques
 
         if (events_count) {
             KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Serializing %u events", events_count);
-            *((uint8_t *) writer->current) = EVENTS_FIELD;
-            writer->current += sizeof(uint16_t); // field id + reserved
-            *((uint16_t *) writer->current) = KAA_HTONS(events_count);
-            writer->current += sizeof(uint16_t);
+            kaa_platform_message_put_uint8(writer, EVENTS_FIELD);
+            kaa_platform_message_put_padding(writer, sizeof(uint8_t)); // reserved
+            kaa_platform_message_put_uint16(writer, events_count);
 
             error = kaa_event_list_serialize(self, resending_events, writer);
             if (error) {
@@ -744,8 +999,8 @@ kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t reques
         }
 
         if (kaa_list_get_size(self->event_listeners_requests)) {
-            *((uint8_t *) writer->current) = EVENT_LISTENERS_FIELD;
-            writer->current += sizeof(uint16_t); // field id + reserved
+            kaa_platform_message_put_uint8(writer, EVENT_LISTENERS_FIELD);
+            kaa_platform_message_put_padding(writer, sizeof(uint8_t)); // reserved
             uint8_t *listeners_count_p = writer->current; // Pointer to the listeners count. Will be filled in later
             writer->current += sizeof(uint16_t);
 
@@ -757,7 +1012,7 @@ kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t reques
                 KAA_LOG_ERROR(self->logger, error, "Failed to serialize event listeners request");
                 return error;
             }
-            *((uint16_t *) listeners_count_p) = KAA_HTONS(listeners_count);
+            kaa_platform_store_be16(listeners_count_p, listeners_count);
         }
     }
     return KAA_ERR_NONE;
@@ -768,33 +1023,24 @@ static kaa_error_t kaa_event_read_event(kaa_event_manager_t *self, kaa_platform_
 
     KAA_RETURN_IF_NIL2(self, reader, KAA_ERR_BADPARAM);
 
-    uint16_t event_options = 0;
-    kaa_error_t error = kaa_platform_message_read(reader, &event_options, sizeof(uint16_t));
-    if (error) {
-        KAA_LOG_ERROR(self->logger, error, "Failed to read event options field");
-        return error;
+    if (!kaa_platform_message_is_buffer_large_enough(reader, 2 * sizeof(uint16_t))) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to read event options and class fqn length fields");
+        return KAA_ERR_READ_FAILED;
     }
-    event_options = KAA_NTOHS(event_options);
 
-    uint16_t event_class_fqn_length = 0;
-    error = kaa_platform_message_read(reader, &event_class_fqn_length, sizeof(uint16_t));
-    if (error) {
-        KAA_LOG_ERROR(self->logger, error, "Failed to read event class fqn length field");
-        return error;
-    }
-    event_class_fqn_length = KAA_NTOHS(event_class_fqn_length);
+    uint16_t event_options = kaa_platform_message_get_uint16(reader);
+    uint16_t event_class_fqn_length = kaa_platform_message_get_uint16(reader);
 
     uint32_t event_data_size = 0;
     if (event_options & KAA_EVENT_OPTION_EVENT_HAS_DATA) {
-        error = kaa_platform_message_read(reader, &event_data_size, sizeof(uint32_t));
-        if (error) {
-            KAA_LOG_ERROR(self->logger, error, "Failed to read event data size field");
-            return error;
+        if (!kaa_platform_message_is_buffer_large_enough(reader, sizeof(uint32_t))) {
+            KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to read event data size field");
+            return KAA_ERR_READ_FAILED;
         }
-        event_data_size = KAA_NTOHL(event_data_size);
+        event_data_size = kaa_platform_message_get_uint32(reader);
     }
 
-    error = kaa_platform_message_read(reader, (void*)self->event_source, sizeof(kaa_endpoint_id));
+    kaa_error_t error = kaa_platform_message_read(reader, (void*)self->event_source, sizeof(kaa_endpoint_id));
 
     if (error) {
         KAA_LOG_ERROR(self->logger, error, "Failed to read event source endpoint id field");
@@ -846,13 +1092,9 @@ static kaa_error_t kaa_event_read_event(kaa_event_manager_t *self, kaa_platform_
 
 static kaa_error_t kaa_event_read_listeners_response(kaa_event_manager_t *self, kaa_platform_message_reader_t *reader)
 {
-    uint16_t request_id = KAA_NTOHS(*(uint16_t *) reader->current);
-    reader->current += sizeof(uint16_t);
-    uint16_t listeners_result = KAA_NTOHS(*(uint16_t *) reader->current);
-    reader->current += sizeof(uint16_t);
-
-    uint32_t listeners_count =  KAA_NTOHL(*(uint32_t *) reader->current);
-    reader->current += sizeof(uint32_t);
+    uint16_t request_id = kaa_platform_message_get_uint16(reader);
+    uint16_t listeners_result = kaa_platform_message_get_uint16(reader);
+    uint32_t listeners_count = kaa_platform_message_get_uint32(reader);
 
     KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Received %u event listener(s) on %u request"
                                                                 , listeners_count, request_id);
@@ -868,6 +1110,7 @@ static kaa_error_t kaa_event_read_listeners_response(kaa_event_manager_t *self,
         }
         kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) kaa_list_get_data(request_node);
         if (listeners_result == EVENT_LISTENERS_SUCCESS) {
+            cache_listeners(self, request, (const kaa_endpoint_id *) reader->current, listeners_count);
             request->callback.on_event_listeners(request->callback.context, (const kaa_endpoint_id *) reader->current, listeners_count);
             KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Success event listeners response for request id %u", request_id);
         } else {
@@ -875,6 +1118,7 @@ static kaa_error_t kaa_event_read_listeners_response(kaa_event_manager_t *self,
             KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Failed to find event listeners, request id %u", request_id);
         }
         kaa_list_remove_at(self->event_listeners_requests, request_node, &destroy_event_listener_request);
+        self->extension_payload_size_valid = false;
     } else {
         KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Failed to find event listeners callback with request id %u", request_id);
     }
@@ -906,6 +1150,7 @@ kaa_error_t kaa_event_handle_server_sync(kaa_event_manager_t *self
         KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Received event sequence number '%u'", event_sequence_number);
         if (self->sequence_number_status != KAA_EVENT_SEQUENCE_NUMBER_SYNCHRONIZED) {
             self->sequence_number_status = KAA_EVENT_SEQUENCE_NUMBER_SYNCHRONIZED;
+            self->extension_payload_size_valid = false;
 
             if (self->event_sequence_number != event_sequence_number) {
                 KAA_LOG_WARN(self->logger, KAA_ERR_BAD_STATE, "Stored event sequence number is not correct (stored %u, received %u).", self->event_sequence_number, event_sequence_number);
@@ -929,6 +1174,7 @@ kaa_error_t kaa_event_handle_server_sync(kaa_event_manager_t *self
     if (request_id == self->events_awaiting_response.request_id) {
         kaa_list_clear(self->events_awaiting_response.sent_events, &kaa_event_destroy);
         self->events_awaiting_response.request_id = (size_t) -1;
+        self->extension_payload_size_valid = false;
     }
 
     while (extension_length > 0) {
@@ -1001,6 +1247,15 @@ kaa_error_t kaa_event_manager_find_event_listeners(kaa_event_manager_t *self, co
 {
     KAA_RETURN_IF_NIL5(self, fqns_count, callback, callback->on_event_listeners, callback->on_event_listeners_failed, KAA_ERR_BADPARAM);
 
+    if (self->listeners_cache_ttl) {
+        kaa_event_listeners_cache_entry_t *entry = find_cached_listeners(self, fqns, fqns_count);
+        if (entry) {
+            KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Found %zu cached event listener(s)", entry->listeners_count);
+            callback->on_event_listeners(callback->context, (const kaa_endpoint_id *) entry->listeners, entry->listeners_count);
+            return KAA_ERR_NONE;
+        }
+    }
+
     kaa_event_listeners_request_t *subscriber = create_event_listener_request(self, fqns, fqns_count, callback);
     KAA_RETURN_IF_NIL(subscriber, KAA_ERR_NOMEM);
 
@@ -1009,6 +1264,7 @@ kaa_error_t kaa_event_manager_find_event_listeners(kaa_event_manager_t *self, co
         destroy_event_listener_request(subscriber);
         return KAA_ERR_NOMEM;
     }
+    self->extension_payload_size_valid = false;
 
     ++self->event_listeners_request_id;
 
@@ -1033,33 +1289,43 @@ kaa_error_t kaa_event_manager_find_event_listeners(kaa_event_manager_t *self, co
  *
  * @return  Error code.
  */
+static kaa_error_t kaa_event_manager_put_callback(kaa_event_manager_t *self, const char *fqn,
+        bool copy_fqn, kaa_event_callback_t callback)
+{
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding callback for events, fqn '%s'", fqn);
+    event_callback_pair_t *pair = create_event_callback_pair(fqn, copy_fqn, callback);
+    KAA_RETURN_IF_NIL(pair, KAA_ERR_NOMEM);
+    void *replaced = NULL;
+    if (kaa_hash_map_put(self->event_callbacks, pair->fqn, pair, &replaced)) {
+        kaa_event_destroy_callback_pair(pair);
+        return KAA_ERR_NOMEM;
+    }
+    kaa_event_destroy_callback_pair(replaced);
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_event_manager_add_on_event_callback(kaa_event_manager_t *self, const char *fqn, kaa_event_callback_t callback)
 {
     KAA_RETURN_IF_NIL2(self, callback, KAA_ERR_BADPARAM);
     if (fqn) {
-        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding callback for events, fqn '%s'", fqn);
-        event_callback_pair_t *pair = create_event_callback_pair(fqn, callback);
-        KAA_RETURN_IF_NIL(pair, KAA_ERR_NOMEM);
-        kaa_list_node_t *it = kaa_list_begin(self->event_callbacks);
-        while (it) {
-            event_callback_pair_t *data = (event_callback_pair_t *) kaa_list_get_data(it);
-            if (strcmp(fqn, data->fqn) == 0) {
-                kaa_list_set_data_at(it, pair, &kaa_event_destroy_callback_pair);
-                return KAA_ERR_NONE;
-            }
-            it = kaa_list_next(it);
-        }
-        if (!kaa_list_push_back(self->event_callbacks, pair)) {
-            kaa_event_destroy_callback_pair(pair);
-            return KAA_ERR_NOMEM;
-        }
-    } else {
-        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding global event callback");
-        self->global_event_callback = callback;
+        return kaa_event_manager_put_callback(self, fqn, true, callback);
     }
+
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding global event callback");
+    self->global_event_callback = callback;
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_event_manager_add_on_event_callback_by_id(kaa_event_manager_t *self,
+        kaa_event_fqn_id_t fqn_id, kaa_event_callback_t callback)
+{
+    KAA_RETURN_IF_NIL2(self, callback, KAA_ERR_BADPARAM);
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(fqn_id);
+    KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
+
+    return kaa_event_manager_put_callback(self, fqn->fqn, false, callback);
+}
+
 kaa_error_t kaa_event_create_transaction(kaa_event_manager_t *self, kaa_event_block_id *trx_id)
 {
     KAA_RETURN_IF_NIL2(self, trx_id, KAA_ERR_NOT_INITIALIZED);
@@ -1085,6 +1351,11 @@ kaa_error_t kaa_event_finish_transaction(kaa_event_manager_t *self, kaa_event_bl
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Going to send events from event batch, id %zu", trx_id);
 
+    // The events sent before the block go first
+    if (self->coalescing_trx && trx_id != self->coalescing_trx) {
+        kaa_event_manager_flush_coalesced_events(self);
+    }
+
     kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->transactions), &transaction_search_by_id_predicate, &trx_id);
     if (it) {
         event_transaction_t *trx = kaa_list_get_data(it);
@@ -1094,6 +1365,7 @@ kaa_error_t kaa_event_finish_transaction(kaa_event_manager_t *self, kaa_event_bl
         }
         if (kaa_list_get_size(trx->events) > 0) {
             self->pending_events = kaa_lists_merge(self->pending_events, trx->events);
+            self->extension_payload_size_valid = false;
             need_sync = true;
         }
         kaa_list_remove_at(self->transactions, it, &destroy_transaction);
@@ -1117,6 +1389,10 @@ kaa_error_t kaa_event_remove_transaction(kaa_event_manager_t *self, kaa_event_bl
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Going to remove events batch with id %zu", trx_id);
 
+    if (trx_id == self->coalescing_trx) {
+        self->coalescing_trx = 0;
+    }
+
     kaa_error_t error = kaa_list_remove_first(self->transactions, &transaction_search_by_id_predicate, &trx_id, &destroy_transaction);
     if (error) {
         KAA_LOG_WARN(self->logger, error, "Events batch with id %zu was not created before", trx_id);
@@ -1125,6 +1401,123 @@ kaa_error_t kaa_event_remove_transaction(kaa_event_manager_t *self, kaa_event_bl
     return error;
 }
 
+static kaa_error_t kaa_event_manager_add_to_transaction(kaa_event_manager_t *self
+                                                       , kaa_event_block_id trx_id
+                                                       , kaa_event_t *event)
+{
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to add event to events batch, id %zu", trx_id);
+
+    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->transactions), &transaction_search_by_id_predicate, &trx_id);
+    if (it) {
+        event->seq_num = -1;
+
+        event_transaction_t *trx = kaa_list_get_data(it);
+        if (!kaa_list_push_back(trx->events, event)) {
+            kaa_event_destroy(event);
+            return KAA_ERR_NOMEM;
+        }
+
+        return KAA_ERR_NONE;
+    }
+
+    KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Can not add event to events batch, id %zu.", trx_id);
+    kaa_event_destroy(event);
+
+    return KAA_ERR_EVENT_TRX_NOT_FOUND;
+}
+
+/*
+ * Events sent outside a block are put into a block of their own, which is
+ * finished once the coalescing window is over or enough events are there.
+ */
+static kaa_error_t kaa_event_manager_coalesce_event(kaa_event_manager_t *self, kaa_event_t *event)
+{
+    if (!self->coalescing_window || self->coalescing_max_events == 1) {
+        return kaa_event_manager_queue_event(self, event);
+    }
+
+    if (!self->coalescing_trx) {
+        kaa_error_t error = kaa_event_create_transaction(self, &self->coalescing_trx);
+        if (error) {
+            kaa_event_destroy(event);
+            return error;
+        }
+        self->coalesced_events_count = 0;
+        self->coalescing_deadline = KAA_TIME() + (kaa_time_t)self->coalescing_window;
+    }
+
+    kaa_error_t error = kaa_event_manager_add_to_transaction(self, self->coalescing_trx, event);
+    if (error) {
+        return error;
+    }
+
+    if (self->coalescing_max_events && ++self->coalesced_events_count >= self->coalescing_max_events) {
+        return kaa_event_manager_flush_coalesced_events(self);
+    }
+
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_event_manager_flush_coalesced_events(kaa_event_manager_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+
+    if (!self->coalescing_trx) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_event_block_id trx_id = self->coalescing_trx;
+    self->coalescing_trx = 0;
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Syncing %zu coalesced events", self->coalesced_events_count);
+    return kaa_event_finish_transaction(self, trx_id);
+}
+
+kaa_error_t kaa_event_manager_set_coalescing_window(kaa_event_manager_t *self, size_t window, size_t max_events)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+
+    self->coalescing_window = window;
+    self->coalescing_max_events = max_events;
+
+    if (!window || (max_events && self->coalesced_events_count >= max_events)) {
+        return kaa_event_manager_flush_coalesced_events(self);
+    }
+    if (self->coalescing_trx) {
+        kaa_time_t deadline = KAA_TIME() + (kaa_time_t)window;
+        if (deadline < self->coalescing_deadline) {
+            self->coalescing_deadline = deadline;
+        }
+    }
+
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_event_manager_set_listeners_cache_ttl(kaa_event_manager_t *self, size_t ttl)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+
+    self->listeners_cache_ttl = ttl;
+    kaa_list_clear(self->event_listeners_cache, &destroy_listeners_cache_entry);
+    return KAA_ERR_NONE;
+}
+
+void kaa_event_manager_coalescing_timeout(kaa_event_manager_t *self)
+{
+    if (self && self->coalescing_trx && KAA_TIME() >= self->coalescing_deadline) {
+        kaa_event_manager_flush_coalesced_events(self);
+    }
+}
+
+size_t kaa_event_manager_get_coalescing_timeout(kaa_event_manager_t *self)
+{
+    if (!self || !self->coalescing_trx) {
+        return SIZE_MAX;
+    }
+
+    kaa_time_t now = KAA_TIME();
+    return now >= self->coalescing_deadline ? 0 : (size_t)(self->coalescing_deadline - now);
+}
+
 /*
  * @brief Adds a raw event to the transaction.
  *
@@ -1149,54 +1542,57 @@ kaa_error_t kaa_event_manager_add_event_to_transaction(kaa_event_manager_t *self
                                                      , kaa_endpoint_id_p target)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+    KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to add event to events batch, id %zu", trx_id);
+    kaa_event_t *event = kaa_event_create_raw(fqn, strlen(fqn), true, event_data, event_data_size, target);
+    KAA_RETURN_IF_NIL(event, KAA_ERR_NOMEM);
 
+    return kaa_event_manager_add_to_transaction(self, trx_id, event);
+}
+
+kaa_error_t kaa_event_manager_add_event_by_id_to_transaction(kaa_event_manager_t *self
+                                                           , kaa_event_block_id trx_id
+                                                           , kaa_event_fqn_id_t fqn_id
+                                                           , const char *event_data
+                                                           , size_t event_data_size
+                                                           , kaa_endpoint_id_p target)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(fqn_id);
     KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->transactions), &transaction_search_by_id_predicate, &trx_id);
-    if (it) {
-        /**
-         * KAA_CALLOC is really needed there.
-         */
-        kaa_event_t *event = (kaa_event_t*)KAA_CALLOC(1, sizeof(kaa_event_t));
-        KAA_RETURN_IF_NIL(event, KAA_ERR_NOMEM);
-
-        kaa_error_t error = kaa_fill_event_structure(event
-                                                   , (size_t)-1
-                                                   , fqn
-                                                   , event_data
-                                                   , event_data_size
-                                                   , target);
-        if (error) {
-            kaa_event_destroy(event);
-            return error;
-        }
+    kaa_event_t *event = kaa_event_create_raw(fqn->fqn, fqn->fqn_length, false, event_data, event_data_size, target);
+    KAA_RETURN_IF_NIL(event, KAA_ERR_NOMEM);
 
-        event_transaction_t *trx = kaa_list_get_data(it);
-        if (!kaa_list_push_back(trx->events, event)) {
-            kaa_event_destroy(event);
-            return KAA_ERR_NOMEM;
-        }
+    return kaa_event_manager_add_to_transaction(self, trx_id, event);
+}
 
-        return KAA_ERR_NONE;
-    }
+kaa_error_t kaa_event_manager_add_record_by_id_to_transaction(kaa_event_manager_t *self
+                                                            , kaa_event_block_id trx_id
+                                                            , kaa_event_fqn_id_t fqn_id
+                                                            , void *record
+                                                            , serialize_fn serialize
+                                                            , size_t record_size
+                                                            , kaa_endpoint_id_p target)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOT_INITIALIZED);
+    KAA_RETURN_IF_NIL2(record, serialize, KAA_ERR_BADPARAM);
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(fqn_id);
+    KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Can not add event to events batch, id %zu.", trx_id);
+    kaa_event_t *event = kaa_event_create_from_record(fqn, record, serialize, record_size, target);
+    KAA_RETURN_IF_NIL(event, KAA_ERR_NOMEM);
 
-    return KAA_ERR_EVENT_TRX_NOT_FOUND;
+    return kaa_event_manager_add_to_transaction(self, trx_id, event);
 }
 
 const char *kaa_find_class_family_name(const char *fqn)
 {
-    size_t i = 0;
-    while (SUPPORTED_EVENT_CLASS_FAMILIES_SIZE - i++) {
-        size_t fqn_count = SUPPORTED_EVENT_CLASS_FAMILIES[SUPPORTED_EVENT_CLASS_FAMILIES_SIZE - i].supported_incoming_fqns_count;
-        char **fqns = SUPPORTED_EVENT_CLASS_FAMILIES[SUPPORTED_EVENT_CLASS_FAMILIES_SIZE - i].supported_incoming_fqns;
-        while (fqn_count--) {
-            if (strcmp(fqn, fqns[fqn_count]) == 0) {
-                return SUPPORTED_EVENT_CLASS_FAMILIES[SUPPORTED_EVENT_CLASS_FAMILIES_SIZE - i].ecf_name;
-            }
+    KAA_RETURN_IF_NIL(fqn, NULL);
+    for (size_t id = 0; id < KAA_EVENT_FQNS_COUNT; ++id) {
+        const kaa_event_fqn_t *supported = kaa_event_fqn_get((kaa_event_fqn_id_t)id);
+        if (supported->incoming && !strcmp(fqn, supported->fqn)) {
+            return supported->ecf_name;
         }
     }
     return NULL;
@@ -44,6 +44,9 @@ typedef size_t kaa_event_block_id;
 /**
  * @brief Initiates a request to the server to search for available event listeners by given FQNs.
  *
+ * If the listeners of the same FQNs, in any order, were found within the listeners cache TTL and no endpoint
+ * was attached to or detached from the user since, the callback is called with them before this function
+ * returns and no request is sent. See @link kaa_event_manager_set_listeners_cache_ttl() @endlink.
  *
  * @param[in]       self                Valid pointer to the event manager instance.
  * @param[in]       fqns                List of FQN strings.
@@ -91,6 +94,44 @@ kaa_error_t kaa_event_finish_transaction(kaa_event_manager_t *self, kaa_event_bl
  */
 kaa_error_t kaa_event_remove_transaction(kaa_event_manager_t *self, kaa_event_block_id trx_id);
 
+/**
+ * @brief Sets the window in which the events sent outside a block are coalesced into one sync.
+ *
+ * The coalesced events are sent as a block once @p window seconds have passed since the first
+ * of them or once there are @p max_events of them, whichever comes first. Defaults to
+ * @c KAA_EVENT_COALESCING_WINDOW and @c KAA_EVENT_COALESCING_MAX_EVENTS.
+ *
+ * @param[in]       self                Valid pointer to the event manager instance.
+ * @param[in]       window              Time in seconds, @c 0 to sync each event right away.
+ * @param[in]       max_events          Amount of events, @c 0 if not limited.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_event_manager_set_coalescing_window(kaa_event_manager_t *self, size_t window, size_t max_events);
+
+/**
+ * @brief Sets for how long found event listeners are reused by @link kaa_event_manager_find_event_listeners() @endlink.
+ *
+ * The cache is dropped once an endpoint is attached to or detached from the user by this endpoint or
+ * the endpoint itself is attached or detached. Endpoints attached by others are noticed only after the TTL.
+ * Defaults to @c KAA_EVENT_LISTENERS_CACHE_TTL, at most @c KAA_EVENT_LISTENERS_CACHE_SIZE FQN lists are cached.
+ *
+ * @param[in]       self                Valid pointer to the event manager instance.
+ * @param[in]       ttl                 Time in seconds, @c 0 to disable the cache.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_event_manager_set_listeners_cache_ttl(kaa_event_manager_t *self, size_t ttl);
+
+/**
+ * @brief Sends the coalesced events without waiting for the coalescing window to be over.
+ *
+ * @param[in]       self                Valid pointer to the event manager instance.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_event_manager_flush_coalesced_events(kaa_event_manager_t *self);
+
 /**
  * @brief Find class family name of the event by its fully-qualified name.
  *
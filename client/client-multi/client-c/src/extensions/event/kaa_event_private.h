@@ -21,6 +21,8 @@
 #include <kaa_channel_manager.h>
 #include <utilities/kaa_log.h>
 #include <kaa_platform_utils.h>
+#include <kaa_common_schema.h>
+#include <gen/kaa_event_fqn_definitions.h>
 
 kaa_error_t kaa_event_manager_create(kaa_event_manager_t **event_manager_p, kaa_status_t *status,
         kaa_channel_manager_t *channel_manager, kaa_logger_t *logger);
@@ -34,6 +36,34 @@ kaa_error_t kaa_event_manager_add_event_to_transaction(kaa_event_manager_t *self
 kaa_error_t kaa_event_manager_add_on_event_callback(kaa_event_manager_t *self, const char *fqn,
     kaa_event_callback_t callback);
 
+/*
+ * Same as the above, for the FQNs of the generated event families. The FQN
+ * is referred to by its id and is never copied.
+ */
+kaa_error_t kaa_event_manager_send_event_by_id(kaa_event_manager_t *self, kaa_event_fqn_id_t fqn_id,
+    const char *event_data, size_t event_data_size, kaa_endpoint_id_p target);
+
+kaa_error_t kaa_event_manager_add_event_by_id_to_transaction(kaa_event_manager_t *self, kaa_event_block_id trx_id,
+    kaa_event_fqn_id_t fqn_id, const char *event_data, size_t event_data_size, kaa_endpoint_id_p target);
+
+/*
+ * Same as the above, with the record serialized straight into the event
+ * rather than into a buffer of its own. @p record_size is the size
+ * @p serialize writes.
+ */
+kaa_error_t kaa_event_manager_send_record_by_id(kaa_event_manager_t *self, kaa_event_fqn_id_t fqn_id,
+    void *record, serialize_fn serialize, size_t record_size, kaa_endpoint_id_p target);
+
+kaa_error_t kaa_event_manager_add_record_by_id_to_transaction(kaa_event_manager_t *self, kaa_event_block_id trx_id,
+    kaa_event_fqn_id_t fqn_id, void *record, serialize_fn serialize, size_t record_size, kaa_endpoint_id_p target);
+
+kaa_error_t kaa_event_manager_add_on_event_callback_by_id(kaa_event_manager_t *self, kaa_event_fqn_id_t fqn_id,
+    kaa_event_callback_t callback);
+
+void kaa_event_manager_coalescing_timeout(kaa_event_manager_t *self);
+/* Seconds until kaa_event_manager_coalescing_timeout() has anything to sync, SIZE_MAX if no events are coalesced */
+size_t kaa_event_manager_get_coalescing_timeout(kaa_event_manager_t *self);
+
 kaa_error_t kaa_event_request_get_size(kaa_event_manager_t *self, size_t *expected_size);
 kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t request_id,
         kaa_platform_message_writer_t *writer);
@@ -34,6 +34,7 @@
 #include "platform/sock.h"
 
 #include "kaa_private.h"
+#include "avro_src/avro/io.h"
 
 
 static int global_events_counter = 0;
@@ -195,6 +196,85 @@ void test_kaa_event_listeners_handle_sync(void **state)
     kaa_platform_message_reader_destroy(reader);
 }
 
+static void handle_listeners_response(uint16_t request_id)
+{
+    const uint32_t extension_size = 52;
+    uint8_t buffer[extension_size];
+
+    uint8_t *cursor = buffer;
+    *cursor = 0; // field id (0)
+    cursor += sizeof(uint16_t);
+    *((uint16_t *) cursor) = KAA_HTONS(1); // responses count = 1
+    cursor += sizeof(uint16_t);
+    *((uint16_t *) cursor) = KAA_HTONS(request_id);
+    cursor += sizeof(uint16_t);
+    *((uint16_t *) cursor) = KAA_HTONS(0); // SUCCESS
+    cursor += sizeof(uint16_t);
+    *((uint32_t *) cursor) = KAA_HTONL(2); // listener count = 2
+    cursor += sizeof(uint32_t);
+    memcpy(cursor, endpoint_id1, KAA_ENDPOINT_ID_LENGTH);
+    cursor += KAA_ENDPOINT_ID_LENGTH;
+    memcpy(cursor, endpoint_id2, KAA_ENDPOINT_ID_LENGTH);
+
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(buffer, extension_size);
+    ASSERT_EQUAL(kaa_event_handle_server_sync(event_manager, &reader, 0, extension_size, 1), KAA_ERR_NONE);
+}
+
+void test_kaa_event_listeners_cache(void **state)
+{
+    (void)state;
+    test_deinit();
+    test_init();
+
+    ASSERT_EQUAL(kaa_event_manager_set_listeners_cache_ttl(event_manager, 100), KAA_ERR_NONE);
+
+    size_t empty_size = 0;
+    ASSERT_EQUAL(kaa_event_request_get_size(event_manager, &empty_size), KAA_ERR_NONE);
+
+    const char *fqns[] = { "test.fqn1", "test.fqn2" };
+    const char *reordered_fqns[] = { "test.fqn2", "test.fqn1" };
+    kaa_event_listeners_callback_t callback = { NULL, &event_listeners_callback, &event_listeners_request_failed };
+
+    is_event_listeners_cb_called = false;
+    ASSERT_EQUAL(kaa_event_manager_find_event_listeners(event_manager, fqns, 2, &callback), KAA_ERR_NONE);
+    ASSERT_FALSE(is_event_listeners_cb_called);
+    handle_listeners_response(1);
+    ASSERT_TRUE(is_event_listeners_cb_called);
+
+    /* Found in the cache, no request is sent */
+    is_event_listeners_cb_called = false;
+    ASSERT_EQUAL(kaa_event_manager_find_event_listeners(event_manager, reordered_fqns, 2, &callback), KAA_ERR_NONE);
+    ASSERT_TRUE(is_event_listeners_cb_called);
+
+    size_t request_size = 0;
+    ASSERT_EQUAL(kaa_event_request_get_size(event_manager, &request_size), KAA_ERR_NONE);
+    ASSERT_EQUAL(request_size, empty_size);
+
+    /* Another subset of FQNs isn't found */
+    is_event_listeners_cb_called = false;
+    ASSERT_EQUAL(kaa_event_manager_find_event_listeners(event_manager, fqns, 1, &callback), KAA_ERR_NONE);
+    ASSERT_FALSE(is_event_listeners_cb_called);
+    handle_listeners_response(2);
+    ASSERT_TRUE(is_event_listeners_cb_called);
+
+    /* An endpoint attached to the user drops the cache */
+    ++status->user_endpoints_epoch;
+    is_event_listeners_cb_called = false;
+    ASSERT_EQUAL(kaa_event_manager_find_event_listeners(event_manager, fqns, 2, &callback), KAA_ERR_NONE);
+    ASSERT_FALSE(is_event_listeners_cb_called);
+    ASSERT_EQUAL(kaa_event_request_get_size(event_manager, &request_size), KAA_ERR_NONE);
+    ASSERT_TRUE(request_size > empty_size);
+
+    handle_listeners_response(3);
+    ASSERT_TRUE(is_event_listeners_cb_called);
+
+    /* Disabling the cache drops it */
+    ASSERT_EQUAL(kaa_event_manager_set_listeners_cache_ttl(event_manager, 0), KAA_ERR_NONE);
+    is_event_listeners_cb_called = false;
+    ASSERT_EQUAL(kaa_event_manager_find_event_listeners(event_manager, fqns, 2, &callback), KAA_ERR_NONE);
+    ASSERT_FALSE(is_event_listeners_cb_called);
+}
+
 void test_kaa_event_sync_get_size(void **state)
 {
     (void)state;
@@ -426,7 +506,226 @@ void test_event_sync_serialize(void **state)
     kaa_platform_message_writer_destroy(server_sync_writer);
 }
 
+void test_event_sync_serialize_by_id(void **state)
+{
+    (void)state;
+    test_deinit();
+    test_init();
+
+    kaa_error_t error_code;
+
+    const uint8_t event_field = 1;
+    const uint8_t reserved_field = 0;
+    uint16_t event_count = 1;
+
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAY_COMMAND);
+    ASSERT_NOT_NULL(fqn);
+    ASSERT_EQUAL(fqn->fqn_length, strlen(fqn->fqn));
+    ASSERT_NULL(kaa_event_fqn_get(KAA_EVENT_FQNS_COUNT));
+    ASSERT_EQUAL(strcmp(kaa_find_class_family_name(fqn->fqn), fqn->ecf_name), 0);
+
+    const size_t server_sync_buffer_size = sizeof(uint32_t);
+    uint8_t server_sync_buffer[server_sync_buffer_size];
+    uint32_t sequence_number = KAA_HTONL(12345);
+    memcpy(server_sync_buffer, &sequence_number, sizeof(uint32_t));
+    sequence_number = KAA_NTOHL(sequence_number);
+
+    kaa_platform_message_reader_t *server_sync_reader;
+    error_code = kaa_platform_message_reader_create(&server_sync_reader, server_sync_buffer, server_sync_buffer_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_event_handle_server_sync(event_manager, server_sync_reader, 0x1, sizeof(uint32_t), 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_event_manager_send_event_by_id(event_manager, KAA_EVENT_FQNS_COUNT, NULL, 0, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_EVENT_BAD_FQN);
+    error_code = kaa_event_manager_send_event_by_id(event_manager, KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAY_COMMAND, NULL, 0, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t event_sync_size = 0;
+    error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    uint8_t manual_buffer[event_sync_size];
+    uint8_t auto_buffer[event_sync_size];
 
+    kaa_platform_message_writer_t *manual_writer;
+    error_code = kaa_platform_message_writer_create(&manual_writer, manual_buffer, event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    kaa_platform_message_writer_t *auto_writer;
+    error_code = kaa_platform_message_writer_create(&auto_writer, auto_buffer, event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_platform_message_write_extension_header(manual_writer
+                                                           , KAA_EXTENSION_EVENT
+                                                           , 0x1
+                                                           , event_sync_size - KAA_EXTENSION_HEADER_SIZE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = kaa_platform_message_write(manual_writer, &event_field, sizeof(uint8_t));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = kaa_platform_message_write(manual_writer, &reserved_field, sizeof(uint8_t));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    event_count = KAA_HTONS(event_count);
+    error_code = kaa_platform_message_write(manual_writer, &event_count, sizeof(uint16_t));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = serialize_event(manual_writer, fqn->fqn, NULL, 0, NULL, ++sequence_number, true);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_event_request_serialize(event_manager, 1, auto_writer);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(memcmp(auto_buffer, manual_buffer, KAA_EXTENSION_HEADER_SIZE), 0);
+    ASSERT_EQUAL(auto_buffer[KAA_EXTENSION_HEADER_SIZE], manual_buffer[KAA_EXTENSION_HEADER_SIZE]);
+
+    size_t events_offset = KAA_EXTENSION_HEADER_SIZE + sizeof(uint16_t);
+    ASSERT_EQUAL(memcmp(auto_buffer + events_offset, manual_buffer + events_offset,
+            event_sync_size - events_offset), 0);
+
+    kaa_platform_message_writer_destroy(manual_writer);
+    kaa_platform_message_writer_destroy(auto_writer);
+    kaa_platform_message_reader_destroy(server_sync_reader);
+}
+
+static const char record_data[] = { 1, 2, 3, 4, 5 };
+
+static void serialize_record(avro_writer_t writer, void *data)
+{
+    avro_write(writer, data, sizeof(record_data));
+}
+
+void test_event_sync_serialize_record(void **state)
+{
+    (void)state;
+    test_deinit();
+    test_init();
+
+    kaa_error_t error_code;
+
+    const kaa_event_fqn_t *fqn = kaa_event_fqn_get(KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAY_COMMAND);
+
+    uint8_t server_sync_buffer[sizeof(uint32_t)];
+    uint32_t sequence_number = KAA_HTONL(12345);
+    memcpy(server_sync_buffer, &sequence_number, sizeof(uint32_t));
+    sequence_number = KAA_NTOHL(sequence_number);
+
+    kaa_platform_message_reader_t server_sync_reader = KAA_MESSAGE_READER(server_sync_buffer, sizeof(uint32_t));
+    error_code = kaa_event_handle_server_sync(event_manager, &server_sync_reader, 0x1, sizeof(uint32_t), 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_event_manager_send_record_by_id(event_manager, KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAY_COMMAND,
+            (void *)record_data, &serialize_record, sizeof(record_data), endpoint_id1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t event_sync_size = 0;
+    error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    uint8_t manual_buffer[event_sync_size];
+    uint8_t auto_buffer[event_sync_size];
+
+    kaa_platform_message_writer_t manual_writer = KAA_MESSAGE_WRITER(manual_buffer, event_sync_size);
+    error_code = kaa_platform_message_write_extension_header(&manual_writer
+                                                           , KAA_EXTENSION_EVENT
+                                                           , 0x1
+                                                           , event_sync_size - KAA_EXTENSION_HEADER_SIZE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    uint16_t event_count = KAA_HTONS(1);
+    uint16_t event_field = 1;
+    error_code = kaa_platform_message_write(&manual_writer, &event_field, sizeof(uint16_t));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = kaa_platform_message_write(&manual_writer, &event_count, sizeof(uint16_t));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = serialize_event(&manual_writer, fqn->fqn, record_data, sizeof(record_data), endpoint_id1,
+            ++sequence_number, true);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t size = event_sync_size;
+    bool need_resync = false;
+    error_code = kaa_extension_event_request_serialize(event_manager, 1, auto_buffer, &size, &need_resync);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(size, event_sync_size);
+
+    size_t events_offset = KAA_EXTENSION_HEADER_SIZE + sizeof(uint16_t);
+    ASSERT_EQUAL(memcmp(auto_buffer, manual_buffer, KAA_EXTENSION_HEADER_SIZE), 0);
+    ASSERT_EQUAL(memcmp(auto_buffer + events_offset, manual_buffer + events_offset,
+            event_sync_size - events_offset), 0);
+
+    /* Not acknowledged yet, so the event is sent again, its data right from the event */
+    kaa_platform_message_splice_t splice_items[1];
+    kaa_platform_message_splices_t splices = { splice_items, 0, 1, 0 };
+    size = event_sync_size;
+    error_code = kaa_extension_event_request_serialize_spliced(event_manager, 2, auto_buffer, &size,
+            &splices, &need_resync);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(splices.count, 1);
+    ASSERT_EQUAL(splices.size, kaa_aligned_size_get(sizeof(record_data)));
+    ASSERT_EQUAL(size + splices.size, event_sync_size);
+    ASSERT_EQUAL(splice_items[0].position, auto_buffer + size);
+    ASSERT_EQUAL(memcmp(splice_items[0].data, record_data, sizeof(record_data)), 0);
+    ASSERT_EQUAL(memcmp(auto_buffer + events_offset, manual_buffer + events_offset, size - events_offset), 0);
+}
+
+
+
+void test_event_coalescing(void **state)
+{
+    (void)state;
+    test_deinit();
+    test_init();
+
+    uint8_t server_sync_buffer[sizeof(uint32_t)] = { 0 };
+    kaa_platform_message_reader_t server_sync_reader = KAA_MESSAGE_READER(server_sync_buffer, sizeof(uint32_t));
+    kaa_error_t error_code = kaa_event_handle_server_sync(event_manager, &server_sync_reader, 0x1, sizeof(uint32_t), 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t empty_sync_size = 0;
+    error_code = kaa_event_request_get_size(event_manager, &empty_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_event_manager_set_coalescing_window(event_manager, 100, 3);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_event_manager_get_coalescing_timeout(event_manager), SIZE_MAX);
+
+    size_t event_sync_size = 0;
+    for (int i = 0; i < 2; ++i) {
+        error_code = kaa_event_manager_send_event(event_manager, "test fqn", NULL, 0, NULL);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+        error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+        ASSERT_EQUAL(event_sync_size, empty_sync_size);
+    }
+    ASSERT_TRUE(kaa_event_manager_get_coalescing_timeout(event_manager) <= 100);
+
+    /* Not due yet */
+    kaa_event_manager_coalescing_timeout(event_manager);
+    error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(event_sync_size, empty_sync_size);
+
+    /* The third event completes the batch */
+    error_code = kaa_event_manager_send_event(event_manager, "test fqn", NULL, 0, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_event_manager_get_coalescing_timeout(event_manager), SIZE_MAX);
+
+    size_t batch_sync_size = 0;
+    error_code = kaa_event_request_get_size(event_manager, &batch_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(batch_sync_size > empty_sync_size);
+
+    /* Closing the window syncs what has been coalesced so far */
+    error_code = kaa_event_manager_send_event(event_manager, "test fqn", NULL, 0, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(event_sync_size, batch_sync_size);
+
+    error_code = kaa_event_manager_set_coalescing_window(event_manager, 0, 0);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = kaa_event_request_get_size(event_manager, &event_sync_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(event_sync_size > batch_sync_size);
+    ASSERT_EQUAL(kaa_event_manager_get_coalescing_timeout(event_manager), SIZE_MAX);
+}
 
 void global_event_cb(const char *fqn, const char *data, size_t size, kaa_endpoint_id_p source)
 {
@@ -653,7 +952,11 @@ KAA_SUITE_MAIN(Event, test_init, test_deinit,
         KAA_TEST_CASE(create_event_manager, test_kaa_create_event_manager)
         KAA_TEST_CASE(compile_event_request, test_kaa_event_sync_get_size)
         KAA_TEST_CASE(event_sync_serialize, test_event_sync_serialize)
+        KAA_TEST_CASE(event_sync_serialize_by_id, test_event_sync_serialize_by_id)
+        KAA_TEST_CASE(event_sync_serialize_record, test_event_sync_serialize_record)
         KAA_TEST_CASE(add_on_event_callback, test_kaa_server_sync_with_event_callbacks)
         KAA_TEST_CASE(event_listeners_serialize_request, test_kaa_event_listeners_serialize_request)
         KAA_TEST_CASE(event_listeners_handle_sync, test_kaa_event_listeners_handle_sync)
-        KAA_TEST_CASE(event_test_blocks, test_event_blocks))
+        KAA_TEST_CASE(event_listeners_cache, test_kaa_event_listeners_cache)
+        KAA_TEST_CASE(event_test_blocks, test_event_blocks)
+        KAA_TEST_CASE(event_coalescing, test_event_coalescing))
@@ -39,6 +39,18 @@
 #define KAA_LOGGING_RECEIVE_UPDATES_FLAG   0x01
 #define KAA_MAX_PADDING_LENGTH             (KAA_ALIGNMENT - 1)
 
+#ifndef KAA_MAX_PENDING_LOG_BUCKETS
+/** Buckets awaiting delivery status at once, caps the parallel uploads of the strategy */
+#define KAA_MAX_PENDING_LOG_BUCKETS        8
+#endif
+
+#ifdef KAA_FILE_LOG_STORAGE
+/* The file log storage reads the records through a small window that the next record may reuse */
+#define KAA_LOG_STORAGE_KEEPS_RECORDS      false
+#else
+#define KAA_LOG_STORAGE_KEEPS_RECORDS      true
+#endif
+
 typedef enum {
     LOGGING_RESULT_SUCCESS = 0x00,
     LOGGING_RESULT_FAILURE = 0x01
@@ -49,7 +61,7 @@ typedef struct {
      *  Already expired buckets marked with deadline equal to 0.
      */
     kaa_time_t   deadline;
-    uint16_t     log_bucket_id;     /**< ID of bucket present in storage. */
+    uint16_t     log_bucket_id;     /**< ID of bucket present in storage, 0 for a free slot. */
     uint16_t     log_count;         /**< Current logs count. */
 } timeout_info_t;
 
@@ -66,12 +78,15 @@ struct kaa_log_collector_t {
     kaa_status_t                   *status;
     kaa_channel_manager_t          *channel_manager;
     kaa_logger_t                   *logger;
-    kaa_list_t                     *timeouts;
+    timeout_info_t                 timeouts[KAA_MAX_PENDING_LOG_BUCKETS]; /**< Slot probing starts at log_bucket_id */
+    size_t                         timeouts_count;
     kaa_log_delivery_listener_t    log_delivery_listeners;
     bool                           is_sync_ignored;
     uint32_t                       log_last_id;         /**< Last log record ID */
     uint16_t                       log_bucket_id;
     last_bucket_info_t             last_bucket;
+    char                           *record_buffer;      /**< Log records are serialized here first */
+    size_t                         record_buffer_size;
 };
 
 static const kaa_extension_id logging_sync_services[] = {KAA_EXTENSION_LOGGING};
@@ -96,11 +111,9 @@ kaa_error_t kaa_extension_logging_request_get_size(void *context, size_t *expect
     return kaa_logging_request_get_size(context, expected_size);
 }
 
-kaa_error_t kaa_extension_logging_request_serialize(void *context, uint32_t request_id,
-        uint8_t *buffer, size_t *size, bool *need_resync)
+static kaa_error_t logging_request_serialize(void *context, uint8_t *buffer, size_t *size,
+        kaa_platform_message_splices_t *splices, bool *need_resync)
 {
-    (void)request_id;
-
     // TODO(KAA-982): Use asserts
     if (!context || !size || !need_resync) {
         return KAA_ERR_BADPARAM;
@@ -133,6 +146,7 @@ kaa_error_t kaa_extension_logging_request_serialize(void *context, uint32_t requ
     *size = size_needed;
 
     kaa_platform_message_writer_t writer = KAA_MESSAGE_WRITER(buffer, *size);
+    writer.splices = splices;
     error = kaa_logging_request_serialize(context, &writer);
     if (error) {
         return error;
@@ -142,6 +156,20 @@ kaa_error_t kaa_extension_logging_request_serialize(void *context, uint32_t requ
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_extension_logging_request_serialize(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, bool *need_resync)
+{
+    (void)request_id;
+    return logging_request_serialize(context, buffer, size, NULL, need_resync);
+}
+
+kaa_error_t kaa_extension_logging_request_serialize_spliced(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync)
+{
+    (void)request_id;
+    return logging_request_serialize(context, buffer, size, splices, need_resync);
+}
+
 kaa_error_t kaa_extension_logging_server_sync(void *context, uint32_t request_id,
         uint16_t extension_options, const uint8_t *buffer, size_t size)
 {
@@ -172,6 +200,27 @@ kaa_error_t kaa_logging_need_logging_resync(kaa_log_collector_t *self, bool *res
     return KAA_ERR_NONE;
 }
 
+/*
+ * Returns the slot of the bucket, or the first free slot on its probe sequence if
+ * the bucket is unknown. The slots of buckets sent one after another don't collide.
+ */
+static timeout_info_t *find_timeout(kaa_log_collector_t *self, uint16_t bucket_id)
+{
+    timeout_info_t *free_slot = NULL;
+
+    for (size_t i = 0; i < KAA_MAX_PENDING_LOG_BUCKETS; ++i) {
+        timeout_info_t *info = &self->timeouts[(bucket_id + i) % KAA_MAX_PENDING_LOG_BUCKETS];
+        if (info->log_bucket_id == bucket_id) {
+            return info;
+        }
+        if (!info->log_bucket_id && !free_slot) {
+            free_slot = info;
+        }
+    }
+
+    return free_slot;
+}
+
 static kaa_error_t remember_request(kaa_log_collector_t *self, uint16_t bucket_id, uint16_t count)
 {
     // TODO(KAA-982): Use asserts
@@ -179,59 +228,39 @@ static kaa_error_t remember_request(kaa_log_collector_t *self, uint16_t bucket_i
         return KAA_ERR_BADPARAM;
     }
 
-    timeout_info_t *info = KAA_MALLOC(sizeof(*info));
+    timeout_info_t *info = find_timeout(self, bucket_id);
     if (!info) {
         return KAA_ERR_NOMEM;
     }
 
+    if (!info->log_bucket_id) {
+        ++self->timeouts_count;
+    }
+
     info->log_bucket_id = bucket_id;
     info->deadline = KAA_TIME() + (kaa_time_t)ext_log_upload_strategy_get_timeout(self->log_upload_strategy_context);
     info->log_count = count;
 
-    kaa_list_node_t *it = kaa_list_push_back(self->timeouts, info);
-    if (!it) {
-        KAA_FREE(info);
-        return KAA_ERR_NOMEM;
-    }
-
     return KAA_ERR_NONE;
 }
 
-static bool find_by_bucket_id(void *data, void *context)
+static void clear_timeouts(kaa_log_collector_t *self)
 {
-    // TODO(KAA-982): Use asserts
-    if (!data || !context) {
-        return false;
-    }
-
-    uint16_t bucket_id = *(uint16_t *) context;
-    timeout_info_t *timeout_info = data;
-
-    if (timeout_info->log_bucket_id == bucket_id) {
-        return true;
-    }
-
-    return false;
+    memset(self->timeouts, 0, sizeof(self->timeouts));
+    self->timeouts_count = 0;
 }
 
 
 /* Returns amount of logs in bucket */
 static size_t remove_request(kaa_log_collector_t *self, uint16_t bucket_id)
 {
-    kaa_list_node_t     *node;
-    timeout_info_t      *info;
-    size_t              logs_sent = 0;
-
-    node = kaa_list_find_next(kaa_list_begin(self->timeouts), find_by_bucket_id, &bucket_id);
-
-    if (node) {
-        info = kaa_list_get_data(node);
-
-        if (info) {
-            logs_sent = info->log_count;
-        }
+    size_t logs_sent = 0;
 
-        kaa_list_remove_at(self->timeouts, node, NULL);
+    timeout_info_t *info = find_timeout(self, bucket_id);
+    if (info && info->log_bucket_id) {
+        logs_sent = info->log_count;
+        info->log_bucket_id = 0;
+        --self->timeouts_count;
     }
 
     return logs_sent;
@@ -241,7 +270,7 @@ static size_t remove_request(kaa_log_collector_t *self, uint16_t bucket_id)
 static void handle_timeout(kaa_log_collector_t *self)
 {
     // TODO(KAA-982): Use asserts
-    if (!self || !self->timeouts) {
+    if (!self) {
         return;
     }
 
@@ -256,8 +285,11 @@ static void handle_timeout(kaa_log_collector_t *self)
         KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Access point has been switched. All buckets are expired.");
     }
 
-    for (kaa_list_node_t *it = kaa_list_begin(self->timeouts); it; it = kaa_list_next(it)) {
-        timeout_info_t *info = kaa_list_get_data(it);
+    for (size_t i = 0; i < KAA_MAX_PENDING_LOG_BUCKETS; ++i) {
+        timeout_info_t *info = &self->timeouts[i];
+        if (!info->log_bucket_id) {
+            continue;
+        }
 
         if (expire_every_entry || !info->deadline) {
             ext_log_storage_unmark_by_bucket_id(self->log_storage_context, info->log_bucket_id);
@@ -273,7 +305,7 @@ static void handle_timeout(kaa_log_collector_t *self)
         }
     }
 
-    kaa_list_clear(self->timeouts, NULL);
+    clear_timeouts(self);
 }
 
 static bool is_timeout(kaa_log_collector_t *self)
@@ -281,9 +313,9 @@ static bool is_timeout(kaa_log_collector_t *self)
     kaa_time_t now = KAA_TIME();
     bool timeout_occur = false;
 
-    for (kaa_list_node_t *it = kaa_list_begin(self->timeouts); it; it = kaa_list_next(it)) {
-        timeout_info_t *info = kaa_list_get_data(it);
-        if (now >= info->deadline) {
+    for (size_t i = 0; i < KAA_MAX_PENDING_LOG_BUCKETS; ++i) {
+        timeout_info_t *info = &self->timeouts[i];
+        if (info->log_bucket_id && now >= info->deadline) {
             KAA_LOG_ERROR(self->logger, KAA_ERR_TIMEOUT,
                     "Log delivery timeout occurred (bucket_id %u)", info->log_bucket_id);
             timeout_occur = true;
@@ -297,9 +329,13 @@ static bool is_timeout(kaa_log_collector_t *self)
 
 static bool is_upload_allowed(kaa_log_collector_t *self)
 {
-    size_t pendingCount = kaa_list_get_size(self->timeouts);
+    size_t pendingCount = self->timeouts_count;
     size_t allowedCount = ext_log_upload_strategy_get_max_parallel_uploads(self->log_upload_strategy_context);
 
+    if (allowedCount > KAA_MAX_PENDING_LOG_BUCKETS) {
+        allowedCount = KAA_MAX_PENDING_LOG_BUCKETS;
+    }
+
     if (pendingCount >= allowedCount) {
         KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Ignore log upload: too much pending requests %zu, max allowed %zu",
                 pendingCount,  allowedCount);
@@ -319,7 +355,7 @@ void kaa_log_collector_destroy(kaa_log_collector_t *self)
 
     ext_log_upload_strategy_destroy(self->log_upload_strategy_context);
     ext_log_storage_destroy(self->log_storage_context);
-    kaa_list_destroy(self->timeouts, NULL);
+    KAA_FREE(self->record_buffer);
     KAA_FREE(self);
 }
 
@@ -348,16 +384,14 @@ kaa_error_t kaa_log_collector_create(kaa_log_collector_t **log_collector_p,
     collector->last_bucket.log_count            = 0;
     collector->last_bucket.size                 = 0;
     collector->last_bucket.id                   = 1;
+    collector->record_buffer                    = NULL;
+    collector->record_buffer_size               = 0;
 
     /* Must be overriden in _init() */
     collector->bucket_size.max_bucket_log_count = 0;
     collector->bucket_size.max_bucket_size      = 0;
 
-    collector->timeouts = kaa_list_create();
-    if (!collector->timeouts) {
-        KAA_FREE(collector);
-        return KAA_ERR_NOMEM;
-    }
+    clear_timeouts(collector);
 
     *log_collector_p = collector;
     return KAA_ERR_NONE;
@@ -496,6 +530,37 @@ static void place_record_in_next_bucket(kaa_log_collector_t *self, kaa_log_recor
     place_record_in_current_bucket(self, new_record);
 }
 
+/*
+ * Serializes the log entry into the record buffer, walking it once. The writer counts
+ * the bytes past the end of the buffer, so a record that doesn't fit is written again
+ * into a buffer of the exact size.
+ */
+static kaa_error_t serialize_log_entry(kaa_log_collector_t *self, kaa_user_log_record_t *entry, size_t *size)
+{
+    for (;;) {
+        struct avro_writer_t_ writer = {
+            .buf = self->record_buffer,
+            .len = self->record_buffer_size,
+            .written = 0,
+        };
+
+        entry->serialize(&writer, entry);
+
+        *size = (size_t)writer.written;
+        if (*size <= self->record_buffer_size) {
+            return KAA_ERR_NONE;
+        }
+
+        char *buffer = KAA_REALLOC(self->record_buffer, *size);
+        if (!buffer) {
+            return KAA_ERR_NOMEM;
+        }
+
+        self->record_buffer = buffer;
+        self->record_buffer_size = *size;
+    }
+}
+
 kaa_error_t kaa_logging_add_record(kaa_log_collector_t *self, kaa_user_log_record_t *entry, kaa_log_record_info_t *log_info)
 {
     // TODO(KAA-982): Use asserts
@@ -511,10 +576,17 @@ kaa_error_t kaa_logging_add_record(kaa_log_collector_t *self, kaa_user_log_recor
     // Bucket ID will be incremented only if it will be added without errors
     kaa_log_record_t record = {
         .data = NULL,
-        .size = entry->get_size(entry),
+        .size = 0,
         .bucket_id = 0,
     };
 
+    kaa_error_t error = serialize_log_entry(self, entry, &record.size);
+    if (error) {
+        KAA_LOG_ERROR(self->logger, error,
+                "Failed to add log record: cannot allocate serialization buffer");
+        return error;
+    }
+
     if (!record.size) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_BADDATA,
                 "Failed to add log record: serialized record size is null. "
@@ -534,7 +606,7 @@ kaa_error_t kaa_logging_add_record(kaa_log_collector_t *self, kaa_user_log_recor
         place_record_in_current_bucket(self, &record);
     }
 
-    kaa_error_t error = ext_log_storage_allocate_log_record_buffer(self->log_storage_context,
+    error = ext_log_storage_allocate_log_record_buffer(self->log_storage_context,
             &record);
     if (error) {
         KAA_LOG_ERROR(self->logger, error,
@@ -542,17 +614,7 @@ kaa_error_t kaa_logging_add_record(kaa_log_collector_t *self, kaa_user_log_recor
         goto err_buffer;
     }
 
-    avro_writer_t writer = avro_writer_memory((char *)record.data, record.size);
-    if (!writer) {
-        error = KAA_ERR_NOMEM;
-        KAA_LOG_ERROR(self->logger, error,
-                "Failed to add log record: cannot create serializer");
-        ext_log_storage_deallocate_log_record_buffer(self->log_storage_context, &record);
-        goto err_avro;
-    }
-
-    entry->serialize(writer, entry);
-    avro_writer_free(writer);
+    memcpy(record.data, self->record_buffer, record.size);
 
     error = ext_log_storage_add_log_record(self->log_storage_context, &record);
     if (error) {
@@ -579,7 +641,6 @@ kaa_error_t kaa_logging_add_record(kaa_log_collector_t *self, kaa_user_log_recor
     return KAA_ERR_NONE;
 
 err_add:
-err_avro:
     ext_log_storage_deallocate_log_record_buffer(self->log_storage_context, &record);
 err_buffer:
     self->last_bucket = fallback;
@@ -686,29 +747,55 @@ kaa_error_t kaa_logging_request_serialize(kaa_log_collector_t *self, kaa_platfor
             "Extracting log records... (bucket size %zu)", bucket_size);
 
     uint16_t records_count = 0;
+    size_t spliced_size = 0;
 
     while (!error && bucket_size > sizeof(uint32_t) && records_count < max_log_count) {
         size_t record_len = 0;
-        error = ext_log_storage_write_next_record(self->log_storage_context,
-                (char *)tmp_writer.current + sizeof(uint32_t),
-                bucket_size - sizeof(uint32_t),
-                &bucket_id,
-                &record_len);
+        const char *record_data = NULL;
+        if (tmp_writer.splices && KAA_LOG_STORAGE_KEEPS_RECORDS) {
+            // The record is left in the storage, it is sent from there
+            error = ext_log_storage_get_next_record(self->log_storage_context,
+                    bucket_size - sizeof(uint32_t),
+                    &record_data,
+                    &bucket_id,
+                    &record_len);
+        } else {
+            error = ext_log_storage_write_next_record(self->log_storage_context,
+                    (char *)tmp_writer.current + sizeof(uint32_t),
+                    bucket_size - sizeof(uint32_t),
+                    &bucket_id,
+                    &record_len);
+        }
 
         switch (error) {
             case KAA_ERR_NONE:
                 if (first_bucket == 0) {
                     first_bucket = bucket_id;
                 } else if (bucket_id != first_bucket) {
-                    // Put back log item if it is in another bucket
+                    // Put back log item if it is in another bucket, it opens the next upload
                     ext_log_storage_unmark_by_bucket_id(self->log_storage_context, bucket_id);
+                    error = KAA_ERR_NOT_FOUND;
                     break;
                 }
 
                 ++records_count;
                 *((uint32_t *) tmp_writer.current) = KAA_HTONL(record_len);
-                tmp_writer.current += (sizeof(uint32_t) + record_len);
-                kaa_platform_message_write_alignment(&tmp_writer);
+                tmp_writer.current += sizeof(uint32_t);
+                if (record_data) {
+                    bool spliced = false;
+                    error = kaa_platform_message_write_aligned_spliced(&tmp_writer,
+                            record_data, record_len, &spliced);
+                    if (error) {
+                        KAA_LOG_ERROR(self->logger, error, "Failed to write the log record");
+                        return error;
+                    }
+                    if (spliced) {
+                        spliced_size += kaa_aligned_size_get(record_len);
+                    }
+                } else {
+                    tmp_writer.current += record_len;
+                    kaa_platform_message_write_alignment(&tmp_writer);
+                }
                 bucket_size -= kaa_aligned_size_get(record_len) + sizeof(uint32_t);
                 break;
             case KAA_ERR_NOT_FOUND:
@@ -727,7 +814,7 @@ kaa_error_t kaa_logging_request_serialize(kaa_log_collector_t *self, kaa_platfor
 
     *((uint16_t *) bucket_id_p) = KAA_HTONS(first_bucket);
 
-    size_t payload_size = tmp_writer.current - writer->current - KAA_EXTENSION_HEADER_SIZE;
+    size_t payload_size = tmp_writer.current - writer->current - KAA_EXTENSION_HEADER_SIZE + spliced_size;
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
             "Created log bucket: id '%u', log records count %u, payload size %zu",
             first_bucket, records_count, payload_size);
@@ -746,6 +833,11 @@ kaa_error_t kaa_logging_request_serialize(kaa_log_collector_t *self, kaa_platfor
         form_new_bucket(self);
     }
 
+    // Backlog is uploaded by the following syncs without waiting for this one to be acknowledged
+    if (ext_log_storage_get_records_count(self->log_storage_context)) {
+        update_storage(self);
+    }
+
     return KAA_ERR_NONE;
 }
 
@@ -833,12 +925,48 @@ kaa_error_t kaa_logging_handle_server_sync(kaa_log_collector_t *self,
 }
 
 
+size_t ext_log_upload_get_next_timeout(kaa_log_collector_t *self)
+{
+    // TODO(KAA-982): Use asserts
+    if (!self || !self->log_upload_strategy_context) {
+        return SIZE_MAX;
+    }
+
+    size_t next_timeout = ext_log_upload_strategy_get_decision_delay(self->log_upload_strategy_context);
+    kaa_time_t now = KAA_TIME();
+
+    for (size_t i = 0; i < KAA_MAX_PENDING_LOG_BUCKETS; ++i) {
+        timeout_info_t *info = &self->timeouts[i];
+        /* Expired buckets are already reported */
+        if (!info->log_bucket_id || !info->deadline) {
+            continue;
+        }
+
+        if (info->deadline <= now) {
+            return 0;
+        }
+
+        if ((size_t)(info->deadline - now) < next_timeout) {
+            next_timeout = (size_t)(info->deadline - now);
+        }
+    }
+
+    return next_timeout;
+}
+
 void ext_log_upload_timeout(kaa_log_collector_t *self)
 {
+    // Adding and delivering logs update the storage on their own, only deadlines are checked here
+    if (ext_log_upload_get_next_timeout(self)) {
+        return;
+    }
+
     if (!is_timeout(self)
             || ext_log_upload_strategy_is_timeout_strategy(self->log_upload_strategy_context)) {
         update_storage(self);
     } else {
         handle_timeout(self);
+        // Expired buckets are to be uploaded again
+        update_storage(self);
     }
 }
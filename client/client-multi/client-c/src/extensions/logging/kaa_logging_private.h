@@ -34,12 +34,15 @@ kaa_error_t kaa_logging_request_serialize(kaa_log_collector_t *self,
 kaa_error_t kaa_logging_handle_server_sync(kaa_log_collector_t *self, kaa_platform_message_reader_t *reader, uint16_t extension_options, size_t extension_length);
 
 void ext_log_upload_timeout(kaa_log_collector_t *self);
-void ext_log_upload_timeout(kaa_log_collector_t *self);
+/* Seconds until ext_log_upload_timeout() has anything to check, SIZE_MAX if nothing is scheduled */
+size_t ext_log_upload_get_next_timeout(kaa_log_collector_t *self);
 bool ext_log_upload_strategy_is_timeout_strategy(void *strategy);
 
 kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger);
 kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger,
         size_t storage_size, size_t percent_to_delete);
+kaa_error_t ext_ring_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger,
+        void *ring, size_t capacity);
 kaa_error_t ext_log_storage_destroy(void *context);
 
 #endif /* KAA_LOGGING_PRIVATE_H */
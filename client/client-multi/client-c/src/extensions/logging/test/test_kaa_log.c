@@ -64,6 +64,8 @@ typedef struct {
     size_t max_parallel_uploads;
     int on_timeout_count;
     int on_failure_count;
+    int decide_count;
+    size_t decision_delay;
     ext_log_upload_decision_t decision;
     kaa_error_t timeout_retval; // Return value when timeout event hits
 } mock_strategy_context_t;
@@ -156,9 +158,15 @@ ext_log_upload_decision_t ext_log_upload_strategy_decide(void *context,
         const void *log_storage_context)
 {
     (void)log_storage_context;
+    ((mock_strategy_context_t *)context)->decide_count++;
     return ((mock_strategy_context_t *)context)->decision;
 }
 
+size_t ext_log_upload_strategy_get_decision_delay(void *context)
+{
+    return ((mock_strategy_context_t *)context)->decision_delay;
+}
+
 size_t ext_log_upload_strategy_get_timeout(void *context)
 {
     return ((mock_strategy_context_t *)context)->timeout;
@@ -281,6 +289,32 @@ kaa_error_t ext_log_storage_write_next_record(void *context, char *buffer, size_
     return KAA_ERR_NONE;
 }
 
+kaa_error_t ext_log_storage_get_next_record(void *context, size_t max_len, const char **data,
+        uint16_t *bucket_id, size_t *record_len)
+{
+    mock_storage_context_t *self = context;
+    KAA_RETURN_IF_NIL2(self, self->logs, KAA_ERR_NOT_FOUND);
+
+    kaa_list_node_t *node = kaa_list_find_next(kaa_list_begin(self->logs),
+            match_unprocessed, NULL);
+
+    if (!node) {
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    test_log_record_t *record = kaa_list_get_data(node);
+
+    if (max_len < record->rec.size) {
+        return KAA_ERR_INSUFFICIENT_BUFFER;
+    }
+
+    *record_len = record->rec.size;
+    *bucket_id = record->rec.bucket_id;
+    *data = record->rec.data;
+    record->processed = true;
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_id)
 {
     (void)bucket_id;
@@ -401,6 +435,72 @@ void test_create_request(void **state)
 
 
 
+void test_create_spliced_request(void **state)
+{
+    (void)state;
+
+    kaa_user_log_record_t *test_log_record = kaa_test_log_record_create();
+    test_log_record->data = kaa_string_copy_create(TEST_LOG_BUFFER);
+    size_t test_log_record_size = test_log_record->get_size(test_log_record);
+
+    kaa_log_collector_t *log_collector = NULL;
+    kaa_error_t error_code = kaa_log_collector_create(&log_collector, status,
+            channel_manager, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    mock_strategy_context_t strategy;
+    memset(&strategy, 0, sizeof(mock_strategy_context_t));
+    strategy.decision = NOOP;
+    strategy.max_parallel_uploads = UINT32_MAX;
+
+    kaa_log_bucket_constraints_t constraints = {
+        .max_bucket_size = 2 * test_log_record_size,
+        .max_bucket_log_count = UINT32_MAX,
+    };
+
+    mock_storage_context_t *storage = create_mock_storage();
+    error_code = kaa_logging_init(log_collector, storage, &strategy, &constraints);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_logging_add_record(log_collector, test_log_record, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t expected_size = 0;
+    error_code = kaa_logging_request_get_size(log_collector, &expected_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    kaa_platform_message_splice_t splice_items[1];
+    kaa_platform_message_splices_t splices = { splice_items, 0, 1, 0 };
+
+    uint8_t buffer[expected_size];
+    kaa_platform_message_writer_t writer = KAA_MESSAGE_WRITER(buffer, expected_size);
+    writer.splices = &splices;
+
+    error_code = kaa_logging_request_serialize(log_collector, &writer);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    /* Only the record length is in the buffer, the record itself is left in the storage */
+    ASSERT_EQUAL(writer.current - buffer, KAA_EXTENSION_HEADER_SIZE + 2 * sizeof(uint32_t));
+    ASSERT_EQUAL(splices.count, 1);
+    ASSERT_EQUAL(splices.size, kaa_aligned_size_get(test_log_record_size));
+
+    test_log_record_t *stored = kaa_list_get_data(kaa_list_begin(storage->logs));
+    ASSERT_TRUE(splice_items[0].data == stored->rec.data);
+    ASSERT_TRUE(splice_items[0].position == writer.current);
+    ASSERT_EQUAL(splice_items[0].size, test_log_record_size);
+    ASSERT_EQUAL(splice_items[0].size + splice_items[0].padding, splices.size);
+
+    /* The extension length covers the spliced record */
+    ASSERT_EQUAL(*(uint32_t *)(buffer + sizeof(uint32_t)), KAA_HTONL(20));
+    ASSERT_EQUAL(*(uint32_t *)(buffer + KAA_EXTENSION_HEADER_SIZE + sizeof(uint32_t)),
+            KAA_HTONL(test_log_record_size));
+
+    kaa_log_collector_destroy(log_collector);
+    test_log_record->destroy(test_log_record);
+}
+
+
+
 void test_response(void **state)
 {
     (void)state;
@@ -771,6 +871,183 @@ void test_max_parallel_uploads_with_sync_all(void **state)
     kaa_log_collector_destroy(log_collector);
 }
 
+void test_upload_timeout_waits_for_deadlines(void **state)
+{
+    (void)state;
+
+    kaa_log_collector_t *log_collector = NULL;
+    kaa_error_t error_code = kaa_log_collector_create(&log_collector, status, channel_manager, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    kaa_user_log_record_t *test_log_record = kaa_test_log_record_create();
+    test_log_record->data = kaa_string_copy_create(TEST_LOG_BUFFER);
+
+    mock_strategy_context_t strategy;
+    memset(&strategy, 0, sizeof(mock_strategy_context_t));
+    strategy.timeout = 10;
+    strategy.decision = NOOP;
+    strategy.decision_delay = SIZE_MAX;
+    strategy.max_parallel_uploads = UINT32_MAX;
+
+    kaa_log_bucket_constraints_t constraints = {
+        .max_bucket_size = 1024,
+        .max_bucket_log_count = UINT32_MAX,
+    };
+
+    error_code = kaa_logging_init(log_collector, create_mock_storage(), &strategy, &constraints);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    /*
+     * Nothing is scheduled, the strategy is consulted on log events only.
+     */
+    ASSERT_EQUAL(ext_log_upload_get_next_timeout(log_collector), SIZE_MAX);
+    ext_log_upload_timeout(log_collector);
+    ASSERT_EQUAL(strategy.decide_count, 0);
+
+    error_code = kaa_logging_add_record(log_collector, test_log_record, NULL);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(strategy.decide_count, 1);
+
+    strategy.decision_delay = 100;
+    ASSERT_EQUAL(ext_log_upload_get_next_timeout(log_collector), 100);
+
+    /*
+     * The delivery deadline comes first.
+     */
+    uint8_t request_buffer[256];
+    kaa_platform_message_writer_t *writer = NULL;
+    error_code = kaa_platform_message_writer_create(&writer, request_buffer, sizeof(request_buffer));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_logging_request_serialize(log_collector, writer);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t next_timeout = ext_log_upload_get_next_timeout(log_collector);
+    ASSERT_TRUE(next_timeout > 0 && next_timeout <= strategy.timeout);
+
+    int decide_count = strategy.decide_count;
+    ext_log_upload_timeout(log_collector);
+    ASSERT_EQUAL(strategy.decide_count, decide_count);
+
+    /*
+     * Due strategy deadline.
+     */
+    strategy.decision_delay = 0;
+    ASSERT_EQUAL(ext_log_upload_get_next_timeout(log_collector), 0);
+    ext_log_upload_timeout(log_collector);
+    ASSERT_EQUAL(strategy.decide_count, decide_count + 1);
+
+    kaa_platform_message_writer_destroy(writer);
+    test_log_record->destroy(test_log_record);
+    kaa_log_collector_destroy(log_collector);
+}
+
+/* Same as the collector default */
+#define TEST_MAX_PENDING_BUCKETS    8
+
+void test_pipelined_uploads(void **state)
+{
+    (void)state;
+
+    uint32_t channel_id = 0;
+    kaa_transport_channel_interface_t transport_context;
+    test_kaa_channel_create(&transport_context);
+
+    kaa_channel_manager_add_transport_channel(channel_manager, &transport_context, &channel_id);
+    mock_transport_channel_context_t *channel = transport_context.context;
+
+    kaa_log_collector_t *log_collector = NULL;
+    kaa_error_t error_code = kaa_log_collector_create(&log_collector, status, channel_manager, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    kaa_user_log_record_t *test_log_record = kaa_test_log_record_create();
+    test_log_record->data = kaa_string_copy_create(TEST_LOG_BUFFER);
+
+    mock_strategy_context_t strategy;
+    memset(&strategy, 0, sizeof(mock_strategy_context_t));
+    strategy.timeout = INT16_MAX;
+    strategy.decision = NOOP;
+    strategy.max_parallel_uploads = UINT32_MAX;
+
+    kaa_log_bucket_constraints_t constraints = {
+        .max_bucket_size = 1024,
+        .max_bucket_log_count = 1,
+    };
+
+    error_code = kaa_logging_init(log_collector, create_mock_storage(), &strategy, &constraints);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    /*
+     * Make a backlog of one bucket more than may be pending.
+     */
+    for (int i = 0; i <= TEST_MAX_PENDING_BUCKETS; ++i) {
+        error_code = kaa_logging_add_record(log_collector, test_log_record, NULL);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(channel->on_sync_count, 0);
+
+    uint8_t request_buffer[256];
+    kaa_platform_message_writer_t *writer = NULL;
+    error_code = kaa_platform_message_writer_create(&writer, request_buffer, sizeof(request_buffer));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    /*
+     * Every upload requests the next one until the pending buckets hit the limit.
+     */
+    strategy.decision = UPLOAD;
+    size_t expected_size = 0;
+    for (int i = 0; i < TEST_MAX_PENDING_BUCKETS; ++i) {
+        error_code = kaa_logging_request_get_size(log_collector, &expected_size);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+        ASSERT_TRUE(expected_size);
+
+        writer->current = writer->begin;
+        error_code = kaa_logging_request_serialize(log_collector, writer);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(channel->on_sync_count, TEST_MAX_PENDING_BUCKETS - 1);
+
+    error_code = kaa_logging_request_get_size(log_collector, &expected_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_FALSE(expected_size);
+
+    /*
+     * Any acknowledged bucket frees a place for the backlog.
+     */
+    uint8_t response_buffer[sizeof(uint32_t) + sizeof(uint32_t)];
+    uint8_t *response = response_buffer;
+    *((uint32_t *)response) = KAA_HTONL(1);
+    response += sizeof(uint32_t);
+    *((uint16_t *)response) = KAA_HTONS(3);
+    response += sizeof(uint16_t);
+    *((uint8_t *)response) = 0x0; // SUCCESS
+    response += sizeof(uint8_t);
+    *((uint8_t *)response) = 0;
+
+    kaa_platform_message_reader_t *reader = NULL;
+    error_code = kaa_platform_message_reader_create(&reader, response_buffer, sizeof(response_buffer));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = kaa_logging_handle_server_sync(log_collector, reader, 0, sizeof(response_buffer));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(channel->on_sync_count, TEST_MAX_PENDING_BUCKETS);
+
+    error_code = kaa_logging_request_get_size(log_collector, &expected_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(expected_size);
+
+    /*
+     * Clean up.
+     */
+    error_code = kaa_channel_manager_remove_transport_channel(channel_manager, channel_id);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    kaa_platform_message_reader_destroy(reader);
+    kaa_platform_message_writer_destroy(writer);
+    test_log_record->destroy(test_log_record);
+    kaa_log_collector_destroy(log_collector);
+}
+
 /* ---------------------------------------------------------------------------*/
 /* Log delivery tests                                                         */
 /* ---------------------------------------------------------------------------*/
@@ -1630,11 +1907,14 @@ int test_deinit(void)
 
 KAA_SUITE_MAIN(Log, test_init, test_deinit,
         KAA_TEST_CASE(create_request, test_create_request)
+        KAA_TEST_CASE(create_spliced_request, test_create_spliced_request)
         KAA_TEST_CASE(process_response, test_response)
         KAA_TEST_CASE(process_timeout, test_timeout)
         KAA_TEST_CASE(decline_timeout, test_decline_timeout)
         KAA_TEST_CASE(max_parallel_uploads_with_log_sync, test_max_parallel_uploads_with_log_sync)
         KAA_TEST_CASE(max_parallel_uploads_with_sync_all, test_max_parallel_uploads_with_sync_all)
+        KAA_TEST_CASE(pipelined_uploads, test_pipelined_uploads)
+        KAA_TEST_CASE(upload_timeout_waits_for_deadlines, test_upload_timeout_waits_for_deadlines)
         KAA_RUN_TEST(log_setters, set_strategy_invalid_parameters)
         KAA_RUN_TEST(log_setters, set_strategy_valid_parameters)
         KAA_RUN_TEST(log_setters, set_storage_invalid_parameters)
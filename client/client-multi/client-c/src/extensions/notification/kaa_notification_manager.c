@@ -24,14 +24,23 @@
 #include "kaa_status.h"
 #include "kaa_platform_common.h"
 #include "utilities/kaa_mem.h"
+#include "collections/kaa_hash_map.h"
 #include "kaa_common.h"
 #include "utilities/kaa_log.h"
+#include "utilities/kaa_scratch.h"
 #include "kaa_platform_utils.h"
 #include "kaa_channel_manager.h"
 #include "platform-impl/common/kaa_htonll.h"
 
 #include "platform/sock.h"
 
+#ifdef KAA_AVRO_ARENA_READER
+/* First chunk of the notification arena, grown to fit the largest sync on demand. */
+#ifndef KAA_NOTIFICATION_ARENA_SIZE
+#define KAA_NOTIFICATION_ARENA_SIZE     256
+#endif
+#endif
+
 struct kaa_notification_manager_t {
     kaa_list_t                     *mandatory_listeners;
     kaa_list_t                     *topics_listeners;
@@ -40,6 +49,13 @@ struct kaa_notification_manager_t {
     kaa_list_t                     *unsubscriptions;
     kaa_list_t                     *uids;
     kaa_list_t                     *notifications;
+    kaa_hash_map_t                 *topics_by_id;   /**< Index of status->topics */
+    kaa_hash_map_t                 *topic_states_by_id;     /**< Index of status->topic_states */
+    kaa_hash_map_t                 *optional_listeners_by_topic;    /**< Index of optional_listeners */
+    kaa_hash_map_t                 *notifications_by_topic; /**< Index of notifications */
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_t                  *notification_arena;     /**< Notifications of the current sync live there */
+#endif
     size_t                         extension_payload_size;
 
     kaa_platform_message_writer_t  *writer;
@@ -186,14 +202,10 @@ typedef struct {
 typedef struct {
     uint64_t    topic_id;
     kaa_list_t *notifications;
+    uint32_t    last_sqn;   /**< Sequence number of the last added notification */
+    bool        is_sorted;  /**< Whether notifications were added in the sequence number order */
 } kaa_topic_notifications_node_t;
 
-static bool find_notifications_by_topic(void *data, void *context)
-{
-    kaa_topic_notifications_node_t *node = data;
-    return node->topic_id == *((uint64_t *) context);
-}
-
 static bool sort_topic_by_id(void *node_1, void *node_2)
 {
     KAA_RETURN_IF_NIL2(node_1, node_2, false);
@@ -228,7 +240,7 @@ static void kaa_destroy_notification_node(void *data)
     KAA_FREE(node);
 }
 
-static kaa_error_t kaa_create_topic_notification_node(kaa_topic_notifications_node_t **node, kaa_notification_t *item, uint32_t *sqn, uint64_t topic_id)
+static kaa_error_t kaa_create_topic_notification_node(kaa_topic_notifications_node_t **node, uint64_t topic_id)
 {
     KAA_RETURN_IF_NIL(node, KAA_ERR_BADPARAM);
 
@@ -241,61 +253,65 @@ static kaa_error_t kaa_create_topic_notification_node(kaa_topic_notifications_no
         return KAA_ERR_NOMEM;
     }
 
-    kaa_notification_wrapper_t *wrapper = KAA_MALLOC(sizeof(*wrapper));
-    if (!wrapper) {
-        kaa_destroy_notification_node(new_node);
-        return KAA_ERR_NOMEM;
-    }
-
-    if (!kaa_list_push_back(new_node->notifications, wrapper)) {
-        kaa_destroy_notification_node(new_node);
-        KAA_FREE(wrapper);
-        return KAA_ERR_NOMEM;
-    }
-
     new_node->topic_id = topic_id;
-    wrapper->notification = item;
-    wrapper->sqn = *sqn;
+    new_node->last_sqn = 0;
+    new_node->is_sorted = true;
     *node = new_node;
     return KAA_ERR_NONE;
 }
 
-static kaa_error_t kaa_add_notification_to_map(kaa_list_t *notifications, kaa_notification_t *item, uint64_t topic_id, uint32_t *sqn)
+static void kaa_clear_notifications(kaa_notification_manager_t *self)
+{
+    kaa_hash_map_clear(self->notifications_by_topic, NULL);
+    kaa_list_clear(self->notifications, &kaa_destroy_notification_node);
+}
+
+/*
+ * Notifications of a topic are kept in the order they were received. As they usually come
+ * in the sequence number order, the topic list is sorted before dispatching only if they didn't.
+ */
+static kaa_error_t kaa_add_notification_to_map(kaa_notification_manager_t *self, kaa_notification_t *item, uint64_t topic_id, uint32_t sqn)
 {
-    KAA_RETURN_IF_NIL3(notifications, item, sqn, KAA_ERR_BADPARAM);
-    kaa_list_node_t *notification_list_node = kaa_list_find_next(kaa_list_begin(notifications), find_notifications_by_topic, &topic_id);
-    kaa_topic_notifications_node_t *notification_node = NULL;
-    if (!notification_list_node) {
-        kaa_error_t err = kaa_create_topic_notification_node(&notification_node, item, sqn, topic_id);
+    KAA_RETURN_IF_NIL2(self, item, KAA_ERR_BADPARAM);
+
+    kaa_topic_notifications_node_t *notification_node = kaa_hash_map_get(self->notifications_by_topic, &topic_id);
+    if (!notification_node) {
+        kaa_error_t err = kaa_create_topic_notification_node(&notification_node, topic_id);
         if (err) {
-            kaa_list_destroy(notifications, &kaa_destroy_notification_node);
             item->destroy(item);
             return err;
         }
-        if (!kaa_list_push_back(notifications, notification_node)) {
-            kaa_list_destroy(notifications, &kaa_destroy_notification_node);
+        if (!kaa_list_push_back(self->notifications, notification_node)) {
             kaa_destroy_notification_node(notification_node);
             item->destroy(item);
             return KAA_ERR_NOMEM;
         }
-    } else {
-        notification_node = kaa_list_get_data(notification_list_node);
-        kaa_notification_wrapper_t *new_wrapper = KAA_MALLOC(sizeof(*new_wrapper));
-        if (!new_wrapper) {
-            kaa_list_destroy(notifications, &kaa_destroy_notification_node);
-            item->destroy(item);
-            return KAA_ERR_NOMEM;
-        }
-        if (!kaa_list_push_back(notification_node->notifications, new_wrapper)) {
-            kaa_list_destroy(notifications, &kaa_destroy_notification_node);
+        err = kaa_hash_map_put(self->notifications_by_topic, &notification_node->topic_id, notification_node, NULL);
+        if (err) {
+            kaa_list_remove_at(self->notifications, kaa_list_back(self->notifications), &kaa_destroy_notification_node);
             item->destroy(item);
-            KAA_FREE(new_wrapper);
-            return KAA_ERR_NOMEM;
+            return err;
         }
+    }
+
+    kaa_notification_wrapper_t *new_wrapper = KAA_MALLOC(sizeof(*new_wrapper));
+    if (!new_wrapper) {
+        item->destroy(item);
+        return KAA_ERR_NOMEM;
+    }
+    if (!kaa_list_push_back(notification_node->notifications, new_wrapper)) {
+        item->destroy(item);
+        KAA_FREE(new_wrapper);
+        return KAA_ERR_NOMEM;
+    }
 
-        new_wrapper->notification = item;
-        new_wrapper->sqn = *sqn;
+    new_wrapper->notification = item;
+    new_wrapper->sqn = sqn;
+
+    if (kaa_list_get_size(notification_node->notifications) > 1 && sqn < notification_node->last_sqn) {
+        notification_node->is_sorted = false;
     }
+    notification_node->last_sqn = sqn;
 
     return KAA_ERR_NONE;
 }
@@ -307,17 +323,6 @@ static bool kaa_predicate_for_notifications(void *notif_1, void *notif_2)
     kaa_notification_wrapper_t *wrapper_2 = notif_2;
     return wrapper_1->sqn < wrapper_2->sqn;
 }
-static void kaa_sort_notifications_by_sqn(void *data, void *context)
-{
-    (void)context;
-    kaa_topic_notifications_node_t *node = data;
-    kaa_list_sort(node->notifications, &kaa_predicate_for_notifications);
-}
-
-static void kaa_sort_notifications(kaa_list_t *notifications)
-{
-    kaa_list_for_each(kaa_list_begin(notifications), kaa_list_back(notifications), &kaa_sort_notifications_by_sqn, NULL);
-}
 
 static kaa_extension_id notification_sync_services[] = { KAA_EXTENSION_NOTIFICATION };
 
@@ -332,30 +337,33 @@ static bool kaa_find_topic_listener_by_id(void *listener, void *context)
     return ((kaa_topic_listener_wrapper_t *) listener)->id == *(uint32_t *)context;
 }
 
-static bool kaa_find_optional_notification_listener_by_id (void *optional_listener_list, void *topic_id)
+static bool kaa_find_optional_listeners_wrapper(void *optional_listener_list, void *wrapper)
 {
-    KAA_RETURN_IF_NIL2(optional_listener_list, topic_id, KAA_ERR_NONE);
-    kaa_optional_notification_listeners_wrapper_t *optional_listener_node = optional_listener_list;
-    return optional_listener_node->topic_id == *(uint64_t *)topic_id;
+    return optional_listener_list == wrapper;
 }
 
-static bool kaa_find_topic_by_id(void *topic, void *id)
+static kaa_error_t kaa_find_topic(kaa_notification_manager_t *self, kaa_topic_t **topic, uint64_t *topic_id)
 {
-    KAA_RETURN_IF_NIL2(topic, id, KAA_ERR_NONE);
-    kaa_topic_t* notification_topic = topic;
-    return notification_topic->id == *(uint64_t *)id;
+    KAA_RETURN_IF_NIL2(topic_id, topic, KAA_ERR_BADPARAM);
+    *topic = kaa_hash_map_get(self->topics_by_id, topic_id);
+    return *topic ? KAA_ERR_NONE : KAA_ERR_NOT_FOUND;
 }
 
-static kaa_error_t kaa_find_topic(kaa_notification_manager_t *self, kaa_topic_t **topic, uint64_t *topic_id)
+/* Maps topic ids to the topics of the list, the list keeps owning them. */
+static kaa_hash_map_t *kaa_create_topic_index(kaa_list_t *topics)
 {
-    KAA_RETURN_IF_NIL2(topic_id, topic, KAA_ERR_BADPARAM);
-    kaa_list_node_t *topic_node = kaa_list_find_next(kaa_list_begin(self->status->topics), &kaa_find_topic_by_id, topic_id);
-    if (!topic_node) {
-        return KAA_ERR_NOT_FOUND;
+    kaa_hash_map_t *index = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+    KAA_RETURN_IF_NIL(index, NULL);
+
+    for (kaa_list_node_t *it = kaa_list_begin(topics); it; it = kaa_list_next(it)) {
+        kaa_topic_t *topic = kaa_list_get_data(it);
+        if (kaa_hash_map_put(index, &topic->id, topic, NULL)) {
+            kaa_hash_map_destroy(index, NULL);
+            return NULL;
+        }
     }
 
-    *topic = kaa_list_get_data(topic_node);
-    return KAA_ERR_NONE;
+    return index;
 }
 
 static bool kaa_find_uid(void *data, void *context)
@@ -373,11 +381,21 @@ static bool kaa_find_uid(void *data, void *context)
     return false;
 }
 
-static bool kaa_find_topic_state_by_id(void *topic_state, void *id)
+/* Maps topic ids to the states of the list, the list keeps owning them. */
+static kaa_hash_map_t *kaa_create_topic_state_index(kaa_list_t *topic_states)
 {
-    KAA_RETURN_IF_NIL2(topic_state, id, KAA_ERR_BADPARAM);
-    kaa_topic_state_t *state = topic_state;
-    return state->topic_id == *(uint64_t *)id;
+    kaa_hash_map_t *index = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+    KAA_RETURN_IF_NIL(index, NULL);
+
+    for (kaa_list_node_t *it = kaa_list_begin(topic_states); it; it = kaa_list_next(it)) {
+        kaa_topic_state_t *state = kaa_list_get_data(it);
+        if (kaa_hash_map_put(index, &state->topic_id, state, NULL)) {
+            kaa_hash_map_destroy(index, NULL);
+            return NULL;
+        }
+    }
+
+    return index;
 }
 
 kaa_error_t kaa_calculate_topic_listener_id(const kaa_topic_listener_t *listener, uint32_t *listener_id)
@@ -591,6 +609,13 @@ void kaa_notification_manager_destroy(kaa_notification_manager_t *self)
     kaa_list_destroy(self->optional_listeners, destroy_optional_listeners_wrapper);
     kaa_list_destroy(self->uids, destroy_notifications_uid);
     kaa_list_destroy(self->notifications, kaa_destroy_notification_node);
+    kaa_hash_map_destroy(self->topics_by_id, NULL);
+    kaa_hash_map_destroy(self->topic_states_by_id, NULL);
+    kaa_hash_map_destroy(self->optional_listeners_by_topic, NULL);
+    kaa_hash_map_destroy(self->notifications_by_topic, NULL);
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_destroy(self->notification_arena);
+#endif
 
     KAA_FREE(self);
 }
@@ -615,10 +640,23 @@ kaa_error_t kaa_notification_manager_create(kaa_notification_manager_t **self, k
     manager->unsubscriptions     =  kaa_list_create();
     manager->notifications       =  kaa_list_create();
     manager->uids                =  kaa_list_create();
+    manager->topics_by_id        =  kaa_create_topic_index(status->topics);
+    manager->topic_states_by_id  =  kaa_create_topic_state_index(status->topic_states);
+    manager->optional_listeners_by_topic = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+    manager->notifications_by_topic = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+#ifdef KAA_AVRO_ARENA_READER
+    manager->notification_arena = NULL;
+    if (kaa_scratch_create(&manager->notification_arena, KAA_NOTIFICATION_ARENA_SIZE)) {
+        kaa_notification_manager_destroy(manager);
+        return KAA_ERR_NOMEM;
+    }
+#endif
 
     if (!manager->mandatory_listeners || !manager->topics_listeners
             || !manager->optional_listeners ||!manager->subscriptions
-            || !manager->unsubscriptions || !manager->uids)
+            || !manager->unsubscriptions || !manager->uids || !manager->topics_by_id
+            || !manager->topic_states_by_id || !manager->optional_listeners_by_topic
+            || !manager->notifications_by_topic)
     {
         kaa_notification_manager_destroy(manager);
         return KAA_ERR_NOMEM;
@@ -700,7 +738,7 @@ kaa_error_t kaa_add_optional_notification_listener(kaa_notification_manager_t *s
 {
     KAA_RETURN_IF_NIL4(self, listener, listener->callback, topic_id, KAA_ERR_BADPARAM);
 
-    if (!kaa_list_find_next(kaa_list_begin(self->status->topics), &kaa_find_topic_by_id, topic_id)) {
+    if (!kaa_hash_map_get(self->topics_by_id, topic_id)) {
         KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND,
                 "Failed to add optional notification listener: topic with id '%llu' not found",
                 *topic_id);
@@ -718,16 +756,16 @@ kaa_error_t kaa_add_optional_notification_listener(kaa_notification_manager_t *s
     kaa_notification_listener_wrapper_t *wrapper = KAA_MALLOC(sizeof(*wrapper));
     KAA_RETURN_IF_NIL(wrapper, KAA_ERR_NOMEM);
 
-    kaa_list_node_t *opt_listeners_node = kaa_list_find_next(
-            kaa_list_begin(self->optional_listeners), kaa_find_optional_notification_listener_by_id,
-            topic_id);
-    if (!opt_listeners_node) {
-        kaa_optional_notification_listeners_wrapper_t* optional_wrapper = KAA_MALLOC(sizeof(*optional_wrapper));
+    kaa_optional_notification_listeners_wrapper_t* optional_wrapper =
+        kaa_hash_map_get(self->optional_listeners_by_topic, topic_id);
+    if (!optional_wrapper) {
+        optional_wrapper = KAA_MALLOC(sizeof(*optional_wrapper));
         if (!optional_wrapper) {
             KAA_FREE(wrapper);
             return KAA_ERR_NOMEM;
         }
 
+        optional_wrapper->topic_id = *topic_id;
         optional_wrapper->listeners = kaa_list_create();
         if (!kaa_list_push_front(optional_wrapper->listeners, wrapper)) {
             KAA_FREE(wrapper);
@@ -736,14 +774,19 @@ kaa_error_t kaa_add_optional_notification_listener(kaa_notification_manager_t *s
         }
 
         if (!kaa_list_push_front(self->optional_listeners, optional_wrapper)) {
-            KAA_FREE(wrapper);
             destroy_optional_listeners_wrapper(optional_wrapper);
+            KAA_FREE(wrapper);
             return KAA_ERR_NOMEM;
         }
 
-        optional_wrapper->topic_id = *topic_id;
+        err = kaa_hash_map_put(self->optional_listeners_by_topic, &optional_wrapper->topic_id, optional_wrapper, NULL);
+        if (err) {
+            kaa_list_remove_at(self->optional_listeners, kaa_list_begin(self->optional_listeners),
+                    &destroy_optional_listeners_wrapper);
+            KAA_FREE(wrapper);
+            return err;
+        }
     } else {
-        kaa_optional_notification_listeners_wrapper_t* optional_wrapper = kaa_list_get_data(opt_listeners_node);
 
         if (kaa_list_find_next(kaa_list_begin(optional_wrapper->listeners), &kaa_find_notification_listener_by_id, &id)) {
             KAA_LOG_WARN(self->logger, KAA_ERR_ALREADY_EXISTS, "Failed to add the optional listener: the listener is already subscribed");
@@ -773,16 +816,13 @@ kaa_error_t kaa_remove_optional_notification_listener(kaa_notification_manager_t
     KAA_RETURN_IF_NIL3(self, topic_id, listener_id, KAA_ERR_BADPARAM);
     KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to remove optional notification listener: id '%u', topic id '%u'", *listener_id, *topic_id);
 
-    kaa_list_node_t *opt_listeners_node = kaa_list_find_next(
-            kaa_list_begin(self->optional_listeners),
-            &kaa_find_optional_notification_listener_by_id, topic_id);
-    if (!opt_listeners_node) {
+    kaa_optional_notification_listeners_wrapper_t *optional_wrapper =
+        kaa_hash_map_get(self->optional_listeners_by_topic, topic_id);
+    if (!optional_wrapper) {
         KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Failed to remove the optional listener: there is no listeners subscribed on this topic (topic id '%llu').", *topic_id);
         return KAA_ERR_NOT_FOUND;
     }
 
-    kaa_optional_notification_listeners_wrapper_t *optional_wrapper = kaa_list_get_data(opt_listeners_node);
-
     kaa_error_t error = kaa_list_remove_first(optional_wrapper->listeners,
             &kaa_find_notification_listener_by_id, listener_id, &kaa_data_destroy);
     if (error) {
@@ -791,7 +831,9 @@ kaa_error_t kaa_remove_optional_notification_listener(kaa_notification_manager_t
     } else {
         KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Removed optional notification listener id: '%lu', topic id '%llu'", *listener_id, *topic_id);
         if (!kaa_list_get_size(optional_wrapper->listeners)) {
-            kaa_list_remove_at(self->optional_listeners, opt_listeners_node, &destroy_optional_listeners_wrapper);
+            kaa_hash_map_remove(self->optional_listeners_by_topic, topic_id);
+            kaa_list_remove_first(self->optional_listeners, &kaa_find_optional_listeners_wrapper,
+                    optional_wrapper, &destroy_optional_listeners_wrapper);
         }
         return KAA_ERR_NONE;
     }
@@ -889,13 +931,9 @@ static kaa_error_t kaa_notify_optional_notification_subscribers(kaa_notification
         uint64_t topic_id, kaa_notification_t *notification)
 {
     KAA_RETURN_IF_NIL3(self, topic_id, notification, KAA_ERR_BADPARAM);
-    kaa_list_node_t *opt_listeners_node = kaa_list_find_next(
-            kaa_list_begin(self->optional_listeners),
-            kaa_find_optional_notification_listener_by_id, &topic_id);
-    KAA_RETURN_IF_NIL(opt_listeners_node, KAA_ERR_NOT_FOUND);
-
     kaa_optional_notification_listeners_wrapper_t* optional_wrapper =
-        kaa_list_get_data(opt_listeners_node);
+        kaa_hash_map_get(self->optional_listeners_by_topic, &topic_id);
+    KAA_RETURN_IF_NIL(optional_wrapper, KAA_ERR_NOT_FOUND);
 
     kaa_list_node_t *optional_listener_node = kaa_list_begin(optional_wrapper->listeners);
     while (optional_listener_node) {
@@ -1087,35 +1125,50 @@ kaa_error_t kaa_sync_topic_subscriptions(kaa_notification_manager_t *self)
 static kaa_error_t kaa_topic_list_update(kaa_notification_manager_t *self, kaa_list_t *new_topics)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
-    kaa_topic_t *topic = NULL;
-    kaa_list_node_t *topic_node = kaa_list_begin(new_topics);
-
-    // "Substracts" self topics from new topics based on IDs
-    while (topic_node && kaa_list_get_size(self->status->topics) > 0) {
-        topic = kaa_list_get_data(topic_node);
-        KAA_RETURN_IF_NIL(topic, KAA_ERR_NOMEM);
-        kaa_list_remove_first(self->status->topics, kaa_find_topic_by_id, &topic->id, destroy_topic);
-        topic_node = kaa_list_next(topic_node);
-    }
-
-    if (kaa_list_get_size(self->status->topics)) {
-        KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
-                "Going to remove optional listener(s) from obsolete %zu topics",
-                kaa_list_get_size(self->status->topics));
-
-        kaa_list_node_t *outdated_topics = kaa_list_begin(self->status->topics);
-        while (outdated_topics) {
-            topic = kaa_list_get_data(outdated_topics);
-            kaa_list_remove_first(self->optional_listeners,
-                    kaa_find_optional_notification_listener_by_id, &topic->id,
-                    destroy_optional_listeners_wrapper);
-            outdated_topics = kaa_list_next(outdated_topics);
+
+    // The topic list is resent as is if the server doesn't confirm the hash (e.g. on reconnect)
+    kaa_list_sort(new_topics, &sort_topic_by_id);
+    int32_t topic_list_hash = kaa_list_hash(new_topics, &get_topic_id);
+    if (topic_list_hash == self->status->topic_list_hash
+            && kaa_list_get_size(new_topics) == kaa_list_get_size(self->status->topics)) {
+        KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Topic list is unchanged (hash %d), skipping update", topic_list_hash);
+        kaa_list_destroy(new_topics, &destroy_topic);
+        return KAA_ERR_NONE;
+    }
+
+    kaa_hash_map_t *new_index = kaa_create_topic_index(new_topics);
+    if (!new_index) {
+        kaa_list_destroy(new_topics, &destroy_topic);
+        return KAA_ERR_NOMEM;
+    }
+
+    // Old topics missing from the new list are obsolete
+    size_t outdated_count = 0;
+    for (kaa_list_node_t *it = kaa_list_begin(self->status->topics); it; it = kaa_list_next(it)) {
+        kaa_topic_t *topic = kaa_list_get_data(it);
+        if (kaa_hash_map_get(new_index, &topic->id)) {
+            continue;
+        }
+
+        kaa_optional_notification_listeners_wrapper_t *optional_wrapper =
+            kaa_hash_map_remove(self->optional_listeners_by_topic, &topic->id);
+        if (!optional_wrapper) {
+            continue;
+        }
+
+        if (!outdated_count++) {
+            KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
+                    "Going to remove optional listener(s) from obsolete topics");
         }
+        kaa_list_remove_first(self->optional_listeners,
+                kaa_find_optional_listeners_wrapper, optional_wrapper,
+                destroy_optional_listeners_wrapper);
     }
 
+    kaa_hash_map_destroy(self->topics_by_id, NULL);
+    self->topics_by_id = new_index;
     kaa_list_destroy(self->status->topics, &destroy_topic);
-    kaa_list_sort(new_topics, &sort_topic_by_id);
-    self->status->topic_list_hash = kaa_list_hash(new_topics, &get_topic_id);
+    self->status->topic_list_hash = topic_list_hash;
     self->status->topics = new_topics;
     return kaa_notify_topic_update_subscribers(self, new_topics);
 }
@@ -1129,14 +1182,13 @@ static kaa_error_t kaa_notification_received(kaa_notification_manager_t *self, k
     return KAA_ERR_NONE;
 }
 
-static kaa_error_t update_sequence_number(kaa_notification_manager_t *self, uint64_t topic_id, uint32_t sqn_number)
+static kaa_error_t update_sequence_number(kaa_notification_manager_t *self, kaa_topic_state_t **state_p,
+        uint64_t topic_id, uint32_t sqn_number)
 {
-    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+    KAA_RETURN_IF_NIL2(self, state_p, KAA_ERR_BADPARAM);
 
-    kaa_topic_state_t *state;
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->status->topic_states),
-            kaa_find_topic_state_by_id, &topic_id);
-    if (!it) {
+    kaa_topic_state_t *state = *state_p;
+    if (!state) {
         state = KAA_MALLOC(sizeof(*state));
         KAA_RETURN_IF_NIL(state, KAA_ERR_NOMEM);
 
@@ -1147,13 +1199,18 @@ static kaa_error_t update_sequence_number(kaa_notification_manager_t *self, uint
 
         state->topic_id = topic_id;
         state->sqn_number = sqn_number;
-        self->status->has_update = true;
-    } else {
-        state = kaa_list_get_data(it);
-        if (sqn_number > state->sqn_number) {
-            state->sqn_number = sqn_number;
-            self->status->has_update = true;
+
+        kaa_error_t err = kaa_hash_map_put(self->topic_states_by_id, &state->topic_id, state, NULL);
+        if (err) {
+            kaa_list_remove_at(self->status->topic_states, kaa_list_begin(self->status->topic_states), &kaa_data_destroy);
+            return err;
         }
+
+        self->status->has_update = true;
+        *state_p = state;
+    } else if (sqn_number > state->sqn_number) {
+        state->sqn_number = sqn_number;
+        self->status->has_update = true;
     }
     return KAA_ERR_NONE;
 }
@@ -1163,15 +1220,18 @@ static void kaa_notify_notification_listeners(void *data, void* context)
     KAA_RETURN_IF_NIL2(data, context, );
     kaa_error_t err = KAA_ERR_NONE;
     kaa_topic_notifications_node_t *node = data;
-    kaa_list_node_t *notification_list_node = kaa_list_begin(node->notifications);
     kaa_notification_manager_t *self = context;
 
+    if (!node->is_sorted) {
+        kaa_list_sort(node->notifications, &kaa_predicate_for_notifications);
+    }
+
+    kaa_topic_state_t *state = kaa_hash_map_get(self->topic_states_by_id, &node->topic_id);
+    kaa_list_node_t *notification_list_node = kaa_list_begin(node->notifications);
+
     while(notification_list_node) {
         kaa_notification_wrapper_t *wrapper = kaa_list_get_data(notification_list_node);
-        kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->status->topic_states),
-                kaa_find_topic_state_by_id, &node->topic_id);
-        if (it) {
-            kaa_topic_state_t *state = kaa_list_get_data(it);
+        if (state) {
             if (wrapper->sqn > state->sqn_number) {
                 err = kaa_notification_received(self, wrapper->notification, node->topic_id);
             }
@@ -1183,7 +1243,7 @@ static void kaa_notify_notification_listeners(void *data, void* context)
             }
         }
 
-        err = update_sequence_number(self, node->topic_id, wrapper->sqn);
+        err = update_sequence_number(self, &state, node->topic_id, wrapper->sqn);
         if (err) {
             KAA_LOG_WARN(self->logger, err, "Failed to update notification sequence number for topic '%llu'", node->topic_id);
         }
@@ -1201,6 +1261,13 @@ kaa_error_t kaa_notification_manager_handle_server_sync(kaa_notification_manager
 
     kaa_list_clear(self->subscriptions, &kaa_data_destroy);
     kaa_list_clear(self->unsubscriptions, &kaa_data_destroy);
+#if defined(KAA_AVRO_BORROWED_READER) || defined(KAA_AVRO_ARENA_READER)
+    /* Drop notifications left by a failed sync: they point into its buffer or arena. */
+    kaa_clear_notifications(self);
+#endif
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_reset(self->notification_arena);
+#endif
 
     if (extension_length > 0) {
         kaa_error_t err = KAA_ERR_NONE;
@@ -1271,11 +1338,21 @@ kaa_error_t kaa_notification_manager_handle_server_sync(kaa_notification_manager
                             }
                         }
                         if (notification_size) {
+#ifdef KAA_AVRO_BORROWED_READER
+                            /* Notifications are dispatched and destroyed before this
+                             * function returns, so they may borrow the sync buffer. */
+                            avro_reader_t avro_reader = avro_reader_memory_borrowed((char *)reader->current, notification_size);
+#else
                             avro_reader_t avro_reader = avro_reader_memory((const char *)reader->current, notification_size);
+#endif
                             if (!avro_reader) {
                                 return KAA_ERR_NOMEM;
                             }
+#ifdef KAA_AVRO_ARENA_READER
+                            notification = KAA_NOTIFICATION_DESERIALIZE_INTO_ARENA(avro_reader, self->notification_arena);
+#else
                             notification = KAA_NOTIFICATION_DESERIALIZE(avro_reader);
+#endif
                             avro_reader_free(avro_reader);
                             if (!notification) {
                                 KAA_LOG_WARN(self->logger, KAA_ERR_NOMEM, "Failed to deserialize notification");
@@ -1286,13 +1363,14 @@ kaa_error_t kaa_notification_manager_handle_server_sync(kaa_notification_manager
                                 , seq_number, topic_id, uid_length ? "unicast" : "multicast", notification_size);
                         shift_and_sub_extension(reader, &extension_length, kaa_aligned_size_get(notification_size));
                         if (uid_length == 0) {
-                            err = kaa_add_notification_to_map(self->notifications, notification, topic_id, &seq_number);
+                            err = kaa_add_notification_to_map(self, notification, topic_id, seq_number);
                         } else {
                             err = kaa_notification_received(self, notification, topic_id);
                             notification->destroy(notification);
                         }
                         if (err) {
                             KAA_LOG_WARN(self->logger, err, "Failed to add notification to map");
+                            kaa_clear_notifications(self);
                             return KAA_ERR_NOMEM;
                         }
                     }
@@ -1356,13 +1434,12 @@ kaa_error_t kaa_notification_manager_handle_server_sync(kaa_notification_manager
     }
 
     if (kaa_list_get_size(self->notifications)) {
-        kaa_sort_notifications(self->notifications);
         kaa_list_for_each(kaa_list_begin(self->notifications), kaa_list_back(self->notifications), kaa_notify_notification_listeners, self);
-        kaa_list_clear(self->notifications, &kaa_destroy_notification_node);
-        if (!self->notifications) {
-            return KAA_ERR_NOMEM;
-        }
+        kaa_clear_notifications(self);
     }
+#ifdef KAA_AVRO_ARENA_READER
+    kaa_scratch_reset(self->notification_arena);
+#endif
 
     return do_sync(self);
 }
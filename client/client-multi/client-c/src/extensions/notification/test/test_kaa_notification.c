@@ -252,6 +252,27 @@ void test_notification_listeners_adding_and_removing(void **state)
     ASSERT_EQUAL(err, KAA_ERR_NONE);
 }
 
+void test_notification_sequence_tracking(void **state)
+{
+    (void)state;
+
+    err = kaa_add_optional_notification_listener(context->notification_manager, &listener, &topic_id, &id);
+    ASSERT_EQUAL(err, KAA_ERR_NONE);
+
+    listener_has_been_notified = false;
+    err = kaa_platform_protocol_process_server_sync(context->platform_protocol, buffer_pointer, size);
+    ASSERT_EQUAL(err, KAA_ERR_NONE);
+    ASSERT_EQUAL(listener_has_been_notified, false); // sqn 100 has been already received
+
+    *(uint32_t *)pointer_to_sqn = KAA_HTONL((uint32_t) 101);
+    err = kaa_platform_protocol_process_server_sync(context->platform_protocol, buffer_pointer, size);
+    ASSERT_EQUAL(err, KAA_ERR_NONE);
+    ASSERT_EQUAL(listener_has_been_notified, true);
+
+    err = kaa_remove_optional_notification_listener(context->notification_manager, &topic_id, &id);
+    ASSERT_EQUAL(err, KAA_ERR_NONE);
+}
+
 void test_topic_list_listeners_adding_and_removing(void **state)
 {
     (void)state;
@@ -330,6 +351,7 @@ void test_subscriptions(void **state)
 KAA_SUITE_MAIN(Notification, test_init, test_deinit,
        KAA_TEST_CASE(deserializing, test_deserializing)
        KAA_TEST_CASE(removing_and_adding_notifications_listeners, test_notification_listeners_adding_and_removing)
+       KAA_TEST_CASE(notification_sequence_tracking, test_notification_sequence_tracking)
        KAA_TEST_CASE(removing_and_adding_topic_list_listeners, test_topic_list_listeners_adding_and_removing)
        KAA_TEST_CASE(topic_list_retrieving, test_retrieving_topic_list)
        KAA_TEST_CASE(serializing, test_serializing)
@@ -386,6 +386,7 @@ kaa_error_t kaa_profile_handle_server_sync(kaa_profile_manager_t *self
     if (!self->status->is_registered) {
         KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Endpoint has been registered");
         self->status->is_registered = true;
+        self->status->dirty_fields |= KAA_STATUS_REGISTERED;
     }
 
     return error_code;
@@ -414,6 +415,14 @@ kaa_error_t kaa_profile_manager_update_profile(kaa_profile_manager_t *self, kaa_
     profile_body->serialize(writer, profile_body);
     avro_writer_free(writer);
 
+    // Same body as the last update, so same hash: no need to compute it
+    if (self->profile_body.size == serialized_profile_size
+            && !memcmp(self->profile_body.buffer, serialized_profile, serialized_profile_size)) {
+        self->need_resync = false;
+        KAA_FREE(serialized_profile);
+        return KAA_ERR_NONE;
+    }
+
     kaa_digest new_hash;
     ext_calculate_sha_hash(serialized_profile, serialized_profile_size, new_hash);
 
@@ -429,6 +438,7 @@ kaa_error_t kaa_profile_manager_update_profile(kaa_profile_manager_t *self, kaa_
         KAA_FREE(serialized_profile);
         return KAA_ERR_BAD_STATE;
     }
+    self->status->dirty_fields |= KAA_STATUS_PROFILE_HASH;
 
     if (self->profile_body.size > 0) {
         KAA_FREE(self->profile_body.buffer);
@@ -63,12 +63,25 @@ typedef struct {
     kaa_endpoint_status_listener_t *listener;
 } kaa_endpoint_info_t;
 
+typedef struct {
+    uint16_t                        first_request_id;       /*!< Requests of the batch have consecutive ids */
+    uint16_t                        count;
+    uint16_t                        pending_count;          /*!< Requests not answered yet */
+    bool                            is_serialized;
+    on_endpoints_attached_fn        on_completed;
+    void                           *context;
+    uint16_t                       *access_token_lengths;   /*!< The arrays below are allocated along with the batch */
+    kaa_endpoint_attach_result_t   *results;
+    char                           *access_tokens;          /*!< Not null-terminated, one after another */
+} kaa_endpoint_attach_batch_t;
+
 struct kaa_user_manager_t {
     kaa_attachment_status_listeners_t   attachment_listeners;               /*!< Client code-defined user attachment listeners */
     user_info_t                        *user_info;                          /*!< User credentials */
     bool                                is_waiting_user_attach_response;
     kaa_list_t                         *attach_endpoints;                   /*!< Endpoints attach list*/
     kaa_list_t                         *detach_endpoints;                   /*!< Endpoints detach list */
+    kaa_list_t                         *attach_batches;                     /*!< Endpoints attach batches */
     uint16_t                            endpoint_request_counter;           /*!< Endpoints counter of request id*/
     kaa_status_t                       *status;                             /*!< Reference to global status */
     kaa_channel_manager_t              *channel_manager;                    /*!< Reference to global channel manager */
@@ -179,6 +192,16 @@ static bool match_predicate_endpoint_info(void *data, void *context)
     return request_id == endpoint_item->request_id;
 }
 
+static bool match_predicate_attach_batch(void *data, void *context)
+{
+    KAA_RETURN_IF_NIL2(data, context, false);
+
+    kaa_endpoint_attach_batch_t *batch = (kaa_endpoint_attach_batch_t*)data;
+    uint16_t request_id = *(uint16_t*)context;
+
+    return (uint16_t)(request_id - batch->first_request_id) < batch->count;
+}
+
 static void destroy_user_info(user_info_t *user_info)
 {
     KAA_RETURN_IF_NIL(user_info, );
@@ -247,6 +270,7 @@ kaa_error_t kaa_user_manager_create(kaa_user_manager_t **user_manager_p
     (*user_manager_p)->is_waiting_user_attach_response = false;
     (*user_manager_p)->attach_endpoints = kaa_list_create();
     (*user_manager_p)->detach_endpoints = kaa_list_create();
+    (*user_manager_p)->attach_batches = kaa_list_create();
     (*user_manager_p)->endpoint_request_counter = 0;
     (*user_manager_p)->status = status;
     (*user_manager_p)->channel_manager = channel_manager;
@@ -261,6 +285,7 @@ void kaa_user_manager_destroy(kaa_user_manager_t *self)
     if (self) {
         kaa_list_destroy(self->attach_endpoints, dtor_endpoint_info);
         kaa_list_destroy(self->detach_endpoints, dtor_endpoint_info);
+        kaa_list_destroy(self->attach_batches, NULL);
         destroy_user_info(self->user_info);
         KAA_FREE(self);
     }
@@ -341,6 +366,62 @@ kaa_error_t kaa_user_manager_attach_endpoint(kaa_user_manager_t *self, const cha
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_user_manager_attach_endpoints(kaa_user_manager_t *self, const char *const *endpoint_access_tokens, size_t count,
+                                              on_endpoints_attached_fn on_completed, void *context)
+{
+    KAA_RETURN_IF_NIL2(self, endpoint_access_tokens, KAA_ERR_BADPARAM);
+    if (!count || count > UINT16_MAX)
+        return KAA_ERR_BADPARAM;
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Going to attach %zu endpoints by access tokens", count);
+
+    size_t access_tokens_size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        KAA_RETURN_IF_NIL(endpoint_access_tokens[i], KAA_ERR_BADPARAM);
+        size_t length = strlen(endpoint_access_tokens[i]);
+        if (length > UINT16_MAX)
+            return KAA_ERR_BADPARAM;
+        access_tokens_size += length;
+    }
+
+    kaa_endpoint_attach_batch_t *batch = KAA_MALLOC(sizeof(*batch)
+            + count * (sizeof(*batch->access_token_lengths) + sizeof(*batch->results))
+            + access_tokens_size);
+    KAA_RETURN_IF_NIL(batch, KAA_ERR_NOMEM);
+
+    batch->access_token_lengths = (uint16_t *)(batch + 1);
+    batch->results = (kaa_endpoint_attach_result_t *)(batch->access_token_lengths + count);
+    batch->access_tokens = (char *)(batch->results + count);
+    memset(batch->results, 0, count * sizeof(*batch->results));
+
+    char *access_token = batch->access_tokens;
+    for (size_t i = 0; i < count; ++i) {
+        batch->access_token_lengths[i] = (uint16_t)strlen(endpoint_access_tokens[i]);
+        memcpy(access_token, endpoint_access_tokens[i], batch->access_token_lengths[i]);
+        access_token += batch->access_token_lengths[i];
+    }
+
+    batch->first_request_id = self->endpoint_request_counter + 1;
+    batch->count = (uint16_t)count;
+    batch->pending_count = (uint16_t)count;
+    batch->is_serialized = false;
+    batch->on_completed = on_completed;
+    batch->context = context;
+    self->endpoint_request_counter += (uint16_t)count;
+
+    if (!kaa_list_push_back(self->attach_batches, batch)) {
+        KAA_FREE(batch);
+        return KAA_ERR_NOMEM;
+    }
+
+    kaa_transport_channel_interface_t *channel =
+            kaa_channel_manager_get_transport_channel(self->channel_manager, user_sync_services[0]);
+    if (channel)
+        channel->sync_handler(channel->context, user_sync_services, 1);
+
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_user_manager_detach_endpoint(kaa_user_manager_t *self, const kaa_endpoint_id_p endpoint_hash_key, kaa_endpoint_status_listener_t *listener)
 {
     KAA_RETURN_IF_NIL2(self, endpoint_hash_key, KAA_ERR_BADPARAM);
@@ -390,6 +471,28 @@ kaa_error_t kaa_user_manager_set_attachment_listeners(kaa_user_manager_t *self
     return KAA_ERR_NONE;
 }
 
+static size_t kaa_user_get_attach_requests_count(kaa_user_manager_t *self)
+{
+    size_t count = 0;
+
+    kaa_list_node_t *node = kaa_list_begin(self->attach_endpoints);
+    while (node) {
+        if (!((kaa_endpoint_info_t*)kaa_list_get_data(node))->is_waiting_response)
+            ++count;
+        node = kaa_list_next(node);
+    }
+
+    node = kaa_list_begin(self->attach_batches);
+    while (node) {
+        kaa_endpoint_attach_batch_t *batch = (kaa_endpoint_attach_batch_t*)kaa_list_get_data(node);
+        if (!batch->is_serialized)
+            count += batch->count;
+        node = kaa_list_next(node);
+    }
+
+    return count;
+}
+
 static size_t kaa_user_request_get_size_no_header(kaa_user_manager_t *self)
 {
     size_t expected_size = 0;
@@ -401,16 +504,26 @@ static size_t kaa_user_request_get_size_no_header(kaa_user_manager_t *self)
        expected_size += kaa_aligned_size_get(self->user_info->user_verifier_token_len);
     }
 
-    if (kaa_list_get_size(self->attach_endpoints)) {
-
+    if (kaa_user_get_attach_requests_count(self)) {
         expected_size += sizeof(uint32_t); //  field id + reserved + endpoint attach requests count
+    }
 
-        kaa_list_node_t *node = kaa_list_begin(self->attach_endpoints);
-        while (node) {
-            kaa_endpoint_info_t *info = (kaa_endpoint_info_t*)kaa_list_get_data(node);
+    kaa_list_node_t *node = kaa_list_begin(self->attach_endpoints);
+    while (node) {
+        kaa_endpoint_info_t *info = (kaa_endpoint_info_t*)kaa_list_get_data(node);
+        if (!info->is_waiting_response)
             expected_size += sizeof(uint32_t) + kaa_aligned_size_get(info->access_token_length); //request id + endpoint access token length
-            node = kaa_list_next(node);
+        node = kaa_list_next(node);
+    }
+
+    node = kaa_list_begin(self->attach_batches);
+    while (node) {
+        kaa_endpoint_attach_batch_t *batch = (kaa_endpoint_attach_batch_t*)kaa_list_get_data(node);
+        if (!batch->is_serialized) {
+            for (uint16_t i = 0; i < batch->count; ++i)
+                expected_size += sizeof(uint32_t) + kaa_aligned_size_get(batch->access_token_lengths[i]);
         }
+        node = kaa_list_next(node);
     }
 
     if (kaa_list_get_size(self->detach_endpoints)) {
@@ -484,11 +597,12 @@ kaa_error_t kaa_user_request_serialize(kaa_user_manager_t *self, kaa_platform_me
         self->is_waiting_user_attach_response = true;
     }
 
-    if (kaa_list_get_size(self->attach_endpoints)) {
+    size_t attach_requests_count = kaa_user_get_attach_requests_count(self);
+    if (attach_requests_count) {
         kaa_list_node_t *node = kaa_list_begin(self->attach_endpoints);
         *(writer->current) = EXTERNAL_SYSTEM_ENDPOINT_ATTACH_FIELD;
         writer->current += sizeof(uint16_t);
-        *((uint16_t*)writer->current) = KAA_HTONS((uint16_t)kaa_list_get_size(self->attach_endpoints));
+        *((uint16_t*)writer->current) = KAA_HTONS((uint16_t)attach_requests_count);
         writer->current += sizeof(uint16_t);
 
         while (node) {
@@ -512,6 +626,30 @@ kaa_error_t kaa_user_request_serialize(kaa_user_manager_t *self, kaa_platform_me
 
             node = kaa_list_next(node);
         }
+
+        node = kaa_list_begin(self->attach_batches);
+        while (node) {
+            kaa_endpoint_attach_batch_t *batch = (kaa_endpoint_attach_batch_t*)kaa_list_get_data(node);
+
+            if (!batch->is_serialized) {
+                const char *access_token = batch->access_tokens;
+                for (uint16_t i = 0; i < batch->count; ++i) {
+                    *((uint16_t*)writer->current) = KAA_HTONS((uint16_t)(batch->first_request_id + i));
+                    writer->current += sizeof(uint16_t);
+                    *((uint16_t*)writer->current) = KAA_HTONS(batch->access_token_lengths[i]);
+                    writer->current += sizeof(uint16_t);
+                    if (kaa_platform_message_write_aligned(writer, access_token, batch->access_token_lengths[i])) {
+                        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to write the user Endpoint access token");
+                        return KAA_ERR_WRITE_FAILED;
+                    }
+                    access_token += batch->access_token_lengths[i];
+                }
+
+                batch->is_serialized = true;
+            }
+
+            node = kaa_list_next(node);
+        }
     }
 
     if (kaa_list_get_size(self->detach_endpoints)) {
@@ -541,6 +679,28 @@ kaa_error_t kaa_user_request_serialize(kaa_user_manager_t *self, kaa_platform_me
     return KAA_ERR_NONE;
 }
 
+static bool kaa_user_handle_batched_attach_response(kaa_user_manager_t *self, uint16_t request_id,
+                                                    bool is_attached, const uint8_t *endpoint_id)
+{
+    kaa_list_node_t *node = kaa_list_find_next(kaa_list_begin(self->attach_batches), match_predicate_attach_batch, (void*)&request_id);
+    if (!node)
+        return false;
+
+    kaa_endpoint_attach_batch_t *batch = (kaa_endpoint_attach_batch_t*)kaa_list_get_data(node);
+    kaa_endpoint_attach_result_t *result = &batch->results[(uint16_t)(request_id - batch->first_request_id)];
+    result->is_attached = is_attached;
+    if (endpoint_id)
+        memcpy(result->endpoint_id, endpoint_id, KAA_ENDPOINT_ID_LENGTH);
+
+    if (!--batch->pending_count) {
+        if (batch->on_completed)
+            batch->on_completed(batch->context, batch->results, batch->count);
+        kaa_list_remove_at(self->attach_batches, node, NULL);
+    }
+
+    return true;
+}
+
 kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                                       , kaa_platform_message_reader_t *reader
                                       , uint16_t extension_options
@@ -571,6 +731,7 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                 if (result == USER_RESULT_SUCCESS) {
                     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Endpoint was successfully attached to user");
                     kaa_status_set_attached(self->status, true);
+                    ++self->status->user_endpoints_epoch;
                     if (self->attachment_listeners.on_attach_success)
                         (self->attachment_listeners.on_attach_success)(self->attachment_listeners.context);
                 } else {
@@ -650,6 +811,7 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                 remaining_length -= kaa_aligned_size_get(access_token_length);
 
                 kaa_status_set_attached(self->status, true);
+                ++self->status->user_endpoints_epoch;
 
                 if (self->attachment_listeners.on_attached)
                     (self->attachment_listeners.on_attached)(self->attachment_listeners.context
@@ -673,6 +835,7 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                 remaining_length -= kaa_aligned_size_get(access_token_length);
 
                 kaa_status_set_attached(self->status, false);
+                ++self->status->user_endpoints_epoch;
 
                 if (self->attachment_listeners.on_detached)
                     (self->attachment_listeners.on_detached)(self->attachment_listeners.context, access_token);
@@ -694,6 +857,9 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                     remaining_length -= sizeof(uint32_t);
 
                     if (result_code == USER_RESULT_FAILURE) {
+                        if (kaa_user_handle_batched_attach_response(self, request_id, false, NULL))
+                            continue;
+
                         kaa_list_node_t *node = kaa_list_find_next(kaa_list_begin(self->attach_endpoints), match_predicate_endpoint_info, (void*)&request_id);
                         if (node) {
                             kaa_endpoint_info_t *info = (kaa_endpoint_info_t*)kaa_list_get_data(node);
@@ -704,12 +870,17 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                         continue;
                     }
 
+                    ++self->status->user_endpoints_epoch;
+
                     if (options & USER_SYNC_ENDPOINT_ID_OPTION) {
                         kaa_endpoint_id endpoint_id;
                         memcpy(endpoint_id, reader->current, KAA_ENDPOINT_ID_LENGTH);
                         reader->current  += KAA_ENDPOINT_ID_LENGTH;
                         remaining_length -= KAA_ENDPOINT_ID_LENGTH;
 
+                        if (kaa_user_handle_batched_attach_response(self, request_id, true, endpoint_id))
+                            continue;
+
                         kaa_list_node_t *node = kaa_list_find_next(kaa_list_begin(self->attach_endpoints), match_predicate_endpoint_info, (void*)&request_id);
                         if (node) {
                             kaa_endpoint_info_t *info = (kaa_endpoint_info_t*)kaa_list_get_data(node);
@@ -717,6 +888,8 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                                 info->listener->on_attached(info->listener->context, endpoint_id);
                             kaa_list_remove_at(self->attach_endpoints, node, dtor_endpoint_info);
                         }
+                    } else {
+                        kaa_user_handle_batched_attach_response(self, request_id, true, NULL);
                     }
                 }
 
@@ -747,6 +920,8 @@ kaa_error_t kaa_user_handle_server_sync(kaa_user_manager_t *self
                         continue;
                     }
 
+                    ++self->status->user_endpoints_epoch;
+
                     kaa_list_node_t *node = kaa_list_find_next(kaa_list_begin(self->detach_endpoints), match_predicate_endpoint_info, (void*)&request_id);
                     if (node) {
                         kaa_endpoint_info_t *info = (kaa_endpoint_info_t*)kaa_list_get_data(node);
@@ -119,6 +119,23 @@ kaa_error_t kaa_user_manager_set_attachment_listeners(kaa_user_manager_t *self
 kaa_error_t kaa_user_manager_attach_endpoint(kaa_user_manager_t *self, const char *endpoint_access_token, kaa_endpoint_status_listener_t *listener);
 
 
+/**
+ * @brief Attaches several external endpoints by their access tokens.
+ *
+ * The requests are sent in one sync and reported at once, when the server has answered all of them.
+ *
+ * @param[in]   self                      The user manager instance.
+ * @param[in]   endpoint_access_tokens    Null-terminated strings representing endpoint access tokens.
+ * @param[in]   count                     Amount of access tokens, up to UINT16_MAX.
+ * @param[in]   on_completed              Callback to receive the outcomes. May be NULL.
+ * @param[in]   context                   Context to pass to @p on_completed.
+ *
+ * @return      Error code.
+ */
+kaa_error_t kaa_user_manager_attach_endpoints(kaa_user_manager_t *self, const char *const *endpoint_access_tokens, size_t count,
+                                              on_endpoints_attached_fn on_completed, void *context);
+
+
 /**
  * @brief Detaches external endpoint by its access token.
  *
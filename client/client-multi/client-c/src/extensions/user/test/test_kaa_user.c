@@ -205,6 +205,79 @@ void test_failed_response(void **state)
 
 
 
+static size_t attach_batch_completions = 0;
+static kaa_endpoint_attach_result_t attach_batch_results[2];
+
+static void on_endpoints_attached(void *context, const kaa_endpoint_attach_result_t *results, size_t results_count)
+{
+    ASSERT_EQUAL(context, &attach_batch_completions);
+    ASSERT_EQUAL(results_count, 2);
+    memcpy(attach_batch_results, results, sizeof(attach_batch_results));
+    ++attach_batch_completions;
+}
+
+void test_attach_endpoints_batch(void **state)
+{
+    (void)state;
+
+    const char *access_tokens[] = { "token1", "another_token" };
+    ASSERT_EQUAL(kaa_user_manager_attach_endpoints(user_manager, access_tokens, 2, &on_endpoints_attached, &attach_batch_completions), KAA_ERR_NONE);
+
+    size_t expected_size = 0;
+    ASSERT_EQUAL(kaa_user_request_get_size(user_manager, &expected_size), KAA_ERR_NONE);
+    ASSERT_EQUAL(expected_size, KAA_EXTENSION_HEADER_SIZE + sizeof(uint32_t)
+                              + sizeof(uint32_t) + kaa_aligned_size_get(strlen(access_tokens[0]))
+                              + sizeof(uint32_t) + kaa_aligned_size_get(strlen(access_tokens[1])));
+
+    uint8_t buffer[expected_size];
+    kaa_platform_message_writer_t writer = KAA_MESSAGE_WRITER(buffer, expected_size);
+    ASSERT_EQUAL(kaa_user_request_serialize(user_manager, &writer), KAA_ERR_NONE);
+    ASSERT_EQUAL((size_t)(writer.current - buffer), expected_size);
+
+    uint8_t *buf_cursor = buffer + KAA_EXTENSION_HEADER_SIZE;
+    ASSERT_EQUAL(*buf_cursor, 0x01); /* Endpoint attach field */
+    ASSERT_EQUAL(KAA_NTOHS(*(uint16_t *)(buf_cursor + sizeof(uint16_t))), 2);
+    buf_cursor += sizeof(uint32_t);
+
+    uint16_t first_request_id = KAA_NTOHS(*(uint16_t *)buf_cursor);
+    ASSERT_EQUAL(KAA_NTOHS(*(uint16_t *)(buf_cursor + sizeof(uint16_t))), strlen(access_tokens[0]));
+    buf_cursor += sizeof(uint32_t);
+    ASSERT_EQUAL(memcmp(buf_cursor, access_tokens[0], strlen(access_tokens[0])), 0);
+    buf_cursor += kaa_aligned_size_get(strlen(access_tokens[0]));
+
+    ASSERT_EQUAL(KAA_NTOHS(*(uint16_t *)buf_cursor), first_request_id + 1);
+    ASSERT_EQUAL(KAA_NTOHS(*(uint16_t *)(buf_cursor + sizeof(uint16_t))), strlen(access_tokens[1]));
+    buf_cursor += sizeof(uint32_t);
+    ASSERT_EQUAL(memcmp(buf_cursor, access_tokens[1], strlen(access_tokens[1])), 0);
+
+    /* The requests are sent once */
+    ASSERT_EQUAL(kaa_user_request_get_size(user_manager, &expected_size), KAA_ERR_NONE);
+    ASSERT_EQUAL(expected_size, KAA_EXTENSION_HEADER_SIZE);
+
+    uint8_t second_id = (uint8_t)(first_request_id + 1);
+    uint8_t response[] = {
+            0x03, 0x00, 0x00, 0x01,                             /* Endpoint attach responses field, 1 response */
+            0x00, 0x01, 0x00, second_id,                        /* Success with the endpoint ID */
+            0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,
+            0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14,
+            0x03, 0x00, 0x00, 0x01,
+            0x01, 0x00, 0x00, (uint8_t)first_request_id,        /* Failure */
+    };
+    ASSERT_TRUE(first_request_id < UINT8_MAX);
+
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(response, 28);
+    ASSERT_EQUAL(kaa_user_handle_server_sync(user_manager, &reader, 0, 28), KAA_ERR_NONE);
+    ASSERT_EQUAL(attach_batch_completions, 0);
+
+    reader = KAA_MESSAGE_READER(response + 28, sizeof(response) - 28);
+    ASSERT_EQUAL(kaa_user_handle_server_sync(user_manager, &reader, 0, sizeof(response) - 28), KAA_ERR_NONE);
+    ASSERT_EQUAL(attach_batch_completions, 1);
+
+    ASSERT_FALSE(attach_batch_results[0].is_attached);
+    ASSERT_TRUE(attach_batch_results[1].is_attached);
+    ASSERT_EQUAL(memcmp(attach_batch_results[1].endpoint_id, response + 8, KAA_ENDPOINT_ID_LENGTH), 0);
+}
+
 int test_init(void)
 {
     kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -253,4 +326,5 @@ KAA_SUITE_MAIN(Log, test_init, test_deinit
        KAA_TEST_CASE(specified_user_verifier, test_specified_user_verifier)
        KAA_TEST_CASE(process_success_response, test_success_response)
        KAA_TEST_CASE(process_failed_response, test_failed_response)
+       KAA_TEST_CASE(attach_endpoints_batch, test_attach_endpoints_batch)
         )
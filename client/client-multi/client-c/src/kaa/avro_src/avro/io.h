@@ -22,12 +22,17 @@ extern "C" {
 #endif
 
 #include "platform.h"
+#include <stddef.h>
 #include <stdint.h>
 
+struct kaa_scratch_t;
+
 struct avro_reader_t_ {
     const char *buf;
     int64_t len;
     int64_t read;
+    int borrowed;
+    struct kaa_scratch_t *arena;
 };
 
 struct avro_writer_t_ {
@@ -40,8 +45,34 @@ typedef struct avro_reader_t_ *avro_reader_t;
 typedef struct avro_writer_t_ *avro_writer_t;
 
 avro_reader_t avro_reader_memory(const char *buf, int64_t len);
+/*
+ * Writes that don't fit into @buf fail with ENOSPC but are still counted in
+ * @written, so serializing into a short buffer tells the size it lacks.
+ */
 avro_writer_t avro_writer_memory(const char *buf, int64_t len);
 
+/*
+ * Creates a reader whose decoded strings and bytes point into @buf instead of
+ * being copied to the heap. Strings are NUL-terminated in place by shifting
+ * them one byte back over their length prefix, so @buf is modified and must
+ * outlive every value deserialized from it.
+ */
+avro_reader_t avro_reader_memory_borrowed(char *buf, int64_t len);
+int avro_reader_is_borrowed(avro_reader_t reader);
+
+/*
+ * While @arena is set, every value decoded through @reader is allocated from
+ * it, so the decoded tree is released at once by resetting or destroying the
+ * arena and must not be destroyed value by value. NULL restores the heap.
+ */
+void avro_reader_set_arena(avro_reader_t reader, struct kaa_scratch_t *arena);
+struct kaa_scratch_t *avro_reader_get_arena(avro_reader_t reader);
+
+/*
+ * Allocates @size bytes from the reader's arena, or from the heap if it has none.
+ */
+void *avro_reader_alloc(avro_reader_t reader, size_t size);
+
 int avro_read(avro_reader_t reader, void *buf, int64_t len);
 int avro_skip(avro_reader_t reader, int64_t len);
 int avro_write(avro_writer_t writer, void *buf, int64_t len);
@@ -81,7 +81,15 @@ static int read_bytes(avro_reader_t reader, char **bytes, int64_t * len)
     int rval;
     check_prefix(rval, read_long(reader, len),
              "Cannot read bytes length: ");
-    *bytes = (char *) KAA_MALLOC(*len);
+    if (reader->borrowed) {
+        if (*len < 0 || (reader->len - reader->read) < *len) {
+            return ENOSPC;
+        }
+        *bytes = (char *) reader->buf + reader->read;
+        reader->read += *len;
+        return 0;
+    }
+    *bytes = (char *) avro_reader_alloc(reader, *len);
     if (!*bytes) {
         return ENOMEM;
     }
@@ -109,7 +117,19 @@ static int read_string(avro_reader_t reader, char **s, int64_t *len)
     int rval;
     check_prefix(rval, read_long(reader, &str_len),
              "Cannot read string length: ");
-    *s = (char *) KAA_MALLOC(str_len + 1);
+    if (reader->borrowed) {
+        if (str_len < 0 || (reader->len - reader->read) < str_len) {
+            return ENOSPC;
+        }
+        /* The length prefix is at least one byte long, so the string can be
+         * moved back over its last byte to make room for the terminator. */
+        *s = (char *) reader->buf + reader->read - 1;
+        memmove(*s, *s + 1, str_len);
+        (*s)[str_len] = '\0';
+        reader->read += str_len;
+        return 0;
+    }
+    *s = (char *) avro_reader_alloc(reader, str_len + 1);
     if (!*s) {
         return ENOMEM;
     }
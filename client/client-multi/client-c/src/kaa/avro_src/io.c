@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <string.h>
 #include "utilities/kaa_mem.h"
+#include "utilities/kaa_scratch.h"
 
 #include "avro_private.h"
 
@@ -38,6 +39,40 @@ avro_reader_t avro_reader_memory(const char *buf, int64_t len)
     return mem_reader;
 }
 
+avro_reader_t avro_reader_memory_borrowed(char *buf, int64_t len)
+{
+    avro_reader_t mem_reader = avro_reader_memory(buf, len);
+    if (mem_reader) {
+        mem_reader->borrowed = 1;
+    }
+    return mem_reader;
+}
+
+int avro_reader_is_borrowed(avro_reader_t reader)
+{
+    return reader && reader->borrowed;
+}
+
+void avro_reader_set_arena(avro_reader_t reader, struct kaa_scratch_t *arena)
+{
+    if (reader) {
+        reader->arena = arena;
+    }
+}
+
+struct kaa_scratch_t *avro_reader_get_arena(avro_reader_t reader)
+{
+    return reader ? reader->arena : NULL;
+}
+
+void *avro_reader_alloc(avro_reader_t reader, size_t size)
+{
+    if (reader && reader->arena) {
+        return kaa_scratch_alloc(reader->arena, size);
+    }
+    return KAA_MALLOC(size);
+}
+
 avro_writer_t avro_writer_memory(const char *buf, int64_t len)
 {
     struct avro_writer_t_ *mem_writer = (struct avro_writer_t_ *) KAA_CALLOC(1,
@@ -97,6 +132,8 @@ static int avro_write_memory(struct avro_writer_t_ *writer, void *buf, int64_t l
 {
     if (len) {
         if ((writer->len - writer->written) < len) {
+            // Still counted, so the caller learns the size needed
+            writer->written += len;
             return ENOSPC;
         }
         memcpy((void *) (writer->buf + writer->written), buf, len);
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_hash_map.h"
+#include "kaa_common.h"
+#include "utilities/kaa_mem.h"
+
+#define KAA_HASH_MAP_MIN_CAPACITY    8
+
+typedef struct {
+    const void *key;        /* NULL marks an empty slot. */
+    void       *value;
+    uint32_t    hash;
+} kaa_hash_map_entry_t;
+
+struct kaa_hash_map_t {
+    kaa_hash_map_entry_t    *entries;
+    size_t                  capacity;   /* Zero or a power of two. */
+    size_t                  size;
+    kaa_hash_map_hash_fn    hash;
+    kaa_hash_map_equals_fn  equals;
+};
+
+kaa_hash_map_t *kaa_hash_map_create(kaa_hash_map_hash_fn hash, kaa_hash_map_equals_fn equals)
+{
+    KAA_RETURN_IF_NIL2(hash, equals, NULL);
+
+    kaa_hash_map_t *map = KAA_MALLOC(sizeof(kaa_hash_map_t));
+    KAA_RETURN_IF_NIL(map, NULL);
+
+    map->entries = NULL;
+    map->capacity = 0;
+    map->size = 0;
+    map->hash = hash;
+    map->equals = equals;
+    return map;
+}
+
+void kaa_hash_map_clear(kaa_hash_map_t *map, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL(map, );
+
+    if (deallocator) {
+        for (size_t i = 0; i < map->capacity; ++i) {
+            if (map->entries[i].key) {
+                deallocator(map->entries[i].value);
+            }
+        }
+    }
+
+    KAA_FREE(map->entries);
+    map->entries = NULL;
+    map->capacity = 0;
+    map->size = 0;
+}
+
+void kaa_hash_map_destroy(kaa_hash_map_t *map, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL(map, );
+    kaa_hash_map_clear(map, deallocator);
+    KAA_FREE(map);
+}
+
+size_t kaa_hash_map_get_size(const kaa_hash_map_t *map)
+{
+    KAA_RETURN_IF_NIL(map, 0);
+    return map->size;
+}
+
+static kaa_hash_map_entry_t *find_entry(const kaa_hash_map_t *map, const void *key, uint32_t hash)
+{
+    if (!map->capacity) {
+        return NULL;
+    }
+
+    size_t mask = map->capacity - 1;
+    for (size_t i = hash & mask; map->entries[i].key; i = (i + 1) & mask) {
+        if (map->entries[i].hash == hash && map->equals(map->entries[i].key, key)) {
+            return &map->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void insert_entry(kaa_hash_map_t *map, const kaa_hash_map_entry_t *entry)
+{
+    size_t mask = map->capacity - 1;
+    size_t i = entry->hash & mask;
+    while (map->entries[i].key) {
+        i = (i + 1) & mask;
+    }
+    map->entries[i] = *entry;
+}
+
+static kaa_error_t grow(kaa_hash_map_t *map)
+{
+    size_t capacity = map->capacity ? map->capacity * 2 : KAA_HASH_MAP_MIN_CAPACITY;
+    kaa_hash_map_entry_t *entries = KAA_CALLOC(capacity, sizeof(kaa_hash_map_entry_t));
+    KAA_RETURN_IF_NIL(entries, KAA_ERR_NOMEM);
+
+    kaa_hash_map_entry_t *old_entries = map->entries;
+    size_t old_capacity = map->capacity;
+
+    map->entries = entries;
+    map->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_entries[i].key) {
+            insert_entry(map, &old_entries[i]);
+        }
+    }
+
+    KAA_FREE(old_entries);
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_hash_map_put(kaa_hash_map_t *map, const void *key, void *value, void **old_value)
+{
+    KAA_RETURN_IF_NIL2(map, key, KAA_ERR_BADPARAM);
+
+    uint32_t hash = map->hash(key);
+    kaa_hash_map_entry_t *entry = find_entry(map, key, hash);
+    if (entry) {
+        if (old_value) {
+            *old_value = entry->value;
+        }
+        entry->key = key;
+        entry->value = value;
+        return KAA_ERR_NONE;
+    }
+
+    /* Keeps the load factor at or below 3/4. */
+    if ((map->size + 1) * 4 > map->capacity * 3) {
+        kaa_error_t error = grow(map);
+        if (error) {
+            return error;
+        }
+    }
+
+    kaa_hash_map_entry_t new_entry = { key, value, hash };
+    insert_entry(map, &new_entry);
+    ++map->size;
+
+    if (old_value) {
+        *old_value = NULL;
+    }
+    return KAA_ERR_NONE;
+}
+
+void *kaa_hash_map_get(const kaa_hash_map_t *map, const void *key)
+{
+    KAA_RETURN_IF_NIL2(map, key, NULL);
+    kaa_hash_map_entry_t *entry = find_entry(map, key, map->hash(key));
+    return entry ? entry->value : NULL;
+}
+
+void *kaa_hash_map_remove(kaa_hash_map_t *map, const void *key)
+{
+    KAA_RETURN_IF_NIL2(map, key, NULL);
+
+    kaa_hash_map_entry_t *entry = find_entry(map, key, map->hash(key));
+    KAA_RETURN_IF_NIL(entry, NULL);
+
+    void *value = entry->value;
+    size_t mask = map->capacity - 1;
+    size_t hole = (size_t)(entry - map->entries);
+
+    /*
+     * Backward shift deletion: entries of the same probe run that can't be
+     * reached past the hole anymore are moved into it, so no tombstones are needed.
+     */
+    for (size_t i = (hole + 1) & mask; map->entries[i].key; i = (i + 1) & mask) {
+        size_t home = map->entries[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            map->entries[hole] = map->entries[i];
+            hole = i;
+        }
+    }
+
+    map->entries[hole].key = NULL;
+    map->entries[hole].value = NULL;
+    --map->size;
+    return value;
+}
+
+void kaa_hash_map_for_each(kaa_hash_map_t *map, process_data process, void *context)
+{
+    KAA_RETURN_IF_NIL2(map, process, );
+
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->entries[i].key) {
+            process(map->entries[i].value, context);
+        }
+    }
+}
+
+/* 32-bit FNV-1a */
+uint32_t kaa_hash_map_string_hash(const void *key)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = key; *c; ++c) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+bool kaa_hash_map_string_equals(const void *key1, const void *key2)
+{
+    return !strcmp(key1, key2);
+}
+
+uint32_t kaa_hash_map_uint16_hash(const void *key)
+{
+    /* Fibonacci hashing spreads consecutive ids over the table. */
+    return (uint32_t)*(const uint16_t *)key * 2654435769u;
+}
+
+bool kaa_hash_map_uint16_equals(const void *key1, const void *key2)
+{
+    return *(const uint16_t *)key1 == *(const uint16_t *)key2;
+}
+
+uint32_t kaa_hash_map_uint64_hash(const void *key)
+{
+    uint64_t value = *(const uint64_t *)key;
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    return (uint32_t)value;
+}
+
+bool kaa_hash_map_uint64_equals(const void *key1, const void *key2)
+{
+    return *(const uint64_t *)key1 == *(const uint64_t *)key2;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file kaa_hash_map.h
+ * @brief Open-addressing hash map with linear probing.
+ *
+ * The map stores pointers only: keys usually point into the values they
+ * index (e.g. a name or an id field), so neither is copied. Keys must stay
+ * valid and unchanged while they are in the map.
+ */
+
+#ifndef KAA_HASH_MAP_H_
+#define KAA_HASH_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kaa_error.h"
+#include "kaa_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kaa_hash_map_t kaa_hash_map_t;
+
+typedef uint32_t (*kaa_hash_map_hash_fn)(const void *key);
+typedef bool (*kaa_hash_map_equals_fn)(const void *key1, const void *key2);
+
+/**
+ * @brief Creates an empty map.
+ * @retval NULL out of memory or any of the functions is @c NULL
+ */
+kaa_hash_map_t *kaa_hash_map_create(kaa_hash_map_hash_fn hash, kaa_hash_map_equals_fn equals);
+
+/**
+ * @brief Destroys the map, the values are passed to @p deallocator unless it is @c NULL.
+ */
+void kaa_hash_map_destroy(kaa_hash_map_t *map, deallocate_list_data deallocator);
+
+/**
+ * @brief Removes all entries, the values are passed to @p deallocator unless it is @c NULL.
+ */
+void kaa_hash_map_clear(kaa_hash_map_t *map, deallocate_list_data deallocator);
+
+size_t kaa_hash_map_get_size(const kaa_hash_map_t *map);
+
+/**
+ * @brief Maps @p key to @p value, replacing the existing entry with an equal key.
+ *
+ * @param[out] old_value The replaced value or @c NULL if there was none. May be @c NULL.
+ */
+kaa_error_t kaa_hash_map_put(kaa_hash_map_t *map, const void *key, void *value, void **old_value);
+
+/**
+ * @retval NULL no such key
+ */
+void *kaa_hash_map_get(const kaa_hash_map_t *map, const void *key);
+
+/**
+ * @brief Removes the entry and returns its value.
+ * @retval NULL no such key
+ */
+void *kaa_hash_map_remove(kaa_hash_map_t *map, const void *key);
+
+/**
+ * @brief Calls @p process for each value in unspecified order. The map must not be modified meanwhile.
+ */
+void kaa_hash_map_for_each(kaa_hash_map_t *map, process_data process, void *context);
+
+/** Hash and equality for null-terminated strings. */
+uint32_t kaa_hash_map_string_hash(const void *key);
+bool kaa_hash_map_string_equals(const void *key1, const void *key2);
+
+/** Hash and equality for @c uint16_t keys. */
+uint32_t kaa_hash_map_uint16_hash(const void *key);
+bool kaa_hash_map_uint16_equals(const void *key1, const void *key2);
+
+/** Hash and equality for @c uint64_t keys. */
+uint32_t kaa_hash_map_uint64_hash(const void *key);
+bool kaa_hash_map_uint64_equals(const void *key1, const void *key2);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_HASH_MAP_H_ */
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file kaa_intrusive_list.h
+ * @brief Doubly linked list whose nodes are embedded into the elements.
+ *
+ * Unlike @link kaa_list.h @endlink, the list never allocates: an element joins
+ * the list through its @ref kaa_intrusive_node_t member and can be unlinked in
+ * O(1) without a search. The list doesn't own its elements.
+ */
+
+#ifndef KAA_INTRUSIVE_LIST_H_
+#define KAA_INTRUSIVE_LIST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kaa_intrusive_node_t {
+    struct kaa_intrusive_node_t *next;
+    struct kaa_intrusive_node_t *prev;
+} kaa_intrusive_node_t;
+
+/**
+ * Circular list with a sentinel node. Must be initialized with
+ * kaa_intrusive_list_init() before use.
+ */
+typedef struct {
+    kaa_intrusive_node_t head;
+    size_t               size;
+} kaa_intrusive_list_t;
+
+/**
+ * @brief Returns the element that embeds @p node as its @p member.
+ */
+#define KAA_INTRUSIVE_ENTRY(node, type, member) \
+    ((type *)((char *)(node) - offsetof(type, member)))
+
+/**
+ * @brief Iterates over the nodes, @p node may be unlinked in the loop body.
+ */
+#define KAA_INTRUSIVE_LIST_FOR_EACH(node, next_node, list) \
+    for ((node) = (list)->head.next, (next_node) = (node)->next; \
+         (node) != &(list)->head; \
+         (node) = (next_node), (next_node) = (node)->next)
+
+static inline void kaa_intrusive_list_init(kaa_intrusive_list_t *list)
+{
+    list->head.next = list->head.prev = &list->head;
+    list->size = 0;
+}
+
+static inline bool kaa_intrusive_list_is_empty(const kaa_intrusive_list_t *list)
+{
+    return list->head.next == &list->head;
+}
+
+static inline size_t kaa_intrusive_list_get_size(const kaa_intrusive_list_t *list)
+{
+    return list->size;
+}
+
+static inline void kaa_intrusive_list_insert_before(kaa_intrusive_list_t *list,
+        kaa_intrusive_node_t *position, kaa_intrusive_node_t *node)
+{
+    node->next = position;
+    node->prev = position->prev;
+    position->prev->next = node;
+    position->prev = node;
+    ++list->size;
+}
+
+static inline void kaa_intrusive_list_push_back(kaa_intrusive_list_t *list, kaa_intrusive_node_t *node)
+{
+    kaa_intrusive_list_insert_before(list, &list->head, node);
+}
+
+static inline void kaa_intrusive_list_push_front(kaa_intrusive_list_t *list, kaa_intrusive_node_t *node)
+{
+    kaa_intrusive_list_insert_before(list, list->head.next, node);
+}
+
+static inline void kaa_intrusive_list_remove(kaa_intrusive_list_t *list, kaa_intrusive_node_t *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node->prev = NULL;
+    --list->size;
+}
+
+/**
+ * @brief Returns the first node or NULL if the list is empty.
+ */
+static inline kaa_intrusive_node_t *kaa_intrusive_list_front(kaa_intrusive_list_t *list)
+{
+    return kaa_intrusive_list_is_empty(list) ? NULL : list->head.next;
+}
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_INTRUSIVE_LIST_H_ */
@@ -20,6 +20,7 @@
 #include "kaa_list.h"
 #include "kaa_common.h"
 #include "utilities/kaa_mem.h"
+#include "utilities/kaa_scratch.h"
 
 
 
@@ -33,6 +34,7 @@ struct kaa_list_t {
     kaa_list_node_t    *head;
     kaa_list_node_t    *tail;
     size_t             size;
+    kaa_scratch_t      *scratch;    /**< Nodes and elements live there, if set */
 };
 
 static kaa_list_node_t *set_next_neighbor(kaa_list_node_t *whom, kaa_list_node_t *neighbor)
@@ -48,19 +50,24 @@ static kaa_list_node_t *set_next_neighbor(kaa_list_node_t *whom, kaa_list_node_t
     return neighbor;
 }
 
-static kaa_list_node_t *create_node(void *data)
+static kaa_list_node_t *create_node(kaa_list_t *list, void *data)
 {
     KAA_RETURN_IF_NIL(data, NULL);
-    kaa_list_node_t *node = (kaa_list_node_t *)KAA_MALLOC(sizeof(kaa_list_node_t));
+    kaa_list_node_t *node = list->scratch
+            ? (kaa_list_node_t *)kaa_scratch_alloc(list->scratch, sizeof(kaa_list_node_t))
+            : (kaa_list_node_t *)KAA_MALLOC(sizeof(kaa_list_node_t));
     KAA_RETURN_IF_NIL(node, NULL);
     node->data = data;
     node->next = node->prev = NULL;
     return node;
 }
 
-static void destroy_node(kaa_list_node_t *it, deallocate_list_data deallocator)
+static void destroy_node(kaa_list_t *list, kaa_list_node_t *it, deallocate_list_data deallocator)
 {
     KAA_RETURN_IF_NIL(it, );
+    if (list->scratch) {
+        return;
+    }
     if (deallocator) {
         (*deallocator)(it->data);
     } else {
@@ -121,10 +128,20 @@ kaa_list_t *kaa_list_create(void)
     return (kaa_list_t *) KAA_CALLOC(1, sizeof(kaa_list_t));
 }
 
+kaa_list_t *kaa_list_create_in_scratch(kaa_scratch_t *scratch)
+{
+    KAA_RETURN_IF_NIL(scratch, NULL);
+    kaa_list_t *list = (kaa_list_t *)kaa_scratch_alloc(scratch, sizeof(kaa_list_t));
+    KAA_RETURN_IF_NIL(list, NULL);
+    reset_list(list);
+    list->scratch = scratch;
+    return list;
+}
+
 kaa_list_node_t *kaa_list_push_front(kaa_list_t *list, void *data)
 {
     KAA_RETURN_IF_NIL2(list, data, NULL);
-    kaa_list_node_t *node = create_node(data);
+    kaa_list_node_t *node = create_node(list, data);
     KAA_RETURN_IF_NIL(node, NULL);
 
     ++list->size;
@@ -141,7 +158,7 @@ kaa_list_node_t *kaa_list_push_front(kaa_list_t *list, void *data)
 kaa_list_node_t *kaa_list_push_back(kaa_list_t *list, void *data)
 {
     KAA_RETURN_IF_NIL(list, NULL);
-    kaa_list_node_t *node = create_node(data);
+    kaa_list_node_t *node = create_node(list, data);
     KAA_RETURN_IF_NIL(node, NULL);
 
     ++list->size;
@@ -173,7 +190,7 @@ void kaa_list_clear(kaa_list_t *list, deallocate_list_data deallocator)
     kaa_list_node_t *it = list->head;
     while (it) {
         kaa_list_node_t *next = it->next;
-        destroy_node(it, deallocator);
+        destroy_node(list, it, deallocator);
         it = next;
     }
 
@@ -184,7 +201,9 @@ void kaa_list_destroy(kaa_list_t *list, deallocate_list_data deallocator)
 {
     KAA_RETURN_IF_NIL(list, );
     kaa_list_clear(list, deallocator);
-    KAA_FREE(list);
+    if (!list->scratch) {
+        KAA_FREE(list);
+    }
 }
 
 kaa_list_node_t *kaa_list_remove_at(kaa_list_t *list, kaa_list_node_t *it, deallocate_list_data deallocator)
@@ -200,7 +219,7 @@ kaa_list_node_t *kaa_list_remove_at(kaa_list_t *list, kaa_list_node_t *it, deall
     }
 
     set_next_neighbor(it->prev, next);
-    destroy_node(it, deallocator);
+    destroy_node(list, it, deallocator);
     --list->size;
 
     return next;
@@ -251,64 +270,91 @@ void kaa_list_for_each(kaa_list_node_t *first, kaa_list_node_t *last, process_da
     }
 }
 
-static kaa_list_node_t *kaa_split_util(kaa_list_node_t *head);
-
-
-static kaa_list_node_t *kaa_merge_util(kaa_list_node_t *first, kaa_list_node_t *second, match_predicate pred)
+/*
+ * Detaches the first @p count nodes of the chain starting at @p head and returns the rest.
+ */
+static kaa_list_node_t *kaa_split_util(kaa_list_node_t *head, size_t count)
 {
-    KAA_RETURN_IF_NIL(first, second);
-    KAA_RETURN_IF_NIL(second, first);
-
-    if (pred(first->data, second->data)) {
-
-        first->next = kaa_merge_util(first->next, second, pred);
-        first->next->prev = first;
-        first->prev = NULL;
-
-        return first;
-    } else {
-        second->next = kaa_merge_util(first, second->next, pred);
-        second->next->prev = second;
-        second->prev = NULL;
-        return second;
+    while (head && --count) {
+        head = head->next;
     }
-}
-
-static kaa_list_node_t *kaa_merge_sort(kaa_list_node_t *head, match_predicate pred)
-{
-    KAA_RETURN_IF_NIL2(head, head->next, head);
 
-    kaa_list_node_t *second = kaa_split_util(head);
-
-    head = kaa_merge_sort(head, pred);
-    second = kaa_merge_sort(second, pred);
-
-    head = kaa_merge_util(head, second, pred);
-    return head;
+    KAA_RETURN_IF_NIL(head, NULL);
+    kaa_list_node_t *rest = head->next;
+    head->next = NULL;
+    return rest;
 }
 
-static kaa_list_node_t *kaa_split_util( kaa_list_node_t *head)
+/*
+ * Merges two sorted chains linked by the next pointers only. On ties nodes of
+ * @p first go first, which keeps the sort stable.
+ */
+static kaa_list_node_t *kaa_merge_util(kaa_list_node_t *first, kaa_list_node_t *second,
+        match_predicate pred, kaa_list_node_t **tail)
 {
-    kaa_list_node_t *fast = head;
-    kaa_list_node_t *slow = head;
-    while (fast->next && fast->next->next) {
-        fast = fast->next->next;
-        slow = slow->next;
+    kaa_list_node_t head;
+    kaa_list_node_t *last = &head;
+
+    while (first && second) {
+        if (pred(second->data, first->data)) {
+            last->next = second;
+            second = second->next;
+        } else {
+            last->next = first;
+            first = first->next;
+        }
+        last = last->next;
     }
-    kaa_list_node_t *temp = slow->next;
-    slow->next = NULL;
-    return temp;
+
+    last->next = first ? first : second;
+    while (last->next) {
+        last = last->next;
+    }
+
+    *tail = last;
+    return head.next;
 }
 
+/*
+ * Bottom-up merge sort: runs of 1, 2, 4... nodes are merged pairwise until one
+ * run is left. Needs neither recursion nor allocation.
+ */
 void kaa_list_sort(kaa_list_t *list, match_predicate pred)
 {
+    KAA_RETURN_IF_NIL2(list, pred, );
     KAA_RETURN_IF_NIL(list->size,);
-    kaa_list_node_t *node = kaa_merge_sort(kaa_list_begin(list), pred);
-    list->head = node;
-    while (node->next) {
-        node = node->next;
+
+    kaa_list_node_t *head = list->head;
+    for (size_t width = 1; width < list->size; width *= 2) {
+        kaa_list_node_t *rest = head;
+        kaa_list_node_t *tail = NULL;
+        head = NULL;
+
+        while (rest) {
+            kaa_list_node_t *first = rest;
+            kaa_list_node_t *second = kaa_split_util(first, width);
+            rest = kaa_split_util(second, width);
+
+            kaa_list_node_t *merged_tail;
+            kaa_list_node_t *merged = kaa_merge_util(first, second, pred, &merged_tail);
+            if (tail) {
+                tail->next = merged;
+            } else {
+                head = merged;
+            }
+            tail = merged_tail;
+        }
     }
-    list->tail = node;
+
+    /* Restores the back links. */
+    kaa_list_node_t *prev = NULL;
+    for (kaa_list_node_t *node = head; node; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+
+    list->head = head;
+    list->tail = prev;
 }
 
 int32_t kaa_list_hash(kaa_list_t *list, list_node_hash pred)
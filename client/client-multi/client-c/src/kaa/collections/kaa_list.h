@@ -25,6 +25,7 @@ extern "C" {
 #include <stddef.h>
 
 #include "kaa_error.h"
+#include "utilities/kaa_scratch.h"
 
 typedef struct kaa_list_node_t kaa_list_node_t;
 typedef struct kaa_list_t kaa_list_t;
@@ -55,6 +56,17 @@ typedef void (*process_data)(void *data, void *context);
  */
 kaa_list_t *kaa_list_create(void);
 
+/**
+ * @brief Creates empty list whose nodes are allocated from @p scratch.
+ *
+ * The list doesn't own its elements: they are expected to live in the same
+ * scratch arena, so removing or destroying them neither calls the deallocator
+ * nor frees anything. Everything is released by resetting the arena.
+ *
+ * @return The list object or NULL if the arena is out of memory.
+ */
+kaa_list_t *kaa_list_create_in_scratch(kaa_scratch_t *scratch);
+
 /**
  * @brief Destroys list and all elements.
  */
@@ -158,8 +170,11 @@ void kaa_list_for_each(kaa_list_node_t *first, kaa_list_node_t *last, process_da
 
 /**
  * @brief Sorts list according to predicate condition.
+ *
+ * Stable O(n log n) merge sort, the nodes are relinked in place without allocations.
+ *
  * @param list  List to sort.
- * @param pred  Predicate that is used to sort list.
+ * @param pred  Predicate that is used to sort list, returns @b true if the first element goes before the second.
  */
 void kaa_list_sort(kaa_list_t *list, match_predicate pred);
 
@@ -25,6 +25,7 @@ extern "C" {
 
 typedef kaa_configuration_root_record_t kaa_root_configuration_t;
 # define KAA_CONFIGURATION_DESERIALIZE(reader)  kaa_configuration_root_record_deserialize(reader)
+# define KAA_CONFIGURATION_DESERIALIZE_INTO_ARENA(reader, arena)  kaa_configuration_root_record_deserialize_into_arena(reader, arena)
 
 # ifdef __cplusplus
 }      /* extern "C" */
@@ -126,9 +126,14 @@ kaa_union_t *kaa_union_null_or_fixed_branch_1_create(void)
 
 kaa_union_t *kaa_union_null_or_fixed_deserialize(avro_reader_t reader)
 {
-    kaa_union_t *kaa_union = kaa_union_null_or_fixed_create();
+    kaa_union_t *kaa_union = (kaa_union_t *)avro_reader_alloc(reader, sizeof(kaa_union_t));
 
     if (kaa_union) {
+        kaa_union->serialize = kaa_union_null_or_fixed_serialize;
+        kaa_union->get_size = kaa_union_null_or_fixed_get_size;
+        kaa_union->destroy = avro_reader_get_arena(reader) ? kaa_null_destroy : kaa_union_null_or_fixed_destroy;
+        kaa_union->data = NULL;
+
         int64_t branch;
         avro_binary_encoding.read_long(reader, &branch);
         kaa_union->type = branch;
@@ -204,12 +209,12 @@ kaa_configuration_root_record_t *kaa_configuration_root_record_create(void)
 kaa_configuration_root_record_t *kaa_configuration_root_record_deserialize(avro_reader_t reader)
 {
     kaa_configuration_root_record_t *record = 
-            (kaa_configuration_root_record_t *)KAA_MALLOC(sizeof(kaa_configuration_root_record_t));
+            (kaa_configuration_root_record_t *)avro_reader_alloc(reader, sizeof(kaa_configuration_root_record_t));
 
     if (record) {
         record->serialize = kaa_configuration_root_record_serialize;
         record->get_size = kaa_configuration_root_record_get_size;
-        record->destroy = kaa_configuration_root_record_destroy;
+        record->destroy = avro_reader_get_arena(reader) ? kaa_null_destroy : kaa_configuration_root_record_destroy;
 
         record->data = kaa_string_deserialize(reader);
         record->__uuid = kaa_union_null_or_fixed_deserialize(reader);
@@ -218,3 +223,17 @@ kaa_configuration_root_record_t *kaa_configuration_root_record_deserialize(avro_
     return record;
 }
 
+kaa_configuration_root_record_t *kaa_configuration_root_record_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena)
+{
+    if (!reader || !arena) {
+        return NULL;
+    }
+
+    kaa_scratch_t *previous_arena = avro_reader_get_arena(reader);
+    avro_reader_set_arena(reader, arena);
+    kaa_configuration_root_record_t *record = kaa_configuration_root_record_deserialize(reader);
+    avro_reader_set_arena(reader, previous_arena);
+
+    return record;
+}
+
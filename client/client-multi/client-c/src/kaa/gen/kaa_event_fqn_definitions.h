@@ -23,31 +23,50 @@
 # ifndef KAA_FQN_DEFINITIONS_
 # define KAA_FQN_DEFINITIONS_
 
+# include <stddef.h>
+# include <stdbool.h>
+# include <stdint.h>
+
+/*
+ * Compile-time ids of the event FQNs. The events sent and the callbacks
+ * registered by id refer to the static FQN strings rather than copy them.
+ */
+typedef enum {
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAY_COMMAND,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_REWIND_COMMAND,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_PAUSE_COMMAND,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_STOP_COMMAND,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_PLAYBACK_STATUS,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_BATTERY_CHARGING_STATUS,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_BATTERY_STATUS,
+    KAA_EVENT_FQN_TEST_EVENT_FAMILY_STATUS_EVENT,
+    KAA_EVENT_FQNS_COUNT
+} kaa_event_fqn_id_t;
+
 typedef struct {
-    char       *ecf_name;
-    size_t      supported_incoming_fqns_count;
-    char      **supported_incoming_fqns;
-} event_class_family_t;
-
-static const char *TestEventFamilyFQNS[8] = {
-        "org.kaaproject.kaa.example.audio.PlayCommand",
-        "org.kaaproject.kaa.example.audio.RewindCommand",
-        "org.kaaproject.kaa.example.audio.PauseCommand",
-        "org.kaaproject.kaa.example.audio.StopCommand",
-        "org.kaaproject.kaa.example.audio.PlaybackStatus",
-        "org.kaaproject.kaa.example.audio.BatteryChargingStatus",
-        "org.kaaproject.kaa.example.audio.BatteryStatus",
-        "org.kaaproject.kaa.example.audio.StatusEvent"
-};
-
-# define SUPPORTED_EVENT_CLASS_FAMILIES_SIZE 1
-
-static const event_class_family_t SUPPORTED_EVENT_CLASS_FAMILIES[SUPPORTED_EVENT_CLASS_FAMILIES_SIZE] =
+    const char *fqn;
+    uint16_t    fqn_length;
+    bool        incoming;       /**< Supported as an incoming event */
+    const char *ecf_name;
+} kaa_event_fqn_t;
+
+/*
+ * Returns the FQN with the given id, NULL if there is none.
+ */
+static inline const kaa_event_fqn_t *kaa_event_fqn_get(kaa_event_fqn_id_t id)
 {
-    {
-        /* .ecf_name = */                       "TestEventFamily",
-        /* .supported_incoming_fqns_count = */  8,
-        /* .supported_incoming_fqns = */        (char **)TestEventFamilyFQNS
-    }
-};
+    static const kaa_event_fqn_t fqns[KAA_EVENT_FQNS_COUNT + 1] = {
+        { "org.kaaproject.kaa.example.audio.PlayCommand", sizeof("org.kaaproject.kaa.example.audio.PlayCommand") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.RewindCommand", sizeof("org.kaaproject.kaa.example.audio.RewindCommand") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.PauseCommand", sizeof("org.kaaproject.kaa.example.audio.PauseCommand") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.StopCommand", sizeof("org.kaaproject.kaa.example.audio.StopCommand") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.PlaybackStatus", sizeof("org.kaaproject.kaa.example.audio.PlaybackStatus") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.BatteryChargingStatus", sizeof("org.kaaproject.kaa.example.audio.BatteryChargingStatus") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.BatteryStatus", sizeof("org.kaaproject.kaa.example.audio.BatteryStatus") - 1, true, "TestEventFamily" },
+        { "org.kaaproject.kaa.example.audio.StatusEvent", sizeof("org.kaaproject.kaa.example.audio.StatusEvent") - 1, true, "TestEventFamily" },
+        { NULL, 0, false, NULL }
+    };
+
+    return (size_t)id < KAA_EVENT_FQNS_COUNT ? &fqns[id] : NULL;
+}
 # endif
@@ -29,6 +29,7 @@ extern "C" {
 typedef kaa_test_log_record_t    kaa_user_log_record_t;
 
 # define KAA_LOGGING_DESERIALIZE(reader)  kaa_test_log_record_deserialize(reader)
+# define KAA_LOGGING_DESERIALIZE_INTO_ARENA(reader, arena)  kaa_test_log_record_deserialize_into_arena(reader, arena)
 
 # ifdef __cplusplus
 }      /* extern "C" */
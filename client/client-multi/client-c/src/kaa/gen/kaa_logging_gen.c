@@ -77,12 +77,12 @@ kaa_test_log_record_t *kaa_test_log_record_create(void)
 kaa_test_log_record_t *kaa_test_log_record_deserialize(avro_reader_t reader)
 {
     kaa_test_log_record_t *record = 
-            (kaa_test_log_record_t *)KAA_MALLOC(sizeof(kaa_test_log_record_t));
+            (kaa_test_log_record_t *)avro_reader_alloc(reader, sizeof(kaa_test_log_record_t));
 
     if (record) {
         record->serialize = kaa_test_log_record_serialize;
         record->get_size = kaa_test_log_record_get_size;
-        record->destroy = kaa_test_log_record_destroy;
+        record->destroy = avro_reader_get_arena(reader) ? kaa_null_destroy : kaa_test_log_record_destroy;
 
         record->data = kaa_string_deserialize(reader);
     }
@@ -90,3 +90,17 @@ kaa_test_log_record_t *kaa_test_log_record_deserialize(avro_reader_t reader)
     return record;
 }
 
+kaa_test_log_record_t *kaa_test_log_record_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena)
+{
+    if (!reader || !arena) {
+        return NULL;
+    }
+
+    kaa_scratch_t *previous_arena = avro_reader_get_arena(reader);
+    avro_reader_set_arena(reader, arena);
+    kaa_test_log_record_t *record = kaa_test_log_record_deserialize(reader);
+    avro_reader_set_arena(reader, previous_arena);
+
+    return record;
+}
+
@@ -36,6 +36,12 @@ typedef struct {
 kaa_test_log_record_t *kaa_test_log_record_create(void);
 kaa_test_log_record_t *kaa_test_log_record_deserialize(avro_reader_t reader);
 
+/*
+ * Deserializes the record with all its fields allocated from @p arena, which
+ * releases them at once. The record must not be destroyed by its destroy().
+ */
+kaa_test_log_record_t *kaa_test_log_record_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena);
+
 #ifdef __cplusplus
 }      /* extern "C" */
 #endif
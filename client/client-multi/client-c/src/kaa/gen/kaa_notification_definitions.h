@@ -25,6 +25,7 @@ extern "C" {
 
 typedef kaa_notification_notification_t kaa_notification_t;
 # define KAA_NOTIFICATION_DESERIALIZE(reader)  kaa_notification_notification_deserialize(reader)
+# define KAA_NOTIFICATION_DESERIALIZE_INTO_ARENA(reader, arena)  kaa_notification_notification_deserialize_into_arena(reader, arena)
 
 # ifdef __cplusplus
 }      /* extern "C" */
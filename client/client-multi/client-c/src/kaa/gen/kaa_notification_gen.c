@@ -77,12 +77,12 @@ kaa_notification_notification_t *kaa_notification_notification_create(void)
 kaa_notification_notification_t *kaa_notification_notification_deserialize(avro_reader_t reader)
 {
     kaa_notification_notification_t *record = 
-            (kaa_notification_notification_t *)KAA_MALLOC(sizeof(kaa_notification_notification_t));
+            (kaa_notification_notification_t *)avro_reader_alloc(reader, sizeof(kaa_notification_notification_t));
 
     if (record) {
         record->serialize = kaa_notification_notification_serialize;
         record->get_size = kaa_notification_notification_get_size;
-        record->destroy = kaa_notification_notification_destroy;
+        record->destroy = avro_reader_get_arena(reader) ? kaa_null_destroy : kaa_notification_notification_destroy;
 
         record->message = kaa_string_deserialize(reader);
     }
@@ -90,3 +90,17 @@ kaa_notification_notification_t *kaa_notification_notification_deserialize(avro_
     return record;
 }
 
+kaa_notification_notification_t *kaa_notification_notification_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena)
+{
+    if (!reader || !arena) {
+        return NULL;
+    }
+
+    kaa_scratch_t *previous_arena = avro_reader_get_arena(reader);
+    avro_reader_set_arena(reader, arena);
+    kaa_notification_notification_t *record = kaa_notification_notification_deserialize(reader);
+    avro_reader_set_arena(reader, previous_arena);
+
+    return record;
+}
+
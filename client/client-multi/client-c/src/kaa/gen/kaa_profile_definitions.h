@@ -29,6 +29,7 @@ extern "C" {
 typedef kaa_profile_basic_endpoint_profile_test_t kaa_profile_t;
 
 # define KAA_PROFILE_DESERIALIZE(reader)  kaa_profile_basic_endpoint_profile_test_deserialize(reader)
+# define KAA_PROFILE_DESERIALIZE_INTO_ARENA(reader, arena)  kaa_profile_basic_endpoint_profile_test_deserialize_into_arena(reader, arena)
 
 # ifdef __cplusplus
 }      /* extern "C" */
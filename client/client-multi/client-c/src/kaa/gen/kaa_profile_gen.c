@@ -77,12 +77,12 @@ kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_te
 kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_test_deserialize(avro_reader_t reader)
 {
     kaa_profile_basic_endpoint_profile_test_t *record = 
-            (kaa_profile_basic_endpoint_profile_test_t *)KAA_MALLOC(sizeof(kaa_profile_basic_endpoint_profile_test_t));
+            (kaa_profile_basic_endpoint_profile_test_t *)avro_reader_alloc(reader, sizeof(kaa_profile_basic_endpoint_profile_test_t));
 
     if (record) {
         record->serialize = kaa_profile_basic_endpoint_profile_test_serialize;
         record->get_size = kaa_profile_basic_endpoint_profile_test_get_size;
-        record->destroy = kaa_profile_basic_endpoint_profile_test_destroy;
+        record->destroy = avro_reader_get_arena(reader) ? kaa_null_destroy : kaa_profile_basic_endpoint_profile_test_destroy;
 
         record->profile_body = kaa_string_deserialize(reader);
     }
@@ -90,3 +90,17 @@ kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_te
     return record;
 }
 
+kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_test_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena)
+{
+    if (!reader || !arena) {
+        return NULL;
+    }
+
+    kaa_scratch_t *previous_arena = avro_reader_get_arena(reader);
+    avro_reader_set_arena(reader, arena);
+    kaa_profile_basic_endpoint_profile_test_t *record = kaa_profile_basic_endpoint_profile_test_deserialize(reader);
+    avro_reader_set_arena(reader, previous_arena);
+
+    return record;
+}
+
@@ -36,6 +36,12 @@ typedef struct {
 kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_test_create(void);
 kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_test_deserialize(avro_reader_t reader);
 
+/*
+ * Deserializes the record with all its fields allocated from @p arena, which
+ * releases them at once. The record must not be destroyed by its destroy().
+ */
+kaa_profile_basic_endpoint_profile_test_t *kaa_profile_basic_endpoint_profile_test_deserialize_into_arena(avro_reader_t reader, kaa_scratch_t *arena);
+
 #ifdef __cplusplus
 }      /* extern "C" */
 #endif
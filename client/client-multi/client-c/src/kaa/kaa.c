@@ -66,8 +66,8 @@ static kaa_error_t kaa_context_create(kaa_context_t **context_p, kaa_logger_t *l
         goto exit;
     }
 
-    error = kaa_platform_protocol_create(&context->platform_protocol, context->logger,
-            context->status->status_instance);
+    error = kaa_platform_protocol_create(&context->platform_protocol, context,
+            context->logger, context->status->status_instance);
     if (error) {
         goto exit;
     }
@@ -92,7 +92,7 @@ static kaa_error_t kaa_context_create(kaa_context_t **context_p, kaa_logger_t *l
     return KAA_ERR_NONE;
 
 extensions_deinit:
-    kaa_extension_deinit_all();
+    kaa_extension_deinit_all(context);
 
 exit:
     kaa_context_destroy(context);
@@ -104,6 +104,7 @@ static kaa_error_t kaa_context_destroy(kaa_context_t *context)
 {
     KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
 
+    kaa_extension_deinit_all(context);
     kaa_channel_manager_destroy(context->channel_manager);
     kaa_status_destroy(context->status->status_instance);
     kaa_failover_strategy_destroy(context->failover_strategy);
@@ -219,6 +220,12 @@ bool kaa_process_failover(kaa_context_t *kaa_context)
     return kaa_bootstrap_manager_process_failover(kaa_context->bootstrap_manager);
 }
 
+size_t kaa_get_failover_timeout(kaa_context_t *kaa_context)
+{
+    KAA_RETURN_IF_NIL(kaa_context, SIZE_MAX);
+    return kaa_bootstrap_manager_get_failover_timeout(kaa_context->bootstrap_manager);
+}
+
 kaa_error_t kaa_context_set_status_registered(kaa_context_t *kaa_context, bool is_registered)
 {
     KAA_RETURN_IF_NIL(kaa_context, KAA_ERR_BADPARAM);
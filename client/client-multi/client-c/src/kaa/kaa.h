@@ -94,6 +94,19 @@ bool kaa_process_failover(kaa_context_t *kaa_context);
 
 
 
+/**
+ * @brief Retrieves the time left until the scheduled failover is executed.
+ *
+ * While a failover is scheduled, @link kaa_process_failover @endlink keeps returning
+ * true and the client has nothing else to do, so the platform may sleep until then.
+ *
+ * @param[in]   kaa_context    Pointer to an initialized Kaa endpoint context.
+ * @return      The timeout in seconds, SIZE_MAX if no failover is scheduled.
+ */
+size_t kaa_get_failover_timeout(kaa_context_t *kaa_context);
+
+
+
 /**
  * @brief Checks if Kaa context is initialized and ready to be used.
  *
@@ -44,6 +44,12 @@ typedef enum {
     KAA_EXTENSION_NOTIFICATION  = 6,
 } kaa_extension_id;
 
+/**
+ * @brief The bound of extension ids. Extension contexts are kept in
+ * @link kaa_context_t @endlink indexed by id.
+ */
+#define KAA_EXTENSION_ID_COUNT 32
+
 /*
  * Standard error handling macros
  */
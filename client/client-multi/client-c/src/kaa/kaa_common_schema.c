@@ -29,6 +29,17 @@
 
 
 
+/*
+ * Values decoded into an arena are freed with the arena. Strings and bytes are decoded
+ * in place or into the same block as their value, so they are never freed on their own.
+ */
+static void kaa_deserialized_free(avro_reader_t reader, void *data)
+{
+    if (!avro_reader_get_arena(reader)) {
+        KAA_FREE(data);
+    }
+}
+
 size_t avro_long_get_size(int64_t l)
 {
     int64_t len = 0;
@@ -68,18 +79,13 @@ kaa_string_t *kaa_string_copy_create(const char *data)
 {
     KAA_RETURN_IF_NIL(data, NULL);
 
-    kaa_string_t *str = (kaa_string_t *)KAA_MALLOC(sizeof(kaa_string_t));
-    KAA_RETURN_IF_NIL(str, NULL);
-
     size_t len = strlen(data) + 1;
-    str->data = (char *)KAA_MALLOC(len * sizeof(char));
-    if (!str->data) {
-        KAA_FREE(str);
-        return NULL;
-    }
+    kaa_string_t *str = (kaa_string_t *)KAA_MALLOC(sizeof(kaa_string_t) + len * sizeof(char));
+    KAA_RETURN_IF_NIL(str, NULL);
 
+    str->data = (char *)(str + 1);
     memcpy(str->data, data, len);
-    str->destroy = &kaa_data_destroy;
+    str->destroy = NULL;
 
     return str;
 }
@@ -99,11 +105,30 @@ kaa_string_t *kaa_string_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    kaa_string_t *str = (kaa_string_t *)KAA_MALLOC(sizeof(kaa_string_t));
+    if (avro_reader_is_borrowed(reader)) {
+        kaa_string_t *str = (kaa_string_t *)avro_reader_alloc(reader, sizeof(kaa_string_t));
+        KAA_RETURN_IF_NIL(str, NULL);
+
+        avro_binary_encoding.read_string(reader, &str->data, NULL);
+        str->destroy = NULL;
+        return str;
+    }
+
+    int64_t len = 0;
+    if (avro_binary_encoding.read_long(reader, &len) || len < 0) {
+        return NULL;
+    }
+
+    kaa_string_t *str = (kaa_string_t *)avro_reader_alloc(reader, sizeof(kaa_string_t) + len + 1);
     KAA_RETURN_IF_NIL(str, NULL);
 
-    avro_binary_encoding.read_string(reader, &str->data, NULL);
-    str->destroy = kaa_data_destroy;
+    str->data = (char *)(str + 1);
+    str->destroy = NULL;
+    if (avro_read(reader, str->data, len)) {
+        kaa_deserialized_free(reader, str);
+        return NULL;
+    }
+    str->data[len] = '\0';
 
     return str;
 }
@@ -138,18 +163,13 @@ kaa_bytes_t *kaa_bytes_copy_create(const uint8_t *data, size_t data_len)
 {
     KAA_RETURN_IF_NIL2(data, data_len, NULL);
 
-    kaa_bytes_t *bytes_array = (kaa_bytes_t *)KAA_MALLOC(sizeof(kaa_bytes_t));
+    kaa_bytes_t *bytes_array = (kaa_bytes_t *)KAA_MALLOC(sizeof(kaa_bytes_t) + sizeof(uint8_t) * data_len);
     KAA_RETURN_IF_NIL(bytes_array, NULL);
 
-    bytes_array->buffer = (uint8_t *)KAA_MALLOC(sizeof(uint8_t) * data_len);
-    if (!bytes_array->buffer) {
-        KAA_FREE(bytes_array);
-        return NULL;
-    }
-
+    bytes_array->buffer = (uint8_t *)(bytes_array + 1);
     memcpy(bytes_array->buffer, data, data_len);
     bytes_array->size = data_len;
-    bytes_array->destroy = &kaa_data_destroy;
+    bytes_array->destroy = NULL;
 
     return bytes_array;
 }
@@ -169,13 +189,31 @@ kaa_bytes_t *kaa_bytes_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    kaa_bytes_t *bytes = (kaa_bytes_t *)KAA_MALLOC(sizeof(kaa_bytes_t));
+    int64_t size = 0;
+    if (avro_reader_is_borrowed(reader)) {
+        kaa_bytes_t *bytes = (kaa_bytes_t *)avro_reader_alloc(reader, sizeof(kaa_bytes_t));
+        KAA_RETURN_IF_NIL(bytes, NULL);
+
+        avro_binary_encoding.read_bytes(reader, (char **)&bytes->buffer, &size);
+        bytes->size = size;
+        bytes->destroy = NULL;
+        return bytes;
+    }
+
+    if (avro_binary_encoding.read_long(reader, &size) || size < 0) {
+        return NULL;
+    }
+
+    kaa_bytes_t *bytes = (kaa_bytes_t *)avro_reader_alloc(reader, sizeof(kaa_bytes_t) + size);
     KAA_RETURN_IF_NIL(bytes, NULL);
 
-    int64_t size;
-    avro_binary_encoding.read_bytes(reader, (char **)&bytes->buffer, &size);
+    bytes->buffer = (uint8_t *)(bytes + 1);
     bytes->size = size;
-    bytes->destroy = kaa_data_destroy;
+    bytes->destroy = NULL;
+    if (avro_read(reader, bytes->buffer, size)) {
+        kaa_deserialized_free(reader, bytes);
+        return NULL;
+    }
 
     return bytes;
 }
@@ -223,17 +261,30 @@ kaa_bytes_t *kaa_fixed_deserialize(avro_reader_t reader, void *context)
 {
     KAA_RETURN_IF_NIL2(reader, context, NULL);
 
-    kaa_bytes_t *bytes = (kaa_bytes_t *)KAA_MALLOC(sizeof(kaa_bytes_t));
+    size_t size = *(size_t *)context;
+    int is_borrowed = avro_reader_is_borrowed(reader);
+
+    kaa_bytes_t *bytes = (kaa_bytes_t *)avro_reader_alloc(reader,
+            sizeof(kaa_bytes_t) + (is_borrowed ? 0 : size * sizeof(uint8_t)));
     KAA_RETURN_IF_NIL(bytes, NULL);
-    bytes->buffer = (uint8_t*)KAA_MALLOC((*(size_t *)context) * sizeof(uint8_t));
-    if (!bytes->buffer) {
-        KAA_FREE(bytes);
-        return NULL;
+
+    bytes->size = size;
+    bytes->destroy = NULL;
+
+    if (is_borrowed) {
+        bytes->buffer = (uint8_t *)reader->buf + reader->read;
+        if (avro_skip(reader, bytes->size)) {
+            kaa_deserialized_free(reader, bytes);
+            return NULL;
+        }
+        return bytes;
     }
 
-    avro_read(reader, (void *)bytes->buffer, (*(size_t *)context));
-    bytes->size = (*(size_t *)context);
-    bytes->destroy = kaa_data_destroy;
+    bytes->buffer = (uint8_t *)(bytes + 1);
+    if (avro_read(reader, (void *)bytes->buffer, size)) {
+        kaa_deserialized_free(reader, bytes);
+        return NULL;
+    }
 
     return bytes;
 }
@@ -255,7 +306,7 @@ int8_t* kaa_boolean_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    int8_t* data = (int8_t*)KAA_MALLOC(sizeof(int8_t));
+    int8_t* data = (int8_t*)avro_reader_alloc(reader, sizeof(int8_t));
     KAA_RETURN_IF_NIL(data, NULL);
     avro_binary_encoding.read_boolean(reader, data);
     return data;
@@ -277,7 +328,7 @@ int32_t *kaa_int_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    int32_t *data = (int32_t *)KAA_MALLOC(sizeof(int32_t));
+    int32_t *data = (int32_t *)avro_reader_alloc(reader, sizeof(int32_t));
     KAA_RETURN_IF_NIL(data, NULL);
     avro_binary_encoding.read_int(reader, data);
     return data;
@@ -299,7 +350,7 @@ int64_t *kaa_long_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    int64_t *data = (int64_t *)KAA_MALLOC(sizeof(int64_t));
+    int64_t *data = (int64_t *)avro_reader_alloc(reader, sizeof(int64_t));
     KAA_RETURN_IF_NIL(data, NULL);
     avro_binary_encoding.read_long(reader, data);
     return data;
@@ -321,7 +372,7 @@ int *kaa_enum_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    int *data = (int *)KAA_MALLOC(sizeof(int));
+    int *data = (int *)avro_reader_alloc(reader, sizeof(int));
     KAA_RETURN_IF_NIL(data, NULL);
     int64_t value;
     avro_binary_encoding.read_long(reader, &value);
@@ -345,7 +396,7 @@ float *kaa_float_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    float *data = (float *)KAA_MALLOC(sizeof(float));
+    float *data = (float *)avro_reader_alloc(reader, sizeof(float));
     KAA_RETURN_IF_NIL(data, NULL);
     avro_binary_encoding.read_float(reader, data);
     return data;
@@ -367,7 +418,7 @@ double *kaa_double_deserialize(avro_reader_t reader)
 {
     KAA_RETURN_IF_NIL(reader, NULL);
 
-    double* data = (double *)KAA_MALLOC(sizeof(double));
+    double* data = (double *)avro_reader_alloc(reader, sizeof(double));
     KAA_RETURN_IF_NIL(data, NULL);
     avro_binary_encoding.read_double(reader, data);
     return data;
@@ -412,7 +463,8 @@ static kaa_list_t *kaa_array_deserialize(avro_reader_t reader, deserialize_fn de
 {
     KAA_RETURN_IF_NIL2(reader, deserialize, NULL);
 
-    kaa_list_t *array = kaa_list_create();
+    kaa_scratch_t *arena = avro_reader_get_arena(reader);
+    kaa_list_t *array = arena ? kaa_list_create_in_scratch(arena) : kaa_list_create();
     KAA_RETURN_IF_NIL(array, NULL);
 
     int64_t element_count;
@@ -22,6 +22,7 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "avro_src/avro/io.h"
 #include "collections/kaa_list.h"
@@ -90,6 +91,10 @@ typedef struct {
 
 
 kaa_string_t *kaa_string_move_create(const char *data, destroy_fn destroy);
+
+/**
+ * Copies the string right after the value, so both are released at once by @ref kaa_string_destroy().
+ */
 kaa_string_t *kaa_string_copy_create(const char *data);
 
 void kaa_string_destroy(void *data);
@@ -100,6 +105,10 @@ size_t kaa_string_get_size(void *data);
 
 
 kaa_bytes_t *kaa_bytes_move_create(const uint8_t *data, size_t data_len, destroy_fn destroy);
+
+/**
+ * Copies the bytes right after the value, so both are released at once by @ref kaa_bytes_destroy().
+ */
 kaa_bytes_t *kaa_bytes_copy_create(const uint8_t *data, size_t data_len);
 
 void kaa_bytes_destroy(void *data);
@@ -153,6 +162,42 @@ void kaa_double_serialize(avro_writer_t writer, void *data);
 double *kaa_double_deserialize(avro_reader_t reader);
 size_t kaa_double_get_size(void *data);
 
+/*
+ * Encode into a buffer of AVRO_FLOAT_SIZE and AVRO_DOUBLE_SIZE bytes. Used by records of fixed-size
+ * fields, which are written out all at once.
+ */
+static inline void kaa_float_encode(char *buffer, float value)
+{
+    union {
+        float f;
+        uint32_t i;
+    } v;
+
+    v.f = value;
+    buffer[0] = (char)(v.i >> 0);
+    buffer[1] = (char)(v.i >> 8);
+    buffer[2] = (char)(v.i >> 16);
+    buffer[3] = (char)(v.i >> 24);
+}
+
+static inline void kaa_double_encode(char *buffer, double value)
+{
+    union {
+        double d;
+        uint64_t l;
+    } v;
+
+    v.d = value;
+    buffer[0] = (char)(v.l >> 0);
+    buffer[1] = (char)(v.l >> 8);
+    buffer[2] = (char)(v.l >> 16);
+    buffer[3] = (char)(v.l >> 24);
+    buffer[4] = (char)(v.l >> 32);
+    buffer[5] = (char)(v.l >> 40);
+    buffer[6] = (char)(v.l >> 48);
+    buffer[7] = (char)(v.l >> 56);
+}
+
 
 
 void kaa_array_serialize(avro_writer_t writer, kaa_list_t *array, serialize_fn serialize);
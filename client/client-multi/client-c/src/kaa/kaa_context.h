@@ -24,6 +24,8 @@
 #ifndef KAA_CONTEXT_H_
 #define KAA_CONTEXT_H_
 
+#include "kaa_common.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +44,15 @@ struct kaa_configuration_manager;
 struct kaa_notification_manager_t;
 struct kaa_logger_t;
 struct kaa_failover_strategy_t;
+struct kaa_extension;
+
+/**
+ * An initialized extension and its opaque context, see @link kaa_extension.h @endlink.
+ */
+typedef struct {
+    const struct kaa_extension *extension;
+    void                       *context;
+} kaa_extension_slot_t;
 
 /**
  * General Kaa endpoint context. Contains private structures of all Kaa endpoint SDK subsystems that can be used
@@ -60,6 +71,7 @@ typedef struct kaa_context_s {
     struct kaa_logger_t                *logger;                 /**< See @link kaa_log.h @endlink. */
     struct kaa_notification_manager_t  *notification_manager;   /**< See @link kaa_notification_manager.h @endlink. */
     struct kaa_failover_strategy_t     *failover_strategy;
+    kaa_extension_slot_t               extensions[KAA_EXTENSION_ID_COUNT]; /**< Indexed by extension id. */
 } kaa_context_t;
 
 #ifdef __cplusplus
@@ -38,6 +38,39 @@ extern "C" {
 
 # define KAA_SYNC_TIMEOUT               60000L
 
+/* Events sent outside a block are synced together within this window (in seconds), 0 disables it */
+# ifndef KAA_EVENT_COALESCING_WINDOW
+# define KAA_EVENT_COALESCING_WINDOW        0
+# endif
+/* The coalesced events are synced before the window is over once there are that many, 0 if not limited */
+# ifndef KAA_EVENT_COALESCING_MAX_EVENTS
+# define KAA_EVENT_COALESCING_MAX_EVENTS    0
+# endif
+/* Found event listeners are reused for that many seconds unless the user's endpoints change, 0 disables it */
+# ifndef KAA_EVENT_LISTENERS_CACHE_TTL
+# define KAA_EVENT_LISTENERS_CACHE_TTL      0
+# endif
+/* The event listeners of at most that many FQN lists are cached */
+# ifndef KAA_EVENT_LISTENERS_CACHE_SIZE
+# define KAA_EVENT_LISTENERS_CACHE_SIZE     4
+# endif
+/* Changed status fields are appended to the status storage until that many bytes, then it is rewritten */
+# ifndef KAA_STATUS_JOURNAL_MAX_SIZE
+# define KAA_STATUS_JOURNAL_MAX_SIZE        256
+# endif
+/* A server sync is processed for about that many milliseconds per client loop iteration, 0 if not limited */
+# ifndef KAA_SERVER_SYNC_TIME_BUDGET_MS
+# define KAA_SERVER_SYNC_TIME_BUDGET_MS     0
+# endif
+/* At most that many extensions of a server sync are processed per client loop iteration, 0 if not limited */
+# ifndef KAA_SERVER_SYNC_MAX_EXTENSIONS
+# define KAA_SERVER_SYNC_MAX_EXTENSIONS     0
+# endif
+/* Received operations access points are stored and reused on start for that many seconds, 0 disables it */
+# ifndef KAA_BOOTSTRAP_ACCESS_POINTS_TTL
+# define KAA_BOOTSTRAP_ACCESS_POINTS_TTL    86400
+# endif
+
 /**
  * @brief Uses to represent transport-specific connection data to establish
  * connection to Bootstrap servers.
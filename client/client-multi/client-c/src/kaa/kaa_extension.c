@@ -19,110 +19,152 @@
 #include <kaa_extension_private.h>
 
 #include <stddef.h>
+#include <string.h>
 
-#define EXTENSION_COUNT (sizeof(kaa_extensions)/sizeof(*kaa_extensions))
-
-#define EXTENSION_NOT_FOUND ((size_t)-1)
+#include "kaa_context.h"
 
-/**
- * A list of kaa contexts.
- */
-static void *kaa_extension_contexts[EXTENSION_COUNT] = { NULL };
+#define EXTENSION_COUNT (sizeof(kaa_extensions)/sizeof(*kaa_extensions))
 
 /**
- * Return the index of extension in the kaa_extensions.
+ * Returns the slot of the initialized extension, @c NULL if the
+ * extension is unknown or hasn't been initialized in the context.
  */
-static size_t extension_id_to_idx(kaa_extension_id id)
+static kaa_extension_slot_t *extension_slot(struct kaa_context_s *kaa_context, kaa_extension_id id)
 {
-    for (size_t i = 0; i < EXTENSION_COUNT; ++i) {
-        if (kaa_extensions[i]->id == id) {
-            return i;
-        }
+    if (!kaa_context || (size_t)id >= KAA_EXTENSION_ID_COUNT
+            || !kaa_context->extensions[id].extension) {
+        return NULL;
     }
-    return EXTENSION_NOT_FOUND;
+
+    return &kaa_context->extensions[id];
 }
 
 const struct kaa_extension *kaa_extension_get(kaa_extension_id id)
 {
-    size_t idx = extension_id_to_idx(id);
-    return idx == EXTENSION_NOT_FOUND ? NULL : kaa_extensions[idx];
+    if ((size_t)id >= KAA_EXTENSION_ID_COUNT) {
+        return NULL;
+    }
+    return kaa_extensions_by_id[id];
 }
 
-void *kaa_extension_get_context(kaa_extension_id id)
+void *kaa_extension_get_context(struct kaa_context_s *kaa_context, kaa_extension_id id)
 {
-    size_t idx = extension_id_to_idx(id);
-    return idx == EXTENSION_NOT_FOUND ? NULL : kaa_extension_contexts[idx];
+    kaa_extension_slot_t *slot = extension_slot(kaa_context, id);
+    return slot ? slot->context : NULL;
 }
 
-kaa_error_t kaa_extension_set_context(kaa_extension_id id, void *context)
+kaa_error_t kaa_extension_set_context(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        void *context)
 {
-    size_t idx = extension_id_to_idx(id);
-    if (idx == EXTENSION_NOT_FOUND) {
+    KAA_RETURN_IF_NIL(kaa_context, KAA_ERR_BADPARAM);
+
+    const struct kaa_extension *extension = kaa_extension_get(id);
+    if (!extension || (size_t)id >= KAA_EXTENSION_ID_COUNT) {
         return KAA_ERR_NOT_FOUND;
     }
 
-    kaa_extension_contexts[idx] = context;
+    kaa_context->extensions[id].extension = extension;
+    kaa_context->extensions[id].context = context;
     return KAA_ERR_NONE;
 }
 
 kaa_error_t kaa_extension_init_all(struct kaa_context_s *kaa_context)
 {
+    KAA_RETURN_IF_NIL(kaa_context, KAA_ERR_BADPARAM);
+
     kaa_error_t result = KAA_ERR_NONE;
 
     size_t i = 0;
     for (; i < EXTENSION_COUNT; ++i) {
-        result = kaa_extensions[i]->init(kaa_context, &kaa_extension_contexts[i]);
+        kaa_extension_id id = kaa_extensions[i]->id;
+        if ((size_t)id >= KAA_EXTENSION_ID_COUNT) {
+            result = KAA_ERR_BADPARAM;
+            break;
+        }
+
+        result = kaa_extensions[i]->init(kaa_context, &kaa_context->extensions[id].context);
         if (result != KAA_ERR_NONE) {
+            kaa_context->extensions[id].context = NULL;
             break;
         }
+
+        kaa_context->extensions[id].extension = kaa_extensions[i];
     }
 
     if (result != KAA_ERR_NONE) {
         while (i > 0) {
             --i;
-            kaa_extensions[i]->deinit(kaa_extension_contexts[i]);
+            kaa_extension_slot_t *slot = &kaa_context->extensions[kaa_extensions[i]->id];
+            kaa_extensions[i]->deinit(slot->context);
+            memset(slot, 0, sizeof(*slot));
         }
     }
 
     return result;
 }
 
-kaa_error_t kaa_extension_deinit_all(void)
+kaa_error_t kaa_extension_deinit_all(struct kaa_context_s *kaa_context)
 {
+    KAA_RETURN_IF_NIL(kaa_context, KAA_ERR_BADPARAM);
+
     kaa_error_t result = KAA_ERR_NONE;
 
     for (size_t i = EXTENSION_COUNT; i > 0;) {
         --i;
 
-        kaa_error_t res = kaa_extensions[i]->deinit(kaa_extension_contexts[i]);
+        kaa_extension_slot_t *slot = extension_slot(kaa_context, kaa_extensions[i]->id);
+        if (!slot) {
+            continue;
+        }
+
+        kaa_error_t res = slot->extension->deinit(slot->context);
         if (res != KAA_ERR_NONE) {
             result = res;
         }
+        memset(slot, 0, sizeof(*slot));
     }
 
     return result;
 }
 
-kaa_error_t kaa_extension_request_serialize(kaa_extension_id id, uint32_t request_id,
-        uint8_t *buffer, size_t *size, bool *sync_needed)
+kaa_error_t kaa_extension_request_serialize(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        uint32_t request_id, uint8_t *buffer, size_t *size, bool *sync_needed)
 {
-    size_t idx = extension_id_to_idx(id);
-    if (idx == EXTENSION_NOT_FOUND) {
+    kaa_extension_slot_t *slot = extension_slot(kaa_context, id);
+    if (!slot) {
         return KAA_ERR_NOT_FOUND;
     }
 
-    return kaa_extensions[idx]->request_serialize(kaa_extension_contexts[idx], request_id,
+    return slot->extension->request_serialize(slot->context, request_id,
             buffer, size, sync_needed);
 }
 
-kaa_error_t kaa_extension_server_sync(kaa_extension_id id, uint32_t request_id,
-        uint16_t extension_options, const uint8_t *buffer, size_t size)
+kaa_error_t kaa_extension_request_serialize_spliced(struct kaa_context_s *kaa_context,
+        kaa_extension_id id, uint32_t request_id, uint8_t *buffer, size_t *size,
+        kaa_platform_message_splices_t *splices, bool *sync_needed)
+{
+    kaa_extension_slot_t *slot = extension_slot(kaa_context, id);
+    if (!slot) {
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    if (!splices || !slot->extension->request_serialize_spliced) {
+        return slot->extension->request_serialize(slot->context, request_id,
+                buffer, size, sync_needed);
+    }
+
+    return slot->extension->request_serialize_spliced(slot->context, request_id,
+            buffer, size, splices, sync_needed);
+}
+
+kaa_error_t kaa_extension_server_sync(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        uint32_t request_id, uint16_t extension_options, const uint8_t *buffer, size_t size)
 {
-    size_t idx = extension_id_to_idx(id);
-    if (idx == EXTENSION_NOT_FOUND) {
+    kaa_extension_slot_t *slot = extension_slot(kaa_context, id);
+    if (!slot) {
         return KAA_ERR_NOT_FOUND;
     }
 
-    return kaa_extensions[idx]->server_sync(kaa_extension_contexts[idx], request_id,
+    return slot->extension->server_sync(slot->context, request_id,
             extension_options, buffer, size);
 }
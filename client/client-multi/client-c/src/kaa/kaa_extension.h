@@ -24,6 +24,7 @@
 
 #include <kaa_common.h>
 #include <kaa_error.h>
+#include <kaa_platform_utils.h>
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -114,6 +115,19 @@ struct kaa_extension {
      */
     kaa_error_t (*server_sync)(void *context, uint32_t request_id,
             uint16_t extension_options, const uint8_t *buffer, size_t size);
+
+    /**
+     * Optional. Same as request_serialize(), but large pieces of the
+     * request may be left where they are and only recorded in
+     * @p splices (see kaa_platform_message_write_aligned_spliced()).
+     *
+     * @p size is set to the number of bytes written into @p buffer; the
+     * sizes of the recorded pieces are added to kaa_platform_message_splices_t::size.
+     * The pieces must stay valid until the request is sent.
+     */
+    kaa_error_t (*request_serialize_spliced)(void *context, uint32_t request_id,
+            uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices,
+            bool *sync_needed);
 };
 
 /**
@@ -124,11 +138,14 @@ struct kaa_extension {
 const struct kaa_extension *kaa_extension_get(kaa_extension_id id);
 
 /**
- * Return context for the given extension @p id.
+ * Return context of the extension @p id in the given Kaa client context.
  *
- * @retval NULL Extension not found.
+ * Extension contexts are kept in @p kaa_context, so several Kaa
+ * clients can live in one process.
+ *
+ * @retval NULL Extension not found or not initialized.
  */
-void *kaa_extension_get_context(kaa_extension_id id);
+void *kaa_extension_get_context(struct kaa_context_s *kaa_context, kaa_extension_id id);
 
 /**
  * Sets extension context to later be retrieved with
@@ -137,7 +154,8 @@ void *kaa_extension_get_context(kaa_extension_id id);
  * @retval KAA_ERR_NONE      Success.
  * @retval KAA_ERR_NOT_FOUND No extension with such id.
  */
-kaa_error_t kaa_extension_set_context(kaa_extension_id id, void *context);
+kaa_error_t kaa_extension_set_context(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        void *context);
 
 /**
  * Initializes all extensions. If error occurs, it deinitializes all
@@ -148,37 +166,46 @@ kaa_error_t kaa_extension_set_context(kaa_extension_id id, void *context);
 kaa_error_t kaa_extension_init_all(struct kaa_context_s *kaa_context);
 
 /**
- * Deinitializes all extensions in reverse order.
+ * Deinitializes all extensions initialized in @p kaa_context in
+ * reverse order. Extensions which weren't initialized are skipped, so
+ * it's safe to call the function several times.
  *
  * If any extension errored during deinitialization, error code is
  * returned.
  *
- * @warning The function doesn't check if extension was
- * initialized. Must only be called if kaa_extension_init_all()
- * succeeded before.
- *
  * @retval KAA_ERR_NONE All extensions deinitialized successfully.
  *
  * @note In case several extensions failed deinitialization it's
  * unspecified which error code is returned.
  */
-kaa_error_t kaa_extension_deinit_all(void);
+kaa_error_t kaa_extension_deinit_all(struct kaa_context_s *kaa_context);
 
 /**
  * A proxy for kaa_extension::request_serialize().
  *
  * @retval KAA_ERR_NOT_FOUND Extension was not found.
  */
-kaa_error_t kaa_extension_request_serialize(kaa_extension_id id, uint32_t request_id,
-        uint8_t *buffer, size_t *size, bool *sync_needed);
+kaa_error_t kaa_extension_request_serialize(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        uint32_t request_id, uint8_t *buffer, size_t *size, bool *sync_needed);
+
+/**
+ * A proxy for kaa_extension::request_serialize_spliced(). Falls back to
+ * kaa_extension::request_serialize() if @p splices is @c NULL or the
+ * extension doesn't support splicing.
+ *
+ * @retval KAA_ERR_NOT_FOUND Extension was not found.
+ */
+kaa_error_t kaa_extension_request_serialize_spliced(struct kaa_context_s *kaa_context,
+        kaa_extension_id id, uint32_t request_id, uint8_t *buffer, size_t *size,
+        kaa_platform_message_splices_t *splices, bool *sync_needed);
 
 /**
  * A proxy for kaa_extension::server_sync().
  *
  * @retval KAA_ERR_NOT_FOUND Extension was not found.
  */
-kaa_error_t kaa_extension_server_sync(kaa_extension_id id, uint32_t request_id,
-        uint16_t extension_options, const uint8_t *buffer, size_t size);
+kaa_error_t kaa_extension_server_sync(struct kaa_context_s *kaa_context, kaa_extension_id id,
+        uint32_t request_id, uint16_t extension_options, const uint8_t *buffer, size_t size);
 
 #ifdef __cplusplus
 }
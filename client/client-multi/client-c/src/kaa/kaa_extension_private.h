@@ -58,6 +58,7 @@ static struct kaa_extension kaa_extension_event = {
     .deinit = kaa_extension_event_deinit,
     .request_serialize = kaa_extension_event_request_serialize,
     .server_sync = kaa_extension_event_server_sync,
+    .request_serialize_spliced = kaa_extension_event_request_serialize_spliced,
 };
 #endif
 
@@ -68,6 +69,7 @@ static struct kaa_extension kaa_extension_logging = {
     .deinit = kaa_extension_logging_deinit,
     .request_serialize = kaa_extension_logging_request_serialize,
     .server_sync = kaa_extension_logging_server_sync,
+    .request_serialize_spliced = kaa_extension_logging_request_serialize_spliced,
 };
 #endif
 
@@ -128,3 +130,31 @@ static const struct kaa_extension *kaa_extensions[] = {
     &kaa_extension_user,
 #endif
 };
+
+// The same extensions indexed by their ids, so lookups don't need to
+// scan kaa_extensions[]. Disabled extensions leave NULL slots.
+static const struct kaa_extension *const kaa_extensions_by_id[KAA_EXTENSION_ID_COUNT] = {
+    [KAA_EXTENSION_BOOTSTRAP] = &kaa_extension_bootstrap,
+
+    [KAA_EXTENSION_PROFILE] = &kaa_extension_profile,
+
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+    [KAA_EXTENSION_EVENT] = &kaa_extension_event,
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+    [KAA_EXTENSION_LOGGING] = &kaa_extension_logging,
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_CONFIGURATION
+    [KAA_EXTENSION_CONFIGURATION] = &kaa_extension_configuration,
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_NOTIFICATION
+    [KAA_EXTENSION_NOTIFICATION] = &kaa_extension_notification,
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_USER
+    [KAA_EXTENSION_USER] = &kaa_extension_user,
+#endif
+};
@@ -21,7 +21,11 @@
 #include <string.h>
 #include "platform/stdio.h"
 #include "platform/ext_sha.h"
+#ifdef KAA_ENCRYPTION
+#include "platform/ext_encryption_utils.h"
+#endif
 #include "platform/sock.h"
+#include "platform/time.h"
 #include "kaa_status.h"
 #include "kaa_platform_protocol.h"
 #include "utilities/kaa_mem.h"
@@ -38,6 +42,14 @@
 /** Resync flag indicating that profile manager should be resynced */
 #define KAA_PROFILE_RESYNC_FLAG     0x1
 
+/** Cached size of an extension which couldn't be queried, it is asked again on serialization */
+#define KAA_EXTENSION_SIZE_UNKNOWN  SIZE_MAX
+
+#ifndef KAA_TIME_MS
+/* Platforms without a millisecond clock fall back to the second one */
+#define KAA_TIME_MS() ((uint64_t)KAA_TIME() * 1000)
+#endif
+
 static const size_t kaa_meta_data_request_size =
     KAA_EXTENSION_HEADER_SIZE +
     sizeof(uint32_t) +
@@ -48,16 +60,28 @@ static const size_t kaa_meta_data_request_size =
 
 struct kaa_platform_protocol_t
 {
-    kaa_status_t *status;
-    kaa_logger_t *logger;
-    uint32_t      request_id;
+    kaa_context_t *kaa_context;
+    kaa_status_t  *status;
+    kaa_logger_t  *logger;
+    uint32_t       request_id;
+
+    uint32_t       sync_time_budget_ms;     /**< 0 if not limited */
+    uint16_t       sync_max_extensions;     /**< 0 if not limited */
+    bool           sync_in_progress;        /**< Extensions of a server sync are being processed */
+    uint8_t       *pending_sync;            /**< Extensions of the last server sync left for the next slices */
+    size_t         pending_sync_size;
+    size_t         pending_sync_offset;
+    uint32_t       pending_request_id;
 };
 
 /**
  * That's a function that aids transition to the new interface. Its
  * usages should be removed.
  */
-static kaa_error_t get_extension_request_size(kaa_extension_id id, size_t *size);
+static kaa_error_t get_extension_request_size(kaa_platform_protocol_t *self, kaa_extension_id id,
+        size_t *size);
+
+static void kaa_server_sync_flush_pending(kaa_platform_protocol_t *self);
 
 kaa_error_t kaa_meta_data_request_serialize(kaa_platform_protocol_t *self,
         kaa_platform_message_writer_t *writer, uint32_t request_id)
@@ -112,9 +136,9 @@ kaa_error_t kaa_meta_data_request_serialize(kaa_platform_protocol_t *self,
 }
 
 kaa_error_t kaa_platform_protocol_create(kaa_platform_protocol_t **platform_protocol_p,
-        kaa_logger_t *logger, kaa_status_t *status)
+        kaa_context_t *kaa_context, kaa_logger_t *logger, kaa_status_t *status)
 {
-    if (!platform_protocol_p || !logger || !status) {
+    if (!platform_protocol_p || !kaa_context || !logger || !status) {
         return KAA_ERR_BADPARAM;
     }
 
@@ -124,9 +148,12 @@ kaa_error_t kaa_platform_protocol_create(kaa_platform_protocol_t **platform_prot
     }
 
     **platform_protocol_p = (kaa_platform_protocol_t){
+        .kaa_context = kaa_context,
         .request_id = 0,
         .status = status,
         .logger = logger,
+        .sync_time_budget_ms = KAA_SERVER_SYNC_TIME_BUDGET_MS,
+        .sync_max_extensions = KAA_SERVER_SYNC_MAX_EXTENSIONS,
     };
 
     return KAA_ERR_NONE;
@@ -134,12 +161,21 @@ kaa_error_t kaa_platform_protocol_create(kaa_platform_protocol_t **platform_prot
 
 void kaa_platform_protocol_destroy(kaa_platform_protocol_t *self)
 {
+    if (self) {
+        KAA_FREE(self->pending_sync);
+    }
     KAA_FREE(self);
 }
 
+/**
+ * Computes the size of the client sync. If @p extension_sizes is not NULL,
+ * it receives the exact size of each extension (zero if the extension has nothing
+ * to sync), so that the following serialization doesn't size the extensions again.
+ */
 static kaa_error_t kaa_client_sync_get_size(kaa_platform_protocol_t *self,
         const kaa_extension_id *extensions,
         const size_t extension_count,
+        size_t *extension_sizes,
         size_t *expected_size)
 {
     // TODO(KAA-982): Use assert here
@@ -152,13 +188,17 @@ static kaa_error_t kaa_client_sync_get_size(kaa_platform_protocol_t *self,
     for (size_t i = 0; i < extension_count; ++i) {
         size_t extension_size = 0;
 
-        kaa_error_t error = get_extension_request_size(extensions[i], &extension_size);
+        kaa_error_t error = get_extension_request_size(self, extensions[i], &extension_size);
         if (error && error != KAA_ERR_NOT_FOUND) {
             KAA_LOG_ERROR(self->logger, error,
                     "Failed to query extension size for %u", extensions[i]);
             return error;
         }
 
+        if (extension_sizes) {
+            extension_sizes[i] = error ? KAA_EXTENSION_SIZE_UNKNOWN : extension_size;
+        }
+
         *expected_size += extension_size;
     }
 
@@ -166,7 +206,8 @@ static kaa_error_t kaa_client_sync_get_size(kaa_platform_protocol_t *self,
 }
 
 static kaa_error_t kaa_client_sync_serialize(kaa_platform_protocol_t *self,
-        const kaa_extension_id services[], size_t services_count, uint8_t *buffer, size_t *size)
+        const kaa_extension_id services[], size_t services_count, const size_t *extension_sizes,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices)
 {
     kaa_platform_message_writer_t writer = KAA_MESSAGE_WRITER(buffer, *size);
 
@@ -190,9 +231,18 @@ static kaa_error_t kaa_client_sync_serialize(kaa_platform_protocol_t *self,
 
     while (!error_code && services_count--) {
         size_t size_required = writer.end - writer.current;
+        if (extension_sizes && extension_sizes[services_count] != KAA_EXTENSION_SIZE_UNKNOWN) {
+            if (!extension_sizes[services_count]) {
+                // Nothing to sync, the extension isn't asked again.
+                --total_services_count;
+                continue;
+            }
+            size_required = extension_sizes[services_count];
+        }
+
         bool need_resync = false;
-        error_code = kaa_extension_request_serialize(services[services_count],
-                self->request_id, writer.current, &size_required, &need_resync);
+        error_code = kaa_extension_request_serialize_spliced(self->kaa_context, services[services_count],
+                self->request_id, writer.current, &size_required, splices, &need_resync);
         if (error_code) {
             KAA_LOG_ERROR(self->logger, error_code,
                     "Failed to serialize the '%d' extension", services[services_count]);
@@ -214,6 +264,27 @@ fail:
     return error_code;
 }
 
+static kaa_error_t kaa_client_sync_serialize_request(kaa_platform_protocol_t *self,
+        const kaa_extension_id *services, size_t services_count, const size_t *extension_sizes,
+        uint8_t *buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices)
+{
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Serializing client sync...");
+
+    self->request_id++;
+    kaa_error_t error = kaa_client_sync_serialize(self, services, services_count, extension_sizes,
+            buffer, buffer_size, splices);
+    if (error) {
+        self->request_id--;
+        return error;
+    }
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
+            "Client sync serialized: request id '%u', payload size '%zu'",
+            self->request_id, *buffer_size);
+
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_platform_protocol_serialize_client_sync(kaa_platform_protocol_t *self,
         const kaa_extension_id *services, size_t services_count,
         uint8_t *buffer, size_t *buffer_size)
@@ -226,9 +297,15 @@ kaa_error_t kaa_platform_protocol_serialize_client_sync(kaa_platform_protocol_t
         return KAA_ERR_BADDATA;
     }
 
+    kaa_server_sync_flush_pending(self);
+
+    /* Services are distinct extensions, the sizes are cached unless the list is longer */
+    size_t extension_sizes[KAA_EXTENSION_ID_COUNT];
+    size_t *sizes = services_count <= KAA_EXTENSION_ID_COUNT ? extension_sizes : NULL;
+
     size_t required_buffer_size = 0;
     kaa_error_t error = kaa_client_sync_get_size(self, services, services_count,
-            &required_buffer_size);
+            sizes, &required_buffer_size);
     if (error) {
         KAA_LOG_ERROR(self->logger, error, "Failed to get required buffer size");
         return error;
@@ -240,156 +317,425 @@ kaa_error_t kaa_platform_protocol_serialize_client_sync(kaa_platform_protocol_t
     }
     *buffer_size = required_buffer_size;
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Serializing client sync...");
+    return kaa_client_sync_serialize_request(self, services, services_count, sizes,
+            buffer, buffer_size, NULL);
+}
 
-    self->request_id++;
-    error = kaa_client_sync_serialize(self, services, services_count, buffer, buffer_size);
-    if (error) {
-        self->request_id--;
-        return error;
-    }
+static kaa_error_t kaa_server_sync_process_extension(kaa_platform_protocol_t *self,
+        kaa_platform_message_reader_t *reader, uint16_t extension_type,
+        uint16_t extension_options, uint32_t extension_length, uint32_t *request_id)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
 
-    KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
-            "Client sync serialized: request id '%u', payload size '%zu'",
-            self->request_id, *buffer_size);
+    /* Do not resync unless it is requested by the metadata extension */
 
-    return KAA_ERR_NONE;
-}
+    // TODO: must profile_needs_resync be set inside of the loop?
+    self->status->profile_needs_resync = false;
 
-// TODO(KAA-1089): Remove weak linkage
-__attribute__((weak))
-kaa_error_t kaa_platform_protocol_process_server_sync(kaa_platform_protocol_t *self,
-        const uint8_t *buffer, size_t buffer_size)
-{
-    if (!self || !buffer || buffer_size == 0) {
-        return KAA_ERR_BADPARAM;
-    }
+    if (extension_type == KAA_EXTENSION_META_DATA) {
+        error_code = kaa_platform_message_read(reader, request_id, sizeof(*request_id));
+        if (error_code) {
+            KAA_LOG_ERROR(self->logger, error_code, "Failed to read meta data (request_id)");
+            return error_code;
+        }
 
-    KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
-            "Server sync received: payload size '%zu'", buffer_size);
+        *request_id = KAA_NTOHL(*request_id);
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Server sync request id %u", *request_id);
 
-    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(buffer, buffer_size);
+        /* Check if managers needs resync */
+
+        uint32_t resync_request;
+        error_code = kaa_platform_message_read(reader,
+                &resync_request, sizeof(resync_request));
+        if (error_code) {
+            KAA_LOG_ERROR(self->logger, error_code, "Failed to read meta data (resync_request)");
+            return error_code;
+        }
+
+        resync_request = KAA_NTOHL(resync_request);
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE,
+                "Server resync request %u", resync_request);
+
+        if (resync_request & KAA_PROFILE_RESYNC_FLAG) {
+            KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Profile resync is requested");
+            self->status->profile_needs_resync = true;
+
+            void *profile_ctx = kaa_extension_get_context(self->kaa_context,
+                    KAA_EXTENSION_PROFILE);
+            if (!profile_ctx) {
+                error_code = KAA_ERR_NOT_FOUND;
+                KAA_LOG_ERROR(self->logger, error_code,
+                        "Profile extension is not found. Force resync can't be done");
+                return error_code;
+            }
 
+            error_code = kaa_profile_force_sync(profile_ctx);
+            if (error_code) {
+                KAA_LOG_ERROR(self->logger, error_code, "Failed to force-sync profile");
+                return error_code;
+            }
+        }
+    } else {
+        error_code = kaa_extension_server_sync(self->kaa_context, extension_type, *request_id,
+                extension_options, reader->current, extension_length);
+        reader->current += extension_length;
+
+        if (error_code == KAA_ERR_NOT_FOUND) {
+            KAA_LOG_WARN(self->logger, KAA_ERR_UNSUPPORTED,
+                    "Unsupported extension received (type = %u)", extension_type);
+            error_code = KAA_ERR_NONE;
+        } else if (error_code) {
+            KAA_LOG_ERROR(self->logger, error_code,
+                    "Server sync is corrupted. Failed to read extension with type %u",
+                    extension_type);
+        }
+    }
+
+    return error_code;
+}
+
+static kaa_error_t kaa_server_sync_check_header(kaa_platform_protocol_t *self,
+        kaa_platform_message_reader_t *reader)
+{
     uint32_t protocol_id = 0;
     uint16_t protocol_version = 0;
     uint16_t extension_count = 0;
 
-    kaa_error_t error_code = kaa_platform_message_header_read(&reader,
+    kaa_error_t error_code = kaa_platform_message_header_read(reader,
             &protocol_id, &protocol_version, &extension_count);
     if (error_code) {
-        goto fail;
+        return error_code;
     }
 
     if (protocol_id != KAA_PLATFORM_PROTOCOL_ID) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_PROTOCOL_ID,
                 "Unsupported protocol ID %x", protocol_id);
-        error_code = KAA_ERR_BAD_PROTOCOL_ID;
-        goto fail;
+        return KAA_ERR_BAD_PROTOCOL_ID;
     }
 
     if (protocol_version != KAA_PLATFORM_PROTOCOL_VERSION) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_PROTOCOL_VERSION,
                 "Unsupported protocol version %u", protocol_version);
-        error_code = KAA_ERR_BAD_PROTOCOL_VERSION;
-        goto fail;
+        return KAA_ERR_BAD_PROTOCOL_VERSION;
     }
 
-    uint32_t request_id = 0;
+    return KAA_ERR_NONE;
+}
+
+static bool kaa_server_sync_budget_is_spent(kaa_platform_protocol_t *self,
+        uint64_t start_ms, uint32_t extension_count)
+{
+    return (self->sync_max_extensions && extension_count >= self->sync_max_extensions)
+        || (self->sync_time_budget_ms && KAA_TIME_MS() - start_ms >= self->sync_time_budget_ms);
+}
+
+/*
+ * Processes the extensions following the message header. If @p budgeted, stops
+ * once the budget is spent, after at least one extension.
+ */
+static kaa_error_t kaa_server_sync_process_extensions(kaa_platform_protocol_t *self,
+        kaa_platform_message_reader_t *reader, uint32_t *request_id, bool budgeted)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+    uint64_t start_ms = budgeted ? KAA_TIME_MS() : 0;
+    uint32_t extension_count = 0;
+    bool was_in_progress = self->sync_in_progress;
 
-    while (kaa_platform_message_is_buffer_large_enough(&reader, KAA_PROTOCOL_MESSAGE_HEADER_SIZE)) {
+    self->sync_in_progress = true;
+
+    while (kaa_platform_message_is_buffer_large_enough(reader, KAA_PROTOCOL_MESSAGE_HEADER_SIZE)) {
+        if (budgeted && extension_count && kaa_server_sync_budget_is_spent(self, start_ms, extension_count)) {
+            break;
+        }
 
         uint16_t extension_type;
         uint16_t extension_options;
         uint32_t extension_length;
-        error_code = kaa_platform_message_read_extension_header(&reader, &extension_type,
+        error_code = kaa_platform_message_read_extension_header(reader, &extension_type,
                 &extension_options, &extension_length);
         if (error_code) {
             KAA_LOG_ERROR(self->logger, error_code, "Failed to read extension header");
-            goto fail;
+            break;
         }
 
-        /* Do not resync unless it is requested by the metadata extension */
+        error_code = kaa_server_sync_process_extension(self, reader, extension_type,
+                extension_options, extension_length, request_id);
+        if (error_code) {
+            break;
+        }
+        ++extension_count;
+    }
+
+    self->sync_in_progress = was_in_progress;
+    return error_code;
+}
+
+static kaa_error_t kaa_server_sync_complete(kaa_platform_protocol_t *self)
+{
+    kaa_error_t error_code = kaa_status_save(self->status);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Failed to save status");
+        return error_code;
+    }
 
-        // TODO: must profile_needs_resync be set inside of the loop?
-        self->status->profile_needs_resync = false;
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Server sync successfully processed");
+    return KAA_ERR_NONE;
+}
 
-        if (extension_type == KAA_EXTENSION_META_DATA) {
-            error_code = kaa_platform_message_read(&reader, &request_id, sizeof(request_id));
-            if (error_code) {
-                KAA_LOG_ERROR(self->logger, error_code, "Failed to read meta data (request_id)");
-                goto fail;
-            }
+static void kaa_server_sync_drop_pending(kaa_platform_protocol_t *self)
+{
+    KAA_FREE(self->pending_sync);
+    self->pending_sync = NULL;
+    self->pending_sync_size = 0;
+    self->pending_sync_offset = 0;
+}
 
-            request_id = KAA_NTOHL(request_id);
-            KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Server sync request id %u", request_id);
+/*
+ * Keeps the unprocessed extensions for the next slices. The sync buffer belongs
+ * to the channel, so they are copied.
+ */
+static kaa_error_t kaa_server_sync_defer(kaa_platform_protocol_t *self,
+        const kaa_platform_message_reader_t *reader, uint32_t request_id)
+{
+    size_t size = reader->end - reader->current;
+    self->pending_sync = KAA_MALLOC(size);
+    if (!self->pending_sync) {
+        return KAA_ERR_NOMEM;
+    }
 
-            /* Check if managers needs resync */
+    memcpy(self->pending_sync, reader->current, size);
+    self->pending_sync_size = size;
+    self->pending_sync_offset = 0;
+    self->pending_request_id = request_id;
 
-            uint32_t resync_request;
-            error_code = kaa_platform_message_read(&reader,
-                    &resync_request, sizeof(resync_request));
-            if (error_code) {
-                KAA_LOG_ERROR(self->logger, error_code, "Failed to read meta data (resync_request)");
-                goto fail;
-            }
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE,
+            "%zu bytes of server sync are left for the next iterations", size);
+    return KAA_ERR_NONE;
+}
 
-            resync_request = KAA_NTOHL(resync_request);
-            KAA_LOG_TRACE(self->logger, KAA_ERR_NONE,
-                    "Server resync request %u", resync_request);
-
-            if (resync_request & KAA_PROFILE_RESYNC_FLAG) {
-                KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Profile resync is requested");
-                self->status->profile_needs_resync = true;
-
-                void *profile_ctx = kaa_extension_get_context(KAA_EXTENSION_PROFILE);
-                if (!profile_ctx) {
-                    error_code = KAA_ERR_NOT_FOUND;
-                    KAA_LOG_ERROR(self->logger, error_code,
-                            "Profile extension is not found. Force resync can't be done");
-                    goto fail;
-                }
-
-                error_code = kaa_profile_force_sync(profile_ctx);
-                if (error_code) {
-                    KAA_LOG_ERROR(self->logger, error_code, "Failed to force-sync profile");
-                    goto fail;
-                }
-            }
-        } else {
-            error_code = kaa_extension_server_sync(extension_type, request_id,
-                    extension_options, reader.current, extension_length);
-            reader.current += extension_length;
-
-            if (error_code == KAA_ERR_NOT_FOUND) {
-                KAA_LOG_WARN(self->logger, KAA_ERR_UNSUPPORTED,
-                        "Unsupported extension received (type = %u)", extension_type);
-                error_code = KAA_ERR_NONE;
-            } else if (error_code) {
-                KAA_LOG_ERROR(self->logger, error_code,
-                        "Server sync is corrupted. Failed to read extension with type %u",
-                        extension_type);
-                goto fail;
-            }
-        }
+static kaa_error_t kaa_server_sync_resume(kaa_platform_protocol_t *self, bool budgeted)
+{
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(self->pending_sync + self->pending_sync_offset,
+            self->pending_sync_size - self->pending_sync_offset);
+
+    kaa_error_t error_code = kaa_server_sync_process_extensions(self, &reader,
+            &self->pending_request_id, budgeted);
+    if (!error_code && kaa_platform_message_is_buffer_large_enough(&reader, KAA_PROTOCOL_MESSAGE_HEADER_SIZE)) {
+        self->pending_sync_offset = reader.current - self->pending_sync;
+        return KAA_ERR_NONE;
     }
 
-    error_code = kaa_status_save(self->status);
+    kaa_server_sync_drop_pending(self);
     if (error_code) {
-        KAA_LOG_ERROR(self->logger, error_code, "Failed to save status");
-        goto fail;
+        return error_code;
     }
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Server sync successfully processed");
+    return kaa_server_sync_complete(self);
+}
 
-fail:
-    return error_code;
+/*
+ * Server syncs are processed in the order they are received, and client syncs
+ * reflect everything received, so the rest of a sliced sync goes first.
+ */
+static void kaa_server_sync_flush_pending(kaa_platform_protocol_t *self)
+{
+    if (!self->pending_sync || self->sync_in_progress) {
+        return;
+    }
+
+    kaa_error_t error_code = kaa_server_sync_resume(self, false);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Failed to process the rest of server sync");
+    }
 }
 
 // TODO(KAA-1089): Remove weak linkage
 __attribute__((weak))
-kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_protocol_t *self,
-        const kaa_extension_id *services, size_t services_count,
-        uint8_t **buffer, size_t *buffer_size)
+kaa_error_t kaa_platform_protocol_process_server_sync(kaa_platform_protocol_t *self,
+        const uint8_t *buffer, size_t buffer_size)
+{
+    if (!self || !buffer || buffer_size == 0) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE,
+            "Server sync received: payload size '%zu'", buffer_size);
+
+    kaa_server_sync_flush_pending(self);
+
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(buffer, buffer_size);
+
+    kaa_error_t error_code = kaa_server_sync_check_header(self, &reader);
+    if (error_code) {
+        return error_code;
+    }
+
+    uint32_t request_id = 0;
+    bool budgeted = (self->sync_time_budget_ms || self->sync_max_extensions) && !self->sync_in_progress;
+
+    error_code = kaa_server_sync_process_extensions(self, &reader, &request_id, budgeted);
+    if (error_code) {
+        return error_code;
+    }
+
+    if (kaa_platform_message_is_buffer_large_enough(&reader, KAA_PROTOCOL_MESSAGE_HEADER_SIZE)) {
+        error_code = kaa_server_sync_defer(self, &reader, request_id);
+        if (!error_code) {
+            return KAA_ERR_NONE;
+        }
+
+        KAA_LOG_WARN(self->logger, error_code, "No memory to slice server sync, processing it at once");
+        error_code = kaa_server_sync_process_extensions(self, &reader, &request_id, false);
+        if (error_code) {
+            return error_code;
+        }
+    }
+
+    return kaa_server_sync_complete(self);
+}
+
+kaa_error_t kaa_platform_protocol_process_pending_server_sync(kaa_platform_protocol_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    if (!self->pending_sync || self->sync_in_progress) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_error_t error_code = kaa_server_sync_resume(self, true);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Failed to process the rest of server sync");
+    }
+    return error_code;
+}
+
+bool kaa_platform_protocol_has_pending_server_sync(kaa_platform_protocol_t *self)
+{
+    return self && self->pending_sync;
+}
+
+void kaa_platform_protocol_set_server_sync_budget(kaa_platform_protocol_t *self,
+        uint32_t time_budget_ms, uint16_t max_extensions)
+{
+    KAA_RETURN_IF_NIL(self, );
+    self->sync_time_budget_ms = time_budget_ms;
+    self->sync_max_extensions = max_extensions;
+}
+
+void kaa_platform_protocol_server_sync_stream_init(kaa_server_sync_stream_t *stream)
+{
+    KAA_RETURN_IF_NIL(stream, );
+    memset(stream, 0, sizeof(*stream));
+}
+
+static kaa_error_t kaa_server_sync_stream_header_done(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream)
+{
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(stream->header, sizeof(stream->header));
+    stream->header_filled = 0;
+
+    if (!stream->message_header_read) {
+        stream->message_header_read = true;
+        return kaa_server_sync_check_header(self, &reader);
+    }
+
+    kaa_error_t error_code = kaa_platform_message_read_extension_header(&reader,
+            &stream->extension_type, &stream->extension_options, &stream->extension_length);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Failed to read extension header");
+        return error_code;
+    }
+
+    if (stream->extension_length) {
+        stream->extension = KAA_MALLOC(stream->extension_length);
+        if (!stream->extension) {
+            KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM,
+                    "No memory for extension of %u bytes", stream->extension_length);
+            return KAA_ERR_NOMEM;
+        }
+    }
+    stream->extension_filled = 0;
+    stream->in_extension = true;
+    return KAA_ERR_NONE;
+}
+
+static kaa_error_t kaa_server_sync_stream_extension_done(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream)
+{
+    kaa_platform_message_reader_t reader = KAA_MESSAGE_READER(stream->extension, stream->extension_length);
+
+    kaa_error_t error_code = kaa_server_sync_process_extension(self, &reader, stream->extension_type,
+            stream->extension_options, stream->extension_length, &stream->request_id);
+
+    KAA_FREE(stream->extension);
+    stream->extension = NULL;
+    stream->in_extension = false;
+    return error_code;
+}
+
+kaa_error_t kaa_platform_protocol_stream_server_sync(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream, const uint8_t *chunk, size_t chunk_size)
+{
+    if (!self || !stream || (!chunk && chunk_size)) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    kaa_server_sync_flush_pending(self);
+
+    while (!stream->error && chunk_size) {
+        size_t length;
+        if (stream->in_extension) {
+            length = stream->extension_length - stream->extension_filled;
+            length = (length > chunk_size) ? chunk_size : length;
+            memcpy(stream->extension + stream->extension_filled, chunk, length);
+            stream->extension_filled += length;
+        } else {
+            length = sizeof(stream->header) - stream->header_filled;
+            length = (length > chunk_size) ? chunk_size : length;
+            memcpy(stream->header + stream->header_filled, chunk, length);
+            stream->header_filled += length;
+            if (stream->header_filled == sizeof(stream->header)) {
+                stream->error = kaa_server_sync_stream_header_done(self, stream);
+            }
+        }
+        chunk += length;
+        chunk_size -= length;
+
+        if (!stream->error && stream->in_extension
+                && stream->extension_filled == stream->extension_length) {
+            stream->error = kaa_server_sync_stream_extension_done(self, stream);
+        }
+    }
+
+    return stream->error;
+}
+
+kaa_error_t kaa_platform_protocol_finish_server_sync(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream)
+{
+    if (!self || !stream) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    kaa_error_t error_code = stream->error;
+    if (!error_code && (!stream->message_header_read || stream->in_extension)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Server sync is truncated");
+        error_code = KAA_ERR_READ_FAILED;
+    }
+
+    KAA_FREE(stream->extension);
+    kaa_platform_protocol_server_sync_stream_init(stream);
+
+    if (error_code) {
+        return error_code;
+    }
+
+    return kaa_server_sync_complete(self);
+}
+
+static kaa_error_t kaa_client_sync_alloc_serialize(kaa_platform_protocol_t *self,
+        kaa_scratch_t *scratch, const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices)
 {
     if (!self || !buffer || !buffer_size) {
         return KAA_ERR_BADPARAM;
@@ -399,28 +745,67 @@ kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_proto
         return KAA_ERR_BADDATA;
     }
 
+    kaa_server_sync_flush_pending(self);
+
+    /*
+     * The extensions are sized once, the same sizes are used to allocate
+     * the buffer and to serialize into it.
+     */
+    size_t extension_sizes[KAA_EXTENSION_ID_COUNT];
+    size_t *sizes = services_count <= KAA_EXTENSION_ID_COUNT ? extension_sizes : NULL;
+
     *buffer_size = 0;
-    kaa_error_t error = kaa_platform_protocol_serialize_client_sync(self, services, services_count,
-            NULL, buffer_size);
-    // TODO(982): assert error != KAA_ERR_NONE
-    if (error != KAA_ERR_BUFFER_IS_NOT_ENOUGH) {
+    kaa_error_t error = kaa_client_sync_get_size(self, services, services_count,
+            sizes, buffer_size);
+    if (error) {
+        KAA_LOG_ERROR(self->logger, error, "Failed to get required buffer size");
         return error;
     }
 
-    *buffer = KAA_MALLOC(*buffer_size);
+#ifdef KAA_ENCRYPTION
+    /* Room for the cipher padding, the request is encrypted in place */
+    size_t alloc_size = ext_get_encrypted_data_size(*buffer_size);
+#else
+    size_t alloc_size = *buffer_size;
+#endif
+
+    *buffer = scratch ? kaa_scratch_alloc(scratch, alloc_size) : KAA_SCRATCH_MALLOC(alloc_size);
     if (!*buffer) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "No memory for buffer");
         return KAA_ERR_NOMEM;
     }
 
-    return kaa_platform_protocol_serialize_client_sync(self, services, services_count,
-            *buffer, buffer_size);
+    return kaa_client_sync_serialize_request(self, services, services_count, sizes,
+            *buffer, buffer_size, splices);
+}
+
+// TODO(KAA-1089): Remove weak linkage
+__attribute__((weak))
+kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_protocol_t *self,
+        const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size)
+{
+    return kaa_client_sync_alloc_serialize(self, NULL, services, services_count,
+            buffer, buffer_size, NULL);
+}
+
+// TODO(KAA-1089): Remove weak linkage
+__attribute__((weak))
+kaa_error_t kaa_platform_protocol_scratch_serialize_client_sync(kaa_platform_protocol_t *self,
+        kaa_scratch_t *scratch, const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices)
+{
+    KAA_RETURN_IF_NIL(scratch, KAA_ERR_BADPARAM);
+    return kaa_client_sync_alloc_serialize(self, scratch, services, services_count,
+            buffer, buffer_size, splices);
 }
 
-static kaa_error_t get_extension_request_size(kaa_extension_id id, size_t *size)
+static kaa_error_t get_extension_request_size(kaa_platform_protocol_t *self, kaa_extension_id id,
+        size_t *size)
 {
     bool need_resync;
-    kaa_error_t error = kaa_extension_request_serialize(id, 0, NULL, size, &need_resync);
+    kaa_error_t error = kaa_extension_request_serialize(self->kaa_context, id, 0, NULL, size,
+            &need_resync);
     if (error == KAA_ERR_BUFFER_IS_NOT_ENOUGH) {
         error = KAA_ERR_NONE;
     }
@@ -27,10 +27,14 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "kaa_error.h"
 #include "kaa_context.h"
 #include "kaa_common.h"
+#include "kaa_platform_common.h"
+#include "kaa_platform_utils.h"
+#include "utilities/kaa_scratch.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,9 +94,31 @@ kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_proto
         const kaa_extension_id *services, size_t services_count,
         uint8_t **buffer, size_t *buffer_size);
 
+/**
+ * Same as kaa_platform_protocol_alloc_serialize_client_sync(), but the
+ * buffer is taken from @p scratch and is released with the next
+ * kaa_scratch_reset() rather than freed by the caller.
+ *
+ * If @p splices is not @c NULL, the extensions supporting it may leave
+ * pieces of the request out of the buffer and record them in @p splices
+ * instead. @p buffer_size is then the size of the buffer only, the whole
+ * request is @p buffer_size + kaa_platform_message_splices_t::size bytes.
+ *
+ * With @c KAA_ENCRYPTION the buffer holds ext_get_encrypted_data_size()
+ * of @p buffer_size bytes, so that the request can be encrypted in place.
+ */
+kaa_error_t kaa_platform_protocol_scratch_serialize_client_sync(kaa_platform_protocol_t *self,
+        kaa_scratch_t *scratch, const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices);
+
 /**
  * @brief Processes downstream data received from Operations server.
  *
+ * If a budget is set with kaa_platform_protocol_set_server_sync_budget(), only
+ * the extensions fitting into it are processed. The rest is copied and left for
+ * kaa_platform_protocol_process_pending_server_sync(). The status is saved once
+ * the last extension is processed.
+ *
  * @param[in] self        Pointer to a @ref kaa_platform_protocol_t instance.
  * @param[in] buffer      Pointer to a data buffer for processing received from server.
  * @param[in] buffer_size Size of @c buffer.
@@ -102,6 +128,81 @@ kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_proto
 kaa_error_t kaa_platform_protocol_process_server_sync(kaa_platform_protocol_t *self,
         const uint8_t *buffer, size_t buffer_size);
 
+/**
+ * @brief Limits the work done on a server sync per call.
+ *
+ * At least one extension is processed per call, an extension is never split.
+ * Without a millisecond clock on the platform, the time is measured in seconds.
+ * Both limits are zero by default, see @c KAA_SERVER_SYNC_TIME_BUDGET_MS and
+ * @c KAA_SERVER_SYNC_MAX_EXTENSIONS.
+ *
+ * @param[in] self              Pointer to a @ref kaa_platform_protocol_t instance.
+ * @param[in] time_budget_ms    Time after which no next extension is processed, 0 if not limited.
+ * @param[in] max_extensions    Max number of extensions processed per call, 0 if not limited.
+ */
+void kaa_platform_protocol_set_server_sync_budget(kaa_platform_protocol_t *self,
+        uint32_t time_budget_ms, uint16_t max_extensions);
+
+/**
+ * @brief Processes the next extensions of a server sync left by the budget.
+ *
+ * The rest of a sync is also processed at once before the next server sync and
+ * before a client sync is serialized, so the syncs stay in order.
+ *
+ * @return Error code. Once an error occurs the rest of the sync is dropped.
+ */
+kaa_error_t kaa_platform_protocol_process_pending_server_sync(kaa_platform_protocol_t *self);
+
+/**
+ * @return Whether extensions of a server sync are left for
+ * kaa_platform_protocol_process_pending_server_sync().
+ */
+bool kaa_platform_protocol_has_pending_server_sync(kaa_platform_protocol_t *self);
+
+/**
+ * State of a server sync that is processed piece by piece as it arrives.
+ * Only one extension payload is held in memory at a time.
+ */
+typedef struct {
+    uint8_t header[KAA_EXTENSION_HEADER_SIZE];  /**< Message or extension header being collected */
+    size_t header_filled;
+    bool message_header_read;
+    bool in_extension;                          /**< Collecting @c extension */
+    uint16_t extension_type;
+    uint16_t extension_options;
+    uint8_t *extension;
+    uint32_t extension_length;
+    uint32_t extension_filled;
+    uint32_t request_id;
+    kaa_error_t error;                          /**< First error, sticky until finished */
+} kaa_server_sync_stream_t;
+
+/**
+ * @brief Prepares @p stream for a new server sync.
+ */
+void kaa_platform_protocol_server_sync_stream_init(kaa_server_sync_stream_t *stream);
+
+/**
+ * @brief Feeds the next @p chunk_size bytes of a server sync.
+ *
+ * Each extension is processed as soon as its payload is complete, the same
+ * way kaa_platform_protocol_process_server_sync() does it.
+ *
+ * @return Error code. Once an error occurs the rest of the sync is ignored
+ * and the same error is returned.
+ */
+kaa_error_t kaa_platform_protocol_stream_server_sync(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream, const uint8_t *chunk, size_t chunk_size);
+
+/**
+ * @brief Completes a streamed server sync and resets @p stream.
+ *
+ * Must be called after the last chunk, also when streaming failed, to
+ * release the partially received extension.
+ */
+kaa_error_t kaa_platform_protocol_finish_server_sync(kaa_platform_protocol_t *self,
+        kaa_server_sync_stream_t *stream);
+
 #ifdef __cplusplus
 }      /* extern "C" */
 #endif
@@ -18,7 +18,6 @@
 
 #include <stdint.h>
 #include <string.h>
-#include "platform/sock.h"
 #include <stdbool.h>
 #include "kaa_platform_utils.h"
 
@@ -37,6 +36,7 @@ kaa_error_t kaa_platform_message_writer_create(kaa_platform_message_writer_t** w
     (*writer_p)->begin = buf;
     (*writer_p)->end = buf + len;
     (*writer_p)->current = buf;
+    (*writer_p)->splices = NULL;
 
     return KAA_ERR_NONE;
 }
@@ -58,9 +58,8 @@ kaa_error_t kaa_platform_message_write(kaa_platform_message_writer_t* writer
 {
     KAA_RETURN_IF_NIL3(writer, data, data_size, KAA_ERR_BADPARAM);
 
-    if ((writer->current + data_size) <= writer->end) {
-        memcpy((void *)writer->current, data, data_size);
-        writer->current += data_size;
+    if (kaa_platform_message_writer_reserve(writer, data_size)) {
+        kaa_platform_message_put_bytes(writer, data, data_size);
         return KAA_ERR_NONE;
     }
 
@@ -77,9 +76,8 @@ kaa_error_t kaa_platform_message_write_alignment(kaa_platform_message_writer_t*
     if (!alignment_size)
         return KAA_ERR_NONE;
 
-    if (writer->current + alignment_size <= writer->end) {
-        memset((void *)writer->current, 0, alignment_size);
-        writer->current += alignment_size;
+    if (kaa_platform_message_writer_reserve(writer, alignment_size)) {
+        kaa_platform_message_put_padding(writer, alignment_size);
         return KAA_ERR_NONE;
     }
 
@@ -95,10 +93,9 @@ kaa_error_t kaa_platform_message_write_aligned(kaa_platform_message_writer_t* wr
 
     size_t aligned_size = kaa_aligned_size_get(data_size);
 
-    if ((writer->current + aligned_size) <= writer->end) {
-        memcpy((void *)writer->current, data, data_size);
-        memset((void *)(writer->current + data_size), 0, (aligned_size - data_size));
-        writer->current += aligned_size;
+    if (kaa_platform_message_writer_reserve(writer, aligned_size)) {
+        kaa_platform_message_put_bytes(writer, data, data_size);
+        kaa_platform_message_put_padding(writer, aligned_size - data_size);
         return KAA_ERR_NONE;
     }
 
@@ -106,17 +103,41 @@ kaa_error_t kaa_platform_message_write_aligned(kaa_platform_message_writer_t* wr
 }
 
 
+kaa_error_t kaa_platform_message_write_aligned_spliced(kaa_platform_message_writer_t* writer
+                                                     , const void *data
+                                                     , size_t data_size
+                                                     , bool *spliced)
+{
+    KAA_RETURN_IF_NIL4(writer, data, data_size, spliced, KAA_ERR_BADPARAM);
+
+    kaa_platform_message_splices_t *splices = writer->splices;
+    if (!splices || splices->count == splices->capacity) {
+        *spliced = false;
+        return kaa_platform_message_write_aligned(writer, data, data_size);
+    }
+
+    size_t aligned_size = kaa_aligned_size_get(data_size);
+    splices->items[splices->count++] = (kaa_platform_message_splice_t) {
+        .position = writer->current,
+        .data = data,
+        .size = data_size,
+        .padding = aligned_size - data_size,
+    };
+    splices->size += aligned_size;
+    *spliced = true;
+    return KAA_ERR_NONE;
+}
+
+
 kaa_error_t kaa_platform_message_header_write(kaa_platform_message_writer_t* writer
                                             , uint32_t protocol_id
                                             , uint16_t protocol_version)
 {
     KAA_RETURN_IF_NIL(writer, KAA_ERR_BADPARAM);
 
-    if ((writer->current + KAA_PROTOCOL_ID_SIZE + KAA_PROTOCOL_VERSION_SIZE) <= writer->end) {
-        *(uint32_t *) writer->current = KAA_HTONL(protocol_id);
-        writer->current += KAA_PROTOCOL_ID_SIZE;
-        *(uint16_t *) writer->current = KAA_HTONS(protocol_version);
-        writer->current += KAA_PROTOCOL_VERSION_SIZE;
+    if (kaa_platform_message_writer_reserve(writer, KAA_PROTOCOL_ID_SIZE + KAA_PROTOCOL_VERSION_SIZE)) {
+        kaa_platform_message_put_uint32(writer, protocol_id);
+        kaa_platform_message_put_uint16(writer, protocol_version);
         return KAA_ERR_NONE;
     }
 
@@ -130,18 +151,10 @@ kaa_error_t kaa_platform_message_write_extension_header(kaa_platform_message_wri
 {
     KAA_RETURN_IF_NIL(writer, KAA_ERR_BADPARAM);
 
-    if ((writer->current + KAA_EXTENSION_HEADER_SIZE) <= writer->end) {
-        extension_type = KAA_HTONS(extension_type);
-        options = KAA_HTONS(options);
-        payload_size = KAA_HTONL(payload_size);
-
-        memcpy((void *)writer->current, &extension_type, KAA_EXTENSION_TYPE_SIZE);
-        writer->current += KAA_EXTENSION_TYPE_SIZE;
-        memcpy((void *)writer->current, &options, KAA_EXTENSION_OPTIONS_SIZE);
-        writer->current += KAA_EXTENSION_OPTIONS_SIZE;
-        memcpy((void *)writer->current, &payload_size, KAA_EXTENSION_PAYLOAD_LENGTH_SIZE);
-        writer->current += KAA_EXTENSION_PAYLOAD_LENGTH_SIZE;
-
+    if (kaa_platform_message_writer_reserve(writer, KAA_EXTENSION_HEADER_SIZE)) {
+        kaa_platform_message_put_uint16(writer, extension_type);
+        kaa_platform_message_put_uint16(writer, options);
+        kaa_platform_message_put_uint32(writer, payload_size);
         return KAA_ERR_NONE;
     }
 
@@ -174,7 +187,7 @@ void kaa_platform_message_reader_destroy(kaa_platform_message_reader_t *reader)
 kaa_error_t kaa_platform_message_read(kaa_platform_message_reader_t *reader, void *buffer, size_t expected_size)
 {
     KAA_RETURN_IF_NIL3(reader, buffer, expected_size, KAA_ERR_BADPARAM);
-    if (reader->current + expected_size <= reader->end) {
+    if (kaa_platform_message_is_buffer_large_enough(reader, expected_size)) {
         memcpy(buffer, reader->current, expected_size);
         reader->current += expected_size;
         return KAA_ERR_NONE;
@@ -188,7 +201,7 @@ kaa_error_t kaa_platform_message_read_aligned(kaa_platform_message_reader_t *rea
 {
     KAA_RETURN_IF_NIL3(reader, buffer, expected_size, KAA_ERR_BADPARAM);
     size_t aligned_size = kaa_aligned_size_get(expected_size);
-    if (reader->current + aligned_size <= reader->end) {
+    if (kaa_platform_message_is_buffer_large_enough(reader, aligned_size)) {
         memcpy(buffer, reader->current, expected_size);
         reader->current += aligned_size;
         return KAA_ERR_NONE;
@@ -205,13 +218,10 @@ kaa_error_t kaa_platform_message_header_read(kaa_platform_message_reader_t* read
 {
     KAA_RETURN_IF_NIL4(reader, protocol_id, protocol_version, extension_count, KAA_ERR_BADPARAM);
 
-    if (reader->current + KAA_PROTOCOL_MESSAGE_HEADER_SIZE <= reader->end) {
-        *protocol_id = KAA_NTOHL(*((const uint32_t *)reader->current));
-        reader->current += sizeof(uint32_t);
-        *protocol_version = KAA_NTOHS(*((const uint16_t *)reader->current));
-        reader->current += sizeof(uint16_t);
-        *extension_count = KAA_NTOHS(*((const uint16_t *)reader->current));
-        reader->current += sizeof(uint16_t);
+    if (kaa_platform_message_is_buffer_large_enough(reader, KAA_PROTOCOL_MESSAGE_HEADER_SIZE)) {
+        *protocol_id = kaa_platform_message_get_uint32(reader);
+        *protocol_version = kaa_platform_message_get_uint16(reader);
+        *extension_count = kaa_platform_message_get_uint16(reader);
         return KAA_ERR_NONE;
     }
 
@@ -227,15 +237,10 @@ kaa_error_t kaa_platform_message_read_extension_header(kaa_platform_message_read
 {
     KAA_RETURN_IF_NIL4(reader, extension_type, extension_options, extension_payload_length, KAA_ERR_BADPARAM);
 
-    if (reader->current + KAA_EXTENSION_HEADER_SIZE <= reader->end) {
-        memcpy(extension_type, reader->current, KAA_EXTENSION_OPTIONS_SIZE);
-        *extension_type = KAA_NTOHS(*extension_type);
-        reader->current += KAA_EXTENSION_TYPE_SIZE;
-        memcpy(extension_options, reader->current, KAA_EXTENSION_OPTIONS_SIZE);
-        *extension_options = KAA_NTOHS(*extension_options);
-        reader->current += KAA_EXTENSION_OPTIONS_SIZE;
-        *extension_payload_length = KAA_NTOHL(*((const uint32_t *)reader->current));
-        reader->current += KAA_EXTENSION_PAYLOAD_LENGTH_SIZE;
+    if (kaa_platform_message_is_buffer_large_enough(reader, KAA_EXTENSION_HEADER_SIZE)) {
+        *extension_type = kaa_platform_message_get_uint16(reader);
+        *extension_options = kaa_platform_message_get_uint16(reader);
+        *extension_payload_length = kaa_platform_message_get_uint32(reader);
         return KAA_ERR_NONE;
     }
 
@@ -253,14 +258,14 @@ bool kaa_platform_message_is_buffer_large_enough(kaa_platform_message_reader_t *
         return true;
     }
 
-    return (reader->current + size <= reader->end);
+    return (size_t)(reader->end - reader->current) >= size;
 }
 
 kaa_error_t kaa_platform_message_skip(kaa_platform_message_reader_t *reader, size_t size)
 {
     KAA_RETURN_IF_NIL2(reader, size, KAA_ERR_BADPARAM);
 
-    if (reader->current + size <= reader->end) {
+    if (kaa_platform_message_is_buffer_large_enough(reader, size)) {
         reader->current += size;
         return KAA_ERR_NONE;
     }
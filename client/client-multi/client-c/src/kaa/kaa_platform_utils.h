@@ -21,19 +21,44 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "kaa_error.h"
 #include "kaa_platform_common.h"
+#include "platform-impl/common/kaa_htonll.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
+/**
+ * A piece of a message that is not copied into the writer's buffer but
+ * belongs right before @c position in it, followed by @c padding zero bytes.
+ */
+typedef struct {
+    const uint8_t *position;
+    const void    *data;
+    size_t         size;
+    size_t         padding;
+} kaa_platform_message_splice_t;
+
+/**
+ * Pieces written with @ref kaa_platform_message_write_aligned_spliced, in
+ * the order of their positions. The caller provides @c items and @c capacity.
+ */
+typedef struct {
+    kaa_platform_message_splice_t *items;
+    size_t count;
+    size_t capacity;
+    size_t size;        /**< Total size of the pieces, padding included */
+} kaa_platform_message_splices_t;
+
 typedef struct {
     uint8_t *begin;
     uint8_t *current;
     uint8_t *end;
+    kaa_platform_message_splices_t *splices;    /**< Optional */
 } kaa_platform_message_writer_t;
 
 
@@ -44,7 +69,7 @@ typedef struct {
 } kaa_platform_message_reader_t;
 
 #define KAA_MESSAGE_WRITER(buffer, len) \
-    (kaa_platform_message_writer_t){ (buffer), (buffer), (buffer) + (len) }
+    (kaa_platform_message_writer_t){ (buffer), (buffer), (buffer) + (len), NULL }
 
 #define KAA_MESSAGE_READER(buffer, len) \
     (kaa_platform_message_reader_t){ (buffer), (buffer), (buffer) + (len) }
@@ -67,6 +92,18 @@ kaa_error_t kaa_platform_message_write_aligned(kaa_platform_message_writer_t* wr
                                              , const void *data
                                              , size_t data_size);
 
+/**
+ * Same as @ref kaa_platform_message_write_aligned, but if the writer has
+ * room in its splice list only a reference to @p data is recorded there:
+ * @p data must then stay valid until the message is sent.
+ *
+ * @return Error code; @p spliced is set to @c true if @p data was not copied.
+ */
+kaa_error_t kaa_platform_message_write_aligned_spliced(kaa_platform_message_writer_t* writer
+                                                     , const void *data
+                                                     , size_t data_size
+                                                     , bool *spliced);
+
 kaa_error_t kaa_platform_message_header_write(kaa_platform_message_writer_t* writer
                                             , uint32_t protocol_id
                                             , uint16_t protocol_version);
@@ -110,6 +147,150 @@ bool kaa_platform_message_is_buffer_large_enough(kaa_platform_message_reader_t *
 
 kaa_error_t kaa_platform_message_skip(kaa_platform_message_reader_t *reader, size_t size);
 
+/*
+ * Big-endian stores and loads of fields at any alignment. Fixed-size memcpy()
+ * compiles to a single unaligned access where the target allows it.
+ */
+static inline void kaa_platform_store_be16(uint8_t *position, uint16_t value)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    value = KAA_HOST_TO_BE16(value);
+    memcpy(position, &value, sizeof(value));
+#else
+    position[0] = (uint8_t)(value >> 8);
+    position[1] = (uint8_t)value;
+#endif
+}
+
+static inline void kaa_platform_store_be32(uint8_t *position, uint32_t value)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    value = KAA_HOST_TO_BE32(value);
+    memcpy(position, &value, sizeof(value));
+#else
+    kaa_platform_store_be16(position, (uint16_t)(value >> 16));
+    kaa_platform_store_be16(position + 2, (uint16_t)value);
+#endif
+}
+
+static inline void kaa_platform_store_be64(uint8_t *position, uint64_t value)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    value = KAA_HOST_TO_BE64(value);
+    memcpy(position, &value, sizeof(value));
+#else
+    kaa_platform_store_be32(position, (uint32_t)(value >> 32));
+    kaa_platform_store_be32(position + 4, (uint32_t)value);
+#endif
+}
+
+static inline uint16_t kaa_platform_load_be16(const uint8_t *position)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    uint16_t value;
+    memcpy(&value, position, sizeof(value));
+    return KAA_HOST_TO_BE16(value);
+#else
+    return (uint16_t)((position[0] << 8) | position[1]);
+#endif
+}
+
+static inline uint32_t kaa_platform_load_be32(const uint8_t *position)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    uint32_t value;
+    memcpy(&value, position, sizeof(value));
+    return KAA_HOST_TO_BE32(value);
+#else
+    return ((uint32_t)kaa_platform_load_be16(position) << 16) | kaa_platform_load_be16(position + 2);
+#endif
+}
+
+static inline uint64_t kaa_platform_load_be64(const uint8_t *position)
+{
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    uint64_t value;
+    memcpy(&value, position, sizeof(value));
+    return KAA_HOST_TO_BE64(value);
+#else
+    return ((uint64_t)kaa_platform_load_be32(position) << 32) | kaa_platform_load_be32(position + 4);
+#endif
+}
+
+/**
+ * Checks once that @p size bytes fit in the writer, so that the fields making
+ * them up can be written by the unchecked kaa_platform_message_put_*() functions.
+ *
+ * @return @c true if the bytes fit.
+ */
+static inline bool kaa_platform_message_writer_reserve(const kaa_platform_message_writer_t *writer, size_t size)
+{
+    return writer && (size_t)(writer->end - writer->current) >= size;
+}
+
+/*
+ * Unchecked writes of big-endian fields, call only within a reserved size.
+ */
+static inline void kaa_platform_message_put_uint8(kaa_platform_message_writer_t *writer, uint8_t value)
+{
+    *writer->current++ = value;
+}
+
+static inline void kaa_platform_message_put_uint16(kaa_platform_message_writer_t *writer, uint16_t value)
+{
+    kaa_platform_store_be16(writer->current, value);
+    writer->current += sizeof(value);
+}
+
+static inline void kaa_platform_message_put_uint32(kaa_platform_message_writer_t *writer, uint32_t value)
+{
+    kaa_platform_store_be32(writer->current, value);
+    writer->current += sizeof(value);
+}
+
+static inline void kaa_platform_message_put_uint64(kaa_platform_message_writer_t *writer, uint64_t value)
+{
+    kaa_platform_store_be64(writer->current, value);
+    writer->current += sizeof(value);
+}
+
+static inline void kaa_platform_message_put_bytes(kaa_platform_message_writer_t *writer, const void *data, size_t size)
+{
+    memcpy(writer->current, data, size);
+    writer->current += size;
+}
+
+static inline void kaa_platform_message_put_padding(kaa_platform_message_writer_t *writer, size_t size)
+{
+    memset(writer->current, 0, size);
+    writer->current += size;
+}
+
+/*
+ * Unchecked reads of big-endian fields, call only after
+ * kaa_platform_message_is_buffer_large_enough() has confirmed the size.
+ */
+static inline uint16_t kaa_platform_message_get_uint16(kaa_platform_message_reader_t *reader)
+{
+    uint16_t value = kaa_platform_load_be16(reader->current);
+    reader->current += sizeof(value);
+    return value;
+}
+
+static inline uint32_t kaa_platform_message_get_uint32(kaa_platform_message_reader_t *reader)
+{
+    uint32_t value = kaa_platform_load_be32(reader->current);
+    reader->current += sizeof(value);
+    return value;
+}
+
+static inline uint64_t kaa_platform_message_get_uint64(kaa_platform_message_reader_t *reader)
+{
+    uint64_t value = kaa_platform_load_be64(reader->current);
+    reader->current += sizeof(value);
+    return value;
+}
+
 #define KAA_ALIGNED_SIZE(s) ((s) + (KAA_ALIGNMENT - (s) % KAA_ALIGNMENT) % KAA_ALIGNMENT)
 
 static inline size_t kaa_aligned_size_get(size_t size)
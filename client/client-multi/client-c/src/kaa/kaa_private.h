@@ -54,7 +54,7 @@ kaa_error_t kaa_bootstrap_manager_create(kaa_bootstrap_manager_t **bootstrap_man
 void kaa_bootstrap_manager_destroy(kaa_bootstrap_manager_t *self);
 
 kaa_error_t kaa_platform_protocol_create(kaa_platform_protocol_t **platform_protocol_p,
-        kaa_logger_t *logger, kaa_status_t *status);
+        kaa_context_t *kaa_context, kaa_logger_t *logger, kaa_status_t *status);
 void kaa_platform_protocol_destroy(kaa_platform_protocol_t *self);
 
 kaa_error_t kaa_status_set_registered(kaa_status_t *self, bool is_registered);
@@ -62,6 +62,8 @@ kaa_error_t kaa_status_set_registered(kaa_status_t *self, bool is_registered);
 kaa_error_t kaa_failover_strategy_create(kaa_failover_strategy_t** strategy, kaa_logger_t *logger);
 void kaa_failover_strategy_destroy(kaa_failover_strategy_t* strategy);
 bool kaa_bootstrap_manager_process_failover(kaa_bootstrap_manager_t *self);
+/* Seconds until the scheduled failover is executed, SIZE_MAX if there is none */
+size_t kaa_bootstrap_manager_get_failover_timeout(kaa_bootstrap_manager_t *self);
 
 kaa_error_t kaa_channel_manager_on_new_access_point(kaa_channel_manager_t *self
         , kaa_transport_protocol_id_t *protocol_id
@@ -75,9 +77,15 @@ kaa_access_point_t *kaa_bootstrap_manager_get_bootstrap_access_point(
     kaa_bootstrap_manager_t *self,
     kaa_transport_protocol_id_t *protocol_id);
 
+bool kaa_bootstrap_manager_has_operations_access_points(kaa_bootstrap_manager_t *self);
+
 
 kaa_error_t kaa_status_set_endpoint_access_token(kaa_status_t *self, const char *token);
 
+/* NULL access points clear the stored ones */
+kaa_error_t kaa_status_set_operations_access_points(kaa_status_t *self, const uint8_t *access_points,
+        size_t size, uint64_t expiry);
+
 
 kaa_error_t kaa_status_set_updated(kaa_status_t *self, bool is_updated);
 
@@ -120,6 +128,11 @@ kaa_error_t kaa_extension_notification_request_serialize(void *context, uint32_t
 kaa_error_t kaa_extension_user_request_serialize(void *context, uint32_t request_id,
         uint8_t *buffer, size_t *size, bool *need_resync);
 
+kaa_error_t kaa_extension_event_request_serialize_spliced(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync);
+kaa_error_t kaa_extension_logging_request_serialize_spliced(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync);
+
 kaa_error_t kaa_extension_bootstrap_server_sync(void *context, uint32_t request_id,
         uint16_t extension_options, const uint8_t *buffer, size_t size);
 kaa_error_t kaa_extension_profile_server_sync(void *context, uint32_t request_id,
@@ -28,9 +28,12 @@ extern "C" {
 #define FIRST_BIT                0x80
 #define MAX_MESSAGE_TYPE_LENGTH  0x0F
 #define MAX_MESSAGE_LENGTH       0x0FFFFFFF
+#define KAATCP_MAX_LENGTH_BYTES  4
 #define PROTOCOL_VERSION         0x01
 
 #define KAA_SYNC_HEADER_LENGTH 12
+/* The fixed header with the longest remaining length followed by the KaaSync header */
+#define KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH (5 + KAA_SYNC_HEADER_LENGTH)
 #define KAA_SYNC_ZIPPED_BIT    0x02
 #define KAA_SYNC_ENCRYPTED_BIT 0x04
 #define KAA_SYNC_REQUEST_BIT   0x01
@@ -60,7 +63,8 @@ typedef enum {
     KAATCP_ERR_BUFFER_NOT_ENOUGH = -2,
     KAATCP_ERR_BAD_PARAM         = -3,
     KAATCP_ERR_INVALID_STATE     = -4,
-    KAATCP_ERR_INVALID_PROTOCOL  = -5
+    KAATCP_ERR_INVALID_PROTOCOL  = -5,
+    KAATCP_ERR_MESSAGE_TOO_LARGE = -6
 } kaatcp_error_t;
 
 typedef enum {
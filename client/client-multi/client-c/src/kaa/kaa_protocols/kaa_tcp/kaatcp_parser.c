@@ -28,20 +28,70 @@
 
 
 
-static kaatcp_error_t kaatcp_parser_message_done(kaatcp_parser_t *parser)
+static kaatcp_error_t kaatcp_parser_read_sync_header(const char *payload, kaatcp_kaasync_header_t *sync_header)
+{
+    const char *cursor = payload;
+
+    sync_header->protocol_name_length = KAA_NTOHS(*((uint16_t *) cursor));
+    if (sync_header->protocol_name_length > KAATCP_PROTOCOL_NAME_MAX_SIZE) {
+        return KAATCP_ERR_INVALID_PROTOCOL;
+    }
+
+    cursor += sizeof(uint16_t);
+
+    if (memcmp(cursor, KAA_TCP_NAME, KAA_TCP_NAME_LENGTH)) {
+        return KAATCP_ERR_INVALID_PROTOCOL;
+    }
+
+    memcpy(sync_header->protocol_name, cursor, sync_header->protocol_name_length);
+    sync_header->protocol_name[sync_header->protocol_name_length] = '\0';
+    cursor += sync_header->protocol_name_length;
+
+    sync_header->protocol_version = *(cursor++);
+    if (sync_header->protocol_version != PROTOCOL_VERSION) {
+        return KAATCP_ERR_INVALID_PROTOCOL;
+    }
+
+    uint16_t msg_id;
+    memcpy(&msg_id, cursor, sizeof(uint16_t));
+    cursor += sizeof(uint16_t);
+    sync_header->message_id = KAA_NTOHS(msg_id);
+    sync_header->flags = *(cursor++);
+
+    return KAATCP_ERR_NONE;
+}
+
+static kaatcp_error_t kaatcp_parser_message_done(kaatcp_parser_t *parser, char *payload)
 {
     KAA_RETURN_IF_NIL(parser, KAATCP_ERR_BAD_PARAM);
 
+    /* Reject payloads too short for their headers before dereferencing them. */
+    switch (parser->message_type) {
+        case KAATCP_MESSAGE_CONNACK:
+        case KAATCP_MESSAGE_DISCONNECT:
+            if (parser->message_length < 2) {
+                return KAATCP_ERR_INVALID_PROTOCOL;
+            }
+            break;
+        case KAATCP_MESSAGE_KAASYNC:
+            if (parser->message_length < KAA_SYNC_HEADER_LENGTH) {
+                return KAATCP_ERR_INVALID_PROTOCOL;
+            }
+            break;
+        default:
+            break;
+    }
+
     switch (parser->message_type) {
         case KAATCP_MESSAGE_CONNACK:
             if (parser->handlers.connack_handler) {
-                kaatcp_connack_t connack = { *(parser->payload + 1) };
+                kaatcp_connack_t connack = { *(payload + 1) };
                 parser->handlers.connack_handler(parser->handlers.handlers_context, connack);
             }
             break;
         case KAATCP_MESSAGE_DISCONNECT:
             if (parser->handlers.disconnect_handler) {
-                kaatcp_disconnect_t disconnect = { *(parser->payload + 1) };
+                kaatcp_disconnect_t disconnect = { *(payload + 1) };
                 parser->handlers.disconnect_handler(parser->handlers.handlers_context, disconnect);
             }
             break;
@@ -53,33 +103,10 @@ static kaatcp_error_t kaatcp_parser_message_done(kaatcp_parser_t *parser)
         case KAATCP_MESSAGE_KAASYNC:
         {
             kaatcp_kaasync_header_t sync_header;
-            const char *cursor = parser->payload;
-
-            sync_header.protocol_name_length = KAA_NTOHS(*((uint16_t *) cursor));
-            if (sync_header.protocol_name_length > KAATCP_PROTOCOL_NAME_MAX_SIZE) {
-                return KAATCP_ERR_INVALID_PROTOCOL;
-            }
+            char *cursor = payload + KAA_SYNC_HEADER_LENGTH;
 
-            cursor += sizeof(uint16_t);
-
-            if (memcmp(cursor, KAA_TCP_NAME, KAA_TCP_NAME_LENGTH)) {
-                return KAATCP_ERR_INVALID_PROTOCOL;
-            }
-
-            memcpy(sync_header.protocol_name, cursor, sync_header.protocol_name_length);
-            sync_header.protocol_name[sync_header.protocol_name_length] = '\0';
-            cursor += sync_header.protocol_name_length;
-
-            sync_header.protocol_version = *(cursor++);
-            if (sync_header.protocol_version != PROTOCOL_VERSION) {
-                return KAATCP_ERR_INVALID_PROTOCOL;
-            }
-            
-            uint16_t msg_id;
-            memcpy(&msg_id, cursor, sizeof(uint16_t));
-            cursor += sizeof(uint16_t);
-            sync_header.message_id = KAA_NTOHS(msg_id);
-            sync_header.flags = *(cursor++);
+            kaatcp_error_t rval = kaatcp_parser_read_sync_header(payload, &sync_header);
+            KAA_RETURN_IF_ERR(rval);
 
             if ((sync_header.flags & KAA_SYNC_SYNC_BIT) && parser->handlers.kaasync_handler) {
                 kaatcp_kaasync_t *kaasync = (kaatcp_kaasync_t *) KAA_MALLOC(sizeof(kaatcp_kaasync_t));
@@ -88,16 +115,7 @@ static kaatcp_error_t kaatcp_parser_message_done(kaatcp_parser_t *parser)
                 kaasync->sync_header = sync_header;
                 kaasync->sync_request_size = parser->message_length - KAA_SYNC_HEADER_LENGTH;
 
-                if (kaasync->sync_request_size) {
-                    kaasync->sync_request = (char *) KAA_MALLOC(kaasync->sync_request_size);
-                    if (!kaasync->sync_request) {
-                        KAA_FREE(kaasync);
-                        return KAATCP_ERR_NOMEM;
-                    }
-                    memcpy(kaasync->sync_request, cursor, kaasync->sync_request_size);
-                } else {
-                    kaasync->sync_request = NULL;
-                }
+                kaasync->sync_request = kaasync->sync_request_size ? cursor : NULL;
 
                 parser->handlers.kaasync_handler(parser->handlers.handlers_context, kaasync);
             }
@@ -115,6 +133,25 @@ static void kaatcp_parser_retrieve_message_type(kaatcp_parser_t *parser, uint8_t
     parser->message_type = ((byte & 0xFF) >> 4);
 }
 
+/* Picks the state that follows the fixed header once the message length is known. */
+static kaatcp_error_t kaatcp_parser_length_done(kaatcp_parser_t *parser)
+{
+    if (parser->max_message_length && parser->message_length > parser->max_message_length) {
+        if (parser->message_type != KAATCP_MESSAGE_KAASYNC || !parser->handlers.kaasync_chunk_handler) {
+            return KAATCP_ERR_MESSAGE_TOO_LARGE;
+        }
+        if (parser->message_length < KAA_SYNC_HEADER_LENGTH) {
+            return KAATCP_ERR_INVALID_PROTOCOL;
+        }
+        parser->state = KAATCP_PARSER_STATE_STREAMING_PAYLOAD;
+    } else if (parser->message_length) {
+        parser->state = KAATCP_PARSER_STATE_PROCESSING_PAYLOAD;
+    } else {
+        return kaatcp_parser_message_done(parser, parser->payload);
+    }
+    return KAATCP_ERR_NONE;
+}
+
 static kaatcp_error_t kaatcp_parser_process_byte(kaatcp_parser_t *parser, uint8_t byte)
 {
     KAA_RETURN_IF_NIL(parser, KAATCP_ERR_BAD_PARAM);
@@ -125,32 +162,111 @@ static kaatcp_error_t kaatcp_parser_process_byte(kaatcp_parser_t *parser, uint8_
             parser->state = KAATCP_PARSER_STATE_PROCESSING_LENGTH;
             break;
         case KAATCP_PARSER_STATE_PROCESSING_LENGTH:
+            /* The length takes at most four bytes. */
+            if ((byte & FIRST_BIT) && parser->length_multiplier >= FIRST_BIT * FIRST_BIT * FIRST_BIT) {
+                return KAATCP_ERR_INVALID_PROTOCOL;
+            }
             parser->message_length += ((byte & ~FIRST_BIT) * parser->length_multiplier);
             parser->length_multiplier *= FIRST_BIT;
             if (!(byte & FIRST_BIT)) {
-                if (parser->message_length) {
-                    parser->state = KAATCP_PARSER_STATE_PROCESSING_PAYLOAD;
-                } else {
-                    return kaatcp_parser_message_done(parser);
-                }
+                return kaatcp_parser_length_done(parser);
             }
             break;
         default:
             return KAATCP_ERR_INVALID_STATE;
     }
 
-    if (parser->state == KAATCP_PARSER_STATE_PROCESSING_PAYLOAD && parser->message_length > parser->payload_buffer_size) {
-        char *ptr = KAA_REALLOC(parser->payload, parser->message_length);
-        if (ptr) {
-            parser->payload = ptr;
-            parser->payload_buffer_size = parser->message_length;
-        } else
-            return (kaatcp_error_t)KAA_ERR_NOMEM;
+    return KAATCP_ERR_NONE;
+}
+
+/*
+ * Decodes the message type and the whole length in one step if the fixed
+ * header is complete in @p buf. Otherwise nothing is consumed and the header
+ * is left to kaatcp_parser_process_byte().
+ */
+static kaatcp_error_t kaatcp_parser_read_fixed_header(kaatcp_parser_t *parser, const uint8_t *buf, size_t size, size_t *consumed)
+{
+    *consumed = 0;
+
+    uint32_t length = 0;
+    size_t length_bytes = (size - 1 < KAATCP_MAX_LENGTH_BYTES) ? size - 1 : KAATCP_MAX_LENGTH_BYTES;
+    for (size_t i = 0; i < length_bytes; ++i) {
+        length |= (uint32_t)(buf[i + 1] & ~FIRST_BIT) << (7 * i);
+        if (!(buf[i + 1] & FIRST_BIT)) {
+            kaatcp_parser_retrieve_message_type(parser, buf[0]);
+            parser->message_length = length;
+            *consumed = i + 2;
+            return kaatcp_parser_length_done(parser);
+        }
     }
 
+    if (length_bytes == KAATCP_MAX_LENGTH_BYTES) {
+        return KAATCP_ERR_INVALID_PROTOCOL;
+    }
+    return KAATCP_ERR_NONE;
+}
+
+static kaatcp_error_t kaatcp_parser_reserve_payload(kaatcp_parser_t *parser, uint32_t size)
+{
+    if (size > parser->payload_buffer_size) {
+        char *ptr = KAA_REALLOC(parser->payload, size);
+        if (!ptr) {
+            return KAATCP_ERR_NOMEM;
+        }
+        parser->payload = ptr;
+        parser->payload_buffer_size = size;
+    }
     return KAATCP_ERR_NONE;
 }
 
+/*
+ * Consumes up to @p size bytes of a message that is too large to be
+ * buffered: the KAASYNC header is collected in parser->payload, the sync
+ * body is passed on to the chunk handler as it arrives.
+ */
+static kaatcp_error_t kaatcp_parser_stream_payload(kaatcp_parser_t *parser, char *buf, uint32_t size, uint32_t *consumed)
+{
+    kaatcp_error_t rval = KAATCP_ERR_NONE;
+
+    if (parser->processed_payload_length < KAA_SYNC_HEADER_LENGTH) {
+        uint32_t header_remaining = KAA_SYNC_HEADER_LENGTH - parser->processed_payload_length;
+        *consumed = (header_remaining > size) ? size : header_remaining;
+
+        rval = kaatcp_parser_reserve_payload(parser, KAA_SYNC_HEADER_LENGTH);
+        KAA_RETURN_IF_ERR(rval);
+
+        memcpy(parser->payload + parser->processed_payload_length, buf, *consumed);
+        parser->processed_payload_length += *consumed;
+
+        if (parser->processed_payload_length == KAA_SYNC_HEADER_LENGTH) {
+            rval = kaatcp_parser_read_sync_header(parser->payload, &parser->stream_header);
+            if (!rval && parser->processed_payload_length == parser->message_length) {
+                rval = kaatcp_parser_reset(parser);
+            }
+        }
+        return rval;
+    }
+
+    uint32_t remaining_size = parser->message_length - parser->processed_payload_length;
+    *consumed = (remaining_size > size) ? size : remaining_size;
+
+    /* The handler may reset the parser, so the state is updated first. */
+    uint32_t offset = parser->processed_payload_length - KAA_SYNC_HEADER_LENGTH;
+    uint32_t total_size = parser->message_length - KAA_SYNC_HEADER_LENGTH;
+    kaatcp_kaasync_header_t sync_header = parser->stream_header;
+
+    parser->processed_payload_length += *consumed;
+    if (parser->processed_payload_length == parser->message_length) {
+        rval = kaatcp_parser_reset(parser);
+    }
+
+    if (sync_header.flags & KAA_SYNC_SYNC_BIT) {
+        parser->handlers.kaasync_chunk_handler(parser->handlers.handlers_context, &sync_header
+                , buf, *consumed, offset, total_size);
+    }
+    return rval;
+}
+
 kaatcp_error_t kaatcp_parser_reset(kaatcp_parser_t *parser)
 {
     KAA_RETURN_IF_NIL(parser, KAATCP_ERR_BAD_PARAM);
@@ -172,34 +288,62 @@ kaatcp_error_t kaatcp_parser_init(kaatcp_parser_t *parser
     kaatcp_error_t rval = kaatcp_parser_reset(parser);
     KAA_RETURN_IF_ERR(rval);
 
+    parser->max_message_length = 0;
     parser->handlers = *handlers;
     return rval;
 }
 
-kaatcp_error_t kaatcp_parser_process_buffer(kaatcp_parser_t *parser, const char *buf, size_t buf_size)
+kaatcp_error_t kaatcp_parser_process_buffer(kaatcp_parser_t *parser, char *buf, size_t buf_size)
 {
     KAA_RETURN_IF_NIL3(parser, buf, buf_size, KAATCP_ERR_BAD_PARAM);
 
     kaatcp_error_t rval = KAATCP_ERR_NONE;
-    const char *buf_cursor = buf;
+    char *buf_cursor = buf;
 
     while (buf_cursor != buf + buf_size) {
         if (parser->state == KAATCP_PARSER_STATE_PROCESSING_PAYLOAD) {
             uint32_t remaining_size = parser->message_length - parser->processed_payload_length;
             uint32_t buffer_remaining_size = buf + buf_size - buf_cursor;
+
+            if (!parser->processed_payload_length && remaining_size <= buffer_remaining_size) {
+                /* The whole payload is in the input buffer: parse it in place. */
+                buf_cursor += remaining_size;
+                rval = kaatcp_parser_message_done(parser, buf_cursor - remaining_size);
+                KAA_RETURN_IF_ERR(rval);
+                continue;
+            }
+
             uint32_t bytes_to_read = (remaining_size > buffer_remaining_size) ? buffer_remaining_size : remaining_size;
 
+            rval = kaatcp_parser_reserve_payload(parser, parser->message_length);
+            KAA_RETURN_IF_ERR(rval);
+
             memcpy(parser->payload + parser->processed_payload_length, buf_cursor, bytes_to_read);
             parser->processed_payload_length += bytes_to_read;
             buf_cursor += bytes_to_read;
 
             if (parser->message_length == parser->processed_payload_length) {
-                rval = kaatcp_parser_message_done(parser);
+                rval = kaatcp_parser_message_done(parser, parser->payload);
                 KAA_RETURN_IF_ERR(rval);
             }
-        } else {
-            rval = kaatcp_parser_process_byte(parser, *(buf_cursor++));
+        } else if (parser->state == KAATCP_PARSER_STATE_STREAMING_PAYLOAD) {
+            uint32_t consumed = 0;
+            rval = kaatcp_parser_stream_payload(parser, buf_cursor, buf + buf_size - buf_cursor, &consumed);
             KAA_RETURN_IF_ERR(rval);
+            buf_cursor += consumed;
+        } else {
+            size_t consumed = 0;
+            if (parser->state == KAATCP_PARSER_STATE_NONE) {
+                rval = kaatcp_parser_read_fixed_header(parser, (const uint8_t *)buf_cursor
+                        , buf + buf_size - buf_cursor, &consumed);
+                KAA_RETURN_IF_ERR(rval);
+            }
+            if (consumed) {
+                buf_cursor += consumed;
+            } else {
+                rval = kaatcp_parser_process_byte(parser, *(buf_cursor++));
+                KAA_RETURN_IF_ERR(rval);
+            }
         }
     }
 
@@ -209,11 +353,6 @@ kaatcp_error_t kaatcp_parser_process_buffer(kaatcp_parser_t *parser, const char
 void kaatcp_parser_kaasync_destroy(kaatcp_kaasync_t *message)
 {
     KAA_RETURN_IF_NIL(message,);
-
-    if (message->sync_request) {
-        KAA_FREE(message->sync_request);
-    }
-
     KAA_FREE(message);
 }
 
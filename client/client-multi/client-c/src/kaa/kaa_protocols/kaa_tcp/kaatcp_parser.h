@@ -29,12 +29,22 @@ typedef void (*on_disconnect_message_fn)(void *context, kaatcp_disconnect_t mess
 typedef void (*on_kaasync_message_fn)(void *context, kaatcp_kaasync_t *message);
 typedef void (*on_pingresp_message_fn)(void *context);
 
+/*
+ * Receives the body of a KAASYNC message that exceeds max_message_length
+ * piece by piece, in order: @p offset is the position of @p chunk within
+ * the body of @p total_size bytes. Chunks point into the input buffer.
+ */
+typedef void (*on_kaasync_chunk_fn)(void *context, const kaatcp_kaasync_header_t *header
+                                  , char *chunk, size_t chunk_size
+                                  , size_t offset, size_t total_size);
+
 
 
 typedef enum {
     KAATCP_PARSER_STATE_NONE               = 0x00,
     KAATCP_PARSER_STATE_PROCESSING_LENGTH  = 0x01,
     KAATCP_PARSER_STATE_PROCESSING_PAYLOAD = 0x02,
+    KAATCP_PARSER_STATE_STREAMING_PAYLOAD  = 0x03,
 } kaatcp_parser_state_t;
 
 typedef struct {
@@ -43,6 +53,7 @@ typedef struct {
     on_disconnect_message_fn    disconnect_handler;
     on_kaasync_message_fn       kaasync_handler;
     on_pingresp_message_fn      pingresp_handler;
+    on_kaasync_chunk_fn         kaasync_chunk_handler;      /* Optional */
 } kaatcp_parser_handlers_t;
 
 typedef struct {
@@ -53,19 +64,34 @@ typedef struct {
     uint32_t                 length_multiplier;
     uint32_t                 payload_buffer_size;
     char                    *payload;
+    uint32_t                 max_message_length;    /* 0 - unlimited */
+    kaatcp_kaasync_header_t  stream_header;
 
     kaatcp_parser_handlers_t handlers;
 } kaatcp_parser_t;
 
 
 
+/*
+ * Initializes @p parser with no limit on the message length. Set
+ * max_message_length afterwards to bound the payload buffer: larger
+ * KAASYNC messages are then streamed to kaasync_chunk_handler, and any
+ * other too large message fails with KAATCP_ERR_MESSAGE_TOO_LARGE.
+ */
 kaatcp_error_t kaatcp_parser_init(kaatcp_parser_t *parser
                                 , const kaatcp_parser_handlers_t *handlers);
 
 kaatcp_error_t kaatcp_parser_reset(kaatcp_parser_t *parser);
 
+/*
+ * Parses @buf and invokes the handlers for every complete message.
+ * A payload that arrives whole in @buf is parsed in place, so a KAASYNC
+ * message's sync_request points into @buf; payloads split across calls are
+ * collected in parser->payload, which grows on demand. Either way
+ * sync_request is valid (and may be modified) only until the handler returns.
+ */
 kaatcp_error_t kaatcp_parser_process_buffer(kaatcp_parser_t *parser
-                                          , const char *buf
+                                          , char *buf
                                           , size_t buf_size);
 
 void kaatcp_parser_kaasync_destroy(kaatcp_kaasync_t *message);
@@ -299,6 +299,28 @@ kaatcp_error_t kaatcp_get_request_kaasync(const kaatcp_kaasync_t *message, char
 }
 
 
+kaatcp_error_t kaatcp_get_request_kaasync_header(const kaatcp_kaasync_t *message, char *buf, size_t *buf_size)
+{
+    KAA_RETURN_IF_NIL3(message, buf, buf_size, KAATCP_ERR_BAD_PARAM);
+
+    /*
+     * The header is checked against the room for the whole message,
+     * so it is reported with the sync request size.
+     */
+    size_t header_size = *buf_size + message->sync_request_size;
+    char *cursor = NULL;
+    kaatcp_error_t rval = kaatcp_get_kaasync_header(&message->sync_header
+                                                  , message->sync_request_size
+                                                  , buf
+                                                  , &header_size
+                                                  , &cursor);
+    KAA_RETURN_IF_ERR(rval);
+
+    *buf_size = cursor - buf;
+    return KAATCP_ERR_NONE;
+}
+
+
 kaatcp_error_t kaatcp_get_request_ping(char *buf, size_t *buf_size)
 {
     KAA_RETURN_IF_NIL2(buf, buf_size, KAATCP_ERR_BAD_PARAM);
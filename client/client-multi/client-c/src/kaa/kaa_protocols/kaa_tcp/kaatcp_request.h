@@ -50,6 +50,14 @@ kaatcp_error_t kaatcp_get_request_kaasync(const kaatcp_kaasync_t *message
                                         , char *buf
                                         , size_t *buf_size);
 
+/*
+ * Serializes the headers of the KAASYNC message without the sync request, which follows
+ * them on the wire. At most KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH bytes are written.
+ */
+kaatcp_error_t kaatcp_get_request_kaasync_header(const kaatcp_kaasync_t *message
+                                               , char *buf
+                                               , size_t *buf_size);
+
 kaatcp_error_t kaatcp_get_request_ping(char *buf, size_t *buf_size);
 
 kaatcp_error_t kaatcp_get_request_size(const kaatcp_connect_t *message, kaatcp_message_type_t type, size_t *size);
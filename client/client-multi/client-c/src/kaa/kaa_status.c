@@ -51,6 +51,9 @@
  *  name
  * topic_hash                       sizeof(int32_t)
  * token_buf                        sizeof(KAA_SDK_TOKEN)
+ * records (variable length)        changed fields appended until the next rewrite
+ *  tag                             sizeof(uint8_t), one of kaa_status_field_t
+ *  value                           as the field, see kaa_status_write_records()
  */
 #define KAA_STATUS_STATIC_SIZE      (sizeof(bool) + sizeof(bool) + sizeof(size_t) + sizeof(bool) + sizeof(uint32_t) + sizeof(size_t) + SHA_1_DIGEST_LENGTH * sizeof(char) * 2 + sizeof(KAA_SDK_TOKEN))
 
@@ -62,6 +65,132 @@
         memcpy(TO, FROM, SIZE); \
         TO += SIZE
 
+#define KAA_STATUS_LAST_FIELD       KAA_STATUS_OPERATIONS_ACCESS_POINTS
+
+/* The value size is only used by the variable length records */
+static size_t kaa_status_get_record_size(uint8_t tag, size_t value_size)
+{
+    switch (tag) {
+    case KAA_STATUS_REGISTERED:
+    case KAA_STATUS_ATTACHED:
+        return sizeof(tag) + sizeof(bool);
+    case KAA_STATUS_EVENT_SEQ_N:
+        return sizeof(tag) + sizeof(uint32_t);
+    case KAA_STATUS_PROFILE_HASH:
+    case KAA_STATUS_CONFIGURATION_HASH:
+        return sizeof(tag) + SHA_1_DIGEST_LENGTH + sizeof(bool);
+    case KAA_STATUS_OPERATIONS_ACCESS_POINTS:
+        return sizeof(tag) + sizeof(uint64_t) + sizeof(uint32_t) + value_size;
+    default:
+        return 0;
+    }
+}
+
+static size_t kaa_status_get_records_size(const kaa_status_t *self, uint32_t fields)
+{
+    size_t size = 0;
+    for (uint32_t field = KAA_STATUS_REGISTERED; field <= KAA_STATUS_LAST_FIELD; field <<= 1) {
+        if (fields & field)
+            size += kaa_status_get_record_size(field, self->operations_access_points_size);
+    }
+    return size;
+}
+
+static size_t kaa_status_write_records(const kaa_status_t *self, uint32_t fields, char *buffer)
+{
+    char *buffer_head = buffer;
+
+    for (uint32_t field = KAA_STATUS_REGISTERED; field <= KAA_STATUS_LAST_FIELD; field <<= 1) {
+        if (!(fields & field))
+            continue;
+
+        uint8_t tag = field;
+        WRITE_BUFFER(&tag, buffer, sizeof(tag));
+        switch (field) {
+        case KAA_STATUS_REGISTERED:
+            WRITE_BUFFER(&self->is_registered, buffer, sizeof(self->is_registered));
+            break;
+        case KAA_STATUS_ATTACHED:
+            WRITE_BUFFER(&self->is_attached, buffer, sizeof(self->is_attached));
+            break;
+        case KAA_STATUS_EVENT_SEQ_N:
+            WRITE_BUFFER(&self->event_seq_n, buffer, sizeof(self->event_seq_n));
+            break;
+        case KAA_STATUS_PROFILE_HASH:
+            WRITE_BUFFER(self->profile_hash, buffer, SHA_1_DIGEST_LENGTH);
+            WRITE_BUFFER(&self->profile_needs_resync, buffer, sizeof(self->profile_needs_resync));
+            break;
+        case KAA_STATUS_CONFIGURATION_HASH:
+            WRITE_BUFFER(self->configuration_hash, buffer, SHA_1_DIGEST_LENGTH);
+            WRITE_BUFFER(&self->has_configuration_hash, buffer, sizeof(self->has_configuration_hash));
+            break;
+        case KAA_STATUS_OPERATIONS_ACCESS_POINTS: {
+            uint32_t size = (uint32_t)self->operations_access_points_size;
+            WRITE_BUFFER(&self->operations_access_points_expiry, buffer, sizeof(self->operations_access_points_expiry));
+            WRITE_BUFFER(&size, buffer, sizeof(size));
+            if (size) {
+                WRITE_BUFFER(self->operations_access_points, buffer, size);
+            }
+            break;
+        }
+        }
+    }
+
+    return buffer - buffer_head;
+}
+
+static void kaa_status_read_records(kaa_status_t *self, const char *buffer, size_t buffer_size)
+{
+    const char *end = buffer + buffer_size;
+
+    while (buffer < end) {
+        uint8_t tag = *buffer;
+        uint32_t value_size = 0;
+        if (tag == KAA_STATUS_OPERATIONS_ACCESS_POINTS) {
+            if (kaa_status_get_record_size(tag, 0) > (size_t)(end - buffer))
+                break;
+            memcpy(&value_size, buffer + sizeof(tag) + sizeof(uint64_t), sizeof(value_size));
+        }
+
+        size_t record_size = kaa_status_get_record_size(tag, value_size);
+        // Stop at the record cut short by an interrupted append as well
+        if (!record_size || record_size > (size_t)(end - buffer))
+            break;
+
+        buffer += sizeof(tag);
+        switch (tag) {
+        case KAA_STATUS_REGISTERED:
+            READ_BUFFER(buffer, &self->is_registered, sizeof(self->is_registered));
+            break;
+        case KAA_STATUS_ATTACHED:
+            READ_BUFFER(buffer, &self->is_attached, sizeof(self->is_attached));
+            break;
+        case KAA_STATUS_EVENT_SEQ_N:
+            READ_BUFFER(buffer, &self->event_seq_n, sizeof(self->event_seq_n));
+            break;
+        case KAA_STATUS_PROFILE_HASH:
+            READ_BUFFER(buffer, self->profile_hash, SHA_1_DIGEST_LENGTH);
+            READ_BUFFER(buffer, &self->profile_needs_resync, sizeof(self->profile_needs_resync));
+            break;
+        case KAA_STATUS_CONFIGURATION_HASH:
+            READ_BUFFER(buffer, self->configuration_hash, SHA_1_DIGEST_LENGTH);
+            READ_BUFFER(buffer, &self->has_configuration_hash, sizeof(self->has_configuration_hash));
+            break;
+        case KAA_STATUS_OPERATIONS_ACCESS_POINTS:
+            READ_BUFFER(buffer, &self->operations_access_points_expiry, sizeof(self->operations_access_points_expiry));
+            buffer += sizeof(value_size);
+            KAA_FREE(self->operations_access_points);
+            self->operations_access_points = value_size ? KAA_MALLOC(value_size) : NULL;
+            self->operations_access_points_size = self->operations_access_points ? value_size : 0;
+            if (self->operations_access_points) {
+                memcpy(self->operations_access_points, buffer, value_size);
+            }
+            buffer += value_size;
+            break;
+        }
+    }
+}
+
 // TODO KAA-845: discuss/implement a failover, when storage is somehow broken
 kaa_error_t kaa_status_create(kaa_status_t ** kaa_status_p)
 {
@@ -146,9 +275,16 @@ kaa_error_t kaa_status_create(kaa_status_t ** kaa_status_p)
         char token_buf[sizeof(KAA_SDK_TOKEN)];
         READ_BUFFER(read_buf, token_buf, sizeof(token_buf));
 
+        kaa_status->journal_size = read_size - (size_t)(read_buf - read_buf_head);
+        kaa_status_read_records(kaa_status, read_buf, kaa_status->journal_size);
+
         // TODO: shouldn't that be memcmp?
         if (strcmp(token_buf, KAA_SDK_TOKEN)) {
             kaa_status->is_registered = false;
+            kaa_status->has_configuration_hash = false;
+            KAA_FREE(kaa_status->operations_access_points);
+            kaa_status->operations_access_points = NULL;
+            kaa_status->operations_access_points_size = 0;
         } else {
             kaa_status_set_updated(kaa_status, true);
         }
@@ -166,6 +302,7 @@ void kaa_status_destroy(kaa_status_t *self)
 {
     if (self) {
         KAA_FREE(self->endpoint_access_token);
+        KAA_FREE(self->operations_access_points);
         kaa_list_destroy(self->topic_states, NULL);
         kaa_list_destroy(self->topics, NULL);
         KAA_FREE(self);
@@ -200,7 +337,7 @@ kaa_error_t kaa_status_set_registered(kaa_status_t *self, bool is_registered)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
     self->is_registered = is_registered;
-    self->has_update = true;
+    self->dirty_fields |= KAA_STATUS_REGISTERED;
     return KAA_ERR_NONE;
 }
 
@@ -208,7 +345,7 @@ kaa_error_t kaa_status_set_attached(kaa_status_t *self, bool is_attached)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
     self->is_attached = is_attached;
-    self->has_update = true;
+    self->dirty_fields |= KAA_STATUS_ATTACHED;
     return KAA_ERR_NONE;
 }
 
@@ -220,16 +357,57 @@ kaa_error_t kaa_status_set_updated(kaa_status_t *self, bool is_updated)
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_status_set_operations_access_points(kaa_status_t *self, const uint8_t *access_points,
+                                                    size_t size, uint64_t expiry)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+    if (size > UINT32_MAX)
+        return KAA_ERR_BADPARAM;
+
+    uint8_t *new_access_points = NULL;
+    if (access_points && size) {
+        new_access_points = KAA_MALLOC(size);
+        KAA_RETURN_IF_NIL(new_access_points, KAA_ERR_NOMEM);
+        memcpy(new_access_points, access_points, size);
+    } else {
+        size = 0;
+    }
+
+    KAA_FREE(self->operations_access_points);
+    self->operations_access_points = new_access_points;
+    self->operations_access_points_size = size;
+    self->operations_access_points_expiry = expiry;
+    self->dirty_fields |= KAA_STATUS_OPERATIONS_ACCESS_POINTS;
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_status_save(kaa_status_t *self)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
 
-    if (!self->has_update)
-        return KAA_ERR_NONE;
+    if (!self->has_update) {
+        if (!self->dirty_fields)
+            return KAA_ERR_NONE;
+
+        size_t records_size = kaa_status_get_records_size(self, self->dirty_fields);
+        if (self->journal_size + records_size <= KAA_STATUS_JOURNAL_MAX_SIZE) {
+            char *records = KAA_MALLOC(records_size);
+            KAA_RETURN_IF_NIL(records, KAA_ERR_NOMEM);
+            kaa_status_write_records(self, self->dirty_fields, records);
+            ext_status_append(records, records_size);
+            KAA_FREE(records);
+            self->journal_size += records_size;
+            self->dirty_fields = 0;
+            return KAA_ERR_NONE;
+        }
+        // Compact the appended records into a rewrite
+    }
 
     size_t endpoint_access_token_length = self->endpoint_access_token ? strlen(self->endpoint_access_token) : 0;
     size_t states_count = kaa_list_get_size(self->topic_states);
     size_t topics_count = kaa_list_get_size(self->topics);
+    uint32_t records_fields = (self->has_configuration_hash ? KAA_STATUS_CONFIGURATION_HASH : 0)
+            | (self->operations_access_points ? KAA_STATUS_OPERATIONS_ACCESS_POINTS : 0);
 
     // Calculate size of whole list of topics
     kaa_list_node_t *topic_node = kaa_list_begin(self->topics);
@@ -252,7 +430,8 @@ kaa_error_t kaa_status_save(kaa_status_t *self)
             /*               Topic ID            Sequence number  */
             + states_count * (sizeof(uint32_t) + sizeof(uint64_t))
             + topics_size
-            + sizeof(int32_t);
+            + sizeof(int32_t)
+            + kaa_status_get_records_size(self, records_fields);
 
     char *buffer_head = KAA_MALLOC(buffer_size * sizeof(char));
     KAA_RETURN_IF_NIL(buffer_head, KAA_ERR_NOMEM);
@@ -294,12 +473,15 @@ kaa_error_t kaa_status_save(kaa_status_t *self)
 
     WRITE_BUFFER(&self->topic_list_hash, buffer, sizeof(self->topic_list_hash));
     WRITE_BUFFER(KAA_SDK_TOKEN, buffer, sizeof(KAA_SDK_TOKEN));
+    size_t records_size = kaa_status_write_records(self, records_fields, buffer);
 
     ext_status_store(buffer_head, buffer_size);
 
     KAA_FREE(buffer_head);
 
     self->has_update = false;
+    self->dirty_fields = 0;
+    self->journal_size = records_size;
 
     return KAA_ERR_NONE;
 }
@@ -31,6 +31,19 @@ typedef struct {
     uint32_t sqn_number;
 } kaa_topic_state_t;
 
+/**
+ * Fields saved by appending a small record to the persisted status instead of rewriting the whole of it.
+ * Set them in @c dirty_fields when changed; @c has_update still requests the complete rewrite.
+ */
+typedef enum {
+    KAA_STATUS_REGISTERED               = 0x01,
+    KAA_STATUS_ATTACHED                 = 0x02,
+    KAA_STATUS_EVENT_SEQ_N              = 0x04,
+    KAA_STATUS_PROFILE_HASH             = 0x08, /**< Along with profile_needs_resync */
+    KAA_STATUS_CONFIGURATION_HASH       = 0x10, /**< Along with has_configuration_hash */
+    KAA_STATUS_OPERATIONS_ACCESS_POINTS = 0x20, /**< Along with their expiry time */
+} kaa_status_field_t;
+
 #ifndef KAA_STATUS_T
 # define KAA_STATUS_T
 typedef struct
@@ -48,6 +61,14 @@ typedef struct
     int32_t         topic_list_hash;        /**< List hash */
     char            *endpoint_access_token;
     bool            has_update; /**< Indicates that status was changed on the client size */
+    kaa_digest      configuration_hash;     /**< Hash of the persisted configuration */
+    bool            has_configuration_hash; /**< Indicates that configuration_hash is known */
+    uint32_t        dirty_fields;           /**< kaa_status_field_t fields changed since the last save */
+    size_t          journal_size;           /**< Size of the records appended since the last rewrite */
+    uint8_t         *operations_access_points;          /**< Access points of the last bootstrap response, as received */
+    size_t          operations_access_points_size;
+    uint64_t        operations_access_points_expiry;    /**< KAA_TIME() after which the access points are not used */
+    uint32_t        user_endpoints_epoch;   /**< Changed along with the endpoints attached to the user, not persisted */
 } kaa_status_t;
 
 #endif
@@ -25,20 +25,32 @@
 #include <stddef.h>
 #include "platform/ext_configuration_persistence.h"
 #include "econais_ec19d_file_utils.h"
+#include "platform-impl/common/kaa_bank_storage.h"
 
-#define KAA_CONFIGURATION_STORAGE    "kaa_configuration.bin"
+#define KAA_CONFIGURATION_STORAGE       "kaa_configuration.bin"
+#define KAA_CONFIGURATION_STORAGE_BANK  "kaa_configuration_1.bin"
+
+static const kaa_bank_file_ops_t configuration_file_ops = {
+    econais_ec19d_binary_file_read,
+    econais_ec19d_binary_file_store,
+    econais_ec19d_binary_file_append,
+    econais_ec19d_binary_file_delete,
+};
+
+static kaa_bank_storage_t configuration_storage = KAA_BANK_STORAGE_INITIALIZER(
+        KAA_CONFIGURATION_STORAGE, KAA_CONFIGURATION_STORAGE_BANK, &configuration_file_ops);
 
 void ext_configuration_read(char **buffer, size_t *buffer_size, bool *needs_deallocation)
 {
-    econais_ec19d_binary_file_read(KAA_CONFIGURATION_STORAGE, buffer, buffer_size, needs_deallocation);
+    kaa_bank_storage_read(&configuration_storage, buffer, buffer_size, needs_deallocation);
 }
 
 void ext_configuration_store(const char *buffer, size_t buffer_size)
 {
-    econais_ec19d_binary_file_store(KAA_CONFIGURATION_STORAGE, buffer, buffer_size);
+    kaa_bank_storage_store(&configuration_storage, buffer, buffer_size);
 }
 
 void ext_configuration_delete(void)
 {
-    econais_ec19d_binary_file_delete(KAA_CONFIGURATION_STORAGE);
+    kaa_bank_storage_delete(&configuration_storage);
 }
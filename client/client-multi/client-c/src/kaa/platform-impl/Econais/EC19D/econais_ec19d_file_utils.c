@@ -57,7 +57,21 @@ int econais_ec19d_binary_file_store(const char *file_name, const char *buffer, s
     if (status_file) {
         int i = sndc_file_write(status_file, (void*)buffer, buffer_size);
         sndc_file_close(status_file);
-        return 0 ? (i >= 0) : -1;
+        return i >= 0 ? 0 : -1;
+    }
+    return -1;
+}
+
+int econais_ec19d_binary_file_append(const char *file_name, const char *buffer, size_t buffer_size)
+{
+    KAA_RETURN_IF_NIL3(file_name, buffer, buffer_size, -1);
+    sndc_file_ref_t status_file = sndc_file_open(file_name, DE_FCREATE|DE_FWRONLY);
+
+    if (status_file) {
+        sndc_file_seek(status_file, 0, SEEK_END);
+        int i = sndc_file_write(status_file, (void*)buffer, buffer_size);
+        sndc_file_close(status_file);
+        return i >= 0 ? 0 : -1;
     }
     return -1;
 }
@@ -34,6 +34,7 @@ typedef long long int64_t;
 #include "platform/time.h"
 #include "platform-impl/common/kaa_tcp_channel.h"
 #include "platform-impl/common/ext_log_upload_strategies.h"
+#include "platform-impl/common/kaa_bank_storage.h"
 #include "kaa_bootstrap_manager.h"
 #include "kaa_channel_manager.h"
 #include "kaa_configuration_manager.h"
@@ -100,6 +101,7 @@ _Static_assert(KAA_DEMO_MAX_LOG_BUCKET_SIZE, "Maximum bucket size cannot be 0!")
  */
 #define KAA_KEY_STORAGE       "key.txt"
 #define KAA_STATUS_STORAGE    "status.conf"
+#define KAA_STATUS_STORAGE_BANK "status_1.conf"
 
 static size_t kaa_public_key_length;
 static char *kaa_public_key;
@@ -637,14 +639,29 @@ void thread_run_fn(uintptr_t arg)
 /*
  * External API to store/load the Kaa SDK status.
  */
+static const kaa_bank_file_ops_t status_file_ops = {
+    econais_ec19d_binary_file_read,
+    econais_ec19d_binary_file_store,
+    econais_ec19d_binary_file_append,
+    econais_ec19d_binary_file_delete,
+};
+
+static kaa_bank_storage_t status_storage =
+        KAA_BANK_STORAGE_INITIALIZER(KAA_STATUS_STORAGE, KAA_STATUS_STORAGE_BANK, &status_file_ops);
+
 void ext_status_read(char **buffer, size_t *buffer_size, bool *needs_deallocation)
 {
-    econais_ec19d_binary_file_read(KAA_STATUS_STORAGE, buffer, buffer_size, needs_deallocation);
+    kaa_bank_storage_read(&status_storage, buffer, buffer_size, needs_deallocation);
 }
 
 void ext_status_store(const char *buffer, size_t buffer_size)
 {
-    econais_ec19d_binary_file_store(KAA_STATUS_STORAGE, buffer, buffer_size);
+    kaa_bank_storage_store(&status_storage, buffer, buffer_size);
+}
+
+void ext_status_append(const char *buffer, size_t buffer_size)
+{
+    kaa_bank_storage_append(&status_storage, buffer, buffer_size);
 }
 
 
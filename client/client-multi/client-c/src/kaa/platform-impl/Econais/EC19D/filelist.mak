@@ -16,7 +16,7 @@
 
 
 CFILES-ECONAIS-PLAT = kaa/platform-impl/Econais/EC19D/econais_ec19d_kaa_client.c kaa/platform-impl/Econais/EC19D/__ashldi3.c kaa/platform-impl/Econais/EC19D/logger.c kaa/platform-impl/Econais/EC19D/sha.c kaa/platform-impl/Econais/EC19D/econais_ec19d_tcp_utils.c kaa/platform-impl/Econais/EC19D/econais_ec19d_file_utils.c kaa/platform-impl/Econais/EC19D/econais_ec19d_configuration_persistence.c
-CFILES-PLAT-IMPL = kaa/platform-impl/common/ext_log_storage_memory.c kaa/platform-impl/common/ext_log_upload_strategies.c kaa/platform-impl/common/kaa_failover_strategy.c kaa/platform-impl/common/kaa_tcp_channel.c kaa/platform-impl/common/kaa_htonll.c
+CFILES-PLAT-IMPL = kaa/platform-impl/common/ext_log_storage_memory.c kaa/platform-impl/common/ext_log_upload_strategies.c kaa/platform-impl/common/kaa_failover_strategy.c kaa/platform-impl/common/kaa_tcp_channel.c kaa/platform-impl/common/kaa_htonll.c kaa/platform-impl/common/kaa_bank_storage.c
 CFILES-PROTO = kaa/kaa_protocols/kaa_tcp/kaatcp_parser.c kaa/kaa_protocols/kaa_tcp/kaatcp_request.c
 CFILES-AVRO = kaa/avro_src/io.c kaa/avro_src/encoding_binary.c
 CFILES-COLLECTIONS = kaa/collections/kaa_list.c
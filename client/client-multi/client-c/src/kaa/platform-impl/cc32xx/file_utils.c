@@ -190,3 +190,88 @@ int cc32xx_binary_file_delete(const char *file_name)
     return -1;
 #endif
 }
+
+int cc32xx_binary_file_append(const char *file_name, const char *buffer, size_t buffer_size)
+{
+// TODO: KAA-845
+// There is no file consistency check when parsing persistence data. This causes
+// bugs when data inside a file is misinterpreted.
+#if 0
+    KAA_RETURN_IF_NIL3(file_name, buffer, buffer_size, -1);
+
+    int32_t ret = -1;
+    uint32_t ul_token;
+    int32_t l_file_handle;
+    SlFsFileInfo_t file_info;
+
+    memset(&file_info, 0, sizeof(file_info));
+
+    if (!file_is_exist(file_name) && !create_file(file_name))
+        return ret;
+
+    sl_FsGetInfo((unsigned char*)file_name, 0, &file_info);
+    if (MAX_FILE_SIZE < file_info.FileLen + buffer_size)
+        return ret;
+
+    // The file is rewritten as a whole when opened for writing
+    uint8_t *result_buffer = (uint8_t*) KAA_MALLOC(file_info.FileLen + buffer_size);
+    if (!result_buffer)
+        return ret;
+
+    if (file_info.FileLen > 0) {
+        ret = sl_FsOpen((unsigned char*)file_name, FS_MODE_OPEN_READ, &ul_token, &l_file_handle);
+        if (ret < 0 || sl_FsRead(l_file_handle, 0, result_buffer, file_info.FileLen) < (int32_t)file_info.FileLen) {
+            sl_FsClose(l_file_handle, 0, 0, 0);
+            KAA_FREE(result_buffer);
+            return -1;
+        }
+        sl_FsClose(l_file_handle, 0, 0, 0);
+    }
+    memcpy(result_buffer + file_info.FileLen, buffer, buffer_size);
+
+    ret = sl_FsOpen((unsigned char*)file_name, FS_MODE_OPEN_WRITE, &ul_token, &l_file_handle);
+    if (ret == 0) {
+        if (sl_FsWrite(l_file_handle, 0, result_buffer, file_info.FileLen + buffer_size) < 0)
+            ret = -1;
+        sl_FsClose(l_file_handle, 0, 0, 0);
+    }
+
+    KAA_FREE(result_buffer);
+    return ret;
+#else
+    (void)file_name;
+    (void)buffer;
+    (void)buffer_size;
+    return -1;
+#endif
+}
+
+int cc32xx_binary_file_read_at(const char *file_name, size_t offset, char *buffer, size_t buffer_size)
+{
+// TODO: KAA-845
+// There is no file consistency check when parsing persistence data. This causes
+// bugs when data inside a file is misinterpreted.
+#if 0
+    KAA_RETURN_IF_NIL3(file_name, buffer, buffer_size, -1);
+
+    uint32_t ul_token;
+    int32_t l_file_handle;
+
+    int32_t ret = sl_FsOpen((unsigned char*)file_name, FS_MODE_OPEN_READ, &ul_token, &l_file_handle);
+    if (ret < 0) {
+        sl_FsClose(l_file_handle, 0, 0, 0);
+        return -1;
+    }
+
+    ret = sl_FsRead(l_file_handle, offset, (unsigned char *)buffer, buffer_size);
+    sl_FsClose(l_file_handle, 0, 0, 0);
+
+    return ret < 0 ? 0 : ret;
+#else
+    (void)file_name;
+    (void)offset;
+    (void)buffer;
+    (void)buffer_size;
+    return -1;
+#endif
+}
@@ -20,6 +20,8 @@
 
 #define KAA_TCP_CHANNEL_IN_BUFFER_SIZE      2048
 #define KAA_TCP_CHANNEL_OUT_BUFFER_SIZE     8192
+#define KAA_TCP_CHANNEL_SCRATCH_SIZE        2048
+#define KAA_TCP_CHANNEL_MAX_SPLICES         8
 
 #define KAA_TCP_CHANNEL_MAX_TIMEOUT         200u
 #define KAA_TCP_CHANNEL_PING_TIMEOUT        (KAA_TCP_CHANNEL_MAX_TIMEOUT / 2)
@@ -27,4 +29,8 @@
 #define KAATCP_PARSER_MAX_MESSAGE_LENGTH    1024
 #define KAA_MAX_LOG_MESSAGE_LENGTH          512
 
+#define KAA_FILE_LOG_STORAGE_SEGMENT_SIZE   8192
+#define KAA_FILE_LOG_STORAGE_MAX_SEGMENTS   4
+#define KAA_FILE_LOG_STORAGE_WINDOW_SIZE    1024
+
 #endif /* CC32XX_DEFAULTS_H_ */
@@ -18,22 +18,37 @@
 #include <stddef.h>
 #include <platform/ext_status.h>
 #include <platform/file_utils.h>
+#include "platform-impl/common/kaa_bank_storage.h"
 
-#define KAA_STATUS_STORAGE    "kaa_status.bin"
+#define KAA_STATUS_STORAGE          "kaa_status.bin"
+#define KAA_STATUS_STORAGE_BANK     "kaa_status_1.bin"
+
+static const kaa_bank_file_ops_t status_file_ops = {
+    cc32xx_binary_file_read,
+    cc32xx_binary_file_store,
+    cc32xx_binary_file_append,
+    cc32xx_binary_file_delete,
+};
+
+static kaa_bank_storage_t status_storage =
+        KAA_BANK_STORAGE_INITIALIZER(KAA_STATUS_STORAGE, KAA_STATUS_STORAGE_BANK, &status_file_ops);
 
 void ext_status_read(char **buffer, size_t *buffer_size, bool *needs_deallocation)
 {
-    cc32xx_binary_file_read(KAA_STATUS_STORAGE, buffer, buffer_size, needs_deallocation);
+    kaa_bank_storage_read(&status_storage, buffer, buffer_size, needs_deallocation);
 }
 
 void ext_status_store(const char *buffer, size_t buffer_size)
 {
-    cc32xx_binary_file_store(KAA_STATUS_STORAGE, buffer, buffer_size);
+    kaa_bank_storage_store(&status_storage, buffer, buffer_size);
 }
 
-void ext_status_delete(void)
+void ext_status_append(const char *buffer, size_t buffer_size)
 {
-    cc32xx_binary_file_delete(KAA_STATUS_STORAGE);
+    kaa_bank_storage_append(&status_storage, buffer, buffer_size);
 }
 
-
+void ext_status_delete(void)
+{
+    kaa_bank_storage_delete(&status_storage);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/ext_encryption_utils.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <mbedtls/aes.h>
+
+#define AES_BLOCK_SIZE    16
+#define AES_KEY_BITS      128
+
+/*
+ * The session key doesn't change between the requests, so it is expanded
+ * only when it does rather than for each block.
+ */
+static struct {
+    mbedtls_aes_context enc;
+    mbedtls_aes_context dec;
+    uint8_t key[AES_BLOCK_SIZE];
+    bool initialized;
+    bool key_set;
+} aes;
+
+static kaa_error_t set_key(const uint8_t *key)
+{
+    if (aes.key_set && !memcmp(aes.key, key, sizeof(aes.key))) {
+        return KAA_ERR_NONE;
+    }
+
+    if (!aes.initialized) {
+        mbedtls_aes_init(&aes.enc);
+        mbedtls_aes_init(&aes.dec);
+        aes.initialized = true;
+    }
+
+    aes.key_set = !mbedtls_aes_setkey_enc(&aes.enc, key, AES_KEY_BITS)
+            && !mbedtls_aes_setkey_dec(&aes.dec, key, AES_KEY_BITS);
+    if (!aes.key_set) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    memcpy(aes.key, key, sizeof(aes.key));
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t ext_aes_ecb_crypt(bool encrypt, const uint8_t *key, const uint8_t *input,
+        size_t size, uint8_t *output)
+{
+    if (!key || !input || !output || size % AES_BLOCK_SIZE) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    kaa_error_t error = set_key(key);
+    if (error) {
+        return error;
+    }
+
+    mbedtls_aes_context *ctx = encrypt ? &aes.enc : &aes.dec;
+    int mode = encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT;
+
+    for (; size; size -= AES_BLOCK_SIZE) {
+        if (mbedtls_aes_crypt_ecb(ctx, mode, input, output)) {
+            return KAA_ERR_BADDATA;
+        }
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+    }
+
+    return KAA_ERR_NONE;
+}
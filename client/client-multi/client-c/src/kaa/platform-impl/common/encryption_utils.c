@@ -16,6 +16,7 @@
 
 #include "platform/ext_encryption_utils.h"
 #include "platform/ext_key_utils.h"
+#include "platform/ext_sha.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -31,8 +32,27 @@
 #define KAA_SIGNATURE_LENGTH           256
 #define AES_ECB_ENCRYPTION_CHUNK_SIZE  16
 
+#ifndef KAA_SESSION_KEY_CACHE_SIZE
+/* One entry for the bootstrap access point and one for the operations one. */
+#define KAA_SESSION_KEY_CACHE_SIZE     2
+#endif
+
 extern mbedtls_pk_context kaa_pk_context_;
 
+/**
+ * The session key encrypted with a remote key and its signature.
+ *
+ * The session key doesn't change, so reconnects to the same access point
+ * reuse both instead of repeating the RSA operations.
+ */
+typedef struct {
+    kaa_digest remote_key_hash;
+    bool       is_encrypted;
+    bool       is_signed;
+    uint8_t    encrypted_session_key[ENCRYPTED_SESSION_KEY_LENGTH];
+    uint8_t    signature[KAA_SIGNATURE_LENGTH];
+} session_key_cache_entry_t;
+
 /**
  * Contains Endpoint keys.
  *
@@ -41,9 +61,10 @@ extern mbedtls_pk_context kaa_pk_context_;
  */
 static struct {
     uint8_t session_key[KAA_SESSION_KEY_LENGTH];
-    uint8_t encrypted_session_key[ENCRYPTED_SESSION_KEY_LENGTH];
     uint8_t signature[KAA_SIGNATURE_LENGTH];
     size_t  session_key_length;
+    session_key_cache_entry_t cache[KAA_SESSION_KEY_CACHE_SIZE];
+    size_t  next_cache_entry;
 } keys;
 
 kaa_error_t kaa_init_session_key(void)
@@ -80,13 +101,40 @@ kaa_error_t ext_get_encrypted_session_key(uint8_t **buffer, size_t *buffer_size,
         return KAA_ERR_BADPARAM;
     }
 
-    kaa_error_t err = rsa_encrypt(remote_key, remote_key_size, keys.session_key,
-            KAA_SESSION_KEY_LENGTH, keys.encrypted_session_key);
+    kaa_digest remote_key_hash;
+    kaa_error_t err = ext_calculate_sha_hash((const char *)remote_key, remote_key_size, remote_key_hash);
     if (err) {
         return err;
     }
 
-    *buffer = keys.encrypted_session_key;
+    session_key_cache_entry_t *entry = NULL;
+    for (size_t i = 0; i < KAA_SESSION_KEY_CACHE_SIZE; ++i) {
+        if (keys.cache[i].is_encrypted
+                && !memcmp(keys.cache[i].remote_key_hash, remote_key_hash, SHA_1_DIGEST_LENGTH)) {
+            entry = &keys.cache[i];
+            break;
+        }
+    }
+
+    if (!entry) {
+        /* The oldest entry is replaced */
+        entry = &keys.cache[keys.next_cache_entry];
+        keys.next_cache_entry = (keys.next_cache_entry + 1) % KAA_SESSION_KEY_CACHE_SIZE;
+
+        entry->is_encrypted = false;
+        entry->is_signed = false;
+
+        err = rsa_encrypt(remote_key, remote_key_size, keys.session_key,
+                KAA_SESSION_KEY_LENGTH, entry->encrypted_session_key);
+        if (err) {
+            return err;
+        }
+
+        memcpy(entry->remote_key_hash, remote_key_hash, SHA_1_DIGEST_LENGTH);
+        entry->is_encrypted = true;
+    }
+
+    *buffer = entry->encrypted_session_key;
     *buffer_size = ENCRYPTED_SESSION_KEY_LENGTH;
 
     return err;
@@ -110,11 +158,12 @@ kaa_error_t ext_encrypt_data(const uint8_t *input, size_t payload_size, uint8_t
     /* Adding PKCS7 padding */
     size_t enc_data_size = ext_get_encrypted_data_size(payload_size);
     uint8_t padding = enc_data_size - payload_size;
-    memcpy(output, input, payload_size);
+    if (output != input) {
+        memcpy(output, input, payload_size);
+    }
     memset(output + payload_size, padding, padding);
 
-    return aes_encrypt_decrypt(MBEDTLS_AES_ENCRYPT, output, enc_data_size,
-            output, keys.session_key);
+    return ext_aes_ecb_crypt(true, keys.session_key, output, enc_data_size, output);
 }
 
 kaa_error_t ext_decrypt_data(const uint8_t *input, size_t input_size,
@@ -124,8 +173,7 @@ kaa_error_t ext_decrypt_data(const uint8_t *input, size_t input_size,
         return KAA_ERR_BADPARAM;
     }
 
-    if (aes_encrypt_decrypt(MBEDTLS_AES_DECRYPT, input, input_size,
-                output, keys.session_key)) {
+    if (ext_aes_ecb_crypt(false, keys.session_key, input, input_size, output)) {
         return KAA_ERR_BADPARAM;
     }
 
@@ -143,6 +191,24 @@ kaa_error_t ext_get_signature(const uint8_t *input, size_t input_size,
         return KAA_ERR_BADPARAM;
     }
 
+    /* The encrypted session key from the cache is signed once */
+    for (size_t i = 0; i < KAA_SESSION_KEY_CACHE_SIZE; ++i) {
+        session_key_cache_entry_t *entry = &keys.cache[i];
+        if (entry->is_encrypted && input == entry->encrypted_session_key
+                && input_size == ENCRYPTED_SESSION_KEY_LENGTH) {
+            if (!entry->is_signed) {
+                if (rsa_sign(&kaa_pk_context_, input, input_size, entry->signature, output_size)) {
+                    return KAA_ERR_BADDATA;
+                }
+                entry->is_signed = true;
+            }
+
+            *output = entry->signature;
+            *output_size = KAA_SIGNATURE_LENGTH;
+            return KAA_ERR_NONE;
+        }
+    }
+
     kaa_error_t error = rsa_sign(&kaa_pk_context_, input, input_size, keys.signature, output_size);
 
     if (error) {
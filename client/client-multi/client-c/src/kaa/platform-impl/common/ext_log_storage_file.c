@@ -0,0 +1,821 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Persistent log storage. The records are appended to a chain of segment files,
+ * each one starting with its sequence number. A segment is never rewritten: it is
+ * deleted once all its records are delivered or it is the eldest one and the
+ * storage is full. The sequence numbers cycle through a fixed set of file names,
+ * so the flash is worn evenly.
+ *
+ * Only a window of the records is kept in memory, the records are read through it
+ * as they are uploaded. The records left on flash are read back after a restart;
+ * those uploaded but not yet removed from the storage are sent again.
+ *
+ * A position is the segment index times KAA_FILE_LOG_STORAGE_SEGMENT_SIZE plus the
+ * offset in the segment. The positions are shifted once the eldest segment is gone.
+ */
+
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <platform/ext_log_storage.h>
+#include <platform/file_utils.h>
+
+#include "kaa_common.h"
+#include "kaa_platform_utils.h"
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#include <assert.h>
+
+#ifndef KAA_FILE_LOG_STORAGE_SEGMENT_SIZE
+/** Maximum size of a segment file */
+#define KAA_FILE_LOG_STORAGE_SEGMENT_SIZE       16384
+#endif
+
+#ifndef KAA_FILE_LOG_STORAGE_MAX_SEGMENTS
+/** Number of segment files */
+#define KAA_FILE_LOG_STORAGE_MAX_SEGMENTS       8
+#endif
+
+#ifndef KAA_FILE_LOG_STORAGE_WINDOW_SIZE
+/** Size of the records read at once, the biggest record with its header must fit it */
+#define KAA_FILE_LOG_STORAGE_WINDOW_SIZE        2048
+#endif
+
+#ifndef KAA_FILE_LOG_STORAGE_MAX_BUCKETS
+/** Number of buckets that may be marked (being uploaded) at the same time */
+#define KAA_FILE_LOG_STORAGE_MAX_BUCKETS        8
+#endif
+
+#define EXT_FILE_LOG_STORAGE_NAME               "kaa_logs_%u.bin"
+#define EXT_FILE_LOG_STORAGE_NAME_SIZE          sizeof("kaa_logs_4294967295.bin")
+#define EXT_FILE_LOG_STORAGE_MAGIC              0x4B4C4F47
+
+#ifdef CC32XX_PLATFORM
+#define log_file_append         cc32xx_binary_file_append
+#define log_file_read_at        cc32xx_binary_file_read_at
+#define log_file_delete         cc32xx_binary_file_delete
+#else
+#define log_file_append         posix_binary_file_append
+#define log_file_read_at        posix_binary_file_read_at
+#define log_file_delete         posix_binary_file_delete
+#endif
+
+
+
+typedef struct {
+    uint32_t    magic;
+    uint32_t    sequence;   /**< Sequence number of the segment */
+} ext_file_segment_header_t;
+
+typedef struct {
+    uint32_t    size;       /**< Size of the record data */
+    uint16_t    bucket_id;  /**< Bucket ID of the record */
+    uint16_t    unused;
+} ext_file_record_header_t;
+
+typedef struct {
+    uint16_t    bucket_id;  /**< Zero for the free entries */
+    bool        removed;    /**< The records are delivered but not yet reclaimed */
+    size_t      begin;      /**< Position of the first record of the bucket */
+    size_t      end;        /**< Position past the last record of the bucket */
+    size_t      count;      /**< Number of the records */
+    size_t      size;       /**< Size of the records data */
+} ext_file_bucket_t;
+
+typedef struct {
+    uint32_t           first_sequence;          /**< Sequence number of the eldest segment */
+    size_t             segment_count;           /**< Number of the segment files */
+    size_t             segment_lengths[KAA_FILE_LOG_STORAGE_MAX_SEGMENTS]; /**< Sizes of the segment files */
+    bool               sealed;                  /**< The newest segment is not appended to */
+    size_t             max_segments;            /**< Maximum number of the segment files */
+    size_t             shrinked_segments;       /**< Number of segments to shrink to if the storage is full */
+    size_t             head;                    /**< Position of the oldest record */
+    size_t             tail;                    /**< Position past the newest record */
+    size_t             next;                    /**< No unmarked records before this position */
+    size_t             unmarked_occupied_size;  /**< Volume occupied by unmarked logs */
+    size_t             unmarked_record_count;   /**< Number of unmarked logs */
+    ext_file_bucket_t  buckets[KAA_FILE_LOG_STORAGE_MAX_BUCKETS]; /**< Marked buckets */
+    char               *window;                 /**< Records read from the flash */
+    size_t             window_position;         /**< Position of the window */
+    size_t             window_length;           /**< Number of bytes in the window */
+    kaa_logger_t       *logger;                 /**< Logger instance */
+} ext_log_storage_file_t;
+
+
+
+/**
+ * @brief Creates the file log storage of @c KAA_FILE_LOG_STORAGE_MAX_SEGMENTS segments.
+ *
+ * The records left by the previous run are loaded. The elder logs are deleted
+ * to make room for the new ones.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger);
+
+
+
+/**
+ * @brief Creates the file log storage of the given size.
+ *
+ * The size is rounded down to whole segments, so are the elder logs deleted.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ * @param[in]     storage_size             The maximum storage size.
+ * @param[in]     percent_to_delete        The percentage of elder logs to delete if the maximum storage size.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete);
+
+
+
+/**
+ * @brief Destroys the instance of the file log storage. The records stay on flash.
+ *
+ * @param[in]   context The log storage context.
+ * @return    Error code.
+ */
+kaa_error_t ext_log_storage_destroy(void *context);
+
+
+
+static size_t file_slot_size(size_t record_size)
+{
+    return sizeof(ext_file_record_header_t) + KAA_ALIGNED_SIZE(record_size);
+}
+
+static void file_segment_name(char *name, uint32_t sequence)
+{
+    snprintf(name, EXT_FILE_LOG_STORAGE_NAME_SIZE, EXT_FILE_LOG_STORAGE_NAME,
+            (unsigned)(sequence % KAA_FILE_LOG_STORAGE_MAX_SEGMENTS));
+}
+
+static size_t file_segment_begin(size_t index)
+{
+    return index * KAA_FILE_LOG_STORAGE_SEGMENT_SIZE + sizeof(ext_file_segment_header_t);
+}
+
+/*
+ * Returns @p size bytes at @p position, reading them from the flash if needed.
+ */
+static const char *file_read(ext_log_storage_file_t *self, size_t position, size_t size)
+{
+    assert(size <= KAA_FILE_LOG_STORAGE_WINDOW_SIZE);
+
+    if (position < self->window_position || position + size > self->window_position + self->window_length) {
+        char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+        file_segment_name(name, self->first_sequence + position / KAA_FILE_LOG_STORAGE_SEGMENT_SIZE);
+
+        int length = log_file_read_at(name, position % KAA_FILE_LOG_STORAGE_SEGMENT_SIZE,
+                self->window, KAA_FILE_LOG_STORAGE_WINDOW_SIZE);
+
+        self->window_position = position;
+        self->window_length = length < 0 ? 0 : (size_t)length;
+        if (size > self->window_length) {
+            return NULL;
+        }
+    }
+
+    return self->window + (position - self->window_position);
+}
+
+/*
+ * Returns the position of the record stored at or after @p position, skipping the end of the segment.
+ */
+static size_t file_skip_segment_end(const ext_log_storage_file_t *self, size_t position)
+{
+    if (position >= self->tail) {
+        return position;
+    }
+
+    size_t index = position / KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    size_t offset = position % KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    if (offset < sizeof(ext_file_segment_header_t)) {
+        // Past the end of a segment filled up to the brim
+        return file_segment_begin(index);
+    }
+    if (offset >= self->segment_lengths[index]) {
+        return file_segment_begin(index + 1);
+    }
+    return position;
+}
+
+static ext_file_bucket_t *file_find_bucket_at(ext_log_storage_file_t *self, size_t position)
+{
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        if (self->buckets[i].bucket_id && self->buckets[i].begin == position) {
+            return &self->buckets[i];
+        }
+    }
+    return NULL;
+}
+
+static ext_file_bucket_t *file_find_free_bucket(ext_log_storage_file_t *self)
+{
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        if (!self->buckets[i].bucket_id) {
+            return &self->buckets[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Deletes the eldest segment file and shifts the positions to the next one.
+ */
+static void file_delete_first_segment(ext_log_storage_file_t *self)
+{
+    char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+    file_segment_name(name, self->first_sequence);
+    log_file_delete(name);
+
+    ++self->first_sequence;
+    --self->segment_count;
+    memmove(self->segment_lengths, self->segment_lengths + 1, self->segment_count * sizeof(size_t));
+    self->window_length = 0;
+
+    if (!self->segment_count) {
+        self->head = self->tail = self->next = 0;
+        self->sealed = false;
+        return;
+    }
+
+    self->head -= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    self->tail -= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    self->next -= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        if (self->buckets[i].bucket_id) {
+            self->buckets[i].begin -= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+            self->buckets[i].end -= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+        }
+    }
+}
+
+/*
+ * Reclaims the delivered buckets at the beginning of the storage.
+ */
+static void file_collect(ext_log_storage_file_t *self)
+{
+    while (self->head != self->tail) {
+        ext_file_bucket_t *bucket = file_find_bucket_at(self, file_skip_segment_end(self, self->head));
+        if (!bucket || !bucket->removed) {
+            break;
+        }
+
+        self->head = bucket->end;
+        memset(bucket, 0, sizeof(*bucket));
+    }
+
+    if (self->head == self->tail) {
+        // Everything is delivered, nothing to read back after a restart
+        while (self->segment_count) {
+            file_delete_first_segment(self);
+        }
+        return;
+    }
+
+    self->head = file_skip_segment_end(self, self->head);
+    if (self->next < self->head) {
+        self->next = self->head;
+    }
+
+    while (self->head >= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE) {
+        file_delete_first_segment(self);
+    }
+}
+
+/*
+ * Deletes the eldest segment together with the records left in it. May delete records already marked.
+ */
+static size_t file_drop_first_segment(ext_log_storage_file_t *self)
+{
+    size_t removed_record_count = 0;
+
+    for (size_t position = self->head; position < self->segment_lengths[0]; ) {
+        ext_file_record_header_t header;
+        const char *data = file_read(self, position, sizeof(header));
+        if (!data) {
+            break;
+        }
+        memcpy(&header, data, sizeof(header));
+        size_t slot_size = file_slot_size(header.size);
+
+        ext_file_bucket_t *bucket = file_find_bucket_at(self, position);
+        if (bucket) {
+            bucket->count--;
+            bucket->size -= header.size;
+            bucket->begin = file_skip_segment_end(self, position + slot_size);
+            if (bucket->begin >= bucket->end) {
+                memset(bucket, 0, sizeof(*bucket));
+            }
+        } else {
+            self->unmarked_record_count--;
+            self->unmarked_occupied_size -= header.size;
+        }
+
+        position += slot_size;
+        ++removed_record_count;
+    }
+
+    self->head = file_segment_begin(1);
+    if (self->next < self->head) {
+        self->next = self->head;
+    }
+
+    if (self->segment_count == 1) {
+        self->head = self->tail;
+    }
+    file_delete_first_segment(self);
+    file_collect(self);
+
+    return removed_record_count;
+}
+
+/*
+ * Makes sure the newest segment has room for @p slot_size bytes.
+ */
+static kaa_error_t file_prepare_segment(ext_log_storage_file_t *self, size_t slot_size)
+{
+    if (self->segment_count && !self->sealed
+            && self->segment_lengths[self->segment_count - 1] + slot_size <= KAA_FILE_LOG_STORAGE_SEGMENT_SIZE) {
+        return KAA_ERR_NONE;
+    }
+
+    if (self->segment_count >= self->max_segments) {
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Log storage is full (%zu segments). "
+                "Going to delete elder logs", self->segment_count);
+
+        size_t removed_record_count = 0;
+        do {
+            removed_record_count += file_drop_first_segment(self);
+        } while (self->segment_count && self->segment_count > self->shrinked_segments);
+
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "%zu records forcibly removed", removed_record_count);
+    }
+
+    uint32_t sequence = self->first_sequence + self->segment_count;
+    char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+    file_segment_name(name, sequence);
+
+    // Left by the previous run if the storage was full
+    log_file_delete(name);
+
+    ext_file_segment_header_t header = { EXT_FILE_LOG_STORAGE_MAGIC, sequence };
+    if (log_file_append(name, (const char *)&header, sizeof(header))) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to create log segment '%s'", name);
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    if (!self->segment_count) {
+        self->head = self->next = file_segment_begin(0);
+    }
+
+    self->segment_lengths[self->segment_count++] = sizeof(header);
+    self->tail = file_segment_begin(self->segment_count - 1);
+    self->sealed = false;
+
+    return KAA_ERR_NONE;
+}
+
+/*
+ * Loads the segments left by the previous run.
+ */
+static void file_load_segments(ext_log_storage_file_t *self)
+{
+    uint32_t sequences[KAA_FILE_LOG_STORAGE_MAX_SEGMENTS];
+    bool valid[KAA_FILE_LOG_STORAGE_MAX_SEGMENTS];
+    bool found = false;
+    uint32_t last_sequence = 0;
+
+    for (uint32_t slot = 0; slot < KAA_FILE_LOG_STORAGE_MAX_SEGMENTS; ++slot) {
+        char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+        file_segment_name(name, slot);
+
+        ext_file_segment_header_t header;
+        valid[slot] = log_file_read_at(name, 0, (char *)&header, sizeof(header)) == (int)sizeof(header)
+                && header.magic == EXT_FILE_LOG_STORAGE_MAGIC
+                && header.sequence % KAA_FILE_LOG_STORAGE_MAX_SEGMENTS == slot;
+        sequences[slot] = header.sequence;
+
+        if (valid[slot] && (!found || (int32_t)(header.sequence - last_sequence) > 0)) {
+            last_sequence = header.sequence;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return;
+    }
+
+    // The chain of the segments ending with the newest one
+    size_t count = 0;
+    while (count < self->max_segments) {
+        uint32_t slot = (last_sequence - count) % KAA_FILE_LOG_STORAGE_MAX_SEGMENTS;
+        if (!valid[slot] || sequences[slot] != last_sequence - count) {
+            break;
+        }
+        valid[slot] = false;
+        ++count;
+    }
+
+    for (uint32_t slot = 0; slot < KAA_FILE_LOG_STORAGE_MAX_SEGMENTS; ++slot) {
+        if (valid[slot]) {
+            char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+            file_segment_name(name, slot);
+            log_file_delete(name);
+        }
+    }
+
+    self->first_sequence = last_sequence - (count - 1);
+    self->segment_count = count;
+    self->head = self->next = file_segment_begin(0);
+
+    for (size_t index = 0; index < count; ++index) {
+        size_t position = file_segment_begin(index);
+        size_t end = (index + 1) * KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+        bool torn = false;
+
+        while (position < end) {
+            ext_file_record_header_t header;
+            const char *data = file_read(self, position, sizeof(header));
+            if (!data) {
+                torn = file_read(self, position, 1) != NULL;
+                break;
+            }
+            memcpy(&header, data, sizeof(header));
+
+            size_t slot_size = file_slot_size(header.size);
+            if (!header.size || !header.bucket_id || slot_size > KAA_FILE_LOG_STORAGE_WINDOW_SIZE
+                    || position + slot_size > end || !file_read(self, position, slot_size)) {
+                // Written partially when the previous run was interrupted
+                torn = true;
+                break;
+            }
+
+            self->unmarked_record_count++;
+            self->unmarked_occupied_size += header.size;
+            position += slot_size;
+        }
+
+        self->segment_lengths[index] = position % KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+        if (position == end) {
+            self->segment_lengths[index] = KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+        }
+        self->tail = index * KAA_FILE_LOG_STORAGE_SEGMENT_SIZE + self->segment_lengths[index];
+        self->sealed = torn;
+    }
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Loaded %zu log records from %zu segments",
+            self->unmarked_record_count, self->segment_count);
+
+    file_collect(self);
+}
+
+
+
+static kaa_error_t file_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t max_segments
+                                         , size_t shrinked_segments)
+{
+    ext_log_storage_file_t *log_storage = KAA_CALLOC(1, sizeof(ext_log_storage_file_t));
+    KAA_RETURN_IF_NIL(log_storage, KAA_ERR_NOMEM);
+
+    log_storage->window = KAA_MALLOC(KAA_FILE_LOG_STORAGE_WINDOW_SIZE);
+    if (!log_storage->window) {
+        KAA_FREE(log_storage);
+        return KAA_ERR_NOMEM;
+    }
+
+    log_storage->logger            = logger;
+    log_storage->max_segments      = max_segments;
+    log_storage->shrinked_segments = shrinked_segments;
+
+    file_load_segments(log_storage);
+
+    *log_storage_context_p = log_storage;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger)
+{
+    KAA_RETURN_IF_NIL2(log_storage_context_p, logger, KAA_ERR_BADPARAM);
+    return file_log_storage_create(log_storage_context_p, logger, KAA_FILE_LOG_STORAGE_MAX_SEGMENTS,
+            KAA_FILE_LOG_STORAGE_MAX_SEGMENTS);
+}
+
+
+
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete)
+{
+    KAA_RETURN_IF_NIL4(log_storage_context_p, logger, storage_size, percent_to_delete, KAA_ERR_BADPARAM);
+
+    if (percent_to_delete > 100) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: percentage of logs "
+                                                    "to remove is more than 100%% (%u%%)", percent_to_delete);
+        return KAA_ERR_BADPARAM;
+    }
+
+    size_t max_segments = storage_size / KAA_FILE_LOG_STORAGE_SEGMENT_SIZE;
+    if (!max_segments) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: %zu bytes are less "
+                "than a segment (%u)", storage_size, KAA_FILE_LOG_STORAGE_SEGMENT_SIZE);
+        return KAA_ERR_BADPARAM;
+    }
+    if (max_segments > KAA_FILE_LOG_STORAGE_MAX_SEGMENTS) {
+        max_segments = KAA_FILE_LOG_STORAGE_MAX_SEGMENTS;
+    }
+
+    return file_log_storage_create(log_storage_context_p, logger, max_segments,
+            (max_segments * (100 - percent_to_delete)) / 100);
+}
+
+
+
+kaa_error_t ext_log_storage_allocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL3(context, record, record->size, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    size_t slot_size = file_slot_size(record->size);
+    if (slot_size > KAA_FILE_LOG_STORAGE_WINDOW_SIZE
+            || slot_size > KAA_FILE_LOG_STORAGE_SEGMENT_SIZE - sizeof(ext_file_segment_header_t)) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_NOMEM, "Log record of %zu bytes doesn't fit the log storage",
+                record->size);
+        return KAA_ERR_NOMEM;
+    }
+
+    // Room for the header, so the record is written at once
+    char *slot = KAA_MALLOC(slot_size);
+    KAA_RETURN_IF_NIL(slot, KAA_ERR_NOMEM);
+
+    record->data = slot + sizeof(ext_file_record_header_t);
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_deallocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL3(context, record, record->data, KAA_ERR_BADPARAM);
+
+    KAA_FREE(record->data - sizeof(ext_file_record_header_t));
+    record->data = NULL;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_add_log_record(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL4(context, record, record->data, record->size, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    assert(record->bucket_id);
+
+    size_t slot_size = file_slot_size(record->size);
+    kaa_error_t error_code = file_prepare_segment(self, slot_size);
+    KAA_RETURN_IF_ERR(error_code);
+
+    char *slot = record->data - sizeof(ext_file_record_header_t);
+    ext_file_record_header_t header = { record->size, record->bucket_id, 0 };
+    memcpy(slot, &header, sizeof(header));
+    memset(record->data + record->size, 0, slot_size - sizeof(header) - record->size);
+
+    char name[EXT_FILE_LOG_STORAGE_NAME_SIZE];
+    file_segment_name(name, self->first_sequence + self->segment_count - 1);
+    if (log_file_append(name, slot, slot_size)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to write log record to '%s'", name);
+        // Whatever got written is not trusted
+        self->sealed = true;
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    self->segment_lengths[self->segment_count - 1] += slot_size;
+    self->tail += slot_size;
+
+    self->unmarked_occupied_size += record->size;
+    self->unmarked_record_count++;
+
+    KAA_FREE(slot);
+    record->data = NULL;
+    record->size = 0;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_get_next_record(void *context
+                                          , size_t max_len
+                                          , const char **data
+                                          , uint16_t *bucket_id
+                                          , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL4(context, max_len, data, record_len, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    if (!self->unmarked_record_count) {
+        *record_len = 0;
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    // Marked buckets are skipped as a whole
+    size_t position = file_skip_segment_end(self, self->next);
+    for (ext_file_bucket_t *marked = file_find_bucket_at(self, position); marked;
+            marked = file_find_bucket_at(self, position)) {
+        position = file_skip_segment_end(self, marked->end);
+    }
+    assert(position < self->tail);
+    self->next = position;
+
+    ext_file_record_header_t header;
+    const char *slot = file_read(self, position, sizeof(header));
+    if (slot) {
+        memcpy(&header, slot, sizeof(header));
+        slot = file_read(self, position, file_slot_size(header.size));
+    }
+
+    if (!slot) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to read log record");
+        *record_len = 0;
+        return KAA_ERR_READ_FAILED;
+    }
+
+    *record_len = header.size;
+    if (*record_len > max_len)
+        return KAA_ERR_INSUFFICIENT_BUFFER;
+
+    ext_file_bucket_t *bucket = NULL;
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_file_bucket_t *it = &self->buckets[i];
+        if (it->bucket_id == header.bucket_id && !it->removed
+                && file_skip_segment_end(self, it->end) == position) {
+            bucket = it;
+            break;
+        }
+    }
+
+    if (!bucket) {
+        bucket = file_find_free_bucket(self);
+        if (!bucket) {
+            KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Too many log buckets are being uploaded (%u)",
+                    KAA_FILE_LOG_STORAGE_MAX_BUCKETS);
+            *record_len = 0;
+            return KAA_ERR_NOT_FOUND;
+        }
+
+        bucket->bucket_id = header.bucket_id;
+        bucket->begin = position;
+    }
+
+    size_t slot_size = file_slot_size(header.size);
+    bucket->end = position + slot_size;
+    bucket->count++;
+    bucket->size += header.size;
+
+    *data = slot + sizeof(header);
+    if (bucket_id) {
+        *bucket_id = header.bucket_id;
+    }
+
+    self->next = position + slot_size;
+    self->unmarked_record_count--;
+    self->unmarked_occupied_size -= header.size;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_write_next_record(void *context
+                                            , char *buffer
+                                            , size_t buffer_len
+                                            , uint16_t *bucket_id
+                                            , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL(buffer, KAA_ERR_BADPARAM);
+
+    const char *data = NULL;
+    kaa_error_t error = ext_log_storage_get_next_record(context, buffer_len, &data, bucket_id, record_len);
+    if (!error) {
+        memcpy(buffer, data, *record_len);
+    }
+
+    return error;
+}
+
+
+
+kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL2(context, bucket_id, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    bool found = false;
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_file_bucket_t *bucket = &self->buckets[i];
+        if (bucket->bucket_id == bucket_id && !bucket->removed) {
+            // Reclaimed once all the elder records are gone
+            bucket->removed = true;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    file_collect(self);
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_unmark_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL2(context, bucket_id, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    bool found = false;
+    for (size_t i = 0; i < KAA_FILE_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_file_bucket_t *bucket = &self->buckets[i];
+        if (bucket->bucket_id != bucket_id || bucket->removed) {
+            continue;
+        }
+
+        self->unmarked_record_count += bucket->count;
+        self->unmarked_occupied_size += bucket->size;
+        if (bucket->begin < self->next) {
+            self->next = bucket->begin;
+        }
+
+        memset(bucket, 0, sizeof(*bucket));
+        found = true;
+    }
+
+    return found ? KAA_ERR_NONE : KAA_ERR_NOT_FOUND;
+}
+
+
+
+size_t ext_log_storage_get_total_size(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_file_t *)context)->unmarked_occupied_size;
+}
+
+
+
+size_t ext_log_storage_get_records_count(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_file_t *)context)->unmarked_record_count;
+}
+
+
+
+kaa_error_t ext_log_storage_destroy(void *context)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+    KAA_FREE(self->window);
+    KAA_FREE(self);
+    return KAA_ERR_NONE;
+}
+
+#endif
+
+/* ISO C forbids an empty translation unit */
+typedef int make_iso_compilers_happy;
@@ -261,13 +261,13 @@ static bool find_marked(void *log_record_p, void *mark)
     return ((ext_log_record_t *)log_record_p)->mark == *(bool *)mark;
 }
 
-kaa_error_t ext_log_storage_write_next_record(void *context
-                                            , char *buffer
-                                            , size_t buffer_len
-                                            , uint16_t *bucket_id
-                                            , size_t *record_len)
+kaa_error_t ext_log_storage_get_next_record(void *context
+                                          , size_t max_len
+                                          , const char **data
+                                          , uint16_t *bucket_id
+                                          , size_t *record_len)
 {
-    KAA_RETURN_IF_NIL4(context, buffer, buffer_len, record_len, KAA_ERR_BADPARAM);
+    KAA_RETURN_IF_NIL4(context, max_len, data, record_len, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = context;
 
     kaa_list_node_t *it = self->first_unmarked;
@@ -283,14 +283,14 @@ kaa_error_t ext_log_storage_write_next_record(void *context
 
     ext_log_record_t *record = kaa_list_get_data(it);
     *record_len = record->size;
-    if (*record_len > buffer_len)
+    if (*record_len > max_len)
         return KAA_ERR_INSUFFICIENT_BUFFER;
 
     // Only unmarked buckets with valid id can be written
     assert(record->bucket_id);
     assert(!record->mark);
 
-    memcpy(buffer, record->data, record->size);
+    *data = record->data;
 
     if (bucket_id) {
         *bucket_id = record->bucket_id;
@@ -307,6 +307,25 @@ kaa_error_t ext_log_storage_write_next_record(void *context
 
 
 
+kaa_error_t ext_log_storage_write_next_record(void *context
+                                            , char *buffer
+                                            , size_t buffer_len
+                                            , uint16_t *bucket_id
+                                            , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL(buffer, KAA_ERR_BADPARAM);
+
+    const char *data = NULL;
+    kaa_error_t error = ext_log_storage_get_next_record(context, buffer_len, &data, bucket_id, record_len);
+    if (!error) {
+        memcpy(buffer, data, *record_len);
+    }
+
+    return error;
+}
+
+
+
 kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_id)
 {
     KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
@@ -0,0 +1,618 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Fixed-capacity log storage. The records are kept one after another in a single
+ * preallocated byte ring, each one prefixed with its size and bucket ID. A record
+ * never wraps: if it doesn't fit before the end of the ring, the rest of the ring
+ * is skipped. The buckets being uploaded are kept in a small side table, so
+ * marking, unmarking and removing them don't walk the records.
+ *
+ * Positions in the ring only grow (the record at position p lives at p % capacity);
+ * they are brought back under the capacity once the oldest record passes it.
+ */
+
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+
+#include <stdint.h>
+#include <string.h>
+#include <platform/ext_log_storage.h>
+
+#include "kaa_common.h"
+#include "kaa_platform_utils.h"
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#include <assert.h>
+
+#ifndef KAA_RING_LOG_STORAGE_SIZE
+/** Capacity of the ring created by @link ext_unlimited_log_storage_create @endlink */
+#define KAA_RING_LOG_STORAGE_SIZE           4096
+#endif
+
+#ifndef KAA_RING_LOG_STORAGE_MAX_BUCKETS
+/** Number of buckets that may be marked (being uploaded) at the same time */
+#define KAA_RING_LOG_STORAGE_MAX_BUCKETS    8
+#endif
+
+/** Size of the header marking the skipped end of the ring */
+#define EXT_RING_PADDING                    UINT32_MAX
+
+
+
+typedef struct {
+    uint32_t    size;       /**< Size of the record data or @c EXT_RING_PADDING */
+    uint16_t    bucket_id;  /**< Bucket ID of the record */
+    uint16_t    unused;
+} ext_ring_record_header_t;
+
+typedef struct {
+    uint16_t    bucket_id;  /**< Zero for the free entries */
+    bool        removed;    /**< The records are delivered but not yet reclaimed */
+    size_t      begin;      /**< Position of the first record of the bucket */
+    size_t      end;        /**< Position past the last record of the bucket */
+    size_t      count;      /**< Number of the records */
+    size_t      size;       /**< Size of the records data */
+} ext_ring_bucket_t;
+
+typedef struct {
+    char               *ring;                   /**< The records */
+    size_t             capacity;                /**< Size of the ring */
+    bool               owns_ring;               /**< The ring is freed with the storage */
+    size_t             head;                    /**< Position of the oldest record */
+    size_t             tail;                    /**< Position past the newest record */
+    size_t             next;                    /**< No unmarked records before this position */
+    size_t             shrinked_size;           /**< Size to shrink the ring to if it is full */
+    size_t             unmarked_occupied_size;  /**< Volume occupied by unmarked logs */
+    size_t             unmarked_record_count;   /**< Number of unmarked logs */
+    char               *reserved;               /**< Data buffer given out and not yet added */
+    ext_ring_bucket_t  buckets[KAA_RING_LOG_STORAGE_MAX_BUCKETS]; /**< Marked buckets */
+    kaa_logger_t       *logger;                 /**< Logger instance */
+} ext_log_storage_ring_t;
+
+
+
+/**
+ * @brief Creates the ring log storage.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ * @param[in]     ring                     Optional memory for the records, allocated if @c NULL.
+ * @param[in]     capacity                 The size of the @p ring.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_ring_log_storage_create(void **log_storage_context_p
+                                      , kaa_logger_t *logger
+                                      , void *ring
+                                      , size_t capacity);
+
+
+
+/**
+ * @brief Creates the ring log storage of @c KAA_RING_LOG_STORAGE_SIZE bytes.
+ *
+ * The ring can't grow, so the storage is not really unlimited: the elder
+ * logs are deleted to make room for the new ones.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger);
+
+
+
+/**
+ * @brief Creates the ring log storage of the given size.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ * @param[in]     storage_size             The maximum storage size.
+ * @param[in]     percent_to_delete        The percentage of elder logs to delete if the maximum storage size.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete);
+
+
+
+/**
+ * @brief Destroys the instance of the ring log storage.
+ *
+ * @param[in]   context The log storage context.
+ * @return    Error code.
+ */
+kaa_error_t ext_log_storage_destroy(void *context);
+
+
+
+static size_t ring_slot_size(size_t record_size)
+{
+    return sizeof(ext_ring_record_header_t) + KAA_ALIGNED_SIZE(record_size);
+}
+
+static void ring_read_header(const ext_log_storage_ring_t *self, size_t position, ext_ring_record_header_t *header)
+{
+    memcpy(header, self->ring + position % self->capacity, sizeof(*header));
+}
+
+static void ring_write_header(ext_log_storage_ring_t *self, size_t position, uint32_t size, uint16_t bucket_id)
+{
+    ext_ring_record_header_t header = { size, bucket_id, 0 };
+    memcpy(self->ring + position % self->capacity, &header, sizeof(header));
+}
+
+/*
+ * Returns the position of the record stored at or after @p position, skipping the end of the ring.
+ */
+static size_t ring_skip_padding(const ext_log_storage_ring_t *self, size_t position)
+{
+    if (position >= self->tail) {
+        return position;
+    }
+
+    size_t left = self->capacity - position % self->capacity;
+    if (left < sizeof(ext_ring_record_header_t)) {
+        return position + left;
+    }
+
+    ext_ring_record_header_t header;
+    ring_read_header(self, position, &header);
+    return header.size == EXT_RING_PADDING ? position + left : position;
+}
+
+/*
+ * Returns the position where a record slot of @p slot_size bytes goes after the newest record.
+ */
+static size_t ring_slot_position(const ext_log_storage_ring_t *self, size_t slot_size)
+{
+    size_t left = self->capacity - self->tail % self->capacity;
+    return left < slot_size ? self->tail + left : self->tail;
+}
+
+static ext_ring_bucket_t *ring_find_bucket_at(ext_log_storage_ring_t *self, size_t position)
+{
+    for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        if (self->buckets[i].bucket_id && self->buckets[i].begin == position) {
+            return &self->buckets[i];
+        }
+    }
+    return NULL;
+}
+
+static ext_ring_bucket_t *ring_find_free_bucket(ext_log_storage_ring_t *self)
+{
+    for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        if (!self->buckets[i].bucket_id) {
+            return &self->buckets[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Reclaims the delivered buckets at the beginning of the ring.
+ */
+static void ring_collect(ext_log_storage_ring_t *self)
+{
+    while (self->head != self->tail) {
+        ext_ring_bucket_t *bucket = ring_find_bucket_at(self, ring_skip_padding(self, self->head));
+        if (!bucket || !bucket->removed) {
+            break;
+        }
+
+        self->head = bucket->end;
+        memset(bucket, 0, sizeof(*bucket));
+    }
+
+    if (self->head == self->tail && !self->reserved) {
+        // Empty, start over from the beginning of the ring
+        self->head = self->tail = self->next = 0;
+        return;
+    }
+
+    if (self->next < self->head) {
+        self->next = self->head;
+    }
+
+    if (self->head >= self->capacity) {
+        self->head -= self->capacity;
+        self->tail -= self->capacity;
+        self->next -= self->capacity;
+        for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+            if (self->buckets[i].bucket_id) {
+                self->buckets[i].begin -= self->capacity;
+                self->buckets[i].end -= self->capacity;
+            }
+        }
+    }
+}
+
+/*
+ * Deletes the oldest record. May delete a record already marked.
+ */
+static void ring_drop_head(ext_log_storage_ring_t *self)
+{
+    size_t position = ring_skip_padding(self, self->head);
+
+    ext_ring_record_header_t header;
+    ring_read_header(self, position, &header);
+    size_t slot_size = ring_slot_size(header.size);
+
+    ext_ring_bucket_t *bucket = ring_find_bucket_at(self, position);
+    if (bucket) {
+        bucket->count--;
+        bucket->size -= header.size;
+        bucket->begin = ring_skip_padding(self, position + slot_size);
+        if (bucket->begin >= bucket->end) {
+            memset(bucket, 0, sizeof(*bucket));
+        }
+    } else {
+        self->unmarked_record_count--;
+        self->unmarked_occupied_size -= header.size;
+    }
+
+    self->head = position + slot_size;
+    ring_collect(self);
+}
+
+static kaa_error_t ring_reserve(ext_log_storage_ring_t *self, size_t size, char **data)
+{
+    size_t slot_size = ring_slot_size(size);
+    if (slot_size > self->capacity) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_NOMEM, "Log record of %zu bytes doesn't fit the log storage of %zu bytes",
+                size, self->capacity);
+        return KAA_ERR_NOMEM;
+    }
+
+    size_t position = ring_slot_position(self, slot_size);
+    if (position + slot_size - self->head > self->capacity) {
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Log storage is full (occupied %zu, max %zu, record size %zu). "
+                "Going to delete elder logs", self->tail - self->head, self->capacity, size);
+
+        size_t removed_record_count = 0;
+        while (self->head != self->tail && (self->tail - self->head > self->shrinked_size
+                || ring_slot_position(self, slot_size) + slot_size - self->head > self->capacity)) {
+            ring_drop_head(self);
+            ++removed_record_count;
+        }
+
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "%zu records forcibly removed", removed_record_count);
+        position = ring_slot_position(self, slot_size);
+    }
+
+    *data = self->ring + position % self->capacity + sizeof(ext_ring_record_header_t);
+    self->reserved = *data;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_ring_log_storage_create(void **log_storage_context_p
+                                      , kaa_logger_t *logger
+                                      , void *ring
+                                      , size_t capacity)
+{
+    KAA_RETURN_IF_NIL3(log_storage_context_p, logger, capacity, KAA_ERR_BADPARAM);
+
+    // Records are aligned in the ring
+    capacity -= capacity % KAA_ALIGNMENT;
+    if (capacity < ring_slot_size(1)) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: %zu bytes are too few", capacity);
+        return KAA_ERR_BADPARAM;
+    }
+
+    ext_log_storage_ring_t *log_storage = KAA_CALLOC(1, sizeof(ext_log_storage_ring_t));
+    KAA_RETURN_IF_NIL(log_storage, KAA_ERR_NOMEM);
+
+    log_storage->logger        = logger;
+    log_storage->capacity      = capacity;
+    log_storage->shrinked_size = capacity;
+    log_storage->ring          = ring;
+
+    if (!log_storage->ring) {
+        log_storage->ring = KAA_MALLOC(capacity);
+        if (!log_storage->ring) {
+            KAA_FREE(log_storage);
+            return KAA_ERR_NOMEM;
+        }
+        log_storage->owns_ring = true;
+    }
+
+    *log_storage_context_p = log_storage;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger)
+{
+    return ext_ring_log_storage_create(log_storage_context_p, logger, NULL, KAA_RING_LOG_STORAGE_SIZE);
+}
+
+
+
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete)
+{
+    KAA_RETURN_IF_NIL4(log_storage_context_p, logger, storage_size, percent_to_delete, KAA_ERR_BADPARAM);
+
+    if (percent_to_delete > 100) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: percentage of logs "
+                                                    "to remove is more than 100%% (%u%%)", percent_to_delete);
+        return KAA_ERR_BADPARAM;
+    }
+
+    kaa_error_t error_code = ext_ring_log_storage_create(log_storage_context_p, logger, NULL, storage_size);
+    KAA_RETURN_IF_ERR(error_code);
+
+    ext_log_storage_ring_t *log_storage = *log_storage_context_p;
+    log_storage->shrinked_size = (log_storage->capacity * (100 - percent_to_delete)) / 100;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_allocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL3(context, record, record->size, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    // The record is serialized right where it is stored
+    return ring_reserve(self, record->size, &record->data);
+}
+
+
+
+kaa_error_t ext_log_storage_deallocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL3(context, record, record->data, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    if (record->data == self->reserved) {
+        self->reserved = NULL;
+        ring_collect(self);
+    } else {
+        KAA_FREE(record->data);
+    }
+
+    record->data = NULL;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_add_log_record(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL4(context, record, record->data, record->size, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    assert(record->bucket_id);
+
+    if (record->data != self->reserved) {
+        // Not allocated by the storage, so copied in
+        char *data = NULL;
+        kaa_error_t error_code = ring_reserve(self, record->size, &data);
+        KAA_RETURN_IF_ERR(error_code);
+
+        memcpy(data, record->data, record->size);
+        KAA_FREE(record->data);
+        record->data = data;
+    }
+
+    size_t slot_size = ring_slot_size(record->size);
+    size_t position = ring_slot_position(self, slot_size);
+    if (position != self->tail && position - self->tail >= sizeof(ext_ring_record_header_t)) {
+        ring_write_header(self, self->tail, EXT_RING_PADDING, 0);
+    }
+
+    ring_write_header(self, position, record->size, record->bucket_id);
+    self->tail = position + slot_size;
+    self->reserved = NULL;
+
+    self->unmarked_occupied_size += record->size;
+    self->unmarked_record_count++;
+
+    record->data = NULL;
+    record->size = 0;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_get_next_record(void *context
+                                          , size_t max_len
+                                          , const char **data
+                                          , uint16_t *bucket_id
+                                          , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL4(context, max_len, data, record_len, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    if (!self->unmarked_record_count) {
+        *record_len = 0;
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    // Marked buckets are skipped as a whole
+    size_t position = ring_skip_padding(self, self->next);
+    for (ext_ring_bucket_t *marked = ring_find_bucket_at(self, position); marked;
+            marked = ring_find_bucket_at(self, position)) {
+        position = ring_skip_padding(self, marked->end);
+    }
+    assert(position < self->tail);
+    self->next = position;
+
+    ext_ring_record_header_t header;
+    ring_read_header(self, position, &header);
+
+    *record_len = header.size;
+    if (*record_len > max_len)
+        return KAA_ERR_INSUFFICIENT_BUFFER;
+
+    ext_ring_bucket_t *bucket = NULL;
+    for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_ring_bucket_t *it = &self->buckets[i];
+        if (it->bucket_id == header.bucket_id && !it->removed
+                && ring_skip_padding(self, it->end) == position) {
+            bucket = it;
+            break;
+        }
+    }
+
+    if (!bucket) {
+        bucket = ring_find_free_bucket(self);
+        if (!bucket) {
+            KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Too many log buckets are being uploaded (%u)",
+                    KAA_RING_LOG_STORAGE_MAX_BUCKETS);
+            *record_len = 0;
+            return KAA_ERR_NOT_FOUND;
+        }
+
+        bucket->bucket_id = header.bucket_id;
+        bucket->begin = position;
+    }
+
+    size_t slot_size = ring_slot_size(header.size);
+    bucket->end = position + slot_size;
+    bucket->count++;
+    bucket->size += header.size;
+
+    *data = self->ring + position % self->capacity + sizeof(header);
+    if (bucket_id) {
+        *bucket_id = header.bucket_id;
+    }
+
+    self->next = position + slot_size;
+    self->unmarked_record_count--;
+    self->unmarked_occupied_size -= header.size;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_write_next_record(void *context
+                                            , char *buffer
+                                            , size_t buffer_len
+                                            , uint16_t *bucket_id
+                                            , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL(buffer, KAA_ERR_BADPARAM);
+
+    const char *data = NULL;
+    kaa_error_t error = ext_log_storage_get_next_record(context, buffer_len, &data, bucket_id, record_len);
+    if (!error) {
+        memcpy(buffer, data, *record_len);
+    }
+
+    return error;
+}
+
+
+
+kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL2(context, bucket_id, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    bool found = false;
+    for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_ring_bucket_t *bucket = &self->buckets[i];
+        if (bucket->bucket_id == bucket_id && !bucket->removed) {
+            // Reclaimed once all the elder records are gone
+            bucket->removed = true;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    ring_collect(self);
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_unmark_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL2(context, bucket_id, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+
+    bool found = false;
+    for (size_t i = 0; i < KAA_RING_LOG_STORAGE_MAX_BUCKETS; ++i) {
+        ext_ring_bucket_t *bucket = &self->buckets[i];
+        if (bucket->bucket_id != bucket_id || bucket->removed) {
+            continue;
+        }
+
+        self->unmarked_record_count += bucket->count;
+        self->unmarked_occupied_size += bucket->size;
+        if (bucket->begin < self->next) {
+            self->next = bucket->begin;
+        }
+
+        memset(bucket, 0, sizeof(*bucket));
+        found = true;
+    }
+
+    return found ? KAA_ERR_NONE : KAA_ERR_NOT_FOUND;
+}
+
+
+
+size_t ext_log_storage_get_total_size(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_ring_t *)context)->unmarked_occupied_size;
+}
+
+
+
+size_t ext_log_storage_get_records_count(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_ring_t *)context)->unmarked_record_count;
+}
+
+
+
+kaa_error_t ext_log_storage_destroy(void *context)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    ext_log_storage_ring_t *self = context;
+    if (self->owns_ring) {
+        KAA_FREE(self->ring);
+    }
+    KAA_FREE(self);
+    return KAA_ERR_NONE;
+}
+
+#endif
+
+/* ISO C forbids an empty translation unit */
+typedef int make_iso_compilers_happy;
@@ -18,6 +18,7 @@
 
 #include "kaa_private.h"
 #include "ext_log_upload_strategies.h"
+#include <stdint.h>
 #include <platform/ext_log_upload_strategy.h>
 #include <platform/ext_transport_channel.h>
 #include <platform/time.h>
@@ -135,6 +136,28 @@ ext_log_upload_decision_t ext_log_upload_strategy_decide(void *context, const vo
     return decision;
 }
 
+static size_t seconds_until(kaa_time_t deadline)
+{
+    kaa_time_t now = KAA_TIME();
+    return (deadline > now) ? (size_t)(deadline - now) : 0;
+}
+
+size_t ext_log_upload_strategy_get_decision_delay(void *context)
+{
+    KAA_RETURN_IF_NIL(context, SIZE_MAX);
+    ext_log_upload_strategy_t *self = (ext_log_upload_strategy_t *)context;
+
+    if (self->upload_retry_ts) {
+        return seconds_until((kaa_time_t)self->upload_retry_ts);
+    }
+
+    if (self->type & TIMEOUT_FLAG) {
+        return seconds_until((kaa_time_t)self->timeout);
+    }
+
+    return SIZE_MAX;
+}
+
 size_t ext_log_upload_strategy_get_timeout(void *context)
 {
     KAA_RETURN_IF_NIL(context, 0);
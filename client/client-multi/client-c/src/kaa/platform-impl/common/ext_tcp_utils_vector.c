@@ -0,0 +1,97 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Vectored socket I/O for the platforms without the native scatter/gather support.
+ * The parts are processed one by one with the plain socket calls until one of them is partial.
+ */
+
+#include "platform/ext_tcp_utils.h"
+#include "kaa_common.h"
+
+
+
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_writev(kaa_fd_t fd
+                                                         , const ext_tcp_io_vector_t *vectors
+                                                         , size_t vector_count
+                                                         , size_t *bytes_written)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+
+    size_t total_written = 0;
+    for (size_t i = 0; i < vector_count; ++i) {
+        if (!vectors[i].size) {
+            continue;
+        }
+
+        size_t part_written = 0;
+        ext_tcp_socket_io_errors_t io_error = ext_tcp_utils_tcp_socket_write(fd, vectors[i].buffer
+                                                                           , vectors[i].size, &part_written);
+        if (io_error) {
+            if (!total_written) {
+                return io_error;
+            }
+            // Reports the written bytes, the error repeats on the next call.
+            break;
+        }
+
+        total_written += part_written;
+        if (part_written < vectors[i].size) {
+            break;
+        }
+    }
+
+    if (bytes_written)
+        *bytes_written = total_written;
+    return KAA_TCP_SOCK_IO_OK;
+}
+
+
+
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_readv(kaa_fd_t fd
+                                                        , const ext_tcp_io_vector_t *vectors
+                                                        , size_t vector_count
+                                                        , size_t *bytes_read)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+
+    size_t total_read = 0;
+    for (size_t i = 0; i < vector_count; ++i) {
+        if (!vectors[i].size) {
+            continue;
+        }
+
+        size_t part_read = 0;
+        ext_tcp_socket_io_errors_t io_error = ext_tcp_utils_tcp_socket_read(fd, vectors[i].buffer
+                                                                          , vectors[i].size, &part_read);
+        if (io_error) {
+            if (!total_read) {
+                return io_error;
+            }
+            // Reports the read bytes, EOF or the error repeats on the next call.
+            break;
+        }
+
+        total_read += part_read;
+        if (part_read < vectors[i].size) {
+            break;
+        }
+    }
+
+    if (bytes_read)
+        *bytes_read = total_read;
+    return KAA_TCP_SOCK_IO_OK;
+}
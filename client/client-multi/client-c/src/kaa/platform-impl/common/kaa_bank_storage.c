@@ -0,0 +1,237 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A bank is the header followed by the blob and the data appended to it. The header is
+ * written first and the blob is appended to it, so a bank cut short by a reset is shorter
+ * than its header claims or fails the CRC.
+ */
+
+#include <string.h>
+
+#include "kaa_bank_storage.h"
+#include "utilities/kaa_mem.h"
+
+#define KAA_BANK_STORAGE_MAGIC      0x4B42414E
+
+typedef struct {
+    uint32_t    magic;
+    uint32_t    sequence;   /**< Incremented by each store, wraps around */
+    uint32_t    size;       /**< Size of the blob following the header */
+    uint32_t    crc;        /**< CRC-32 of the blob */
+} kaa_bank_header_t;
+
+typedef struct {
+    char        *buffer;
+    size_t      size;
+    bool        needs_deallocation;
+} kaa_bank_image_t;
+
+
+
+/* Bitwise CRC-32 (IEEE 802.3); the blobs are small and rarely stored, so a table isn't worth the flash. */
+static uint32_t kaa_bank_crc32(const char *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    while (size--) {
+        crc ^= (uint8_t) *data++;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void kaa_bank_image_release(kaa_bank_image_t *image)
+{
+    if (image->buffer && image->needs_deallocation) {
+        KAA_FREE(image->buffer);
+    }
+    memset(image, 0, sizeof(*image));
+}
+
+static bool kaa_bank_image_is_valid(const kaa_bank_image_t *image, kaa_bank_header_t *header)
+{
+    if (!image->buffer || image->size < sizeof(*header)) {
+        return false;
+    }
+
+    memcpy(header, image->buffer, sizeof(*header));
+    return header->magic == KAA_BANK_STORAGE_MAGIC
+        && header->size <= image->size - sizeof(*header)
+        && header->crc == kaa_bank_crc32(image->buffer + sizeof(*header), header->size);
+}
+
+static bool kaa_bank_image_is_legacy(const kaa_bank_image_t *image)
+{
+    uint32_t magic = 0;
+    if (!image->buffer || image->size < sizeof(kaa_bank_header_t)) {
+        return false;
+    }
+
+    memcpy(&magic, image->buffer, sizeof(magic));
+    return magic != KAA_BANK_STORAGE_MAGIC;
+}
+
+/*
+ * Finds the current bank. If requested, passes out the image of the current bank or,
+ * if there is none, the legacy image of the first bank.
+ */
+static void kaa_bank_storage_load(kaa_bank_storage_t *self, kaa_bank_image_t *current)
+{
+    kaa_bank_image_t images[KAA_BANK_STORAGE_BANK_COUNT];
+    kaa_bank_header_t header;
+
+    memset(images, 0, sizeof(images));
+    self->has_blob = false;
+    self->appended = false;
+    self->current_bank = 0;
+
+    for (uint8_t bank = 0; bank < KAA_BANK_STORAGE_BANK_COUNT; ++bank) {
+        kaa_bank_image_t *image = &images[bank];
+        if (self->ops->read(self->bank_names[bank], &image->buffer, &image->size, &image->needs_deallocation)) {
+            // The platform releases the buffer of a failed read
+            memset(image, 0, sizeof(*image));
+            continue;
+        }
+
+        if (!kaa_bank_image_is_valid(image, &header)) {
+            continue;
+        }
+
+        if (!self->has_blob || (int32_t)(header.sequence - self->sequence) > 0) {
+            self->has_blob = true;
+            self->current_bank = bank;
+            self->sequence = header.sequence;
+            self->size = header.size;
+            self->crc = header.crc;
+            self->appended = image->size > sizeof(header) + header.size;
+        }
+    }
+
+    self->loaded = true;
+
+    for (uint8_t bank = 0; bank < KAA_BANK_STORAGE_BANK_COUNT; ++bank) {
+        bool keep = current && (self->has_blob ? bank == self->current_bank
+                                               : bank == 0 && kaa_bank_image_is_legacy(&images[bank]));
+        if (keep) {
+            *current = images[bank];
+        } else {
+            kaa_bank_image_release(&images[bank]);
+        }
+    }
+}
+
+void kaa_bank_storage_read(kaa_bank_storage_t *self, char **buffer, size_t *buffer_size, bool *needs_deallocation)
+{
+    if (!self || !buffer || !buffer_size || !needs_deallocation) {
+        return;
+    }
+
+    *buffer = NULL;
+    *buffer_size = 0;
+    *needs_deallocation = false;
+
+    kaa_bank_image_t image = { NULL, 0, false };
+    kaa_bank_storage_load(self, &image);
+    if (!image.buffer) {
+        return;
+    }
+
+    if (self->has_blob) {
+        image.size -= sizeof(kaa_bank_header_t);
+        memmove(image.buffer, image.buffer + sizeof(kaa_bank_header_t), image.size);
+    }
+
+    *buffer = image.buffer;
+    *buffer_size = image.size;
+    *needs_deallocation = image.needs_deallocation;
+}
+
+int kaa_bank_storage_store(kaa_bank_storage_t *self, const char *buffer, size_t buffer_size)
+{
+    if (!self || !buffer || !buffer_size || buffer_size > UINT32_MAX) {
+        return -1;
+    }
+
+    if (!self->loaded) {
+        kaa_bank_storage_load(self, NULL);
+    }
+
+    uint32_t crc = kaa_bank_crc32(buffer, buffer_size);
+    if (self->has_blob && !self->appended && self->size == buffer_size && self->crc == crc) {
+        return 0;
+    }
+
+    // Never overwrite the current blob; a legacy file in the first bank is kept until the store succeeds
+    uint8_t bank = (self->current_bank + 1) % KAA_BANK_STORAGE_BANK_COUNT;
+    kaa_bank_header_t header = { KAA_BANK_STORAGE_MAGIC, self->sequence + 1, (uint32_t) buffer_size, crc };
+
+    if (self->ops->store(self->bank_names[bank], (const char *) &header, sizeof(header))
+            || self->ops->append(self->bank_names[bank], buffer, buffer_size)) {
+        return -1;
+    }
+
+    bool had_blob = self->has_blob;
+    self->has_blob = true;
+    self->appended = false;
+    self->current_bank = bank;
+    self->sequence = header.sequence;
+    self->size = header.size;
+    self->crc = header.crc;
+
+    if (!had_blob) {
+        // Don't let a stale or legacy bank be read if this one gets damaged
+        self->ops->remove(self->bank_names[(bank + 1) % KAA_BANK_STORAGE_BANK_COUNT]);
+    }
+
+    return 0;
+}
+
+int kaa_bank_storage_append(kaa_bank_storage_t *self, const char *buffer, size_t buffer_size)
+{
+    if (!self || !buffer || !buffer_size) {
+        return -1;
+    }
+
+    if (!self->loaded) {
+        kaa_bank_storage_load(self, NULL);
+    }
+
+    if (!self->has_blob) {
+        return -1;
+    }
+
+    // Even a failed append may leave a part of the data
+    self->appended = true;
+    return self->ops->append(self->bank_names[self->current_bank], buffer, buffer_size) ? -1 : 0;
+}
+
+void kaa_bank_storage_delete(kaa_bank_storage_t *self)
+{
+    if (!self) {
+        return;
+    }
+
+    for (uint8_t bank = 0; bank < KAA_BANK_STORAGE_BANK_COUNT; ++bank) {
+        self->ops->remove(self->bank_names[bank]);
+    }
+
+    self->loaded = true;
+    self->has_blob = false;
+    self->appended = false;
+    self->current_bank = 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file kaa_bank_storage.h
+ * @brief Dual-bank persistence of a single blob (e.g. the status or the configuration) on flash file systems.
+ *
+ * Each store goes to the bank not holding the current blob, after a header with the sequence number,
+ * the size and the CRC-32 of the blob. The newest bank whose blob matches its header is read back, so a
+ * store interrupted by a reset leaves the previous blob in place. A store of the blob already persisted
+ * is skipped.
+ *
+ * Appends go to the end of the current bank past the checked blob, so the appended data must detect
+ * its own interrupted tail (as the status records do).
+ *
+ * A first bank holding no header, i.e. the file written before the banks were introduced, is read as is.
+ */
+
+#ifndef KAA_BANK_STORAGE_H_
+#define KAA_BANK_STORAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KAA_BANK_STORAGE_BANK_COUNT     2
+
+/**
+ * File primitives of the platform, all of them return 0 on success.
+ */
+typedef struct {
+    int (*read)(const char *file_name, char **buffer, size_t *buffer_size, bool *needs_deallocation);
+    int (*store)(const char *file_name, const char *buffer, size_t buffer_size);
+    int (*append)(const char *file_name, const char *buffer, size_t buffer_size);
+    int (*remove)(const char *file_name);
+} kaa_bank_file_ops_t;
+
+typedef struct {
+    const char                 *bank_names[KAA_BANK_STORAGE_BANK_COUNT];
+    const kaa_bank_file_ops_t  *ops;
+    bool                       loaded;      /**< Banks were examined */
+    bool                       has_blob;    /**< @c current_bank holds a valid blob */
+    bool                       appended;    /**< Data was appended past the blob */
+    uint8_t                    current_bank;
+    uint32_t                   sequence;    /**< Sequence number of the current blob */
+    uint32_t                   size;        /**< Size of the current blob */
+    uint32_t                   crc;         /**< CRC-32 of the current blob */
+} kaa_bank_storage_t;
+
+/**
+ * Static initializer of the storage over the two files.
+ */
+#define KAA_BANK_STORAGE_INITIALIZER(FIRST_NAME, SECOND_NAME, OPS) \
+    { { (FIRST_NAME), (SECOND_NAME) }, (OPS), false, false, false, 0, 0, 0, 0 }
+
+/**
+ * @brief Reads the newest valid blob followed by the data appended to it.
+ *
+ * Follows the ext_status_read() contract: @c *buffer is NULL and @c *buffer_size is 0 if nothing is stored.
+ */
+void kaa_bank_storage_read(kaa_bank_storage_t *self, char **buffer, size_t *buffer_size, bool *needs_deallocation);
+
+/**
+ * @brief Persists the blob into the other bank unless it is the current one.
+ *
+ * @return 0 if the blob is persisted or was already, -1 otherwise.
+ */
+int kaa_bank_storage_store(kaa_bank_storage_t *self, const char *buffer, size_t buffer_size);
+
+/**
+ * @brief Appends the data to the current bank.
+ *
+ * @return 0 on success, -1 if no blob is stored or the write fails.
+ */
+int kaa_bank_storage_append(kaa_bank_storage_t *self, const char *buffer, size_t buffer_size);
+
+/**
+ * @brief Removes both banks.
+ */
+void kaa_bank_storage_delete(kaa_bank_storage_t *self);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_BANK_STORAGE_H_ */
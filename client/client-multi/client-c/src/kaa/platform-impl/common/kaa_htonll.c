@@ -21,6 +21,9 @@
 #define TYP_BIGE 2
 
 uint64_t kaa_htonll(uint64_t hostlonglong) {
+#ifdef KAA_HOST_BYTE_ORDER_KNOWN
+    return KAA_HOST_TO_BE64(hostlonglong);
+#else
     static int typ = TYP_INIT;
     unsigned char c;
     union {
@@ -39,6 +42,7 @@ uint64_t kaa_htonll(uint64_t hostlonglong) {
     c = x.c[2]; x.c[2] = x.c[5]; x.c[5] = c;
     c = x.c[3]; x.c[3] = x.c[4]; x.c[4] = c;
     return x.ull;
+#endif
 }
 
 uint64_t kaa_ntohll(uint64_t netlonglong)
@@ -19,6 +19,24 @@
 
 #include <stdint.h>
 
+/*
+ * Where the compiler tells the target's byte order, swaps compile to single
+ * instructions (e.g. BSWAP on x86, REV on Cortex-M3 and later). Otherwise
+ * KAA_HOST_BYTE_ORDER_KNOWN is left undefined and the byte order is found at run time.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define KAA_HOST_BYTE_ORDER_KNOWN
+#define KAA_HOST_TO_BE16(x)     ((uint16_t)(x))
+#define KAA_HOST_TO_BE32(x)     ((uint32_t)(x))
+#define KAA_HOST_TO_BE64(x)     ((uint64_t)(x))
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) \
+        && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define KAA_HOST_BYTE_ORDER_KNOWN
+#define KAA_HOST_TO_BE16(x)     __builtin_bswap16((uint16_t)(x))
+#define KAA_HOST_TO_BE32(x)     __builtin_bswap32((uint32_t)(x))
+#define KAA_HOST_TO_BE64(x)     __builtin_bswap64((uint64_t)(x))
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
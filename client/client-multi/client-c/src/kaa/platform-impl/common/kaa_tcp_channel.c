@@ -28,6 +28,7 @@
 #include "kaa_common.h"
 #include "utilities/kaa_mem.h"
 #include "utilities/kaa_buffer.h"
+#include "utilities/kaa_scratch.h"
 #include "utilities/kaa_log.h"
 #include "kaa_protocols/kaa_tcp/kaatcp.h"
 #include "platform/ext_system_logger.h"
@@ -42,6 +43,13 @@
 #define KAA_TCP_CHANNEL_TRANSPORT_PROTOCOL_ID         0x56c8ff92
 #define KAA_TCP_CHANNEL_TRANSPORT_PROTOCOL_VERSION    1
 
+#define KAA_TCP_CHANNEL_RESOLVE_POLL_MS               100
+
+#ifndef KAA_TIME_MS
+/* Platforms without a millisecond clock fall back to the second one */
+#define KAA_TIME_MS() ((uint64_t)KAA_TIME() * 1000)
+#endif
+
 
 
 
@@ -83,10 +91,19 @@ typedef struct {
 } kaa_tcp_access_point_t;
 
 typedef struct {
-    kaa_time_t last_sent_keepalive;
-    kaa_time_t last_receive_keepalive;
+    uint64_t last_sent_keepalive;       /* KAA_TIME_MS() */
+    uint64_t last_receive_keepalive;    /* KAA_TIME_MS() */
 } kaa_tcp_keepalive_t ;
 
+typedef enum {
+    KAA_TCP_DEADLINE_RESOLVE = 0,   /* Next poll of the pending hostname resolve */
+    KAA_TCP_DEADLINE_AUTHORIZE,     /* CONNACK is overdue */
+    KAA_TCP_DEADLINE_PING,          /* PING is to be sent, or the last one is unanswered */
+    KAA_TCP_DEADLINE_COUNT
+} kaa_tcp_deadline_t;
+
+#define KAA_TCP_DEADLINE_NONE   UINT64_MAX
+
 typedef struct {
     uint8_t *aes_session_key;
     size_t   aes_session_key_size;
@@ -104,15 +121,17 @@ typedef struct {
     on_kaa_tcp_channel_event_fn    event_callback;
     void                           *event_context;
     kaa_tcp_access_point_t         access_point;
-    kaa_extension_id               *pending_request_services;
-    size_t                         pending_request_service_count;
+    uint32_t                       pending_services;    /* Bitmask of extension ids waiting for a sync */
     kaa_extension_id               *supported_services;
     size_t                         supported_service_count;
     kaa_buffer_t                   *in_buffer;
     kaa_buffer_t                   *out_buffer;
+    kaa_scratch_t                  *scratch;        /* Per-sync temporaries, reset after each request. */
     kaatcp_parser_t                *parser;
+    kaa_server_sync_stream_t       sync_stream;     /* KAASYNC messages too large for the parser */
     uint16_t                       message_id;
     kaa_tcp_keepalive_t            keepalive;
+    uint64_t                       deadlines[KAA_TCP_DEADLINE_COUNT];   /* KAA_TIME_MS(), by kaa_tcp_deadline_t */
     kaa_tcp_encrypt_t              encryption;
 } kaa_tcp_channel_t;
 
@@ -129,6 +148,9 @@ static kaa_error_t kaa_tcp_channel_set_access_point(void *context, kaa_access_po
 static void kaa_tcp_channel_connack_message_callback(void *context, kaatcp_connack_t message);
 static void kaa_tcp_channel_disconnect_message_callback(void *context, kaatcp_disconnect_t message);
 static void kaa_tcp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *message);
+static void kaa_tcp_channel_kaasync_chunk_callback(void *context, const kaatcp_kaasync_header_t *header
+                                                 , char *chunk, size_t chunk_size
+                                                 , size_t offset, size_t total_size);
 static void kaa_tcp_channel_pingresp_message_callback(void *context);
 
 /*
@@ -137,33 +159,66 @@ static void kaa_tcp_channel_pingresp_message_callback(void *context);
 static kaa_error_t kaa_tcp_channel_socket_io_error(kaa_tcp_channel_t *self, kaa_failover_reason reason_code);
 static kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self);
 static bool is_service_pending(kaa_tcp_channel_t *self, const kaa_extension_id service);
-static kaa_error_t kaa_tcp_channel_delete_pending_services(kaa_tcp_channel_t *self, const kaa_extension_id services[], size_t service_count);
+static void kaa_tcp_channel_delete_pending_services(kaa_tcp_channel_t *self, const kaa_extension_id services[], size_t service_count);
 static kaa_error_t kaa_tcp_channel_update_pending_services(kaa_tcp_channel_t *self, const kaa_extension_id services[], size_t service_count);
+static size_t kaa_tcp_channel_get_pending_services(kaa_tcp_channel_t *self, kaa_extension_id services[KAA_EXTENSION_ID_COUNT]);
 static kaa_error_t kaa_tcp_channel_set_access_point_hostname_resolved(void *context, const kaa_sockaddr_t *addr, kaa_socklen_t addr_size);
 static kaa_error_t kaa_tcp_channel_set_access_point_hostname_resolve_failed(void *context);
 static inline uint32_t get_uint32_t(const uint8_t *buffer);
 static kaa_error_t kaa_tcp_channel_connect_access_point(kaa_tcp_channel_t *self);
 static kaa_error_t kaa_tcp_channel_release_access_point(kaa_tcp_channel_t *self);
-static kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self, kaa_extension_id *service, size_t services_count);
+static kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self);
 static kaa_error_t kaa_tcp_write_buffer(kaa_tcp_channel_t *self);
+static kaa_error_t kaa_tcp_write_kaasync_message(kaa_tcp_channel_t *self, const kaatcp_kaasync_t *message,
+        const kaa_platform_message_splices_t *splices);
+static kaa_error_t kaa_tcp_queue_bytes(kaa_tcp_channel_t *self, const char *bytes, size_t size);
 static kaa_error_t kaa_tcp_channel_ping(kaa_tcp_channel_t *self);
 static kaa_error_t kaa_tcp_channel_disconnect_internal(kaa_tcp_channel_t *self, kaatcp_disconnect_reason_t return_code);
 
-/*
- * Create TCP channel object
- */
-kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
-        kaa_logger_t *logger, kaa_extension_id *supported_services,
-        size_t supported_service_count)
+static void kaa_tcp_channel_set_deadline(kaa_tcp_channel_t *self, kaa_tcp_deadline_t deadline, uint32_t delay_ms)
 {
-    KAA_RETURN_IF_NIL4(self, logger, supported_services, supported_service_count, KAA_ERR_BADPARAM);
+    self->deadlines[deadline] = KAA_TIME_MS() + delay_ms;
+}
 
-    KAA_LOG_TRACE(logger, KAA_ERR_NONE, "Kaa TCP channel creating....");
+static void kaa_tcp_channel_clear_deadline(kaa_tcp_channel_t *self, kaa_tcp_deadline_t deadline)
+{
+    self->deadlines[deadline] = KAA_TCP_DEADLINE_NONE;
+}
 
-    kaa_error_t error_code = KAA_ERR_NONE;
+static void kaa_tcp_channel_clear_deadlines(kaa_tcp_channel_t *self)
+{
+    for (size_t i = 0; i < KAA_TCP_DEADLINE_COUNT; ++i) {
+        self->deadlines[i] = KAA_TCP_DEADLINE_NONE;
+    }
+}
+
+/* A deadline only counts in the channel state it was set for. */
+static bool kaa_tcp_channel_is_deadline_active(kaa_tcp_channel_t *self, kaa_tcp_deadline_t deadline)
+{
+    switch (deadline) {
+    case KAA_TCP_DEADLINE_RESOLVE:
+        return self->access_point.state == AP_IN_PROGRESS;
+    case KAA_TCP_DEADLINE_AUTHORIZE:
+        return self->channel_state == KAA_TCP_CHANNEL_AUTHORIZING;
+    case KAA_TCP_DEADLINE_PING:
+        return self->channel_state == KAA_TCP_CHANNEL_AUTHORIZED;
+    default:
+        return false;
+    }
+}
+
+static bool kaa_tcp_channel_is_deadline_expired(kaa_tcp_channel_t *self, kaa_tcp_deadline_t deadline, uint64_t now)
+{
+    return kaa_tcp_channel_is_deadline_active(self, deadline) && now >= self->deadlines[deadline];
+}
 
-    //Check supported services, as Bootstrap channel we accept only one service which is bootstrap.
-    //From other hand bootstrap can't be as service in operations service.
+/*
+ * Check supported services, as Bootstrap channel we accept only one service which is bootstrap.
+ * From other hand bootstrap can't be as service in operations service.
+ */
+static kaa_error_t kaa_tcp_channel_get_operation_type(kaa_logger_t *logger, const kaa_extension_id *supported_services,
+        size_t supported_service_count, kaa_server_type_t *operation_type)
+{
     bool bootstrap_found = false;
 
     for (size_t i = 0; i < supported_service_count; i++) {
@@ -177,9 +232,29 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
         //unsupported configuration
         KAA_LOG_ERROR(logger,KAA_ERR_BADPARAM,"Kaa TCP channel creating, error unsupported configuration,  "
                 "supports: one Bootstrap service or all other in any combination");
-        KAA_RETURN_IF_ERR(KAA_ERR_BADPARAM);
+        return KAA_ERR_BADPARAM;
     }
 
+    *operation_type = bootstrap_found ? KAA_SERVER_BOOTSTRAP : KAA_SERVER_OPERATIONS;
+    return KAA_ERR_NONE;
+}
+
+/*
+ * Create TCP channel object
+ */
+kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
+        kaa_logger_t *logger, kaa_extension_id *supported_services,
+        size_t supported_service_count)
+{
+    KAA_RETURN_IF_NIL4(self, logger, supported_services, supported_service_count, KAA_ERR_BADPARAM);
+
+    KAA_LOG_TRACE(logger, KAA_ERR_NONE, "Kaa TCP channel creating....");
+
+    kaa_server_type_t operation_type;
+    kaa_error_t error_code = kaa_tcp_channel_get_operation_type(logger, supported_services,
+            supported_service_count, &operation_type);
+    KAA_RETURN_IF_ERR(error_code);
+
     kaa_tcp_channel_t *kaa_tcp_channel = (kaa_tcp_channel_t *) KAA_CALLOC(1, sizeof(kaa_tcp_channel_t));
     KAA_RETURN_IF_NIL(kaa_tcp_channel, KAA_ERR_NOMEM);
 
@@ -206,10 +281,7 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
     /*
      * Define type of channel (bootstrap or operations)
      */
-    kaa_tcp_channel->channel_operation_type = KAA_SERVER_OPERATIONS;
-    if (bootstrap_found) {
-        kaa_tcp_channel->channel_operation_type = KAA_SERVER_BOOTSTRAP;
-    }
+    kaa_tcp_channel->channel_operation_type = operation_type;
 
     /*
      * Creates read/write buffers.
@@ -228,12 +300,19 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
         kaa_tcp_channel_destroy_context(kaa_tcp_channel);
         return error_code;
     }
+    error_code = kaa_scratch_create(&kaa_tcp_channel->scratch, KAA_TCP_CHANNEL_SCRATCH_SIZE);
+    if (error_code) {
+        KAA_LOG_ERROR(logger, error_code, "Failed to create scratch arena for channel");
+        kaa_tcp_channel_destroy_context(kaa_tcp_channel);
+        return error_code;
+    }
 
     /*
      * Initializes keepalive configuration.
      */
-    kaa_tcp_channel->keepalive.last_sent_keepalive = KAA_TIME();
+    kaa_tcp_channel->keepalive.last_sent_keepalive = KAA_TIME_MS();
     kaa_tcp_channel->keepalive.last_receive_keepalive = kaa_tcp_channel->keepalive.last_sent_keepalive;
+    kaa_tcp_channel_clear_deadlines(kaa_tcp_channel);
 
     KAA_LOG_TRACE(logger, KAA_ERR_NONE, "Kaa TCP channel keepalive is %u",
             KAA_TCP_CHANNEL_MAX_TIMEOUT);
@@ -253,11 +332,13 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
     kaa_tcp_channel->parser = KAA_MALLOC(sizeof(kaatcp_parser_t));
 
     if (kaa_tcp_channel->parser) {
-        kaa_tcp_channel->parser->payload_buffer_size = KAATCP_PARSER_MAX_MESSAGE_LENGTH;
-        kaa_tcp_channel->parser->payload = KAA_MALLOC(kaa_tcp_channel->parser->payload_buffer_size);
+        /* Only frames split across reads are copied, so the payload buffer
+         * is allocated on demand by the parser. */
+        kaa_tcp_channel->parser->payload_buffer_size = 0;
+        kaa_tcp_channel->parser->payload = NULL;
     }
 
-    if (!kaa_tcp_channel->parser || !kaa_tcp_channel->parser->payload) {
+    if (!kaa_tcp_channel->parser) {
         KAA_LOG_ERROR(logger, KAA_ERR_NOMEM, "Failed to create Kaa TCP parser");
         kaa_tcp_channel_destroy_context(kaa_tcp_channel);
         return KAA_ERR_NOMEM;
@@ -269,6 +350,7 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
     parser_handler.disconnect_handler = kaa_tcp_channel_disconnect_message_callback;
     parser_handler.kaasync_handler    = kaa_tcp_channel_kaasync_message_callback;
     parser_handler.pingresp_handler   = kaa_tcp_channel_pingresp_message_callback;
+    parser_handler.kaasync_chunk_handler = kaa_tcp_channel_kaasync_chunk_callback;
     parser_handler.handlers_context   = kaa_tcp_channel;
 
     kaatcp_error_t parser_error_code = kaatcp_parser_init(kaa_tcp_channel->parser, &parser_handler);
@@ -277,6 +359,8 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
         kaa_tcp_channel_destroy_context(kaa_tcp_channel);
         return KAA_ERR_TCPCHANNEL_PARSER_INIT_FAILED;
     }
+    kaa_tcp_channel->parser->max_message_length = KAATCP_PARSER_MAX_MESSAGE_LENGTH;
+    kaa_platform_protocol_server_sync_stream_init(&kaa_tcp_channel->sync_stream);
 
     /*
      * Initializes a transport channel interface.
@@ -296,6 +380,69 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self,
 
 
 
+/*
+ * Reuse TCP channel object for other services
+ */
+kaa_error_t kaa_tcp_channel_set_supported_services(kaa_transport_channel_interface_t *self,
+        kaa_extension_id *supported_services, size_t supported_service_count)
+{
+    KAA_RETURN_IF_NIL4(self, self->context, supported_services, supported_service_count, KAA_ERR_BADPARAM);
+
+    kaa_tcp_channel_t *channel = (kaa_tcp_channel_t *) self->context;
+
+    kaa_server_type_t operation_type;
+    kaa_error_t error_code = kaa_tcp_channel_get_operation_type(channel->logger, supported_services,
+            supported_service_count, &operation_type);
+    KAA_RETURN_IF_ERR(error_code);
+
+    KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] switching to %zu %s services",
+            channel->access_point.id, supported_service_count,
+            operation_type == KAA_SERVER_BOOTSTRAP ? "Bootstrap" : "Operations");
+
+    /* The array only grows, so switching back and forth allocates it at most once */
+    if (supported_service_count > channel->supported_service_count) {
+        kaa_extension_id *services = KAA_MALLOC(supported_service_count * sizeof(kaa_extension_id));
+        if (!services) {
+            KAA_LOG_ERROR(channel->logger, KAA_ERR_NOMEM, "Failed to copy supported services");
+            return KAA_ERR_NOMEM;
+        }
+        KAA_FREE(channel->supported_services);
+        channel->supported_services = services;
+    }
+
+    memcpy(channel->supported_services, supported_services, sizeof(kaa_extension_id) * supported_service_count);
+    channel->supported_service_count = supported_service_count;
+    channel->channel_operation_type = operation_type;
+
+    kaa_tcp_channel_release_access_point(channel);
+
+    channel->channel_state = KAA_TCP_CHANNEL_UNDEFINED;
+    channel->sync_state = KAA_TCP_CHANNEL_SYNC_OP_UNDEFINED;
+    channel->message_id = 0;
+
+    channel->pending_services = 0;
+
+    kaa_buffer_reset(channel->in_buffer);
+    kaa_buffer_reset(channel->out_buffer);
+    kaa_scratch_reset(channel->scratch);
+    kaatcp_parser_reset(channel->parser);
+    KAA_FREE(channel->sync_stream.extension);
+    kaa_platform_protocol_server_sync_stream_init(&channel->sync_stream);
+
+    channel->encryption.aes_session_key = NULL;
+    channel->encryption.aes_session_key_size = 0;
+    channel->encryption.signature = NULL;
+    channel->encryption.signature_size = 0;
+
+    channel->keepalive.last_sent_keepalive = KAA_TIME_MS();
+    channel->keepalive.last_receive_keepalive = channel->keepalive.last_sent_keepalive;
+    kaa_tcp_channel_clear_deadlines(channel);
+
+    return KAA_ERR_NONE;
+}
+
+
+
 static kaa_error_t kaa_tcp_channel_on_access_point_failed(kaa_tcp_channel_t *self, kaa_failover_reason reason_code)
 {
     kaa_error_t error_code = kaa_bootstrap_manager_on_access_point_failed(self->transport_context.kaa_context->bootstrap_manager,
@@ -358,7 +505,7 @@ kaa_error_t kaa_tcp_channel_sync_handler(void *context, const kaa_extension_id s
 
     //If channel pending sync only bootstrap, at sync it should initiate new connection if access point resolved
     if (((kaa_tcp_channel_t *) context)->access_point.state == AP_RESOLVED
-            && ((kaa_tcp_channel_t *) context)->pending_request_service_count > 0
+            && ((kaa_tcp_channel_t *) context)->pending_services
             && ((kaa_tcp_channel_t *) context)->channel_state == KAA_TCP_CHANNEL_UNDEFINED) {
         KAA_LOG_INFO(((kaa_tcp_channel_t *) context)->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] connection down but access point resolved, trying to connect....",
                 ((kaa_tcp_channel_t *) context)->access_point.id);
@@ -394,14 +541,13 @@ kaa_error_t kaa_tcp_channel_destroy_context(void *context)
         KAA_FREE(channel->parser);
         channel->parser = NULL;
     }
+    KAA_FREE(channel->sync_stream.extension);
 
     kaa_tcp_channel_release_access_point(channel);
 
     kaa_buffer_destroy(channel->in_buffer);
     kaa_buffer_destroy(channel->out_buffer);
-
-    KAA_FREE(channel->pending_request_services);
-    channel->pending_request_services = NULL;
+    kaa_scratch_destroy(channel->scratch);
 
     KAA_FREE(channel->supported_services);
     channel->supported_services = NULL;
@@ -616,7 +762,7 @@ bool kaa_tcp_channel_is_ready(kaa_transport_channel_interface_t *self,
                 return true;
             } else  if (tcp_channel->access_point.state == AP_CONNECTED) {
                 //If there are some pending sync services put W into fd_set
-                if (tcp_channel->pending_request_service_count > 0) {
+                if (tcp_channel->pending_services) {
                     if (is_service_pending(tcp_channel, KAA_EXTENSION_BOOTSTRAP)
                             || tcp_channel->channel_state == KAA_TCP_CHANNEL_AUTHORIZED) {
                         return true;
@@ -685,26 +831,32 @@ kaa_error_t kaa_tcp_channel_process_event(kaa_transport_channel_interface_t *sel
                             }
                             KAA_RETURN_IF_ERR(error_code);
 
-                            error_code = kaa_buffer_get_unprocessed_space(tcp_channel->in_buffer, &buf, &buf_size);
-                            if (error_code) {
-                                KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] error get unprocessed %zu bytes"
-                                        , tcp_channel->access_point.id, bytes_read);
-                            }
-                            KAA_RETURN_IF_ERR(error_code);
-                            //TODO Modify parser errors code
-                            kaatcp_error_t kaatcp_error_code = kaatcp_parser_process_buffer(tcp_channel->parser, buf, buf_size);
-                            if (kaatcp_error_code) {
-                                error_code = KAA_ERR_TCPCHANNEL_PARSER_ERROR;
-                                KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] failed to parse the buffer (kaatcp_error_code=%d)"
-                                        , tcp_channel->access_point.id, kaatcp_error_code);
-                                kaa_tcp_channel_socket_io_error(tcp_channel, KAA_CHANNEL_NA);
-                            } else {
-                                //Need to check AP state to avoid free space on closed connection.
-                                if (tcp_channel->access_point.state == AP_CONNECTED) {
-                                    error_code = kaa_buffer_free_allocated_space(tcp_channel->in_buffer, buf_size);
-                                    if (error_code) {
-                                        KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] error free allocated buffer %zu bytes"
-                                                , tcp_channel->access_point.id, buf_size);
+                            //The unprocessed bytes may wrap around the end of the buffer, so parse them span by span.
+                            while (!error_code && tcp_channel->access_point.state == AP_CONNECTED) {
+                                error_code = kaa_buffer_get_unprocessed_space(tcp_channel->in_buffer, &buf, &buf_size);
+                                if (error_code) {
+                                    KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] error get unprocessed %zu bytes"
+                                            , tcp_channel->access_point.id, bytes_read);
+                                }
+                                KAA_RETURN_IF_ERR(error_code);
+                                if (!buf_size) {
+                                    break;
+                                }
+                                //TODO Modify parser errors code
+                                kaatcp_error_t kaatcp_error_code = kaatcp_parser_process_buffer(tcp_channel->parser, buf, buf_size);
+                                if (kaatcp_error_code) {
+                                    error_code = KAA_ERR_TCPCHANNEL_PARSER_ERROR;
+                                    KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] failed to parse the buffer (kaatcp_error_code=%d)"
+                                            , tcp_channel->access_point.id, kaatcp_error_code);
+                                    kaa_tcp_channel_socket_io_error(tcp_channel, KAA_CHANNEL_NA);
+                                } else {
+                                    //Need to check AP state to avoid free space on closed connection.
+                                    if (tcp_channel->access_point.state == AP_CONNECTED) {
+                                        error_code = kaa_buffer_free_allocated_space(tcp_channel->in_buffer, buf_size);
+                                        if (error_code) {
+                                            KAA_LOG_ERROR(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] error free allocated buffer %zu bytes"
+                                                    , tcp_channel->access_point.id, buf_size);
+                                        }
                                     }
                                 }
                             }
@@ -768,7 +920,7 @@ kaa_error_t kaa_tcp_channel_process_event(kaa_transport_channel_interface_t *sel
                         KAA_LOG_TRACE(tcp_channel->logger, error_code, "Kaa TCP channel [0x%08X] can't disconnect right now (%d bytes are unprocessed)"
                                 , tcp_channel->access_point.id, buf_size);
                     }
-                } else if (tcp_channel->pending_request_service_count > 0) {
+                } else if (tcp_channel->pending_services) {
                     if (tcp_channel->channel_operation_type == KAA_SERVER_BOOTSTRAP) {
                         KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] going to sync Bootstrap service"
                                 , tcp_channel->access_point.id);
@@ -776,12 +928,10 @@ kaa_error_t kaa_tcp_channel_process_event(kaa_transport_channel_interface_t *sel
                     } else if (tcp_channel->channel_state == KAA_TCP_CHANNEL_AUTHORIZED) {
                         KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] going to sync all services"
                                 , tcp_channel->access_point.id);
-                        error_code = kaa_tcp_channel_write_pending_services(tcp_channel
-                                , tcp_channel->pending_request_services
-                                , tcp_channel->pending_request_service_count);
+                        error_code = kaa_tcp_channel_write_pending_services(tcp_channel);
                     } else if (tcp_channel->channel_state == KAA_TCP_CHANNEL_AUTHORIZING) {
-                        KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel is authorizing (%zu pending requests)"
-                                , tcp_channel->pending_request_service_count);
+                        KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel is authorizing (pending services 0x%08X)"
+                                , tcp_channel->pending_services);
                     } else {
                         KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] authorizing channel"
                                 , tcp_channel->access_point.id);
@@ -809,10 +959,35 @@ kaa_error_t kaa_tcp_channel_process_event(kaa_transport_channel_interface_t *sel
 kaa_error_t kaa_tcp_channel_get_max_timeout(kaa_transport_channel_interface_t *self,
         uint16_t *max_timeout)
 {
-    KAA_RETURN_IF_NIL3(self, self->context, max_timeout, KAA_ERR_BADPARAM);
+    KAA_RETURN_IF_NIL(max_timeout, KAA_ERR_BADPARAM);
+
+    uint32_t max_timeout_ms = 0;
+    kaa_error_t error_code = kaa_tcp_channel_get_max_timeout_ms(self, &max_timeout_ms);
+    KAA_RETURN_IF_ERR(error_code);
+
+    // Rounded up, no less than a second as the platforms polling in seconds expect
+    uint32_t seconds = (max_timeout_ms + 999) / 1000;
+    *max_timeout = seconds ? (uint16_t)seconds : 1;
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_tcp_channel_get_max_timeout_ms(kaa_transport_channel_interface_t *self,
+        uint32_t *max_timeout_ms)
+{
+    KAA_RETURN_IF_NIL3(self, self->context, max_timeout_ms, KAA_ERR_BADPARAM);
 
-    *max_timeout = KAA_TCP_CHANNEL_PING_TIMEOUT;
+    kaa_tcp_channel_t *tcp_channel = (kaa_tcp_channel_t *) self->context;
 
+    uint64_t now = KAA_TIME_MS();
+    uint64_t deadline = now + KAA_TCP_CHANNEL_PING_TIMEOUT * 1000;
+    for (size_t i = 0; i < KAA_TCP_DEADLINE_COUNT; ++i) {
+        if (kaa_tcp_channel_is_deadline_active(tcp_channel, (kaa_tcp_deadline_t)i)
+                && tcp_channel->deadlines[i] < deadline) {
+            deadline = tcp_channel->deadlines[i];
+        }
+    }
+
+    *max_timeout_ms = (deadline > now) ? (uint32_t)(deadline - now) : 0;
     return KAA_ERR_NONE;
 }
 
@@ -823,7 +998,7 @@ kaa_error_t kaa_tcp_channel_check_keepalive(kaa_transport_channel_interface_t *s
     kaa_error_t error_code = KAA_ERR_NONE;
     kaa_tcp_channel_t *tcp_channel = (kaa_tcp_channel_t *) self->context;
 
-    if (tcp_channel->access_point.state == AP_SET) {
+    if (tcp_channel->access_point.state == AP_SET || tcp_channel->access_point.state == AP_IN_PROGRESS) {
         kaa_dns_resolve_listener_t resolve_listener;
         resolve_listener.context = (void *) tcp_channel;
         resolve_listener.on_host_resolved = kaa_tcp_channel_set_access_point_hostname_resolved;
@@ -843,9 +1018,12 @@ kaa_error_t kaa_tcp_channel_check_keepalive(kaa_transport_channel_interface_t *s
 
         switch (resolve_state) {
             case RET_STATE_VALUE_IN_PROGRESS:
-                KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel new access point [0x%08X] destination name resolve pending...",
-                        tcp_channel->access_point.id);
+                if (tcp_channel->access_point.state == AP_SET) {
+                    KAA_LOG_TRACE(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel new access point [0x%08X] destination name resolve pending...",
+                            tcp_channel->access_point.id);
+                }
                 tcp_channel->access_point.state = AP_IN_PROGRESS;
+                kaa_tcp_channel_set_deadline(tcp_channel, KAA_TCP_DEADLINE_RESOLVE, KAA_TCP_CHANNEL_RESOLVE_POLL_MS);
                 break;
             case RET_STATE_VALUE_READY:
                 tcp_channel->access_point.state = AP_RESOLVED;
@@ -881,13 +1059,20 @@ kaa_error_t kaa_tcp_channel_check_keepalive(kaa_transport_channel_interface_t *s
         KAA_LOG_TRACE_LDB(tcp_channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] checking keepalive",
                 tcp_channel->access_point.id);
 
-        if (tcp_channel->channel_state != KAA_TCP_CHANNEL_AUTHORIZED) {
-            return error_code;
+        uint64_t now = KAA_TIME_MS();
+
+        if (kaa_tcp_channel_is_deadline_expired(tcp_channel, KAA_TCP_DEADLINE_AUTHORIZE, now)) {
+            KAA_LOG_WARN(tcp_channel->logger, KAA_ERR_TIMEOUT, "Kaa TCP channel [0x%08X] CONNACK timed out",
+                    tcp_channel->access_point.id);
+            kaa_tcp_channel_clear_deadline(tcp_channel, KAA_TCP_DEADLINE_AUTHORIZE);
+            error_code = kaa_bootstrap_manager_on_access_point_failed(tcp_channel->transport_context.kaa_context->bootstrap_manager,
+                    &tcp_channel->protocol_id, tcp_channel->channel_operation_type,
+                    (tcp_channel->channel_operation_type == KAA_SERVER_BOOTSTRAP)
+                            ? KAA_BOOTSTRAP_SERVERS_NA : KAA_OPERATION_SERVERS_NA);
+            return error_code ? error_code : KAA_ERR_TIMEOUT;
         }
 
-        kaa_time_t interval = KAA_TIME() - tcp_channel->keepalive.last_sent_keepalive;
-
-        if (interval >= (kaa_time_t)KAA_TCP_CHANNEL_PING_TIMEOUT) {
+        if (kaa_tcp_channel_is_deadline_expired(tcp_channel, KAA_TCP_DEADLINE_PING, now)) {
             //Send ping request
 
             if (tcp_channel->keepalive.last_sent_keepalive > tcp_channel->keepalive.last_receive_keepalive) {
@@ -956,9 +1141,11 @@ void kaa_tcp_channel_connack_message_callback(void *context, kaatcp_connack_t me
                     "Kaa TCP channel [0x%08X] successfully authorized",
                     channel->access_point.id);
 
-            channel->keepalive.last_receive_keepalive = KAA_TIME();
+            channel->keepalive.last_receive_keepalive = KAA_TIME_MS();
             channel->keepalive.last_sent_keepalive
                 = channel->keepalive.last_receive_keepalive;
+            kaa_tcp_channel_clear_deadline(channel, KAA_TCP_DEADLINE_AUTHORIZE);
+            kaa_tcp_channel_set_deadline(channel, KAA_TCP_DEADLINE_PING, KAA_TCP_CHANNEL_PING_TIMEOUT * 1000);
 
         } else if (message.return_code == KAATCP_CONNACK_REFUSE_BAD_CREDENTIALS) {
             kaa_context_set_status_registered(channel->transport_context.kaa_context, false);
@@ -1009,6 +1196,15 @@ void kaa_tcp_channel_disconnect_message_callback(void *context, kaatcp_disconnec
 
 
 
+static void kaa_tcp_channel_server_sync_processed(kaa_tcp_channel_t *channel)
+{
+    //Check if service supports only bootstrap, after sync it disconnects.
+    if (channel->channel_operation_type == KAA_SERVER_BOOTSTRAP) {
+        channel->sync_state = KAA_TCP_CHANNEL_SYNC_OP_FINISHED;
+        kaa_tcp_channel_disconnect_internal(channel, KAATCP_DISCONNECT_NONE);
+    }
+}
+
 void kaa_tcp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *message)
 {
     KAA_RETURN_IF_NIL2(context, message, );
@@ -1042,10 +1238,41 @@ void kaa_tcp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *m
 
     kaatcp_parser_kaasync_destroy(message);
 
-    //Check if service supports only bootstrap, after sync it disconnects.
-    if (channel->channel_operation_type == KAA_SERVER_BOOTSTRAP) {
-        channel->sync_state = KAA_TCP_CHANNEL_SYNC_OP_FINISHED;
-        kaa_tcp_channel_disconnect_internal(channel, KAATCP_DISCONNECT_NONE);
+    kaa_tcp_channel_server_sync_processed(channel);
+}
+
+void kaa_tcp_channel_kaasync_chunk_callback(void *context, const kaatcp_kaasync_header_t *header
+                                          , char *chunk, size_t chunk_size
+                                          , size_t offset, size_t total_size)
+{
+    KAA_RETURN_IF_NIL2(context, header, );
+    kaa_tcp_channel_t *channel = (kaa_tcp_channel_t *) context;
+    kaa_platform_protocol_t *protocol = channel->transport_context.kaa_context->platform_protocol;
+
+    if (!offset) {
+        KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] KAASYNC message of %zu bytes received, processing it in chunks",
+                channel->access_point.id, total_size);
+
+        KAA_FREE(channel->sync_stream.extension);
+        kaa_platform_protocol_server_sync_stream_init(&channel->sync_stream);
+
+        /* Decryption needs the whole message */
+        if (header->flags & (KAA_SYNC_ZIPPED_BIT | KAA_SYNC_ENCRYPTED_BIT)) {
+            KAA_LOG_WARN(channel->logger, KAA_ERR_UNSUPPORTED, "Kaa TCP channel [0x%08X] can't process zipped or encrypted message in chunks (flags 0x%02X)",
+                    channel->access_point.id, header->flags);
+            channel->sync_stream.error = KAA_ERR_UNSUPPORTED;
+        }
+    }
+
+    kaa_platform_protocol_stream_server_sync(protocol, &channel->sync_stream, (const uint8_t *)chunk, chunk_size);
+
+    if (offset + chunk_size == total_size) {
+        kaa_error_t error_code = kaa_platform_protocol_finish_server_sync(protocol, &channel->sync_stream);
+        if (error_code)
+            KAA_LOG_ERROR(channel->logger, error_code, "Kaa TCP channel [0x%08X] failed to process server sync",
+                    channel->access_point.id);
+
+        kaa_tcp_channel_server_sync_processed(channel);
     }
 }
 
@@ -1056,7 +1283,7 @@ void kaa_tcp_channel_pingresp_message_callback(void *context)
     KAA_RETURN_IF_NIL(context,);
     kaa_tcp_channel_t *channel = (kaa_tcp_channel_t *)context;
 
-    channel->keepalive.last_receive_keepalive = KAA_TIME();
+    channel->keepalive.last_receive_keepalive = KAA_TIME_MS();
 
     KAA_LOG_INFO(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] PING message received",
             channel->access_point.id);
@@ -1105,6 +1332,8 @@ kaa_error_t kaa_tcp_channel_socket_io_error(kaa_tcp_channel_t *self, kaa_failove
 
 
     kaatcp_parser_reset(self->parser);
+    KAA_FREE(self->sync_stream.extension);
+    kaa_platform_protocol_server_sync_stream_init(&self->sync_stream);
 
     self->sync_state = KAA_TCP_CHANNEL_SYNC_OP_UNDEFINED;
 
@@ -1112,30 +1341,20 @@ kaa_error_t kaa_tcp_channel_socket_io_error(kaa_tcp_channel_t *self, kaa_failove
 }
 
 #ifdef KAA_ENCRYPTION
-static kaa_error_t kaa_tcp_channel_encrypt(kaa_tcp_channel_t *self, uint8_t **data, size_t *data_size)
+static kaa_error_t kaa_tcp_channel_encrypt(kaa_tcp_channel_t *self, uint8_t *data, size_t *data_size)
 {
     if (!data || !data_size) {
         return KAA_ERR_BADPARAM;
     }
 
-    size_t encrypted_size = ext_get_encrypted_data_size(*data_size);
-
-    char *enc_buff = KAA_MALLOC(encrypted_size);
-    if (!enc_buff) {
-        return KAA_ERR_NOMEM;
-    }
-
-    memcpy(enc_buff, *data, *data_size);
-    kaa_error_t error_code = ext_encrypt_data((uint8_t *)enc_buff, *data_size, (uint8_t *)enc_buff);
+    /* The client sync buffer has room for the padding */
+    kaa_error_t error_code = ext_encrypt_data(data, *data_size, data);
     if (error_code) {
         KAA_LOG_ERROR(self->logger, error_code, "Can't encrypt the data");
-        KAA_FREE(enc_buff);
         return KAA_ERR_BADDATA;
     }
-    KAA_FREE(*data);
 
-    *data = (uint8_t *)enc_buff;
-    *data_size = encrypted_size;
+    *data_size = ext_get_encrypted_data_size(*data_size);
     return KAA_ERR_NONE;
 }
 #endif
@@ -1156,25 +1375,26 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     uint8_t *sync_buffer = NULL;
     size_t sync_size = 0;
 
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Calling kaa_platform_protocol_alloc_serialize_client_sync");
-    kaa_error_t error_code = kaa_platform_protocol_alloc_serialize_client_sync(
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Calling kaa_platform_protocol_scratch_serialize_client_sync");
+    kaa_error_t error_code = kaa_platform_protocol_scratch_serialize_client_sync(
             self->transport_context.kaa_context->platform_protocol,
+            self->scratch,
             self->supported_services,
             self->supported_service_count,
             &sync_buffer,
-            &sync_size);
+            &sync_size,
+            NULL);
 
     if (error_code) {
         KAA_LOG_ERROR(self->logger, error_code, "Failed to allocate and serialize client sync");
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return error_code;
     }
 
 #ifdef KAA_ENCRYPTION
-    /* TODO(KAA-1246): Rework the solution to cipher without additional allocations */
-    error_code = kaa_tcp_channel_encrypt(self, (uint8_t **)&sync_buffer, &sync_size);
+    error_code = kaa_tcp_channel_encrypt(self, sync_buffer, &sync_size);
     if (error_code) {
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return error_code;
     }
 #endif
@@ -1182,23 +1402,8 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     KAA_LOG_TRACE(self->logger, error_code, "Kaa TCP channel [0x%08X] going to send CONNECT message (%zu bytes)",
             self->access_point.id, sync_size);
 
-    kaa_error_t delete_error_code = kaa_tcp_channel_delete_pending_services(self, self->pending_request_services,
-            self->pending_request_service_count);
-    if (delete_error_code) {
-        KAA_LOG_ERROR(self->logger, delete_error_code, "Kaa TCP channel [0x%08X] failed to delete pending services",
-                self->access_point.id);
-    }
-
-    if (error_code) {
-        KAA_LOG_ERROR(self->logger, error_code, "Kaa TCP channel [0x%08X] failed to serialize supported services",
-                self->access_point.id);
-    }
-
-    if (error_code || delete_error_code) {
-        KAA_FREE(sync_buffer);
-
-        return error_code ? error_code : delete_error_code;
-    }
+    // CONNECT carries all supported services, so nothing is left pending
+    self->pending_services = 0;
 
 
     kaatcp_connect_t connect_message;
@@ -1211,7 +1416,7 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     if (kaatcp_error_code) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to fill CONNECT message",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
     }
 
@@ -1227,7 +1432,7 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     }
 
     if (error_code) {
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return KAA_ERR_NOMEM;
     }
 
@@ -1236,7 +1441,7 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     if (kaatcp_error_code) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to get serialize CONNECT message",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
 
         return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
     }
@@ -1246,13 +1451,14 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
 
     error_code = kaa_buffer_lock_space(self->out_buffer, buffer_size);
 
-    KAA_FREE(sync_buffer);
+    kaa_scratch_reset(self->scratch);
 
     if (error_code) {
         return error_code;
     }
 
     self->channel_state = KAA_TCP_CHANNEL_AUTHORIZING;
+    kaa_tcp_channel_set_deadline(self, KAA_TCP_DEADLINE_AUTHORIZE, KAA_TCP_CHANNEL_MAX_TIMEOUT * 1000);
 
     self->sync_state = KAA_TCP_CHANNEL_SYNC_OP_STARTED;
 
@@ -1266,150 +1472,65 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
  */
 bool is_service_pending(kaa_tcp_channel_t *self, const kaa_extension_id service)
 {
-    KAA_RETURN_IF_NIL2(self, self->pending_request_services, false);
-
-    size_t i = 0;
-    for (; i < self->pending_request_service_count; ++i) {
-        if (self->pending_request_services[i] == service) {
-            return true;
-        }
-    }
-    return false;
+    KAA_RETURN_IF_NIL(self, false);
+    return (self->pending_services & ((uint32_t)1 << service)) != 0;
 }
 
 
-/* Appends destination array with only new members from source array.
- * Capacity is a maximum amount of items that can be stored in the destination
- * array. Destination count is a current amount of items in destination array.
- *
- * Returns new array count.
- */
-static size_t append_with_new_services(kaa_extension_id *dest,
-        size_t dest_count,
-        size_t dest_capacity,
-        const kaa_extension_id *src,
-        size_t src_count)
-{
-    KAA_RETURN_IF_NIL2(dest, src, 0);
-
-    for (size_t i = 0; i < src_count; ++i) {
-        bool found = false;
-        for (size_t j = 0; j < dest_count; ++j) {
-            if (src[i] == dest[j]) {
-                found = true;
-                break;
-            }
-        }
-
-        /* Only add new services that doesn't yet exist in destination array */
-        if (!found) {
-            dest[dest_count++] = src[i];
-        }
-
-        /* No more empty space in array */
-        if (dest_count == dest_capacity) {
-            break;
-        }
-    }
-
-    return dest_count;
-}
 
 /*
  * Delete specified services from pending list.
  */
-kaa_error_t kaa_tcp_channel_delete_pending_services(kaa_tcp_channel_t *self,
+void kaa_tcp_channel_delete_pending_services(kaa_tcp_channel_t *self,
         const kaa_extension_id services[], size_t service_count)
 {
-    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
-
-    // These cases are normal.
-    if (!self->pending_request_services || !self->pending_request_service_count || !services || !service_count) {
-        return KAA_ERR_NONE;
-    }
-
-    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] %zu pending services, going to delete %zu services",
-            self->access_point.id, self->pending_request_service_count, service_count);
+    KAA_RETURN_IF_NIL2(self, services, );
 
-    //Check if services to delete point to himself
-    if (services == self->pending_request_services) {
-        //Remove all
-        KAA_FREE(self->pending_request_services); //free previous pending services array.
-        self->pending_request_services = NULL;
-        self->pending_request_service_count = 0;
-        return KAA_ERR_NONE;
+    for (size_t i = 0; i < service_count; ++i) {
+        self->pending_services &= ~((uint32_t)1 << services[i]);
     }
-
-    size_t new_service_count = 0;
-    kaa_extension_id temp_new_services[self->pending_request_service_count];
-
-    new_service_count = append_with_new_services(temp_new_services,
-            new_service_count,
-            self->pending_request_service_count,
-            self->pending_request_services,
-            self->pending_request_service_count);
-
-    KAA_FREE(self->pending_request_services); //free previous pending services array.
-    self->pending_request_services = NULL;
-    self->pending_request_service_count = 0;
-
-    self->pending_request_services = KAA_MALLOC(new_service_count * sizeof(kaa_extension_id));
-    KAA_RETURN_IF_NIL(self->pending_request_services, KAA_ERR_NOMEM);
-
-    if (new_service_count > 0) {
-        self->pending_request_service_count = new_service_count;
-        memcpy(self->pending_request_services, temp_new_services, new_service_count * sizeof(kaa_extension_id));
-    }
-
-    return KAA_ERR_NONE;
 }
 
 
 
 /*
- * Update pending service list with specified list. Pending service list should have only unique services.
+ * Update pending service list with specified list. Requests made until the next
+ * KAASYNC is written are merged, so they are sent together in one message.
  */
 kaa_error_t kaa_tcp_channel_update_pending_services(kaa_tcp_channel_t *self,
         const kaa_extension_id services[], size_t service_count)
 {
     KAA_RETURN_IF_NIL3(self, services, service_count, KAA_ERR_BADPARAM);
 
-    KAA_LOG_TRACE(self->logger,KAA_ERR_NONE,"Kaa TCP channel [0x%08X] %zu pending services, going to update %zu services",
-            self->access_point.id, self->pending_request_service_count, service_count);
+    KAA_LOG_TRACE(self->logger,KAA_ERR_NONE,"Kaa TCP channel [0x%08X] pending services 0x%08X, going to update %zu services",
+            self->access_point.id, self->pending_services, service_count);
 
-    size_t new_service_count = 0;
-    kaa_extension_id temp_new_services[self->pending_request_service_count + service_count];
+    for (size_t i = 0; i < service_count; ++i) {
+        if ((size_t)services[i] >= KAA_EXTENSION_ID_COUNT) {
+            return KAA_ERR_BADPARAM;
+        }
+        self->pending_services |= (uint32_t)1 << services[i];
+    }
 
-    /* First call of sync handlers services, no one services wait */
-    if (!self->pending_request_services || !self->pending_request_service_count) {
-        temp_new_services[new_service_count++] = services[0];
-    } else {
-        /* Some services waiting to sync with service, need merge with other services */
-        new_service_count = self->pending_request_service_count;
-        memcpy(temp_new_services, self->pending_request_services, new_service_count * sizeof(kaa_extension_id));
+    return KAA_ERR_NONE;
+}
 
-        KAA_FREE(self->pending_request_services); //free previous pending services array.
-        self->pending_request_services = NULL;
-        self->pending_request_service_count = 0;
-    }
 
-    new_service_count = append_with_new_services(temp_new_services,
-            new_service_count,
-            self->pending_request_service_count + service_count,
-            services,
-            service_count);
 
-    self->pending_request_services = KAA_MALLOC(new_service_count * sizeof(kaa_extension_id));
-    if (!self->pending_request_services) {
-        return KAA_ERR_NOMEM;
-    }
+/*
+ * Fill the list of pending services in the extension id order.
+ */
+size_t kaa_tcp_channel_get_pending_services(kaa_tcp_channel_t *self, kaa_extension_id services[KAA_EXTENSION_ID_COUNT])
+{
+    size_t service_count = 0;
 
-    if (new_service_count > 0) {
-        self->pending_request_service_count = new_service_count;
-        memcpy(self->pending_request_services, temp_new_services, new_service_count * sizeof(kaa_extension_id));
+    for (size_t id = 0; id < KAA_EXTENSION_ID_COUNT; ++id) {
+        if (self->pending_services & ((uint32_t)1 << id)) {
+            services[service_count++] = (kaa_extension_id)id;
+        }
     }
 
-    return KAA_ERR_NONE;
+    return service_count;
 }
 
 
@@ -1541,15 +1662,17 @@ kaa_error_t kaa_tcp_channel_release_access_point(kaa_tcp_channel_t *self)
 /*
  * Write to socket sync services.
  */
-kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self,
-        kaa_extension_id *service, size_t services_count)
+kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self)
 {
     KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
 
+    kaa_extension_id service[KAA_EXTENSION_ID_COUNT];
+    size_t services_count = kaa_tcp_channel_get_pending_services(self, service);
+
     KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] going to serialize %zu pending services"
-            , self->access_point.id, self->pending_request_service_count);
+            , self->access_point.id, services_count);
 
-    KAA_RETURN_IF_NIL2(service, services_count, KAA_ERR_NONE);
+    KAA_RETURN_IF_NIL(services_count, KAA_ERR_NONE);
 
     char *buffer = NULL;
     uint8_t *sync_buffer = NULL;
@@ -1558,29 +1681,52 @@ kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self,
     bool zipped = false;
     kaatcp_kaasync_t kaa_sync_message;
 
-    kaa_error_t error_code = kaa_buffer_allocate_space(self->out_buffer, &buffer, &buffer_size);
-    KAA_RETURN_IF_ERR(error_code);
+    /*
+     * Nothing is queued before the message, so it goes to the socket straight from
+     * where it was serialized. Only the bytes the socket doesn't take are copied to out_buffer.
+     */
+    size_t queued_size = 0;
+    kaa_buffer_get_locked_space(self->out_buffer, &queued_size);
+    bool write_directly = !queued_size && self->access_point.state == AP_CONNECTED;
 
-    error_code = kaa_platform_protocol_alloc_serialize_client_sync(
+    kaa_platform_message_splices_t *splices = NULL;
+#ifndef KAA_ENCRYPTION
+    /*
+     * The encryption needs the whole request in one buffer. Otherwise the extensions
+     * may leave large pieces (e.g. log records) in their storages, they are gathered
+     * into the same socket write.
+     */
+    kaa_platform_message_splices_t message_splices = { NULL, 0, KAA_TCP_CHANNEL_MAX_SPLICES, 0 };
+    if (write_directly) {
+        message_splices.items = kaa_scratch_alloc(self->scratch,
+                KAA_TCP_CHANNEL_MAX_SPLICES * sizeof(kaa_platform_message_splice_t));
+        if (message_splices.items) {
+            splices = &message_splices;
+        }
+    }
+#endif
+
+    kaa_error_t error_code = kaa_platform_protocol_scratch_serialize_client_sync(
             self->transport_context.kaa_context->platform_protocol,
+            self->scratch,
             service,
             services_count,
             &sync_buffer,
-            &sync_size);
+            &sync_size,
+            splices);
 
     if (error_code) {
         KAA_LOG_ERROR(self->logger, error_code, "Kaa TCP channel [0x%08X] Failed to allocate and serialize client sync",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return error_code;
     }
 
 #ifdef KAA_ENCRYPTION
-    /* TODO(KAA-1246): Rework the solution to cipher without additional allocations */
     bool encrypted = true;
-    error_code = kaa_tcp_channel_encrypt(self,(uint8_t **) &sync_buffer, &sync_size);
+    error_code = kaa_tcp_channel_encrypt(self, sync_buffer, &sync_size);
     if (error_code) {
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return error_code;
     }
 #else
@@ -1591,38 +1737,46 @@ kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self,
 
     kaa_tcp_channel_delete_pending_services(self, service, services_count);
 
-    if (!error_code) {
-        kaa_buffer_get_free_space(self->out_buffer, &buffer_size);
-        if ( buffer_size < (sync_size + sizeof(kaatcp_kaasync_header_t)) ) {
-            error_code = kaa_buffer_reallocate_space( self->out_buffer, (sync_size + sizeof(kaatcp_kaasync_header_t)) );
-            if (!error_code) {
-                kaa_buffer_allocate_space(self->out_buffer, &buffer, &buffer_size);
-            }
-        }
-    }
+    size_t request_size = sync_size + (splices ? splices->size : 0);
+    kaatcp_error_t parser_error_code = kaatcp_fill_kaasync_message((char *)sync_buffer, request_size, self->message_id++,
+            zipped, encrypted, &kaa_sync_message);
 
-    if (error_code) {
-        KAA_LOG_ERROR(self->logger, error_code, "Kaa TCP channel [0x%08X] failed to serialize client sync",
+    if (parser_error_code) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to fill KAASYNC message",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
+        return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
+    }
+
+    if (write_directly) {
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] going to send KAASYNC message (%zu bytes)",
+                self->access_point.id, request_size);
+        error_code = kaa_tcp_write_kaasync_message(self, &kaa_sync_message, splices);
+        kaa_scratch_reset(self->scratch);
         return error_code;
     }
 
-    kaatcp_error_t parser_error_code = kaatcp_fill_kaasync_message((char *)sync_buffer, sync_size, self->message_id++,
-            zipped, encrypted, &kaa_sync_message);
+    kaa_buffer_get_free_space(self->out_buffer, &buffer_size);
+    if (buffer_size < (sync_size + KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH)) {
+        error_code = kaa_buffer_reallocate_space(self->out_buffer, (sync_size + KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH));
+    }
 
-    if (parser_error_code) {
-        KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to fill KAASYNC message",
+    if (!error_code) {
+        error_code = kaa_buffer_allocate_space(self->out_buffer, &buffer, &buffer_size);
+    }
+
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Kaa TCP channel [0x%08X] failed to serialize client sync",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
-        return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
+        kaa_scratch_reset(self->scratch);
+        return error_code;
     }
 
     parser_error_code = kaatcp_get_request_kaasync(&kaa_sync_message, buffer, &buffer_size);
     if (parser_error_code) {
         KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to serialize KAASYNC message",
                 self->access_point.id);
-        KAA_FREE(sync_buffer);
+        kaa_scratch_reset(self->scratch);
         return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
     }
 
@@ -1631,7 +1785,7 @@ kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self,
 
     error_code = kaa_buffer_lock_space(self->out_buffer, buffer_size);
 
-    KAA_FREE(sync_buffer);
+    kaa_scratch_reset(self->scratch);
     KAA_RETURN_IF_ERR(error_code);
 
     error_code = kaa_tcp_write_buffer(self);
@@ -1649,32 +1803,157 @@ kaa_error_t kaa_tcp_write_buffer(kaa_tcp_channel_t *self)
     char *buf = NULL;
     size_t buf_size = 0;
     size_t bytes_written = 0;
-    kaa_error_t error_code = kaa_buffer_get_unprocessed_space(self->out_buffer, &buf, &buf_size);
-    KAA_LOG_TRACE(self->logger, error_code, "Kaa TCP channel [0x%08X] writing %zu bytes to the socket",
-            self->access_point.id, buf_size);
-    KAA_RETURN_IF_ERR(error_code);
-    if (buf_size > 0) {
+    kaa_error_t error_code = KAA_ERR_NONE;
+
+    /*
+     * The unprocessed bytes may wrap around the end of the buffer. The next span is written
+     * only if the socket has taken the whole previous one.
+     */
+    do {
+        error_code = kaa_buffer_get_unprocessed_space(self->out_buffer, &buf, &buf_size);
+        KAA_LOG_TRACE(self->logger, error_code, "Kaa TCP channel [0x%08X] writing %zu bytes to the socket",
+                self->access_point.id, buf_size);
+        KAA_RETURN_IF_ERR(error_code);
+        if (!buf_size) {
+            break;
+        }
+
+        bytes_written = 0;
         ext_tcp_socket_io_errors_t io_error =
             ext_tcp_utils_tcp_socket_write(self->access_point.socket_descriptor,
                     buf, buf_size, &bytes_written);
         switch (io_error) {
             case KAA_TCP_SOCK_IO_OK:
-                error_code = kaa_buffer_free_allocated_space(self->out_buffer, bytes_written);
+                if (bytes_written) {
+                    error_code = kaa_buffer_free_allocated_space(self->out_buffer, bytes_written);
+                }
                 KAA_LOG_TRACE(self->logger, error_code, "Kaa TCP channel [0x%08X] %zu bytes were successfully written",
                         self->access_point.id, bytes_written);
                 break;
             default:
                 KAA_LOG_WARN(self->logger, KAA_ERR_SOCKET_ERROR, "Kaa TCP channel [0x%08X] write failed",
                         self->access_point.id);
-                error_code = kaa_tcp_channel_socket_io_error(self, KAA_CHANNEL_NA);
+                return kaa_tcp_channel_socket_io_error(self, KAA_CHANNEL_NA);
+        }
+    } while (!error_code && bytes_written == buf_size);
+
+    return error_code;
+}
+
+
+/*
+ * Write KAASYNC message to socket from the serialized sync request and the pieces spliced
+ * into it, queue the unwritten bytes.
+ */
+kaa_error_t kaa_tcp_write_kaasync_message(kaa_tcp_channel_t *self, const kaatcp_kaasync_t *message,
+        const kaa_platform_message_splices_t *splices)
+{
+    KAA_RETURN_IF_NIL2(self, message, KAA_ERR_BADPARAM);
+
+    static const char padding[KAA_ALIGNMENT];
+
+    char header[KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH];
+    size_t header_size = sizeof(header);
+    kaatcp_error_t parser_error_code = kaatcp_get_request_kaasync_header(message, header, &header_size);
+    if (parser_error_code) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to serialize KAASYNC message",
+                self->access_point.id);
+        return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
+    }
+
+    /* The header, then the serialized request interleaved with the spliced pieces and their padding */
+    size_t splice_count = splices ? splices->count : 0;
+    ext_tcp_io_vector_t *vectors = kaa_scratch_alloc(self->scratch, (3 * splice_count + 2) * sizeof(ext_tcp_io_vector_t));
+    KAA_RETURN_IF_NIL(vectors, KAA_ERR_NOMEM);
+
+    size_t vector_count = 0;
+    vectors[vector_count++] = (ext_tcp_io_vector_t) { header, header_size };
+
+    char *cursor = message->sync_request;
+    for (size_t i = 0; i < splice_count; ++i) {
+        const kaa_platform_message_splice_t *splice = &splices->items[i];
+        vectors[vector_count++] = (ext_tcp_io_vector_t) { cursor, (const char *)splice->position - cursor };
+        vectors[vector_count++] = (ext_tcp_io_vector_t) { (void *)splice->data, splice->size };
+        vectors[vector_count++] = (ext_tcp_io_vector_t) { (void *)padding, splice->padding };
+        cursor = (char *)splice->position;
+    }
+    size_t spliced_size = splices ? splices->size : 0;
+    vectors[vector_count++] = (ext_tcp_io_vector_t) { cursor,
+            message->sync_request + message->sync_request_size - spliced_size - cursor };
+
+    /* The platform may take a limited number of parts per call */
+    size_t first = 0;
+    size_t bytes_written = 0;
+    do {
+        while (first < vector_count && !vectors[first].size) {
+            ++first;
+        }
+        if (first == vector_count) {
+            break;
+        }
+
+        ext_tcp_socket_io_errors_t io_error = ext_tcp_utils_tcp_socket_writev(self->access_point.socket_descriptor,
+                vectors + first, vector_count - first, &bytes_written);
+        if (io_error) {
+            KAA_LOG_WARN(self->logger, KAA_ERR_SOCKET_ERROR, "Kaa TCP channel [0x%08X] write failed",
+                    self->access_point.id);
+            return kaa_tcp_channel_socket_io_error(self, KAA_CHANNEL_NA);
+        }
+
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] %zu bytes were successfully written",
+                self->access_point.id, bytes_written);
+
+        for (size_t written = bytes_written; written; ++first) {
+            size_t part_written = written < vectors[first].size ? written : vectors[first].size;
+            vectors[first].buffer = (char *)vectors[first].buffer + part_written;
+            vectors[first].size -= part_written;
+            written -= part_written;
+            if (vectors[first].size) {
                 break;
+            }
+        }
+    } while (bytes_written);
+
+    for (size_t i = first; i < vector_count; ++i) {
+        if (!vectors[i].size) {
+            continue;
         }
+
+        kaa_error_t error_code = kaa_tcp_queue_bytes(self, vectors[i].buffer, vectors[i].size);
+        KAA_RETURN_IF_ERR(error_code);
     }
 
-    return error_code;
+    return KAA_ERR_NONE;
 }
 
 
+
+/*
+ * Copy bytes to out_buffer, they are written on the next WRITE event.
+ */
+kaa_error_t kaa_tcp_queue_bytes(kaa_tcp_channel_t *self, const char *bytes, size_t size)
+{
+    KAA_RETURN_IF_NIL3(self, bytes, size, KAA_ERR_BADPARAM);
+
+    char *buffer = NULL;
+    size_t buffer_size = 0;
+
+    kaa_error_t error_code = kaa_buffer_reallocate_space(self->out_buffer, size);
+    if (!error_code) {
+        error_code = kaa_buffer_allocate_space(self->out_buffer, &buffer, &buffer_size);
+    }
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Kaa TCP channel [0x%08X] failed to queue %zu bytes",
+                self->access_point.id, size);
+        return error_code;
+    }
+
+    memcpy(buffer, bytes, size);
+    return kaa_buffer_lock_space(self->out_buffer, size);
+}
+
+
+
 /*
  * Send Ping request message
  */
@@ -1703,7 +1982,8 @@ kaa_error_t kaa_tcp_channel_ping(kaa_tcp_channel_t *self)
 
     error_code = kaa_buffer_lock_space(self->out_buffer, buffer_size);
 
-    self->keepalive.last_sent_keepalive = KAA_TIME();
+    self->keepalive.last_sent_keepalive = KAA_TIME_MS();
+    kaa_tcp_channel_set_deadline(self, KAA_TCP_DEADLINE_PING, KAA_TCP_CHANNEL_PING_TIMEOUT * 1000);
 
     KAA_LOG_INFO(self->logger,KAA_ERR_NONE,"Kaa TCP channel [0x%08X] going to send PING message (%zu bytes)",
             self->access_point.id, buffer_size);
@@ -75,6 +75,24 @@ kaa_error_t kaa_tcp_channel_create(kaa_transport_channel_interface_t *self
                                  , size_t supported_service_count);
 
 
+/**
+ * @brief Switches the channel to another list of services, e.g. from Bootstrap to Operations.
+ *
+ * The connection and the access point are released, while the buffers and the parser
+ * are kept for reuse. The channel must be removed from the channel manager beforehand
+ * and added again afterwards to get an access point for the new services.
+ *
+ * @param[in]   self                       The channel instance.
+ * @param[in]   supported_services         A list of supported services for this channel.
+ * @param[in]   supported_service_count    The number of services in the list.
+ *
+ * @return Error code
+ */
+kaa_error_t kaa_tcp_channel_set_supported_services(kaa_transport_channel_interface_t *self
+                                                 , kaa_extension_id *supported_services
+                                                 , size_t supported_service_count);
+
+
 /**
  * @brief Retrieves the socket descriptor from the given channel instance.
  *
@@ -115,7 +133,8 @@ kaa_error_t kaa_tcp_channel_process_event(kaa_transport_channel_interface_t *sel
 
 /**
  * @brief Retrieves the maximum timeout for the multiplexing I/O like select/poll.
- * Used for @link kaa_tcp_channel_check_keepalive @endlink needs.
+ * Used for @link kaa_tcp_channel_check_keepalive @endlink needs: once the channel
+ * is authorized, it is the time left until the next keepalive ping.
  *
  * @param[in]   self           The channel instance.
  * @param[out]  max_timeout    The maximum timeout value (in seconds),
@@ -127,6 +146,20 @@ kaa_error_t kaa_tcp_channel_get_max_timeout(kaa_transport_channel_interface_t *s
                                           , uint16_t *max_timeout);
 
 
+/**
+ * @brief Retrieves the time left until the earliest channel deadline: the next poll
+ * of a pending hostname resolve, the CONNACK wait or the keepalive ping.
+ * @link kaa_tcp_channel_check_keepalive @endlink should be called once it elapses.
+ *
+ * @param[in]   self              The channel instance.
+ * @param[out]  max_timeout_ms    The maximum timeout value (in milliseconds).
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_tcp_channel_get_max_timeout_ms(kaa_transport_channel_interface_t *self
+                                             , uint32_t *max_timeout_ms);
+
+
 /**
  * @brief Checks whether a keepalive timeout occurred. If so, sends a
  * keepalive message to the server.
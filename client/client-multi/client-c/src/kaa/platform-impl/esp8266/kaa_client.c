@@ -25,6 +25,7 @@
 #include "utilities/kaa_log.h"
 #include <platform/time.h>
 #include "kaa_channel_manager.h"
+#include "kaa_platform_protocol.h"
 #include "platform-impl/common/kaa_tcp_channel.h"
 #include "platform-impl/common/ext_log_upload_strategies.h"
 #include "platform/ext_kaa_failover_strategy.h"
@@ -36,6 +37,10 @@
 static kaa_error_t kaa_log_collector_init(kaa_client_t *kaa_client);
 #endif
 
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+#include "kaa_event_private.h"
+#endif
+
 #include "kaa_private.h"
 
 typedef enum {
@@ -133,6 +138,8 @@ kaa_error_t kaa_client_create(kaa_client_t **client, kaa_client_props_t *props)
     }
 
     self->operate = true;
+    // Stored operations access points are tried first, the bootstrap servers are asked once they fail
+    self->bootstrap_complete = kaa_bootstrap_manager_has_operations_access_points(self->context->bootstrap_manager);
 
 #ifndef KAA_DISABLE_FEATURE_LOGGING
     error_code = kaa_log_collector_init(self);
@@ -158,21 +165,55 @@ static uint16_t get_poll_timeout(kaa_client_t *kaa_client)
 {
     KAA_RETURN_IF_NIL(kaa_client, 0);
 
-    uint16_t select_timeout;
-    kaa_tcp_channel_get_max_timeout(&kaa_client->channel, &select_timeout);
+    // The rest of a sliced server sync is processed on the next iteration
+    if (kaa_platform_protocol_has_pending_server_sync(kaa_client->context->platform_protocol)) {
+        return 0;
+    }
 
+    uint16_t select_timeout = KAA_TCP_CHANNEL_PING_TIMEOUT;
+    kaa_tcp_channel_get_max_timeout(&kaa_client->channel, &select_timeout);
 
-    if ((kaa_client->external_process_max_delay > 0) && (select_timeout > kaa_client->external_process_max_delay)) {
-        select_timeout = kaa_client->external_process_max_delay;
+    if (kaa_client->external_process && (kaa_client->external_process_max_delay > 0)) {
+        time_t elapsed = KAA_TIME() - kaa_client->external_process_last_call;
+        time_t remaining = (elapsed < kaa_client->external_process_max_delay)
+                ? kaa_client->external_process_max_delay - elapsed : 0;
+        if (select_timeout > remaining) {
+            select_timeout = (uint16_t)remaining;
+        }
     }
 
     if ((KAA_BOOTSTRAP_RESPONSE_PERIOD > 0) && (select_timeout > KAA_BOOTSTRAP_RESPONSE_PERIOD)) {
         select_timeout = KAA_BOOTSTRAP_RESPONSE_PERIOD;
     }
 
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+    size_t log_upload_timeout = ext_log_upload_get_next_timeout(kaa_client->context->log_collector);
+    if (select_timeout > log_upload_timeout) {
+        select_timeout = (uint16_t)log_upload_timeout;
+    }
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+    size_t event_coalescing_timeout = kaa_event_manager_get_coalescing_timeout(kaa_client->context->event_manager);
+    if (select_timeout > event_coalescing_timeout) {
+        select_timeout = (uint16_t)event_coalescing_timeout;
+    }
+#endif
+
+    size_t failover_timeout = kaa_get_failover_timeout(kaa_client->context);
+    if (select_timeout > failover_timeout) {
+        select_timeout = (uint16_t)failover_timeout;
+    }
+
     return select_timeout;
 }
 
+static bool is_failover_pending(kaa_client_t *kaa_client)
+{
+    size_t failover_timeout = kaa_get_failover_timeout(kaa_client->context);
+    return failover_timeout > 0 && failover_timeout != SIZE_MAX;
+}
+
 
 kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
 {
@@ -278,8 +319,18 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client,
                 kaa_client->external_process_last_call = KAA_TIME();
             }
         }
+        // A server sync sliced by the budget is completed before the channel is served, a slice per iteration
+        if (kaa_platform_protocol_has_pending_server_sync(kaa_client->context->platform_protocol)) {
+            error_code = kaa_platform_protocol_process_pending_server_sync(kaa_client->context->platform_protocol);
+            continue;
+        }
         if (kaa_process_failover(kaa_client->context)) {
             kaa_client->bootstrap_complete = false;
+            if (is_failover_pending(kaa_client)) {
+                // Let the MCU idle in select() until the failover or any other deadline
+                struct timeval select_tv = { get_poll_timeout(kaa_client), 0 };
+                select(0, NULL, NULL, NULL, &select_tv);
+            }
         } else {
             if(kaa_client->channel_id>0) {
                 if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED) {
@@ -313,6 +364,9 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client,
         }
 #ifndef KAA_DISABLE_FEATURE_LOGGING
       ext_log_upload_timeout(kaa_client->context->log_collector);
+#endif
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+      kaa_event_manager_coalescing_timeout(kaa_client->context->event_manager);
 #endif
     }
     KAA_LOG_INFO(kaa_client->context->logger, KAA_ERR_NONE, "Kaa client stopped");
@@ -320,6 +374,24 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client,
     return error_code;
 }
 
+kaa_error_t kaa_client_get_timeout(kaa_client_t *kaa_client, kaa_time_t *timeout)
+{
+    KAA_RETURN_IF_NIL2(kaa_client, timeout, KAA_ERR_BADPARAM);
+
+    if (!kaa_client->operate) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    if ((kaa_client->channel_id > 0 && kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED)
+            || is_failover_pending(kaa_client)) {
+        *timeout = get_poll_timeout(kaa_client);
+    } else {
+        *timeout = 0;
+    }
+
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_client_init_channel(kaa_client_t *kaa_client, kaa_client_channel_type_t channel_type)
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
@@ -328,35 +400,40 @@ kaa_error_t kaa_client_init_channel(kaa_client_t *kaa_client, kaa_client_channel
 
     KAA_LOG_TRACE(kaa_client->context->logger, KAA_ERR_NONE, "Initializing channel....");
 
-    switch (channel_type) {
-        case KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP:
-            error_code = kaa_tcp_channel_create(&kaa_client->channel
-                                              , kaa_client->context->logger
-                                              , BOOTSTRAP_SERVICE
-                                              , BOOTSTRAP_SERVICE_COUNT);
-            break;
-        case KAA_CLIENT_CHANNEL_TYPE_OPERATIONS:
-            error_code = kaa_tcp_channel_create(&kaa_client->channel
-                                              , kaa_client->context->logger
-                                              , OPERATIONS_SERVICES
-                                              , OPERATIONS_SERVICES_COUNT);
-            break;
+    kaa_extension_id *services = BOOTSTRAP_SERVICE;
+    size_t service_count = BOOTSTRAP_SERVICE_COUNT;
+    if (channel_type == KAA_CLIENT_CHANNEL_TYPE_OPERATIONS) {
+        services = OPERATIONS_SERVICES;
+        service_count = OPERATIONS_SERVICES_COUNT;
     }
 
-    if (error_code) {
-        KAA_LOG_ERROR(kaa_client->context->logger, error_code, "Failed to create transport channel, type %d", channel_type);
-        return error_code;
+    // The channel created for the first phase is reused by the next ones
+    if (kaa_client->channel.context) {
+        error_code = kaa_tcp_channel_set_supported_services(&kaa_client->channel, services, service_count);
+    } else {
+        error_code = kaa_tcp_channel_create(&kaa_client->channel
+                                          , kaa_client->context->logger
+                                          , services
+                                          , service_count);
+        if (error_code) {
+            KAA_LOG_ERROR(kaa_client->context->logger, error_code, "Failed to create transport channel, type %d", channel_type);
+            return error_code;
+        }
+
+        error_code = kaa_tcp_channel_set_socket_events_callback(&kaa_client->channel, &on_kaa_tcp_channel_event, kaa_client);
     }
 
-    error_code = kaa_tcp_channel_set_socket_events_callback(&kaa_client->channel, &on_kaa_tcp_channel_event, kaa_client);
     if (error_code) {
-        KAA_LOG_ERROR(kaa_client->context->logger, error_code,
-                "Failed to set socket events callback, channel type %d", channel_type);
+        KAA_LOG_ERROR(kaa_client->context->logger, error_code, "Failed to set up transport channel, type %d", channel_type);
         return error_code;
     }
 
+    // The client owns the channel, so the channel manager must not destroy it on removal
+    kaa_transport_channel_interface_t channel = kaa_client->channel;
+    channel.destroy = NULL;
+
     error_code = kaa_channel_manager_add_transport_channel(kaa_client->context->channel_manager
-                                                         , &kaa_client->channel
+                                                         , &channel
                                                          , &kaa_client->channel_id);
     if (error_code) {
         KAA_LOG_ERROR(kaa_client->context->logger, error_code, "Failed to add transport channel, type %d", channel_type);
@@ -388,13 +465,6 @@ kaa_error_t kaa_client_deinit_channel(kaa_client_t *kaa_client)
 
     kaa_client->channel_id = 0;
     kaa_client->channel_socket_closed = false;
-    kaa_client->channel.context = NULL;
-    kaa_client->channel.destroy = NULL;
-    kaa_client->channel.get_protocol_id = NULL;
-    kaa_client->channel.get_supported_services = NULL;
-    kaa_client->channel.init = NULL;
-    kaa_client->channel.set_access_point = NULL;
-    kaa_client->channel.sync_handler = NULL;
 
     KAA_LOG_TRACE(kaa_client->context->logger, KAA_ERR_NONE, "Channel deinitialized successfully");
 
@@ -417,6 +487,11 @@ void kaa_client_destroy(kaa_client_t *self)
 {
     KAA_RETURN_IF_NIL(self, );
 
+    if (self->channel.context) {
+        kaa_client_deinit_channel(self);
+        self->channel.destroy(self->channel.context);
+    }
+
     if (self->context) {
         kaa_deinit(self->context);
     }
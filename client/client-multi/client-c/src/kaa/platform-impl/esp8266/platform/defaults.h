@@ -19,6 +19,8 @@
 
 #define KAA_TCP_CHANNEL_IN_BUFFER_SIZE      246
 #define KAA_TCP_CHANNEL_OUT_BUFFER_SIZE     1015
+#define KAA_TCP_CHANNEL_SCRATCH_SIZE        512
+#define KAA_TCP_CHANNEL_MAX_SPLICES         4
 
 #define KAA_TCP_CHANNEL_MAX_TIMEOUT         200u
 #define KAA_TCP_CHANNEL_PING_TIMEOUT        (KAA_TCP_CHANNEL_MAX_TIMEOUT / 2)
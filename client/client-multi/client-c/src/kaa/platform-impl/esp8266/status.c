@@ -30,3 +30,9 @@ void ext_status_store(const char *buffer, size_t buffer_size)
     (void)buffer;
     (void)buffer_size;
 }
+
+void ext_status_append(const char *buffer, size_t buffer_size)
+{
+    (void)buffer;
+    (void)buffer_size;
+}
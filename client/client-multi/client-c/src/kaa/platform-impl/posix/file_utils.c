@@ -114,3 +114,47 @@ int posix_binary_file_delete(const char *file_name)
     }
     return -1;
 }
+
+int posix_binary_file_append(const char *file_name, const char *buffer, size_t buffer_size)
+{
+    if (file_name == NULL || buffer == NULL || buffer_size == 0) {
+        return -1;
+    }
+
+    FILE *file = binary_file_open(file_name, "ab");
+    if (file == NULL) {
+        return -1;
+    }
+
+    size_t written = fwrite(buffer, buffer_size, 1, file);
+    if (fclose(file) != 0 || written != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+int posix_binary_file_read_at(const char *file_name, size_t offset, char *buffer, size_t buffer_size)
+{
+    if (file_name == NULL || buffer == NULL || buffer_size == 0) {
+        return -1;
+    }
+
+    FILE *file = binary_file_open(file_name, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    if (fseek(file, (long)offset, SEEK_SET) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    size_t result_size = fread(buffer, 1, buffer_size, file);
+    if (ferror(file)) {
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+    return (int)result_size;
+}
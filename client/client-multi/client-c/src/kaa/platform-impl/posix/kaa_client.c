@@ -38,12 +38,17 @@
 #include <platform/kaa_failover_strategy.h>
 #include "kaa_channel_manager.h"
 #include "kaa_platform_utils.h"
+#include "kaa_platform_protocol.h"
 
 #ifndef KAA_DISABLE_FEATURE_LOGGING
 #include "kaa_logging.h"
 #include "kaa_logging_private.h"
 #endif
 
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+#include "kaa_event_private.h"
+#endif
+
 #include "kaa_private.h"
 
 static kaa_extension_id BOOTSTRAP_SERVICE[] = { KAA_EXTENSION_BOOTSTRAP };
@@ -147,6 +152,8 @@ kaa_error_t kaa_client_create(kaa_client_t **kaa_client, kaa_client_props_t *pro
     }
 
     self->operate = true;
+    // Stored operations access points are tried first, the bootstrap servers are asked once they fail
+    self->boostrap_complete = kaa_bootstrap_manager_has_operations_access_points(self->kaa_context->bootstrap_manager);
 
 #ifndef KAA_DISABLE_FEATURE_LOGGING
     error_code = kaa_log_collector_init(self);
@@ -167,6 +174,11 @@ void kaa_client_destroy(kaa_client_t *self)
 {
     KAA_RETURN_IF_NIL(self, );
 
+    if (self->channel.context) {
+        kaa_client_deinit_channel(self);
+        self->channel.destroy(self->channel.context);
+    }
+
     if (self->kaa_context) {
         kaa_deinit(self->kaa_context);
     }
@@ -180,25 +192,113 @@ kaa_context_t* kaa_client_get_context(kaa_client_t *kaa_client)
     return kaa_client->kaa_context;
 }
 
-static uint16_t get_poll_timeout(kaa_client_t *kaa_client)
+/* Lowers the poll timeout (in milliseconds) to a deadline given in seconds. */
+static uint32_t limit_poll_timeout(uint32_t timeout_ms, size_t deadline_sec)
+{
+    if (deadline_sec < UINT32_MAX / 1000 && deadline_sec * 1000 < timeout_ms) {
+        return (uint32_t)(deadline_sec * 1000);
+    }
+    return timeout_ms;
+}
+
+static uint32_t get_poll_timeout_ms(kaa_client_t *kaa_client)
 {
     KAA_RETURN_IF_NIL(kaa_client, 0);
 
-    uint16_t select_timeout;
-    kaa_tcp_channel_get_max_timeout(&kaa_client->channel, &select_timeout);
+    // The rest of a sliced server sync is processed on the next iteration
+    if (kaa_platform_protocol_has_pending_server_sync(kaa_client->kaa_context->platform_protocol)) {
+        return 0;
+    }
 
+    uint32_t select_timeout = KAA_TCP_CHANNEL_PING_TIMEOUT * 1000;
+    kaa_tcp_channel_get_max_timeout_ms(&kaa_client->channel, &select_timeout);
 
-    if ((kaa_client->external_process_max_delay > 0) && (select_timeout > kaa_client->external_process_max_delay)) {
-        select_timeout = kaa_client->external_process_max_delay;
+    if (kaa_client->external_process_fn && (kaa_client->external_process_max_delay > 0)) {
+        time_t elapsed = KAA_TIME() - kaa_client->external_process_last_call;
+        time_t remaining = (elapsed < kaa_client->external_process_max_delay)
+                ? kaa_client->external_process_max_delay - elapsed : 0;
+        select_timeout = limit_poll_timeout(select_timeout, (size_t)remaining);
     }
 
-    if ((KAA_BOOTSTRAP_RESPONSE_PERIOD > 0) && (select_timeout > KAA_BOOTSTRAP_RESPONSE_PERIOD)) {
-        select_timeout = KAA_BOOTSTRAP_RESPONSE_PERIOD;
+    if (KAA_BOOTSTRAP_RESPONSE_PERIOD > 0) {
+        select_timeout = limit_poll_timeout(select_timeout, KAA_BOOTSTRAP_RESPONSE_PERIOD);
     }
 
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+    select_timeout = limit_poll_timeout(select_timeout,
+            ext_log_upload_get_next_timeout(kaa_client->kaa_context->log_collector));
+#endif
+
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+    select_timeout = limit_poll_timeout(select_timeout,
+            kaa_event_manager_get_coalescing_timeout(kaa_client->kaa_context->event_manager));
+#endif
+
+    select_timeout = limit_poll_timeout(select_timeout, kaa_get_failover_timeout(kaa_client->kaa_context));
+
     return select_timeout;
 }
 
+static struct timeval get_poll_timeval(kaa_client_t *kaa_client)
+{
+    uint32_t timeout_ms = get_poll_timeout_ms(kaa_client);
+    struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    return tv;
+}
+
+static bool is_failover_pending(kaa_client_t *kaa_client)
+{
+    size_t failover_timeout = kaa_get_failover_timeout(kaa_client->kaa_context);
+    return failover_timeout > 0 && failover_timeout != SIZE_MAX;
+}
+
+static kaa_error_t kaa_client_process_channel_events(kaa_client_t *kaa_client, bool readable, bool writable)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+    int channel_fd = 0;
+
+    kaa_tcp_channel_get_descriptor(&kaa_client->channel, &channel_fd);
+
+    if (!readable && !writable) {
+        error_code = kaa_tcp_channel_check_keepalive(&kaa_client->channel);
+    } else if (channel_fd >= 0) {
+        if (readable) {
+            KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                    "Processing IN event for the client socket %d", channel_fd);
+            error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_READ);
+            if (error_code) {
+                KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
+                        "Failed to process IN event for the client socket %d", channel_fd);
+            }
+        }
+        if (writable) {
+            KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                    "Processing OUT event for the client socket %d", channel_fd);
+
+            error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_WRITE);
+            if (error_code) {
+                KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
+                        "Failed to process OUT event for the client socket %d", channel_fd);
+            }
+        }
+    }
+
+    return error_code;
+}
+
+static void kaa_client_check_channel_closed(kaa_client_t *kaa_client, kaa_error_t error_code)
+{
+    if (kaa_client->channel_socket_closed) {
+        KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                "Channel [0x%08X] connection terminated", kaa_client->channel_id);
+
+        kaa_client->channel_state = KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED;
+        if (error_code != KAA_ERR_EVENT_NOT_ATTACHED) {
+            kaa_client_deinit_channel(kaa_client);
+        }
+    }
+}
+
 kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
@@ -206,7 +306,7 @@ kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
     kaa_error_t error_code = KAA_ERR_NONE;
 
     fd_set read_fds, write_fds, except_fds;
-    struct timeval select_tv = { get_poll_timeout(kaa_client), 0 };
+    struct timeval select_tv = get_poll_timeval(kaa_client);
     int channel_fd = 0;
 
     FD_ZERO(&read_fds);
@@ -222,44 +322,16 @@ kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
         FD_SET(channel_fd, &write_fds);
 
     int poll_result = select(channel_fd + 1, &read_fds, &write_fds, NULL, &select_tv);
-    if (poll_result == 0) {
-        error_code = kaa_tcp_channel_check_keepalive(&kaa_client->channel);
-    } else if (poll_result > 0) {
-        if (channel_fd >= 0) {
-            if (FD_ISSET(channel_fd, &read_fds)) {
-                KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                        "Processing IN event for the client socket %d", channel_fd);
-                error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_READ);
-                if (error_code) {
-                    KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
-                            "Failed to process IN event for the client socket %d", channel_fd);
-                }
-            }
-            if (FD_ISSET(channel_fd, &write_fds)) {
-                KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                        "Processing OUT event for the client socket %d", channel_fd);
-
-                error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_WRITE);
-                if (error_code) {
-                    KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
-                            "Failed to process OUT event for the client socket %d", channel_fd);
-                }
-            }
-        }
+    if (poll_result >= 0) {
+        bool readable = poll_result > 0 && channel_fd >= 0 && FD_ISSET(channel_fd, &read_fds);
+        bool writable = poll_result > 0 && channel_fd >= 0 && FD_ISSET(channel_fd, &write_fds);
+        error_code = kaa_client_process_channel_events(kaa_client, readable, writable);
     } else {
         KAA_LOG_ERROR(kaa_client->kaa_context->logger, KAA_ERR_BAD_STATE, "Failed to poll descriptors: %s", strerror(errno));
         error_code = KAA_ERR_BAD_STATE;
     }
 
-    if (kaa_client->channel_socket_closed) {
-        KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                "Channel [0x%08X] connection terminated", kaa_client->channel_id);
-
-        kaa_client->channel_state = KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED;
-        if (error_code != KAA_ERR_EVENT_NOT_ATTACHED) {
-            kaa_client_deinit_channel(kaa_client);
-        }
-    }
+    kaa_client_check_channel_closed(kaa_client, error_code);
 
     return error_code;
 }
@@ -279,6 +351,82 @@ kaa_error_t kaa_client_process_channel_disconnected(kaa_client_t *kaa_client)
     return error_code;
 }
 
+/*
+ * One iteration of the client loop. If @p wait is set, waits for the channel events with select(),
+ * otherwise processes the events reported by an external event loop.
+ */
+static kaa_error_t kaa_client_step(kaa_client_t *kaa_client, bool wait, bool readable, bool writable)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+
+    if (kaa_client->external_process_fn) {
+        if ((KAA_TIME() - kaa_client->external_process_last_call) >= kaa_client->external_process_max_delay) {
+            kaa_client->external_process_fn(kaa_client->external_process_context);
+            kaa_client->external_process_last_call = KAA_TIME();
+        }
+    }
+
+    /*
+     * A server sync sliced by the budget is completed before the channel is read or written,
+     * one slice per iteration, so the application gets control back in between.
+     */
+    if (kaa_platform_protocol_has_pending_server_sync(kaa_client->kaa_context->platform_protocol)) {
+        return kaa_platform_protocol_process_pending_server_sync(kaa_client->kaa_context->platform_protocol);
+    }
+
+    //Check Kaa channel is ready to transmit something
+    if (kaa_process_failover(kaa_client->kaa_context)) {
+        kaa_client->boostrap_complete = false;
+        if (wait && is_failover_pending(kaa_client)) {
+            // Idle until the failover or any other deadline instead of spinning
+            struct timeval select_tv = get_poll_timeval(kaa_client);
+            select(0, NULL, NULL, NULL, &select_tv);
+        }
+    } else {
+        if (kaa_client->channel_id > 0) {
+            if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED) {
+                error_code = kaa_client_process_channel_disconnected(kaa_client);
+            } else  if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+                if (wait) {
+                    error_code = kaa_client_process_channel_connected(kaa_client);
+                } else {
+                    error_code = kaa_client_process_channel_events(kaa_client, readable, writable);
+                    kaa_client_check_channel_closed(kaa_client, error_code);
+                }
+                if (error_code == KAA_ERR_TIMEOUT)
+                    kaa_client_deinit_channel(kaa_client);
+            }
+        } else {
+            //No initialized channels
+            if (kaa_client->boostrap_complete) {
+                KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                            "Channel [0x%08X] Boostrap complete, reinitializing to Operations ...", kaa_client->channel_id);
+                kaa_client->boostrap_complete = false;
+                kaa_client_deinit_channel(kaa_client);
+                error_code = kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_OPERATIONS);
+                if (error_code == KAA_ERR_BAD_STATE) {
+                    kaa_client_deinit_channel(kaa_client);
+                    kaa_client->boostrap_complete = false;
+                }
+            } else {
+                KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                            "Channel [0x%08X] Operations error, reinitializing to Bootstrap ...", kaa_client->channel_id);
+                kaa_client->boostrap_complete = true;
+                kaa_client_deinit_channel(kaa_client);
+                kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP);
+            }
+        }
+    }
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+    ext_log_upload_timeout(kaa_client->kaa_context->log_collector);
+#endif
+#ifndef KAA_DISABLE_FEATURE_EVENTS
+    kaa_event_manager_coalescing_timeout(kaa_client->kaa_context->event_manager);
+#endif
+
+    return error_code;
+}
+
 kaa_error_t kaa_client_start(kaa_client_t *kaa_client
                            , external_process_fn external_process
                            , void *external_process_context
@@ -300,55 +448,69 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client
     KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Starting Kaa client...");
 
     while (kaa_client->operate) {
-        if (kaa_client->external_process_fn) {
-            if ((KAA_TIME() - kaa_client->external_process_last_call) >= kaa_client->external_process_max_delay) {
-                kaa_client->external_process_fn(kaa_client->external_process_context);
-                kaa_client->external_process_last_call = KAA_TIME();
-            }
-        }
-
-        //Check Kaa channel is ready to transmit something
-        if (kaa_process_failover(kaa_client->kaa_context)) {
-            kaa_client->boostrap_complete = false;
-        } else {
-            if (kaa_client->channel_id > 0) {
-                if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED) {
-                    error_code = kaa_client_process_channel_disconnected(kaa_client);
-                } else  if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
-                    error_code = kaa_client_process_channel_connected(kaa_client);
-                    if (error_code == KAA_ERR_TIMEOUT)
-                        kaa_client_deinit_channel(kaa_client);
-                }
-            } else {
-                //No initialized channels
-                if (kaa_client->boostrap_complete) {
-                    KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                                "Channel [0x%08X] Boostrap complete, reinitializing to Operations ...", kaa_client->channel_id);
-                    kaa_client->boostrap_complete = false;
-                    kaa_client_deinit_channel(kaa_client);
-                    error_code = kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_OPERATIONS);
-                    if (error_code == KAA_ERR_BAD_STATE) {
-                        kaa_client_deinit_channel(kaa_client);
-                        kaa_client->boostrap_complete = false;
-                    }
-                } else {
-                    KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                                "Channel [0x%08X] Operations error, reinitializing to Bootstrap ...", kaa_client->channel_id);
-                    kaa_client->boostrap_complete = true;
-                    kaa_client_deinit_channel(kaa_client);
-                    kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP);
-            }
-        }
-      }
-#ifndef KAA_DISABLE_FEATURE_LOGGING
-      ext_log_upload_timeout(kaa_client->kaa_context->log_collector);
-#endif
+        error_code = kaa_client_step(kaa_client, true, false, false);
     }
     KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Kaa client stopped");
 
     return error_code;
 }
 
+kaa_error_t kaa_client_get_descriptor(kaa_client_t *kaa_client, kaa_fd_t *fd, bool *wants_read, bool *wants_write)
+{
+    KAA_RETURN_IF_NIL3(kaa_client, fd, wants_read, KAA_ERR_BADPARAM);
+    KAA_RETURN_IF_NIL(wants_write, KAA_ERR_BADPARAM);
+
+    *fd = KAA_TCP_SOCKET_NOT_SET;
+    *wants_read = false;
+    *wants_write = false;
+
+    if (!kaa_client->operate) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    if (kaa_client->channel_id > 0 && kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+        kaa_tcp_channel_get_descriptor(&kaa_client->channel, fd);
+        *wants_read = kaa_tcp_channel_is_ready(&kaa_client->channel, FD_READ);
+        *wants_write = kaa_tcp_channel_is_ready(&kaa_client->channel, FD_WRITE);
+    }
+
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_client_get_timeout(kaa_client_t *kaa_client, kaa_time_t *timeout)
+{
+    KAA_RETURN_IF_NIL2(kaa_client, timeout, KAA_ERR_BADPARAM);
+
+    if (!kaa_client->operate) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    /*
+     * Until the channel is connected the client makes progress on each call, as kaa_client_start() does.
+     * A scheduled failover leaves nothing to do but to wait for the nearest deadline.
+     */
+    if ((kaa_client->channel_id > 0 && kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED)
+            || is_failover_pending(kaa_client)) {
+        // Rounded up not to wake up before the deadline
+        *timeout = (kaa_time_t)((get_poll_timeout_ms(kaa_client) + 999) / 1000);
+    } else {
+        *timeout = 0;
+    }
+
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_client_process(kaa_client_t *kaa_client, bool readable, bool writable)
+{
+    KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
+
+    if (!kaa_client->operate) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    return kaa_client_step(kaa_client, false, readable, writable);
+}
+
 kaa_error_t kaa_client_stop(kaa_client_t *kaa_client)
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
@@ -366,35 +528,40 @@ kaa_error_t kaa_client_init_channel(kaa_client_t *kaa_client, kaa_client_channel
 
     KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Initializing channel....");
 
-    switch (channel_type) {
-        case KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP:
-            error_code = kaa_tcp_channel_create(&kaa_client->channel
-                                              , kaa_client->kaa_context->logger
-                                              , BOOTSTRAP_SERVICE
-                                              , BOOTSTRAP_SERVICE_COUNT);
-            break;
-        case KAA_CLIENT_CHANNEL_TYPE_OPERATIONS:
-            error_code = kaa_tcp_channel_create(&kaa_client->channel
-                                              , kaa_client->kaa_context->logger
-                                              , OPERATIONS_SERVICES
-                                              , OPERATIONS_SERVICES_COUNT);
-            break;
+    kaa_extension_id *services = BOOTSTRAP_SERVICE;
+    size_t service_count = BOOTSTRAP_SERVICE_COUNT;
+    if (channel_type == KAA_CLIENT_CHANNEL_TYPE_OPERATIONS) {
+        services = OPERATIONS_SERVICES;
+        service_count = OPERATIONS_SERVICES_COUNT;
     }
 
-    if (error_code) {
-        KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code, "Failed to create transport channel, type %d", channel_type);
-        return error_code;
+    // The channel created for the first phase is reused by the next ones
+    if (kaa_client->channel.context) {
+        error_code = kaa_tcp_channel_set_supported_services(&kaa_client->channel, services, service_count);
+    } else {
+        error_code = kaa_tcp_channel_create(&kaa_client->channel
+                                          , kaa_client->kaa_context->logger
+                                          , services
+                                          , service_count);
+        if (error_code) {
+            KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code, "Failed to create transport channel, type %d", channel_type);
+            return error_code;
+        }
+
+        error_code = kaa_tcp_channel_set_socket_events_callback(&kaa_client->channel, &on_kaa_tcp_channel_event, kaa_client);
     }
 
-    error_code = kaa_tcp_channel_set_socket_events_callback(&kaa_client->channel, &on_kaa_tcp_channel_event, kaa_client);
     if (error_code) {
-        KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
-                "Failed to set socket events callback, channel type %d", channel_type);
+        KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code, "Failed to set up transport channel, type %d", channel_type);
         return error_code;
     }
 
+    // The client owns the channel, so the channel manager must not destroy it on removal
+    kaa_transport_channel_interface_t channel = kaa_client->channel;
+    channel.destroy = NULL;
+
     error_code = kaa_channel_manager_add_transport_channel(kaa_client->kaa_context->channel_manager
-                                                         , &kaa_client->channel
+                                                         , &channel
                                                          , &kaa_client->channel_id);
     if (error_code) {
         KAA_LOG_WARN(kaa_client->kaa_context->logger, error_code, "Failed to %s channel, type %d",
@@ -428,13 +595,6 @@ kaa_error_t kaa_client_deinit_channel(kaa_client_t *kaa_client)
 
     kaa_client->channel_id = 0;
     kaa_client->channel_socket_closed = false;
-    kaa_client->channel.context = NULL;
-    kaa_client->channel.destroy = NULL;
-    kaa_client->channel.get_protocol_id = NULL;
-    kaa_client->channel.get_supported_services = NULL;
-    kaa_client->channel.init = NULL;
-    kaa_client->channel.set_access_point = NULL;
-    kaa_client->channel.sync_handler = NULL;
 
     KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Channel deinitialized successfully");
 
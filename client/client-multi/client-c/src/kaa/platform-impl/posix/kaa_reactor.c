@@ -0,0 +1,597 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kaa_reactor.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#define KAA_REACTOR_USE_EPOLL
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__)
+#define KAA_REACTOR_USE_KQUEUE
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#else
+#include <poll.h>
+#endif
+
+#include "kaa.h"
+#include "kaa_common.h"
+#include "utilities/kaa_mem.h"
+#include "platform/ext_tcp_utils.h"
+
+/* The number of events taken from the kernel at once, the rest is taken on the next iteration */
+#define KAA_REACTOR_MAX_EVENTS      64
+
+/* The maximum wait of kaa_reactor_run(), clients and descriptors usually wake it up earlier */
+#define KAA_REACTOR_RUN_MAX_WAIT    60
+
+typedef struct kaa_reactor_entry_t {
+    struct kaa_reactor_entry_t    *next;
+
+    kaa_client_t                  *kaa_client;          /**< NULL for user descriptors */
+    kaa_fd_t                      fd;                   /**< User descriptor */
+    bool                          wants_read;
+    bool                          wants_write;
+    kaa_reactor_fd_callback_fn    callback;
+    void                          *context;
+
+    kaa_fd_t                      registered_fd;        /**< KAA_TCP_SOCKET_NOT_SET if not registered */
+    bool                          registered_read;
+    bool                          registered_write;
+
+    bool                          readable;             /**< Events of the current iteration */
+    bool                          writable;
+    bool                          removed;              /**< Freed after the current iteration */
+} kaa_reactor_entry_t;
+
+struct kaa_reactor_t {
+    kaa_reactor_entry_t    *entries;
+    bool                   operate;
+    bool                   dispatching;
+#if defined(KAA_REACTOR_USE_EPOLL) || defined(KAA_REACTOR_USE_KQUEUE)
+    int                    backend_fd;
+#else
+    struct pollfd          *poll_fds;
+    kaa_reactor_entry_t    **poll_entries;
+    size_t                 poll_capacity;
+#endif
+};
+
+
+
+#if defined(KAA_REACTOR_USE_EPOLL)
+
+static kaa_error_t kaa_reactor_backend_create(kaa_reactor_t *self)
+{
+    self->backend_fd = epoll_create1(EPOLL_CLOEXEC);
+    return self->backend_fd < 0 ? KAA_ERR_BAD_STATE : KAA_ERR_NONE;
+}
+
+static void kaa_reactor_backend_destroy(kaa_reactor_t *self)
+{
+    if (self->backend_fd >= 0) {
+        close(self->backend_fd);
+    }
+}
+
+static void kaa_reactor_backend_unregister(kaa_reactor_t *self, kaa_reactor_entry_t *entry)
+{
+    // Fails if the descriptor is closed already, which removes it from the set as well.
+    struct epoll_event event = { 0 };
+    epoll_ctl(self->backend_fd, EPOLL_CTL_DEL, entry->registered_fd, &event);
+}
+
+static kaa_error_t kaa_reactor_backend_register(kaa_reactor_t *self, kaa_reactor_entry_t *entry
+                                              , kaa_fd_t fd, bool wants_read, bool wants_write)
+{
+    struct epoll_event event = { 0 };
+    event.events = (wants_read ? EPOLLIN : 0) | (wants_write ? EPOLLOUT : 0);
+    event.data.ptr = entry;
+
+    /*
+     * A closed descriptor leaves the set, so the same number may need to be added again.
+     */
+    int op = entry->registered_fd == fd ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    int result = epoll_ctl(self->backend_fd, op, fd, &event);
+    if (result && op == EPOLL_CTL_MOD && errno == ENOENT) {
+        result = epoll_ctl(self->backend_fd, EPOLL_CTL_ADD, fd, &event);
+    } else if (result && op == EPOLL_CTL_ADD && errno == EEXIST) {
+        result = epoll_ctl(self->backend_fd, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    return result ? KAA_ERR_BAD_STATE : KAA_ERR_NONE;
+}
+
+static int kaa_reactor_backend_wait(kaa_reactor_t *self, int timeout_ms)
+{
+    struct epoll_event events[KAA_REACTOR_MAX_EVENTS];
+
+    int count = epoll_wait(self->backend_fd, events, KAA_REACTOR_MAX_EVENTS, timeout_ms);
+    for (int i = 0; i < count; ++i) {
+        kaa_reactor_entry_t *entry = events[i].data.ptr;
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            entry->readable = true;
+        }
+        if (events[i].events & EPOLLOUT) {
+            entry->writable = true;
+        }
+    }
+
+    return count;
+}
+
+#elif defined(KAA_REACTOR_USE_KQUEUE)
+
+static kaa_error_t kaa_reactor_backend_create(kaa_reactor_t *self)
+{
+    self->backend_fd = kqueue();
+    return self->backend_fd < 0 ? KAA_ERR_BAD_STATE : KAA_ERR_NONE;
+}
+
+static void kaa_reactor_backend_destroy(kaa_reactor_t *self)
+{
+    if (self->backend_fd >= 0) {
+        close(self->backend_fd);
+    }
+}
+
+static void kaa_reactor_backend_unregister(kaa_reactor_t *self, kaa_reactor_entry_t *entry)
+{
+    struct kevent changes[2];
+    int count = 0;
+
+    if (entry->registered_read) {
+        EV_SET(&changes[count++], entry->registered_fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    }
+    if (entry->registered_write) {
+        EV_SET(&changes[count++], entry->registered_fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+    }
+
+    // Fails if the descriptor is closed already, which removes its filters as well.
+    kevent(self->backend_fd, changes, count, NULL, 0, NULL);
+}
+
+static kaa_error_t kaa_reactor_backend_register(kaa_reactor_t *self, kaa_reactor_entry_t *entry
+                                              , kaa_fd_t fd, bool wants_read, bool wants_write)
+{
+    struct kevent changes[2];
+    int count = 0;
+
+    bool is_registered = entry->registered_fd == fd;
+    if (wants_read != (is_registered && entry->registered_read)) {
+        EV_SET(&changes[count++], fd, EVFILT_READ, wants_read ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, entry);
+    }
+    if (wants_write != (is_registered && entry->registered_write)) {
+        EV_SET(&changes[count++], fd, EVFILT_WRITE, wants_write ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, entry);
+    }
+
+    if (count && kevent(self->backend_fd, changes, count, NULL, 0, NULL) < 0) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    return KAA_ERR_NONE;
+}
+
+static int kaa_reactor_backend_wait(kaa_reactor_t *self, int timeout_ms)
+{
+    struct kevent events[KAA_REACTOR_MAX_EVENTS];
+    struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+
+    int count = kevent(self->backend_fd, NULL, 0, events, KAA_REACTOR_MAX_EVENTS, &timeout);
+    for (int i = 0; i < count; ++i) {
+        kaa_reactor_entry_t *entry = (kaa_reactor_entry_t *)events[i].udata;
+        if (events[i].filter == EVFILT_READ) {
+            entry->readable = true;
+        } else if (events[i].filter == EVFILT_WRITE) {
+            entry->writable = true;
+        }
+    }
+
+    return count;
+}
+
+#else
+
+static kaa_error_t kaa_reactor_backend_create(kaa_reactor_t *self)
+{
+    (void)self;
+    return KAA_ERR_NONE;
+}
+
+static void kaa_reactor_backend_destroy(kaa_reactor_t *self)
+{
+    KAA_FREE(self->poll_fds);
+    KAA_FREE(self->poll_entries);
+}
+
+static void kaa_reactor_backend_unregister(kaa_reactor_t *self, kaa_reactor_entry_t *entry)
+{
+    (void)self;
+    (void)entry;
+}
+
+static kaa_error_t kaa_reactor_backend_register(kaa_reactor_t *self, kaa_reactor_entry_t *entry
+                                              , kaa_fd_t fd, bool wants_read, bool wants_write)
+{
+    // The descriptor set is built on each wait from the registered entries.
+    (void)self;
+    (void)entry;
+    (void)fd;
+    (void)wants_read;
+    (void)wants_write;
+    return KAA_ERR_NONE;
+}
+
+static int kaa_reactor_backend_wait(kaa_reactor_t *self, int timeout_ms)
+{
+    size_t fd_count = 0;
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (entry->registered_fd != KAA_TCP_SOCKET_NOT_SET) {
+            ++fd_count;
+        }
+    }
+
+    if (fd_count > self->poll_capacity) {
+        KAA_FREE(self->poll_fds);
+        KAA_FREE(self->poll_entries);
+        self->poll_capacity = 0;
+
+        self->poll_fds = KAA_MALLOC(2 * fd_count * sizeof(*self->poll_fds));
+        self->poll_entries = KAA_MALLOC(2 * fd_count * sizeof(*self->poll_entries));
+        if (!self->poll_fds || !self->poll_entries) {
+            errno = ENOMEM;
+            return -1;
+        }
+        self->poll_capacity = 2 * fd_count;
+    }
+
+    size_t i = 0;
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (entry->registered_fd != KAA_TCP_SOCKET_NOT_SET) {
+            self->poll_fds[i].fd = entry->registered_fd;
+            self->poll_fds[i].events = (entry->registered_read ? POLLIN : 0) | (entry->registered_write ? POLLOUT : 0);
+            self->poll_fds[i].revents = 0;
+            self->poll_entries[i++] = entry;
+        }
+    }
+
+    int count = poll(self->poll_fds, fd_count, timeout_ms);
+    for (i = 0; count > 0 && i < fd_count; ++i) {
+        if (self->poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            self->poll_entries[i]->readable = true;
+        }
+        if (self->poll_fds[i].revents & POLLOUT) {
+            self->poll_entries[i]->writable = true;
+        }
+    }
+
+    return count;
+}
+
+#endif
+
+
+
+/*
+ * Brings the registration of the entry in line with the descriptor and the events it waits for.
+ */
+static kaa_error_t kaa_reactor_update(kaa_reactor_t *self, kaa_reactor_entry_t *entry
+                                    , kaa_fd_t fd, bool wants_read, bool wants_write)
+{
+    bool wants = fd != KAA_TCP_SOCKET_NOT_SET && (wants_read || wants_write);
+
+    if (entry->registered_fd != KAA_TCP_SOCKET_NOT_SET && (!wants || entry->registered_fd != fd)) {
+        kaa_reactor_backend_unregister(self, entry);
+        entry->registered_fd = KAA_TCP_SOCKET_NOT_SET;
+        entry->registered_read = false;
+        entry->registered_write = false;
+    }
+
+    if (!wants || (entry->registered_fd == fd
+            && entry->registered_read == wants_read && entry->registered_write == wants_write)) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_error_t error_code = kaa_reactor_backend_register(self, entry, fd, wants_read, wants_write);
+    if (error_code) {
+        return error_code;
+    }
+
+    entry->registered_fd = fd;
+    entry->registered_read = wants_read;
+    entry->registered_write = wants_write;
+    return KAA_ERR_NONE;
+}
+
+static kaa_reactor_entry_t *kaa_reactor_find_entry(kaa_reactor_t *self, kaa_client_t *kaa_client, kaa_fd_t fd)
+{
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (!entry->removed && entry->kaa_client == kaa_client && (kaa_client || entry->fd == fd)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static kaa_error_t kaa_reactor_add_entry(kaa_reactor_t *self, kaa_reactor_entry_t **entry_p)
+{
+    kaa_reactor_entry_t *entry = KAA_CALLOC(1, sizeof(*entry));
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOMEM);
+
+    entry->fd = KAA_TCP_SOCKET_NOT_SET;
+    entry->registered_fd = KAA_TCP_SOCKET_NOT_SET;
+    entry->next = self->entries;
+    self->entries = entry;
+
+    *entry_p = entry;
+    return KAA_ERR_NONE;
+}
+
+static void kaa_reactor_remove_entry(kaa_reactor_t *self, kaa_reactor_entry_t *entry)
+{
+    kaa_reactor_update(self, entry, KAA_TCP_SOCKET_NOT_SET, false, false);
+    entry->removed = true;
+}
+
+/*
+ * Frees the removed entries, deferred while events are dispatched.
+ */
+static void kaa_reactor_purge_entries(kaa_reactor_t *self)
+{
+    kaa_reactor_entry_t **entry_p = &self->entries;
+    while (*entry_p) {
+        kaa_reactor_entry_t *entry = *entry_p;
+        if (entry->removed) {
+            *entry_p = entry->next;
+            KAA_FREE(entry);
+        } else {
+            entry_p = &entry->next;
+        }
+    }
+}
+
+kaa_error_t kaa_reactor_create(kaa_reactor_t **reactor_p)
+{
+    KAA_RETURN_IF_NIL(reactor_p, KAA_ERR_BADPARAM);
+
+    kaa_reactor_t *self = KAA_CALLOC(1, sizeof(*self));
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOMEM);
+
+    kaa_error_t error_code = kaa_reactor_backend_create(self);
+    if (error_code) {
+        KAA_FREE(self);
+        return error_code;
+    }
+
+    *reactor_p = self;
+    return KAA_ERR_NONE;
+}
+
+void kaa_reactor_destroy(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, );
+
+    while (self->entries) {
+        kaa_reactor_entry_t *entry = self->entries;
+        self->entries = entry->next;
+        KAA_FREE(entry);
+    }
+
+    kaa_reactor_backend_destroy(self);
+    KAA_FREE(self);
+}
+
+kaa_error_t kaa_reactor_add_client(kaa_reactor_t *self, kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL2(self, kaa_client, KAA_ERR_BADPARAM);
+
+    if (kaa_reactor_find_entry(self, kaa_client, KAA_TCP_SOCKET_NOT_SET)) {
+        return KAA_ERR_ALREADY_EXISTS;
+    }
+
+    kaa_error_t error_code = kaa_check_readiness(kaa_client_get_context(kaa_client));
+    if (error_code) {
+        return error_code;
+    }
+
+    kaa_reactor_entry_t *entry = NULL;
+    error_code = kaa_reactor_add_entry(self, &entry);
+    if (error_code) {
+        return error_code;
+    }
+
+    entry->kaa_client = kaa_client;
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_reactor_remove_client(kaa_reactor_t *self, kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL2(self, kaa_client, KAA_ERR_BADPARAM);
+
+    kaa_reactor_entry_t *entry = kaa_reactor_find_entry(self, kaa_client, KAA_TCP_SOCKET_NOT_SET);
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOT_FOUND);
+
+    kaa_reactor_remove_entry(self, entry);
+    if (!self->dispatching) {
+        kaa_reactor_purge_entries(self);
+    }
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_reactor_add_fd(kaa_reactor_t *self, kaa_fd_t fd, bool wants_read, bool wants_write
+                             , kaa_reactor_fd_callback_fn callback, void *context)
+{
+    KAA_RETURN_IF_NIL2(self, callback, KAA_ERR_BADPARAM);
+    if (fd == KAA_TCP_SOCKET_NOT_SET) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    if (kaa_reactor_find_entry(self, NULL, fd)) {
+        return KAA_ERR_ALREADY_EXISTS;
+    }
+
+    kaa_reactor_entry_t *entry = NULL;
+    kaa_error_t error_code = kaa_reactor_add_entry(self, &entry);
+    if (error_code) {
+        return error_code;
+    }
+
+    entry->fd = fd;
+    entry->callback = callback;
+    entry->context = context;
+
+    error_code = kaa_reactor_modify_fd(self, fd, wants_read, wants_write);
+    if (error_code) {
+        kaa_reactor_remove_fd(self, fd);
+    }
+    return error_code;
+}
+
+kaa_error_t kaa_reactor_modify_fd(kaa_reactor_t *self, kaa_fd_t fd, bool wants_read, bool wants_write)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    kaa_reactor_entry_t *entry = kaa_reactor_find_entry(self, NULL, fd);
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOT_FOUND);
+
+    entry->wants_read = wants_read;
+    entry->wants_write = wants_write;
+    return kaa_reactor_update(self, entry, fd, wants_read, wants_write);
+}
+
+kaa_error_t kaa_reactor_remove_fd(kaa_reactor_t *self, kaa_fd_t fd)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    kaa_reactor_entry_t *entry = kaa_reactor_find_entry(self, NULL, fd);
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOT_FOUND);
+
+    kaa_reactor_remove_entry(self, entry);
+    if (!self->dispatching) {
+        kaa_reactor_purge_entries(self);
+    }
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_reactor_process(kaa_reactor_t *self, kaa_time_t max_wait)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    if (self->dispatching) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    kaa_error_t error_code = KAA_ERR_NONE;
+    kaa_time_t wait = max_wait;
+
+    /*
+     * Channel descriptors change on reconnects, so they are checked on each iteration.
+     * The kernel is called only if a descriptor or its events differ from the registered ones.
+     */
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (!entry->kaa_client) {
+            continue;
+        }
+
+        kaa_fd_t fd = KAA_TCP_SOCKET_NOT_SET;
+        bool wants_read = false;
+        bool wants_write = false;
+        kaa_time_t timeout = 0;
+
+        if (kaa_client_get_descriptor(entry->kaa_client, &fd, &wants_read, &wants_write)
+                || kaa_client_get_timeout(entry->kaa_client, &timeout)) {
+            // The client is stopped.
+            kaa_reactor_update(self, entry, KAA_TCP_SOCKET_NOT_SET, false, false);
+            continue;
+        }
+
+        kaa_error_t update_error = kaa_reactor_update(self, entry, fd, wants_read, wants_write);
+        if (update_error) {
+            error_code = update_error;
+        }
+
+        if (timeout < wait) {
+            wait = timeout;
+        }
+    }
+
+    int timeout_ms = 0;
+    if (wait > 0) {
+        timeout_ms = wait > INT_MAX / 1000 ? INT_MAX : (int)wait * 1000;
+    }
+
+    if (kaa_reactor_backend_wait(self, timeout_ms) < 0 && errno != EINTR) {
+        return KAA_ERR_BAD_STATE;
+    }
+
+    self->dispatching = true;
+
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (!entry->removed && !entry->kaa_client && (entry->readable || entry->writable)) {
+            entry->callback(entry->context, entry->fd, entry->readable, entry->writable);
+        }
+    }
+
+    /*
+     * Clients without events are processed as well: they check keepalive and do the periodic work.
+     * Their errors are logged by the clients, which recover on the next iterations.
+     */
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        if (!entry->removed && entry->kaa_client) {
+            kaa_client_process(entry->kaa_client, entry->readable, entry->writable);
+        }
+    }
+
+    for (kaa_reactor_entry_t *entry = self->entries; entry; entry = entry->next) {
+        entry->readable = false;
+        entry->writable = false;
+    }
+
+    self->dispatching = false;
+    kaa_reactor_purge_entries(self);
+
+    return error_code;
+}
+
+kaa_error_t kaa_reactor_run(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    kaa_error_t error_code = KAA_ERR_NONE;
+
+    self->operate = true;
+    while (self->operate) {
+        error_code = kaa_reactor_process(self, KAA_REACTOR_RUN_MAX_WAIT);
+        if (error_code == KAA_ERR_BAD_STATE) {
+            break;
+        }
+    }
+
+    return error_code;
+}
+
+kaa_error_t kaa_reactor_stop(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+    self->operate = false;
+    return KAA_ERR_NONE;
+}
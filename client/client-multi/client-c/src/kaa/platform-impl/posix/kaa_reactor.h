@@ -0,0 +1,153 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file kaa_reactor.h
+ * @brief Event loop driving many Kaa clients and user descriptors in one thread.
+ *
+ * The reactor waits for the channel events of all added clients with epoll on Linux,
+ * kqueue on BSD and macOS, and poll() elsewhere, so the number of clients isn't limited
+ * by FD_SETSIZE and a process doesn't need a thread per client.
+ *
+ * To integrate clients into an existing event loop instead, see
+ * @link kaa_client_get_descriptor @endlink.
+ */
+
+#ifndef KAA_REACTOR_H_
+#define KAA_REACTOR_H_
+
+#include <stdbool.h>
+
+#include "kaa_error.h"
+#include <platform/sock.h>
+#include <platform/time.h>
+#include <platform/kaa_client.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kaa_reactor_t;
+typedef struct kaa_reactor_t kaa_reactor_t;
+
+/**
+ * @brief Notifies about the I/O events of a user descriptor.
+ *
+ * @param[in]   context     Callback's context.
+ * @param[in]   fd          The descriptor.
+ * @param[in]   readable    Whether the descriptor has become readable (or closed).
+ * @param[in]   writable    Whether the descriptor has become writable.
+ */
+typedef void (*kaa_reactor_fd_callback_fn)(void *context, kaa_fd_t fd, bool readable, bool writable);
+
+/**
+ * @brief Creates a reactor.
+ *
+ * @param[out]  reactor_p    Pointer to return the address of the reactor.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_create(kaa_reactor_t **reactor_p);
+
+/**
+ * @brief Destroys the reactor. Added clients and descriptors are neither stopped nor closed.
+ *
+ * @param[in]   reactor    The reactor.
+ */
+void kaa_reactor_destroy(kaa_reactor_t *reactor);
+
+/**
+ * @brief Adds a Kaa client to the reactor.
+ *
+ * The client is processed by the reactor instead of @link kaa_client_start @endlink.
+ * A client stopped by @link kaa_client_stop @endlink is skipped until it is removed.
+ *
+ * @param[in]   reactor       The reactor.
+ * @param[in]   kaa_client    The client, its profile must be set.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_add_client(kaa_reactor_t *reactor, kaa_client_t *kaa_client);
+
+/**
+ * @brief Removes a Kaa client from the reactor. Must be called before the client is destroyed.
+ *
+ * @return Error code, KAA_ERR_NOT_FOUND if the client wasn't added.
+ */
+kaa_error_t kaa_reactor_remove_client(kaa_reactor_t *reactor, kaa_client_t *kaa_client);
+
+/**
+ * @brief Adds a user descriptor to the reactor.
+ *
+ * @param[in]   reactor        The reactor.
+ * @param[in]   fd             The descriptor, it can be added once.
+ * @param[in]   wants_read     Whether to wait for the descriptor to become readable.
+ * @param[in]   wants_write    Whether to wait for the descriptor to become writable.
+ * @param[in]   callback       The callback invoked from @link kaa_reactor_process @endlink.
+ * @param[in]   context        The callback's context.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_add_fd(kaa_reactor_t *reactor, kaa_fd_t fd, bool wants_read, bool wants_write
+                             , kaa_reactor_fd_callback_fn callback, void *context);
+
+/**
+ * @brief Changes the events the reactor waits for on a user descriptor.
+ *
+ * @return Error code, KAA_ERR_NOT_FOUND if the descriptor wasn't added.
+ */
+kaa_error_t kaa_reactor_modify_fd(kaa_reactor_t *reactor, kaa_fd_t fd, bool wants_read, bool wants_write);
+
+/**
+ * @brief Removes a user descriptor from the reactor. Must be called before the descriptor is closed.
+ *
+ * @return Error code, KAA_ERR_NOT_FOUND if the descriptor wasn't added.
+ */
+kaa_error_t kaa_reactor_remove_fd(kaa_reactor_t *reactor, kaa_fd_t fd);
+
+/**
+ * @brief Runs one iteration of the reactor.
+ *
+ * Waits for the events of all clients and user descriptors, at most @p max_wait seconds
+ * or less if a client needs processing sooner, then dispatches the events and processes
+ * every client. Clients and descriptors may be added and removed from the callbacks.
+ *
+ * @param[in]   reactor     The reactor.
+ * @param[in]   max_wait    The maximum time to wait in seconds.
+ *
+ * @return Error code, KAA_ERR_BAD_STATE if waiting for the events failed.
+ */
+kaa_error_t kaa_reactor_process(kaa_reactor_t *reactor, kaa_time_t max_wait);
+
+/**
+ * @brief Runs the reactor until @link kaa_reactor_stop @endlink is called.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_run(kaa_reactor_t *reactor);
+
+/**
+ * @brief Makes @link kaa_reactor_run @endlink return after the current iteration.
+ * Can be called from the client and descriptor callbacks.
+ */
+kaa_error_t kaa_reactor_stop(kaa_reactor_t *reactor);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_REACTOR_H_ */
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa_private.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "kaa_common.h"
+#include "kaa_context.h"
+#include "kaa_platform_protocol.h"
+#include "kaa_platform_common.h"
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+#include "kaa_shm_channel.h"
+
+
+#define KAA_SHM_CHANNEL_TRANSPORT_PROTOCOL_ID         0x4B53484D
+#define KAA_SHM_CHANNEL_TRANSPORT_PROTOCOL_VERSION    1
+
+/* Keeps the indexes written by different processes on different cache lines */
+#define KAA_SHM_CHANNEL_LINE        64
+
+#define KAA_SHM_CHANNEL_ALIGN(size) (((size) + 3) & ~(size_t)3)
+
+
+
+typedef struct {
+    uint32_t    value;
+    uint8_t     padding[KAA_SHM_CHANNEL_LINE - sizeof(uint32_t)];
+} kaa_shm_index_t;
+
+typedef struct {
+    uint32_t           magic;
+    uint32_t           version;
+    uint32_t           ring_size;
+    uint32_t           platform_protocol_id;
+    uint8_t            padding[KAA_SHM_CHANNEL_LINE - 4 * sizeof(uint32_t)];
+    kaa_shm_index_t    uplink_write;
+    kaa_shm_index_t    uplink_read;
+    kaa_shm_index_t    downlink_write;
+    kaa_shm_index_t    downlink_read;
+} kaa_shm_header_t;
+
+typedef struct {
+    uint32_t    *write_index;
+    uint32_t    *read_index;
+    uint8_t     *data;
+    uint32_t    size;
+} kaa_shm_ring_t;
+
+typedef struct {
+    kaa_logger_t                   *logger;
+    kaa_transport_context_t        transport_context;
+    kaa_transport_protocol_id_t    protocol_id;
+    kaa_extension_id               *supported_services;
+    size_t                         supported_service_count;
+    uint32_t                       pending_services;    /* Bitmask of extension ids waiting for a sync */
+    uint8_t                        *pending_sync;       /* Serialized sync that didn't fit into the uplink */
+    size_t                         pending_sync_size;
+    char                           *name;
+    bool                           owner;
+    kaa_shm_header_t               *header;
+    size_t                         segment_size;
+    kaa_shm_ring_t                 uplink;
+    kaa_shm_ring_t                 downlink;
+} kaa_shm_channel_t;
+
+
+
+static kaa_error_t kaa_shm_channel_get_transport_protocol_info(void *context, kaa_transport_protocol_id_t *protocol_info);
+static kaa_error_t kaa_shm_channel_get_supported_services(void *context, const kaa_extension_id **supported_services, size_t *service_count);
+static kaa_error_t kaa_shm_channel_sync_handler(void *context, const kaa_extension_id services[], size_t service_count);
+static kaa_error_t kaa_shm_channel_destroy_context(void *context);
+static kaa_error_t kaa_shm_channel_init(void *context, kaa_transport_context_t *transport_context);
+static kaa_error_t kaa_shm_channel_set_access_point(void *context, kaa_access_point_t *access_point);
+
+static kaa_error_t kaa_shm_channel_attach(kaa_shm_channel_t *self, size_t ring_size);
+static kaa_error_t kaa_shm_channel_flush(kaa_shm_channel_t *self);
+
+
+
+/*
+ * Appends a record to the ring. Returns KAA_ERR_BUFFER_IS_NOT_ENOUGH if the reader
+ * hasn't freed enough space yet.
+ */
+static kaa_error_t kaa_shm_ring_push(kaa_shm_ring_t *ring, const uint8_t *data, size_t size)
+{
+    size_t record_size = sizeof(uint32_t) + KAA_SHM_CHANNEL_ALIGN(size);
+    if (record_size > ring->size / 2) {
+        return KAA_ERR_BADPARAM;
+    }
+
+    uint32_t write_index = __atomic_load_n(ring->write_index, __ATOMIC_RELAXED);
+    uint32_t read_index = __atomic_load_n(ring->read_index, __ATOMIC_ACQUIRE);
+
+    uint32_t offset = write_index & (ring->size - 1);
+    uint32_t tail_space = ring->size - offset;
+    uint32_t skipped = tail_space < record_size ? tail_space : 0;
+
+    if (ring->size - (uint32_t)(write_index - read_index) < skipped + record_size) {
+        return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
+    }
+
+    if (skipped) {
+        *(uint32_t *)(ring->data + offset) = KAA_SHM_CHANNEL_PAD;
+        write_index += skipped;
+        offset = 0;
+    }
+
+    *(uint32_t *)(ring->data + offset) = (uint32_t)size;
+    memcpy(ring->data + offset + sizeof(uint32_t), data, size);
+
+    __atomic_store_n(ring->write_index, write_index + (uint32_t)record_size, __ATOMIC_RELEASE);
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_shm_channel_create(kaa_transport_channel_interface_t *self,
+        kaa_logger_t *logger, const char *name, size_t ring_size,
+        const kaa_extension_id *supported_services, size_t supported_service_count)
+{
+    KAA_RETURN_IF_NIL5(self, logger, name, supported_services, supported_service_count, KAA_ERR_BADPARAM);
+
+    if (ring_size < KAA_SHM_CHANNEL_LINE || ring_size > UINT32_MAX / 2 || (ring_size & (ring_size - 1))) {
+        KAA_LOG_ERROR(logger, KAA_ERR_BADPARAM, "Shared memory ring size %zu is not a power of two", ring_size);
+        return KAA_ERR_BADPARAM;
+    }
+
+    kaa_shm_channel_t *channel = KAA_CALLOC(1, sizeof(kaa_shm_channel_t));
+    KAA_RETURN_IF_NIL(channel, KAA_ERR_NOMEM);
+
+    channel->logger = logger;
+    channel->protocol_id.id = KAA_SHM_CHANNEL_TRANSPORT_PROTOCOL_ID;
+    channel->protocol_id.version = KAA_SHM_CHANNEL_TRANSPORT_PROTOCOL_VERSION;
+
+    channel->supported_services = KAA_MALLOC(supported_service_count * sizeof(kaa_extension_id));
+    channel->name = KAA_MALLOC(strlen(name) + 1);
+    if (!channel->supported_services || !channel->name) {
+        KAA_LOG_ERROR(logger, KAA_ERR_NOMEM, "Failed to create shared memory channel");
+        kaa_shm_channel_destroy_context(channel);
+        return KAA_ERR_NOMEM;
+    }
+    memcpy(channel->supported_services, supported_services, supported_service_count * sizeof(kaa_extension_id));
+    channel->supported_service_count = supported_service_count;
+    strcpy(channel->name, name);
+
+    kaa_error_t error_code = kaa_shm_channel_attach(channel, ring_size);
+    if (error_code) {
+        kaa_shm_channel_destroy_context(channel);
+        return error_code;
+    }
+
+    self->context = channel;
+    self->get_protocol_id = kaa_shm_channel_get_transport_protocol_info;
+    self->get_supported_services = kaa_shm_channel_get_supported_services;
+    self->destroy = kaa_shm_channel_destroy_context;
+    self->sync_handler = kaa_shm_channel_sync_handler;
+    self->init = kaa_shm_channel_init;
+    self->set_access_point = kaa_shm_channel_set_access_point;
+
+    KAA_LOG_TRACE(logger, KAA_ERR_NONE, "Shared memory channel '%s' created (ring size %zu, %s)",
+            name, ring_size, channel->owner ? "created" : "attached");
+
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * Creates the segment or attaches to an existing one. The creator publishes
+ * the magic last, so a half-initialized segment is never accepted.
+ */
+kaa_error_t kaa_shm_channel_attach(kaa_shm_channel_t *self, size_t ring_size)
+{
+    size_t segment_size = sizeof(kaa_shm_header_t) + 2 * ring_size;
+
+    int fd = shm_open(self->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    self->owner = fd >= 0;
+    if (fd < 0 && errno == EEXIST) {
+        fd = shm_open(self->name, O_RDWR, 0);
+    }
+    if (fd < 0) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_NOT_FOUND, "Failed to open shared memory '%s' (errno %d)", self->name, errno);
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    struct stat info;
+    if (self->owner ? ftruncate(fd, (off_t)segment_size) : fstat(fd, &info)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_STATE, "Failed to size shared memory '%s' (errno %d)", self->name, errno);
+        close(fd);
+        return KAA_ERR_BAD_STATE;
+    }
+    if (!self->owner && (size_t)info.st_size != segment_size) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_STATE, "Shared memory '%s' has %lld bytes, %zu expected",
+                self->name, (long long)info.st_size, segment_size);
+        close(fd);
+        return KAA_ERR_BAD_STATE;
+    }
+
+    void *segment = mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_NOMEM, "Failed to map shared memory '%s' (errno %d)", self->name, errno);
+        return KAA_ERR_NOMEM;
+    }
+    self->header = segment;
+    self->segment_size = segment_size;
+
+    if (self->owner) {
+        /* ftruncate() zeroes the segment, the indexes start at 0 */
+        self->header->version = KAA_SHM_CHANNEL_VERSION;
+        self->header->ring_size = (uint32_t)ring_size;
+        self->header->platform_protocol_id = KAA_PLATFORM_PROTOCOL_ID;
+        __atomic_store_n(&self->header->magic, KAA_SHM_CHANNEL_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&self->header->magic, __ATOMIC_ACQUIRE) != KAA_SHM_CHANNEL_MAGIC
+            || self->header->version != KAA_SHM_CHANNEL_VERSION
+            || self->header->ring_size != ring_size
+            || self->header->platform_protocol_id != KAA_PLATFORM_PROTOCOL_ID) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_PROTOCOL_VERSION, "Shared memory '%s' has unexpected layout", self->name);
+        return KAA_ERR_BAD_PROTOCOL_VERSION;
+    }
+
+    uint8_t *rings = (uint8_t *)segment + sizeof(kaa_shm_header_t);
+
+    self->uplink.write_index = &self->header->uplink_write.value;
+    self->uplink.read_index = &self->header->uplink_read.value;
+    self->uplink.data = rings;
+    self->uplink.size = (uint32_t)ring_size;
+
+    self->downlink.write_index = &self->header->downlink_write.value;
+    self->downlink.read_index = &self->header->downlink_read.value;
+    self->downlink.data = rings + ring_size;
+    self->downlink.size = (uint32_t)ring_size;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_shm_channel_get_transport_protocol_info(void *context, kaa_transport_protocol_id_t *protocol_info)
+{
+    KAA_RETURN_IF_NIL2(context, protocol_info, KAA_ERR_BADPARAM);
+    *protocol_info = ((kaa_shm_channel_t *) context)->protocol_id;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_shm_channel_get_supported_services(void *context, const kaa_extension_id **supported_services, size_t *service_count)
+{
+    KAA_RETURN_IF_NIL3(context, supported_services, service_count, KAA_ERR_BADPARAM);
+    kaa_shm_channel_t *channel = (kaa_shm_channel_t *) context;
+
+    *supported_services = channel->supported_services;
+    *service_count = channel->supported_service_count;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_shm_channel_sync_handler(void *context, const kaa_extension_id services[], size_t service_count)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    kaa_shm_channel_t *channel = (kaa_shm_channel_t *) context;
+
+    for (size_t i = 0; i < service_count; ++i) {
+        channel->pending_services |= 1u << services[i];
+    }
+
+    return kaa_shm_channel_flush(channel);
+}
+
+
+
+kaa_error_t kaa_shm_channel_destroy_context(void *context)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    kaa_shm_channel_t *channel = (kaa_shm_channel_t *) context;
+
+    if (channel->header) {
+        munmap(channel->header, channel->segment_size);
+    }
+    if (channel->owner) {
+        shm_unlink(channel->name);
+    }
+
+    KAA_FREE(channel->pending_sync);
+    KAA_FREE(channel->supported_services);
+    KAA_FREE(channel->name);
+    KAA_FREE(channel);
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_shm_channel_init(void *context, kaa_transport_context_t *transport_context)
+{
+    KAA_RETURN_IF_NIL3(context, transport_context, transport_context->kaa_context, KAA_ERR_BADPARAM);
+    ((kaa_shm_channel_t *) context)->transport_context = *transport_context;
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * The proxy owns the upstream connection, there is nothing to connect to.
+ */
+kaa_error_t kaa_shm_channel_set_access_point(void *context, kaa_access_point_t *access_point)
+{
+    (void)context;
+    (void)access_point;
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * Serializes the pending services unless the previous sync is still waiting
+ * for the uplink space, then tries to write it.
+ */
+kaa_error_t kaa_shm_channel_flush(kaa_shm_channel_t *self)
+{
+    KAA_RETURN_IF_NIL(self->transport_context.kaa_context, KAA_ERR_NOT_INITIALIZED);
+
+    if (!self->pending_sync && self->pending_services) {
+        kaa_extension_id services[KAA_EXTENSION_ID_COUNT];
+        size_t service_count = 0;
+        for (size_t id = 0; id < KAA_EXTENSION_ID_COUNT; ++id) {
+            if (self->pending_services & (1u << id)) {
+                services[service_count++] = (kaa_extension_id)id;
+            }
+        }
+
+        kaa_error_t error_code = kaa_platform_protocol_alloc_serialize_client_sync(
+                self->transport_context.kaa_context->platform_protocol, services, service_count,
+                &self->pending_sync, &self->pending_sync_size);
+        if (error_code) {
+            KAA_LOG_ERROR(self->logger, error_code, "Shared memory channel '%s' failed to serialize client sync", self->name);
+            return error_code;
+        }
+        self->pending_services = 0;
+    }
+
+    KAA_RETURN_IF_NIL(self->pending_sync, KAA_ERR_NONE);
+
+    kaa_error_t error_code = kaa_shm_ring_push(&self->uplink, self->pending_sync, self->pending_sync_size);
+    if (error_code == KAA_ERR_BUFFER_IS_NOT_ENOUGH) {
+        KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Shared memory channel '%s' uplink is full, %zu bytes postponed",
+                self->name, self->pending_sync_size);
+        return KAA_ERR_NONE;
+    }
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Shared memory channel '%s' can't fit %zu bytes sync into the ring",
+                self->name, self->pending_sync_size);
+    } else {
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Shared memory channel '%s' sent client sync (%zu bytes)",
+                self->name, self->pending_sync_size);
+    }
+
+    KAA_FREE(self->pending_sync);
+    self->pending_sync = NULL;
+    self->pending_sync_size = 0;
+    return error_code;
+}
+
+
+
+kaa_error_t kaa_shm_channel_process(kaa_transport_channel_interface_t *self)
+{
+    KAA_RETURN_IF_NIL2(self, self->context, KAA_ERR_BADPARAM);
+    kaa_shm_channel_t *channel = (kaa_shm_channel_t *) self->context;
+    KAA_RETURN_IF_NIL(channel->transport_context.kaa_context, KAA_ERR_NOT_INITIALIZED);
+
+    kaa_error_t error_code = kaa_shm_channel_flush(channel);
+
+    kaa_shm_ring_t *ring = &channel->downlink;
+    uint32_t read_index = __atomic_load_n(ring->read_index, __ATOMIC_RELAXED);
+    uint32_t write_index = __atomic_load_n(ring->write_index, __ATOMIC_ACQUIRE);
+
+    while (read_index != write_index) {
+        uint32_t offset = read_index & (ring->size - 1);
+        uint32_t size = *(const uint32_t *)(ring->data + offset);
+
+        if (size == KAA_SHM_CHANNEL_PAD) {
+            read_index += ring->size - offset;
+            __atomic_store_n(ring->read_index, read_index, __ATOMIC_RELEASE);
+            continue;
+        }
+        if (size > ring->size - offset - sizeof(uint32_t)) {
+            KAA_LOG_ERROR(channel->logger, KAA_ERR_BADDATA, "Shared memory channel '%s' downlink is corrupted", channel->name);
+            return KAA_ERR_BADDATA;
+        }
+
+        kaa_error_t sync_error = kaa_platform_protocol_process_server_sync(
+                channel->transport_context.kaa_context->platform_protocol,
+                ring->data + offset + sizeof(uint32_t), size);
+        if (sync_error) {
+            KAA_LOG_ERROR(channel->logger, sync_error, "Shared memory channel '%s' failed to process server sync", channel->name);
+        }
+
+        read_index += sizeof(uint32_t) + KAA_SHM_CHANNEL_ALIGN(size);
+        __atomic_store_n(ring->read_index, read_index, __ATOMIC_RELEASE);
+    }
+
+    return error_code;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file kaa_shm_channel.h
+ * @brief Transport channel that hands sync requests to a local proxy through shared memory.
+ *
+ * Endpoints running as separate processes on one gateway share a single upstream
+ * connection owned by a multiplexing proxy. Each endpoint creates a POSIX shared
+ * memory segment and exchanges raw client and server syncs with the proxy through
+ * two single-producer single-consumer rings in it, so no handshakes, keepalives or
+ * encryption are done by the endpoint itself.
+ *
+ * Segment layout (all fields in host byte order):
+ *
+ * | Offset | Size        | Field                                          |
+ * |--------|-------------|------------------------------------------------|
+ * | 0      | 4           | Magic, @link KAA_SHM_CHANNEL_MAGIC @endlink    |
+ * | 4      | 4           | Layout version                                 |
+ * | 8      | 4           | Size of each ring, a power of two              |
+ * | 12     | 4           | Platform protocol id of the syncs              |
+ * | 64     | 4           | Uplink write index (endpoint)                  |
+ * | 128    | 4           | Uplink read index (proxy)                      |
+ * | 192    | 4           | Downlink write index (proxy)                   |
+ * | 256    | 4           | Downlink read index (endpoint)                 |
+ * | 320    | ring size   | Uplink ring: client syncs                      |
+ * | ...    | ring size   | Downlink ring: server syncs                    |
+ *
+ * The indexes are free-running byte counters, published with release and read
+ * with acquire semantics. A record is a 4-byte length followed by the payload,
+ * padded to 4 bytes. Records never wrap: a length of
+ * @link KAA_SHM_CHANNEL_PAD @endlink tells the reader to skip to the ring start.
+ *
+ * The proxy is expected to open the segment by name, ignore endpoints with an
+ * unknown magic or version and pass the platform protocol id upstream on their behalf.
+ */
+
+#ifndef KAA_SHM_CHANNEL_H_
+#define KAA_SHM_CHANNEL_H_
+
+#include "kaa_error.h"
+#include "platform/ext_transport_channel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KAA_SHM_CHANNEL_MAGIC       0x4D48534B  /* "KSHM" */
+#define KAA_SHM_CHANNEL_VERSION     1
+#define KAA_SHM_CHANNEL_PAD         0xFFFFFFFF
+
+
+
+/**
+ * @brief Creates a shared memory channel instance.
+ *
+ * Creates the segment @p name, or attaches to it if it already exists with the same
+ * ring size. The segment is removed when the channel that created it is destroyed.
+ *
+ * The proxy doesn't appear among the access points, so
+ * @link kaa_channel_manager_add_transport_channel @endlink returns KAA_ERR_BAD_STATE
+ * for this channel. The channel is added nevertheless and takes syncs right away.
+ *
+ * @param[in]   self                       The pointer to the channel instance.
+ * @param[in]   logger                     The pointer to the Kaa logger instance.
+ * @param[in]   name                       The segment name, e.g. "/kaa-endpoint-1".
+ * @param[in]   ring_size                  The size of each ring in bytes, a power of two.
+ * @param[in]   supported_services         A list of supported services for this channel.
+ * @param[in]   supported_service_count    The number of services in the list.
+ *
+ * @return Error code
+ */
+kaa_error_t kaa_shm_channel_create(kaa_transport_channel_interface_t *self
+                                 , kaa_logger_t *logger
+                                 , const char *name
+                                 , size_t ring_size
+                                 , const kaa_extension_id *supported_services
+                                 , size_t supported_service_count);
+
+
+/**
+ * @brief Moves the data between the rings and the SDK.
+ *
+ * Writes the client sync that did not fit into the uplink ring on the previous
+ * attempt, then processes all server syncs waiting in the downlink ring.
+ * Should be called periodically from the application loop.
+ *
+ * @param[in]   self    The channel instance.
+ *
+ * @return Error code
+ */
+kaa_error_t kaa_shm_channel_process(kaa_transport_channel_interface_t *self);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_SHM_CHANNEL_H_ */
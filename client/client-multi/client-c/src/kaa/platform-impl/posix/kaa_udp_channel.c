@@ -0,0 +1,848 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa_private.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "kaa_common.h"
+#include "kaa_context.h"
+#include "kaa_channel_manager.h"
+#include "kaa_platform_protocol.h"
+#include "kaa_platform_common.h"
+#include "kaa_protocols/kaa_tcp/kaatcp.h"
+#include "platform/ext_encryption_utils.h"
+#include <platform/time.h>
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+#include "utilities/kaa_scratch.h"
+#include "kaa_udp_channel.h"
+
+
+#define KAA_UDP_CHANNEL_TRANSPORT_PROTOCOL_ID         0x4B554450
+#define KAA_UDP_CHANNEL_TRANSPORT_PROTOCOL_VERSION    1
+
+#define KAA_UDP_CHANNEL_CONNECT_MESSAGE_ID            0
+
+
+
+typedef enum {
+    KAA_UDP_SESSION_NONE = 0,
+    KAA_UDP_SESSION_CONNECTING,
+    KAA_UDP_SESSION_ESTABLISHED
+} kaa_udp_session_state_t;
+
+typedef struct {
+    uint32_t                id;
+    uint8_t                 *public_key;
+    uint32_t                public_key_length;
+    char                    *hostname;
+    uint32_t                hostname_length;
+    uint16_t                port;
+    bool                    resolved;
+    kaa_sockaddr_storage_t  sockaddr;
+    kaa_socklen_t           sockaddr_length;
+} kaa_udp_access_point_t;
+
+/* The request waiting for its response */
+typedef struct {
+    uint8_t       datagram[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+    size_t        size;                 /* 0 - there is no request in flight */
+    uint16_t      message_id;
+    uint32_t      services;             /* Bitmask of the extension ids in the request */
+    size_t        retransmit_count;
+    kaa_time_t    timeout;
+    kaa_time_t    resend_time;
+} kaa_udp_request_t;
+
+typedef struct {
+    uint8_t *aes_session_key;
+    size_t   aes_session_key_size;
+    uint8_t *signature;
+    size_t   signature_size;
+} kaa_udp_encrypt_t;
+
+typedef struct {
+    kaa_logger_t                   *logger;
+    kaa_transport_context_t        transport_context;
+    kaa_transport_protocol_id_t    protocol_id;
+    kaa_server_type_t              channel_operation_type;
+    kaa_extension_id               *supported_services;
+    size_t                         supported_service_count;
+    uint32_t                       pending_services;    /* Bitmask of extension ids waiting for a sync */
+    kaa_udp_access_point_t         access_point;
+    kaa_fd_t                       socket_descriptor;
+    kaa_udp_session_state_t        session_state;
+    kaa_time_t                     last_activity;       /* When the server was last heard from */
+    uint16_t                       message_id;
+    kaa_udp_request_t              request;
+    uint8_t                        response[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+    kaa_scratch_t                  *scratch;            /* Per-sync temporaries, reset after each request. */
+    kaatcp_parser_t                parser;
+    kaa_udp_encrypt_t              encryption;
+} kaa_udp_channel_t;
+
+
+
+static kaa_error_t kaa_udp_channel_get_transport_protocol_info(void *context, kaa_transport_protocol_id_t *protocol_info);
+static kaa_error_t kaa_udp_channel_get_supported_services(void *context, const kaa_extension_id **supported_services, size_t *service_count);
+static kaa_error_t kaa_udp_channel_sync_handler(void *context, const kaa_extension_id services[], size_t service_count);
+static kaa_error_t kaa_udp_channel_destroy_context(void *context);
+static kaa_error_t kaa_udp_channel_init(void *context, kaa_transport_context_t *transport_context);
+static kaa_error_t kaa_udp_channel_set_access_point(void *context, kaa_access_point_t *access_point);
+
+static void kaa_udp_channel_connack_message_callback(void *context, kaatcp_connack_t message);
+static void kaa_udp_channel_disconnect_message_callback(void *context, kaatcp_disconnect_t message);
+static void kaa_udp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *message);
+static void kaa_udp_channel_pingresp_message_callback(void *context);
+
+static kaa_error_t kaa_udp_channel_resolve(kaa_udp_channel_t *self);
+static void kaa_udp_channel_release_access_point(kaa_udp_channel_t *self);
+static kaa_error_t kaa_udp_channel_send_pending_services(kaa_udp_channel_t *self);
+static void kaa_udp_channel_transmit(kaa_udp_channel_t *self);
+static kaa_error_t kaa_udp_channel_receive(kaa_udp_channel_t *self);
+static kaa_error_t kaa_udp_channel_on_access_point_failed(kaa_udp_channel_t *self, kaa_failover_reason reason_code);
+
+
+
+/*
+ * Read uint32 value from buffer.
+ */
+static uint32_t get_uint32_t(const uint8_t *buffer)
+{
+    uint32_t value = 0;
+    memcpy(&value, buffer, sizeof(value));
+    return KAA_NTOHL(value);
+}
+
+
+
+kaa_error_t kaa_udp_channel_create(kaa_transport_channel_interface_t *self,
+        kaa_logger_t *logger, const kaa_extension_id *supported_services,
+        size_t supported_service_count)
+{
+    KAA_RETURN_IF_NIL4(self, logger, supported_services, supported_service_count, KAA_ERR_BADPARAM);
+
+    kaa_udp_channel_t *channel = KAA_CALLOC(1, sizeof(kaa_udp_channel_t));
+    KAA_RETURN_IF_NIL(channel, KAA_ERR_NOMEM);
+
+    channel->logger = logger;
+    channel->socket_descriptor = KAA_TCP_SOCKET_NOT_SET;
+    channel->protocol_id.id = KAA_UDP_CHANNEL_TRANSPORT_PROTOCOL_ID;
+    channel->protocol_id.version = KAA_UDP_CHANNEL_TRANSPORT_PROTOCOL_VERSION;
+    channel->channel_operation_type = KAA_SERVER_OPERATIONS;
+
+    channel->supported_services = KAA_MALLOC(supported_service_count * sizeof(kaa_extension_id));
+    if (!channel->supported_services) {
+        KAA_LOG_ERROR(logger, KAA_ERR_NOMEM, "Failed to copy supported services");
+        kaa_udp_channel_destroy_context(channel);
+        return KAA_ERR_NOMEM;
+    }
+    memcpy(channel->supported_services, supported_services, supported_service_count * sizeof(kaa_extension_id));
+    channel->supported_service_count = supported_service_count;
+
+    for (size_t i = 0; i < supported_service_count; ++i) {
+        if (supported_services[i] == KAA_EXTENSION_BOOTSTRAP) {
+            channel->channel_operation_type = KAA_SERVER_BOOTSTRAP;
+        }
+    }
+
+    kaa_error_t error_code = kaa_scratch_create(&channel->scratch, KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE);
+    if (error_code) {
+        KAA_LOG_ERROR(logger, error_code, "Failed to create scratch arena for channel");
+        kaa_udp_channel_destroy_context(channel);
+        return error_code;
+    }
+
+    kaatcp_parser_handlers_t parser_handler;
+    memset(&parser_handler, 0, sizeof(parser_handler));
+    parser_handler.connack_handler    = kaa_udp_channel_connack_message_callback;
+    parser_handler.disconnect_handler = kaa_udp_channel_disconnect_message_callback;
+    parser_handler.kaasync_handler    = kaa_udp_channel_kaasync_message_callback;
+    parser_handler.pingresp_handler   = kaa_udp_channel_pingresp_message_callback;
+    parser_handler.handlers_context   = channel;
+
+    kaatcp_parser_init(&channel->parser, &parser_handler);
+    /* A datagram is parsed in place, a longer message is never complete */
+    channel->parser.max_message_length = KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE;
+
+    self->context = channel;
+    self->get_protocol_id = kaa_udp_channel_get_transport_protocol_info;
+    self->get_supported_services = kaa_udp_channel_get_supported_services;
+    self->destroy = kaa_udp_channel_destroy_context;
+    self->sync_handler = kaa_udp_channel_sync_handler;
+    self->init = kaa_udp_channel_init;
+    self->set_access_point = kaa_udp_channel_set_access_point;
+
+    KAA_LOG_TRACE(logger, KAA_ERR_NONE, "Kaa UDP channel created (protocol: id=0x%08X, version=%u)",
+            channel->protocol_id.id, channel->protocol_id.version);
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_udp_channel_get_transport_protocol_info(void *context, kaa_transport_protocol_id_t *protocol_info)
+{
+    KAA_RETURN_IF_NIL2(context, protocol_info, KAA_ERR_BADPARAM);
+    *protocol_info = ((kaa_udp_channel_t *) context)->protocol_id;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_udp_channel_get_supported_services(void *context, const kaa_extension_id **supported_services, size_t *service_count)
+{
+    KAA_RETURN_IF_NIL3(context, supported_services, service_count, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    *supported_services = channel->supported_services;
+    *service_count = channel->supported_service_count;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * The services are merged into the next request, which is sent right away
+ * unless another one is still in flight.
+ */
+kaa_error_t kaa_udp_channel_sync_handler(void *context, const kaa_extension_id services[], size_t service_count)
+{
+    KAA_RETURN_IF_NIL2(context, services, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    for (size_t i = 0; i < service_count; ++i) {
+        if ((size_t)services[i] >= KAA_EXTENSION_ID_COUNT) {
+            return KAA_ERR_BADPARAM;
+        }
+        channel->pending_services |= (uint32_t)1 << services[i];
+    }
+
+    return kaa_udp_channel_send_pending_services(channel);
+}
+
+
+
+kaa_error_t kaa_udp_channel_destroy_context(void *context)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    kaa_udp_channel_release_access_point(channel);
+
+    /* The session key and the signature belong to the encryption utils */
+    channel->encryption.aes_session_key = NULL;
+    channel->encryption.signature = NULL;
+
+    if (channel->scratch) {
+        kaa_scratch_destroy(channel->scratch);
+    }
+    KAA_FREE(channel->supported_services);
+    KAA_FREE(channel);
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_udp_channel_init(void *context, kaa_transport_context_t *transport_context)
+{
+    KAA_RETURN_IF_NIL3(context, transport_context, transport_context->kaa_context, KAA_ERR_BADPARAM);
+    ((kaa_udp_channel_t *) context)->transport_context = *transport_context;
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * Parses the connection data, which has the same layout as for the Kaa TCP
+ * channel: the public key, the hostname and the port, each preceded by its length.
+ */
+kaa_error_t kaa_udp_channel_set_access_point(void *context, kaa_access_point_t *access_point)
+{
+    KAA_RETURN_IF_NIL2(context, access_point, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    kaa_udp_channel_release_access_point(channel);
+    channel->access_point.id = access_point->id;
+
+    KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel new access point [0x%08X], connection data length %u",
+            channel->access_point.id, access_point->connection_data_len);
+
+    const uint8_t *connection_data = (const uint8_t *)access_point->connection_data;
+    size_t connection_data_len = access_point->connection_data_len;
+    size_t position = 0;
+    kaa_error_t error = KAA_ERR_INSUFFICIENT_BUFFER;
+
+    if (position + sizeof(uint32_t) > connection_data_len) {
+        goto cleanup;
+    }
+    channel->access_point.public_key_length = get_uint32_t(connection_data + position);
+    position += sizeof(uint32_t);
+
+    if (channel->access_point.public_key_length > connection_data_len - position) {
+        goto cleanup;
+    }
+    channel->access_point.public_key = KAA_MALLOC(channel->access_point.public_key_length + 1);
+    if (!channel->access_point.public_key) {
+        error = KAA_ERR_NOMEM;
+        goto cleanup;
+    }
+    memcpy(channel->access_point.public_key, connection_data + position, channel->access_point.public_key_length);
+    position += channel->access_point.public_key_length;
+
+    if (position + sizeof(uint32_t) > connection_data_len) {
+        goto cleanup;
+    }
+    channel->access_point.hostname_length = get_uint32_t(connection_data + position);
+    position += sizeof(uint32_t);
+
+    if (channel->access_point.hostname_length > connection_data_len - position) {
+        goto cleanup;
+    }
+    channel->access_point.hostname = KAA_MALLOC(channel->access_point.hostname_length + 1);
+    if (!channel->access_point.hostname) {
+        error = KAA_ERR_NOMEM;
+        goto cleanup;
+    }
+    memcpy(channel->access_point.hostname, connection_data + position, channel->access_point.hostname_length);
+    position += channel->access_point.hostname_length;
+
+    if (position + sizeof(uint32_t) > connection_data_len) {
+        goto cleanup;
+    }
+    channel->access_point.port = (uint16_t) get_uint32_t(connection_data + position);
+
+    KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel new access point [0x%08X] destination %.*s:%u",
+            channel->access_point.id, (int)channel->access_point.hostname_length,
+            channel->access_point.hostname, channel->access_point.port);
+
+#ifdef KAA_ENCRYPTION
+    error = ext_get_encrypted_session_key(&channel->encryption.aes_session_key,
+            &channel->encryption.aes_session_key_size,
+            channel->access_point.public_key,
+            channel->access_point.public_key_length);
+    if (error) {
+        KAA_LOG_ERROR(channel->logger, error, "Can't get session key");
+        goto cleanup;
+    }
+
+    if (channel->channel_operation_type != KAA_SERVER_BOOTSTRAP) {
+        error = ext_get_signature(channel->encryption.aes_session_key, channel->encryption.aes_session_key_size,
+                &channel->encryption.signature, &channel->encryption.signature_size);
+        if (error) {
+            KAA_LOG_ERROR(channel->logger, error, "Can't get signature");
+            goto cleanup;
+        }
+    }
+#endif
+
+    /* A pending DNS resolve is finished by kaa_udp_channel_process() */
+    error = kaa_udp_channel_resolve(channel);
+    if (error == KAA_ERR_NONE && channel->access_point.resolved) {
+        error = kaa_udp_channel_send_pending_services(channel);
+    }
+    return error;
+
+cleanup:
+    kaa_udp_channel_release_access_point(channel);
+    return error;
+}
+
+
+
+/*
+ * Resolves the access point and opens the socket. The socket is connected,
+ * so datagrams from other peers are dropped by the system.
+ */
+kaa_error_t kaa_udp_channel_resolve(kaa_udp_channel_t *self)
+{
+    if (self->access_point.resolved || !self->access_point.hostname) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_dns_resolve_info_t resolve_props;
+    resolve_props.hostname = self->access_point.hostname;
+    resolve_props.hostname_length = self->access_point.hostname_length;
+    resolve_props.port = self->access_point.port;
+
+    self->access_point.sockaddr_length = sizeof(self->access_point.sockaddr);
+    ext_tcp_utils_function_return_state_t resolve_state = ext_tcp_utils_getaddrbyhost(NULL, &resolve_props,
+            (kaa_sockaddr_t *) &self->access_point.sockaddr, &self->access_point.sockaddr_length);
+
+    if (resolve_state == RET_STATE_VALUE_IN_PROGRESS) {
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] hostname is being resolved",
+                self->access_point.id);
+        return KAA_ERR_NONE;
+    }
+    if (resolve_state != RET_STATE_VALUE_READY) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_AP_RESOLVE_FAILED, "Kaa UDP channel [0x%08X] can't resolve %.*s",
+                self->access_point.id, (int)self->access_point.hostname_length, self->access_point.hostname);
+        kaa_udp_channel_on_access_point_failed(self, KAA_CHANNEL_NA);
+        return KAA_ERR_TCPCHANNEL_AP_RESOLVE_FAILED;
+    }
+
+    kaa_fd_t fd = socket(((kaa_sockaddr_t *) &self->access_point.sockaddr)->sa_family, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_SOCKET_ERROR, "Kaa UDP channel [0x%08X] failed to create socket (errno %d)",
+                self->access_point.id, errno);
+        return KAA_ERR_SOCKET_ERROR;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0
+            || connect(fd, (kaa_sockaddr_t *) &self->access_point.sockaddr, self->access_point.sockaddr_length)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_SOCKET_CONNECT_ERROR, "Kaa UDP channel [0x%08X] failed to set up socket (errno %d)",
+                self->access_point.id, errno);
+        close(fd);
+        return KAA_ERR_SOCKET_CONNECT_ERROR;
+    }
+
+    self->socket_descriptor = fd;
+    self->access_point.resolved = true;
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] hostname resolved", self->access_point.id);
+    return KAA_ERR_NONE;
+}
+
+
+
+void kaa_udp_channel_release_access_point(kaa_udp_channel_t *self)
+{
+    if (self->socket_descriptor != KAA_TCP_SOCKET_NOT_SET) {
+        close(self->socket_descriptor);
+        self->socket_descriptor = KAA_TCP_SOCKET_NOT_SET;
+    }
+
+    KAA_FREE(self->access_point.public_key);
+    KAA_FREE(self->access_point.hostname);
+    memset(&self->access_point, 0, sizeof(self->access_point));
+
+    /* The server of another access point doesn't know the session */
+    self->session_state = KAA_UDP_SESSION_NONE;
+    self->pending_services |= self->request.services;
+    self->request.size = 0;
+    self->request.services = 0;
+}
+
+
+
+static kaa_error_t kaa_udp_channel_on_access_point_failed(kaa_udp_channel_t *self, kaa_failover_reason reason_code)
+{
+    KAA_RETURN_IF_NIL(self->transport_context.kaa_context, KAA_ERR_NOT_INITIALIZED);
+
+    kaa_error_t error_code = kaa_bootstrap_manager_on_access_point_failed(self->transport_context.kaa_context->bootstrap_manager,
+            &self->protocol_id, self->channel_operation_type, reason_code);
+
+    if (error_code != KAA_ERR_EVENT_NOT_ATTACHED) {
+        KAA_LOG_ERROR(self->logger, error_code, "Kaa UDP channel [0x%08X] "
+                "error notifying bootstrap manager on access point failure",
+                self->access_point.id);
+    }
+    return error_code;
+}
+
+
+
+/*
+ * Serializes the pending services into the next request: a CONNECT message with all
+ * supported services if there is no session, a KAASYNC message otherwise.
+ */
+kaa_error_t kaa_udp_channel_send_pending_services(kaa_udp_channel_t *self)
+{
+    if (self->request.size || !self->access_point.resolved || !self->transport_context.kaa_context) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_time_t now = KAA_TIME();
+    if (self->session_state == KAA_UDP_SESSION_ESTABLISHED
+            && now - self->last_activity > (kaa_time_t)KAA_UDP_CHANNEL_SESSION_TIMEOUT) {
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] session expired", self->access_point.id);
+        self->session_state = KAA_UDP_SESSION_NONE;
+    }
+
+    /* Without anything to sync the session is set up with the next request */
+    KAA_RETURN_IF_NIL(self->pending_services, KAA_ERR_NONE);
+    bool connect = self->session_state != KAA_UDP_SESSION_ESTABLISHED;
+
+    kaa_extension_id services[KAA_EXTENSION_ID_COUNT];
+    size_t service_count = 0;
+    uint32_t request_services = 0;
+
+    if (connect) {
+        /* CONNECT carries all supported services, so nothing is left pending */
+        for (size_t i = 0; i < self->supported_service_count; ++i) {
+            services[service_count++] = self->supported_services[i];
+            request_services |= (uint32_t)1 << self->supported_services[i];
+        }
+        request_services |= self->pending_services;
+    } else {
+        for (size_t id = 0; id < KAA_EXTENSION_ID_COUNT; ++id) {
+            if (self->pending_services & ((uint32_t)1 << id)) {
+                services[service_count++] = (kaa_extension_id)id;
+            }
+        }
+        request_services = self->pending_services;
+    }
+
+    uint8_t *sync_buffer = NULL;
+    size_t sync_size = 0;
+    kaa_error_t error_code = kaa_platform_protocol_scratch_serialize_client_sync(
+            self->transport_context.kaa_context->platform_protocol, self->scratch,
+            services, service_count, &sync_buffer, &sync_size, NULL);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Kaa UDP channel [0x%08X] failed to serialize client sync",
+                self->access_point.id);
+        kaa_scratch_reset(self->scratch);
+        return error_code;
+    }
+
+    bool encrypted = false;
+#ifdef KAA_ENCRYPTION
+    /* The client sync buffer has room for the padding */
+    error_code = ext_encrypt_data(sync_buffer, sync_size, sync_buffer);
+    if (error_code) {
+        KAA_LOG_ERROR(self->logger, error_code, "Can't encrypt the data");
+        kaa_scratch_reset(self->scratch);
+        return KAA_ERR_BADDATA;
+    }
+    sync_size = ext_get_encrypted_data_size(sync_size);
+    encrypted = true;
+#endif
+
+    self->pending_services = 0;
+
+    size_t datagram_size = sizeof(self->request.datagram);
+    kaatcp_error_t kaatcp_error_code;
+    uint16_t message_id = KAA_UDP_CHANNEL_CONNECT_MESSAGE_ID;
+
+    if (connect) {
+        kaatcp_connect_t connect_message;
+        kaatcp_error_code = kaatcp_fill_connect_message(KAA_UDP_CHANNEL_SESSION_TIMEOUT, KAA_PLATFORM_PROTOCOL_ID,
+                (char *)sync_buffer, sync_size, (char *)self->encryption.aes_session_key,
+                self->encryption.aes_session_key_size, (char *)self->encryption.signature,
+                self->encryption.signature_size, &connect_message);
+        if (!kaatcp_error_code) {
+            kaatcp_error_code = kaatcp_get_request_connect(&connect_message,
+                    (char *)self->request.datagram, &datagram_size);
+        }
+    } else {
+        if (++self->message_id == KAA_UDP_CHANNEL_CONNECT_MESSAGE_ID) {
+            ++self->message_id;
+        }
+        message_id = self->message_id;
+
+        kaatcp_kaasync_t kaasync_message;
+        kaatcp_error_code = kaatcp_fill_kaasync_message((char *)sync_buffer, sync_size, message_id,
+                false, encrypted, &kaasync_message);
+        if (!kaatcp_error_code) {
+            kaatcp_error_code = kaatcp_get_request_kaasync(&kaasync_message,
+                    (char *)self->request.datagram, &datagram_size);
+        }
+    }
+
+    kaa_scratch_reset(self->scratch);
+
+    if (kaatcp_error_code == KAATCP_ERR_BUFFER_NOT_ENOUGH) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BUFFER_IS_NOT_ENOUGH, "Kaa UDP channel [0x%08X] drops client sync of %zu bytes: "
+                "it doesn't fit into a datagram", self->access_point.id, sync_size);
+        return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
+    }
+    if (kaatcp_error_code) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa UDP channel [0x%08X] failed to serialize %s message",
+                self->access_point.id, connect ? "CONNECT" : "KAASYNC");
+        return KAA_ERR_TCPCHANNEL_PARSER_ERROR;
+    }
+
+    if (connect) {
+        self->session_state = KAA_UDP_SESSION_CONNECTING;
+    }
+
+    self->request.size = datagram_size;
+    self->request.message_id = message_id;
+    self->request.services = request_services;
+    self->request.retransmit_count = 0;
+    self->request.timeout = KAA_UDP_CHANNEL_ACK_TIMEOUT;
+
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] going to send %s message %u (%zu bytes)",
+            self->access_point.id, connect ? "CONNECT" : "KAASYNC", message_id, datagram_size);
+
+    kaa_udp_channel_transmit(self);
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * Sends the request in flight. A datagram the system didn't take is as good
+ * as lost, so the errors are left to the retransmission.
+ */
+void kaa_udp_channel_transmit(kaa_udp_channel_t *self)
+{
+    ssize_t sent = send(self->socket_descriptor, self->request.datagram, self->request.size, 0);
+    if (sent < 0) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_WRITE_FAILED, "Kaa UDP channel [0x%08X] failed to send message %u (errno %d)",
+                self->access_point.id, self->request.message_id, errno);
+    }
+
+    self->request.resend_time = KAA_TIME() + self->request.timeout;
+}
+
+
+
+/*
+ * Every datagram holds a whole message, so the parser starts over for each one.
+ */
+kaa_error_t kaa_udp_channel_receive(kaa_udp_channel_t *self)
+{
+    for (;;) {
+        ssize_t received = recv(self->socket_descriptor, self->response, sizeof(self->response), 0);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return KAA_ERR_NONE;
+            }
+            /* E.g. ECONNREFUSED after an ICMP port unreachable, the request is resent anyway */
+            KAA_LOG_WARN(self->logger, KAA_ERR_READ_FAILED, "Kaa UDP channel [0x%08X] failed to receive (errno %d)",
+                    self->access_point.id, errno);
+            return KAA_ERR_NONE;
+        }
+        if (!received) {
+            continue;
+        }
+
+        kaatcp_parser_reset(&self->parser);
+        kaatcp_error_t kaatcp_error_code = kaatcp_parser_process_buffer(&self->parser, (char *)self->response, (size_t)received);
+        if (kaatcp_error_code || self->parser.state != KAATCP_PARSER_STATE_NONE) {
+            KAA_LOG_WARN(self->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa UDP channel [0x%08X] dropped malformed datagram "
+                    "of %zd bytes (kaatcp_error_code=%d)", self->access_point.id, received, kaatcp_error_code);
+        }
+
+        /* A handler may have released the socket */
+        if (self->socket_descriptor == KAA_TCP_SOCKET_NOT_SET) {
+            return KAA_ERR_NONE;
+        }
+    }
+}
+
+
+
+kaa_error_t kaa_udp_channel_get_descriptor(kaa_transport_channel_interface_t *self, kaa_fd_t *fd_p)
+{
+    KAA_RETURN_IF_NIL3(self, self->context, fd_p, KAA_ERR_BADPARAM);
+    *fd_p = ((kaa_udp_channel_t *) self->context)->socket_descriptor;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t kaa_udp_channel_process(kaa_transport_channel_interface_t *self, bool readable)
+{
+    KAA_RETURN_IF_NIL2(self, self->context, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) self->context;
+    KAA_RETURN_IF_NIL(channel->transport_context.kaa_context, KAA_ERR_NOT_INITIALIZED);
+
+    kaa_error_t error_code = kaa_udp_channel_resolve(channel);
+    KAA_RETURN_IF_ERR(error_code);
+
+    if (readable && channel->socket_descriptor != KAA_TCP_SOCKET_NOT_SET) {
+        error_code = kaa_udp_channel_receive(channel);
+        KAA_RETURN_IF_ERR(error_code);
+    }
+
+    if (channel->request.size && KAA_TIME() >= channel->request.resend_time) {
+        if (channel->request.retransmit_count < KAA_UDP_CHANNEL_MAX_RETRANSMIT) {
+            ++channel->request.retransmit_count;
+            channel->request.timeout *= 2;
+
+            KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] resending message %u (attempt %zu)",
+                    channel->access_point.id, channel->request.message_id, channel->request.retransmit_count);
+            kaa_udp_channel_transmit(channel);
+        } else {
+            KAA_LOG_WARN(channel->logger, KAA_ERR_TIMEOUT, "Kaa UDP channel [0x%08X] got no response to message %u",
+                    channel->access_point.id, channel->request.message_id);
+
+            channel->request.size = 0;
+            channel->request.services = 0;
+            channel->session_state = KAA_UDP_SESSION_NONE;
+            kaa_udp_channel_on_access_point_failed(channel, KAA_CHANNEL_NA);
+            return KAA_ERR_TIMEOUT;
+        }
+    }
+
+    return kaa_udp_channel_send_pending_services(channel);
+}
+
+
+
+kaa_error_t kaa_udp_channel_get_max_timeout(kaa_transport_channel_interface_t *self, uint16_t *max_timeout)
+{
+    KAA_RETURN_IF_NIL3(self, self->context, max_timeout, KAA_ERR_BADPARAM);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) self->context;
+
+    if (channel->access_point.hostname && !channel->access_point.resolved) {
+        *max_timeout = 1;
+    } else if (channel->request.size) {
+        kaa_time_t now = KAA_TIME();
+        *max_timeout = channel->request.resend_time > now ? (uint16_t)(channel->request.resend_time - now) : 1;
+    } else {
+        *max_timeout = KAA_UDP_CHANNEL_SESSION_TIMEOUT;
+    }
+
+    return KAA_ERR_NONE;
+}
+
+
+
+void kaa_udp_channel_connack_message_callback(void *context, kaatcp_connack_t message)
+{
+    KAA_RETURN_IF_NIL(context,);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    if (channel->session_state != KAA_UDP_SESSION_CONNECTING) {
+        /* A duplicate of the CONNACK that has already been handled */
+        return;
+    }
+
+    channel->last_activity = KAA_TIME();
+
+    if (message.return_code == KAATCP_CONNACK_SUCCESS) {
+        KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] session established",
+                channel->access_point.id);
+        channel->session_state = KAA_UDP_SESSION_ESTABLISHED;
+        return;
+    }
+
+    /* The CONNECT is refused, there is no response to wait for */
+    channel->session_state = KAA_UDP_SESSION_NONE;
+    channel->request.size = 0;
+    channel->request.services = 0;
+
+    kaa_channel_manager_t *channel_manager = channel->transport_context.kaa_context->channel_manager;
+
+    if (message.return_code == KAATCP_CONNACK_REFUSE_BAD_CREDENTIALS) {
+        KAA_LOG_WARN(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] received KAATCP_CONNACK_REFUSE_BAD_CREDENTIALS",
+                channel->access_point.id);
+        kaa_context_set_status_registered(channel->transport_context.kaa_context, false);
+        kaa_channel_manager_process_auth_failure(channel_manager, KAA_AUTH_STATUS_BAD_CREDENTIALS);
+    } else if (message.return_code == KAATCP_CONNACK_REFUSE_VERIFICATION_FAILED) {
+        KAA_LOG_WARN(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] received KAATCP_CONNACK_REFUSE_VERIFICATION_FAILED",
+                channel->access_point.id);
+        kaa_channel_manager_process_auth_failure(channel_manager, KAA_AUTH_STATUS_VERIFICATION_FAILED);
+        kaa_udp_channel_on_access_point_failed(channel, KAA_ENDPOINT_NOT_REGISTERED);
+    } else {
+        KAA_LOG_ERROR(channel->logger, KAA_ERR_BAD_STATE, "Kaa UDP channel [0x%08X] authorization failed, code %d",
+                channel->access_point.id, message.return_code);
+        kaa_channel_manager_process_auth_failure(channel_manager, KAA_AUTH_STATUS_UNKNOWN);
+        kaa_udp_channel_on_access_point_failed(channel, KAA_CHANNEL_NA);
+    }
+}
+
+
+
+/*
+ * The server has dropped the session: the request in flight is sent again
+ * in a new one, unless the credentials are revoked.
+ */
+void kaa_udp_channel_disconnect_message_callback(void *context, kaatcp_disconnect_t message)
+{
+    KAA_RETURN_IF_NIL(context,);
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] DISCONNECT message received (reason %u)",
+            channel->access_point.id, message.reason);
+
+    channel->session_state = KAA_UDP_SESSION_NONE;
+    if (message.reason != KAATCP_DISCONNECT_CREDENTIALS_REVOKED) {
+        channel->pending_services |= channel->request.services;
+    }
+    channel->request.size = 0;
+    channel->request.services = 0;
+
+    if (message.reason == KAATCP_DISCONNECT_CREDENTIALS_REVOKED) {
+        kaa_udp_channel_on_access_point_failed(channel, KAA_CREDENTIALS_REVOKED);
+    }
+}
+
+
+
+void kaa_udp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *message)
+{
+    KAA_RETURN_IF_NIL2(context, message, );
+    kaa_udp_channel_t *channel = (kaa_udp_channel_t *) context;
+
+    uint16_t message_id = message->sync_header.message_id;
+    if (!channel->request.size || message_id != channel->request.message_id) {
+        /* A response to a resent request may come twice, it must be applied once */
+        KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] dropped unexpected KAASYNC message %u",
+                channel->access_point.id, message_id);
+        kaatcp_parser_kaasync_destroy(message);
+        return;
+    }
+
+    KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] KAASYNC message %u received",
+            channel->access_point.id, message_id);
+
+    channel->request.size = 0;
+    channel->request.services = 0;
+    channel->last_activity = KAA_TIME();
+    /* The CONNACK may have been lost, the response tells the session is there */
+    if (message_id == KAA_UDP_CHANNEL_CONNECT_MESSAGE_ID) {
+        channel->session_state = KAA_UDP_SESSION_ESTABLISHED;
+    }
+
+    uint8_t zipped = message->sync_header.flags & KAA_SYNC_ZIPPED_BIT;
+    uint8_t encrypted = message->sync_header.flags & KAA_SYNC_ENCRYPTED_BIT;
+    (void)encrypted;
+
+#ifdef KAA_ENCRYPTION
+    if (encrypted) {
+        ext_decrypt_data((uint8_t *)message->sync_request, message->sync_request_size,
+                (uint8_t *)message->sync_request, &message->sync_request_size);
+    }
+#endif
+    if (!zipped) {
+        kaa_error_t error_code = kaa_platform_protocol_process_server_sync(channel->transport_context.kaa_context->platform_protocol,
+                (const uint8_t *)message->sync_request, message->sync_request_size);
+        if (error_code) {
+            KAA_LOG_ERROR(channel->logger, error_code, "Kaa UDP channel [0x%08X] failed to process server sync",
+                    channel->access_point.id);
+        }
+    } else {
+        KAA_LOG_WARN(channel->logger, KAA_ERR_NONE, "Kaa UDP channel [0x%08X] received unsupported flags: zipped %d, encrypted %d",
+                channel->access_point.id, zipped, encrypted);
+    }
+
+    kaatcp_parser_kaasync_destroy(message);
+}
+
+
+
+/*
+ * The channel doesn't ping, the session lives as long as it is used.
+ */
+void kaa_udp_channel_pingresp_message_callback(void *context)
+{
+    KAA_RETURN_IF_NIL(context,);
+    ((kaa_udp_channel_t *) context)->last_activity = KAA_TIME();
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file kaa_udp_channel.h
+ * @brief Datagram transport channel for constrained devices.
+ *
+ * Carries the Kaa TCP messages over UDP, one message per datagram, so a device
+ * waking up for a single sync doesn't pay for a TCP handshake and keepalives.
+ * The access point connection data is the same as for the Kaa TCP channel.
+ *
+ * The first request of a session is a CONNECT message, which carries the
+ * encrypted session key and its signature (with @c KAA_ENCRYPTION) along with
+ * the client sync. The following requests are KAASYNC messages encrypted with
+ * the same session key. The session is kept across the syncs until it stays idle
+ * for @c KAA_UDP_CHANNEL_SESSION_TIMEOUT seconds or the server refuses it.
+ *
+ * Requests are confirmable: only one is in flight at a time, and it is resent
+ * after @c KAA_UDP_CHANNEL_ACK_TIMEOUT seconds, doubling the timeout each time,
+ * until the server responds with a KAASYNC message with the same message id.
+ * CONNECT requests have message id 0, KAASYNC requests count from 1. After
+ * @c KAA_UDP_CHANNEL_MAX_RETRANSMIT resends the access point is reported as failed.
+ * Syncs requested meanwhile are merged and sent as the next request.
+ */
+
+#ifndef KAA_UDP_CHANNEL_H_
+#define KAA_UDP_CHANNEL_H_
+
+#include <stdbool.h>
+
+#include "kaa_error.h"
+#include "platform/ext_transport_channel.h"
+#include <platform/defaults.h>
+#include "platform/ext_tcp_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/**
+ * @brief Creates a Kaa UDP channel instance.
+ *
+ * @param[in]   self                       The pointer to the channel instance.
+ * @param[in]   logger                     The pointer to the Kaa logger instance.
+ * @param[in]   supported_services         A list of supported services for this channel.
+ * @param[in]   supported_service_count    The number of services in the list.
+ *
+ * @return Error code
+ */
+kaa_error_t kaa_udp_channel_create(kaa_transport_channel_interface_t *self
+                                 , kaa_logger_t *logger
+                                 , const kaa_extension_id *supported_services
+                                 , size_t supported_service_count);
+
+
+/**
+ * @brief Retrieves the socket descriptor from the given channel instance.
+ *
+ * The socket is created once the access point is resolved and only needs
+ * to be polled for reading.
+ *
+ * @param[in]   self       The channel instance.
+ * @param[out]  fd_p       The socket descriptor or KAA_TCP_SOCKET_NOT_SET
+ *                         if there is no open descriptor.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_udp_channel_get_descriptor(kaa_transport_channel_interface_t *self
+                                         , kaa_fd_t *fd_p);
+
+
+/**
+ * @brief Receives the waiting datagrams, resends the request if its response
+ * is overdue and sends the next request if the channel is idle.
+ *
+ * Should be called when the socket is readable and whenever the timeout
+ * returned by @link kaa_udp_channel_get_max_timeout @endlink expires.
+ *
+ * @param[in]   self        The channel instance.
+ * @param[in]   readable    Whether the socket has datagrams to receive.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_udp_channel_process(kaa_transport_channel_interface_t *self
+                                  , bool readable);
+
+
+/**
+ * @brief Retrieves the maximum timeout for the multiplexing I/O like select/poll:
+ * the time left until the request in flight is resent, or
+ * @c KAA_UDP_CHANNEL_SESSION_TIMEOUT if there is none.
+ *
+ * @param[in]   self           The channel instance.
+ * @param[out]  max_timeout    The maximum timeout value (in seconds).
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_udp_channel_get_max_timeout(kaa_transport_channel_interface_t *self
+                                          , uint16_t *max_timeout);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_UDP_CHANNEL_H_ */
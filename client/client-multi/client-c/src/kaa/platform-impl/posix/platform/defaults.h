@@ -25,12 +25,20 @@
 
 #define KAA_TCP_CHANNEL_IN_BUFFER_SIZE      2048
 #define KAA_TCP_CHANNEL_OUT_BUFFER_SIZE     8192
+#define KAA_TCP_CHANNEL_SCRATCH_SIZE        2048
+#define KAA_TCP_CHANNEL_MAX_SPLICES         32
 
 #define KAA_TCP_CHANNEL_MAX_TIMEOUT         200u
 #define KAA_TCP_CHANNEL_PING_TIMEOUT        (KAA_TCP_CHANNEL_MAX_TIMEOUT / 2)
 
 #define KAATCP_PARSER_MAX_MESSAGE_LENGTH    1024 * 1024
 
+/* Fits into the IPv6 minimum MTU with the IP and UDP headers */
+#define KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE   1232
+#define KAA_UDP_CHANNEL_ACK_TIMEOUT         2u
+#define KAA_UDP_CHANNEL_MAX_RETRANSMIT      4u
+#define KAA_UDP_CHANNEL_SESSION_TIMEOUT     KAA_TCP_CHANNEL_MAX_TIMEOUT
+
 #define KAA_MAX_LOG_MESSAGE_LENGTH          512
 
 #endif /* POSIX_DEFAULTS_H_ */
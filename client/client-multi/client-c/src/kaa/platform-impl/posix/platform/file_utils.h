@@ -32,6 +32,12 @@ int posix_binary_file_store(const char *file_name, const char *buffer, size_t bu
 
 int posix_binary_file_delete(const char *file_name);
 
+
+int posix_binary_file_append(const char *file_name, const char *buffer, size_t buffer_size);
+
+/* Returns the number of bytes read, which is less than @p buffer_size at the end of the file, or -1 */
+int posix_binary_file_read_at(const char *file_name, size_t offset, char *buffer, size_t buffer_size);
+
 #ifdef __cplusplus
 }      /* extern "C" */
 #endif
@@ -19,9 +19,20 @@
 #define POSIX_TIME_H_
 
 #include <time.h>
+#include <stdint.h>
 
 typedef time_t kaa_time_t;
 
 #define KAA_TIME() (kaa_time_t)time(NULL)
 
+/* Monotonic time in milliseconds, not affected by the system clock changes */
+static inline uint64_t kaa_posix_time_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+#define KAA_TIME_MS() kaa_posix_time_ms()
+
 #endif /* POSIX_TIME_H_ */
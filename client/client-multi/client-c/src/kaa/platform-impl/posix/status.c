@@ -30,3 +30,8 @@ void ext_status_store(const char *buffer, size_t buffer_size)
 {
     posix_binary_file_store(KAA_STATUS_STORAGE, buffer, buffer_size);
 }
+
+void ext_status_append(const char *buffer, size_t buffer_size)
+{
+    posix_binary_file_append(KAA_STATUS_STORAGE, buffer, buffer_size);
+}
@@ -18,8 +18,10 @@
 #define _POSIX_C_SOURCE 200112L
 
 #include "platform/ext_tcp_utils.h"
+#include <platform/kaa_client_properties.h>
 #include <platform/stdio.h>
 #include "kaa_common.h"
+#include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
 #include <netdb.h>
@@ -27,7 +29,51 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <time.h>
+
+/* The parts above the limit are left for the next call, as a partial write or read */
+#define KAA_TCP_IO_VECTOR_MAX_COUNT    16
+
+/* Resolved addresses are reused for that many seconds */
+#ifndef KAA_DNS_CACHE_TTL
+#define KAA_DNS_CACHE_TTL              300
+#endif
+
+/* Hosts which are resolved or being resolved at the same time */
+#ifndef KAA_DNS_CACHE_SIZE
+#define KAA_DNS_CACHE_SIZE             4
+#endif
+
+/* Longer hostnames are resolved in place */
+#define KAA_DNS_HOSTNAME_MAX_LENGTH    255
+
+typedef enum {
+    KAA_DNS_ENTRY_EMPTY = 0,
+    KAA_DNS_ENTRY_RESOLVING,
+    KAA_DNS_ENTRY_RESOLVED,
+    KAA_DNS_ENTRY_FAILED
+} kaa_dns_entry_state_t;
+
+/*
+ * The hostname, port and family are only changed while no resolver thread uses the entry,
+ * everything else is guarded by kaa_dns_cache_lock.
+ */
+typedef struct {
+    kaa_dns_entry_state_t      state;
+    char                       hostname[KAA_DNS_HOSTNAME_MAX_LENGTH + 1];
+    uint16_t                   port;
+    int                        family;
+    struct sockaddr_storage    addr;
+    socklen_t                  addr_size;
+    time_t                     expiry;
+} kaa_dns_entry_t;
+
+static kaa_dns_entry_t kaa_dns_cache[KAA_DNS_CACHE_SIZE];
+static pthread_mutex_t kaa_dns_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 
@@ -53,6 +99,138 @@ kaa_error_t ext_tcp_utils_set_sockaddr_port(kaa_sockaddr_t *addr, uint16_t port)
 
 
 
+static bool kaa_dns_resolve(const char *hostname, uint16_t port, int family, int flags
+                          , struct sockaddr_storage *addr, socklen_t *addr_size)
+{
+    struct addrinfo hints;
+    memset(&hints, 0 , sizeof(struct addrinfo));
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_family = family;
+    hints.ai_flags = flags;
+
+    struct addrinfo *resolve_result = NULL;
+    int resolve_error = 0;
+
+    if (port) {
+        char port_str[6];
+        snprintf(port_str, 6, "%u", port);
+        resolve_error = getaddrinfo(hostname, port_str, &hints, &resolve_result);
+    } else {
+        resolve_error = getaddrinfo(hostname, NULL, &hints, &resolve_result);
+    }
+
+    if (resolve_error || !resolve_result)
+        return false;
+
+    if (resolve_result->ai_addrlen > sizeof(struct sockaddr_storage)) {
+        freeaddrinfo(resolve_result);
+        return false;
+    }
+
+    memcpy(addr, resolve_result->ai_addr, resolve_result->ai_addrlen);
+    *addr_size = resolve_result->ai_addrlen;
+    freeaddrinfo(resolve_result);
+    return true;
+}
+
+
+
+static ext_tcp_utils_function_return_state_t kaa_dns_copy_result(const struct sockaddr_storage *addr
+                                                                , socklen_t addr_size
+                                                                , kaa_sockaddr_t *result
+                                                                , kaa_socklen_t *result_size)
+{
+    if (addr_size > *result_size)
+        return RET_STATE_BUFFER_NOT_ENOUGH;
+
+    memcpy(result, addr, addr_size);
+    *result_size = addr_size;
+    return RET_STATE_VALUE_READY;
+}
+
+
+
+static void *kaa_dns_resolve_thread(void *context)
+{
+    kaa_dns_entry_t *entry = (kaa_dns_entry_t *)context;
+
+    struct sockaddr_storage addr;
+    socklen_t addr_size = 0;
+    bool resolved = kaa_dns_resolve(entry->hostname, entry->port, entry->family, 0, &addr, &addr_size);
+
+    pthread_mutex_lock(&kaa_dns_cache_lock);
+    if (resolved) {
+        memcpy(&entry->addr, &addr, addr_size);
+        entry->addr_size = addr_size;
+        entry->expiry = time(NULL) + KAA_DNS_CACHE_TTL;
+        entry->state = KAA_DNS_ENTRY_RESOLVED;
+    } else {
+        entry->state = KAA_DNS_ENTRY_FAILED;
+    }
+    pthread_mutex_unlock(&kaa_dns_cache_lock);
+
+    return NULL;
+}
+
+
+
+static kaa_dns_entry_t *kaa_dns_find_entry(const char *hostname, uint16_t port, int family)
+{
+    for (size_t i = 0; i < KAA_DNS_CACHE_SIZE; ++i) {
+        kaa_dns_entry_t *entry = &kaa_dns_cache[i];
+        if (entry->state != KAA_DNS_ENTRY_EMPTY && entry->port == port && entry->family == family
+                && !strcmp(entry->hostname, hostname)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+
+
+/*
+ * Returns an empty entry or the resolved one which expires first. The entries being resolved
+ * are in use by the resolver threads, so NULL is returned if there are no other ones.
+ */
+static kaa_dns_entry_t *kaa_dns_get_free_entry(void)
+{
+    kaa_dns_entry_t *free_entry = NULL;
+    for (size_t i = 0; i < KAA_DNS_CACHE_SIZE; ++i) {
+        kaa_dns_entry_t *entry = &kaa_dns_cache[i];
+        if (entry->state == KAA_DNS_ENTRY_EMPTY || entry->state == KAA_DNS_ENTRY_FAILED) {
+            return entry;
+        }
+        if (entry->state == KAA_DNS_ENTRY_RESOLVED && (!free_entry || entry->expiry < free_entry->expiry)) {
+            free_entry = entry;
+        }
+    }
+    return free_entry;
+}
+
+
+
+static bool kaa_dns_start_resolve(kaa_dns_entry_t *entry)
+{
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr))
+        return false;
+
+    pthread_t thread;
+    bool started = !pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED)
+                && !pthread_create(&thread, &attr, kaa_dns_resolve_thread, entry);
+    pthread_attr_destroy(&attr);
+
+    if (started)
+        entry->state = KAA_DNS_ENTRY_RESOLVING;
+    return started;
+}
+
+
+
+/*
+ * Hostnames are resolved by a helper thread, so a slow DNS server doesn't block the client.
+ * The result is taken from the cache by the next call for the same host.
+ */
 ext_tcp_utils_function_return_state_t ext_tcp_utils_getaddrbyhost(kaa_dns_resolve_listener_t *resolve_listener
                                                                 , const kaa_dns_resolve_info_t *resolve_props
                                                                 , kaa_sockaddr_t *result
@@ -63,42 +241,125 @@ ext_tcp_utils_function_return_state_t ext_tcp_utils_getaddrbyhost(kaa_dns_resolv
     if (*result_size < sizeof(struct sockaddr_in))
         return RET_STATE_BUFFER_NOT_ENOUGH;
 
-    struct addrinfo hints;
-    memset(&hints, 0 , sizeof(struct addrinfo));
-    hints.ai_socktype = SOCK_STREAM;
-    if (*result_size < sizeof(struct sockaddr_in6))
-        hints.ai_family = AF_INET;
+    int family = (*result_size < sizeof(struct sockaddr_in6)) ? AF_INET : AF_UNSPEC;
 
     char hostname_str[resolve_props->hostname_length + 1];
     memcpy(hostname_str, resolve_props->hostname, resolve_props->hostname_length);
     hostname_str[resolve_props->hostname_length] = '\0';
 
-    struct addrinfo *resolve_result = NULL;
-    int resolve_error = 0;
+    struct sockaddr_storage addr;
+    socklen_t addr_size = 0;
 
-    if (resolve_props->port) {
-        char port_str[6];
-        snprintf(port_str, 6, "%u", resolve_props->port);
-        resolve_error = getaddrinfo(hostname_str, port_str, &hints, &resolve_result);
-    } else {
-        resolve_error = getaddrinfo(hostname_str, NULL, &hints, &resolve_result);
+    // Numeric addresses don't need a DNS server
+    if (kaa_dns_resolve(hostname_str, resolve_props->port, family, AI_NUMERICHOST, &addr, &addr_size))
+        return kaa_dns_copy_result(&addr, addr_size, result, result_size);
+
+    if (resolve_props->hostname_length > KAA_DNS_HOSTNAME_MAX_LENGTH) {
+        if (!kaa_dns_resolve(hostname_str, resolve_props->port, family, 0, &addr, &addr_size))
+            return RET_STATE_VALUE_ERROR;
+        return kaa_dns_copy_result(&addr, addr_size, result, result_size);
     }
 
-    if (resolve_error || !resolve_result)
-        return RET_STATE_VALUE_ERROR;
+    ext_tcp_utils_function_return_state_t state = RET_STATE_VALUE_IN_PROGRESS;
+
+    pthread_mutex_lock(&kaa_dns_cache_lock);
+    kaa_dns_entry_t *entry = kaa_dns_find_entry(hostname_str, resolve_props->port, family);
+    if (entry) {
+        switch (entry->state) {
+        case KAA_DNS_ENTRY_RESOLVED:
+            if (entry->expiry > time(NULL)) {
+                state = kaa_dns_copy_result(&entry->addr, entry->addr_size, result, result_size);
+            } else if (!kaa_dns_start_resolve(entry)) {
+                entry->state = KAA_DNS_ENTRY_EMPTY;
+                entry = NULL;
+            }
+            break;
+        case KAA_DNS_ENTRY_FAILED:
+            entry->state = KAA_DNS_ENTRY_EMPTY;
+            state = RET_STATE_VALUE_ERROR;
+            break;
+        default:
+            break;
+        }
+    } else {
+        entry = kaa_dns_get_free_entry();
+        if (entry) {
+            memcpy(entry->hostname, hostname_str, resolve_props->hostname_length + 1);
+            entry->port = resolve_props->port;
+            entry->family = family;
+            if (!kaa_dns_start_resolve(entry)) {
+                entry->state = KAA_DNS_ENTRY_EMPTY;
+                entry = NULL;
+            }
+        }
+    }
+    pthread_mutex_unlock(&kaa_dns_cache_lock);
 
-    if (resolve_result->ai_addrlen > *result_size) {
-        freeaddrinfo(resolve_result);
-        return RET_STATE_BUFFER_NOT_ENOUGH;
+    if (!entry) {
+        // No room for one more resolver thread
+        if (!kaa_dns_resolve(hostname_str, resolve_props->port, family, 0, &addr, &addr_size))
+            return RET_STATE_VALUE_ERROR;
+        return kaa_dns_copy_result(&addr, addr_size, result, result_size);
     }
 
-    memcpy(result, resolve_result->ai_addr, resolve_result->ai_addrlen);
-    *result_size = resolve_result->ai_addrlen;
-    freeaddrinfo(resolve_result);
-    return RET_STATE_VALUE_READY;
+    return state;
+}
+
+
+
+static const kaa_tcp_socket_options_t kaa_default_tcp_socket_options = {
+    .no_delay = true,
+};
+
+static void kaa_tcp_set_int_option(kaa_fd_t sock, int level, int name, int value)
+{
+    // Tuning is best effort: the connection works with the system defaults as well
+    (void)setsockopt(sock, level, name, &value, sizeof(value));
 }
 
+/*
+ * Applied before connect(): the buffer sizes affect the window scale negotiated
+ * in the handshake, and TCP Fast Open defers SYN until the first write.
+ */
+static void kaa_tcp_apply_socket_options(kaa_fd_t sock)
+{
+    const kaa_tcp_socket_options_t *options = kaa_client_props_get()->tcp_socket_options;
+    if (!options) {
+        options = &kaa_default_tcp_socket_options;
+    }
+
+    if (options->no_delay) {
+        kaa_tcp_set_int_option(sock, IPPROTO_TCP, TCP_NODELAY, 1);
+    }
+    if (options->send_buffer_size) {
+        kaa_tcp_set_int_option(sock, SOL_SOCKET, SO_SNDBUF, (int)options->send_buffer_size);
+    }
+    if (options->receive_buffer_size) {
+        kaa_tcp_set_int_option(sock, SOL_SOCKET, SO_RCVBUF, (int)options->receive_buffer_size);
+    }
+
+    if (options->keepalive_idle || options->keepalive_interval || options->keepalive_count) {
+        kaa_tcp_set_int_option(sock, SOL_SOCKET, SO_KEEPALIVE, 1);
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+        if (options->keepalive_idle) {
+            kaa_tcp_set_int_option(sock, IPPROTO_TCP, TCP_KEEPIDLE, options->keepalive_idle);
+        }
+        if (options->keepalive_interval) {
+            kaa_tcp_set_int_option(sock, IPPROTO_TCP, TCP_KEEPINTVL, options->keepalive_interval);
+        }
+        if (options->keepalive_count) {
+            kaa_tcp_set_int_option(sock, IPPROTO_TCP, TCP_KEEPCNT, options->keepalive_count);
+        }
+#endif
+    }
 
+#ifdef TCP_FASTOPEN_CONNECT
+    // connect() completes at once, the CONNECT message written first goes with SYN
+    if (options->fast_open) {
+        kaa_tcp_set_int_option(sock, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1);
+    }
+#endif
+}
 
 kaa_error_t ext_tcp_utils_open_tcp_socket(kaa_fd_t *fd
                                         , const kaa_sockaddr_t *destination
@@ -110,6 +371,8 @@ kaa_error_t ext_tcp_utils_open_tcp_socket(kaa_fd_t *fd
     if (sock < 0)
         return KAA_ERR_SOCKET_ERROR;
 
+    kaa_tcp_apply_socket_options(sock);
+
     int flags = fcntl(sock, F_GETFL);
     if (flags < 0) {
         ext_tcp_utils_tcp_socket_close(sock);
@@ -186,6 +449,61 @@ ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_read(kaa_fd_t fd
 
 
 
+static size_t ext_tcp_utils_fill_iovec(struct iovec *iov, const ext_tcp_io_vector_t *vectors, size_t vector_count)
+{
+    size_t iov_count = 0;
+    for (size_t i = 0; i < vector_count && iov_count < KAA_TCP_IO_VECTOR_MAX_COUNT; ++i) {
+        if (vectors[i].size) {
+            iov[iov_count].iov_base = vectors[i].buffer;
+            iov[iov_count].iov_len = vectors[i].size;
+            ++iov_count;
+        }
+    }
+    return iov_count;
+}
+
+
+
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_writev(kaa_fd_t fd
+                                                         , const ext_tcp_io_vector_t *vectors
+                                                         , size_t vector_count
+                                                         , size_t *bytes_written)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+    struct iovec iov[KAA_TCP_IO_VECTOR_MAX_COUNT];
+    size_t iov_count = ext_tcp_utils_fill_iovec(iov, vectors, vector_count);
+    KAA_RETURN_IF_NIL(iov_count, KAA_TCP_SOCK_IO_ERROR);
+    ssize_t write_result = writev(fd, iov, iov_count);
+    if (write_result < 0 && errno != EAGAIN)
+        return KAA_TCP_SOCK_IO_ERROR;
+    if (bytes_written)
+        *bytes_written = (write_result > 0) ? write_result : 0;
+    return KAA_TCP_SOCK_IO_OK;
+}
+
+
+
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_readv(kaa_fd_t fd
+                                                        , const ext_tcp_io_vector_t *vectors
+                                                        , size_t vector_count
+                                                        , size_t *bytes_read)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+    struct iovec iov[KAA_TCP_IO_VECTOR_MAX_COUNT];
+    size_t iov_count = ext_tcp_utils_fill_iovec(iov, vectors, vector_count);
+    KAA_RETURN_IF_NIL(iov_count, KAA_TCP_SOCK_IO_ERROR);
+    ssize_t read_result = readv(fd, iov, iov_count);
+    if (!read_result)
+        return KAA_TCP_SOCK_IO_EOF;
+    if (read_result < 0 && errno != EAGAIN)
+        return KAA_TCP_SOCK_IO_ERROR;
+    if (bytes_read)
+        *bytes_read = (read_result > 0) ? read_result : 0;
+    return KAA_TCP_SOCK_IO_OK;
+}
+
+
+
 kaa_error_t ext_tcp_utils_tcp_socket_close(kaa_fd_t fd)
 {
     return (close(fd) < 0) ? KAA_ERR_SOCKET_ERROR : KAA_ERR_NONE;
@@ -25,6 +25,7 @@
 
 #include <kaa/kaa_error.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -61,6 +62,9 @@ void ext_get_endpoint_session_key(const uint8_t **buffer, size_t *buffer_size);
  * @param[in] input_size   The size of the input buffer.
  * @param[out] output      The pointer which will be initialized with buffer containing
  *                         enctypted data.
+ *
+ * @note The output buffer must hold ext_get_encrypted_data_size() bytes. It may be
+ *       the input buffer, the data is then encrypted in place.
  */
 kaa_error_t ext_encrypt_data(const uint8_t *input, size_t input_size, uint8_t *output);
 
@@ -81,11 +85,28 @@ size_t ext_get_encrypted_data_size(size_t input_size);
  * @param[out] output               The buffer which contains decrypted data will be filled in.
  *
  * @note The output buffer is assumed to be at least as long as @p input_size.
+ *       It may be the input buffer.
  *
  */
 kaa_error_t ext_decrypt_data(const uint8_t *input, size_t input_size,
         uint8_t *output, size_t *output_payload_size);
 
+/**
+ * Encrypts or decrypts whole AES blocks in ECB mode with a 128-bit key.
+ *
+ * ext_encrypt_data() and ext_decrypt_data() are built on it. The default
+ * implementation in platform-impl/common/aes.c uses mbedtls; a platform with
+ * an AES engine replaces it by setting @c KAA_AES_SOURCE_FILES in its listfile.
+ *
+ * @param[in]  encrypt     @c true to encrypt, @c false to decrypt.
+ * @param[in]  key         The 16-byte key.
+ * @param[in]  input       The data to be processed.
+ * @param[in]  size        The size of the data, a multiple of 16 bytes.
+ * @param[out] output      The buffer of @p size bytes, may be @p input.
+ */
+kaa_error_t ext_aes_ecb_crypt(bool encrypt, const uint8_t *key, const uint8_t *input,
+        size_t size, uint8_t *output);
+
 /**
  * Returns encrypted endpoint session key.
  *
@@ -94,6 +115,8 @@ kaa_error_t ext_decrypt_data(const uint8_t *input, size_t input_size,
  * @param[in]   remote_key          Remote public key which will be used to encrypt session key.
  * @param[in]   remote_key_size     Remote public key's size.
  *
+ * The encrypted key is cached per remote key, so the buffer stays valid and
+ * unchanged while the access point is in use.
  */
 kaa_error_t ext_get_encrypted_session_key(uint8_t **buffer, size_t *buffer_size,
         const uint8_t *remote_key, size_t remote_key_size);
@@ -106,6 +129,8 @@ kaa_error_t ext_get_encrypted_session_key(uint8_t **buffer, size_t *buffer_size,
  * @param [out] output           The pointer which will be initialized with signed key.
  * @param [out] output_size      The length of signed key.
  *
+ * The signature of a key returned by ext_get_encrypted_session_key() is
+ * computed once and cached along with the key.
  */
 kaa_error_t ext_get_signature(const uint8_t *input, size_t input_size,
                               uint8_t **output, size_t *output_size);
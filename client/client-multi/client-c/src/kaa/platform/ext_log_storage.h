@@ -112,6 +112,26 @@ kaa_error_t ext_log_storage_write_next_record(void *context, char *buffer, size_
 
 
 
+/**
+ * @brief Same as @link ext_log_storage_write_next_record @endlink, but
+ * returns the stored data of the record instead of copying it.
+ *
+ * @p data stays valid until the record is removed from the storage or
+ * another record is added. Storages that don't keep the records in memory
+ * (see @c KAA_FILE_LOG_STORAGE) only keep it until the next call.
+ *
+ * @param[in]       context     Log storage context.
+ * @param[in]       max_len     Maximum size of the record data.
+ * @param[out]      data        The record data.
+ * @param[out]      bucket_id   Optional bucket ID of the next record.
+ * @param[out]      record_len  Size of the record data.
+ *
+ * @return Error code, see @link ext_log_storage_write_next_record @endlink.
+ */
+kaa_error_t ext_log_storage_get_next_record(void *context, size_t max_len, const char **data, uint16_t *bucket_id, size_t *record_len);
+
+
+
 /**
  * @brief Removes from the storage all records marked with the provided @c bucket_id.
  *
@@ -71,6 +71,16 @@ kaa_error_t ext_log_upload_strategy_create(struct kaa_context_s *context, void *
  */
 ext_log_upload_decision_t ext_log_upload_strategy_decide(void *context, const void *log_storage_context);
 
+/**
+ * @brief Time left until the decision may change by itself, i.e. with the log storage left as is.
+ *
+ * The log collector doesn't consult the strategy again until then, unless logs are added or delivered.
+ *
+ * @param[in]   context    Log upload strategy context.
+ * @return                 Time in seconds, @c SIZE_MAX if the decision depends only on the log storage.
+ */
+size_t ext_log_upload_strategy_get_decision_delay(void *context);
+
 /**
  * @brief The maximum time to wait a log delivery response.
  *
@@ -84,6 +94,8 @@ size_t ext_log_upload_strategy_get_timeout(void *context);
 /**
  * @brief Max amount of log batches allowed to be uploaded parallel.
  *
+ * The log collector keeps up to @c KAA_MAX_PENDING_LOG_BUCKETS batches pending whatever is returned.
+ *
  * @param[in]   context    Log upload strategy context.
  * @return                 Amount of batches.
  */
@@ -17,6 +17,9 @@
 /*
 * @file ext_sha.h
 * @brief External SHA functions.
+*
+* The default implementation in platform-impl/common/sha.c uses mbedtls, a platform
+* with a SHA engine lists its own implementation in its listfile instead.
 */
 
 #ifndef EXT_SHA_H_
@@ -51,6 +51,17 @@ void ext_status_read(char **buffer, size_t *buffer_size, bool *needs_deallocatio
  */
 void ext_status_store(const char *buffer, size_t buffer_size);
 
+/**
+ * @brief Called when only a few status fields have changed since the last store.
+ *
+ * The buffer must be added to the end of the persisted status, which is passed to ext_status_read() as a whole.
+ *
+ * @param[in]   buffer          Valid pointer to buffer which contains the changed Kaa status fields.
+ * @param[in]   buffer_size     The buffer's size.
+ *
+ */
+void ext_status_append(const char *buffer, size_t buffer_size);
+
 /**
  * @brief Deletes a status storage.
  */
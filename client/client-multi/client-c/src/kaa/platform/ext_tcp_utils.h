@@ -57,6 +57,17 @@ typedef enum {
 } ext_tcp_socket_io_errors_t;
 
 
+/**
+ * @brief A part of the data for the vectored socket I/O.
+ *
+ * See @link ext_tcp_utils_tcp_socket_writev @endlink and @link ext_tcp_utils_tcp_socket_readv @endlink.
+ */
+typedef struct {
+    void      *buffer;    /**< The beginning of the part. */
+    size_t    size;       /**< The size of the part. */
+} ext_tcp_io_vector_t;
+
+
 /**
  * @brief The callback for successful DNS results. See @link ext_tcp_utils_getaddrbyhost @endlink.
  *
@@ -122,7 +133,9 @@ typedef struct {
  *
  * @return
  *      RET_STATE_VALUE_READY - the address was successfully resolved.
- *      RET_STATE_VALUE_IN_PROGRESS - the address will be resolved later.
+ *      RET_STATE_VALUE_IN_PROGRESS - the address will be resolved later. It is either reported
+ *                                    to the listener or returned by one of the next calls
+ *                                    for the same host, depending on the platform.
  *                                    See @link kaa_dns_resolve_listener_t @endlink.
  *      RET_STATE_VALUE_ERROR - the resolve failed.
  *      RET_STATE_BUFFER_NOT_ENOUGH - the given buffer is not enough to store the result.
@@ -213,6 +226,48 @@ ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_read(kaa_fd_t fd
                                                        , size_t *bytes_read);
 
 
+/**
+ * @brief Writes the parts of the data into the given socket as a single write.
+ *
+ * The parts are written in order. As with @link ext_tcp_utils_tcp_socket_write @endlink,
+ * fewer bytes than the total size may be written, the caller resumes from the first unwritten one.
+ *
+ * @param[in]   fd               The socket descriptor.
+ * @param[in]   vectors          The parts which are going to be written into the socket.
+ * @param[in]   vector_count     The number of the parts.
+ * @param[out]  bytes_written    The actual number of bytes which were successfully written into the socket.
+ *
+ * @return
+ *       KAA_TCP_SOCK_IO_OK - the parts were successfully written into the socket.
+ *       KAA_TCP_SOCK_IO_ERROR - the operation failed.
+ */
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_writev(kaa_fd_t fd
+                                                         , const ext_tcp_io_vector_t *vectors
+                                                         , size_t vector_count
+                                                         , size_t *bytes_written);
+
+
+/**
+ * @brief Reads bytes from the given socket into the parts of the buffer.
+ *
+ * The parts are filled in order.
+ *
+ * @param[in]   fd             The socket descriptor.
+ * @param[in]   vectors        The parts to which the read result will be saved.
+ * @param[in]   vector_count   The number of the parts.
+ * @param[out]  bytes_read     The actual number of bytes which were read from the socket.
+ *
+ * @return
+ *      KAA_TCP_SOCK_IO_OK - the bytes were successfully obtained from the socket.
+ *      KAA_TCP_SOCK_IO_EOF - EOF occurred.
+ *      KAA_TCP_SOCK_IO_ERROR - the operation failed.
+ */
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_readv(kaa_fd_t fd
+                                                        , const ext_tcp_io_vector_t *vectors
+                                                        , size_t vector_count
+                                                        , size_t *bytes_read);
+
+
 /**
  * @brief Closes the given socket.
  *
@@ -23,6 +23,8 @@
 #ifndef EXT_USER_CALLBACK_H_
 #define EXT_USER_CALLBACK_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "kaa_common.h"
 
 #ifdef __cplusplus
@@ -144,6 +146,25 @@ typedef struct {
 } kaa_endpoint_status_listener_t;
 
 
+/**
+ * @brief Outcome of one request of an endpoint attach batch.
+ */
+typedef struct {
+    bool             is_attached;   /**< False if the attach attempt is failed. */
+    kaa_endpoint_id  endpoint_id;   /**< ID of the attached endpoint, zeroed unless the server sent it. */
+} kaa_endpoint_attach_result_t;
+
+
+/**
+ * @brief Notifies that all requests of an endpoint attach batch are answered.
+ *
+ * @param[in]   context          Callback's context.
+ * @param[in]   results          Outcomes in the order of the access tokens of the batch.
+ * @param[in]   results_count    Amount of requests in the batch.
+ */
+typedef void (*on_endpoints_attached_fn)(void *context, const kaa_endpoint_attach_result_t *results, size_t results_count);
+
+
 #ifdef __cplusplus
 }    /* extern "C" */
 #endif
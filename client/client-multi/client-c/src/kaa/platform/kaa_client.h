@@ -30,7 +30,9 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <platform/time.h>
+#include <platform/sock.h>
 
 #include "kaa_context.h"
 #include <platform/kaa_client_properties.h>
@@ -91,6 +93,56 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client
  */
 kaa_error_t kaa_client_stop(kaa_client_t *kaa_client);
 
+/**
+ * @brief Retrieves the descriptor of the Kaa client channel and the I/O events the channel waits for.
+ *
+ * Together with @link kaa_client_get_timeout @endlink and @link kaa_client_process @endlink
+ * it drives the client from an external event loop (libuv, libevent, etc.) instead of
+ * @link kaa_client_start @endlink. The descriptor changes when the client reconnects,
+ * so it should be retrieved on each loop iteration.
+ *
+ * @note Implemented by the POSIX client. The profile must be set before the client is processed.
+ *
+ * @param[in]   kaa_client     Pointer to a Kaa client.
+ * @param[out]  fd             The channel descriptor, KAA_TCP_SOCKET_NOT_SET if there is no connected channel.
+ * @param[out]  wants_read     Whether the channel waits for the descriptor to become readable.
+ * @param[out]  wants_write    Whether the channel waits for the descriptor to become writable.
+ *
+ * @return Error code, KAA_ERR_BAD_STATE if the client is stopped.
+ */
+kaa_error_t kaa_client_get_descriptor(kaa_client_t *kaa_client, kaa_fd_t *fd, bool *wants_read, bool *wants_write);
+
+/**
+ * @brief Retrieves the time the external event loop may wait for the channel events
+ * before calling @link kaa_client_process @endlink.
+ *
+ * The timeout is the nearest of the keepalive, log upload, event coalescing, bootstrap response,
+ * failover and external process deadlines, so the platform may put the MCU to sleep for that long
+ * unless the channel descriptor becomes ready earlier.
+ *
+ * @note Implemented by the POSIX and ESP8266 clients.
+ *
+ * @param[in]   kaa_client     Pointer to a Kaa client.
+ * @param[out]  timeout        The timeout in seconds, 0 - the client must be processed without waiting.
+ *
+ * @return Error code, KAA_ERR_BAD_STATE if the client is stopped.
+ */
+kaa_error_t kaa_client_get_timeout(kaa_client_t *kaa_client, kaa_time_t *timeout);
+
+/**
+ * @brief Runs one iteration of the Kaa client loop without waiting.
+ *
+ * Processes the channel events reported by the external event loop, or checks keepalive
+ * if there are none, and performs the periodic work of the client.
+ *
+ * @param[in]   kaa_client     Pointer to a Kaa client.
+ * @param[in]   readable       Whether the channel descriptor has become readable.
+ * @param[in]   writable       Whether the channel descriptor has become writable.
+ *
+ * @return Error code, KAA_ERR_BAD_STATE if the client is stopped.
+ */
+kaa_error_t kaa_client_process(kaa_client_t *kaa_client, bool readable, bool writable);
+
 /**
  * @brief Return pointer to Kaa context
  *
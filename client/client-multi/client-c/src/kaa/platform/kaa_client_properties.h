@@ -16,8 +16,26 @@
 #ifndef PLATFORM_KAA_CLIENT_PROPERIES_H_
 #define PLATFORM_KAA_CLIENT_PROPERIES_H_
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <kaa_error.h>
 
+/**
+ * Options of the TCP sockets connected to the Kaa servers.
+ *
+ * Zero values leave the system defaults. The options a platform
+ * doesn't support are ignored.
+ */
+typedef struct {
+    bool     no_delay;              /**< Disable the Nagle's algorithm (TCP_NODELAY). */
+    bool     fast_open;             /**< Send the first request with SYN (TCP Fast Open). */
+    uint16_t keepalive_idle;        /**< Seconds of idleness before TCP keepalive probes. */
+    uint16_t keepalive_interval;    /**< Seconds between TCP keepalive probes. */
+    uint16_t keepalive_count;       /**< Unanswered probes before the connection is dropped. */
+    uint32_t send_buffer_size;      /**< SO_SNDBUF in bytes. */
+    uint32_t receive_buffer_size;   /**< SO_RCVBUF in bytes. */
+} kaa_tcp_socket_options_t;
+
 typedef struct {
     /**
      * The directory to place client files into.
@@ -25,6 +43,13 @@ typedef struct {
      * Must not be @c NULL.
      */
     const char *working_directory;
+
+    /**
+     * The options of the TCP sockets.
+     *
+     * If @c NULL, only @c no_delay is set.
+     */
+    const kaa_tcp_socket_options_t *tcp_socket_options;
 } kaa_client_props_t;
 
 /**
@@ -17,6 +17,9 @@
 /*
  * @file kaa_base64.c
  *
+ * Blocks of input are processed with SIMD instructions the compiler targets (AVX2, SSSE3
+ * or AArch64 NEON), the rest of input and blocks with padding or invalid characters
+ * are processed by the table-driven code, which is the only one on MCUs.
  */
 
 
@@ -26,40 +29,348 @@
 #include "kaa_common.h"
 #include "kaa_base64.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KAA_BASE64_AVX2
+#endif
 
-static char decoding_table[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x3F,
-                                0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
-                                0x3C, 0x3D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
-                                0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
-                                0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
-                                0x17, 0x18, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
-                                0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
-                                0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
-                                0x31, 0x32, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define KAA_BASE64_SSSE3
+#endif
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KAA_BASE64_NEON
+#endif
+
+
+#define KAA_BASE64_PADDING      '='
+
+static const char encoding_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const uint8_t decoding_table[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+                                         0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+                                         0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+                                         0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+                                         0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+                                         0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+                                         0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+                                         0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+                                         0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+
+
+#if defined(KAA_BASE64_SSSE3) || defined(KAA_BASE64_AVX2)
+
+/*
+ * The SSE and AVX2 code follows the algorithms of Wojciech Mula and Daniel Lemire,
+ * "Faster Base64 Encoding and Decoding Using AVX2 Instructions".
+ */
+
+#define KAA_BASE64_SPLIT_SHUFFLE        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+#define KAA_BASE64_SHIFT_LUT            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, \
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, \
+                                        '/' - 63, 'A', 0, 0
+#define KAA_BASE64_VALIDATION_LUT_LO    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+#define KAA_BASE64_VALIDATION_LUT_HI    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+#define KAA_BASE64_ROLL_LUT             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+#define KAA_BASE64_PACK_SHUFFLE         2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+#endif
+
+#ifdef KAA_BASE64_AVX2
+
+/* Each 128-bit lane holds 12 input bytes in its low part. */
+static __m256i encode_block_avx2(__m256i in)
+{
+    in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(KAA_BASE64_SPLIT_SHUFFLE, KAA_BASE64_SPLIT_SHUFFLE));
+
+    /* Spreads each 24 bits over 4 bytes, 6 bits per byte. */
+    __m256i indices = _mm256_or_si256(
+            _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040)),
+            _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010)));
+
+    /* Maps 0..25 to 13, 26..51 to 0, 52..61 to 1..10, 62 to 11 and 63 to 12, then adds the offset of the range. */
+    __m256i ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    ranges = _mm256_or_si256(ranges, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices),
+                                                      _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(indices, _mm256_shuffle_epi8(_mm256_setr_epi8(KAA_BASE64_SHIFT_LUT, KAA_BASE64_SHIFT_LUT),
+                                                        ranges));
+}
+
+static void encode_blocks_avx2(const uint8_t **data, size_t *length, uint8_t **out)
+{
+    /* Loads 16 bytes for 12 ones of each lane, so the last load must not cross the input. */
+    while (*length >= 28) {
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)*data)),
+                                             _mm_loadu_si128((const __m128i *)(*data + 12)), 1);
+        _mm256_storeu_si256((__m256i *)*out, encode_block_avx2(in));
+        *data += 24;
+        *length -= 24;
+        *out += 32;
+    }
+}
+
+static void decode_blocks_avx2(const uint8_t **encoded_data, size_t *length, uint8_t **out)
+{
+    /* Stores 32 bytes for 24 decoded ones, so at least 16 characters must be left after a block. */
+    while (*length >= 48) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)*encoded_data);
+
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0F));
+        __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0F));
+        __m256i hi = _mm256_shuffle_epi8(_mm256_setr_epi8(KAA_BASE64_VALIDATION_LUT_HI, KAA_BASE64_VALIDATION_LUT_HI),
+                                         hi_nibbles);
+        __m256i lo = _mm256_shuffle_epi8(_mm256_setr_epi8(KAA_BASE64_VALIDATION_LUT_LO, KAA_BASE64_VALIDATION_LUT_LO),
+                                         lo_nibbles);
+
+        /* Padding and invalid characters are left to the table-driven code. */
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+
+        __m256i is_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        __m256i roll = _mm256_shuffle_epi8(_mm256_setr_epi8(KAA_BASE64_ROLL_LUT, KAA_BASE64_ROLL_LUT),
+                                           _mm256_add_epi8(is_slash, hi_nibbles));
+        __m256i sextets = _mm256_add_epi8(in, roll);
+
+        /* Merges 4 sextets into 24 bits and packs them. */
+        __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140)),
+                                           _mm256_set1_epi32(0x00011000));
+        merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(KAA_BASE64_PACK_SHUFFLE, KAA_BASE64_PACK_SHUFFLE));
+        merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        _mm256_storeu_si256((__m256i *)*out, merged);
+        *encoded_data += 32;
+        *length -= 32;
+        *out += 24;
+    }
+}
+
+#endif
+
+#ifdef KAA_BASE64_SSSE3
+
+static void encode_blocks_ssse3(const uint8_t **data, size_t *length, uint8_t **out)
+{
+    /* Loads 16 bytes for 12 ones, so the load must not cross the input. */
+    while (*length >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)*data);
+        in = _mm_shuffle_epi8(in, _mm_setr_epi8(KAA_BASE64_SPLIT_SHUFFLE));
+
+        __m128i indices = _mm_or_si128(
+                _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040)),
+                _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010)));
+
+        __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+
+        _mm_storeu_si128((__m128i *)*out,
+                         _mm_add_epi8(indices, _mm_shuffle_epi8(_mm_setr_epi8(KAA_BASE64_SHIFT_LUT), ranges)));
+        *data += 12;
+        *length -= 12;
+        *out += 16;
+    }
+}
+
+static void decode_blocks_ssse3(const uint8_t **encoded_data, size_t *length, uint8_t **out)
+{
+    /* Stores 16 bytes for 12 decoded ones, so at least 8 characters must be left after a block. */
+    while (*length >= 24) {
+        __m128i in = _mm_loadu_si128((const __m128i *)*encoded_data);
+
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0F));
+        __m128i lo_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0F));
+        __m128i hi = _mm_shuffle_epi8(_mm_setr_epi8(KAA_BASE64_VALIDATION_LUT_HI), hi_nibbles);
+        __m128i lo = _mm_shuffle_epi8(_mm_setr_epi8(KAA_BASE64_VALIDATION_LUT_LO), lo_nibbles);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+
+        __m128i is_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        __m128i roll = _mm_shuffle_epi8(_mm_setr_epi8(KAA_BASE64_ROLL_LUT), _mm_add_epi8(is_slash, hi_nibbles));
+        __m128i sextets = _mm_add_epi8(in, roll);
+
+        __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140)),
+                                        _mm_set1_epi32(0x00011000));
+
+        _mm_storeu_si128((__m128i *)*out, _mm_shuffle_epi8(merged, _mm_setr_epi8(KAA_BASE64_PACK_SHUFFLE)));
+        *encoded_data += 16;
+        *length -= 16;
+        *out += 12;
+    }
+}
+
+#endif
+
+#ifdef KAA_BASE64_NEON
+
+static void encode_blocks_neon(const uint8_t **data, size_t *length, uint8_t **out)
+{
+    const uint8_t *alphabet = (const uint8_t *)encoding_table;
+    uint8x16x4_t lut = { { vld1q_u8(alphabet), vld1q_u8(alphabet + 16),
+                           vld1q_u8(alphabet + 32), vld1q_u8(alphabet + 48) } };
+    uint8x16_t sextet_mask = vdupq_n_u8(0x3F);
+
+    while (*length >= 48) {
+        /* Deinterleaves 16 triples of bytes. */
+        uint8x16x3_t in = vld3q_u8(*data);
+        uint8x16x4_t indices;
+
+        indices.val[0] = vshrq_n_u8(in.val[0], 2);
+        indices.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[1], 4), vshlq_n_u8(in.val[0], 4)), sextet_mask);
+        indices.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[2], 6), vshlq_n_u8(in.val[1], 2)), sextet_mask);
+        indices.val[3] = vandq_u8(in.val[2], sextet_mask);
+
+        uint8x16x4_t encoded;
+        encoded.val[0] = vqtbl4q_u8(lut, indices.val[0]);
+        encoded.val[1] = vqtbl4q_u8(lut, indices.val[1]);
+        encoded.val[2] = vqtbl4q_u8(lut, indices.val[2]);
+        encoded.val[3] = vqtbl4q_u8(lut, indices.val[3]);
+
+        vst4q_u8(*out, encoded);
+        *data += 48;
+        *length -= 48;
+        *out += 64;
+    }
+}
+
+static void decode_blocks_neon(const uint8_t **encoded_data, size_t *length, uint8_t **out)
+{
+    /* The table lookups cover ASCII, characters above it are out of range and give 0. */
+    uint8x16x4_t lut_lo = { { vld1q_u8(decoding_table), vld1q_u8(decoding_table + 16),
+                              vld1q_u8(decoding_table + 32), vld1q_u8(decoding_table + 48) } };
+    uint8x16x4_t lut_hi = { { vld1q_u8(decoding_table + 64), vld1q_u8(decoding_table + 80),
+                              vld1q_u8(decoding_table + 96), vld1q_u8(decoding_table + 112) } };
+    uint8x16_t hi_offset = vdupq_n_u8(64);
+    uint8x16_t non_ascii_mask = vdupq_n_u8(0x80);
+
+    while (*length >= 64) {
+        uint8x16x4_t in = vld4q_u8(*encoded_data);
+        uint8x16x4_t sextets;
+        uint8x16_t invalid = vdupq_n_u8(0);
+
+        for (int i = 0; i < 4; ++i) {
+            sextets.val[i] = vorrq_u8(vqtbl4q_u8(lut_lo, in.val[i]),
+                                      vqtbl4q_u8(lut_hi, vsubq_u8(in.val[i], hi_offset)));
+            invalid = vorrq_u8(invalid, vorrq_u8(sextets.val[i], vandq_u8(in.val[i], non_ascii_mask)));
+        }
+
+        /* Padding and invalid characters are left to the table-driven code. */
+        if (vmaxvq_u8(invalid) > 0x3F) {
+            break;
+        }
+
+        uint8x16x3_t decoded;
+        decoded.val[0] = vorrq_u8(vshlq_n_u8(sextets.val[0], 2), vshrq_n_u8(sextets.val[1], 4));
+        decoded.val[1] = vorrq_u8(vshlq_n_u8(sextets.val[1], 4), vshrq_n_u8(sextets.val[2], 2));
+        decoded.val[2] = vorrq_u8(vshlq_n_u8(sextets.val[2], 6), sextets.val[3]);
+
+        vst3q_u8(*out, decoded);
+        *encoded_data += 64;
+        *length -= 64;
+        *out += 48;
+    }
+}
+
+#endif
+
+
+
+kaa_error_t kaa_base64_encode(const char *data, size_t data_length, char *encoded_data, size_t *encoded_data_length)
+{
+    KAA_RETURN_IF_NIL3(data, encoded_data, encoded_data_length, KAA_ERR_BADPARAM);
+
+    size_t encoded_length = KAA_BASE64_ENCODED_LENGTH(data_length);
+    if (encoded_length > *encoded_data_length) return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
+
+    const uint8_t *in = (const uint8_t *)data;
+    uint8_t *out = (uint8_t *)encoded_data;
+    size_t remaining_length = data_length;
+
+#ifdef KAA_BASE64_AVX2
+    encode_blocks_avx2(&in, &remaining_length, &out);
+#endif
+#ifdef KAA_BASE64_SSSE3
+    encode_blocks_ssse3(&in, &remaining_length, &out);
+#endif
+#ifdef KAA_BASE64_NEON
+    encode_blocks_neon(&in, &remaining_length, &out);
+#endif
+
+    for (; remaining_length >= 3; remaining_length -= 3, in += 3) {
+        uint32_t triple = ((uint32_t)in[0] << 2 * 8) | ((uint32_t)in[1] << 1 * 8) | in[2];
+
+        *out++ = encoding_table[(triple >> 3 * 6) & 0x3F];
+        *out++ = encoding_table[(triple >> 2 * 6) & 0x3F];
+        *out++ = encoding_table[(triple >> 1 * 6) & 0x3F];
+        *out++ = encoding_table[(triple >> 0 * 6) & 0x3F];
+    }
+
+    if (remaining_length) {
+        uint32_t triple = ((uint32_t)in[0] << 2 * 8) | (remaining_length > 1 ? (uint32_t)in[1] << 1 * 8 : 0);
+
+        *out++ = encoding_table[(triple >> 3 * 6) & 0x3F];
+        *out++ = encoding_table[(triple >> 2 * 6) & 0x3F];
+        *out++ = remaining_length > 1 ? encoding_table[(triple >> 1 * 6) & 0x3F] : KAA_BASE64_PADDING;
+        *out++ = KAA_BASE64_PADDING;
+    }
+
+    *encoded_data_length = encoded_length;
+    return KAA_ERR_NONE;
+}
+
+
+
+/*
+ * Decodes 2, 3 or 4 characters into 1, 2 or 3 bytes respectively.
+ */
+static kaa_error_t decode_quad(const uint8_t *in, size_t character_count, uint8_t *out)
+{
+    uint32_t triple = 0;
+    uint8_t invalid = 0;
+
+    for (size_t i = 0; i < 4; ++i) {
+        uint8_t sextet = i < character_count ? decoding_table[in[i]] : 0;
+        invalid |= sextet;
+        triple = (triple << 6) | (sextet & 0x3F);
+    }
+
+    if (invalid > 0x3F) return KAA_ERR_BADPARAM;
+
+    for (size_t i = 0; i < character_count - 1; ++i) {
+        out[i] = (triple >> (2 - i) * 8) & 0xFF;
+    }
+
+    return KAA_ERR_NONE;
+}
 
 kaa_error_t kaa_base64_decode(const char *encoded_data, size_t encoded_data_length, char *decoded_data, size_t *decoded_data_length)
 {
@@ -67,30 +378,40 @@ kaa_error_t kaa_base64_decode(const char *encoded_data, size_t encoded_data_leng
 
     if (encoded_data_length % 4 != 0) return KAA_ERR_BADPARAM;
 
-    size_t remainig_decoded_length = encoded_data_length / 4 * 3;
-    if (remainig_decoded_length > *decoded_data_length) return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
+    size_t padding_length = 0;
+    if (encoded_data_length && encoded_data[encoded_data_length - 1] == KAA_BASE64_PADDING) {
+        padding_length = encoded_data[encoded_data_length - 2] == KAA_BASE64_PADDING ? 2 : 1;
+    }
+
+    size_t decoded_length = encoded_data_length / 4 * 3 - padding_length;
+    if (decoded_length > *decoded_data_length) return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
 
-    *decoded_data_length = remainig_decoded_length;
+    const uint8_t *in = (const uint8_t *)encoded_data;
+    uint8_t *out = (uint8_t *)decoded_data;
 
-    if (encoded_data[encoded_data_length - 1] == '=') (*decoded_data_length)--;
-    if (encoded_data[encoded_data_length - 2] == '=') (*decoded_data_length)--;
+    /* The last quad with padding is decoded separately. */
+    size_t remaining_length = encoded_data_length - (padding_length ? 4 : 0);
 
-    int i = 0, j = 0;
-    while (i < encoded_data_length) {
-        uint32_t sextet_a = encoded_data[i] == '=' ? 0 & i++ : decoding_table[(int)encoded_data[i++]];
-        uint32_t sextet_b = encoded_data[i] == '=' ? 0 & i++ : decoding_table[(int)encoded_data[i++]];
-        uint32_t sextet_c = encoded_data[i] == '=' ? 0 & i++ : decoding_table[(int)encoded_data[i++]];
-        uint32_t sextet_d = encoded_data[i] == '=' ? 0 & i++ : decoding_table[(int)encoded_data[i++]];
+#ifdef KAA_BASE64_AVX2
+    decode_blocks_avx2(&in, &remaining_length, &out);
+#endif
+#ifdef KAA_BASE64_SSSE3
+    decode_blocks_ssse3(&in, &remaining_length, &out);
+#endif
+#ifdef KAA_BASE64_NEON
+    decode_blocks_neon(&in, &remaining_length, &out);
+#endif
 
-        uint32_t triple = (sextet_a << 3 * 6)
-        + (sextet_b << 2 * 6)
-        + (sextet_c << 1 * 6)
-        + (sextet_d << 0 * 6);
+    for (; remaining_length; remaining_length -= 4, in += 4, out += 3) {
+        kaa_error_t error_code = decode_quad(in, 4, out);
+        if (error_code) return error_code;
+    }
 
-        if (j < *decoded_data_length) decoded_data[j++] = (triple >> 2 * 8) & 0xFF;
-        if (j < *decoded_data_length) decoded_data[j++] = (triple >> 1 * 8) & 0xFF;
-        if (j < *decoded_data_length) decoded_data[j++] = (triple >> 0 * 8) & 0xFF;
+    if (padding_length) {
+        kaa_error_t error_code = decode_quad(in, 4 - padding_length, out);
+        if (error_code) return error_code;
     }
 
+    *decoded_data_length = decoded_length;
     return KAA_ERR_NONE;
 }
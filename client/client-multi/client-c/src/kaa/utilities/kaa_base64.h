@@ -17,19 +17,39 @@
 /*
  * @file kaa_base64.h
  *
- * @breaf Decode base64 encoded data
+ * @breaf Encode and decode base64 data
  *
  */
 
 #ifndef KAA_BASE64_H_
 #define KAA_BASE64_H_
 
+#include <stddef.h>
+
 #include "kaa_error.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * The length of base64 encoded data of the given length, padding included.
+ */
+#define KAA_BASE64_ENCODED_LENGTH(length)   (((length) + 2) / 3 * 4)
+
+/**
+ * @brief Encode data in base64 with padding
+ *
+ * @param[in]       data                Pointer to data buffer
+ * @param[in]       data_length         Size of data buffer
+ * @param[out]      encoded_data        Pointer to output encoded data buffer, the encoded data isn't null-terminated
+ * @param[in,out]   encoded_data_length Size of output buffer on [in] and size of encoded data on [out]
+ *                                      the buffer should be at least @link KAA_BASE64_ENCODED_LENGTH @endlink
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_base64_encode(const char *data, size_t data_length, char *encoded_data, size_t *encoded_data_length);
+
 /**
  * @brief Decode base64 encoded data
  *
@@ -38,9 +58,9 @@ extern "C" {
  * @param[out]      decoded_data        Pointer to output decoded data buffer
  * @param[in,out]   decoded_data_length Size of output buffer on [in] and size of decoded data on [out]
  *                                      base64_decode() checks that buffer for decoded data have enough length
- *                                      length ration is 3:4 (decoded/encoded)
+ *                                      length ration is 3:4 (decoded/encoded) without padding
  *
- * @return Error code.
+ * @return Error code, @c KAA_ERR_BADPARAM if the data contains characters outside of the base64 alphabet.
  */
 kaa_error_t kaa_base64_decode(const char *encoded_data, size_t encoded_data_length, char *decoded_data, size_t *decoded_data_length);
 
@@ -16,33 +16,68 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include "kaa_buffer.h"
 #include "kaa_mem.h"
 #include "kaa_common.h"
 
 
+/*
+ * head and tail are free-running counters, the offsets are taken by masking them with capacity - 1.
+ * The buffer is empty when they are equal and full when they differ by the capacity.
+ */
 struct kaa_buffer_t {
-    char    *begin;
-    char    *end;
-    char    *current;
+    char      *data;
+    size_t    capacity;
+    size_t    head;
+    size_t    tail;
 };
 
 
+static size_t kaa_buffer_round_up_capacity(size_t size)
+{
+    size_t capacity = 1;
+    while (capacity < size && capacity <= KAA_BUFFER_MAX_SIZE) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static size_t kaa_buffer_locked_size(const kaa_buffer_t *buffer_p)
+{
+    return buffer_p->tail - buffer_p->head;
+}
+
+static size_t kaa_buffer_contiguous_free_size(const kaa_buffer_t *buffer_p)
+{
+    size_t free_size = buffer_p->capacity - kaa_buffer_locked_size(buffer_p);
+    size_t tail_offset = buffer_p->tail & (buffer_p->capacity - 1);
+    size_t till_end = buffer_p->capacity - tail_offset;
+    return free_size < till_end ? free_size : till_end;
+}
+
+
 kaa_error_t kaa_buffer_create_buffer(kaa_buffer_t **buffer_p, size_t buffer_size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, buffer_size, KAA_ERR_BADPARAM);
 
+    size_t capacity = kaa_buffer_round_up_capacity(buffer_size);
+    if (capacity > KAA_BUFFER_MAX_SIZE) {
+        return KAA_ERR_BADPARAM;
+    }
+
     kaa_buffer_t *buffer = (kaa_buffer_t *) KAA_MALLOC(sizeof(kaa_buffer_t));
     KAA_RETURN_IF_NIL(buffer, KAA_ERR_NOMEM);
 
-    buffer->begin = (char *) KAA_CALLOC(buffer_size , sizeof(char));
-    if (!buffer->begin) {
+    buffer->data = (char *) KAA_CALLOC(capacity, sizeof(char));
+    if (!buffer->data) {
         KAA_FREE(buffer);
         return KAA_ERR_NOMEM;
     }
 
-    buffer->end = buffer->begin + buffer_size;
-    buffer->current = buffer->begin;
+    buffer->capacity = capacity;
+    buffer->head = 0;
+    buffer->tail = 0;
     *buffer_p = buffer;
     return KAA_ERR_NONE;
 }
@@ -52,8 +87,8 @@ kaa_error_t kaa_buffer_destroy(kaa_buffer_t *buffer_p)
 {
     KAA_RETURN_IF_NIL(buffer_p, KAA_ERR_BADPARAM);
 
-    if (buffer_p->begin)
-        KAA_FREE(buffer_p->begin);
+    if (buffer_p->data)
+        KAA_FREE(buffer_p->data);
 
     KAA_FREE(buffer_p);
 
@@ -65,8 +100,8 @@ kaa_error_t kaa_buffer_allocate_space(kaa_buffer_t *buffer_p, char **buffer, siz
 {
     KAA_RETURN_IF_NIL3(buffer_p, buffer, free_size, KAA_ERR_BADPARAM);
 
-    *buffer = buffer_p->current;
-    *free_size = buffer_p->end - buffer_p->current;
+    *buffer = buffer_p->data + (buffer_p->tail & (buffer_p->capacity - 1));
+    *free_size = kaa_buffer_contiguous_free_size(buffer_p);
 
     return KAA_ERR_NONE;
 }
@@ -74,31 +109,49 @@ kaa_error_t kaa_buffer_allocate_space(kaa_buffer_t *buffer_p, char **buffer, siz
 kaa_error_t kaa_buffer_reallocate_space(kaa_buffer_t *buffer_p, size_t size)
 {
     KAA_RETURN_IF_NIL(buffer_p, KAA_ERR_BADPARAM);
-    size_t locked_space    = buffer_p->current - buffer_p->begin;
-    size_t total_space     = buffer_p->end     - buffer_p->begin;
-    size_t new_buffer_size = size + locked_space;
-    char *ptr;
 
-    if (total_space >= new_buffer_size)
-        return KAA_ERR_BADPARAM;
+    if (kaa_buffer_contiguous_free_size(buffer_p) >= size)
+        return KAA_ERR_NONE;
+
+    size_t locked_space = kaa_buffer_locked_size(buffer_p);
+    if (size > KAA_BUFFER_MAX_SIZE - locked_space)
+        return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
 
-    ptr = KAA_REALLOC(buffer_p->begin, new_buffer_size);
+    /*
+     * Keeps the capacity if only the wrapped data prevents the contiguous write,
+     * the data is moved to the beginning of the storage then.
+     */
+    size_t capacity = kaa_buffer_round_up_capacity(locked_space + size);
+    if (capacity < buffer_p->capacity)
+        capacity = buffer_p->capacity;
+    if (capacity > KAA_BUFFER_MAX_SIZE)
+        return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
 
-    if (ptr) {
-        buffer_p->begin = ptr;
-        buffer_p->end = buffer_p->begin + new_buffer_size;
-        buffer_p->current = buffer_p->begin + locked_space;
-        return KAA_ERR_NONE;
-    }
+    char *data = (char *) KAA_MALLOC(capacity);
+    KAA_RETURN_IF_NIL(data, KAA_ERR_NOMEM);
 
-    return KAA_ERR_NOMEM;
+    size_t head_offset = buffer_p->head & (buffer_p->capacity - 1);
+    size_t first_part = buffer_p->capacity - head_offset;
+    if (first_part > locked_space)
+        first_part = locked_space;
+
+    memcpy(data, buffer_p->data + head_offset, first_part);
+    memcpy(data + first_part, buffer_p->data, locked_space - first_part);
+
+    KAA_FREE(buffer_p->data);
+    buffer_p->data = data;
+    buffer_p->capacity = capacity;
+    buffer_p->head = 0;
+    buffer_p->tail = locked_space;
+
+    return KAA_ERR_NONE;
 }
 
 kaa_error_t kaa_buffer_get_locked_space(kaa_buffer_t *buffer_p, size_t *size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, size, KAA_ERR_BADPARAM);
 
-    *size = buffer_p->current - buffer_p->begin;
+    *size = kaa_buffer_locked_size(buffer_p);
 
     return KAA_ERR_NONE;
 }
@@ -107,7 +160,7 @@ kaa_error_t kaa_buffer_get_size(kaa_buffer_t *buffer_p, size_t *size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, size, KAA_ERR_BADPARAM);
 
-    *size = buffer_p->end - buffer_p->begin;
+    *size = buffer_p->capacity;
 
     return KAA_ERR_NONE;
 }
@@ -116,7 +169,7 @@ kaa_error_t kaa_buffer_get_free_space(kaa_buffer_t *buffer_p, size_t *size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, size, KAA_ERR_BADPARAM);
 
-    *size = buffer_p->end - buffer_p->current;
+    *size = kaa_buffer_contiguous_free_size(buffer_p);
 
     return KAA_ERR_NONE;
 }
@@ -125,10 +178,10 @@ kaa_error_t kaa_buffer_lock_space(kaa_buffer_t *buffer_p, size_t lock_size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, lock_size, KAA_ERR_BADPARAM);
 
-    if (buffer_p->current + lock_size > buffer_p->end)
+    if (lock_size > kaa_buffer_contiguous_free_size(buffer_p))
         return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
 
-    buffer_p->current += lock_size;
+    buffer_p->tail += lock_size;
     return KAA_ERR_NONE;
 }
 
@@ -137,15 +190,16 @@ kaa_error_t kaa_buffer_free_allocated_space(kaa_buffer_t *buffer_p, size_t size)
 {
     KAA_RETURN_IF_NIL2(buffer_p, size, KAA_ERR_BADPARAM);
 
-    if (buffer_p->begin + size > buffer_p->current)
+    if (size > kaa_buffer_locked_size(buffer_p))
         return KAA_ERR_BUFFER_INVALID_SIZE;
 
-    char *byte_to_copy = buffer_p->begin + size;
-    char *it = buffer_p->begin;
-    for (; byte_to_copy != buffer_p->current; ++byte_to_copy, ++it)
-        *it = *byte_to_copy;
+    buffer_p->head += size;
 
-    buffer_p->current -= size;
+    /* Rewinds the empty buffer so that the next write gets the whole storage contiguously */
+    if (buffer_p->head == buffer_p->tail) {
+        buffer_p->head = 0;
+        buffer_p->tail = 0;
+    }
 
     return KAA_ERR_NONE;
 }
@@ -157,8 +211,12 @@ kaa_error_t kaa_buffer_get_unprocessed_space(kaa_buffer_t *buffer_p
 {
     KAA_RETURN_IF_NIL3(buffer_p, buffer, available_size, KAA_ERR_BADPARAM);
 
-    *buffer = buffer_p->begin;
-    *available_size = buffer_p->current - buffer_p->begin;
+    size_t locked_space = kaa_buffer_locked_size(buffer_p);
+    size_t head_offset = buffer_p->head & (buffer_p->capacity - 1);
+    size_t till_end = buffer_p->capacity - head_offset;
+
+    *buffer = buffer_p->data + head_offset;
+    *available_size = locked_space < till_end ? locked_space : till_end;
 
     return KAA_ERR_NONE;
 }
@@ -167,7 +225,7 @@ kaa_error_t kaa_buffer_get_unprocessed_space(kaa_buffer_t *buffer_p
 kaa_error_t kaa_buffer_reset(kaa_buffer_t *buffer_p)
 {
     KAA_RETURN_IF_NIL(buffer_p, KAA_ERR_BADPARAM);
-    buffer_p->current = buffer_p->begin;
+    buffer_p->head = 0;
+    buffer_p->tail = 0;
     return KAA_ERR_NONE;
 }
-
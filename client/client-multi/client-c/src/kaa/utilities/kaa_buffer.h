@@ -24,33 +24,76 @@
 extern "C" {
 #endif
 
+/**
+ * The upper bound of the buffer capacity, growing beyond it fails with KAA_ERR_BUFFER_IS_NOT_ENOUGH.
+ */
+#ifndef KAA_BUFFER_MAX_SIZE
+#define KAA_BUFFER_MAX_SIZE    (4 * 1024 * 1024)
+#endif
+
+/**
+ * Ring buffer with the power-of-two capacity.
+ *
+ * Bytes are written to the contiguous span returned by @link kaa_buffer_allocate_space @endlink
+ * and committed by @link kaa_buffer_lock_space @endlink. They are read from the contiguous span
+ * returned by @link kaa_buffer_get_unprocessed_space @endlink and released by
+ * @link kaa_buffer_free_allocated_space @endlink. Neither operation moves the stored bytes,
+ * so the data may wrap around: both spans may be shorter than the total free and locked space.
+ */
 typedef struct kaa_buffer_t kaa_buffer_t;
 
 
 
+/**
+ * Creates the buffer. The capacity is @p buffer_size rounded up to the power of two.
+ */
 kaa_error_t kaa_buffer_create_buffer(kaa_buffer_t **buffer_p
                                    , size_t buffer_size);
 
 kaa_error_t kaa_buffer_destroy(kaa_buffer_t *buffer_p);
 
+/**
+ * Returns the contiguous span available for writing.
+ */
 kaa_error_t kaa_buffer_allocate_space(kaa_buffer_t *buffer_p
                                     , char **buffer
                                     , size_t *free_size);
 
+/**
+ * Makes sure that at least @p size bytes can be written contiguously.
+ *
+ * The capacity is doubled until the locked bytes and @p size fit, the locked bytes are
+ * moved to the beginning of the new storage. Does nothing if the space is available already.
+ */
 kaa_error_t kaa_buffer_reallocate_space(kaa_buffer_t *buffer_p, size_t size);
 
+/**
+ * Returns the total number of the locked bytes.
+ */
 kaa_error_t kaa_buffer_get_locked_space(kaa_buffer_t *buffer_p, size_t *size);
 
 kaa_error_t kaa_buffer_get_size(kaa_buffer_t *buffer_p, size_t *size);
 
+/**
+ * Returns the size of the contiguous span available for writing.
+ */
 kaa_error_t kaa_buffer_get_free_space(kaa_buffer_t *buffer_p, size_t *size);
 
+/**
+ * Commits @p lock_size bytes written to the span returned by @link kaa_buffer_allocate_space @endlink.
+ */
 kaa_error_t kaa_buffer_lock_space(kaa_buffer_t *buffer_p
                                 , size_t lock_size);
 
+/**
+ * Releases @p size of the oldest locked bytes.
+ */
 kaa_error_t kaa_buffer_free_allocated_space(kaa_buffer_t *buffer_p
                                           , size_t size);
 
+/**
+ * Returns the contiguous span of the oldest locked bytes.
+ */
 kaa_error_t kaa_buffer_get_unprocessed_space(kaa_buffer_t *buffer_p
                                            , char **buffer
                                            , size_t *available_size);
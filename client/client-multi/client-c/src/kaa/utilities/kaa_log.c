@@ -16,6 +16,7 @@
 
 #include <stddef.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <string.h>
 #include "kaa_log.h"
 #include "kaa_common.h"
@@ -44,11 +45,35 @@ static const char* kaa_log_level_name[] =
     , "TRACE"
 };
 
+#ifdef KAA_BINARY_LOGGING
+
+#define KAA_BINARY_LOG_VERSION          1
+/* Lines of the dump start with these, so the dump can be picked out of a console capture */
+#define KAA_BINARY_LOG_DUMP_BEGIN       "KLOG-DUMP\n"
+#define KAA_BINARY_LOG_DUMP_PREFIX      "KLOG "
+#define KAA_BINARY_LOG_DUMP_LINE_SIZE   32
+
+#define KAA_FNV1A_OFFSET_BASIS          2166136261u
+#define KAA_FNV1A_PRIME                 16777619u
+
+/*
+ * The record header, stored unaligned in the host byte order:
+ * uint16 record size, uint8 log level, uint32 time, uint32 format id, uint16 line, int32 error code.
+ */
+#define KAA_BINARY_LOG_RECORD_HEADER_SIZE   17
+
+#endif
+
 struct kaa_logger_t {
     FILE           *sink;
     kaa_log_level_t max_log_level;
     char           *log_buffer;
     size_t          buffer_size;
+#ifdef KAA_BINARY_LOGGING
+    char           *ring;
+    size_t          ring_begin;
+    size_t          ring_used;
+#endif
 };
 
 kaa_error_t kaa_log_create(kaa_logger_t **logger_p, size_t buffer_size, kaa_log_level_t max_log_level, FILE* sink)
@@ -69,6 +94,18 @@ kaa_error_t kaa_log_create(kaa_logger_t **logger_p, size_t buffer_size, kaa_log_
 
     (*logger_p)->buffer_size = buffer_size;
 
+#ifdef KAA_BINARY_LOGGING
+    (*logger_p)->ring = (char *) KAA_MALLOC(KAA_BINARY_LOG_RING_SIZE);
+    if (!(*logger_p)->ring) {
+        KAA_FREE((*logger_p)->log_buffer);
+        KAA_FREE(*logger_p);
+        *logger_p = NULL;
+        return KAA_ERR_NOMEM;
+    }
+    (*logger_p)->ring_begin = 0;
+    (*logger_p)->ring_used = 0;
+#endif
+
     (*logger_p)->sink = sink ? sink : stdout;
     (*logger_p)->max_log_level = max_log_level;
 #ifdef KAA_TRACE_MEMORY_ALLOCATIONS
@@ -84,6 +121,9 @@ kaa_error_t kaa_log_destroy(kaa_logger_t *logger)
     kaa_trace_memory_allocs_set_logger(NULL);
 #endif
     KAA_FREE(logger->log_buffer);
+#ifdef KAA_BINARY_LOGGING
+    KAA_FREE(logger->ring);
+#endif
     KAA_FREE(logger);
     return KAA_ERR_NONE;
 }
@@ -112,6 +152,308 @@ kaa_error_t kaa_log_set_sink(kaa_logger_t *self, FILE *sink)
     return KAA_ERR_NONE;
 }
 
+#ifdef KAA_BINARY_LOGGING
+
+static uint32_t kaa_log_hash(uint32_t hash, const char *str)
+{
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= KAA_FNV1A_PRIME;
+    }
+    return hash;
+}
+
+static bool kaa_log_put(char **cursor, const char *end, const void *data, size_t size)
+{
+    if ((size_t)(end - *cursor) < size) {
+        return false;
+    }
+    memcpy(*cursor, data, size);
+    *cursor += size;
+    return true;
+}
+
+#define KAA_LOG_PUT_ARG(type) \
+    do { type value = va_arg(args, type); if (!kaa_log_put(&cursor, end, &value, sizeof(value))) return cursor; } while (0)
+
+/*
+ * Stores the raw arguments the format refers to. The arguments which don't fit are dropped,
+ * the decoder reports the message as truncated then.
+ */
+static char *kaa_log_put_args(char *cursor, const char *end, const char *format, va_list args)
+{
+    while (*format) {
+        if (*format++ != '%') {
+            continue;
+        }
+
+        while (*format && strchr("-+ #0", *format)) {
+            ++format;
+        }
+
+        if (*format == '*') {
+            KAA_LOG_PUT_ARG(int);
+            ++format;
+        }
+        while (*format >= '0' && *format <= '9') {
+            ++format;
+        }
+
+        int precision = -1;
+        if (*format == '.') {
+            ++format;
+            if (*format == '*') {
+                precision = va_arg(args, int);
+                if (!kaa_log_put(&cursor, end, &precision, sizeof(precision))) {
+                    return cursor;
+                }
+                ++format;
+            } else {
+                precision = 0;
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        char length = 0;
+        switch (*format) {
+        case 'h':
+            while (*format == 'h') {
+                ++format;
+            }
+            break;
+        case 'l':
+            length = *format++;
+            if (*format == 'l') {
+                length = 'q';
+                ++format;
+            }
+            break;
+        case 'z':
+        case 'j':
+        case 't':
+        case 'L':
+            length = *format++;
+            break;
+        }
+
+        switch (*format) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            switch (length) {
+            case 'l': KAA_LOG_PUT_ARG(long); break;
+            case 'q': KAA_LOG_PUT_ARG(long long); break;
+            case 'z': KAA_LOG_PUT_ARG(size_t); break;
+            case 'j': KAA_LOG_PUT_ARG(intmax_t); break;
+            case 't': KAA_LOG_PUT_ARG(ptrdiff_t); break;
+            default: KAA_LOG_PUT_ARG(int); break;
+            }
+            break;
+        case 'c':
+            KAA_LOG_PUT_ARG(int);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if (length == 'L') {
+                double value = (double)va_arg(args, long double);
+                if (!kaa_log_put(&cursor, end, &value, sizeof(value))) {
+                    return cursor;
+                }
+            } else {
+                KAA_LOG_PUT_ARG(double);
+            }
+            break;
+        case 'p':
+            KAA_LOG_PUT_ARG(void *);
+            break;
+        case 's': {
+            const char *str = va_arg(args, const char *);
+            if (!str) {
+                str = "(null)";
+            }
+            size_t str_length = 0;
+            size_t max_length = (precision >= 0 && precision < KAA_BINARY_LOG_MAX_STRING_LENGTH)
+                              ? (size_t)precision : KAA_BINARY_LOG_MAX_STRING_LENGTH;
+            while (str_length < max_length && str[str_length]) {
+                ++str_length;
+            }
+            uint8_t stored_length = (uint8_t)str_length;
+            if (!kaa_log_put(&cursor, end, &stored_length, sizeof(stored_length))
+                    || !kaa_log_put(&cursor, end, str, str_length)) {
+                return cursor;
+            }
+            break;
+        }
+        case 'n':
+            (void)va_arg(args, void *);
+            break;
+        case '\0':
+            return cursor;
+        }
+        ++format;
+    }
+    return cursor;
+}
+
+static void kaa_log_ring_read(const kaa_logger_t *self, size_t offset, void *data, size_t size)
+{
+    size_t position = (self->ring_begin + offset) % KAA_BINARY_LOG_RING_SIZE;
+    size_t first_part = KAA_BINARY_LOG_RING_SIZE - position;
+    if (first_part >= size) {
+        memcpy(data, self->ring + position, size);
+    } else {
+        memcpy(data, self->ring + position, first_part);
+        memcpy((char *)data + first_part, self->ring, size - first_part);
+    }
+}
+
+/*
+ * Adds the record to the ring, the oldest records are dropped to make room for it.
+ */
+static void kaa_log_ring_push(kaa_logger_t *self, const char *record, size_t size)
+{
+    if (size > KAA_BINARY_LOG_RING_SIZE) {
+        return;
+    }
+
+    while (KAA_BINARY_LOG_RING_SIZE - self->ring_used < size) {
+        uint16_t oldest_size = 0;
+        kaa_log_ring_read(self, 0, &oldest_size, sizeof(oldest_size));
+        self->ring_begin = (self->ring_begin + oldest_size) % KAA_BINARY_LOG_RING_SIZE;
+        self->ring_used -= oldest_size;
+    }
+
+    size_t position = (self->ring_begin + self->ring_used) % KAA_BINARY_LOG_RING_SIZE;
+    size_t first_part = KAA_BINARY_LOG_RING_SIZE - position;
+    if (first_part >= size) {
+        memcpy(self->ring + position, record, size);
+    } else {
+        memcpy(self->ring + position, record, first_part);
+        memcpy(self->ring, record + first_part, size - first_part);
+    }
+    self->ring_used += size;
+}
+
+void kaa_log_write(kaa_logger_t *self, const char* source_file, int lineno, kaa_log_level_t log_level
+        , kaa_error_t error_code, const char* format, ...)
+{
+    if (!self || (log_level > self->max_log_level))
+        return;
+
+    // Truncate the file name
+    char* path_separator_pos = strrchr(source_file, '/');
+    path_separator_pos = (path_separator_pos ? path_separator_pos : strrchr(source_file, '\\'));
+    const char* truncated_name = (path_separator_pos ? path_separator_pos + 1 : source_file);
+
+    char *cursor = self->log_buffer;
+    const char *end = self->log_buffer + (self->buffer_size < UINT16_MAX ? self->buffer_size : UINT16_MAX);
+
+    uint16_t record_size = 0;
+    uint32_t time = (uint32_t)ext_get_systime();
+    uint32_t format_id = kaa_log_hash(kaa_log_hash(KAA_FNV1A_OFFSET_BASIS, truncated_name), format);
+    uint16_t line = (uint16_t)lineno;
+    int32_t error = error_code;
+
+    if (!kaa_log_put(&cursor, end, &record_size, sizeof(record_size))
+            || !kaa_log_put(&cursor, end, &log_level, sizeof(log_level))
+            || !kaa_log_put(&cursor, end, &time, sizeof(time))
+            || !kaa_log_put(&cursor, end, &format_id, sizeof(format_id))
+            || !kaa_log_put(&cursor, end, &line, sizeof(line))
+            || !kaa_log_put(&cursor, end, &error, sizeof(error))) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    cursor = kaa_log_put_args(cursor, end, format, args);
+    va_end(args);
+
+    record_size = (uint16_t)(cursor - self->log_buffer);
+    memcpy(self->log_buffer, &record_size, sizeof(record_size));
+
+    kaa_log_ring_push(self, self->log_buffer, record_size);
+}
+
+/*
+ * Prints the data as hex, KAA_BINARY_LOG_DUMP_LINE_SIZE bytes per line at most.
+ */
+static void kaa_log_dump_bytes(kaa_logger_t *self, size_t *line_length, const uint8_t *data, size_t size)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    const size_t prefix_length = sizeof(KAA_BINARY_LOG_DUMP_PREFIX) - 1;
+    size_t max_line_length = (self->buffer_size - prefix_length - 2) / 2;
+    if (max_line_length > KAA_BINARY_LOG_DUMP_LINE_SIZE) {
+        max_line_length = KAA_BINARY_LOG_DUMP_LINE_SIZE;
+    }
+
+    while (size--) {
+        if (!*line_length) {
+            memcpy(self->log_buffer, KAA_BINARY_LOG_DUMP_PREFIX, prefix_length);
+        }
+        char *digits = self->log_buffer + prefix_length + 2 * (*line_length)++;
+        digits[0] = hex[*data >> 4];
+        digits[1] = hex[*data++ & 0xF];
+
+        if (*line_length == max_line_length || !size) {
+            char *line_end = self->log_buffer + prefix_length + 2 * (*line_length);
+            line_end[0] = '\n';
+            line_end[1] = 0;
+            ext_write_log(self->sink, self->log_buffer, line_end - self->log_buffer + 1);
+            *line_length = 0;
+        }
+    }
+}
+
+kaa_error_t kaa_log_dump(kaa_logger_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+    // The buffer must fit the first line and a line with one byte at least
+    if (self->buffer_size < sizeof(KAA_BINARY_LOG_DUMP_BEGIN) || self->buffer_size < sizeof(KAA_BINARY_LOG_DUMP_PREFIX) + 3) {
+        return KAA_ERR_BUFFER_IS_NOT_ENOUGH;
+    }
+
+    // The decoder needs the byte order and the sizes of the stored arguments
+    uint16_t byte_order = 0x0102;
+    uint8_t header[] = {
+          KAA_BINARY_LOG_VERSION
+        , ((uint8_t *)&byte_order)[0]
+        , ((uint8_t *)&byte_order)[1]
+        , sizeof(int)
+        , sizeof(long)
+        , sizeof(long long)
+        , sizeof(size_t)
+        , sizeof(intmax_t)
+        , sizeof(ptrdiff_t)
+        , sizeof(void *)
+        , sizeof(double)
+    };
+
+    memcpy(self->log_buffer, KAA_BINARY_LOG_DUMP_BEGIN, sizeof(KAA_BINARY_LOG_DUMP_BEGIN));
+    ext_write_log(self->sink, self->log_buffer, sizeof(KAA_BINARY_LOG_DUMP_BEGIN) - 1);
+
+    size_t line_length = 0;
+    kaa_log_dump_bytes(self, &line_length, header, sizeof(header));
+    while (self->ring_used) {
+        size_t size = KAA_BINARY_LOG_RING_SIZE - self->ring_begin;
+        if (size > self->ring_used) {
+            size = self->ring_used;
+        }
+        kaa_log_dump_bytes(self, &line_length, (const uint8_t *)self->ring + self->ring_begin, size);
+        self->ring_begin = (self->ring_begin + size) % KAA_BINARY_LOG_RING_SIZE;
+        self->ring_used -= size;
+    }
+    self->ring_begin = 0;
+
+    return KAA_ERR_NONE;
+}
+
+#else
+
+kaa_error_t kaa_log_dump(kaa_logger_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+    return KAA_ERR_NONE;
+}
+
 void kaa_log_write(kaa_logger_t *self, const char* source_file, int lineno, kaa_log_level_t log_level
         , kaa_error_t error_code, const char* format, ...)
 {
@@ -163,3 +505,5 @@ void kaa_log_write(kaa_logger_t *self, const char* source_file, int lineno, kaa_
     self->log_buffer[consumed_len++] = 0;
     ext_write_log(self->sink, self->log_buffer, consumed_len);
 }
+
+#endif
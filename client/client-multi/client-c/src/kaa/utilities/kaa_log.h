@@ -56,6 +56,16 @@ extern "C" {
 #define KAA_MAX_LOG_LEVEL   KAA_LOG_LEVEL_TRACE
 #endif
 
+#ifndef KAA_BINARY_LOG_RING_SIZE
+/** The size of the ring which keeps the binary log records, see @link kaa_log_dump @endlink */
+#define KAA_BINARY_LOG_RING_SIZE    2048
+#endif
+
+#ifndef KAA_BINARY_LOG_MAX_STRING_LENGTH
+/** String arguments of the binary log records are truncated to that many characters */
+#define KAA_BINARY_LOG_MAX_STRING_LENGTH    64
+#endif
+
 #define KAA_LOG_LEVEL_FATAL_ENABLED     (KAA_MAX_LOG_LEVEL >= KAA_LOG_LEVEL_FATAL)
 #define KAA_LOG_LEVEL_ERROR_ENABLED     (KAA_MAX_LOG_LEVEL >= KAA_LOG_LEVEL_ERROR)
 #define KAA_LOG_LEVEL_WARN_ENABLED      (KAA_MAX_LOG_LEVEL >= KAA_LOG_LEVEL_WARN)
@@ -132,6 +142,10 @@ kaa_error_t kaa_log_set_sink(kaa_logger_t *self, FILE *sink);
  *
  * The log message gets truncated if it is longer than @c buffer_size specified to @link kaa_log_create @endlink.
  *
+ * If the SDK is built with @c KAA_BINARY_LOGGING, the message is not formatted. Its level, time,
+ * line, error code, the id of the file name and the format and the raw arguments are put into
+ * a ring of @link KAA_BINARY_LOG_RING_SIZE @endlink bytes instead, see @link kaa_log_dump @endlink.
+ *
  * @param[in] self          Pointer to a logger.
  * @param[in] source_file   The source file that the message is logged from.
  * @param[in] lineno        The line number in the source file that the message is logged from.
@@ -142,6 +156,18 @@ kaa_error_t kaa_log_set_sink(kaa_logger_t *self, FILE *sink);
 void kaa_log_write(kaa_logger_t *self, const char* source_file, int lineno, kaa_log_level_t log_level
         , kaa_error_t error_code, const char* format, ...);
 
+/**
+ * @brief Writes the binary log records to the sink and empties the ring.
+ *
+ * The records are printed as hex lines starting with @c "KLOG ", so they can be picked out of
+ * a console capture. Decode them with tools/kaa_log_decoder, given the SDK and application sources.
+ * Does nothing unless the SDK is built with @c KAA_BINARY_LOGGING.
+ *
+ * @param[in] self          Pointer to a logger.
+ * @return                  Error code.
+ */
+kaa_error_t kaa_log_dump(kaa_logger_t *self);
+
 /*
  * Shortcut macros for logging at various log levels
  */
@@ -15,37 +15,130 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "utilities/kaa_mem.h"
 
 
 
 #ifdef KAA_TRACE_MEMORY_ALLOCATIONS
 
+/*
+ * Every block is prefixed with its size and call site, so that the counters
+ * can be updated on free. The union keeps the user part aligned as malloc() does.
+ */
+typedef union {
+    struct {
+        size_t size;
+        size_t site;
+    } info;
+    long double align_ld;
+    long long   align_ll;
+    void       *align_ptr;
+} kaa_trace_memory_header_t;
 
-#if KAA_LOG_LEVEL_TRACE_ENABLED
 static kaa_logger_t * logger_ = NULL;
-#endif
+static kaa_trace_memory_stats_t stats_;
+
+/* Returns KAA_TRACE_MEMORY_SITE_COUNT if the table is full */
+static size_t get_site(const char *file, int line)
+{
+    for (size_t i = 0; i < stats_.site_count; ++i) {
+        if (stats_.sites[i].line == line
+                && (stats_.sites[i].file == file || !strcmp(stats_.sites[i].file, file))) {
+            return i;
+        }
+    }
+
+    if (stats_.site_count == KAA_TRACE_MEMORY_SITE_COUNT) {
+        return KAA_TRACE_MEMORY_SITE_COUNT;
+    }
+
+    kaa_trace_memory_site_stats_t *site = &stats_.sites[stats_.site_count];
+    site->file = file;
+    site->line = line;
+    return stats_.site_count++;
+}
+
+static void *track_allocation(kaa_trace_memory_header_t *header, size_t s, const char *file, int line)
+{
+    if (!header) {
+        return NULL;
+    }
+
+    header->info.size = s;
+    header->info.site = get_site(file, line);
+
+    ++stats_.allocations;
+    stats_.live_bytes += s;
+    if (stats_.live_bytes > stats_.peak_bytes) {
+        stats_.peak_bytes = stats_.live_bytes;
+    }
+
+    if (header->info.site < KAA_TRACE_MEMORY_SITE_COUNT) {
+        kaa_trace_memory_site_stats_t *site = &stats_.sites[header->info.site];
+        ++site->allocations;
+        site->live_bytes += s;
+        if (site->live_bytes > site->peak_bytes) {
+            site->peak_bytes = site->live_bytes;
+        }
+    } else {
+        ++stats_.site_overflows;
+    }
+
+    return header + 1;
+}
+
+static void untrack_allocation(kaa_trace_memory_header_t *header)
+{
+    ++stats_.frees;
+    stats_.live_bytes -= header->info.size;
+    if (header->info.site < KAA_TRACE_MEMORY_SITE_COUNT) {
+        stats_.sites[header->info.site].live_bytes -= header->info.size;
+    }
+}
 
 void *kaa_trace_memory_allocs_malloc(size_t s, const char *file, int line) {
+    void *ptr = track_allocation(__KAA_MALLOC(sizeof(kaa_trace_memory_header_t) + s), s, file, line);
 #if KAA_LOG_LEVEL_TRACE_ENABLED
-    void *ptr = __KAA_MALLOC(s);
     if (logger_)
         kaa_log_write(logger_, file, line, KAA_LOG_LEVEL_TRACE, KAA_ERR_NONE, "Allocated (using malloc) %d bytes at {%p}", s, ptr);
-    return ptr;
-#else
-    return malloc(s);
 #endif
+    return ptr;
 }
 
 void *kaa_trace_memory_allocs_calloc(size_t n, size_t s, const char *file, int line) {
+    void *ptr = NULL;
+    if (!s || n <= (SIZE_MAX - sizeof(kaa_trace_memory_header_t)) / s) {
+        ptr = track_allocation(__KAA_CALLOC(1, sizeof(kaa_trace_memory_header_t) + n * s), n * s, file, line);
+    }
 #if KAA_LOG_LEVEL_TRACE_ENABLED
-    void *ptr = __KAA_CALLOC(n, s);
     if (logger_)
         kaa_log_write(logger_, file, line, KAA_LOG_LEVEL_TRACE, KAA_ERR_NONE, "Allocated (using calloc) %u blocks of %u bytes (total %u) at {%p}", n, s, n*s, ptr);
+#endif
     return ptr;
-#else
-    return calloc(n, s);
+}
+
+void *kaa_trace_memory_allocs_realloc(void *p, size_t s, const char *file, int line)
+{
+    if (!p) {
+        return kaa_trace_memory_allocs_malloc(s, file, line);
+    }
+
+    kaa_trace_memory_header_t *header = (kaa_trace_memory_header_t *)p - 1;
+    kaa_trace_memory_header_t *new_header = __KAA_REALLOC(header, sizeof(kaa_trace_memory_header_t) + s);
+    if (!new_header) {
+        return NULL;
+    }
+
+    /* The block is accounted to the call site that resized it */
+    untrack_allocation(new_header);
+    void *ptr = track_allocation(new_header, s, file, line);
+#if KAA_LOG_LEVEL_TRACE_ENABLED
+    if (logger_)
+        kaa_log_write(logger_, file, line, KAA_LOG_LEVEL_TRACE, KAA_ERR_NONE, "Reallocated {%p} to %u bytes at {%p}", p, s, ptr);
 #endif
+    return ptr;
 }
 
 void kaa_trace_memory_allocs_free(void * p, const char *file, int line)
@@ -53,17 +146,55 @@ void kaa_trace_memory_allocs_free(void * p, const char *file, int line)
 #if KAA_LOG_LEVEL_TRACE_ENABLED
     if (logger_)
         kaa_log_write(logger_, file, line, KAA_LOG_LEVEL_TRACE, KAA_ERR_NONE, "Going to deallocate memory at {%p}", p);
+#else
+    (void)file;
+    (void)line;
 #endif
-    __KAA_FREE(p);
+    if (!p) {
+        return;
+    }
+
+    kaa_trace_memory_header_t *header = (kaa_trace_memory_header_t *)p - 1;
+    untrack_allocation(header);
+    __KAA_FREE(header);
 }
 
 void kaa_trace_memory_allocs_set_logger(kaa_logger_t *logger)
 {
-#if KAA_LOG_LEVEL_TRACE_ENABLED
     logger_ = logger;
-#endif
 }
 
-#endif
+void kaa_trace_memory_allocs_get_stats(kaa_trace_memory_stats_t *stats)
+{
+    if (stats) {
+        *stats = stats_;
+    }
+}
 
+void kaa_trace_memory_allocs_reset_peak(void)
+{
+    stats_.peak_bytes = stats_.live_bytes;
+    for (size_t i = 0; i < stats_.site_count; ++i) {
+        stats_.sites[i].peak_bytes = stats_.sites[i].live_bytes;
+    }
+}
 
+void kaa_trace_memory_allocs_dump(kaa_logger_t *logger)
+{
+    if (!logger) {
+        return;
+    }
+
+    kaa_log_write(logger, __FILE__, __LINE__, KAA_LOG_LEVEL_INFO, KAA_ERR_NONE,
+            "Heap: %zu bytes live, %zu bytes peak, %zu allocations, %zu frees, %zu at untracked sites",
+            stats_.live_bytes, stats_.peak_bytes, stats_.allocations, stats_.frees, stats_.site_overflows);
+
+    for (size_t i = 0; i < stats_.site_count; ++i) {
+        const kaa_trace_memory_site_stats_t *site = &stats_.sites[i];
+        kaa_log_write(logger, site->file, site->line, KAA_LOG_LEVEL_INFO, KAA_ERR_NONE,
+                "Heap site: %zu bytes live, %zu bytes peak, %zu allocations",
+                site->live_bytes, site->peak_bytes, site->allocations);
+    }
+}
+
+#endif
@@ -21,25 +21,78 @@
 
 #ifdef KAA_TRACE_MEMORY_ALLOCATIONS
 
+#include <stddef.h>
 #include "utilities/kaa_log.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Number of allocation call sites tracked individually. */
+#ifndef KAA_TRACE_MEMORY_SITE_COUNT
+#define KAA_TRACE_MEMORY_SITE_COUNT     64
+#endif
+
+typedef struct {
+    const char *file;       /**< Source file of the allocation call. */
+    int         line;       /**< Source line of the allocation call. */
+    size_t      allocations;/**< Allocations made at the site since start-up. */
+    size_t      live_bytes; /**< Bytes allocated at the site and not freed yet. */
+    size_t      peak_bytes; /**< Maximum of @c live_bytes since start-up. */
+} kaa_trace_memory_site_stats_t;
+
+typedef struct {
+    size_t live_bytes;      /**< Bytes currently allocated through @c KAA_MALLOC and friends. */
+    size_t peak_bytes;      /**< Maximum of @c live_bytes since start-up or the last peak reset. */
+    size_t allocations;     /**< Allocations made since start-up, a resize counts as a free and an allocation. */
+    size_t frees;           /**< Allocations released since start-up. */
+    size_t site_count;      /**< Number of valid entries in @c sites. */
+    size_t site_overflows;  /**< Allocations made at sites that didn't fit in @c sites. */
+    kaa_trace_memory_site_stats_t sites[KAA_TRACE_MEMORY_SITE_COUNT];
+} kaa_trace_memory_stats_t;
+
 void *  kaa_trace_memory_allocs_malloc(size_t s, const char *file, int line);
 void *  kaa_trace_memory_allocs_calloc(size_t n, size_t s, const char *file, int line);
+void *  kaa_trace_memory_allocs_realloc(void *p, size_t s, const char *file, int line);
 void    kaa_trace_memory_allocs_free(void * p, const char *file, int line);
 void    kaa_trace_memory_allocs_set_logger(kaa_logger_t *logger);
 
+/**
+ * @brief Copies the current heap usage counters into @p stats.
+ */
+void    kaa_trace_memory_allocs_get_stats(kaa_trace_memory_stats_t *stats);
+
+/**
+ * @brief Restarts the peak tracking from the current live bytes, e.g. before a sync is measured.
+ */
+void    kaa_trace_memory_allocs_reset_peak(void);
+
+/**
+ * @brief Writes the counters and the call site table to @p logger at the INFO level.
+ */
+void    kaa_trace_memory_allocs_dump(kaa_logger_t *logger);
+
 #define KAA_MALLOC(S)           kaa_trace_memory_allocs_malloc(S, __FILE__, __LINE__)
 #define KAA_CALLOC(N,S)         kaa_trace_memory_allocs_calloc((N), (S), __FILE__, __LINE__)
+#define KAA_REALLOC(P,S)        kaa_trace_memory_allocs_realloc((P), (S), __FILE__, __LINE__)
 #define KAA_FREE(P)             kaa_trace_memory_allocs_free((P), __FILE__, __LINE__)
+#define KAA_SCRATCH_MALLOC(S)   KAA_MALLOC(S)
 
 #ifdef __cplusplus
 } // extern "C"
 #endif
 
+#elif defined(KAA_MEMORY_POOLS)
+
+#include "utilities/kaa_mem_pool.h"
+
+#define KAA_MALLOC(S)           kaa_mem_pool_malloc(S)
+#define KAA_CALLOC(N,S)         kaa_mem_pool_calloc((N), (S))
+#define KAA_REALLOC(P,S)        kaa_mem_pool_realloc((P), (S))
+#define KAA_FREE(P)             kaa_mem_pool_free(P)
+/* Short-lived buffers (e.g. serialized sync requests); released with KAA_FREE. */
+#define KAA_SCRATCH_MALLOC(S)   kaa_mem_pool_scratch_malloc(S)
+
 #else // defined KAA_TRACE_MEMORY_ALLOCATIONS
 
 
@@ -47,6 +100,7 @@ void    kaa_trace_memory_allocs_set_logger(kaa_logger_t *logger);
 #define KAA_CALLOC(N,S)  __KAA_CALLOC(N,S)
 #define KAA_REALLOC(P,S) __KAA_REALLOC(P,S)
 #define KAA_FREE(P)      __KAA_FREE(P)
+#define KAA_SCRATCH_MALLOC(S) __KAA_MALLOC(S)
 
 
 #endif // defined KAA_TRACE_MEMORY_ALLOCATIONS
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform/mem.h>
+#include "kaa_mem_pool.h"
+
+/* Most strictly aligned fundamental types; C99 has no max_align_t. */
+typedef union {
+    long long   ll;
+    long double ld;
+    void       *p;
+    void      (*f)(void);
+} kaa_mem_align_t;
+
+#define KAA_MEM_UNITS(bytes) (((bytes) + sizeof(kaa_mem_align_t) - 1) / sizeof(kaa_mem_align_t))
+
+typedef struct kaa_mem_free_block_t {
+    struct kaa_mem_free_block_t *next;
+} kaa_mem_free_block_t;
+
+typedef struct {
+    char                 *begin;
+    char                 *end;
+    kaa_mem_free_block_t *free_list;
+    size_t                block_size;
+    size_t                block_count;
+    size_t                used;
+    size_t                high_water;
+    size_t                overflows;
+} kaa_mem_pool_class_t;
+
+static kaa_mem_align_t pool_storage_16[KAA_MEM_UNITS(16 * KAA_MEMORY_POOL_BLOCKS_16)];
+static kaa_mem_align_t pool_storage_32[KAA_MEM_UNITS(32 * KAA_MEMORY_POOL_BLOCKS_32)];
+static kaa_mem_align_t pool_storage_64[KAA_MEM_UNITS(64 * KAA_MEMORY_POOL_BLOCKS_64)];
+static kaa_mem_align_t pool_storage_128[KAA_MEM_UNITS(128 * KAA_MEMORY_POOL_BLOCKS_128)];
+static kaa_mem_align_t pool_storage_256[KAA_MEM_UNITS(256 * KAA_MEMORY_POOL_BLOCKS_256)];
+
+#define KAA_MEM_POOL_CLASS(size) \
+    { (char *)pool_storage_##size, (char *)pool_storage_##size + sizeof(pool_storage_##size), \
+      NULL, size, KAA_MEMORY_POOL_BLOCKS_##size, 0, 0, 0 }
+
+static kaa_mem_pool_class_t pool_classes[KAA_MEMORY_POOL_CLASS_COUNT] = {
+    KAA_MEM_POOL_CLASS(16),
+    KAA_MEM_POOL_CLASS(32),
+    KAA_MEM_POOL_CLASS(64),
+    KAA_MEM_POOL_CLASS(128),
+    KAA_MEM_POOL_CLASS(256),
+};
+
+static bool pools_initialized;
+
+/* Every arena buffer is preceded by one alignment unit holding its size. */
+static kaa_mem_align_t arena_storage[KAA_MEM_UNITS(KAA_MEMORY_ARENA_SIZE)];
+static size_t arena_offset;
+static size_t arena_live_count;
+static size_t arena_high_water;
+static size_t arena_overflows;
+
+static size_t heap_allocations;
+
+static void pools_init(void)
+{
+    for (size_t i = 0; i < KAA_MEMORY_POOL_CLASS_COUNT; ++i) {
+        kaa_mem_pool_class_t *pool = &pool_classes[i];
+        pool->free_list = NULL;
+        for (size_t j = pool->block_count; j > 0; --j) {
+            kaa_mem_free_block_t *block =
+                    (kaa_mem_free_block_t *)(pool->begin + (j - 1) * pool->block_size);
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+    }
+    pools_initialized = true;
+}
+
+static kaa_mem_pool_class_t *find_pool(const void *ptr)
+{
+    const char *p = ptr;
+    for (size_t i = 0; i < KAA_MEMORY_POOL_CLASS_COUNT; ++i) {
+        if (p >= pool_classes[i].begin && p < pool_classes[i].end) {
+            return &pool_classes[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_arena_pointer(const void *ptr)
+{
+    const char *p = ptr;
+    return p >= (const char *)arena_storage && p < (const char *)arena_storage + sizeof(arena_storage);
+}
+
+static void *heap_malloc(size_t size)
+{
+    void *ptr = __KAA_MALLOC(size);
+    if (ptr) {
+        ++heap_allocations;
+    }
+    return ptr;
+}
+
+static void *pool_malloc(size_t size)
+{
+    if (!pools_initialized) {
+        pools_init();
+    }
+
+    for (size_t i = 0; i < KAA_MEMORY_POOL_CLASS_COUNT; ++i) {
+        kaa_mem_pool_class_t *pool = &pool_classes[i];
+        if (size > pool->block_size) {
+            continue;
+        }
+        if (!pool->free_list) {
+            ++pool->overflows;
+            continue;
+        }
+
+        kaa_mem_free_block_t *block = pool->free_list;
+        pool->free_list = block->next;
+        if (++pool->used > pool->high_water) {
+            pool->high_water = pool->used;
+        }
+        return block;
+    }
+
+    return NULL;
+}
+
+void *kaa_mem_pool_malloc(size_t size)
+{
+    if (!size) {
+        size = 1;
+    }
+
+    void *ptr = NULL;
+    if (size <= KAA_MEMORY_POOL_MAX_BLOCK_SIZE) {
+        ptr = pool_malloc(size);
+    }
+    return ptr ? ptr : heap_malloc(size);
+}
+
+void *kaa_mem_pool_calloc(size_t count, size_t size)
+{
+    if (size && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void *ptr = kaa_mem_pool_malloc(count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void *kaa_mem_pool_scratch_malloc(size_t size)
+{
+    size_t units = 1 + KAA_MEM_UNITS(size ? size : 1);
+    size_t offset = arena_offset / sizeof(kaa_mem_align_t);
+
+    if (size > sizeof(arena_storage) || units > KAA_MEM_UNITS(sizeof(arena_storage)) - offset) {
+        ++arena_overflows;
+        return kaa_mem_pool_malloc(size);
+    }
+
+    kaa_mem_align_t *header = &arena_storage[offset];
+    *(size_t *)header = size;
+
+    arena_offset += units * sizeof(kaa_mem_align_t);
+    if (arena_offset > arena_high_water) {
+        arena_high_water = arena_offset;
+    }
+    ++arena_live_count;
+
+    return header + 1;
+}
+
+void kaa_mem_pool_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    kaa_mem_pool_class_t *pool = find_pool(ptr);
+    if (pool) {
+        kaa_mem_free_block_t *block = ptr;
+        block->next = pool->free_list;
+        pool->free_list = block;
+        --pool->used;
+        return;
+    }
+
+    if (is_arena_pointer(ptr)) {
+        if (!--arena_live_count) {
+            arena_offset = 0;
+        }
+        return;
+    }
+
+    --heap_allocations;
+    __KAA_FREE(ptr);
+}
+
+void *kaa_mem_pool_realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return kaa_mem_pool_malloc(size);
+    }
+
+    if (!size) {
+        kaa_mem_pool_free(ptr);
+        return NULL;
+    }
+
+    size_t old_size;
+    kaa_mem_pool_class_t *pool = find_pool(ptr);
+    if (pool) {
+        old_size = pool->block_size;
+    } else if (is_arena_pointer(ptr)) {
+        old_size = *(size_t *)((kaa_mem_align_t *)ptr - 1);
+    } else {
+        return __KAA_REALLOC(ptr, size);
+    }
+
+    if (size <= old_size) {
+        return ptr;
+    }
+
+    void *new_ptr = kaa_mem_pool_malloc(size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_size);
+        kaa_mem_pool_free(ptr);
+    }
+    return new_ptr;
+}
+
+void kaa_mem_pool_get_stats(kaa_mem_pool_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    for (size_t i = 0; i < KAA_MEMORY_POOL_CLASS_COUNT; ++i) {
+        stats->classes[i].block_size = pool_classes[i].block_size;
+        stats->classes[i].block_count = pool_classes[i].block_count;
+        stats->classes[i].used = pool_classes[i].used;
+        stats->classes[i].high_water = pool_classes[i].high_water;
+        stats->classes[i].overflows = pool_classes[i].overflows;
+    }
+
+    stats->arena_size = sizeof(arena_storage);
+    stats->arena_used = arena_offset;
+    stats->arena_high_water = arena_high_water;
+    stats->arena_overflows = arena_overflows;
+    stats->heap_allocations = heap_allocations;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file kaa_mem_pool.h
+ * @brief Static memory pools backing @c KAA_MALLOC on targets without a usable heap.
+ *
+ * Requests up to @c KAA_MEMORY_POOL_MAX_BLOCK_SIZE bytes are served from
+ * fixed-size slab pools, per-sync scratch buffers from a bump arena that rewinds
+ * once every scratch buffer is released. Anything that does not fit falls back
+ * to the platform allocator.
+ *
+ * The allocator is not thread-safe, as is the rest of the SDK.
+ */
+
+#ifndef KAA_MEM_POOL_H_
+#define KAA_MEM_POOL_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of slab size classes (16, 32, 64, 128 and 256 bytes). */
+#define KAA_MEMORY_POOL_CLASS_COUNT     5
+
+/** Largest request served from the slab pools. */
+#define KAA_MEMORY_POOL_MAX_BLOCK_SIZE  256
+
+#ifndef KAA_MEMORY_POOL_BLOCKS_16
+#define KAA_MEMORY_POOL_BLOCKS_16       64
+#endif
+
+#ifndef KAA_MEMORY_POOL_BLOCKS_32
+#define KAA_MEMORY_POOL_BLOCKS_32       64
+#endif
+
+#ifndef KAA_MEMORY_POOL_BLOCKS_64
+#define KAA_MEMORY_POOL_BLOCKS_64       32
+#endif
+
+#ifndef KAA_MEMORY_POOL_BLOCKS_128
+#define KAA_MEMORY_POOL_BLOCKS_128      16
+#endif
+
+#ifndef KAA_MEMORY_POOL_BLOCKS_256
+#define KAA_MEMORY_POOL_BLOCKS_256      8
+#endif
+
+/** Size of the scratch arena in bytes. */
+#ifndef KAA_MEMORY_ARENA_SIZE
+#define KAA_MEMORY_ARENA_SIZE           4096
+#endif
+
+typedef struct {
+    size_t block_size;      /**< Size of a single block. */
+    size_t block_count;     /**< Total number of blocks in the pool. */
+    size_t used;            /**< Blocks currently handed out. */
+    size_t high_water;      /**< Maximum of @c used since start-up. */
+    size_t overflows;       /**< Requests that did not fit and went to a larger class or the heap. */
+} kaa_mem_pool_class_stats_t;
+
+typedef struct {
+    kaa_mem_pool_class_stats_t classes[KAA_MEMORY_POOL_CLASS_COUNT];
+    size_t arena_size;      /**< Total arena capacity in bytes. */
+    size_t arena_used;      /**< Bytes currently claimed from the arena. */
+    size_t arena_high_water;/**< Maximum of @c arena_used since start-up. */
+    size_t arena_overflows; /**< Scratch requests that did not fit in the arena. */
+    size_t heap_allocations;/**< Live allocations served by the platform allocator. */
+} kaa_mem_pool_stats_t;
+
+void *kaa_mem_pool_malloc(size_t size);
+void *kaa_mem_pool_calloc(size_t count, size_t size);
+void *kaa_mem_pool_realloc(void *ptr, size_t size);
+void  kaa_mem_pool_free(void *ptr);
+
+/**
+ * @brief Allocates a short-lived buffer from the scratch arena.
+ *
+ * The buffer is released with @c kaa_mem_pool_free() like any other. The arena
+ * is rewound when its last live buffer is released.
+ */
+void *kaa_mem_pool_scratch_malloc(size_t size);
+
+/**
+ * @brief Copies the current pool statistics into @p stats.
+ */
+void kaa_mem_pool_get_stats(kaa_mem_pool_stats_t *stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* KAA_MEM_POOL_H_ */
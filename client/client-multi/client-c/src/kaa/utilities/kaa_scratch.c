@@ -0,0 +1,139 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdint.h>
+
+#include "kaa_scratch.h"
+#include "kaa_common.h"
+#include "kaa_mem.h"
+
+typedef union {
+    long long   ll;
+    long double ld;
+    void       *p;
+    void      (*f)(void);
+} kaa_scratch_align_t;
+
+#define KAA_SCRATCH_ALIGN(size) \
+    (((size) + sizeof(kaa_scratch_align_t) - 1) & ~(sizeof(kaa_scratch_align_t) - 1))
+
+typedef struct kaa_scratch_chunk_t {
+    struct kaa_scratch_chunk_t *next;
+    size_t                      size;
+    size_t                      used;
+    kaa_scratch_align_t         data[];
+} kaa_scratch_chunk_t;
+
+struct kaa_scratch_t {
+    kaa_scratch_chunk_t *chunks;        /* The current chunk goes first. */
+    size_t               chunk_size;
+    size_t               round_size;    /* Bytes handed out since the last reset. */
+};
+
+static kaa_scratch_chunk_t *kaa_scratch_chunk_create(size_t size)
+{
+    kaa_scratch_chunk_t *chunk = KAA_MALLOC(sizeof(kaa_scratch_chunk_t) + size);
+    if (chunk) {
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+    }
+    return chunk;
+}
+
+static void kaa_scratch_free_chunks(kaa_scratch_chunk_t *chunk)
+{
+    while (chunk) {
+        kaa_scratch_chunk_t *next = chunk->next;
+        KAA_FREE(chunk);
+        chunk = next;
+    }
+}
+
+kaa_error_t kaa_scratch_create(kaa_scratch_t **scratch_p, size_t chunk_size)
+{
+    KAA_RETURN_IF_NIL2(scratch_p, chunk_size, KAA_ERR_BADPARAM);
+
+    kaa_scratch_t *scratch = KAA_MALLOC(sizeof(kaa_scratch_t));
+    KAA_RETURN_IF_NIL(scratch, KAA_ERR_NOMEM);
+
+    scratch->chunk_size = KAA_SCRATCH_ALIGN(chunk_size);
+    scratch->round_size = 0;
+    scratch->chunks = kaa_scratch_chunk_create(scratch->chunk_size);
+    if (!scratch->chunks) {
+        KAA_FREE(scratch);
+        return KAA_ERR_NOMEM;
+    }
+
+    *scratch_p = scratch;
+    return KAA_ERR_NONE;
+}
+
+void kaa_scratch_destroy(kaa_scratch_t *scratch)
+{
+    if (scratch) {
+        kaa_scratch_free_chunks(scratch->chunks);
+        KAA_FREE(scratch);
+    }
+}
+
+void *kaa_scratch_alloc(kaa_scratch_t *scratch, size_t size)
+{
+    KAA_RETURN_IF_NIL(scratch, NULL);
+
+    if (size > SIZE_MAX / 2) {
+        return NULL;
+    }
+    size = KAA_SCRATCH_ALIGN(size ? size : 1);
+
+    kaa_scratch_chunk_t *chunk = scratch->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        chunk = kaa_scratch_chunk_create(size > scratch->chunk_size ? size : scratch->chunk_size);
+        KAA_RETURN_IF_NIL(chunk, NULL);
+        chunk->next = scratch->chunks;
+        scratch->chunks = chunk;
+    }
+
+    void *ptr = (char *)chunk->data + chunk->used;
+    chunk->used += size;
+    scratch->round_size += size;
+    return ptr;
+}
+
+void kaa_scratch_reset(kaa_scratch_t *scratch)
+{
+    if (!scratch) {
+        return;
+    }
+
+    kaa_scratch_chunk_t *chunk = scratch->chunks;
+    if (chunk && !chunk->next && chunk->size <= KAA_SCRATCH_MAX_RETAINED_SIZE) {
+        chunk->used = 0;
+        scratch->round_size = 0;
+        return;
+    }
+
+    /* The round didn't fit into one chunk: replace the chain with a single one. */
+    size_t size = scratch->round_size > scratch->chunk_size ? scratch->round_size : scratch->chunk_size;
+    if (size > KAA_SCRATCH_MAX_RETAINED_SIZE) {
+        size = scratch->chunk_size > KAA_SCRATCH_MAX_RETAINED_SIZE ? scratch->chunk_size : KAA_SCRATCH_MAX_RETAINED_SIZE;
+    }
+
+    kaa_scratch_free_chunks(chunk);
+    scratch->chunks = kaa_scratch_chunk_create(size);
+    scratch->round_size = 0;
+}
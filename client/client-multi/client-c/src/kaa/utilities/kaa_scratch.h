@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef KAA_SCRATCH_H_
+#define KAA_SCRATCH_H_
+
+#include <stddef.h>
+
+#include "kaa_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Scratch memory retained across resets, larger rounds release the excess on reset.
+ */
+#ifndef KAA_SCRATCH_MAX_RETAINED_SIZE
+#define KAA_SCRATCH_MAX_RETAINED_SIZE    (16 * 1024)
+#endif
+
+/**
+ * Bump allocator for temporaries that live for a single sync round.
+ *
+ * Allocations are never freed one by one: @link kaa_scratch_reset @endlink releases
+ * all of them at once. When a round outgrows the current chunk, another chunk is
+ * chained; on reset the chunks are merged into one sized for the whole round,
+ * so subsequent rounds of the same size are served from a single chunk.
+ */
+typedef struct kaa_scratch_t kaa_scratch_t;
+
+/**
+ * Creates the scratch arena with the first chunk of @p chunk_size bytes.
+ */
+kaa_error_t kaa_scratch_create(kaa_scratch_t **scratch_p, size_t chunk_size);
+
+void kaa_scratch_destroy(kaa_scratch_t *scratch);
+
+/**
+ * Returns @p size bytes aligned for any fundamental type, or NULL if out of memory.
+ */
+void *kaa_scratch_alloc(kaa_scratch_t *scratch, size_t size);
+
+/**
+ * Releases everything allocated since the previous reset.
+ */
+void kaa_scratch_reset(kaa_scratch_t *scratch);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* KAA_SCRATCH_H_ */
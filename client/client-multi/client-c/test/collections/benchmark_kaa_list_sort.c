@@ -0,0 +1,137 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures kaa_list_sort() on lists shaped like the ones the notification
+ * manager sorts: topics by id and notifications by sequence number.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "kaa_test.h"
+#include "collections/kaa_list.h"
+
+#define BENCHMARK_LIST_SIZE     1000
+#define BENCHMARK_ITERATIONS    100
+
+typedef struct {
+    uint64_t id;
+} benchmark_node_t;
+
+typedef enum {
+    BENCHMARK_RANDOM,
+    BENCHMARK_SORTED,
+    BENCHMARK_REVERSED,
+} benchmark_order_t;
+
+static const char *order_names[] = { "random", "sorted", "reversed" };
+
+static benchmark_node_t nodes[BENCHMARK_LIST_SIZE];
+
+static bool benchmark_predicate(void *node_1, void *node_2)
+{
+    return ((benchmark_node_t *)node_1)->id < ((benchmark_node_t *)node_2)->id;
+}
+
+/* The nodes are static, only the list nodes are freed. */
+static void benchmark_keep_data(void *data)
+{
+    (void)data;
+}
+
+static void fill_list(kaa_list_t *list, benchmark_order_t order)
+{
+    kaa_list_clear(list, &benchmark_keep_data);
+    for (size_t i = 0; i < BENCHMARK_LIST_SIZE; ++i) {
+        switch (order) {
+        case BENCHMARK_RANDOM:
+            nodes[i].id = (uint64_t)rand();
+            break;
+        case BENCHMARK_SORTED:
+            nodes[i].id = i;
+            break;
+        case BENCHMARK_REVERSED:
+            nodes[i].id = BENCHMARK_LIST_SIZE - i;
+            break;
+        }
+        ASSERT_NOT_NULL(kaa_list_push_back(list, &nodes[i]));
+    }
+}
+
+static void benchmark_sort(benchmark_order_t order)
+{
+    kaa_list_t *list = kaa_list_create();
+    ASSERT_NOT_NULL(list);
+
+    clock_t total = 0;
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; ++i) {
+        fill_list(list, order);
+
+        clock_t start = clock();
+        kaa_list_sort(list, &benchmark_predicate);
+        total += clock() - start;
+
+        benchmark_node_t *prev = kaa_list_get_data(kaa_list_begin(list));
+        for (kaa_list_node_t *it = kaa_list_next(kaa_list_begin(list)); it; it = kaa_list_next(it)) {
+            benchmark_node_t *node = kaa_list_get_data(it);
+            ASSERT_TRUE(prev->id <= node->id);
+            prev = node;
+        }
+    }
+
+    printf("kaa_list_sort: %d %s nodes, %.1f us per sort\n", BENCHMARK_LIST_SIZE, order_names[order],
+            (double)total * 1000000 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS);
+
+    kaa_list_destroy(list, &benchmark_keep_data);
+}
+
+static void test_sort_random(void **state)
+{
+    (void)state;
+    benchmark_sort(BENCHMARK_RANDOM);
+}
+
+static void test_sort_sorted(void **state)
+{
+    (void)state;
+    benchmark_sort(BENCHMARK_SORTED);
+}
+
+static void test_sort_reversed(void **state)
+{
+    (void)state;
+    benchmark_sort(BENCHMARK_REVERSED);
+}
+
+static int test_init(void)
+{
+    srand(time(NULL));
+    return 0;
+}
+
+static int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(ListSortBenchmark, test_init, test_deinit,
+        KAA_TEST_CASE(sort_random, test_sort_random)
+        KAA_TEST_CASE(sort_sorted, test_sort_sorted)
+        KAA_TEST_CASE(sort_reversed, test_sort_reversed)
+)
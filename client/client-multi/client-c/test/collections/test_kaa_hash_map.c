@@ -0,0 +1,160 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "kaa_test.h"
+#include "collections/kaa_hash_map.h"
+#include "utilities/kaa_mem.h"
+
+#define TEST_ENTRY_COUNT 1000
+
+typedef struct {
+    uint64_t id;
+    char     name[16];
+} test_entry_t;
+
+static void count_entries(void *data, void *context)
+{
+    (void)data;
+    ++*(size_t *)context;
+}
+
+static void test_map_put_get(void **state)
+{
+    (void)state;
+
+    kaa_hash_map_t *map = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQUAL(kaa_hash_map_get_size(map), 0);
+
+    uint64_t missing = 42;
+    ASSERT_NULL(kaa_hash_map_get(map, &missing));
+
+    static test_entry_t entries[TEST_ENTRY_COUNT];
+    for (size_t i = 0; i < TEST_ENTRY_COUNT; ++i) {
+        entries[i].id = i * 1024;
+        ASSERT_EQUAL(kaa_hash_map_put(map, &entries[i].id, &entries[i], NULL), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(kaa_hash_map_get_size(map), TEST_ENTRY_COUNT);
+
+    for (size_t i = 0; i < TEST_ENTRY_COUNT; ++i) {
+        uint64_t id = i * 1024;
+        ASSERT_EQUAL((uintptr_t)kaa_hash_map_get(map, &id), (uintptr_t)&entries[i]);
+    }
+
+    size_t count = 0;
+    kaa_hash_map_for_each(map, &count_entries, &count);
+    ASSERT_EQUAL(count, TEST_ENTRY_COUNT);
+
+    kaa_hash_map_destroy(map, NULL);
+}
+
+static void test_map_replace(void **state)
+{
+    (void)state;
+
+    kaa_hash_map_t *map = kaa_hash_map_create(&kaa_hash_map_string_hash, &kaa_hash_map_string_equals);
+    ASSERT_NOT_NULL(map);
+
+    test_entry_t first = { 1, "fqn" };
+    test_entry_t second = { 2, "fqn" };
+    void *replaced = &first;
+
+    ASSERT_EQUAL(kaa_hash_map_put(map, first.name, &first, &replaced), KAA_ERR_NONE);
+    ASSERT_NULL(replaced);
+    ASSERT_EQUAL(kaa_hash_map_put(map, second.name, &second, &replaced), KAA_ERR_NONE);
+    ASSERT_EQUAL((uintptr_t)replaced, (uintptr_t)&first);
+    ASSERT_EQUAL(kaa_hash_map_get_size(map), 1);
+
+    /* The key of the replacing entry is stored, the replaced one may be freed. */
+    memset(first.name, 0, sizeof(first.name));
+    ASSERT_EQUAL((uintptr_t)kaa_hash_map_get(map, "fqn"), (uintptr_t)&second);
+
+    kaa_hash_map_destroy(map, NULL);
+}
+
+static void test_map_remove(void **state)
+{
+    (void)state;
+
+    kaa_hash_map_t *map = kaa_hash_map_create(&kaa_hash_map_uint16_hash, &kaa_hash_map_uint16_equals);
+    ASSERT_NOT_NULL(map);
+
+    static uint16_t keys[TEST_ENTRY_COUNT];
+    for (size_t i = 0; i < TEST_ENTRY_COUNT; ++i) {
+        keys[i] = (uint16_t)(i * 7);
+        ASSERT_EQUAL(kaa_hash_map_put(map, &keys[i], &keys[i], NULL), KAA_ERR_NONE);
+    }
+
+    /* Removes every other key, the remaining ones must stay reachable. */
+    for (size_t i = 0; i < TEST_ENTRY_COUNT; i += 2) {
+        ASSERT_EQUAL((uintptr_t)kaa_hash_map_remove(map, &keys[i]), (uintptr_t)&keys[i]);
+        ASSERT_NULL(kaa_hash_map_remove(map, &keys[i]));
+    }
+    ASSERT_EQUAL(kaa_hash_map_get_size(map), TEST_ENTRY_COUNT / 2);
+
+    for (size_t i = 0; i < TEST_ENTRY_COUNT; ++i) {
+        void *value = kaa_hash_map_get(map, &keys[i]);
+        if (i % 2) {
+            ASSERT_EQUAL((uintptr_t)value, (uintptr_t)&keys[i]);
+        } else {
+            ASSERT_NULL(value);
+        }
+    }
+
+    kaa_hash_map_clear(map, NULL);
+    ASSERT_EQUAL(kaa_hash_map_get_size(map), 0);
+    ASSERT_NULL(kaa_hash_map_get(map, &keys[1]));
+
+    kaa_hash_map_destroy(map, NULL);
+}
+
+static void test_map_deallocator(void **state)
+{
+    (void)state;
+
+    kaa_hash_map_t *map = kaa_hash_map_create(&kaa_hash_map_uint64_hash, &kaa_hash_map_uint64_equals);
+    ASSERT_NOT_NULL(map);
+
+    for (uint64_t i = 0; i < 10; ++i) {
+        test_entry_t *entry = KAA_MALLOC(sizeof(test_entry_t));
+        ASSERT_NOT_NULL(entry);
+        entry->id = i;
+        ASSERT_EQUAL(kaa_hash_map_put(map, &entry->id, entry, NULL), KAA_ERR_NONE);
+    }
+
+    kaa_hash_map_destroy(map, &free);
+}
+
+static int test_init(void)
+{
+    return 0;
+}
+
+static int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(HashMap, test_init, test_deinit,
+        KAA_TEST_CASE(map_put_get, test_map_put_get)
+        KAA_TEST_CASE(map_replace, test_map_replace)
+        KAA_TEST_CASE(map_remove, test_map_remove)
+        KAA_TEST_CASE(map_deallocator, test_map_deallocator)
+)
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include "kaa_test.h"
+#include "collections/kaa_intrusive_list.h"
+
+typedef struct {
+    int                  value;
+    kaa_intrusive_node_t node;
+} test_item_t;
+
+static void test_intrusive_list_push(void **state)
+{
+    (void)state;
+
+    kaa_intrusive_list_t list;
+    kaa_intrusive_list_init(&list);
+    ASSERT_TRUE(kaa_intrusive_list_is_empty(&list));
+    ASSERT_NULL(kaa_intrusive_list_front(&list));
+
+    test_item_t items[3] = { { .value = 1 }, { .value = 2 }, { .value = 3 } };
+    kaa_intrusive_list_push_back(&list, &items[1].node);
+    kaa_intrusive_list_push_back(&list, &items[2].node);
+    kaa_intrusive_list_push_front(&list, &items[0].node);
+    ASSERT_EQUAL(kaa_intrusive_list_get_size(&list), 3);
+
+    int expected = 1;
+    kaa_intrusive_node_t *it, *next;
+    KAA_INTRUSIVE_LIST_FOR_EACH(it, next, &list) {
+        ASSERT_EQUAL(KAA_INTRUSIVE_ENTRY(it, test_item_t, node)->value, expected++);
+    }
+    ASSERT_EQUAL(expected, 4);
+}
+
+static void test_intrusive_list_remove(void **state)
+{
+    (void)state;
+
+    kaa_intrusive_list_t list;
+    kaa_intrusive_list_init(&list);
+
+    test_item_t items[4] = { { .value = 0 }, { .value = 1 }, { .value = 2 }, { .value = 3 } };
+    for (size_t i = 0; i < 4; ++i) {
+        kaa_intrusive_list_push_back(&list, &items[i].node);
+    }
+
+    /* Unlinks the even items while iterating. */
+    kaa_intrusive_node_t *it, *next;
+    KAA_INTRUSIVE_LIST_FOR_EACH(it, next, &list) {
+        if (!(KAA_INTRUSIVE_ENTRY(it, test_item_t, node)->value % 2)) {
+            kaa_intrusive_list_remove(&list, it);
+        }
+    }
+    ASSERT_EQUAL(kaa_intrusive_list_get_size(&list), 2);
+    ASSERT_EQUAL(KAA_INTRUSIVE_ENTRY(kaa_intrusive_list_front(&list), test_item_t, node)->value, 1);
+
+    kaa_intrusive_list_remove(&list, &items[1].node);
+    kaa_intrusive_list_remove(&list, &items[3].node);
+    ASSERT_TRUE(kaa_intrusive_list_is_empty(&list));
+    ASSERT_EQUAL(kaa_intrusive_list_get_size(&list), 0);
+}
+
+static int test_init(void)
+{
+    return 0;
+}
+
+static int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(IntrusiveList, test_init, test_deinit,
+        KAA_TEST_CASE(intrusive_list_push, test_intrusive_list_push)
+        KAA_TEST_CASE(intrusive_list_remove, test_intrusive_list_remove)
+)
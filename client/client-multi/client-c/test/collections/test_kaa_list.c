@@ -127,6 +127,53 @@ static void test_list_sort()
     kaa_list_destroy(list, NULL);
 }
 
+typedef struct {
+    uint64_t id;
+    uint64_t order;
+} test_stable_node_t;
+
+static bool test_kaa_stable_predicate(void *node_1, void *node_2)
+{
+    return ((test_stable_node_t *)node_1)->id < ((test_stable_node_t *)node_2)->id;
+}
+
+static void test_list_stable_sort()
+{
+    kaa_list_t *list = kaa_list_create();
+    ASSERT_NOT_NULL(list);
+
+    /* Odd size and few distinct keys: runs of unequal length and many ties. */
+    uint64_t node_number = 1001;
+    for (uint64_t i = 0; i < node_number; ++i) {
+        test_stable_node_t *node = KAA_MALLOC(sizeof(test_stable_node_t));
+        ASSERT_NOT_NULL(node);
+        node->id = (uint64_t) rand() % 8;
+        node->order = i;
+        kaa_list_push_back(list, node);
+    }
+
+    kaa_list_sort(list, &test_kaa_stable_predicate);
+    ASSERT_EQUAL(kaa_list_get_size(list), node_number);
+
+    size_t count = 1;
+    kaa_list_node_t *it = kaa_list_begin(list);
+    kaa_list_node_t *next = kaa_list_next(it);
+    ASSERT_NULL(kaa_list_prev(it));
+    while (next) {
+        test_stable_node_t *first = kaa_list_get_data(it);
+        test_stable_node_t *second = kaa_list_get_data(next);
+        ASSERT_TRUE(first->id < second->id || (first->id == second->id && first->order < second->order));
+        ASSERT_EQUAL((uintptr_t)kaa_list_prev(next), (uintptr_t)it);
+        it = next;
+        next = kaa_list_next(it);
+        ++count;
+    }
+    ASSERT_EQUAL(count, node_number);
+    ASSERT_EQUAL((uintptr_t)kaa_list_back(list), (uintptr_t)it);
+
+    kaa_list_destroy(list, NULL);
+}
+
 static void test_list_empty_sort()
 {
     /* Purpose of this test is to show that no crash occur if
@@ -210,5 +257,6 @@ KAA_SUITE_MAIN(List, test_init, test_deinit,
         KAA_TEST_CASE(list_for_each, test_list_for_each)
         KAA_TEST_CASE(list_sort, test_list_sort)
         KAA_TEST_CASE(list_sort, test_list_empty_sort)
+        KAA_TEST_CASE(list_stable_sort, test_list_stable_sort)
         KAA_TEST_CASE(list_hash, test_list_hash)
 )
@@ -25,6 +25,10 @@
  */
 #include <kaa_extension.h>
 
+#define FAKE_EXTENSION1_ID 13
+#define FAKE_EXTENSION2_ID 5
+#define FAKE_EXTENSION3_ID 17
+
 extern const struct kaa_extension fake_extension1;
 extern const struct kaa_extension fake_extension2;
 extern const struct kaa_extension fake_extension3;
@@ -34,3 +38,9 @@ static const struct kaa_extension *kaa_extensions[] = {
     &fake_extension2,
     &fake_extension3,
 };
+
+static const struct kaa_extension *const kaa_extensions_by_id[KAA_EXTENSION_ID_COUNT] = {
+    [FAKE_EXTENSION1_ID] = &fake_extension1,
+    [FAKE_EXTENSION2_ID] = &fake_extension2,
+    [FAKE_EXTENSION3_ID] = &fake_extension3,
+};
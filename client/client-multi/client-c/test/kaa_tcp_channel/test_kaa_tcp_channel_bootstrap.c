@@ -229,6 +229,63 @@ void test_set_access_point_full_success_bootstrap(void **state)
     KAA_FREE(channel);
 }
 
+/*
+ * Test the bootstrap channel reused for operations services.
+ */
+void test_switch_to_operations_services(void **state)
+{
+    (void)state;
+
+    kaa_error_t error_code;
+
+    kaa_transport_channel_interface_t *channel =
+        KAA_CALLOC(1, sizeof(kaa_transport_channel_interface_t));
+
+    kaa_extension_id bootstrap_services[] = {KAA_EXTENSION_BOOTSTRAP};
+    kaa_extension_id operations_services[] = {KAA_EXTENSION_PROFILE, KAA_EXTENSION_USER, KAA_EXTENSION_EVENT};
+
+    error_code = kaa_tcp_channel_create(channel,logger,bootstrap_services,1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    test_set_access_point(channel);
+    void *context = channel->context;
+
+    //Bootstrap can't be mixed with other services
+    kaa_extension_id mixed_services[] = {KAA_EXTENSION_BOOTSTRAP, KAA_EXTENSION_PROFILE};
+    error_code = kaa_tcp_channel_set_supported_services(channel, mixed_services, 2);
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = kaa_tcp_channel_set_supported_services(channel, operations_services, 3);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(channel->context, context);
+
+    //The connection to the bootstrap access point is closed
+    ASSERT_EQUAL(access_point_test_info.socket_disconnected_closed, true);
+    kaa_fd_t fd = -1;
+    error_code = kaa_tcp_channel_get_descriptor(channel,&fd);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(fd, KAA_TCP_SOCKET_NOT_SET);
+
+    const kaa_extension_id *r_supported_services;
+    size_t r_supported_service_count = 0;
+    error_code = channel->get_supported_services(channel->context,&r_supported_services,&r_supported_service_count);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(r_supported_service_count, 3);
+    ASSERT_EQUAL(memcmp(r_supported_services, operations_services, sizeof(operations_services)), 0);
+
+    //And back to bootstrap
+    error_code = kaa_tcp_channel_set_supported_services(channel, bootstrap_services, 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = channel->get_supported_services(channel->context,&r_supported_services,&r_supported_service_count);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(r_supported_service_count, 1);
+    ASSERT_EQUAL(r_supported_services[0], KAA_EXTENSION_BOOTSTRAP);
+
+    channel->destroy(channel->context);
+
+    KAA_FREE(channel);
+}
+
 /*
  * Test connecting error during set access point.
  */
@@ -709,15 +766,21 @@ kaatcp_error_t kaatcp_fill_connect_message(uint16_t keepalive, uint32_t next_pro
 }
 
 
-kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_protocol_t *self,
-        const kaa_extension_id *services, size_t services_count,
-        uint8_t **buffer, size_t *buffer_size)
+kaa_error_t kaa_platform_protocol_scratch_serialize_client_sync(kaa_platform_protocol_t *self,
+        kaa_scratch_t *scratch, const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices)
 {
     (void)self;
+    (void)splices;
 
     if (services_count == 1
             && services[0] == KAA_EXTENSION_BOOTSTRAP) {
-        uint8_t *alloc_buffer = KAA_MALLOC(sizeof(CONNECT_PACK));
+#ifdef KAA_ENCRYPTION
+        /* The channel encrypts in place */
+        uint8_t *alloc_buffer = kaa_scratch_alloc(scratch, ext_get_encrypted_data_size(sizeof(CONNECT_PACK)));
+#else
+        uint8_t *alloc_buffer = kaa_scratch_alloc(scratch, sizeof(CONNECT_PACK));
+#endif
         if (alloc_buffer) {
             memcpy(alloc_buffer, CONNECT_PACK, sizeof(CONNECT_PACK));
             *buffer = alloc_buffer;
@@ -799,6 +862,30 @@ ext_tcp_utils_function_return_state_t ext_tcp_utils_getaddrbyhost(kaa_dns_resolv
     return RET_STATE_VALUE_READY;
 }
 
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_writev(kaa_fd_t fd, const ext_tcp_io_vector_t *vectors, size_t vector_count, size_t *bytes_written)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+
+    // Joins the parts so that the write checks above see the whole message
+    size_t buffer_size = 0;
+    for (size_t i = 0; i < vector_count; ++i) {
+        buffer_size += vectors[i].size;
+    }
+
+    char *buffer = KAA_MALLOC(buffer_size);
+    KAA_RETURN_IF_NIL(buffer, KAA_TCP_SOCK_IO_ERROR);
+
+    char *cursor = buffer;
+    for (size_t i = 0; i < vector_count; ++i) {
+        memcpy(cursor, vectors[i].buffer, vectors[i].size);
+        cursor += vectors[i].size;
+    }
+
+    ext_tcp_socket_io_errors_t io_error = ext_tcp_utils_tcp_socket_write(fd, buffer, buffer_size, bytes_written);
+    KAA_FREE(buffer);
+    return io_error;
+}
+
 kaa_error_t ext_tcp_utils_open_tcp_socket(kaa_fd_t *fd, const kaa_sockaddr_t *destination, kaa_socklen_t destination_size)
 {
     int result_memcmp;
@@ -838,4 +925,5 @@ KAA_SUITE_MAIN(Log, test_init, test_deinit,
         KAA_TEST_CASE(set_access_point_connecting_error, test_set_access_point_connecting_error)
         KAA_TEST_CASE(set_access_point_io_error, test_set_access_point_io_error)
         KAA_TEST_CASE(bootstrap_sync_success, test_bootstrap_sync_success)
+        KAA_TEST_CASE(switch_to_operations_services, test_switch_to_operations_services)
         )
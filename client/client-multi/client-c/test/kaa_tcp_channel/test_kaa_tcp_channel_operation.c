@@ -562,12 +562,24 @@ void test_check_channel_auth(kaa_transport_channel_interface_t *channel)
     //and WR false, no pending services and empty buffer.
     CHECK_SOCKET_RW(channel, true, false);
 
+    //The channel wakes up no later than the CONNACK timeout
+    uint32_t timeout_ms = 0;
+    error_code = kaa_tcp_channel_get_max_timeout_ms(channel, &timeout_ms);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(timeout_ms <= KAA_TCP_CHANNEL_PING_TIMEOUT * 1000);
+
 
     //Imitate socket ready for reading, and read CONNACK message
     error_code = kaa_tcp_channel_process_event(channel, FD_READ);
     ASSERT_EQUAL(error_code, KAA_ERR_NONE);
     ASSERT_EQUAL(access_point_test_info.connack_read, true);
 
+    //Once authorized, the next deadline is the keepalive ping
+    error_code = kaa_tcp_channel_get_max_timeout_ms(channel, &timeout_ms);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(timeout_ms <= KAA_TCP_CHANNEL_PING_TIMEOUT * 1000);
+    ASSERT_TRUE(timeout_ms > (KAA_TCP_CHANNEL_PING_TIMEOUT - 1) * 1000);
+
     //Check correct RD,WR operation, in this point we waiting for RD operations true
     //and WR false, no pending services and empty buffer.
     //Checking receiving KAA_SYNC message
@@ -756,16 +768,22 @@ kaa_error_t kaa_platform_protocol_process_server_sync(kaa_platform_protocol_t *s
     return KAA_ERR_BADPARAM;
 }
 
-kaa_error_t kaa_platform_protocol_alloc_serialize_client_sync(kaa_platform_protocol_t *self,
-        const kaa_extension_id *services, size_t services_count,
-        uint8_t **buffer, size_t *buffer_size)
+kaa_error_t kaa_platform_protocol_scratch_serialize_client_sync(kaa_platform_protocol_t *self,
+        kaa_scratch_t *scratch, const kaa_extension_id *services, size_t services_count,
+        uint8_t **buffer, size_t *buffer_size, kaa_platform_message_splices_t *splices)
 {
     (void)self;
+    (void)splices;
 
     ASSERT_EQUAL(services_count > 0, true);
     ASSERT_NOT_NULL(services);
 
-    uint8_t *alloc_buffer = KAA_MALLOC(sizeof(CONNECT_PACK));
+#ifdef KAA_ENCRYPTION
+    /* The channel encrypts in place */
+    uint8_t *alloc_buffer = kaa_scratch_alloc(scratch, ext_get_encrypted_data_size(sizeof(CONNECT_PACK)));
+#else
+    uint8_t *alloc_buffer = kaa_scratch_alloc(scratch, sizeof(CONNECT_PACK));
+#endif
     if (alloc_buffer) {
         memcpy(alloc_buffer, CONNECT_PACK, sizeof(CONNECT_PACK));
         *buffer = alloc_buffer;
@@ -924,6 +942,30 @@ ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_write(kaa_fd_t fd, const cha
     return KAA_TCP_SOCK_IO_ERROR;
 }
 
+ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_writev(kaa_fd_t fd, const ext_tcp_io_vector_t *vectors, size_t vector_count, size_t *bytes_written)
+{
+    KAA_RETURN_IF_NIL2(vectors, vector_count, KAA_TCP_SOCK_IO_ERROR);
+
+    // Joins the parts so that the write checks above see the whole message
+    size_t buffer_size = 0;
+    for (size_t i = 0; i < vector_count; ++i) {
+        buffer_size += vectors[i].size;
+    }
+
+    char *buffer = KAA_MALLOC(buffer_size);
+    KAA_RETURN_IF_NIL(buffer, KAA_TCP_SOCK_IO_ERROR);
+
+    char *cursor = buffer;
+    for (size_t i = 0; i < vector_count; ++i) {
+        memcpy(cursor, vectors[i].buffer, vectors[i].size);
+        cursor += vectors[i].size;
+    }
+
+    ext_tcp_socket_io_errors_t io_error = ext_tcp_utils_tcp_socket_write(fd, buffer, buffer_size, bytes_written);
+    KAA_FREE(buffer);
+    return io_error;
+}
+
 kaa_error_t ext_tcp_utils_open_tcp_socket(kaa_fd_t *fd, const kaa_sockaddr_t *destination, kaa_socklen_t destination_size)
 {
     KAA_RETURN_IF_NIL3(fd, destination, destination_size, KAA_ERR_BADPARAM);
@@ -40,6 +40,12 @@ void ext_status_store(const char *buffer, size_t buffer_size)
     (void)buffer_size;
 }
 
+void ext_status_append(const char *buffer, size_t buffer_size)
+{
+    (void)buffer;
+    (void)buffer_size;
+}
+
 void ext_get_endpoint_public_key(const uint8_t **buffer, size_t *buffer_size)
 {
     *buffer = test_ep_key;
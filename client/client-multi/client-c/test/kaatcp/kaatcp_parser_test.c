@@ -84,7 +84,7 @@ void test_kaatcp_parser(void **state)
 {
     (void)state;
 
-    kaatcp_parser_handlers_t handlers = { NULL, &connack_listener, &disconnect_listener, &kaasync_listener, &ping_listener };
+    kaatcp_parser_handlers_t handlers = { NULL, &connack_listener, &disconnect_listener, &kaasync_listener, &ping_listener, NULL };
     kaatcp_parser_t parser;
 
     parser.payload_buffer_size = 1;
@@ -101,13 +101,13 @@ void test_kaatcp_parser(void **state)
     ASSERT_NOT_EQUAL(connack_received, 0);
 
     uint8_t kaa_sync_message[] = { 0xF0, 0x0D, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xFF };
-    rval = kaatcp_parser_process_buffer(&parser, (const char *)kaa_sync_message, 15);
+    rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, 15);
     ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
 
     ASSERT_NOT_EQUAL(kaasync_received, 0);
 
     unsigned char disconnect_message[] = { 0xE0, 0x02, 0x00, 0x01 };
-    rval = kaatcp_parser_process_buffer(&parser, (const char *) disconnect_message, 4);
+    rval = kaatcp_parser_process_buffer(&parser, (char *)disconnect_message, 4);
     ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
 
     ASSERT_NOT_EQUAL(disconnect_received, 0);
@@ -115,6 +115,170 @@ void test_kaatcp_parser(void **state)
     KAA_FREE(parser.payload);
 }
 
+static char *kaasync_request;
+
+static void kaasync_pointer_listener(void *context, kaatcp_kaasync_t *message)
+{
+    (void)context;
+
+    ASSERT_EQUAL(message->sync_request_size, 1);
+    ASSERT_EQUAL((uint8_t)message->sync_request[0], 0xFF);
+    kaasync_request = message->sync_request;
+
+    kaatcp_parser_kaasync_destroy(message);
+}
+
+void test_kaatcp_parser_in_place(void **state)
+{
+    (void)state;
+
+    kaatcp_parser_handlers_t handlers = { NULL, NULL, NULL, &kaasync_pointer_listener, NULL, NULL };
+    kaatcp_parser_t parser;
+
+    parser.payload_buffer_size = 0;
+    parser.payload = NULL;
+
+    kaatcp_error_t rval = kaatcp_parser_init(&parser, &handlers);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+
+    uint8_t kaa_sync_message[] = { 0xF0, 0x0D, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xFF };
+
+    /* A frame that is whole in the input buffer is not copied. */
+    kaasync_request = NULL;
+    rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, sizeof(kaa_sync_message));
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_TRUE(kaasync_request == (char *)kaa_sync_message + sizeof(kaa_sync_message) - 1);
+    ASSERT_NULL(parser.payload);
+
+    /* A frame split across reads is collected in the parser's payload buffer. */
+    kaasync_request = NULL;
+    rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, 6);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NULL(kaasync_request);
+    rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message + 6, sizeof(kaa_sync_message) - 6);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NOT_NULL(parser.payload);
+    ASSERT_TRUE(kaasync_request == parser.payload + KAA_SYNC_HEADER_LENGTH);
+    ASSERT_EQUAL(parser.payload_buffer_size, 13);
+
+    KAA_FREE(parser.payload);
+}
+
+static size_t streamed_size;
+
+static void kaasync_chunk_listener(void *context, const kaatcp_kaasync_header_t *header
+                                 , char *chunk, size_t chunk_size
+                                 , size_t offset, size_t total_size)
+{
+    (void)context;
+
+    ASSERT_EQUAL(header->message_id, 5);
+    ASSERT_EQUAL(offset, streamed_size);
+    ASSERT_EQUAL(total_size, 3);
+    for (size_t i = 0; i < chunk_size; ++i) {
+        ASSERT_EQUAL((uint8_t)chunk[i], 0xF0 + offset + i);
+    }
+    streamed_size += chunk_size;
+}
+
+void test_kaatcp_parser_max_message_length(void **state)
+{
+    (void)state;
+
+    kaatcp_parser_handlers_t handlers = { NULL, &connack_listener, NULL, &kaasync_pointer_listener, NULL, NULL };
+    kaatcp_parser_t parser;
+
+    parser.payload_buffer_size = 0;
+    parser.payload = NULL;
+
+    kaatcp_error_t rval = kaatcp_parser_init(&parser, &handlers);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    parser.max_message_length = KAA_SYNC_HEADER_LENGTH + 1;
+
+    /* Without a chunk handler a too large message is rejected. */
+    uint8_t kaa_sync_message[] = { 0xF0, 0x0F, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xF0, 0xF1, 0xF2 };
+    rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, sizeof(kaa_sync_message));
+    ASSERT_EQUAL(rval, KAATCP_ERR_MESSAGE_TOO_LARGE);
+
+    handlers.kaasync_chunk_handler = &kaasync_chunk_listener;
+    rval = kaatcp_parser_init(&parser, &handlers);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    parser.max_message_length = KAA_SYNC_HEADER_LENGTH + 1;
+
+    /* Messages that fit are still delivered whole. */
+    uint8_t small_sync_message[] = { 0xF0, 0x0D, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xFF };
+    kaasync_request = NULL;
+    rval = kaatcp_parser_process_buffer(&parser, (char *)small_sync_message, sizeof(small_sync_message));
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NOT_NULL(kaasync_request);
+
+    /* A large one is streamed, whatever way it is split, and never buffered whole. */
+    for (size_t split = 1; split < sizeof(kaa_sync_message); ++split) {
+        streamed_size = 0;
+        rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, split);
+        ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+        rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message + split, sizeof(kaa_sync_message) - split);
+        ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+        ASSERT_EQUAL(streamed_size, 3);
+        ASSERT_TRUE(parser.payload_buffer_size <= KAA_SYNC_HEADER_LENGTH);
+    }
+
+    /* The parser is ready for the next message. */
+    connack_received = 0;
+    uint8_t connack_message[] = { 0x20, 0x02, 0x00, 0x03 };
+    rval = kaatcp_parser_process_buffer(&parser, (char *)connack_message, sizeof(connack_message));
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NOT_EQUAL(connack_received, 0);
+
+    KAA_FREE(parser.payload);
+}
+
+void test_kaatcp_parser_length_encoding(void **state)
+{
+    (void)state;
+
+    kaatcp_parser_handlers_t handlers = { NULL, NULL, NULL, &kaasync_listener, &ping_listener, NULL };
+    kaatcp_parser_t parser;
+    parser.payload_buffer_size = 0;
+    parser.payload = NULL;
+
+    kaatcp_error_t rval = kaatcp_parser_init(&parser, &handlers);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+
+    /* A two-byte length, decoded at once or split anywhere. */
+    uint8_t kaa_sync_message[] = { 0xF0, 0x8D, 0x00, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xFF };
+    for (size_t split = 1; split <= 3; ++split) {
+        kaasync_received = 0;
+        rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message, split);
+        ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+        rval = kaatcp_parser_process_buffer(&parser, (char *)kaa_sync_message + split, sizeof(kaa_sync_message) - split);
+        ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+        ASSERT_NOT_EQUAL(kaasync_received, 0);
+    }
+
+    /* Consecutive pings in one buffer. */
+    uint8_t ping_messages[] = { 0xD0, 0x00, 0xD0, 0x00 };
+    ping_received = 0;
+    rval = kaatcp_parser_process_buffer(&parser, (char *)ping_messages, sizeof(ping_messages));
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NOT_EQUAL(ping_received, 0);
+    ASSERT_EQUAL(parser.state, KAATCP_PARSER_STATE_NONE);
+
+    /* The length takes at most four bytes. */
+    uint8_t bad_length[] = { 0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    rval = kaatcp_parser_process_buffer(&parser, (char *)bad_length, sizeof(bad_length));
+    ASSERT_EQUAL(rval, KAATCP_ERR_INVALID_PROTOCOL);
+    kaatcp_parser_reset(&parser);
+    for (size_t i = 0; i < 4; ++i) {
+        rval = kaatcp_parser_process_buffer(&parser, (char *)bad_length + i, 1);
+        ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    }
+    rval = kaatcp_parser_process_buffer(&parser, (char *)bad_length + 4, 1);
+    ASSERT_EQUAL(rval, KAATCP_ERR_INVALID_PROTOCOL);
+
+    KAA_FREE(parser.payload);
+}
+
 int test_init(void)
 {
     kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -134,5 +298,8 @@ int test_deinit(void)
 KAA_SUITE_MAIN(Log, test_init, test_deinit
        ,
        KAA_TEST_CASE(kaatcp_parser, test_kaatcp_parser)
+       KAA_TEST_CASE(kaatcp_parser_in_place, test_kaatcp_parser_in_place)
+       KAA_TEST_CASE(kaatcp_parser_max_message_length, test_kaatcp_parser_max_message_length)
+       KAA_TEST_CASE(kaatcp_parser_length_encoding, test_kaatcp_parser_length_encoding)
 )
 
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <kaa_private.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#include "platform/ext_log_storage.h"
+#include "platform/file_utils.h"
+
+/* Same as the storage defaults */
+#define TEST_SEGMENT_COUNT          8
+#define TEST_RECORDS_PER_SEGMENT    8
+#define TEST_BIG_RECORD_SIZE        2000
+
+static kaa_logger_t *logger = NULL;
+
+
+
+static void delete_segments(void)
+{
+    for (int i = 0; i < TEST_SEGMENT_COUNT; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "kaa_logs_%d.bin", i);
+        posix_binary_file_delete(name);
+    }
+}
+
+static kaa_error_t add_log_record(void *storage, const char *data, size_t size, uint16_t bucket_id)
+{
+    kaa_log_record_t record = { NULL, size, bucket_id };
+    kaa_error_t error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    KAA_RETURN_IF_ERR(error_code);
+
+    memcpy(record.data, data, size);
+    error_code = ext_log_storage_add_log_record(storage, &record);
+    if (error_code) {
+        ext_log_storage_deallocate_log_record_buffer(storage, &record);
+    }
+    return error_code;
+}
+
+static void assert_next_record(void *storage, const char *data, uint16_t bucket_id)
+{
+    char buffer[TEST_BIG_RECORD_SIZE];
+    uint16_t record_bucket_id = 0;
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_write_next_record(storage, buffer, sizeof(buffer),
+            &record_bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(record_len, strlen(data));
+    ASSERT_EQUAL(record_bucket_id, bucket_id);
+    ASSERT_EQUAL(memcmp(buffer, data, record_len), 0);
+}
+
+static void assert_no_next_record(void *storage)
+{
+    char buffer[TEST_BIG_RECORD_SIZE];
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_write_next_record(storage, buffer, sizeof(buffer),
+            NULL, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+}
+
+
+
+void test_records_survive_restart(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 4, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "BB", 2, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "CCC", 3, 2), KAA_ERR_NONE);
+
+    /* Marks are not persisted, the records are sent again */
+    assert_next_record(storage, "AAAA", 1);
+    ext_log_storage_destroy(storage);
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 3);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), 9);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BB", 1);
+    assert_next_record(storage, "CCC", 2);
+    assert_no_next_record(storage);
+
+    /* Delivered records are gone for good */
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 2), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+    assert_no_next_record(storage);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
+void test_unmark_and_remove_buckets(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 4, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "BBBB", 4, 2), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "CCCC", 4, 3), KAA_ERR_NONE);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BBBB", 2);
+    assert_next_record(storage, "CCCC", 3);
+
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, 4), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 4), KAA_ERR_NOT_FOUND);
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 2), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_no_next_record(storage);
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 3), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
+void test_segments_rotate(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    char data[TEST_BIG_RECORD_SIZE + 1];
+    for (int i = 0; i < TEST_SEGMENT_COUNT * TEST_RECORDS_PER_SEGMENT; ++i) {
+        memset(data, 'A' + i % 26, TEST_BIG_RECORD_SIZE);
+        ASSERT_EQUAL(add_log_record(storage, data, TEST_BIG_RECORD_SIZE, 1 + i / 10), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), TEST_SEGMENT_COUNT * TEST_RECORDS_PER_SEGMENT);
+
+    /* The eldest segment is dropped */
+    memset(data, 'Z', TEST_BIG_RECORD_SIZE);
+    ASSERT_EQUAL(add_log_record(storage, data, TEST_BIG_RECORD_SIZE, 9), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage),
+            (TEST_SEGMENT_COUNT - 1) * TEST_RECORDS_PER_SEGMENT + 1);
+
+    data[TEST_BIG_RECORD_SIZE] = '\0';
+    memset(data, 'A' + TEST_RECORDS_PER_SEGMENT, TEST_BIG_RECORD_SIZE);
+    assert_next_record(storage, data, 1);
+    ext_log_storage_destroy(storage);
+
+    /* Reloaded from the newest segment backwards */
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage),
+            (TEST_SEGMENT_COUNT - 1) * TEST_RECORDS_PER_SEGMENT + 1);
+    assert_next_record(storage, data, 1);
+
+    /* A record bigger than the read window is refused */
+    kaa_log_record_t record = { NULL, 4096, 1 };
+    error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOMEM);
+
+    ext_log_storage_destroy(storage);
+    delete_segments();
+}
+
+
+
+void test_torn_record_ignored(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 4, 1), KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+
+    /* The header of a record written partially */
+    const char torn[] = { 4, 0, 0, 0, 1, 0 };
+    ASSERT_EQUAL(posix_binary_file_append("kaa_logs_0.bin", torn, sizeof(torn)), 0);
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+
+    /* Not appended after the garbage */
+    ASSERT_EQUAL(add_log_record(storage, "BBBB", 4, 2), KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 2);
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BBBB", 2);
+
+    ext_log_storage_destroy(storage);
+    delete_segments();
+}
+
+
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger) {
+        return error;
+    }
+
+    delete_segments();
+    return 0;
+}
+
+int test_deinit(void)
+{
+    delete_segments();
+    kaa_log_destroy(logger);
+    return 0;
+}
+
+
+
+KAA_SUITE_MAIN(FileLogStorage, test_init, test_deinit,
+        KAA_TEST_CASE(records_survive_restart, test_records_survive_restart)
+        KAA_TEST_CASE(unmark_and_remove_buckets, test_unmark_and_remove_buckets)
+        KAA_TEST_CASE(segments_rotate, test_segments_rotate)
+        KAA_TEST_CASE(torn_record_ignored, test_torn_record_ignored)
+)
@@ -246,6 +246,59 @@ void test_write_next_log_record(void **state)
 
 
 
+void test_get_next_log_record(void **state)
+{
+    (void)state;
+
+    kaa_error_t error_code;
+    void *storage;
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    uint16_t bucket_id = 0;
+    size_t record_len = 0;
+    const char *record_data = NULL;
+
+    error_code = ext_log_storage_get_next_record(storage, 33, NULL, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = ext_log_storage_get_next_record(storage, 33, &record_data, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+
+    const char *data = "DATA";
+    size_t data_size = strlen("DATA");
+
+    error_code = add_log_record(storage, data, data_size, TEST_RECORD_BUCKET_ID);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    error_code = ext_log_storage_get_next_record(storage, 1, &record_data, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_INSUFFICIENT_BUFFER);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+
+    error_code = ext_log_storage_get_next_record(storage, data_size, &record_data, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(record_len, data_size);
+    ASSERT_EQUAL(bucket_id, TEST_RECORD_BUCKET_ID);
+    ASSERT_EQUAL(memcmp(record_data, data, data_size), 0);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    error_code = ext_log_storage_get_next_record(storage, data_size, &record_data, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+
+    /* The data isn't copied, the same stored extent is returned again */
+    const char *first_data = record_data;
+    error_code = ext_log_storage_unmark_by_bucket_id(storage, TEST_RECORD_BUCKET_ID);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = ext_log_storage_get_next_record(storage, data_size, &record_data, &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_TRUE(record_data == first_data);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
 void test_remove_by_bucket_id(void **state)
 {
     (void)state;
@@ -448,6 +501,7 @@ KAA_SUITE_MAIN(MetaExtension, test_init, test_deinit,
         KAA_TEST_CASE(allocate_log_record_buffer, test_allocate_log_record_buffer)
         KAA_TEST_CASE(add_log_record, test_add_log_record)
         KAA_TEST_CASE(write_next_log_record, test_write_next_log_record)
+        KAA_TEST_CASE(get_next_log_record, test_get_next_log_record)
         KAA_TEST_CASE(remove_by_bucket_id, test_remove_by_bucket_id)
         KAA_TEST_CASE(unmark_by_bucket_id, test_unmark_by_bucket_id)
         KAA_TEST_CASE(shrink_to_size, test_shrink_to_size)
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <kaa_private.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#include "platform/ext_log_storage.h"
+
+#include "kaa_logging_private.h"
+
+/* Header of 8 bytes and 4 bytes of data */
+#define TEST_SLOT_SIZE      12
+#define TEST_RING_SIZE      (4 * TEST_SLOT_SIZE + 4)
+
+static kaa_logger_t *logger = NULL;
+static uint32_t ring[TEST_RING_SIZE / sizeof(uint32_t)];
+
+
+
+static kaa_error_t add_log_record(void *storage, const char *data, uint16_t bucket_id)
+{
+    kaa_log_record_t record = { NULL, strlen(data), bucket_id };
+    kaa_error_t error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    KAA_RETURN_IF_ERR(error_code);
+
+    memcpy(record.data, data, record.size);
+    return ext_log_storage_add_log_record(storage, &record);
+}
+
+static void assert_next_record(void *storage, const char *data, uint16_t bucket_id)
+{
+    const char *record_data = NULL;
+    uint16_t record_bucket_id = 0;
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_get_next_record(storage, TEST_RING_SIZE,
+            &record_data, &record_bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(record_len, strlen(data));
+    ASSERT_EQUAL(record_bucket_id, bucket_id);
+    ASSERT_EQUAL(memcmp(record_data, data, record_len), 0);
+}
+
+static void assert_no_next_record(void *storage)
+{
+    const char *record_data = NULL;
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_get_next_record(storage, TEST_RING_SIZE,
+            &record_data, NULL, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+}
+
+
+
+void test_create_ring_storage(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+
+    kaa_error_t error_code = ext_ring_log_storage_create(&storage, logger, ring, 0);
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = ext_ring_log_storage_create(&storage, logger, ring, TEST_SLOT_SIZE - 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = ext_ring_log_storage_create(&storage, NULL, ring, sizeof(ring));
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = ext_ring_log_storage_create(&storage, logger, NULL, sizeof(ring));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+
+    error_code = ext_limited_log_storage_create(&storage, logger, sizeof(ring), 101);
+    ASSERT_EQUAL(error_code, KAA_ERR_BADPARAM);
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+}
+
+
+
+void test_records_stored_in_ring(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_ring_log_storage_create(&storage, logger, ring, sizeof(ring));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    kaa_log_record_t record = { NULL, 4, 1 };
+    error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    /* Serialized right into the ring, nothing is allocated */
+    ASSERT_TRUE(record.data > (char *)ring && record.data < (char *)ring + sizeof(ring));
+
+    error_code = ext_log_storage_deallocate_log_record_buffer(storage, &record);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "BB", 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 2);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), 6);
+
+    /* Records added from another buffer are copied in */
+    char *data = KAA_MALLOC(3);
+    memcpy(data, "CCC", 3);
+    kaa_log_record_t foreign = { data, 3, 2 };
+    ASSERT_EQUAL(ext_log_storage_add_log_record(storage, &foreign), KAA_ERR_NONE);
+    ASSERT_NULL(foreign.data);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BB", 1);
+    assert_next_record(storage, "CCC", 2);
+    assert_no_next_record(storage);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
+void test_unmark_and_remove_buckets(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_ring_log_storage_create(&storage, logger, ring, sizeof(ring));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "BBBB", 2), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "CCCC", 3), KAA_ERR_NONE);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BBBB", 2);
+    assert_next_record(storage, "CCCC", 3);
+
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, 4), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 4), KAA_ERR_NOT_FOUND);
+
+    /* The second bucket is delivered first, the first one times out */
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 2), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+
+    /* The removed and the marked buckets are skipped */
+    assert_next_record(storage, "AAAA", 1);
+    assert_no_next_record(storage);
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 3), KAA_ERR_NONE);
+
+    /* Everything is reclaimed, the whole ring is free again */
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQUAL(add_log_record(storage, "DDDD", 5), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 4);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
+void test_ring_wraps_and_drops_elder_records(void **state)
+{
+    (void)state;
+
+    void *storage = NULL;
+    kaa_error_t error_code = ext_ring_log_storage_create(&storage, logger, ring, sizeof(ring));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(add_log_record(storage, "AAAA", 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "BBBB", 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "CCCC", 2), KAA_ERR_NONE);
+
+    assert_next_record(storage, "AAAA", 1);
+    assert_next_record(storage, "BBBB", 1);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NONE);
+
+    /* Doesn't fit the end of the ring, goes to the beginning */
+    ASSERT_EQUAL(add_log_record(storage, "DDDDDDDD", 3), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "EEEE", 3), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(add_log_record(storage, "FFFF", 4), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 4);
+
+    /* No room left, the eldest record is dropped */
+    ASSERT_EQUAL(add_log_record(storage, "GGGG", 4), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 4);
+
+    assert_next_record(storage, "DDDDDDDD", 3);
+    assert_next_record(storage, "EEEE", 3);
+    assert_next_record(storage, "FFFF", 4);
+    assert_next_record(storage, "GGGG", 4);
+    assert_no_next_record(storage);
+
+    /* A record larger than the ring is refused */
+    kaa_log_record_t record = { NULL, sizeof(ring), 5 };
+    error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOMEM);
+
+    ext_log_storage_destroy(storage);
+}
+
+
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger) {
+        return error;
+    }
+
+    return 0;
+}
+
+int test_deinit(void)
+{
+    kaa_log_destroy(logger);
+    return 0;
+}
+
+
+
+KAA_SUITE_MAIN(RingLogStorage, test_init, test_deinit,
+        KAA_TEST_CASE(create_ring_storage, test_create_ring_storage)
+        KAA_TEST_CASE(records_stored_in_ring, test_records_stored_in_ring)
+        KAA_TEST_CASE(unmark_and_remove_buckets, test_unmark_and_remove_buckets)
+        KAA_TEST_CASE(ring_wraps_and_drops_elder_records, test_ring_wraps_and_drops_elder_records)
+)
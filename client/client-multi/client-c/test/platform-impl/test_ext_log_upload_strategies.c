@@ -267,6 +267,39 @@ void test_upload_decision_on_failure(void **state)
     ASSERT_EQUAL(upload_decision, UPLOAD);
 }
 
+void test_decision_delay(void **state)
+{
+    (void)state;
+
+    size_t DEFAULT_UPLOAD_TIMEOUT = 100;
+    size_t DEFAULT_RETRY_PERIOD   = 10;
+
+    ASSERT_EQUAL(ext_log_upload_strategy_get_decision_delay(NULL), SIZE_MAX);
+
+    kaa_error_t error_code = ext_log_upload_strategy_change_strategy(strategy,
+            KAA_LOG_UPLOAD_VOLUME_STRATEGY);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_upload_strategy_get_decision_delay(strategy), SIZE_MAX);
+
+    error_code = ext_log_upload_strategy_change_strategy(strategy,
+            KAA_LOG_UPLOAD_BY_STORAGE_SIZE_AND_TIMELIMIT);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = ext_log_upload_strategy_set_upload_timeout(strategy, DEFAULT_UPLOAD_TIMEOUT);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t delay = ext_log_upload_strategy_get_decision_delay(strategy);
+    ASSERT_TRUE(delay > DEFAULT_UPLOAD_TIMEOUT - 2 && delay <= DEFAULT_UPLOAD_TIMEOUT);
+
+    /* The retry comes first */
+    error_code = ext_log_upload_strategy_set_upload_retry_period(strategy, DEFAULT_RETRY_PERIOD);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = ext_log_upload_strategy_on_failure(strategy, REMOTE_CONNECTION_ERROR);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    delay = ext_log_upload_strategy_get_decision_delay(strategy);
+    ASSERT_TRUE(delay > DEFAULT_RETRY_PERIOD - 2 && delay <= DEFAULT_RETRY_PERIOD);
+}
+
 int test_init(void)
 {
     kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -311,4 +344,5 @@ KAA_SUITE_MAIN(MetaExtension, test_init, test_deinit,
         KAA_TEST_CASE(upload_decision_by_timeout, test_upload_decision_by_timeout)
         KAA_TEST_CASE(noop_decision_on_failure, test_noop_decision_on_failure)
         KAA_TEST_CASE(upload_decision_on_failure, test_upload_decision_on_failure)
+        KAA_TEST_CASE(decision_delay, test_decision_delay)
 )
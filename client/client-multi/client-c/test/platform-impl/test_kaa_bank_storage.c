@@ -0,0 +1,270 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_mem.h"
+#include "platform-impl/common/kaa_bank_storage.h"
+
+#define TEST_FILE_MAX_SIZE      256
+
+/* In-memory files; a write may be cut short to simulate a reset */
+typedef struct {
+    const char  *name;
+    char        data[TEST_FILE_MAX_SIZE];
+    size_t      size;
+    bool        exists;
+} test_file_t;
+
+static test_file_t test_files[] = { { "bank_0", { 0 }, 0, false }, { "bank_1", { 0 }, 0, false } };
+static size_t test_write_count;
+static size_t test_write_limit;     /* Bytes to write before the reset, SIZE_MAX for none */
+
+static test_file_t *test_file_get(const char *file_name)
+{
+    for (size_t i = 0; i < sizeof(test_files) / sizeof(test_files[0]); ++i) {
+        if (!strcmp(test_files[i].name, file_name)) {
+            return &test_files[i];
+        }
+    }
+    return NULL;
+}
+
+static int test_file_read(const char *file_name, char **buffer, size_t *buffer_size, bool *needs_deallocation)
+{
+    test_file_t *file = test_file_get(file_name);
+    if (!file || !file->exists || !file->size) {
+        return -1;
+    }
+
+    *buffer = KAA_MALLOC(file->size);
+    memcpy(*buffer, file->data, file->size);
+    *buffer_size = file->size;
+    *needs_deallocation = true;
+    return 0;
+}
+
+static int test_file_write(test_file_t *file, const char *buffer, size_t buffer_size)
+{
+    ++test_write_count;
+    size_t written = buffer_size < test_write_limit ? buffer_size : test_write_limit;
+    test_write_limit -= written;
+
+    memcpy(file->data + file->size, buffer, written);
+    file->size += written;
+    file->exists = true;
+    return written == buffer_size ? 0 : -1;
+}
+
+static int test_file_store(const char *file_name, const char *buffer, size_t buffer_size)
+{
+    test_file_t *file = test_file_get(file_name);
+    file->size = 0;
+    return test_file_write(file, buffer, buffer_size);
+}
+
+static int test_file_append(const char *file_name, const char *buffer, size_t buffer_size)
+{
+    return test_file_write(test_file_get(file_name), buffer, buffer_size);
+}
+
+static int test_file_remove(const char *file_name)
+{
+    test_file_t *file = test_file_get(file_name);
+    file->exists = false;
+    file->size = 0;
+    return 0;
+}
+
+static const kaa_bank_file_ops_t test_file_ops = {
+    test_file_read,
+    test_file_store,
+    test_file_append,
+    test_file_remove,
+};
+
+static kaa_bank_storage_t test_storage_create(void)
+{
+    kaa_bank_storage_t storage = KAA_BANK_STORAGE_INITIALIZER("bank_0", "bank_1", &test_file_ops);
+    return storage;
+}
+
+/* Reads the storage as after a restart */
+static void test_storage_check(const char *expected, size_t expected_size)
+{
+    kaa_bank_storage_t storage = test_storage_create();
+    char *buffer = NULL;
+    size_t buffer_size = 0;
+    bool needs_deallocation = false;
+
+    kaa_bank_storage_read(&storage, &buffer, &buffer_size, &needs_deallocation);
+    ASSERT_EQUAL(buffer_size, expected_size);
+    if (expected_size) {
+        ASSERT_NOT_NULL(buffer);
+        ASSERT_EQUAL(memcmp(buffer, expected, expected_size), 0);
+    }
+
+    if (needs_deallocation) {
+        KAA_FREE(buffer);
+    }
+}
+
+static int test_init(void)
+{
+    for (size_t i = 0; i < sizeof(test_files) / sizeof(test_files[0]); ++i) {
+        test_files[i].exists = false;
+        test_files[i].size = 0;
+    }
+    test_write_count = 0;
+    test_write_limit = SIZE_MAX;
+    return 0;
+}
+
+void test_read_empty(void **state)
+{
+    (void)state;
+    test_init();
+    test_storage_check(NULL, 0);
+}
+
+void test_store_alternates_banks(void **state)
+{
+    (void)state;
+    test_init();
+    kaa_bank_storage_t storage = test_storage_create();
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "first", 5), 0);
+    ASSERT_TRUE(test_files[1].exists);
+    ASSERT_FALSE(test_files[0].exists);
+    test_storage_check("first", 5);
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "second", 6), 0);
+    ASSERT_TRUE(test_files[0].exists);
+    ASSERT_TRUE(test_files[1].exists);
+    test_storage_check("second", 6);
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "third", 5), 0);
+    test_storage_check("third", 5);
+}
+
+void test_identical_store_is_skipped(void **state)
+{
+    (void)state;
+    test_init();
+    kaa_bank_storage_t storage = test_storage_create();
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "status", 6), 0);
+    size_t write_count = test_write_count;
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "status", 6), 0);
+    ASSERT_EQUAL(test_write_count, write_count);
+
+    /* Also after a restart */
+    storage = test_storage_create();
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "status", 6), 0);
+    ASSERT_EQUAL(test_write_count, write_count);
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "statuz", 6), 0);
+    ASSERT_NOT_EQUAL(test_write_count, write_count);
+    test_storage_check("statuz", 6);
+}
+
+void test_interrupted_store_keeps_previous(void **state)
+{
+    (void)state;
+    test_init();
+    kaa_bank_storage_t storage = test_storage_create();
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "previous", 8), 0);
+
+    /* Reset in the middle of the header and in the middle of the blob */
+    for (size_t limit = 8; limit <= 20; limit += 12) {
+        test_write_limit = limit;
+        ASSERT_NOT_EQUAL(kaa_bank_storage_store(&storage, "interrupted", 11), 0);
+        test_write_limit = SIZE_MAX;
+        test_storage_check("previous", 8);
+    }
+
+    /* The damaged bank is the next to be written */
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "next", 4), 0);
+    test_storage_check("next", 4);
+}
+
+void test_append(void **state)
+{
+    (void)state;
+    test_init();
+    kaa_bank_storage_t storage = test_storage_create();
+
+    ASSERT_NOT_EQUAL(kaa_bank_storage_append(&storage, "records", 7), 0);
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "base", 4), 0);
+    ASSERT_EQUAL(kaa_bank_storage_append(&storage, "+one", 4), 0);
+    ASSERT_EQUAL(kaa_bank_storage_append(&storage, "+two", 4), 0);
+    test_storage_check("base+one+two", 12);
+
+    /* The same blob is stored again to drop the appended data */
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "base", 4), 0);
+    test_storage_check("base", 4);
+}
+
+void test_legacy_file(void **state)
+{
+    (void)state;
+    test_init();
+
+    const char legacy[] = "status written before the banks";
+    memcpy(test_files[0].data, legacy, sizeof(legacy));
+    test_files[0].size = sizeof(legacy);
+    test_files[0].exists = true;
+
+    test_storage_check(legacy, sizeof(legacy));
+
+    kaa_bank_storage_t storage = test_storage_create();
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "banked", 6), 0);
+    ASSERT_FALSE(test_files[0].exists);
+    test_storage_check("banked", 6);
+}
+
+void test_delete(void **state)
+{
+    (void)state;
+    test_init();
+    kaa_bank_storage_t storage = test_storage_create();
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "first", 5), 0);
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "second", 6), 0);
+
+    kaa_bank_storage_delete(&storage);
+    test_storage_check(NULL, 0);
+
+    ASSERT_EQUAL(kaa_bank_storage_store(&storage, "second", 6), 0);
+    test_storage_check("second", 6);
+}
+
+KAA_SUITE_MAIN(BankStorage, NULL, NULL,
+        KAA_TEST_CASE(read_empty, test_read_empty)
+        KAA_TEST_CASE(store_alternates_banks, test_store_alternates_banks)
+        KAA_TEST_CASE(identical_store_is_skipped, test_identical_store_is_skipped)
+        KAA_TEST_CASE(interrupted_store_keeps_previous, test_interrupted_store_keeps_previous)
+        KAA_TEST_CASE(append, test_append)
+        KAA_TEST_CASE(legacy_file, test_legacy_file)
+        KAA_TEST_CASE(delete, test_delete)
+)
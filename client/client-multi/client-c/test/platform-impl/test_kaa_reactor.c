@@ -0,0 +1,150 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include "kaa_test.h"
+
+#include "platform-impl/posix/kaa_reactor.h"
+
+typedef struct {
+    kaa_reactor_t    *reactor;
+    size_t           read_count;
+    bool             remove_on_read;
+} test_fd_context_t;
+
+
+
+static int test_pipe[2];
+
+
+
+static void test_on_fd_event(void *context, kaa_fd_t fd, bool readable, bool writable)
+{
+    (void)writable;
+    test_fd_context_t *fd_context = context;
+
+    if (readable) {
+        char buffer[16];
+        ASSERT_TRUE(read(fd, buffer, sizeof(buffer)) > 0);
+        ++fd_context->read_count;
+    }
+
+    if (fd_context->remove_on_read) {
+        ASSERT_EQUAL(kaa_reactor_remove_fd(fd_context->reactor, fd), KAA_ERR_NONE);
+    }
+}
+
+void test_create_reactor(void **state)
+{
+    (void)state;
+
+    ASSERT_EQUAL(kaa_reactor_create(NULL), KAA_ERR_BADPARAM);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor), KAA_ERR_NONE);
+    ASSERT_NOT_NULL(reactor);
+
+    ASSERT_EQUAL(kaa_reactor_add_client(reactor, NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_remove_fd(reactor, test_pipe[0]), KAA_ERR_NOT_FOUND);
+
+    kaa_reactor_destroy(reactor);
+}
+
+void test_add_fd(void **state)
+{
+    (void)state;
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor), KAA_ERR_NONE);
+
+    test_fd_context_t fd_context = { reactor, 0, false };
+
+    ASSERT_EQUAL(kaa_reactor_add_fd(reactor, test_pipe[0], true, false, NULL, &fd_context), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_add_fd(reactor, test_pipe[0], true, false, test_on_fd_event, &fd_context), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_add_fd(reactor, test_pipe[0], true, false, test_on_fd_event, &fd_context)
+               , KAA_ERR_ALREADY_EXISTS);
+
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 0);
+
+    ASSERT_EQUAL(write(test_pipe[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 1);
+
+    ASSERT_EQUAL(kaa_reactor_modify_fd(reactor, test_pipe[0], false, false), KAA_ERR_NONE);
+    ASSERT_EQUAL(write(test_pipe[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 1);
+
+    ASSERT_EQUAL(kaa_reactor_modify_fd(reactor, test_pipe[0], true, false), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 2);
+
+    ASSERT_EQUAL(kaa_reactor_remove_fd(reactor, test_pipe[0]), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_modify_fd(reactor, test_pipe[0], true, false), KAA_ERR_NOT_FOUND);
+
+    kaa_reactor_destroy(reactor);
+}
+
+void test_remove_fd_from_callback(void **state)
+{
+    (void)state;
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor), KAA_ERR_NONE);
+
+    test_fd_context_t fd_context = { reactor, 0, true };
+    ASSERT_EQUAL(kaa_reactor_add_fd(reactor, test_pipe[0], true, false, test_on_fd_event, &fd_context), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(write(test_pipe[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 1);
+
+    ASSERT_EQUAL(write(test_pipe[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(fd_context.read_count, 1);
+    ASSERT_EQUAL(kaa_reactor_remove_fd(reactor, test_pipe[0]), KAA_ERR_NOT_FOUND);
+
+    char buffer[16];
+    ASSERT_EQUAL(read(test_pipe[0], buffer, sizeof(buffer)), 1);
+
+    kaa_reactor_destroy(reactor);
+}
+
+
+
+int test_init(void)
+{
+    return pipe(test_pipe);
+}
+
+int test_deinit(void)
+{
+    close(test_pipe[0]);
+    close(test_pipe[1]);
+    return 0;
+}
+
+
+
+KAA_SUITE_MAIN(Reactor, test_init, test_deinit,
+        KAA_TEST_CASE(create_reactor, test_create_reactor)
+        KAA_TEST_CASE(add_fd, test_add_fd)
+        KAA_TEST_CASE(remove_fd_from_callback, test_remove_fd_from_callback)
+)
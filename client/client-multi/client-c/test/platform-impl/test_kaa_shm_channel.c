@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "kaa_test.h"
+
+#include "kaa.h"
+#include "kaa_context.h"
+#include "kaa_platform_common.h"
+#include "utilities/kaa_log.h"
+#include "platform-impl/posix/kaa_shm_channel.h"
+
+#define TEST_SHM_NAME           "/kaa-test-shm-channel"
+#define TEST_RING_SIZE          512
+#define TEST_HEADER_SIZE        320
+
+/* Offsets of the indexes, see kaa_shm_channel.h */
+#define TEST_UPLINK_WRITE       64
+#define TEST_UPLINK_READ        128
+#define TEST_DOWNLINK_WRITE     192
+#define TEST_DOWNLINK_READ      256
+
+static const uint8_t server_sync[] = {
+    /* Message header: protocol id, version, extension count */
+    0x02, 0x31, 0xad, 0x61, 0x00, 0x01, 0x00, 0x01,
+    /* Meta data extension: request id 1, no resync */
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+};
+
+static kaa_extension_id services[] = { KAA_EXTENSION_PROFILE };
+
+static kaa_context_t *kaa_context;
+static kaa_transport_channel_interface_t channel;
+static uint8_t *proxy;
+
+static uint32_t *proxy_index(size_t offset)
+{
+    return (uint32_t *)(proxy + offset);
+}
+
+/* Plays the proxy: attaches to the segment the channel has created. */
+static uint8_t *proxy_attach(void)
+{
+    int fd = shm_open(TEST_SHM_NAME, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    void *segment = mmap(NULL, TEST_HEADER_SIZE + 2 * TEST_RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return segment == MAP_FAILED ? NULL : segment;
+}
+
+void test_shm_channel_layout(void **state)
+{
+    (void)state;
+
+    ASSERT_EQUAL(*proxy_index(0), KAA_SHM_CHANNEL_MAGIC);
+    ASSERT_EQUAL(*proxy_index(4), KAA_SHM_CHANNEL_VERSION);
+    ASSERT_EQUAL(*proxy_index(8), TEST_RING_SIZE);
+    ASSERT_EQUAL(*proxy_index(12), KAA_PLATFORM_PROTOCOL_ID);
+
+    /* A second endpoint with another ring size is refused */
+    kaa_transport_channel_interface_t other;
+    ASSERT_EQUAL(kaa_shm_channel_create(&other, kaa_context->logger, TEST_SHM_NAME, TEST_RING_SIZE * 2,
+            services, 1), KAA_ERR_BAD_STATE);
+    ASSERT_EQUAL(kaa_shm_channel_create(&other, kaa_context->logger, TEST_SHM_NAME, 100,
+            services, 1), KAA_ERR_BADPARAM);
+}
+
+void test_shm_channel_uplink(void **state)
+{
+    (void)state;
+
+    uint8_t *uplink = proxy + TEST_HEADER_SIZE;
+    uint32_t write_index = *proxy_index(TEST_UPLINK_WRITE);
+
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    uint32_t record_size = *(uint32_t *)(uplink + write_index);
+    ASSERT_TRUE(record_size > 0);
+    ASSERT_EQUAL(*proxy_index(TEST_UPLINK_WRITE), write_index + sizeof(uint32_t) + ((record_size + 3) & ~3u));
+
+    /* The proxy doesn't read, the syncs pile up until the ring is full */
+    uint32_t last_write_index;
+    do {
+        last_write_index = *proxy_index(TEST_UPLINK_WRITE);
+        ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    } while (*proxy_index(TEST_UPLINK_WRITE) != last_write_index);
+    ASSERT_TRUE(*proxy_index(TEST_UPLINK_WRITE) - *proxy_index(TEST_UPLINK_READ) <= TEST_RING_SIZE);
+
+    /* The postponed sync is written once the proxy frees the space */
+    *proxy_index(TEST_UPLINK_READ) = last_write_index;
+    ASSERT_EQUAL(kaa_shm_channel_process(&channel), KAA_ERR_NONE);
+    ASSERT_TRUE(*proxy_index(TEST_UPLINK_WRITE) != last_write_index);
+
+    /* The wrapped record is preceded by a padding marker */
+    uint32_t offset = last_write_index & (TEST_RING_SIZE - 1);
+    if (*proxy_index(TEST_UPLINK_WRITE) - last_write_index > TEST_RING_SIZE - offset) {
+        ASSERT_EQUAL(*(uint32_t *)(uplink + offset), KAA_SHM_CHANNEL_PAD);
+    }
+    *proxy_index(TEST_UPLINK_READ) = *proxy_index(TEST_UPLINK_WRITE);
+}
+
+void test_shm_channel_downlink(void **state)
+{
+    (void)state;
+
+    uint8_t *downlink = proxy + TEST_HEADER_SIZE + TEST_RING_SIZE;
+
+    for (size_t i = 0; i < 3; ++i) {
+        uint32_t write_index = *proxy_index(TEST_DOWNLINK_WRITE);
+        *(uint32_t *)(downlink + write_index % TEST_RING_SIZE) = sizeof(server_sync);
+        memcpy(downlink + write_index % TEST_RING_SIZE + sizeof(uint32_t), server_sync, sizeof(server_sync));
+        *proxy_index(TEST_DOWNLINK_WRITE) = write_index + sizeof(uint32_t) + sizeof(server_sync);
+    }
+
+    ASSERT_EQUAL(kaa_shm_channel_process(&channel), KAA_ERR_NONE);
+    ASSERT_EQUAL(*proxy_index(TEST_DOWNLINK_READ), *proxy_index(TEST_DOWNLINK_WRITE));
+
+    /* A record that runs past the ring end is rejected */
+    uint32_t write_index = *proxy_index(TEST_DOWNLINK_WRITE);
+    *(uint32_t *)(downlink + write_index % TEST_RING_SIZE) = TEST_RING_SIZE;
+    *proxy_index(TEST_DOWNLINK_WRITE) = write_index + sizeof(uint32_t);
+    ASSERT_EQUAL(kaa_shm_channel_process(&channel), KAA_ERR_BADDATA);
+}
+
+int test_init(void)
+{
+    shm_unlink(TEST_SHM_NAME);
+
+    kaa_error_t error = kaa_init(&kaa_context);
+    if (error) {
+        return error;
+    }
+
+    error = kaa_shm_channel_create(&channel, kaa_context->logger, TEST_SHM_NAME, TEST_RING_SIZE, services, 1);
+    if (error) {
+        return error;
+    }
+
+    kaa_transport_context_t transport_context = { kaa_context };
+    channel.init(channel.context, &transport_context);
+
+    proxy = proxy_attach();
+    return proxy ? 0 : -1;
+}
+
+int test_deinit(void)
+{
+    munmap(proxy, TEST_HEADER_SIZE + 2 * TEST_RING_SIZE);
+    channel.destroy(channel.context);
+    kaa_deinit(kaa_context);
+    return 0;
+}
+
+KAA_SUITE_MAIN(ShmChannel, test_init, test_deinit,
+        KAA_TEST_CASE(layout, test_shm_channel_layout)
+        KAA_TEST_CASE(uplink, test_shm_channel_uplink)
+        KAA_TEST_CASE(downlink, test_shm_channel_downlink)
+)
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+
+#include "kaa_test.h"
+
+#include "kaa.h"
+#include "kaa_context.h"
+#include "kaa_protocols/kaa_tcp/kaatcp.h"
+#include "utilities/kaa_log.h"
+#include "platform-impl/posix/kaa_udp_channel.h"
+
+#define TEST_HOSTNAME           "127.0.0.1"
+
+static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x01 };
+static const uint8_t disconnect[] = { 0xE0, 0x02, 0x00, 0x00 };
+
+static const uint8_t server_sync[] = {
+    /* Message header: protocol id, version, extension count */
+    0x02, 0x31, 0xad, 0x61, 0x00, 0x01, 0x00, 0x01,
+    /* Meta data extension: request id 1, no resync */
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+};
+
+static kaa_extension_id services[] = { KAA_EXTENSION_PROFILE };
+
+static kaa_context_t *kaa_context;
+static kaa_transport_channel_interface_t channel;
+static int server_fd = -1;
+static struct sockaddr_in server_addr;
+static struct sockaddr_in client_addr;
+
+/* Plays the server: waits for the next datagram from the channel */
+static ssize_t server_receive(uint8_t *buffer, size_t size, int timeout_ms)
+{
+    struct pollfd fds = { server_fd, POLLIN, 0 };
+    if (poll(&fds, 1, timeout_ms) <= 0) {
+        return -1;
+    }
+    socklen_t addr_size = sizeof(client_addr);
+    return recvfrom(server_fd, buffer, size, 0, (struct sockaddr *)&client_addr, &addr_size);
+}
+
+static void server_send(const uint8_t *buffer, size_t size)
+{
+    sendto(server_fd, buffer, size, 0, (struct sockaddr *)&client_addr, sizeof(client_addr));
+}
+
+static void server_send_kaasync(uint16_t message_id)
+{
+    kaatcp_kaasync_t message;
+    kaatcp_fill_kaasync_message((char *)server_sync, sizeof(server_sync), message_id, false, false, &message);
+    /* Responses come without the request bit */
+    message.sync_header.flags = KAA_SYNC_SYNC_BIT;
+
+    char buffer[128];
+    size_t size = sizeof(buffer);
+    kaatcp_get_request_kaasync(&message, buffer, &size);
+    server_send((const uint8_t *)buffer, size);
+}
+
+/* Lets the datagrams sent by the server reach the channel socket */
+static kaa_error_t channel_process(void)
+{
+    kaa_fd_t fd = KAA_TCP_SOCKET_NOT_SET;
+    kaa_udp_channel_get_descriptor(&channel, &fd);
+    struct pollfd fds = { fd, POLLIN, 0 };
+    poll(&fds, 1, 100);
+    return kaa_udp_channel_process(&channel, true);
+}
+
+static uint16_t kaasync_message_id(const uint8_t *datagram)
+{
+    /* Skips the type, the variable length and the protocol name, its length and version */
+    size_t position = 1;
+    while (datagram[position++] & 0x80);
+    position += 2 + KAA_TCP_NAME_LENGTH + 1;
+    return (uint16_t)((datagram[position] << 8) | datagram[position + 1]);
+}
+
+/* Each test case starts with a new channel */
+static void establish_session(void)
+{
+    uint8_t datagram[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    ASSERT_TRUE(server_receive(datagram, sizeof(datagram), 1000) > 0);
+    ASSERT_EQUAL(datagram[0] >> 4, KAATCP_MESSAGE_CONNECT);
+
+    server_send(connack, sizeof(connack));
+    server_send_kaasync(0);
+    ASSERT_EQUAL(channel_process(), KAA_ERR_NONE);
+}
+
+void test_udp_channel_connect(void **state)
+{
+    (void)state;
+
+    uint8_t datagram[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    ASSERT_TRUE(server_receive(datagram, sizeof(datagram), 1000) > 0);
+    ASSERT_EQUAL(datagram[0] >> 4, KAATCP_MESSAGE_CONNECT);
+
+    /* Nothing else is sent while the CONNECT is in flight */
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    ASSERT_TRUE(server_receive(datagram, sizeof(datagram), 100) < 0);
+
+    /* The response completes the CONNECT, the postponed sync follows in the session */
+    server_send(connack, sizeof(connack));
+    server_send_kaasync(0);
+    ASSERT_EQUAL(channel_process(), KAA_ERR_NONE);
+
+    ssize_t size = server_receive(datagram, sizeof(datagram), 1000);
+    ASSERT_TRUE(size > 0);
+    ASSERT_EQUAL(datagram[0] >> 4, KAATCP_MESSAGE_KAASYNC);
+    ASSERT_EQUAL(kaasync_message_id(datagram), 1);
+
+    server_send_kaasync(1);
+    ASSERT_EQUAL(channel_process(), KAA_ERR_NONE);
+
+    uint16_t timeout = 0;
+    ASSERT_EQUAL(kaa_udp_channel_get_max_timeout(&channel, &timeout), KAA_ERR_NONE);
+    ASSERT_EQUAL(timeout, KAA_UDP_CHANNEL_SESSION_TIMEOUT);
+}
+
+void test_udp_channel_retransmit(void **state)
+{
+    (void)state;
+
+    uint8_t datagram[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+    uint8_t resent[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+
+    establish_session();
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    ssize_t size = server_receive(datagram, sizeof(datagram), 1000);
+    ASSERT_TRUE(size > 0);
+    ASSERT_EQUAL(kaasync_message_id(datagram), 1);
+
+    uint16_t timeout = 0;
+    ASSERT_EQUAL(kaa_udp_channel_get_max_timeout(&channel, &timeout), KAA_ERR_NONE);
+    ASSERT_TRUE(timeout > 0 && timeout <= KAA_UDP_CHANNEL_ACK_TIMEOUT);
+
+    /* The lost request is sent again as is */
+    sleep(KAA_UDP_CHANNEL_ACK_TIMEOUT + 1);
+    ASSERT_EQUAL(kaa_udp_channel_process(&channel, false), KAA_ERR_NONE);
+    ASSERT_EQUAL(server_receive(resent, sizeof(resent), 1000), size);
+    ASSERT_EQUAL(memcmp(datagram, resent, (size_t)size), 0);
+
+    /* Both responses arrive, the duplicate is dropped */
+    server_send_kaasync(1);
+    server_send_kaasync(1);
+    ASSERT_EQUAL(channel_process(), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_udp_channel_get_max_timeout(&channel, &timeout), KAA_ERR_NONE);
+    ASSERT_EQUAL(timeout, KAA_UDP_CHANNEL_SESSION_TIMEOUT);
+}
+
+void test_udp_channel_disconnect(void **state)
+{
+    (void)state;
+
+    uint8_t datagram[KAA_UDP_CHANNEL_MAX_DATAGRAM_SIZE];
+
+    establish_session();
+    ASSERT_EQUAL(channel.sync_handler(channel.context, services, 1), KAA_ERR_NONE);
+    ASSERT_TRUE(server_receive(datagram, sizeof(datagram), 1000) > 0);
+    ASSERT_EQUAL(datagram[0] >> 4, KAATCP_MESSAGE_KAASYNC);
+
+    /* The server has lost the session, the request is repeated in a new one */
+    server_send(disconnect, sizeof(disconnect));
+    ASSERT_EQUAL(channel_process(), KAA_ERR_NONE);
+    ASSERT_TRUE(server_receive(datagram, sizeof(datagram), 1000) > 0);
+    ASSERT_EQUAL(datagram[0] >> 4, KAATCP_MESSAGE_CONNECT);
+}
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_init(&kaa_context);
+    if (error) {
+        return error;
+    }
+
+    server_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_size = sizeof(server_addr);
+    if (server_fd < 0 || bind(server_fd, (struct sockaddr *)&server_addr, sizeof(server_addr))
+            || getsockname(server_fd, (struct sockaddr *)&server_addr, &addr_size)) {
+        return -1;
+    }
+
+    error = kaa_udp_channel_create(&channel, kaa_context->logger, services, 1);
+    if (error) {
+        return error;
+    }
+
+    kaa_transport_context_t transport_context = { kaa_context };
+    channel.init(channel.context, &transport_context);
+
+    /* Public key, hostname and port, each preceded by its length */
+    uint8_t connection_data[4 + 4 + 4 + sizeof(TEST_HOSTNAME) - 1 + 4] = { 0 };
+    size_t position = 0;
+    uint32_t value = htonl(4);
+    memcpy(connection_data + position, &value, sizeof(value));
+    position += sizeof(value) + 4;
+    value = htonl(sizeof(TEST_HOSTNAME) - 1);
+    memcpy(connection_data + position, &value, sizeof(value));
+    position += sizeof(value);
+    memcpy(connection_data + position, TEST_HOSTNAME, sizeof(TEST_HOSTNAME) - 1);
+    position += sizeof(TEST_HOSTNAME) - 1;
+    value = htonl(ntohs(server_addr.sin_port));
+    memcpy(connection_data + position, &value, sizeof(value));
+
+    kaa_access_point_t access_point = { 1, sizeof(connection_data), (char *)connection_data };
+    return channel.set_access_point(channel.context, &access_point);
+}
+
+int test_deinit(void)
+{
+    channel.destroy(channel.context);
+    close(server_fd);
+    kaa_deinit(kaa_context);
+    return 0;
+}
+
+KAA_SUITE_MAIN(UdpChannel, test_init, test_deinit,
+        KAA_TEST_CASE(connect, test_udp_channel_connect)
+        KAA_TEST_CASE(retransmit, test_udp_channel_retransmit)
+        KAA_TEST_CASE(disconnect, test_udp_channel_disconnect)
+)
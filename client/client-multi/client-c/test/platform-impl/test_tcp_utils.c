@@ -0,0 +1,137 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "kaa_test.h"
+
+#include "platform/ext_tcp_utils.h"
+#include "platform/kaa_client_properties.h"
+
+#define TEST_RESOLVE_ATTEMPTS    50
+
+
+
+static ext_tcp_utils_function_return_state_t test_resolve(const char *hostname, kaa_sockaddr_storage_t *addr
+                                                        , kaa_socklen_t *addr_size)
+{
+    kaa_dns_resolve_info_t resolve_props;
+    resolve_props.hostname = (char *)hostname;
+    resolve_props.hostname_length = strlen(hostname);
+    resolve_props.port = 9888;
+
+    *addr_size = sizeof(kaa_sockaddr_storage_t);
+    return ext_tcp_utils_getaddrbyhost(NULL, &resolve_props, (kaa_sockaddr_t *)addr, addr_size);
+}
+
+void test_resolve_numeric_host(void **state)
+{
+    (void)state;
+
+    kaa_sockaddr_storage_t addr;
+    kaa_socklen_t addr_size;
+    ASSERT_EQUAL(test_resolve("127.0.0.1", &addr, &addr_size), RET_STATE_VALUE_READY);
+
+    struct sockaddr_in *addr_in = (struct sockaddr_in *)&addr;
+    ASSERT_EQUAL(addr_size, sizeof(struct sockaddr_in));
+    ASSERT_EQUAL(addr_in->sin_family, AF_INET);
+    ASSERT_EQUAL(addr_in->sin_port, KAA_HTONS(9888));
+    ASSERT_EQUAL(addr_in->sin_addr.s_addr, KAA_HTONL(INADDR_LOOPBACK));
+}
+
+void test_resolve_host_in_background(void **state)
+{
+    (void)state;
+
+    kaa_sockaddr_storage_t addr;
+    kaa_socklen_t addr_size;
+    ext_tcp_utils_function_return_state_t resolve_state = test_resolve("localhost", &addr, &addr_size);
+    ASSERT_EQUAL(resolve_state, RET_STATE_VALUE_IN_PROGRESS);
+
+    for (size_t i = 0; i < TEST_RESOLVE_ATTEMPTS && resolve_state == RET_STATE_VALUE_IN_PROGRESS; ++i) {
+        usleep(100000);
+        resolve_state = test_resolve("localhost", &addr, &addr_size);
+    }
+    ASSERT_EQUAL(resolve_state, RET_STATE_VALUE_READY);
+
+    kaa_sockaddr_storage_t cached_addr;
+    kaa_socklen_t cached_addr_size;
+    ASSERT_EQUAL(test_resolve("localhost", &cached_addr, &cached_addr_size), RET_STATE_VALUE_READY);
+    ASSERT_EQUAL(cached_addr_size, addr_size);
+    ASSERT_EQUAL(memcmp(&cached_addr, &addr, addr_size), 0);
+}
+
+static int test_get_int_option(kaa_fd_t fd, int level, int name)
+{
+    int value = 0;
+    socklen_t size = sizeof(value);
+    ASSERT_EQUAL(getsockopt(fd, level, name, &value, &size), 0);
+    return value;
+}
+
+void test_open_socket_with_options(void **state)
+{
+    (void)state;
+
+    kaa_sockaddr_storage_t addr;
+    kaa_socklen_t addr_size;
+    ASSERT_EQUAL(test_resolve("127.0.0.1", &addr, &addr_size), RET_STATE_VALUE_READY);
+
+    kaa_fd_t fd = -1;
+    ASSERT_EQUAL(ext_tcp_utils_open_tcp_socket(&fd, (kaa_sockaddr_t *)&addr, addr_size), KAA_ERR_NONE);
+    ASSERT_TRUE(test_get_int_option(fd, IPPROTO_TCP, TCP_NODELAY));
+    ASSERT_FALSE(test_get_int_option(fd, SOL_SOCKET, SO_KEEPALIVE));
+    ext_tcp_utils_tcp_socket_close(fd);
+
+    kaa_tcp_socket_options_t options = {
+        .no_delay = false,
+        .keepalive_idle = 60,
+    };
+    kaa_client_props_t props = {
+        .working_directory = "./",
+        .tcp_socket_options = &options,
+    };
+    ASSERT_EQUAL(kaa_client_props_set(&props), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(ext_tcp_utils_open_tcp_socket(&fd, (kaa_sockaddr_t *)&addr, addr_size), KAA_ERR_NONE);
+    ASSERT_FALSE(test_get_int_option(fd, IPPROTO_TCP, TCP_NODELAY));
+    ASSERT_TRUE(test_get_int_option(fd, SOL_SOCKET, SO_KEEPALIVE));
+    ext_tcp_utils_tcp_socket_close(fd);
+
+    kaa_client_props_set(NULL);
+}
+
+int test_init(void)
+{
+    return 0;
+}
+
+int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(TcpUtils, test_init, test_deinit,
+        KAA_TEST_CASE(resolve_numeric_host, test_resolve_numeric_host)
+        KAA_TEST_CASE(resolve_host_in_background, test_resolve_host_in_background)
+        KAA_TEST_CASE(open_socket_with_options, test_open_socket_with_options)
+)
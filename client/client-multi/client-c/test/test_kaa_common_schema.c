@@ -24,6 +24,7 @@
 #include "kaa_common_schema.h"
 #include "utilities/kaa_log.h"
 #include "utilities/kaa_mem.h"
+#include "utilities/kaa_scratch.h"
 #include "avro_src/encoding.h"
 #include "avro_src/avro/io.h"
 #include "kaa_common.h"
@@ -79,7 +80,9 @@ static void test_string_copy_create(void **state)
     kaa_string_t *kaa_str1 = kaa_string_copy_create(plain_test_str1);
     ASSERT_NOT_NULL(kaa_str1);
     ASSERT_NOT_NULL(kaa_str1->data);
-    ASSERT_EQUAL(kaa_str1->destroy, &kaa_data_destroy);
+    /* The copy is stored right after the value in a single allocation. */
+    ASSERT_NULL(kaa_str1->destroy);
+    ASSERT_EQUAL((uintptr_t)kaa_str1->data, (uintptr_t)(kaa_str1 + 1));
     ASSERT_EQUAL(strcmp(kaa_str1->data, plain_test_str1), 0);
 
     kaa_string_destroy(kaa_str1);
@@ -172,6 +175,7 @@ static void test_string_deserialize(void **state)
     kaa_string_t *kaa_str2 = kaa_string_deserialize(avro_reader);
     ASSERT_NOT_NULL(kaa_str2);
 
+    ASSERT_EQUAL((uintptr_t)kaa_str2->data, (uintptr_t)(kaa_str2 + 1));
     ASSERT_EQUAL(strcmp(kaa_str2->data, plain_test_str1), 0);
     ASSERT_EQUAL(strcmp(kaa_str2->data, kaa_str1->data), 0);
 
@@ -182,6 +186,43 @@ static void test_string_deserialize(void **state)
 }
 
 
+static void test_string_deserialize_borrowed(void **state)
+{
+    (void)state;
+
+    const char *plain_test_str1 = "test";
+    kaa_string_t *kaa_str1 = kaa_string_copy_create(plain_test_str1);
+    ASSERT_NOT_NULL(kaa_str1);
+
+    /* Two strings back to back: terminating the first one in place must
+     * not clobber the length prefix of the second one. */
+    size_t str_size = kaa_string_get_size(kaa_str1);
+    char buffer[2 * str_size];
+    avro_writer_t avro_writer = avro_writer_memory(buffer, sizeof(buffer));
+
+    kaa_string_serialize(avro_writer, kaa_str1);
+    kaa_string_serialize(avro_writer, kaa_str1);
+
+    avro_reader_t avro_reader = avro_reader_memory_borrowed(buffer, sizeof(buffer));
+    ASSERT_TRUE(avro_reader_is_borrowed(avro_reader));
+
+    kaa_string_t *kaa_str2 = kaa_string_deserialize(avro_reader);
+    ASSERT_NOT_NULL(kaa_str2);
+    kaa_string_t *kaa_str3 = kaa_string_deserialize(avro_reader);
+    ASSERT_NOT_NULL(kaa_str3);
+
+    ASSERT_TRUE(kaa_str2->data >= buffer && kaa_str2->data < buffer + sizeof(buffer));
+    ASSERT_TRUE(kaa_str3->data >= buffer && kaa_str3->data < buffer + sizeof(buffer));
+    ASSERT_NULL(kaa_str2->destroy);
+    ASSERT_EQUAL(strcmp(kaa_str2->data, plain_test_str1), 0);
+    ASSERT_EQUAL(strcmp(kaa_str3->data, plain_test_str1), 0);
+
+    kaa_string_destroy(kaa_str3);
+    kaa_string_destroy(kaa_str2);
+    avro_reader_free(avro_reader);
+    avro_writer_free(avro_writer);
+    kaa_string_destroy(kaa_str1);
+}
 
 static void test_bytes_move_create(void **state)
 {
@@ -238,7 +279,8 @@ static void test_bytes_copy_create(void **state)
 
     ASSERT_NOT_NULL(kaa_bytes1);
     ASSERT_EQUAL((size_t)kaa_bytes1->size, plain_bytes1_size);
-    ASSERT_EQUAL(kaa_bytes1->destroy, &kaa_data_destroy);
+    ASSERT_NULL(kaa_bytes1->destroy);
+    ASSERT_EQUAL((uintptr_t)kaa_bytes1->buffer, (uintptr_t)(kaa_bytes1 + 1));
     ASSERT_EQUAL(memcmp(kaa_bytes1->buffer, plain_bytes1, plain_bytes1_size), 0);
 
     kaa_bytes_destroy(kaa_bytes1);
@@ -333,6 +375,7 @@ static void test_bytes_deserialize(void **state)
     kaa_bytes_t *kaa_bytes2 = kaa_bytes_deserialize(avro_reader);
     ASSERT_NOT_NULL(kaa_bytes2);
 
+    ASSERT_EQUAL((uintptr_t)kaa_bytes2->buffer, (uintptr_t)(kaa_bytes2 + 1));
     ASSERT_EQUAL(memcmp(kaa_bytes2->buffer, plain_bytes1, plain_bytes1_size), 0);
     ASSERT_EQUAL(memcmp(kaa_bytes2->buffer, kaa_bytes1->buffer, plain_bytes1_size), 0);
 
@@ -343,6 +386,46 @@ static void test_bytes_deserialize(void **state)
 }
 
 
+static void test_bytes_deserialize_borrowed(void **state)
+{
+    (void)state;
+
+    const uint8_t plain_bytes1[] = { 0x0, 0x1, 0x2, 0x3, 0x4 };
+    size_t plain_bytes1_size = sizeof(plain_bytes1) / sizeof(char);
+
+    kaa_bytes_t *kaa_bytes1 = kaa_bytes_copy_create(plain_bytes1, plain_bytes1_size);
+    ASSERT_NOT_NULL(kaa_bytes1);
+
+    size_t expected_size = kaa_bytes_get_size(kaa_bytes1);
+    char buffer[expected_size];
+    avro_writer_t avro_writer = avro_writer_memory(buffer, expected_size);
+
+    kaa_bytes_serialize(avro_writer, kaa_bytes1);
+
+    avro_reader_t avro_reader = avro_reader_memory_borrowed(buffer, expected_size);
+
+    kaa_bytes_t *kaa_bytes2 = kaa_bytes_deserialize(avro_reader);
+    ASSERT_NOT_NULL(kaa_bytes2);
+
+    ASSERT_TRUE((char *)kaa_bytes2->buffer == buffer + expected_size - plain_bytes1_size);
+    ASSERT_NULL(kaa_bytes2->destroy);
+    ASSERT_EQUAL(kaa_bytes2->size, plain_bytes1_size);
+    ASSERT_EQUAL(memcmp(kaa_bytes2->buffer, plain_bytes1, plain_bytes1_size), 0);
+
+    kaa_bytes_destroy(kaa_bytes2);
+    avro_reader_free(avro_reader);
+
+    /* A truncated payload must not yield a pointer past its end. */
+    avro_reader = avro_reader_memory_borrowed(buffer, expected_size - 1);
+    char *data = NULL;
+    int64_t size = 0;
+    ASSERT_NOT_EQUAL(avro_binary_encoding.read_bytes(avro_reader, &data, &size), 0);
+    ASSERT_NULL(data);
+
+    avro_reader_free(avro_reader);
+    avro_writer_free(avro_writer);
+    kaa_bytes_destroy(kaa_bytes1);
+}
 
 static void test_fixed_move_create(void **state)
 {
@@ -399,7 +482,8 @@ static void test_fixed_copy_create(void **state)
 
     ASSERT_NOT_NULL(kaa_fixed1);
     ASSERT_EQUAL((size_t)kaa_fixed1->size, plain_fixed1_size);
-    ASSERT_EQUAL(kaa_fixed1->destroy, &kaa_data_destroy);
+    ASSERT_NULL(kaa_fixed1->destroy);
+    ASSERT_EQUAL((uintptr_t)kaa_fixed1->buffer, (uintptr_t)(kaa_fixed1 + 1));
     ASSERT_EQUAL(memcmp(kaa_fixed1->buffer, plain_fixed1, plain_fixed1_size), 0);
 
     kaa_fixed_destroy(kaa_fixed1);
@@ -494,6 +578,7 @@ static void test_fixed_deserialize(void **state)
     kaa_bytes_t *kaa_fixed2 = kaa_fixed_deserialize(avro_reader, &expected_size);
     ASSERT_NOT_NULL(kaa_fixed2);
 
+    ASSERT_EQUAL((uintptr_t)kaa_fixed2->buffer, (uintptr_t)(kaa_fixed2 + 1));
     ASSERT_EQUAL(memcmp(kaa_fixed2->buffer, plain_fixed1, plain_fixed1_size), 0);
     ASSERT_EQUAL(memcmp(kaa_fixed2->buffer, kaa_fixed1->buffer, plain_fixed1_size), 0);
 
@@ -504,6 +589,25 @@ static void test_fixed_deserialize(void **state)
 }
 
 
+static void test_fixed_deserialize_borrowed(void **state)
+{
+    (void)state;
+
+    const uint8_t plain_fixed1[] = { 0x0, 0x1, 0x2, 0x3, 0x4 };
+    size_t plain_fixed1_size = sizeof(plain_fixed1) / sizeof(char);
+
+    avro_reader_t avro_reader = avro_reader_memory_borrowed((char *)plain_fixed1, plain_fixed1_size);
+
+    kaa_bytes_t *kaa_fixed = kaa_fixed_deserialize(avro_reader, &plain_fixed1_size);
+    ASSERT_NOT_NULL(kaa_fixed);
+
+    ASSERT_TRUE(kaa_fixed->buffer == plain_fixed1);
+    ASSERT_NULL(kaa_fixed->destroy);
+    ASSERT_NULL(kaa_fixed_deserialize(avro_reader, &plain_fixed1_size));
+
+    kaa_fixed_destroy(kaa_fixed);
+    avro_reader_free(avro_reader);
+}
 
 static void test_boolean_get_size(void **state)
 {
@@ -1114,6 +1218,55 @@ static void test_array_deserialize_wo_ctx(void **state)
 
 
 
+static void test_array_deserialize_into_arena(void **state)
+{
+    (void)state;
+
+    const char *plain_test_str = "test";
+    kaa_string_t *kaa_str = kaa_string_copy_create(plain_test_str);
+    ASSERT_NOT_NULL(kaa_str);
+
+    kaa_list_t *avro_array1 = kaa_list_create();
+    kaa_list_push_back(avro_array1, kaa_str);
+    kaa_list_push_back(avro_array1, kaa_string_copy_create(plain_test_str));
+
+    size_t buffer_size = kaa_array_get_size(avro_array1, kaa_string_get_size);
+    char buffer[buffer_size];
+    avro_writer_t avro_writer = avro_writer_memory(buffer, buffer_size);
+    kaa_array_serialize(avro_writer, avro_array1, kaa_string_serialize);
+
+    kaa_scratch_t *arena = NULL;
+    ASSERT_EQUAL(kaa_scratch_create(&arena, 64), KAA_ERR_NONE);
+
+    avro_reader_t avro_reader = avro_reader_memory(buffer, buffer_size);
+    avro_reader_set_arena(avro_reader, arena);
+    ASSERT_EQUAL(avro_reader_get_arena(avro_reader), arena);
+
+    kaa_list_t *avro_array2 = kaa_array_deserialize_wo_ctx(avro_reader, (deserialize_wo_ctx_fn)kaa_string_deserialize);
+    ASSERT_NOT_NULL(avro_array2);
+    ASSERT_EQUAL(kaa_list_get_size(avro_array2), 2);
+
+    kaa_list_node_t *it = kaa_list_begin(avro_array2);
+    while (it) {
+        kaa_string_t *value = kaa_list_get_data(it);
+        ASSERT_NOT_NULL(value);
+        ASSERT_NULL(value->destroy);
+        ASSERT_EQUAL(strcmp(value->data, plain_test_str), 0);
+        it = kaa_list_next(it);
+    }
+
+    /* Arena lists don't own their nodes and elements, so this frees nothing. */
+    kaa_list_destroy(avro_array2, kaa_string_destroy);
+
+    avro_reader_set_arena(avro_reader, NULL);
+    avro_reader_free(avro_reader);
+    kaa_scratch_destroy(arena);
+    avro_writer_free(avro_writer);
+    kaa_list_destroy(avro_array1, kaa_string_destroy);
+}
+
+
+
 static void test_array_deserialize_w_ctx(void **state)
 {
     (void)state;
@@ -1181,18 +1334,21 @@ KAA_SUITE_MAIN(Log, test_init, test_deinit
        KAA_TEST_CASE(string_get_size, test_string_get_size)
        KAA_TEST_CASE(string_serialize, test_string_serialize)
        KAA_TEST_CASE(string_deserialize, test_string_deserialize)
+       KAA_TEST_CASE(string_deserialize_borrowed, test_string_deserialize_borrowed)
 
        KAA_TEST_CASE(bytes_move_create, test_bytes_move_create)
        KAA_TEST_CASE(bytes_copy_create, test_bytes_copy_create)
        KAA_TEST_CASE(bytes_get_size, test_bytes_get_size)
        KAA_TEST_CASE(bytes_serialize, test_bytes_serialize)
        KAA_TEST_CASE(bytes_deserialize, test_bytes_deserialize)
+       KAA_TEST_CASE(bytes_deserialize_borrowed, test_bytes_deserialize_borrowed)
 
        KAA_TEST_CASE(fixed_move_create, test_fixed_move_create)
        KAA_TEST_CASE(fixed_copy_create, test_fixed_copy_create)
        KAA_TEST_CASE(fixed_get_size, test_fixed_get_size)
        KAA_TEST_CASE(fixed_serialize, test_fixed_serialize)
        KAA_TEST_CASE(fixed_deserialize, test_fixed_deserialize)
+       KAA_TEST_CASE(fixed_deserialize_borrowed, test_fixed_deserialize_borrowed)
 
        KAA_TEST_CASE(boolean_get_size, test_boolean_get_size)
        KAA_TEST_CASE(boolean_serialize, test_boolean_serialize)
@@ -1228,4 +1384,5 @@ KAA_SUITE_MAIN(Log, test_init, test_deinit
        KAA_TEST_CASE(array_serialize, test_array_serialize)
        KAA_TEST_CASE(array_deserialize_wo_ctx, test_array_deserialize_wo_ctx)
        KAA_TEST_CASE(array_deserialize_w_ctx, test_array_deserialize_w_ctx)
+       KAA_TEST_CASE(array_deserialize_into_arena, test_array_deserialize_into_arena)
         )
@@ -16,15 +16,15 @@
 
 #include <kaa_extension.h>
 #include <kaa_extension_private.h>
+#include <kaa_context.h>
+#include <string.h>
 
 #include "kaa_test.h"
 
-#define FAKE_EXTENSION1_ID 13
-#define FAKE_EXTENSION2_ID 5
-#define FAKE_EXTENSION3_ID 17
-
 #define BAD_EXTENSION_ID 3
 
+static kaa_context_t kaa_context;
+
 static void test_kaa_extension_get_wrong_extension(void **state)
 {
     (void)state;
@@ -44,16 +44,16 @@ static void test_kaa_extension_get_ok(void **state)
 static void test_kaa_extension_get_context_wrong_extension(void **state)
 {
     (void)state;
-    assert_null(kaa_extension_get_context(0));
-    assert_null(kaa_extension_get_context(4));
-    assert_null(kaa_extension_get_context(100500));
+    assert_null(kaa_extension_get_context(&kaa_context, 0));
+    assert_null(kaa_extension_get_context(&kaa_context, 4));
+    assert_null(kaa_extension_get_context(&kaa_context, 100500));
 }
 
 static void test_kaa_extension_set_context_wrong_extension(void **state)
 {
     (void)state;
     int ctx;
-    assert_int_equal(KAA_ERR_NOT_FOUND, kaa_extension_set_context(0, &ctx));
+    assert_int_equal(KAA_ERR_NOT_FOUND, kaa_extension_set_context(&kaa_context, 0, &ctx));
 }
 
 static void test_kaa_extension_set_context_ok(void **state)
@@ -61,47 +61,64 @@ static void test_kaa_extension_set_context_ok(void **state)
     (void)state;
     int ctx1, ctx2;
 
-    assert_ptr_equal(NULL, kaa_extension_get_context(FAKE_EXTENSION1_ID));
-    assert_int_equal(KAA_ERR_NONE, kaa_extension_set_context(FAKE_EXTENSION1_ID, &ctx1));
-    assert_ptr_equal(&ctx1, kaa_extension_get_context(FAKE_EXTENSION1_ID));
+    assert_ptr_equal(NULL, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION1_ID));
+    assert_int_equal(KAA_ERR_NONE, kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &ctx1));
+    assert_ptr_equal(&ctx1, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION1_ID));
 
-    assert_ptr_equal(NULL, kaa_extension_get_context(FAKE_EXTENSION2_ID));
-    assert_int_equal(KAA_ERR_NONE, kaa_extension_set_context(FAKE_EXTENSION2_ID, &ctx2));
-    assert_ptr_equal(&ctx2, kaa_extension_get_context(FAKE_EXTENSION2_ID));
+    assert_ptr_equal(NULL, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION2_ID));
+    assert_int_equal(KAA_ERR_NONE, kaa_extension_set_context(&kaa_context, FAKE_EXTENSION2_ID, &ctx2));
+    assert_ptr_equal(&ctx2, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION2_ID));
 
-    assert_ptr_equal(&ctx1, kaa_extension_get_context(FAKE_EXTENSION1_ID));
+    assert_ptr_equal(&ctx1, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION1_ID));
 }
 
-static void test_kaa_extension_init_all_ok(void **state)
+static void test_kaa_extension_contexts_are_independent(void **state)
 {
     (void)state;
+    kaa_context_t other_kaa_context;
+    memset(&other_kaa_context, 0, sizeof(other_kaa_context));
+    int ctx1, ctx2;
+
+    assert_int_equal(KAA_ERR_NONE, kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &ctx1));
+    assert_null(kaa_extension_get_context(&other_kaa_context, FAKE_EXTENSION1_ID));
+
+    assert_int_equal(KAA_ERR_NONE,
+            kaa_extension_set_context(&other_kaa_context, FAKE_EXTENSION1_ID, &ctx2));
+    assert_ptr_equal(&ctx1, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION1_ID));
+    assert_ptr_equal(&ctx2, kaa_extension_get_context(&other_kaa_context, FAKE_EXTENSION1_ID));
 
-    int fake_kaa_context;
+    assert_null(kaa_extension_get_context(NULL, FAKE_EXTENSION1_ID));
+    assert_int_equal(KAA_ERR_BADPARAM, kaa_extension_init_all(NULL));
+}
+
+static void test_kaa_extension_init_all_ok(void **state)
+{
+    (void)state;
 
     int fake_context1;
     int fake_context2;
     int fake_context3;
 
     expect_string(called, name, "fake_init1");
-    expect_value(fake_init1, kaa_context, &fake_kaa_context);
+    expect_value(fake_init1, kaa_context, &kaa_context);
     will_return(fake_init1, &fake_context1);
     will_return(fake_init1, KAA_ERR_NONE);
 
     expect_string(called, name, "fake_init2");
-    expect_value(fake_init2, kaa_context, &fake_kaa_context);
+    expect_value(fake_init2, kaa_context, &kaa_context);
     will_return(fake_init2, &fake_context2);
     will_return(fake_init2, KAA_ERR_NONE);
 
     expect_string(called, name, "fake_init3");
-    expect_value(fake_init3, kaa_context, &fake_kaa_context);
+    expect_value(fake_init3, kaa_context, &kaa_context);
     will_return(fake_init3, &fake_context3);
     will_return(fake_init3, KAA_ERR_NONE);
 
-    assert_int_equal(KAA_ERR_NONE, kaa_extension_init_all((struct kaa_context_s *)&fake_kaa_context));
+    assert_int_equal(KAA_ERR_NONE, kaa_extension_init_all(&kaa_context));
 
-    assert_ptr_equal(&fake_context1, kaa_extension_get_context(FAKE_EXTENSION1_ID));
-    assert_ptr_equal(&fake_context2, kaa_extension_get_context(FAKE_EXTENSION2_ID));
-    assert_ptr_equal(&fake_context3, kaa_extension_get_context(FAKE_EXTENSION3_ID));
+    assert_ptr_equal(&fake_context1, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION1_ID));
+    assert_ptr_equal(&fake_context2, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION2_ID));
+    assert_ptr_equal(&fake_context3, kaa_extension_get_context(&kaa_context, FAKE_EXTENSION3_ID));
 }
 
 static void test_kaa_extension_init_all_fail(void **state)
@@ -136,7 +153,7 @@ static void test_kaa_extension_init_all_fail(void **state)
     expect_value(fake_deinit1, context, &fake_context1);
     will_return(fake_deinit1, KAA_ERR_NONE);
 
-    assert_int_equal(KAA_ERR_BADPARAM, kaa_extension_init_all(NULL));
+    assert_int_equal(KAA_ERR_BADPARAM, kaa_extension_init_all(&kaa_context));
 }
 
 static void test_kaa_extension_deinit_all_ok(void **state)
@@ -144,9 +161,9 @@ static void test_kaa_extension_deinit_all_ok(void **state)
     (void)state;
     int fake_context1, fake_context2, fake_context3;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, &fake_context1);
-    kaa_extension_set_context(FAKE_EXTENSION2_ID, &fake_context2);
-    kaa_extension_set_context(FAKE_EXTENSION3_ID, &fake_context3);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &fake_context1);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION2_ID, &fake_context2);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION3_ID, &fake_context3);
 
     expect_string(called, name, "fake_deinit3");
     expect_value(fake_deinit3, context, &fake_context3);
@@ -160,7 +177,7 @@ static void test_kaa_extension_deinit_all_ok(void **state)
     expect_value(fake_deinit1, context, &fake_context1);
     will_return(fake_deinit1, KAA_ERR_NONE);
 
-    assert_int_equal(KAA_ERR_NONE, kaa_extension_deinit_all());
+    assert_int_equal(KAA_ERR_NONE, kaa_extension_deinit_all(&kaa_context));
 }
 
 static void test_kaa_extension_deinit_all_fail(void **state)
@@ -168,9 +185,9 @@ static void test_kaa_extension_deinit_all_fail(void **state)
     (void)state;
     int fake_context1, fake_context2, fake_context3;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, &fake_context1);
-    kaa_extension_set_context(FAKE_EXTENSION2_ID, &fake_context2);
-    kaa_extension_set_context(FAKE_EXTENSION3_ID, &fake_context3);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &fake_context1);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION2_ID, &fake_context2);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION3_ID, &fake_context3);
 
     expect_string(called, name, "fake_deinit3");
     expect_value(fake_deinit3, context, &fake_context3);
@@ -184,7 +201,7 @@ static void test_kaa_extension_deinit_all_fail(void **state)
     expect_value(fake_deinit1, context, &fake_context1);
     will_return(fake_deinit1, KAA_ERR_NONE);
 
-    assert_int_equal(KAA_ERR_NOMEM, kaa_extension_deinit_all());
+    assert_int_equal(KAA_ERR_NOMEM, kaa_extension_deinit_all(&kaa_context));
 }
 
 static void test_kaa_extension_request_serialize_not_found(void **state)
@@ -192,7 +209,7 @@ static void test_kaa_extension_request_serialize_not_found(void **state)
     (void)state;
 
     assert_int_equal(KAA_ERR_NOT_FOUND,
-            kaa_extension_request_serialize(BAD_EXTENSION_ID, 0, NULL, NULL, NULL));
+            kaa_extension_request_serialize(&kaa_context, BAD_EXTENSION_ID, 0, NULL, NULL, NULL));
 }
 
 static void test_kaa_extension_request_serialize_ok(void **state)
@@ -203,7 +220,7 @@ static void test_kaa_extension_request_serialize_ok(void **state)
     size_t size = 0;
     bool sync_needed = true;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, &fake_context1);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &fake_context1);
     expect_string(called, name, "fake_request_serialize1");
     expect_value(fake_request_serialize1, request_id, 13);
     expect_value(fake_request_serialize1, context, &fake_context1);
@@ -212,11 +229,11 @@ static void test_kaa_extension_request_serialize_ok(void **state)
     will_return(fake_request_serialize1, true);
     will_return(fake_request_serialize1, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_request_serialize(FAKE_EXTENSION1_ID, 13, &buffer, &size, &sync_needed));
+            kaa_extension_request_serialize(&kaa_context, FAKE_EXTENSION1_ID, 13, &buffer, &size, &sync_needed));
     assert_int_equal(143, size);
     assert_true(sync_needed);
 
-    kaa_extension_set_context(FAKE_EXTENSION2_ID, &fake_context2);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION2_ID, &fake_context2);
     expect_string(called, name, "fake_request_serialize2");
     expect_value(fake_request_serialize2, request_id, 7);
     expect_value(fake_request_serialize2, context, &fake_context2);
@@ -225,11 +242,11 @@ static void test_kaa_extension_request_serialize_ok(void **state)
     will_return(fake_request_serialize2, false);
     will_return(fake_request_serialize2, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_request_serialize(FAKE_EXTENSION2_ID, 7, &buffer, &size, &sync_needed));
+            kaa_extension_request_serialize(&kaa_context, FAKE_EXTENSION2_ID, 7, &buffer, &size, &sync_needed));
     assert_int_equal(512, size);
     assert_false(sync_needed);
 
-    kaa_extension_set_context(FAKE_EXTENSION3_ID, &fake_context3);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION3_ID, &fake_context3);
     expect_string(called, name, "fake_request_serialize3");
     expect_value(fake_request_serialize3, request_id, 19);
     expect_value(fake_request_serialize3, context, &fake_context3);
@@ -238,7 +255,7 @@ static void test_kaa_extension_request_serialize_ok(void **state)
     will_return(fake_request_serialize3, true);
     will_return(fake_request_serialize3, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_request_serialize(FAKE_EXTENSION3_ID, 19, &buffer, &size, &sync_needed));
+            kaa_extension_request_serialize(&kaa_context, FAKE_EXTENSION3_ID, 19, &buffer, &size, &sync_needed));
     assert_int_equal(0, size);
     assert_true(sync_needed);
 }
@@ -250,7 +267,7 @@ static void test_kaa_extension_request_serialize_fail(void **state)
     bool sync_needed = true;
     uint8_t buffer;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, NULL);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, NULL);
     expect_string(called, name, "fake_request_serialize1");
     expect_value(fake_request_serialize1, request_id, 13);
     expect_value(fake_request_serialize1, buffer, &buffer);
@@ -259,7 +276,7 @@ static void test_kaa_extension_request_serialize_fail(void **state)
     will_return(fake_request_serialize1, true);
     will_return(fake_request_serialize1, KAA_ERR_NOMEM);
     assert_int_equal(KAA_ERR_NOMEM,
-            kaa_extension_request_serialize(FAKE_EXTENSION1_ID, 13, &buffer, &size, &sync_needed));
+            kaa_extension_request_serialize(&kaa_context, FAKE_EXTENSION1_ID, 13, &buffer, &size, &sync_needed));
 }
 
 static void test_kaa_extension_server_sync_not_found(void **state)
@@ -267,7 +284,7 @@ static void test_kaa_extension_server_sync_not_found(void **state)
     (void)state;
 
     assert_int_equal(KAA_ERR_NOT_FOUND,
-            kaa_extension_server_sync(BAD_EXTENSION_ID, 0, 0, NULL, 0));
+            kaa_extension_server_sync(&kaa_context, BAD_EXTENSION_ID, 0, 0, NULL, 0));
 }
 
 static void test_kaa_extension_server_sync_ok(void **state)
@@ -276,7 +293,7 @@ static void test_kaa_extension_server_sync_ok(void **state)
     int fake_context1, fake_context2, fake_context3;
     uint8_t buffer;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, &fake_context1);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, &fake_context1);
     expect_string(called, name, "fake_server_sync1");
     expect_value(fake_server_sync1, context, &fake_context1);
     expect_value(fake_server_sync1, request_id, 13);
@@ -285,9 +302,9 @@ static void test_kaa_extension_server_sync_ok(void **state)
     expect_value(fake_server_sync1, size, 113);
     will_return(fake_server_sync1, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_server_sync(FAKE_EXTENSION1_ID, 13, 2, &buffer, 113));
+            kaa_extension_server_sync(&kaa_context, FAKE_EXTENSION1_ID, 13, 2, &buffer, 113));
 
-    kaa_extension_set_context(FAKE_EXTENSION2_ID, &fake_context2);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION2_ID, &fake_context2);
     expect_string(called, name, "fake_server_sync2");
     expect_value(fake_server_sync2, context, &fake_context2);
     expect_value(fake_server_sync2, request_id, 7);
@@ -296,9 +313,9 @@ static void test_kaa_extension_server_sync_ok(void **state)
     expect_value(fake_server_sync2, size, 9);
     will_return(fake_server_sync2, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_server_sync(FAKE_EXTENSION2_ID, 7, 14, &buffer, 9));
+            kaa_extension_server_sync(&kaa_context, FAKE_EXTENSION2_ID, 7, 14, &buffer, 9));
 
-    kaa_extension_set_context(FAKE_EXTENSION3_ID, &fake_context3);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION3_ID, &fake_context3);
     expect_string(called, name, "fake_server_sync3");
     expect_value(fake_server_sync3, context, &fake_context3);
     expect_value(fake_server_sync3, request_id, 0);
@@ -307,14 +324,14 @@ static void test_kaa_extension_server_sync_ok(void **state)
     expect_value(fake_server_sync3, size, 0);
     will_return(fake_server_sync3, KAA_ERR_NONE);
     assert_int_equal(KAA_ERR_NONE,
-            kaa_extension_server_sync(FAKE_EXTENSION3_ID, 0, 0, NULL, 0));
+            kaa_extension_server_sync(&kaa_context, FAKE_EXTENSION3_ID, 0, 0, NULL, 0));
 }
 
 static void test_kaa_extension_server_sync_fail(void **state)
 {
     (void)state;
 
-    kaa_extension_set_context(FAKE_EXTENSION1_ID, NULL);
+    kaa_extension_set_context(&kaa_context, FAKE_EXTENSION1_ID, NULL);
     expect_string(called, name, "fake_server_sync1");
     expect_value(fake_server_sync1, context, NULL);
     expect_value(fake_server_sync1, request_id, 0);
@@ -323,7 +340,7 @@ static void test_kaa_extension_server_sync_fail(void **state)
     expect_value(fake_server_sync1, size, 0);
     will_return(fake_server_sync1, KAA_ERR_NOMEM);
     assert_int_equal(KAA_ERR_NOMEM,
-            kaa_extension_server_sync(FAKE_EXTENSION1_ID, 0, 0, NULL, 0));
+            kaa_extension_server_sync(&kaa_context, FAKE_EXTENSION1_ID, 0, 0, NULL, 0));
 }
 
 int main(void)
@@ -331,6 +348,7 @@ int main(void)
     // Note that this kaa_extensions is a different instance from
     // kaa_extensions used by kaa_extension.c.
     (void)kaa_extensions;
+    (void)kaa_extensions_by_id;
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_kaa_extension_get_wrong_extension),
@@ -340,6 +358,7 @@ int main(void)
 
         cmocka_unit_test(test_kaa_extension_set_context_wrong_extension),
         cmocka_unit_test(test_kaa_extension_set_context_ok),
+        cmocka_unit_test(test_kaa_extension_contexts_are_independent),
 
         cmocka_unit_test(test_kaa_extension_init_all_ok),
         cmocka_unit_test(test_kaa_extension_init_all_fail),
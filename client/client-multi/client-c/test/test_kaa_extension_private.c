@@ -61,10 +61,24 @@ static void test_kaa_extension_get_all_extensions(void **state)
 #endif
 }
 
+static void test_kaa_extension_get_matches_id(void **state)
+{
+    (void)state;
+    for (size_t id = 0; id < KAA_EXTENSION_ID_COUNT; ++id) {
+        const struct kaa_extension *extension = kaa_extension_get((kaa_extension_id)id);
+        if (extension) {
+            assert_int_equal(id, extension->id);
+        }
+    }
+
+    assert_null(kaa_extension_get(KAA_EXTENSION_ID_COUNT));
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_kaa_extension_get_all_extensions),
+        cmocka_unit_test(test_kaa_extension_get_matches_id),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -130,6 +144,10 @@ kaa_error_t kaa_extension_user_request_serialize(void *context, uint8_t *buffer,
         bool *need_resync)
 { (void)context; (void)buffer; (void)size; (void)need_resync; return KAA_ERR_NONE; }
 
+kaa_error_t kaa_extension_logging_request_serialize_spliced(void *context, uint32_t request_id,
+        uint8_t *buffer, size_t *size, kaa_platform_message_splices_t *splices, bool *need_resync)
+{ (void)context; (void)request_id; (void)buffer; (void)size; (void)splices; (void)need_resync; return KAA_ERR_NONE; }
+
 kaa_error_t kaa_extension_bootstrap_server_sync(void *context, uint32_t request_id,
         uint16_t extension_options, const uint8_t *buffer, size_t size)
 { (void)context; (void)request_id; (void)extension_options; (void)buffer; (void)size; return KAA_ERR_NONE; }
@@ -25,9 +25,11 @@
 #include "platform/ext_sha.h"
 #include "platform/ext_key_utils.h"
 #include "kaa_private.h"
+#include "kaa_defaults.h"
 
 kaa_digest test_ep_key_hash = {0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF, 0x10, 0x11, 0x12, 0x13, 0x14};
 kaa_digest test_profile_hash= {0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28};
+kaa_digest test_configuration_hash = {0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C};
 
 #define KAA_STATUS_STORAGE "status.conf"
 
@@ -78,6 +80,29 @@ void ext_status_store(const char *buffer, size_t buffer_size)
     }
 }
 
+void ext_status_append(const char *buffer, size_t buffer_size)
+{
+    FILE* status_file = fopen(KAA_STATUS_STORAGE, "ab");
+
+    if (status_file) {
+        fwrite(buffer, buffer_size, 1, status_file);
+        fclose(status_file);
+    }
+}
+
+static long get_status_storage_size(void)
+{
+    FILE* status_file = fopen(KAA_STATUS_STORAGE, "rb");
+    if (!status_file) {
+        return -1;
+    }
+
+    fseek(status_file, 0, SEEK_END);
+    long size = ftell(status_file);
+    fclose(status_file);
+    return size;
+}
+
 void ext_get_endpoint_public_key(const uint8_t **buffer, size_t *buffer_size)
 {
     *buffer = NULL;
@@ -110,6 +135,7 @@ void test_status_persistense(void **state)
     ASSERT_FALSE(status->is_attached);
     ASSERT_FALSE(status->is_registered);
     ASSERT_FALSE(status->is_updated);
+    ASSERT_FALSE(status->has_configuration_hash);
 
     ASSERT_EQUAL(kaa_status_set_endpoint_access_token(status, "my_token"), KAA_ERR_NONE);
     ASSERT_EQUAL(ext_copy_sha_hash(status->endpoint_public_key_hash, test_ep_key_hash), KAA_ERR_NONE);
@@ -118,6 +144,8 @@ void test_status_persistense(void **state)
     status->is_registered = true;
     status->is_updated = true;
     status->event_seq_n = 10;
+    ASSERT_EQUAL(ext_copy_sha_hash(status->configuration_hash, test_configuration_hash), KAA_ERR_NONE);
+    status->has_configuration_hash = true;
 
     err_code = kaa_status_save(status);
     ASSERT_EQUAL(err_code, KAA_ERR_NONE);
@@ -139,6 +167,110 @@ void test_status_persistense(void **state)
 
     ASSERT_EQUAL(memcmp(test_ep_key_hash, status->endpoint_public_key_hash, SHA_1_DIGEST_LENGTH), 0);
     ASSERT_EQUAL(memcmp(test_profile_hash, status->profile_hash, SHA_1_DIGEST_LENGTH), 0);
+    ASSERT_TRUE(status->has_configuration_hash);
+    ASSERT_EQUAL(memcmp(test_configuration_hash, status->configuration_hash, SHA_1_DIGEST_LENGTH), 0);
+
+    kaa_status_destroy(status);
+}
+
+void test_status_journal(void **state)
+{
+    (void)state;
+
+    kaa_status_t *status;
+    kaa_error_t err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+
+    ASSERT_EQUAL(kaa_status_set_endpoint_access_token(status, "my_token"), KAA_ERR_NONE);
+    status->is_attached = true;
+    status->is_registered = true;
+    ASSERT_EQUAL(ext_copy_sha_hash(status->configuration_hash, test_configuration_hash), KAA_ERR_NONE);
+    status->has_configuration_hash = true;
+
+    /* A new token makes the status rewritten as a whole */
+    ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+    long rewritten_size = get_status_storage_size();
+    ASSERT_TRUE(rewritten_size > 0);
+
+    /* Nothing changed, nothing written */
+    ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+    ASSERT_EQUAL(get_status_storage_size(), rewritten_size);
+
+    /* Several changes are appended at once */
+    ASSERT_EQUAL(kaa_status_set_attached(status, false), KAA_ERR_NONE);
+    status->event_seq_n = 11;
+    status->dirty_fields |= KAA_STATUS_EVENT_SEQ_N;
+    ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+    ASSERT_EQUAL(get_status_storage_size(),
+            rewritten_size + (long)(2 * sizeof(uint8_t) + sizeof(bool) + sizeof(uint32_t)));
+
+    kaa_status_destroy(status);
+    err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+
+    ASSERT_FALSE(status->is_attached);
+    ASSERT_TRUE(status->is_registered);
+    ASSERT_EQUAL(status->event_seq_n, 11);
+    ASSERT_TRUE(status->has_configuration_hash);
+    ASSERT_EQUAL(memcmp(test_configuration_hash, status->configuration_hash, SHA_1_DIGEST_LENGTH), 0);
+
+    /* The appended records are compacted once there are too many of them */
+    status->has_update = false;
+    long journaled_size = get_status_storage_size();
+    long size = journaled_size;
+    while (size >= journaled_size) {
+        ++status->event_seq_n;
+        status->dirty_fields |= KAA_STATUS_EVENT_SEQ_N;
+        ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+        size = get_status_storage_size();
+        ASSERT_TRUE(size <= rewritten_size + KAA_STATUS_JOURNAL_MAX_SIZE);
+    }
+    ASSERT_EQUAL(size, rewritten_size);
+    uint32_t event_seq_n = status->event_seq_n;
+
+    kaa_status_destroy(status);
+    err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+    ASSERT_EQUAL(status->event_seq_n, event_seq_n);
+    ASSERT_FALSE(status->is_attached);
+
+    kaa_status_destroy(status);
+}
+
+void test_status_operations_access_points(void **state)
+{
+    (void)state;
+
+    const uint8_t access_points[] = { 0x00, 0x01, 0x0A, 0x0B, 0x0C, 0x0D };
+
+    kaa_status_t *status;
+    kaa_error_t err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+
+    ASSERT_NULL(status->operations_access_points);
+    ASSERT_EQUAL(kaa_status_set_endpoint_access_token(status, "my_token"), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_status_set_operations_access_points(status, access_points, sizeof(access_points), 100), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+
+    kaa_status_destroy(status);
+    err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+
+    ASSERT_NOT_NULL(status->operations_access_points);
+    ASSERT_EQUAL(status->operations_access_points_size, sizeof(access_points));
+    ASSERT_EQUAL(memcmp(access_points, status->operations_access_points, sizeof(access_points)), 0);
+    ASSERT_EQUAL(status->operations_access_points_expiry, 100);
+
+    /* Cleared access points are appended as an empty record */
+    ASSERT_EQUAL(kaa_status_set_operations_access_points(status, NULL, 0, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_status_save(status), KAA_ERR_NONE);
+
+    kaa_status_destroy(status);
+    err_code = kaa_status_create(&status);
+    assert_int_equal(KAA_ERR_NONE, err_code);
+
+    ASSERT_NULL(status->operations_access_points);
+    ASSERT_EQUAL(status->operations_access_points_size, 0);
 
     kaa_status_destroy(status);
 }
@@ -159,4 +291,6 @@ int test_deinit(void)
 KAA_SUITE_MAIN(Status, status_test_init, test_deinit,
         KAA_TEST_CASE(create, test_create_status)
         KAA_TEST_CASE(persistence, test_status_persistense)
+        KAA_TEST_CASE(journal, test_status_journal)
+        KAA_TEST_CASE(operations_access_points, test_status_operations_access_points)
 )
@@ -80,6 +80,115 @@ void test_empty_log_collector_extension_count(void **state)
     KAA_FREE(buffer);
 }
 
+void test_stream_server_sync(void **state)
+{
+    kaa_context_t *kaa_context = *state;
+
+    uint8_t server_sync[] = {
+        /* Message header: protocol id, version, extension count */
+        0x02, 0x31, 0xad, 0x61, 0x00, 0x01, 0x00, 0x02,
+        /* Meta data extension: request id 5, no resync */
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+        0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00,
+        /* Unsupported extension, skipped */
+        0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+        0xaa, 0xbb, 0xcc,
+    };
+
+    kaa_server_sync_stream_t stream;
+    kaa_platform_protocol_server_sync_stream_init(&stream);
+
+    /* Every byte on its own is the worst case for collecting headers. */
+    for (size_t i = 0; i < sizeof(server_sync); ++i) {
+        kaa_error_t error_code = kaa_platform_protocol_stream_server_sync(kaa_context->platform_protocol,
+                &stream, server_sync + i, 1);
+        assert_int_equal(KAA_ERR_NONE, error_code);
+    }
+    assert_int_equal(5, stream.request_id);
+    assert_false(stream.in_extension);
+
+    kaa_error_t error_code = kaa_platform_protocol_finish_server_sync(kaa_context->platform_protocol, &stream);
+    assert_int_equal(KAA_ERR_NONE, error_code);
+
+    /* A sync cut in the middle of an extension is reported on finish. */
+    error_code = kaa_platform_protocol_stream_server_sync(kaa_context->platform_protocol,
+            &stream, server_sync, sizeof(server_sync) - 1);
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_true(stream.in_extension);
+
+    error_code = kaa_platform_protocol_finish_server_sync(kaa_context->platform_protocol, &stream);
+    assert_int_equal(KAA_ERR_READ_FAILED, error_code);
+    assert_ptr_equal(stream.extension, NULL);
+
+    /* Errors are sticky until the sync is finished. */
+    server_sync[0] = 0xff;
+    error_code = kaa_platform_protocol_stream_server_sync(kaa_context->platform_protocol,
+            &stream, server_sync, KAA_PROTOCOL_MESSAGE_HEADER_SIZE);
+    assert_int_equal(KAA_ERR_BAD_PROTOCOL_ID, error_code);
+    error_code = kaa_platform_protocol_stream_server_sync(kaa_context->platform_protocol,
+            &stream, server_sync + KAA_PROTOCOL_MESSAGE_HEADER_SIZE, 1);
+    assert_int_equal(KAA_ERR_BAD_PROTOCOL_ID, error_code);
+    error_code = kaa_platform_protocol_finish_server_sync(kaa_context->platform_protocol, &stream);
+    assert_int_equal(KAA_ERR_BAD_PROTOCOL_ID, error_code);
+}
+
+void test_sliced_server_sync(void **state)
+{
+    kaa_context_t *kaa_context = *state;
+    kaa_platform_protocol_t *protocol = kaa_context->platform_protocol;
+
+    const uint8_t server_sync[] = {
+        /* Message header: protocol id, version, extension count */
+        0x02, 0x31, 0xad, 0x61, 0x00, 0x01, 0x00, 0x03,
+        /* Meta data extension: request id 5, no resync */
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+        0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00,
+        /* Unsupported extensions, skipped */
+        0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+        0xaa, 0xbb, 0xcc,
+        0x00, 0x7e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        0xdd,
+    };
+
+    kaa_platform_protocol_set_server_sync_budget(protocol, 0, 1);
+
+    /* An extension per call */
+    kaa_error_t error_code = kaa_platform_protocol_process_server_sync(protocol, server_sync, sizeof(server_sync));
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_true(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    error_code = kaa_platform_protocol_process_pending_server_sync(protocol);
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_true(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    error_code = kaa_platform_protocol_process_pending_server_sync(protocol);
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_false(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    /* The rest of a sync is processed before the next one, which is sliced in turn */
+    error_code = kaa_platform_protocol_process_server_sync(protocol, server_sync, sizeof(server_sync));
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    error_code = kaa_platform_protocol_process_server_sync(protocol, server_sync, sizeof(server_sync));
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_true(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    /* and before a client sync */
+    kaa_extension_id services[] = { KAA_EXTENSION_PROFILE };
+    uint8_t *buffer = NULL;
+    size_t buffer_size = 0;
+    kaa_platform_protocol_alloc_serialize_client_sync(protocol, services, 1, &buffer, &buffer_size);
+    KAA_FREE(buffer);
+    assert_false(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    /* A sync fitting into the budget isn't copied */
+    kaa_platform_protocol_set_server_sync_budget(protocol, 0, 3);
+    error_code = kaa_platform_protocol_process_server_sync(protocol, server_sync, sizeof(server_sync));
+    assert_int_equal(KAA_ERR_NONE, error_code);
+    assert_false(kaa_platform_protocol_has_pending_server_sync(protocol));
+
+    kaa_platform_protocol_set_server_sync_budget(protocol, 0, 0);
+}
+
 int test_init(void **state)
 {
     return kaa_init((kaa_context_t **)state);
@@ -95,6 +204,8 @@ int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_empty_log_collector_extension_count),
+        cmocka_unit_test(test_stream_server_sync),
+        cmocka_unit_test(test_sliced_server_sync),
     };
 
     return cmocka_run_group_tests(tests, test_init, test_deinit);
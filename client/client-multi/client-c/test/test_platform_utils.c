@@ -196,6 +196,46 @@ void test_write_extension_header(void **state)
     kaa_platform_message_writer_destroy(writer);
 }
 
+void test_put_get_unaligned(void **state)
+{
+    (void)state;
+    uint8_t buffer[1 + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint64_t) + 2];
+    kaa_platform_message_writer_t *writer = NULL;
+
+    const uint8_t serialized[sizeof(buffer)] = {0x7f, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+            0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x00, 0x00};
+
+    kaa_error_t error_code = kaa_platform_message_writer_create(&writer, buffer, sizeof(buffer));
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_TRUE(kaa_platform_message_writer_reserve(writer, sizeof(buffer)));
+    ASSERT_FALSE(kaa_platform_message_writer_reserve(writer, sizeof(buffer) + 1));
+
+    /* Every multi-byte field starts at an odd offset */
+    kaa_platform_message_put_uint8(writer, 0x7f);
+    kaa_platform_message_put_uint16(writer, 0x0102);
+    kaa_platform_message_put_uint32(writer, 0x03040506);
+    kaa_platform_message_put_uint64(writer, 0x0708090a0b0c0d0eULL);
+    kaa_platform_message_put_padding(writer, 2);
+
+    ASSERT_FALSE(kaa_platform_message_writer_reserve(writer, 1));
+    ASSERT_EQUAL(memcmp(buffer, serialized, sizeof(buffer)), 0);
+
+    kaa_platform_message_writer_destroy(writer);
+
+    kaa_platform_message_reader_t *reader = NULL;
+    error_code = kaa_platform_message_reader_create(&reader, serialized + 1, sizeof(serialized) - 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(kaa_platform_message_get_uint16(reader), 0x0102);
+    ASSERT_EQUAL(kaa_platform_message_get_uint32(reader), 0x03040506);
+    ASSERT_TRUE(kaa_platform_message_get_uint64(reader) == 0x0708090a0b0c0d0eULL);
+    ASSERT_TRUE(kaa_platform_message_is_buffer_large_enough(reader, 2));
+    ASSERT_FALSE(kaa_platform_message_is_buffer_large_enough(reader, 3));
+
+    kaa_platform_message_reader_destroy(reader);
+}
+
 void test_create_destroy_reader(void **state)
 {
     (void)state;
@@ -364,6 +404,7 @@ KAA_SUITE_MAIN(PlatformUtils, NULL, NULL
         KAA_TEST_CASE(buffer_overflow_write, test_write_buffer_overflow)
         KAA_TEST_CASE(write_protocol_message_header, test_write_protocol_message_header)
         KAA_TEST_CASE(write_extension_header, test_write_extension_header)
+        KAA_TEST_CASE(put_get_unaligned, test_put_get_unaligned)
         KAA_TEST_CASE(create_destroy_writer, test_create_destroy_reader)
         KAA_TEST_CASE(raw_read, test_read)
         KAA_TEST_CASE(raw_read_aligned, test_read_aligned)
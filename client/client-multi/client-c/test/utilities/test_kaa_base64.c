@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_base64.h"
+
+/* Long enough for every SIMD block size and a tail after it. */
+#define DATA_SIZE 300
+
+static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ * The reference encoder, bit by bit.
+ */
+static size_t encode_reference(const uint8_t *data, size_t data_length, char *encoded_data)
+{
+    size_t length = 0;
+    for (size_t bit = 0; bit < data_length * 8; bit += 6) {
+        uint8_t sextet = 0;
+        for (size_t i = bit; i < bit + 6; ++i) {
+            uint8_t value = i < data_length * 8 ? (data[i / 8] >> (7 - i % 8)) & 1 : 0;
+            sextet = (sextet << 1) | value;
+        }
+        encoded_data[length++] = alphabet[sextet];
+    }
+
+    while (length % 4) {
+        encoded_data[length++] = '=';
+    }
+
+    return length;
+}
+
+void test_rfc4648_vectors(void **state)
+{
+    (void)state;
+
+    const char *data[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+    const char *encoded[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+
+    for (size_t i = 0; i < sizeof(data) / sizeof(data[0]); ++i) {
+        char buffer[16];
+        size_t length = sizeof(buffer);
+
+        ASSERT_EQUAL(kaa_base64_encode(data[i], strlen(data[i]), buffer, &length), KAA_ERR_NONE);
+        ASSERT_EQUAL(length, strlen(encoded[i]));
+        ASSERT_EQUAL(length, KAA_BASE64_ENCODED_LENGTH(strlen(data[i])));
+        ASSERT_EQUAL(memcmp(buffer, encoded[i], length), 0);
+
+        length = sizeof(buffer);
+        ASSERT_EQUAL(kaa_base64_decode(encoded[i], strlen(encoded[i]), buffer, &length), KAA_ERR_NONE);
+        ASSERT_EQUAL(length, strlen(data[i]));
+        ASSERT_EQUAL(memcmp(buffer, data[i], length), 0);
+    }
+}
+
+void test_round_trip(void **state)
+{
+    (void)state;
+
+    uint8_t data[DATA_SIZE];
+    for (size_t i = 0; i < DATA_SIZE; ++i) {
+        data[i] = (uint8_t)(i * 167 + 13);
+    }
+
+    for (size_t data_length = 0; data_length <= DATA_SIZE; ++data_length) {
+        char expected[KAA_BASE64_ENCODED_LENGTH(DATA_SIZE)];
+        char encoded[KAA_BASE64_ENCODED_LENGTH(DATA_SIZE)];
+        char decoded[DATA_SIZE];
+
+        size_t expected_length = encode_reference(data, data_length, expected);
+        size_t encoded_length = sizeof(encoded);
+        ASSERT_EQUAL(kaa_base64_encode((const char *)data, data_length, encoded, &encoded_length), KAA_ERR_NONE);
+        ASSERT_EQUAL(encoded_length, expected_length);
+        ASSERT_EQUAL(memcmp(encoded, expected, encoded_length), 0);
+
+        /* Decoding fits into the exact length of the data. */
+        size_t decoded_length = data_length;
+        ASSERT_EQUAL(kaa_base64_decode(encoded, encoded_length, decoded, &decoded_length), KAA_ERR_NONE);
+        ASSERT_EQUAL(decoded_length, data_length);
+        ASSERT_EQUAL(memcmp(decoded, data, data_length), 0);
+    }
+}
+
+void test_invalid_characters(void **state)
+{
+    (void)state;
+
+    uint8_t data[DATA_SIZE];
+    for (size_t i = 0; i < DATA_SIZE; ++i) {
+        data[i] = (uint8_t)(i * 31);
+    }
+
+    char encoded[KAA_BASE64_ENCODED_LENGTH(DATA_SIZE)];
+    size_t encoded_length = sizeof(encoded);
+    ASSERT_EQUAL(kaa_base64_encode((const char *)data, DATA_SIZE, encoded, &encoded_length), KAA_ERR_NONE);
+
+    /* An invalid character is detected whichever block it is in, the last one would be padding. */
+    const char invalid[] = { '-', '=', '\n', '\0', (char)0x80, (char)0xC1 };
+    for (size_t position = 0; position < encoded_length - 1; position += 7) {
+        for (size_t i = 0; i < sizeof(invalid); ++i) {
+            char corrupted[sizeof(encoded)];
+            memcpy(corrupted, encoded, encoded_length);
+            corrupted[position] = invalid[i];
+
+            char decoded[DATA_SIZE];
+            size_t decoded_length = sizeof(decoded);
+            ASSERT_EQUAL(kaa_base64_decode(corrupted, encoded_length, decoded, &decoded_length), KAA_ERR_BADPARAM);
+        }
+    }
+}
+
+void test_bad_params(void **state)
+{
+    (void)state;
+
+    char buffer[8];
+    size_t length = sizeof(buffer);
+
+    ASSERT_EQUAL(kaa_base64_encode(NULL, 1, buffer, &length), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_encode("f", 1, NULL, &length), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_encode("f", 1, buffer, NULL), KAA_ERR_BADPARAM);
+
+    ASSERT_EQUAL(kaa_base64_decode(NULL, 4, buffer, &length), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_decode("Zg==", 4, NULL, &length), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_decode("Zg==", 4, buffer, NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_decode("Zg=", 3, buffer, &length), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_base64_decode("====", 4, buffer, &length), KAA_ERR_BADPARAM);
+
+    length = 3;
+    ASSERT_EQUAL(kaa_base64_encode("foo", 3, buffer, &length), KAA_ERR_BUFFER_IS_NOT_ENOUGH);
+
+    length = 2;
+    ASSERT_EQUAL(kaa_base64_decode("Zm9v", 4, buffer, &length), KAA_ERR_BUFFER_IS_NOT_ENOUGH);
+}
+
+int test_init(void)
+{
+    return 0;
+}
+
+int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(Base64, test_init, test_deinit,
+        KAA_TEST_CASE(rfc4648_vectors, test_rfc4648_vectors)
+        KAA_TEST_CASE(round_trip, test_round_trip)
+        KAA_TEST_CASE(invalid_characters, test_invalid_characters)
+        KAA_TEST_CASE(bad_params, test_bad_params)
+)
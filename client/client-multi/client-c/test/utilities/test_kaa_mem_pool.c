@@ -0,0 +1,189 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_mem_pool.h"
+
+static bool in_range(const void *ptr, const void *begin, size_t size)
+{
+    return (const char *)ptr >= (const char *)begin && (const char *)ptr < (const char *)begin + size;
+}
+
+void test_slab_classes(void **state)
+{
+    (void)state;
+
+    kaa_mem_pool_stats_t stats;
+    void *small = kaa_mem_pool_malloc(10);
+    void *medium = kaa_mem_pool_malloc(100);
+    void *zeroed = kaa_mem_pool_calloc(4, 8);
+
+    ASSERT_NOT_NULL(small);
+    ASSERT_NOT_NULL(medium);
+    ASSERT_NOT_NULL(zeroed);
+    for (size_t i = 0; i < 32; ++i) {
+        ASSERT_EQUAL(((uint8_t *)zeroed)[i], 0);
+    }
+
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[0].block_size, 16);
+    ASSERT_EQUAL(stats.classes[0].used, 1);
+    ASSERT_EQUAL(stats.classes[1].used, 1);
+    ASSERT_EQUAL(stats.classes[3].used, 1);
+    ASSERT_EQUAL(stats.heap_allocations, 0);
+
+    kaa_mem_pool_free(small);
+    kaa_mem_pool_free(medium);
+    kaa_mem_pool_free(zeroed);
+
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[0].used, 0);
+    ASSERT_EQUAL(stats.classes[0].high_water, 1);
+    ASSERT_EQUAL(stats.classes[3].used, 0);
+}
+
+void test_pool_exhaustion(void **state)
+{
+    (void)state;
+
+    void *blocks[KAA_MEMORY_POOL_BLOCKS_256 + 1];
+    kaa_mem_pool_stats_t stats;
+
+    for (size_t i = 0; i < KAA_MEMORY_POOL_BLOCKS_256 + 1; ++i) {
+        blocks[i] = kaa_mem_pool_malloc(KAA_MEMORY_POOL_MAX_BLOCK_SIZE);
+        ASSERT_NOT_NULL(blocks[i]);
+    }
+
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[4].used, KAA_MEMORY_POOL_BLOCKS_256);
+    ASSERT_EQUAL(stats.classes[4].overflows, 1);
+    ASSERT_EQUAL(stats.heap_allocations, 1);
+
+    void *large = kaa_mem_pool_malloc(KAA_MEMORY_POOL_MAX_BLOCK_SIZE + 1);
+    ASSERT_NOT_NULL(large);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.heap_allocations, 2);
+
+    kaa_mem_pool_free(large);
+    for (size_t i = 0; i < KAA_MEMORY_POOL_BLOCKS_256 + 1; ++i) {
+        kaa_mem_pool_free(blocks[i]);
+    }
+
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[4].used, 0);
+    ASSERT_EQUAL(stats.classes[4].high_water, KAA_MEMORY_POOL_BLOCKS_256);
+    ASSERT_EQUAL(stats.heap_allocations, 0);
+}
+
+void test_scratch_arena(void **state)
+{
+    (void)state;
+
+    kaa_mem_pool_stats_t stats;
+    void *first = kaa_mem_pool_scratch_malloc(100);
+    void *second = kaa_mem_pool_scratch_malloc(200);
+
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    ASSERT_TRUE((uintptr_t)second > (uintptr_t)first);
+
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_TRUE(stats.arena_used >= 300);
+
+    kaa_mem_pool_free(first);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_TRUE(stats.arena_used >= 300);
+
+    kaa_mem_pool_free(second);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.arena_used, 0);
+    ASSERT_TRUE(stats.arena_high_water >= 300);
+
+    /* The arena is rewound, so the next buffer reuses its start. */
+    void *third = kaa_mem_pool_scratch_malloc(100);
+    ASSERT_EQUAL((uintptr_t)third, (uintptr_t)first);
+
+    void *oversized = kaa_mem_pool_scratch_malloc(KAA_MEMORY_ARENA_SIZE);
+    ASSERT_NOT_NULL(oversized);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.arena_overflows, 1);
+    ASSERT_FALSE(in_range(oversized, first, stats.arena_size));
+
+    kaa_mem_pool_free(oversized);
+    kaa_mem_pool_free(third);
+}
+
+void test_realloc(void **state)
+{
+    (void)state;
+
+    kaa_mem_pool_stats_t stats;
+    char *ptr = kaa_mem_pool_malloc(10);
+    ASSERT_NOT_NULL(ptr);
+    memcpy(ptr, "pool", 5);
+
+    /* Fits in the same block. */
+    ASSERT_EQUAL((uintptr_t)kaa_mem_pool_realloc(ptr, 16), (uintptr_t)ptr);
+
+    ptr = kaa_mem_pool_realloc(ptr, 200);
+    ASSERT_NOT_NULL(ptr);
+    ASSERT_EQUAL(strcmp(ptr, "pool"), 0);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[0].used, 0);
+    ASSERT_EQUAL(stats.classes[4].used, 1);
+
+    ptr = kaa_mem_pool_realloc(ptr, 1000);
+    ASSERT_NOT_NULL(ptr);
+    ASSERT_EQUAL(strcmp(ptr, "pool"), 0);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.classes[4].used, 0);
+    ASSERT_EQUAL(stats.heap_allocations, 1);
+
+    char *scratch = kaa_mem_pool_scratch_malloc(8);
+    memcpy(scratch, "arena", 6);
+    scratch = kaa_mem_pool_realloc(scratch, 64);
+    ASSERT_NOT_NULL(scratch);
+    ASSERT_EQUAL(strcmp(scratch, "arena"), 0);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.arena_used, 0);
+
+    kaa_mem_pool_free(scratch);
+    kaa_mem_pool_free(ptr);
+    kaa_mem_pool_get_stats(&stats);
+    ASSERT_EQUAL(stats.heap_allocations, 0);
+}
+
+int test_init(void)
+{
+    return 0;
+}
+
+int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(MemPool, test_init, test_deinit,
+        KAA_TEST_CASE(slab_classes, test_slab_classes)
+        KAA_TEST_CASE(pool_exhaustion, test_pool_exhaustion)
+        KAA_TEST_CASE(scratch_arena, test_scratch_arena)
+        KAA_TEST_CASE(realloc, test_realloc)
+)
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+#include "kaa_defaults.h"
+
+static kaa_logger_t *logger = NULL;
+
+static const kaa_trace_memory_site_stats_t *find_site(const kaa_trace_memory_stats_t *stats, int line)
+{
+    for (size_t i = 0; i < stats->site_count; ++i) {
+        if (stats->sites[i].line == line && !strcmp(stats->sites[i].file, __FILE__)) {
+            return &stats->sites[i];
+        }
+    }
+    return NULL;
+}
+
+void test_live_and_peak_bytes(void **state)
+{
+    (void)state;
+
+    kaa_trace_memory_stats_t before;
+    kaa_trace_memory_stats_t stats;
+    kaa_trace_memory_allocs_get_stats(&before);
+
+    char *buffer = KAA_MALLOC(100); int malloc_line = __LINE__;
+    uint32_t *zeroed = KAA_CALLOC(4, sizeof(uint32_t));
+    ASSERT_NOT_NULL(buffer);
+    ASSERT_NOT_NULL(zeroed);
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_EQUAL(zeroed[i], 0);
+    }
+
+    kaa_trace_memory_allocs_get_stats(&stats);
+    ASSERT_EQUAL(stats.live_bytes, before.live_bytes + 100 + 4 * sizeof(uint32_t));
+    ASSERT_EQUAL(stats.allocations, before.allocations + 2);
+
+    const kaa_trace_memory_site_stats_t *site = find_site(&stats, malloc_line);
+    ASSERT_NOT_NULL(site);
+    ASSERT_EQUAL(site->allocations, 1);
+    ASSERT_EQUAL(site->live_bytes, 100);
+
+    memcpy(buffer, "trace", 6);
+    buffer = KAA_REALLOC(buffer, 200); int realloc_line = __LINE__;
+    ASSERT_NOT_NULL(buffer);
+    ASSERT_EQUAL(strcmp(buffer, "trace"), 0);
+
+    kaa_trace_memory_allocs_get_stats(&stats);
+    ASSERT_EQUAL(stats.live_bytes, before.live_bytes + 200 + 4 * sizeof(uint32_t));
+    ASSERT_EQUAL(find_site(&stats, malloc_line)->live_bytes, 0);
+    ASSERT_EQUAL(find_site(&stats, realloc_line)->live_bytes, 200);
+
+    kaa_trace_memory_allocs_dump(logger);
+
+    KAA_FREE(buffer);
+    KAA_FREE(zeroed);
+    KAA_FREE(NULL);
+
+    kaa_trace_memory_allocs_get_stats(&stats);
+    ASSERT_EQUAL(stats.live_bytes, before.live_bytes);
+    //The resize counts as a free and an allocation
+    ASSERT_EQUAL(stats.allocations, before.allocations + 3);
+    ASSERT_EQUAL(stats.frees, before.frees + 3);
+    ASSERT_TRUE(stats.peak_bytes >= before.live_bytes + 200 + 4 * sizeof(uint32_t));
+    ASSERT_EQUAL(find_site(&stats, realloc_line)->peak_bytes, 200);
+
+    kaa_trace_memory_allocs_reset_peak();
+    kaa_trace_memory_allocs_get_stats(&stats);
+    ASSERT_EQUAL(stats.peak_bytes, stats.live_bytes);
+    ASSERT_EQUAL(find_site(&stats, realloc_line)->peak_bytes, 0);
+}
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger)
+        return error;
+
+    return 0;
+}
+
+int test_deinit(void)
+{
+    kaa_log_destroy(logger);
+    return 0;
+}
+
+KAA_SUITE_MAIN(MemTrace, test_init, test_deinit,
+        KAA_TEST_CASE(live_and_peak_bytes, test_live_and_peak_bytes)
+)
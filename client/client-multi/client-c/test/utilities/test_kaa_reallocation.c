@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "kaa_test.h"
 
@@ -60,6 +61,87 @@ void test_reallocation(void **state)
     kaa_buffer_destroy(buffer_ptr);
 }
 
+void test_wrap_around(void **state)
+{
+    (void)state;
+
+    kaa_buffer_t *buffer_ptr;
+    kaa_error_t error_code;
+    char *span;
+    size_t span_size;
+
+    error_code = kaa_buffer_create_buffer(&buffer_ptr, BUFFER_SIZE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    // The capacity is rounded up to the power of two
+    error_code = kaa_buffer_get_size(buffer_ptr, &span_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(span_size, 16);
+
+    kaa_buffer_allocate_space(buffer_ptr, &span, &span_size);
+    memcpy(span, "0123456789ab", 12);
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 12), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_buffer_free_allocated_space(buffer_ptr, 10), KAA_ERR_NONE);
+
+    // Only the tail of the storage is contiguous
+    error_code = kaa_buffer_allocate_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(span_size, 4);
+    memcpy(span, "cdef", 4);
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 4), KAA_ERR_NONE);
+
+    kaa_buffer_allocate_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 10);
+    memcpy(span, "gh", 2);
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 2), KAA_ERR_NONE);
+
+    kaa_buffer_get_locked_space(buffer_ptr, &span_size);
+    ASSERT_EQUAL(span_size, 8);
+
+    // The locked bytes are read in two spans
+    kaa_buffer_get_unprocessed_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 6);
+    ASSERT_EQUAL(memcmp(span, "abcdef", 6), 0);
+    ASSERT_EQUAL(kaa_buffer_free_allocated_space(buffer_ptr, 3), KAA_ERR_NONE);
+
+    kaa_buffer_get_unprocessed_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 3);
+    ASSERT_EQUAL(kaa_buffer_free_allocated_space(buffer_ptr, 3), KAA_ERR_NONE);
+
+    kaa_buffer_get_unprocessed_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 2);
+    ASSERT_EQUAL(memcmp(span, "gh", 2), 0);
+
+    // Growing moves the wrapped bytes to the beginning of the storage
+    ASSERT_EQUAL(kaa_buffer_free_allocated_space(buffer_ptr, 1), KAA_ERR_NONE);
+    kaa_buffer_allocate_space(buffer_ptr, &span, &span_size);
+    memcpy(span, "ijklmnopqrstuv", 14);
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 14), KAA_ERR_NONE);
+    kaa_buffer_allocate_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 1);
+    *span = 'w';
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_buffer_lock_space(buffer_ptr, 1), KAA_ERR_BUFFER_IS_NOT_ENOUGH);
+
+    error_code = kaa_buffer_reallocate_space(buffer_ptr, BUFFER_SIZE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    kaa_buffer_get_size(buffer_ptr, &span_size);
+    ASSERT_EQUAL(span_size, 32);
+
+    kaa_buffer_get_unprocessed_space(buffer_ptr, &span, &span_size);
+    ASSERT_EQUAL(span_size, 16);
+    ASSERT_EQUAL(memcmp(span, "hijklmnopqrstuvw", 16), 0);
+
+    // The emptied buffer is rewound
+    ASSERT_EQUAL(kaa_buffer_free_allocated_space(buffer_ptr, 16), KAA_ERR_NONE);
+    kaa_buffer_get_free_space(buffer_ptr, &span_size);
+    ASSERT_EQUAL(span_size, 32);
+
+    ASSERT_EQUAL(kaa_buffer_reallocate_space(buffer_ptr, KAA_BUFFER_MAX_SIZE + 1), KAA_ERR_BUFFER_IS_NOT_ENOUGH);
+
+    kaa_buffer_destroy(buffer_ptr);
+}
+
 int test_init(void)
 {
     kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -74,4 +156,5 @@ int test_deinit(void)
 
 KAA_SUITE_MAIN(Context, test_init, test_deinit
         , KAA_TEST_CASE(reallocation, test_reallocation)
+        KAA_TEST_CASE(wrap_around, test_wrap_around)
 )
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_test.h"
+
+#include "utilities/kaa_scratch.h"
+
+#define CHUNK_SIZE 64
+
+void test_bump_allocation(void **state)
+{
+    (void)state;
+
+    kaa_scratch_t *scratch;
+    ASSERT_EQUAL(kaa_scratch_create(&scratch, CHUNK_SIZE), KAA_ERR_NONE);
+
+    char *first = kaa_scratch_alloc(scratch, 10);
+    char *second = kaa_scratch_alloc(scratch, 10);
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    ASSERT_TRUE(second >= first + 10);
+    ASSERT_EQUAL((uintptr_t)second % sizeof(void *), 0);
+
+    memset(first, 'a', 10);
+    memset(second, 'b', 10);
+    ASSERT_EQUAL(first[9], 'a');
+
+    kaa_scratch_reset(scratch);
+    ASSERT_EQUAL((uintptr_t)kaa_scratch_alloc(scratch, 10), (uintptr_t)first);
+
+    kaa_scratch_destroy(scratch);
+}
+
+void test_chunk_overflow(void **state)
+{
+    (void)state;
+
+    kaa_scratch_t *scratch;
+    ASSERT_EQUAL(kaa_scratch_create(&scratch, CHUNK_SIZE), KAA_ERR_NONE);
+
+    char *small = kaa_scratch_alloc(scratch, CHUNK_SIZE / 2);
+    char *large = kaa_scratch_alloc(scratch, CHUNK_SIZE * 4);
+    char *next = kaa_scratch_alloc(scratch, CHUNK_SIZE / 2);
+    ASSERT_NOT_NULL(small);
+    ASSERT_NOT_NULL(large);
+    ASSERT_NOT_NULL(next);
+
+    memset(small, 's', CHUNK_SIZE / 2);
+    memset(large, 'l', CHUNK_SIZE * 4);
+    memset(next, 'n', CHUNK_SIZE / 2);
+    ASSERT_EQUAL(small[CHUNK_SIZE / 2 - 1], 's');
+    ASSERT_EQUAL(large[CHUNK_SIZE * 4 - 1], 'l');
+
+    /* After the reset the whole round fits into a single chunk. */
+    kaa_scratch_reset(scratch);
+    char *merged = kaa_scratch_alloc(scratch, CHUNK_SIZE / 2);
+    char *merged_large = kaa_scratch_alloc(scratch, CHUNK_SIZE * 4);
+    char *merged_next = kaa_scratch_alloc(scratch, CHUNK_SIZE / 2);
+    ASSERT_EQUAL((uintptr_t)merged_large, (uintptr_t)(merged + CHUNK_SIZE / 2));
+    ASSERT_EQUAL((uintptr_t)merged_next, (uintptr_t)(merged_large + CHUNK_SIZE * 4));
+
+    kaa_scratch_destroy(scratch);
+}
+
+void test_retained_size_limit(void **state)
+{
+    (void)state;
+
+    kaa_scratch_t *scratch;
+    ASSERT_EQUAL(kaa_scratch_create(&scratch, CHUNK_SIZE), KAA_ERR_NONE);
+
+    ASSERT_NOT_NULL(kaa_scratch_alloc(scratch, CHUNK_SIZE));
+    ASSERT_NOT_NULL(kaa_scratch_alloc(scratch, KAA_SCRATCH_MAX_RETAINED_SIZE * 2));
+    kaa_scratch_reset(scratch);
+
+    /* The oversized round is not retained: a request above the limit needs a new chunk. */
+    char *first = kaa_scratch_alloc(scratch, KAA_SCRATCH_MAX_RETAINED_SIZE);
+    char *second = kaa_scratch_alloc(scratch, CHUNK_SIZE);
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    ASSERT_TRUE(second != first + KAA_SCRATCH_MAX_RETAINED_SIZE);
+
+    kaa_scratch_destroy(scratch);
+}
+
+void test_bad_params(void **state)
+{
+    (void)state;
+
+    kaa_scratch_t *scratch = NULL;
+    ASSERT_EQUAL(kaa_scratch_create(NULL, CHUNK_SIZE), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_scratch_create(&scratch, 0), KAA_ERR_BADPARAM);
+    ASSERT_NULL(kaa_scratch_alloc(NULL, CHUNK_SIZE));
+    kaa_scratch_reset(NULL);
+    kaa_scratch_destroy(NULL);
+}
+
+int test_init(void)
+{
+    return 0;
+}
+
+int test_deinit(void)
+{
+    return 0;
+}
+
+KAA_SUITE_MAIN(Scratch, test_init, test_deinit,
+        KAA_TEST_CASE(bump_allocation, test_bump_allocation)
+        KAA_TEST_CASE(chunk_overflow, test_chunk_overflow)
+        KAA_TEST_CASE(retained_size_limit, test_retained_size_limit)
+        KAA_TEST_CASE(bad_params, test_bad_params)
+)
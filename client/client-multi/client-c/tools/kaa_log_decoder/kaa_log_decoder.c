@@ -0,0 +1,641 @@
+/*
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Decodes the binary log dumps printed by kaa_log_dump() of the SDK built with KAA_BINARY_LOGGING.
+ *
+ * Usage: kaa_log_decoder DUMP_FILE SOURCE_FILE...
+ *
+ * The format strings are taken from the KAA_LOG_* calls of the given sources, so pass all
+ * SDK and application sources the firmware is built from, e.g. $(find src -name '*.c').
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KAA_BINARY_LOG_VERSION              1
+#define KAA_BINARY_LOG_DUMP_BEGIN           "KLOG-DUMP"
+#define KAA_BINARY_LOG_DUMP_PREFIX          "KLOG "
+#define KAA_BINARY_LOG_HEADER_SIZE          11
+#define KAA_BINARY_LOG_RECORD_HEADER_SIZE   17
+
+#define KAA_FNV1A_OFFSET_BASIS              2166136261u
+#define KAA_FNV1A_PRIME                     16777619u
+
+static const char *log_level_name[] = { "NONE", "FATAL", "ERROR", "WARNING", "INFO", "DEBUG", "TRACE" };
+
+typedef struct {
+    uint32_t    id;
+    char        *file;
+    char        *format;
+} log_format_t;
+
+static log_format_t *formats = NULL;
+static size_t format_count = 0;
+static size_t format_capacity = 0;
+
+/* The sizes of the argument types on the device, in the dump header order */
+typedef enum {
+    SIZE_INT = 0,
+    SIZE_LONG,
+    SIZE_LONG_LONG,
+    SIZE_SIZE_T,
+    SIZE_INTMAX_T,
+    SIZE_PTRDIFF_T,
+    SIZE_POINTER,
+    SIZE_DOUBLE,
+    SIZE_COUNT
+} type_size_index_t;
+
+typedef struct {
+    bool        little_endian;
+    uint8_t     sizes[SIZE_COUNT];
+    const uint8_t *current;
+    const uint8_t *end;
+} record_reader_t;
+
+
+
+static uint32_t hash(uint32_t value, const char *str, size_t length)
+{
+    while (length--) {
+        value ^= (uint8_t)*str++;
+        value *= KAA_FNV1A_PRIME;
+    }
+    return value;
+}
+
+static void *xmalloc(size_t size)
+{
+    void *ptr = malloc(size);
+    if (!ptr) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static char *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *buffer = xmalloc(file_size + 1);
+    if (file_size && fread(buffer, file_size, 1, file) != 1) {
+        free(buffer);
+        fclose(file);
+        return NULL;
+    }
+    buffer[file_size] = '\0';
+    *size = file_size;
+    fclose(file);
+    return buffer;
+}
+
+
+
+/*
+ * Source scanning.
+ */
+
+static const char *skip_space(const char *p, const char *end)
+{
+    while (p < end) {
+        if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+            ++p;
+        } else if (p + 1 < end && p[0] == '/' && p[1] == '/') {
+            while (p < end && *p != '\n') {
+                ++p;
+            }
+        } else if (p + 1 < end && p[0] == '/' && p[1] == '*') {
+            p += 2;
+            while (p + 1 < end && !(p[0] == '*' && p[1] == '/')) {
+                ++p;
+            }
+            p += 2;
+        } else {
+            break;
+        }
+    }
+    return p < end ? p : end;
+}
+
+/* Skips a string or character literal, p points to the opening quote */
+static const char *skip_literal(const char *p, const char *end)
+{
+    char quote = *p++;
+    while (p < end && *p != quote) {
+        if (*p == '\\') {
+            ++p;
+        }
+        ++p;
+    }
+    return p < end ? p + 1 : end;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/*
+ * Parses adjacent string literals into one unescaped string.
+ * Returns NULL if there is no string literal at p.
+ */
+static char *parse_string(const char *p, const char *end)
+{
+    p = skip_space(p, end);
+    if (p >= end || *p != '"') {
+        return NULL;
+    }
+
+    char *result = xmalloc(end - p + 1);
+    size_t length = 0;
+
+    while (p < end && *p == '"') {
+        ++p;
+        while (p < end && *p != '"') {
+            if (*p != '\\' || p + 1 >= end) {
+                result[length++] = *p++;
+                continue;
+            }
+            ++p;
+            switch (*p) {
+            case 'n': result[length++] = '\n'; ++p; break;
+            case 't': result[length++] = '\t'; ++p; break;
+            case 'r': result[length++] = '\r'; ++p; break;
+            case 'a': result[length++] = '\a'; ++p; break;
+            case 'b': result[length++] = '\b'; ++p; break;
+            case 'f': result[length++] = '\f'; ++p; break;
+            case 'v': result[length++] = '\v'; ++p; break;
+            case 'x': {
+                int value = 0;
+                ++p;
+                while (p < end && hex_value(*p) >= 0) {
+                    value = value * 16 + hex_value(*p++);
+                }
+                result[length++] = (char)value;
+                break;
+            }
+            default:
+                if (*p >= '0' && *p <= '7') {
+                    int value = 0;
+                    for (int i = 0; i < 3 && p < end && *p >= '0' && *p <= '7'; ++i) {
+                        value = value * 8 + (*p++ - '0');
+                    }
+                    result[length++] = (char)value;
+                } else {
+                    result[length++] = *p++;
+                }
+                break;
+            }
+        }
+        p = skip_space(p + 1, end);
+    }
+
+    result[length] = '\0';
+    return result;
+}
+
+static void add_format(const char *file, char *format)
+{
+    if (format_count == format_capacity) {
+        format_capacity = format_capacity ? 2 * format_capacity : 256;
+        formats = realloc(formats, format_capacity * sizeof(log_format_t));
+        if (!formats) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    log_format_t *entry = &formats[format_count++];
+    entry->file = strdup(file);
+    entry->format = format;
+    entry->id = hash(hash(KAA_FNV1A_OFFSET_BASIS, file, strlen(file)), format, strlen(format));
+}
+
+/*
+ * Collects the format strings of KAA_LOG_<LEVEL>(logger, error, "format", ...) calls.
+ */
+static void scan_source(const char *path)
+{
+    size_t size = 0;
+    char *source = read_file(path, &size);
+    if (!source) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        return;
+    }
+
+    const char *file = strrchr(path, '/');
+    file = file ? file + 1 : path;
+
+    const char *end = source + size;
+    const char *p = source;
+    while ((p = strstr(p, "KAA_LOG_"))) {
+        p += strlen("KAA_LOG_");
+        while (p < end && ((*p >= 'A' && *p <= 'Z') || *p == '_')) {
+            ++p;
+        }
+        p = skip_space(p, end);
+        if (p >= end || *p != '(') {
+            continue;
+        }
+        ++p;
+
+        // Skip the logger and the error code
+        int depth = 0;
+        int commas = 0;
+        while (p < end && commas < 2 && depth >= 0) {
+            switch (*p) {
+            case '"':
+            case '\'':
+                p = skip_literal(p, end);
+                continue;
+            case '(': case '[': case '{':
+                ++depth;
+                break;
+            case ')': case ']': case '}':
+                --depth;
+                break;
+            case ',':
+                if (!depth) {
+                    ++commas;
+                }
+                break;
+            }
+            ++p;
+        }
+        if (commas < 2) {
+            continue;
+        }
+
+        char *format = parse_string(p, end);
+        if (format) {
+            add_format(file, format);
+        }
+    }
+
+    free(source);
+}
+
+static const log_format_t *find_format(uint32_t id)
+{
+    for (size_t i = 0; i < format_count; ++i) {
+        if (formats[i].id == id) {
+            return &formats[i];
+        }
+    }
+    return NULL;
+}
+
+
+
+/*
+ * Record decoding.
+ */
+
+static bool read_bytes(record_reader_t *reader, size_t size, uint64_t *value)
+{
+    if ((size_t)(reader->end - reader->current) < size || size > sizeof(*value)) {
+        return false;
+    }
+
+    *value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        size_t index = reader->little_endian ? size - 1 - i : i;
+        *value = (*value << 8) | reader->current[index];
+    }
+    reader->current += size;
+    return true;
+}
+
+static bool read_signed(record_reader_t *reader, size_t size, long long *value)
+{
+    uint64_t raw = 0;
+    if (!read_bytes(reader, size, &raw)) {
+        return false;
+    }
+    if (size < sizeof(raw) && (raw >> (8 * size - 1)) & 1) {
+        raw |= ~(uint64_t)0 << (8 * size);
+    }
+    *value = (long long)raw;
+    return true;
+}
+
+static bool read_double(record_reader_t *reader, double *value)
+{
+    uint64_t raw = 0;
+    if (reader->sizes[SIZE_DOUBLE] != sizeof(double) || !read_bytes(reader, sizeof(double), &raw)) {
+        return false;
+    }
+    memcpy(value, &raw, sizeof(*value));
+    return true;
+}
+
+static size_t get_integer_size(const record_reader_t *reader, char length)
+{
+    switch (length) {
+    case 'l': return reader->sizes[SIZE_LONG];
+    case 'q': return reader->sizes[SIZE_LONG_LONG];
+    case 'z': return reader->sizes[SIZE_SIZE_T];
+    case 'j': return reader->sizes[SIZE_INTMAX_T];
+    case 't': return reader->sizes[SIZE_PTRDIFF_T];
+    default: return reader->sizes[SIZE_INT];
+    }
+}
+
+/*
+ * Prints the message, taking the arguments from the record the same way kaa_log_write() stored them.
+ * Returns false if the record ends before all arguments are read.
+ */
+static bool print_message(const char *format, record_reader_t *reader)
+{
+    while (*format) {
+        if (*format != '%') {
+            putchar(*format++);
+            continue;
+        }
+
+        char spec[64];
+        size_t spec_length = 0;
+        spec[spec_length++] = *format++;
+
+        while (*format && strchr("-+ #0", *format) && spec_length < 8) {
+            spec[spec_length++] = *format++;
+        }
+
+        long long number = 0;
+        if (*format == '*') {
+            if (!read_signed(reader, reader->sizes[SIZE_INT], &number)) {
+                return false;
+            }
+            spec_length += snprintf(spec + spec_length, sizeof(spec) - spec_length, "%d", (int)number);
+            ++format;
+        }
+        while (*format >= '0' && *format <= '9' && spec_length < 24) {
+            spec[spec_length++] = *format++;
+        }
+
+        if (*format == '.') {
+            spec[spec_length++] = *format++;
+            if (*format == '*') {
+                if (!read_signed(reader, reader->sizes[SIZE_INT], &number)) {
+                    return false;
+                }
+                spec_length += snprintf(spec + spec_length, sizeof(spec) - spec_length, "%d", (int)(number < 0 ? 0 : number));
+                ++format;
+            }
+            while (*format >= '0' && *format <= '9' && spec_length < 48) {
+                spec[spec_length++] = *format++;
+            }
+        }
+
+        char length = 0;
+        switch (*format) {
+        case 'h':
+            while (*format == 'h') {
+                ++format;
+            }
+            break;
+        case 'l':
+            length = *format++;
+            if (*format == 'l') {
+                length = 'q';
+                ++format;
+            }
+            break;
+        case 'z': case 'j': case 't': case 'L':
+            length = *format++;
+            break;
+        }
+
+        char conversion = *format;
+        if (!conversion) {
+            break;
+        }
+        ++format;
+
+        switch (conversion) {
+        case 'd': case 'i': {
+            long long value = 0;
+            if (!read_signed(reader, get_integer_size(reader, length), &value)) {
+                return false;
+            }
+            spec[spec_length++] = 'l';
+            spec[spec_length++] = 'l';
+            spec[spec_length++] = conversion;
+            spec[spec_length] = '\0';
+            printf(spec, value);
+            break;
+        }
+        case 'u': case 'o': case 'x': case 'X': {
+            uint64_t value = 0;
+            if (!read_bytes(reader, get_integer_size(reader, length), &value)) {
+                return false;
+            }
+            spec[spec_length++] = 'l';
+            spec[spec_length++] = 'l';
+            spec[spec_length++] = conversion;
+            spec[spec_length] = '\0';
+            printf(spec, (unsigned long long)value);
+            break;
+        }
+        case 'c': {
+            long long value = 0;
+            if (!read_signed(reader, reader->sizes[SIZE_INT], &value)) {
+                return false;
+            }
+            spec[spec_length++] = 'c';
+            spec[spec_length] = '\0';
+            printf(spec, (int)value);
+            break;
+        }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double value = 0;
+            if (!read_double(reader, &value)) {
+                return false;
+            }
+            spec[spec_length++] = conversion;
+            spec[spec_length] = '\0';
+            printf(spec, value);
+            break;
+        }
+        case 'p': {
+            uint64_t value = 0;
+            if (!read_bytes(reader, reader->sizes[SIZE_POINTER], &value)) {
+                return false;
+            }
+            printf("0x%llx", (unsigned long long)value);
+            break;
+        }
+        case 's': {
+            uint64_t str_length = 0;
+            if (!read_bytes(reader, 1, &str_length) || (uint64_t)(reader->end - reader->current) < str_length) {
+                return false;
+            }
+            char str[256];
+            memcpy(str, reader->current, str_length);
+            str[str_length] = '\0';
+            reader->current += str_length;
+            spec[spec_length++] = 's';
+            spec[spec_length] = '\0';
+            printf(spec, str);
+            break;
+        }
+        case 'n':
+            break;
+        default:
+            putchar(conversion);
+            break;
+        }
+    }
+    return true;
+}
+
+static void decode_dump(const uint8_t *dump, size_t size)
+{
+    if (size < KAA_BINARY_LOG_HEADER_SIZE || dump[0] != KAA_BINARY_LOG_VERSION) {
+        fprintf(stderr, "Unsupported binary log dump\n");
+        return;
+    }
+
+    record_reader_t reader;
+    reader.little_endian = (dump[1] == 0x02 && dump[2] == 0x01);
+    memcpy(reader.sizes, dump + 3, SIZE_COUNT);
+
+    const uint8_t *record = dump + KAA_BINARY_LOG_HEADER_SIZE;
+    const uint8_t *end = dump + size;
+
+    while (record < end) {
+        reader.current = record;
+        reader.end = end;
+
+        uint64_t record_size = 0, level = 0, time = 0, id = 0, line = 0;
+        long long error_code = 0;
+        if (!read_bytes(&reader, 2, &record_size) || record_size < KAA_BINARY_LOG_RECORD_HEADER_SIZE
+                || record_size > (uint64_t)(end - record)) {
+            fprintf(stderr, "Corrupted binary log record\n");
+            return;
+        }
+        reader.end = record + record_size;
+
+        read_bytes(&reader, 1, &level);
+        read_bytes(&reader, 4, &time);
+        read_bytes(&reader, 4, &id);
+        read_bytes(&reader, 2, &line);
+        read_signed(&reader, 4, &error_code);
+
+        time_t t = (time_t)time;
+        struct tm *tp = gmtime(&t);
+        const log_format_t *format = find_format((uint32_t)id);
+
+        printf("%04d/%02d/%02d %d:%02d:%02d [%s] [%s:%d] (%d) - "
+             , 1900 + tp->tm_year, tp->tm_mon + 1, tp->tm_mday, tp->tm_hour, tp->tm_min, tp->tm_sec
+             , level < sizeof(log_level_name) / sizeof(log_level_name[0]) ? log_level_name[level] : "?"
+             , format ? format->file : "?", (int)line, (int)error_code);
+
+        if (!format) {
+            printf("<unknown format 0x%08X>", (unsigned)id);
+        } else if (!print_message(format->format, &reader)) {
+            printf("<truncated>");
+        }
+        putchar('\n');
+
+        record += record_size;
+    }
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s DUMP_FILE SOURCE_FILE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        scan_source(argv[i]);
+    }
+
+    FILE *dump_file = fopen(argv[1], "r");
+    if (!dump_file) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *dump = NULL;
+    size_t dump_size = 0;
+    size_t dump_capacity = 0;
+    bool in_dump = false;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), dump_file)) {
+        if (strstr(line, KAA_BINARY_LOG_DUMP_BEGIN)) {
+            if (in_dump) {
+                decode_dump(dump, dump_size);
+            }
+            in_dump = true;
+            dump_size = 0;
+            continue;
+        }
+
+        const char *hex = strstr(line, KAA_BINARY_LOG_DUMP_PREFIX);
+        if (!in_dump || !hex) {
+            continue;
+        }
+
+        hex += strlen(KAA_BINARY_LOG_DUMP_PREFIX);
+        while (hex_value(hex[0]) >= 0 && hex_value(hex[1]) >= 0) {
+            if (dump_size == dump_capacity) {
+                dump_capacity = dump_capacity ? 2 * dump_capacity : 4096;
+                dump = realloc(dump, dump_capacity);
+                if (!dump) {
+                    fprintf(stderr, "Out of memory\n");
+                    return EXIT_FAILURE;
+                }
+            }
+            dump[dump_size++] = (uint8_t)(hex_value(hex[0]) * 16 + hex_value(hex[1]));
+            hex += 2;
+        }
+    }
+
+    if (in_dump) {
+        decode_dump(dump, dump_size);
+    }
+
+    fclose(dump_file);
+    free(dump);
+    for (size_t i = 0; i < format_count; ++i) {
+        free(formats[i].file);
+        free(formats[i].format);
+    }
+    free(formats);
+    return EXIT_SUCCESS;
+}
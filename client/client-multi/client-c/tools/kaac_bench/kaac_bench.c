@@ -0,0 +1,271 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the steps of a sync round trip against canned server responses:
+ * serializing a client sync, framing and parsing it as KAATCP, processing the
+ * server sync, adding a log record and encrypting the payload.
+ *
+ * Only stdio is used for the report, so the same binary runs on a host and,
+ * linked with newlib's rdimon specs, on a Cortex-M board through semihosting.
+ * Allocations are counted when the SDK is built with WITH_MEMORY_TRACING.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "kaa.h"
+#include "kaa_context.h"
+#include "kaa_platform_protocol.h"
+#include "kaa_private.h"
+#include "kaa_logging.h"
+#include "kaa_logging_private.h"
+#include "kaa_protocols/kaa_tcp/kaatcp_parser.h"
+#include "platform/ext_log_upload_strategy.h"
+#include "platform/ext_encryption_utils.h"
+#include "platform-impl/common/ext_log_upload_strategies.h"
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#ifndef KAAC_BENCH_ITERATIONS
+#define KAAC_BENCH_ITERATIONS   1000
+#endif
+
+#define KAAC_BENCH_BUFFER_SIZE  1024
+
+/*
+ * Cycle counter. Cortex-M3 and above count in the DWT unit, x86 hosts read
+ * the TSC. Anything else falls back to clock() ticks; define KAAC_BENCH_CYCLES
+ * to supply a counter of your own.
+ */
+#if defined(KAAC_BENCH_CYCLES)
+typedef uint32_t bench_cycles_t;
+static void bench_cycles_init(void) { }
+static bench_cycles_t bench_cycles(void) { return KAAC_BENCH_CYCLES(); }
+#define BENCH_CYCLES_UNIT "cycles"
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define BENCH_DEMCR         (*(volatile uint32_t *)0xE000EDFC)
+#define BENCH_DWT_CTRL      (*(volatile uint32_t *)0xE0001000)
+#define BENCH_DWT_CYCCNT    (*(volatile uint32_t *)0xE0001004)
+typedef uint32_t bench_cycles_t;
+static void bench_cycles_init(void)
+{
+    BENCH_DEMCR |= 1u << 24;    /* TRCENA */
+    BENCH_DWT_CYCCNT = 0;
+    BENCH_DWT_CTRL |= 1u;       /* CYCCNTENA */
+}
+static bench_cycles_t bench_cycles(void) { return BENCH_DWT_CYCCNT; }
+#define BENCH_CYCLES_UNIT "cycles"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+typedef uint64_t bench_cycles_t;
+static void bench_cycles_init(void) { }
+static bench_cycles_t bench_cycles(void) { return __rdtsc(); }
+#define BENCH_CYCLES_UNIT "cycles"
+#else
+typedef clock_t bench_cycles_t;
+static void bench_cycles_init(void) { }
+static bench_cycles_t bench_cycles(void) { return clock(); }
+#define BENCH_CYCLES_UNIT "ticks"
+#endif
+
+/* Runs one operation and reports the bytes it produced or consumed. */
+typedef kaa_error_t (*bench_fn)(void *arg, size_t *bytes);
+
+static const uint8_t server_sync[] = {
+    /* Message header: protocol id, version, extension count */
+    0x02, 0x31, 0xad, 0x61, 0x00, 0x01, 0x00, 0x02,
+    /* Meta data extension: request id 5, no resync */
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+    0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00,
+    /* Profile extension: the profile is up to date */
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static const kaa_extension_id services[] = { KAA_EXTENSION_PROFILE, KAA_EXTENSION_LOGGING };
+
+static kaa_context_t *kaa_context;
+static kaa_test_log_record_t *log_record;
+
+static uint8_t request[KAAC_BENCH_BUFFER_SIZE];
+static uint8_t frame[KAAC_BENCH_BUFFER_SIZE];
+static size_t frame_size;
+
+static void on_kaasync(void *context, kaatcp_kaasync_t *message)
+{
+    (void)context;
+    kaatcp_parser_kaasync_destroy(message);
+}
+
+static kaa_error_t bench_serialize_client_sync(void *arg, size_t *bytes)
+{
+    (void)arg;
+    *bytes = sizeof(request);
+    return kaa_platform_protocol_serialize_client_sync(kaa_context->platform_protocol,
+            services, sizeof(services) / sizeof(services[0]), request, bytes);
+}
+
+static kaa_error_t bench_parse_kaatcp(void *arg, size_t *bytes)
+{
+    kaatcp_parser_t *parser = arg;
+    *bytes = frame_size;
+    /* The parser works in place, so every pass gets a fresh copy. */
+    char buffer[KAAC_BENCH_BUFFER_SIZE];
+    memcpy(buffer, frame, frame_size);
+    return kaatcp_parser_process_buffer(parser, buffer, frame_size) ? KAA_ERR_READ_FAILED : KAA_ERR_NONE;
+}
+
+static kaa_error_t bench_process_server_sync(void *arg, size_t *bytes)
+{
+    (void)arg;
+    *bytes = sizeof(server_sync);
+    return kaa_platform_protocol_process_server_sync(kaa_context->platform_protocol,
+            server_sync, sizeof(server_sync));
+}
+
+static kaa_error_t bench_add_log_record(void *arg, size_t *bytes)
+{
+    (void)arg;
+    *bytes = log_record->get_size(log_record);
+    return kaa_logging_add_record(kaa_context->log_collector, log_record, NULL);
+}
+
+#ifdef KAA_ENCRYPTION
+static kaa_error_t bench_encrypt(void *arg, size_t *bytes)
+{
+    (void)arg;
+    static uint8_t encrypted[KAAC_BENCH_BUFFER_SIZE + 16];
+    *bytes = KAAC_BENCH_BUFFER_SIZE;
+    return ext_encrypt_data(request, KAAC_BENCH_BUFFER_SIZE, encrypted);
+}
+#endif
+
+static int bench_run(const char *name, bench_fn fn, void *arg)
+{
+#ifdef KAA_TRACE_MEMORY_ALLOCATIONS
+    kaa_trace_memory_stats_t before, after;
+    kaa_trace_memory_allocs_get_stats(&before);
+#endif
+
+    uint64_t cycles = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < KAAC_BENCH_ITERATIONS; ++i) {
+        bench_cycles_t start = bench_cycles();
+        kaa_error_t error = fn(arg, &bytes);
+        cycles += (bench_cycles_t)(bench_cycles() - start);
+        if (error) {
+            printf("%-24s failed: %d\n", name, error);
+            return 1;
+        }
+    }
+
+#ifdef KAA_TRACE_MEMORY_ALLOCATIONS
+    kaa_trace_memory_allocs_get_stats(&after);
+    printf("%-24s %10lu %s %6lu bytes %8.2f allocs\n", name,
+            (unsigned long)(cycles / KAAC_BENCH_ITERATIONS), BENCH_CYCLES_UNIT, (unsigned long)bytes,
+            (double)(after.allocations - before.allocations) / KAAC_BENCH_ITERATIONS);
+#else
+    printf("%-24s %10lu %s %6lu bytes %8s allocs\n", name,
+            (unsigned long)(cycles / KAAC_BENCH_ITERATIONS), BENCH_CYCLES_UNIT, (unsigned long)bytes, "n/a");
+#endif
+    return 0;
+}
+
+static kaa_error_t bench_init(void)
+{
+    kaa_error_t error = kaa_init(&kaa_context);
+    if (error) {
+        return error;
+    }
+    kaa_set_max_log_level(kaa_context->logger, KAA_LOG_LEVEL_NONE);
+
+    void *log_storage_context = NULL;
+    void *log_upload_strategy_context = NULL;
+    error = ext_unlimited_log_storage_create(&log_storage_context, kaa_context->logger);
+    if (error) {
+        return error;
+    }
+    error = ext_log_upload_strategy_create(kaa_context, &log_upload_strategy_context,
+            KAA_LOG_UPLOAD_BY_TIMEOUT_STRATEGY);
+    if (error) {
+        return error;
+    }
+    /* Records pile up in the storage, no upload is ever due */
+    ext_log_upload_strategy_set_upload_timeout(log_upload_strategy_context, SIZE_MAX / 2);
+
+    kaa_log_bucket_constraints_t constraints = {
+        .max_bucket_size = KAAC_BENCH_BUFFER_SIZE / 2,
+        .max_bucket_log_count = UINT32_MAX,
+    };
+    error = kaa_logging_init(kaa_context->log_collector, log_storage_context,
+            log_upload_strategy_context, &constraints);
+    if (error) {
+        return error;
+    }
+
+    log_record = kaa_test_log_record_create();
+    if (!log_record) {
+        return KAA_ERR_NOMEM;
+    }
+    log_record->data = kaa_string_copy_create("temperature=21.5;humidity=40;battery=3.61");
+    if (!log_record->data) {
+        return KAA_ERR_NOMEM;
+    }
+
+    /* A KAASYNC frame around the canned server sync, as the TCP channel receives it */
+    static const uint8_t kaasync_header[] = { 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14 };
+    size_t remaining = sizeof(kaasync_header) + sizeof(server_sync);
+    frame[0] = 0xF0;
+    frame[1] = (uint8_t)remaining;
+    memcpy(frame + 2, kaasync_header, sizeof(kaasync_header));
+    memcpy(frame + 2 + sizeof(kaasync_header), server_sync, sizeof(server_sync));
+    frame_size = 2 + remaining;
+
+    return KAA_ERR_NONE;
+}
+
+int main(void)
+{
+    bench_cycles_init();
+
+    kaa_error_t error = bench_init();
+    if (error) {
+        printf("Failed to initialize Kaa: %d\n", error);
+        return 1;
+    }
+
+    kaatcp_parser_t parser;
+    kaatcp_parser_handlers_t handlers = { NULL, NULL, NULL, &on_kaasync, NULL, NULL };
+    kaatcp_parser_init(&parser, &handlers);
+
+    printf("kaac_bench: %d iterations per operation\n", KAAC_BENCH_ITERATIONS);
+
+    int failed = 0;
+    failed |= bench_run("add_log_record", &bench_add_log_record, NULL);
+    failed |= bench_run("serialize_client_sync", &bench_serialize_client_sync, NULL);
+    failed |= bench_run("kaatcp_parse", &bench_parse_kaatcp, &parser);
+    failed |= bench_run("process_server_sync", &bench_process_server_sync, NULL);
+#ifdef KAA_ENCRYPTION
+    failed |= bench_run("aes_encrypt_1k", &bench_encrypt, NULL);
+#endif
+
+    kaatcp_parser_reset(&parser);
+    log_record->destroy(log_record);
+    kaa_deinit(kaa_context);
+    return failed;
+}
@@ -0,0 +1,49 @@
+#
+# Copyright 2014-2016 CyberVision, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Specializes codecs of a header generated by avrogencpp for encoding without copies.
+#
+# avrogencpp passes unions to codec_traits<>::encode() by value and its union getters
+# return a copy of the held value, so encoding of a record copies every union subtree
+# (e.g. all log entries of a sync request) several times. The function rewrites the header
+# so that unions are encoded by const reference and the getters return a const reference
+# to the held value. Codecs keep their avro::Encoder/avro::Decoder signatures, so they are
+# inlined into kaa::AvroBinaryVectorEncoder/kaa::AvroBinaryMemoryDecoder calls.
+function(kaa_specialize_avro_codecs header)
+    file(READ ${header} content)
+
+    string(REGEX REPLACE
+        "static void encode\\(Encoder& e, ([A-Za-z0-9_:]+) v\\)"
+        "static void encode(Encoder& e, const \\1& v)"
+        content "${content}")
+
+    string(REGEX REPLACE
+        "\n    ([^\n]+) get_([A-Za-z0-9_]+)\\(\\) const;"
+        "\n    const \\1& get_\\2() const;"
+        content "${content}")
+
+    string(REGEX REPLACE
+        "\n([^\n]+) ([A-Za-z0-9_]+)::get_([A-Za-z0-9_]+)\\(\\) const {"
+        "\nconst \\1& \\2::get_\\3() const {"
+        content "${content}")
+
+    string(REGEX REPLACE
+        "return boost::any_cast<([^\n]+)>\\(value_\\);"
+        "return *boost::any_cast<\\1>(&value_);"
+        content "${content}")
+
+    file(WRITE ${header} "${content}")
+endfunction()
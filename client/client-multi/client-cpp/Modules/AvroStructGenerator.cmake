@@ -16,6 +16,8 @@
 # This file is generated by CppEventSourcesGenerator.java
 # from client-cpp/templates/event/AvroStructGenerator.cmake.template
 
+include(${CMAKE_CURRENT_LIST_DIR}/AvroCodecSpecializer.cmake)
+
 find_program(avrogen avrogencpp)
 
 if (${avrogen} STREQUAL "avrogen-NOTFOUND")
@@ -55,6 +57,12 @@ execute_process(COMMAND ${avrogen}
     -o ${kaa_headers}configuration${directory_separator}gen${directory_separator}ConfigurationGen.hpp
     -n kaa_configuration)
 
+kaa_specialize_avro_codecs(${kaa_headers}gen${directory_separator}EndpointGen.hpp)
+kaa_specialize_avro_codecs(${kaa_headers}profile${directory_separator}gen${directory_separator}ProfileGen.hpp)
+kaa_specialize_avro_codecs(${kaa_headers}notification${directory_separator}gen${directory_separator}NotificationGen.hpp)
+kaa_specialize_avro_codecs(${kaa_headers}log${directory_separator}gen${directory_separator}LogGen.hpp)
+kaa_specialize_avro_codecs(${kaa_headers}configuration${directory_separator}gen${directory_separator}ConfigurationGen.hpp)
+
 set(event_family_classes "")
 
 foreach(family ${event_family_classes})
@@ -62,4 +70,5 @@ foreach(family ${event_family_classes})
         -i ${avro_schemas}event${directory_separator}${family}.avsc
         -o ${kaa_headers}event${directory_separator}gen${directory_separator}${family}Gen.hpp
         -n ns${family})
+    kaa_specialize_avro_codecs(${kaa_headers}event${directory_separator}gen${directory_separator}${family}Gen.hpp)
 endforeach(family)
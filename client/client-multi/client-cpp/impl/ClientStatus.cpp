@@ -16,18 +16,36 @@
 
 #include "kaa/ClientStatus.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <string>
 #include <sstream>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <boost/crc.hpp>
 
 #include "kaa/logging/Log.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 #include "kaa/common/UuidGenerator.hpp"
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/logging/Log.hpp"
 
 namespace kaa {
 
+/*
+ * The values are used as record keys by the binary state format, so only append new ones.
+ */
 enum class ClientParameterT {
     EVENT_SEQUENCE_NUMBER,
     IS_REGISTERED,
@@ -39,7 +57,84 @@ enum class ClientParameterT {
     EP_ATTACH_STATUS,
     EP_KEY_HASH,
     PROPERTIES_HASH,
-    IS_PROFILE_RESYNC_NEEDED
+    IS_PROFILE_RESYNC_NEEDED,
+    KEEPALIVE_INTERVAL,
+    OPERATIONS_SERVERS,
+    TOPIC_SEQUENCE_WINDOWS,
+    UNICAST_NOTIFICATION_HASHES
+};
+
+/*
+ * Little-endian encoding of the binary state format.
+ */
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& buffer) : buffer_(buffer) {}
+
+    template<typename T>
+    void writeInt(T value)
+    {
+        auto bits = static_cast<typename std::make_unsigned<T>::type>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            buffer_.push_back(static_cast<char>(bits >> (8 * i)));
+        }
+    }
+
+    void writeBytes(const void *data, std::size_t size)
+    {
+        writeInt<std::uint32_t>(size);
+        buffer_.append(static_cast<const char *>(data), size);
+    }
+
+private:
+    std::string& buffer_;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char *data, std::size_t size) : data_(data), size_(size), position_(0) {}
+
+    template<typename T>
+    T readInt()
+    {
+        require(sizeof(T));
+        typename std::make_unsigned<T>::type bits = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<decltype(bits)>(static_cast<std::uint8_t>(data_[position_++])) << (8 * i);
+        }
+        return static_cast<T>(bits);
+    }
+
+    std::string readBytes()
+    {
+        std::size_t size = readInt<std::uint32_t>();
+        require(size);
+        std::string bytes(data_ + position_, size);
+        position_ += size;
+        return bytes;
+    }
+
+    void skip(std::size_t size)
+    {
+        require(size);
+        position_ += size;
+    }
+
+    std::size_t getPosition() const { return position_; }
+    bool isEmpty() const { return position_ == size_; }
+
+private:
+    void require(std::size_t size) const
+    {
+        if (size_ - position_ < size) {
+            throw KaaException("Truncated state record");
+        }
+    }
+
+private:
+    const char *data_;
+    const std::size_t size_;
+    std::size_t position_;
 };
 
 class IPersistentParameter {
@@ -47,6 +142,8 @@ public:
     virtual ~IPersistentParameter() {}
     virtual void save(std::ostream &os) = 0;
     virtual void read(const std::string &strValue) = 0;
+    virtual void save(BinaryWriter &writer) = 0;
+    virtual void read(BinaryReader &reader) = 0;
     virtual boost::any getValue() const = 0;
     virtual void setValue(boost::any v) = 0;
 };
@@ -65,6 +162,10 @@ static bimap create_bimap()
     bi.left.insert(bimap::left_value_type(ClientParameterT::EP_KEY_HASH,              "ep_key_hash"));
     bi.left.insert(bimap::left_value_type(ClientParameterT::PROPERTIES_HASH,          "properties_hash"));
     bi.left.insert(bimap::left_value_type(ClientParameterT::IS_PROFILE_RESYNC_NEEDED, "is_profile_resync"));
+    bi.left.insert(bimap::left_value_type(ClientParameterT::KEEPALIVE_INTERVAL,       "keepalive_interval"));
+    bi.left.insert(bimap::left_value_type(ClientParameterT::OPERATIONS_SERVERS,       "operations_servers"));
+    bi.left.insert(bimap::left_value_type(ClientParameterT::TOPIC_SEQUENCE_WINDOWS,   "topic_seq_windows"));
+    bi.left.insert(bimap::left_value_type(ClientParameterT::UNICAST_NOTIFICATION_HASHES, "unicast_nf_hashes"));
     return bi;
 }
 
@@ -78,6 +179,81 @@ const AttachedEndpoints     ClientStatus::attachedEndpoints_;
 const bool                  ClientStatus::endpointDefaultAttachStatus_  = false;
 const std::string           ClientStatus::endpointKeyHashDefault_;
 const bool                  ClientStatus::isProfileResyncNeededDefault_ = false;
+const std::int32_t          ClientStatus::keepAliveIntervalDefault_     = 0;
+const std::string           ClientStatus::operationsServersDefault_;
+const TopicSequenceWindows  ClientStatus::topicSequenceWindowsDefault_;
+const UnicastNotificationHashes ClientStatus::unicastNotificationHashesDefault_;
+
+/*
+ * Binary state file layout: magic, version, then records appended on each save.
+ * Record: key, payload size (little-endian), payload, CRC-32 of the preceding record bytes.
+ * Records are replayed in order, so the last record of a parameter wins.
+ */
+static const char           STATE_FILE_MAGIC[] = { 'K', 'A', 'A', 'S' };
+static const std::uint8_t   STATE_FILE_VERSION = 1;
+static const std::size_t    STATE_FILE_HEADER_SIZE = sizeof(STATE_FILE_MAGIC) + 1;
+
+/* Record keys of topic states, clear of the ClientParameterT values. */
+static const std::uint8_t   TOPIC_STATE_KEY = 0x80;
+static const std::uint8_t   TOPIC_STATE_REMOVED_KEY = 0x81;
+
+/* The journal is rewritten as a snapshot when it outgrows both values. */
+static const std::size_t    JOURNAL_COMPACTION_MIN_SIZE = 4096;
+static const std::size_t    JOURNAL_COMPACTION_RATIO = 2;
+
+static const char * const   TEMPORARY_FILE_SUFFIX = ".tmp";
+
+static std::uint32_t calculateChecksum(const char *data, std::size_t size)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+static void writeRecord(std::string& buffer, std::uint8_t key, const std::string& payload)
+{
+    std::size_t recordOffset = buffer.size();
+
+    BinaryWriter writer(buffer);
+    writer.writeInt(key);
+    writer.writeBytes(payload.data(), payload.size());
+    writer.writeInt(calculateChecksum(buffer.data() + recordOffset, buffer.size() - recordOffset));
+}
+
+static void writeTopicStateRecord(std::string& buffer, std::int64_t topicId, std::int32_t sequenceNumber)
+{
+    std::string payload;
+    BinaryWriter writer(payload);
+    writer.writeInt(topicId);
+    writer.writeInt(sequenceNumber);
+    writeRecord(buffer, TOPIC_STATE_KEY, payload);
+}
+
+static bool writeFully(std::FILE *file, const std::string& data)
+{
+    return data.empty() || std::fwrite(data.data(), data.size(), 1, file) == 1;
+}
+
+static bool syncFile(std::FILE *file)
+{
+    if (std::fflush(file)) {
+        return false;
+    }
+#ifdef _WIN32
+    return !_commit(_fileno(file));
+#else
+    return !fsync(fileno(file));
+#endif
+}
+
+static bool replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return !std::rename(from.c_str(), to.c_str());
+#endif
+}
 
 static std::string convertToByteArrayString(const std::string & str)
 {
@@ -115,6 +291,8 @@ public:
     }
     void save(std::ostream &os);
     void read(const std::string &strValue);
+    void save(BinaryWriter &writer);
+    void read(BinaryReader &reader);
     boost::any getValue() const { return value_; }
     void setValue(boost::any v) { value_ = boost::any_cast<const T&>(v); }
 private:
@@ -188,6 +366,30 @@ void ClientParameter<HashDigest>::save(std::ostream &os)
     }
 }
 
+template<>
+void ClientParameter<TopicSequenceWindows>::save(std::ostream &os)
+{
+    if (!value_.empty()) {
+        os << attributeName_ << "=";
+        for (const auto& window : value_) {
+            os << window.first << ' ' << window.second << ' ';
+        }
+        os << std::endl;
+    }
+}
+
+template<>
+void ClientParameter<UnicastNotificationHashes>::save(std::ostream &os)
+{
+    if (!value_.empty()) {
+        os << attributeName_ << "=";
+        for (auto hash : value_) {
+            os << hash << ' ';
+        }
+        os << std::endl;
+    }
+}
+
 template<typename T>
 T convert(const std::string &strValue)
 {
@@ -290,6 +492,31 @@ void ClientParameter<AttachedEndpoints>::read(const std::string &strValue)
     }
 }
 
+template<>
+void ClientParameter<TopicSequenceWindows>::read(const std::string &strValue)
+{
+    value_.clear();
+
+    std::stringstream stream(strValue);
+    std::int64_t topicId;
+    std::uint64_t window;
+    while ((stream >> topicId) && (stream >> window)) {
+        value_[topicId] = window;
+    }
+}
+
+template<>
+void ClientParameter<UnicastNotificationHashes>::read(const std::string &strValue)
+{
+    value_.clear();
+
+    std::stringstream stream(strValue);
+    std::uint64_t hash;
+    while (stream >> hash) {
+        value_.push_back(hash);
+    }
+}
+
 template<>
 void ClientParameter<HashDigest>::read(const std::string &strValue)
 {
@@ -300,11 +527,156 @@ void ClientParameter<HashDigest>::read(const std::string &strValue)
     }
 }
 
+template<>
+void ClientParameter<std::int32_t>::save(BinaryWriter &writer)
+{
+    writer.writeInt(value_);
+}
+
+template<>
+void ClientParameter<std::int32_t>::read(BinaryReader &reader)
+{
+    value_ = reader.readInt<std::int32_t>();
+}
+
+template<>
+void ClientParameter<bool>::save(BinaryWriter &writer)
+{
+    writer.writeInt<std::uint8_t>(value_ ? 1 : 0);
+}
+
+template<>
+void ClientParameter<bool>::read(BinaryReader &reader)
+{
+    value_ = reader.readInt<std::uint8_t>() != 0;
+}
+
+template<>
+void ClientParameter<std::string>::save(BinaryWriter &writer)
+{
+    writer.writeBytes(value_.data(), value_.size());
+}
+
+template<>
+void ClientParameter<std::string>::read(BinaryReader &reader)
+{
+    value_ = reader.readBytes();
+}
+
+template<>
+void ClientParameter<Topics>::save(BinaryWriter &writer)
+{
+    writer.writeInt<std::uint32_t>(value_.size());
+    for (const auto& topic : value_) {
+        writer.writeInt<std::int64_t>(topic.id);
+        writer.writeBytes(topic.name.data(), topic.name.size());
+        writer.writeInt<std::uint8_t>(topic.subscriptionType == SubscriptionType::MANDATORY_SUBSCRIPTION ? 1 : 0);
+    }
+}
+
+template<>
+void ClientParameter<Topics>::read(BinaryReader &reader)
+{
+    Topics topics(reader.readInt<std::uint32_t>());
+    for (auto& topic : topics) {
+        topic.id = reader.readInt<std::int64_t>();
+        topic.name = reader.readBytes();
+        topic.subscriptionType = (reader.readInt<std::uint8_t>() ? SubscriptionType::MANDATORY_SUBSCRIPTION
+                                                                 : SubscriptionType::OPTIONAL_SUBSCRIPTION);
+    }
+    value_.swap(topics);
+}
+
+template<>
+void ClientParameter<AttachedEndpoints>::save(BinaryWriter &writer)
+{
+    writer.writeInt<std::uint32_t>(value_.size());
+    for (const auto& endpoint : value_) {
+        writer.writeBytes(endpoint.first.data(), endpoint.first.size());
+        writer.writeBytes(endpoint.second.data(), endpoint.second.size());
+    }
+}
+
+template<>
+void ClientParameter<AttachedEndpoints>::read(BinaryReader &reader)
+{
+    AttachedEndpoints endpoints;
+    for (std::size_t count = reader.readInt<std::uint32_t>(); count > 0; --count) {
+        std::string token = reader.readBytes();
+        endpoints[token] = reader.readBytes();
+    }
+    value_.swap(endpoints);
+}
+
+template<>
+void ClientParameter<HashDigest>::save(BinaryWriter &writer)
+{
+    writer.writeBytes(value_.data(), value_.size());
+}
+
+template<>
+void ClientParameter<HashDigest>::read(BinaryReader &reader)
+{
+    std::string bytes = reader.readBytes();
+    value_.assign(bytes.begin(), bytes.end());
+}
+
+template<>
+void ClientParameter<TopicSequenceWindows>::save(BinaryWriter &writer)
+{
+    writer.writeInt<std::uint32_t>(value_.size());
+    for (const auto& window : value_) {
+        writer.writeInt(window.first);
+        writer.writeInt(window.second);
+    }
+}
+
+template<>
+void ClientParameter<TopicSequenceWindows>::read(BinaryReader &reader)
+{
+    TopicSequenceWindows windows;
+    for (std::size_t count = reader.readInt<std::uint32_t>(); count > 0; --count) {
+        auto topicId = reader.readInt<std::int64_t>();
+        windows[topicId] = reader.readInt<std::uint64_t>();
+    }
+    value_.swap(windows);
+}
+
+template<>
+void ClientParameter<UnicastNotificationHashes>::save(BinaryWriter &writer)
+{
+    writer.writeInt<std::uint32_t>(value_.size());
+    for (auto hash : value_) {
+        writer.writeInt(hash);
+    }
+}
+
+template<>
+void ClientParameter<UnicastNotificationHashes>::read(BinaryReader &reader)
+{
+    UnicastNotificationHashes hashes(reader.readInt<std::uint32_t>());
+    for (auto& hash : hashes) {
+        hash = reader.readInt<std::uint64_t>();
+    }
+    value_.swap(hashes);
+}
+
   ClientStatus::ClientStatus(IKaaClientContext& context)
       : filename_(context.getProperties().getStateFileName()),
         isSDKPropertiesForUpdated_(false),
         hasUpdate_(false),
-        context_(context)
+        context_(context),
+        isBinaryFormat_(context.getProperties().getStateFileFormat() == StateFileFormat::BINARY),
+        saveDelay_(context.getProperties().getStateSaveDelay()),
+        journalSize_(0),
+        snapshotSize_(0),
+        needsCompaction_(false),
+        eventSeqNumber_(eventSeqNumberDefault_),
+        isRegistered_(isRegisteredDefault_),
+        isAttached_(endpointDefaultAttachStatus_),
+        hotGeneration_(0),
+        savedHotGeneration_(0),
+        saveTimer_("ClientStatus saveTimer")
 {
     auto eventSeqNumberTokenParamToken = parameterToToken_.left.find(ClientParameterT::EVENT_SEQUENCE_NUMBER);
     if (eventSeqNumberTokenParamToken != parameterToToken_.left.end()) {
@@ -372,12 +744,53 @@ void ClientParameter<HashDigest>::read(const std::string &strValue)
                 isProfileResyncNeededParamToken->second, isProfileResyncNeededDefault_));
         parameters_.insert(std::make_pair(ClientParameterT::IS_PROFILE_RESYNC_NEEDED, isProfileResyncNeededParam));
     }
+    auto keepAliveIntervalParamToken = parameterToToken_.left.find(ClientParameterT::KEEPALIVE_INTERVAL);
+    if (keepAliveIntervalParamToken != parameterToToken_.left.end()) {
+        std::shared_ptr<IPersistentParameter> keepAliveIntervalParam(new ClientParameter<std::int32_t>(
+                keepAliveIntervalParamToken->second, keepAliveIntervalDefault_));
+        parameters_.insert(std::make_pair(ClientParameterT::KEEPALIVE_INTERVAL, keepAliveIntervalParam));
+    }
+    auto operationsServersParamToken = parameterToToken_.left.find(ClientParameterT::OPERATIONS_SERVERS);
+    if (operationsServersParamToken != parameterToToken_.left.end()) {
+        std::shared_ptr<IPersistentParameter> operationsServersParam(new ClientParameter<std::string>(
+                operationsServersParamToken->second, operationsServersDefault_));
+        parameters_.insert(std::make_pair(ClientParameterT::OPERATIONS_SERVERS, operationsServersParam));
+    }
+    auto topicSequenceWindowsParamToken = parameterToToken_.left.find(ClientParameterT::TOPIC_SEQUENCE_WINDOWS);
+    if (topicSequenceWindowsParamToken != parameterToToken_.left.end()) {
+        std::shared_ptr<IPersistentParameter> topicSequenceWindowsParam(new ClientParameter<TopicSequenceWindows>(
+                topicSequenceWindowsParamToken->second, topicSequenceWindowsDefault_));
+        parameters_.insert(std::make_pair(ClientParameterT::TOPIC_SEQUENCE_WINDOWS, topicSequenceWindowsParam));
+    }
+    auto unicastHashesParamToken = parameterToToken_.left.find(ClientParameterT::UNICAST_NOTIFICATION_HASHES);
+    if (unicastHashesParamToken != parameterToToken_.left.end()) {
+        std::shared_ptr<IPersistentParameter> unicastHashesParam(new ClientParameter<UnicastNotificationHashes>(
+                unicastHashesParamToken->second, unicastNotificationHashesDefault_));
+        parameters_.insert(std::make_pair(ClientParameterT::UNICAST_NOTIFICATION_HASHES, unicastHashesParam));
+    }
 
     this->read();
 
     checkSDKPropertiesForUpdates();
 }
 
+ClientStatus::~ClientStatus()
+{
+    if (saveDelay_ != std::chrono::milliseconds::zero()) {
+        try {
+            flush();
+        } catch (std::exception& e) {
+            KAA_LOG_ERROR(boost::format("Failed to save pending client state: %s") % e.what());
+        }
+    }
+}
+
+void ClientStatus::markDirty(ClientParameterT type)
+{
+    dirtyParameters_.insert(type);
+    hasUpdate_ = true;
+}
+
 void ClientStatus::checkSDKPropertiesForUpdates()
 {
     HashDigest currentPropertiesHash = getPropertiesHash();
@@ -388,7 +801,7 @@ void ClientStatus::checkSDKPropertiesForUpdates()
 
     if (storedPropertiesHash == endpointHashDefault_) {
         parameter_it->second->setValue(currentPropertiesHash);
-        hasUpdate_ = true;
+        markDirty(ClientParameterT::PROPERTIES_HASH);
         KAA_LOG_INFO("SDK properties are up to date");
     } else {
         if (currentPropertiesHash != storedPropertiesHash) {
@@ -396,7 +809,7 @@ void ClientStatus::checkSDKPropertiesForUpdates()
 
             setRegistered(false);
             isSDKPropertiesForUpdated_ = true;
-            hasUpdate_ = true;
+            markDirty(ClientParameterT::PROPERTIES_HASH);
             KAA_LOG_INFO("SDK properties were updated");
         } else {
             KAA_LOG_INFO("SDK properties are up to date");
@@ -407,26 +820,29 @@ void ClientStatus::checkSDKPropertiesForUpdates()
 template< ClientParameterT Type, class ParameterData >
 void ClientStatus::setParameterData(const ParameterData& data)
 {
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
     auto parameter_it = parameters_.find(Type);
     if (parameter_it != parameters_.end()) {
         parameter_it->second->setValue(data);
-        hasUpdate_ = true;
+        markDirty(Type);
     }
 }
 
 template< ClientParameterT Type, class ParameterData >
 void ClientStatus::setParameterDataWithEqualCheck(const ParameterData& data)
 {
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
     auto parameter_it = parameters_.find(Type);
     if (parameter_it != parameters_.end() && data != boost::any_cast<ParameterData>(parameter_it->second->getValue())) {
         parameter_it->second->setValue(data);
-        hasUpdate_ = true;
+        markDirty(Type);
     }
 }
 
 template< ClientParameterT Type, class ParameterData >
 ParameterData ClientStatus::getParameterData(const ParameterData& defaultValue) const
 {
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
     auto parameter_it = parameters_.find(Type);
     if (parameter_it != parameters_.end()) {
         return boost::any_cast<ParameterData>(parameter_it->second->getValue());
@@ -435,14 +851,38 @@ ParameterData ClientStatus::getParameterData(const ParameterData& defaultValue)
     return defaultValue;
 }
 
+void ClientStatus::loadHotParameters()
+{
+    eventSeqNumber_ = getParameterData<ClientParameterT::EVENT_SEQUENCE_NUMBER>(eventSeqNumberDefault_);
+    isRegistered_ = getParameterData<ClientParameterT::IS_REGISTERED>(isRegisteredDefault_);
+    isAttached_ = getParameterData<ClientParameterT::EP_ATTACH_STATUS>(endpointDefaultAttachStatus_);
+    savedHotGeneration_ = hotGeneration_.load(std::memory_order_acquire);
+}
+
+void ClientStatus::storeHotParameters()
+{
+    /* The generation is read first: a change racing with the copy bumps it again for the next save. */
+    auto generation = hotGeneration_.load(std::memory_order_acquire);
+    if (generation == savedHotGeneration_) {
+        return;
+    }
+
+    savedHotGeneration_ = generation;
+    setParameterDataWithEqualCheck<ClientParameterT::EVENT_SEQUENCE_NUMBER>(eventSeqNumber_.load());
+    setParameterDataWithEqualCheck<ClientParameterT::IS_REGISTERED>(isRegistered_.load());
+    setParameterDataWithEqualCheck<ClientParameterT::EP_ATTACH_STATUS>(isAttached_.load());
+}
+
 bool ClientStatus::isRegistered() const
 {
-    return getParameterData<ClientParameterT::IS_REGISTERED>(isRegisteredDefault_);
+    return isRegistered_;
 }
 
 void ClientStatus::setRegistered(bool isRegisteredP)
 {
-    setParameterDataWithEqualCheck<ClientParameterT::IS_REGISTERED>(isRegisteredP);
+    if (isRegistered_.exchange(isRegisteredP) != isRegisteredP) {
+        onHotParameterChanged();
+    }
 }
 
 bool ClientStatus::isProfileResyncNeeded() const
@@ -455,6 +895,26 @@ void ClientStatus::setProfileResyncNeeded(bool isNeeded)
     setParameterDataWithEqualCheck<ClientParameterT::IS_PROFILE_RESYNC_NEEDED>(isNeeded);
 }
 
+std::int32_t ClientStatus::getKeepAliveInterval() const
+{
+    return getParameterData<ClientParameterT::KEEPALIVE_INTERVAL>(keepAliveIntervalDefault_);
+}
+
+void ClientStatus::setKeepAliveInterval(std::int32_t interval)
+{
+    setParameterDataWithEqualCheck<ClientParameterT::KEEPALIVE_INTERVAL>(interval);
+}
+
+std::string ClientStatus::getOperationsServers() const
+{
+    return getParameterData<ClientParameterT::OPERATIONS_SERVERS>(operationsServersDefault_);
+}
+
+void ClientStatus::setOperationsServers(const std::string& servers)
+{
+    setParameterDataWithEqualCheck<ClientParameterT::OPERATIONS_SERVERS>(servers);
+}
+
 std::string ClientStatus::getEndpointAccessToken()
 {
     std::string token;
@@ -513,17 +973,46 @@ void ClientStatus::setProfileHash(HashDigest hash)
 
 bool ClientStatus::getEndpointAttachStatus() const
 {
-    return getParameterData<ClientParameterT::EP_ATTACH_STATUS>(endpointDefaultAttachStatus_);
+    return isAttached_;
 }
 
 void ClientStatus::setEndpointAttachStatus(bool isAttached)
 {
-    setParameterDataWithEqualCheck<ClientParameterT::EP_ATTACH_STATUS>(isAttached);
+    if (isAttached_.exchange(isAttached) != isAttached) {
+        onHotParameterChanged();
+    }
 }
 
 void ClientStatus::read()
 {
-    std::ifstream stateFile(filename_);
+    std::ifstream stateFile(filename_, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(stateFile)), std::istreambuf_iterator<char>());
+    stateFile.close();
+
+    bool isBinaryFile = content.size() >= STATE_FILE_HEADER_SIZE &&
+                        !std::memcmp(content.data(), STATE_FILE_MAGIC, sizeof(STATE_FILE_MAGIC));
+
+    if (isBinaryFile) {
+        readBinary(content);
+    } else {
+        std::istringstream stream(content);
+        readText(stream);
+    }
+
+    /* Migrate the file to the configured format on the next save. */
+    if (!content.empty() && isBinaryFile != isBinaryFormat_) {
+        hasUpdate_ = true;
+        needsCompaction_ = true;
+    }
+
+    persistedTopicStates_ = topicStates_;
+    loadHotParameters();
+
+    KAA_LOG_DEBUG(boost::format("Read topic list hash: %1%") % getTopicListHash());
+}
+
+void ClientStatus::readText(std::istream& stateFile)
+{
     std::string value;
     std::string token;
 
@@ -552,18 +1041,95 @@ void ClientStatus::read()
             }
         }
     }
+}
 
-    KAA_LOG_DEBUG(boost::format("Read topic list hash: %1%") % getTopicListHash());
+void ClientStatus::readBinary(const std::string& content)
+{
+    if (static_cast<std::uint8_t>(content[sizeof(STATE_FILE_MAGIC)]) != STATE_FILE_VERSION) {
+        KAA_LOG_WARN(boost::format("Unsupported state file version %1%, starting with the default state")
+                                    % static_cast<int>(static_cast<std::uint8_t>(content[sizeof(STATE_FILE_MAGIC)])));
+        needsCompaction_ = true;
+        return;
+    }
 
-    stateFile.close();
+    BinaryReader reader(content.data(), content.size());
+    reader.skip(STATE_FILE_HEADER_SIZE);
+
+    while (!reader.isEmpty()) {
+        std::size_t recordOffset = reader.getPosition();
+        try {
+            auto key = reader.readInt<std::uint8_t>();
+            std::string payload = reader.readBytes();
+            std::size_t recordSize = reader.getPosition() - recordOffset;
+
+            if (reader.readInt<std::uint32_t>() != calculateChecksum(content.data() + recordOffset, recordSize)) {
+                throw KaaException("Checksum mismatch");
+            }
+
+            BinaryReader payloadReader(payload.data(), payload.size());
+            applyRecord(key, payloadReader);
+        } catch (std::exception& e) {
+            /* Most likely a save was interrupted. Records after a broken one can't be trusted. */
+            KAA_LOG_WARN(boost::format("Discarding state file tail at offset %1%: %2%") % recordOffset % e.what());
+            journalSize_ = recordOffset;
+            snapshotSize_ = recordOffset;
+            needsCompaction_ = true;
+            return;
+        }
+    }
+
+    journalSize_ = content.size();
+    snapshotSize_ = content.size();
+}
+
+void ClientStatus::applyRecord(std::uint8_t key, BinaryReader& reader)
+{
+    if (key == TOPIC_STATE_KEY) {
+        auto topicId = reader.readInt<std::int64_t>();
+        topicStates_[topicId] = reader.readInt<std::int32_t>();
+    } else if (key == TOPIC_STATE_REMOVED_KEY) {
+        topicStates_.erase(reader.readInt<std::int64_t>());
+    } else {
+        auto it = parameters_.find(static_cast<ClientParameterT>(key));
+        if (it != parameters_.end()) {
+            it->second->read(reader);
+        }
+    }
 }
 
 void ClientStatus::save()
 {
+    if (saveDelay_ == std::chrono::milliseconds::zero()) {
+        flush();
+        return;
+    }
+
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
+    if (hasUpdate_ || hotGeneration_.load(std::memory_order_acquire) != savedHotGeneration_) {
+        /* No-op while a save is already pending, so saves within the delay are coalesced. */
+        saveTimer_.start(saveDelay_, [this] { flush(); });
+    }
+}
+
+void ClientStatus::flush()
+{
+    saveTimer_.stop();
+
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
+    storeHotParameters();
     if (!hasUpdate_) {
         return;
     }
 
+    if (isBinaryFormat_) {
+        saveBinary();
+    } else {
+        saveText();
+    }
+}
+
+void ClientStatus::saveText()
+{
     std::ofstream stateFile(filename_);
 
     /* Save topic list hash */
@@ -586,14 +1152,129 @@ void ClientStatus::save()
     hasUpdate_ = false;
 }
 
+void ClientStatus::saveBinary()
+{
+    bool needsCompaction = needsCompaction_ || !journalSize_ ||
+            journalSize_ > std::max(JOURNAL_COMPACTION_MIN_SIZE, JOURNAL_COMPACTION_RATIO * snapshotSize_);
+
+    bool isSaved = needsCompaction ? compactJournal() : appendJournal();
+    if (!isSaved && !needsCompaction) {
+        /* The journal tail may be broken now, rewrite it as a whole. */
+        isSaved = compactJournal();
+    }
+
+    if (!isSaved) {
+        KAA_LOG_ERROR(boost::format("Failed to save client state to '%1%'") % filename_);
+        needsCompaction_ = true;
+        return;
+    }
+
+    dirtyParameters_.clear();
+    persistedTopicStates_ = topicStates_;
+    hasUpdate_ = false;
+}
+
+bool ClientStatus::appendJournal()
+{
+    std::string records;
+
+    for (auto type : dirtyParameters_) {
+        std::string payload;
+        BinaryWriter writer(payload);
+        parameters_[type]->save(writer);
+        writeRecord(records, static_cast<std::uint8_t>(type), payload);
+    }
+
+    /* Topic states are mutated in place by their users, so find the changes by comparison. */
+    for (const auto& state : topicStates_) {
+        auto persisted = persistedTopicStates_.find(state.first);
+        if (persisted == persistedTopicStates_.end() || persisted->second != state.second) {
+            writeTopicStateRecord(records, state.first, state.second);
+        }
+    }
+    for (const auto& state : persistedTopicStates_) {
+        if (!topicStates_.count(state.first)) {
+            std::string payload;
+            BinaryWriter writer(payload);
+            writer.writeInt(state.first);
+            writeRecord(records, TOPIC_STATE_REMOVED_KEY, payload);
+        }
+    }
+
+    if (records.empty()) {
+        return true;
+    }
+
+    std::FILE *file = std::fopen(filename_.c_str(), "ab");
+    if (!file) {
+        return false;
+    }
+
+    bool isWritten = writeFully(file, records) && syncFile(file);
+    if (std::fclose(file) || !isWritten) {
+        return false;
+    }
+
+    KAA_LOG_TRACE(boost::format("Appended %1% bytes to the client state journal") % records.size());
+    journalSize_ += records.size();
+    return true;
+}
+
+bool ClientStatus::compactJournal()
+{
+    std::string snapshot(STATE_FILE_MAGIC, sizeof(STATE_FILE_MAGIC));
+    snapshot.push_back(static_cast<char>(STATE_FILE_VERSION));
+
+    for (const auto& parameter : parameters_) {
+        std::string payload;
+        BinaryWriter writer(payload);
+        parameter.second->save(writer);
+        writeRecord(snapshot, static_cast<std::uint8_t>(parameter.first), payload);
+    }
+
+    for (const auto& state : topicStates_) {
+        writeTopicStateRecord(snapshot, state.first, state.second);
+    }
+
+    const std::string temporaryFilename = filename_ + TEMPORARY_FILE_SUFFIX;
+    std::FILE *file = std::fopen(temporaryFilename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool isWritten = writeFully(file, snapshot) && syncFile(file);
+    if (std::fclose(file) || !isWritten || !replaceFile(temporaryFilename, filename_)) {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+
+    KAA_LOG_DEBUG(boost::format("Compacted client state journal from %1% to %2% bytes")
+                                % journalSize_ % snapshot.size());
+    journalSize_ = snapshot.size();
+    snapshotSize_ = snapshot.size();
+    needsCompaction_ = false;
+    return true;
+}
+
 std::int32_t ClientStatus::getEventSequenceNumber() const
 {
-    return getParameterData<ClientParameterT::EVENT_SEQUENCE_NUMBER>(eventSeqNumberDefault_);
+    return eventSeqNumber_;
 }
 
 void ClientStatus::setEventSequenceNumber(std::int32_t sequenceNumber)
 {
-    setParameterDataWithEqualCheck<ClientParameterT::EVENT_SEQUENCE_NUMBER>(sequenceNumber);
+    if (eventSeqNumber_.exchange(sequenceNumber) != sequenceNumber) {
+        onHotParameterChanged();
+    }
+}
+
+std::int32_t ClientStatus::reserveEventSequenceNumbers(std::int32_t count)
+{
+    std::int32_t first = eventSeqNumber_.fetch_add(count);
+    if (count) {
+        onHotParameterChanged();
+    }
+    return first;
 }
 
 std::string ClientStatus::getEndpointKeyHash() const
@@ -618,6 +1299,7 @@ std::int32_t ClientStatus::getTopicListHash()
 
 void ClientStatus::setTopicStates(const TopicStates& subscriptions)
 {
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, statusGuard_);
     topicStates_ = subscriptions;
     hasUpdate_ = true;
 }
@@ -627,4 +1309,24 @@ std::map<std::int64_t, std::int32_t>& ClientStatus::getTopicStates()
     return topicStates_;
 }
 
+TopicSequenceWindows ClientStatus::getTopicSequenceWindows() const
+{
+    return getParameterData<ClientParameterT::TOPIC_SEQUENCE_WINDOWS>(topicSequenceWindowsDefault_);
+}
+
+void ClientStatus::setTopicSequenceWindows(const TopicSequenceWindows& windows)
+{
+    setParameterDataWithEqualCheck<ClientParameterT::TOPIC_SEQUENCE_WINDOWS>(windows);
+}
+
+UnicastNotificationHashes ClientStatus::getUnicastNotificationHashes() const
+{
+    return getParameterData<ClientParameterT::UNICAST_NOTIFICATION_HASHES>(unicastNotificationHashesDefault_);
+}
+
+void ClientStatus::setUnicastNotificationHashes(const UnicastNotificationHashes& hashes)
+{
+    setParameterDataWithEqualCheck<ClientParameterT::UNICAST_NOTIFICATION_HASHES>(hashes);
+}
+
 }
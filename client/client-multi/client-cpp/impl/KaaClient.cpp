@@ -15,10 +15,12 @@
  */
 
 #include <fstream>
+#include <algorithm>
 
 #include "kaa/KaaClient.hpp"
 
 #include "kaa/channel/connectivity/PingConnectivityChecker.hpp"
+#include "kaa/channel/connectivity/ConnectivityMonitor.hpp"
 #include "kaa/bootstrap/BootstrapManager.hpp"
 #include "kaa/KaaDefaults.hpp"
 
@@ -35,20 +37,41 @@
 #include "kaa/channel/KaaChannelManager.hpp"
 
 #include "kaa/failover/DefaultFailoverStrategy.hpp"
+#include "kaa/failover/BackoffFailoverStrategy.hpp"
 
 #include "kaa/logging/Log.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/context/PollingExecutorContext.hpp"
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/logging/AsyncLogger.hpp"
 
 namespace kaa {
 
+static LoggerPtr createLogger(const KaaClientProperties& properties)
+{
+    auto defaultLogger = std::make_shared<DefaultLogger>(properties.getClientId(), properties.getLogFileName());
+    defaultLogger->setLevel(properties.getLogLevel());
+
+    LoggerPtr logger = defaultLogger;
+
+#ifndef KAA_USE_SINGLE_THREAD
+    std::size_t queueCapacity = properties.getAsyncLogQueueCapacity();
+    if (queueCapacity) {
+        logger = std::make_shared<AsyncLogger>(logger, queueCapacity);
+    }
+#endif
+
+    return logger;
+}
+
 KaaClient::KaaClient(IKaaClientPlatformContextPtr platformContext, KaaClientStateListenerPtr listener)
-    : logger_(new DefaultLogger(platformContext->getProperties().getClientId(), platformContext->getProperties().getLogFileName())),
+    : logger_(createLogger(platformContext->getProperties())),
       context_(platformContext->getProperties(), *logger_, platformContext->getExecutorContext(), nullptr,
                (listener == nullptr) ? std::make_shared<KaaClientStateListener>() : listener),
       status_(new ClientStatus(context_)),
-      platformContext_(platformContext)
+      platformContext_(platformContext),
+      memoryCheckTimer_("KaaClient memoryCheckTimer")
 {
     init();
 }
@@ -62,7 +85,13 @@ void KaaClient::init()
     context_.setStatus(status_);
     bootstrapManager_.reset(new BootstrapManager(context_, this));
     channelManager_.reset(new KaaChannelManager(*bootstrapManager_, getBootstrapServers(), context_, this));
-    failoverStrategy_.reset(new DefaultFailoverStrategy(context_));
+    if (context_.getProperties().isFailoverBackoff()) {
+        failoverStrategy_.reset(new BackoffFailoverStrategy(context_,
+                                                            context_.getProperties().getFailoverBackoffBase().count(),
+                                                            context_.getProperties().getFailoverBackoffMax().count()));
+    } else {
+        failoverStrategy_.reset(new DefaultFailoverStrategy(context_));
+    }
     channelManager_->setFailoverStrategy(failoverStrategy_);
     profileManager_.reset(new ProfileManager(context_));
 
@@ -73,6 +102,7 @@ void KaaClient::init()
     registrationManager_.reset(new EndpointRegistrationManager(context_));
     eventManager_.reset(new EventManager(context_));
     eventFamilyFactory_.reset(new EventFamilyFactory(*eventManager_, *eventManager_, context_));
+    registrationManager_->setUserEndpointsChangeListener([this] { eventManager_->clearEventListenersCache(); });
 #endif
 #ifdef KAA_USE_NOTIFICATIONS
     notificationManager_.reset(new NotificationManager(context_));
@@ -112,7 +142,9 @@ void KaaClient::start()
 #ifdef KAA_USE_CONFIGURATION
                 configurationManager_->init();
 #endif
-                bootstrapManager_->receiveOperationsServerList();
+                if (!context_.getProperties().isFastStart() || !bootstrapManager_->useSavedOperationsServers()) {
+                    bootstrapManager_->receiveOperationsServerList();
+                }
                 context_.getClientStateListener().onStarted();
 
                 KAA_LOG_INFO("Kaa client started");
@@ -122,6 +154,10 @@ void KaaClient::start()
             }
         });
 
+    if (context_.getProperties().getMemorySoftLimit()) {
+        startMemoryCheckTimer();
+    }
+
     setClientState(State::STARTED);
 }
 
@@ -132,6 +168,8 @@ void KaaClient::stop()
 
     KAA_LOG_TRACE("Kaa client stopping...");
 
+    memoryCheckTimer_.stop();
+
     /*
      * To prevent a race condition between stopping a client when it is already destroyed,
      * pass a reference to this client to a 'stop' task.
@@ -141,7 +179,7 @@ void KaaClient::stop()
         {
             try {
                 channelManager_->shutdown();
-                status_->save();
+                status_->flush();
                 context_.getClientStateListener().onStopped();
 
                 KAA_LOG_INFO("Kaa client stopped");
@@ -164,7 +202,7 @@ void KaaClient::pause()
     context_.getExecutorContext().getLifeCycleExecutor().add([this]
         {
             try {
-                status_->save();
+                status_->flush();
                 channelManager_->pause();
                 context_.getClientStateListener().onPaused();
 
@@ -200,6 +238,16 @@ void KaaClient::resume()
     setClientState(State::STARTED);
 }
 
+std::size_t KaaClient::poll(std::chrono::milliseconds timeout)
+{
+    auto *pollingContext = dynamic_cast<PollingExecutorContext *>(&context_.getExecutorContext());
+    if (!pollingContext) {
+        throw KaaException("Kaa client isn't created with polling executor context");
+    }
+
+    return pollingContext->poll(timeout);
+}
+
 void KaaClient::initKaaTransport()
 {
     IBootstrapTransportPtr bootstrapTransport(new BootstrapTransport(*channelManager_, *bootstrapManager_, context_));
@@ -261,6 +309,7 @@ void KaaClient::initKaaTransport()
 #endif
             , redirectionTransport
             , context_));
+    syncProcessor_->setBandwidthShaper(channelManager_->getBandwidthShaper());
 
 #ifdef KAA_USE_EVENTS
     eventManager_->setTransport(std::dynamic_pointer_cast<EventTransport, IEventTransport>(eventTransport).get());
@@ -280,14 +329,16 @@ void KaaClient::initKaaTransport()
     channelManager_->addChannel(bootstrapChannel_.get());
 #endif
 #ifdef KAA_DEFAULT_TCP_CHANNEL
-    opsTcpChannel_.reset(new DefaultOperationTcpChannel(*channelManager_, *clientKeys_, context_));
+    opsTcpChannel_.reset(new DefaultOperationTcpChannel(*channelManager_, *clientKeys_, context_,
+                                                        platformContext_->getIoServicePool()));
     opsTcpChannel_->setDemultiplexer(syncProcessor_.get());
     opsTcpChannel_->setMultiplexer(syncProcessor_.get());
     KAA_LOG_INFO(boost::format("Going to set default operations Kaa TCP channel: %1%") % opsTcpChannel_.get());
     channelManager_->addChannel(opsTcpChannel_.get());
 #endif
 #ifdef KAA_DEFAULT_CONNECTIVITY_CHECKER
-    channelManager_->setConnectivityChecker(std::make_shared<PingConnectivityChecker>());
+    channelManager_->setConnectivityChecker(
+            std::make_shared<ConnectivityMonitor>(std::make_shared<PingConnectivityChecker>()));
 #endif
 }
 
@@ -325,7 +376,7 @@ void KaaClient::initClientKeys()
     std::string endpointKeyHash = Botan::base64_encode(digest.data(), digest.size());
 
     status_->setEndpointKeyHash(endpointKeyHash);
-    status_->save();
+    status_->flush();
 
 }
 
@@ -365,6 +416,15 @@ const KaaRootConfiguration& KaaClient::getConfiguration() {
     throw KaaException("Failed to subscribe to get configuration. Configuration subsystem is disabled");
 #endif
 }
+
+std::shared_ptr<const KaaRootConfiguration> KaaClient::getConfigurationSnapshot() {
+#ifdef KAA_USE_CONFIGURATION
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    return configurationManager_->getConfigurationSnapshot();
+#else
+    throw KaaException("Failed to get configuration snapshot. Configuration subsystem is disabled");
+#endif
+}
 void KaaClient::addTopicListListener(INotificationTopicListListener& listener) {
 #ifdef KAA_USE_NOTIFICATIONS
     notificationManager_->addTopicListListener(listener);
@@ -419,6 +479,38 @@ void KaaClient::removeNotificationListener(std::int64_t topicId, INotificationLi
 #endif
 }
 
+void KaaClient::addRawNotificationListener(IRawNotificationListener& listener) {
+#ifdef KAA_USE_NOTIFICATIONS
+    notificationManager_->addRawNotificationListener(listener);
+#else
+    throw KaaException("Failed to add raw notification listener. Notification subsystem is disabled");
+#endif
+}
+
+void KaaClient::addRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) {
+#ifdef KAA_USE_NOTIFICATIONS
+    notificationManager_->addRawNotificationListener(topicId, listener);
+#else
+    throw KaaException("Failed to add raw notification listener. Notification subsystem is disabled");
+#endif
+}
+
+void KaaClient::removeRawNotificationListener(IRawNotificationListener& listener) {
+#ifdef KAA_USE_NOTIFICATIONS
+    notificationManager_->removeRawNotificationListener(listener);
+#else
+    throw KaaException("Failed to remove raw notification listener. Notification subsystem is disabled");
+#endif
+}
+
+void KaaClient::removeRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) {
+#ifdef KAA_USE_NOTIFICATIONS
+    notificationManager_->removeRawNotificationListener(topicId, listener);
+#else
+    throw KaaException("Failed to remove raw notification listener. Notification subsystem is disabled");
+#endif
+}
+
 void KaaClient::subscribeToTopic(std::int64_t id, bool forceSync) {
 #ifdef KAA_USE_NOTIFICATIONS
     checkClientState(State::STARTED, "Kaa client isn't started");
@@ -482,6 +574,26 @@ void KaaClient::detachEndpoint(const std::string&  endpointKeyHash
 #endif
 }
 
+void KaaClient::attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                               , IAttachEndpointsCallbackPtr listener) {
+#ifdef KAA_USE_EVENTS
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    registrationManager_->attachEndpoints(endpointAccessTokens, listener);
+#else
+    throw KaaException("Failed to attach endpoints. Event subsystem is disabled");
+#endif
+}
+
+void KaaClient::detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                               , IDetachEndpointsCallbackPtr listener) {
+#ifdef KAA_USE_EVENTS
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    registrationManager_->detachEndpoints(endpointKeyHashes, listener);
+#else
+    throw KaaException("Failed to detach endpoints. Event subsystem is disabled");
+#endif
+}
+
 void KaaClient::attachUser(const std::string& userExternalId, const std::string& userAccessToken
                           , IUserAttachCallbackPtr listener) {
 #ifdef KAA_USE_EVENTS
@@ -528,6 +640,15 @@ EventFamilyFactory& KaaClient::getEventFamilyFactory()
 #endif
 }
 
+IEventManager& KaaClient::getEventManager()
+{
+#ifdef KAA_USE_EVENTS
+    return *eventManager_;
+#else
+    throw KaaException("Failed to retrieve EventManager. Event subsystem is disabled");
+#endif
+}
+
 std::int32_t KaaClient::findEventListeners(const std::list<std::string>& eventFQNs, IFetchEventListenersPtr listener)
 {
 #ifdef KAA_USE_EVENTS
@@ -537,11 +658,122 @@ std::int32_t KaaClient::findEventListeners(const std::list<std::string>& eventFQ
     throw KaaException("Failed to find event listeners. Event subsystem is disabled");
 #endif
 }
+
+void KaaClient::setEventBatchingSettings(const EventBatchingSettings& settings)
+{
+#ifdef KAA_USE_EVENTS
+    eventManager_->setBatchingSettings(settings);
+#else
+    throw KaaException("Failed to set event batching settings. Event subsystem is disabled");
+#endif
+}
+
+void KaaClient::setEventStorage(ILogStoragePtr storage, std::size_t maxResidentEvents)
+{
+#ifdef KAA_USE_EVENTS
+    eventManager_->setEventStorage(storage, maxResidentEvents);
+#else
+    throw KaaException("Failed to set event storage. Event subsystem is disabled");
+#endif
+}
+
 IKaaChannelManager& KaaClient::getChannelManager()
 {
     return *channelManager_;
 }
 
+KaaClientMetrics KaaClient::getMetrics()
+{
+    KaaClientMetrics metrics = channelManager_->getMetrics();
+    metrics.skippedProfileUpdates_ = profileManager_->getSkippedUpdatesCount();
+    return metrics;
+}
+
+void KaaClient::setTransportRateLimit(TransportType type, const TransportRateLimit& limit)
+{
+    if (type != TransportType::EVENT && type != TransportType::LOGGING) {
+        throw KaaException("Only event and logging transports may be rate-limited");
+    }
+
+    auto shaper = channelManager_->getBandwidthShaper();
+    shaper->setRateLimit(type, limit);
+
+#ifdef KAA_USE_LOGGING
+    if (type == TransportType::LOGGING) {
+        logCollector_->setMaxBucketSize(shaper->getBurstBytes(type));
+    }
+#endif
+}
+
+MemoryUsage KaaClient::getMemoryUsage()
+{
+    MemoryUsage usage;
+#ifdef KAA_USE_LOGGING
+    usage.logStorage_ = logCollector_->getStorageMemoryUsage();
+#endif
+#ifdef KAA_USE_EVENTS
+    usage.pendingEvents_ = eventManager_->getPendingEventsVolume();
+#endif
+#ifdef KAA_USE_NOTIFICATIONS
+    usage.notifications_ = notificationManager_->getPendingNotificationsVolume();
+#endif
+    usage.channelBuffers_ = channelManager_->getMetrics().total_.bufferedBytes_;
+
+    /*
+     * Task closures aren't measurable, so a task is estimated by its wrapper and a couple of captures.
+     * Executors may be shared, e.g. by the polling executor context, so each is counted once.
+     */
+    auto& executorContext = context_.getExecutorContext();
+    IThreadPool *executors[] = { &executorContext.getLifeCycleExecutor(),
+                                 &executorContext.getApiExecutor(),
+                                 &executorContext.getCallbackExecutor() };
+    const std::size_t executorCount = sizeof(executors) / sizeof(executors[0]);
+    for (std::size_t i = 0; i < executorCount; ++i) {
+        if (std::find(executors, executors + i, executors[i]) == executors + i) {
+            usage.executorQueues_ += executors[i]->getQueueMetrics().queueDepth_
+                                     * (sizeof(ThreadPoolTask) + 2 * sizeof(void *));
+        }
+    }
+
+    return usage;
+}
+
+void KaaClient::startMemoryCheckTimer()
+{
+    memoryCheckTimer_.start(context_.getProperties().getMemoryCheckPeriod(), [this]
+        {
+            checkMemoryLimit();
+            startMemoryCheckTimer();
+        });
+}
+
+void KaaClient::checkMemoryLimit()
+{
+    const std::size_t limit = context_.getProperties().getMemorySoftLimit();
+    const MemoryUsage usage = getMemoryUsage();
+    const std::size_t total = usage.getTotal();
+
+    if (total <= limit) {
+        return;
+    }
+
+    KAA_LOG_WARN(boost::format("Memory usage %1% bytes exceeds the soft limit %2% bytes "
+                               "[logs %3%, events %4%, notifications %5%, channels %6%, executors %7%]")
+                 % total % limit % usage.logStorage_ % usage.pendingEvents_ % usage.notifications_
+                 % usage.channelBuffers_ % usage.executorQueues_);
+
+#ifdef KAA_USE_LOGGING
+    /*
+     * Log records are the only data which can be dropped without breaking the protocol state.
+     */
+    const std::size_t excess = total - limit;
+    const std::size_t allowedVolume = usage.logStorage_ > excess ? usage.logStorage_ - excess : 0;
+    if (!logCollector_->releaseStorageMemory(allowedVolume)) {
+        KAA_LOG_WARN("Log storage doesn't support releasing memory");
+    }
+#endif
+}
+
 const KeyPair& KaaClient::getClientKeyPair()
 {
     return *clientKeys_;
@@ -569,10 +801,45 @@ std::string KaaClient::getEndpointKeyHash() const
 }
 
 RecordFuture KaaClient::addLogRecord(const KaaUserLogRecord& record)
+{
+    return addLogRecord(record, LogPriority::NORMAL);
+}
+
+RecordFuture KaaClient::addLogRecord(const KaaUserLogRecord& record, LogPriority priority)
 {
 #ifdef KAA_USE_LOGGING
     checkClientState(State::STARTED, "Kaa client isn't started");
-    return logCollector_->addLogRecord(record);
+    return logCollector_->addLogRecord(record, priority);
+#else
+    throw KaaException("Failed to add log record. Logging subsystem is disabled");
+#endif
+}
+
+void KaaClient::addLogRecordWithoutFuture(const KaaUserLogRecord& record)
+{
+    addLogRecordWithoutFuture(record, LogPriority::NORMAL);
+}
+
+void KaaClient::addLogRecordWithoutFuture(const KaaUserLogRecord& record, LogPriority priority)
+{
+#ifdef KAA_USE_LOGGING
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    logCollector_->addLogRecordWithoutFuture(record, priority);
+#else
+    throw KaaException("Failed to add log record. Logging subsystem is disabled");
+#endif
+}
+
+void KaaClient::addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record)
+{
+    addLogRecord(batch, record, LogPriority::NORMAL);
+}
+
+void KaaClient::addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record, LogPriority priority)
+{
+#ifdef KAA_USE_LOGGING
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    logCollector_->addLogRecord(batch, record, priority);
 #else
     throw KaaException("Failed to add log record. Logging subsystem is disabled");
 #endif
@@ -617,6 +884,17 @@ void KaaClient::setFailoverStrategy(IFailoverStrategyPtr strategy)
     channelManager_->setFailoverStrategy(failoverStrategy_);
 }
 
+void KaaClient::setServerSelectionStrategy(IServerSelectionStrategyPtr strategy)
+{
+    if (!strategy) {
+        KAA_LOG_ERROR("Failed to set server selection strategy: bad data");
+        throw KaaException("Bad server selection strategy");
+    }
+
+    KAA_LOG_INFO("New server selection strategy was set");
+    bootstrapManager_->setServerSelectionStrategy(strategy);
+}
+
 IKaaDataMultiplexer& KaaClient::getOperationMultiplexer()
 {
     return *syncProcessor_;
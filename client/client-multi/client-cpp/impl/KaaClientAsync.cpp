@@ -0,0 +1,183 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/KaaClientAsync.hpp"
+
+#include "kaa/common/exception/UserAttachException.hpp"
+
+namespace kaa {
+
+class PromisedUserAttachCallback : public IUserAttachCallback {
+public:
+    virtual void onAttachSuccess()
+    {
+        promise_.setValue();
+    }
+
+    virtual void onAttachFailed(UserAttachErrorCode errorCode, const std::string& reason)
+    {
+        promise_.setException(std::make_exception_ptr(UserAttachException(errorCode, reason)));
+    }
+
+    KaaFuture<void> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<void> promise_;
+};
+
+class PromisedAttachEndpointCallback : public IAttachEndpointCallback {
+public:
+    virtual void onAttachSuccess(const std::string& endpointKeyHash)
+    {
+        promise_.setValue(endpointKeyHash);
+    }
+
+    virtual void onAttachFailed()
+    {
+        promise_.setException(std::make_exception_ptr(KaaException("Failed to attach endpoint")));
+    }
+
+    KaaFuture<std::string> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<std::string> promise_;
+};
+
+class PromisedDetachEndpointCallback : public IDetachEndpointCallback {
+public:
+    virtual void onDetachSuccess()
+    {
+        promise_.setValue();
+    }
+
+    virtual void onDetachFailed()
+    {
+        promise_.setException(std::make_exception_ptr(KaaException("Failed to detach endpoint")));
+    }
+
+    KaaFuture<void> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<void> promise_;
+};
+
+class PromisedAttachEndpointsCallback : public IAttachEndpointsCallback {
+public:
+    virtual void onAttachCompleted(const std::vector<EndpointAttachResult>& results)
+    {
+        promise_.setValue(results);
+    }
+
+    KaaFuture<std::vector<EndpointAttachResult>> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<std::vector<EndpointAttachResult>> promise_;
+};
+
+class PromisedDetachEndpointsCallback : public IDetachEndpointsCallback {
+public:
+    virtual void onDetachCompleted(const std::vector<EndpointDetachResult>& results)
+    {
+        promise_.setValue(results);
+    }
+
+    KaaFuture<std::vector<EndpointDetachResult>> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<std::vector<EndpointDetachResult>> promise_;
+};
+
+class PromisedFetchEventListeners : public IFetchEventListeners {
+public:
+    virtual void onEventListenersReceived(const std::vector<std::string>& eventListeners)
+    {
+        promise_.setValue(eventListeners);
+    }
+
+    virtual void onRequestFailed()
+    {
+        promise_.setException(std::make_exception_ptr(KaaException("Failed to find event listeners")));
+    }
+
+    KaaFuture<std::vector<std::string>> getFuture() const { return promise_.getFuture(); }
+
+private:
+    KaaPromise<std::vector<std::string>> promise_;
+};
+
+KaaFuture<void> attachUserAsync(IKaaClient& client, const std::string& userExternalId, const std::string& userAccessToken)
+{
+    auto callback = std::make_shared<PromisedUserAttachCallback>();
+    client.attachUser(userExternalId, userAccessToken, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<void> attachUserAsync(IKaaClient& client, const std::string& userExternalId, const std::string& userAccessToken,
+                                const std::string& userVerifierToken)
+{
+    auto callback = std::make_shared<PromisedUserAttachCallback>();
+    client.attachUser(userExternalId, userAccessToken, userVerifierToken, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<std::string> attachEndpointAsync(IKaaClient& client, const std::string& endpointAccessToken)
+{
+    auto callback = std::make_shared<PromisedAttachEndpointCallback>();
+    client.attachEndpoint(endpointAccessToken, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<void> detachEndpointAsync(IKaaClient& client, const std::string& endpointKeyHash)
+{
+    auto callback = std::make_shared<PromisedDetachEndpointCallback>();
+    client.detachEndpoint(endpointKeyHash, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<std::vector<EndpointAttachResult>> attachEndpointsAsync(IKaaClient& client,
+                                                                  const std::vector<std::string>& endpointAccessTokens)
+{
+    auto callback = std::make_shared<PromisedAttachEndpointsCallback>();
+    client.attachEndpoints(endpointAccessTokens, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<std::vector<EndpointDetachResult>> detachEndpointsAsync(IKaaClient& client,
+                                                                  const std::vector<std::string>& endpointKeyHashes)
+{
+    auto callback = std::make_shared<PromisedDetachEndpointsCallback>();
+    client.detachEndpoints(endpointKeyHashes, callback);
+    return callback->getFuture();
+}
+
+KaaFuture<std::vector<std::string>> findEventListenersAsync(IKaaClient& client, const std::list<std::string>& eventFQNs)
+{
+    auto listener = std::make_shared<PromisedFetchEventListeners>();
+    client.findEventListeners(eventFQNs, listener);
+    return listener->getFuture();
+}
+
+KaaFuture<RecordInfo> addLogRecordAsync(IKaaClient& client, const KaaUserLogRecord& record)
+{
+    return client.addLogRecord(record).getFuture();
+}
+
+KaaFuture<RecordInfo> addLogRecordAsync(IKaaClient& client, const KaaUserLogRecord& record, LogPriority priority)
+{
+    return client.addLogRecord(record, priority).getFuture();
+}
+
+} /* namespace kaa */
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/KaaClientHost.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+
+#include "kaa/Kaa.hpp"
+#include "kaa/KaaClientPlatformContext.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/context/PollingExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+KaaClientHost::KaaClientHost(const KaaClientProperties& properties,
+                             IExecutorContextPtr executorContext,
+                             IoServicePoolPtr ioServicePool)
+    : properties_(properties), executorContext_(executorContext), ioServicePool_(ioServicePool)
+{
+    if (!executorContext_) {
+#ifdef KAA_USE_SINGLE_THREAD
+        auto pollingContext = std::make_shared<PollingExecutorContext>();
+        if (!ioServicePool_) {
+            ioServicePool_ = pollingContext->getIoServicePool();
+        }
+        executorContext_ = pollingContext;
+#else
+        executorContext_ = std::make_shared<SimpleExecutorContext>();
+#endif
+    }
+
+    if (!ioServicePool_) {
+        ioServicePool_ = std::make_shared<IoServicePool>();
+    }
+}
+
+KaaClientHost::~KaaClientHost()
+{
+    try {
+        stopAll();
+    } catch (...) {
+    }
+}
+
+std::shared_ptr<IKaaClient> KaaClientHost::addEndpoint(const std::string& endpointName,
+                                                       KaaClientStateListenerPtr listener)
+{
+    if (endpointName.empty() || endpointName == "." || endpointName == ".." ||
+            endpointName.find('/') != std::string::npos) {
+        throw KaaException(boost::format("Invalid endpoint name '%s'") % endpointName);
+    }
+
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    if (endpoints_.count(endpointName)) {
+        throw KaaException(boost::format("Endpoint '%s' already exists") % endpointName);
+    }
+
+    std::string workingDirectory = properties_.getWorkingDirectoryPath();
+    if (!workingDirectory.empty() && workingDirectory.back() != '/') {
+        workingDirectory += '/';
+    }
+    workingDirectory += endpointName + "/";
+
+    if (mkdir(workingDirectory.c_str(), 0755) && errno != EEXIST) {
+        throw KaaException(boost::format("Failed to create working directory '%s' of endpoint: %s")
+                                                            % workingDirectory % std::strerror(errno));
+    }
+
+    KaaClientProperties endpointProperties(properties_);
+    endpointProperties.setWorkingDirectoryPath(workingDirectory);
+
+    auto platformContext = std::make_shared<KaaClientPlatformContext>(endpointProperties,
+                                                                      executorContext_,
+                                                                      ioServicePool_);
+    auto client = Kaa::newClient(platformContext, listener);
+
+    if (logStorageFactory_) {
+        auto storage = logStorageFactory_(endpointName, *client);
+        if (storage) {
+            client->setLogStorage(storage);
+        }
+    }
+
+    endpoints_[endpointName].client_ = client;
+    return client;
+}
+
+bool KaaClientHost::removeEndpoint(const std::string& endpointName)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    auto it = endpoints_.find(endpointName);
+    if (it == endpoints_.end()) {
+        return false;
+    }
+
+    stopEndpoint(it->second);
+    endpoints_.erase(it);
+    return true;
+}
+
+std::shared_ptr<IKaaClient> KaaClientHost::getClient(const std::string& endpointName)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    auto it = endpoints_.find(endpointName);
+    return (it != endpoints_.end() ? it->second.client_ : std::shared_ptr<IKaaClient>());
+}
+
+std::vector<std::string> KaaClientHost::getEndpointNames()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    std::vector<std::string> names;
+    names.reserve(endpoints_.size());
+    for (const auto& endpoint : endpoints_) {
+        names.push_back(endpoint.first);
+    }
+
+    return names;
+}
+
+std::size_t KaaClientHost::getEndpointCount()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    return endpoints_.size();
+}
+
+void KaaClientHost::startAll()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    for (auto& endpoint : endpoints_) {
+        if (!endpoint.second.isStarted_) {
+            endpoint.second.client_->start();
+            endpoint.second.isStarted_ = true;
+        }
+    }
+}
+
+void KaaClientHost::stopAll()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    for (auto& endpoint : endpoints_) {
+        stopEndpoint(endpoint.second);
+    }
+}
+
+void KaaClientHost::setLogStorageFactory(const LogStorageFactory& factory)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(endpointsLock, endpointsGuard_);
+
+    logStorageFactory_ = factory;
+}
+
+void KaaClientHost::stopEndpoint(Endpoint& endpoint)
+{
+    if (!endpoint.isStarted_) {
+        return;
+    }
+
+    endpoint.isStarted_ = false;
+    try {
+        endpoint.client_->stop();
+    } catch (KaaException&) {
+        /*
+         * The client may be stopped by the application bypassing the host.
+         */
+    }
+}
+
+} /* namespace kaa */
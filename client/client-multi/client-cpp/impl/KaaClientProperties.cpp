@@ -16,6 +16,9 @@
 
 #include "kaa/KaaClientProperties.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
 #include <sstream>
 
 #include "kaa/KaaDefaults.hpp"
@@ -38,6 +41,25 @@ const std::string KaaClientProperties::PROP_LOGS_DB = "kaa.logs.db_file";
 const std::string KaaClientProperties::PROP_CONF_FILE = "kaa.conf.file";
 const std::string KaaClientProperties::PROP_CLIENT_ID = "kaa.conf.client_id";
 const std::string KaaClientProperties::PROP_LOG_FILE_NAME = "kaa.log.file.name";
+const std::string KaaClientProperties::PROP_STATE_FILE_FORMAT = "kaa.state.format";
+const std::string KaaClientProperties::PROP_STATE_SAVE_DELAY = "kaa.state.save_delay";
+const std::string KaaClientProperties::PROP_LOG_QUEUE_CAPACITY = "kaa.log.async.queue_capacity";
+const std::string KaaClientProperties::PROP_LOG_LEVEL = "kaa.log.level";
+const std::string KaaClientProperties::PROP_FAST_START = "kaa.start.fast";
+const std::string KaaClientProperties::PROP_WARM_PAUSE = "kaa.pause.warm";
+const std::string KaaClientProperties::PROP_OPERATIONS_SERVERS_TTL = "kaa.bootstrap.servers_ttl";
+const std::string KaaClientProperties::PROP_EVENT_LISTENERS_CACHE_TTL = "kaa.event.listeners_cache_ttl";
+const std::string KaaClientProperties::PROP_FAILOVER_BACKOFF = "kaa.failover.backoff";
+const std::string KaaClientProperties::PROP_FAILOVER_BACKOFF_BASE = "kaa.failover.backoff.base";
+const std::string KaaClientProperties::PROP_FAILOVER_BACKOFF_MAX = "kaa.failover.backoff.max";
+const std::string KaaClientProperties::PROP_MEMORY_SOFT_LIMIT = "kaa.memory.soft_limit";
+const std::string KaaClientProperties::PROP_MEMORY_CHECK_PERIOD = "kaa.memory.check_period";
+const std::string KaaClientProperties::PROP_TCP_NO_DELAY = "kaa.tcp.no_delay";
+const std::string KaaClientProperties::PROP_TCP_KEEPALIVE_IDLE = "kaa.tcp.keepalive.idle";
+const std::string KaaClientProperties::PROP_TCP_KEEPALIVE_INTERVAL = "kaa.tcp.keepalive.interval";
+const std::string KaaClientProperties::PROP_TCP_KEEPALIVE_COUNT = "kaa.tcp.keepalive.count";
+const std::string KaaClientProperties::PROP_TCP_SEND_BUFFER = "kaa.tcp.send_buffer";
+const std::string KaaClientProperties::PROP_TCP_RECEIVE_BUFFER = "kaa.tcp.receive_buffer";
 
 const std::string KaaClientProperties::DEFAULT_WORKING_DIR = std::string(".") + DIRECTORY_SEPARATOR;
 const std::string KaaClientProperties::DEFAULT_STATE_FILE = CLIENT_STATUS_FILE_LOCATION;
@@ -47,6 +69,24 @@ const std::string KaaClientProperties::DEFAULT_LOGS_DB = "logs.db";
 const std::string KaaClientProperties::DEFAULT_CONF_FILE = "configuration.bin";
 const std::string KaaClientProperties::DEFAULT_CLIENT_ID = "client_";
 const std::string KaaClientProperties::DEFAULT_LOG_FILE_NAME = "";
+const std::string KaaClientProperties::DEFAULT_STATE_FILE_FORMAT = "text";
+const std::string KaaClientProperties::DEFAULT_STATE_SAVE_DELAY = "0";
+const std::string KaaClientProperties::DEFAULT_LOG_QUEUE_CAPACITY = "0";
+const std::string KaaClientProperties::DEFAULT_LOG_LEVEL = "trace";
+const std::string KaaClientProperties::DEFAULT_FAST_START = "false";
+const std::string KaaClientProperties::DEFAULT_WARM_PAUSE = "false";
+const std::string KaaClientProperties::DEFAULT_OPERATIONS_SERVERS_TTL = "86400";
+const std::string KaaClientProperties::DEFAULT_EVENT_LISTENERS_CACHE_TTL = "0";
+const std::string KaaClientProperties::DEFAULT_FAILOVER_BACKOFF = "false";
+const std::string KaaClientProperties::DEFAULT_FAILOVER_BACKOFF_BASE = "1";
+const std::string KaaClientProperties::DEFAULT_FAILOVER_BACKOFF_MAX = "300";
+const std::string KaaClientProperties::DEFAULT_MEMORY_SOFT_LIMIT = "0";
+const std::string KaaClientProperties::DEFAULT_MEMORY_CHECK_PERIOD = "5";
+const std::string KaaClientProperties::DEFAULT_TCP_NO_DELAY = "true";
+
+static const std::string BINARY_STATE_FILE_FORMAT = "binary";
+
+static const std::string LOG_LEVEL_NAMES[] = { "trace", "debug", "info", "warning", "error", "fatal" };
 
 static std::string getDefaultClientId()
 {
@@ -89,6 +129,20 @@ void KaaClientProperties::initByDefaults()
     properties_.insert(std::make_pair(PROP_CONF_FILE, DEFAULT_CONF_FILE));
     properties_.insert(std::make_pair(PROP_CLIENT_ID, getDefaultClientId()));
     properties_.insert(std::make_pair(PROP_LOG_FILE_NAME, DEFAULT_LOG_FILE_NAME));
+    properties_.insert(std::make_pair(PROP_STATE_FILE_FORMAT, DEFAULT_STATE_FILE_FORMAT));
+    properties_.insert(std::make_pair(PROP_STATE_SAVE_DELAY, DEFAULT_STATE_SAVE_DELAY));
+    properties_.insert(std::make_pair(PROP_LOG_QUEUE_CAPACITY, DEFAULT_LOG_QUEUE_CAPACITY));
+    properties_.insert(std::make_pair(PROP_LOG_LEVEL, DEFAULT_LOG_LEVEL));
+    properties_.insert(std::make_pair(PROP_FAST_START, DEFAULT_FAST_START));
+    properties_.insert(std::make_pair(PROP_WARM_PAUSE, DEFAULT_WARM_PAUSE));
+    properties_.insert(std::make_pair(PROP_OPERATIONS_SERVERS_TTL, DEFAULT_OPERATIONS_SERVERS_TTL));
+    properties_.insert(std::make_pair(PROP_EVENT_LISTENERS_CACHE_TTL, DEFAULT_EVENT_LISTENERS_CACHE_TTL));
+    properties_.insert(std::make_pair(PROP_FAILOVER_BACKOFF, DEFAULT_FAILOVER_BACKOFF));
+    properties_.insert(std::make_pair(PROP_FAILOVER_BACKOFF_BASE, DEFAULT_FAILOVER_BACKOFF_BASE));
+    properties_.insert(std::make_pair(PROP_FAILOVER_BACKOFF_MAX, DEFAULT_FAILOVER_BACKOFF_MAX));
+    properties_.insert(std::make_pair(PROP_MEMORY_SOFT_LIMIT, DEFAULT_MEMORY_SOFT_LIMIT));
+    properties_.insert(std::make_pair(PROP_MEMORY_CHECK_PERIOD, DEFAULT_MEMORY_CHECK_PERIOD));
+    properties_.insert(std::make_pair(PROP_TCP_NO_DELAY, DEFAULT_TCP_NO_DELAY));
 }
 
 void KaaClientProperties::setWorkingDirectoryPath(const std::string& path)
@@ -115,12 +169,195 @@ void KaaClientProperties::setLogFileName(const std::string& logFileName)
     setProperty(PROP_LOG_FILE_NAME, logFileName);
 }
 
+void KaaClientProperties::setFastStart(bool isEnabled)
+{
+    setProperty(PROP_FAST_START, isEnabled ? "true" : DEFAULT_FAST_START);
+}
+
+bool KaaClientProperties::isFastStart() const
+{
+    return getProperty(PROP_FAST_START, DEFAULT_FAST_START) == "true";
+}
+
+void KaaClientProperties::setWarmPause(bool isEnabled)
+{
+    setProperty(PROP_WARM_PAUSE, isEnabled ? "true" : DEFAULT_WARM_PAUSE);
+}
+
+bool KaaClientProperties::isWarmPause() const
+{
+    return getProperty(PROP_WARM_PAUSE, DEFAULT_WARM_PAUSE) == "true";
+}
+
+void KaaClientProperties::setOperationsServersTtl(std::chrono::seconds ttl)
+{
+    setProperty(PROP_OPERATIONS_SERVERS_TTL, std::to_string(std::max(ttl.count(), std::chrono::seconds::rep())));
+}
+
+std::chrono::seconds KaaClientProperties::getOperationsServersTtl() const
+{
+    std::int64_t ttl = 0;
+    std::istringstream(getProperty(PROP_OPERATIONS_SERVERS_TTL, DEFAULT_OPERATIONS_SERVERS_TTL)) >> ttl;
+    return std::chrono::seconds(std::max<std::int64_t>(ttl, 0));
+}
+
+void KaaClientProperties::setEventListenersCacheTtl(std::chrono::seconds ttl)
+{
+    setProperty(PROP_EVENT_LISTENERS_CACHE_TTL, std::to_string(std::max(ttl.count(), std::chrono::seconds::rep())));
+}
+
+std::chrono::seconds KaaClientProperties::getEventListenersCacheTtl() const
+{
+    std::int64_t ttl = 0;
+    std::istringstream(getProperty(PROP_EVENT_LISTENERS_CACHE_TTL, DEFAULT_EVENT_LISTENERS_CACHE_TTL)) >> ttl;
+    return std::chrono::seconds(std::max<std::int64_t>(ttl, 0));
+}
+
+void KaaClientProperties::setFailoverBackoff(bool isEnabled)
+{
+    setProperty(PROP_FAILOVER_BACKOFF, isEnabled ? "true" : DEFAULT_FAILOVER_BACKOFF);
+}
+
+bool KaaClientProperties::isFailoverBackoff() const
+{
+    return getProperty(PROP_FAILOVER_BACKOFF, DEFAULT_FAILOVER_BACKOFF) == "true";
+}
+
+void KaaClientProperties::setFailoverBackoffBase(std::chrono::seconds period)
+{
+    setProperty(PROP_FAILOVER_BACKOFF_BASE, std::to_string(std::max<std::chrono::seconds::rep>(period.count(), 1)));
+}
+
+std::chrono::seconds KaaClientProperties::getFailoverBackoffBase() const
+{
+    std::int64_t period = 0;
+    std::istringstream(getProperty(PROP_FAILOVER_BACKOFF_BASE, DEFAULT_FAILOVER_BACKOFF_BASE)) >> period;
+    return std::chrono::seconds(std::max<std::int64_t>(period, 1));
+}
+
+void KaaClientProperties::setFailoverBackoffMax(std::chrono::seconds period)
+{
+    setProperty(PROP_FAILOVER_BACKOFF_MAX, std::to_string(std::max<std::chrono::seconds::rep>(period.count(), 1)));
+}
+
+std::chrono::seconds KaaClientProperties::getFailoverBackoffMax() const
+{
+    std::int64_t period = 0;
+    std::istringstream(getProperty(PROP_FAILOVER_BACKOFF_MAX, DEFAULT_FAILOVER_BACKOFF_MAX)) >> period;
+    return std::max(std::chrono::seconds(period), getFailoverBackoffBase());
+}
+
+void KaaClientProperties::setMemorySoftLimit(std::size_t bytes)
+{
+    setProperty(PROP_MEMORY_SOFT_LIMIT, std::to_string(bytes));
+}
+
+std::size_t KaaClientProperties::getMemorySoftLimit() const
+{
+    std::size_t bytes = 0;
+    std::istringstream(getProperty(PROP_MEMORY_SOFT_LIMIT, DEFAULT_MEMORY_SOFT_LIMIT)) >> bytes;
+    return bytes;
+}
+
+void KaaClientProperties::setMemoryCheckPeriod(std::chrono::seconds period)
+{
+    setProperty(PROP_MEMORY_CHECK_PERIOD, std::to_string(std::max<std::chrono::seconds::rep>(period.count(), 1)));
+}
+
+std::chrono::seconds KaaClientProperties::getMemoryCheckPeriod() const
+{
+    std::int64_t period = 0;
+    std::istringstream(getProperty(PROP_MEMORY_CHECK_PERIOD, DEFAULT_MEMORY_CHECK_PERIOD)) >> period;
+    return std::chrono::seconds(std::max<std::int64_t>(period, 1));
+}
+
+void KaaClientProperties::setTcpSocketOptions(const TcpSocketOptions& options)
+{
+    setProperty(PROP_TCP_NO_DELAY, options.noDelay ? DEFAULT_TCP_NO_DELAY : "false");
+    setProperty(PROP_TCP_KEEPALIVE_IDLE, std::to_string(std::max<std::int64_t>(options.keepAliveIdle.count(), 0)));
+    setProperty(PROP_TCP_KEEPALIVE_INTERVAL, std::to_string(std::max<std::int64_t>(options.keepAliveInterval.count(), 0)));
+    setProperty(PROP_TCP_KEEPALIVE_COUNT, std::to_string(options.keepAliveCount));
+    setProperty(PROP_TCP_SEND_BUFFER, std::to_string(options.sendBufferSize));
+    setProperty(PROP_TCP_RECEIVE_BUFFER, std::to_string(options.receiveBufferSize));
+}
+
+TcpSocketOptions KaaClientProperties::getTcpSocketOptions() const
+{
+    TcpSocketOptions options;
+    std::int64_t seconds = 0;
+
+    options.noDelay = getProperty(PROP_TCP_NO_DELAY, DEFAULT_TCP_NO_DELAY) == "true";
+    std::istringstream(getProperty(PROP_TCP_KEEPALIVE_IDLE, "0")) >> seconds;
+    options.keepAliveIdle = std::chrono::seconds(std::max<std::int64_t>(seconds, 0));
+    seconds = 0;
+    std::istringstream(getProperty(PROP_TCP_KEEPALIVE_INTERVAL, "0")) >> seconds;
+    options.keepAliveInterval = std::chrono::seconds(std::max<std::int64_t>(seconds, 0));
+    std::istringstream(getProperty(PROP_TCP_KEEPALIVE_COUNT, "0")) >> options.keepAliveCount;
+    std::istringstream(getProperty(PROP_TCP_SEND_BUFFER, "0")) >> options.sendBufferSize;
+    std::istringstream(getProperty(PROP_TCP_RECEIVE_BUFFER, "0")) >> options.receiveBufferSize;
+
+    return options;
+}
+
+void KaaClientProperties::setLogLevel(LogLevel level)
+{
+    setProperty(PROP_LOG_LEVEL, LOG_LEVEL_NAMES[static_cast<std::size_t>(level)]);
+}
+
+LogLevel KaaClientProperties::getLogLevel() const
+{
+    const std::string name = getProperty(PROP_LOG_LEVEL, DEFAULT_LOG_LEVEL);
+
+    auto it = std::find(std::begin(LOG_LEVEL_NAMES), std::end(LOG_LEVEL_NAMES), name);
+    if (it == std::end(LOG_LEVEL_NAMES)) {
+        return LogLevel::KAA_TRACE;
+    }
+
+    return static_cast<LogLevel>(it - std::begin(LOG_LEVEL_NAMES));
+}
+
+void KaaClientProperties::setAsyncLogQueueCapacity(std::size_t capacity)
+{
+    setProperty(PROP_LOG_QUEUE_CAPACITY, std::to_string(capacity));
+}
+
+std::size_t KaaClientProperties::getAsyncLogQueueCapacity() const
+{
+    std::size_t capacity = 0;
+    std::istringstream(getProperty(PROP_LOG_QUEUE_CAPACITY, DEFAULT_LOG_QUEUE_CAPACITY)) >> capacity;
+    return capacity;
+}
+
 void KaaClientProperties::setStateFileName(const std::string& fileName)
 {
     checkEmptyness(fileName, "Empty value of state file name");
     setProperty(PROP_STATE_FILE, fileName);
 }
 
+void KaaClientProperties::setStateFileFormat(StateFileFormat format)
+{
+    setProperty(PROP_STATE_FILE_FORMAT, format == StateFileFormat::BINARY ? BINARY_STATE_FILE_FORMAT
+                                                                          : DEFAULT_STATE_FILE_FORMAT);
+}
+
+StateFileFormat KaaClientProperties::getStateFileFormat() const
+{
+    return getProperty(PROP_STATE_FILE_FORMAT, DEFAULT_STATE_FILE_FORMAT) == BINARY_STATE_FILE_FORMAT ?
+            StateFileFormat::BINARY : StateFileFormat::TEXT;
+}
+
+void KaaClientProperties::setStateSaveDelay(std::chrono::milliseconds delay)
+{
+    setProperty(PROP_STATE_SAVE_DELAY, std::to_string(std::max(delay.count(), std::chrono::milliseconds::rep())));
+}
+
+std::chrono::milliseconds KaaClientProperties::getStateSaveDelay() const
+{
+    std::int64_t delay = 0;
+    std::istringstream(getProperty(PROP_STATE_SAVE_DELAY, DEFAULT_STATE_SAVE_DELAY)) >> delay;
+    return std::chrono::milliseconds(std::max<std::int64_t>(delay, 0));
+}
+
 void KaaClientProperties::setPublicKeyFileName(const std::string& fileName)
 {
     checkEmptyness(fileName, "Empty value of public key file name");
@@ -25,6 +25,7 @@
 #include <sstream>
 
 #include "kaa/channel/GenericTransportInfo.hpp"
+#include "kaa/utils/RandomGenerator.hpp"
 
 namespace kaa {
 
@@ -66,7 +67,7 @@ const BootstrapServers& getBootstrapServers()
         listOfServers.push_back(createTransportInfo(0x929a2016, 0xfb9a3cf0, 1, "AAABJjCCASIwDQYJKoZIhvcNAQEBBQADggEPADCCAQoCggEBALPFnHKu3C/sPCp14y+LDR9pZky19eu4az9SuuvPXrb140akP6dkCstA8MBak9FoihYKf6oIAlmV+kh1We8uvpcMqHPWRSMZfn/1lQxE3wy/gtXwAP1GiMCgIS5UDW/sYRzPEpxKO6kN1hfF9AUaWu5mB7yCR+KTmTVY96WeXMiDbYkd0sBdPDUbT30JHZ4OSf9ZiPiGd8D2SEAe2vPyPdOT6p/w1Gx2HcWZ9CwE/qWSWQcgDGXQ+c8jTW/bPtcQK+UzWiRZAyvRM+WipCXBmqCNzDFLmuRiGFk+Tx+tqeVvI9XdjhicPRuF4GSqdUmmhRxpIWx8IfZbzoZhzILMisMCAwEAAQAAAAlsb2NhbGhvc3QAACah"));
 listOfServers.push_back(createTransportInfo(0x929a2016, 0x56c8ff92, 1, "AAABJjCCASIwDQYJKoZIhvcNAQEBBQADggEPADCCAQoCggEBALPFnHKu3C/sPCp14y+LDR9pZky19eu4az9SuuvPXrb140akP6dkCstA8MBak9FoihYKf6oIAlmV+kh1We8uvpcMqHPWRSMZfn/1lQxE3wy/gtXwAP1GiMCgIS5UDW/sYRzPEpxKO6kN1hfF9AUaWu5mB7yCR+KTmTVY96WeXMiDbYkd0sBdPDUbT30JHZ4OSf9ZiPiGd8D2SEAe2vPyPdOT6p/w1Gx2HcWZ9CwE/qWSWQcgDGXQ+c8jTW/bPtcQK+UzWiRZAyvRM+WipCXBmqCNzDFLmuRiGFk+Tx+tqeVvI9XdjhicPRuF4GSqdUmmhRxpIWx8IfZbzoZhzILMisMCAwEAAQAAAAlsb2NhbGhvc3QAACag"));
 ;
-        std::random_shuffle(listOfServers.begin(), listOfServers.end());
+        std::shuffle(listOfServers.begin(), listOfServers.end(), RandomGenerator::getThreadGenerator());
     }
     return listOfServers;
 }
@@ -79,23 +80,23 @@ const Botan::secure_vector<std::uint8_t>& getDefaultConfigData()
 
 HashDigest getPropertiesHash()
 {
-    std::ostringstream ss;
+    EndpointObjectHash hash;
 
-    ss << SDK_TOKEN;
-    ss << POLLING_PERIOD_SECONDS;
-    ss << CLIENT_PUB_KEY_LOCATION;
-    ss << CLIENT_PRIV_KEY_LOCATION;
-    ss << CLIENT_STATUS_FILE_LOCATION;
+    hash.update(SDK_TOKEN);
+    hash.update(std::to_string(POLLING_PERIOD_SECONDS));
+    hash.update(CLIENT_PUB_KEY_LOCATION);
+    hash.update(CLIENT_PRIV_KEY_LOCATION);
+    hash.update(CLIENT_STATUS_FILE_LOCATION);
 
     for (const auto& server : getBootstrapServers()) {
         const auto& connectionInfo = server->getConnectionInfo();
-        ss.write(reinterpret_cast<const char*>(connectionInfo.data()), connectionInfo.size());
+        hash.update(connectionInfo.data(), connectionInfo.size());
     }
 
-    ss.write(reinterpret_cast<const char*>(
-            getDefaultConfigData().data()), getDefaultConfigData().size());
+    hash.update(getDefaultConfigData().data(), getDefaultConfigData().size());
+    hash.finalize();
 
-    return EndpointObjectHash(ss.str()).getHashDigest();
+    return hash.getHashDigest();
 }
 
 }
@@ -21,20 +21,138 @@
 #include <cstdint>
 #include <algorithm>
 #include <random>
+#include <sstream>
 
 #include "kaa/IKaaClient.hpp"
 #include "kaa/KaaDefaults.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/common/exception/KaaException.hpp"
+#include "kaa/utils/RandomGenerator.hpp"
 
 namespace kaa {
 
+/*
+ * Spreads the refresh of saved operations servers by many endpoints restarted at once.
+ */
+static const std::size_t MAX_REFRESH_DELAY = 60; // in seconds
+
+/*
+ * Saved operations servers: "<save time>@" followed by
+ * "<access point id>:<protocol id>:<protocol version>:<hex connection info>" entries separated by ';'.
+ * The save time is in seconds since the epoch.
+ */
+static std::string encodeOperationsServers(const std::vector<ProtocolMetaData>& operationsServers, std::time_t saveTime)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    std::string encoded = std::to_string(static_cast<std::int64_t>(saveTime)) + '@';
+    bool isFirst = true;
+    for (const auto& server : operationsServers) {
+        if (!isFirst) {
+            encoded += ';';
+        }
+        isFirst = false;
+
+        encoded += std::to_string(server.accessPointId) + ':' +
+                   std::to_string(server.protocolVersionInfo.id) + ':' +
+                   std::to_string(server.protocolVersionInfo.version) + ':';
+
+        for (std::uint8_t byte : server.connectionInfo) {
+            encoded += HEX_DIGITS[byte >> 4];
+            encoded += HEX_DIGITS[byte & 0x0F];
+        }
+    }
+
+    return encoded;
+}
+
+static int hexDigitValue(char digit)
+{
+    if (digit >= '0' && digit <= '9') {
+        return digit - '0';
+    }
+    if (digit >= 'a' && digit <= 'f') {
+        return digit - 'a' + 10;
+    }
+    return -1;
+}
+
+static bool decodeOperationsServers(const std::string& encoded, std::vector<ProtocolMetaData>& operationsServers,
+                                    std::time_t& saveTime)
+{
+    std::istringstream stream(encoded);
+    std::int64_t time = 0;
+    char timeSeparator = 0;
+
+    stream >> time >> timeSeparator;
+    if (!stream || timeSeparator != '@') {
+        return false;
+    }
+    saveTime = static_cast<std::time_t>(time);
+
+    std::string item;
+
+    while (std::getline(stream, item, ';')) {
+        std::istringstream itemStream(item);
+        ProtocolMetaData server;
+        char separators[3] = {};
+
+        itemStream >> server.accessPointId >> separators[0]
+                   >> server.protocolVersionInfo.id >> separators[1]
+                   >> server.protocolVersionInfo.version >> separators[2];
+
+        if (!itemStream || separators[0] != ':' || separators[1] != ':' || separators[2] != ':') {
+            return false;
+        }
+
+        std::string hex;
+        std::getline(itemStream, hex);
+        if (hex.empty() || hex.size() % 2) {
+            return false;
+        }
+
+        server.connectionInfo.reserve(hex.size() / 2);
+        for (std::size_t i = 0; i < hex.size(); i += 2) {
+            int high = hexDigitValue(hex[i]);
+            int low = hexDigitValue(hex[i + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            server.connectionInfo.push_back(static_cast<std::uint8_t>((high << 4) | low));
+        }
+
+        operationsServers.push_back(std::move(server));
+    }
+
+    return !operationsServers.empty();
+}
+
 void BootstrapManager::setFailoverStrategy(IFailoverStrategyPtr strategy)
 {
     failoverStrategy_ = strategy;
 }
 
+void BootstrapManager::setServerSelectionStrategy(IServerSelectionStrategyPtr strategy)
+{
+    if (!strategy) {
+        throw KaaException("Bad server selection strategy");
+    }
+
+    std::atomic_store(&selectionStrategy_, strategy);
+}
+
+void BootstrapManager::onOperationsServerRttMeasured(const ITransportConnectionInfo& server,
+                                                     std::chrono::microseconds rtt)
+{
+    std::atomic_load(&selectionStrategy_)->onServerRttMeasured(server, rtt);
+}
+
+std::map<std::int32_t, std::chrono::microseconds> BootstrapManager::getOperationsServerRtts()
+{
+    return std::atomic_load(&selectionStrategy_)->getServerRtts();
+}
+
 void BootstrapManager::receiveOperationsServerList()
 {
     if (bootstrapTransport_ != nullptr) {
@@ -42,6 +160,62 @@ void BootstrapManager::receiveOperationsServerList()
     }
 }
 
+bool BootstrapManager::useSavedOperationsServers()
+{
+    /*
+     * Servers saved with other SDK properties may belong to another Kaa installation.
+     */
+    if (context_.getStatus().isSDKPropertiesUpdated()) {
+        return false;
+    }
+
+    std::vector<ProtocolMetaData> operationsServers;
+    std::time_t saveTime = 0;
+    if (!decodeOperationsServers(context_.getStatus().getOperationsServers(), operationsServers, saveTime)) {
+        return false;
+    }
+
+    auto ttl = context_.getProperties().getOperationsServersTtl();
+    auto age = std::time(nullptr) - saveTime;
+    if (ttl.count() && (age < 0 || age > ttl.count())) {
+        KAA_LOG_INFO(boost::format("Saved operations services are expired: age %1% s, TTL %2% s") % age % ttl.count());
+        return false;
+    }
+
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, guard_);
+
+    KAA_LOG_INFO(boost::format("Using %1% saved operations services, bootstrap is skipped") % operationsServers.size());
+
+    isUsingSavedServers_ = true;
+    applyOperationsServers(operationsServers);
+
+    std::size_t refreshDelay = std::uniform_int_distribution<std::size_t>(0, MAX_REFRESH_DELAY)(
+                                        RandomGenerator::getThreadGenerator());
+
+    KAA_LOG_DEBUG(boost::format("Saved operations services will be refreshed in %1% seconds") % refreshDelay);
+
+    refreshTimer_.stop();
+    refreshTimer_.start(refreshDelay, [this] { refreshOperationsServers(); });
+    return true;
+}
+
+void BootstrapManager::refreshOperationsServers()
+{
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, guard_);
+
+    /*
+     * The list may already be requested because the saved servers have failed.
+     */
+    if (!isUsingSavedServers_ || !bootstrapTransport_) {
+        return;
+    }
+
+    KAA_LOG_INFO("Refreshing saved operations services");
+
+    isRefreshing_ = true;
+    bootstrapTransport_->sync();
+}
+
 BootstrapManager::OperationsServers BootstrapManager::getOPSByAccessPointId(std::int32_t id)
 {
     OperationsServers servers;
@@ -91,20 +265,55 @@ void BootstrapManager::onOperationsServerFailed(const TransportProtocolId& proto
         }
         case FailoverStrategyAction::USE_NEXT_OPERATIONS_SERVER:
         {
+            auto selectionStrategy = std::atomic_load(&selectionStrategy_);
+            selectionStrategy->onServerFailed(**(lastServerIt->second));
+
             OperationsServers::iterator nextOperationIterator = (lastServerIt->second) + 1;
             if (nextOperationIterator != serverIt->second.end()) {
+                /*
+                 * What is known about the servers not tried yet may have changed since the list was ordered.
+                 */
+                OperationsServers untriedServers(nextOperationIterator, serverIt->second.end());
+                selectionStrategy->orderServers(untriedServers);
+                std::copy(untriedServers.begin(), untriedServers.end(), nextOperationIterator);
+
                 KAA_LOG_INFO(boost::format("New Operations service [%1%] will be used for %2%")
                                            % (*nextOperationIterator)->getAccessPointId()
                                            % LoggingUtils::toString(protocolId));
 
                 lastOperationsServers_[protocolId] = nextOperationIterator;
 
-                channelManager_->onTransportConnectionInfoUpdated(*nextOperationIterator);
+                auto nextOperationsServer = *nextOperationIterator;
+                std::size_t period = decision.getRetryPeriod();
+
+                retryTimer_.stop();
+                if (period) {
+                    KAA_LOG_INFO(boost::format("Attempt to connect to new Operations service will be made in %1% seconds")
+                                                                                                             % period);
+                    retryTimer_.start(period,
+                                      [this, nextOperationsServer]
+                                           {
+                                                channelManager_->onTransportConnectionInfoUpdated(nextOperationsServer);
+                                           });
+                } else {
+                    channelManager_->onTransportConnectionInfoUpdated(nextOperationsServer);
+                }
             } else {
                 KAA_LOG_WARN(boost::format("No Operations services are accessible for %1%.")
                                                          % LoggingUtils::toString(protocolId));
 
-                onCurrentBootstrapServerFailed(KaaFailoverReason::ALL_OPERATIONS_SERVERS_NA);
+                if (isUsingSavedServers_) {
+                    /*
+                     * The saved servers are out of date, the Bootstrap service is asked for the current ones.
+                     */
+                    KAA_LOG_INFO("Requesting operations services from the Bootstrap service");
+                    isUsingSavedServers_ = false;
+                    isRefreshing_ = false;
+                    refreshTimer_.stop();
+                    bootstrapTransport_->sync();
+                } else {
+                    onCurrentBootstrapServerFailed(KaaFailoverReason::ALL_OPERATIONS_SERVERS_NA);
+                }
             }
             break;
         }
@@ -163,16 +372,45 @@ void BootstrapManager::onCurrentBootstrapServerFailed(KaaFailoverReason reason)
 
 void BootstrapManager::onServerListUpdated(const std::vector<ProtocolMetaData>& operationsServers)
 {
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, guard_);
+
+    bool isRefresh = isRefreshing_;
+    isRefreshing_ = false;
+
     if (operationsServers.empty()) {
         KAA_LOG_WARN("Received empty operations service list");
+        if (isRefresh) {
+            /*
+             * The client is already connected to a saved server, nothing to fail over.
+             */
+            return;
+        }
+
+        KAA_UNLOCK(lock);
         onCurrentBootstrapServerFailed(KaaFailoverReason::NO_OPERATIONS_SERVERS_RECEIVED);
         return;
     }
 
-    KAA_R_MUTEX_UNIQUE_DECLARE(lock, guard_);
-
     KAA_LOG_INFO(boost::format("Received %1% new operations services") % operationsServers.size());
 
+    isUsingSavedServers_ = false;
+    refreshTimer_.stop();
+    applyOperationsServers(operationsServers, isRefresh);
+
+    context_.getStatus().setOperationsServers(encodeOperationsServers(operationsServers, std::time(nullptr)));
+    context_.getStatus().save();
+}
+
+void BootstrapManager::applyOperationsServers(const std::vector<ProtocolMetaData>& operationsServers,
+                                              bool keepCurrentServers)
+{
+    std::map<TransportProtocolId, ITransportConnectionInfoPtr> currentServers;
+    if (keepCurrentServers) {
+        for (const auto& lastServer : lastOperationsServers_) {
+            currentServers[lastServer.first] = *lastServer.second;
+        }
+    }
+
     lastOperationsServers_.clear();
     operationServers_.clear();
 
@@ -184,10 +422,29 @@ void BootstrapManager::onServerListUpdated(const std::vector<ProtocolMetaData>&
         servers.push_back(connectionInfo);
     }
 
+    auto selectionStrategy = std::atomic_load(&selectionStrategy_);
     for (auto& transportSpecificServers : operationServers_) {
-        std::shuffle (transportSpecificServers.second.begin()
-                      , transportSpecificServers.second.end()
-                      , std::default_random_engine(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+        selectionStrategy->orderServers(transportSpecificServers.second);
+
+        /*
+         * A refreshed list doesn't move the client off the server it is connected to.
+         */
+        auto currentServerIt = currentServers.find(transportSpecificServers.first);
+        if (currentServerIt != currentServers.end()) {
+            const auto& currentServer = currentServerIt->second;
+            auto sameServerIt = std::find_if(transportSpecificServers.second.begin(), transportSpecificServers.second.end(),
+                                             [&currentServer] (const ITransportConnectionInfoPtr& server)
+                                             {
+                                                 return server->getAccessPointId() == currentServer->getAccessPointId() &&
+                                                        server->getConnectionInfo() == currentServer->getConnectionInfo();
+                                             });
+
+            if (sameServerIt != transportSpecificServers.second.end()) {
+                std::iter_swap(transportSpecificServers.second.begin(), sameServerIt);
+            } else {
+                currentServers.erase(currentServerIt);
+            }
+        }
 
         lastOperationsServers_[transportSpecificServers.first] =
                 transportSpecificServers.second.begin();
@@ -203,7 +460,9 @@ void BootstrapManager::onServerListUpdated(const std::vector<ProtocolMetaData>&
         }
     } else {
         for (const auto& transportSpecificServers : operationServers_) {
-            channelManager_->onTransportConnectionInfoUpdated(transportSpecificServers.second.front());
+            if (!currentServers.count(transportSpecificServers.first)) {
+                channelManager_->onTransportConnectionInfoUpdated(transportSpecificServers.second.front());
+            }
         }
     }
 }
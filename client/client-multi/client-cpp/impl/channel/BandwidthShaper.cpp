@@ -0,0 +1,192 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/channel/BandwidthShaper.hpp"
+
+#include <algorithm>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/logging/LoggingUtils.hpp"
+
+namespace kaa {
+
+const std::size_t BandwidthShaper::TRANSPORT_TYPE_COUNT;
+
+void BandwidthShaper::setResumeCallback(const ResumeCallback& callback)
+{
+    KAA_MUTEX_LOCKING("resumeCallbackGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, resumeCallbackGuard_);
+    KAA_MUTEX_LOCKED("resumeCallbackGuard_");
+
+    resumeCallback_ = callback;
+}
+
+void BandwidthShaper::setRateLimit(TransportType type, const TransportRateLimit& limit)
+{
+    KAA_MUTEX_LOCKING("guard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+    KAA_MUTEX_LOCKED("guard_");
+
+    Bucket& bucket = buckets_.at(static_cast<std::size_t>(type));
+    bucket.limit_ = limit;
+    if (!bucket.limit_.burstBytes_) {
+        bucket.limit_.burstBytes_ = bucket.limit_.bytesPerSecond_;
+    }
+
+    bucket.availableBytes_ = static_cast<double>(bucket.limit_.burstBytes_);
+    bucket.refilledAt_ = Clock::now();
+
+    if (!bucket.resumeTimer_) {
+        bucket.resumeTimer_.reset(new KaaTimer<void ()>("Bandwidth shaper resume timer"));
+    }
+
+    if (!limit.bytesPerSecond_ && bucket.isThrottled_) {
+        /*
+         * Deferred sections may go at once.
+         */
+        bucket.resumeTimer_->stop();
+        bucket.resumeTimer_->start(std::chrono::milliseconds::zero(), [this, type] { onResume(type); });
+    }
+
+    KAA_LOG_INFO(boost::format("Rate limit of %1%: %2% bytes/s, burst %3% bytes")
+                 % LoggingUtils::toString(type) % bucket.limit_.bytesPerSecond_ % bucket.limit_.burstBytes_);
+}
+
+std::size_t BandwidthShaper::getBurstBytes(TransportType type) const
+{
+    KAA_MUTEX_LOCKING("guard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+    KAA_MUTEX_LOCKED("guard_");
+
+    const Bucket& bucket = buckets_.at(static_cast<std::size_t>(type));
+    return bucket.limit_.bytesPerSecond_ ? bucket.limit_.burstBytes_ : 0;
+}
+
+bool BandwidthShaper::tryAcquire(TransportType type)
+{
+    KAA_MUTEX_LOCKING("guard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+    KAA_MUTEX_LOCKED("guard_");
+
+    Bucket *bucket = getLimitedBucket(type);
+    if (!bucket) {
+        return true;
+    }
+
+    refill(*bucket, Clock::now());
+    if (bucket->availableBytes_ >= 1) {
+        return true;
+    }
+
+    ++bucket->deferredSections_;
+    bucket->isThrottled_ = true;
+
+    /*
+     * The time the balance becomes positive again.
+     */
+    std::chrono::duration<double> refillTime((1 - bucket->availableBytes_) / bucket->limit_.bytesPerSecond_);
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(refillTime) + std::chrono::milliseconds(1);
+    bucket->resumeTimer_->start(delay, [this, type] { onResume(type); });
+
+    KAA_LOG_DEBUG(boost::format("%1% section is deferred for %2% ms: %3% bytes available")
+                  % LoggingUtils::toString(type) % delay.count() % static_cast<std::int64_t>(bucket->availableBytes_));
+    return false;
+}
+
+void BandwidthShaper::consume(TransportType type, std::size_t bytes)
+{
+    KAA_MUTEX_LOCKING("guard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+    KAA_MUTEX_LOCKED("guard_");
+
+    Bucket *bucket = getLimitedBucket(type);
+    if (!bucket) {
+        return;
+    }
+
+    refill(*bucket, Clock::now());
+    bucket->availableBytes_ -= static_cast<double>(bytes);
+    bucket->sentBytes_ += bytes;
+}
+
+std::map<TransportType, TransportThrottlingSnapshot> BandwidthShaper::getSnapshot() const
+{
+    KAA_MUTEX_LOCKING("guard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+    KAA_MUTEX_LOCKED("guard_");
+
+    std::map<TransportType, TransportThrottlingSnapshot> snapshot;
+    const auto now = Clock::now();
+
+    for (std::size_t i = 0; i < TRANSPORT_TYPE_COUNT; ++i) {
+        const Bucket& bucket = buckets_[i];
+        if (!bucket.limit_.bytesPerSecond_) {
+            continue;
+        }
+
+        std::chrono::duration<double> elapsed = now - bucket.refilledAt_;
+        double availableBytes = std::min(static_cast<double>(bucket.limit_.burstBytes_),
+                                         bucket.availableBytes_ + elapsed.count() * bucket.limit_.bytesPerSecond_);
+
+        TransportThrottlingSnapshot& state = snapshot[static_cast<TransportType>(i)];
+        state.bytesPerSecond_ = bucket.limit_.bytesPerSecond_;
+        state.availableBytes_ = static_cast<std::int64_t>(availableBytes);
+        state.sentBytes_ = bucket.sentBytes_;
+        state.deferredSections_ = bucket.deferredSections_;
+        state.isThrottled_ = bucket.isThrottled_;
+    }
+
+    return snapshot;
+}
+
+BandwidthShaper::Bucket *BandwidthShaper::getLimitedBucket(TransportType type)
+{
+    Bucket& bucket = buckets_.at(static_cast<std::size_t>(type));
+    return bucket.limit_.bytesPerSecond_ ? &bucket : nullptr;
+}
+
+void BandwidthShaper::refill(Bucket& bucket, Clock::time_point now)
+{
+    std::chrono::duration<double> elapsed = now - bucket.refilledAt_;
+    bucket.availableBytes_ = std::min(static_cast<double>(bucket.limit_.burstBytes_),
+                                      bucket.availableBytes_ + elapsed.count() * bucket.limit_.bytesPerSecond_);
+    bucket.refilledAt_ = now;
+}
+
+void BandwidthShaper::onResume(TransportType type)
+{
+    {
+        KAA_MUTEX_LOCKING("guard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, guard_);
+        KAA_MUTEX_LOCKED("guard_");
+
+        buckets_.at(static_cast<std::size_t>(type)).isThrottled_ = false;
+        KAA_MUTEX_UNLOCKED("guard_");
+    }
+
+    /*
+     * The sync compiles the request, which takes guard_ again.
+     */
+    KAA_MUTEX_LOCKING("resumeCallbackGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, resumeCallbackGuard_);
+    KAA_MUTEX_LOCKED("resumeCallbackGuard_");
+
+    if (resumeCallback_) {
+        resumeCallback_(type);
+    }
+}
+
+} /* namespace kaa */
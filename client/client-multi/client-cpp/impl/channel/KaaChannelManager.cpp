@@ -17,6 +17,9 @@
 #include "kaa/channel/KaaChannelManager.hpp"
 
 #include <sstream>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 #include "kaa/IKaaClient.hpp"
 #include "kaa/logging/Log.hpp"
@@ -26,6 +29,24 @@
 
 namespace kaa {
 
+const std::chrono::milliseconds KaaChannelManager::DEFAULT_SYNC_WINDOW(20);
+
+/*
+ * The lower the value, the sooner the transport type is synced.
+ */
+static int getSyncPriority(TransportType type)
+{
+    switch (type) {
+    case TransportType::EVENT:
+    case TransportType::NOTIFICATION:
+        return 0;
+    case TransportType::LOGGING:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
 KaaChannelManager::KaaChannelManager(IBootstrapManager& manager,
                                      const BootstrapServers& servers,
                                      IKaaClientContext& context,
@@ -34,9 +55,16 @@ KaaChannelManager::KaaChannelManager(IBootstrapManager& manager,
     , context_(context)
     , client_(client)
     , retryTimer_("KaaChannelManager retryTimer")
+    , syncTimer_("KaaChannelManager syncTimer")
+    , syncWindow_(DEFAULT_SYNC_WINDOW)
     , isShutdown_(false)
     , isPaused_(false)
+    , channelsSnapshot_(std::make_shared<const ChannelSet>())
+    , mappedChannelsSnapshot_(std::make_shared<const ChannelMap>())
+    , bandwidthShaper_(std::make_shared<BandwidthShaper>(context))
 {
+    bandwidthShaper_->setResumeCallback([this] (TransportType type) { sync(type); });
+
     for (const auto& connectionInfo : servers) {
         auto& list = bootstrapServers_[connectionInfo->getTransportId()];
         list.push_back(connectionInfo);
@@ -44,6 +72,12 @@ KaaChannelManager::KaaChannelManager(IBootstrapManager& manager,
     }
 }
 
+KaaChannelManager::~KaaChannelManager()
+{
+    doShutdown();
+    bandwidthShaper_->setResumeCallback(BandwidthShaper::ResumeCallback());
+}
+
 void KaaChannelManager::setFailoverStrategy(IFailoverStrategyPtr strategy) {
     if (isShutdown_) {
         KAA_LOG_WARN("Can't set failover strategy. Channel manager is down");
@@ -69,6 +103,10 @@ void KaaChannelManager::setFailoverStrategy(IFailoverStrategyPtr strategy) {
 
 void KaaChannelManager::onConnected(const EndpointConnectionInfo& connection)
 {
+    if (connection.connectionAccepted_ && connection.serverType_ == ServerType::OPERATIONS && failoverStrategy_) {
+        failoverStrategy_->onRecover();
+    }
+
     context_.getClientStateListener().onConnectionEstablished(connection);
 }
 
@@ -108,6 +146,17 @@ void KaaChannelManager::onServerFailed(ITransportConnectionInfoPtr connectionInf
     }
 }
 
+void KaaChannelManager::onServerRttMeasured(ITransportConnectionInfoPtr server, std::chrono::microseconds rtt)
+{
+    if (!server) {
+        throw KaaException("empty connection info pointer");
+    }
+
+    if (server->getServerType() == ServerType::OPERATIONS) {
+        bootstrapManager_.onOperationsServerRttMeasured(*server, rtt);
+    }
+}
+
 void KaaChannelManager::onBootstrapServerFailed(ITransportConnectionInfoPtr connectionInfo, KaaFailoverReason reason) {
     if (!connectionInfo) {
         throw KaaException("empty connection info pointer");
@@ -223,6 +272,8 @@ bool KaaChannelManager::addChannelToList(IDataChannelPtr channel)
     auto res = channels_.insert(channel);
 
     if (res.second) {
+        publishChannels();
+
         channel->setFailoverStrategy(failoverStrategy_);
         channel->setConnectivityChecker(connectivityChecker_);
 
@@ -314,6 +365,7 @@ bool KaaChannelManager::useChannelForType(const std::pair<TransportType, Channel
         KAA_MUTEX_LOCKED("mappedChannelGuard_");
 
         mappedChannels_[type.first] = channel;
+        publishMappedChannels();
         return true;
     }
     return false;
@@ -357,6 +409,7 @@ void KaaChannelManager::removeChannel(IDataChannelPtr channel)
     KAA_MUTEX_LOCKED("channelGuard_");
 
     if (channels_.erase(channel)) {
+        publishChannels();
         replaceChannel(channel);
     }
 }
@@ -371,6 +424,7 @@ void KaaChannelManager::removeChannel(const std::string& id)
         if ((*it)->getId() == id) {
             IDataChannelPtr channel = *it;
             channels_.erase(it);
+            publishChannels();
             replaceChannel(channel);
             return;
         }
@@ -388,43 +442,148 @@ void KaaChannelManager::useNewChannelForType(TransportType type) {
     }
 
     mappedChannels_[type] = IDataChannelPtr();
+    publishMappedChannels();
 }
 
-std::list<IDataChannelPtr> KaaChannelManager::getChannels()
+void KaaChannelManager::publishChannels()
 {
-    KAA_MUTEX_LOCKING("channelGuard_");
-    KAA_R_MUTEX_UNIQUE_DECLARE(channelLock, channelGuard_);
-    KAA_MUTEX_LOCKED("channelGuard_");
+    std::atomic_store(&channelsSnapshot_, std::make_shared<const ChannelSet>(channels_));
+}
+
+void KaaChannelManager::publishMappedChannels()
+{
+    std::atomic_store(&mappedChannelsSnapshot_, std::make_shared<const ChannelMap>(mappedChannels_));
+}
 
-    std::list<IDataChannelPtr> channels(channels_.begin(), channels_.end());
+std::list<IDataChannelPtr> KaaChannelManager::getChannels()
+{
+    auto channelsSnapshot = getChannelsSnapshot();
+    std::list<IDataChannelPtr> channels(channelsSnapshot->begin(), channelsSnapshot->end());
     return channels;
 }
 
+KaaClientMetrics KaaChannelManager::getMetrics()
+{
+    KaaClientMetrics metrics;
+    for (auto& channel : *getChannelsSnapshot()) {
+        const auto& channelMetrics = channel->getMetrics();
+        metrics.channels_[channel->getId()] = channelMetrics;
+        metrics.total_ += channelMetrics;
+    }
+
+    for (const auto& rtt : bootstrapManager_.getOperationsServerRtts()) {
+        metrics.operationsServerRttUs_[rtt.first] = rtt.second.count();
+    }
+
+    metrics.throttling_ = bandwidthShaper_->getSnapshot();
+
+    return metrics;
+}
+
 IDataChannelPtr KaaChannelManager::getChannelByTransportType(TransportType type)
 {
-    KAA_MUTEX_LOCKING("mappedChannelGuard_");
-    KAA_R_MUTEX_UNIQUE_DECLARE(mappedChannelLock, mappedChannelGuard_);
-    KAA_MUTEX_LOCKED("mappedChannelGuard_");
+    auto mappedChannels = getMappedChannelsSnapshot();
 
     IDataChannelPtr channel = nullptr;
-    auto it = mappedChannels_.find(type);
+    auto it = mappedChannels->find(type);
 
-    if (it != mappedChannels_.end()) {
+    if (it != mappedChannels->end()) {
         channel = it->second;
     }
 
     return channel;
 }
 
-IDataChannelPtr KaaChannelManager::getChannel(const std::string& channelId)
+void KaaChannelManager::sync(TransportType type)
 {
-    KAA_MUTEX_LOCKING("channelGuard_");
-    KAA_R_MUTEX_UNIQUE_DECLARE(channelLock, channelGuard_);
-    KAA_MUTEX_LOCKED("channelGuard_");
+    if (isShutdown_) {
+        KAA_LOG_WARN(boost::format("Can't sync transport '%s'. Channel manager is down") % LoggingUtils::toString(type));
+        return;
+    }
+
+    if (!getChannelByTransportType(type)) {
+        throw KaaException("Cannot find appropriate channel");
+    }
+
+    if (syncWindow_ == std::chrono::milliseconds::zero()) {
+        syncChannels({ type });
+        return;
+    }
+
+    KAA_MUTEX_LOCKING("syncGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(syncLock, syncGuard_);
+    KAA_MUTEX_LOCKED("syncGuard_");
+
+    pendingSyncTypes_.insert(type);
+
+    // No-op if the window is already open
+    syncTimer_.start(syncWindow_, [this] { onSyncWindowExpired(); });
+}
+
+void KaaChannelManager::onSyncWindowExpired()
+{
+    std::set<TransportType> types;
+
+    KAA_MUTEX_LOCKING("syncGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(syncLock, syncGuard_);
+    KAA_MUTEX_LOCKED("syncGuard_");
+
+    types.swap(pendingSyncTypes_);
+
+    KAA_MUTEX_UNLOCKING("syncGuard_");
+    KAA_UNLOCK(syncLock);
+    KAA_MUTEX_UNLOCKED("syncGuard_");
+
+    if (!isShutdown_) {
+        syncChannels(types);
+    }
+}
+
+void KaaChannelManager::syncChannels(const std::set<TransportType>& types)
+{
+    std::vector<TransportType> orderedTypes(types.begin(), types.end());
+    std::stable_sort(orderedTypes.begin(), orderedTypes.end(), [] (TransportType left, TransportType right)
+            {
+                return getSyncPriority(left) < getSyncPriority(right);
+            });
+
+    // Channels in the order of their most urgent type
+    std::vector<std::pair<IDataChannelPtr, std::vector<TransportType>>> channelTypes;
+    for (auto type : orderedTypes) {
+        IDataChannelPtr channel = getChannelByTransportType(type);
+        if (!channel) {
+            KAA_LOG_WARN(boost::format("Can't sync transport '%s': no channel") % LoggingUtils::toString(type));
+            continue;
+        }
+
+        auto it = std::find_if(channelTypes.begin(), channelTypes.end(),
+                               [channel] (const std::pair<IDataChannelPtr, std::vector<TransportType>>& entry)
+                               {
+                                   return entry.first == channel;
+                               });
+        if (it == channelTypes.end()) {
+            channelTypes.emplace_back(channel, std::vector<TransportType>{ type });
+        } else {
+            it->second.push_back(type);
+        }
+    }
+
+    for (const auto& entry : channelTypes) {
+        // A channel compiles a single request for all its transport types
+        if (entry.second.size() == 1) {
+            entry.first->sync(entry.second.front());
+        } else {
+            KAA_LOG_TRACE(boost::format("Merging %u syncs for channel [%s]") % entry.second.size() % entry.first->getId());
+            entry.first->syncAll();
+        }
+    }
+}
 
+IDataChannelPtr KaaChannelManager::getChannel(const std::string& channelId)
+{
     IDataChannelPtr channel = nullptr;
 
-    for (const auto& c : channels_) {
+    for (const auto& c : *getChannelsSnapshot()) {
         if (c->getId() == channelId) {
             channel = c;
         }
@@ -445,6 +604,9 @@ void KaaChannelManager::clearChannelList()
 
     channels_.clear();
     mappedChannels_.clear();
+
+    publishChannels();
+    publishMappedChannels();
 }
 
 ITransportConnectionInfoPtr KaaChannelManager::getCurrentBootstrapServer(const TransportProtocolId& protocolId)
@@ -512,12 +674,13 @@ void KaaChannelManager::doShutdown()
 
     if (!isShutdown_) {
         isShutdown_ = true;
+        syncTimer_.stop();
 
-        KAA_MUTEX_LOCKING("mappedChannelGuard_");
-        KAA_R_MUTEX_UNIQUE_DECLARE(mappedChannelLock, mappedChannelGuard_);
-        KAA_MUTEX_LOCKED("mappedChannelGuard_");
+        for (auto& it : *getMappedChannelsSnapshot()) {
+            if (!it.second) {
+                continue;
+            }
 
-        for (auto& it : mappedChannels_) {
             KAA_LOG_TRACE(boost::format("Channel manager is shutting down channel [%s], transport '%s'")
                                                                     % it.second->getId()
                                                                     % LoggingUtils::toString(it.first));
@@ -542,12 +705,10 @@ void KaaChannelManager::pause()
     if (!isPaused_) {
         isPaused_ = true;
 
-        KAA_MUTEX_LOCKING("mappedChannelGuard_");
-        KAA_R_MUTEX_UNIQUE_DECLARE(mappedChannelLock, mappedChannelGuard_);
-        KAA_MUTEX_LOCKED("mappedChannelGuard_");
-
-        for (auto& channel : mappedChannels_) {
-            channel.second->pause();
+        for (auto& channel : *getMappedChannelsSnapshot()) {
+            if (channel.second) {
+                channel.second->pause();
+            }
         }
     }
 }
@@ -561,12 +722,10 @@ void KaaChannelManager::resume()
     if (isPaused_) {
         isPaused_ = false;
 
-        KAA_MUTEX_LOCKING("mappedChannelGuard_");
-        KAA_R_MUTEX_UNIQUE_DECLARE(mappedChannelLock, mappedChannelGuard_);
-        KAA_MUTEX_LOCKED("mappedChannelGuard_");
-
-        for (auto& channel : mappedChannels_) {
-            channel.second->resume();
+        for (auto& channel : *getMappedChannelsSnapshot()) {
+            if (channel.second) {
+                channel.second->resume();
+            }
         }
     }
 }
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/channel/KeepAliveTuner.hpp"
+
+#include <algorithm>
+
+namespace kaa {
+
+const std::size_t KeepAliveTuner::MAX_SETTLED_FAILURES;
+
+KeepAliveTuner::KeepAliveTuner(std::chrono::seconds minInterval, std::chrono::seconds maxInterval)
+    : minInterval_(minInterval), maxInterval_(std::max(minInterval, maxInterval)),
+      interval_(minInterval), safeInterval_(0), limit_(0)
+{
+}
+
+void KeepAliveTuner::restore(std::chrono::seconds interval)
+{
+    if (interval < minInterval_ || interval > maxInterval_) {
+        return;
+    }
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, tunerGuard_);
+    interval_ = safeInterval_ = interval;
+    isSettled_ = true;
+    settledFailures_ = 0;
+}
+
+std::chrono::seconds KeepAliveTuner::getInterval() const
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, tunerGuard_);
+    return interval_;
+}
+
+std::chrono::seconds KeepAliveTuner::getSettledInterval() const
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, tunerGuard_);
+    return isSettled_ ? interval_ : std::chrono::seconds(0);
+}
+
+bool KeepAliveTuner::onKeepAliveSucceeded(std::chrono::steady_clock::duration idle)
+{
+    const auto idleSeconds = std::chrono::duration_cast<std::chrono::seconds>(idle);
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, tunerGuard_);
+    safeInterval_ = std::max(safeInterval_, idleSeconds);
+
+    if (isSettled_) {
+        settledFailures_ = 0;
+        return false;
+    }
+
+    if (idleSeconds < interval_) {
+        // The connection wasn't idle for the whole interval, so nothing is learned.
+        return false;
+    }
+
+    auto next = std::min(maxInterval_, interval_ + interval_ / 2);
+    if (limit_.count()) {
+        next = std::min(next, limit_ - limit_ / 10);
+    }
+
+    if (next <= interval_) {
+        return settle(interval_);
+    }
+
+    interval_ = next;
+    return false;
+}
+
+bool KeepAliveTuner::onKeepAliveFailed(std::chrono::steady_clock::duration idle)
+{
+    const auto idleSeconds = std::chrono::duration_cast<std::chrono::seconds>(idle);
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, tunerGuard_);
+    if (idleSeconds > safeInterval_) {
+        limit_ = limit_.count() ? std::min(limit_, idleSeconds) : idleSeconds;
+        return settle(std::max(safeInterval_, limit_ - limit_ / 10));
+    }
+
+    if (isSettled_ && idleSeconds >= interval_ && ++settledFailures_ >= MAX_SETTLED_FAILURES) {
+        // The interval used to be safe, the network seems to have changed.
+        interval_ = minInterval_;
+        safeInterval_ = limit_ = std::chrono::seconds(0);
+        isSettled_ = false;
+        settledFailures_ = 0;
+    }
+
+    // Otherwise the keepalive was lost for another reason than an idle timeout.
+    return false;
+}
+
+bool KeepAliveTuner::settle(std::chrono::seconds interval)
+{
+    interval = std::min(maxInterval_, std::max(minInterval_, interval));
+
+    const bool isChanged = !isSettled_ || interval != interval_;
+    interval_ = interval;
+    isSettled_ = true;
+    settledFailures_ = 0;
+    return isChanged;
+}
+
+} /* namespace kaa */
@@ -18,9 +18,49 @@
 #include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/channel/SyncDataProcessor.hpp"
 #include <kaa/utils/TimeUtils.hpp>
+#include "kaa/utils/SyncTracer.hpp"
+
+namespace avro {
+
+template<> struct codec_traits<kaa::SyncRequestWithEncodedSections> {
+    static void encode(Encoder& e, const kaa::SyncRequestWithEncodedSections& v) {
+        /*
+         * The fields go in the order of codec_traits<kaa::SyncRequest>.
+         */
+        const kaa::SyncRequest& request = *v.request_;
+        avro::encode(e, request.requestId);
+        e.encodeFixed(v.encodedSyncRequestMetaData_->data(), v.encodedSyncRequestMetaData_->size());
+        avro::encode(e, request.bootstrapSyncRequest);
+        avro::encode(e, request.profileSyncRequest);
+        avro::encode(e, request.configurationSyncRequest);
+        avro::encode(e, request.notificationSyncRequest);
+        avro::encode(e, request.userSyncRequest);
+        avro::encode(e, request.eventSyncRequest);
+        if (v.encodedLogSyncRequest_) {
+            e.encodeUnionIndex(getLogSyncRequestBranch());
+            e.encodeFixed(v.encodedLogSyncRequest_->data(), v.encodedLogSyncRequest_->size());
+        } else {
+            avro::encode(e, request.logSyncRequest);
+        }
+        avro::encode(e, request.extensionSyncRequests);
+    }
+
+    static std::size_t getLogSyncRequestBranch() {
+        static const std::size_t branch = [] {
+            kaa::SyncRequest::logSyncRequest_t logSyncRequest;
+            logSyncRequest.set_LogSyncRequest(kaa::LogSyncRequest());
+            return logSyncRequest.idx();
+        }();
+        return branch;
+    }
+};
+
+}
 
 namespace kaa {
 
+const std::size_t SyncDataProcessor::MAX_PENDING_DELTA_REQUESTS;
+
 SyncDataProcessor::SyncDataProcessor(IMetaDataTransportPtr       metaDataTransport
                     , IBootstrapTransportPtr      bootstrapTransport
                     , IProfileTransportPtr        profileTransport
@@ -48,9 +88,158 @@ SyncDataProcessor::SyncDataProcessor(IMetaDataTransportPtr       metaDataTranspo
 
 std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes)
 {
+    std::vector<std::uint8_t> encodedData;
+    compileRequest(transportTypes, encodedData);
+    return encodedData;
+}
+
+void SyncDataProcessor::compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                       std::vector<std::uint8_t>& dest)
+{
+    compileRequest(transportTypes, dest, false);
+}
+
+void SyncDataProcessor::compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                       AvroChunkedOutputStream& dest)
+{
+    compileRequest(transportTypes, dest, false);
+}
+
+void SyncDataProcessor::compileDeltaRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                            std::vector<std::uint8_t>& dest)
+{
+    compileRequest(transportTypes, dest, true);
+}
+
+void SyncDataProcessor::resetDeltaState()
+{
+    KAA_MUTEX_LOCKING("deltaGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, deltaGuard_);
+    KAA_MUTEX_LOCKED("deltaGuard_");
+
+    acknowledgedSections_.clear();
+    pendingSections_.clear();
+}
+
+template<typename Section>
+bool SyncDataProcessor::isSectionAcknowledged(TransportType type, const Section& section, std::int32_t requestId)
+{
+    std::vector<std::uint8_t> encodedSection;
+    AvroByteArrayConverter<Section>().toByteArray(section, encodedSection);
+
+    KAA_MUTEX_LOCKING("deltaGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, deltaGuard_);
+    KAA_MUTEX_LOCKED("deltaGuard_");
+
+    auto it = acknowledgedSections_.find(type);
+    if (it != acknowledgedSections_.end() && it->second == encodedSection) {
+        return true;
+    }
+
+    pendingSections_[requestId][type] = std::move(encodedSection);
+
+    /*
+     * Requests whose responses are lost are forgotten.
+     */
+    if (pendingSections_.size() > MAX_PENDING_DELTA_REQUESTS) {
+        pendingSections_.erase(pendingSections_.begin());
+    }
+
+    return false;
+}
+
+void SyncDataProcessor::acknowledgeSections(const SyncResponse& response)
+{
+    KAA_MUTEX_LOCKING("deltaGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, deltaGuard_);
+    KAA_MUTEX_LOCKED("deltaGuard_");
+
+    auto it = pendingSections_.find(response.requestId);
+    if (it == pendingSections_.end()) {
+        return;
+    }
+
+    if (response.status == SyncResponseResultType::SUCCESS) {
+        for (auto& section : it->second) {
+            bool isAcknowledged = (section.first == TransportType::CONFIGURATION && !response.configurationSyncResponse.is_null())
+                               || (section.first == TransportType::NOTIFICATION && !response.notificationSyncResponse.is_null());
+            if (isAcknowledged) {
+                acknowledgedSections_[section.first] = std::move(section.second);
+            }
+        }
+    }
+
+    pendingSections_.erase(it);
+}
+
+bool SyncDataProcessor::isSectionAllowed(TransportType type)
+{
+    if (bandwidthShaper_ && !bandwidthShaper_->tryAcquire(type)) {
+        KAA_LOG_DEBUG(boost::format("%1% section is deferred by the rate limit") % LoggingUtils::toString(type));
+        return false;
+    }
+    return true;
+}
+
+void SyncDataProcessor::onSectionSent(TransportType type, std::size_t bytes)
+{
+    if (bandwidthShaper_) {
+        bandwidthShaper_->consume(type, bytes);
+    }
+}
+
+/*
+ * Approximates the encoded size of the event section without encoding it.
+ */
+static std::size_t getEventSectionSize(const EventSyncRequest& request)
+{
+    std::size_t size = 0;
+    if (!request.events.is_null()) {
+        for (const auto& event : request.events.get_array()) {
+            size += sizeof(event.seqNum) + event.eventClassFQN.size() + event.eventData.size()
+                    + (event.target.is_null() ? 0 : event.target.get_string().size());
+        }
+    }
+    return size;
+}
+
+void SyncDataProcessor::encodeRequest(const SyncRequestWithEncodedSections& request,
+                                      std::vector<std::uint8_t>& dest)
+{
+    /*
+     * Avro gives no encoded size upfront, so the buffer is reserved for the size of the previous request.
+     * Subsequent requests are usually of the same size, e.g. log buckets, so that makes a single allocation.
+     */
+    std::size_t offset = dest.size();
+    dest.reserve(offset + lastEncodedRequestSize_);
+    requestConverter_.appendToByteArray(request, dest);
+
+    lastEncodedRequestSize_ = dest.size() - offset;
+}
+
+void SyncDataProcessor::encodeRequest(const SyncRequestWithEncodedSections& request,
+                                      AvroChunkedOutputStream& dest)
+{
+    requestConverter_.toByteArray(request, dest);
+}
+
+template<typename Output>
+void SyncDataProcessor::compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                       Output& dest, bool isDeltaRequest)
+{
+    /*
+     * The section of a single requested transport type is always sent, e.g. to poll for updates.
+     */
+    bool skipAcknowledged = isDeltaRequest && transportTypes.size() > 1;
+
+    KAA_SYNC_TRACE_SCOPE(traceScope, COMPILE, 0, nullptr);
+
     SyncRequest request;
+    std::shared_ptr<const std::vector<std::uint8_t>> encodedLogSyncRequest;
 
     request.requestId = ++requestId;
+    KAA_SYNC_TRACE_SET_REQUEST_ID(traceScope, request.requestId);
+    KAA_SYNC_TRACE_SET_CURRENT_REQUEST_ID(request.requestId);
     request.bootstrapSyncRequest.set_null();
     request.configurationSyncRequest.set_null();
     request.eventSyncRequest.set_null();
@@ -61,10 +250,11 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
 
     KAA_LOG_DEBUG(boost::format("Compiling sync request. RequestId: %1%") % requestId);
 
-    auto metaRequest = metaDataTransport_->createSyncRequestMetaData();
-    request.syncRequestMetaData.set_SyncRequestMetaData(*metaRequest);
-    KAA_LOG_DEBUG(boost::format("Compiled SyncRequestMetaData: %1%")
-                        % LoggingUtils::toString(request.syncRequestMetaData));
+    /*
+     * The meta data rarely changes, so it is encoded once and reused by subsequent requests.
+     */
+    auto encodedMetaData = metaDataTransport_->createEncodedSyncRequestMetaData();
+    KAA_LOG_DEBUG(boost::format("Compiled SyncRequestMetaData: %1% bytes encoded") % encodedMetaData->size());
 
     for (const auto& t : transportTypes) {
         bool isDownDirection = (t.second == ChannelDirection::DOWN);
@@ -105,7 +295,11 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
 #ifdef KAA_USE_CONFIGURATION
                 if (configurationTransport_) {
                     auto ptr = configurationTransport_->createConfigurationRequest();
-                    if (ptr) {
+                    if (ptr && skipAcknowledged
+                            && isSectionAcknowledged(TransportType::CONFIGURATION, *ptr, request.requestId)) {
+                        KAA_LOG_DEBUG("ConfigurationSyncRequest is skipped: no changes since the last acknowledgement");
+                        request.configurationSyncRequest.set_null();
+                    } else if (ptr) {
                         request.configurationSyncRequest.set_ConfigurationSyncRequest(*ptr);
                     } else {
                         request.configurationSyncRequest.set_null();
@@ -124,7 +318,11 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
                         request.notificationSyncRequest.set_NotificationSyncRequest(*notificationTransport_->createEmptyNotificationRequest());
                     } else {
                         auto ptr = notificationTransport_->createNotificationRequest();
-                        if (ptr) {
+                        if (ptr && skipAcknowledged
+                                && isSectionAcknowledged(TransportType::NOTIFICATION, *ptr, request.requestId)) {
+                            KAA_LOG_DEBUG("NotificationSyncRequest is skipped: no changes since the last acknowledgement");
+                            request.notificationSyncRequest.set_null();
+                        } else if (ptr) {
                             request.notificationSyncRequest.set_NotificationSyncRequest(*ptr);
                         } else {
                             request.notificationSyncRequest.set_null();
@@ -167,8 +365,13 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
                     event.events.set_null();
                     request.eventSyncRequest.set_EventSyncRequest(event);
                 } else if (eventTransport_) {
-                    auto ptr = eventTransport_->createEventRequest(requestId);
+                    /*
+                     * Deferred events stay pending in the event manager.
+                     */
+                    auto ptr = isSectionAllowed(TransportType::EVENT)
+                            ? eventTransport_->createEventRequest(requestId) : nullptr;
                     if (ptr) {
+                        onSectionSent(TransportType::EVENT, getEventSectionSize(*ptr));
                         request.eventSyncRequest.set_EventSyncRequest(*ptr);
                     } else {
                         request.eventSyncRequest.set_null();
@@ -187,47 +390,60 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
                     log.logEntries.set_null();
                     log.requestId = 0;
                     request.logSyncRequest.set_LogSyncRequest(log);
-                } else if (loggingTransport_) {
-                    auto ptr = loggingTransport_->createLogSyncRequest();
-                    if (ptr) {
-                        request.logSyncRequest.set_LogSyncRequest(*ptr);
-                    } else {
-                        request.logSyncRequest.set_null();
+                } else if (loggingTransport_ && isSectionAllowed(TransportType::LOGGING)) {
+                    /*
+                     * Retried log buckets are sent as they were encoded the first time.
+                     */
+                    encodedLogSyncRequest = loggingTransport_->createEncodedLogSyncRequest();
+                    if (encodedLogSyncRequest) {
+                        onSectionSent(TransportType::LOGGING, encodedLogSyncRequest->size());
                     }
-                } else {
+                } else if (!loggingTransport_) {
                     KAA_LOG_WARN("Log upload transport was not specified.");
                 }
 #endif
-                KAA_LOG_DEBUG(boost::format("Compiled LogSyncRequest: %1%")
-                    % LoggingUtils::toString(request.logSyncRequest));
+                if (encodedLogSyncRequest) {
+                    KAA_LOG_DEBUG(boost::format("Compiled LogSyncRequest: %1% bytes encoded")
+                        % encodedLogSyncRequest->size());
+                } else {
+                    KAA_LOG_DEBUG(boost::format("Compiled LogSyncRequest: %1%")
+                        % LoggingUtils::toString(request.logSyncRequest));
+                }
                 break;
             default:
                 break;
         }
     }
 
-    std::vector<std::uint8_t> encodedData;
-    requestConverter_.toByteArray(request, encodedData);
-
-    return encodedData;
+    encodeRequest({ &request, encodedMetaData.get(), encodedLogSyncRequest.get() }, dest);
 }
 
 DemultiplexerReturnCode SyncDataProcessor::processResponse(const std::vector<std::uint8_t> &response)
 {
-    if (response.empty()) {
+    return processResponse(response.data(), response.size());
+}
+
+DemultiplexerReturnCode SyncDataProcessor::processResponse(const std::uint8_t *data, std::size_t size)
+{
+    if (!data || !size) {
         return DemultiplexerReturnCode::FAILURE;
     }
 
+    KAA_SYNC_TRACE_SCOPE(traceScope, PROCESS, 0, nullptr);
+
     auto deliveryTime = TimeUtils::getCurrentTimeInMs();
     DemultiplexerReturnCode returnCode = DemultiplexerReturnCode::SUCCESS;
 
     try {
         SyncResponse syncResponse;
-        responseConverter_.fromByteArray(response.data(), response.size(), syncResponse);
+        responseConverter_.fromByteArray(data, size, syncResponse);
+        KAA_SYNC_TRACE_SET_REQUEST_ID(traceScope, syncResponse.requestId);
 
         KAA_LOG_INFO(boost::format("Got SyncResponse: requestId: %1%, result: %2%")
             % syncResponse.requestId % LoggingUtils::toString(syncResponse.status));
 
+        acknowledgeSections(syncResponse);
+
         KAA_LOG_DEBUG(boost::format("Got BootstrapSyncResponse: %1%")
             % LoggingUtils::toString(syncResponse.bootstrapSyncResponse));
 
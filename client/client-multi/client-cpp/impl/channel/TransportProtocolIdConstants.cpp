@@ -24,11 +24,17 @@ const std::int32_t TransportProtocolIdConstants::HTTP_TRANSPORT_PROTOCOL_VERSION
 const std::int32_t TransportProtocolIdConstants::TCP_TRANSPORT_PROTOCOL_ID       = 0x56c8ff92;
 const std::int32_t TransportProtocolIdConstants::TCP_TRANSPORT_PROTOCOL_VERSION  = 1;
 
+const std::int32_t TransportProtocolIdConstants::SHM_TRANSPORT_PROTOCOL_ID       = 0x4B53484D;
+const std::int32_t TransportProtocolIdConstants::SHM_TRANSPORT_PROTOCOL_VERSION  = 1;
+
 const TransportProtocolId TransportProtocolIdConstants::HTTP_TRANSPORT_ID(
                     HTTP_TRANSPORT_PROTOCOL_ID, HTTP_TRANSPORT_PROTOCOL_VERSION);
 
 const TransportProtocolId TransportProtocolIdConstants::TCP_TRANSPORT_ID(
                     TCP_TRANSPORT_PROTOCOL_ID, TCP_TRANSPORT_PROTOCOL_VERSION);
 
+const TransportProtocolId TransportProtocolIdConstants::SHM_TRANSPORT_ID(
+                    SHM_TRANSPORT_PROTOCOL_ID, SHM_TRANSPORT_PROTOCOL_VERSION);
+
 
 } /* namespace kaa */
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/channel/connectivity/ConnectivityMonitor.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <initializer_list>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+#include "kaa/observer/KaaObservable.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+const std::chrono::seconds ConnectivityMonitor::DEFAULT_PROBE_INTERVAL(60);
+
+/*
+ * The state shared with the monitor thread. The thread isn't joined, because a probe may block
+ * for a long time, e.g. while connecting to an unreachable host, so it keeps the state alive.
+ */
+struct ConnectivityMonitor::Monitor {
+    /*
+     * Bursts of network events and connectivity checks are coalesced into one probe per gap.
+     */
+    static const std::chrono::milliseconds MIN_PROBE_GAP;
+
+    Monitor(ConnectivityCheckerPtr probe, std::chrono::milliseconds probeInterval)
+        : probe_(probe), probeInterval_(probeInterval), isConnected_(true), isStopped_(false)
+    {
+        openNetlink();
+    }
+
+    ~Monitor()
+    {
+        closeNetlink();
+    }
+
+    void run();
+    void wait(std::chrono::milliseconds timeout);
+    void wakeUp();
+
+    void openNetlink();
+    void closeNetlink();
+
+    const ConnectivityCheckerPtr probe_;
+    const std::chrono::milliseconds probeInterval_;
+
+    std::atomic<bool> isConnected_;
+    std::atomic<bool> isStopped_;
+    KaaObservable<void (bool), const void *> listeners_;
+
+    /*
+     * Held while listeners are notified, so none is notified once the monitor is stopped.
+     */
+    std::mutex notificationGuard_;
+
+    std::mutex wakeUpGuard_;
+    std::condition_variable wakeUpCondition_;
+    bool isProbeRequested_ = false;
+
+#ifdef __linux__
+    int netlinkFd_ = -1;
+    int wakeUpPipe_[2] = { -1, -1 };
+#endif
+};
+
+const std::chrono::milliseconds ConnectivityMonitor::Monitor::MIN_PROBE_GAP(1000);
+
+void ConnectivityMonitor::Monitor::run()
+{
+    while (!isStopped_) {
+        const bool isConnected = probe_->checkConnectivity();
+        const auto probedAt = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(notificationGuard_);
+            if (isStopped_) {
+                return;
+            }
+
+            if (isConnected_.exchange(isConnected) != isConnected) {
+                listeners_(isConnected);
+            }
+        }
+
+        wait(probeInterval_);
+
+        for (auto now = std::chrono::steady_clock::now(); !isStopped_ && now < probedAt + MIN_PROBE_GAP;
+                now = std::chrono::steady_clock::now()) {
+            wait(std::chrono::duration_cast<std::chrono::milliseconds>(probedAt + MIN_PROBE_GAP - now));
+        }
+    }
+}
+
+void ConnectivityMonitor::Monitor::wait(std::chrono::milliseconds timeout)
+{
+#ifdef __linux__
+    if (netlinkFd_ >= 0) {
+        pollfd fds[] = { { netlinkFd_, POLLIN, 0 }, { wakeUpPipe_[0], POLLIN, 0 } };
+        poll(fds, 2, static_cast<int>(timeout.count()));
+
+        /*
+         * The content of the events doesn't matter, any of them triggers a probe.
+         */
+        char buffer[4096];
+        while (recv(netlinkFd_, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {}
+        while (read(wakeUpPipe_[0], buffer, sizeof(buffer)) > 0) {}
+        return;
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(wakeUpGuard_);
+    wakeUpCondition_.wait_for(lock, timeout, [this] { return isProbeRequested_ || isStopped_; });
+    isProbeRequested_ = false;
+}
+
+void ConnectivityMonitor::Monitor::wakeUp()
+{
+#ifdef __linux__
+    if (netlinkFd_ >= 0) {
+        const char byte = 0;
+        static_cast<void>(write(wakeUpPipe_[1], &byte, sizeof(byte)));
+        return;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(wakeUpGuard_);
+        isProbeRequested_ = true;
+    }
+    wakeUpCondition_.notify_one();
+}
+
+void ConnectivityMonitor::Monitor::openNetlink()
+{
+#ifdef __linux__
+    netlinkFd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (netlinkFd_ < 0) {
+        return;
+    }
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+
+    if (bind(netlinkFd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ||
+            pipe2(wakeUpPipe_, O_CLOEXEC | O_NONBLOCK)) {
+        /*
+         * Periodic probes still work without network events.
+         */
+        closeNetlink();
+    }
+#endif
+}
+
+void ConnectivityMonitor::Monitor::closeNetlink()
+{
+#ifdef __linux__
+    for (int *fd : { &netlinkFd_, &wakeUpPipe_[0], &wakeUpPipe_[1] }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+#endif
+}
+
+ConnectivityMonitor::ConnectivityMonitor(ConnectivityCheckerPtr probe, std::chrono::milliseconds probeInterval)
+{
+    if (!probe) {
+        throw KaaException("Connectivity probe is null");
+    }
+
+    monitor_ = std::make_shared<Monitor>(probe, probeInterval);
+
+    std::shared_ptr<Monitor> monitor = monitor_;
+    std::thread([monitor] { monitor->run(); }).detach();
+}
+
+ConnectivityMonitor::~ConnectivityMonitor()
+{
+    {
+        std::lock_guard<std::mutex> lock(monitor_->notificationGuard_);
+        monitor_->isStopped_ = true;
+    }
+    monitor_->wakeUp();
+}
+
+bool ConnectivityMonitor::checkConnectivity()
+{
+    monitor_->wakeUp();
+    return monitor_->isConnected_;
+}
+
+bool ConnectivityMonitor::addConnectivityListener(const void *key, const ConnectivityListener& listener)
+{
+    return monitor_->listeners_.addCallback(key, listener);
+}
+
+void ConnectivityMonitor::removeConnectivityListener(const void *key)
+{
+    /*
+     * Waits for the notification in progress, so the listener isn't called after the removal.
+     */
+    std::lock_guard<std::mutex> lock(monitor_->notificationGuard_);
+    monitor_->listeners_.removeCallback(key);
+}
+
+void ConnectivityMonitor::onNetworkChanged()
+{
+    monitor_->wakeUp();
+}
+
+} /* namespace kaa */
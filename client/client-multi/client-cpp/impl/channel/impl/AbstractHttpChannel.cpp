@@ -18,6 +18,7 @@
 
 #include "kaa/channel/impl/AbstractHttpChannel.hpp"
 #include "kaa/common/exception/HttpTransportException.hpp"
+#include "kaa/utils/SyncTracer.hpp"
 
 namespace kaa {
 
@@ -46,7 +47,13 @@ void AbstractHttpChannel::processTypes(const std::map<TransportType, ChannelDire
 #endif
                                        )
 {
-    auto postRequest = createRequest(currentServer_, multiplexer_->compileRequest(types));
+    const auto& requestBody = multiplexer_->compileRequest(types);
+#ifdef KAA_USE_SYNC_TRACING
+    const std::int32_t traceRequestId = SyncTracer::getCurrentRequestId();
+    const auto encryptStartedAt = std::chrono::steady_clock::now();
+#endif
+    auto postRequest = createRequest(currentServer_, requestBody);
+    KAA_SYNC_TRACE_RECORD(ENCRYPT, traceRequestId, getId().c_str(), encryptStartedAt, std::chrono::steady_clock::now());
 
     KAA_MUTEX_UNLOCKING("channelGuard_");
     KAA_UNLOCK(lock);
@@ -55,7 +62,11 @@ void AbstractHttpChannel::processTypes(const std::map<TransportType, ChannelDire
     try {
         // Sending http request
         EndpointConnectionInfo connection("", "", getServerType());
+        auto requestStart = std::chrono::steady_clock::now();
         auto response = httpClient_.sendRequest(*postRequest, &connection);
+        auto responseReceivedAt = std::chrono::steady_clock::now();
+        recordExchange(requestBody.size(), *response, responseReceivedAt - requestStart);
+        KAA_SYNC_TRACE_RECORD(NETWORK, traceRequestId, getId().c_str(), requestStart, responseReceivedAt);
         channelManager_.onConnected(connection);
 
         KAA_MUTEX_LOCKING("channelGuard_");
@@ -64,15 +75,15 @@ void AbstractHttpChannel::processTypes(const std::map<TransportType, ChannelDire
 
         // Retrieving the avro data from the HTTP response
         const std::string& processedResponse = retrieveResponse(*response);
+        KAA_SYNC_TRACE_RECORD(DECRYPT, traceRequestId, getId().c_str(), responseReceivedAt, std::chrono::steady_clock::now());
 
         KAA_MUTEX_UNLOCKING("channelGuard_");
         KAA_UNLOCK(lockInternal);
         KAA_MUTEX_UNLOCKED("channelGuard_");
 
         if (!processedResponse.empty()) {
-            demultiplexer_->processResponse(
-                    std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
-                                              reinterpret_cast<const std::uint8_t *>(processedResponse.data() + processedResponse.size())));
+            demultiplexer_->processResponse(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
+                                            processedResponse.size());
         }
     } catch (HttpTransportException& e) {
         KAA_LOG_WARN(boost::format("Channel [%1%] failed to connect %2%:%3%: %4%")
@@ -114,8 +125,21 @@ void AbstractHttpChannel::processTypes(const std::map<TransportType, ChannelDire
 }
 
 
+void AbstractHttpChannel::recordExchange(std::size_t requestBodySize, const IHttpResponse& response,
+                                         std::chrono::steady_clock::duration latency)
+{
+    metrics_.onConnected();
+    metrics_.onFramesSent();
+    metrics_.onBytesSent(requestBodySize);
+    metrics_.onFrameReceived();
+    metrics_.onBytesReceived(response.getBody().second);
+    metrics_.getSyncLatency().record(latency);
+}
+
 void AbstractHttpChannel::onServerFailed(KaaFailoverReason reason)
 {
+    metrics_.onServerFailed();
+
     auto server = std::dynamic_pointer_cast<ITransportConnectionInfo, IPTransportInfo>(currentServer_);
 
     KAA_LOG_WARN(boost::format("Channel [%1%] detected '%2%' failover for %3%")
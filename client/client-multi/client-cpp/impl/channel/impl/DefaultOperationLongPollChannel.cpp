@@ -24,6 +24,7 @@
 #include "kaa/http/IHttpResponse.hpp"
 #include "kaa/http/IHttpRequest.hpp"
 #include "kaa/http/MultipartPostHttpRequest.hpp"
+#include "kaa/transport/TransportException.hpp"
 
 namespace kaa {
 
@@ -40,8 +41,9 @@ const std::map<TransportType, ChannelDirection> DefaultOperationLongPollChannel:
 DefaultOperationLongPollChannel::DefaultOperationLongPollChannel(IKaaChannelManager& channelManager, const KeyPair& clientKeys, IKaaClientContext &context)
     : clientKeys_(clientKeys), work_(io_), pollThread_()
     , stopped_(true), isShutdown_(false), isPaused_(false), connectionInProgress_(false), taskPosted_(false), firstStart_(true)
+    , syncInProgress_(false), syncPending_(false)
     , multiplexer_(nullptr), demultiplexer_(nullptr), channelManager_(channelManager)
-    , httpDataProcessor_(context), httpClient_(context), context_(context) {}
+    , httpDataProcessor_(context), httpClient_(context, io_), syncHttpClient_(context, io_), context_(context) {}
 
 DefaultOperationLongPollChannel::~DefaultOperationLongPollChannel()
 {
@@ -72,6 +74,10 @@ void DefaultOperationLongPollChannel::stopPoll()
     KAA_LOG_INFO("Stopping poll future..");
     if (!stopped_) {
         stopped_ = true;
+        syncPending_ = false;
+        if (syncInProgress_) {
+            syncHttpClient_.closeConnection();
+        }
         if (connectionInProgress_) {
             httpClient_.closeConnection();
             KAA_MUTEX_LOCKING("conditionMutex_");
@@ -107,21 +113,49 @@ void DefaultOperationLongPollChannel::executeTask()
     KAA_MUTEX_UNLOCKING("channelGuard_");
     KAA_UNLOCK(lock);
     KAA_MUTEX_UNLOCKED("channelGuard_");
+
+    metrics_.onFramesSent();
+    metrics_.onBytesSent(bodyRaw.size());
+
+    // Sending http request, the poll thread isn't blocked until the response
+    httpClient_.sendRequestAsync(*postRequest,
+            [this] (const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response)
+            {
+                onPollResponse(errorCode, response);
+            });
+}
+
+void DefaultOperationLongPollChannel::onPollResponse(const boost::system::error_code& errorCode,
+                                                     std::shared_ptr<IHttpResponse> response)
+{
     try {
-        // Sending http request
-        auto response = httpClient_.sendRequest(*postRequest);
+        if (errorCode) {
+            throw TransportException(errorCode);
+        }
+
+        metrics_.onConnected();
+        metrics_.onFrameReceived();
+        metrics_.onBytesReceived(response->getBody().second);
+
         KAA_MUTEX_LOCKING("channelGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(lockInternal, channelGuard_);
         KAA_MUTEX_LOCKED("channelGuard_");
         // Retrieving the avro data from the HTTP response
         connectionInProgress_ = false;
         const std::string& processedResponse = httpDataProcessor_.retrieveOperationResponse(*response);
+
+        /*
+         * The next poll is queued before the response is dispatched, ahead of the syncs requested by the handlers.
+         * It is compiled on this thread right after the response is applied, so it doesn't carry stale state.
+         */
+        if (!stopped_ && !taskPosted_) {
+            postTask();
+        }
         KAA_MUTEX_UNLOCKING("channelGuard_");
         KAA_UNLOCK(lockInternal);
         KAA_MUTEX_UNLOCKED("channelGuard_");
-        demultiplexer_->processResponse(
-                std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
-                                            reinterpret_cast<const std::uint8_t *>(processedResponse.data() + processedResponse.size())));
+        demultiplexer_->processResponse(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
+                                        processedResponse.size());
 
         KAA_MUTEX_LOCKING("conditionMutex_");
         KAA_MUTEX_UNIQUE_DECLARE(conditionLock, conditionMutex_);
@@ -151,17 +185,126 @@ void DefaultOperationLongPollChannel::executeTask()
         KAA_MUTEX_LOCKED("conditionMutex_");
         KAA_CONDITION_NOTIFY_ALL(waitCondition_);
         if (isServerFailed) {
+            metrics_.onServerFailed();
             channelManager_.onServerFailed(std::dynamic_pointer_cast<ITransportConnectionInfo, IPTransportInfo>(currentServer_),
                                             KaaFailoverReason::NO_CONNECTIVITY);
         }
         return;
     }
+}
+
+void DefaultOperationLongPollChannel::requestSync()
+{
+    if (stopped_) {
+        // The first poll request carries the data
+        startPoll();
+    } else if (!taskPosted_) {
+        postSync();
+    }
+}
+
+void DefaultOperationLongPollChannel::postSync()
+{
+    if (syncInProgress_) {
+        syncPending_ = true;
+        return;
+    }
+
+    syncInProgress_ = true;
+    io_.post([this](){ this->executeSync(); });
+}
 
+void DefaultOperationLongPollChannel::executeSync()
+{
     KAA_MUTEX_LOCKING("channelGuard_");
-    KAA_LOCK(lock);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
     KAA_MUTEX_LOCKED("channelGuard_");
-    if (!stopped_ && !taskPosted_) {
-        postTask();
+    if (stopped_) {
+        syncInProgress_ = false;
+        return;
+    }
+
+    const auto& bodyRaw = multiplexer_->compileRequest(getSupportedTransportTypes());
+    std::shared_ptr<IHttpRequest> postRequest = httpDataProcessor_.createOperationRequest(
+                                        currentServer_->getURL() + getSyncURLSuffix(), bodyRaw);
+
+    KAA_MUTEX_UNLOCKING("channelGuard_");
+    KAA_UNLOCK(lock);
+    KAA_MUTEX_UNLOCKED("channelGuard_");
+
+    metrics_.onFramesSent();
+    metrics_.onBytesSent(bodyRaw.size());
+
+    syncHttpClient_.sendRequestAsync(*postRequest,
+            [this] (const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response)
+            {
+                onSyncResponse(errorCode, response);
+            });
+}
+
+void DefaultOperationLongPollChannel::onSyncResponse(const boost::system::error_code& errorCode,
+                                                     std::shared_ptr<IHttpResponse> response)
+{
+    try {
+        if (errorCode == boost::asio::error::operation_aborted) {
+            // The channel has been stopped, possibly restarted since
+            KAA_LOG_INFO(boost::format("Sync request for channel %1% was aborted") % getId());
+        } else {
+            if (errorCode) {
+                throw TransportException(errorCode);
+            }
+
+            metrics_.onFrameReceived();
+            metrics_.onBytesReceived(response->getBody().second);
+
+            KAA_MUTEX_LOCKING("channelGuard_");
+            KAA_MUTEX_UNIQUE_DECLARE(lockInternal, channelGuard_);
+            KAA_MUTEX_LOCKED("channelGuard_");
+            const std::string& processedResponse = httpDataProcessor_.retrieveOperationResponse(*response);
+            KAA_MUTEX_UNLOCKING("channelGuard_");
+            KAA_UNLOCK(lockInternal);
+            KAA_MUTEX_UNLOCKED("channelGuard_");
+            demultiplexer_->processResponse(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
+                                            processedResponse.size());
+        }
+    } catch (std::exception& e) {
+        KAA_MUTEX_LOCKING("channelGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lockException, channelGuard_);
+        KAA_MUTEX_LOCKED("channelGuard_");
+
+        syncInProgress_ = false;
+        syncPending_ = false;
+        if (stopped_) {
+            KAA_LOG_INFO(boost::format("Sync request for channel %1% was aborted") % getId());
+            return;
+        }
+
+        KAA_LOG_ERROR(boost::format("Sync request failed, server %1%:%2%: %3%")
+                % currentServer_->getHost() % currentServer_->getPort() % e.what());
+
+        // The poll goes to the same server, so it is aborted too
+        stopped_ = true;
+        if (connectionInProgress_) {
+            httpClient_.closeConnection();
+        }
+
+        KAA_MUTEX_UNLOCKING("channelGuard_");
+        KAA_UNLOCK(lockException);
+        KAA_MUTEX_UNLOCKED("channelGuard_");
+
+        metrics_.onServerFailed();
+        channelManager_.onServerFailed(std::dynamic_pointer_cast<ITransportConnectionInfo, IPTransportInfo>(currentServer_),
+                                        KaaFailoverReason::NO_CONNECTIVITY);
+        return;
+    }
+
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+    syncInProgress_ = false;
+    if (syncPending_ && !stopped_) {
+        syncPending_ = false;
+        postSync();
     }
 }
 
@@ -182,8 +325,7 @@ void DefaultOperationLongPollChannel::sync(TransportType type)
     auto it = types.find(type);
     if (it != types.end() && (it->second == ChannelDirection::UP || it->second == ChannelDirection::BIDIRECTIONAL)) {
         if (currentServer_) {
-            stopPoll();
-            startPoll();
+            requestSync();
         } else {
             KAA_LOG_WARN(boost::format("Can't sync channel %1%. Server is null") % getId());
         }
@@ -206,8 +348,7 @@ void DefaultOperationLongPollChannel::syncAll()
         return;
     }
     if (currentServer_) {
-        stopPoll();
-        startPoll();
+        requestSync();
     } else {
         KAA_LOG_WARN(boost::format("Can't sync channel %1%. Server is null") % getId());
     }
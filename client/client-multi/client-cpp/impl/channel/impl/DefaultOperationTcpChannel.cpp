@@ -18,8 +18,8 @@
 
 #include "kaa/channel/impl/DefaultOperationTcpChannel.hpp"
 
+#include <algorithm>
 #include <memory>
-#include <sstream>
 #include <functional>
 #include <chrono>
 #include <thread>
@@ -27,7 +27,14 @@
 
 #include <boost/bind.hpp>
 
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
 #include "kaa/IKaaClient.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 #include "kaa/common/exception/TransportRedirectException.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
@@ -37,11 +44,16 @@
 #include "kaa/kaatcp/KaaSyncRequest.hpp"
 #include "kaa/kaatcp/PingRequest.hpp"
 #include "kaa/kaatcp/DisconnectMessage.hpp"
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
 #include "kaa/http/HttpUtils.hpp"
+#include "kaa/utils/SyncTracer.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
 
 namespace kaa {
 const std::uint16_t DefaultOperationTcpChannel::THREADPOOL_SIZE;
+const std::size_t DefaultOperationTcpChannel::DEFAULT_MAX_IN_FLIGHT_SYNC_REQUESTS;
+const int DefaultOperationTcpChannel::MIN_KEEPALIVE_INTERVAL;
+const int DefaultOperationTcpChannel::MAX_KEEPALIVE_INTERVAL;
 const std::string DefaultOperationTcpChannel::CHANNEL_ID = "default_operation_kaa_tcp_channel";
 
 const std::map<TransportType, ChannelDirection> DefaultOperationTcpChannel::SUPPORTED_TYPES =
@@ -62,14 +74,20 @@ public:
 
     /**
      * Initializes RSA encoding/decoding and opens a TCP connection to the @c currentServer.
+     * If @c sessionTicket is set, the connection resumes its session instead of starting a new one.
+     * Otherwise, if @c connectCredentials are set, CONNECT reuses their session key, encrypted and signed beforehand.
+     * PINGs are sent after @c keepAliveTuner intervals of idleness and their outcome is reported back to it.
+     * If @c isIoPolled is set, nobody runs @c io while the connection waits, see @link IoServicePool::createPolled() @endlink.
      *
      * Throws @c KaaFailoverReason on failure.
      */
     ChannelConnection(IKaaChannelManager &channelManager, const KeyPair &clientKeys,
                       IKaaClientContext &context, IKaaDataMultiplexer *multiplexer,
                       IKaaDataDemultiplexer *demultiplexer, DefaultOperationTcpChannel *channel,
-                      const std::string &channelId, const IPTransportInfo &currentServer,
-                      boost::asio::io_service &io);
+                      const std::string &channelId, std::shared_ptr<IPTransportInfo> currentServer,
+                      boost::asio::io_service &io, bool isIoPolled, TcpSessionTicketPtr sessionTicket,
+                      TcpConnectCredentialsPtr connectCredentials,
+                      ChannelMetrics &metrics, KeepAliveTuner &keepAliveTuner);
 
     ~ChannelConnection();
 
@@ -91,8 +109,31 @@ public:
      */
     void shutdown();
 
+    /**
+     * Stops PINGs and holds sync requests back, keeping the connection open.
+     */
+    void suspend();
+
+    /**
+     * Restarts PINGs and sends the sync requests held back, if there are none, checks the connection with a PING.
+     */
+    void resume();
+
 private:
+    /**
+     * A frame waiting to be written: the KaaTcp header (or the whole message) followed by the optional body.
+     */
+    struct OutgoingFrame {
+        std::vector<std::uint8_t> header_;
+        std::vector<std::uint8_t> body_;
+
+        std::size_t getCapacity() const { return header_.capacity() + body_.capacity(); }
+    };
+
+    typedef std::shared_ptr<OutgoingFrame> OutgoingFramePtr;
+
     void sendData(const IKaaTcpRequest& request);
+    void sendFrame(OutgoingFramePtr frame);
     void sendDataImpl();
 
     void onReadEvent(const boost::system::error_code& err);
@@ -106,6 +147,26 @@ private:
     void onPingResponse();
 
 
+    void sendDeferredKaaSync();
+
+    /**
+     * Returns the id of the answered sync request for tracing, zero if tracing is disabled or the request is unknown.
+     */
+    std::int32_t onKaaSyncResponseReceived(std::uint16_t messageId);
+
+    void onKeepAliveLost();
+
+    /**
+     * Applies @c KaaClientProperties::getTcpSocketOptions() to the connected socket.
+     * Options the platform rejects are only logged.
+     */
+    void applySocketOptions();
+
+    /**
+     * Reports the change of the buffer capacity since the previous call to the channel metrics.
+     */
+    void trackBufferCapacity(const std::vector<std::uint8_t>& buffer, std::size_t& trackedCapacity);
+
     void readFromSocket();
     void setPingTimer();
     void setConnAckTimer();
@@ -119,13 +180,34 @@ private:
     IKaaDataDemultiplexer *const demultiplexer_;
     std::list<TransportType> ackTypes_;
     KaaTcpResponseProcessor responseProcessor_;
-    std::recursive_mutex connectionMutex_;
+    KAA_R_MUTEX_DECLARE(connectionMutex_);
     boost::asio::io_service::strand strand_;
     EndpointConnectionInfo currentConnection_;
 
-    std::deque<std::vector<uint8_t>> requestQueue_;
+    std::deque<OutgoingFramePtr> requestQueue_;
+    std::size_t framesInFlight_ = 0;
+
+    /*
+     * Requests are compiled here under connectionMutex_, so the buffer is allocated once per connection.
+     */
+    std::vector<std::uint8_t> requestBuffer_;
+    std::size_t requestBufferCapacity_ = 0;
+
+    /*
+     * KAASYNC responses are decrypted in place here, so the buffer is allocated once per connection.
+     */
+    std::vector<std::uint8_t> responseDecodeBuffer_;
+    std::size_t responseDecodeBufferCapacity_ = 0;
 
     RsaEncoderDecoder encDec_;
+    const TcpSessionTicketPtr sessionTicket_;
+
+    /*
+     * Credentials sent in CONNECT, either reused or created by the connection.
+     */
+    TcpConnectCredentialsPtr connectCredentials_;
+
+    const bool isIoPolled_;
 
     enum class State {
         Disconnected, ///< Connection has not been initiated yet
@@ -135,26 +217,68 @@ private:
 
     std::atomic<State> state_;
     bool hasPendingSyncRequest_ = false;
+    bool isSuspended_ = false;
+
+    struct InFlightSyncRequest {
+        std::uint16_t messageId_;
+        std::chrono::steady_clock::time_point sentAt_;
+#ifdef KAA_USE_SYNC_TRACING
+        std::int32_t requestId_;
+#endif
+    };
+
+    /*
+     * KAASYNC requests waiting for responses, the oldest first.
+     */
+    std::deque<InFlightSyncRequest> inFlightSyncRequests_;
+    std::uint16_t nextMessageId_ = 1;
+
+    /*
+     * Transport types to be synced once the window of in-flight requests has room.
+     */
+    std::map<TransportType, ChannelDirection> deferredSyncTypes_;
+
+#ifdef KAA_USE_SYNC_TRACING
+    std::chrono::steady_clock::time_point deferredSince_;
+#endif
 
     IKaaClientContext &context_;
     IKaaChannelManager &channelManager_;
 
+    ChannelMetrics &metrics_;
+    std::chrono::steady_clock::time_point pingSentAt_;
+    bool isPingInFlight_ = false;
+
+    KeepAliveTuner &keepAliveTuner_;
+    std::chrono::steady_clock::time_point lastActivityAt_;
+
+    /*
+     * How long the connection was idle before the in-flight PING.
+     */
+    std::chrono::steady_clock::duration pingIdleTime_;
+
     DefaultOperationTcpChannel *const channel_;
     const std::string channelId_;
+    const std::shared_ptr<IPTransportInfo> server_;
 
     static const std::uint32_t KAA_PLATFORM_PROTOCOL_AVRO_ID = 0xf291f2d4;
 
     static const int CHANNEL_TIMEOUT = 200;
-    static const int PING_TIMEOUT = CHANNEL_TIMEOUT / 2;
+    static const int PING_RESPONSE_TIMEOUT = 20;
     static const int CONN_ACK_TIMEOUT = 20;
     static const int DISCONNECT_TIMEOUT = 3;
+
+    static const std::size_t MAX_COALESCED_FRAMES = 16;
+    static const std::size_t AES_BLOCK_SIZE = 16;
 };
 
 const std::uint32_t ChannelConnection::KAA_PLATFORM_PROTOCOL_AVRO_ID;
 const int ChannelConnection::CHANNEL_TIMEOUT;
-const int ChannelConnection::PING_TIMEOUT;
+const int ChannelConnection::PING_RESPONSE_TIMEOUT;
 const int ChannelConnection::CONN_ACK_TIMEOUT;
 const int ChannelConnection::DISCONNECT_TIMEOUT;
+const std::size_t ChannelConnection::MAX_COALESCED_FRAMES;
+const std::size_t ChannelConnection::AES_BLOCK_SIZE;
 
 ChannelConnection::ChannelConnection(IKaaChannelManager& channelManager,
                                      const KeyPair& clientKeys,
@@ -163,12 +287,20 @@ ChannelConnection::ChannelConnection(IKaaChannelManager& channelManager,
                                      IKaaDataDemultiplexer *demultiplexer,
                                      DefaultOperationTcpChannel *channel,
                                      const std::string &channelId,
-                                     const IPTransportInfo &currentServer,
-                                     boost::asio::io_service &io):
+                                     std::shared_ptr<IPTransportInfo> currentServer,
+                                     boost::asio::io_service &io,
+                                     bool isIoPolled,
+                                     TcpSessionTicketPtr sessionTicket,
+                                     TcpConnectCredentialsPtr connectCredentials,
+                                     ChannelMetrics &metrics,
+                                     KeepAliveTuner &keepAliveTuner):
     sock_(io),
     strand_(io),
     context_(context),
     channelManager_(channelManager),
+    metrics_(metrics),
+    keepAliveTuner_(keepAliveTuner),
+    lastActivityAt_(std::chrono::steady_clock::now()),
     pingTimer_(io),
     connAckTimer_(io),
     multiplexer_(multiplexer),
@@ -177,10 +309,16 @@ ChannelConnection::ChannelConnection(IKaaChannelManager& channelManager,
     channel_(channel),
     encDec_(clientKeys.getPublicKey(),
            clientKeys.getPrivateKey(),
-           currentServer.getPublicKey(),
+           currentServer->getPublicKey(),
+           sessionTicket ? sessionTicket->sessionKey_ :
+               connectCredentials ? connectCredentials->sessionKey_ : KeyUtils().generateSessionKey(16),
            context_),
+    sessionTicket_(sessionTicket),
+    connectCredentials_(sessionTicket ? TcpConnectCredentialsPtr() : connectCredentials),
+    isIoPolled_(isIoPolled),
     state_(State::Disconnected),
-    channelId_(channelId)
+    channelId_(channelId),
+    server_(currentServer)
 {
     responseProcessor_.registerConnackReceiver(std::bind(&ChannelConnection::onConnack, this, std::placeholders::_1));
     responseProcessor_.registerKaaSyncReceiver(std::bind(&ChannelConnection::onKaaSync, this, std::placeholders::_1));
@@ -189,9 +327,9 @@ ChannelConnection::ChannelConnection(IKaaChannelManager& channelManager,
 
     boost::system::error_code errorCode;
 
-    boost::asio::ip::tcp::endpoint ep = HttpUtils::resolveEndpoint(currentServer.getHost(),
-                                                                   currentServer.getPort(),
-                                                                   errorCode);
+    const auto& endpoints = HttpUtils::resolveEndpoints(currentServer->getHost(),
+                                                        currentServer->getPort(),
+                                                        errorCode);
     if (errorCode) {
         KAA_LOG_ERROR(boost::format("Channel [%1%] failed to resolve endpoint: %2%")
                                                                     % channelId_
@@ -199,28 +337,34 @@ ChannelConnection::ChannelConnection(IKaaChannelManager& channelManager,
         throw(KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA);
     }
 
-    sock_.open(ep.protocol(), errorCode);
-
-    if (errorCode) {
-        KAA_LOG_ERROR(boost::format("Channel [%1%] failed to open socket: %2%")
-                                                            % channelId_
-                                                            % errorCode.message());
-        throw(KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA);
-    }
-
-    sock_.connect(ep, errorCode);
+    /*
+     * Connection attempts to all addresses of the server are raced, the winner is reported to the channel manager.
+     */
+    auto connectStartedAt = std::chrono::steady_clock::now();
+    boost::asio::ip::tcp::endpoint ep = HttpUtils::connect(io, sock_, endpoints, errorCode);
 
     if (errorCode) {
-        KAA_LOG_ERROR(boost::format("Channel [%1%] failed to connect to %2%:%3%: %4%")
+        KAA_LOG_ERROR(boost::format("Channel [%1%] failed to connect to %2%:%3% (%4% addresses): %5%")
                                                                 % channelId_
-                                                                % ep.address().to_string()
-                                                                % ep.port()
+                                                                % currentServer->getHost()
+                                                                % currentServer->getPort()
+                                                                % endpoints.size()
                                                                 % errorCode.message());
+        HttpUtils::invalidateEndpoints(currentServer->getHost(), currentServer->getPort());
         throw(KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA);
     }
 
+    /*
+     * The TCP handshake takes one round trip, so the connect time estimates RTT to the server.
+     */
+    auto connectTime = std::chrono::steady_clock::now() - connectStartedAt;
+    metrics_.getConnectTime().record(connectTime);
+    channelManager_.onServerRttMeasured(server_, std::chrono::duration_cast<std::chrono::microseconds>(connectTime));
+
     KAA_LOG_INFO(boost::format("Channel [%1%] connected to %2%") % channelId_ % ep.address().to_string());
 
+    applySocketOptions();
+
     currentConnection_.endpointIp_ = sock_.local_endpoint().address().to_string();
     currentConnection_.serverIp_ = ep.address().to_string();
     currentConnection_.serverType_ = channel_->getServerType();
@@ -240,7 +384,7 @@ void ChannelConnection::run()
 
 void ChannelConnection::shutdown()
 {
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
     if (state_ == State::Disconnected) {
         return;
     }
@@ -255,19 +399,92 @@ void ChannelConnection::shutdown()
     responseProcessor_.flush();
 }
 
+void ChannelConnection::suspend()
+{
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (state_ == State::Disconnected || isSuspended_) {
+        return;
+    }
+
+    KAA_LOG_DEBUG(boost::format("Channel [%1%] suspending connection") % channelId_);
+    isSuspended_ = true;
+    pingTimer_.cancel();
+
+    // A PING response arriving while suspended can't be timed out, so it is ignored.
+    isPingInFlight_ = false;
+}
+
+void ChannelConnection::resume()
+{
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (state_ == State::Disconnected || !isSuspended_) {
+        return;
+    }
+
+    KAA_LOG_DEBUG(boost::format("Channel [%1%] resuming connection: %2% transports to sync")
+                  % channelId_ % deferredSyncTypes_.size());
+    isSuspended_ = false;
+
+    if (state_ == State::Ready) {
+        if (deferredSyncTypes_.empty()) {
+            sendPingRequest();
+        } else {
+            sendDeferredKaaSync();
+        }
+    }
+
+    setPingTimer();
+}
+
 ChannelConnection::~ChannelConnection()
 {
     shutdown();
+
+    std::size_t bufferedBytes = requestBufferCapacity_ + responseDecodeBufferCapacity_;
+    for (const auto& frame : requestQueue_) {
+        bufferedBytes += frame->getCapacity();
+    }
+    metrics_.onBufferedBytesChanged(-static_cast<std::int64_t>(bufferedBytes));
+}
+
+void ChannelConnection::trackBufferCapacity(const std::vector<std::uint8_t>& buffer, std::size_t& trackedCapacity)
+{
+    if (buffer.capacity() != trackedCapacity) {
+        metrics_.onBufferedBytesChanged(static_cast<std::int64_t>(buffer.capacity())
+                                      - static_cast<std::int64_t>(trackedCapacity));
+        trackedCapacity = buffer.capacity();
+    }
 }
 
 void ChannelConnection::onConnack(const ConnackMessage& message)
 {
+    metrics_.onFrameReceived();
+
     KAA_LOG_DEBUG(boost::format("Channel [%1%] received Connack: status %2%")
                                                             % channelId_
                                                             % message.getMessage());
 
+    if (sessionTicket_ && message.getReturnCode() != ConnackReturnCode::ACCEPTED) {
+        KAA_LOG_INFO(boost::format("Channel [%1%] session resumption refused: %2%")
+                     % channelId_ % message.getMessage());
+        channel_->onSessionResumptionRefused();
+        return;
+    }
+
     switch (message.getReturnCode()) {
         case ConnackReturnCode::ACCEPTED:
+            if (!message.getSessionTicket().empty()) {
+                KAA_LOG_DEBUG(boost::format("Channel [%1%] received session ticket valid for %2% seconds")
+                              % channelId_ % message.getSessionTicketLifetime());
+                channel_->onSessionTicket(message.getSessionTicket(), message.getSessionTicketLifetime(),
+                                          encDec_.getSessionKey());
+            }
+
+            if (connectCredentials_) {
+                channel_->onConnectCredentials(connectCredentials_);
+            }
+
+            metrics_.onConnected();
             currentConnection_.connectionAccepted_ = true;
             channelManager_.onConnected(currentConnection_);
             break;
@@ -276,6 +493,8 @@ void ChannelConnection::onConnack(const ConnackMessage& message)
             KAA_LOG_WARN(boost::format("Channel [%1%] failed server authentication: %2%")
                          % channelId_ % ConnackMessage::returnCodeToString(message.getReturnCode()));
 
+            channel_->onConnectCredentials(TcpConnectCredentialsPtr());
+
             channel_->onServerFailed(KaaFailoverReason::ENDPOINT_NOT_REGISTERED);
             break;
         default:
@@ -286,8 +505,55 @@ void ChannelConnection::onConnack(const ConnackMessage& message)
     }
 }
 
+void ChannelConnection::applySocketOptions()
+{
+    const TcpSocketOptions options = context_.getProperties().getTcpSocketOptions();
+    boost::system::error_code errorCode;
+
+    auto check = [&](const char *option) {
+        if (errorCode) {
+            KAA_LOG_WARN(boost::format("Channel [%1%] failed to set %2%: %3%") % channelId_ % option % errorCode.message());
+            errorCode.clear();
+        }
+    };
+
+    sock_.set_option(boost::asio::ip::tcp::no_delay(options.noDelay), errorCode);
+    check("TCP_NODELAY");
+
+    if (options.sendBufferSize) {
+        sock_.set_option(boost::asio::socket_base::send_buffer_size(static_cast<int>(options.sendBufferSize)), errorCode);
+        check("SO_SNDBUF");
+    }
+
+    if (options.receiveBufferSize) {
+        sock_.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(options.receiveBufferSize)), errorCode);
+        check("SO_RCVBUF");
+    }
+
+    if (!options.keepAliveIdle.count() && !options.keepAliveInterval.count() && !options.keepAliveCount) {
+        return;
+    }
+
+    sock_.set_option(boost::asio::socket_base::keep_alive(true), errorCode);
+    check("SO_KEEPALIVE");
+
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+    auto setTcpOption = [&](int name, int value, const char *option) {
+        if (value > 0 && ::setsockopt(sock_.native_handle(), IPPROTO_TCP, name, &value, sizeof(value))) {
+            KAA_LOG_WARN(boost::format("Channel [%1%] failed to set %2%") % channelId_ % option);
+        }
+    };
+
+    setTcpOption(TCP_KEEPIDLE, static_cast<int>(options.keepAliveIdle.count()), "TCP_KEEPIDLE");
+    setTcpOption(TCP_KEEPINTVL, static_cast<int>(options.keepAliveInterval.count()), "TCP_KEEPINTVL");
+    setTcpOption(TCP_KEEPCNT, static_cast<int>(options.keepAliveCount), "TCP_KEEPCNT");
+#endif
+}
+
 void ChannelConnection::onDisconnect(const DisconnectMessage& message)
 {
+    metrics_.onFrameReceived();
+
     KAA_LOG_DEBUG(boost::format("Channel [%1%] received Disconnect: %2%")
                   % channelId_ % message.getMessage());
 
@@ -300,13 +566,25 @@ void ChannelConnection::onDisconnect(const DisconnectMessage& message)
 
 void ChannelConnection::onKaaSync(const KaaSyncResponse& message)
 {
-    KAA_LOG_DEBUG(boost::format("Channel [%1%]. KaaSync response received") % channelId_);
+    metrics_.onFrameReceived();
+
+    KAA_LOG_DEBUG(boost::format("Channel [%1%]. KaaSync response received: message id %2%")
+                                                            % channelId_ % message.getMessageId());
+#ifdef KAA_USE_SYNC_TRACING
+    const std::int32_t traceRequestId = onKaaSyncResponseReceived(message.getMessageId());
+    const auto decryptStartedAt = std::chrono::steady_clock::now();
+#else
+    onKaaSyncResponseReceived(message.getMessageId());
+#endif
+
     const auto& encodedResponse = message.getPayload();
 
-    std::string decodedResponse;
+    std::size_t decodedSize = 0;
 
     try {
-        decodedResponse = encDec_.decodeData(encodedResponse.data(), encodedResponse.size());
+        responseDecodeBuffer_.assign(encodedResponse.begin(), encodedResponse.end());
+        trackBufferCapacity(responseDecodeBuffer_, responseDecodeBufferCapacity_);
+        decodedSize = encDec_.decodeDataInPlace(responseDecodeBuffer_.data(), responseDecodeBuffer_.size());
     } catch (const std::exception& e) {
         KAA_LOG_ERROR(boost::format("Channel [%1%] unable to decode data: %2%")
                                                                         % channelId_
@@ -316,9 +594,39 @@ void ChannelConnection::onKaaSync(const KaaSyncResponse& message)
         return;
     }
 
-    auto returnCode = demultiplexer_->processResponse(
-                                            std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(decodedResponse.data()),
-                                                                    reinterpret_cast<const std::uint8_t *>(decodedResponse.data() + decodedResponse.size())));
+    /*
+     * The response is demultiplexed in place, either in the decoded or in the decompressed buffer.
+     */
+    const std::uint8_t *responseData = responseDecodeBuffer_.data();
+    std::size_t responseSize = decodedSize;
+
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+    std::vector<std::uint8_t> decompressedResponse;
+#endif
+
+    if (message.isZipped()) {
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+        try {
+            decompressedResponse = KaaSyncCompressor::decompress(responseData, responseSize);
+            responseData = decompressedResponse.data();
+            responseSize = decompressedResponse.size();
+        } catch (const std::exception& e) {
+            KAA_LOG_ERROR(boost::format("Channel [%1%] unable to decompress data: %2%") % channelId_ % e.what());
+            channel_->onServerFailed();
+            return;
+        }
+#else
+        KAA_LOG_ERROR(boost::format("Channel [%1%] received compressed data, but compression is not supported")
+                                                                                                % channelId_);
+        channel_->onServerFailed();
+        return;
+#endif
+    }
+
+    KAA_SYNC_TRACE_RECORD(DECRYPT, traceRequestId, channel_->getId().c_str(),
+                          decryptStartedAt, std::chrono::steady_clock::now());
+
+    auto returnCode = demultiplexer_->processResponse(responseData, responseSize);
 
     if (returnCode == DemultiplexerReturnCode::REDIRECT) {
         throw TransportRedirectException(boost::format("Channel [%1%] received REDIRECT response")
@@ -351,19 +659,120 @@ void ChannelConnection::onKaaSync(const KaaSyncResponse& message)
             sync(*ackTypesCopy.begin());
         }
     }
+
+    sendDeferredKaaSync();
+}
+
+std::int32_t ChannelConnection::onKaaSyncResponseReceived(std::uint16_t messageId)
+{
+    std::int32_t requestId = 0;
+
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    auto it = std::find_if(inFlightSyncRequests_.begin(), inFlightSyncRequests_.end(),
+                           [messageId] (const InFlightSyncRequest& request) { return request.messageId_ == messageId; });
+    if (it == inFlightSyncRequests_.end() && state_ == State::Ready && !inFlightSyncRequests_.empty()) {
+        /*
+         * The server doesn't echo message ids, so responses are taken in the order of requests.
+         */
+        KAA_LOG_DEBUG(boost::format("Channel [%1%] unknown KAASYNC message id %2%, assuming %3%")
+                                        % channelId_ % messageId % inFlightSyncRequests_.front().messageId_);
+        it = inFlightSyncRequests_.begin();
+    }
+
+    if (it != inFlightSyncRequests_.end()) {
+        auto receivedAt = std::chrono::steady_clock::now();
+        metrics_.getSyncLatency().record(receivedAt - it->sentAt_);
+#ifdef KAA_USE_SYNC_TRACING
+        requestId = it->requestId_;
+        KAA_SYNC_TRACE_RECORD(NETWORK, requestId, channel_->getId().c_str(), it->sentAt_, receivedAt);
+#endif
+        inFlightSyncRequests_.erase(it);
+    }
+
+    return requestId;
+}
+
+void ChannelConnection::sendDeferredKaaSync()
+{
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (deferredSyncTypes_.empty() || state_ != State::Ready || isSuspended_ ||
+            inFlightSyncRequests_.size() >= channel_->getMaxInFlightSyncRequests()) {
+        return;
+    }
+
+    std::map<TransportType, ChannelDirection> transportTypes;
+    transportTypes.swap(deferredSyncTypes_);
+
+    KAA_LOG_DEBUG(boost::format("Channel [%1%] sending %2% deferred sync requests") % channelId_ % transportTypes.size());
+#ifdef KAA_USE_SYNC_TRACING
+    const auto dequeuedAt = std::chrono::steady_clock::now();
+#endif
+    sendKaaSync(transportTypes);
+    KAA_SYNC_TRACE_RECORD(QUEUE, SyncTracer::getCurrentRequestId(), channel_->getId().c_str(), deferredSince_, dequeuedAt);
 }
 
 void ChannelConnection::onPingResponse()
 {
+    metrics_.onFrameReceived();
+
     KAA_LOG_DEBUG(boost::format("Channel [%1%] received ping response ") % channelId_);
+
+    KAA_R_MUTEX_UNIQUE_DECLARE(lock, connectionMutex_);
+    if (isPingInFlight_) {
+        isPingInFlight_ = false;
+
+        auto rtt = std::chrono::steady_clock::now() - pingSentAt_;
+        metrics_.getPingRtt().record(rtt);
+
+        if (keepAliveTuner_.onKeepAliveSucceeded(pingIdleTime_)) {
+            auto interval = keepAliveTuner_.getSettledInterval();
+            KAA_LOG_INFO(boost::format("Channel [%1%] keepalive interval settled at %2% seconds")
+                         % channelId_ % interval.count());
+            context_.getStatus().setKeepAliveInterval(interval.count());
+            context_.getStatus().save();
+        }
+
+        setPingTimer();
+
+        lock.unlock();
+        channelManager_.onServerRttMeasured(server_, std::chrono::duration_cast<std::chrono::microseconds>(rtt));
+    }
+}
+
+void ChannelConnection::onKeepAliveLost()
+{
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (!isPingInFlight_) {
+        return;
+    }
+
+    isPingInFlight_ = false;
+
+    KAA_LOG_WARN(boost::format("Channel [%1%] PING lost after %2% seconds of idleness")
+                 % channelId_ % std::chrono::duration_cast<std::chrono::seconds>(pingIdleTime_).count());
+
+    if (keepAliveTuner_.onKeepAliveFailed(pingIdleTime_)) {
+        auto interval = keepAliveTuner_.getSettledInterval();
+        KAA_LOG_INFO(boost::format("Channel [%1%] keepalive interval settled at %2% seconds")
+                     % channelId_ % interval.count());
+        context_.getStatus().setKeepAliveInterval(interval.count());
+        context_.getStatus().save();
+    }
 }
 
 void ChannelConnection::sendData(const IKaaTcpRequest& request)
 {
-    auto data = request.getRawMessage();
-    strand_.post([this, data] {
-        requestQueue_.push_back(data);
-        if (requestQueue_.size() == 1) {
+    auto frame = std::make_shared<OutgoingFrame>();
+    frame->header_ = request.getRawMessage();
+    sendFrame(frame);
+}
+
+void ChannelConnection::sendFrame(OutgoingFramePtr frame)
+{
+    strand_.post([this, frame] {
+        metrics_.onBufferedBytesChanged(frame->getCapacity());
+        requestQueue_.push_back(frame);
+        if (!framesInFlight_) {
             sendDataImpl();
         }
     });
@@ -374,10 +783,30 @@ void ChannelConnection::sendDataImpl()
     if (state_ == State::Disconnected) {
         return;
     }
-    const auto &data = requestQueue_[0];
-    KAA_LOG_TRACE(boost::format("Channel [%1%] sending data: size %2%") % channelId_ % data.size());
-    boost::asio::async_write(sock_,
-            boost::asio::buffer(reinterpret_cast<const char *>(data.data()), data.size()),
+
+    /*
+     * Frames queued while the previous write was in progress are written by a single call.
+     */
+    std::vector<boost::asio::const_buffer> buffers;
+    std::size_t size = 0;
+
+    for (const auto& frame : requestQueue_) {
+        if (framesInFlight_ == MAX_COALESCED_FRAMES) {
+            break;
+        }
+
+        buffers.push_back(boost::asio::buffer(frame->header_));
+        if (!frame->body_.empty()) {
+            buffers.push_back(boost::asio::buffer(frame->body_));
+        }
+
+        size += frame->header_.size() + frame->body_.size();
+        ++framesInFlight_;
+    }
+
+    KAA_LOG_TRACE(boost::format("Channel [%1%] sending data: frames %2%, size %3%")
+                                                % channelId_ % framesInFlight_ % size);
+    boost::asio::async_write(sock_, buffers,
             strand_.wrap(boost::bind(&ChannelConnection::onWriteEvent, shared_from_this(),
                                     boost::asio::placeholders::error,
                                     boost::asio::placeholders::bytes_transferred)));
@@ -385,7 +814,20 @@ void ChannelConnection::sendDataImpl()
 
 void ChannelConnection::onWriteEvent(const boost::system::error_code &err, std::size_t bytes_transferred)
 {
-    requestQueue_.pop_front();
+    metrics_.onBytesSent(bytes_transferred);
+    if (!err) {
+        metrics_.onFramesSent(framesInFlight_);
+        lastActivityAt_ = std::chrono::steady_clock::now();
+    }
+
+    std::size_t sentBytes = 0;
+    for (std::size_t i = 0; i < framesInFlight_; ++i) {
+        sentBytes += requestQueue_[i]->getCapacity();
+    }
+    metrics_.onBufferedBytesChanged(-static_cast<std::int64_t>(sentBytes));
+
+    requestQueue_.erase(requestQueue_.begin(), requestQueue_.begin() + framesInFlight_);
+    framesInFlight_ = 0;
 
     if (err && err != boost::asio::error::operation_aborted) {
         KAA_LOG_ERROR(boost::format("Channel [%1%] write failed: %2%") % channelId_ % err.message());
@@ -400,34 +842,149 @@ void ChannelConnection::onWriteEvent(const boost::system::error_code &err, std::
 
 void ChannelConnection::sendKaaSync(const std::map<TransportType, ChannelDirection>& transportTypes)
 {
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
-    KAA_LOG_TRACE(boost::format("Channel [%1%] sending KAASYNC") % channelId_);
-    const auto& requestBody = multiplexer_->compileRequest(transportTypes);
-    const auto& requestEncoded = encDec_.encodeData(requestBody.data(), requestBody.size());
-    sendData(KaaSyncRequest(false, true, 0, requestEncoded, KaaSyncMessageType::SYNC));
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+
+    if (isSuspended_ || inFlightSyncRequests_.size() >= channel_->getMaxInFlightSyncRequests()) {
+        KAA_LOG_DEBUG(boost::format("Channel [%1%] %2% KAASYNC requests are in flight, deferring sync%3%")
+                                                            % channelId_ % inFlightSyncRequests_.size()
+                                                            % (isSuspended_ ? " until resumed" : ""));
+#ifdef KAA_USE_SYNC_TRACING
+        if (deferredSyncTypes_.empty()) {
+            deferredSince_ = std::chrono::steady_clock::now();
+        }
+#endif
+        for (const auto& transportType : transportTypes) {
+            deferredSyncTypes_.insert(transportType);
+        }
+        return;
+    }
+
+    std::uint16_t messageId = nextMessageId_++;
+    if (!nextMessageId_) {
+        /*
+         * Zero is the id of responses to CONNECT.
+         */
+        nextMessageId_ = 1;
+    }
+
+    KAA_LOG_TRACE(boost::format("Channel [%1%] sending KAASYNC: message id %2%") % channelId_ % messageId);
+    requestBuffer_.clear();
+    multiplexer_->compileDeltaRequest(transportTypes, requestBuffer_);
+    trackBufferCapacity(requestBuffer_, requestBufferCapacity_);
+    const auto& requestBody = requestBuffer_;
+
+#ifdef KAA_USE_SYNC_TRACING
+    const std::int32_t traceRequestId = SyncTracer::getCurrentRequestId();
+    const auto encryptStartedAt = std::chrono::steady_clock::now();
+#endif
+
+    bool isZipped = false;
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+    std::vector<std::uint8_t> compressedBody;
+    try {
+        isZipped = KaaSyncCompressor::compress(requestBody.data(), requestBody.size(), compressedBody);
+    } catch (const std::exception& e) {
+        KAA_LOG_WARN(boost::format("Channel [%1%] failed to compress KAASYNC, sending it uncompressed: %2%")
+                                                                                    % channelId_ % e.what());
+    }
+
+    if (isZipped) {
+        KAA_LOG_TRACE(boost::format("Channel [%1%] KAASYNC compressed: %2% -> %3% bytes")
+                                        % channelId_ % requestBody.size() % compressedBody.size());
+    }
+
+    const auto& requestPayload = isZipped ? compressedBody : requestBody;
+#else
+    const auto& requestPayload = requestBody;
+#endif
+
+    /*
+     * The body is sent as a separate buffer to avoid copying it after the header.
+     * It is encrypted in place, the capacity is reserved for the padding.
+     */
+    auto frame = std::make_shared<OutgoingFrame>();
+    frame->body_.reserve(requestPayload.size() + AES_BLOCK_SIZE);
+    frame->body_.assign(requestPayload.begin(), requestPayload.end());
+    encDec_.encodeDataInPlace(frame->body_);
+    frame->header_ = KaaSyncRequest::createHeader(isZipped, true, messageId, frame->body_.size(), KaaSyncMessageType::SYNC);
+
+    auto sentAt = std::chrono::steady_clock::now();
+    KAA_SYNC_TRACE_RECORD(ENCRYPT, traceRequestId, channel_->getId().c_str(), encryptStartedAt, sentAt);
+#ifdef KAA_USE_SYNC_TRACING
+    inFlightSyncRequests_.push_back({ messageId, sentAt, traceRequestId });
+#else
+    inFlightSyncRequests_.push_back({ messageId, sentAt });
+#endif
+    sendFrame(frame);
 }
 
 void ChannelConnection::sendConnect()
 {
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
     KAA_LOG_TRACE(boost::format("Channel [%1%] sending CONNECT") % channelId_ );
+    /*
+     * A new session starts, so KAASYNC requests carry all sections again until the server acknowledges them.
+     */
+    multiplexer_->resetDeltaState();
     const auto& requestBody = multiplexer_->compileRequest(channel_->getSupportedTransportTypes());
     const auto& requestEncoded = encDec_.encodeData(requestBody.data(), requestBody.size());
-    const auto& sessionKey = encDec_.getEncodedSessionKey();
-    const auto& signature = encDec_.signData(sessionKey.data(), sessionKey.size());
-    sendData(ConnectMessage(CHANNEL_TIMEOUT, KAA_PLATFORM_PROTOCOL_AVRO_ID, signature, sessionKey, requestEncoded));
+
+    /*
+     * The resumed session skips the RSA encryption and signature of the session key.
+     */
+    if (sessionTicket_) {
+        KAA_LOG_TRACE(boost::format("Channel [%1%] resuming session") % channelId_);
+        sendData(ConnectMessage::resumeSession(CHANNEL_TIMEOUT, KAA_PLATFORM_PROTOCOL_AVRO_ID,
+                                               sessionTicket_->ticket_, requestEncoded));
+        return;
+    }
+
+    /*
+     * Reconnects to the same server reuse the session key, so it is RSA encrypted and signed only once.
+     */
+    if (!connectCredentials_) {
+        auto credentials = std::make_shared<TcpConnectCredentials>();
+        credentials->sessionKey_ = encDec_.getSessionKey();
+        credentials->encodedSessionKey_ = encDec_.getEncodedSessionKey();
+        credentials->signature_ = encDec_.signData(credentials->encodedSessionKey_.data(),
+                                                   credentials->encodedSessionKey_.size());
+        credentials->serverHost_ = server_->getHost();
+        credentials->serverPort_ = server_->getPort();
+        credentials->serverKey_ = server_->getPublicKey();
+        connectCredentials_ = credentials;
+    } else {
+        KAA_LOG_TRACE(boost::format("Channel [%1%] reusing CONNECT credentials") % channelId_);
+    }
+
+    sendData(ConnectMessage(CHANNEL_TIMEOUT, KAA_PLATFORM_PROTOCOL_AVRO_ID, connectCredentials_->signature_,
+                            connectCredentials_->encodedSessionKey_, requestEncoded));
 }
 
 void ChannelConnection::sendDisconnect()
 {
     KAA_LOG_TRACE(boost::format("Channel [%1%] sending DISCONNECT") % channelId_);
+    auto msg = DisconnectMessage(DisconnectReason::NONE);
+    const auto data = msg.getRawMessage();
+
+    if (isIoPolled_) {
+        // The polled I/O service isn't run while waiting here, so the DISCONNECT is written without
+        // blocking instead. It is dropped if the socket buffer is full: the socket is closed anyway.
+        boost::system::error_code errorCode;
+        sock_.non_blocking(true, errorCode);
+        boost::asio::write(sock_,
+                boost::asio::buffer(reinterpret_cast<const char *>(data.data()), data.size()),
+                errorCode);
+        if (errorCode) {
+            KAA_LOG_DEBUG(boost::format("Channel [%1%] failed to send DISCONNECT: %2%") % channelId_ % errorCode.message());
+        }
+        return;
+    }
+
     // The DISCONNECT message is sent synchronously with timeout equal to DISCONNECT_TIMEOUT.
     // This is done in order to keep the ChannelConnection alive until the DISCONNECT is delivered
     // or timeout occurs.
     std::condition_variable cv;
     std::mutex cvMutex;
-    auto msg = DisconnectMessage(DisconnectReason::NONE);
-    const auto data = msg.getRawMessage();
     boost::asio::async_write(sock_,
             boost::asio::buffer(reinterpret_cast<const char *>(data.data()), data.size()),
             [this, &cv] (const boost::system::error_code &ec, std::size_t bytes_transferred)
@@ -447,6 +1004,13 @@ void ChannelConnection::sendPingRequest()
         return;
     }
     KAA_LOG_TRACE(boost::format("Channel [%1%] sending PING") % channelId_);
+
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (!isPingInFlight_) {
+        isPingInFlight_ = true;
+        pingSentAt_ = std::chrono::steady_clock::now();
+        pingIdleTime_ = pingSentAt_ - lastActivityAt_;
+    }
     sendData(PingRequest());
 }
 
@@ -455,7 +1019,7 @@ void ChannelConnection::readFromSocket()
     if (state_ == State::Disconnected) {
         return;
     }
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
     boost::asio::async_read(sock_, responseBuffer_, boost::asio::transfer_at_least(1),
                             boost::bind(&ChannelConnection::onReadEvent, shared_from_this(),
                                         boost::asio::placeholders::error));
@@ -466,14 +1030,26 @@ void ChannelConnection::setPingTimer()
     if (state_ == State::Disconnected) {
         return;
     }
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
-    pingTimer_.expires_from_now(boost::posix_time::seconds(PING_TIMEOUT));
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+    if (isSuspended_) {
+        return;
+    }
+
+    /*
+     * Waits for the PING response if one is in flight, otherwise until the connection has been idle
+     * for the keepalive interval.
+     */
+    auto deadline = isPingInFlight_ ? pingSentAt_ + std::chrono::seconds(PING_RESPONSE_TIMEOUT)
+                                    : lastActivityAt_ + keepAliveTuner_.getInterval();
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+    pingTimer_.expires_from_now(boost::posix_time::milliseconds(std::max<std::int64_t>(delay.count(), 0)));
     pingTimer_.async_wait(std::bind(&ChannelConnection::onPingTimeout, shared_from_this(), std::placeholders::_1));
 }
 
 void ChannelConnection::setConnAckTimer()
 {
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
     connAckTimer_.expires_from_now(boost::posix_time::seconds(CONN_ACK_TIMEOUT));
     connAckTimer_.async_wait(std::bind(&ChannelConnection::onConnAckTimeout, shared_from_this(), std::placeholders::_1));
 }
@@ -483,7 +1059,7 @@ void ChannelConnection::syncAck(TransportType type)
     if (state_ == State::Disconnected) {
         return;
     }
-    std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+    std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
     ackTypes_.push_back(type);
 }
 
@@ -529,27 +1105,38 @@ void ChannelConnection::syncAll()
 void ChannelConnection::onReadEvent(const boost::system::error_code& err)
 {
     if (!err) {
-        std::ostringstream responseStream;
-        responseStream << &responseBuffer_;
-        const auto& responseStr = responseStream.str();
+        /*
+         * Messages are parsed right in the input sequence of the buffer, it is consumed afterwards.
+         */
+        const auto& responseData = responseBuffer_.data();
+        std::size_t responseSize = boost::asio::buffer_size(responseData);
+        metrics_.onBytesReceived(responseSize);
+        lastActivityAt_ = std::chrono::steady_clock::now();
         try {
-            if (responseStr.empty()) {
+            if (!responseSize) {
                  KAA_LOG_ERROR(boost::format("Channel [%1%] no data read from socket") % channelId_);
             } else {
-                responseProcessor_.processResponseBuffer(responseStr.data(), responseStr.size());
+                for (auto it = responseData.begin(); it != responseData.end(); ++it) {
+                    responseProcessor_.processResponseBuffer(boost::asio::buffer_cast<const char *>(*it),
+                                                             boost::asio::buffer_size(*it));
+                }
             }
         } catch (const TransportRedirectException& exception) {
             KAA_LOG_INFO(boost::format("Channel [%1%] received REDIRECT response") % channelId_);
+            responseBuffer_.consume(responseSize);
             return;
         } catch (const KaaException& exception) {
             KAA_LOG_ERROR(boost::format("Channel [%1%] failed to process data: %2%")
                           % channelId_ % exception.what());
             channel_->onServerFailed();
         }
+        responseBuffer_.consume(responseSize);
     } else {
         KAA_LOG_WARN(boost::format("Channel [%1%] socket error: %2%") % channelId_ % err.message());
 
         if (err != boost::asio::error::operation_aborted && state_ != State::Disconnected) {
+            // A connection dropped by NAT is usually reset once a PING reaches it.
+            onKeepAliveLost();
             channel_->onServerFailed();
             return;
         } else {
@@ -567,7 +1154,22 @@ void ChannelConnection::onReadEvent(const boost::system::error_code& err)
 void ChannelConnection::onPingTimeout(const boost::system::error_code& err)
 {
     if (!err) {
-        sendPingRequest();
+        bool isPingLost = false;
+        {
+            std::lock_guard<KAA_R_MUTEX> lock(connectionMutex_);
+            auto now = std::chrono::steady_clock::now();
+            if (isPingInFlight_) {
+                isPingLost = (now - pingSentAt_ >= std::chrono::seconds(PING_RESPONSE_TIMEOUT));
+            } else if (!isSuspended_ && now - lastActivityAt_ >= keepAliveTuner_.getInterval()) {
+                sendPingRequest();
+            }
+        }
+
+        if (isPingLost) {
+            onKeepAliveLost();
+            channel_->onServerFailed();
+            return;
+        }
     } else if (err != boost::asio::error::operation_aborted && state_ != State::Disconnected) {
         KAA_LOG_ERROR(boost::format("Channel [%1%] failed to process PING: %2%")
                       % channelId_ % err.message());
@@ -605,37 +1207,167 @@ void ChannelConnection::onConnAckTimeout(const boost::system::error_code& err)
 
 DefaultOperationTcpChannel::DefaultOperationTcpChannel(IKaaChannelManager& channelManager,
                                                        const KeyPair& clientKeys,
-                                                       IKaaClientContext& context)
+                                                       IKaaClientContext& context,
+                                                       IoServicePoolPtr ioServicePool)
     : context_(context),
       channelManager_(channelManager),
+      ioServicePool_(ioServicePool),
+      ownIoService_(ioServicePool ? nullptr : new boost::asio::io_service),
+      io_(ioServicePool ? ioServicePool->getIoService() : *ownIoService_),
+      work_(ioServicePool ? nullptr : new boost::asio::io_service::work(io_)),
+      lifeToken_(std::make_shared<bool>(true)),
       clientKeys_(clientKeys),
-      work_(io_)
+      maxInFlightSyncRequests_(DEFAULT_MAX_IN_FLIGHT_SYNC_REQUESTS),
+      keepAliveTuner_(std::chrono::seconds(MIN_KEEPALIVE_INTERVAL), std::chrono::seconds(MAX_KEEPALIVE_INTERVAL))
 {
-    startThreads();
+    keepAliveTuner_.restore(std::chrono::seconds(context_.getStatus().getKeepAliveInterval()));
+
+    if (ioServicePool_ && ioServicePool_->isPolled()) {
+        KAA_LOG_TRACE(boost::format("Channel [%1%] uses polled IO service") % getId());
+    } else if (ioServicePool_) {
+        KAA_LOG_TRACE(boost::format("Channel [%1%] uses shared IO service pool of %2% threads")
+                      % getId() % ioServicePool_->getSize());
+    } else {
+        startThreads();
+    }
+}
+
+void DefaultOperationTcpChannel::setMaxInFlightSyncRequests(std::size_t count)
+{
+    if (!count) {
+        throw KaaException("Max number of in-flight sync requests should be greater than zero");
+    }
+
+    maxInFlightSyncRequests_ = count;
 }
 
 DefaultOperationTcpChannel::~DefaultOperationTcpChannel()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
-    if (!isShutdown_) {
-        shutdown();
+    if (connectivityChecker_) {
+        connectivityChecker_->removeConnectivityListener(this);
+    }
+
+    shutdown();
+
+    if (ioServicePool_) {
+        waitForPendingHandlers();
+    }
+}
+
+void DefaultOperationTcpChannel::setConnectivityChecker(ConnectivityCheckerPtr checker)
+{
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    if (connectivityChecker_) {
+        connectivityChecker_->removeConnectivityListener(this);
+    }
+
+    connectivityChecker_ = checker;
+
+    /*
+     * The listener is called from the checker's thread, so it only posts the change.
+     */
+    if (connectivityChecker_) {
+        connectivityChecker_->addConnectivityListener(this, [this] (bool isConnected)
+            {
+                post(std::bind(&DefaultOperationTcpChannel::onConnectivityChanged, this, isConnected));
+            });
+    }
+}
+
+void DefaultOperationTcpChannel::onConnectivityChanged(bool isConnected)
+{
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    KAA_LOG_DEBUG(boost::format("Channel [%1%] connectivity is %2%") % getId() % (isConnected ? "up" : "down"));
+
+    if (!isConnected || !isWaitingForConnectivity_ || isShutdown_) {
+        return;
+    }
+
+    isWaitingForConnectivity_ = false;
+    if (!connection_ && currentServer_) {
+        KAA_LOG_INFO(boost::format("Channel [%1%] reconnects: connectivity is back") % getId());
+        openConnection();
+    }
+}
+
+void DefaultOperationTcpChannel::post(const std::function<void ()>& task)
+{
+    std::weak_ptr<void> token = lifeToken_;
+    io_.post([token, task]
+        {
+            if (auto lock = token.lock()) {
+                task();
+            }
+        });
+}
+
+void DefaultOperationTcpChannel::waitForPendingHandlers()
+{
+    /*
+     * The shared I/O service keeps running, so wait until no handler refers to the channel.
+     */
+    std::weak_ptr<void> token = lifeToken_;
+    lifeToken_.reset();
+
+    std::vector<std::weak_ptr<ChannelConnection>> closedConnections;
+    {
+        std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+        closedConnections.swap(closedConnections_);
+    }
+
+    auto isPending = [&token, &closedConnections] ()
+        {
+            return !token.expired() ||
+                std::any_of(closedConnections.begin(), closedConnections.end(),
+                            [] (const std::weak_ptr<ChannelConnection>& connection) { return !connection.expired(); });
+        };
+
+    /*
+     * Nobody else runs the polled I/O service, so its handlers are run here.
+     */
+    const bool isIoPolled = ioServicePool_->isPolled();
+
+    while (isPending()) {
+        if (!isIoPolled || !io_.poll_one()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
     }
 }
 
 void DefaultOperationTcpChannel::openConnection()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    if (isShutdown_) {
+        KAA_LOG_WARN(boost::format("Channel [%1%] can't open connection: channel is shut down") % getId());
+        return;
+    }
+
     if (connection_ != nullptr) {
         KAA_LOG_WARN(boost::format("Channel [%1%] connection is already opened") % getId());
         return;
     }
 
+    isWaitingForConnectivity_ = false;
+
     KAA_LOG_INFO(boost::format("Channel [%1%] opening connection to %2%:%3%")
                  % getId() % currentServer_->getHost() % currentServer_->getPort());
+
+    if (sessionTicket_ && !sessionTicket_->isValidFor(*currentServer_)) {
+        KAA_LOG_DEBUG(boost::format("Channel [%1%] drops expired or foreign session ticket") % getId());
+        sessionTicket_.reset();
+    }
+
+    if (connectCredentials_ && !connectCredentials_->isValidFor(*currentServer_)) {
+        KAA_LOG_DEBUG(boost::format("Channel [%1%] drops CONNECT credentials of another server") % getId());
+        connectCredentials_.reset();
+    }
+
     try {
         connection_ = std::make_shared<ChannelConnection>(channelManager_, clientKeys_,
                                                           context_, multiplexer_, demultiplexer_,
-                                                          this, getId(), *currentServer_, io_);
+                                                          this, getId(), currentServer_, io_,
+                                                          ioServicePool_ && ioServicePool_->isPolled(), sessionTicket_,
+                                                          connectCredentials_, metrics_, keepAliveTuner_);
         connection_->run();
     } catch (KaaFailoverReason r) {
         onServerFailed(r);
@@ -644,7 +1376,7 @@ void DefaultOperationTcpChannel::openConnection()
 
 void DefaultOperationTcpChannel::closeConnection()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (!connection_) {
         KAA_LOG_WARN(boost::format("Channel [%1%] can't close connection: connection is null") % getId());
         return;
@@ -652,19 +1384,37 @@ void DefaultOperationTcpChannel::closeConnection()
 
     KAA_LOG_INFO(boost::format("Channel [%1%] closing connection") % getId())
     connection_->shutdown();
+
+    if (ioServicePool_) {
+        closedConnections_.erase(std::remove_if(closedConnections_.begin(), closedConnections_.end(),
+                                                [] (const std::weak_ptr<ChannelConnection>& connection)
+                                                {
+                                                    return connection.expired();
+                                                }),
+                                 closedConnections_.end());
+        closedConnections_.push_back(connection_);
+    }
+
     connection_.reset();
 }
 
 void DefaultOperationTcpChannel::onServerFailed(KaaFailoverReason failoverReason)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (isFailoverInProgress_) {
         KAA_LOG_TRACE(boost::format("Channel [%1%] failover processing already in progress. Ignore '%2%' failover")
                       % getId() % LoggingUtils::toString(failoverReason));
         return;
     }
 
+    if (isPaused_) {
+        KAA_LOG_INFO(boost::format("Channel [%1%] lost connection while paused, reconnecting on resume") % getId());
+        closeConnection();
+        return;
+    }
+
     isFailoverInProgress_ = true;
+    metrics_.onServerFailed();
 
     closeConnection();
 
@@ -673,6 +1423,7 @@ void DefaultOperationTcpChannel::onServerFailed(KaaFailoverReason failoverReason
         if (connectivityChecker_ && !connectivityChecker_->checkConnectivity()) {
             KAA_LOG_INFO(boost::format("Channel [%1%] detected loss of connectivity") % getId());
             finalFailoverReason = KaaFailoverReason::NO_CONNECTIVITY;
+            isWaitingForConnectivity_ = true;
         }
     }
 
@@ -682,9 +1433,45 @@ void DefaultOperationTcpChannel::onServerFailed(KaaFailoverReason failoverReason
     channelManager_.onServerFailed(currentServer_, finalFailoverReason);
 }
 
+void DefaultOperationTcpChannel::onSessionTicket(const std::vector<std::uint8_t>& ticket,
+                                                 std::uint16_t lifetime,
+                                                 const SessionKey& sessionKey)
+{
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    if (!lifetime) {
+        sessionTicket_.reset();
+        return;
+    }
+
+    auto sessionTicket = std::make_shared<TcpSessionTicket>();
+    sessionTicket->ticket_ = ticket;
+    sessionTicket->sessionKey_ = sessionKey;
+    sessionTicket->expiresAt_ = std::chrono::steady_clock::now() + std::chrono::seconds(lifetime);
+    sessionTicket->serverHost_ = currentServer_->getHost();
+    sessionTicket->serverPort_ = currentServer_->getPort();
+    sessionTicket->serverKey_ = currentServer_->getPublicKey();
+    sessionTicket_ = sessionTicket;
+}
+
+void DefaultOperationTcpChannel::onConnectCredentials(TcpConnectCredentialsPtr credentials)
+{
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    connectCredentials_ = credentials;
+}
+
+void DefaultOperationTcpChannel::onSessionResumptionRefused()
+{
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+    sessionTicket_.reset();
+    post([this] {
+        closeConnection();
+        openConnection();
+    });
+}
+
 void DefaultOperationTcpChannel::startThreads()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (!ioThreads_.empty()) {
         return;
     }
@@ -717,7 +1504,7 @@ void DefaultOperationTcpChannel::startThreads()
 
 void DefaultOperationTcpChannel::stopThreads()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     for (std::size_t i = 0; i < THREADPOOL_SIZE; ++i) {
         if (ioThreads_[i].joinable()) {
             ioThreads_[i].join();
@@ -732,19 +1519,19 @@ void DefaultOperationTcpChannel::stopThreads()
 
 void DefaultOperationTcpChannel::setMultiplexer(IKaaDataMultiplexer *multiplexer)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     multiplexer_ = multiplexer;
 }
 
 void DefaultOperationTcpChannel::setDemultiplexer(IKaaDataDemultiplexer *demultiplexer)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     demultiplexer_ = demultiplexer;
 }
 
 void DefaultOperationTcpChannel::setServer(ITransportConnectionInfoPtr server)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (isShutdown_) {
         KAA_LOG_WARN(boost::format("Channel [%1%] ignore new server: channel is shut down") % getId());
         return;
@@ -761,15 +1548,17 @@ void DefaultOperationTcpChannel::setServer(ITransportConnectionInfoPtr server)
 
     currentServer_ = std::make_shared<IPTransportInfo>(server);
     isFailoverInProgress_ = false;
-    io_.post([this] {
+    post([this] {
         closeConnection();
-        openConnection();
+        if (!isPaused_) {
+            openConnection();
+        }
     });
 }
 
 void DefaultOperationTcpChannel::sync(TransportType type)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (connection_) {
         connection_->sync(type);
     } else {
@@ -779,7 +1568,7 @@ void DefaultOperationTcpChannel::sync(TransportType type)
 
 void DefaultOperationTcpChannel::syncAll()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (!connection_) {
         KAA_LOG_WARN(boost::format("Channel [%1%] can't sync: connection is not opened") % getId());
         return;
@@ -789,7 +1578,7 @@ void DefaultOperationTcpChannel::syncAll()
 
 void DefaultOperationTcpChannel::syncAck(TransportType type)
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (!connection_) {
         KAA_LOG_ERROR(boost::format("Channel [%1%] failed to add ACK for transport %2%: connection is null")
                       % getId() % LoggingUtils::toString(type));
@@ -802,7 +1591,7 @@ void DefaultOperationTcpChannel::syncAck(TransportType type)
 
 void DefaultOperationTcpChannel::shutdown()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     KAA_LOG_DEBUG(boost::format("Channel [%1%] is shutting down: isShutdown '%2%'")
                   % getId() % boost::io::group(std::boolalpha, isShutdown_));
 
@@ -810,6 +1599,10 @@ void DefaultOperationTcpChannel::shutdown()
         isShutdown_ = true;
         closeConnection();
 
+        if (ioServicePool_) {
+            return;
+        }
+
         KAA_LOG_TRACE(boost::format("Channel [%1%] stopping IO service: isStopped '%2%'")
                       % getId() % boost::io::group(std::boolalpha, io_.stopped()));
 
@@ -823,24 +1616,56 @@ void DefaultOperationTcpChannel::shutdown()
 
 void DefaultOperationTcpChannel::pause()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (isShutdown_) {
         KAA_LOG_WARN(boost::format("Channel [%1%] can't pause: channel is shut down") % getId());
         return;
     }
 
-    closeConnection();
+    if (isPaused_) {
+        return;
+    }
+
+    isPaused_ = true;
+    isWaitingForConnectivity_ = false;
+
+    /*
+     * Either way the session ticket and CONNECT credentials are kept, so a closed connection is
+     * reopened on resume without a new RSA handshake while they are valid.
+     */
+    if (connection_ && context_.getProperties().isWarmPause()) {
+        KAA_LOG_INFO(boost::format("Channel [%1%] pausing, connection is kept open") % getId());
+        connection_->suspend();
+    } else {
+        closeConnection();
+    }
 }
 
 void DefaultOperationTcpChannel::resume()
 {
-    std::lock_guard<std::recursive_mutex> lock(channelGuard_);
+    std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
     if (isShutdown_) {
         KAA_LOG_WARN(boost::format("Channel [%1%] can't resume: channel is shut down") % getId());
         return;
     }
 
-    io_.post(std::bind(&DefaultOperationTcpChannel::openConnection, this));
+    if (!isPaused_) {
+        return;
+    }
+
+    isPaused_ = false;
+    post([this] {
+        std::lock_guard<KAA_R_MUTEX> lock(channelGuard_);
+        if (isPaused_) {
+            return;
+        }
+
+        if (connection_) {
+            connection_->resume();
+        } else {
+            openConnection();
+        }
+    });
 }
 
 }
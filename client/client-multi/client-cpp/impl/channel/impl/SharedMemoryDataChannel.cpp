@@ -0,0 +1,375 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/channel/impl/SharedMemoryDataChannel.hpp"
+
+#ifdef KAA_USE_SHM_CHANNEL
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+namespace {
+
+// Shared with the C SDK, see kaa_shm_channel.h
+const std::uint32_t SHM_MAGIC = 0x4D48534B;
+const std::uint32_t SHM_VERSION = 1;
+const std::uint32_t SHM_PAD = 0xFFFFFFFF;
+const std::uint32_t KAA_PLATFORM_PROTOCOL_AVRO_ID = 0xf291f2d4;
+
+// Keeps the indexes written by different processes on different cache lines
+const std::size_t SHM_LINE = 64;
+
+struct ShmIndex {
+    std::uint32_t value;
+    std::uint8_t  padding[SHM_LINE - sizeof(std::uint32_t)];
+};
+
+struct ShmHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t ringSize;
+    std::uint32_t platformProtocolId;
+    std::uint8_t  padding[SHM_LINE - 4 * sizeof(std::uint32_t)];
+    ShmIndex      uplinkWrite;
+    ShmIndex      uplinkRead;
+    ShmIndex      downlinkWrite;
+    ShmIndex      downlinkRead;
+};
+
+std::uint32_t align(std::size_t size)
+{
+    return static_cast<std::uint32_t>((size + 3) & ~static_cast<std::size_t>(3));
+}
+
+}
+
+const std::size_t SharedMemoryDataChannel::DEFAULT_RING_SIZE;
+
+const std::string SharedMemoryDataChannel::CHANNEL_ID = "shared_memory_channel";
+const std::map<TransportType, ChannelDirection> SharedMemoryDataChannel::SUPPORTED_TYPES =
+        {
+                { TransportType::PROFILE, ChannelDirection::BIDIRECTIONAL },
+                { TransportType::CONFIGURATION, ChannelDirection::BIDIRECTIONAL },
+                { TransportType::NOTIFICATION, ChannelDirection::BIDIRECTIONAL },
+                { TransportType::USER, ChannelDirection::BIDIRECTIONAL },
+                { TransportType::EVENT, ChannelDirection::BIDIRECTIONAL },
+                { TransportType::LOGGING, ChannelDirection::BIDIRECTIONAL }
+        };
+
+SharedMemoryDataChannel::SharedMemoryDataChannel(IKaaClientContext& context, const std::string& name,
+                                                 std::size_t ringSize, std::chrono::milliseconds pollPeriod)
+    : name_(name), pollPeriod_(pollPeriod), context_(context)
+{
+    if (ringSize < SHM_LINE || ringSize > UINT32_MAX / 2 || (ringSize & (ringSize - 1))) {
+        throw KaaException(boost::format("Shared memory ring size %1% is not a power of two") % ringSize);
+    }
+
+    attach(ringSize);
+    pollThread_ = std::thread(&SharedMemoryDataChannel::run, this);
+}
+
+SharedMemoryDataChannel::~SharedMemoryDataChannel()
+{
+    shutdown();
+}
+
+void SharedMemoryDataChannel::attach(std::size_t ringSize)
+{
+    segmentSize_ = sizeof(ShmHeader) + 2 * ringSize;
+
+    int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    isOwner_ = fd >= 0;
+    if (fd < 0 && errno == EEXIST) {
+        fd = shm_open(name_.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0) {
+        throw KaaException(boost::format("Failed to open shared memory '%1%': %2%") % name_ % std::strerror(errno));
+    }
+
+    struct stat info;
+    if (isOwner_ ? ftruncate(fd, static_cast<off_t>(segmentSize_)) : fstat(fd, &info)) {
+        int error = errno;
+        close(fd);
+        detach();
+        throw KaaException(boost::format("Failed to size shared memory '%1%': %2%") % name_ % std::strerror(error));
+    }
+    if (!isOwner_ && static_cast<std::size_t>(info.st_size) != segmentSize_) {
+        close(fd);
+        throw KaaException(boost::format("Shared memory '%1%' has %2% bytes, %3% expected")
+                           % name_ % info.st_size % segmentSize_);
+    }
+
+    void *segment = mmap(nullptr, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        detach();
+        throw KaaException(boost::format("Failed to map shared memory '%1%'") % name_);
+    }
+    segment_ = segment;
+
+    auto header = static_cast<ShmHeader *>(segment_);
+    if (isOwner_) {
+        // ftruncate() zeroes the segment, the indexes start at 0. The magic goes last,
+        // so a half-initialized segment is never accepted.
+        header->version = SHM_VERSION;
+        header->ringSize = static_cast<std::uint32_t>(ringSize);
+        header->platformProtocolId = KAA_PLATFORM_PROTOCOL_AVRO_ID;
+        __atomic_store_n(&header->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC
+            || header->version != SHM_VERSION
+            || header->ringSize != ringSize
+            || header->platformProtocolId != KAA_PLATFORM_PROTOCOL_AVRO_ID) {
+        detach();
+        throw KaaException(boost::format("Shared memory '%1%' has unexpected layout") % name_);
+    }
+
+    auto rings = static_cast<std::uint8_t *>(segment_) + sizeof(ShmHeader);
+    uplink_ = { &header->uplinkWrite.value, &header->uplinkRead.value, rings, static_cast<std::uint32_t>(ringSize) };
+    downlink_ = { &header->downlinkWrite.value, &header->downlinkRead.value, rings + ringSize,
+                  static_cast<std::uint32_t>(ringSize) };
+
+    KAA_LOG_INFO(boost::format("Channel [%1%] %2% shared memory '%3%' (ring size %4%)")
+                 % getId() % (isOwner_ ? "created" : "attached to") % name_ % ringSize);
+}
+
+void SharedMemoryDataChannel::detach()
+{
+    if (segment_) {
+        munmap(segment_, segmentSize_);
+        segment_ = nullptr;
+    }
+    if (isOwner_) {
+        shm_unlink(name_.c_str());
+        isOwner_ = false;
+    }
+}
+
+bool SharedMemoryDataChannel::push(const AvroChunkedOutputStream& record)
+{
+    std::size_t dataSize = record.byteCount();
+    std::uint32_t recordSize = sizeof(std::uint32_t) + align(dataSize);
+    if (recordSize > uplink_.size / 2) {
+        KAA_LOG_ERROR(boost::format("Channel [%1%] drops request of %2% bytes: it doesn't fit into the ring")
+                      % getId() % dataSize);
+        return true;
+    }
+
+    std::uint32_t writeIndex = __atomic_load_n(uplink_.writeIndex, __ATOMIC_RELAXED);
+    std::uint32_t readIndex = __atomic_load_n(uplink_.readIndex, __ATOMIC_ACQUIRE);
+
+    std::uint32_t offset = writeIndex & (uplink_.size - 1);
+    std::uint32_t tailSpace = uplink_.size - offset;
+    std::uint32_t skipped = tailSpace < recordSize ? tailSpace : 0;
+
+    if (uplink_.size - (writeIndex - readIndex) < skipped + recordSize) {
+        return false;
+    }
+
+    if (skipped) {
+        *reinterpret_cast<std::uint32_t *>(uplink_.data + offset) = SHM_PAD;
+        writeIndex += skipped;
+        offset = 0;
+    }
+
+    /*
+     * The request is encoded into pooled chunks, they are copied to the ring one by one.
+     */
+    *reinterpret_cast<std::uint32_t *>(uplink_.data + offset) = static_cast<std::uint32_t>(dataSize);
+    record.copyTo(uplink_.data + offset + sizeof(std::uint32_t));
+
+    __atomic_store_n(uplink_.writeIndex, writeIndex + recordSize, __ATOMIC_RELEASE);
+
+    metrics_.onFramesSent();
+    metrics_.onBytesSent(dataSize);
+    return true;
+}
+
+void SharedMemoryDataChannel::flush()
+{
+    if (isShutdown_ || isPaused_ || !multiplexer_) {
+        return;
+    }
+
+    if (pendingRequest_.empty() && !pendingTypes_.empty()) {
+        multiplexer_->compileRequest(pendingTypes_, pendingRequest_);
+        pendingTypes_.clear();
+    }
+
+    if (!pendingRequest_.empty()) {
+        if (push(pendingRequest_)) {
+            pendingRequest_.clear();
+        } else {
+            KAA_LOG_DEBUG(boost::format("Channel [%1%] uplink is full, %2% bytes postponed")
+                          % getId() % pendingRequest_.byteCount());
+        }
+    }
+}
+
+void SharedMemoryDataChannel::drain()
+{
+    // Only this thread reads the downlink, so the records are processed in place
+    // and released afterwards. The lock isn't held meanwhile, as the demultiplexer
+    // may sync in response.
+    IKaaDataDemultiplexer *demultiplexer = nullptr;
+    std::uint32_t readIndex = 0;
+    std::uint32_t writeIndex = 0;
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+        if (isPaused_ || !demultiplexer_) {
+            return;
+        }
+        demultiplexer = demultiplexer_;
+        readIndex = __atomic_load_n(downlink_.readIndex, __ATOMIC_RELAXED);
+        writeIndex = __atomic_load_n(downlink_.writeIndex, __ATOMIC_ACQUIRE);
+    }
+
+    while (readIndex != writeIndex) {
+        std::uint32_t offset = readIndex & (downlink_.size - 1);
+        std::uint32_t size = *reinterpret_cast<const std::uint32_t *>(downlink_.data + offset);
+
+        if (size == SHM_PAD) {
+            readIndex += downlink_.size - offset;
+            __atomic_store_n(downlink_.readIndex, readIndex, __ATOMIC_RELEASE);
+            continue;
+        }
+        if (size > downlink_.size - offset - sizeof(std::uint32_t)) {
+            KAA_LOG_ERROR(boost::format("Channel [%1%] downlink is corrupted") % getId());
+            return;
+        }
+
+        metrics_.onFrameReceived();
+        metrics_.onBytesReceived(size);
+
+        if (demultiplexer->processResponse(downlink_.data + offset + sizeof(std::uint32_t), size)
+                != DemultiplexerReturnCode::SUCCESS) {
+            KAA_LOG_ERROR(boost::format("Channel [%1%] failed to process response") % getId());
+        }
+
+        readIndex += sizeof(std::uint32_t) + align(size);
+        __atomic_store_n(downlink_.readIndex, readIndex, __ATOMIC_RELEASE);
+    }
+}
+
+void SharedMemoryDataChannel::run()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    while (!isShutdown_) {
+        pollCondition_.wait_for(lock, pollPeriod_);
+        if (isShutdown_) {
+            break;
+        }
+
+        KAA_UNLOCK(lock);
+        drain();
+        KAA_LOCK(lock);
+
+        // Retries the postponed request and sends the ACKs collected while processing responses
+        flush();
+    }
+}
+
+void SharedMemoryDataChannel::sync(TransportType type)
+{
+    auto it = SUPPORTED_TYPES.find(type);
+    if (it == SUPPORTED_TYPES.end() || it->second == ChannelDirection::DOWN) {
+        KAA_LOG_ERROR(boost::format("Channel [%1%] ignore sync: unsupported transport type %2%")
+                      % getId() % LoggingUtils::toString(type));
+        return;
+    }
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    pendingTypes_.insert(*it);
+    flush();
+}
+
+void SharedMemoryDataChannel::syncAll()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    pendingTypes_.insert(SUPPORTED_TYPES.begin(), SUPPORTED_TYPES.end());
+    flush();
+}
+
+void SharedMemoryDataChannel::syncAck(TransportType type)
+{
+    auto it = SUPPORTED_TYPES.find(type);
+    if (it == SUPPORTED_TYPES.end()) {
+        return;
+    }
+
+    // Sent by the poll thread once the current response is processed
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_LOG_DEBUG(boost::format("Channel [%1%] adding ACK for transport '%2%'")
+                  % getId() % LoggingUtils::toString(type));
+    pendingTypes_.insert(*it);
+}
+
+void SharedMemoryDataChannel::setMultiplexer(IKaaDataMultiplexer *multiplexer)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    multiplexer_ = multiplexer;
+}
+
+void SharedMemoryDataChannel::setDemultiplexer(IKaaDataDemultiplexer *demultiplexer)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    demultiplexer_ = demultiplexer;
+}
+
+void SharedMemoryDataChannel::shutdown()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+        if (isShutdown_) {
+            return;
+        }
+        KAA_LOG_DEBUG(boost::format("Channel [%1%] is shutting down") % getId());
+        isShutdown_ = true;
+        KAA_CONDITION_NOTIFY(pollCondition_);
+    }
+
+    if (pollThread_.joinable()) {
+        pollThread_.join();
+    }
+    detach();
+}
+
+void SharedMemoryDataChannel::pause()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    isPaused_ = true;
+}
+
+void SharedMemoryDataChannel::resume()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    isPaused_ = false;
+    KAA_CONDITION_NOTIFY(pollCondition_);
+}
+
+}
+
+#endif
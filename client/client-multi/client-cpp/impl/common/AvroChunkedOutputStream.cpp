@@ -0,0 +1,123 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/common/AvroChunkedOutputStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kaa {
+
+const std::size_t AvroChunkPool::CHUNK_SIZE;
+const std::size_t AvroChunkPool::MAX_FREE_CHUNKS;
+
+AvroChunkPool::~AvroChunkPool()
+{
+    for (auto chunk : freeChunks_) {
+        delete [] chunk;
+    }
+}
+
+std::uint8_t *AvroChunkPool::acquire()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, poolGuard_);
+        if (!freeChunks_.empty()) {
+            std::uint8_t *chunk = freeChunks_.back();
+            freeChunks_.pop_back();
+            return chunk;
+        }
+    }
+
+    return new std::uint8_t[CHUNK_SIZE];
+}
+
+void AvroChunkPool::release(std::uint8_t *chunk)
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, poolGuard_);
+        if (freeChunks_.size() < MAX_FREE_CHUNKS) {
+            freeChunks_.push_back(chunk);
+            return;
+        }
+    }
+
+    delete [] chunk;
+}
+
+std::size_t AvroChunkPool::getFreeChunkCount()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, poolGuard_);
+    return freeChunks_.size();
+}
+
+AvroChunkPool& AvroChunkPool::getInstance()
+{
+    static AvroChunkPool instance;
+    return instance;
+}
+
+void AvroChunkedOutputStream::write(const std::uint8_t *data, std::size_t size)
+{
+    while (size) {
+        std::uint8_t *chunk = nullptr;
+        std::size_t chunkSize = 0;
+        next(&chunk, &chunkSize);
+
+        std::size_t copied = std::min(size, chunkSize);
+        std::memcpy(chunk, data, copied);
+        backup(chunkSize - copied);
+
+        data += copied;
+        size -= copied;
+    }
+}
+
+std::vector<boost::asio::const_buffer> AvroChunkedOutputStream::getBuffers() const
+{
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(chunks_.size());
+
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+        std::size_t size = (i + 1 == chunks_.size()) ? lastChunkUsed_ : AvroChunkPool::CHUNK_SIZE;
+        if (size) {
+            buffers.push_back(boost::asio::const_buffer(chunks_[i], size));
+        }
+    }
+
+    return buffers;
+}
+
+void AvroChunkedOutputStream::copyTo(std::uint8_t *dest) const
+{
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+        std::size_t size = (i + 1 == chunks_.size()) ? lastChunkUsed_ : AvroChunkPool::CHUNK_SIZE;
+        std::memcpy(dest, chunks_[i], size);
+        dest += size;
+    }
+}
+
+void AvroChunkedOutputStream::clear()
+{
+    for (auto chunk : chunks_) {
+        pool_.release(chunk);
+    }
+
+    chunks_.clear();
+    lastChunkUsed_ = 0;
+}
+
+} /* namespace kaa */
@@ -23,6 +23,16 @@
 
 namespace kaa {
 
+EndpointObjectHash::EndpointObjectHash()
+{
+
+}
+
+EndpointObjectHash::~EndpointObjectHash()
+{
+
+}
+
 EndpointObjectHash::EndpointObjectHash(const std::uint8_t *data, const std::uint32_t &dataSize)
 {
     calculateHash(data, dataSize);
@@ -43,7 +53,8 @@ EndpointObjectHash::EndpointObjectHash(const EndpointObjectHash& endpointHash) :
 
 }
 
-EndpointObjectHash::EndpointObjectHash(EndpointObjectHash&& endpointHash) : hashDigest_(std::move(endpointHash.hashDigest_))
+EndpointObjectHash::EndpointObjectHash(EndpointObjectHash&& endpointHash)
+    : hashDigest_(std::move(endpointHash.hashDigest_)), hashFunction_(std::move(endpointHash.hashFunction_))
 {
 
 }
@@ -57,14 +68,49 @@ EndpointObjectHash& EndpointObjectHash::operator=(const EndpointObjectHash& endp
 EndpointObjectHash& EndpointObjectHash::operator=(EndpointObjectHash&& endpointHash)
 {
     hashDigest_ = std::move(endpointHash.hashDigest_);
+    hashFunction_ = std::move(endpointHash.hashFunction_);
     return *this;
 }
 
+EndpointObjectHash EndpointObjectHash::fromDigest(const HashDigest& digest)
+{
+    EndpointObjectHash hash;
+    hash.hashDigest_ = digest;
+    return hash;
+}
+
 std::vector<std::uint8_t> EndpointObjectHash::getHashDigest()
 {
     return hashDigest_;
 }
 
+EndpointObjectHash& EndpointObjectHash::update(const std::uint8_t* data, std::size_t dataSize)
+{
+    if (!data && dataSize != 0) {
+        throw KaaException("empty raw data or null size");
+    }
+
+    if (!hashFunction_) {
+        hashFunction_.reset(new Botan::SHA_160);
+    }
+
+    hashFunction_->update(data, dataSize);
+    return *this;
+}
+
+void EndpointObjectHash::finalize()
+{
+    if (!hashFunction_) {
+        hashFunction_.reset(new Botan::SHA_160);
+    }
+
+    /*
+     * The hash function is reset by final(), so it is kept for the next hash.
+     */
+    const auto& result = hashFunction_->final();
+    hashDigest_.assign(result.begin(), result.end());
+}
+
 void EndpointObjectHash::calculateHash(const std::uint8_t* data, std::uint32_t dataSize)
 {
     if (!data && dataSize != 0) {
@@ -18,6 +18,8 @@
 
 #ifdef KAA_USE_CONFIGURATION
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "kaa/common/exception/KaaException.hpp"
@@ -32,7 +34,7 @@
 namespace kaa {
 
 ConfigurationManager::ConfigurationManager(IKaaClientContext &context)
-    : isConfigurationLoaded_(false), context_(context)
+    : isConfigurationLoaded_(false), context_(context), isNotificationPending_(false)
 {}
 
 void ConfigurationManager::addReceiver(IConfigurationReceiver &receiver)
@@ -59,7 +61,7 @@ void ConfigurationManager::init()
         loadConfiguration();
     }
 
-    notifySubscribers(configuration_);
+    notifySubscribers();
 }
 
 const KaaRootConfiguration& ConfigurationManager::getConfiguration()
@@ -75,12 +77,36 @@ const KaaRootConfiguration& ConfigurationManager::getConfiguration()
     return configuration_;
 }
 
+std::shared_ptr<const KaaRootConfiguration> ConfigurationManager::getConfigurationSnapshot()
+{
+    auto snapshot = std::atomic_load(&configurationSnapshot_);
+    if (snapshot) {
+        return snapshot;
+    }
+
+    /*
+     * Nothing is published before the configuration is loaded.
+     */
+    getConfiguration();
+    return std::atomic_load(&configurationSnapshot_);
+}
+
 void ConfigurationManager::updateConfiguration(const std::uint8_t* data, const std::uint32_t dataSize)
+{
+    updateConfiguration(data, dataSize, EndpointObjectHash(data, dataSize));
+}
+
+void ConfigurationManager::updateConfiguration(const std::uint8_t* data, const std::uint32_t dataSize,
+                                               EndpointObjectHash&& hash)
 {
     AvroByteArrayConverter<KaaRootConfiguration> converter;
 
-    converter.fromByteArray(data, dataSize, configuration_);
-    configurationHash_ = EndpointObjectHash(data, dataSize);
+    auto snapshot = std::make_shared<KaaRootConfiguration>();
+    converter.fromByteArray(data, dataSize, *snapshot);
+
+    configuration_ = *snapshot;
+    std::atomic_store(&configurationSnapshot_, std::shared_ptr<const KaaRootConfiguration>(std::move(snapshot)));
+    configurationHash_ = std::move(hash);
 
     KAA_LOG_TRACE(boost::format("Calculated configuration hash: %1%") %
             LoggingUtils::toString(configurationHash_.getHashDigest()));
@@ -93,9 +119,14 @@ void ConfigurationManager::loadConfiguration()
             KAA_LOG_INFO("Ignore loading configuration from storage: configuration version updated");
             storage_->clearConfiguration();
         } else {
-            auto data = storage_->loadConfiguration();
+            HashDigest storedHash;
+            auto data = storage_->loadConfigurationWithHash(storedHash);
             if (!data.empty()) {
-                updateConfiguration(data.data(), data.size());
+                if (storedHash.empty()) {
+                    updateConfiguration(data.data(), data.size());
+                } else {
+                    updateConfiguration(data.data(), data.size(), EndpointObjectHash::fromDigest(storedHash));
+                }
                 isConfigurationLoaded_ = true;
                 KAA_LOG_INFO("Loaded configuration from storage");
             }
@@ -121,13 +152,24 @@ void ConfigurationManager::processConfigurationData(const std::vector<std::uint8
     KAA_MUTEX_UNIQUE_DECLARE(configurationGuardLock, configurationGuard_);
     KAA_MUTEX_LOCKED("configurationGuard_");
 
-    updateConfiguration(data.data(), data.size());
+    /*
+     * The server resends the whole configuration, so an unchanged one is recognized by its hash
+     * without decoding, saving and delivering it again.
+     */
+    EndpointObjectHash receivedHash(data.data(), data.size());
+    if (isConfigurationLoaded_ && receivedHash == configurationHash_) {
+        KAA_LOG_DEBUG("Received configuration is the same as the current one, ignoring it");
+        return;
+    }
+
+    updateConfiguration(data.data(), data.size(), std::move(receivedHash));
+    isConfigurationLoaded_ = true;
 
     if (storage_) {
-        storage_->saveConfiguration(data);
+        storage_->saveConfigurationWithHash(data, configurationHash_.getHashDigest());
     }
 
-    notifySubscribers(configuration_);
+    notifySubscribers();
 }
 
 void ConfigurationManager::setConfigurationStorage(IConfigurationStoragePtr storage)
@@ -139,12 +181,31 @@ void ConfigurationManager::setConfigurationStorage(IConfigurationStoragePtr stor
     storage_ = storage;
 }
 
-void ConfigurationManager::notifySubscribers(const KaaRootConfiguration& configuration)
+void ConfigurationManager::notifySubscribers()
 {
-    context_.getExecutorContext().getCallbackExecutor().add([this, configuration]
-        {
-            configurationReceivers_(configuration);
-        });
+    /*
+     * Only the latest configuration is worth delivering, whatever the overflow policy of the executor is.
+     */
+    if (isNotificationPending_.exchange(true)) {
+        KAA_LOG_TRACE("Configuration notification is already pending, it will deliver the new configuration");
+        return;
+    }
+
+    try {
+        context_.getExecutorContext().getCallbackExecutor().addCoalescing(&configurationReceivers_, [this]
+            {
+                /*
+                 * Cleared before the snapshot is taken, so a newer configuration is notified again.
+                 * Receivers share one immutable copy.
+                 */
+                isNotificationPending_ = false;
+                auto snapshot = std::atomic_load(&configurationSnapshot_);
+                configurationReceivers_(*snapshot);
+            });
+    } catch (...) {
+        isNotificationPending_ = false;
+        throw;
+    }
 }
 
 }  // namespace kaa
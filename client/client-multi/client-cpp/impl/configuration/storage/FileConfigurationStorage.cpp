@@ -16,36 +16,143 @@
 
 #include "kaa/configuration/storage/FileConfigurationStorage.hpp"
 
-#include <fstream>
-#include <iterator>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 namespace kaa {
 
+/*
+ * File layout: magic, version, hash size, hash, data size (little-endian), data.
+ */
+static const char          FILE_MAGIC[] = { 'K', 'A', 'A', 'C' };
+static const std::uint8_t  FILE_VERSION = 1;
+static const std::size_t   DATA_SIZE_LENGTH = 4;
+static const std::size_t   FIXED_HEADER_SIZE = sizeof(FILE_MAGIC) + 2;
 
-void FileConfigurationStorage::saveConfiguration(const std::vector<std::uint8_t>& bytes)
+static const char * const  TEMPORARY_FILE_SUFFIX = ".tmp";
+
+static bool writeFully(std::FILE *file, const void *data, std::size_t size)
+{
+    return !size || std::fwrite(data, size, 1, file) == 1;
+}
+
+/*
+ * Makes the data durable before the file is renamed over the previous one.
+ */
+static bool syncFile(std::FILE *file)
 {
-    std::ofstream outFile(filename_, std::ofstream::binary);
-    if (outFile.good()) {
-        outFile.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
-        outFile.close();
+    if (std::fflush(file)) {
+        return false;
     }
+#ifdef _WIN32
+    return !_commit(_fileno(file));
+#else
+    return !fsync(fileno(file));
+#endif
+}
+
+static bool replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return !std::rename(from.c_str(), to.c_str());
+#endif
+}
+
+void FileConfigurationStorage::saveConfiguration(const std::vector<std::uint8_t>& bytes)
+{
+    saveConfigurationWithHash(bytes, HashDigest());
 }
 
 std::vector<std::uint8_t> FileConfigurationStorage::loadConfiguration()
 {
-    std::ifstream inFile(filename_, std::ifstream::ate | std::ifstream::binary);
-    if (inFile.good()) {
-        std::vector<std::uint8_t> result;
-        result.reserve(inFile.tellg());
-        inFile.seekg(0, std::ifstream::beg);
+    HashDigest hash;
+    return loadConfigurationWithHash(hash);
+}
 
-        result.assign(std::istreambuf_iterator<char>(inFile),
-                      std::istreambuf_iterator<char>());
+void FileConfigurationStorage::saveConfigurationWithHash(const std::vector<std::uint8_t>& bytes, const HashDigest& hash)
+{
+    if (hash.size() > UINT8_MAX) {
+        return;
+    }
+
+    const std::string temporaryFilename = filename_ + TEMPORARY_FILE_SUFFIX;
+    std::FILE *file = std::fopen(temporaryFilename.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+
+    std::uint8_t header[FIXED_HEADER_SIZE];
+    std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header[sizeof(FILE_MAGIC)] = FILE_VERSION;
+    header[sizeof(FILE_MAGIC) + 1] = static_cast<std::uint8_t>(hash.size());
+
+    std::uint8_t dataSize[DATA_SIZE_LENGTH];
+    for (std::size_t i = 0; i < DATA_SIZE_LENGTH; ++i) {
+        dataSize[i] = static_cast<std::uint8_t>(bytes.size() >> (8 * i));
+    }
+
+    bool isWritten = writeFully(file, header, sizeof(header))
+                  && writeFully(file, hash.data(), hash.size())
+                  && writeFully(file, dataSize, sizeof(dataSize))
+                  && writeFully(file, bytes.data(), bytes.size())
+                  && syncFile(file);
 
-        return result;
+    if (std::fclose(file) || !isWritten || !replaceFile(temporaryFilename, filename_)) {
+        std::remove(temporaryFilename.c_str());
+    }
+}
+
+std::vector<std::uint8_t> FileConfigurationStorage::loadConfigurationWithHash(HashDigest& hash)
+{
+    hash.clear();
+
+    try {
+        boost::interprocess::file_mapping file(filename_.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+
+        const std::uint8_t *data = static_cast<const std::uint8_t *>(region.get_address());
+        std::size_t size = region.get_size();
+
+        if (size < FIXED_HEADER_SIZE || std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC))) {
+            return std::vector<std::uint8_t>(data, data + size);
+        }
+
+        std::size_t hashSize = data[sizeof(FILE_MAGIC) + 1];
+        std::size_t dataOffset = FIXED_HEADER_SIZE + hashSize + DATA_SIZE_LENGTH;
+        if (data[sizeof(FILE_MAGIC)] != FILE_VERSION || size < dataOffset) {
+            return std::vector<std::uint8_t>();
+        }
+
+        std::size_t dataSize = 0;
+        for (std::size_t i = 0; i < DATA_SIZE_LENGTH; ++i) {
+            dataSize |= static_cast<std::size_t>(data[FIXED_HEADER_SIZE + hashSize + i]) << (8 * i);
+        }
+
+        if (size - dataOffset != dataSize) {
+            return std::vector<std::uint8_t>();
+        }
+
+        hash.assign(data + FIXED_HEADER_SIZE, data + FIXED_HEADER_SIZE + hashSize);
+        return std::vector<std::uint8_t>(data + dataOffset, data + size);
+    } catch (const boost::interprocess::interprocess_exception&) {
+        /*
+         * The file doesn't exist or is empty, i.e. it can't be mapped.
+         */
+        return std::vector<std::uint8_t>();
     }
-    return std::vector<std::uint8_t>();
 }
 
 void FileConfigurationStorage::clearConfiguration()
@@ -54,4 +161,3 @@ void FileConfigurationStorage::clearConfiguration()
 }
 
 }
-
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/context/AffinityExecutorContext.hpp"
+
+#include "kaa/utils/IThreadPool.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+AffinityExecutorContext::AffinityExecutorContext(const PoolSettings& lifeCycleSettings, const PoolSettings& apiSettings,
+                                                 const PoolSettings& callbackSettings, ThreadPoolType threadPoolType)
+    : AbstractExecutorContext(), apiSettings_(apiSettings), callbackSettings_(callbackSettings)
+    , lifeCycleSettings_(lifeCycleSettings), threadPoolType_(threadPoolType)
+{
+    if (!lifeCycleSettings_.threadCount_ || !apiSettings_.threadCount_ || !callbackSettings_.threadCount_) {
+        throw KaaException("Failed to create executor context: bad input parameters");
+    }
+
+    validateThreadSettings(lifeCycleSettings_.threadSettings_);
+    validateThreadSettings(apiSettings_.threadSettings_);
+    validateThreadSettings(callbackSettings_.threadSettings_);
+}
+
+IThreadPoolPtr AffinityExecutorContext::createPinnedExecutor(const PoolSettings& settings,
+                                                             const TaskQueueSettings& queueSettings)
+{
+    const ThreadSettings threadSettings = settings.threadSettings_;
+    return createExecutor(settings.threadCount_, threadPoolType_,
+                          [threadSettings] (std::size_t workerIndex)
+                              {
+                                  applyThreadSettings(threadSettings, workerIndex);
+                              },
+                          queueSettings);
+}
+
+void AffinityExecutorContext::doInit()
+{
+    lifeCycleExecutor_ = createPinnedExecutor(lifeCycleSettings_);
+    apiExecutor_ = createPinnedExecutor(apiSettings_);
+    callbackExecutor_ = createPinnedExecutor(callbackSettings_, getCallbackQueueSettings());
+}
+
+void AffinityExecutorContext::doStop()
+{
+    shutdownExecutor(lifeCycleExecutor_);
+    shutdownExecutor(apiExecutor_);
+    shutdownExecutor(callbackExecutor_);
+}
+
+} /* namespace kaa */
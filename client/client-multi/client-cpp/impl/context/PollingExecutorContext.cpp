@@ -0,0 +1,116 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/context/PollingExecutorContext.hpp"
+
+#include <algorithm>
+
+#include "kaa/utils/TimerService.hpp"
+#include "kaa/utils/IoServiceExecutor.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+PollingExecutorContext::PollingExecutorContext()
+    : AbstractExecutorContext(), ioServicePool_(IoServicePool::createPolled()), io_(ioServicePool_->getIoService()),
+      wakeUpTimer_(io_), wakeUpCount_(std::make_shared<std::atomic<std::size_t>>(0))
+{
+    boost::asio::io_service *io = &io_;
+    auto wakeUpCount = wakeUpCount_;
+
+    /*
+     * A timer scheduled by another thread wakes up the polling loop to wait for a shorter time.
+     */
+    bool isAttached = TimerService::getInstance().attachPoller([io, wakeUpCount]
+        {
+            io->post([wakeUpCount] { ++*wakeUpCount; });
+        });
+
+    if (!isAttached) {
+        throw KaaException("Failed to create polling executor context: timers are already run by another thread");
+    }
+}
+
+PollingExecutorContext::~PollingExecutorContext()
+{
+    TimerService::getInstance().detachPoller();
+}
+
+void PollingExecutorContext::doInit()
+{
+    lifeCycleExecutor_ = std::make_shared<IoServiceExecutor>(io_);
+    apiExecutor_ = std::make_shared<IoServiceExecutor>(io_);
+    callbackExecutor_ = std::make_shared<IoServiceExecutor>(io_);
+}
+
+void PollingExecutorContext::doStop()
+{
+    shutdownExecutor(lifeCycleExecutor_);
+    shutdownExecutor(apiExecutor_);
+    shutdownExecutor(callbackExecutor_);
+}
+
+template <typename RunFunction>
+std::size_t PollingExecutorContext::runIoHandlers(RunFunction run)
+{
+    std::size_t wakeUpCount = *wakeUpCount_;
+    std::size_t handlerCount = run();
+    return handlerCount - (*wakeUpCount_ - wakeUpCount);
+}
+
+std::size_t PollingExecutorContext::poll(std::chrono::milliseconds timeout)
+{
+    auto& timerService = TimerService::getInstance();
+    const auto deadline = TimerService::Clock::now() + timeout;
+
+    while (true) {
+        std::size_t eventCount = timerService.runExpired();
+        eventCount += runIoHandlers([this] { return io_.poll(); });
+
+        if (eventCount) {
+            return eventCount;
+        }
+
+        const auto now = TimerService::Clock::now();
+        if (deadline <= now) {
+            return 0;
+        }
+
+        const auto wakeUpAt = std::min(deadline, timerService.getNextDeadline());
+        if (wakeUpAt <= now) {
+            continue;
+        }
+
+        auto wakeUpCount = wakeUpCount_;
+        wakeUpTimer_.expires_at(wakeUpAt);
+        wakeUpTimer_.async_wait([wakeUpCount] (const boost::system::error_code&) { ++*wakeUpCount; });
+
+        eventCount = runIoHandlers([this] { return io_.run_one(); });
+
+        /*
+         * Handlers which got ready along with the first one are run at once. The cancelled wait
+         * is completed here or by the next run, neither counts it.
+         */
+        wakeUpTimer_.cancel();
+        eventCount += runIoHandlers([this] { return io_.poll(); });
+
+        if (eventCount) {
+            return eventCount;
+        }
+    }
+}
+
+} /* namespace kaa */
@@ -22,9 +22,10 @@
 
 namespace kaa {
 
-SimpleExecutorContext::SimpleExecutorContext(std::size_t lifeCycleThreadCount, std::size_t apiThreadCount, std::size_t callbackThreadCount)
+SimpleExecutorContext::SimpleExecutorContext(std::size_t lifeCycleThreadCount, std::size_t apiThreadCount, std::size_t callbackThreadCount,
+                                             ThreadPoolType threadPoolType)
     : AbstractExecutorContext(), apiThreadCount_(apiThreadCount), callbackThreadCount_(callbackThreadCount)
-    , lifeCycleThreadCount_(lifeCycleThreadCount)
+    , lifeCycleThreadCount_(lifeCycleThreadCount), threadPoolType_(threadPoolType)
 {
     if (!lifeCycleThreadCount_ || !apiThreadCount_ || !callbackThreadCount_) {
         throw KaaException("Failed to crate executor context: bad input parameters");
@@ -33,9 +34,10 @@ SimpleExecutorContext::SimpleExecutorContext(std::size_t lifeCycleThreadCount, s
 
 void SimpleExecutorContext::doInit()
 {
-    lifeCycleExecutor_ = createExecutor(lifeCycleThreadCount_);
-    apiExecutor_ = createExecutor(apiThreadCount_);
-    callbackExecutor_ = createExecutor(callbackThreadCount_);
+    lifeCycleExecutor_ = createExecutor(lifeCycleThreadCount_, threadPoolType_);
+    apiExecutor_ = createExecutor(apiThreadCount_, threadPoolType_);
+    callbackExecutor_ = createExecutor(callbackThreadCount_, threadPoolType_, ThreadPoolWorkerInitializer(),
+                                       getCallbackQueueSettings());
 }
 
 void SimpleExecutorContext::doStop()
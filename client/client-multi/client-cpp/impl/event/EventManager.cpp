@@ -29,6 +29,10 @@
 #include "kaa/common/exception/KaaException.hpp"
 #include "kaa/context/IExecutorContext.hpp"
 #include "kaa/utils/IThreadPool.hpp"
+#include "kaa/utils/ObjectPool.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/ILogStorageStatus.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
 #include "kaa/common/exception/TransportNotFoundException.hpp"
 
 namespace kaa {
@@ -39,6 +43,18 @@ void EventManager::registerEventFamily(IEventFamily* eventFamily)
         auto it = eventFamilies_.insert(eventFamily);
         if (!it.second) {
             KAA_LOG_WARN("Failed to register event family: already exists");
+            return;
+        }
+
+        std::size_t eventClassId = 0;
+        for (const auto& fqn : eventFamily->getSupportedEventClassFQNs()) {
+            auto& routes = eventFamiliesByFqn_[fqn];
+            if (std::find_if(routes.begin(), routes.end(),
+                             [eventFamily] (const EventFamilyRoute& route) { return route.first == eventFamily; })
+                    == routes.end()) {
+                routes.push_back(std::make_pair(eventFamily, eventClassId));
+            }
+            ++eventClassId;
         }
     } else {
         KAA_LOG_WARN("Failed to register event family: bad input data");
@@ -47,41 +63,254 @@ void EventManager::registerEventFamily(IEventFamily* eventFamily)
 
 void EventManager::produceEvent(const std::string& fqn, const std::vector<std::uint8_t>& data,
                                 const std::string& target, TransactionIdPtr trxId)
+{
+    produceEvent(boost::string_ref(fqn), data.data(), data.size(), boost::string_ref(target), trxId);
+}
+
+void EventManager::produceEvent(const std::string& fqn, std::vector<std::uint8_t>&& data,
+                                const std::string& target, TransactionIdPtr trxId)
 {
     if (fqn.empty()) {
         KAA_LOG_WARN("Failed to process outgoing event: bad input data");
         return;
     }
 
+    Event event = createEvent(fqn, target, data.size());
+    event.eventData = std::move(data);
+    addEvent(std::move(event), trxId);
+}
+
+void EventManager::produceEvent(boost::string_ref fqn, const std::uint8_t *data, std::size_t dataSize,
+                                boost::string_ref target, TransactionIdPtr trxId)
+{
+    if (fqn.empty() || (!data && dataSize)) {
+        KAA_LOG_WARN("Failed to process outgoing event: bad input data");
+        return;
+    }
+
+    Event event = createEvent(fqn, target, dataSize);
+    event.eventData.assign(data, data + dataSize);
+    addEvent(std::move(event), trxId);
+}
+
+Event EventManager::createEvent(boost::string_ref fqn, boost::string_ref target, std::size_t dataSize)
+{
     KAA_LOG_DEBUG(boost::format("Going to produce Event [FQN: %1%, target: %2%, data_size = %3%]") % fqn
-                  % (target.empty() ? "broadcast" : target) % data.size());
+                  % (target.empty() ? boost::string_ref("broadcast") : target) % dataSize);
 
-    Event event;
-    event.eventClassFQN = fqn;
-    event.eventData.assign(data.begin(), data.end());
+    /*
+     * The recycled event keeps the capacity of its buffers, see EventTransport::onEventResponse().
+     */
+    Event event = ObjectPool<Event>::acquire();
+    event.eventClassFQN.assign(fqn.data(), fqn.size());
+    event.seqNum = 0;
 
     if (target.empty()) {
         event.target.set_null();
     } else {
-        event.target.set_string(target);
+        event.target.set_string(std::string(target.data(), target.size()));
     }
 
+    return event;
+}
+
+void EventManager::addEvent(Event&& event, TransactionIdPtr trxId)
+{
     if (trxId) {
-        getContainerByTrxId(trxId, context_).push_back(event);
+        getContainerByTrxId(trxId, context_).push_back(std::move(event));
         return;
     }
 
-    KAA_LOG_TRACE(boost::format("New event %1% is produced for %2%") % fqn % target);
+    KAA_LOG_TRACE(boost::format("New event %1% is produced for %2%") % event.eventClassFQN
+                  % (event.target.is_null() ? std::string() : event.target.get_string()));
 
+    std::size_t pendingEventCount = 0;
+    EventBatchingSettings settings;
     {
         KAA_MUTEX_LOCKING("pendingEventsGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
         KAA_MUTEX_LOCKED("pendingEventsGuard_");
-        pendingEvents_.insert(std::make_pair(currentEventIndex_++, event));
+
+        if (batchingSettings_.coalesceEvents) {
+            EventKey key(event.eventClassFQN, event.target.is_null() ? std::string() : event.target.get_string());
+            auto result = coalescedEvents_.insert(std::make_pair(key, currentEventIndex_));
+            if (!result.second) {
+                auto it = pendingEvents_.find(result.first->second);
+                if (it != pendingEvents_.end()) {
+                    KAA_LOG_TRACE(boost::format("Event %1% for %2% replaces the pending one") % key.first % key.second);
+                    pendingEventsVolume_ -= getEventVolume(it->second);
+                    ObjectPool<Event>::release(std::move(it->second));
+                    pendingEvents_.erase(it);
+                }
+                result.first->second = currentEventIndex_;
+            }
+        }
+
+        addPendingEvent(std::move(event));
+        pendingEventCount = pendingEvents_.size() + getStoredEventCount();
+        settings = batchingSettings_;
         KAA_MUTEX_UNLOCKED("pendingEventsGuard_");
     }
 
-    doSync();
+    onEventProduced(settings, pendingEventCount);
+}
+
+void EventManager::setBatchingSettings(const EventBatchingSettings& settings)
+{
+    {
+        KAA_MUTEX_LOCKING("pendingEventsGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
+        KAA_MUTEX_LOCKED("pendingEventsGuard_");
+
+        batchingSettings_ = settings;
+        if (!batchingSettings_.coalesceEvents) {
+            coalescedEvents_.clear();
+        }
+        KAA_MUTEX_UNLOCKED("pendingEventsGuard_");
+    }
+
+    KAA_LOG_INFO(boost::format("Event batching: window %1% ms, max batch size %2%, coalescing %3%")
+                 % settings.batchWindow.count() % settings.maxBatchSize
+                 % (settings.coalesceEvents ? "on" : "off"));
+
+    if (settings.batchWindow == std::chrono::milliseconds::zero()) {
+        /*
+         * Events waiting for the window are sent at once.
+         */
+        batchTimer_.stop();
+        onBatchWindowExpired();
+    }
+}
+
+void EventManager::setEventStorage(ILogStoragePtr storage, std::size_t maxResidentEvents)
+{
+    KAA_MUTEX_LOCKING("pendingEventsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
+    KAA_MUTEX_LOCKED("pendingEventsGuard_");
+
+    eventStorage_ = storage;
+    maxResidentEvents_ = maxResidentEvents;
+
+    KAA_LOG_INFO(boost::format("Event storage is %1%, max resident events %2%")
+                 % (storage ? "set" : "reset") % maxResidentEvents);
+}
+
+void EventManager::addPendingEvent(Event&& event)
+{
+    /*
+     * Once events are stored, next ones are stored as well, so they are sent in order.
+     */
+    if (eventStorage_ && (pendingEvents_.size() >= maxResidentEvents_ || getStoredEventCount())) {
+        static kaa_thread_local AvroByteArrayConverter<Event> converter;
+        static kaa_thread_local std::vector<std::uint8_t> buffer;
+
+        try {
+            converter.toByteArray(event, buffer);
+            eventStorage_->addLogRecord(LogRecord(buffer.data(), buffer.size()));
+
+            ObjectPool<Event>::release(std::move(event));
+            ++currentEventIndex_;
+            return;
+        } catch (const std::exception& e) {
+            KAA_LOG_ERROR(boost::format("Failed to store event, keeping it in memory: %1%") % e.what());
+        }
+    }
+
+    pendingEventsVolume_ += getEventVolume(event);
+    pendingEvents_.insert(std::make_pair(currentEventIndex_++, std::move(event)));
+}
+
+std::size_t EventManager::getStoredEventCount() const
+{
+    return eventStorage_ ? eventStorage_->getStatus().getRecordsCount() : 0;
+}
+
+void EventManager::releaseStoredEvents(std::map<std::int32_t, Event>& events)
+{
+    if (!getStoredEventCount()) {
+        return;
+    }
+
+    /*
+     * Stored events are newer than resident ones, so they follow them.
+     */
+    BucketInfo bucket = eventStorage_->visitNextBucket([this, &events] (const std::uint8_t *data, std::size_t size)
+        {
+            static kaa_thread_local AvroByteArrayConverter<Event> converter;
+
+            Event event = ObjectPool<Event>::acquire();
+            try {
+                converter.fromByteArray(data, size, event);
+                events.insert(std::make_pair(currentEventIndex_++, std::move(event)));
+            } catch (const std::exception& e) {
+                KAA_LOG_ERROR(boost::format("Dropped corrupted stored event: %1%") % e.what());
+                ObjectPool<Event>::release(std::move(event));
+            }
+        });
+
+    /*
+     * From now on the events are tracked by the transport, as resident ones are.
+     */
+    if (bucket.getLogCount()) {
+        eventStorage_->removeBucket(bucket.getBucketId());
+    }
+
+    KAA_LOG_DEBUG(boost::format("Released %1% stored events, %2% events left in storage")
+                  % bucket.getLogCount() % getStoredEventCount());
+}
+
+void EventManager::onEventsDelivered()
+{
+    bool needSync = false;
+    {
+        KAA_MUTEX_LOCKING("pendingEventsGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
+        KAA_MUTEX_LOCKED("pendingEventsGuard_");
+        needSync = getStoredEventCount() > 0;
+        KAA_MUTEX_UNLOCKED("pendingEventsGuard_");
+    }
+
+    /*
+     * The storage is drained one bucket per sync.
+     */
+    if (needSync && eventTransport_) {
+        doSync();
+    }
+}
+
+void EventManager::onEventProduced(const EventBatchingSettings& settings, std::size_t pendingEventCount)
+{
+    if (settings.batchWindow == std::chrono::milliseconds::zero()
+            || (settings.maxBatchSize && pendingEventCount >= settings.maxBatchSize)) {
+        batchTimer_.stop();
+        doSync();
+    } else {
+        /*
+         * Does nothing if the window is already open.
+         */
+        batchTimer_.start(settings.batchWindow, [this] { onBatchWindowExpired(); });
+    }
+}
+
+void EventManager::onBatchWindowExpired()
+{
+    /*
+     * The events may have already gone with a sync requested for other reasons.
+     */
+    if (!hasPendingEvents()) {
+        return;
+    }
+
+    if (!eventTransport_) {
+        KAA_LOG_WARN("Postponed event sync: event transport is not set");
+        return;
+    }
+
+    try {
+        doSync();
+    } catch (const std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to sync batched events: %1%") % e.what());
+    }
 }
 
 std::map<std::int32_t, Event> EventManager::releasePendingEvents()
@@ -92,6 +321,9 @@ std::map<std::int32_t, Event> EventManager::releasePendingEvents()
 
     std::map<std::int32_t, Event> result(std::move(pendingEvents_));
     pendingEvents_ = std::map<std::int32_t, Event>();
+    releaseStoredEvents(result);
+    coalescedEvents_.clear();
+    pendingEventsVolume_ = 0;
     currentEventIndex_ = 0;
     return result;
 }
@@ -101,7 +333,21 @@ bool EventManager::hasPendingEvents() const
     KAA_MUTEX_LOCKING("pendingEventsGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
     KAA_MUTEX_LOCKED("pendingEventsGuard_");
-    return !pendingEvents_.empty();
+    return !pendingEvents_.empty() || getStoredEventCount() > 0;
+}
+
+std::size_t EventManager::getPendingEventsVolume() const
+{
+    KAA_MUTEX_LOCKING("pendingEventsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
+    KAA_MUTEX_LOCKED("pendingEventsGuard_");
+    return pendingEventsVolume_;
+}
+
+std::size_t EventManager::getEventVolume(const Event& event)
+{
+    return sizeof(Event) + event.eventClassFQN.size() + event.eventData.size()
+            + (event.target.is_null() ? 0 : event.target.get_string().size());
 }
 
 std::map<std::int32_t, std::list<std::string> > EventManager::getPendingListenerRequests()
@@ -134,34 +380,39 @@ void EventManager::onEventFromServer(const std::string& eventClassFQN, const std
         return;
     }
 
-    bool isProcessed = false;
-
-    for (auto* family : eventFamilies_) {
-        const auto& list = family->getSupportedEventClassFQNs();
-        auto it = std::find(list.begin(), list.end(), eventClassFQN);
-        if (it != list.end()) {
-            KAA_LOG_TRACE(boost::format("Processing event for %1%") % eventClassFQN);
-            family->onGenericEvent(eventClassFQN, data, source);
-            isProcessed = true;
-        }
+    auto it = eventFamiliesByFqn_.find(eventClassFQN);
+    if (it == eventFamiliesByFqn_.end()) {
+        KAA_LOG_WARN(boost::format("Event '%1%' wasn't processed: could not find appropriate family") % eventClassFQN);
+        return;
     }
 
-    if (!isProcessed) {
-        KAA_LOG_WARN(boost::format("Event '%1%' wasn't processed: could not find appropriate family") % eventClassFQN);
+    KAA_LOG_TRACE(boost::format("Processing event for %1%") % eventClassFQN);
+
+    for (const auto& route : it->second) {
+        route.first->onGenericEvent(route.second, eventClassFQN, data, source);
     }
 }
 
 void EventManager::onEventsReceived(const EventSyncResponse::events_t& eventResponse)
 {
-    auto events = eventResponse.get_array();
-    std::sort(events.begin(), events.end(),
-              [&events](const Event& l, const Event& r) -> bool {return l.seqNum < r.seqNum;});
+    static const std::string UNKNOWN_SOURCE;
+
+    /*
+     * Events are sorted by reference, so their data isn't copied.
+     */
+    const auto& events = eventResponse.get_array();
+    std::vector<const Event *> sortedEvents;
+    sortedEvents.reserve(events.size());
     for (const auto& event : events) {
-        std::string source;
-        if (!event.source.is_null()) {
-            source = event.source.get_string();
-        }
-        onEventFromServer(event.eventClassFQN, event.eventData, source);
+        sortedEvents.push_back(&event);
+    }
+
+    std::sort(sortedEvents.begin(), sortedEvents.end(),
+              [](const Event *l, const Event *r) -> bool {return l->seqNum < r->seqNum;});
+
+    for (const auto *event : sortedEvents) {
+        onEventFromServer(event->eventClassFQN, event->eventData,
+                          event->source.is_null() ? UNKNOWN_SOURCE : event->source.get_string());
     }
 }
 
@@ -178,7 +429,8 @@ void EventManager::onEventListenersReceived(const EventSyncResponse::eventListen
             auto it = eventListenersRequests_.find(response.requestId);
 
             if (it != eventListenersRequests_.end()) {
-                auto callback = it->second->listener_;
+                auto info = it->second;
+                auto callback = info->listener_;
                 eventListenersRequests_.erase(it);
 
                 if (response.result == SyncResponseResultType::SUCCESS) {
@@ -187,6 +439,13 @@ void EventManager::onEventListenersReceived(const EventSyncResponse::eventListen
                         listeners = response.listeners.get_array();
                     }
 
+                    if (eventListenersCacheTtl_ > std::chrono::seconds::zero()) {
+                        CachedEventListeners& cached = eventListenersCache_[std::set<std::string>(info->eventFQNs_.begin(),
+                                                                                                 info->eventFQNs_.end())];
+                        cached.listeners_ = listeners;
+                        cached.expiresAt_ = std::chrono::steady_clock::now() + eventListenersCacheTtl_;
+                    }
+
                     context_.getExecutorContext().getCallbackExecutor().add([callback, listeners]
                                                                 {
                                                                     callback->onEventListenersReceived(listeners);
@@ -221,6 +480,22 @@ std::int32_t EventManager::findEventListeners(const std::list<std::string>& even
         KAA_MUTEX_UNIQUE_DECLARE(eventListenersLock, eventListenersGuard_);
         KAA_MUTEX_LOCKED("eventListenersGuard_");
 
+        auto cached = eventListenersCache_.find(std::set<std::string>(eventFQNs.begin(), eventFQNs.end()));
+        if (cached != eventListenersCache_.end()) {
+            if (cached->second.expiresAt_ > std::chrono::steady_clock::now()) {
+                std::vector<std::string> listeners = cached->second.listeners_;
+
+                KAA_LOG_TRACE("Event listeners are resolved from cache");
+                context_.getExecutorContext().getCallbackExecutor().add([listener, listeners]
+                                                            {
+                                                                listener->onEventListenersReceived(listeners);
+                                                            });
+                return requestId;
+            }
+
+            eventListenersCache_.erase(cached);
+        }
+
         eventListenersRequests_.insert(std::make_pair(requestId, info));
         KAA_MUTEX_UNLOCKED("eventListenersGuard_");
     }
@@ -232,6 +507,28 @@ std::int32_t EventManager::findEventListeners(const std::list<std::string>& even
     return requestId;
 }
 
+void EventManager::setEventListenersCacheTtl(std::chrono::seconds ttl)
+{
+    KAA_MUTEX_LOCKING("eventListenersGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(eventListenersLock, eventListenersGuard_);
+    KAA_MUTEX_LOCKED("eventListenersGuard_");
+
+    eventListenersCacheTtl_ = std::max(ttl, std::chrono::seconds::zero());
+    eventListenersCache_.clear();
+}
+
+void EventManager::clearEventListenersCache()
+{
+    KAA_MUTEX_LOCKING("eventListenersGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(eventListenersLock, eventListenersGuard_);
+    KAA_MUTEX_LOCKED("eventListenersGuard_");
+
+    if (!eventListenersCache_.empty()) {
+        KAA_LOG_TRACE(boost::format("Dropped %1% cached event listeners results") % eventListenersCache_.size());
+        eventListenersCache_.clear();
+    }
+}
+
 void EventManager::setTransport(EventTransport *transport)
 {
     eventTransport_ = transport;
@@ -242,7 +539,7 @@ void EventManager::setTransport(EventTransport *transport)
             KAA_MUTEX_LOCKING("pendingEventsGuard_");
             KAA_MUTEX_UNIQUE_DECLARE(eventsLock, pendingEventsGuard_);
             KAA_MUTEX_LOCKED("pendingEventsGuard_");
-            needSync = !pendingEvents_.empty();
+            needSync = !pendingEvents_.empty() || getStoredEventCount() > 0;
             KAA_MUTEX_UNLOCKED("pendingEventsGuard_");
         }
 
@@ -270,7 +567,7 @@ void EventManager::commit(TransactionIdPtr trxId, IKaaClientContext &context_)
 
         std::list<Event> & events = it->second;
         for (Event &e : events) {
-            pendingEvents_.insert(std::make_pair(currentEventIndex_++, std::move(e)));
+            addPendingEvent(std::move(e));
         }
         transactions_.erase(it);
 
@@ -278,6 +575,10 @@ void EventManager::commit(TransactionIdPtr trxId, IKaaClientContext &context_)
         KAA_UNLOCK(eventsLock);
         KAA_MUTEX_UNLOCKED("pendingEventsGuard_");
 
+        /*
+         * The sync takes batched events as well.
+         */
+        batchTimer_.stop();
         doSync();
     }
 }
@@ -20,6 +20,7 @@
 
 #include "kaa/event/IEventDataProcessor.hpp"
 #include "kaa/logging/Log.hpp"
+#include "kaa/utils/ObjectPool.hpp"
 
 #include <algorithm>
 
@@ -56,14 +57,20 @@ std::shared_ptr<EventSyncRequest> EventTransport::createEventRequest(std::int32_
         KAA_MUTEX_LOCKED("eventsGuard_");
 
         if (releasedEvents.size() != 0) {
-            auto sNum = context_.getStatus().getEventSequenceNumber();
+            auto sNum = context_.getStatus().reserveEventSequenceNumbers(
+                    static_cast<std::int32_t>(releasedEvents.size()));
             for (auto& pair : releasedEvents) {
                 pair.second.seqNum = sNum++;
                 events_[requestId].push_back(std::move(pair.second));
             }
-            context_.getStatus().setEventSequenceNumber(sNum);
         }
+        std::size_t eventCount = 0;
+        for (const auto& pair : events_) {
+            eventCount += pair.second.size();
+        }
+
         std::vector<Event> eventsForSending;
+        eventsForSending.reserve(eventCount);
         for (auto& pair : events_) {
             for (auto& curEvent : pair.second) {
                 eventsForSending.push_back(curEvent);
@@ -116,7 +123,25 @@ void EventTransport::onSyncResponseId(std::int32_t requestId)
     KAA_MUTEX_UNIQUE_DECLARE(eventsGuardLock, eventsGuard_);
     KAA_MUTEX_LOCKED("eventsGuard_");
 
-    events_.erase(requestId);
+    auto it = events_.find(requestId);
+    if (it == events_.end()) {
+        return;
+    }
+
+    /*
+     * Delivered events are recycled by EventManager::produceEvent().
+     */
+    for (auto& event : it->second) {
+        ObjectPool<Event>::release(std::move(event));
+    }
+
+    events_.erase(it);
+
+    KAA_MUTEX_UNLOCKING("eventsGuard_");
+    KAA_UNLOCK(eventsGuardLock);
+    KAA_MUTEX_UNLOCKED("eventsGuard_");
+
+    eventDataProcessor_.onEventsDelivered();
 }
 
 void EventTransport::sync()
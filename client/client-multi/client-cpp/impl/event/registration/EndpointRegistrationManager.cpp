@@ -59,6 +59,7 @@ void EndpointRegistrationManager::onUserAttach(const UserAttachResponse& respons
 
     if (response.result == SyncResponseResultType::SUCCESS) {
         context_.getStatus().setEndpointAttachStatus(true);
+        notifyUserEndpointsChanged();
 
         KAA_LOG_INFO(boost::format("Endpoint was successfully attached to '%1%' user") % userExternalId);
 
@@ -85,10 +86,12 @@ void EndpointRegistrationManager::onEndpointsAttach(const std::vector<EndpointAt
     KAA_MUTEX_UNIQUE_DECLARE(attachEndpointLock, attachEndpointGuard_);
     KAA_MUTEX_LOCKED("attachEndpointGuard_");
 
+    bool isAnyAttached = false;
     for (const auto& attachResponse : attachResponses) {
         auto requestIt = attachEndpointRequests_.find(attachResponse.requestId);
         if (requestIt != attachEndpointRequests_.end()) {
             bool isAttachSuccess = (attachResponse.result == SyncResponseResultType::SUCCESS);
+            isAnyAttached = isAnyAttached || isAttachSuccess;
 
             if (isAttachSuccess) {
                 KAA_LOG_INFO(boost::format("Endpoint '%1%' (request id: %2%) was successfully attached")
@@ -100,6 +103,25 @@ void EndpointRegistrationManager::onEndpointsAttach(const std::vector<EndpointAt
 
             attachEndpointRequests_.erase(requestIt);
 
+            auto bulkIt = bulkAttachRequests_.find(attachResponse.requestId);
+            if (bulkIt != bulkAttachRequests_.end()) {
+                auto bulkRequest = bulkIt->second.first;
+                auto& result = bulkRequest->results_[bulkIt->second.second];
+                bulkAttachRequests_.erase(bulkIt);
+
+                result.isAttached = isAttachSuccess;
+                if (isAttachSuccess && !attachResponse.endpointKeyHash.is_null()) {
+                    result.endpointKeyHash = attachResponse.endpointKeyHash.get_string();
+                }
+
+                if (!--bulkRequest->pendingCount_) {
+                    context_.getExecutorContext().getCallbackExecutor().add([bulkRequest]
+                                                                {
+                                                                    bulkRequest->listener_->onAttachCompleted(bulkRequest->results_);
+                                                                });
+                }
+            }
+
             auto listenerIt = attachEndpointListeners_.find(attachResponse.requestId);
             if (listenerIt != attachEndpointListeners_.end() && listenerIt->second) {
                 auto callback = listenerIt->second;
@@ -118,10 +140,19 @@ void EndpointRegistrationManager::onEndpointsAttach(const std::vector<EndpointAt
             }
         }
     }
+
+    KAA_MUTEX_UNLOCKING("attachEndpointGuard_");
+    KAA_UNLOCK(attachEndpointLock);
+    KAA_MUTEX_UNLOCKED("attachEndpointGuard_");
+
+    if (isAnyAttached) {
+        notifyUserEndpointsChanged();
+    }
 }
 
 void EndpointRegistrationManager::onEndpointsDetach(const std::vector<EndpointDetachResponse>& detachResponses)
 {
+    bool isAnyDetached = false;
     for (const auto& detachResponse : detachResponses) {
         KAA_MUTEX_LOCKING("detachEndpointGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(detachEndpointLock, detachEndpointGuard_);
@@ -130,6 +161,7 @@ void EndpointRegistrationManager::onEndpointsDetach(const std::vector<EndpointDe
         auto requestIt = detachEndpointRequests_.find(detachResponse.requestId);
         if (requestIt != detachEndpointRequests_.end()) {
             bool isDetachSuccess = (detachResponse.result == SyncResponseResultType::SUCCESS);
+            isAnyDetached = isAnyDetached || isDetachSuccess;
 
             if (isDetachSuccess) {
                 KAA_LOG_INFO(boost::format("Endpoint '%1%' (request id: %2%) was successfully detached")
@@ -141,6 +173,20 @@ void EndpointRegistrationManager::onEndpointsDetach(const std::vector<EndpointDe
 
             detachEndpointRequests_.erase(requestIt);
 
+            auto bulkIt = bulkDetachRequests_.find(detachResponse.requestId);
+            if (bulkIt != bulkDetachRequests_.end()) {
+                auto bulkRequest = bulkIt->second.first;
+                bulkRequest->results_[bulkIt->second.second].isDetached = isDetachSuccess;
+                bulkDetachRequests_.erase(bulkIt);
+
+                if (!--bulkRequest->pendingCount_) {
+                    context_.getExecutorContext().getCallbackExecutor().add([bulkRequest]
+                                                                {
+                                                                    bulkRequest->listener_->onDetachCompleted(bulkRequest->results_);
+                                                                });
+                }
+            }
+
             auto listenerIt = detachEndpointListeners_.find(detachResponse.requestId);
             if (listenerIt != detachEndpointListeners_.end() && listenerIt->second) {
                 auto callback = listenerIt->second;
@@ -158,11 +204,16 @@ void EndpointRegistrationManager::onEndpointsDetach(const std::vector<EndpointDe
             }
         }
     }
+
+    if (isAnyDetached) {
+        notifyUserEndpointsChanged();
+    }
 }
 
 void EndpointRegistrationManager::onCurrentEndpointAttach(const UserAttachNotification& response)
 {
     context_.getStatus().setEndpointAttachStatus(true);
+    notifyUserEndpointsChanged();
 
     KAA_LOG_INFO(boost::format("Current endpoint was attached to '%1%' by '%2%'")
                                     % response.userExternalId % response.endpointAccessToken);
@@ -180,6 +231,7 @@ void EndpointRegistrationManager::onCurrentEndpointAttach(const UserAttachNotifi
 void EndpointRegistrationManager::onCurrentEndpointDetach(const UserDetachNotification& response)
 {
     context_.getStatus().setEndpointAttachStatus(false);
+    notifyUserEndpointsChanged();
 
     KAA_LOG_INFO(boost::format("Current endpoint was detached by '%1%'") % response.endpointAccessToken);
 
@@ -271,6 +323,123 @@ void EndpointRegistrationManager::detachEndpoint(const std::string& endpointKeyH
     }
 }
 
+void EndpointRegistrationManager::attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                                                , IAttachEndpointsCallbackPtr listener)
+{
+    for (const auto& endpointAccessToken : endpointAccessTokens) {
+        if (endpointAccessToken.empty()) {
+            KAA_LOG_WARN("Failed to attach endpoints: bad endpoint access token");
+            throw BadCredentials("Bad endpoint access token");
+        }
+    }
+
+    if (endpointAccessTokens.empty()) {
+        if (listener) {
+            context_.getExecutorContext().getCallbackExecutor().add([listener]
+                                                        {
+                                                            listener->onAttachCompleted(std::vector<EndpointAttachResult>());
+                                                        });
+        }
+        return;
+    }
+
+    /* Request ids of the batch are consecutive, so they can't clash with the ones in progress. */
+    std::int32_t count = endpointAccessTokens.size();
+    std::int32_t firstRequestId = (attachRequestId_ += count) - count;
+
+    std::shared_ptr<BulkAttachRequest> bulkRequest;
+    if (listener) {
+        bulkRequest = std::make_shared<BulkAttachRequest>();
+        bulkRequest->results_.resize(count);
+        bulkRequest->pendingCount_ = count;
+        bulkRequest->listener_ = listener;
+    }
+
+    KAA_MUTEX_LOCKING("attachEndpointGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(attachEndpointLock, attachEndpointGuard_);
+    KAA_MUTEX_LOCKED("attachEndpointGuard_");
+
+    attachEndpointRequests_.reserve(attachEndpointRequests_.size() + count);
+    if (bulkRequest) {
+        bulkAttachRequests_.reserve(bulkAttachRequests_.size() + count);
+    }
+
+    for (std::int32_t i = 0; i < count; ++i) {
+        attachEndpointRequests_[firstRequestId + i] = endpointAccessTokens[i];
+        if (bulkRequest) {
+            bulkRequest->results_[i].endpointAccessToken = endpointAccessTokens[i];
+            bulkAttachRequests_.insert(std::make_pair(firstRequestId + i, std::make_pair(bulkRequest, i)));
+        }
+    }
+
+    KAA_MUTEX_UNLOCKING("attachEndpointGuard_");
+    KAA_UNLOCK(attachEndpointLock);
+    KAA_MUTEX_UNLOCKED("attachEndpointGuard_");
+
+    KAA_LOG_INFO(boost::format("Going to attach %1% endpoints (request ids: %2%-%3%)")
+                                        % count % firstRequestId % (firstRequestId + count - 1));
+
+    doSync();
+}
+
+void EndpointRegistrationManager::detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                                                , IDetachEndpointsCallbackPtr listener)
+{
+    for (const auto& endpointKeyHash : endpointKeyHashes) {
+        if (endpointKeyHash.empty()) {
+            KAA_LOG_WARN("Failed to detach endpoints: bad endpoint key hash");
+            throw BadCredentials("Bad endpoint key hash");
+        }
+    }
+
+    if (endpointKeyHashes.empty()) {
+        if (listener) {
+            context_.getExecutorContext().getCallbackExecutor().add([listener]
+                                                        {
+                                                            listener->onDetachCompleted(std::vector<EndpointDetachResult>());
+                                                        });
+        }
+        return;
+    }
+
+    std::int32_t count = endpointKeyHashes.size();
+    std::int32_t firstRequestId = (detachRequestId_ += count) - count;
+
+    std::shared_ptr<BulkDetachRequest> bulkRequest;
+    if (listener) {
+        bulkRequest = std::make_shared<BulkDetachRequest>();
+        bulkRequest->results_.resize(count);
+        bulkRequest->pendingCount_ = count;
+        bulkRequest->listener_ = listener;
+    }
+
+    KAA_MUTEX_LOCKING("detachEndpointGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(detachEndpointLock, detachEndpointGuard_);
+    KAA_MUTEX_LOCKED("detachEndpointGuard_");
+
+    detachEndpointRequests_.reserve(detachEndpointRequests_.size() + count);
+    if (bulkRequest) {
+        bulkDetachRequests_.reserve(bulkDetachRequests_.size() + count);
+    }
+
+    for (std::int32_t i = 0; i < count; ++i) {
+        detachEndpointRequests_[firstRequestId + i] = endpointKeyHashes[i];
+        if (bulkRequest) {
+            bulkRequest->results_[i].endpointKeyHash = endpointKeyHashes[i];
+            bulkDetachRequests_.insert(std::make_pair(firstRequestId + i, std::make_pair(bulkRequest, i)));
+        }
+    }
+
+    KAA_MUTEX_UNLOCKING("detachEndpointGuard_");
+    KAA_UNLOCK(detachEndpointLock);
+    KAA_MUTEX_UNLOCKED("detachEndpointGuard_");
+
+    KAA_LOG_INFO(boost::format("Going to detach %1% endpoints (request ids: %2%-%3%)")
+                                        % count % firstRequestId % (firstRequestId + count - 1));
+
+    doSync();
+}
+
 void EndpointRegistrationManager::attachUser(const std::string& userExternalId
                                            , const std::string& userAccessToken
                                            , IUserAttachCallbackPtr listener)
@@ -346,6 +515,13 @@ std::unordered_map<std::int32_t, std::string> EndpointRegistrationManager::getEn
     return detachEndpointRequests_;
 }
 
+void EndpointRegistrationManager::notifyUserEndpointsChanged()
+{
+    if (userEndpointsChangeListener_) {
+        userEndpointsChangeListener_();
+    }
+}
+
 void EndpointRegistrationManager::doSync()
 {
     if (userTransport_) {
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kaa/failover/BackoffFailoverStrategy.hpp"
+
+#include <random>
+#include <algorithm>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/IKaaClientContext.hpp"
+#include "kaa/utils/RandomGenerator.hpp"
+
+namespace kaa {
+
+const std::size_t BackoffFailoverStrategy::DEFAULT_BASE_PERIOD;
+const std::size_t BackoffFailoverStrategy::DEFAULT_MAX_PERIOD;
+
+BackoffFailoverStrategy::BackoffFailoverStrategy(IKaaClientContext& context,
+                                                 std::size_t basePeriod,
+                                                 std::size_t maxPeriod)
+    : DefaultFailoverStrategy(context, std::max<std::size_t>(basePeriod, 1))
+    , basePeriod_(std::max<std::size_t>(basePeriod, 1))
+    , maxPeriod_(std::max(maxPeriod, basePeriod_))
+    , lastPeriod_(basePeriod_)
+{
+}
+
+FailoverStrategyDecision BackoffFailoverStrategy::onFailover(KaaFailoverReason failover)
+{
+    FailoverStrategyAction action = getDefaultAction(failover);
+    std::size_t period = 0;
+
+    if (action != FailoverStrategyAction::NOOP && action != FailoverStrategyAction::STOP_CLIENT) {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, backoffGuard_);
+
+        std::size_t upperBound = std::min(maxPeriod_, std::max(basePeriod_, lastPeriod_ * 3));
+        period = std::uniform_int_distribution<std::size_t>(basePeriod_, upperBound)(
+                                        RandomGenerator::getThreadGenerator());
+        lastPeriod_ = period;
+    }
+
+    FailoverStrategyDecision decision(action, period);
+
+    KAA_LOG_INFO(boost::format("Use '%s' decision for '%s' failover")
+                                            % LoggingUtils::toString(decision)
+                                            % LoggingUtils::toString(failover));
+
+    return decision;
+}
+
+void BackoffFailoverStrategy::onRecover()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, backoffGuard_);
+    lastPeriod_ = basePeriod_;
+}
+
+}
@@ -24,7 +24,7 @@ namespace kaa {
 
 const std::size_t DefaultFailoverStrategy::DEFAULT_RETRY_PERIOD;
 
-FailoverStrategyDecision DefaultFailoverStrategy::onFailover(KaaFailoverReason failover)
+FailoverStrategyAction DefaultFailoverStrategy::getDefaultAction(KaaFailoverReason failover)
 {
     FailoverStrategyAction action = FailoverStrategyAction::NOOP;
 
@@ -52,7 +52,18 @@ FailoverStrategyDecision DefaultFailoverStrategy::onFailover(KaaFailoverReason f
             break;
     }
 
-    FailoverStrategyDecision decision(action, retryPeriod_);
+    return action;
+}
+
+FailoverStrategyDecision DefaultFailoverStrategy::onFailover(KaaFailoverReason failover)
+{
+    FailoverStrategyAction action = getDefaultAction(failover);
+
+    /*
+     * The next Operations server is tried at once, it is unlikely to be down as well.
+     */
+    FailoverStrategyDecision decision(action,
+                                      action == FailoverStrategyAction::USE_NEXT_OPERATIONS_SERVER ? 0 : retryPeriod_);
 
     KAA_LOG_INFO(boost::format("Use '%s' decision for '%s' failover")
                                             % LoggingUtils::toString(decision)
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kaa/failover/LatencyServerSelectionStrategy.hpp"
+
+#include <tuple>
+#include <algorithm>
+
+#include "kaa/utils/RandomGenerator.hpp"
+
+namespace kaa {
+
+const std::size_t LatencyServerSelectionStrategy::DEFAULT_FAILURE_TIMEOUT;
+
+void LatencyServerSelectionStrategy::orderServers(std::vector<ITransportConnectionInfoPtr>& servers)
+{
+    enum class Rank { MEASURED, UNKNOWN, FAILED };
+
+    typedef std::tuple<Rank, std::int64_t> SortKey;
+
+    /*
+     * Servers of the same rank stay in random order, so endpoints don't pile up on one unknown server.
+     */
+    std::shuffle(servers.begin(), servers.end(), RandomGenerator::getThreadGenerator());
+
+    std::map<std::int32_t, SortKey> keys;
+    const auto now = std::chrono::steady_clock::now();
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, statsGuard_);
+        for (const auto& server : servers) {
+            SortKey key(Rank::UNKNOWN, 0);
+
+            auto statsIt = stats_.find(server->getAccessPointId());
+            if (statsIt != stats_.end()) {
+                const auto& stats = statsIt->second;
+                if (stats.isFailed_ && now - stats.failedAt_ < failureTimeout_) {
+                    key = SortKey(Rank::FAILED, stats.failedAt_.time_since_epoch().count());
+                } else if (stats.isMeasured_) {
+                    key = SortKey(Rank::MEASURED, stats.smoothedRtt_.count());
+                }
+            }
+
+            keys[server->getAccessPointId()] = key;
+        }
+    }
+
+    std::stable_sort(servers.begin(), servers.end(),
+                     [&keys] (const ITransportConnectionInfoPtr& left, const ITransportConnectionInfoPtr& right)
+                     {
+                         return keys[left->getAccessPointId()] < keys[right->getAccessPointId()];
+                     });
+}
+
+void LatencyServerSelectionStrategy::onServerRttMeasured(const ITransportConnectionInfo& server,
+                                                         std::chrono::microseconds rtt)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, statsGuard_);
+
+    auto& stats = stats_[server.getAccessPointId()];
+    if (stats.isMeasured_) {
+        stats.smoothedRtt_ = (stats.smoothedRtt_ * 7 + rtt) / 8;
+    } else {
+        stats.smoothedRtt_ = rtt;
+        stats.isMeasured_ = true;
+    }
+    stats.isFailed_ = false;
+}
+
+void LatencyServerSelectionStrategy::onServerFailed(const ITransportConnectionInfo& server)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, statsGuard_);
+
+    auto& stats = stats_[server.getAccessPointId()];
+    stats.isFailed_ = true;
+    stats.failedAt_ = std::chrono::steady_clock::now();
+}
+
+std::map<std::int32_t, std::chrono::microseconds> LatencyServerSelectionStrategy::getServerRtts() const
+{
+    std::map<std::int32_t, std::chrono::microseconds> rtts;
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, statsGuard_);
+    for (const auto& stats : stats_) {
+        if (stats.second.isMeasured_) {
+            rtts[stats.first] = stats.second.smoothedRtt_;
+        }
+    }
+
+    return rtts;
+}
+
+}
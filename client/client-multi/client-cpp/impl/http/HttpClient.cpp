@@ -20,13 +20,40 @@
     defined(KAA_DEFAULT_OPERATION_HTTP_CHANNEL) || \
     defined(KAA_DEFAULT_LONG_POLL_CHANNEL)
 
+#include <array>
+
 #include "kaa/logging/Log.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 #include "kaa/transport/TransportException.hpp"
 #include "kaa/http/HttpUtils.hpp"
-#include "kaa/http/HttpResponse.hpp"
 
 namespace kaa {
 
+const std::size_t HttpClient::KEEP_ALIVE_TIMEOUT;
+const std::size_t HttpClient::READ_BUFFER_SIZE;
+
+/*
+ * The caller's request may be gone by the time the data is written, so it is copied.
+ */
+struct HttpClient::AsyncRequest {
+    AsyncRequest(const IHttpRequest& request, const HttpResponseHandler& handler)
+        : host_(request.getHost()), port_(request.getPort()), data_(request.getRequestData()), handler_(handler)
+    {}
+
+    const std::string            host_;
+    const std::uint16_t          port_;
+    const std::string            data_;
+    const HttpResponseHandler    handler_;
+
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints_;
+
+    bool isReused_ = false;
+    bool isResent_ = false;
+
+    HttpResponseParser                  parser_;
+    std::array<char, READ_BUFFER_SIZE>  readBuf_;
+};
+
 void HttpClient::checkError(const boost::system::error_code& code)
 {
     if (!code) {
@@ -55,46 +82,333 @@ std::shared_ptr<IHttpResponse> HttpClient::sendRequest(const IHttpRequest& reque
                                                 % request.getHost()
                                                 % request.getPort());
 
+    if (isAsyncRequestInProgress_) {
+        throw TransportException("Asynchronous request is in progress");
+    }
+
+    const auto& buffers = request.getRequestBuffers();
+
+    HttpResponseParser parser;
+
+    for (;;) {
+        bool isReused = isConnectionReusable(request.getHost(), request.getPort());
+        if (isReused) {
+            KAA_LOG_TRACE(boost::format("Reusing connection to %s:%d") % host_ % port_);
+        } else {
+            doSocketClose();
+            connect(request.getHost(), request.getPort());
+        }
+
+        if (connection != nullptr) {
+            boost::system::error_code endpointErrorCode;
+            connection->endpointIp_ = sock_.local_endpoint(endpointErrorCode).address().to_string();
+            connection->serverIp_ = sock_.remote_endpoint(endpointErrorCode).address().to_string();
+        }
+
+        boost::system::error_code errorCode;
+        boost::asio::write(sock_, buffers, errorCode);
+
+        if (!errorCode) {
+            readResponse(parser, errorCode);
+        }
+
+        if (errorCode && isReused && !parser.isStarted()) {
+            /*
+             * The server has closed the idle connection, so the request wasn't processed.
+             */
+            KAA_LOG_DEBUG(boost::format("Kept-alive connection to %s:%d is lost: %s. Reconnecting...")
+                                                                % host_ % port_ % errorCode.message());
+            doSocketClose();
+            continue;
+        }
+
+        checkError(errorCode);
+        break;
+    }
+
+    KAA_LOG_INFO(boost::format("Received response from server %s:%d")
+                                                        % request.getHost()
+                                                        % request.getPort());
+
+    if (parser.isKeepAlive()) {
+        lastUsageTime_ = Clock::now();
+    } else {
+        doSocketClose();
+    }
+
+    return parser.getResponse();
+}
+
+bool HttpClient::isConnectionReusable(const std::string& host, std::uint16_t port) const
+{
+    return sock_.is_open() && host_ == host && port_ == port &&
+           Clock::now() - lastUsageTime_ < std::chrono::seconds(KEEP_ALIVE_TIMEOUT);
+}
+
+void HttpClient::connect(const std::string& host, std::uint16_t port)
+{
     boost::system::error_code errorCode;
 
-    auto ep = HttpUtils::resolveEndpoint(request.getHost(), request.getPort(), errorCode);
+    const auto& endpoints = HttpUtils::resolveEndpoints(host, port, errorCode);
     checkError(errorCode);
 
-    sock_.open(ep.protocol(), errorCode);
-    checkError(errorCode);
+    HttpUtils::connect(io_, sock_, endpoints, errorCode);
+    if (errorCode) {
+        /*
+         * Addresses may be outdated.
+         */
+        HttpUtils::invalidateEndpoints(host, port);
+        checkError(errorCode);
+    }
 
-    sock_.connect(ep, errorCode);
-    checkError(errorCode);
+    host_ = host;
+    port_ = port;
+}
+
+void HttpClient::readResponse(HttpResponseParser& parser, boost::system::error_code& errorCode)
+{
+    std::array<char, READ_BUFFER_SIZE> readBuf;
+
+    parser.reset();
+    while (!parser.isComplete()) {
+        /*
+         * Once its size is known, the body is read straight into its storage.
+         */
+        auto bodyBuffer = parser.prepareBody();
+        bool isBodyRead = boost::asio::buffer_size(bodyBuffer) > 0;
+
+        std::size_t bytesRead = isBodyRead ? sock_.read_some(boost::asio::buffer(bodyBuffer), errorCode)
+                                           : sock_.read_some(boost::asio::buffer(readBuf), errorCode);
 
-    if (connection != nullptr) {
-        connection->endpointIp_ = sock_.local_endpoint().address().to_string();
-        connection->serverIp_ = ep.address().to_string();
+        if (errorCode == boost::asio::error::eof) {
+            errorCode.clear();
+            parser.onEndOfStream(errorCode);
+            return;
+        }
+
+        if (errorCode) {
+            return;
+        }
+
+        if (isBodyRead) {
+            parser.commitBody(bytesRead);
+            continue;
+        }
+
+        parser.parse(readBuf.data(), bytesRead, errorCode);
+        if (errorCode) {
+            return;
+        }
     }
+}
 
-    const auto& data = request.getRequestData();
-    boost::asio::write(sock_, boost::asio::buffer(data.data(), data.size()), errorCode);
-    checkError(errorCode);
+void HttpClient::sendRequestAsync(const IHttpRequest& request, const HttpResponseHandler& handler)
+{
+    if (!handler) {
+        throw KaaException("Bad HTTP response handler");
+    }
 
-    std::ostringstream responseStream;
-    boost::asio::streambuf responseBuf;
+    auto asyncRequest = std::make_shared<AsyncRequest>(request, handler);
 
-    while (boost::asio::read(sock_, responseBuf, boost::asio::transfer_at_least(1), errorCode)) {
-        responseStream << &responseBuf;
+    if (isAsyncRequestInProgress_.exchange(true)) {
+        KAA_LOG_WARN("Failed to send HTTP request: another request is in progress");
+        io_.post([asyncRequest] { asyncRequest->handler_(boost::asio::error::in_progress, std::shared_ptr<IHttpResponse>()); });
+        return;
     }
 
-    checkError(errorCode);
+    KAA_LOG_TRACE(boost::format("Sending async request to %s:%d") % asyncRequest->host_ % asyncRequest->port_);
 
-    KAA_LOG_INFO(boost::format("Received response from server %s:%d")
-                                                        % request.getHost()
-                                                        % request.getPort());
+    /*
+     * The socket is used by the I/O service threads only.
+     */
+    io_.post([this, asyncRequest] { startAsyncRequest(asyncRequest); });
+}
 
-    doSocketClose();
+void HttpClient::startAsyncRequest(AsyncRequestPtr request)
+{
+    isAsyncRequestCancelled_ = false;
+
+    request->isReused_ = isConnectionReusable(request->host_, request->port_);
+    if (request->isReused_) {
+        KAA_LOG_TRACE(boost::format("Reusing connection to %s:%d") % host_ % port_);
+        writeAsync(request);
+    } else {
+        doSocketClose();
+        resolveAsync(request);
+    }
+}
+
+void HttpClient::resolveAsync(AsyncRequestPtr request)
+{
+    if (HttpUtils::findCachedEndpoints(request->host_, request->port_, request->endpoints_)) {
+        connectAsync(request);
+        return;
+    }
+
+    boost::asio::ip::tcp::resolver::query query(request->host_, std::to_string(request->port_),
+                                                boost::asio::ip::resolver_query_base::numeric_service);
+
+    resolver_.async_resolve(query,
+            [this, request] (const boost::system::error_code& errorCode,
+                             boost::asio::ip::tcp::resolver::iterator endpointIt)
+            {
+                if (errorCode) {
+                    completeAsyncRequest(request, errorCode);
+                    return;
+                }
+
+                request->endpoints_ = HttpUtils::cacheEndpoints(request->host_, request->port_, endpointIt);
+
+                connectAsync(request);
+            });
+}
+
+void HttpClient::connectAsync(AsyncRequestPtr request)
+{
+    /*
+     * Addresses are tried one by one here.
+     */
+    boost::asio::async_connect(sock_, request->endpoints_.begin(), request->endpoints_.end(),
+            [this, request] (const boost::system::error_code& errorCode,
+                             std::vector<boost::asio::ip::tcp::endpoint>::iterator endpointIt)
+            {
+                if (errorCode) {
+                    /*
+                     * Addresses may be outdated.
+                     */
+                    HttpUtils::invalidateEndpoints(request->host_, request->port_);
+                    completeAsyncRequest(request, errorCode);
+                    return;
+                }
+
+                host_ = request->host_;
+                port_ = request->port_;
+
+                writeAsync(request);
+            });
+}
+
+void HttpClient::writeAsync(AsyncRequestPtr request)
+{
+    request->parser_.reset();
+
+    boost::asio::async_write(sock_, boost::asio::buffer(request->data_.data(), request->data_.size()),
+            [this, request] (const boost::system::error_code& errorCode, std::size_t bytesTransferred)
+            {
+                if (errorCode) {
+                    onAsyncError(request, errorCode);
+                    return;
+                }
+
+                readResponseAsync(request);
+            });
+}
+
+void HttpClient::readResponseAsync(AsyncRequestPtr request)
+{
+    auto bodyBuffer = request->parser_.prepareBody();
+    bool isBodyRead = boost::asio::buffer_size(bodyBuffer) > 0;
 
-    return std::make_shared<HttpResponse>(responseStream.str());
+    auto handler = [this, request, isBodyRead] (const boost::system::error_code& readErrorCode, std::size_t bytesRead)
+            {
+                boost::system::error_code errorCode = readErrorCode;
+                if (errorCode == boost::asio::error::eof) {
+                    errorCode.clear();
+                    request->parser_.onEndOfStream(errorCode);
+                    if (errorCode) {
+                        onAsyncError(request, errorCode);
+                    } else {
+                        completeAsyncRequest(request, errorCode);
+                    }
+                    return;
+                }
+
+                if (errorCode) {
+                    onAsyncError(request, errorCode);
+                    return;
+                }
+
+                if (isBodyRead) {
+                    request->parser_.commitBody(bytesRead);
+                } else {
+                    request->parser_.parse(request->readBuf_.data(), bytesRead, errorCode);
+                }
+
+                if (errorCode || request->parser_.isComplete()) {
+                    completeAsyncRequest(request, errorCode);
+                } else {
+                    readResponseAsync(request);
+                }
+            };
+
+    if (isBodyRead) {
+        sock_.async_read_some(boost::asio::buffer(bodyBuffer), handler);
+    } else {
+        sock_.async_read_some(boost::asio::buffer(request->readBuf_), handler);
+    }
+}
+
+void HttpClient::onAsyncError(AsyncRequestPtr request, const boost::system::error_code& errorCode)
+{
+    if (isAsyncRequestCancelled_) {
+        completeAsyncRequest(request, boost::asio::error::operation_aborted);
+        return;
+    }
+
+    if (request->isReused_ && !request->isResent_ && !request->parser_.isStarted()) {
+        /*
+         * The server has closed the idle connection, so the request wasn't processed.
+         */
+        KAA_LOG_DEBUG(boost::format("Kept-alive connection to %s:%d is lost: %s. Reconnecting...")
+                                                            % host_ % port_ % errorCode.message());
+        request->isReused_ = false;
+        request->isResent_ = true;
+        doSocketClose();
+        resolveAsync(request);
+        return;
+    }
+
+    completeAsyncRequest(request, errorCode);
+}
+
+void HttpClient::completeAsyncRequest(AsyncRequestPtr request, const boost::system::error_code& errorCode)
+{
+    std::shared_ptr<IHttpResponse> response;
+    boost::system::error_code resultCode = errorCode;
+
+    if (!resultCode) {
+        response = request->parser_.getResponse();
+        KAA_LOG_INFO(boost::format("Received response from server %s:%d") % request->host_ % request->port_);
+    } else {
+        KAA_LOG_WARN(boost::format("Transport error occurred: %s") % resultCode.message());
+    }
+
+    if (!resultCode && request->parser_.isKeepAlive()) {
+        lastUsageTime_ = Clock::now();
+    } else {
+        doSocketClose();
+    }
+
+    isAsyncRequestInProgress_ = false;
+
+    request->handler_(resultCode, response);
 }
 
 void HttpClient::closeConnection()
 {
+    if (isAsyncRequestInProgress_) {
+        /*
+         * Pending operations are aborted by the I/O service thread.
+         */
+        io_.post([this]
+            {
+                isAsyncRequestCancelled_ = true;
+                resolver_.cancel();
+                doSocketClose();
+            });
+        return;
+    }
+
     doSocketClose();
 }
 
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/http/HttpResponseParser.hpp"
+
+#if defined(KAA_DEFAULT_BOOTSTRAP_HTTP_CHANNEL) || \
+    defined(KAA_DEFAULT_OPERATION_HTTP_CHANNEL) || \
+    defined(KAA_DEFAULT_LONG_POLL_CHANNEL)
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <boost/asio/error.hpp>
+
+#include "kaa/http/HttpResponse.hpp"
+
+namespace kaa {
+
+const std::size_t HttpResponseParser::MAX_HEADER_SIZE;
+
+static const std::size_t HTTP_VERSION_OFFSET = 9;
+
+static std::string toLower(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+static std::string trim(const std::string& value)
+{
+    auto begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+
+    return value.substr(begin, value.find_last_not_of(" \t") - begin + 1);
+}
+
+void HttpResponseParser::reset()
+{
+    state_ = State::HEADER;
+    isStarted_ = false;
+    keepAlive_ = false;
+
+    line_.clear();
+    statusCode_ = 0;
+    header_.clear();
+
+    body_.reset();
+    bodySize_ = 0;
+    bodyCapacity_ = 0;
+    bytesToRead_ = 0;
+}
+
+std::size_t HttpResponseParser::parse(const char *data, std::size_t size, boost::system::error_code& errorCode)
+{
+    std::size_t consumed = 0;
+    bool isDone = false;
+
+    isStarted_ = isStarted_ || size > 0;
+
+    while (consumed < size && state_ != State::COMPLETE && !errorCode) {
+        const char *cursor = data + consumed;
+        std::size_t left = size - consumed;
+
+        switch (state_) {
+        case State::HEADER:
+            consumed += readUntil(cursor, left, "\r\n\r\n", isDone, errorCode);
+            if (isDone && !parseHeader()) {
+                errorCode = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+            }
+            break;
+        case State::BODY:
+        case State::CHUNK_DATA: {
+            auto buffer = prepareBody();
+            std::size_t bytesToCopy = std::min(left, boost::asio::buffer_size(buffer));
+            std::memcpy(boost::asio::buffer_cast<char *>(buffer), cursor, bytesToCopy);
+            commitBody(bytesToCopy);
+            consumed += bytesToCopy;
+            break;
+        }
+        case State::BODY_UNTIL_CLOSE:
+            reserveBody(bodySize_ + left);
+            std::memcpy(body_.get() + bodySize_, cursor, left);
+            bodySize_ += left;
+            consumed += left;
+            break;
+        case State::CHUNK_SIZE:
+            consumed += readUntil(cursor, left, "\r\n", isDone, errorCode);
+            if (isDone && !parseChunkSize()) {
+                errorCode = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+            }
+            break;
+        case State::CHUNK_DATA_END:
+            consumed += readUntil(cursor, left, "\r\n", isDone, errorCode);
+            if (isDone) {
+                if (!line_.empty()) {
+                    errorCode = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                }
+                line_.clear();
+                state_ = State::CHUNK_SIZE;
+            }
+            break;
+        case State::TRAILER:
+            /*
+             * Trailer fields are of no use here.
+             */
+            consumed += readUntil(cursor, left, "\r\n", isDone, errorCode);
+            if (isDone) {
+                if (line_.empty()) {
+                    state_ = State::COMPLETE;
+                }
+                line_.clear();
+            }
+            break;
+        case State::COMPLETE:
+            break;
+        }
+    }
+
+    return consumed;
+}
+
+boost::asio::mutable_buffer HttpResponseParser::prepareBody()
+{
+    if (state_ != State::BODY && state_ != State::CHUNK_DATA) {
+        return boost::asio::mutable_buffer();
+    }
+
+    return boost::asio::mutable_buffer(body_.get() + bodySize_, bytesToRead_);
+}
+
+void HttpResponseParser::commitBody(std::size_t size)
+{
+    bodySize_ += size;
+    bytesToRead_ -= size;
+
+    if (!bytesToRead_) {
+        state_ = (state_ == State::BODY) ? State::COMPLETE : State::CHUNK_DATA_END;
+    }
+}
+
+void HttpResponseParser::onEndOfStream(boost::system::error_code& errorCode)
+{
+    if (state_ == State::BODY_UNTIL_CLOSE) {
+        state_ = State::COMPLETE;
+    }
+
+    if (state_ != State::COMPLETE) {
+        errorCode = boost::asio::error::connection_aborted;
+    }
+}
+
+std::shared_ptr<IHttpResponse> HttpResponseParser::getResponse() const
+{
+    SharedBody body;
+    if (bodySize_) {
+        body = std::make_pair(body_, bodySize_);
+    }
+
+    return std::make_shared<HttpResponse>(statusCode_, header_, body);
+}
+
+std::size_t HttpResponseParser::readUntil(const char *data, std::size_t size, const char *terminator, bool& isDone,
+                                          boost::system::error_code& errorCode)
+{
+    const std::size_t terminatorSize = std::strlen(terminator);
+
+    /*
+     * The terminator may be split between the calls.
+     */
+    std::size_t searchStart = line_.size() < terminatorSize ? 0 : line_.size() - terminatorSize + 1;
+    std::size_t bytesToAppend = std::min(size, MAX_HEADER_SIZE + terminatorSize - line_.size());
+    line_.append(data, bytesToAppend);
+
+    auto terminatorPos = line_.find(terminator, searchStart);
+    if (terminatorPos == std::string::npos) {
+        if (line_.size() >= MAX_HEADER_SIZE + terminatorSize) {
+            errorCode = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+        }
+        isDone = false;
+        return bytesToAppend;
+    }
+
+    std::size_t bytesAfterTerminator = line_.size() - terminatorPos - terminatorSize;
+    line_.resize(terminatorPos);
+    isDone = true;
+    return bytesToAppend - bytesAfterTerminator;
+}
+
+bool HttpResponseParser::parseHeader()
+{
+    if (line_.compare(0, 5, "HTTP/") || line_.size() < HTTP_VERSION_OFFSET + 3) {
+        return false;
+    }
+
+    statusCode_ = static_cast<int>(std::strtol(line_.substr(HTTP_VERSION_OFFSET, 3).c_str(), nullptr, 10));
+
+    /*
+     * HTTP/1.1 connections are persistent by default, HTTP/1.0 ones are not.
+     */
+    keepAlive_ = (line_.compare(0, 8, "HTTP/1.1") == 0);
+
+    bool isChunked = false;
+    bool hasContentLength = false;
+    std::uint64_t contentLength = 0;
+
+    std::size_t lineStart = line_.find("\r\n");
+    while (lineStart != std::string::npos) {
+        lineStart += 2;
+
+        std::size_t lineEnd = std::min(line_.find("\r\n", lineStart), line_.size());
+        std::size_t separator = line_.find(':', lineStart);
+        if (separator != std::string::npos && separator < lineEnd) {
+            std::string name = line_.substr(lineStart, separator - lineStart);
+            std::string value = trim(line_.substr(separator + 1, lineEnd - separator - 1));
+
+            const std::string& lowerName = toLower(name);
+            const std::string& lowerValue = toLower(value);
+            if (lowerName == "content-length") {
+                char *end = nullptr;
+                contentLength = std::strtoull(value.c_str(), &end, 10);
+                if (value.empty() || *end || !std::isdigit(static_cast<unsigned char>(value[0]))
+                        || contentLength > std::numeric_limits<std::size_t>::max()) {
+                    return false;
+                }
+                hasContentLength = true;
+            } else if (lowerName == "connection") {
+                if (lowerValue.find("close") != std::string::npos) {
+                    keepAlive_ = false;
+                } else if (lowerValue.find("keep-alive") != std::string::npos) {
+                    keepAlive_ = true;
+                }
+            } else if (lowerName == "transfer-encoding" && lowerValue.find("chunked") != std::string::npos) {
+                isChunked = true;
+            }
+
+            header_.insert(std::make_pair(name, value));
+        }
+
+        lineStart = (lineEnd < line_.size()) ? lineEnd : std::string::npos;
+    }
+
+    line_.clear();
+
+    if ((statusCode_ >= 100 && statusCode_ < 200) || statusCode_ == 204 || statusCode_ == 304) {
+        state_ = State::COMPLETE;
+    } else if (isChunked) {
+        state_ = State::CHUNK_SIZE;
+    } else if (hasContentLength) {
+        reserveBody(static_cast<std::size_t>(contentLength));
+        bytesToRead_ = static_cast<std::size_t>(contentLength);
+        state_ = bytesToRead_ ? State::BODY : State::COMPLETE;
+    } else {
+        keepAlive_ = false;
+        state_ = State::BODY_UNTIL_CLOSE;
+    }
+
+    return true;
+}
+
+bool HttpResponseParser::parseChunkSize()
+{
+    /*
+     * Chunk extensions are ignored.
+     */
+    const std::string& value = trim(line_.substr(0, line_.find(';')));
+    line_.clear();
+
+    char *end = nullptr;
+    std::uint64_t chunkSize = std::strtoull(value.c_str(), &end, 16);
+    if (value.empty() || *end || !std::isxdigit(static_cast<unsigned char>(value[0]))
+            || chunkSize > std::numeric_limits<std::size_t>::max() - bodySize_) {
+        return false;
+    }
+
+    if (!chunkSize) {
+        state_ = State::TRAILER;
+        return true;
+    }
+
+    reserveBody(bodySize_ + static_cast<std::size_t>(chunkSize));
+    bytesToRead_ = static_cast<std::size_t>(chunkSize);
+    state_ = State::CHUNK_DATA;
+    return true;
+}
+
+void HttpResponseParser::reserveBody(std::size_t size)
+{
+    if (size <= bodyCapacity_) {
+        return;
+    }
+
+    /*
+     * Chunks and bodies delimited by the end of the connection grow geometrically.
+     */
+    std::size_t capacity = std::max(size, 2 * bodyCapacity_);
+    boost::shared_array<std::uint8_t> body(new std::uint8_t[capacity]);
+    if (bodySize_) {
+        std::memcpy(body.get(), body_.get(), bodySize_);
+    }
+
+    body_ = body;
+    bodyCapacity_ = capacity;
+}
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/http/HttpUtils.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace kaa {
+
+const std::size_t HttpUtils::DNS_CACHE_TTL;
+const std::size_t HttpUtils::CONNECTION_ATTEMPT_DELAY;
+
+typedef std::chrono::steady_clock HttpUtilsClock;
+
+/*
+ * Interval of checking the state of pending connection attempts.
+ */
+static const std::chrono::milliseconds CONNECTION_POLL_INTERVAL(5);
+
+struct CachedEndpoints {
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints_;
+    HttpUtilsClock::time_point expiration_;
+};
+
+typedef std::pair<std::string, std::uint16_t> EndpointCacheKey;
+
+static std::map<EndpointCacheKey, CachedEndpoints> endpointCache;
+static std::mutex endpointCacheGuard;
+
+std::vector<boost::asio::ip::tcp::endpoint> HttpUtils::resolveEndpoints(const std::string& host,
+                                                                        std::uint16_t port,
+                                                                        boost::system::error_code& errorCode)
+{
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+    if (findCachedEndpoints(host, port, endpoints)) {
+        return endpoints;
+    }
+
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::resolver resolver(io_service);
+    boost::asio::ip::tcp::resolver::query query(host,
+                                                std::to_string(port),
+                                                boost::asio::ip::resolver_query_base::numeric_service);
+
+    auto endpointIt = resolver.resolve(query, errorCode);
+
+    if (errorCode) {
+        return endpoints;
+    }
+
+    return cacheEndpoints(host, port, endpointIt);
+}
+
+bool HttpUtils::findCachedEndpoints(const std::string& host, std::uint16_t port,
+                                    std::vector<boost::asio::ip::tcp::endpoint>& endpoints)
+{
+    std::lock_guard<std::mutex> lock(endpointCacheGuard);
+
+    auto it = endpointCache.find(EndpointCacheKey(host, port));
+    if (it == endpointCache.end()) {
+        return false;
+    }
+
+    if (HttpUtilsClock::now() >= it->second.expiration_) {
+        endpointCache.erase(it);
+        return false;
+    }
+
+    endpoints = it->second.endpoints_;
+    return true;
+}
+
+std::vector<boost::asio::ip::tcp::endpoint> HttpUtils::cacheEndpoints(const std::string& host, std::uint16_t port,
+                                                                      boost::asio::ip::tcp::resolver::iterator endpointIt)
+{
+    std::vector<boost::asio::ip::tcp::endpoint> firstFamily;
+    std::vector<boost::asio::ip::tcp::endpoint> secondFamily;
+
+    /*
+     * The resolver sorts addresses by preference, so the family of the first one is preferred.
+     */
+    for (boost::asio::ip::tcp::resolver::iterator end; endpointIt != end; ++endpointIt) {
+        boost::asio::ip::tcp::endpoint ep = *endpointIt;
+        if (firstFamily.empty() || firstFamily.front().protocol() == ep.protocol()) {
+            firstFamily.push_back(ep);
+        } else {
+            secondFamily.push_back(ep);
+        }
+    }
+
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+    endpoints.reserve(firstFamily.size() + secondFamily.size());
+    for (std::size_t i = 0; i < firstFamily.size() || i < secondFamily.size(); ++i) {
+        if (i < firstFamily.size()) {
+            endpoints.push_back(firstFamily[i]);
+        }
+        if (i < secondFamily.size()) {
+            endpoints.push_back(secondFamily[i]);
+        }
+    }
+
+    if (!endpoints.empty()) {
+        std::lock_guard<std::mutex> lock(endpointCacheGuard);
+
+        auto& cachedEndpoints = endpointCache[EndpointCacheKey(host, port)];
+        cachedEndpoints.endpoints_ = endpoints;
+        cachedEndpoints.expiration_ = HttpUtilsClock::now() + std::chrono::seconds(DNS_CACHE_TTL);
+    }
+
+    return endpoints;
+}
+
+void HttpUtils::invalidateEndpoints(const std::string& host, std::uint16_t port)
+{
+    std::lock_guard<std::mutex> lock(endpointCacheGuard);
+    endpointCache.erase(EndpointCacheKey(host, port));
+}
+
+boost::asio::ip::tcp::endpoint HttpUtils::connect(boost::asio::io_service& io,
+                                                  boost::asio::ip::tcp::socket& sock,
+                                                  const std::vector<boost::asio::ip::tcp::endpoint>& endpoints,
+                                                  boost::system::error_code& errorCode)
+{
+    errorCode = boost::asio::error::host_not_found;
+
+    if (endpoints.size() == 1) {
+        sock.open(endpoints.front().protocol(), errorCode);
+        if (!errorCode) {
+            sock.connect(endpoints.front(), errorCode);
+        }
+        return endpoints.front();
+    }
+
+    struct ConnectionAttempt {
+        std::unique_ptr<boost::asio::ip::tcp::socket>    sock_;
+        boost::asio::ip::tcp::endpoint                   ep_;
+    };
+
+    /*
+     * Attempts are run by non-blocking sockets, so the I/O service of the socket needn't be running.
+     */
+    std::vector<ConnectionAttempt> attempts;
+    std::size_t nextEndpoint = 0;
+    auto nextAttemptTime = HttpUtilsClock::now();
+
+    while (nextEndpoint < endpoints.size() || !attempts.empty()) {
+        if (nextEndpoint < endpoints.size() && (attempts.empty() || HttpUtilsClock::now() >= nextAttemptTime)) {
+            const auto& ep = endpoints[nextEndpoint++];
+
+            ConnectionAttempt attempt;
+            attempt.sock_.reset(new boost::asio::ip::tcp::socket(io));
+            attempt.ep_ = ep;
+
+            boost::system::error_code attemptErrorCode;
+            attempt.sock_->open(ep.protocol(), attemptErrorCode);
+            if (!attemptErrorCode) {
+                attempt.sock_->non_blocking(true, attemptErrorCode);
+            }
+            if (!attemptErrorCode) {
+                attempt.sock_->connect(ep, attemptErrorCode);
+            }
+
+            if (!attemptErrorCode) {
+                attempts.clear();
+                attempts.push_back(std::move(attempt));
+                break;
+            }
+
+            if (attemptErrorCode == boost::asio::error::would_block ||
+                    attemptErrorCode == boost::asio::error::in_progress) {
+                attempts.push_back(std::move(attempt));
+                nextAttemptTime = HttpUtilsClock::now() + std::chrono::milliseconds(CONNECTION_ATTEMPT_DELAY);
+            } else {
+                errorCode = attemptErrorCode;
+            }
+
+            continue;
+        }
+
+        bool isConnected = false;
+        for (auto it = attempts.begin(); it != attempts.end();) {
+            /*
+             * The socket is writable once the connection attempt has finished.
+             */
+            boost::system::error_code attemptErrorCode;
+            it->sock_->write_some(boost::asio::null_buffers(), attemptErrorCode);
+            if (attemptErrorCode == boost::asio::error::would_block) {
+                ++it;
+                continue;
+            }
+
+            if (!attemptErrorCode) {
+                boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_ERROR> socketError;
+                it->sock_->get_option(socketError, attemptErrorCode);
+                if (!attemptErrorCode && socketError.value()) {
+                    attemptErrorCode = boost::system::error_code(socketError.value(),
+                                                                 boost::asio::error::get_system_category());
+                }
+            }
+
+            if (!attemptErrorCode) {
+                ConnectionAttempt winner = std::move(*it);
+                attempts.clear();
+                attempts.push_back(std::move(winner));
+                isConnected = true;
+                break;
+            }
+
+            errorCode = attemptErrorCode;
+            it = attempts.erase(it);
+        }
+
+        if (isConnected) {
+            break;
+        }
+
+        if (!attempts.empty()) {
+            std::this_thread::sleep_for(CONNECTION_POLL_INTERVAL);
+        }
+    }
+
+    if (attempts.empty()) {
+        return boost::asio::ip::tcp::endpoint();
+    }
+
+    auto& winner = attempts.front();
+    winner.sock_->non_blocking(false, errorCode);
+    sock = std::move(*winner.sock_);
+
+    return winner.ep_;
+}
+
+} /* namespace kaa */
@@ -28,6 +28,7 @@
 namespace kaa {
 
 const std::string MultipartPostHttpRequest::BOUNDARY = "----Sanj56fD843koI0";
+const std::string MultipartPostHttpRequest::CRLF = "\r\n";
 
 MultipartPostHttpRequest::MultipartPostHttpRequest(const HttpUrl& url, IKaaClientContext &context) : url_(url),context_(context)
 {
@@ -51,35 +52,68 @@ uint16_t MultipartPostHttpRequest::getPort() const
 
 std::string MultipartPostHttpRequest::getRequestData() const
 {
-    std::ostringstream stream;
-    stream << "POST " << url_.getUri() << " HTTP/1.1\r\n";
+    const auto& buffers = getRequestBuffers();
 
+    std::string data;
+    data.reserve(boost::asio::buffer_size(buffers));
+    for (const auto& buffer : buffers) {
+        data.append(boost::asio::buffer_cast<const char *>(buffer), boost::asio::buffer_size(buffer));
+    }
+
+    return data;
+}
+
+std::vector<boost::asio::const_buffer> MultipartPostHttpRequest::getRequestBuffers() const
+{
     KAA_LOG_TRACE(boost::format("Executing request POST %1% HTTP/1.1") % url_.getUri());
 
+    framing_.clear();
+    framing_.reserve(bodyFields_.size() + 2);
+
+    std::size_t contentLength = 0;
+    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it) {
+        std::ostringstream partStream;
+        partStream << "--" << BOUNDARY << "\r\n";
+        partStream << "Content-Disposition: form-data; name=\"" << it->first << "\"\r\n\r\n";
+        framing_.push_back(partStream.str());
+        contentLength += framing_.back().size() + it->second.size() + CRLF.size();
+    }
+
+    const std::string closing = "--" + BOUNDARY + "--\r\n\r\n";
+    contentLength += closing.size();
+    framing_.push_back(closing + "\r\n\r\n");
+
+    std::ostringstream stream;
+    stream << "POST " << url_.getUri() << " HTTP/1.1\r\n";
     stream << "Accept: */*\r\n";
     stream << "Content-Type: multipart/form-data; boundary=" << BOUNDARY << "\r\n";
     stream << "Host: " << url_.getHost() << "\r\n";
     for (auto it = headerFields_.begin(); it != headerFields_.end(); ++it) {
         stream << it->first << ": " << it->second << "\r\n";
     }
-    stream << "Connection: Close\r\n";
-    std::ostringstream bodyStream;
-    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it) {
-        bodyStream << "--" << BOUNDARY << "\r\n";
-        bodyStream << "Content-Disposition: form-data; name=\"" << it->first << "\"\r\n\r\n";
-        const std::vector<std::uint8_t>& body = it->second;
-        bodyStream.write(reinterpret_cast<const char *>(body.data()), body.size());
-        bodyStream << "\r\n";
+    if (headerFields_.find("Connection") == headerFields_.end()) {
+        stream << "Connection: Close\r\n";
     }
-    bodyStream << "--" << BOUNDARY << "--\r\n\r\n";
-    const std::string& body = bodyStream.str();
-    stream << "Content-Length: " << body.length() << "\r\n";
+    stream << "Content-Length: " << contentLength << "\r\n";
     stream << "\r\n";
-    if (body.length() > 0) {
-        stream << body << "\r\n\r\n";
+    framing_.push_back(stream.str());
+
+    /*
+     * framing_ is complete, so the strings won't move anymore.
+     */
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(3 * bodyFields_.size() + 2);
+    buffers.push_back(boost::asio::buffer(framing_.back()));
+
+    std::size_t partIndex = 0;
+    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it, ++partIndex) {
+        buffers.push_back(boost::asio::buffer(framing_[partIndex]));
+        buffers.push_back(boost::asio::buffer(it->second));
+        buffers.push_back(boost::asio::buffer(CRLF));
     }
+    buffers.push_back(boost::asio::buffer(framing_[partIndex]));
 
-    return stream.str();
+    return buffers;
 }
 
 void MultipartPostHttpRequest::setHeaderField(const std::string& name, const std::string& value)
@@ -97,6 +131,11 @@ void MultipartPostHttpRequest::setBodyField(const std::string& name, const std::
     bodyFields_.insert(std::make_pair(name, value));
 }
 
+void MultipartPostHttpRequest::setBodyField(const std::string& name, std::vector<std::uint8_t>&& value)
+{
+    bodyFields_.insert(std::make_pair(name, std::move(value)));
+}
+
 void MultipartPostHttpRequest::removeBodyField(const std::string& name)
 {
     bodyFields_.erase(name);
@@ -15,6 +15,7 @@
  */
 
 #include "kaa/kaatcp/ConnackMessage.hpp"
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 #include <boost/format.hpp>
 
@@ -58,7 +59,7 @@ std::string ConnackMessage::getMessage() const
 
 void ConnackMessage::parseMessage(const char *payload, std::uint16_t size)
 {
-    if (!payload || !size) {
+    if (!payload || size < 2) {
         throw KaaException("Bad Connack payload data");
     }
 
@@ -67,6 +68,19 @@ void ConnackMessage::parseMessage(const char *payload, std::uint16_t size)
         throw KaaException(boost::format("Bad Connack return code: %1%") % code);
     }
     returnCode_ = (ConnackReturnCode) code;
+
+    /*
+     * The flag of the first byte means the ticket lifetime and the session ticket follow the return code.
+     */
+    if (*payload & KaaTcpCommon::KAA_CONNACK_SESSION_TICKET_FLAG) {
+        if (size < 5) {
+            throw KaaException("Bad Connack session ticket");
+        }
+
+        const std::uint8_t *ticketData = reinterpret_cast<const std::uint8_t *>(payload);
+        sessionTicketLifetime_ = (ticketData[2] << 8) | ticketData[3];
+        sessionTicket_.assign(ticketData + 4, ticketData + size);
+    }
 }
 
 }
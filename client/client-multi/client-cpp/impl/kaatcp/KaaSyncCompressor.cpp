@@ -0,0 +1,98 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+
+#include <zlib.h>
+
+#include <boost/format.hpp>
+
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+#define KAA_SYNC_DECOMPRESSION_CHUNK_SIZE    4096
+
+namespace kaa {
+
+bool KaaSyncCompressor::compress(const std::uint8_t *data, std::size_t size, std::vector<std::uint8_t>& compressed)
+{
+    if (!data || size < MIN_COMPRESSIBLE_SIZE) {
+        return false;
+    }
+
+    uLongf compressedSize = compressBound(size);
+    compressed.resize(compressedSize);
+
+    int result = compress2(compressed.data(), &compressedSize, data, size, Z_DEFAULT_COMPRESSION);
+    if (result != Z_OK) {
+        throw KaaException(boost::format("Failed to compress KaaSync payload: error %1%") % result);
+    }
+
+    if (compressedSize >= size) {
+        return false;
+    }
+
+    compressed.resize(compressedSize);
+    return true;
+}
+
+std::vector<std::uint8_t> KaaSyncCompressor::decompress(const std::uint8_t *data, std::size_t size)
+{
+    if (!data || !size) {
+        throw KaaException("Failed to decompress KaaSync payload: no data");
+    }
+
+    z_stream stream = z_stream();
+    if (inflateInit(&stream) != Z_OK) {
+        throw KaaException("Failed to decompress KaaSync payload: initialization error");
+    }
+
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = size;
+
+    std::vector<std::uint8_t> decompressed;
+    int result = Z_OK;
+
+    while (result == Z_OK) {
+        if (decompressed.size() >= KaaTcpCommon::MAX_MESSAGE_LENGTH) {
+            result = Z_BUF_ERROR;
+            break;
+        }
+
+        auto offset = decompressed.size();
+        decompressed.resize(offset + KAA_SYNC_DECOMPRESSION_CHUNK_SIZE);
+
+        stream.next_out = decompressed.data() + offset;
+        stream.avail_out = KAA_SYNC_DECOMPRESSION_CHUNK_SIZE;
+
+        result = inflate(&stream, Z_NO_FLUSH);
+        decompressed.resize(offset + KAA_SYNC_DECOMPRESSION_CHUNK_SIZE - stream.avail_out);
+    }
+
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        throw KaaException(boost::format("Failed to decompress KaaSync payload: error %1%") % result);
+    }
+
+    return decompressed;
+}
+
+}
+
+#endif
@@ -15,20 +15,35 @@
  */
 
 #include "kaa/kaatcp/KaaTcpParser.hpp"
+
+#include <algorithm>
+
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
-void KaaTcpParser::onMessageDone()
+void KaaTcpParser::onMessageDone(const char *payload, const KaaTcpMessageHandler& handler)
 {
     KAA_LOG_DEBUG("KaaTcp: payload is fully received");
-    messages_.push_back(std::make_pair(messageType_, std::make_pair(messagePayload_, messageLength_)));
-    resetParser();
+    auto messageType = messageType_;
+    auto messageLength = messageLength_;
+    resetState();
+    handler(messageType, payload, messageLength);
+}
+
+void KaaTcpParser::onLengthDone(const KaaTcpMessageHandler& handler)
+{
+    KAA_LOG_DEBUG(boost::format("KaaTcp: retrieved message's size %1%") % (std::uint32_t) messageLength_);
+    if (messageLength_) {
+        state_ = KaaTcpParserState::PROCESSING_PAYLOAD;
+    } else {
+        onMessageDone(nullptr, handler);
+    }
 }
 
-void KaaTcpParser::processByte(char byte)
+void KaaTcpParser::processByte(char byte, const KaaTcpMessageHandler& handler)
 {
     switch (state_) {
         case KaaTcpParserState::NONE:
@@ -37,16 +52,14 @@ void KaaTcpParser::processByte(char byte)
             state_ = KaaTcpParserState::PROCESSING_LENGTH;
             break;
         case KaaTcpParserState::PROCESSING_LENGTH:
+            if (((std::uint8_t)byte & KaaTcpCommon::FIRST_BIT)
+                    && lenghtMultiplier_ >= KaaTcpCommon::FIRST_BIT * KaaTcpCommon::FIRST_BIT * KaaTcpCommon::FIRST_BIT) {
+                throw KaaException("KaaTcp: message length is longer than 4 bytes");
+            }
             messageLength_ += ((std::uint8_t)byte & ~KaaTcpCommon::FIRST_BIT) * lenghtMultiplier_;
             lenghtMultiplier_ *= KaaTcpCommon::FIRST_BIT;
             if (!((std::uint8_t)byte & KaaTcpCommon::FIRST_BIT)) {
-                KAA_LOG_DEBUG(boost::format("KaaTcp: retrieved message's size %1%") % (std::uint32_t) messageLength_);
-                if (messageLength_) {
-                    messagePayload_.reset(new char[messageLength_]);
-                    state_ = KaaTcpParserState::PROCESSING_PAYLOAD;
-                } else {
-                    onMessageDone();
-                }
+                onLengthDone(handler);
             }
             break;
         default:
@@ -54,6 +67,31 @@ void KaaTcpParser::processByte(char byte)
     }
 }
 
+/*
+ * Decodes the message type and the whole length in one step if the fixed header is complete
+ * in the buffer. Returns the number of bytes consumed, 0 if the header is left to processByte().
+ */
+std::uint32_t KaaTcpParser::readFixedHeader(const char *buffer, std::uint32_t size, const KaaTcpMessageHandler& handler)
+{
+    std::uint32_t length = 0;
+    std::uint32_t lengthBytes = std::min<std::uint32_t>(size - 1, KaaTcpCommon::MAX_LENGTH_BYTES);
+    for (std::uint32_t i = 0; i < lengthBytes; ++i) {
+        std::uint8_t byte = buffer[i + 1];
+        length |= (std::uint32_t)(byte & ~KaaTcpCommon::FIRST_BIT) << (7 * i);
+        if (!(byte & KaaTcpCommon::FIRST_BIT)) {
+            retrieveMessageType(buffer[0]);
+            messageLength_ = length;
+            onLengthDone(handler);
+            return i + 2;
+        }
+    }
+
+    if (lengthBytes == KaaTcpCommon::MAX_LENGTH_BYTES) {
+        throw KaaException("KaaTcp: message length is longer than 4 bytes");
+    }
+    return 0;
+}
+
 void KaaTcpParser::retrieveMessageType(char byte)
 {
     int messageType = ((std::uint8_t)(byte) >> 4);
@@ -67,22 +105,57 @@ void KaaTcpParser::retrieveMessageType(char byte)
 }
 
 void KaaTcpParser::parseBuffer(const char *buffer, std::uint32_t size)
+{
+    parseBuffer(buffer, size, [this] (KaaTcpMessageType type, const char *payload, std::uint32_t payloadSize)
+        {
+            boost::shared_array<char> payloadCopy;
+            if (payloadSize) {
+                payloadCopy.reset(new char[payloadSize]);
+                std::copy(payload, payload + payloadSize, payloadCopy.get());
+            }
+            messages_.push_back(std::make_pair(type, std::make_pair(payloadCopy, payloadSize)));
+        });
+}
+
+void KaaTcpParser::parseBuffer(const char *buffer, std::uint32_t size, const KaaTcpMessageHandler& handler)
 {
     auto cursor = buffer;
     while (cursor != buffer + size) {
         if (state_ == KaaTcpParserState::PROCESSING_PAYLOAD) {
             std::uint32_t remainingSize = messageLength_ - processedPayloadLength_;
             std::uint32_t bufferRemainingSize = buffer + size - cursor;
+
+            if (!processedPayloadLength_ && remainingSize <= bufferRemainingSize) {
+                /*
+                 * The whole payload is in the buffer, so it is passed as is.
+                 */
+                cursor += remainingSize;
+                onMessageDone(cursor - remainingSize, handler);
+                continue;
+            }
+
             std::uint32_t bytesToRead = (remainingSize > bufferRemainingSize) ? bufferRemainingSize : remainingSize;
-            std::copy(cursor, cursor + bytesToRead, messagePayload_.get() + processedPayloadLength_);
+            if (!processedPayloadLength_) {
+                splitPayload_.clear();
+                splitPayload_.reserve(messageLength_);
+            }
+            splitPayload_.insert(splitPayload_.end(), cursor, cursor + bytesToRead);
             cursor += bytesToRead;
             processedPayloadLength_ += bytesToRead;
             KAA_LOG_DEBUG(boost::format("KaaTcp: processed payload. Remaining buffer size is %1%") % ((buffer + size) - cursor));
             if (messageLength_ == processedPayloadLength_) {
-                onMessageDone();
+                onMessageDone(splitPayload_.data(), handler);
             }
         } else {
-            processByte(*(cursor++));
+            std::uint32_t consumed = 0;
+            if (state_ == KaaTcpParserState::NONE) {
+                consumed = readFixedHeader(cursor, buffer + size - cursor, handler);
+            }
+            if (consumed) {
+                cursor += consumed;
+            } else {
+                processByte(*(cursor++), handler);
+            }
         }
     }
 }
@@ -95,9 +168,14 @@ MessageRecordList KaaTcpParser::releaseMessages()
 }
 
 void KaaTcpParser::resetParser()
+{
+    resetState();
+    splitPayload_.clear();
+}
+
+void KaaTcpParser::resetState()
 {
     state_ = KaaTcpParserState::NONE;
-    messagePayload_.reset();
     messageLength_ = 0;
     processedPayloadLength_ = 0;
     messageType_ = KaaTcpMessageType::MESSAGE_UNKNOWN;
@@ -105,5 +183,3 @@ void KaaTcpParser::resetParser()
 }
 
 }
-
-
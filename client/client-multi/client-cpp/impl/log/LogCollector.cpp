@@ -16,6 +16,8 @@
 
 #include "kaa/log/LogCollector.hpp"
 
+#include <algorithm>
+
 #include "kaa/gen/EndpointGen.hpp"
 #include "kaa/common/UuidGenerator.hpp"
 #include "kaa/logging/Log.hpp"
@@ -29,6 +31,8 @@
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/log/LogBucket.hpp"
 #include "kaa/log/ILogDeliveryListener.hpp"
+#include "kaa/utils/TimeUtils.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
 
 #ifdef KAA_USE_SQLITE_LOG_STORAGE
 #include "kaa/log/SQLiteDBLogStorage.hpp"
@@ -36,6 +40,17 @@
 #include "kaa/log/MemoryLogStorage.hpp"
 #endif
 
+/*
+ * A round trip time greater than the minimal one by this factor means the link is congested.
+ */
+#define KAA_LOG_UPLOAD_RTT_INFLATION_FACTOR    2
+
+/*
+ * Buckets dropped by a storage are never acknowledged, so their encoded requests are forgotten
+ * once there are more undelivered requests than this.
+ */
+#define KAA_LOG_MAX_ENCODED_REQUESTS    32
+
 namespace kaa {
 
 LogCollector::LogCollector(IKaaChannelManagerPtr manager, IKaaClientContext &context)
@@ -49,30 +64,59 @@ LogCollector::LogCollector(IKaaChannelManagerPtr manager, IKaaClientContext &con
     storage_.reset(new MemoryLogStorage(context_));
 #endif
     uploadStrategy_.reset(new DefaultLogUploadStrategy(context_));
-
-    startTimeoutTimer();
 }
 
 void LogCollector::startTimeoutTimer() {
-    timeoutTimer_.stop();
-    timeoutTimer_.start(uploadStrategy_->getTimeoutCheckPeriod(), [this]
+    std::chrono::milliseconds delay;
+    {
+        KAA_MUTEX_LOCKING("timeoutsGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
+        KAA_MUTEX_LOCKED("timeoutsGuard_");
+
+        /*
+         * The timer runs only while there are buckets waiting for the delivery status.
+         */
+        if (timeoutDeadlines_.empty()) {
+            return;
+        }
+
+        /*
+         * The timer expires right after the earliest deadline, so the request is found expired.
+         */
+        auto timeLeft = std::chrono::duration_cast<std::chrono::milliseconds>(timeoutDeadlines_.begin()->first
+                                                                             - clock_t::now());
+        delay = std::max(timeLeft, std::chrono::milliseconds::zero()) + std::chrono::milliseconds(1);
+    }
+
+    timeoutTimer_.start(delay, [this]
                     {
                             if (isDeliveryTimeout()) {
                                 processTimeout();
                             }
+
                             startTimeoutTimer();
                     });
 }
 
 void LogCollector::startLogUploadCheckTimer()
 {
-    logUploadCheckTimer_.stop();
+    /*
+     * A single deadline: it isn't restarted by decisions made before it expires,
+     * so records added in the meantime don't postpone the check.
+     */
     logUploadCheckTimer_.start(uploadStrategy_->getLogUploadCheckPeriod(),[this]
     {
         processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
     });
 }
 
+void LogCollector::scheduleLogUploadCheck()
+{
+    if (uploadStrategy_->isTimeDependent() && storage_->getStatus().getRecordsCount() > 0) {
+        startLogUploadCheckTimer();
+    }
+}
+
 void LogCollector::processTimeout()
 {
     context_.getExecutorContext().getCallbackExecutor().add([this] ()
@@ -88,44 +132,107 @@ void LogCollector::processTimeout()
 
     auto now = clock_t::now();
 
-    for (auto request = timeouts_.begin(); request != timeouts_.end();) {
-        if (now >= request->second.getTimeoutTime()) {
-            storage_->rollbackBucket(request->first);
-            request = timeouts_.erase(request);
-        } else {
-            request++;
-        }
+    while (!timeoutDeadlines_.empty() && now >= timeoutDeadlines_.begin()->first) {
+        auto requestId = timeoutDeadlines_.begin()->second;
+        storage_->rollbackBucket(requestId);
+        timeouts_.erase(requestId);
+        timeoutDeadlines_.erase(timeoutDeadlines_.begin());
     }
 
     KAA_MUTEX_UNLOCKING("timeoutsGuard_");
     KAA_UNLOCK(timeoutsGuardLock);
     KAA_MUTEX_UNLOCKED("timeoutsGuard_");
 
+    shrinkUploadWindow();
+
     processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
 }
 
-RecordFuture LogCollector::addLogRecord(const KaaUserLogRecord& record)
+RecordFuture LogCollector::addLogRecord(const KaaUserLogRecord& record, LogPriority priority)
 {
     RecordInfo recordInfo;
-    auto promisePtr = std::make_shared<std::promise<RecordInfo>>();
+    auto promisePtr = std::make_shared<KaaPromise<RecordInfo>>();
     RecordDeliveryInfo recordDeliveryInfo(promisePtr, recordInfo);
 
-    context_.getExecutorContext().getApiExecutor().add([this, record, recordDeliveryInfo] ()
+    bool isDrainNeeded = false;
+    try {
+        isDrainNeeded = pendingLogRecords_.push(PendingLogRecord(LogRecord(record, priority), recordDeliveryInfo));
+    } catch (...) {
+        KAA_LOG_WARN("Failed to serialize log record");
+        promisePtr->setException(std::current_exception());
+        return RecordFuture(promisePtr->getFuture());
+    }
+
+    if (isDrainNeeded) {
+        scheduleDrainOfPendingLogRecords();
+    }
+
+    return RecordFuture(promisePtr->getFuture());
+}
+
+void LogCollector::addLogRecordWithoutFuture(const KaaUserLogRecord& record, LogPriority priority)
+{
+    if (pendingLogRecords_.push(PendingLogRecord(LogRecord(record, priority),
+                                                 RecordDeliveryInfo(DeliveryFuture(), RecordInfo())))) {
+        scheduleDrainOfPendingLogRecords();
+    }
+}
+
+void LogCollector::addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record, LogPriority priority)
+{
+    const auto& batchState = batch.getState();
+    if (!batchState->addRecord()) {
+        KAA_LOG_WARN("Failed to add log record: the record batch is closed");
+        throw KaaException("Record batch is closed");
+    }
+
+    bool isDrainNeeded = false;
+    try {
+        isDrainNeeded = pendingLogRecords_.push(PendingLogRecord(LogRecord(record, priority),
+                                                                 RecordDeliveryInfo(DeliveryFuture(), RecordInfo(),
+                                                                                    batchState)));
+    } catch (...) {
+        KAA_LOG_WARN("Failed to serialize log record");
+        batchState->onRecordFailed(std::current_exception());
+        return;
+    }
+
+    if (isDrainNeeded) {
+        scheduleDrainOfPendingLogRecords();
+    }
+}
+
+void LogCollector::scheduleDrainOfPendingLogRecords()
+{
+    /*
+     * Called only by the producer which found the queue empty,
+     * records of the others are picked up by the same drain.
+     */
+    context_.getExecutorContext().getApiExecutor().add([this] () { drainPendingLogRecords(); });
+}
+
+void LogCollector::drainPendingLogRecords()
+{
+    auto recordCount = pendingLogRecords_.consumeAll([this] (PendingLogRecord&& pendingRecord)
             {
                 try {
-                    auto bucketInfo = storage_->addLogRecord(LogRecord(record));
-                    updateBucketInfo(bucketInfo, recordDeliveryInfo);
+                    auto bucketInfo = storage_->addLogRecord(std::move(pendingRecord.record_));
+                    updateBucketInfo(bucketInfo, pendingRecord.recordDeliveryInfo_);
                 } catch (...) {
                     try {
                         KAA_LOG_WARN("Failed to add log record");
-                        recordDeliveryInfo.deliveryFuture_->set_exception(std::current_exception());
+                        if (pendingRecord.recordDeliveryInfo_.deliveryFuture_) {
+                            pendingRecord.recordDeliveryInfo_.deliveryFuture_->setException(std::current_exception());
+                        } else if (pendingRecord.recordDeliveryInfo_.batch_) {
+                            pendingRecord.recordDeliveryInfo_.batch_->onRecordFailed(std::current_exception());
+                        }
                     } catch(...) {}
                 }
 
                 processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
             });
 
-    return RecordFuture(promisePtr->get_future());
+    KAA_LOG_TRACE(boost::format("Moved %1% log record(s) to storage") % recordCount);
 }
 
 void LogCollector::processLogUploadDecision(LogUploadStrategyDecision decision)
@@ -140,9 +247,7 @@ void LogCollector::processLogUploadDecision(LogUploadStrategyDecision decision)
     }
     case LogUploadStrategyDecision::NOOP:
         KAA_LOG_TRACE("Nothing to do now");
-        if (storage_->getStatus().getRecordsCount() > 0) {
-            startLogUploadCheckTimer();
-        }
+        scheduleLogUploadCheck();
         break;
     default:
         KAA_LOG_WARN("Unknown log upload decision");
@@ -159,6 +264,32 @@ void LogCollector::setStorage(ILogStoragePtr storage)
 
     KAA_LOG_INFO("New log storage was set");
     storage_ = storage;
+
+    if (maxBucketSize_) {
+        setMaxBucketSize(maxBucketSize_);
+    }
+
+    // Bucket ids of the new storage may clash with the old ones
+    KAA_MUTEX_LOCKING("encodedRequestsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(encodedRequestsLock, encodedRequestsGuard_);
+    KAA_MUTEX_LOCKED("encodedRequestsGuard_");
+
+    encodedRequests_.clear();
+}
+
+bool LogCollector::setMaxBucketSize(std::size_t bucketSize)
+{
+    maxBucketSize_ = bucketSize;
+    if (!bucketSize) {
+        return false;
+    }
+
+    bool isLimited = storage_->setBucketLimits(bucketSize, LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+    if (!isLimited) {
+        KAA_LOG_WARN(boost::format("Log storage doesn't support bucket limits, buckets may exceed %1% bytes")
+                     % bucketSize);
+    }
+    return isLimited;
 }
 
 void LogCollector::setUploadStrategy(ILogUploadStrategyPtr strategy)
@@ -171,6 +302,17 @@ void LogCollector::setUploadStrategy(ILogUploadStrategyPtr strategy)
     KAA_LOG_INFO("New log upload strategy was set");
     uploadStrategy_ = strategy;
 
+    KAA_MUTEX_LOCKING("timeoutsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
+    KAA_MUTEX_LOCKED("timeoutsGuard_");
+
+    uploadWindow_ = 0;
+    minRoundTripTimeMs_ = 0;
+
+    KAA_MUTEX_UNLOCKING("timeoutsGuard_");
+    KAA_UNLOCK(timeoutsGuardLock);
+    KAA_MUTEX_UNLOCKED("timeoutsGuard_");
+
     rescheduleTimers();
 }
 
@@ -196,24 +338,23 @@ bool LogCollector::isDeliveryTimeout()
     bool isTimeout = false;
     timeoutAccessPointId_ = 0;
 
-    for (const auto& request : timeouts_) {
-        if (now >= request.second.getTimeoutTime()) {
-            KAA_LOG_WARN(boost::format("Log delivery timeout detected, bucket id %li") % request.first);
-            isTimeout = true;
+    for (auto deadline = timeoutDeadlines_.begin();
+            deadline != timeoutDeadlines_.end() && now >= deadline->first; ++deadline) {
+        auto bucketId = deadline->second;
+        KAA_LOG_WARN(boost::format("Log delivery timeout detected, bucket id %li") % bucketId);
+        isTimeout = true;
 
-            if (logDeliverylistener_) {
-                auto bucketId = request.first;
-                context_.getExecutorContext().getCallbackExecutor().add([this, bucketId] ()
-                        {
-                            logDeliverylistener_->onLogDeliveryTimeout(getBucketInfo(bucketId));
-                        });
-            }
+        if (logDeliverylistener_) {
+            context_.getExecutorContext().getCallbackExecutor().add([this, bucketId] ()
+                    {
+                        logDeliverylistener_->onLogDeliveryTimeout(getBucketInfo(bucketId));
+                    });
+        }
 
-            timeoutAccessPointId_ = request.second.getTransportAccessPointId();
-            // Check if current access point already has timeout
-            if (timeoutAccessPointId_ == currentAccessPointId) {
-                break;
-            }
+        timeoutAccessPointId_ = timeouts_.at(bucketId).getTransportAccessPointId();
+        // Check if current access point already has timeout
+        if (timeoutAccessPointId_ == currentAccessPointId) {
+            break;
         }
     }
 
@@ -232,18 +373,45 @@ void LogCollector::addDeliveryTimeout(std::int32_t requestId)
         currentAccessPointId = logChannel->getServer()->getAccessPointId();
     }
     TimeoutInfo timeoutInfo(currentAccessPointId,
-            clock_t::now() + std::chrono::seconds(uploadStrategy_->getTimeout()));
+            clock_t::now() + std::chrono::seconds(uploadStrategy_->getTimeout()),
+            TimeUtils::getCurrentTimeInMs());
 
-    timeouts_.insert(std::make_pair(requestId, timeoutInfo));
+    if (!timeouts_.insert(std::make_pair(requestId, timeoutInfo)).second) {
+        return;
+    }
+
+    timeoutDeadlines_.insert(std::make_pair(timeoutInfo.getTimeoutTime(), requestId));
+    bool isEarliest = timeoutDeadlines_.begin()->second == requestId;
+
+    KAA_MUTEX_UNLOCKING("timeoutsGuard_");
+    KAA_UNLOCK(timeoutsGuardLock);
+    KAA_MUTEX_UNLOCKED("timeoutsGuard_");
+
+    /*
+     * The timer waiting for a later deadline is restarted for the new one.
+     */
+    if (isEarliest) {
+        timeoutTimer_.stop();
+    }
+    startTimeoutTimer();
 }
 
-bool LogCollector::removeDeliveryTimeout(std::int32_t requestId)
+bool LogCollector::removeDeliveryTimeout(std::int32_t requestId, std::size_t& sendTimeMs)
 {
     KAA_MUTEX_LOCKING("timeoutsGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
     KAA_MUTEX_LOCKED("timeoutsGuard_");
 
-    return timeouts_.erase(requestId);
+    auto it = timeouts_.find(requestId);
+    if (it == timeouts_.end()) {
+        return false;
+    }
+
+    sendTimeMs = it->second.getSendTimeMs();
+    timeoutDeadlines_.erase(std::make_pair(it->second.getTimeoutTime(), requestId));
+    timeouts_.erase(it);
+
+    return true;
 }
 
 bool LogCollector::isUploadAllowed()
@@ -252,15 +420,64 @@ bool LogCollector::isUploadAllowed()
     KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
     KAA_MUTEX_LOCKED("timeoutsGuard_");
 
-    if (timeouts_.size() >= uploadStrategy_->getMaxParallelUploads()) {
+    auto uploadWindow = getUploadWindow();
+    if (timeouts_.size() >= uploadWindow) {
         KAA_LOG_INFO(boost::format("Ignore log upload: too much pending requests %u, max allowed %u"  )
-                                                       % timeouts_.size() % uploadStrategy_->getMaxParallelUploads());
+                                                       % timeouts_.size() % uploadWindow);
         return false;
     }
 
     return true;
 }
 
+bool LogCollector::hasFreeUploadSlot()
+{
+    KAA_MUTEX_LOCKING("timeoutsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
+    KAA_MUTEX_LOCKED("timeoutsGuard_");
+
+    return timeouts_.size() < getUploadWindow();
+}
+
+std::size_t LogCollector::getUploadWindow()
+{
+    auto maxParallelUploads = uploadStrategy_->getMaxParallelUploads();
+    return (uploadWindow_ && uploadWindow_ < maxParallelUploads) ? uploadWindow_ : maxParallelUploads;
+}
+
+void LogCollector::adaptUploadWindow(std::size_t roundTripTimeMs)
+{
+    KAA_MUTEX_LOCKING("timeoutsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
+    KAA_MUTEX_LOCKED("timeoutsGuard_");
+
+    if (!minRoundTripTimeMs_ || roundTripTimeMs < minRoundTripTimeMs_) {
+        minRoundTripTimeMs_ = roundTripTimeMs ? roundTripTimeMs : 1;
+    }
+
+    auto uploadWindow = getUploadWindow();
+    if (roundTripTimeMs > minRoundTripTimeMs_ * KAA_LOG_UPLOAD_RTT_INFLATION_FACTOR) {
+        uploadWindow_ = uploadWindow > 1 ? uploadWindow - 1 : 1;
+    } else {
+        uploadWindow_ = uploadWindow + 1;
+    }
+
+    KAA_LOG_TRACE(boost::format("Log upload window %1%, round trip time %2% ms, min %3% ms")
+                                        % getUploadWindow() % roundTripTimeMs % minRoundTripTimeMs_);
+}
+
+void LogCollector::shrinkUploadWindow()
+{
+    KAA_MUTEX_LOCKING("timeoutsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(timeoutsGuardLock, timeoutsGuard_);
+    KAA_MUTEX_LOCKED("timeoutsGuard_");
+
+    auto uploadWindow = getUploadWindow();
+    uploadWindow_ = uploadWindow > 1 ? uploadWindow / 2 : 1;
+
+    KAA_LOG_DEBUG(boost::format("Log upload window shrinked to %1%") % uploadWindow_);
+}
+
 std::shared_ptr<LogSyncRequest> LogCollector::getLogUploadRequest()
 {
     std::shared_ptr<LogSyncRequest> request;
@@ -269,29 +486,79 @@ std::shared_ptr<LogSyncRequest> LogCollector::getLogUploadRequest()
         return request;
     }
 
-    LogBucket bucket = storage_->getNextBucket();
-    if (bucket.getRecords().empty()) {
+    /*
+     * Log records are copied straight from a storage into log entries.
+     */
+    std::vector<LogEntry> logsToSend;
+    auto bucketInfo = storage_->visitNextBucket([&logsToSend] (const std::uint8_t *data, std::size_t size)
+            {
+                logsToSend.emplace_back();
+                logsToSend.back().data.assign(data, data + size);
+            });
+
+    if (!bucketInfo.getLogCount() || logsToSend.empty()) {
         KAA_LOG_TRACE("No logs to send");
         return request;
     }
 
-    KAA_LOG_TRACE(boost::format("Sending %1% log records") % bucket.getRecords().size());
+    KAA_LOG_TRACE(boost::format("Sending %1% log records") % logsToSend.size());
 
     request.reset(new LogSyncRequest);
-    request->requestId = bucket.getBucketId();
+    request->requestId = bucketInfo.getBucketId();
+    request->logEntries.set_array(logsToSend);
+    addDeliveryTimeout(request->requestId);
 
-    std::vector<LogEntry> logsToSend;
-    logsToSend.resize(bucket.getRecords().size());
+    /*
+     * Do not wait for the delivery status to send the next bucket.
+     */
+    if (hasFreeUploadSlot() && storage_->getStatus().getRecordsCount()) {
+        context_.getExecutorContext().getApiExecutor().add([this] ()
+                {
+                    processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
+                });
+    }
+
+    return request;
+}
 
-    std::size_t i = 0;
-    for (auto& record : bucket.getRecords()) {
-        logsToSend[i++].data = std::move(record.getRvalueData());
+std::shared_ptr<const std::vector<std::uint8_t>> LogCollector::getEncodedLogUploadRequest()
+{
+    auto request = getLogUploadRequest();
+    if (!request) {
+        return std::shared_ptr<const std::vector<std::uint8_t>>();
     }
 
-    request->logEntries.set_array(std::move(logsToSend));
-    addDeliveryTimeout(request->requestId);
+    KAA_MUTEX_LOCKING("encodedRequestsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(encodedRequestsLock, encodedRequestsGuard_);
+    KAA_MUTEX_LOCKED("encodedRequestsGuard_");
+
+    /*
+     * A bucket keeps its records and id across retries, so does its encoded request.
+     */
+    auto it = encodedRequests_.find(request->requestId);
+    if (it != encodedRequests_.end()) {
+        KAA_LOG_TRACE(boost::format("Resending encoded log request, id %1%") % request->requestId);
+        return it->second;
+    }
 
-    return request;
+    auto encodedRequest = std::make_shared<std::vector<std::uint8_t>>();
+    AvroByteArrayConverter<LogSyncRequest>().toByteArray(*request, *encodedRequest);
+
+    encodedRequests_.insert(std::make_pair(request->requestId, encodedRequest));
+    if (encodedRequests_.size() > KAA_LOG_MAX_ENCODED_REQUESTS) {
+        encodedRequests_.erase(encodedRequests_.begin());
+    }
+
+    return encodedRequest;
+}
+
+void LogCollector::removeEncodedRequest(std::int32_t requestId)
+{
+    KAA_MUTEX_LOCKING("encodedRequestsGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(encodedRequestsLock, encodedRequestsGuard_);
+    KAA_MUTEX_LOCKED("encodedRequestsGuard_");
+
+    encodedRequests_.erase(requestId);
 }
 
 void LogCollector::onLogUploadResponse(const LogSyncResponse& response, std::size_t deliveryTime)
@@ -300,7 +567,8 @@ void LogCollector::onLogUploadResponse(const LogSyncResponse& response, std::siz
         const auto& deliveryStatuses = response.deliveryStatuses.get_array();
 
         for (const auto& status : deliveryStatuses) {
-            if (!removeDeliveryTimeout(status.requestId)) {
+            std::size_t sendTimeMs = 0;
+            if (!removeDeliveryTimeout(status.requestId, sendTimeMs)) {
                 KAA_LOG_WARN(boost::format("Received unknown delivery status, id %1%. Ignoring...") % status.requestId);
                 continue;
             }
@@ -310,7 +578,18 @@ void LogCollector::onLogUploadResponse(const LogSyncResponse& response, std::siz
             if (status.result == SyncResponseResultType::SUCCESS) {
                 KAA_LOG_INFO(boost::format("Logs (requestId %ld) successfully delivered") % status.requestId);
 
+                if (deliveryTime >= sendTimeMs) {
+                    auto roundTripTimeMs = deliveryTime - sendTimeMs;
+                    adaptUploadWindow(roundTripTimeMs);
+
+                    context_.getExecutorContext().getCallbackExecutor().add([this, bucketInfo, roundTripTimeMs] ()
+                            {
+                                uploadStrategy_->onSuccess(bucketInfo, roundTripTimeMs);
+                            });
+                }
+
                 storage_->removeBucket(status.requestId);
+                removeEncodedRequest(status.requestId);
 
                 if (logDeliverylistener_) {
                     context_.getExecutorContext().getCallbackExecutor().add([this, bucketInfo] ()
@@ -326,6 +605,7 @@ void LogCollector::onLogUploadResponse(const LogSyncResponse& response, std::siz
                         });
             } else {
                 storage_->rollbackBucket(status.requestId);
+                shrinkUploadWindow();
 
                 if (!status.errorCode.is_null()) {
                     auto errocCode = status.errorCode.get_LogDeliveryErrorCode();
@@ -382,6 +662,7 @@ void LogCollector::switchAccessPoint()
                 storage_->rollbackBucket(request.first);
             }
             timeouts_.clear();
+            timeoutDeadlines_.clear();
         }
     } else {
         KAA_LOG_ERROR("Can't find LOGGING data channel");
@@ -390,8 +671,11 @@ void LogCollector::switchAccessPoint()
 
 void LogCollector::rescheduleTimers()
 {
+    timeoutTimer_.stop();
     startTimeoutTimer();
-    startLogUploadCheckTimer();
+
+    logUploadCheckTimer_.stop();
+    scheduleLogUploadCheck();
 }
 
 void LogCollector::updateBucketInfo(const BucketInfo& bucketInfo, const RecordDeliveryInfo& recordInfo)
@@ -403,7 +687,23 @@ void LogCollector::updateBucketInfo(const BucketInfo& bucketInfo, const RecordDe
     auto& bucket = bucketInfoStorage_[bucketInfo.getBucketId()];
 
     bucket.bucketInfo_ = bucketInfo;
-    bucket.recordDeliveryInfoStorage_.push_back(recordInfo);
+
+    if (recordInfo.deliveryFuture_) {
+        bucket.recordDeliveryInfoStorage_.push_back(recordInfo);
+    } else if (recordInfo.batch_) {
+        auto& batchRecordCounts = bucket.batchRecordCounts_;
+        auto it = std::find_if(batchRecordCounts.rbegin(), batchRecordCounts.rend(),
+                               [&recordInfo] (const BatchRecordCounts::value_type& count)
+                               {
+                                   return count.first == recordInfo.batch_;
+                               });
+
+        if (it != batchRecordCounts.rend()) {
+            ++it->second;
+        } else {
+            batchRecordCounts.emplace_back(recordInfo.batch_, 1);
+        }
+    }
 }
 
 void LogCollector::notifyDeliveryFuturesOnSuccess(std::int32_t bucketId, std::size_t deliveryTime)
@@ -412,13 +712,32 @@ void LogCollector::notifyDeliveryFuturesOnSuccess(std::int32_t bucketId, std::si
     KAA_MUTEX_UNIQUE_DECLARE(bucketInfoStorageLock, bucketInfoStorageGuard_);
     KAA_MUTEX_LOCKED("bucketInfoStorageGuard_");
 
+    std::list<RecordDeliveryInfo> recordDeliveryInfos;
+    BatchRecordCounts batchRecordCounts;
+
     auto it = bucketInfoStorage_.find(bucketId);
     if (it != bucketInfoStorage_.end()) {
         for (auto& recordFutureInfo : it->second.recordDeliveryInfoStorage_) {
             recordFutureInfo.recordInfo_.setRecordDeliveryTimeMs(deliveryTime - recordFutureInfo.recordInfo_.getRecordAddedTimestampMs());
             recordFutureInfo.recordInfo_.setBucketInfo(it->second.bucketInfo_);
-            recordFutureInfo.deliveryFuture_->set_value(recordFutureInfo.recordInfo_);
         }
+        recordDeliveryInfos.swap(it->second.recordDeliveryInfoStorage_);
+        batchRecordCounts.swap(it->second.batchRecordCounts_);
+    }
+
+    KAA_MUTEX_UNLOCKING("bucketInfoStorageGuard_");
+    KAA_UNLOCK(bucketInfoStorageLock);
+    KAA_MUTEX_UNLOCKED("bucketInfoStorageGuard_");
+
+    /*
+     * Continuations of record futures run here, so the lock is released before.
+     */
+    for (auto& recordFutureInfo : recordDeliveryInfos) {
+        recordFutureInfo.deliveryFuture_->setValue(recordFutureInfo.recordInfo_);
+    }
+
+    for (const auto& batchRecordCount : batchRecordCounts) {
+        batchRecordCount.first->onRecordsDelivered(batchRecordCount.second);
     }
 }
 
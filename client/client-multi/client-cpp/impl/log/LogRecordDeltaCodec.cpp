@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/log/LogRecordDeltaCodec.hpp"
+
+#include <algorithm>
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+const std::size_t LogRecordDeltaCodec::MIN_COPY_SIZE;
+
+static void writeVarint(std::vector<std::uint8_t>& buffer, std::size_t value)
+{
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+static std::size_t readVarint(const std::uint8_t *&next, const std::uint8_t *end)
+{
+    std::size_t value = 0;
+    for (std::size_t shift = 0; next != end && shift < 8 * sizeof(value); shift += 7) {
+        std::uint8_t byte = *next++;
+        value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw KaaException("Corrupted log record delta");
+}
+
+bool LogRecordDeltaCodec::encode(const std::uint8_t *reference, std::size_t referenceSize,
+                                 const std::uint8_t *record, std::size_t recordSize,
+                                 std::vector<std::uint8_t>& delta)
+{
+    delta.clear();
+
+    std::size_t suffixSize = 0;
+    std::size_t maxSuffixSize = std::min(referenceSize, recordSize);
+    while (suffixSize < maxSuffixSize
+            && reference[referenceSize - suffixSize - 1] == record[recordSize - suffixSize - 1]) {
+        ++suffixSize;
+    }
+
+    std::size_t middleSize = recordSize - suffixSize;
+    writeVarint(delta, suffixSize);
+
+    std::size_t offset = 0;
+    while (offset < middleSize && delta.size() < recordSize) {
+        std::size_t copyOffset = offset;
+        std::size_t copySize = 0;
+        while (copyOffset < middleSize) {
+            while (copyOffset + copySize < middleSize && copyOffset + copySize < referenceSize
+                    && record[copyOffset + copySize] == reference[copyOffset + copySize]) {
+                ++copySize;
+            }
+
+            if (copySize >= MIN_COPY_SIZE) {
+                break;
+            }
+
+            copyOffset += copySize ? copySize : 1;
+            copySize = 0;
+        }
+
+        writeVarint(delta, copyOffset - offset);
+        delta.insert(delta.end(), record + offset, record + copyOffset);
+        writeVarint(delta, copySize);
+
+        offset = copyOffset + copySize;
+    }
+
+    return delta.size() < recordSize;
+}
+
+void LogRecordDeltaCodec::decode(const std::uint8_t *reference, std::size_t referenceSize,
+                                 const std::uint8_t *delta, std::size_t deltaSize,
+                                 std::vector<std::uint8_t>& record)
+{
+    const std::uint8_t *next = delta;
+    const std::uint8_t *end = delta + deltaSize;
+
+    record.clear();
+
+    std::size_t suffixSize = readVarint(next, end);
+    if (suffixSize > referenceSize) {
+        throw KaaException("Corrupted log record delta");
+    }
+
+    while (next != end) {
+        std::size_t literalSize = readVarint(next, end);
+        if (literalSize > static_cast<std::size_t>(end - next)) {
+            throw KaaException("Corrupted log record delta");
+        }
+        record.insert(record.end(), next, next + literalSize);
+        next += literalSize;
+
+        std::size_t copySize = readVarint(next, end);
+        std::size_t copyOffset = record.size();
+        if (copySize && (copyOffset > referenceSize || copySize > referenceSize - copyOffset)) {
+            throw KaaException("Corrupted log record delta");
+        }
+        record.insert(record.end(), reference + copyOffset, reference + copyOffset + copySize);
+    }
+
+    record.insert(record.end(), reference + referenceSize - suffixSize, reference + referenceSize);
+}
+
+std::size_t LogRecordDeltaCodec::getDecodedSize(const std::uint8_t *delta, std::size_t deltaSize)
+{
+    const std::uint8_t *next = delta;
+    const std::uint8_t *end = delta + deltaSize;
+
+    std::size_t size = readVarint(next, end);
+    while (next != end) {
+        std::size_t literalSize = readVarint(next, end);
+        if (literalSize > static_cast<std::size_t>(end - next)) {
+            throw KaaException("Corrupted log record delta");
+        }
+        next += literalSize;
+        size += literalSize + readVarint(next, end);
+    }
+
+    return size;
+}
+
+} /* namespace kaa */
@@ -21,6 +21,11 @@ namespace kaa {
 const std::size_t LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE;
 const std::size_t LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT;
 
+const std::size_t LogStorageConstants::DEFAULT_GROUP_COMMIT_RECORD_COUNT;
+const std::size_t LogStorageConstants::DEFAULT_GROUP_COMMIT_TIMEOUT_MS;
+
+const std::size_t LogStorageConstants::DEFAULT_BUCKET_CACHE_SIZE;
+
 const std::string LogStorageConstants::DEFAULT_LOG_DB_STORAGE = "logs.db";
 
 }
@@ -37,6 +37,11 @@ std::shared_ptr<LogSyncRequest> LoggingTransport::createLogSyncRequest()
     return logProcessor_.getLogUploadRequest();
 }
 
+std::shared_ptr<const std::vector<std::uint8_t>> LoggingTransport::createEncodedLogSyncRequest()
+{
+    return logProcessor_.getEncodedLogUploadRequest();
+}
+
 void LoggingTransport::onLogSyncResponse(const LogSyncResponse& response, std::size_t deliveryTime)
 {
     logProcessor_.onLogUploadResponse(response, deliveryTime);
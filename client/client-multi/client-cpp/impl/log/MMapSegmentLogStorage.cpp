@@ -0,0 +1,510 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef KAA_USE_MMAP_LOG_STORAGE
+
+#include "kaa/log/MMapSegmentLogStorage.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+#define KAA_LOG_SEGMENT_EXTENSION    ".seg"
+
+#define KAA_LOG_SEGMENT_MAGIC        0x4B414153 /* "KAAS" */
+#define KAA_LOG_SEGMENT_VERSION      1
+
+#define KAA_LOG_SEGMENT_IN_USE_FLAG  0x1
+
+namespace kaa {
+
+/*
+ * The header at the beginning of each segment file. The data area following the header
+ * contains records one by another, each prefixed by its size.
+ */
+struct SegmentHeader {
+    std::uint32_t   magic_;
+    std::uint16_t   version_;
+    std::uint16_t   flags_;
+    std::int32_t    bucketId_;
+    std::uint32_t   recordCount_;
+    std::uint32_t   dataSize_;
+    std::uint32_t   reserved_;
+};
+
+typedef std::uint32_t RecordSizePrefix;
+
+static std::string getErrorDescription()
+{
+    return std::strerror(errno);
+}
+
+static bool readSegmentHeader(int fd, SegmentHeader& header)
+{
+    return pread(fd, &header, sizeof(header), 0) == sizeof(header);
+}
+
+static std::size_t getPayloadSize(const SegmentHeader& header)
+{
+    return header.dataSize_ - header.recordCount_ * sizeof(RecordSizePrefix);
+}
+
+static void visitSegmentRecords(const std::uint8_t *data, const ILogStorage::LogRecordVisitor& visitor)
+{
+    const SegmentHeader *header = reinterpret_cast<const SegmentHeader *>(data);
+    const std::uint8_t *record = data + sizeof(SegmentHeader);
+
+    for (std::uint32_t i = 0; i < header->recordCount_; ++i) {
+        RecordSizePrefix recordSize = 0;
+        std::memcpy(&recordSize, record, sizeof(recordSize));
+        record += sizeof(recordSize);
+
+        visitor(record, recordSize);
+        record += recordSize;
+    }
+}
+
+MMapSegmentLogStorage::MMapSegmentLogStorage(IKaaClientContext &context, const std::string& directory,
+                                             std::size_t bucketSize, std::size_t bucketRecordCount)
+    : directory_(directory), maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), context_(context)
+{
+    KAA_LOG_INFO(boost::format("Going to use segment log storage in '%1%'. Bucket: max_size %2% bytes, max_record_count %3%")
+                                                                % directory_ % maxBucketSize_ % maxBucketRecordCount_);
+    loadSegments();
+}
+
+MMapSegmentLogStorage::~MMapSegmentLogStorage()
+{
+    try {
+        closeCurrentSegment();
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to close log segment: %s") % e.what());
+    }
+}
+
+void MMapSegmentLogStorage::loadSegments()
+{
+    if (mkdir(directory_.c_str(), 0755) && errno != EEXIST) {
+        throw KaaException(boost::format("Failed to create log segment directory '%s': %s")
+                                                            % directory_ % getErrorDescription());
+    }
+
+    DIR *dir = opendir(directory_.c_str());
+    if (!dir) {
+        throw KaaException(boost::format("Failed to open log segment directory '%s': %s")
+                                                            % directory_ % getErrorDescription());
+    }
+
+    while (struct dirent *entry = readdir(dir)) {
+        char *extension = nullptr;
+        long bucketId = std::strtol(entry->d_name, &extension, 10);
+
+        if (extension == entry->d_name || std::strcmp(extension, KAA_LOG_SEGMENT_EXTENSION) || bucketId <= 0) {
+            continue;
+        }
+
+        auto segmentPath = getSegmentPath(bucketId);
+        int fd = open(segmentPath.c_str(), O_RDWR);
+        if (fd == -1) {
+            KAA_LOG_WARN(boost::format("Failed to open log segment '%s': %s") % segmentPath % getErrorDescription());
+            continue;
+        }
+
+        SegmentHeader header;
+        struct stat segmentStat;
+        bool isValid = readSegmentHeader(fd, header) && !fstat(fd, &segmentStat) &&
+                       header.magic_ == KAA_LOG_SEGMENT_MAGIC &&
+                       header.version_ == KAA_LOG_SEGMENT_VERSION &&
+                       header.bucketId_ == bucketId &&
+                       header.dataSize_ >= header.recordCount_ * sizeof(RecordSizePrefix) &&
+                       sizeof(header) + header.dataSize_ <= (std::size_t)segmentStat.st_size;
+
+        if (isValid && (header.flags_ & KAA_LOG_SEGMENT_IN_USE_FLAG)) {
+            /*
+             * The bucket has not been delivered before the restart.
+             */
+            header.flags_ &= ~KAA_LOG_SEGMENT_IN_USE_FLAG;
+            isValid = pwrite(fd, &header.flags_, sizeof(header.flags_), offsetof(SegmentHeader, flags_)) == sizeof(header.flags_);
+        }
+
+        close(fd);
+
+        if (!isValid || !header.recordCount_) {
+            if (!isValid) {
+                KAA_LOG_WARN(boost::format("Removing invalid log segment '%s'") % segmentPath);
+            }
+            unlink(segmentPath.c_str());
+            continue;
+        }
+
+        auto& segment = segments_[bucketId];
+        segment.recordCount_ = header.recordCount_;
+        segment.sizeInBytes_ = getPayloadSize(header);
+
+        unmarkedRecordCount_ += segment.recordCount_;
+        unmarkedSizeInBytes_ += segment.sizeInBytes_;
+
+        if (lastBucketId_ < bucketId) {
+            lastBucketId_ = bucketId;
+        }
+    }
+
+    closedir(dir);
+
+    KAA_LOG_INFO(boost::format("Loaded %1% log segment(s): %2% record(s), %3% bytes")
+                                        % segments_.size() % unmarkedRecordCount_ % unmarkedSizeInBytes_);
+}
+
+std::string MMapSegmentLogStorage::getSegmentPath(std::int32_t bucketId) const
+{
+    return directory_ + "/" + std::to_string(bucketId) + KAA_LOG_SEGMENT_EXTENSION;
+}
+
+std::size_t MMapSegmentLogStorage::getSegmentFileSize() const
+{
+    return sizeof(SegmentHeader) + maxBucketSize_ + maxBucketRecordCount_ * sizeof(RecordSizePrefix);
+}
+
+void MMapSegmentLogStorage::mapSegment(std::int32_t bucketId, bool isCreated, MappedSegment& segment)
+{
+    auto segmentPath = getSegmentPath(bucketId);
+
+    int fd = open(segmentPath.c_str(), isCreated ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    if (fd == -1) {
+        throw KaaException(boost::format("Failed to open log segment '%s': %s") % segmentPath % getErrorDescription());
+    }
+
+    std::size_t size = getSegmentFileSize();
+    struct stat segmentStat;
+
+    if (isCreated) {
+        if (ftruncate(fd, size)) {
+            auto error = getErrorDescription();
+            close(fd);
+            unlink(segmentPath.c_str());
+            throw KaaException(boost::format("Failed to allocate log segment '%s': %s") % segmentPath % error);
+        }
+    } else if (!fstat(fd, &segmentStat)) {
+        size = segmentStat.st_size;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        auto error = getErrorDescription();
+        close(fd);
+        throw KaaException(boost::format("Failed to map log segment '%s': %s") % segmentPath % error);
+    }
+
+    segment.bucketId_ = bucketId;
+    segment.fd_ = fd;
+    segment.data_ = static_cast<std::uint8_t *>(data);
+    segment.size_ = size;
+}
+
+void MMapSegmentLogStorage::unmapSegment(MappedSegment& segment)
+{
+    if (segment.fd_ == -1) {
+        return;
+    }
+
+    msync(segment.data_, segment.size_, MS_ASYNC);
+    munmap(segment.data_, segment.size_);
+    close(segment.fd_);
+
+    segment = MappedSegment();
+}
+
+void MMapSegmentLogStorage::openNewSegment()
+{
+    std::int32_t bucketId = lastBucketId_ + 1;
+    mapSegment(bucketId, true, currentSegment_);
+    lastBucketId_ = bucketId;
+
+    SegmentHeader *header = reinterpret_cast<SegmentHeader *>(currentSegment_.data_);
+    header->magic_ = KAA_LOG_SEGMENT_MAGIC;
+    header->version_ = KAA_LOG_SEGMENT_VERSION;
+    header->flags_ = 0;
+    header->bucketId_ = bucketId;
+    header->recordCount_ = 0;
+    header->dataSize_ = 0;
+    header->reserved_ = 0;
+
+    segments_[bucketId] = SegmentInfo();
+
+    KAA_LOG_TRACE(boost::format("Opened log segment %1%") % bucketId);
+}
+
+void MMapSegmentLogStorage::closeCurrentSegment()
+{
+    if (currentSegment_.fd_ == -1) {
+        return;
+    }
+
+    auto bucketId = currentSegment_.bucketId_;
+    unmapSegment(currentSegment_);
+
+    auto it = segments_.find(bucketId);
+    if (it != segments_.end() && !it->second.recordCount_) {
+        unlink(getSegmentPath(bucketId).c_str());
+        segments_.erase(it);
+    }
+}
+
+void MMapSegmentLogStorage::setSegmentInUse(std::int32_t bucketId, bool isInUse)
+{
+    auto segmentPath = getSegmentPath(bucketId);
+
+    int fd = open(segmentPath.c_str(), O_RDWR);
+    if (fd == -1) {
+        throw KaaException(boost::format("Failed to open log segment '%s': %s") % segmentPath % getErrorDescription());
+    }
+
+    std::uint16_t flags = isInUse ? KAA_LOG_SEGMENT_IN_USE_FLAG : 0;
+    bool isWritten = pwrite(fd, &flags, sizeof(flags), offsetof(SegmentHeader, flags_)) == sizeof(flags);
+    close(fd);
+
+    if (!isWritten) {
+        throw KaaException(boost::format("Failed to update log segment '%s': %s") % segmentPath % getErrorDescription());
+    }
+}
+
+BucketInfo MMapSegmentLogStorage::addLogRecord(LogRecord&& record)
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    auto recordSize = record.getSize();
+    if (recordSize > maxBucketSize_) {
+        KAA_LOG_WARN(boost::format("Failed to add log record: record_size %1%B, max_bucket_size %2%B")
+                                                                    % recordSize % maxBucketSize_);
+        throw KaaException("Too big log record");
+    }
+
+    if (currentSegment_.fd_ == -1) {
+        openNewSegment();
+    } else if (checkBucketOverflow(record)) {
+        closeCurrentSegment();
+        openNewSegment();
+    }
+
+    SegmentHeader *header = reinterpret_cast<SegmentHeader *>(currentSegment_.data_);
+    std::uint8_t *recordData = currentSegment_.data_ + sizeof(SegmentHeader) + header->dataSize_;
+
+    RecordSizePrefix prefix = recordSize;
+    std::memcpy(recordData, &prefix, sizeof(prefix));
+    std::memcpy(recordData + sizeof(prefix), record.getData().data(), recordSize);
+
+    /*
+     * The header is updated only after the record is completely written.
+     */
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->dataSize_ += sizeof(prefix) + recordSize;
+    ++header->recordCount_;
+
+    auto& segment = segments_[currentSegment_.bucketId_];
+    segment.sizeInBytes_ += recordSize;
+    ++segment.recordCount_;
+
+    unmarkedSizeInBytes_ += recordSize;
+    ++unmarkedRecordCount_;
+
+    KAA_LOG_TRACE(boost::format("Added log record (%1% bytes) to segment %2%. Non-used records: count %3%, size %4% bytes")
+                                    % recordSize % currentSegment_.bucketId_ % unmarkedRecordCount_ % unmarkedSizeInBytes_);
+
+    return BucketInfo(currentSegment_.bucketId_, segment.recordCount_);
+}
+
+LogBucket MMapSegmentLogStorage::getNextBucket()
+{
+    std::list<LogRecord> records;
+    auto bucketInfo = visitNextBucket([&records] (const std::uint8_t *data, std::size_t size)
+            {
+                records.emplace_back(data, size);
+            });
+
+    if (!bucketInfo.getLogCount()) {
+        return LogBucket();
+    }
+
+    return LogBucket(bucketInfo.getBucketId(), std::move(records));
+}
+
+BucketInfo MMapSegmentLogStorage::visitNextBucket(const LogRecordVisitor& visitor)
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    auto it = segments_.begin();
+    while (it != segments_.end() && (it->second.isInUse_ || !it->second.recordCount_)) {
+        ++it;
+    }
+
+    if (it == segments_.end()) {
+        KAA_LOG_TRACE(boost::format("No free log segments found: total %1%") % segments_.size());
+        return BucketInfo();
+    }
+
+    auto bucketId = it->first;
+    auto& segment = it->second;
+
+    /*
+     * The current segment is taken as is, new records go to the next one.
+     */
+    MappedSegment mappedSegment;
+    if (currentSegment_.fd_ != -1 && currentSegment_.bucketId_ == bucketId) {
+        mappedSegment = currentSegment_;
+        currentSegment_ = MappedSegment();
+    } else {
+        mapSegment(bucketId, false, mappedSegment);
+    }
+
+    try {
+        visitSegmentRecords(mappedSegment.data_, visitor);
+        reinterpret_cast<SegmentHeader *>(mappedSegment.data_)->flags_ |= KAA_LOG_SEGMENT_IN_USE_FLAG;
+    } catch (...) {
+        unmapSegment(mappedSegment);
+        throw;
+    }
+
+    unmapSegment(mappedSegment);
+
+    segment.isInUse_ = true;
+    unmarkedRecordCount_ -= segment.recordCount_;
+    unmarkedSizeInBytes_ -= segment.sizeInBytes_;
+
+    KAA_LOG_INFO(boost::format("Create log bucket: id %1%, size %2%, %3% record(s). "
+                               "Non-used records: count %4%, size %5% bytes")
+                    % bucketId % segment.sizeInBytes_ % segment.recordCount_
+                    % unmarkedRecordCount_ % unmarkedSizeInBytes_);
+
+    return BucketInfo(bucketId, segment.recordCount_);
+}
+
+void MMapSegmentLogStorage::removeBucket(std::int32_t bucketId)
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    auto it = segments_.find(bucketId);
+    if (it == segments_.end()) {
+        KAA_LOG_WARN(boost::format("Failed to remove log bucket %1%: not found") % bucketId);
+        return;
+    }
+
+    if (currentSegment_.fd_ != -1 && currentSegment_.bucketId_ == bucketId) {
+        unmapSegment(currentSegment_);
+    }
+
+    if (!it->second.isInUse_) {
+        unmarkedRecordCount_ -= it->second.recordCount_;
+        unmarkedSizeInBytes_ -= it->second.sizeInBytes_;
+    }
+
+    unlink(getSegmentPath(bucketId).c_str());
+
+    KAA_LOG_TRACE(boost::format("Log bucket %1% removed (%2% records). Non-used records: count %3%, size %4% bytes")
+                        % bucketId % it->second.recordCount_ % unmarkedRecordCount_ % unmarkedSizeInBytes_);
+
+    segments_.erase(it);
+}
+
+void MMapSegmentLogStorage::rollbackBucket(std::int32_t bucketId)
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    auto it = segments_.find(bucketId);
+    if (it == segments_.end() || !it->second.isInUse_) {
+        KAA_LOG_WARN(boost::format("Failed to rollback log bucket %1%: not found") % bucketId);
+        return;
+    }
+
+    setSegmentInUse(bucketId, false);
+
+    it->second.isInUse_ = false;
+    unmarkedRecordCount_ += it->second.recordCount_;
+    unmarkedSizeInBytes_ += it->second.sizeInBytes_;
+
+    KAA_LOG_DEBUG(boost::format("Rollback log bucket %1% (%2% records). Non-used records: count %3%, size %4% bytes")
+                        % bucketId % it->second.recordCount_ % unmarkedRecordCount_ % unmarkedSizeInBytes_);
+}
+
+bool MMapSegmentLogStorage::setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+{
+    if (!bucketSize || !bucketRecordCount) {
+        KAA_LOG_ERROR(boost::format("Failed to change bucket limits: max_size %1% bytes, max_record_count %2%")
+                                                                                % bucketSize % bucketRecordCount);
+        throw KaaException("Bucket limits should be greater than zero");
+    }
+
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    maxBucketSize_ = bucketSize;
+    maxBucketRecordCount_ = bucketRecordCount;
+
+    /*
+     * The current segment is allocated for the previous limits, so it may be too small for new ones.
+     */
+    if (currentSegment_.fd_ != -1 && getSegmentFileSize() > currentSegment_.size_) {
+        closeCurrentSegment();
+    }
+
+    KAA_LOG_INFO(boost::format("Bucket limits changed: max_size %1% bytes, max_record_count %2%")
+                                                        % maxBucketSize_ % maxBucketRecordCount_);
+    return true;
+}
+
+std::size_t MMapSegmentLogStorage::getConsumedVolume()
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    return unmarkedSizeInBytes_;
+}
+
+std::size_t MMapSegmentLogStorage::getRecordsCount()
+{
+    KAA_MUTEX_LOCKING("segmentLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, segmentLogStorageGuard_);
+    KAA_MUTEX_LOCKED("segmentLogStorageGuard_");
+
+    return unmarkedRecordCount_;
+}
+
+} /* namespace kaa */
+
+#endif /* KAA_USE_MMAP_LOG_STORAGE */
@@ -17,16 +17,22 @@
 #include "kaa/log/MemoryLogStorage.hpp"
 
 #include <algorithm>
+#include <cstring>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/log/LogRecord.hpp"
+#include "kaa/log/LogRecordDeltaCodec.hpp"
 #include "kaa/IKaaClientContext.hpp"
 
 namespace kaa {
 
+const MemoryLogStorage::RecordSizePrefix MemoryLogStorage::EVICTED_RECORD_FLAG;
+const MemoryLogStorage::RecordSizePrefix MemoryLogStorage::DELTA_RECORD_FLAG;
+const MemoryLogStorage::RecordSizePrefix MemoryLogStorage::RECORD_SIZE_MASK;
+
 MemoryLogStorage::MemoryLogStorage(IKaaClientContext &context,std::size_t bucketSize, std::size_t bucketRecordCount)
-    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), context_(context)
+    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), recordTimeToLive_(), context_(context)
 {
     KAA_LOG_INFO(boost::format("Going to use  unlimited storage. Bucket: max_size %1% bytes, max_record_count %2%")
                                                                 % maxBucketSize_ % maxBucketRecordCount_);
@@ -36,7 +42,7 @@ MemoryLogStorage::MemoryLogStorage(IKaaClientContext &context,std::size_t bucket
 MemoryLogStorage::MemoryLogStorage(IKaaClientContext &context,
                                    std::size_t maxOccupiedSize, float percentToDelete,
                                    std::size_t bucketSize, std::size_t bucketRecordCount)
-    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), context_(context)
+    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), recordTimeToLive_(), context_(context)
 {
     if (0.0 >= percentToDelete || percentToDelete > 100.0) {
         KAA_LOG_ERROR(boost::format("Failed to create limited log storage: max_size %1% bytes, percentToDelete %2%%%")
@@ -56,6 +62,10 @@ MemoryLogStorage::MemoryLogStorage(IKaaClientContext &context,
 
 BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
 {
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
     auto recordSize = record.getSize();
     if (recordSize > maxBucketSize_) {
         KAA_LOG_WARN(boost::format("Failed to add log record: record_size %1%B, max_bucket_size %2%B")
@@ -63,10 +73,6 @@ BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
         throw KaaException("Too big log record");
     }
 
-    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
-    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
-    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
-
     if (maxOccupiedSize_ && ((totalOccupiedSize_ + record.getSize()) > maxOccupiedSize_)) {
         KAA_LOG_INFO(boost::format("Log storage is full (occupied %1%, max %2%). Going to delete elder logs")
                                                                         % totalOccupiedSize_ % maxOccupiedSize_);
@@ -82,42 +88,67 @@ BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
     KAA_LOG_TRACE(boost::format("Added log record (%1% bytes). Non-used records: count %2%, occupied size %3% bytes")
                                                      % recordSize % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
 
-    return BucketInfo(currentBucketId_, buckets_.back().logs_.size());
+    return BucketInfo(currentBucketId_, buckets_.back().recordCount_);
 }
 
 LogBucket MemoryLogStorage::getNextBucket()
+{
+    std::list<LogRecord> records;
+    auto bucketInfo = visitNextBucket([&records] (const std::uint8_t *data, std::size_t size)
+            {
+                records.emplace_back(data, size);
+            });
+
+    if (!bucketInfo.getLogCount()) {
+        return LogBucket();
+    }
+
+    return LogBucket(bucketInfo.getBucketId(), std::move(records));
+}
+
+BucketInfo MemoryLogStorage::visitNextBucket(const LogRecordVisitor& visitor)
 {
     KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
     KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
 
+    if (!expiringRecords_.empty()) {
+        auto expiredRecordCount = evictExpiredRecords();
+        if (expiredRecordCount) {
+            KAA_LOG_INFO(boost::format("%1% expired log records removed") % expiredRecordCount);
+        }
+    }
+
     std::size_t totalRecordCount = 0;
     for (auto& internalBucket : buckets_) {
-        if (internalBucket.state_ == MemoryLogStorage::BucketState::FREE && !internalBucket.logs_.empty()) {
+        if (internalBucket.state_ == MemoryLogStorage::BucketState::FREE && internalBucket.recordCount_) {
+            internalBucket.visitRecords(visitor);
             internalBucket.state_ = MemoryLogStorage::BucketState::IN_USE;
 
-            unmarkedRecordCount_ -= internalBucket.logs_.size();
+            unmarkedRecordCount_ -= internalBucket.recordCount_;
             occupiedSizeOfUnmarkedRecords_ -= internalBucket.occupiedSize_;
 
-            if (!unmarkedRecordCount_) {
-                addNewBucket();
-            }
-
             KAA_LOG_INFO(boost::format("Create log bucket: id %1%, size %2%, %3% record(s). "
                                        "Non-used records: count %4%, occupied size %5% bytes")
-                            % internalBucket.bucketId_ % internalBucket.occupiedSize_ % internalBucket.logs_.size()
+                            % internalBucket.bucketId_ % internalBucket.occupiedSize_ % internalBucket.recordCount_
                             % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
 
-            return LogBucket(internalBucket.bucketId_, internalBucket.logs_);
+            BucketInfo bucketInfo(internalBucket.bucketId_, internalBucket.recordCount_);
+
+            if (!unmarkedRecordCount_) {
+                addNewBucket();
+            }
+
+            return bucketInfo;
         } else {
-            totalRecordCount += internalBucket.logs_.size();
+            totalRecordCount += internalBucket.recordCount_;
         }
     }
 
     KAA_LOG_TRACE(boost::format("No free log buckets found: total_log_count %1%, total_occupied_size %2%")
                                                                     % totalRecordCount % totalOccupiedSize_);
 
-    return LogBucket();
+    return BucketInfo();
 }
 
 void MemoryLogStorage::removeBucket(std::int32_t bucketId)
@@ -126,24 +157,25 @@ void MemoryLogStorage::removeBucket(std::int32_t bucketId)
     KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
     KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
 
-    bool found = false;
-    buckets_.remove_if([&] (const MemoryLogStorage::InternalBucket& bucket)
-                        {
-                             if (bucket.bucketId_ == bucketId) {
-                                 totalOccupiedSize_ -= bucket.occupiedSize_;
-                                 KAA_LOG_TRACE(boost::format("Log bucket %1% removed (%2% records). "
-                                                             "Non-used records: count %3%, occupied size %4% bytes")
-                                                             % bucketId % bucket.logs_.size() % unmarkedRecordCount_
-                                                             % occupiedSizeOfUnmarkedRecords_);
-                                 found = true;
-                                 return true;
-                             }
-                             return false;
-                        });
-
-    if (!found) {
+    auto it = std::find_if(buckets_.begin(), buckets_.end(), [&bucketId] (const MemoryLogStorage::InternalBucket& bucket)
+            {
+                 return bucket.bucketId_ == bucketId;
+            });
+
+    if (it == buckets_.end()) {
         KAA_LOG_WARN(boost::format("Failed to remove log bucket %1%: not found") % bucketId);
+        return;
     }
+
+    totalOccupiedSize_ -= it->occupiedSize_;
+    totalRecordCount_ -= it->recordCount_;
+
+    KAA_LOG_TRACE(boost::format("Log bucket %1% removed (%2% records). "
+                                "Non-used records: count %3%, occupied size %4% bytes")
+                                % bucketId % it->recordCount_ % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+
+    eraseBucket(it);
+    compactEvictionIndex();
 }
 
 void MemoryLogStorage::rollbackBucket(std::int32_t bucketId)
@@ -160,22 +192,49 @@ void MemoryLogStorage::rollbackBucket(std::int32_t bucketId)
     if (it != buckets_.end()) {
         it->state_ = MemoryLogStorage::BucketState::FREE;
         occupiedSizeOfUnmarkedRecords_ += it->occupiedSize_;
-        unmarkedRecordCount_ += it->logs_.size();
+        unmarkedRecordCount_ += it->recordCount_;
 
         KAA_LOG_DEBUG(boost::format("Rollback log bucket %1% (%2% records). Non-used records: count %3%, occupied size %4% bytes")
-                                            % bucketId % it->logs_.size() % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+                                            % bucketId % it->recordCount_ % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
     } else {
         KAA_LOG_WARN(boost::format("Failed to rollback log bucket %1%: not found") % bucketId);
     }
 
 }
 
+bool MemoryLogStorage::setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+{
+    if (!bucketSize || !bucketRecordCount) {
+        KAA_LOG_ERROR(boost::format("Failed to change bucket limits: max_size %1% bytes, max_record_count %2%")
+                                                                                % bucketSize % bucketRecordCount);
+        throw KaaException("Bucket limits should be greater than zero");
+    }
+
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    maxBucketSize_ = bucketSize;
+    maxBucketRecordCount_ = bucketRecordCount;
+
+    KAA_LOG_INFO(boost::format("Bucket limits changed: max_size %1% bytes, max_record_count %2%")
+                                                        % maxBucketSize_ % maxBucketRecordCount_);
+    return true;
+}
+
 void MemoryLogStorage::shrinkToSize(std::size_t newSize)
 {
     if (!newSize) {
-        unmarkedRecordCount_ = 0;
+        unmarkedRecordCount_ = totalRecordCount_ = 0;
         totalOccupiedSize_ = occupiedSizeOfUnmarkedRecords_ = 0;
         buckets_.clear();
+        bucketsBySequence_.clear();
+
+        for (auto& records : recordsByPriority_) {
+            records.clear();
+        }
+        expiringRecords_.clear();
+
         addNewBucket();
 
         KAA_LOG_INFO("All log records removed");
@@ -183,45 +242,182 @@ void MemoryLogStorage::shrinkToSize(std::size_t newSize)
         return;
     }
 
-    size_t recordCount = 0;
-    while (totalOccupiedSize_ > newSize) {
-        auto& theOldestBucket = buckets_.front();
+    std::size_t recordCount = evictExpiredRecords();
+    while (totalOccupiedSize_ > newSize && evictNextRecord()) {
+        ++recordCount;
+    }
 
-        if (totalOccupiedSize_ - theOldestBucket.occupiedSize_ >= newSize) {
-            KAA_LOG_INFO(boost::format("Removing in-use log bucket %1% (%2% records, %3% bytes)")
-                                    % theOldestBucket.bucketId_ % theOldestBucket.logs_.size() % theOldestBucket.occupiedSize_);
+    KAA_LOG_INFO(boost::format("%1% log records removed") % recordCount);
+}
 
-            totalOccupiedSize_ -= theOldestBucket.occupiedSize_;
-            recordCount += theOldestBucket.logs_.size();
+void MemoryLogStorage::addNewBucket()
+{
+    if (!buckets_.empty() && !buckets_.back().recordCount_
+            && buckets_.back().state_ == MemoryLogStorage::BucketState::FREE) {
+        return;
+    }
 
-            if (theOldestBucket.state_ == MemoryLogStorage::BucketState::FREE) {
-                unmarkedRecordCount_ -= theOldestBucket.logs_.size();
-                occupiedSizeOfUnmarkedRecords_ -= theOldestBucket.occupiedSize_;
-            }
+    if (!buckets_.empty()) {
+        std::vector<std::uint8_t>().swap(buckets_.back().lastRecord_);
+        buckets_.back().hasLastRecord_ = false;
+    }
 
-            buckets_.pop_front();
+    buckets_.emplace_back(++currentBucketId_, nextRecordSequence_);
 
-            if (buckets_.empty()) {
-                addNewBucket();
-            }
-        } else {
-            while (totalOccupiedSize_ > newSize) {
-                const auto& theOldestRecord = theOldestBucket.logs_.front();
+    /*
+     * The previous bucket may start at the same sequence number only if it is empty, so nothing is looked up there.
+     */
+    bucketsBySequence_[nextRecordSequence_] = std::prev(buckets_.end());
+}
 
-                if (theOldestBucket.state_ == MemoryLogStorage::BucketState::FREE) {
-                    --unmarkedRecordCount_;
-                    occupiedSizeOfUnmarkedRecords_ -= theOldestRecord.getSize();
-                }
+void MemoryLogStorage::eraseBucket(BucketIterator bucket)
+{
+    auto it = bucketsBySequence_.find(bucket->firstRecordSequence_);
+    if (it != bucketsBySequence_.end() && it->second == bucket) {
+        bucketsBySequence_.erase(it);
+    }
 
-                totalOccupiedSize_ -= theOldestRecord.getSize();
-                theOldestBucket.logs_.pop_front();
+    buckets_.erase(bucket);
+}
+
+bool MemoryLogStorage::findRecord(const IndexedRecord& record, BucketIterator& bucket)
+{
+    auto it = bucketsBySequence_.upper_bound(record.sequence_);
+    if (it == bucketsBySequence_.begin()) {
+        return false;
+    }
+
+    bucket = (--it)->second;
+    return record.sequence_ < bucket->endRecordSequence_ && !bucket->isRecordEvicted(record.offset_);
+}
+
+std::size_t MemoryLogStorage::evictRecord(BucketIterator bucket, std::size_t offset)
+{
+    auto recordSize = bucket->evictRecord(offset);
+
+    totalOccupiedSize_ -= recordSize;
+    --totalRecordCount_;
+
+    if (bucket->state_ == MemoryLogStorage::BucketState::FREE) {
+        --unmarkedRecordCount_;
+        occupiedSizeOfUnmarkedRecords_ -= recordSize;
+    }
+
+    /*
+     * The last bucket is being filled, so it is kept.
+     */
+    if (!bucket->recordCount_ && bucket != std::prev(buckets_.end())) {
+        KAA_LOG_TRACE(boost::format("Removing empty log bucket %1%") % bucket->bucketId_);
+        eraseBucket(bucket);
+    }
+
+    return recordSize;
+}
+
+bool MemoryLogStorage::evictNextRecord()
+{
+    BucketIterator bucket;
+
+    auto now = Clock::now();
+    while (!expiringRecords_.empty() && expiringRecords_.front().expiryTime_ <= now) {
+        auto record = expiringRecords_.front().record_;
+        std::pop_heap(expiringRecords_.begin(), expiringRecords_.end());
+        expiringRecords_.pop_back();
+
+        if (findRecord(record, bucket)) {
+            evictRecord(bucket, record.offset_);
+            return true;
+        }
+    }
 
-                ++recordCount;
+    for (std::size_t priority = LOG_PRIORITY_COUNT; priority-- > 0;) {
+        auto& records = recordsByPriority_[priority];
+        while (!records.empty()) {
+            auto record = records.front();
+            records.pop_front();
+
+            if (findRecord(record, bucket)) {
+                evictRecord(bucket, record.offset_);
+                return true;
             }
         }
     }
 
-    KAA_LOG_INFO(boost::format("%1% log records removed") % recordCount);
+    return false;
+}
+
+std::size_t MemoryLogStorage::evictExpiredRecords()
+{
+    BucketIterator bucket;
+    std::size_t recordCount = 0;
+
+    auto now = Clock::now();
+    while (!expiringRecords_.empty() && expiringRecords_.front().expiryTime_ <= now) {
+        auto record = expiringRecords_.front().record_;
+        std::pop_heap(expiringRecords_.begin(), expiringRecords_.end());
+        expiringRecords_.pop_back();
+
+        if (findRecord(record, bucket)) {
+            evictRecord(bucket, record.offset_);
+            ++recordCount;
+        }
+    }
+
+    return recordCount;
+}
+
+void MemoryLogStorage::compactEvictionIndex()
+{
+    BucketIterator bucket;
+    auto isRemoved = [this, &bucket] (const IndexedRecord& record) { return !findRecord(record, bucket); };
+
+    /*
+     * Buckets are removed mostly in the order of adding, so entries of removed records are at the front.
+     */
+    std::size_t indexSize = expiringRecords_.size();
+    for (auto& records : recordsByPriority_) {
+        while (!records.empty() && isRemoved(records.front())) {
+            records.pop_front();
+        }
+        indexSize += records.size();
+    }
+
+    const std::size_t minIndexSizeToCompact = 64;
+    if (indexSize < minIndexSizeToCompact || indexSize <= 2 * totalRecordCount_) {
+        return;
+    }
+
+    for (auto& records : recordsByPriority_) {
+        records.erase(std::remove_if(records.begin(), records.end(), isRemoved), records.end());
+    }
+
+    expiringRecords_.erase(std::remove_if(expiringRecords_.begin(), expiringRecords_.end(),
+                                          [&isRemoved] (const ExpiringRecord& record) { return isRemoved(record.record_); }),
+                           expiringRecords_.end());
+    std::make_heap(expiringRecords_.begin(), expiringRecords_.end());
+}
+
+std::size_t MemoryLogStorage::getMemoryUsage()
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+    return totalOccupiedSize_;
+}
+
+bool MemoryLogStorage::releaseMemory(std::size_t allowedVolume)
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    if (totalOccupiedSize_ > allowedVolume) {
+        KAA_LOG_WARN(boost::format("Releasing memory of log storage (occupied %1%, allowed %2%)")
+                                                                    % totalOccupiedSize_ % allowedVolume);
+        shrinkToSize(allowedVolume);
+    }
+
+    return true;
 }
 
 std::size_t MemoryLogStorage::getConsumedVolume()
@@ -240,17 +436,156 @@ std::size_t MemoryLogStorage::getRecordsCount()
     return unmarkedRecordCount_;
 }
 
+void MemoryLogStorage::setRecordTimeToLive(LogPriority priority, std::chrono::milliseconds ttl)
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    recordTimeToLive_[static_cast<std::size_t>(priority)] = ttl;
+
+    KAA_LOG_INFO(boost::format("Time to live of log records changed: priority %1%, ttl %2% ms")
+                                                    % static_cast<int>(priority) % ttl.count());
+}
+
+void MemoryLogStorage::setDeltaEncoding(bool isEnabled)
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    isDeltaEncodingEnabled_ = isEnabled;
+    if (!isEnabled) {
+        std::vector<std::uint8_t>().swap(deltaBuffer_);
+    }
+
+    KAA_LOG_INFO(boost::format("Delta encoding of log records %1%") % (isEnabled ? "enabled" : "disabled"));
+}
+
 void MemoryLogStorage::internalAddLogRecord(LogRecord&& record)
 {
-    auto recordSize = record.getSize();
+    auto priority = static_cast<std::size_t>(record.getPriority());
 
+    auto& bucket = buckets_.back();
+    auto occupiedSize = bucket.occupiedSize_;
+    IndexedRecord indexedRecord(nextRecordSequence_++, bucket.addRecord(record, isDeltaEncodingEnabled_, deltaBuffer_));
+    bucket.endRecordSequence_ = nextRecordSequence_;
+
+    auto recordSize = bucket.occupiedSize_ - occupiedSize;
     totalOccupiedSize_ += recordSize;
     occupiedSizeOfUnmarkedRecords_ += recordSize;
     ++unmarkedRecordCount_;
+    ++totalRecordCount_;
+
+    recordsByPriority_[priority].push_back(indexedRecord);
+
+    if (recordTimeToLive_[priority] != Clock::duration::zero()) {
+        expiringRecords_.emplace_back(Clock::now() + recordTimeToLive_[priority], indexedRecord);
+        std::push_heap(expiringRecords_.begin(), expiringRecords_.end());
+    }
+}
+
+std::size_t MemoryLogStorage::InternalBucket::addRecord(LogRecord& record, bool deltaEncoding,
+                                                       std::vector<std::uint8_t>& delta)
+{
+    const auto& data = record.getData();
+
+    const std::uint8_t *storedData = data.data();
+    RecordSizePrefix recordSize = data.size();
+    RecordSizePrefix sizePrefix = recordSize;
+
+    if (deltaEncoding && hasLastRecord_
+            && LogRecordDeltaCodec::encode(lastRecord_.data(), lastRecord_.size(), data.data(), data.size(), delta)) {
+        storedData = delta.data();
+        recordSize = delta.size();
+        sizePrefix = recordSize | DELTA_RECORD_FLAG;
+        hasDeltaRecords_ = true;
+    }
+
+    auto offset = records_.size();
+    records_.resize(offset + sizeof(sizePrefix) + recordSize);
+
+    std::memcpy(records_.data() + offset, &sizePrefix, sizeof(sizePrefix));
+    std::memcpy(records_.data() + offset + sizeof(sizePrefix), storedData, recordSize);
+
+    occupiedSize_ += recordSize;
+    payloadSize_ += data.size();
+    ++recordCount_;
+
+    /*
+     * Evicted records are still references, so the last record is kept even if it is evicted later.
+     */
+    if (deltaEncoding) {
+        lastRecord_.assign(data.begin(), data.end());
+    } else if (hasLastRecord_) {
+        std::vector<std::uint8_t>().swap(lastRecord_);
+    }
+    hasLastRecord_ = deltaEncoding;
+
+    return offset;
+}
+
+bool MemoryLogStorage::InternalBucket::isRecordEvicted(std::size_t offset) const
+{
+    RecordSizePrefix sizePrefix = 0;
+    std::memcpy(&sizePrefix, records_.data() + offset, sizeof(sizePrefix));
+    return sizePrefix & EVICTED_RECORD_FLAG;
+}
+
+std::size_t MemoryLogStorage::InternalBucket::evictRecord(std::size_t offset)
+{
+    RecordSizePrefix sizePrefix = 0;
+    std::memcpy(&sizePrefix, records_.data() + offset, sizeof(sizePrefix));
+
+    RecordSizePrefix recordSize = sizePrefix & RECORD_SIZE_MASK;
+    const std::uint8_t *data = records_.data() + offset + sizeof(sizePrefix);
+
+    payloadSize_ -= (sizePrefix & DELTA_RECORD_FLAG) ? LogRecordDeltaCodec::getDecodedSize(data, recordSize) : recordSize;
+
+    sizePrefix |= EVICTED_RECORD_FLAG;
+    std::memcpy(records_.data() + offset, &sizePrefix, sizeof(sizePrefix));
 
-    auto& currentBucket  = buckets_.back();
-    currentBucket.occupiedSize_ += recordSize;
-    currentBucket.logs_.push_back(std::move(record));
+    occupiedSize_ -= recordSize;
+    --recordCount_;
+
+    return recordSize;
+}
+
+void MemoryLogStorage::InternalBucket::visitRecords(const LogRecordVisitor& visitor) const
+{
+    /*
+     * Records of a delta-encoded bucket are restored one by one, each is the reference of the next one.
+     */
+    std::vector<std::uint8_t> previousRecord;
+    std::vector<std::uint8_t> currentRecord;
+
+    std::size_t offset = 0;
+    while (offset < records_.size()) {
+        RecordSizePrefix sizePrefix = 0;
+        std::memcpy(&sizePrefix, records_.data() + offset, sizeof(sizePrefix));
+        offset += sizeof(sizePrefix);
+
+        RecordSizePrefix recordSize = sizePrefix & RECORD_SIZE_MASK;
+        const std::uint8_t *data = records_.data() + offset;
+        std::size_t dataSize = recordSize;
+        offset += recordSize;
+
+        if (hasDeltaRecords_) {
+            if (sizePrefix & DELTA_RECORD_FLAG) {
+                LogRecordDeltaCodec::decode(previousRecord.data(), previousRecord.size(), data, dataSize, currentRecord);
+            } else {
+                currentRecord.assign(data, data + dataSize);
+            }
+
+            previousRecord.swap(currentRecord);
+            data = previousRecord.data();
+            dataSize = previousRecord.size();
+        }
+
+        if (!(sizePrefix & EVICTED_RECORD_FLAG)) {
+            visitor(data, dataSize);
+        }
+    }
 }
 
 }  // namespace kaa
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/log/PriorityLogStorage.hpp"
+
+#include <memory>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+namespace kaa {
+
+const std::size_t PriorityLogStorage::DEFAULT_HIGH_PRIORITY_WEIGHT;
+const std::size_t PriorityLogStorage::DEFAULT_NORMAL_PRIORITY_WEIGHT;
+const std::size_t PriorityLogStorage::DEFAULT_LOW_PRIORITY_WEIGHT;
+
+PriorityLogStorage::PriorityLogStorage(IKaaClientContext &context, std::size_t bucketSize, std::size_t bucketRecordCount)
+    : weights_({{ DEFAULT_HIGH_PRIORITY_WEIGHT, DEFAULT_NORMAL_PRIORITY_WEIGHT, DEFAULT_LOW_PRIORITY_WEIGHT }}),
+      currentWeights_(), context_(context)
+{
+    for (auto& lane : lanes_) {
+        lane = std::make_shared<MemoryLogStorage>(context_, bucketSize, bucketRecordCount);
+    }
+}
+
+PriorityLogStorage::PriorityLogStorage(IKaaClientContext &context, const LaneStorages& lanes)
+    : lanes_(lanes),
+      weights_({{ DEFAULT_HIGH_PRIORITY_WEIGHT, DEFAULT_NORMAL_PRIORITY_WEIGHT, DEFAULT_LOW_PRIORITY_WEIGHT }}),
+      currentWeights_(), context_(context)
+{
+    for (std::size_t lane = 0; lane < LOG_PRIORITY_COUNT; ++lane) {
+        if (!lanes_[lane]) {
+            KAA_LOG_ERROR(boost::format("Failed to create priority log storage: lane %1% is null") % lane);
+            throw KaaException("Lane storage is null");
+        }
+
+        for (std::size_t otherLane = 0; otherLane < lane; ++otherLane) {
+            if (lanes_[lane] == lanes_[otherLane]) {
+                KAA_LOG_ERROR(boost::format("Failed to create priority log storage: lanes %1% and %2% are the same")
+                                                                                            % otherLane % lane);
+                throw KaaException("Lane storages should be distinct");
+            }
+        }
+    }
+}
+
+BucketInfo PriorityLogStorage::addLogRecord(LogRecord&& record)
+{
+    auto lane = static_cast<std::size_t>(record.getPriority());
+    if (lane >= LOG_PRIORITY_COUNT) {
+        KAA_LOG_WARN(boost::format("Failed to add log record: unknown priority %1%") % lane);
+        throw KaaException("Unknown log record priority");
+    }
+
+    auto laneBucketInfo = lanes_[lane]->addLogRecord(std::move(record));
+    return BucketInfo(toBucketId(lane, laneBucketInfo.getBucketId()), laneBucketInfo.getLogCount());
+}
+
+template<class Getter>
+BucketInfo PriorityLogStorage::getNextLaneBucket(const Getter& getter)
+{
+    KAA_MUTEX_LOCKING("laneSelectionGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(laneSelectionLock, laneSelectionGuard_);
+    KAA_MUTEX_LOCKED("laneSelectionGuard_");
+
+    std::array<bool, LOG_PRIORITY_COUNT> hasRecords;
+    for (std::size_t lane = 0; lane < LOG_PRIORITY_COUNT; ++lane) {
+        hasRecords[lane] = lanes_[lane]->getStatus().getRecordsCount() > 0;
+    }
+
+    while (true) {
+        std::size_t selectedLane = LOG_PRIORITY_COUNT;
+        std::int64_t totalWeight = 0;
+
+        for (std::size_t lane = 0; lane < LOG_PRIORITY_COUNT; ++lane) {
+            if (!hasRecords[lane]) {
+                continue;
+            }
+
+            currentWeights_[lane] += weights_[lane];
+            totalWeight += weights_[lane];
+
+            if (selectedLane == LOG_PRIORITY_COUNT || currentWeights_[lane] > currentWeights_[selectedLane]) {
+                selectedLane = lane;
+            }
+        }
+
+        if (selectedLane == LOG_PRIORITY_COUNT) {
+            return BucketInfo();
+        }
+
+        currentWeights_[selectedLane] -= totalWeight;
+
+        auto laneBucketInfo = getter(*lanes_[selectedLane]);
+        if (laneBucketInfo.getLogCount()) {
+            KAA_LOG_TRACE(boost::format("Selected bucket from lane %1%") % selectedLane);
+            return BucketInfo(toBucketId(selectedLane, laneBucketInfo.getBucketId()), laneBucketInfo.getLogCount());
+        }
+
+        /*
+         * All records of the lane are already in use.
+         */
+        hasRecords[selectedLane] = false;
+    }
+}
+
+LogBucket PriorityLogStorage::getNextBucket()
+{
+    LogBucket laneBucket;
+    auto bucketInfo = getNextLaneBucket([&laneBucket] (ILogStorage& lane)
+            {
+                laneBucket = lane.getNextBucket();
+                return BucketInfo(laneBucket.getBucketId(), laneBucket.getRecords().size());
+            });
+
+    if (!bucketInfo.getLogCount()) {
+        return LogBucket();
+    }
+
+    return LogBucket(bucketInfo.getBucketId(), std::move(laneBucket.getRecords()));
+}
+
+BucketInfo PriorityLogStorage::visitNextBucket(const LogRecordVisitor& visitor)
+{
+    return getNextLaneBucket([&visitor] (ILogStorage& lane)
+            {
+                return lane.visitNextBucket(visitor);
+            });
+}
+
+void PriorityLogStorage::removeBucket(std::int32_t bucketId)
+{
+    lanes_[toLane(bucketId)]->removeBucket(toLaneBucketId(bucketId));
+}
+
+void PriorityLogStorage::rollbackBucket(std::int32_t bucketId)
+{
+    lanes_[toLane(bucketId)]->rollbackBucket(toLaneBucketId(bucketId));
+}
+
+bool PriorityLogStorage::setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+{
+    bool isChanged = true;
+    for (auto& lane : lanes_) {
+        isChanged = lane->setBucketLimits(bucketSize, bucketRecordCount) && isChanged;
+    }
+
+    return isChanged;
+}
+
+std::size_t PriorityLogStorage::getConsumedVolume()
+{
+    std::size_t volume = 0;
+    for (auto& lane : lanes_) {
+        volume += lane->getStatus().getConsumedVolume();
+    }
+
+    return volume;
+}
+
+std::size_t PriorityLogStorage::getRecordsCount()
+{
+    std::size_t count = 0;
+    for (auto& lane : lanes_) {
+        count += lane->getStatus().getRecordsCount();
+    }
+
+    return count;
+}
+
+void PriorityLogStorage::setLaneWeight(LogPriority priority, std::size_t weight)
+{
+    auto lane = static_cast<std::size_t>(priority);
+    if (!weight || lane >= LOG_PRIORITY_COUNT) {
+        KAA_LOG_ERROR(boost::format("Failed to set lane weight: lane %1%, weight %2%") % lane % weight);
+        throw KaaException("Bad lane weight");
+    }
+
+    KAA_MUTEX_LOCKING("laneSelectionGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(laneSelectionLock, laneSelectionGuard_);
+    KAA_MUTEX_LOCKED("laneSelectionGuard_");
+
+    weights_[lane] = weight;
+}
+
+} /* namespace kaa */
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/log/RecordBatch.hpp"
+
+namespace kaa {
+namespace detail {
+
+bool RecordBatchState::addRecord()
+{
+    if (isClosed_) {
+        return false;
+    }
+
+    ++pendingCount_;
+
+    /*
+     * The batch closed meanwhile may be already completed, so the record is rejected.
+     */
+    if (isClosed_) {
+        onRecordsDelivered(1);
+        return false;
+    }
+
+    ++recordCount_;
+    return true;
+}
+
+void RecordBatchState::onRecordsDelivered(std::size_t recordCount)
+{
+    if (pendingCount_.fetch_sub(recordCount) == recordCount) {
+        complete();
+    }
+}
+
+void RecordBatchState::onRecordFailed(std::exception_ptr exception)
+{
+    complete(exception);
+    onRecordsDelivered(1);
+}
+
+KaaFuture<void> RecordBatchState::close()
+{
+    if (!isClosed_.exchange(true)) {
+        onRecordsDelivered(1);
+    }
+
+    return promise_.getFuture();
+}
+
+std::size_t RecordBatchState::getPendingRecordCount() const
+{
+    std::size_t pendingCount = pendingCount_;
+    return (isClosed_ || !pendingCount) ? pendingCount : pendingCount - 1;
+}
+
+void RecordBatchState::complete(std::exception_ptr exception)
+{
+    if (isCompleted_.exchange(true)) {
+        return;
+    }
+
+    if (exception) {
+        promise_.setException(exception);
+    } else {
+        promise_.setValue();
+    }
+}
+
+} /* namespace detail */
+} /* namespace kaa */
@@ -18,6 +18,8 @@
 
 #include <kaa/log/SQLiteDBLogStorage.hpp>
 
+#include <algorithm>
+
 #include <kaa/logging/Log.hpp>
 #include <kaa/log/LogRecord.hpp>
 #include <kaa/common/exception/KaaException.hpp>
@@ -38,7 +40,8 @@
 #define KAA_BUCKETS_SIZE_IN_BYTES_FIELD_NAME      "SIZE_IN_BYTES"
 #define KAA_BUCKETS_STATE_FIELD_NAME              "STATE" /* 0 - free, 1 - in use*/
 
-#define KAA_BUCKET_ID_INDEX_NAME "KAA_BUCKET_ID_INDEX"
+#define KAA_BUCKET_ID_INDEX_NAME         "KAA_BUCKET_ID_INDEX"
+#define KAA_LOGS_BUCKET_ID_INDEX_NAME    "KAA_LOGS_BUCKET_ID_INDEX"
 
 #define KAA_CREATE_LOGS_TABLE \
          "CREATE TABLE IF NOT EXISTS " KAA_LOGS_TABLE_NAME " ("  \
@@ -64,6 +67,15 @@
     "CREATE INDEX IF NOT EXISTS " KAA_BUCKET_ID_INDEX_NAME " " \
     "ON " KAA_BUCKETS_TABLE_NAME " (" KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME ");"
 
+/*
+ * Entries of the same bucket id are ordered by the implicit rowid, i.e. the record id, so this index
+ * serves both the filter and the order of KAA_SELECT_BUCKET_LOG_RECORDS without a sort. The data isn't
+ * included to make the index covering, as it would store every record twice.
+ */
+#define KAA_CREATE_LOGS_BUCKET_ID_INDEX \
+    "CREATE INDEX IF NOT EXISTS " KAA_LOGS_BUCKET_ID_INDEX_NAME " " \
+    "ON " KAA_LOGS_TABLE_NAME " (" KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME ");"
+
 #define KAA_INSERT_NEW_BUCKET \
     "INSERT INTO " KAA_BUCKETS_TABLE_NAME " " \
     " (" KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME ")" \
@@ -107,6 +119,12 @@
     "ORDER BY " KAA_BUCKETS_INNER_BUCKET_ID_FIELD_NAME " ASC " \
     "LIMIT 1;"
 
+#define KAA_GET_THE_OLDEST_FREE_BUCKET_BEFORE \
+    "SELECT * FROM " KAA_BUCKETS_TABLE_NAME " " \
+    "WHERE " KAA_BUCKETS_STATE_FIELD_NAME " = 0 AND " KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME " < ? " \
+    "ORDER BY " KAA_BUCKETS_INNER_BUCKET_ID_FIELD_NAME " ASC " \
+    "LIMIT 1;"
+
 #define KAA_GET_THE_LATEST_BUCKET \
     "SELECT * FROM " KAA_BUCKETS_TABLE_NAME " " \
     "WHERE " KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME " = " \
@@ -125,7 +143,7 @@
 
 #define KAA_UPDATE_BUCKET_INFO \
     "UPDATE " KAA_BUCKETS_TABLE_NAME " " \
-    "SET " KAA_BUCKETS_SIZE_IN_RECORDS_FIELD_NAME " = " KAA_BUCKETS_SIZE_IN_RECORDS_FIELD_NAME "+ 1, " \
+    "SET " KAA_BUCKETS_SIZE_IN_RECORDS_FIELD_NAME " = " KAA_BUCKETS_SIZE_IN_RECORDS_FIELD_NAME "+ ?, " \
      KAA_BUCKETS_SIZE_IN_BYTES_FIELD_NAME " = " KAA_BUCKETS_SIZE_IN_BYTES_FIELD_NAME "+ ? " \
     "WHERE " KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME " = ?;"
 
@@ -136,6 +154,58 @@
 #define KAA_COUNT_CHANGES_OPTION          "PRAGMA count_changes=OFF"
 #define KAA_MEMORY_JOURNAL_MODE_OPTION    "PRAGMA journal_mode=MEMORY"
 #define KAA_MEMORY_TEMP_STORE_OPTION      "PRAGMA temp_store=MEMORY"
+#define KAA_WAL_JOURNAL_MODE_OPTION       "PRAGMA journal_mode=WAL"
+#define KAA_SYNCHRONOUS_NORMAL_OPTION     "PRAGMA synchronous=NORMAL"
+#define KAA_SYNCHRONOUS_FULL_OPTION       "PRAGMA synchronous=FULL"
+
+#define KAA_STR_(x) #x
+#define KAA_STR(x)  KAA_STR_(x)
+
+/*
+ * Number of WAL pages after which the WAL journal is checkpointed.
+ */
+#ifndef KAA_SQLITE_WAL_AUTOCHECKPOINT
+#define KAA_SQLITE_WAL_AUTOCHECKPOINT     1000
+#endif
+
+/*
+ * Max size in bytes of the database which is accessed through memory-mapped I/O.
+ */
+#ifndef KAA_SQLITE_MMAP_SIZE
+#define KAA_SQLITE_MMAP_SIZE              4194304
+#endif
+
+#define KAA_WAL_AUTOCHECKPOINT_OPTION     "PRAGMA wal_autocheckpoint=" KAA_STR(KAA_SQLITE_WAL_AUTOCHECKPOINT)
+#define KAA_MEMORY_MAPPED_IO_OPTION       "PRAGMA mmap_size=" KAA_STR(KAA_SQLITE_MMAP_SIZE)
+
+/*
+ * SPACE RECLAMATION.
+ */
+
+/*
+ * Max number of free pages returned to the file system by a single vacuum step.
+ */
+#ifndef KAA_SQLITE_INCREMENTAL_VACUUM_PAGES
+#define KAA_SQLITE_INCREMENTAL_VACUUM_PAGES    256
+#endif
+
+#define KAA_AUTO_VACUUM_INCREMENTAL     2
+
+#define KAA_GET_AUTO_VACUUM             "PRAGMA auto_vacuum;"
+#define KAA_INCREMENTAL_AUTO_VACUUM     "PRAGMA auto_vacuum=INCREMENTAL"
+#define KAA_VACUUM                      "VACUUM"
+#define KAA_GET_PAGE_COUNT              "PRAGMA page_count;"
+#define KAA_GET_PAGE_SIZE               "PRAGMA page_size;"
+#define KAA_GET_FREELIST_COUNT          "PRAGMA freelist_count;"
+#define KAA_INCREMENTAL_VACUUM_STEP     "PRAGMA incremental_vacuum(" KAA_STR(KAA_SQLITE_INCREMENTAL_VACUUM_PAGES) ");"
+#define KAA_INCREMENTAL_VACUUM_ALL      "PRAGMA incremental_vacuum;"
+
+/*
+ * TRANSACTIONS.
+ */
+#define KAA_BEGIN_TRANSACTION       "BEGIN TRANSACTION;"
+#define KAA_COMMIT_TRANSACTION      "COMMIT TRANSACTION;"
+#define KAA_ROLLBACK_TRANSACTION    "ROLLBACK TRANSACTION;"
 
 namespace kaa {
 
@@ -171,9 +241,29 @@ private:
     sqlite3_stmt *stmt_ = nullptr;
 };
 
-SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context, std::size_t bucketSize, std::size_t bucketRecordCount)
+/*
+ * Makes a cached statement ready for the next use.
+ */
+class SQLiteStatementResetter {
+public:
+    SQLiteStatementResetter(sqlite3_stmt *stmt) : stmt_(stmt) {}
+
+    ~SQLiteStatementResetter()
+    {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+
+private:
+    sqlite3_stmt *stmt_;
+};
+
+SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context, std::size_t bucketSize, std::size_t bucketRecordCount,
+                                       std::size_t groupCommitRecordCount, std::size_t groupCommitTimeoutMs)
     : dbName_(context.getProperties().getLogsDatabaseFileName()),
       maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount),
+      groupCommitRecordCount_(groupCommitRecordCount ? groupCommitRecordCount : 1),
+      groupCommitTimeout_(groupCommitTimeoutMs),
       context_(context)
 {
     init(SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS);
@@ -181,20 +271,31 @@ SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context, std::size_t b
 
 SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context,
                                        const std::string& dbName, int optimizationMask,
-                                       std::size_t bucketSize, std::size_t bucketRecordCount)
-    : dbName_(dbName), maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), context_(context)
+                                       std::size_t bucketSize, std::size_t bucketRecordCount,
+                                       std::size_t groupCommitRecordCount, std::size_t groupCommitTimeoutMs)
+    : dbName_(dbName), maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount),
+      groupCommitRecordCount_(groupCommitRecordCount ? groupCommitRecordCount : 1),
+      groupCommitTimeout_(groupCommitTimeoutMs),
+      context_(context)
 {
     init(optimizationMask);
 }
 
 SQLiteDBLogStorage::~SQLiteDBLogStorage()
 {
+    try {
+        commitStagedRecords();
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("%d staged log records are lost: %s") % stagedRecords_.size() % e.what());
+    }
+
     closeDBConnection();
 }
 
 void SQLiteDBLogStorage::init(int optimizationMask)
 {
     openDBConnection();
+    initAutoVacuum();
     applyDBOptimization(optimizationMask);
 
     initDBTables();
@@ -211,7 +312,14 @@ void SQLiteDBLogStorage::init(int optimizationMask)
         addNextBucket();
     }
 
+    stagedRecords_.reserve(groupCommitRecordCount_);
+
     KAA_LOG_INFO(boost::format("%d log records in database (total size %d B)") % totalRecordCount_ % consumedMemory_);
+
+    if (groupCommitRecordCount_ > 1 || groupCommitTimeout_.count() > 0) {
+        KAA_LOG_INFO(boost::format("Group commit is used: max_records %d, timeout %d ms")
+                                    % groupCommitRecordCount_ % groupCommitTimeout_.count());
+    }
 }
 
 bool SQLiteDBLogStorage::retrieveLastBucketInfo()
@@ -300,13 +408,81 @@ void SQLiteDBLogStorage::initDBTables()
 
         KAA_LOG_TRACE("'" KAA_LOGS_TABLE_NAME "' table created");
 
-        //TODO: to increase performance need to create indexes on DB tables.
+        SQLiteStatement createBucketIdIndexStmt(db_, KAA_CREATE_BUCKET_ID_INDEX);
+        errorCode = sqlite3_step(createBucketIdIndexStmt.getStatement());
+        throwIfError(errorCode, SQLITE_DONE,
+                (boost::format("Failed to create '" KAA_BUCKET_ID_INDEX_NAME "' index (error %d)") % errorCode).str());
+
+        SQLiteStatement createLogsBucketIdIndexStmt(db_, KAA_CREATE_LOGS_BUCKET_ID_INDEX);
+        errorCode = sqlite3_step(createLogsBucketIdIndexStmt.getStatement());
+        throwIfError(errorCode, SQLITE_DONE,
+                (boost::format("Failed to create '" KAA_LOGS_BUCKET_ID_INDEX_NAME "' index (error %d)") % errorCode).str());
+
+        KAA_LOG_TRACE("Log table indexes created");
     } catch (std::exception& e) {
         KAA_LOG_FATAL(boost::format("Failed to init log table: %s") % e.what());
         throw;
     }
 }
 
+void SQLiteDBLogStorage::initAutoVacuum()
+{
+    /*
+     * Pages freed by removed buckets are kept in the file until a vacuum step returns them.
+     * The mode of an existing database is changed only by rebuilding it, which is done once.
+     */
+    try {
+        if (getPragmaValue(KAA_GET_AUTO_VACUUM) == KAA_AUTO_VACUUM_INCREMENTAL) {
+            return;
+        }
+
+        applyDBOption(KAA_INCREMENTAL_AUTO_VACUUM);
+
+        if (getPragmaValue(KAA_GET_PAGE_COUNT) > 0) {
+            KAA_LOG_INFO(boost::format("Rebuilding '%s' log database to reclaim free pages incrementally") % dbName_);
+            applyDBOption(KAA_VACUUM);
+        }
+    } catch (std::exception& e) {
+        KAA_LOG_WARN(boost::format("Failed to enable incremental auto vacuum: %s") % e.what());
+    }
+}
+
+std::int64_t SQLiteDBLogStorage::getPragmaValue(const char *pragma)
+{
+    SQLiteStatement stmt(db_, pragma);
+    int errorCode = sqlite3_step(stmt.getStatement());
+    throwIfError(errorCode, SQLITE_ROW, (boost::format("Failed to execute '%s' (error %d)") % pragma % errorCode).str());
+
+    return sqlite3_column_int64(stmt.getStatement(), 0);
+}
+
+std::size_t SQLiteDBLogStorage::getUsedDiskSpace()
+{
+    return (getPragmaValue(KAA_GET_PAGE_COUNT) - getPragmaValue(KAA_GET_FREELIST_COUNT)) * getPragmaValue(KAA_GET_PAGE_SIZE);
+}
+
+void SQLiteDBLogStorage::vacuum(const char *vacuumQuery)
+{
+    /*
+     * This function should be called under the storage lock.
+     */
+
+    try {
+        auto freePageCount = getPragmaValue(KAA_GET_FREELIST_COUNT);
+        if (!freePageCount) {
+            return;
+        }
+
+        int errorCode = sqlite3_exec(db_, vacuumQuery, nullptr, nullptr, nullptr);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("(error %d)") % errorCode).str());
+
+        KAA_LOG_TRACE(boost::format("Vacuumed log database: %d of %d free pages left")
+                                        % getPragmaValue(KAA_GET_FREELIST_COUNT) % freePageCount);
+    } catch (std::exception& e) {
+        KAA_LOG_WARN(boost::format("Failed to vacuum log database: %s") % e.what());
+    }
+}
+
 void SQLiteDBLogStorage::applyDBOptimization(int mask)
 {
     if (mask == SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS) {
@@ -314,21 +490,39 @@ void SQLiteDBLogStorage::applyDBOptimization(int mask)
         return;
     }
 
-    if (mask & SQLiteOptimizationOptions::SQLITE_SYNCHRONOUS_OFF) {
-        sqlite3_exec(db_, KAA_SYNCHRONIZATION_OPTION, nullptr, nullptr, nullptr);
-        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_SYNCHRONIZATION_OPTION);
+    if (mask & SQLiteOptimizationOptions::SQLITE_SYNCHRONOUS_FULL) {
+        applyDBOption(KAA_SYNCHRONOUS_FULL_OPTION);
+    } else if (mask & SQLiteOptimizationOptions::SQLITE_SYNCHRONOUS_NORMAL) {
+        applyDBOption(KAA_SYNCHRONOUS_NORMAL_OPTION);
+    } else if (mask & SQLiteOptimizationOptions::SQLITE_SYNCHRONOUS_OFF) {
+        applyDBOption(KAA_SYNCHRONIZATION_OPTION);
     }
-    if (mask & SQLiteOptimizationOptions::SQLITE_MEMORY_JOURNAL_MODE) {
-        sqlite3_exec(db_, KAA_MEMORY_JOURNAL_MODE_OPTION, nullptr, nullptr, nullptr);
-        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_MEMORY_JOURNAL_MODE_OPTION);
+
+    if (mask & SQLiteOptimizationOptions::SQLITE_WAL_JOURNAL_MODE) {
+        applyDBOption(KAA_WAL_JOURNAL_MODE_OPTION);
+        applyDBOption(KAA_WAL_AUTOCHECKPOINT_OPTION);
+    } else if (mask & SQLiteOptimizationOptions::SQLITE_MEMORY_JOURNAL_MODE) {
+        applyDBOption(KAA_MEMORY_JOURNAL_MODE_OPTION);
     }
+
     if (mask & SQLiteOptimizationOptions::SQLITE_MEMORY_TEMP_STORE) {
-        sqlite3_exec(db_, KAA_MEMORY_TEMP_STORE_OPTION, nullptr, nullptr, nullptr);
-        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_MEMORY_TEMP_STORE_OPTION);
+        applyDBOption(KAA_MEMORY_TEMP_STORE_OPTION);
     }
     if (mask & SQLiteOptimizationOptions::SQLITE_COUNT_CHANGES_OFF) {
-        sqlite3_exec(db_, KAA_COUNT_CHANGES_OPTION, nullptr, nullptr, nullptr);
-        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_COUNT_CHANGES_OPTION);
+        applyDBOption(KAA_COUNT_CHANGES_OPTION);
+    }
+    if (mask & SQLiteOptimizationOptions::SQLITE_MEMORY_MAPPED_IO) {
+        applyDBOption(KAA_MEMORY_MAPPED_IO_OPTION);
+    }
+}
+
+void SQLiteDBLogStorage::applyDBOption(const char *option)
+{
+    int errorCode = sqlite3_exec(db_, option, nullptr, nullptr, nullptr);
+    if (errorCode == SQLITE_OK) {
+        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % option);
+    } else {
+        KAA_LOG_WARN(boost::format("Failed to apply '%s' optimization (error %d)") % option % errorCode);
     }
 }
 
@@ -346,6 +540,24 @@ void SQLiteDBLogStorage::markBucketsAsFree()
     }
 }
 
+void SQLiteDBLogStorage::markBucketAsFree(std::int32_t id)
+{
+    try {
+        SQLiteStatement stmt(db_, KAA_MARK_BUCKET_AS_FREE);
+
+        int errorCode = sqlite3_bind_int64(stmt.getStatement(), 1, id);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+        errorCode = sqlite3_step(stmt.getStatement());
+        throwIfError(errorCode, SQLITE_DONE, (boost::format("(error %d)") % errorCode).str());
+
+        KAA_LOG_TRACE(boost::format("Mark log bucket %d as free") % id);
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to mark log bucket %d as free: %s") % id % e.what());
+        throw KaaException(boost::format("Failed to mark log bucket as free: %s") % e.what());
+    }
+}
+
 void SQLiteDBLogStorage::markBucketAsInUse(std::int32_t id)
 {
     try {
@@ -377,13 +589,145 @@ void SQLiteDBLogStorage::openDBConnection()
 void SQLiteDBLogStorage::closeDBConnection()
 {
     if (db_) {
+        finalizeCachedStatements();
         sqlite3_close(db_);
         db_ = nullptr;
     }
 }
 
+sqlite3_stmt *SQLiteDBLogStorage::getCachedStatement(sqlite3_stmt *&stmt, const char *sql)
+{
+    if (!stmt) {
+        int errorCode = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+        if (errorCode != SQLITE_OK) {
+            stmt = nullptr;
+            throw KaaException(boost::format("Failed to create sql statement '%s' (error %d)") % sql % errorCode);
+        }
+    }
+
+    return stmt;
+}
+
+void SQLiteDBLogStorage::finalizeCachedStatements()
+{
+    sqlite3_finalize(insertLogRecordStmt_);
+    insertLogRecordStmt_ = nullptr;
+
+    sqlite3_finalize(updateBucketInfoStmt_);
+    updateBucketInfoStmt_ = nullptr;
+}
+
+bool SQLiteDBLogStorage::isGroupCommitNeeded() const
+{
+    if (stagedRecords_.empty()) {
+        return false;
+    }
+
+    return (stagedRecords_.size() >= groupCommitRecordCount_) ||
+           (groupCommitTimeout_.count() > 0 &&
+                   std::chrono::steady_clock::now() - oldestStagedRecordTime_ >= groupCommitTimeout_);
+}
+
+void SQLiteDBLogStorage::commitStagedRecordsIfNeeded()
+{
+    if (isGroupCommitNeeded()) {
+        try {
+            commitStagedRecords();
+        } catch (std::exception& e) {
+            KAA_LOG_ERROR(boost::format("Failed to commit %d staged log records, will retry later: %s")
+                                                                        % stagedRecords_.size() % e.what());
+        }
+    }
+}
+
+void SQLiteDBLogStorage::insertStagedRecord(std::int32_t bucketId, LogRecord& record)
+{
+    sqlite3_stmt *stmt = getCachedStatement(insertLogRecordStmt_, KAA_INSERT_NEW_RECORD_IN_BUCKET);
+    SQLiteStatementResetter resetter(stmt);
+
+    int errorCode = sqlite3_bind_int(stmt, 1, bucketId);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id of log record (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_bind_blob(stmt, 2, record.getData().data(), record.getSize(), SQLITE_STATIC);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log record data (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_step(stmt);
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute insert log record query (error %d)") % errorCode).str());
+}
+
+void SQLiteDBLogStorage::updateBucketInfo(std::int32_t bucketId, std::size_t recordCount, std::size_t sizeInBytes)
+{
+    sqlite3_stmt *stmt = getCachedStatement(updateBucketInfoStmt_, KAA_UPDATE_BUCKET_INFO);
+    SQLiteStatementResetter resetter(stmt);
+
+    int errorCode = sqlite3_bind_int64(stmt, 1, recordCount);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log record count (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_bind_int64(stmt, 2, sizeInBytes);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log records size (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_bind_int(stmt, 3, bucketId);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_step(stmt);
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute update log bucket query (error %d)") % errorCode).str());
+}
+
+void SQLiteDBLogStorage::commitStagedRecords()
+{
+    /*
+     * This function should be called under the storage lock.
+     */
+
+    if (stagedRecords_.empty()) {
+        return;
+    }
+
+    int errorCode = sqlite3_exec(db_, KAA_BEGIN_TRANSACTION, nullptr, nullptr, nullptr);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to begin transaction (error %d)") % errorCode).str());
+
+    try {
+        /*
+         * Staged records are ordered by bucket id, so bucket info is updated once per bucket.
+         */
+        std::int32_t bucketId = stagedRecords_.front().bucketId_;
+        std::size_t bucketRecordCount = 0;
+        std::size_t bucketSize = 0;
+
+        for (auto& stagedRecord : stagedRecords_) {
+            if (stagedRecord.bucketId_ != bucketId) {
+                updateBucketInfo(bucketId, bucketRecordCount, bucketSize);
+
+                bucketId = stagedRecord.bucketId_;
+                bucketRecordCount = bucketSize = 0;
+            }
+
+            insertStagedRecord(stagedRecord.bucketId_, stagedRecord.record_);
+
+            ++bucketRecordCount;
+            bucketSize += stagedRecord.record_.getSize();
+        }
+
+        updateBucketInfo(bucketId, bucketRecordCount, bucketSize);
+
+        errorCode = sqlite3_exec(db_, KAA_COMMIT_TRANSACTION, nullptr, nullptr, nullptr);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to commit transaction (error %d)") % errorCode).str());
+    } catch (...) {
+        sqlite3_exec(db_, KAA_ROLLBACK_TRANSACTION, nullptr, nullptr, nullptr);
+        throw;
+    }
+
+    KAA_LOG_TRACE(boost::format("Committed %d staged log records. %s") % stagedRecords_.size() % storageStatisticsToStr());
+
+    stagedRecords_.clear();
+}
+
 BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
 {
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
     auto recordSize = record.getSize();
     if (recordSize > maxBucketSize_) {
         KAA_LOG_WARN(boost::format("Failed to add log record: record_size %1%B, max_bucket_size %2%B")
@@ -391,10 +735,6 @@ BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
         throw KaaException("Too big log record");
     }
 
-    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
-    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
-    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
-
     if (checkBucketOverflow(record)) {
         KAA_LOG_TRACE(boost::format("Need to add new log bucket. Current %s. "
                                     "Log record size %d, max_logs %d, max_size % d")
@@ -403,61 +743,65 @@ BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
                                         % maxBucketRecordCount_
                                         % maxBucketSize_);
         addNextBucket();
+        enforceDiskQuota();
     }
 
-    try {
-        SQLiteStatement insertLogRecordStmt(db_, KAA_INSERT_NEW_RECORD_IN_BUCKET);
-
-        int errorCode = sqlite3_bind_int(insertLogRecordStmt.getStatement(), 1, currentBucketId_);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id of log record (error %d)") % errorCode).str());
-
-        errorCode = sqlite3_bind_blob(insertLogRecordStmt.getStatement(), 2, record.getData().data(), record.getSize(), SQLITE_STATIC);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log record data (error %d)") % errorCode).str());
-
-        SQLiteStatement updateBucketInfoStmt(db_, KAA_UPDATE_BUCKET_INFO);
+    if (stagedRecords_.empty()) {
+        oldestStagedRecordTime_ = std::chrono::steady_clock::now();
+    }
 
-        errorCode = sqlite3_bind_int(updateBucketInfoStmt.getStatement(), 1, record.getSize());
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log record size (error %d)") % errorCode).str());
+    stagedRecords_.emplace_back(currentBucketId_, std::move(record));
 
-        errorCode = sqlite3_bind_int(updateBucketInfoStmt.getStatement(), 2, currentBucketId_);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+    ++unmarkedRecordCount_;
+    ++totalRecordCount_;
+    consumedMemory_ += recordSize;
 
-        errorCode = sqlite3_step(insertLogRecordStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute insert log record query (error %d)") % errorCode).str());
+    ++currentBucketRecordCount_;
+    currentBucketSize_ += recordSize;
 
-        errorCode = sqlite3_step(updateBucketInfoStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute update log bucket query (error %d)") % errorCode).str());
+    KAA_LOG_TRACE(boost::format("Log record (%d bytes) added to %s. %s")
+                                    % recordSize % bucketStatisticsToStr() % storageStatisticsToStr());
 
-        ++unmarkedRecordCount_;
-        ++totalRecordCount_;
-        consumedMemory_ += record.getSize();
+    commitStagedRecordsIfNeeded();
 
-        ++currentBucketRecordCount_;
-        currentBucketSize_ += record.getSize();
+    return BucketInfo(currentBucketId_, currentBucketRecordCount_);
+}
 
-        KAA_LOG_TRACE(boost::format("Log record (%d bytes) added to %s. %s")
-                                        % record.getSize() % bucketStatisticsToStr() % storageStatisticsToStr());
-    } catch (std::exception& e) {
-        KAA_LOG_ERROR(boost::format("Failed to add log record: %s") % e.what());
-        throw KaaException(std::string("Failed to add log record: ") + e.what());
+LogBucket SQLiteDBLogStorage::getNextBucket()
+{
+    std::list<LogRecord> records;
+    auto bucketInfo = visitNextBucket([&records] (const std::uint8_t *data, std::size_t size)
+            {
+                records.emplace_back(data, size);
+            });
+
+    if (!bucketInfo.getLogCount()) {
+        return LogBucket();
     }
 
-    return BucketInfo(currentBucketId_, currentBucketRecordCount_);
+    return LogBucket(bucketInfo.getBucketId(), std::move(records));
 }
 
-LogBucket SQLiteDBLogStorage::getNextBucket()
+BucketInfo SQLiteDBLogStorage::visitNextBucket(const LogRecordVisitor& visitor)
 {
     try {
-        SQLiteStatement getOldestBucketStmt(db_, KAA_GET_THE_OLDEST_UNUSED_BUCKET);
-
         KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
         KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
+        commitStagedRecords();
+
+        auto cachedBucketInfo = visitCachedBucket(visitor);
+        if (cachedBucketInfo.getLogCount()) {
+            return cachedBucketInfo;
+        }
+
+        SQLiteStatement getOldestBucketStmt(db_, KAA_GET_THE_OLDEST_UNUSED_BUCKET);
+
         int errorCode = sqlite3_step(getOldestBucketStmt.getStatement());
         if (errorCode == SQLITE_DONE) {
             KAA_LOG_DEBUG("No unused log bucket found");
-            return LogBucket();
+            return BucketInfo();
         }
 
         throwIfError(errorCode, SQLITE_ROW, (boost::format("Failed to get the oldest unused log bucket (error %d)") % errorCode).str());
@@ -488,12 +832,27 @@ LogBucket SQLiteDBLogStorage::getNextBucket()
         errorCode = sqlite3_bind_int(getBucketLogRecordsStmt.getStatement(), 1, bucketId);
         throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind log bucket id (error %d)") % errorCode).str());
 
-        std::list<LogRecord> records;
+        std::vector<std::uint8_t> cachedData;
+        std::vector<std::size_t> cachedRecordSizes;
+        bool isCacheable = (bucketSizeInBytes <= bucketCacheSize_);
+        if (isCacheable) {
+            cachedData.reserve(bucketSizeInBytes);
+            cachedRecordSizes.reserve(bucketSizeInRecords);
+        }
 
+        /*
+         * The blob is valid only until the next step, so the visitor gets it without copying.
+         */
         while (SQLITE_ROW == (errorCode = sqlite3_step(getBucketLogRecordsStmt.getStatement()))) {
-            const void *recordData = sqlite3_column_blob(getBucketLogRecordsStmt.getStatement(), 0);
+            auto recordData = reinterpret_cast<const std::uint8_t *>(
+                                    sqlite3_column_blob(getBucketLogRecordsStmt.getStatement(), 0));
             int recordDataSize = sqlite3_column_bytes(getBucketLogRecordsStmt.getStatement(), 0);
-            records.emplace_back(reinterpret_cast<const std::uint8_t *>(recordData), recordDataSize);
+            visitor(recordData, recordDataSize);
+
+            if (isCacheable) {
+                cachedData.insert(cachedData.end(), recordData, recordData + recordDataSize);
+                cachedRecordSizes.push_back(recordDataSize);
+            }
         }
 
         throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'select bucket log records; query (error %d)")
@@ -505,6 +864,10 @@ LogBucket SQLiteDBLogStorage::getNextBucket()
         consumedMemory_ -= bucketSizeInBytes;
         consumedMemoryStorage_.insert(std::make_pair(bucketId, InnerBucketInfo(bucketSizeInBytes, bucketSizeInRecords)));
 
+        if (isCacheable) {
+            cacheBucket(bucketId, bucketSizeInBytes, std::move(cachedData), std::move(cachedRecordSizes));
+        }
+
         KAA_LOG_INFO(boost::format("Get log bucket: id %d, logs %d, size %d. %s")
                                         % bucketId % bucketSizeInRecords % bucketSizeInBytes % storageStatisticsToStr());
 
@@ -513,64 +876,158 @@ LogBucket SQLiteDBLogStorage::getNextBucket()
             addNextBucket();
         }
 
-        return LogBucket(bucketId, std::move(records));
+        return BucketInfo(bucketId, bucketSizeInRecords);
     } catch (std::exception& e) {
         KAA_LOG_ERROR(boost::format("Failed to get log bucket: %s") % e.what());
     }
 
-    return LogBucket();
+    return BucketInfo();
 }
 
 
-void SQLiteDBLogStorage::removeBucket(std::int32_t bucketId)
+std::size_t SQLiteDBLogStorage::deleteBucket(std::int32_t bucketId)
 {
-    try {
-        SQLiteStatement deleteBucketStmt(db_, KAA_DELETE_BUCKET);
+    /*
+     * This function should be called under the storage lock.
+     */
 
-        int errorCode = sqlite3_bind_int64(deleteBucketStmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+    SQLiteStatement deleteBucketStmt(db_, KAA_DELETE_BUCKET);
 
-        SQLiteStatement deleteBucketRecordsStmt(db_, KAA_DELETE_BUCKET_RECORDS);
+    int errorCode = sqlite3_bind_int64(deleteBucketStmt.getStatement(), 1, bucketId);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
 
-        errorCode = sqlite3_bind_int64(deleteBucketRecordsStmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+    SQLiteStatement deleteBucketRecordsStmt(db_, KAA_DELETE_BUCKET_RECORDS);
 
+    errorCode = sqlite3_bind_int64(deleteBucketRecordsStmt.getStatement(), 1, bucketId);
+    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_step(deleteBucketStmt.getStatement());
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'delete bucket info' query (error %d)") % errorCode).str());
+
+    errorCode = sqlite3_step(deleteBucketRecordsStmt.getStatement());
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'delete bucket logs' query (error %d)") % errorCode).str());
+
+    std::size_t removedRecordsCount = sqlite3_changes(db_);
+    totalRecordCount_ -= removedRecordsCount;
+    removeCachedBucket(bucketId);
+
+    return removedRecordsCount;
+}
+
+void SQLiteDBLogStorage::removeBucket(std::int32_t bucketId)
+{
+    try {
         KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
         KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
-        errorCode = sqlite3_step(deleteBucketStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'delete bucket info' query (error %d)") % errorCode).str());
-
-        errorCode = sqlite3_step(deleteBucketRecordsStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'delete bucket logs' query (error %d)") % errorCode).str());
-
-        auto removedRecordsCount = sqlite3_changes(db_);
-        totalRecordCount_ -= removedRecordsCount;
+        auto removedRecordsCount = deleteBucket(bucketId);
         consumedMemoryStorage_.erase(bucketId);
 
         KAA_LOG_INFO(boost::format("Removed %d log records, bucket id %d. %s")
                                     % removedRecordsCount % bucketId % storageStatisticsToStr());
+
+        /*
+         * No bucket is out for the upload, so a short vacuum step doesn't hold back the next one.
+         */
+        if (consumedMemoryStorage_.empty()) {
+            vacuum(KAA_INCREMENTAL_VACUUM_STEP);
+        }
     } catch (std::exception& e) {
         KAA_LOG_ERROR(boost::format("Failed to remove log bucket/records by bucket id %d: %s")
                                                                         % bucketId % e.what());
     }
 }
 
-void SQLiteDBLogStorage::rollbackBucket(std::int32_t bucketId)
+void SQLiteDBLogStorage::setDiskQuota(std::size_t size)
 {
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    diskQuota_ = size;
+
+    KAA_LOG_INFO(boost::format("Log database disk quota changed: %1% bytes") % diskQuota_);
+
+    enforceDiskQuota();
+}
+
+void SQLiteDBLogStorage::enforceDiskQuota()
+{
+    /*
+     * This function should be called under the storage lock.
+     */
+
+    if (!diskQuota_) {
+        return;
+    }
+
     try {
-        SQLiteStatement stmt(db_, KAA_MARK_BUCKET_AS_FREE);
+        auto usedSpace = getUsedDiskSpace();
+        if (usedSpace <= diskQuota_) {
+            return;
+        }
 
-        int errorCode = sqlite3_bind_int64(stmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+        /*
+         * Neither the buckets taken for the upload nor the ones with staged records are dropped.
+         */
+        std::int32_t firstKeptBucketId = stagedRecords_.empty() ? currentBucketId_ : stagedRecords_.front().bucketId_;
+        std::size_t droppedRecordCount = 0;
+
+        while (usedSpace > diskQuota_) {
+            SQLiteStatement getOldestBucketStmt(db_, KAA_GET_THE_OLDEST_FREE_BUCKET_BEFORE);
+
+            int errorCode = sqlite3_bind_int(getOldestBucketStmt.getStatement(), 1, firstKeptBucketId);
+            throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+            errorCode = sqlite3_step(getOldestBucketStmt.getStatement());
+            if (errorCode == SQLITE_DONE) {
+                KAA_LOG_WARN(boost::format("Log database takes %d B over the quota of %d B, no log bucket to drop")
+                                                                                    % usedSpace % diskQuota_);
+                break;
+            }
+
+            throwIfError(errorCode, SQLITE_ROW, (boost::format("Failed to get the oldest free log bucket (error %d)") % errorCode).str());
+
+            std::int32_t bucketId = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 1);
+            std::size_t bucketSizeInRecords = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 2);
+            std::size_t bucketSizeInBytes = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 3);
+
+            droppedRecordCount += deleteBucket(bucketId);
+            unmarkedRecordCount_ -= bucketSizeInRecords;
+            consumedMemory_ -= bucketSizeInBytes;
+
+            KAA_LOG_WARN(boost::format("Dropped log bucket %d (%d logs, %d B) to fit the disk quota")
+                                                % bucketId % bucketSizeInRecords % bucketSizeInBytes);
+
+            usedSpace = getUsedDiskSpace();
+        }
+
+        if (droppedRecordCount) {
+            vacuum(KAA_INCREMENTAL_VACUUM_ALL);
+            KAA_LOG_INFO(boost::format("Dropped %d log records to fit the disk quota. %s")
+                                                    % droppedRecordCount % storageStatisticsToStr());
+        }
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to enforce log database disk quota: %s") % e.what());
+    }
+}
 
+void SQLiteDBLogStorage::rollbackBucket(std::int32_t bucketId)
+{
+    try {
         KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
         KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
-        errorCode = sqlite3_step(stmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute 'update bucket in-use flag' query (error %d)") % errorCode).str());
+        auto cachedBucket = cachedBuckets_.find(bucketId);
+        if (cachedBucket != cachedBuckets_.end()) {
+            // Stays in use in the database until it is evicted from the cache
+            cachedBucket->second.isRolledBack_ = true;
+            touchCachedBucket(bucketId);
+        } else {
+            markBucketAsFree(bucketId);
+        }
 
         auto it = consumedMemoryStorage_.find(bucketId);
         if (it != consumedMemoryStorage_.end()) {
@@ -586,12 +1043,129 @@ void SQLiteDBLogStorage::rollbackBucket(std::int32_t bucketId)
 }
 
 
+void SQLiteDBLogStorage::setBucketCacheSize(std::size_t size)
+{
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    bucketCacheSize_ = size;
+    evictCachedBuckets(0);
+
+    KAA_LOG_INFO(boost::format("Bucket cache size changed: %1% bytes") % bucketCacheSize_);
+}
+
+BucketInfo SQLiteDBLogStorage::visitCachedBucket(const LogRecordVisitor& visitor)
+{
+    auto it = std::find_if(cachedBuckets_.begin(), cachedBuckets_.end(),
+                           [] (const std::pair<const std::int32_t, CachedBucket>& bucket)
+                           {
+                               return bucket.second.isRolledBack_;
+                           });
+    if (it == cachedBuckets_.end()) {
+        return BucketInfo();
+    }
+
+    std::int32_t bucketId = it->first;
+    CachedBucket& bucket = it->second;
+
+    const std::uint8_t *recordData = bucket.data_.data();
+    for (auto recordDataSize : bucket.recordSizes_) {
+        visitor(recordData, recordDataSize);
+        recordData += recordDataSize;
+    }
+
+    bucket.isRolledBack_ = false;
+    touchCachedBucket(bucketId);
+
+    std::size_t bucketSizeInRecords = bucket.recordSizes_.size();
+    unmarkedRecordCount_ -= bucketSizeInRecords;
+    consumedMemory_ -= bucket.sizeInBytes_;
+    consumedMemoryStorage_.insert(std::make_pair(bucketId, InnerBucketInfo(bucket.sizeInBytes_, bucketSizeInRecords)));
+
+    KAA_LOG_INFO(boost::format("Get cached log bucket: id %d, logs %d, size %d. %s")
+                                    % bucketId % bucketSizeInRecords % bucket.sizeInBytes_ % storageStatisticsToStr());
+
+    return BucketInfo(bucketId, bucketSizeInRecords);
+}
+
+void SQLiteDBLogStorage::cacheBucket(std::int32_t bucketId, std::size_t sizeInBytes,
+                                     std::vector<std::uint8_t>&& data, std::vector<std::size_t>&& recordSizes)
+{
+    evictCachedBuckets(data.size());
+
+    CachedBucket& bucket = cachedBuckets_[bucketId];
+    bucket.sizeInBytes_ = sizeInBytes;
+    bucket.data_ = std::move(data);
+    bucket.recordSizes_ = std::move(recordSizes);
+
+    cachedBucketsLru_.push_front(bucketId);
+    bucket.lruPosition_ = cachedBucketsLru_.begin();
+    cachedBucketsSize_ += bucket.data_.size();
+}
+
+void SQLiteDBLogStorage::touchCachedBucket(std::int32_t bucketId)
+{
+    auto it = cachedBuckets_.find(bucketId);
+    if (it != cachedBuckets_.end()) {
+        cachedBucketsLru_.splice(cachedBucketsLru_.begin(), cachedBucketsLru_, it->second.lruPosition_);
+    }
+}
+
+void SQLiteDBLogStorage::evictCachedBuckets(std::size_t sizeToFit)
+{
+    while (!cachedBucketsLru_.empty() && cachedBucketsSize_ + sizeToFit > bucketCacheSize_) {
+        std::int32_t bucketId = cachedBucketsLru_.back();
+        if (cachedBuckets_[bucketId].isRolledBack_) {
+            try {
+                markBucketAsFree(bucketId);
+            } catch (std::exception& e) {
+                KAA_LOG_ERROR(boost::format("Log bucket %d stays in use until the storage is reopened: %s")
+                                                                                        % bucketId % e.what());
+            }
+        }
+        removeCachedBucket(bucketId);
+    }
+}
+
+void SQLiteDBLogStorage::removeCachedBucket(std::int32_t bucketId)
+{
+    auto it = cachedBuckets_.find(bucketId);
+    if (it != cachedBuckets_.end()) {
+        cachedBucketsSize_ -= it->second.data_.size();
+        cachedBucketsLru_.erase(it->second.lruPosition_);
+        cachedBuckets_.erase(it);
+    }
+}
+
+bool SQLiteDBLogStorage::setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+{
+    if (!bucketSize || !bucketRecordCount) {
+        KAA_LOG_ERROR(boost::format("Failed to change bucket limits: max_size %1% bytes, max_record_count %2%")
+                                                                                % bucketSize % bucketRecordCount);
+        throw KaaException("Bucket limits should be greater than zero");
+    }
+
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    maxBucketSize_ = bucketSize;
+    maxBucketRecordCount_ = bucketRecordCount;
+
+    KAA_LOG_INFO(boost::format("Bucket limits changed: max_size %1% bytes, max_record_count %2%")
+                                                        % maxBucketSize_ % maxBucketRecordCount_);
+    return true;
+}
+
 std::size_t SQLiteDBLogStorage::getRecordsCount()
 {
     KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
     KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
+    commitStagedRecordsIfNeeded();
+
     return unmarkedRecordCount_;
 }
 
@@ -601,6 +1175,8 @@ std::size_t SQLiteDBLogStorage::getConsumedVolume()
     KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
     KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
+    commitStagedRecordsIfNeeded();
+
     return consumedMemory_;
 }
 
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/log/TieredLogStorage.hpp"
+
+#include <memory>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+namespace kaa {
+
+const std::size_t TieredLogStorage::MEMORY_TIER;
+const std::size_t TieredLogStorage::DISK_TIER;
+const std::size_t TieredLogStorage::TIER_COUNT;
+
+TieredLogStorage::TieredLogStorage(IKaaClientContext &context,
+                                   ILogStoragePtr diskStorage,
+                                   std::size_t memoryWatermark,
+                                   std::size_t bucketSize,
+                                   std::size_t bucketRecordCount)
+    : tiers_{ std::make_shared<MemoryLogStorage>(context, bucketSize, bucketRecordCount), diskStorage },
+      memoryWatermark_(memoryWatermark), context_(context)
+{
+    checkTiers();
+}
+
+TieredLogStorage::TieredLogStorage(IKaaClientContext &context,
+                                   ILogStoragePtr memoryStorage,
+                                   ILogStoragePtr diskStorage,
+                                   std::size_t memoryWatermark)
+    : tiers_{ memoryStorage, diskStorage }, memoryWatermark_(memoryWatermark), context_(context)
+{
+    checkTiers();
+}
+
+void TieredLogStorage::checkTiers()
+{
+    if (!tiers_[MEMORY_TIER] || !tiers_[DISK_TIER]) {
+        KAA_LOG_ERROR("Failed to create tiered log storage: tier is null");
+        throw KaaException("Tier storage is null");
+    }
+
+    if (tiers_[MEMORY_TIER] == tiers_[DISK_TIER]) {
+        KAA_LOG_ERROR("Failed to create tiered log storage: tiers are the same");
+        throw KaaException("Tier storages should be distinct");
+    }
+
+    if (!memoryWatermark_) {
+        KAA_LOG_ERROR("Failed to create tiered log storage: zero memory watermark");
+        throw KaaException("Memory watermark is zero");
+    }
+}
+
+BucketInfo TieredLogStorage::addLogRecord(LogRecord&& record)
+{
+    KAA_MUTEX_LOCKING("spillGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(spillLock, spillGuard_);
+    KAA_MUTEX_LOCKED("spillGuard_");
+
+    const std::size_t memoryUsage = tiers_[MEMORY_TIER]->getMemoryUsage();
+
+    if (!isSpilling_ && memoryUsage >= memoryWatermark_) {
+        KAA_LOG_INFO(boost::format("Memory tier occupies %1% bytes, log records spill to disk tier") % memoryUsage);
+        isSpilling_ = true;
+    }
+
+    const std::size_t tier = isSpilling_ ? DISK_TIER : MEMORY_TIER;
+    auto tierBucketInfo = tiers_[tier]->addLogRecord(std::move(record));
+    return BucketInfo(toBucketId(tier, tierBucketInfo.getBucketId()), tierBucketInfo.getLogCount());
+}
+
+template<class Getter>
+BucketInfo TieredLogStorage::getNextTierBucket(const Getter& getter)
+{
+    for (std::size_t tier = 0; tier < TIER_COUNT; ++tier) {
+        auto tierBucketInfo = getter(*tiers_[tier]);
+        if (tierBucketInfo.getLogCount()) {
+            KAA_LOG_TRACE(boost::format("Selected bucket from %1% tier") % (tier == MEMORY_TIER ? "memory" : "disk"));
+            return BucketInfo(toBucketId(tier, tierBucketInfo.getBucketId()), tierBucketInfo.getLogCount());
+        }
+    }
+
+    return BucketInfo();
+}
+
+LogBucket TieredLogStorage::getNextBucket()
+{
+    LogBucket tierBucket;
+    auto bucketInfo = getNextTierBucket([&tierBucket] (ILogStorage& tier)
+            {
+                tierBucket = tier.getNextBucket();
+                return BucketInfo(tierBucket.getBucketId(), tierBucket.getRecords().size());
+            });
+
+    if (!bucketInfo.getLogCount()) {
+        return LogBucket();
+    }
+
+    return LogBucket(bucketInfo.getBucketId(), std::move(tierBucket.getRecords()));
+}
+
+BucketInfo TieredLogStorage::visitNextBucket(const LogRecordVisitor& visitor)
+{
+    return getNextTierBucket([&visitor] (ILogStorage& tier)
+            {
+                return tier.visitNextBucket(visitor);
+            });
+}
+
+void TieredLogStorage::removeBucket(std::int32_t bucketId)
+{
+    const std::size_t tier = toTier(bucketId);
+    tiers_[tier]->removeBucket(toTierBucketId(bucketId));
+
+    if (tier != DISK_TIER) {
+        return;
+    }
+
+    KAA_MUTEX_LOCKING("spillGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(spillLock, spillGuard_);
+    KAA_MUTEX_LOCKED("spillGuard_");
+
+    /*
+     * Switched back only after the disk tier is drained, so records are uploaded in order.
+     */
+    if (isSpilling_ && !tiers_[DISK_TIER]->getStatus().getRecordsCount()
+            && tiers_[MEMORY_TIER]->getMemoryUsage() < memoryWatermark_) {
+        KAA_LOG_INFO("Disk tier is drained, log records go to memory tier");
+        isSpilling_ = false;
+    }
+}
+
+void TieredLogStorage::rollbackBucket(std::int32_t bucketId)
+{
+    tiers_[toTier(bucketId)]->rollbackBucket(toTierBucketId(bucketId));
+}
+
+bool TieredLogStorage::setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+{
+    bool isChanged = true;
+    for (auto& tier : tiers_) {
+        isChanged = tier->setBucketLimits(bucketSize, bucketRecordCount) && isChanged;
+    }
+
+    return isChanged;
+}
+
+std::size_t TieredLogStorage::getMemoryUsage()
+{
+    return tiers_[MEMORY_TIER]->getMemoryUsage() + tiers_[DISK_TIER]->getMemoryUsage();
+}
+
+bool TieredLogStorage::releaseMemory(std::size_t allowedVolume)
+{
+    KAA_MUTEX_LOCKING("spillGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(spillLock, spillGuard_);
+    KAA_MUTEX_LOCKED("spillGuard_");
+
+    if (!isSpilling_) {
+        KAA_LOG_INFO(boost::format("Memory pressure (allowed %1% bytes), log records spill to disk tier") % allowedVolume);
+        isSpilling_ = true;
+    }
+
+    return true;
+}
+
+std::size_t TieredLogStorage::getConsumedVolume()
+{
+    return tiers_[MEMORY_TIER]->getStatus().getConsumedVolume() + tiers_[DISK_TIER]->getStatus().getConsumedVolume();
+}
+
+std::size_t TieredLogStorage::getRecordsCount()
+{
+    return tiers_[MEMORY_TIER]->getStatus().getRecordsCount() + tiers_[DISK_TIER]->getStatus().getRecordsCount();
+}
+
+bool TieredLogStorage::isSpilling()
+{
+    KAA_MUTEX_LOCKING("spillGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(spillLock, spillGuard_);
+    KAA_MUTEX_LOCKED("spillGuard_");
+
+    return isSpilling_;
+}
+
+} /* namespace kaa */
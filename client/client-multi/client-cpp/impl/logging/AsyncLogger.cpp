@@ -0,0 +1,102 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/logging/AsyncLogger.hpp"
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+const std::size_t AsyncLogger::DEFAULT_QUEUE_CAPACITY;
+
+AsyncLogger::AsyncLogger(LoggerPtr logger, std::size_t queueCapacity)
+    : logger_(logger), queueCapacity_(queueCapacity), pendingCount_(0), droppedCount_(0)
+{
+    if (!logger_) {
+        throw KaaException("Logger is null");
+    }
+
+    if (!queueCapacity_) {
+        throw KaaException("Log queue capacity is zero");
+    }
+
+    thread_ = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        isStopped_ = true;
+    }
+
+    onMessage_.notify_one();
+    thread_.join();
+}
+
+void AsyncLogger::log(LogLevel level, const char *message) const
+{
+    if (pendingCount_ >= queueCapacity_ && level < LogLevel::KAA_WARNING) {
+        ++droppedCount_;
+        return;
+    }
+
+    ++pendingCount_;
+    if (queue_.push(Message(level, message))) {
+        /*
+         * The background thread checks the queue under the lock before it waits,
+         * so the wakeup can't be missed.
+         */
+        { std::lock_guard<std::mutex> lock(guard_); }
+        onMessage_.notify_one();
+    }
+}
+
+void AsyncLogger::flush() const
+{
+    if (std::this_thread::get_id() == thread_.get_id()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(guard_);
+    onWritten_.wait(lock, [this] { return !pendingCount_; });
+}
+
+void AsyncLogger::run()
+{
+    for (;;) {
+        queue_.consumeAll([this] (Message&& message)
+            {
+                try {
+                    logger_->log(message.level_, message.text_.c_str());
+                } catch (...) {
+                }
+                --pendingCount_;
+            });
+
+        std::unique_lock<std::mutex> lock(guard_);
+        onWritten_.notify_all();
+
+        if (queue_.empty()) {
+            if (isStopped_) {
+                return;
+            }
+            onMessage_.wait(lock, [this] { return isStopped_ || !queue_.empty(); });
+        }
+    }
+}
+
+}  // namespace kaa
@@ -33,7 +33,8 @@
 
 namespace kaa {
 
-DefaultLogger::DefaultLogger(const std::string& clientId, const std::string& logFileName): clientId_(clientId), pSink_(new text_sink)
+DefaultLogger::DefaultLogger(const std::string& clientId, const std::string& logFileName)
+    : clientId_(clientId), level_(LogLevel::KAA_TRACE), pSink_(new text_sink)
 {
     text_sink::locked_backend_ptr pBackend = pSink_->locked_backend();
     boost::shared_ptr< std::ostream > consoleStream(&std::clog, [](const void *)->void const {});
@@ -18,16 +18,25 @@
 
 #if KAA_LOG_LEVEL > KAA_LOG_LEVEL_NONE
 
+#include <string>
+#include <cstring>
+
 #include <boost/format.hpp>
 
 namespace kaa {
 
-static const char * const KAA_LOG_FMT = "[%1%:%2%]:\t%3%";
-
 void kaa_log_message(const ILogger & logger, LogLevel level, const char *message, const char *file, size_t lineno)
 {
-    boost::format logline = boost::format(KAA_LOG_FMT) % file % lineno % message;
-    logger.log(level, logline.str().c_str());
+    /*
+     * Built by hand rather than by boost::format: it is done for every message, often on the I/O thread.
+     */
+    const std::string line = std::to_string(lineno);
+
+    std::string logline;
+    logline.reserve(std::strlen(file) + line.size() + std::strlen(message) + 5);
+    logline.append(1, '[').append(file).append(1, ':').append(line).append("]:\t").append(message);
+
+    logger.log(level, logline.c_str());
 }
 
 void kaa_log_message(const ILogger & logger, LogLevel level, const std::string &message, const char *file, size_t lineno)
@@ -25,15 +25,16 @@
 #include "kaa/utils/IThreadPool.hpp"
 #include "kaa/context/IExecutorContext.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
-#include "kaa/common/AvroByteArrayConverter.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 #include "kaa/common/exception/UnavailableTopicException.hpp"
 #include "kaa/common/exception/TransportNotFoundException.hpp"
 
 namespace kaa {
 
+const std::size_t NotificationManager::MAX_NOTIFICATIONS_PER_TASK;
+
 NotificationManager::NotificationManager(IKaaClientContext &context)
-    : context_(context)
+    : context_(context), pendingNotificationsVolume_(0)
 {
     auto topicList = context_.getStatus().getTopicList();
 
@@ -87,18 +88,15 @@ void NotificationManager::topicsListUpdated(const Topics& topicList)
 
 void NotificationManager::notificationReceived(const Notifications& notifications)
 {
-    AvroByteArrayConverter<KaaNotification> deserializer;
+    /*
+     * The batch is copied once and shared by the dispatch queues of its topics.
+     */
+    auto batch = std::make_shared<const Notifications>(notifications);
 
-    for (const Notification& notification : notifications) {
+    for (const Notification& notification : *batch) {
         try {
             findTopic(notification.topicId);
-
-            auto deserializedNotification = std::make_shared<KaaNotification>();
-            deserializer.fromByteArray(notification.body.data(), notification.body.size(), *deserializedNotification);
-
-            if (!notifyOptionalNotificationSubscribers(notification.topicId, deserializedNotification)) {
-                notifyMandatoryNotificationSubscribers(notification.topicId, deserializedNotification);
-            }
+            enqueueNotification(batch, notification);
         } catch (const UnavailableTopicException& e) {
             KAA_LOG_WARN(boost::format("Received notification for unknown topic (id='%1%')") % notification.topicId);
         }
@@ -177,6 +175,51 @@ void NotificationManager::removeNotificationListener(std::int64_t topidId, INoti
     }
 }
 
+void NotificationManager::addRawNotificationListener(IRawNotificationListener& listener)
+{
+    mandatoryRawListeners_.addCallback(&listener, std::bind(&IRawNotificationListener::onRawNotification, &listener,
+                                                            std::placeholders::_1, std::placeholders::_2));
+}
+
+void NotificationManager::addRawNotificationListener(std::int64_t topidId, IRawNotificationListener& listener)
+{
+    findTopic(topidId);
+
+    KAA_MUTEX_LOCKING("optionalListenersGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(optionalListenersLock, optionalListenersGuard_);
+    KAA_MUTEX_LOCKED("optionalListenersGuard_");
+
+    auto it = optionalRawListeners_.find(topidId);
+    if (it == optionalRawListeners_.end()) {
+        it = optionalRawListeners_.insert(std::make_pair(topidId, std::make_shared<RawNotificationObservable>())).first;
+    }
+
+    it->second->addCallback(&listener, std::bind(&IRawNotificationListener::onRawNotification, &listener,
+                            std::placeholders::_1, std::placeholders::_2));
+}
+
+void NotificationManager::removeRawNotificationListener(IRawNotificationListener& listener)
+{
+    mandatoryRawListeners_.removeCallback(&listener);
+}
+
+void NotificationManager::removeRawNotificationListener(std::int64_t topidId, IRawNotificationListener& listener)
+{
+    findTopic(topidId);
+
+    KAA_MUTEX_LOCKING("optionalListenersGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(optionalListenersLock, optionalListenersGuard_);
+    KAA_MUTEX_LOCKED("optionalListenersGuard_");
+
+    auto it = optionalRawListeners_.find(topidId);
+    if (it != optionalRawListeners_.end()) {
+        it->second->removeCallback(&listener);
+        if (it->second->isEmpty()) {
+            optionalRawListeners_.erase(topidId);
+        }
+    }
+}
+
 void NotificationManager::subscribeToTopic(std::int64_t id, bool forceSync)
 {
     if (findTopic(id).subscriptionType != OPTIONAL_SUBSCRIPTION) {
@@ -325,36 +368,144 @@ const Topic& NotificationManager::findTopic(std::int64_t id)
 
 void NotificationManager::notifyTopicUpdateSubscribers(const Topics& topics)
 {
-    context_.getExecutorContext().getCallbackExecutor().add([this, topics] () { topicListeners_(topics); });
+    /*
+     * Only the latest topic list is worth delivering.
+     */
+    context_.getExecutorContext().getCallbackExecutor().addCoalescing(&topicListeners_,
+                                                                      [this, topics] () { topicListeners_(topics); });
+}
+
+void NotificationManager::enqueueNotification(const std::shared_ptr<const Notifications>& batch,
+                                              const Notification& notification)
+{
+    TopicDispatchQueuePtr queue;
+    {
+        KAA_MUTEX_LOCKING("dispatchQueuesGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(dispatchQueuesLock, dispatchQueuesGuard_);
+        KAA_MUTEX_LOCKED("dispatchQueuesGuard_");
+
+        auto& topicQueue = dispatchQueues_[notification.topicId];
+        if (!topicQueue) {
+            topicQueue = std::make_shared<TopicDispatchQueue>();
+        }
+        queue = topicQueue;
+    }
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queue->queueGuard_);
+        queue->notifications_.emplace_back(batch, &notification);
+    }
+    pendingNotificationsVolume_ += getNotificationVolume(notification);
+
+    scheduleDispatch(queue);
 }
 
-void NotificationManager::notifyMandatoryNotificationSubscribers(std::int64_t id, KaaNotificationPtr notification)
+void NotificationManager::scheduleDispatch(TopicDispatchQueuePtr queue)
 {
-    context_.getExecutorContext().getCallbackExecutor().add([this, id, notification] () { mandatoryListeners_(id, *notification); });
+    /*
+     * A task per notification keeps the callback queue limits in effect, while one pending task
+     * per topic is enough with the coalescing policy.
+     */
+    context_.getExecutorContext().getCallbackExecutor().addCoalescing(queue.get(),
+                                                                      [this, queue] () { dispatchNotifications(queue); });
 }
 
-bool NotificationManager::notifyOptionalNotificationSubscribers(std::int64_t id, KaaNotificationPtr notification)
+void NotificationManager::dispatchNotifications(TopicDispatchQueuePtr queue)
 {
-    bool notified = false;
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queue->queueGuard_);
 
-    KAA_MUTEX_LOCKING("optionalListenersGuard_");
-    KAA_MUTEX_UNIQUE_DECLARE(optionalListenersLock, optionalListenersGuard_);
-    KAA_MUTEX_LOCKED("optionalListenersGuard_");
+        if (queue->isDispatching_) {
+            // The running dispatch picks the notification up.
+            return;
+        }
 
-    auto it = optionalListeners_.find(id);
-    if (it != optionalListeners_.end()) {
-        auto notifier = it->second;
+        queue->isDispatching_ = true;
+    }
+
+    for (std::size_t i = 0; i < MAX_NOTIFICATIONS_PER_TASK; ++i) {
+        PendingNotification pending;
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(queueLock, queue->queueGuard_);
+
+            if (queue->notifications_.empty()) {
+                queue->isDispatching_ = false;
+                return;
+            }
+
+            pending = std::move(queue->notifications_.front());
+            queue->notifications_.pop_front();
+        }
+
+        dispatchNotification(*pending.second);
+        pendingNotificationsVolume_ -= getNotificationVolume(*pending.second);
+    }
 
-        KAA_MUTEX_UNLOCKING("optionalListenersGuard_");
-        KAA_UNLOCK(optionalListenersLock);
-        KAA_MUTEX_UNLOCKED("optionalListenersGuard_");
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queue->queueGuard_);
+        queue->isDispatching_ = false;
+    }
+
+    /*
+     * A busy topic yields the callback worker to other topics.
+     */
+    scheduleDispatch(queue);
+}
+
+void NotificationManager::dispatchNotification(const Notification& notification)
+{
+    NotificationObservablePtr optionalListeners;
+    RawNotificationObservablePtr optionalRawListeners;
+    {
+        KAA_MUTEX_LOCKING("optionalListenersGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(optionalListenersLock, optionalListenersGuard_);
+        KAA_MUTEX_LOCKED("optionalListenersGuard_");
 
-        notified = true;
+        auto it = optionalListeners_.find(notification.topicId);
+        if (it != optionalListeners_.end()) {
+            optionalListeners = it->second;
+        }
 
-        context_.getExecutorContext().getCallbackExecutor().add([notifier, id, notification] () { (*notifier)(id, *notification); });
+        auto rawIt = optionalRawListeners_.find(notification.topicId);
+        if (rawIt != optionalRawListeners_.end()) {
+            optionalRawListeners = rawIt->second;
+        }
     }
 
-    return notified;
+    /*
+     * Topic-specific listeners of either kind take precedence over global ones.
+     */
+    NotificationObservable *listeners = &mandatoryListeners_;
+    RawNotificationObservable *rawListeners = &mandatoryRawListeners_;
+    if (optionalListeners || optionalRawListeners) {
+        listeners = optionalListeners.get();
+        rawListeners = optionalRawListeners.get();
+    }
+
+    /*
+     * The body is decoded only if a typed listener or a raw listener asks for it.
+     * A listener may run other dispatch tasks on this thread (e.g. by stopping a polled client),
+     * so each dispatch has its own notification wrapper.
+     */
+    RawNotification rawNotification(notification.body.data(), notification.body.size());
+
+    /*
+     * A failed listener must not stall the rest of the topic's notifications.
+     */
+    try {
+        if (rawListeners) {
+            (*rawListeners)(notification.topicId, rawNotification);
+        }
+
+        if (listeners && !listeners->isEmpty()) {
+            (*listeners)(notification.topicId, rawNotification.get());
+        }
+    } catch (const std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Notification listener for topic (id='%1%') failed: %2%")
+                      % notification.topicId % e.what());
+    } catch (...) {
+        KAA_LOG_ERROR(boost::format("Notification listener for topic (id='%1%') failed") % notification.topicId);
+    }
 }
 
 void NotificationManager::setTransport(std::shared_ptr<NotificationTransport> transport)
@@ -28,6 +28,23 @@
 
 namespace kaa {
 
+/* Multicast notifications this far below the topic state are considered received. */
+static const std::int32_t TOPIC_SEQUENCE_WINDOW_SIZE = 64;
+static const std::size_t  UNICAST_NOTIFICATION_HISTORY_SIZE = 128;
+
+/*
+ * FNV-1a: the hashes are persisted, so they must not depend on the standard library implementation.
+ */
+static std::uint64_t hashNotificationUid(const std::string& uid)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : uid) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 NotificationTransport::NotificationTransport(IKaaChannelManager& manager, IKaaClientContext &context)
     : AbstractKaaTransport(manager, context), notificationProcessor_(nullptr)
 {}
@@ -95,12 +112,14 @@ NotificationSyncRequestPtr NotificationTransport::createNotificationRequest()
 void NotificationTransport::onNotificationResponse(const NotificationSyncResponse& response)
 {
     auto &topicStates = context_.getStatus().getTopicStates();
+    auto topicSequenceWindows = context_.getStatus().getTopicSequenceWindows();
+    auto unicastNotificationHashes = context_.getStatus().getUnicastNotificationHashes();
 
     if (response.responseStatus == SyncResponseStatus::NO_DELTA) {
         acceptedUnicastNotificationIds_.clear();
     } else {
         if (!response.availableTopics.is_null()) {
-            auto&& topics = response.availableTopics.get_array();
+            auto topics = response.availableTopics.get_array();
             std::sort(topics.begin(), topics.end(), [](const Topic& topic1, const Topic& topic2) { return topic1.id < topic2.id; });
             std::int64_t tId;
             std::int32_t topicListHash = 1;
@@ -111,25 +130,29 @@ void NotificationTransport::onNotificationResponse(const NotificationSyncRespons
                  topicListHash = 31 * topicListHash + (uint32_t)(tId ^ (tId >> 32));
             }
 
-            /* If The current topic list hash are differs from the calculated one - update topic list and hash */
-            if (context_.getStatus().getTopicListHash() != topicListHash) {
+            /* The topic list is resent as is (e.g. on reconnect) if the server doesn't confirm
+             * the hash, so rebuild the topics and notify listeners only if it has changed.
+             */
+            if (context_.getStatus().getTopicListHash() == topicListHash) {
+                KAA_LOG_DEBUG(boost::format("Topic list is unchanged (hash %1%), skipping update") % topicListHash);
+            } else {
                 context_.getStatus().setTopicListHash(topicListHash);
                 context_.getStatus().setTopicList(topics);
-            }
 
-            if (notificationProcessor_) {
-                notificationProcessor_->topicsListUpdated(topics);
-            }
+                if (notificationProcessor_) {
+                    notificationProcessor_->topicsListUpdated(topics);
+                }
 
-            /* In case when we received new topic list, we need to remove
-             * outdated subscription commands.
-             */
-            subscriptions_.remove_if([&](SubscriptionCommand &subscription) {
-                 auto topicIsAvailable = std::find_if(topics.begin(), topics.end(), [&](Topic &topic)
-                                                      { return topic.id == subscription.topicId; });
+                /* In case when we received new topic list, we need to remove
+                 * outdated subscription commands.
+                 */
+                subscriptions_.remove_if([&](SubscriptionCommand &subscription) {
+                     auto topicIsAvailable = std::find_if(topics.begin(), topics.end(), [&](Topic &topic)
+                                                          { return topic.id == subscription.topicId; });
 
-                 return topicIsAvailable == topics.end();
-            });
+                     return topicIsAvailable == topics.end();
+                });
+            }
         }
     }
     /* Add/remove valid subscriptions */
@@ -138,10 +161,13 @@ void NotificationTransport::onNotificationResponse(const NotificationSyncRespons
             topicStates.insert(std::make_pair(subscription.topicId, 0));
         } else {
             topicStates.erase(subscription.topicId);
+            topicSequenceWindows.erase(subscription.topicId);
         }
     }
 
     subscriptions_.clear();
+
+    Notifications newNotifications;
     if (!response.notifications.is_null()) {
 
         KAA_LOG_INFO(boost::format("Received notifications array: %1%") % LoggingUtils::toString(response.notifications));
@@ -151,13 +177,12 @@ void NotificationTransport::onNotificationResponse(const NotificationSyncRespons
         Notifications unicast = getUnicastNotifications(notifications);
         Notifications multicast = getMulticastNotifications(notifications);
 
-        Notifications newNotifications;
-
         for (const auto& n : unicast) {
             const std::string& uid = n.uid.get_string();
             KAA_LOG_INFO(boost::format("Adding '%1%' to unicast accepted notifications") % uid);
+            /* Acknowledge duplicates too: the server resends a notification until it gets the ack. */
             auto addResultPair = acceptedUnicastNotificationIds_.insert(uid);
-            if (addResultPair.second) {
+            if (addResultPair.second && acceptUnicastNotification(uid, unicastNotificationHashes)) {
                 newNotifications.push_back(n);
             } else {
                 KAA_LOG_INFO(boost::format("Notification with uid [%1%] was already received") % uid);
@@ -168,25 +193,75 @@ void NotificationTransport::onNotificationResponse(const NotificationSyncRespons
             KAA_LOG_DEBUG(boost::format("Notification: %1%, Stored sequence number: %2%")
                     % LoggingUtils::toString(n)
                     % topicStates[n.topicId]);
-            auto& currentSequenceNumber = topicStates[n.topicId];
             std::int32_t notificationSequenceNumber = (n.seqNumber.is_null()) ? 0 : n.seqNumber.get_int();
-            if (notificationSequenceNumber > currentSequenceNumber) {
+            if (acceptMulticastNotification(n.topicId, notificationSequenceNumber, topicStates, topicSequenceWindows)) {
                 newNotifications.push_back(n);
-                topicStates[n.topicId] = notificationSequenceNumber;
             }
         }
-        if (notificationProcessor_) {
-            notificationProcessor_->notificationReceived(newNotifications);
-        }
     }
 
     context_.getStatus().setTopicStates(topicStates);
+    context_.getStatus().setTopicSequenceWindows(topicSequenceWindows);
+    context_.getStatus().setUnicastNotificationHashes(unicastNotificationHashes);
+
+    if (!newNotifications.empty()) {
+        /* Persist what was received before the delivery, so a restart doesn't deliver it again. */
+        context_.getStatus().flush();
+    }
+
+    if (!response.notifications.is_null() && notificationProcessor_) {
+        notificationProcessor_->notificationReceived(newNotifications);
+    }
 
     if (response.responseStatus != SyncResponseStatus::NO_DELTA) {
         syncAck();
     }
 }
 
+bool NotificationTransport::acceptMulticastNotification(std::int64_t topicId, std::int32_t sequenceNumber,
+                                                        TopicStates& topicStates, TopicSequenceWindows& windows)
+{
+    auto& currentSequenceNumber = topicStates[topicId];
+    auto& window = windows[topicId];
+
+    if (sequenceNumber > currentSequenceNumber) {
+        /* Slide the window, the previous topic state becomes its newest entry. */
+        std::int64_t shift = static_cast<std::int64_t>(sequenceNumber) - currentSequenceNumber;
+        if (shift < TOPIC_SEQUENCE_WINDOW_SIZE) {
+            window = (window << shift) | (1ULL << (shift - 1));
+        } else if (shift == TOPIC_SEQUENCE_WINDOW_SIZE) {
+            window = 1ULL << (TOPIC_SEQUENCE_WINDOW_SIZE - 1);
+        } else {
+            window = 0;
+        }
+        currentSequenceNumber = sequenceNumber;
+        return true;
+    }
+
+    /* Late notifications are accepted once unless they are too old to tell. */
+    std::int64_t offset = static_cast<std::int64_t>(currentSequenceNumber) - sequenceNumber - 1;
+    if (offset < 0 || offset >= TOPIC_SEQUENCE_WINDOW_SIZE || (window & (1ULL << offset))) {
+        return false;
+    }
+
+    window |= 1ULL << offset;
+    return true;
+}
+
+bool NotificationTransport::acceptUnicastNotification(const std::string& uid, UnicastNotificationHashes& hashes)
+{
+    auto hash = hashNotificationUid(uid);
+    if (std::find(hashes.begin(), hashes.end(), hash) != hashes.end()) {
+        return false;
+    }
+
+    if (hashes.size() >= UNICAST_NOTIFICATION_HISTORY_SIZE) {
+        hashes.erase(hashes.begin(), hashes.begin() + (hashes.size() - UNICAST_NOTIFICATION_HISTORY_SIZE + 1));
+    }
+    hashes.push_back(hash);
+    return true;
+}
+
 Notifications NotificationTransport::getUnicastNotifications(const Notifications & notifications)
 {
     Notifications result;
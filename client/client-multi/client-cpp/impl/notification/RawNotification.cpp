@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef KAA_USE_NOTIFICATIONS
+
+#include "kaa/notification/RawNotification.hpp"
+
+#include <exception>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/utils/ObjectPool.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+RawNotification::RawNotification(const std::uint8_t *data, std::size_t size)
+    : data_(data), size_(size)
+{
+}
+
+RawNotification::~RawNotification()
+{
+    if (isDecoded_) {
+        ObjectPool<KaaNotification>::release(std::move(notification_));
+    }
+}
+
+const KaaNotification& RawNotification::get() const
+{
+    if (!isDecoded_) {
+        static kaa_thread_local AvroByteArrayConverter<KaaNotification> deserializer;
+
+        /*
+         * The recycled object keeps buffers of a previous notification, so decoding doesn't allocate them.
+         */
+        notification_ = ObjectPool<KaaNotification>::acquire();
+
+        try {
+            deserializer.fromByteArray(data_, size_, notification_);
+        } catch (const std::exception& e) {
+            throw KaaException(boost::format("Failed to decode notification: %1%") % e.what());
+        }
+
+        isDecoded_ = true;
+    }
+
+    return notification_;
+}
+
+} /* namespace kaa */
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kaa/profile/ProfileManager.hpp"
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+ProfileManager::ProfileManager(IKaaClientContext &context)
+    : profileContainer_(std::make_shared<DefaultProfileContainer>()), context_(context), skippedUpdatesCount_(0)
+{
+}
+
+void ProfileManager::setProfileContainer(IProfileContainerPtr container)
+{
+    if (container) {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+        profileContainer_ = container;
+        isSerializedProfileValid_ = false;
+    }
+}
+
+void ProfileManager::refreshSerializedProfile()
+{
+    std::uint64_t version = profileContainer_ ? profileContainer_->getProfileVersion() : 0;
+
+    /* Zero version means the container doesn't track its changes. */
+    if (isSerializedProfileValid_ && version && version == serializedProfileVersion_) {
+        return;
+    }
+
+    EndpointObjectHash hash;
+    if (profileContainer_) {
+        serializedProfile_ = avroConverter_.toByteArray(profileContainer_->getProfile(), hash);
+    }
+#if KAA_PROFILE_SCHEMA_VERSION > 0
+    else {
+        throw KaaException("Profile container is not set!");
+    }
+#else
+    else {
+        serializedProfile_ = avroConverter_.toByteArray(KaaProfile(), hash);
+    }
+#endif
+
+    serializedProfileHash_ = hash.getHashDigest();
+    serializedProfileVersion_ = version;
+    isSerializedProfileValid_ = true;
+}
+
+SharedDataBuffer ProfileManager::getSerializedProfile()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+    refreshSerializedProfile();
+    return serializedProfile_;
+}
+
+HashDigest ProfileManager::getSerializedProfileHash()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+    refreshSerializedProfile();
+    return serializedProfileHash_;
+}
+
+void ProfileManager::updateProfile()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+    refreshSerializedProfile();
+
+    bool hasProfile = serializedProfile_.first.get() && serializedProfile_.second > 0;
+    HashDigest profileHash = serializedProfileHash_;
+
+    KAA_UNLOCK(lock);
+
+    auto& status = context_.getStatus();
+    if (status.isProfileResyncNeeded()) {
+        transport_->sync();
+        return;
+    }
+
+    if (status.isRegistered() && profileHash == status.getProfileHash()) {
+        ++skippedUpdatesCount_;
+        KAA_LOG_TRACE("Profile is unchanged, skipping sync");
+        return;
+    }
+
+    if (hasProfile) {
+        transport_->sync();
+    }
+}
+
+} /* namespace kaa */
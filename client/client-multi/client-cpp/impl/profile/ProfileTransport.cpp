@@ -43,7 +43,7 @@ ProfileSyncRequestPtr ProfileTransport::createProfileRequest()
 
     if (profileManager_) {
         auto encodedProfile = profileManager_->getSerializedProfile();
-        HashDigest newHash = EndpointObjectHash(encodedProfile).getHashDigest();
+        HashDigest newHash = profileManager_->getSerializedProfileHash();
 
         if (context_.getStatus().isProfileResyncNeeded()
                 || !context_.getStatus().isRegistered() || isProfileOutDated(newHash))
@@ -15,83 +15,118 @@
  */
 
 #include "kaa/security/RsaEncoderDecoder.hpp"
-#include <botan/pubkey.h>
-#include <botan/pkcs8.h>
-#include <botan/pipe.h>
-#include <botan/key_filt.h>
-#include <sstream>
+#include <botan/lookup.h>
 
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+#include <algorithm>
 
 namespace kaa {
 
 RsaEncoderDecoder::RsaEncoderDecoder(const PublicKey& pubKey,
         const PrivateKey& privKey,
         const PublicKey& remoteKey, IKaaClientContext &context)
-    : pubKey_(nullptr), privKey_(nullptr), remoteKey_(nullptr), sessionKey_(KeyUtils().generateSessionKey(16)), context_(context)
+    : RsaEncoderDecoder(pubKey, privKey, remoteKey, KeyUtils().generateSessionKey(16), context)
+{
+
+}
+
+RsaEncoderDecoder::RsaEncoderDecoder(const PublicKey& pubKey,
+        const PrivateKey& privKey,
+        const PublicKey& remoteKey,
+        const SessionKey& sessionKey,
+        IKaaClientContext &context)
+    : sessionKey_(sessionKey), context_(context)
 {
     KAA_LOG_TRACE("Creating MessageEncoderDecoder with following parameters: ");
 
     if (!pubKey.empty()) {
-        Botan::DataSource_Memory pubMem(pubKey);
-        pubKey_.reset(Botan::X509::load_key(pubMem));
+        pubKey_ = RsaKeyCache::getPublicKey(pubKey);
     }
 
     KAA_LOG_TRACE(boost::format("PublicKey: %1%") % ( pubKey_ ? LoggingUtils::toString(
-        pubKey_->x509_subject_public_key().data(), pubKey_->x509_subject_public_key().size()) : "empty"));
+        pubKey_->getKey().x509_subject_public_key().data(), pubKey_->getKey().x509_subject_public_key().size()) : "empty"));
 
     if (!privKey.empty()) {
-        Botan::DataSource_Memory privMem(privKey);
-        privKey_.reset(Botan::PKCS8::load_key(privMem, rng_));
+        privKey_ = RsaKeyCache::getPrivateKey(privKey);
     }
 
     if (!remoteKey.empty()) {
-        Botan::DataSource_Memory remoteMem(remoteKey);
-        remoteKey_.reset(Botan::X509::load_key(remoteMem));
+        remoteKey_ = RsaKeyCache::getPublicKey(remoteKey);
     }
 
     KAA_LOG_TRACE(boost::format("RemotePublicKey: %1%") % ( remoteKey_ ? LoggingUtils::toString(
-            remoteKey_->x509_subject_public_key().data(), remoteKey_->x509_subject_public_key().size()) : "empty"));
+            remoteKey_->getKey().x509_subject_public_key().data(), remoteKey_->getKey().x509_subject_public_key().size()) : "empty"));
+
+    sessionCipher_.reset(Botan::get_block_cipher("AES-128"));
+    sessionCipher_->set_key(sessionKey_);
 }
 
 EncodedSessionKey RsaEncoderDecoder::getEncodedSessionKey()
 {
-    Botan::PK_Encryptor_EME enc(*remoteKey_, "EME-PKCS1-v1_5");
-    auto &&v = enc.encrypt(sessionKey_.bits_of(), rng_);
-    return Botan::secure_vector<std::uint8_t>(v.begin(), v.end());
-}
+    /*
+     * The session key doesn't change, so it is encrypted once.
+     */
+    if (encodedSessionKey_.empty()) {
+        const auto& bits = sessionKey_.bits_of();
+        encodedSessionKey_ = remoteKey_->encrypt(bits.data(), bits.size());
+    }
 
-std::string RsaEncoderDecoder::cipherPipe(const std::uint8_t *data, std::size_t size, Botan::Cipher_Dir dir)
-{
-    Botan::Pipe pipe(Botan::get_cipher("AES-128/ECB/PKCS7", sessionKey_, dir));
-    std::ostringstream stream;
-    pipe.process_msg(data, size);
-    stream << pipe;
-    return stream.str();
+    return encodedSessionKey_;
 }
 
 std::string RsaEncoderDecoder::encodeData(const std::uint8_t *data, std::size_t size)
 {
-    return cipherPipe(data, size, Botan::ENCRYPTION);
+    std::vector<std::uint8_t> buffer(data, data + size);
+    encodeDataInPlace(buffer);
+    return std::string(buffer.begin(), buffer.end());
 }
 
 std::string RsaEncoderDecoder::decodeData(const std::uint8_t *data, std::size_t size)
 {
-    return cipherPipe(data, size, Botan::DECRYPTION);
+    std::string buffer(reinterpret_cast<const char *>(data), size);
+    buffer.resize(decodeDataInPlace(reinterpret_cast<std::uint8_t *>(&buffer[0]), buffer.size()));
+    return buffer;
+}
+
+void RsaEncoderDecoder::encodeDataInPlace(std::vector<std::uint8_t>& buffer, std::size_t offset)
+{
+    const std::size_t blockSize = sessionCipher_->block_size();
+    const std::size_t padding = blockSize - (buffer.size() - offset) % blockSize;
+    buffer.insert(buffer.end(), padding, static_cast<std::uint8_t>(padding));
+
+    std::uint8_t *data = buffer.data() + offset;
+    sessionCipher_->encrypt_n(data, data, (buffer.size() - offset) / blockSize);
+}
+
+std::size_t RsaEncoderDecoder::decodeDataInPlace(std::uint8_t *data, std::size_t size)
+{
+    const std::size_t blockSize = sessionCipher_->block_size();
+    if (!size || size % blockSize) {
+        throw KaaException("Invalid size of encrypted data");
+    }
+
+    sessionCipher_->decrypt_n(data, data, size / blockSize);
+
+    const std::size_t padding = data[size - 1];
+    if (!padding || padding > blockSize ||
+            std::any_of(data + size - padding, data + size, [padding] (std::uint8_t b) { return b != padding; })) {
+        throw KaaException("Invalid padding of decrypted data");
+    }
+
+    return size - padding;
 }
 
 Signature RsaEncoderDecoder::signData(const std::uint8_t *data, std::size_t size)
 {
-    Botan::PK_Signer signer(*privKey_, "EMSA3(SHA-1)");
-    auto &&sgn = signer.sign_message(data, size, rng_);
-    return Botan::secure_vector<std::uint8_t>(sgn.begin(), sgn.end());
+    return privKey_->sign(data, size);
 }
 
 bool RsaEncoderDecoder::verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen)
 {
-    Botan::PK_Verifier verifier(*remoteKey_, "EMSA3(SHA-1)");
-    return verifier.verify_message(data, len, sig, sigLen);
+    return remoteKey_->verify(data, len, sig, sigLen);
 }
 
 }
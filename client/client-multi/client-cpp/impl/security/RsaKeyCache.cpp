@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/security/RsaKeyCache.hpp"
+
+#include <botan/pkcs8.h>
+#include <botan/x509_key.h>
+
+namespace kaa {
+
+static const char *const RSA_ENCRYPTION_PADDING = "EME-PKCS1-v1_5";
+static const char *const RSA_SIGNATURE_PADDING = "EMSA3(SHA-1)";
+
+const std::size_t RsaKeyCache::MAX_CACHED_KEYS;
+
+RsaKeyCache::PublicKeyContext::PublicKeyContext(const PublicKey& key)
+{
+    Botan::DataSource_Memory keyMem(key);
+    key_.reset(Botan::X509::load_key(keyMem));
+}
+
+EncodedSessionKey RsaKeyCache::PublicKeyContext::encrypt(const std::uint8_t *data, std::size_t size)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, operationGuard_);
+    if (!encryptor_) {
+        encryptor_.reset(new Botan::PK_Encryptor_EME(*key_, RSA_ENCRYPTION_PADDING));
+    }
+
+    auto &&encrypted = encryptor_->encrypt(data, size, rng_);
+    return EncodedSessionKey(encrypted.begin(), encrypted.end());
+}
+
+bool RsaKeyCache::PublicKeyContext::verify(const std::uint8_t *data, std::size_t len,
+                                           const std::uint8_t *sig, std::size_t sigLen)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, operationGuard_);
+    if (!verifier_) {
+        verifier_.reset(new Botan::PK_Verifier(*key_, RSA_SIGNATURE_PADDING));
+    }
+
+    return verifier_->verify_message(data, len, sig, sigLen);
+}
+
+RsaKeyCache::PrivateKeyContext::PrivateKeyContext(const PrivateKey& key)
+{
+    Botan::DataSource_Memory keyMem(key);
+    key_.reset(Botan::PKCS8::load_key(keyMem, rng_));
+}
+
+Signature RsaKeyCache::PrivateKeyContext::sign(const std::uint8_t *data, std::size_t size)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, operationGuard_);
+    if (!signer_) {
+        signer_.reset(new Botan::PK_Signer(*key_, RSA_SIGNATURE_PADDING));
+    }
+
+    auto &&signature = signer_->sign_message(data, size, rng_);
+    return Signature(signature.begin(), signature.end());
+}
+
+RsaKeyCache& RsaKeyCache::getInstance()
+{
+    static RsaKeyCache instance;
+    return instance;
+}
+
+template<typename Context, typename Key>
+std::shared_ptr<Context> RsaKeyCache::getContext(std::map<HashDigest, std::shared_ptr<Context>>& contexts, const Key& key)
+{
+    const HashDigest& hash = EndpointObjectHash(reinterpret_cast<const std::uint8_t *>(key.data()), key.size()).getHashDigest();
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, getInstance().cacheGuard_);
+        auto it = contexts.find(hash);
+        if (it != contexts.end()) {
+            return it->second;
+        }
+    }
+
+    /*
+     * Keys are parsed outside the lock. If the key is parsed concurrently, the first parsed one is kept.
+     */
+    auto context = std::make_shared<Context>(key);
+
+    KAA_MUTEX_UNIQUE_DECLARE(lock, getInstance().cacheGuard_);
+    if (contexts.size() >= MAX_CACHED_KEYS) {
+        for (auto it = contexts.begin(); it != contexts.end();) {
+            if (it->second.unique()) {
+                it = contexts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return contexts.emplace(hash, context).first->second;
+}
+
+RsaKeyCache::PublicKeyContextPtr RsaKeyCache::getPublicKey(const PublicKey& key)
+{
+    return getContext(getInstance().publicKeys_, key);
+}
+
+RsaKeyCache::PrivateKeyContextPtr RsaKeyCache::getPrivateKey(const PrivateKey& key)
+{
+    return getContext(getInstance().privateKeys_, key);
+}
+
+void RsaKeyCache::clear()
+{
+    RsaKeyCache& instance = getInstance();
+    KAA_MUTEX_UNIQUE_DECLARE(lock, instance.cacheGuard_);
+    instance.publicKeys_.clear();
+    instance.privateKeys_.clear();
+}
+
+} /* namespace kaa */
@@ -20,6 +20,8 @@
     defined(KAA_DEFAULT_OPERATION_HTTP_CHANNEL) || \
     defined(KAA_DEFAULT_LONG_POLL_CHANNEL)
 
+#include <array>
+
 namespace kaa {
 
 void HttpDataProcessor::verifyResponse(const IHttpResponse& response)
@@ -29,9 +31,18 @@ void HttpDataProcessor::verifyResponse(const IHttpResponse& response)
     }
     SharedBody rawResponse = response.getBody();
     const std::string& signature = response.getHeaderField("X-SIGNATURE");
-    boost::scoped_array<std::uint8_t> decodedSignature(new std::uint8_t[signature.length() / 3 * 4]);
-    size_t sigLength = Botan::base64_decode(decodedSignature.get(), signature);
-    if (!encDec_->verifySignature(rawResponse.first.get(), rawResponse.second, decodedSignature.get(), sigLength)) {
+
+    /*
+     * The signature is as long as the server key modulus, so it is decoded on the stack.
+     * Every 4 characters decode to at most 3 bytes.
+     */
+    std::array<std::uint8_t, MAX_SIGNATURE_SIZE + 2> decodedSignature;
+    if ((signature.length() + 3) / 4 * 3 > decodedSignature.size()) {
+        throw TransportException("Invalid signature size");
+    }
+
+    std::size_t sigLength = Botan::base64_decode(decodedSignature.data(), signature);
+    if (!encDec_->verifySignature(rawResponse.first.get(), rawResponse.second, decodedSignature.data(), sigLength)) {
         throw TransportException("Failed to verify signature");
     }
 }
@@ -60,8 +71,13 @@ std::string HttpDataProcessor::retrieveBootstrapResponse(const IHttpResponse& re
 std::shared_ptr<IHttpRequest> HttpDataProcessor::createHttpRequest(const HttpUrl& url, const std::vector<std::uint8_t>& data, bool sign)
 {
     std::shared_ptr<MultipartPostHttpRequest> post(new MultipartPostHttpRequest(url, context_));
+    /*
+     * HttpClient keeps the connection alive between requests.
+     */
+    post->setHeaderField("Connection", "Keep-Alive");
     const EncodedSessionKey& encodedSessionKey = encDec_->getEncodedSessionKey();
-    const std::string& bodyEncoded = encDec_->encodeData(data.data(), data.size());
+    std::vector<std::uint8_t> bodyEncoded(data.begin(), data.end());
+    encDec_->encodeDataInPlace(bodyEncoded);
 
     if (sign) {
         const Signature& clientSignature =
@@ -74,7 +90,7 @@ std::shared_ptr<IHttpRequest> HttpDataProcessor::createHttpRequest(const HttpUrl
     }
 
     post->setBodyField("requestKey", std::vector<std::uint8_t>(encodedSessionKey.begin(), encodedSessionKey.end()));
-    post->setBodyField("requestData", std::vector<std::uint8_t>(bodyEncoded.begin(), bodyEncoded.end()));
+    post->setBodyField("requestData", std::move(bodyEncoded));
 
     return post;
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/IoServiceExecutor.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace kaa {
+
+IoServiceExecutor::IoServiceExecutor(boost::asio::io_service& io)
+    : io_(io), tasks_(std::make_shared<Tasks>()), isShutdown_(false)
+{
+}
+
+IoServiceExecutor::~IoServiceExecutor()
+{
+    shutdownNow();
+}
+
+void IoServiceExecutor::add(const ThreadPoolTask& task)
+{
+    if (!task) {
+        throw std::invalid_argument("Null thread pool task");
+    }
+
+    if (isShutdown_) {
+        throw std::logic_error("Executor is shut down");
+    }
+
+    auto tasks = tasks_;
+    ++tasks->pendingCount_;
+
+    io_.post([tasks, task]
+        {
+            /*
+             * As in ThreadPool, awaitTermination() waits for tasks not yet started only,
+             * so a task may stop the executor it is run by.
+             */
+            --tasks->pendingCount_;
+
+            if (tasks->isCancelled_) {
+                return;
+            }
+
+            try {
+                task();
+            } catch (...) {
+                // Suppress the exception, so it doesn't escape from the I/O service run.
+            }
+        });
+}
+
+void IoServiceExecutor::awaitTermination(std::size_t seconds)
+{
+    if (!isShutdown_) {
+        throw std::logic_error("Do shutdown before");
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+
+    while (tasks_->pendingCount_ && !tasks_->isCancelled_ && std::chrono::steady_clock::now() < deadline) {
+        if (io_.stopped() || !io_.poll_one()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    shutdownNow();
+}
+
+void IoServiceExecutor::shutdown()
+{
+    isShutdown_ = true;
+}
+
+void IoServiceExecutor::shutdownNow()
+{
+    isShutdown_ = true;
+    tasks_->isCancelled_ = true;
+}
+
+} /* namespace kaa */
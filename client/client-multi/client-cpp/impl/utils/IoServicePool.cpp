@@ -0,0 +1,103 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/IoServicePool.hpp"
+
+namespace kaa {
+
+IoServicePool::IoServicePool(std::size_t size)
+    : nextIoService_(0)
+{
+    if (!size) {
+        size = std::thread::hardware_concurrency();
+        if (!size) {
+            size = 1;
+        }
+    }
+
+    ioServices_.reserve(size);
+    works_.reserve(size);
+    threads_.reserve(size);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        ioServices_.emplace_back(new boost::asio::io_service);
+        works_.emplace_back(new boost::asio::io_service::work(*ioServices_.back()));
+    }
+
+    for (auto& ioService : ioServices_) {
+        boost::asio::io_service *io = ioService.get();
+        threads_.emplace_back([io]
+            {
+                /*
+                 * A handler failure must not stop the I/O service shared by other channels.
+                 */
+                for (;;) {
+                    try {
+                        io->run();
+                        return;
+                    } catch (...) {
+                    }
+                }
+            });
+    }
+}
+
+IoServicePool::IoServicePool(PolledTag)
+    : isPolled_(true), nextIoService_(0)
+{
+    ioServices_.emplace_back(new boost::asio::io_service);
+    works_.emplace_back(new boost::asio::io_service::work(*ioServices_.back()));
+}
+
+IoServicePoolPtr IoServicePool::createPolled()
+{
+    return IoServicePoolPtr(new IoServicePool(PolledTag()));
+}
+
+IoServicePool::~IoServicePool()
+{
+    stop();
+}
+
+boost::asio::io_service& IoServicePool::getIoService()
+{
+    return *ioServices_[nextIoService_++ % ioServices_.size()];
+}
+
+void IoServicePool::stop()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, poolGuard_);
+
+    if (works_.empty()) {
+        return;
+    }
+
+    works_.clear();
+
+    for (auto& ioService : ioServices_) {
+        ioService->stop();
+    }
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    threads_.clear();
+}
+
+} /* namespace kaa */
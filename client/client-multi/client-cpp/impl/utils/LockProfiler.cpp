@@ -0,0 +1,145 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/LockProfiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+
+namespace kaa {
+
+static LockProfiler::Entry lockTable[LockProfiler::MAX_LOCK_COUNT];
+
+static bool isSameLock(const char *file1, const char *name1, const char *file2, const char *name2)
+{
+    return (file1 == file2 || !std::strcmp(file1, file2)) && (name1 == name2 || !std::strcmp(name1, name2));
+}
+
+static const char *getFileName(const char *path)
+{
+    const char *fileName = path;
+    for (const char *c = path; *c; ++c) {
+        if (*c == '/' || *c == '\\') {
+            fileName = c + 1;
+        }
+    }
+    return fileName;
+}
+
+LockProfiler::Entry& LockProfiler::getEntry(const char *file, const char *name)
+{
+    for (std::size_t i = 0; i < MAX_LOCK_COUNT - 1; ++i) {
+        auto& entry = lockTable[i];
+        int state = entry.state_.load(std::memory_order_acquire);
+
+        if (state == Entry::FREE) {
+            if (entry.state_.compare_exchange_strong(state, Entry::CLAIMED, std::memory_order_acquire)) {
+                entry.file_ = file;
+                entry.name_ = name;
+                entry.state_.store(Entry::READY, std::memory_order_release);
+                return entry;
+            }
+        }
+
+        /*
+         * Another thread is registering a lock in this entry, it may be the same one.
+         */
+        while (state == Entry::CLAIMED) {
+            std::this_thread::yield();
+            state = entry.state_.load(std::memory_order_acquire);
+        }
+
+        if (isSameLock(entry.file_, entry.name_, file, name)) {
+            return entry;
+        }
+    }
+
+    auto& overflowEntry = lockTable[MAX_LOCK_COUNT - 1];
+    int state = Entry::FREE;
+    if (overflowEntry.state_.compare_exchange_strong(state, Entry::CLAIMED, std::memory_order_acquire)) {
+        overflowEntry.file_ = "";
+        overflowEntry.name_ = "<other locks>";
+        overflowEntry.state_.store(Entry::READY, std::memory_order_release);
+    }
+    return overflowEntry;
+}
+
+std::vector<LockStatistics> LockProfiler::getStatistics()
+{
+    std::vector<LockStatistics> statistics;
+
+    for (auto& entry : lockTable) {
+        if (entry.state_.load(std::memory_order_acquire) != Entry::READY) {
+            continue;
+        }
+
+        LockStatistics lockStatistics;
+        lockStatistics.file_ = getFileName(entry.file_);
+        lockStatistics.name_ = entry.name_;
+        lockStatistics.acquisitionCount_ = entry.acquisitionCount_.load(std::memory_order_relaxed);
+        lockStatistics.contentionCount_ = entry.contentionCount_.load(std::memory_order_relaxed);
+        lockStatistics.totalWaitTimeNs_ = entry.totalWaitTimeNs_.load(std::memory_order_relaxed);
+        lockStatistics.maxWaitTimeNs_ = entry.maxWaitTimeNs_.load(std::memory_order_relaxed);
+        lockStatistics.totalHoldTimeNs_ = entry.totalHoldTimeNs_.load(std::memory_order_relaxed);
+        lockStatistics.maxHoldTimeNs_ = entry.maxHoldTimeNs_.load(std::memory_order_relaxed);
+        statistics.push_back(std::move(lockStatistics));
+    }
+
+    std::stable_sort(statistics.begin(), statistics.end(),
+                     [] (const LockStatistics& l, const LockStatistics& r)
+                         {
+                             return l.totalWaitTimeNs_ > r.totalWaitTimeNs_;
+                         });
+
+    return statistics;
+}
+
+void LockProfiler::dump(std::ostream& stream)
+{
+    stream << std::left << std::setw(48) << "lock"
+           << std::right << std::setw(12) << "acquired"
+           << std::setw(12) << "contended"
+           << std::setw(14) << "wait, us"
+           << std::setw(14) << "max wait, us"
+           << std::setw(14) << "hold, us"
+           << std::setw(14) << "max hold, us" << std::endl;
+
+    for (const auto& lock : getStatistics()) {
+        stream << std::left << std::setw(48) << (lock.file_.empty() ? lock.name_ : lock.file_ + ":" + lock.name_)
+               << std::right << std::setw(12) << lock.acquisitionCount_
+               << std::setw(12) << lock.contentionCount_
+               << std::setw(14) << lock.totalWaitTimeNs_ / 1000
+               << std::setw(14) << lock.maxWaitTimeNs_ / 1000
+               << std::setw(14) << lock.totalHoldTimeNs_ / 1000
+               << std::setw(14) << lock.maxHoldTimeNs_ / 1000 << std::endl;
+    }
+}
+
+void LockProfiler::reset()
+{
+    for (auto& entry : lockTable) {
+        entry.acquisitionCount_.store(0, std::memory_order_relaxed);
+        entry.contentionCount_.store(0, std::memory_order_relaxed);
+        entry.totalWaitTimeNs_.store(0, std::memory_order_relaxed);
+        entry.maxWaitTimeNs_.store(0, std::memory_order_relaxed);
+        entry.totalHoldTimeNs_.store(0, std::memory_order_relaxed);
+        entry.maxHoldTimeNs_.store(0, std::memory_order_relaxed);
+    }
+}
+
+} /* namespace kaa */
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/PriorityThreadPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+namespace kaa {
+
+class PriorityThreadPool::Executor : public IThreadPool {
+public:
+    Executor(PriorityThreadPool& pool, std::size_t priority)
+        : pool_(pool), priority_(priority) {}
+
+    virtual void add(const ThreadPoolTask& task) { pool_.add(priority_, task); }
+
+    virtual TaskQueueMetrics getQueueMetrics() { return pool_.getQueueMetrics(priority_); }
+
+    virtual void awaitTermination(std::size_t seconds) { pool_.awaitTermination(seconds); }
+
+    virtual void shutdown() { pool_.shutdown(); }
+    virtual void shutdownNow() { pool_.shutdownNow(); }
+
+private:
+    PriorityThreadPool&    pool_;
+    const std::size_t      priority_;
+};
+
+PriorityThreadPool::PriorityThreadPool(std::size_t priorityCount, const PrioritySchedulingSettings& settings)
+    : settings_(settings), queues_(priorityCount)
+{
+    if (!priorityCount) {
+        throw std::invalid_argument("Priority thread pool needs at least one priority");
+    }
+
+    if (!settings_.maxAgedSlice_) {
+        throw std::invalid_argument("Priority thread pool needs a non-zero aged slice");
+    }
+
+    for (std::size_t priority = 0; priority < priorityCount; ++priority) {
+        executors_.emplace_back(new Executor(*this, priority));
+    }
+}
+
+PriorityThreadPool::~PriorityThreadPool()
+{
+    shutdownNow();
+}
+
+IThreadPool& PriorityThreadPool::getExecutor(std::size_t priority)
+{
+    if (priority >= executors_.size()) {
+        throw std::out_of_range((boost::format("No executor of priority %u") % priority).str());
+    }
+
+    return *executors_[priority];
+}
+
+void PriorityThreadPool::add(std::size_t priority, const ThreadPoolTask& task)
+{
+    if (!task) {
+        throw std::invalid_argument("Null thread pool task");
+    }
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+        if (state_ == State::CREATED) {
+            start();
+        }
+
+        if (state_ != State::RUNNING) {
+            throw std::logic_error("Thread pool pending shutdown");
+        }
+
+        auto& queue = queues_[priority];
+        queue.tasks_.emplace_back(task, Clock::now());
+
+        ++queue.metrics_.addedTaskCount_;
+        if (queue.tasks_.size() > queue.metrics_.maxQueueDepth_) {
+            queue.metrics_.maxQueueDepth_ = queue.tasks_.size();
+        }
+    }
+
+    onPoolEvent_.notify_all();
+}
+
+TaskQueueMetrics PriorityThreadPool::getQueueMetrics(std::size_t priority)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+    TaskQueueMetrics metrics = queues_[priority].metrics_;
+    metrics.queueDepth_ = queues_[priority].tasks_.size();
+    return metrics;
+}
+
+bool PriorityThreadPool::hasTasks() const
+{
+    for (const auto& queue : queues_) {
+        if (!queue.tasks_.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t PriorityThreadPool::selectQueue(Clock::time_point now)
+{
+    std::size_t highest = queues_.size();
+    std::size_t selected = queues_.size();
+    std::size_t selectedPriority = 0;
+
+    for (std::size_t priority = 0; priority < queues_.size(); ++priority) {
+        const auto& tasks = queues_[priority].tasks_;
+        if (tasks.empty()) {
+            continue;
+        }
+
+        if (highest == queues_.size()) {
+            highest = priority;
+        }
+
+        std::size_t effectivePriority = priority;
+        if (settings_.agingInterval_.count()) {
+            auto promotion = static_cast<std::size_t>((now - tasks.front().addedTime_) / settings_.agingInterval_);
+            effectivePriority -= std::min(promotion, priority);
+        }
+
+        /* Of equal effective priorities the oldest task wins, so an aged task gets its turn. */
+        if (selected == queues_.size() || effectivePriority < selectedPriority ||
+                (effectivePriority == selectedPriority &&
+                 tasks.front().addedTime_ < queues_[selected].tasks_.front().addedTime_)) {
+            selected = priority;
+            selectedPriority = effectivePriority;
+        }
+    }
+
+    if (selected == highest) {
+        agedSliceCount_ = 0;
+        return highest;
+    }
+
+    if (agedSliceCount_ >= settings_.maxAgedSlice_) {
+        agedSliceCount_ = 0;
+        return highest;
+    }
+
+    ++agedSliceCount_;
+    return selected;
+}
+
+void PriorityThreadPool::run()
+{
+    while (true) {
+        ThreadPoolTask task;
+
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+            onPoolEvent_.wait(poolLock, [this] { return state_ == State::STOPPED || hasTasks(); });
+
+            if (state_ == State::STOPPED) {
+                return;
+            }
+
+            auto& tasks = queues_[selectQueue(Clock::now())].tasks_;
+            task = std::move(tasks.front().task_);
+            tasks.pop_front();
+
+            if (state_ == State::PENDING_SHUTDOWN && !hasTasks()) {
+                // To wake up awaitTermination() blocking call.
+                onPoolEvent_.notify_all();
+            }
+        }
+
+        try {
+            task();
+        } catch (...) {
+            // Just suppress an exception as
+            // it is unknown where to log this.
+        }
+    }
+}
+
+void PriorityThreadPool::start()
+{
+    worker_ = std::thread([this] { run(); });
+    state_ = State::RUNNING;
+}
+
+void PriorityThreadPool::awaitTermination(std::size_t seconds)
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(waitLock, poolGuard_);
+
+        if (state_ != State::PENDING_SHUTDOWN) {
+            throw std::logic_error("Do shutdown before");
+        }
+
+        onPoolEvent_.wait_for(waitLock, std::chrono::seconds(seconds), [this] { return !hasTasks(); });
+    }
+
+    shutdownNow();
+}
+
+void PriorityThreadPool::shutdown()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+        if (state_ == State::CREATED || state_ == State::RUNNING) {
+            state_ = State::PENDING_SHUTDOWN;
+        }
+    }
+
+    onPoolEvent_.notify_all();
+}
+
+void PriorityThreadPool::shutdownNow()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+        for (auto& queue : queues_) {
+            queue.tasks_.clear();
+        }
+        state_ = State::STOPPED;
+    }
+
+    onPoolEvent_.notify_all();
+
+    if (worker_.joinable() && worker_.get_id() != std::this_thread::get_id()) {
+        worker_.join();
+    }
+}
+
+} /* namespace kaa */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/RandomGenerator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <exception>
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+static std::atomic<std::uint64_t> seedCounter(0);
+
+/*
+ * SplitMix64 step, used to spread a seed over the generator state.
+ */
+static std::uint64_t splitMix(std::uint64_t& x)
+{
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+RandomGenerator::RandomGenerator(std::uint64_t seed)
+{
+    for (auto& word : state_) {
+        word = splitMix(seed);
+    }
+}
+
+RandomGenerator& RandomGenerator::getThreadGenerator()
+{
+    static kaa_thread_local RandomGenerator generator(generateSeed());
+    return generator;
+}
+
+std::uint64_t RandomGenerator::generateSeed()
+{
+    std::uint64_t counter = seedCounter.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t seed = splitMix(counter);
+
+    seed ^= static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    try {
+        std::random_device device;
+        seed ^= (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    } catch (const std::exception&) {
+        // The counter and the time still make seeds distinct.
+    }
+
+    return seed;
+}
+
+} /* namespace kaa */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kaa/utils/SyncTracer.hpp"
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+std::atomic<ISyncTraceExporter *> SyncTracer::exporter_(nullptr);
+
+static kaa_thread_local std::int32_t currentRequestId = 0;
+
+void SyncTracer::setExporter(ISyncTraceExporter *exporter)
+{
+    exporter_.store(exporter, std::memory_order_release);
+}
+
+void SyncTracer::record(const SyncTraceSpan& span)
+{
+    auto exporter = exporter_.load(std::memory_order_acquire);
+    if (exporter) {
+        exporter->onSpan(span);
+    }
+}
+
+void SyncTracer::setCurrentRequestId(std::int32_t requestId)
+{
+    currentRequestId = requestId;
+}
+
+std::int32_t SyncTracer::getCurrentRequestId()
+{
+    return currentRequestId;
+}
+
+const char *SyncTracer::toString(SyncTraceStage stage)
+{
+    switch (stage) {
+        case SyncTraceStage::QUEUE:
+            return "queue";
+        case SyncTraceStage::COMPILE:
+            return "compile";
+        case SyncTraceStage::ENCRYPT:
+            return "encrypt";
+        case SyncTraceStage::NETWORK:
+            return "network";
+        case SyncTraceStage::DECRYPT:
+            return "decrypt";
+        case SyncTraceStage::PROCESS:
+            return "process";
+        default:
+            return "unknown";
+    }
+}
+
+} /* namespace kaa */
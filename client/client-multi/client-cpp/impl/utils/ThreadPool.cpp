@@ -18,11 +18,17 @@
 
 #include <chrono>
 #include <stdexcept>
+#include <utility>
 
 namespace kaa {
 
-ThreadPool::ThreadPool(std::size_t workerCount)
-    : workerCount_(workerCount)
+static kaa_thread_local const ThreadPool *currentPool = nullptr;
+
+ThreadPool::ThreadPool(std::size_t workerCount, const ThreadPoolWorkerInitializer& workerInitializer,
+                       const TaskQueueSettings& queueSettings)
+    : workerCount_(workerCount), workerInitializer_(workerInitializer),
+      tasks_(queueSettings.capacity_ ? queueSettings.capacity_ : RingQueue<PendingTask>::DEFAULT_CAPACITY),
+      queueSettings_(queueSettings)
 {
     if (!workerCount_) {
         throw std::invalid_argument((boost::format("Wrong thread pool worker count %u") % workerCount_).str());
@@ -35,6 +41,21 @@ ThreadPool::~ThreadPool()
 }
 
 void ThreadPool::add(const ThreadPoolTask& task)
+{
+    doAdd(nullptr, ThreadPoolTask(task));
+}
+
+void ThreadPool::addMoved(ThreadPoolTask&& task)
+{
+    doAdd(nullptr, std::move(task));
+}
+
+void ThreadPool::addCoalescing(TaskCoalescingKey key, const ThreadPoolTask& task)
+{
+    doAdd(key, ThreadPoolTask(task));
+}
+
+void ThreadPool::doAdd(TaskCoalescingKey key, ThreadPoolTask&& task)
 {
     if (!task) {
         throw std::invalid_argument("Null thread pool task");
@@ -51,12 +72,65 @@ void ThreadPool::add(const ThreadPoolTask& task)
             throw std::logic_error("Thread pool pending shutdown");
         }
 
-        tasks_.push_back(task);
+        bool isCoalescing = (key && queueSettings_.overflowPolicy_ == TaskOverflowPolicy::COALESCE);
+        if (isCoalescing) {
+            auto it = coalescingTasks_.find(key);
+            if (it != coalescingTasks_.end()) {
+                tasks_.at(it->second).task_ = std::move(task);
+                ++queueMetrics_.coalescedTaskCount_;
+                return;
+            }
+        }
+
+        if (queueSettings_.capacity_ && tasks_.size() >= queueSettings_.capacity_ && currentPool != this) {
+            makeRoom(tasksLock);
+        }
+
+        auto sequence = tasks_.push(PendingTask(isCoalescing ? key : nullptr, std::move(task)));
+        if (isCoalescing) {
+            coalescingTasks_[key] = sequence;
+        }
+
+        ++queueMetrics_.addedTaskCount_;
+        if (tasks_.size() > queueMetrics_.maxQueueDepth_) {
+            queueMetrics_.maxQueueDepth_ = tasks_.size();
+        }
     }
 
     onThreadpoolEvent_.notify_one();
 }
 
+void ThreadPool::makeRoom(KAA_MUTEX_UNIQUE& tasksLock)
+{
+    if (queueSettings_.overflowPolicy_ == TaskOverflowPolicy::DROP_OLDEST) {
+        if (tasks_.front().key_) {
+            coalescingTasks_.erase(tasks_.front().key_);
+        }
+        tasks_.pop();
+        ++queueMetrics_.droppedTaskCount_;
+        return;
+    }
+
+    ++queueMetrics_.blockedAddCount_;
+    onTaskTaken_.wait(tasksLock, [this]
+        {
+            return state_ != State::RUNNING || tasks_.size() < queueSettings_.capacity_;
+        });
+
+    if (state_ != State::RUNNING) {
+        throw std::logic_error("Thread pool pending shutdown");
+    }
+}
+
+TaskQueueMetrics ThreadPool::getQueueMetrics()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+
+    TaskQueueMetrics metrics = queueMetrics_;
+    metrics.queueDepth_ = tasks_.size();
+    return metrics;
+}
+
 void ThreadPool::awaitTermination(std::size_t seconds)
 {
     {
@@ -91,8 +165,19 @@ void ThreadPool::shutdownNow()
 void ThreadPool::start()
 {
     for (std::size_t i = 0; i < workerCount_; ++i) {
-        workers_.emplace_back([this]()
+        workers_.emplace_back([this, i]()
             {
+                currentPool = this;
+
+                if (workerInitializer_) {
+                    try {
+                        workerInitializer_(i);
+                    } catch (...) {
+                        // Just suppress an exception as
+                        // it is unknown where to log this.
+                    }
+                }
+
                 while (true) {
                     ThreadPoolTask task;
 
@@ -110,8 +195,15 @@ void ThreadPool::start()
                             return;
                         }
 
-                        task = std::move(tasks_.front());
-                        tasks_.pop_front();
+                        task = std::move(tasks_.front().task_);
+                        if (tasks_.front().key_) {
+                            coalescingTasks_.erase(tasks_.front().key_);
+                        }
+                        tasks_.pop();
+
+                        if (queueSettings_.capacity_) {
+                            onTaskTaken_.notify_one();
+                        }
 
                         if (state_ == State::PENDING_SHUTDOWN && tasks_.empty()) {
                             // To wake up awaitTermination() blocking call.
@@ -141,6 +233,7 @@ void ThreadPool::stop()
     }
 
     onThreadpoolEvent_.notify_all();
+    onTaskTaken_.notify_all();
 }
 
 void ThreadPool::forceStop()
@@ -149,10 +242,12 @@ void ThreadPool::forceStop()
         KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
 
         tasks_.clear();
+        coalescingTasks_.clear();
         state_ = State::STOPPED;
     }
 
     onThreadpoolEvent_.notify_all();
+    onTaskTaken_.notify_all();
 }
 
 void ThreadPool::waitForWorkersShutdown()
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/ThreadSettings.hpp"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+static const std::size_t MAX_THREAD_NAME_LENGTH = 15;
+
+static const int MIN_NICE_VALUE = -20;
+static const int MAX_NICE_VALUE = 19;
+
+#ifdef __linux__
+
+static int toNativePolicy(ThreadSchedulingPolicy policy)
+{
+    switch (policy) {
+        case ThreadSchedulingPolicy::BATCH:
+            return SCHED_BATCH;
+        case ThreadSchedulingPolicy::IDLE:
+            return SCHED_IDLE;
+        case ThreadSchedulingPolicy::FIFO:
+            return SCHED_FIFO;
+        case ThreadSchedulingPolicy::ROUND_ROBIN:
+            return SCHED_RR;
+        default:
+            return SCHED_OTHER;
+    }
+}
+
+static bool isRealTimePolicy(ThreadSchedulingPolicy policy)
+{
+    return policy == ThreadSchedulingPolicy::FIFO || policy == ThreadSchedulingPolicy::ROUND_ROBIN;
+}
+
+void validateThreadSettings(const ThreadSettings& settings)
+{
+    for (auto cpu : settings.cpus_) {
+        if (cpu >= CPU_SETSIZE) {
+            throw KaaException(boost::format("Unknown CPU %u") % cpu);
+        }
+    }
+
+    if (isRealTimePolicy(settings.policy_)) {
+        int nativePolicy = toNativePolicy(settings.policy_);
+        if (settings.priority_ < sched_get_priority_min(nativePolicy) ||
+            settings.priority_ > sched_get_priority_max(nativePolicy))
+        {
+            throw KaaException(boost::format("Real-time priority %d is out of range %d..%d")
+                                    % settings.priority_
+                                    % sched_get_priority_min(nativePolicy)
+                                    % sched_get_priority_max(nativePolicy));
+        }
+    } else if (settings.policy_ == ThreadSchedulingPolicy::OTHER || settings.policy_ == ThreadSchedulingPolicy::BATCH) {
+        if (settings.priority_ < MIN_NICE_VALUE || settings.priority_ > MAX_NICE_VALUE) {
+            throw KaaException(boost::format("Nice value %d is out of range %d..%d")
+                                    % settings.priority_ % MIN_NICE_VALUE % MAX_NICE_VALUE);
+        }
+    }
+}
+
+bool applyThreadSettings(const ThreadSettings& settings, std::size_t workerIndex)
+{
+    bool isApplied = true;
+
+    if (!settings.name_.empty()) {
+        std::string name = settings.name_ + std::to_string(workerIndex);
+        if (name.size() > MAX_THREAD_NAME_LENGTH) {
+            name = settings.name_.substr(0, MAX_THREAD_NAME_LENGTH - std::to_string(workerIndex).size()) +
+                   std::to_string(workerIndex);
+        }
+        isApplied &= !pthread_setname_np(pthread_self(), name.c_str());
+    }
+
+    if (!settings.cpus_.empty()) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (auto cpu : settings.cpus_) {
+            CPU_SET(cpu, &cpuSet);
+        }
+        isApplied &= !pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    }
+
+    if (settings.policy_ != ThreadSchedulingPolicy::INHERIT) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        if (isRealTimePolicy(settings.policy_)) {
+            param.sched_priority = settings.priority_;
+        }
+
+        isApplied &= !pthread_setschedparam(pthread_self(), toNativePolicy(settings.policy_), &param);
+
+        if (settings.policy_ == ThreadSchedulingPolicy::OTHER || settings.policy_ == ThreadSchedulingPolicy::BATCH) {
+            // On Linux nice values are per thread.
+            pid_t threadId = static_cast<pid_t>(syscall(SYS_gettid));
+            isApplied &= !setpriority(PRIO_PROCESS, threadId, settings.priority_);
+        }
+    }
+
+    return isApplied;
+}
+
+#else
+
+void validateThreadSettings(const ThreadSettings& settings)
+{
+    if (settings.policy_ == ThreadSchedulingPolicy::OTHER || settings.policy_ == ThreadSchedulingPolicy::BATCH) {
+        if (settings.priority_ < MIN_NICE_VALUE || settings.priority_ > MAX_NICE_VALUE) {
+            throw KaaException(boost::format("Nice value %d is out of range %d..%d")
+                                    % settings.priority_ % MIN_NICE_VALUE % MAX_NICE_VALUE);
+        }
+    }
+}
+
+bool applyThreadSettings(const ThreadSettings& settings, std::size_t workerIndex)
+{
+    return settings.cpus_.empty() && settings.name_.empty() && settings.policy_ == ThreadSchedulingPolicy::INHERIT;
+}
+
+#endif
+
+} /* namespace kaa */
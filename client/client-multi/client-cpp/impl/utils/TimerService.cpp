@@ -0,0 +1,195 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/TimerService.hpp"
+
+#include <stdexcept>
+
+namespace kaa {
+
+TimerService& TimerService::getInstance()
+{
+    /*
+     * Never destroyed: timers owned by static objects may be stopped after static destructors have run.
+     * The service thread just stays blocked until the process exits.
+     */
+    static TimerService *instance = new TimerService;
+    return *instance;
+}
+
+TimerService::TimerHandle TimerService::schedule(Clock::time_point deadline, const Callback& callback, const void *owner)
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+#ifndef KAA_USE_SINGLE_THREAD
+    if (!isPolled_ && serviceThreadId_ == std::thread::id()) {
+        startThread();
+    }
+#endif
+
+    TimerHandle handle(deadline, ++nextTimerId_);
+    bool isEarliest = timers_.empty() || handle < timers_.begin()->first;
+    timers_.emplace(handle, Timer{callback, owner});
+
+    if (isEarliest) {
+        if (isPolled_) {
+            Callback onEarliestChanged = onEarliestChanged_;
+            serviceLock.unlock();
+            if (onEarliestChanged) {
+                onEarliestChanged();
+            }
+        } else {
+            onTimersChanged_.notify_one();
+        }
+    }
+
+    return handle;
+}
+
+bool TimerService::cancel(const TimerHandle& handle)
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+    return timers_.erase(handle);
+}
+
+void TimerService::waitForCallbacks(const void *owner)
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+    if (std::this_thread::get_id() == callbackThreadId_) {
+        return;
+    }
+
+    onCallbackFinished_.wait(serviceLock, [this, owner]
+        {
+            return !isCallbackRunning_ || runningOwner_ != owner;
+        });
+}
+
+bool TimerService::attachPoller(const Callback& onEarliestChanged)
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+    if (isPolled_ || serviceThreadId_ != std::thread::id()) {
+        return false;
+    }
+
+    isPolled_ = true;
+    onEarliestChanged_ = onEarliestChanged;
+    return true;
+}
+
+void TimerService::detachPoller()
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+    if (!isPolled_) {
+        return;
+    }
+
+    isPolled_ = false;
+    onEarliestChanged_ = nullptr;
+
+#ifndef KAA_USE_SINGLE_THREAD
+    if (!timers_.empty()) {
+        startThread();
+    }
+#endif
+}
+
+std::size_t TimerService::runExpired()
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+    if (!isPolled_) {
+        throw std::logic_error("Timer service is run by its own thread");
+    }
+
+    /*
+     * Timers rescheduled by callbacks for now are left to the next call.
+     */
+    const auto now = Clock::now();
+    std::size_t count = 0;
+
+    while (isPolled_ && !timers_.empty() && timers_.begin()->first.first <= now) {
+        runCallback(serviceLock, timers_.begin());
+        ++count;
+    }
+
+    return count;
+}
+
+TimerService::Clock::time_point TimerService::getNextDeadline()
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+    return timers_.empty() ? Clock::time_point::max() : timers_.begin()->first.first;
+}
+
+void TimerService::startThread()
+{
+    std::thread serviceThread([this] { run(); });
+    serviceThreadId_ = serviceThread.get_id();
+    serviceThread.detach();
+}
+
+void TimerService::run()
+{
+    std::unique_lock<std::mutex> serviceLock(serviceGuard_);
+
+    while (true) {
+        if (timers_.empty()) {
+            onTimersChanged_.wait(serviceLock);
+            continue;
+        }
+
+        auto it = timers_.begin();
+        if (Clock::now() < it->first.first) {
+            onTimersChanged_.wait_until(serviceLock, it->first.first);
+            continue;
+        }
+
+        runCallback(serviceLock, it);
+    }
+}
+
+void TimerService::runCallback(std::unique_lock<std::mutex>& serviceLock, Timers::iterator it)
+{
+    Callback callback = std::move(it->second.callback_);
+    runningOwner_ = it->second.owner_;
+    isCallbackRunning_ = true;
+    callbackThreadId_ = std::this_thread::get_id();
+    timers_.erase(it);
+
+    serviceLock.unlock();
+
+    try {
+        callback();
+    } catch (...) {
+        // Just suppress an exception as
+        // it is unknown where to log this.
+    }
+
+    // Releases the resources captured by the callback outside the lock.
+    callback = nullptr;
+
+    serviceLock.lock();
+
+    isCallbackRunning_ = false;
+    callbackThreadId_ = std::thread::id();
+    onCallbackFinished_.notify_all();
+}
+
+} /* namespace kaa */
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kaa/utils/WorkStealingThreadPool.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+namespace kaa {
+
+const std::size_t WorkStealingThreadPool::DEFAULT_WORKER_NUMBER;
+const std::size_t WorkStealingThreadPool::IDLE_SPIN_COUNT;
+const std::size_t WorkStealingThreadPool::INITIAL_QUEUE_CAPACITY;
+
+/*
+ * The pool and the queue index of the worker running on the current thread.
+ */
+static kaa_thread_local const WorkStealingThreadPool *currentPool = nullptr;
+static kaa_thread_local std::size_t currentWorkerIndex = 0;
+
+/*
+ * FIFO ring buffer of task slots. Slots are reused, so it allocates only when it grows.
+ */
+class WorkStealingThreadPool::TaskQueue {
+public:
+    explicit TaskQueue(std::size_t capacity) : slots_(capacity) {}
+
+    void push(const ThreadPoolTask& task)
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queueGuard_);
+        if (size_ == slots_.size()) {
+            grow();
+        }
+
+        slots_[(head_ + size_) % slots_.size()] = task;
+        ++size_;
+    }
+
+    bool pop(ThreadPoolTask& task)
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queueGuard_);
+        return popLocked(task);
+    }
+
+    /*
+     * Doesn't wait for the queue owner, another queue is tried instead.
+     */
+    bool tryPop(ThreadPoolTask& task)
+    {
+        KAA_MUTEX_UNIQUE queueLock(queueGuard_, std::try_to_lock);
+        return queueLock.owns_lock() && popLocked(task);
+    }
+
+    std::size_t clear()
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(queueLock, queueGuard_);
+        std::size_t count = size_;
+        ThreadPoolTask task;
+        while (popLocked(task)) {}
+        return count;
+    }
+
+private:
+    bool popLocked(ThreadPoolTask& task)
+    {
+        if (!size_) {
+            return false;
+        }
+
+        task = std::move(slots_[head_]);
+        slots_[head_] = nullptr;
+        head_ = (head_ + 1) % slots_.size();
+        --size_;
+        return true;
+    }
+
+    void grow()
+    {
+        std::vector<ThreadPoolTask> slots(slots_.size() * 2);
+        for (std::size_t i = 0; i < size_; ++i) {
+            slots[i] = std::move(slots_[(head_ + i) % slots_.size()]);
+        }
+
+        slots_.swap(slots);
+        head_ = 0;
+    }
+
+private:
+    std::vector<ThreadPoolTask>    slots_;
+    std::size_t                    head_ = 0;
+    std::size_t                    size_ = 0;
+
+    KAA_MUTEX_DECLARE(queueGuard_);
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(std::size_t workerCount, const ThreadPoolWorkerInitializer& workerInitializer)
+    : state_(State::CREATED), workerCount_(workerCount), workerInitializer_(workerInitializer), nextQueue_(0), pendingTaskCount_(0), parkedWorkerCount_(0)
+{
+    if (!workerCount_) {
+        throw std::invalid_argument((boost::format("Wrong thread pool worker count %u") % workerCount_).str());
+    }
+
+    queues_.reserve(workerCount_);
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        queues_.emplace_back(new TaskQueue(INITIAL_QUEUE_CAPACITY));
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    shutdownNow();
+}
+
+void WorkStealingThreadPool::add(const ThreadPoolTask& task)
+{
+    if (!task) {
+        throw std::invalid_argument("Null thread pool task");
+    }
+
+    if (state_ == State::CREATED) {
+        KAA_MUTEX_UNIQUE_DECLARE(startLock, threadPoolGuard_);
+        if (state_ == State::CREATED) {
+            start();
+        }
+    }
+
+    if (state_ != State::RUNNING) {
+        throw std::logic_error("Thread pool pending shutdown");
+    }
+
+    std::size_t queueIndex = (currentPool == this) ? currentWorkerIndex : nextQueue_++ % workerCount_;
+
+    /*
+     * Counted before the task becomes visible, so a worker never parks while there is a task to take.
+     */
+    ++pendingTaskCount_;
+    queues_[queueIndex]->push(task);
+
+    if (parkedWorkerCount_) {
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(parkLock, threadPoolGuard_);
+        }
+        onTaskAdded_.notify_one();
+    }
+}
+
+void WorkStealingThreadPool::awaitTermination(std::size_t seconds)
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(waitLock, threadPoolGuard_);
+
+        if (state_ != State::PENDING_SHUTDOWN) {
+            throw std::logic_error("Do shutdown before");
+        }
+
+        onTasksTaken_.wait_for(waitLock,
+                               std::chrono::seconds(seconds),
+                               [this]
+                                   {
+                                       return !pendingTaskCount_;
+                                   });
+    }
+
+    shutdownNow();
+}
+
+void WorkStealingThreadPool::shutdown()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(stateLock, threadPoolGuard_);
+        state_ = State::PENDING_SHUTDOWN;
+    }
+
+    onTaskAdded_.notify_all();
+}
+
+void WorkStealingThreadPool::shutdownNow()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(stateLock, threadPoolGuard_);
+        state_ = State::STOPPED;
+
+        for (auto& queue : queues_) {
+            pendingTaskCount_ -= queue->clear();
+        }
+    }
+
+    onTaskAdded_.notify_all();
+    onTasksTaken_.notify_all();
+
+    waitForWorkersShutdown();
+}
+
+void WorkStealingThreadPool::start()
+{
+    workers_.reserve(workerCount_);
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        workers_.emplace_back(&WorkStealingThreadPool::run, this, i);
+    }
+
+    state_ = State::RUNNING;
+}
+
+void WorkStealingThreadPool::run(std::size_t workerIndex)
+{
+    currentPool = this;
+    currentWorkerIndex = workerIndex;
+
+    if (workerInitializer_) {
+        try {
+            workerInitializer_(workerIndex);
+        } catch (...) {
+            // Just suppress an exception as
+            // it is unknown where to log this.
+        }
+    }
+
+    ThreadPoolTask task;
+    std::size_t idleSpins = 0;
+
+    while (true) {
+        if (takeTask(workerIndex, task)) {
+            idleSpins = 0;
+
+            try {
+                task();
+            } catch (...) {
+                // Just suppress an exception as
+                // it is unknown where to log this.
+            }
+
+            // Releases the resources captured by the task.
+            task = nullptr;
+            continue;
+        }
+
+        if (state_ == State::STOPPED) {
+            return;
+        }
+
+        if (++idleSpins < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+        } else {
+            idleSpins = 0;
+            park();
+        }
+    }
+}
+
+bool WorkStealingThreadPool::takeTask(std::size_t workerIndex, ThreadPoolTask& task)
+{
+    if (queues_[workerIndex]->pop(task)) {
+        onTaskTaken();
+        return true;
+    }
+
+    for (std::size_t i = 1; i < workerCount_; ++i) {
+        if (queues_[(workerIndex + i) % workerCount_]->tryPop(task)) {
+            onTaskTaken();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingThreadPool::park()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(parkLock, threadPoolGuard_);
+
+    ++parkedWorkerCount_;
+    onTaskAdded_.wait(parkLock,
+                      [this]
+                          {
+                              return state_ == State::STOPPED || pendingTaskCount_;
+                          });
+    --parkedWorkerCount_;
+}
+
+void WorkStealingThreadPool::onTaskTaken()
+{
+    if (!--pendingTaskCount_ && state_ == State::PENDING_SHUTDOWN) {
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(waitLock, threadPoolGuard_);
+        }
+        // To wake up awaitTermination() blocking call.
+        onTasksTaken_.notify_all();
+    }
+}
+
+void WorkStealingThreadPool::waitForWorkersShutdown()
+{
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+} /* namespace kaa */
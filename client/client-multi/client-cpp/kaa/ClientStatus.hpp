@@ -19,7 +19,11 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <istream>
 #include <memory>
 #include <boost/bimap.hpp>
 
@@ -28,12 +32,14 @@
 #include "kaa/common/EndpointObjectHash.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
 #include "kaa/IKaaClientContext.hpp"
+#include "kaa/utils/KaaTimer.hpp"
 
 namespace kaa {
 
 /* Fwd declarations */
 enum class ClientParameterT;
 class IPersistentParameter;
+class BinaryReader;
 
 typedef boost::bimaps::bimap<
           boost::bimaps::set_of<ClientParameterT>   /* Client parameter type */
@@ -44,10 +50,11 @@ typedef boost::bimaps::bimap<
 class ClientStatus : public IKaaClientStateStorage {
 public:
     ClientStatus(IKaaClientContext& context);
-    ~ClientStatus() { }
+    ~ClientStatus();
 
     std::int32_t getEventSequenceNumber() const;
     void setEventSequenceNumber(std::int32_t sequenceNumber);
+    std::int32_t reserveEventSequenceNumbers(std::int32_t count);
 
     bool isRegistered() const;
     void setRegistered(bool isRegistered);
@@ -77,16 +84,49 @@ public:
     void setTopicStates(const TopicStates& subscriptions);
     TopicStates& getTopicStates();
 
+    TopicSequenceWindows getTopicSequenceWindows() const;
+    void setTopicSequenceWindows(const TopicSequenceWindows& windows);
+
+    UnicastNotificationHashes getUnicastNotificationHashes() const;
+    void setUnicastNotificationHashes(const UnicastNotificationHashes& hashes);
+
     virtual bool isSDKPropertiesUpdated() const { return isSDKPropertiesForUpdated_; }
 
     virtual bool isProfileResyncNeeded() const;
     virtual void setProfileResyncNeeded(bool isNeeded);
 
+    virtual std::int32_t getKeepAliveInterval() const;
+    virtual void setKeepAliveInterval(std::int32_t interval);
+
+    virtual std::string getOperationsServers() const;
+    virtual void setOperationsServers(const std::string& servers);
+
     void read();
+
+    /**
+     * Saves the state. If the state save delay is set, the save is deferred
+     * and coalesced with the other saves requested within the delay.
+     */
     void save();
+    void flush();
 
 private:
     void checkSDKPropertiesForUpdates();
+    void markDirty(ClientParameterT type);
+
+    void loadHotParameters();
+    void storeHotParameters();
+    void onHotParameterChanged() { hotGeneration_.fetch_add(1, std::memory_order_release); }
+
+    void readText(std::istream& stateFile);
+    void readBinary(const std::string& content);
+    void applyRecord(std::uint8_t key, BinaryReader& reader);
+
+    void saveText();
+    void saveBinary();
+    bool appendJournal();
+    bool compactJournal();
+
     /* Helpers */
     template< ClientParameterT Type, class ParameterData >
     void setParameterData(const ParameterData& data);
@@ -107,6 +147,30 @@ private:
 
     IKaaClientContext &context_;
 
+    const bool                                  isBinaryFormat_;
+    const std::chrono::milliseconds             saveDelay_;
+
+    /* Binary format only: what is to be appended to the journal on the next save. */
+    std::set<ClientParameterT>                  dirtyParameters_;
+    TopicStates                                 persistedTopicStates_;
+    std::size_t                                 journalSize_;
+    std::size_t                                 snapshotSize_;
+    bool                                        needsCompaction_;
+
+    /*
+     * The parameters read or updated on every sync aren't guarded by the status lock. Each change
+     * bumps the generation, and the changed values are copied to the parameters by the next save.
+     */
+    std::atomic<std::int32_t>                   eventSeqNumber_;
+    std::atomic<bool>                           isRegistered_;
+    std::atomic<bool>                           isAttached_;
+    std::atomic<std::uint64_t>                  hotGeneration_;
+    std::uint64_t                               savedHotGeneration_;
+
+    KAA_R_MUTEX_MUTABLE_DECLARE(statusGuard_);
+
+    /* Declared last: its callback may refer to the other members. */
+    KaaTimer<void ()>                           saveTimer_;
 
     static const bimap                      parameterToToken_;
     static const std::int32_t               eventSeqNumberDefault_;
@@ -118,6 +182,10 @@ private:
     static const bool                       endpointDefaultAttachStatus_;
     static const std::string                endpointKeyHashDefault_;
     static const bool                       isProfileResyncNeededDefault_;
+    static const std::int32_t               keepAliveIntervalDefault_;
+    static const std::string                operationsServersDefault_;
+    static const TopicSequenceWindows       topicSequenceWindowsDefault_;
+    static const UnicastNotificationHashes  unicastNotificationHashesDefault_;
 };
 
 }
@@ -17,29 +17,41 @@
 #ifndef IKAACLIENT_HPP_
 #define IKAACLIENT_HPP_
 
+#include <chrono>
+#include <cstddef>
 #include <future>
 
 #include "kaa/profile/IProfileContainer.hpp"
 #include "kaa/notification/INotificationTopicListListener.hpp"
 #include "kaa/notification/gen/NotificationDefinitions.hpp"
 #include "kaa/notification/INotificationListener.hpp"
+#include "kaa/notification/IRawNotificationListener.hpp"
 #include "kaa/configuration/storage/IConfigurationStorage.hpp"
 #include "kaa/configuration/gen/ConfigurationDefinitions.hpp"
 #include "kaa/event/registration/IAttachEndpointCallback.hpp"
 #include "kaa/event/registration/IDetachEndpointCallback.hpp"
+#include "kaa/event/registration/IAttachEndpointsCallback.hpp"
+#include "kaa/event/registration/IDetachEndpointsCallback.hpp"
 #include "kaa/event/registration/IUserAttachCallback.hpp"
 #include "kaa/event/registration/IAttachStatusListener.hpp"
 #include "kaa/event/IFetchEventListeners.hpp"
+#include "kaa/event/EventBatchingSettings.hpp"
 #include "kaa/log/ILogCollector.hpp"
 #include "kaa/failover/IFailoverStrategy.hpp"
+#include "kaa/failover/IServerSelectionStrategy.hpp"
+#include "kaa/channel/ChannelMetrics.hpp"
+#include "kaa/channel/BandwidthShaper.hpp"
+#include "kaa/utils/MemoryUsage.hpp"
 #include "kaa/log/ILogDeliveryListener.hpp"
 #include "kaa/log/RecordFuture.hpp"
+#include "kaa/log/RecordBatch.hpp"
 #include "kaa/IKaaClientContext.hpp"
 
 
 namespace kaa {
 
 class EventFamilyFactory;
+class IEventManager;
 class IKaaChannelManager;
 class IKaaDataMultiplexer;
 class IKaaDataDemultiplexer;
@@ -68,6 +80,9 @@ public:
 
     /**
      * @brief Pauses Kaa's workflow.
+     *
+     * Closes the connection to the Operations server unless the warm pause is enabled,
+     * see @c KaaClientProperties::setWarmPause().
      */
     virtual void pause() = 0;
 
@@ -76,6 +91,19 @@ public:
      */
     virtual void resume() = 0;
 
+    /**
+     * @brief Runs the client work (timers, executor tasks, channel I/O) on the calling thread.
+     *
+     * Handles the events ready now, if there are none, waits for them at most for the timeout.
+     * Call regularly, e.g. from the application event loop, if the client is created with
+     * @link PollingExecutorContext @endlink, which starts no threads.
+     *
+     * @return The number of events handled, zero if the timeout has expired.
+     *
+     * @throw KaaException The client doesn't use a polling executor context.
+     */
+    virtual std::size_t poll(std::chrono::milliseconds timeout) = 0;
+
     /**
      * @brief Sets profile container implemented by the user.
      *
@@ -98,6 +126,14 @@ public:
      */
     virtual EventFamilyFactory& getEventFamilyFactory() = 0;
 
+    /**
+     * @brief Retrieves the event manager, which sends events of any class by FQN without the generated
+     * event families, e.g. for load testing tools.
+     *
+     * @throw KaaException The event subsystem is disabled.
+     */
+    virtual IEventManager& getEventManager() = 0;
+
     /**
      * @brief Adds the listener which receives updates on the list of available topics.
      *
@@ -170,6 +206,51 @@ public:
      */
     virtual void removeNotificationListener(std::int64_t topicId, INotificationListener& listener) = 0;
 
+    /**
+     * @brief Adds the listener which receives Avro-encoded notifications on all available topics.
+     *
+     * Raw listeners are notified before typed ones. The notification is decoded at most once per
+     * dispatch and only if a typed listener exists or a raw listener accesses its fields.
+     *
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void addRawNotificationListener(IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Adds the listener which receives Avro-encoded notifications on the specified topic.
+     *
+     * @param[in] topicId     The id of the topic (either mandatory or optional).
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @throw UnavailableTopicException Throws if the unknown topic id is provided.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void addRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Removes the listener which receives Avro-encoded notifications on all available topics.
+     *
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void removeRawNotificationListener(IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Removes the listener which receives Avro-encoded notifications on the specified topic.
+     *
+     * @param[in] topicId     The id of topic (either mandatory or optional).
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @throw UnavailableTopicException Throws if the unknown topic id is provided.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void removeRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) = 0;
+
     /**
      * @brief Subscribes to the specified optional topic to receive notifications on that topic.
      *
@@ -275,6 +356,14 @@ public:
      */
     virtual const KaaRootConfiguration& getConfiguration() = 0;
 
+    /**
+     * Returns the immutable copy of the current configuration tree, which may be read concurrently
+     * with configuration updates. It is taken without locking.
+     *
+     * @return The current configuration tree.
+     */
+    virtual std::shared_ptr<const KaaRootConfiguration> getConfigurationSnapshot() = 0;
+
     /**
      * Registers new configuration persistence routines. Replaces previously set value.
      * Memory pointed by given parameter should be managed by user.
@@ -310,6 +399,36 @@ public:
     virtual void detachEndpoint(const std::string&  endpointKeyHash
                                , IDetachEndpointCallbackPtr listener = IDetachEndpointCallbackPtr()) = 0;
 
+    /**
+     * @brief Attaches the specified endpoints to the user to which the current endpoint is attached.
+     *
+     * All endpoints are sent in one sync request, which is much faster than attaching them one by one.
+     *
+     * @param[in] endpointAccessTokens    The access tokens of the endpoints to be attached to the user.
+     * @param[in] listener                The optional listener to notify once all endpoints are processed.
+     *
+     * @throw BadCredentials                One of the endpoint access tokens is empty. Nothing is attached then.
+     * @throw TransportNotFoundException    The Kaa SDK isn't fully initialized.
+     * @throw KaaException                  Some other failure has happened.
+     */
+    virtual void attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                                , IAttachEndpointsCallbackPtr listener = IAttachEndpointsCallbackPtr()) = 0;
+
+    /**
+     * @brief Detaches the specified endpoints from the user to which the current endpoint is attached.
+     *
+     * All endpoints are sent in one sync request.
+     *
+     * @param[in] endpointKeyHashes    The key hashes of the endpoints to be detached from the user.
+     * @param[in] listener             The optional listener to notify once all endpoints are processed.
+     *
+     * @throw BadCredentials                One of the endpoint key hashes is empty. Nothing is detached then.
+     * @throw TransportNotFoundException    The Kaa SDK isn't fully initialized.
+     * @throw KaaException                  Some other failure has happened.
+     */
+    virtual void detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                                , IDetachEndpointsCallbackPtr listener = IDetachEndpointsCallbackPtr()) = 0;
+
     /**
      * @brief Attaches the current endpoint to the specifier user. The user verification is carried out by the default verifier.
      *
@@ -357,6 +476,31 @@ public:
      */
     virtual std::int32_t findEventListeners(const std::list<std::string>& eventFQNs, IFetchEventListenersPtr listener) = 0;
 
+    /**
+     * @brief Sets how events produced outside transactions are grouped into syncs.
+     *
+     * Batching cuts the number of syncs and, with coalescing, the payload during event bursts
+     * at the cost of the delivery latency bounded by the batch window.
+     *
+     * @param settings    The batching settings. Default settings send each event at once.
+     *
+     * @see EventBatchingSettings
+     */
+    virtual void setEventBatchingSettings(const EventBatchingSettings& settings) = 0;
+
+    /**
+     * @brief Sets the storage for outgoing events which exceed the given number of events kept in memory.
+     *
+     * Stored events are sent after resident ones, one storage bucket per sync. A persistent storage,
+     * e.g. @c MMapSegmentLogStorage, keeps them across restarts.
+     *
+     * @param storage              The storage. @c nullptr keeps all events in memory.
+     * @param maxResidentEvents    The max number of events kept in memory.
+     *
+     * @see ILogStorage
+     */
+    virtual void setEventStorage(ILogStoragePtr storage, std::size_t maxResidentEvents) = 0;
+
     /**
      * @brief Adds a new log record to the log storage.
      *
@@ -370,6 +514,66 @@ public:
      */
     virtual RecordFuture addLogRecord(const KaaUserLogRecord& record) = 0;
 
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage.
+     *
+     * The priority is taken into account only by storages, which support it, e.g. @c PriorityLogStorage.
+     *
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     *
+     * @see LogPriority
+     */
+    virtual RecordFuture addLogRecord(const KaaUserLogRecord& record, LogPriority priority) = 0;
+
+    /**
+     * @brief Adds a new log record to the log storage without tracking its delivery.
+     *
+     * No @c RecordFuture is created for the record, so it is cheaper than @link addLogRecord() @endlink.
+     * The delivery is reported only per log bucket via @c ILogDeliveryListener.
+     *
+     * @param[in] record    The log record to be added.
+     *
+     * @see setLogDeliveryListener()
+     */
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record) = 0;
+
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage without tracking
+     * its delivery.
+     *
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     */
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record, LogPriority priority) = 0;
+
+    /**
+     * @brief Adds a new log record to the log storage and tracks its delivery with the batch.
+     *
+     * Waiting for @link RecordBatch::whenAll() @endlink is cheaper than waiting for a @c RecordFuture
+     * of each record when many records are added.
+     *
+     * @param[in] batch     The batch the record belongs to.
+     * @param[in] record    The log record to be added.
+     *
+     * @throw KaaException    The batch is closed.
+     *
+     * @see RecordBatch
+     */
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record) = 0;
+
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage and tracks its delivery
+     * with the batch.
+     *
+     * @param[in] batch       The batch the record belongs to.
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     *
+     * @throw KaaException    The batch is closed.
+     */
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record, LogPriority priority) = 0;
+
     /**
      * @brief Set a listener which receives a delivery status of each log bucket.
      *
@@ -402,11 +606,58 @@ public:
 
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) = 0;
 
+    /**
+     * @brief Sets the strategy which decides in which order Operations servers are tried.
+     *
+     * @c DefaultServerSelectionStrategy (random order) is used by default. @c LatencyServerSelectionStrategy
+     * prefers the server with the lowest round-trip time measured on connects and PINGs.
+     *
+     * @param[in] strategy    The @c IServerSelectionStrategy implementation.
+     *
+     * @throw KaaException    The strategy is NULL.
+     */
+    virtual void setServerSelectionStrategy(IServerSelectionStrategyPtr strategy) = 0;
+
     /**
      * @brief  Retrieves the Channel Manager
      */
     virtual IKaaChannelManager&                 getChannelManager() = 0;
 
+    /**
+     * @brief Retrieves the snapshot of connection-level metrics of all channels.
+     *
+     * Metrics are collected without locks and TRACE logging, so they can be exported periodically,
+     * e.g. to Prometheus.
+     *
+     * @return @link KaaClientMetrics @endlink object
+     */
+    virtual KaaClientMetrics                    getMetrics() = 0;
+
+    /**
+     * @brief Caps upstream bytes of the transport, e.g. on metered networks.
+     *
+     * Event and log sections are deferred while their transport is out of bytes, each transport has
+     * its own budget. The log buckets are capped to the burst size. The throttling state is reported
+     * by @link getMetrics() @endlink.
+     *
+     * @param type     The transport type, @c TransportType::EVENT or @c TransportType::LOGGING.
+     * @param limit    The rate limit, a zero rate removes the limit.
+     *
+     * @see BandwidthShaper
+     */
+    virtual void                                setTransportRateLimit(TransportType type,
+                                                                      const TransportRateLimit& limit) = 0;
+
+    /**
+     * @brief Retrieves the memory held by the client subsystems.
+     *
+     * If the total exceeds the soft limit (see @link KaaClientProperties::setMemorySoftLimit() @endlink),
+     * the client sheds log records from the log storage until the usage fits the limit.
+     *
+     * @return @link MemoryUsage @endlink object
+     */
+    virtual MemoryUsage                         getMemoryUsage() = 0;
+
     /**
      * @brief Retrieves the client's public and private key.
      *
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "kaa/context/IExecutorContext.hpp"
+#include "kaa/utils/IoServicePool.hpp"
 
 namespace kaa {
 
@@ -56,6 +57,13 @@ public:
      */
     virtual IExecutorContext& getExecutorContext() = 0;
 
+    /**
+     * @brief Returns the pool of I/O services shared by the default channels.
+     *
+     * @return Shared pool of I/O services. If null, each channel runs its own I/O service and threads.
+     */
+    virtual IoServicePoolPtr getIoServicePool() { return IoServicePoolPtr(); }
+
     virtual ~IKaaClientPlatformContext() = default;
 };
 
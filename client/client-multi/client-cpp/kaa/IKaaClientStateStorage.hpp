@@ -18,7 +18,9 @@
 #define ICLIENTSTATESTORAGE_HPP_
 
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <vector>
 #include "kaa/gen/EndpointGen.hpp"
 #include "kaa/common/EndpointObjectHash.hpp"
 #include "kaa/notification/gen/NotificationDefinitions.hpp"
@@ -31,6 +33,10 @@ typedef struct {
 
 typedef std::map<std::string, std::string> AttachedEndpoints;
 typedef std::map<std::int64_t, std::int32_t> TopicStates;
+/* Bit i is set if the multicast notification (topic state - 1 - i) of the topic was received. */
+typedef std::map<std::int64_t, std::uint64_t> TopicSequenceWindows;
+/* Hashes of the uids of the last received unicast notifications, the oldest first. */
+typedef std::vector<std::uint64_t> UnicastNotificationHashes;
 
 class IKaaClientStateStorage {
 public:
@@ -39,6 +45,17 @@ public:
     virtual std::int32_t getEventSequenceNumber() const = 0;
     virtual void setEventSequenceNumber(std::int32_t sequenceNumber) = 0;
 
+    /*
+     * Takes the given count of event sequence numbers and returns the first of them.
+     * Storages that may be shared by threads must take them atomically.
+     */
+    virtual std::int32_t reserveEventSequenceNumbers(std::int32_t count)
+    {
+        std::int32_t first = getEventSequenceNumber();
+        setEventSequenceNumber(first + count);
+        return first;
+    }
+
     virtual bool isRegistered() const = 0;
     virtual void setRegistered(bool isRegistered) = 0;
 
@@ -69,11 +86,38 @@ public:
     virtual TopicStates& getTopicStates() = 0;
     virtual void setTopicStates(const TopicStates& states) = 0;
 
+    /*
+     * Sequence numbers received below the topic states and uids of unicast notifications received
+     * recently, so the notification transport drops redelivered notifications after a restart too.
+     */
+    virtual TopicSequenceWindows getTopicSequenceWindows() const = 0;
+    virtual void setTopicSequenceWindows(const TopicSequenceWindows& windows) = 0;
+
+    virtual UnicastNotificationHashes getUnicastNotificationHashes() const = 0;
+    virtual void setUnicastNotificationHashes(const UnicastNotificationHashes& hashes) = 0;
+
     virtual bool isProfileResyncNeeded() const = 0;
     virtual void setProfileResyncNeeded(bool isNeeded) = 0;
 
+    /*
+     * Keepalive interval (in seconds) learned by the TCP channel, zero if not measured yet.
+     */
+    virtual std::int32_t getKeepAliveInterval() const = 0;
+    virtual void setKeepAliveInterval(std::int32_t interval) = 0;
+
+    /*
+     * Operations servers received from the Bootstrap server last time, encoded by the bootstrap manager.
+     */
+    virtual std::string getOperationsServers() const = 0;
+    virtual void setOperationsServers(const std::string& servers) = 0;
+
     virtual void read() = 0;
     virtual void save() = 0;
+
+    /*
+     * Writes the state immediately, even if the storage defers saves.
+     */
+    virtual void flush() { save(); }
 };
 
 typedef std::shared_ptr<IKaaClientStateStorage> IKaaClientStateStoragePtr;
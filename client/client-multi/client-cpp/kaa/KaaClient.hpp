@@ -41,6 +41,7 @@
 #include "kaa/IKaaClientPlatformContext.hpp"
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/KaaClientContext.hpp"
+#include "kaa/utils/KaaTimer.hpp"
 
 namespace kaa {
 
@@ -53,9 +54,14 @@ public:
     virtual void stop();
     virtual void pause();
     virtual void resume();
+    virtual std::size_t poll(std::chrono::milliseconds timeout);
 
     virtual void                                updateProfile();
     virtual IKaaChannelManager&                 getChannelManager();
+    virtual KaaClientMetrics                    getMetrics();
+    virtual void                                setTransportRateLimit(TransportType type,
+                                                                      const TransportRateLimit& limit);
+    virtual MemoryUsage                         getMemoryUsage();
     virtual const KeyPair&                      getClientKeyPair();
     virtual void                                setEndpointAccessToken(const std::string& token);
     virtual std::string                         refreshEndpointAccessToken();
@@ -64,12 +70,21 @@ public:
     virtual IKaaDataMultiplexer&                getOperationMultiplexer();
     virtual IKaaDataDemultiplexer&              getOperationDemultiplexer();
     virtual EventFamilyFactory&                 getEventFamilyFactory();
+    virtual IEventManager&                      getEventManager();
 
     virtual RecordFuture                        addLogRecord(const KaaUserLogRecord& record);
+    virtual RecordFuture                        addLogRecord(const KaaUserLogRecord& record, LogPriority priority);
+    virtual void                                addLogRecordWithoutFuture(const KaaUserLogRecord& record);
+    virtual void                                addLogRecordWithoutFuture(const KaaUserLogRecord& record,
+                                                                          LogPriority priority);
+    virtual void                                addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record);
+    virtual void                                addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record,
+                                                             LogPriority priority);
     virtual void                                setLogDeliveryListener(ILogDeliveryListenerPtr listener);
     virtual void                                setLogStorage(ILogStoragePtr storage);
     virtual void                                setLogUploadStrategy(ILogUploadStrategyPtr strategy);
     virtual void                                setFailoverStrategy(IFailoverStrategyPtr strategy);
+    virtual void                                setServerSelectionStrategy(IServerSelectionStrategyPtr strategy);
     virtual void                                setProfileContainer(IProfileContainerPtr container);
     virtual void                                addTopicListListener(INotificationTopicListListener& listener);
     virtual void                                removeTopicListListener(INotificationTopicListListener& listener);
@@ -78,6 +93,10 @@ public:
     virtual void                                addNotificationListener(std::int64_t topicId, INotificationListener& listener);
     virtual void                                removeNotificationListener(INotificationListener& listener);
     virtual void                                removeNotificationListener(std::int64_t topicId, INotificationListener& listener);
+    virtual void                                addRawNotificationListener(IRawNotificationListener& listener);
+    virtual void                                addRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener);
+    virtual void                                removeRawNotificationListener(IRawNotificationListener& listener);
+    virtual void                                removeRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener);
     virtual void                                subscribeToTopic(std::int64_t id, bool forceSync);
     virtual void                                subscribeToTopics(const std::list<std::int64_t>& idList, bool forceSync);
     virtual void                                unsubscribeFromTopic(std::int64_t id, bool forceSync);
@@ -86,11 +105,16 @@ public:
     virtual void                                addConfigurationListener(IConfigurationReceiver &receiver);
     virtual void                                removeConfigurationListener(IConfigurationReceiver &receiver);
     virtual const KaaRootConfiguration&         getConfiguration();
+    virtual std::shared_ptr<const KaaRootConfiguration> getConfigurationSnapshot();
     virtual void                                setConfigurationStorage(IConfigurationStoragePtr storage);
     virtual void                                attachEndpoint(const std::string&  endpointAccessToken
                                                 , IAttachEndpointCallbackPtr listener = IAttachEndpointCallbackPtr());
     virtual void                                detachEndpoint(const std::string&  endpointKeyHash
                                                 , IDetachEndpointCallbackPtr listener = IDetachEndpointCallbackPtr());
+    virtual void                                attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                                                , IAttachEndpointsCallbackPtr listener = IAttachEndpointsCallbackPtr());
+    virtual void                                detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                                                , IDetachEndpointsCallbackPtr listener = IDetachEndpointsCallbackPtr());
     virtual void                                attachUser(const std::string& userExternalId, const std::string& userAccessToken
                                                           , IUserAttachCallbackPtr listener = IUserAttachCallbackPtr());
     virtual void                                attachUser(const std::string& userExternalId, const std::string& userAccessToken
@@ -100,6 +124,8 @@ public:
     virtual bool                                isAttachedToUser();
     virtual std::int32_t                        findEventListeners(const std::list<std::string>& eventFQNs
                                                                   , IFetchEventListenersPtr listener);
+    virtual void                                setEventBatchingSettings(const EventBatchingSettings& settings);
+    virtual void                                setEventStorage(ILogStoragePtr storage, std::size_t maxResidentEvents);
 
     virtual IKaaDataMultiplexer&                getBootstrapMultiplexer();
     virtual IKaaDataDemultiplexer&              getBootstrapDemultiplexer();
@@ -113,6 +139,9 @@ private:
 
     void checkReadiness();
 
+    void startMemoryCheckTimer();
+    void checkMemoryLimit();
+
 private:
 
     enum class State {
@@ -167,6 +196,11 @@ private:
 #endif
 
     IKaaClientPlatformContextPtr                     platformContext_;
+
+    /*
+     * Declared last: its destructor waits for the callback, which refers to the members above.
+     */
+    KaaTimer<void ()>                                memoryCheckTimer_;
 };
 
 }
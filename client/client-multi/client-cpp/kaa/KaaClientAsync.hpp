@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KAACLIENTASYNC_HPP_
+#define KAACLIENTASYNC_HPP_
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "kaa/IKaaClient.hpp"
+#include "kaa/utils/KaaFuture.hpp"
+
+namespace kaa {
+
+/**
+ * @file
+ * @brief Future-returning variants of the listener-based @c IKaaClient operations.
+ *
+ * Results are delivered on the Kaa client's callback executor. Continuations added by @c KaaFuture::then()
+ * without an executor run there, so they must not block; pass an executor, e.g.
+ * <tt>client.getKaaClientContext().getExecutorContext().getCallbackExecutor()</tt> or your own one,
+ * to run continuations which do. Input errors are thrown right away as by the @c IKaaClient methods.
+ */
+
+/**
+ * @brief Attaches the current endpoint to the user, see @c IKaaClient::attachUser().
+ *
+ * @return The future failed with @c UserAttachException if the server has declined the request.
+ */
+KaaFuture<void> attachUserAsync(IKaaClient& client, const std::string& userExternalId, const std::string& userAccessToken);
+
+KaaFuture<void> attachUserAsync(IKaaClient& client, const std::string& userExternalId, const std::string& userAccessToken,
+                                const std::string& userVerifierToken);
+
+/**
+ * @brief Attaches the endpoint to the user of the current endpoint, see @c IKaaClient::attachEndpoint().
+ *
+ * @return The future of the key hash of the attached endpoint.
+ */
+KaaFuture<std::string> attachEndpointAsync(IKaaClient& client, const std::string& endpointAccessToken);
+
+/**
+ * @brief Detaches the endpoint from the user of the current endpoint, see @c IKaaClient::detachEndpoint().
+ */
+KaaFuture<void> detachEndpointAsync(IKaaClient& client, const std::string& endpointKeyHash);
+
+/**
+ * @brief Attaches the endpoints to the user of the current endpoint in one request, see @c IKaaClient::attachEndpoints().
+ *
+ * @return The future of the per-endpoint results. A failed attach of some endpoint doesn't fail the future.
+ */
+KaaFuture<std::vector<EndpointAttachResult>> attachEndpointsAsync(IKaaClient& client,
+                                                                  const std::vector<std::string>& endpointAccessTokens);
+
+/**
+ * @brief Detaches the endpoints from the user of the current endpoint in one request, see @c IKaaClient::detachEndpoints().
+ *
+ * @return The future of the per-endpoint results. A failed detach of some endpoint doesn't fail the future.
+ */
+KaaFuture<std::vector<EndpointDetachResult>> detachEndpointsAsync(IKaaClient& client,
+                                                                  const std::vector<std::string>& endpointKeyHashes);
+
+/**
+ * @brief Finds endpoints supporting the event classes, see @c IKaaClient::findEventListeners().
+ *
+ * @return The future of the key hashes of the found endpoints.
+ */
+KaaFuture<std::vector<std::string>> findEventListenersAsync(IKaaClient& client, const std::list<std::string>& eventFQNs);
+
+/**
+ * @brief Adds the log record, see @c IKaaClient::addLogRecord().
+ *
+ * @return The future of the record's delivery info.
+ */
+KaaFuture<RecordInfo> addLogRecordAsync(IKaaClient& client, const KaaUserLogRecord& record);
+
+KaaFuture<RecordInfo> addLogRecordAsync(IKaaClient& client, const KaaUserLogRecord& record, LogPriority priority);
+
+} /* namespace kaa */
+
+#endif /* KAACLIENTASYNC_HPP_ */
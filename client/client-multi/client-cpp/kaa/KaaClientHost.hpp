@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KAACLIENTHOST_HPP_
+#define KAACLIENTHOST_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/IKaaClient.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/KaaClientStateListener.hpp"
+#include "kaa/context/IExecutorContext.hpp"
+#include "kaa/utils/IoServicePool.hpp"
+#include "kaa/log/ILogStorage.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Runs Kaa clients of several endpoints in one process.
+ *
+ * All clients of the host share one executor context and one pool of I/O services, so the number of
+ * threads doesn't grow with the number of endpoints. Each endpoint gets its own working directory
+ * <tt>\<base working directory\>\<endpoint name\>/</tt>, which keeps apart its state, keys, configuration
+ * and log database. To share a log storage among endpoints, set a log storage factory which hands out
+ * per-endpoint partitions of it.
+ *
+ * @note Each endpoint keeps its own connection to the Operations server: the Kaa protocol identifies an endpoint
+ * by its session, so connections can't be multiplexed.
+ */
+class KaaClientHost {
+public:
+    /**
+     * @brief Creates the log storage of an endpoint, called before the client of the endpoint is returned.
+     *
+     * The first parameter is the endpoint name, the second one is its client.
+     */
+    typedef std::function<ILogStoragePtr (const std::string&, IKaaClient&)> LogStorageFactory;
+
+    /**
+     * @param[in] properties         Properties all endpoints are created with. The working directory is
+     *                               the base one for the endpoint directories.
+     * @param[in] executorContext    The executor context shared by all clients. If null, @c SimpleExecutorContext
+     *                               is used (@c PollingExecutorContext in the single-threaded build).
+     * @param[in] ioServicePool      The pool of I/O services shared by all clients. If null, the pool with
+     *                               a thread per hardware thread is used (the polled one of the executor
+     *                               context in the single-threaded build).
+     */
+    explicit KaaClientHost(const KaaClientProperties& properties = KaaClientProperties(),
+                           IExecutorContextPtr executorContext = IExecutorContextPtr(),
+                           IoServicePoolPtr ioServicePool = IoServicePoolPtr());
+
+    /**
+     * @brief Stops all started clients.
+     */
+    ~KaaClientHost();
+
+    KaaClientHost(const KaaClientHost&) = delete;
+    KaaClientHost& operator=(const KaaClientHost&) = delete;
+
+    /**
+     * @brief Creates the client of a new endpoint. The client isn't started.
+     *
+     * @param[in] endpointName    The unique name of the endpoint, used as the name of its working directory.
+     * @param[in] listener        The state listener of the client.
+     *
+     * @throw KaaException The name is empty or not a valid directory name, the endpoint already exists
+     * or its working directory can't be created.
+     */
+    std::shared_ptr<IKaaClient> addEndpoint(const std::string& endpointName,
+                                            KaaClientStateListenerPtr listener = std::make_shared<KaaClientStateListener>());
+
+    /**
+     * @brief Stops the client of the endpoint, if it is started, and removes it from the host.
+     * The working directory of the endpoint is kept.
+     *
+     * @return @c false if there is no such endpoint.
+     */
+    bool removeEndpoint(const std::string& endpointName);
+
+    /**
+     * @return The client of the endpoint or null if there is no such endpoint.
+     */
+    std::shared_ptr<IKaaClient> getClient(const std::string& endpointName);
+
+    std::vector<std::string> getEndpointNames();
+
+    std::size_t getEndpointCount();
+
+    /**
+     * @brief Starts clients which aren't started yet.
+     */
+    void startAll();
+
+    /**
+     * @brief Stops started clients.
+     */
+    void stopAll();
+
+    /**
+     * @brief Sets the factory of log storages, it applies to endpoints added afterwards.
+     */
+    void setLogStorageFactory(const LogStorageFactory& factory);
+
+    IExecutorContext& getExecutorContext() { return *executorContext_; }
+
+    IoServicePoolPtr getIoServicePool() { return ioServicePool_; }
+
+private:
+    struct Endpoint {
+        std::shared_ptr<IKaaClient>    client_;
+        bool                           isStarted_ = false;
+    };
+
+    void stopEndpoint(Endpoint& endpoint);
+
+private:
+    const KaaClientProperties    properties_;
+    IExecutorContextPtr          executorContext_;
+    IoServicePoolPtr             ioServicePool_;
+
+    LogStorageFactory            logStorageFactory_;
+
+    std::map<std::string, Endpoint>    endpoints_;
+    KAA_MUTEX_DECLARE(endpointsGuard_);
+};
+
+} /* namespace kaa */
+
+#endif /* KAACLIENTHOST_HPP_ */
@@ -23,6 +23,7 @@
 #include "kaa/IKaaClientPlatformContext.hpp"
 #include "kaa/context/IExecutorContext.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/context/PollingExecutorContext.hpp"
 #include "kaa/channel/connectivity/PingConnectivityChecker.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
@@ -31,6 +32,18 @@ namespace kaa {
 class KaaClientPlatformContext : public IKaaClientPlatformContext {
 public:
 
+#ifdef KAA_USE_SINGLE_THREAD
+    /*
+     * The SDK built without threads is always run by IKaaClient::poll().
+     */
+    KaaClientPlatformContext()
+        : KaaClientPlatformContext(KaaClientProperties(), std::make_shared<PollingExecutorContext>())
+    {}
+
+    KaaClientPlatformContext(const KaaClientProperties& properties)
+        : KaaClientPlatformContext(properties, std::make_shared<PollingExecutorContext>())
+    {}
+#else
     KaaClientPlatformContext()
         : properties_(), executorContext_(std::make_shared<SimpleExecutorContext>())
     {}
@@ -38,6 +51,7 @@ public:
     KaaClientPlatformContext(const KaaClientProperties& properties)
         : properties_(properties), executorContext_(std::make_shared<SimpleExecutorContext>())
     {}
+#endif
 
     KaaClientPlatformContext(const KaaClientProperties& properties, IExecutorContextPtr executorContext)
         : properties_(properties), executorContext_(executorContext)
@@ -47,6 +61,36 @@ public:
         }
     }
 
+    /**
+     * @param[in] ioServicePool    Pool of I/O services shared with the channels of other clients.
+     */
+    KaaClientPlatformContext(const KaaClientProperties& properties, IExecutorContextPtr executorContext,
+                             IoServicePoolPtr ioServicePool)
+        : properties_(properties), executorContext_(executorContext), ioServicePool_(ioServicePool)
+    {
+        if (!executorContext_) {
+            throw KaaException("Executor context is null");
+        }
+
+        if (!ioServicePool_) {
+            throw KaaException("I/O service pool is null");
+        }
+    }
+
+    /**
+     * @brief The client is run by @link IKaaClient::poll() @endlink, its channels use the polled I/O service
+     * of the executor context.
+     */
+    KaaClientPlatformContext(const KaaClientProperties& properties, PollingExecutorContextPtr executorContext)
+        : properties_(properties), executorContext_(executorContext)
+    {
+        if (!executorContext) {
+            throw KaaException("Executor context is null");
+        }
+
+        ioServicePool_ = executorContext->getIoServicePool();
+    }
+
     virtual KaaClientProperties& getProperties()
     {
         return properties_;
@@ -62,6 +106,11 @@ public:
         return *executorContext_;
     }
 
+    virtual IoServicePoolPtr getIoServicePool()
+    {
+        return ioServicePool_;
+    }
+
     KaaClientPlatformContext(const KaaClientPlatformContext& properties) = delete;
     KaaClientPlatformContext& operator=(const KaaClientPlatformContext& properties) = delete;
 
@@ -73,6 +122,7 @@ public:
 private:
     KaaClientProperties    properties_;
     IExecutorContextPtr    executorContext_;
+    IoServicePoolPtr       ioServicePool_;
 };
 
 } /* namespace kaa */
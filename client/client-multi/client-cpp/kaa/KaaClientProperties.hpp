@@ -17,11 +17,38 @@
 #ifndef KAACLIENTPROPERTIES_HPP_
 #define KAACLIENTPROPERTIES_HPP_
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 
+#include "kaa/logging/ILogger.hpp"
+
 namespace kaa {
 
+/**
+ * @brief On-disk format of the client's state file.
+ */
+enum class StateFileFormat {
+    TEXT,   /**< Human-readable name=value pairs, the whole file is rewritten on each save. */
+    BINARY  /**< Append-only journal of changed parameters, compacted from time to time. */
+};
+
+/**
+ * @brief Options of the TCP sockets used to connect to the Kaa servers.
+ *
+ * Zero values leave the system defaults.
+ */
+struct TcpSocketOptions {
+    bool noDelay = true;                                /**< Disables the Nagle's algorithm (TCP_NODELAY). */
+    std::chrono::seconds keepAliveIdle{0};              /**< Idle time before TCP keepalive probes are sent. */
+    std::chrono::seconds keepAliveInterval{0};          /**< Interval between TCP keepalive probes. */
+    std::uint32_t keepAliveCount = 0;                   /**< Unanswered probes before the connection is dropped. */
+    std::size_t sendBufferSize = 0;                     /**< SO_SNDBUF in bytes. */
+    std::size_t receiveBufferSize = 0;                  /**< SO_RCVBUF in bytes. */
+};
+
 class KaaClientProperties {
 public:
     KaaClientProperties()
@@ -76,6 +103,206 @@ public:
         return fileName.empty() ? fileName : getWorkingDirectoryPath() + fileName;
     }
 
+    /**
+     * @brief Enables the fast start of the client.
+     *
+     * @param[in] isEnabled Whether the fast start is enabled.
+     *
+     * On start the client connects to the Operations servers received from
+     * the Bootstrap server last time, skipping the bootstrap round trip. If none
+     * of them is available, the client falls back to the Bootstrap server.
+     */
+    void setFastStart(bool isEnabled);
+
+    /**
+     * @brief Checks whether the fast start of the client is enabled.
+     *
+     * @return @c false by default.
+     */
+    bool isFastStart() const;
+
+    /**
+     * @brief Enables the warm pause of the client.
+     *
+     * @param[in] isEnabled Whether the warm pause is enabled.
+     *
+     * On @c IKaaClient::pause() the client keeps the connection to the Operations server
+     * open, stops its PINGs and holds back sync requests. On @c IKaaClient::resume() it
+     * sends a single PING, or the pending delta sync, instead of reconnecting. If the
+     * server drops the connection meanwhile, the client reconnects on resume, resuming
+     * the session if its ticket is still valid.
+     */
+    void setWarmPause(bool isEnabled);
+
+    /**
+     * @brief Checks whether the warm pause of the client is enabled.
+     *
+     * @return @c false by default.
+     */
+    bool isWarmPause() const;
+
+    /**
+     * @brief Sets how long the Operations servers received from the Bootstrap server
+     * may be used by the fast start.
+     *
+     * @param[in] ttl The time to live. If zero, the servers never expire.
+     *
+     * The servers used by the fast start are refreshed in background anyway.
+     */
+    void setOperationsServersTtl(std::chrono::seconds ttl);
+
+    /**
+     * @brief Returns how long the saved Operations servers may be used by the fast start.
+     *
+     * @return The time to live, one day by default.
+     */
+    std::chrono::seconds getOperationsServersTtl() const;
+
+    /**
+     * @brief Sets how long event listeners found by @c IEventListenersResolver::findEventListeners()
+     * are reused for the same event FQNs instead of asking the server again.
+     *
+     * @param[in] ttl The time to live. If zero, the listeners are not cached.
+     *
+     * The cache is dropped whenever this endpoint is attached or detached, or attaches or detaches
+     * another endpoint. Endpoints attached by others are noticed only after the time to live.
+     */
+    void setEventListenersCacheTtl(std::chrono::seconds ttl);
+
+    /**
+     * @return The time to live of found event listeners, zero (no cache) by default.
+     */
+    std::chrono::seconds getEventListenersCacheTtl() const;
+
+    /**
+     * @brief Enables the failover with exponential backoff, see @c BackoffFailoverStrategy.
+     *
+     * @param[in] isEnabled If @c false, @c DefaultFailoverStrategy is used.
+     *
+     * A strategy set by @c IKaaClient::setFailoverStrategy() overrides this property.
+     */
+    void setFailoverBackoff(bool isEnabled);
+
+    /**
+     * @brief Checks whether the failover with exponential backoff is enabled.
+     *
+     * @return @c false by default.
+     */
+    bool isFailoverBackoff() const;
+
+    /**
+     * @brief Sets the shortest delay of the failover with exponential backoff.
+     *
+     * @param[in] period The delay, at least one second.
+     */
+    void setFailoverBackoffBase(std::chrono::seconds period);
+
+    /**
+     * @brief Returns the shortest delay of the failover with exponential backoff.
+     *
+     * @return The delay, one second by default.
+     */
+    std::chrono::seconds getFailoverBackoffBase() const;
+
+    /**
+     * @brief Sets the longest delay of the failover with exponential backoff.
+     *
+     * @param[in] period The delay. It is raised to the shortest delay if below it.
+     */
+    void setFailoverBackoffMax(std::chrono::seconds period);
+
+    /**
+     * @brief Returns the longest delay of the failover with exponential backoff.
+     *
+     * @return The delay, five minutes by default.
+     */
+    std::chrono::seconds getFailoverBackoffMax() const;
+
+    /**
+     * @brief Sets the soft limit of memory held by the SDK, see @c IKaaClient::getMemoryUsage().
+     *
+     * @param[in] bytes The limit in bytes. If zero, the memory isn't limited.
+     *
+     * While the usage is above the limit, elder log records are removed from the log storage
+     * until the usage fits the limit.
+     */
+    void setMemorySoftLimit(std::size_t bytes);
+
+    /**
+     * @brief Returns the soft limit of memory held by the SDK.
+     *
+     * @return The limit in bytes, zero (unlimited) by default.
+     */
+    std::size_t getMemorySoftLimit() const;
+
+    /**
+     * @brief Sets how often the memory usage is checked against the soft limit.
+     *
+     * @param[in] period The period, at least one second.
+     */
+    void setMemoryCheckPeriod(std::chrono::seconds period);
+
+    /**
+     * @brief Returns how often the memory usage is checked against the soft limit.
+     *
+     * @return The period, five seconds by default.
+     */
+    std::chrono::seconds getMemoryCheckPeriod() const;
+
+    /**
+     * @brief Sets the options of the TCP sockets connected to the Kaa servers.
+     *
+     * @param[in] options The socket options. TCP keepalive is enabled if any of its
+     * parameters is set.
+     *
+     * The options are applied once the socket is connected, so they take effect on
+     * the next connection.
+     */
+    void setTcpSocketOptions(const TcpSocketOptions& options);
+
+    /**
+     * @brief Returns the options of the TCP sockets connected to the Kaa servers.
+     *
+     * @return The socket options, only @c TcpSocketOptions::noDelay is set by default.
+     */
+    TcpSocketOptions getTcpSocketOptions() const;
+
+    /**
+     * @brief Sets the lowest level of SDK log messages.
+     *
+     * @param[in] level The log level.
+     *
+     * Messages of lower levels are not even formatted. The level can't enable
+     * messages which are excluded at compile time by @c KAA_LOG_LEVEL.
+     */
+    void setLogLevel(LogLevel level);
+
+    /**
+     * @brief Returns the lowest level of SDK log messages.
+     *
+     * @return The log level, @c LogLevel::KAA_TRACE by default.
+     */
+    LogLevel getLogLevel() const;
+
+    /**
+     * @brief Sets the capacity of the queue of the asynchronous SDK logger.
+     *
+     * @param[in] capacity The max number of queued log messages. If zero,
+     * messages are written synchronously by the logging thread.
+     *
+     * With a non-zero capacity the messages are written by a background thread,
+     * so verbose logging doesn't slow down the I/O thread. If the queue is full,
+     * messages below the warning level are dropped. Ignored in the single-threaded build.
+     */
+    void setAsyncLogQueueCapacity(std::size_t capacity);
+
+    /**
+     * @brief Returns the capacity of the queue of the asynchronous SDK logger.
+     *
+     * @return The queue capacity, zero (synchronous logging) by default.
+     */
+    std::size_t getAsyncLogQueueCapacity() const;
+
     /**
      * @brief Sets working directory path.
      *
@@ -116,6 +343,41 @@ public:
         return getWorkingDirectoryPath() + getProperty(PROP_STATE_FILE, DEFAULT_STATE_FILE);
     }
 
+    /**
+     * @brief Sets the format of the state file.
+     *
+     * @param[in] format The state file format.
+     *
+     * The binary format only appends changed parameters on save, which keeps
+     * saving fast and reduces flash wear. A state file written in the other
+     * format is migrated on the next save.
+     */
+    void setStateFileFormat(StateFileFormat format);
+
+    /**
+     * @brief Returns the format of the state file.
+     *
+     * @return The state file format, @c StateFileFormat::TEXT by default.
+     */
+    StateFileFormat getStateFileFormat() const;
+
+    /**
+     * @brief Sets the delay the client state is saved with.
+     *
+     * @param[in] delay The delay. If zero, the state is saved immediately.
+     *
+     * Saves requested within the delay are coalesced into a single write.
+     * The pending state is always written on client stop or pause.
+     */
+    void setStateSaveDelay(std::chrono::milliseconds delay);
+
+    /**
+     * @brief Returns the delay the client state is saved with.
+     *
+     * @return The save delay, zero by default.
+     */
+    std::chrono::milliseconds getStateSaveDelay() const;
+
     /**
      * @brief Sets public key file name.
      *
@@ -213,6 +475,25 @@ public:
     static const std::string PROP_CONF_FILE;
     static const std::string PROP_CLIENT_ID;
     static const std::string PROP_LOG_FILE_NAME;
+    static const std::string PROP_STATE_FILE_FORMAT;
+    static const std::string PROP_STATE_SAVE_DELAY;
+    static const std::string PROP_LOG_QUEUE_CAPACITY;
+    static const std::string PROP_LOG_LEVEL;
+    static const std::string PROP_FAST_START;
+    static const std::string PROP_WARM_PAUSE;
+    static const std::string PROP_OPERATIONS_SERVERS_TTL;
+    static const std::string PROP_EVENT_LISTENERS_CACHE_TTL;
+    static const std::string PROP_FAILOVER_BACKOFF;
+    static const std::string PROP_FAILOVER_BACKOFF_BASE;
+    static const std::string PROP_FAILOVER_BACKOFF_MAX;
+    static const std::string PROP_MEMORY_SOFT_LIMIT;
+    static const std::string PROP_MEMORY_CHECK_PERIOD;
+    static const std::string PROP_TCP_NO_DELAY;
+    static const std::string PROP_TCP_KEEPALIVE_IDLE;
+    static const std::string PROP_TCP_KEEPALIVE_INTERVAL;
+    static const std::string PROP_TCP_KEEPALIVE_COUNT;
+    static const std::string PROP_TCP_SEND_BUFFER;
+    static const std::string PROP_TCP_RECEIVE_BUFFER;
 
     static const std::string DEFAULT_WORKING_DIR;
     static const std::string DEFAULT_STATE_FILE;
@@ -222,6 +503,20 @@ public:
     static const std::string DEFAULT_CONF_FILE;
     static const std::string DEFAULT_CLIENT_ID;
     static const std::string DEFAULT_LOG_FILE_NAME;
+    static const std::string DEFAULT_STATE_FILE_FORMAT;
+    static const std::string DEFAULT_STATE_SAVE_DELAY;
+    static const std::string DEFAULT_LOG_QUEUE_CAPACITY;
+    static const std::string DEFAULT_LOG_LEVEL;
+    static const std::string DEFAULT_FAST_START;
+    static const std::string DEFAULT_WARM_PAUSE;
+    static const std::string DEFAULT_OPERATIONS_SERVERS_TTL;
+    static const std::string DEFAULT_EVENT_LISTENERS_CACHE_TTL;
+    static const std::string DEFAULT_FAILOVER_BACKOFF;
+    static const std::string DEFAULT_FAILOVER_BACKOFF_BASE;
+    static const std::string DEFAULT_FAILOVER_BACKOFF_MAX;
+    static const std::string DEFAULT_MEMORY_SOFT_LIMIT;
+    static const std::string DEFAULT_MEMORY_CHECK_PERIOD;
+    static const std::string DEFAULT_TCP_NO_DELAY;
 
 private:
     void initByDefaults();
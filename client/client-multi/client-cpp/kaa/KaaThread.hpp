@@ -25,25 +25,62 @@
 #include <atomic>
 #include <condition_variable>
 
+#if defined(KAA_USE_SINGLE_THREAD)
+
+#include "kaa/utils/NullMutex.hpp"
+
+/*
+ * The SDK is run by a single thread (see PollingExecutorContext), so locks compile to nothing.
+ * Waiting on a condition would never end, it's left to the code which isn't built then.
+ */
+#define KAA_MUTEX       kaa::NullMutex
+#define KAA_R_MUTEX     kaa::NullMutex
+
+#define KAA_CONDITION_VARIABLE                      std::condition_variable_any
+
+#define KAA_MUTEX_DECLARE(name)                 KAA_MUTEX name
+#define KAA_R_MUTEX_DECLARE(name)               KAA_R_MUTEX name
+
+#elif defined(KAA_USE_LOCK_PROFILING)
+
+#include "kaa/utils/LockProfiler.hpp"
+
+/*
+ * Locks record their contention to LockProfiler under the file and the name they are declared with.
+ */
+#define KAA_MUTEX       kaa::ProfiledMutex<std::mutex>
+#define KAA_R_MUTEX     kaa::ProfiledMutex<std::recursive_mutex>
+
+#define KAA_CONDITION_VARIABLE                      std::condition_variable_any
+
+#define KAA_MUTEX_DECLARE(name)                 KAA_MUTEX name { __FILE__, #name }
+#define KAA_R_MUTEX_DECLARE(name)               KAA_R_MUTEX name { __FILE__, #name }
+
+#else
+
 #define KAA_MUTEX       std::mutex
 #define KAA_R_MUTEX     std::recursive_mutex
 
+#define KAA_CONDITION_VARIABLE                      std::condition_variable
+
+#define KAA_MUTEX_DECLARE(name)                 KAA_MUTEX name
+#define KAA_R_MUTEX_DECLARE(name)               KAA_R_MUTEX name
+
+#endif
+
 #define KAA_MUTEX_UNIQUE       std::unique_lock<KAA_MUTEX>
 #define KAA_R_MUTEX_UNIQUE     std::unique_lock<KAA_R_MUTEX>
 
 #define KAA_LOCK(mtx)     mtx.lock()
 #define KAA_UNLOCK(mtx)   mtx.unlock()
 
-#define KAA_CONDITION_VARIABLE                      std::condition_variable
 #define KAA_CONDITION_WAIT(cond, lck)               cond.wait(lck)
 #define KAA_CONDITION_WAIT_PRED(cond, lck, pred)    cond.wait(lck, pred)
 #define KAA_CONDITION_NOTIFY(cond)                  cond.notify_one()
 #define KAA_CONDITION_NOTIFY_ALL(cond)              cond.notify_all()
 
 #define KAA_CONDITION_VARIABLE_DECLARE(name)    KAA_CONDITION_VARIABLE name
-#define KAA_MUTEX_DECLARE(name)                 KAA_MUTEX name
 #define KAA_MUTEX_MUTABLE_DECLARE(name)         mutable KAA_MUTEX_DECLARE(name)
-#define KAA_R_MUTEX_DECLARE(name)               KAA_R_MUTEX name
 #define KAA_R_MUTEX_MUTABLE_DECLARE(name)       mutable KAA_R_MUTEX_DECLARE(name)
 #define KAA_MUTEX_UNIQUE_DECLARE(name, mtx)     KAA_MUTEX_UNIQUE name(mtx)
 #define KAA_R_MUTEX_UNIQUE_DECLARE(name, mtx)   KAA_R_MUTEX_UNIQUE name(mtx)
@@ -57,37 +94,4 @@ typedef std::atomic_int_fast32_t RequestId;
 
 #define kaa_thread_local thread_local
 
-#if 0
-
-#define KAA_MUTEX
-#define KAA_R_MUTEX
-
-#define KAA_MUTEX_UNIQUE
-#define KAA_R_MUTEX_UNIQUE
-
-#define KAA_LOCK(mtx)
-#define KAA_UNLOCK(mtx)
-
-#define KAA_CONDITION_VARIABLE
-#define KAA_CONDITION_WAIT(cond, lck)
-#define KAA_CONDITION_WAIT_PRED(cond, lck, pred)
-#define KAA_CONDITION_NOTIFY(cond)
-#define KAA_CONDITION_NOTIFY_ALL(cond)
-
-#define KAA_CONDITION_VARIABLE_DECLARE(name)
-#define KAA_MUTEX_DECLARE(name)
-#define KAA_MUTEX_MUTABLE_DECLARE(name)
-#define KAA_R_MUTEX_DECLARE(name)
-#define KAA_R_MUTEX_MUTABLE_DECLARE(name)
-#define KAA_MUTEX_UNIQUE_DECLARE(name, mtx)
-#define KAA_R_MUTEX_UNIQUE_DECLARE(name, mtx)
-
-typedef bool bool_type;
-typedef std::int32_t RequestId;
-
-#define kaa_thread_local
-
-#endif
-
-
 #endif /* KAA_KAATHREAD_HPP_ */
@@ -23,6 +23,7 @@
 #include "kaa/bootstrap/IBootstrapManager.hpp"
 #include "kaa/bootstrap/BootstrapTransport.hpp"
 #include "kaa/channel/GenericTransportInfo.hpp"
+#include "kaa/failover/DefaultServerSelectionStrategy.hpp"
 #include "kaa/utils/KaaTimer.hpp"
 #include "kaa/IKaaClientContext.hpp"
 
@@ -36,14 +37,20 @@ public:
         : bootstrapTransport_(nullptr)
         , channelManager_(nullptr)
         , context_(context)
+        , selectionStrategy_(std::make_shared<DefaultServerSelectionStrategy>())
         , retryTimer_("BootstrapManager retryTimer")
+        , refreshTimer_("BootstrapManager refreshTimer")
         , client_(client)
     {
 
     }
 
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy);
+    virtual void setServerSelectionStrategy(IServerSelectionStrategyPtr strategy);
+    virtual void onOperationsServerRttMeasured(const ITransportConnectionInfo& server, std::chrono::microseconds rtt);
+    virtual std::map<std::int32_t, std::chrono::microseconds> getOperationsServerRtts();
     virtual void receiveOperationsServerList();
+    virtual bool useSavedOperationsServers();
     virtual void onOperationsServerFailed(const TransportProtocolId& protocolId, KaaFailoverReason reason);
     virtual void useNextOperationsServerByAccessPointId(std::int32_t id);
     virtual void setTransport(IBootstrapTransport* transport);
@@ -55,6 +62,8 @@ private:
 
     OperationsServers getOPSByAccessPointId(std::int32_t id);
     void notifyChannelManangerAboutServer(const OperationsServers& servers);
+    void applyOperationsServers(const std::vector<ProtocolMetaData>& operationsServers, bool keepCurrentServers = false);
+    void refreshOperationsServers();
 
     void onCurrentBootstrapServerFailed(KaaFailoverReason reason);
 
@@ -69,9 +78,17 @@ private:
 
     IFailoverStrategyPtr failoverStrategy_;
 
+    /*
+     * Channels report RTTs without taking guard_, so the strategy is replaced atomically.
+     */
+    IServerSelectionStrategyPtr selectionStrategy_;
+
     std::unique_ptr<std::int32_t> serverToApply;
+    bool isUsingSavedServers_ = false;
+    bool isRefreshing_ = false;
 
     KaaTimer<void ()>        retryTimer_;
+    KaaTimer<void ()>        refreshTimer_;
 
     // Temporary solution to stop app
     IKaaClient *client_;
@@ -17,11 +17,14 @@
 #ifndef IBOOTSTRAPMANAGER_HPP_
 #define IBOOTSTRAPMANAGER_HPP_
 
+#include <map>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <cstdint>
 
 #include "kaa/failover/IFailoverStrategy.hpp"
+#include "kaa/failover/IServerSelectionStrategy.hpp"
 
 namespace kaa {
 
@@ -37,11 +40,46 @@ public:
 
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) = 0;
 
+    /**
+     * Sets the strategy which orders operations servers of each transport protocol.
+     *
+     * @param strategy the strategy to be set.
+     * @see IServerSelectionStrategy
+     *
+     */
+    virtual void setServerSelectionStrategy(IServerSelectionStrategyPtr strategy) = 0;
+
+    /**
+     * Reports the round-trip time measured by a channel to the operations server.
+     *
+     * @param server the operations server.
+     * @param rtt the measured round-trip time.
+     *
+     */
+    virtual void onOperationsServerRttMeasured(const ITransportConnectionInfo& server, std::chrono::microseconds rtt) = 0;
+
+    /**
+     * Retrieves the round-trip times known to the server selection strategy.
+     *
+     * @return the round-trip times by access point id.
+     *
+     */
+    virtual std::map<std::int32_t, std::chrono::microseconds> getOperationsServerRtts() = 0;
+
     /**
      * Receives the latest list of servers from the bootstrap service.
      */
     virtual void receiveOperationsServerList() = 0;
 
+    /**
+     * Uses the operations servers received from the bootstrap service last time instead of
+     * requesting them. If none of them turns out to be available, the list is requested
+     * from the bootstrap service.
+     *
+     * @return false if there are no saved servers or they may be out of date.
+     */
+    virtual bool useSavedOperationsServers() { return false; }
+
     /**
      * Notifies Channel manager about new server meets given parameters.
      *
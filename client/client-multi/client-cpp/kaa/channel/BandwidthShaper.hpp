@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BANDWIDTHSHAPER_HPP_
+#define BANDWIDTHSHAPER_HPP_
+
+#include <map>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/common/TransportType.hpp"
+#include "kaa/channel/ChannelMetrics.hpp"
+#include "kaa/utils/KaaTimer.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+namespace kaa {
+
+/**
+ * @brief The upstream rate limit of a transport.
+ */
+struct TransportRateLimit {
+    std::size_t bytesPerSecond_ = 0;    ///< 0 - unlimited
+    std::size_t burstBytes_ = 0;        ///< The bytes which may be sent at once, 0 - one second of the rate
+};
+
+/**
+ * @brief Caps upstream bytes of transports with token buckets.
+ *
+ * Each rate-limited transport has its own bucket, so logs can't spend the bytes of events. A bucket is
+ * refilled at the rate of the transport up to its burst size.
+ *
+ * A section may be sent while its bucket isn't empty, and its actual size is charged afterwards. So a section
+ * bigger than the burst isn't blocked, but the bucket goes into debt, which defers next sections until
+ * it is repaid. Once a deferred transport may send again, the resume callback is called for it,
+ * e.g. to request the sync.
+ */
+class BandwidthShaper {
+public:
+    typedef std::function<void (TransportType)> ResumeCallback;
+
+    BandwidthShaper(IKaaClientContext& context) : context_(context) {}
+    BandwidthShaper(const BandwidthShaper&) = delete;
+    BandwidthShaper& operator=(const BandwidthShaper&) = delete;
+
+    /**
+     * @brief Sets the callback, waiting for the previous one to return. An empty callback detaches
+     * its owner, e.g. before it is destroyed.
+     */
+    void setResumeCallback(const ResumeCallback& callback);
+
+    /**
+     * @brief Sets the rate limit of the transport. The bucket starts full.
+     *
+     * A zero rate removes the limit.
+     */
+    void setRateLimit(TransportType type, const TransportRateLimit& limit);
+
+    /**
+     * @return The burst size of the transport in bytes, 0 if it isn't rate-limited.
+     */
+    std::size_t getBurstBytes(TransportType type) const;
+
+    /**
+     * @brief Checks whether a section of the transport may be sent now.
+     *
+     * If not, the section is considered deferred, and the resume callback is scheduled.
+     */
+    bool tryAcquire(TransportType type);
+
+    /**
+     * @brief Charges the bytes of a sent section.
+     */
+    void consume(TransportType type, std::size_t bytes);
+
+    /**
+     * @return The throttling state of the rate-limited transports.
+     */
+    std::map<TransportType, TransportThrottlingSnapshot> getSnapshot() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Bucket {
+        TransportRateLimit    limit_;
+        double                availableBytes_ = 0;
+        Clock::time_point     refilledAt_;
+        std::uint64_t         sentBytes_ = 0;
+        std::uint64_t         deferredSections_ = 0;
+        bool                  isThrottled_ = false;
+
+        std::unique_ptr<KaaTimer<void ()>>    resumeTimer_;
+    };
+
+    static const std::size_t TRANSPORT_TYPE_COUNT = static_cast<std::size_t>(TransportType::LOGGING) + 1;
+
+    /*
+     * Called with the guard held.
+     */
+    Bucket *getLimitedBucket(TransportType type);
+    void refill(Bucket& bucket, Clock::time_point now);
+
+    void onResume(TransportType type);
+
+private:
+    IKaaClientContext&    context_;
+
+    /*
+     * Held while the callback is called.
+     */
+    KAA_MUTEX_DECLARE(resumeCallbackGuard_);
+    ResumeCallback    resumeCallback_;
+
+    KAA_MUTEX_MUTABLE_DECLARE(guard_);
+    std::array<Bucket, TRANSPORT_TYPE_COUNT>    buckets_;
+};
+
+typedef std::shared_ptr<BandwidthShaper> BandwidthShaperPtr;
+
+} /* namespace kaa */
+
+#endif /* BANDWIDTHSHAPER_HPP_ */
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHANNELMETRICS_HPP_
+#define CHANNELMETRICS_HPP_
+
+#include <map>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "kaa/common/TransportType.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Snapshot of a duration histogram.
+ *
+ * Bucket 0 counts durations below 1 ms, bucket @c i counts durations in [2^(i-1), 2^i) ms,
+ * the last bucket also counts all longer durations.
+ */
+struct LatencyHistogramSnapshot {
+    static const std::size_t BUCKET_COUNT = 16;
+
+    std::array<std::uint64_t, BUCKET_COUNT> buckets_ = {};
+    std::uint64_t count_ = 0;
+    std::uint64_t sumUs_ = 0;
+    std::uint64_t maxUs_ = 0;
+
+    /**
+     * @brief The mean duration in microseconds, zero if nothing was recorded.
+     */
+    std::uint64_t getMeanUs() const { return count_ ? sumUs_ / count_ : 0; }
+
+    /**
+     * @brief The upper bound in milliseconds of the bucket containing the given quantile.
+     *
+     * @param[in] quantile    The quantile in [0, 1], e.g. 0.99.
+     */
+    std::uint64_t getQuantileUpperBoundMs(double quantile) const
+    {
+        std::uint64_t rank = static_cast<std::uint64_t>(quantile * count_);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets_[i];
+            if (seen > rank || (seen && seen == count_)) {
+                return std::uint64_t(1) << i;
+            }
+        }
+        return 0;
+    }
+
+    LatencyHistogramSnapshot& operator+=(const LatencyHistogramSnapshot& other)
+    {
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        sumUs_ += other.sumUs_;
+        maxUs_ = std::max(maxUs_, other.maxUs_);
+        return *this;
+    }
+};
+
+/**
+ * @brief Snapshot of connection-level metrics of a data channel.
+ */
+struct ChannelMetricsSnapshot {
+    std::uint64_t bytesSent_ = 0;
+    std::uint64_t bytesReceived_ = 0;
+    std::uint64_t framesSent_ = 0;        ///< KaaTcp frames or HTTP requests
+    std::uint64_t framesReceived_ = 0;    ///< KaaTcp frames or HTTP responses
+    std::uint64_t connects_ = 0;          ///< Successfully opened connections
+    std::uint64_t serverFailures_ = 0;    ///< Failovers reported by the channel
+    std::uint64_t bufferedBytes_ = 0;     ///< Memory held by queued frames and codec buffers
+
+    LatencyHistogramSnapshot pingRtt_;       ///< PING to PINGRESP
+    LatencyHistogramSnapshot syncLatency_;   ///< Sync request to its response
+    LatencyHistogramSnapshot connectTime_;   ///< TCP connect, about one round trip
+
+    ChannelMetricsSnapshot& operator+=(const ChannelMetricsSnapshot& other)
+    {
+        bytesSent_ += other.bytesSent_;
+        bytesReceived_ += other.bytesReceived_;
+        framesSent_ += other.framesSent_;
+        framesReceived_ += other.framesReceived_;
+        connects_ += other.connects_;
+        serverFailures_ += other.serverFailures_;
+        bufferedBytes_ += other.bufferedBytes_;
+        pingRtt_ += other.pingRtt_;
+        syncLatency_ += other.syncLatency_;
+        connectTime_ += other.connectTime_;
+        return *this;
+    }
+};
+
+/**
+ * @brief Throttling state of a rate-limited transport, see @c BandwidthShaper.
+ */
+struct TransportThrottlingSnapshot {
+    std::uint64_t bytesPerSecond_ = 0;
+    std::int64_t availableBytes_ = 0;       ///< Negative while a section bigger than the burst is repaid
+    std::uint64_t sentBytes_ = 0;
+    std::uint64_t deferredSections_ = 0;    ///< Sections left out of sync requests for the lack of bytes
+    bool isThrottled_ = false;              ///< A deferred section waits for the bucket to refill
+};
+
+/**
+ * @brief Metrics of all channels of a Kaa client.
+ */
+struct KaaClientMetrics {
+    std::map<std::string, ChannelMetricsSnapshot> channels_;   ///< By channel id
+    ChannelMetricsSnapshot total_;
+    std::uint64_t skippedProfileUpdates_ = 0;   ///< Profile updates which didn't need a sync
+    std::map<std::int32_t, std::uint64_t> operationsServerRttUs_;   ///< Smoothed RTT by access point id
+    std::map<TransportType, TransportThrottlingSnapshot> throttling_;   ///< Rate-limited transports only
+};
+
+/**
+ * @brief Lock-free duration histogram, see @c LatencyHistogramSnapshot.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram()
+    {
+        for (auto& bucket : buckets_) {
+            bucket = 0;
+        }
+    }
+
+    template<typename Duration>
+    void record(Duration duration)
+    {
+        std::int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        std::uint64_t value = us > 0 ? static_cast<std::uint64_t>(us) : 0;
+
+        std::size_t bucket = 0;
+        for (std::uint64_t ms = value / 1000; ms && bucket < LatencyHistogramSnapshot::BUCKET_COUNT - 1; ms >>= 1) {
+            ++bucket;
+        }
+
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumUs_.fetch_add(value, std::memory_order_relaxed);
+
+        std::uint64_t max = maxUs_.load(std::memory_order_relaxed);
+        while (value > max && !maxUs_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Reads the histogram. Values recorded concurrently may be seen partially.
+     */
+    LatencyHistogramSnapshot getSnapshot() const
+    {
+        LatencyHistogramSnapshot snapshot;
+        for (std::size_t i = 0; i < LatencyHistogramSnapshot::BUCKET_COUNT; ++i) {
+            snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count_ = count_.load(std::memory_order_relaxed);
+        snapshot.sumUs_ = sumUs_.load(std::memory_order_relaxed);
+        snapshot.maxUs_ = maxUs_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, LatencyHistogramSnapshot::BUCKET_COUNT> buckets_;
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sumUs_{0};
+    std::atomic<std::uint64_t> maxUs_{0};
+};
+
+/**
+ * @brief Lock-free connection-level metrics updated by a data channel from any thread.
+ */
+class ChannelMetrics {
+public:
+    void onBytesSent(std::size_t bytes)
+    {
+        bytesSent_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void onBytesReceived(std::size_t bytes)
+    {
+        bytesReceived_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void onFramesSent(std::size_t frames = 1)
+    {
+        framesSent_.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    void onFrameReceived()
+    {
+        framesReceived_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void onConnected()
+    {
+        connects_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void onServerFailed()
+    {
+        serverFailures_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Tracks the memory held by the channel buffers, @c delta is negative when they shrink.
+     */
+    void onBufferedBytesChanged(std::int64_t delta)
+    {
+        bufferedBytes_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram& getPingRtt() { return pingRtt_; }
+    LatencyHistogram& getSyncLatency() { return syncLatency_; }
+    LatencyHistogram& getConnectTime() { return connectTime_; }
+
+    ChannelMetricsSnapshot getSnapshot() const
+    {
+        ChannelMetricsSnapshot snapshot;
+        snapshot.bytesSent_ = bytesSent_.load(std::memory_order_relaxed);
+        snapshot.bytesReceived_ = bytesReceived_.load(std::memory_order_relaxed);
+        snapshot.framesSent_ = framesSent_.load(std::memory_order_relaxed);
+        snapshot.framesReceived_ = framesReceived_.load(std::memory_order_relaxed);
+        snapshot.connects_ = connects_.load(std::memory_order_relaxed);
+        snapshot.serverFailures_ = serverFailures_.load(std::memory_order_relaxed);
+        snapshot.bufferedBytes_ = std::max<std::int64_t>(bufferedBytes_.load(std::memory_order_relaxed), 0);
+        snapshot.pingRtt_ = pingRtt_.getSnapshot();
+        snapshot.syncLatency_ = syncLatency_.getSnapshot();
+        snapshot.connectTime_ = connectTime_.getSnapshot();
+        return snapshot;
+    }
+
+private:
+    std::atomic<std::uint64_t> bytesSent_{0};
+    std::atomic<std::uint64_t> bytesReceived_{0};
+    std::atomic<std::uint64_t> framesSent_{0};
+    std::atomic<std::uint64_t> framesReceived_{0};
+    std::atomic<std::uint64_t> connects_{0};
+    std::atomic<std::uint64_t> serverFailures_{0};
+    std::atomic<std::int64_t> bufferedBytes_{0};
+
+    LatencyHistogram pingRtt_;
+    LatencyHistogram syncLatency_;
+    LatencyHistogram connectTime_;
+};
+
+} /* namespace kaa */
+
+#endif /* CHANNELMETRICS_HPP_ */
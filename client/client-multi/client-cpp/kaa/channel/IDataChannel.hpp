@@ -26,6 +26,7 @@
 #include "kaa/channel/ChannelDirection.hpp"
 #include "kaa/channel/IKaaDataMultiplexer.hpp"
 #include "kaa/channel/IKaaDataDemultiplexer.hpp"
+#include "kaa/channel/ChannelMetrics.hpp"
 #include "kaa/channel/ITransportConnectionInfo.hpp"
 #include "kaa/channel/connectivity/IConnectivityChecker.hpp"
 
@@ -151,6 +152,7 @@ public:
 
     /**
      * Pauses the channel's workflow. The channel should stop all network activity.
+     * A channel may keep an idle connection open if @c KaaClientProperties::isWarmPause() is set.
      *
      */
     virtual void pause() = 0;
@@ -161,6 +163,16 @@ public:
      */
     virtual void resume() = 0;
 
+    /**
+     * Retrieves the snapshot of connection-level metrics of the channel.
+     * Channels which don't collect metrics return zero metrics.
+     *
+     * @return the metrics.
+     * @see ChannelMetricsSnapshot
+     *
+     */
+    virtual ChannelMetricsSnapshot getMetrics() const { return ChannelMetricsSnapshot(); }
+
     virtual ~IDataChannel() {}
 
 };
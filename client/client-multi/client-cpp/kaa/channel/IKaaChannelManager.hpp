@@ -18,9 +18,11 @@
 #define IKAACHANNELMANAGER_HPP_
 
 #include <list>
+#include <chrono>
 #include <string>
 
 #include "kaa/channel/IDataChannel.hpp"
+#include "kaa/channel/BandwidthShaper.hpp"
 #include "kaa/channel/ITransportConnectionInfo.hpp"
 #include "kaa/channel/connectivity/IConnectivityChecker.hpp"
 #include "kaa/EndpointConnectionInfo.hpp"
@@ -107,6 +109,18 @@ public:
      */
     virtual IDataChannelPtr getChannel(const std::string& channelId) = 0;
 
+    /**
+     * Requests a sync of the specific transport type with the channel it is mapped to.
+     *
+     * The sync may be deferred to merge it with the syncs of other transport types
+     * requested shortly after.
+     *
+     * @param type the transport's type.
+     * @throw KaaException if no channel is mapped to the transport type.
+     *
+     */
+    virtual void sync(TransportType type) = 0;
+
     /**
      * Reports to Channel Manager in case link with server was not established.
      *
@@ -119,6 +133,17 @@ public:
      */
     virtual void onServerFailed(ITransportConnectionInfoPtr connectionInfo, KaaFailoverReason reason) = 0;
 
+    /**
+     * Reports to Channel Manager the round-trip time measured to the server, e.g. on connect or by PING.
+     *
+     * @param server the parameters of the measured server.
+     * @see ITransportConnectionInfo
+     *
+     * @param rtt The measured round-trip time.
+     *
+     */
+    virtual void onServerRttMeasured(ITransportConnectionInfoPtr server, std::chrono::microseconds rtt) = 0;
+
     /**
      * Reports to Channel Manager about successful connection.
      *
@@ -167,6 +192,24 @@ public:
      */
     virtual void resume() = 0;
 
+    /**
+     * Retrieves metrics of all channels and their total.
+     *
+     * @return the metrics.
+     * @see KaaClientMetrics
+     *
+     */
+    virtual KaaClientMetrics getMetrics() = 0;
+
+    /**
+     * Retrieves the shaper which caps upstream bytes of transports. A sync deferred by it is requested
+     * again once the transport may send.
+     *
+     * @return the shaper.
+     * @see BandwidthShaper
+     */
+    virtual BandwidthShaperPtr getBandwidthShaper() = 0;
+
     virtual ~IKaaChannelManager() {}
 };
 
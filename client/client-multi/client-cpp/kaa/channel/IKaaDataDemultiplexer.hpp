@@ -18,6 +18,7 @@
 #define IKAADATADEMULTIPLEXER_HPP_
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 
 namespace kaa {
@@ -46,6 +47,21 @@ public:
      */
     virtual DemultiplexerReturnCode processResponse(const std::vector<std::uint8_t> &response) = 0;
 
+    /**
+     * Processes the given response bytes in place.
+     *
+     * Channels use it to decode responses straight from their own buffers. The default implementation
+     * copies the bytes to call @link processResponse(const std::vector<std::uint8_t>&) @endlink.
+     *
+     * @param data buffer which to be processed.
+     * @param size size of the buffer.
+     *
+     */
+    virtual DemultiplexerReturnCode processResponse(const std::uint8_t *data, std::size_t size)
+    {
+        return processResponse(std::vector<std::uint8_t>(data, data + size));
+    }
+
     virtual ~IKaaDataDemultiplexer() {}
 };
 
@@ -22,6 +22,7 @@
 #include <vector>
 #include "kaa/common/TransportType.hpp"
 #include "kaa/channel/ChannelDirection.hpp"
+#include "kaa/common/AvroChunkedOutputStream.hpp"
 
 namespace kaa {
 
@@ -47,6 +48,68 @@ public:
      */
     virtual std::vector<std::uint8_t> compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes) = 0;
 
+    /**
+     * Compiles request for given transport types into the given buffer.
+     *
+     * The request is appended after the current content of the buffer, so a channel may reserve room
+     * for its own header and reuse the buffer between requests. The default implementation copies
+     * the result of @link compileRequest(const std::map<TransportType, ChannelDirection>&) @endlink.
+     *
+     * @param types map of types to be polled.
+     * @param dest the buffer the serialized request data is appended to.
+     *
+     */
+    virtual void compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                std::vector<std::uint8_t>& dest)
+    {
+        const auto& request = compileRequest(transportTypes);
+        dest.insert(dest.end(), request.begin(), request.end());
+    }
+
+    /**
+     * Compiles request for given transport types into the given chunked stream.
+     *
+     * The request is encoded into pooled chunks, so no contiguous buffer of the request size
+     * is allocated. The default implementation copies the result of
+     * @link compileRequest(const std::map<TransportType, ChannelDirection>&) @endlink.
+     *
+     * @param types map of types to be polled.
+     * @param dest the stream the serialized request data is appended to.
+     *
+     */
+    virtual void compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                AvroChunkedOutputStream& dest)
+    {
+        const auto& request = compileRequest(transportTypes);
+        dest.write(request.data(), request.size());
+    }
+
+    /**
+     * Compiles request for given transport types into the given buffer, skipping sections which
+     * the server has acknowledged in the current session and which haven't changed since.
+     *
+     * Used by channels keeping a session with the server, which keeps the state of skipped sections.
+     * The section of a single requested transport type is always compiled. The default implementation
+     * compiles the full request.
+     *
+     * @param types map of types to be polled.
+     * @param dest the buffer the serialized request data is appended to.
+     *
+     * @see resetDeltaState()
+     */
+    virtual void compileDeltaRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                     std::vector<std::uint8_t>& dest)
+    {
+        compileRequest(transportTypes, dest);
+    }
+
+    /**
+     * Forgets sections acknowledged by the server, so the next delta request carries all sections.
+     *
+     * Called when a new session with the server starts.
+     */
+    virtual void resetDeltaState() {}
+
     virtual ~IKaaDataMultiplexer() {}
 };
 
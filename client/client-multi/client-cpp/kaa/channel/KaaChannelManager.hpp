@@ -20,6 +20,8 @@
 #include <map>
 #include <set>
 #include <list>
+#include <chrono>
+#include <memory>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/KaaDefaults.hpp"
@@ -42,7 +44,7 @@ public:
                       IKaaClientContext& context,
                       IKaaClient *client);
 
-    ~KaaChannelManager() { doShutdown(); }
+    ~KaaChannelManager();
 
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy);
     virtual void setChannel(TransportType type, IDataChannelPtr channel);
@@ -55,7 +57,15 @@ public:
     virtual IDataChannelPtr getChannelByTransportType(TransportType type);
     virtual IDataChannelPtr getChannel(const std::string& channelId);
 
+    /**
+     * Syncs requested within the sync window are merged: each channel is synced once per window,
+     * in the order of the most urgent transport type mapped to it. Events and notifications go first,
+     * logs go last.
+     */
+    virtual void sync(TransportType type);
+
     virtual void onServerFailed(ITransportConnectionInfoPtr connectionInfo, KaaFailoverReason reason);
+    virtual void onServerRttMeasured(ITransportConnectionInfoPtr server, std::chrono::microseconds rtt);
 
     virtual void onConnected(const EndpointConnectionInfo& connection);
 
@@ -71,6 +81,16 @@ public:
     void pause();
     void resume();
 
+    virtual KaaClientMetrics getMetrics();
+    virtual BandwidthShaperPtr getBandwidthShaper() { return bandwidthShaper_; }
+
+    /**
+     * Sets the time the syncs are accumulated for. Zero disables merging, syncs are passed to channels at once.
+     */
+    void setSyncWindow(std::chrono::milliseconds window) { syncWindow_ = window; }
+
+    static const std::chrono::milliseconds DEFAULT_SYNC_WINDOW;
+
 private:
     bool useChannelForType(const std::pair<TransportType, ChannelDirection>& type, IDataChannelPtr channel);
     void useNewChannel(IDataChannelPtr channel);
@@ -79,6 +99,18 @@ private:
 
     bool addChannelToList(IDataChannelPtr channel);
 
+    typedef std::set<IDataChannelPtr>                   ChannelSet;
+    typedef std::map<TransportType, IDataChannelPtr>    ChannelMap;
+
+    /*
+     * Publish copies of the containers for lock-free readers. Called with the guard of the container held.
+     */
+    void publishChannels();
+    void publishMappedChannels();
+
+    std::shared_ptr<const ChannelSet> getChannelsSnapshot() const { return std::atomic_load(&channelsSnapshot_); }
+    std::shared_ptr<const ChannelMap> getMappedChannelsSnapshot() const { return std::atomic_load(&mappedChannelsSnapshot_); }
+
     void doShutdown();
 
     ITransportConnectionInfoPtr getCurrentBootstrapServer(const TransportProtocolId& protocolId);
@@ -90,6 +122,9 @@ private:
 
     void checkAuthenticationFailover(KaaFailoverReason failover);
 
+    void onSyncWindowExpired();
+    void syncChannels(const std::set<TransportType>& types);
+
 private:
     IBootstrapManager&    bootstrapManager_;
     IKaaClientContext&    context_;
@@ -99,6 +134,12 @@ private:
     IFailoverStrategyPtr failoverStrategy_;
 
     KaaTimer<void ()>        retryTimer_;
+    KaaTimer<void ()>        syncTimer_;
+
+    std::chrono::milliseconds    syncWindow_;
+
+    KAA_MUTEX_DECLARE(syncGuard_);
+    std::set<TransportType>      pendingSyncTypes_;
 
     bool_type isShutdown_;
     bool_type isPaused_;
@@ -109,13 +150,25 @@ private:
     KAA_MUTEX_DECLARE(lastOpsServersGuard_);
     std::map<TransportProtocolId, ITransportConnectionInfoPtr>    lastOpsServers_;
 
+    /*
+     * Channels change on bootstrap and failover only, while the transport to channel mapping
+     * is read on every sync. Writers modify the containers under the guards and publish
+     * immutable copies, readers take the latest copy without locking.
+     */
     KAA_R_MUTEX_DECLARE(channelGuard_);
-    std::set<IDataChannelPtr>                   channels_;
+    ChannelSet                           channels_;
+    std::shared_ptr<const ChannelSet>    channelsSnapshot_;
 
     KAA_R_MUTEX_DECLARE(mappedChannelGuard_);
-    std::map<TransportType, IDataChannelPtr>    mappedChannels_;
+    ChannelMap                           mappedChannels_;
+    std::shared_ptr<const ChannelMap>    mappedChannelsSnapshot_;
 
     ConnectivityCheckerPtr connectivityChecker_;
+
+    /*
+     * Shared with the sync data processor, so the resume callback is reset on destruction.
+     */
+    BandwidthShaperPtr bandwidthShaper_;
 };
 
 } /* namespace kaa */
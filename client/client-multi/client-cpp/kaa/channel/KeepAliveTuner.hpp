@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KEEPALIVETUNER_HPP_
+#define KEEPALIVETUNER_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Learns the longest idle interval a connection survives, e.g. behind a carrier NAT.
+ *
+ * While probing, each keepalive that is answered after the current interval raises the interval
+ * by half, until a keepalive is lost. The interval then settles just below the idle time of the lost
+ * keepalive, or at the longest idle time known to be safe. A settled interval that keeps failing
+ * (e.g. the device moved to another network) restarts probing.
+ *
+ * Thread safe.
+ */
+class KeepAliveTuner {
+public:
+    /**
+     * @param[in] minInterval    The interval probing starts from.
+     * @param[in] maxInterval    The upper bound of the interval, should be below the server keepalive.
+     */
+    KeepAliveTuner(std::chrono::seconds minInterval, std::chrono::seconds maxInterval);
+
+    /**
+     * @brief Settles at the interval learned earlier. Zero or out of range intervals are ignored.
+     */
+    void restore(std::chrono::seconds interval);
+
+    /**
+     * @brief Returns the current keepalive interval.
+     */
+    std::chrono::seconds getInterval() const;
+
+    /**
+     * @brief Returns the settled interval or zero if the tuner is probing.
+     */
+    std::chrono::seconds getSettledInterval() const;
+
+    /**
+     * @brief Reports the keepalive answered after the given idle time.
+     *
+     * @return @c true if the settled interval has changed and is worth persisting.
+     */
+    bool onKeepAliveSucceeded(std::chrono::steady_clock::duration idle);
+
+    /**
+     * @brief Reports the keepalive lost after the given idle time.
+     *
+     * @return @c true if the settled interval has changed and is worth persisting.
+     */
+    bool onKeepAliveFailed(std::chrono::steady_clock::duration idle);
+
+private:
+    bool settle(std::chrono::seconds interval);
+
+private:
+    const std::chrono::seconds    minInterval_;
+    const std::chrono::seconds    maxInterval_;
+
+    std::chrono::seconds    interval_;
+    std::chrono::seconds    safeInterval_;
+    std::chrono::seconds    limit_;
+
+    bool           isSettled_ = false;
+    std::size_t    settledFailures_ = 0;
+
+    KAA_MUTEX_MUTABLE_DECLARE(tunerGuard_);
+
+    static const std::size_t MAX_SETTLED_FAILURES = 2;
+};
+
+} /* namespace kaa */
+
+#endif /* KEEPALIVETUNER_HPP_ */
@@ -21,9 +21,11 @@
 #include <algorithm>
 
 #include "kaa/KaaDefaults.hpp"
+#include "kaa/KaaThread.hpp"
 #include "kaa/channel/transport/AbstractKaaTransport.hpp"
 #include "kaa/channel/transport/IMetaDataTransport.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
 #include "kaa/common/EndpointObjectHash.hpp"
 
 namespace kaa {
@@ -37,19 +39,53 @@ public:
     std::shared_ptr<SyncRequestMetaData> createSyncRequestMetaData()
     {
         std::shared_ptr<SyncRequestMetaData> request(new SyncRequestMetaData);
+        fillSyncRequestMetaData(*request, clientStatus_->getProfileHash());
+        return request;
+    }
 
-        request->sdkToken = SDK_TOKEN;
-        request->endpointPublicKeyHash.set_bytes(publicKeyHash_);
-        request->profileHash.set_bytes(clientStatus_->getProfileHash());
-        request->timeout.set_long(timeout_);
+    std::shared_ptr<const std::vector<std::uint8_t>> createEncodedSyncRequestMetaData()
+    {
+        HashDigest profileHash = clientStatus_->getProfileHash();
 
-        return request;
+        KAA_MUTEX_UNIQUE_DECLARE(lock, encodedMetaDataGuard_);
+
+        /*
+         * Only the profile hash changes during the client's life, the rest is fixed at construction.
+         */
+        if (!encodedMetaData_ || profileHash != encodedProfileHash_) {
+            SyncRequestMetaData request;
+            fillSyncRequestMetaData(request, profileHash);
+
+            SyncRequest::syncRequestMetaData_t section;
+            section.set_SyncRequestMetaData(request);
+
+            auto encodedMetaData = std::make_shared<std::vector<std::uint8_t>>();
+            AvroByteArrayConverter<SyncRequest::syncRequestMetaData_t>().toByteArray(section, *encodedMetaData);
+
+            encodedMetaData_ = encodedMetaData;
+            encodedProfileHash_ = std::move(profileHash);
+        }
+
+        return encodedMetaData_;
+    }
+
+private:
+    void fillSyncRequestMetaData(SyncRequestMetaData& request, const HashDigest& profileHash)
+    {
+        request.sdkToken = SDK_TOKEN;
+        request.endpointPublicKeyHash.set_bytes(publicKeyHash_);
+        request.profileHash.set_bytes(profileHash);
+        request.timeout.set_long(timeout_);
     }
 
 private:
     IKaaClientStateStoragePtr   clientStatus_;
     EndpointObjectHash          publicKeyHash_;
     long                        timeout_;
+
+    std::shared_ptr<const std::vector<std::uint8_t>>    encodedMetaData_;
+    HashDigest                                          encodedProfileHash_;
+    KAA_MUTEX_DECLARE(encodedMetaDataGuard_);
 };
 
 }  // namespace kaa
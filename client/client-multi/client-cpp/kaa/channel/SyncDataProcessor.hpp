@@ -17,9 +17,14 @@
 #ifndef SYNC_DATA_PROCESSOR_HPP_
 #define SYNC_DATA_PROCESSOR_HPP_
 
+#include <map>
+#include <vector>
+
+#include "kaa/KaaThread.hpp"
 #include "kaa/channel/IKaaDataMultiplexer.hpp"
 #include "kaa/channel/IKaaDataDemultiplexer.hpp"
 #include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/channel/BandwidthShaper.hpp"
 #include "kaa/gen/EndpointGen.hpp"
 
 #include "kaa/channel/transport/IMetaDataTransport.hpp"
@@ -45,6 +50,16 @@ typedef std::shared_ptr<IEventTransport>          IEventTransportPtr;
 typedef std::shared_ptr<ILoggingTransport>        ILoggingTransportPtr;
 typedef std::shared_ptr<IRedirectionTransport>    IRedirectionTransportPtr;
 
+/*
+ * A sync request with the meta data and log sections encoded beforehand, it is encoded the same way
+ * as SyncRequest. A null log section is taken from the request.
+ */
+struct SyncRequestWithEncodedSections {
+    const SyncRequest                  *request_;
+    const std::vector<std::uint8_t>    *encodedSyncRequestMetaData_;
+    const std::vector<std::uint8_t>    *encodedLogSyncRequest_;
+};
+
 class SyncDataProcessor : public IKaaDataMultiplexer, public IKaaDataDemultiplexer {
 public:
     SyncDataProcessor(IMetaDataTransportPtr
@@ -59,9 +74,45 @@ public:
                     , IKaaClientContext&);
 
     virtual std::vector<std::uint8_t> compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes);
+    virtual void compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                std::vector<std::uint8_t>& dest);
+    virtual void compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                AvroChunkedOutputStream& dest);
+    virtual void compileDeltaRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                                     std::vector<std::uint8_t>& dest);
+    virtual void resetDeltaState();
+
+    /**
+     * Sets the shaper which defers event and log sections of rate-limited transports.
+     */
+    void setBandwidthShaper(BandwidthShaperPtr shaper) { bandwidthShaper_ = shaper; }
+
     virtual DemultiplexerReturnCode processResponse(const std::vector<std::uint8_t> &response);
+    virtual DemultiplexerReturnCode processResponse(const std::uint8_t *data, std::size_t size);
 private:
-    AvroByteArrayConverter<SyncRequest>     requestConverter_;
+    template<typename Output>
+    void compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes,
+                        Output& dest, bool isDeltaRequest);
+
+    void encodeRequest(const SyncRequestWithEncodedSections& request, std::vector<std::uint8_t>& dest);
+    void encodeRequest(const SyncRequestWithEncodedSections& request, AvroChunkedOutputStream& dest);
+
+    /*
+     * Returns true if the section is the same as the one last acknowledged by the server.
+     * Otherwise, the section is remembered to be acknowledged by the response to the request.
+     */
+    template<typename Section>
+    bool isSectionAcknowledged(TransportType type, const Section& section, std::int32_t requestId);
+    void acknowledgeSections(const SyncResponse& response);
+
+    /*
+     * Returns false if the section of the rate-limited transport is to be deferred.
+     */
+    bool isSectionAllowed(TransportType type);
+    void onSectionSent(TransportType type, std::size_t bytes);
+
+private:
+    AvroByteArrayConverter<SyncRequestWithEncodedSections>  requestConverter_;
     AvroByteArrayConverter<SyncResponse>    responseConverter_;
 
     IMetaDataTransportPtr       metaDataTransport_;
@@ -75,8 +126,18 @@ private:
     IRedirectionTransportPtr    redirectionTransport_;
 
     IKaaClientStateStoragePtr   clientStatus_;
+    BandwidthShaperPtr          bandwidthShaper_;
 
     std::int32_t                requestId;
+    std::size_t                 lastEncodedRequestSize_ = 0;
+
+    typedef std::map<TransportType, std::vector<std::uint8_t>> EncodedSections;
+
+    EncodedSections                             acknowledgedSections_;
+    std::map<std::int32_t, EncodedSections>     pendingSections_;
+    KAA_MUTEX_DECLARE(deltaGuard_);
+
+    static const std::size_t MAX_PENDING_DELTA_REQUESTS = 16;
 
     IKaaClientContext &context_;
 };
@@ -30,6 +30,7 @@ class TransportProtocolIdConstants {
 public:
    static const TransportProtocolId HTTP_TRANSPORT_ID;
    static const TransportProtocolId TCP_TRANSPORT_ID;
+   static const TransportProtocolId SHM_TRANSPORT_ID;
 
 private:
    static const std::int32_t HTTP_TRANSPORT_PROTOCOL_ID;
@@ -37,6 +38,9 @@ private:
 
    static const std::int32_t TCP_TRANSPORT_PROTOCOL_ID;
    static const std::int32_t TCP_TRANSPORT_PROTOCOL_VERSION;
+
+   static const std::int32_t SHM_TRANSPORT_PROTOCOL_ID;
+   static const std::int32_t SHM_TRANSPORT_PROTOCOL_VERSION;
 };
 
 } /* namespace kaa */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONNECTIVITYMONITOR_HPP_
+#define CONNECTIVITYMONITOR_HPP_
+
+#include <chrono>
+#include <memory>
+
+#include "kaa/channel/connectivity/IConnectivityChecker.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Tracks the network connectivity in background, so @link checkConnectivity() @endlink returns
+ * the last known state without blocking.
+ *
+ * The connectivity is probed by another checker, e.g. @link PingConnectivityChecker @endlink, once per
+ * probe interval, on @link onNetworkChanged() @endlink and after each @link checkConnectivity() @endlink.
+ * On Linux, changes of network links, addresses and routes reported by netlink also trigger a probe.
+ *
+ * Listeners are notified about transitions from the monitor thread. Until the first probe completes,
+ * the network is considered available.
+ */
+class ConnectivityMonitor : public IConnectivityChecker {
+public:
+    static const std::chrono::seconds DEFAULT_PROBE_INTERVAL;
+
+public:
+    ConnectivityMonitor(ConnectivityCheckerPtr probe,
+                        std::chrono::milliseconds probeInterval = DEFAULT_PROBE_INTERVAL);
+
+    /**
+     * Stops the monitor. The probe in progress isn't waited for, but its result isn't reported.
+     */
+    ~ConnectivityMonitor();
+
+    /**
+     * @return The state found by the last probe. A new probe is scheduled to refresh it.
+     */
+    virtual bool checkConnectivity();
+
+    virtual bool addConnectivityListener(const void *key, const ConnectivityListener& listener);
+    virtual void removeConnectivityListener(const void *key);
+
+    /**
+     * Probes the connectivity as soon as possible, e.g. when the platform reports a network change.
+     */
+    void onNetworkChanged();
+
+private:
+    struct Monitor;
+    std::shared_ptr<Monitor> monitor_;
+};
+
+} /* namespace kaa */
+
+#endif /* CONNECTIVITYMONITOR_HPP_ */
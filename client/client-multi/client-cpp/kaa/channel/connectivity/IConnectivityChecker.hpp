@@ -18,6 +18,7 @@
 #define ICONNECTIVITYCHECKER_HPP_
 
 #include <memory>
+#include <functional>
 
 namespace kaa {
 
@@ -33,6 +34,29 @@ public:
      */
     virtual bool checkConnectivity() = 0;
 
+    typedef std::function<void (bool isConnected)> ConnectivityListener;
+
+    /**
+     * Subscribes to connectivity changes. Checkers which don't track the connectivity in background
+     * ignore listeners.
+     *
+     * @param[in] key         The key to remove the listener by.
+     * @param[in] listener    Called with the new state when the connectivity changes.
+     *
+     * @return True if the listener is going to be notified, false otherwise.
+     */
+    virtual bool addConnectivityListener(const void *key, const ConnectivityListener& listener)
+    {
+        static_cast<void>(key);
+        static_cast<void>(listener);
+        return false;
+    }
+
+    virtual void removeConnectivityListener(const void *key)
+    {
+        static_cast<void>(key);
+    }
+
     virtual ~IConnectivityChecker() = default;
 };
 
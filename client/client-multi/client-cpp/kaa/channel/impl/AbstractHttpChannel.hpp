@@ -23,6 +23,7 @@
 
 #include "kaa/channel/ImpermanentDataChannel.hpp"
 
+#include <chrono>
 #include <cstdint>
 
 #include "kaa/KaaThread.hpp"
@@ -72,6 +73,13 @@ public:
         connectivityChecker_ = checker;
     }
 
+    /**
+     * HTTP requests and responses are counted as frames, their bodies as bytes.
+     */
+    virtual ChannelMetricsSnapshot getMetrics() const {
+        return metrics_.getSnapshot();
+    }
+
 protected:
     typedef std::shared_ptr<IPTransportInfo> IPTransportInfoPtr;
 
@@ -90,6 +98,8 @@ private:
     virtual std::string retrieveResponse(const IHttpResponse& response) = 0;
 
     void onServerFailed(KaaFailoverReason reason);
+    void recordExchange(std::size_t requestBodySize, const IHttpResponse& response,
+                        std::chrono::steady_clock::duration latency);
 
 private:
     IKaaChannelManager&      channelManager_;
@@ -104,6 +114,7 @@ private:
     IKaaDataMultiplexer      *multiplexer_   = nullptr;
     IKaaDataDemultiplexer    *demultiplexer_ = nullptr;
     ConnectivityCheckerPtr   connectivityChecker_;
+    ChannelMetrics           metrics_;
 };
 
 }
@@ -38,6 +38,12 @@
 
 namespace kaa {
 
+/**
+ * Keeps a long poll request outstanding on one connection to receive server pushes. Upstream syncs requested
+ * while the poll is outstanding are sent as regular sync requests on a second kept-alive connection, so they
+ * neither abort the poll nor wait for it. At most one sync request is in flight, the syncs requested meanwhile
+ * are merged into the next one.
+ */
 class DefaultOperationLongPollChannel : public IDataChannel {
 public:
     DefaultOperationLongPollChannel(IKaaChannelManager& channelManager, const KeyPair& clientKeys, IKaaClientContext &context);
@@ -71,6 +77,12 @@ public:
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) {}
     virtual void setConnectivityChecker(ConnectivityCheckerPtr checker) {}
 
+    /**
+     * Poll requests and responses are counted as frames, their bodies as bytes. Polls are held by the server,
+     * so their duration isn't recorded as sync latency.
+     */
+    virtual ChannelMetricsSnapshot getMetrics() const { return metrics_.getSnapshot(); }
+
     virtual ITransportConnectionInfoPtr getServer() {
         return std::dynamic_pointer_cast<ITransportConnectionInfo, IPTransportInfo>(currentServer_);
     }
@@ -80,11 +92,20 @@ protected:
         return "/EP/LongSync";
     }
 
+    std::string getSyncURLSuffix() {
+        return "/EP/Sync";
+    }
+
 private:
     void startPoll();
     void stopPoll();
     void postTask();
     void executeTask();
+    void onPollResponse(const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response);
+    void requestSync();
+    void postSync();
+    void executeSync();
+    void onSyncResponse(const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response);
     void doShutdown();
 
 private:
@@ -102,18 +123,23 @@ private:
     bool connectionInProgress_;
     bool taskPosted_;
     bool firstStart_;
+    bool syncInProgress_;
+    bool syncPending_;
     IKaaDataMultiplexer *multiplexer_;
     IKaaDataDemultiplexer *demultiplexer_;
     IKaaChannelManager& channelManager_;
     std::shared_ptr<IPTransportInfo> currentServer_;
     HttpDataProcessor httpDataProcessor_;
     HttpClient httpClient_;
+    HttpClient syncHttpClient_;
     KAA_CONDITION_VARIABLE_DECLARE(waitCondition_);
     KAA_MUTEX_DECLARE(conditionMutex_);
     KAA_MUTEX_DECLARE(channelGuard_);
 
 protected:
     IKaaClientContext &context_;
+
+    ChannelMetrics metrics_;
 };
 
 }
@@ -19,16 +19,20 @@
 
 #include "kaa/KaaDefaults.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <thread>
 #include <array>
 #include <memory>
+#include <chrono>
+#include <vector>
 
 #include <boost/asio.hpp>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/security/KeyUtils.hpp"
 #include "kaa/channel/IDataChannel.hpp"
+#include "kaa/channel/KeepAliveTuner.hpp"
 #include "kaa/security/RsaEncoderDecoder.hpp"
 #include "kaa/channel/IKaaChannelManager.hpp"
 #include "kaa/kaatcp/KaaTcpResponseProcessor.hpp"
@@ -36,6 +40,7 @@
 #include "kaa/channel/ITransportConnectionInfo.hpp"
 #include "kaa/channel/TransportProtocolIdConstants.hpp"
 #include "kaa/utils/KaaTimer.hpp"
+#include "kaa/utils/IoServicePool.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
 #include "kaa/IKaaClientContext.hpp"
 
@@ -46,11 +51,63 @@ class IKaaTcpRequest;
 class KeyPair;
 class ChannelConnection;
 
+/**
+ * Session ticket issued by the Operations server in CONNACK. CONNECT to the same server
+ * presents the ticket and reuses the session key instead of sending a new RSA encrypted one.
+ */
+struct TcpSessionTicket {
+    std::vector<std::uint8_t> ticket_;
+    SessionKey sessionKey_;
+    std::chrono::steady_clock::time_point expiresAt_;
+
+    std::string serverHost_;
+    std::uint16_t serverPort_ = 0;
+    PublicKey serverKey_;
+
+    bool isValidFor(const IPTransportInfo& server) const
+    {
+        return std::chrono::steady_clock::now() < expiresAt_ &&
+               serverHost_ == server.getHost() &&
+               serverPort_ == server.getPort() &&
+               serverKey_ == server.getPublicKey();
+    }
+};
+
+typedef std::shared_ptr<const TcpSessionTicket> TcpSessionTicketPtr;
+
+/**
+ * Session key of a CONNECT accepted by the Operations server, with its RSA encrypted and signed form.
+ * Reconnects to the same server reuse them, so CONNECT is built without RSA operations.
+ */
+struct TcpConnectCredentials {
+    SessionKey sessionKey_;
+    EncodedSessionKey encodedSessionKey_;
+    Signature signature_;
+
+    std::string serverHost_;
+    std::uint16_t serverPort_ = 0;
+    PublicKey serverKey_;
+
+    bool isValidFor(const IPTransportInfo& server) const
+    {
+        return serverHost_ == server.getHost() &&
+               serverPort_ == server.getPort() &&
+               serverKey_ == server.getPublicKey();
+    }
+};
+
+typedef std::shared_ptr<const TcpConnectCredentials> TcpConnectCredentialsPtr;
+
 class DefaultOperationTcpChannel : public IDataChannel {
 public:
+    /**
+     * @param[in] ioServicePool    Pool of I/O services shared with other channels. If null, the channel
+     *                             runs its own I/O service with @c THREADPOOL_SIZE threads.
+     */
     DefaultOperationTcpChannel(IKaaChannelManager& channelManager,
                                const KeyPair& clientKeys,
-                               IKaaClientContext& context);
+                               IKaaClientContext& context,
+                               IoServicePoolPtr ioServicePool = IoServicePoolPtr());
 
     ~DefaultOperationTcpChannel();
 
@@ -95,42 +152,125 @@ public:
         static_cast<void>(strategy);
     }
 
-    virtual void setConnectivityChecker(ConnectivityCheckerPtr checker)
+    /**
+     * If the checker tracks the connectivity in background, the channel lost with the connectivity
+     * reconnects as soon as the connectivity is back.
+     */
+    virtual void setConnectivityChecker(ConnectivityCheckerPtr checker);
+
+    virtual ChannelMetricsSnapshot getMetrics() const
     {
-        connectivityChecker_= checker;
+        return metrics_.getSnapshot();
     }
 
+    /**
+     * @brief Sets the max number of KAASYNC requests sent without waiting for their responses.
+     *
+     * Requests are correlated with responses by the message id of the KAASYNC header. Synchronizations
+     * requested while the window is full are merged and sent on the next response.
+     *
+     * @param[in] count    The max number of in-flight requests, @c DEFAULT_MAX_IN_FLIGHT_SYNC_REQUESTS by default.
+     *
+     * @throw KaaException The count is zero.
+     */
+    void setMaxInFlightSyncRequests(std::size_t count);
+    std::size_t getMaxInFlightSyncRequests() const { return maxInFlightSyncRequests_; }
+
     void openConnection();
     void closeConnection();
     void onServerFailed(KaaFailoverReason failoverReason = KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA);
 
+    /**
+     * @brief Keeps the session ticket received in CONNACK for the next connections to the current server.
+     *
+     * @param[in] ticket        The opaque ticket.
+     * @param[in] lifetime      The lifetime of the ticket in seconds. If zero, the kept ticket is dropped.
+     * @param[in] sessionKey    The session key of the connection which received the ticket.
+     */
+    void onSessionTicket(const std::vector<std::uint8_t>& ticket, std::uint16_t lifetime, const SessionKey& sessionKey);
+
+    /**
+     * @brief Drops the session ticket refused by the server and reconnects with a new session key.
+     */
+    void onSessionResumptionRefused();
+
+    /**
+     * @brief Keeps the credentials accepted by the current server for the next connections to it.
+     *
+     * @param[in] credentials   The credentials sent in CONNECT. If null, the kept credentials are dropped.
+     */
+    void onConnectCredentials(TcpConnectCredentialsPtr credentials);
+
 private:
     void startThreads();
     void stopThreads();
 
+    void post(const std::function<void ()>& task);
+    void onConnectivityChanged(bool isConnected);
+    void waitForPendingHandlers();
+
 private:
     static const std::string CHANNEL_ID;
     static const std::map<TransportType, ChannelDirection> SUPPORTED_TYPES;
     static const std::uint16_t THREADPOOL_SIZE = 2;
 
+public:
+    static const std::size_t DEFAULT_MAX_IN_FLIGHT_SYNC_REQUESTS = 4;
+
+    /*
+     * Bounds of the learned keepalive interval in seconds. The upper bound leaves room for a PING
+     * response before the server keepalive (200 seconds) runs out.
+     */
+    static const int MIN_KEEPALIVE_INTERVAL = 30;
+    static const int MAX_KEEPALIVE_INTERVAL = 180;
+
+private:
+
     IKaaClientContext& context_;
     IKaaChannelManager& channelManager_;
 
     std::shared_ptr<ChannelConnection> connection_;
     std::shared_ptr<IPTransportInfo> currentServer_;
 
-    boost::asio::io_service io_;
-    boost::asio::io_service::work work_;
+    IoServicePoolPtr ioServicePool_;
+    std::unique_ptr<boost::asio::io_service> ownIoService_;
+    boost::asio::io_service& io_;
+    std::unique_ptr<boost::asio::io_service::work> work_;
     std::vector<std::thread> ioThreads_;
+
+    /*
+     * Tasks posted by the channel run only while the token is alive.
+     */
+    std::shared_ptr<void> lifeToken_;
+
+    /*
+     * Connections closed while their handlers may still be queued in the shared I/O service.
+     */
+    std::vector<std::weak_ptr<ChannelConnection>> closedConnections_;
     KeyPair clientKeys_;
 
+    TcpSessionTicketPtr sessionTicket_;
+    TcpConnectCredentialsPtr connectCredentials_;
+
+    ChannelMetrics metrics_;
+
     IKaaDataMultiplexer *multiplexer_ = nullptr;
     IKaaDataDemultiplexer *demultiplexer_ = nullptr;
 
+    std::atomic<std::size_t> maxInFlightSyncRequests_;
+
+    KeepAliveTuner keepAliveTuner_;
+
     bool isFailoverInProgress_ = false;
     bool isShutdown_ = false;
+    bool isPaused_ = false;
+
+    /*
+     * Set while the channel is down because of lost connectivity.
+     */
+    bool isWaitingForConnectivity_ = false;
 
-    std::recursive_mutex channelGuard_;
+    KAA_R_MUTEX_DECLARE(channelGuard_);
 
     ConnectivityCheckerPtr connectivityChecker_;
 };
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHAREDMEMORYDATACHANNEL_HPP_
+#define SHAREDMEMORYDATACHANNEL_HPP_
+
+#include "kaa/KaaDefaults.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/channel/IDataChannel.hpp"
+#include "kaa/common/AvroChunkedOutputStream.hpp"
+#include "kaa/channel/TransportProtocolIdConstants.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+namespace kaa {
+
+/**
+ * Hands sync requests to a multiplexing proxy on the same host, which owns the only upstream
+ * connection of the gateway. No handshakes, keepalives or encryption are done by the endpoint.
+ *
+ * The channel creates a POSIX shared memory segment @c name (or attaches to an existing one)
+ * and exchanges serialized requests and responses with the proxy through two single-producer
+ * single-consumer rings in it. The segment layout is shared with the C SDK, see kaa_shm_channel.h;
+ * the platform protocol id in the segment header tells the proxy the payloads are Avro encoded.
+ *
+ * The proxy doesn't appear among the access points, so the channel is used as soon as it is added
+ * to the channel manager. Build the SDK with @c KAA_WITHOUT_OPERATION_TCP_CHANNEL and
+ * @c KAA_WITHOUT_OPERATION_HTTP_CHANNEL and add the channel to @link IKaaClient::getChannelManager() @endlink.
+ */
+class SharedMemoryDataChannel : public IDataChannel {
+public:
+    static const std::size_t DEFAULT_RING_SIZE = 64 * 1024;
+
+    SharedMemoryDataChannel(IKaaClientContext& context, const std::string& name,
+                            std::size_t ringSize = DEFAULT_RING_SIZE,
+                            std::chrono::milliseconds pollPeriod = std::chrono::milliseconds(10));
+    virtual ~SharedMemoryDataChannel();
+
+    virtual void sync(TransportType type);
+    virtual void syncAll();
+    virtual void syncAck(TransportType type);
+    virtual const std::string& getId() const { return CHANNEL_ID; }
+
+    virtual TransportProtocolId getTransportProtocolId() const {
+        return TransportProtocolIdConstants::SHM_TRANSPORT_ID;
+    }
+
+    virtual ServerType getServerType() const {
+        return ServerType::OPERATIONS;
+    }
+
+    virtual void setMultiplexer(IKaaDataMultiplexer *multiplexer);
+    virtual void setDemultiplexer(IKaaDataDemultiplexer *demultiplexer);
+
+    /**
+     * The proxy owns the upstream connection, servers are ignored.
+     */
+    virtual void setServer(ITransportConnectionInfoPtr server) {}
+    virtual ITransportConnectionInfoPtr getServer() { return ITransportConnectionInfoPtr(); }
+
+    virtual const std::map<TransportType, ChannelDirection>& getSupportedTransportTypes() const {
+        return SUPPORTED_TYPES;
+    }
+
+    virtual void shutdown();
+    virtual void pause();
+    virtual void resume();
+
+    virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) {}
+    virtual void setConnectivityChecker(ConnectivityCheckerPtr checker) {}
+
+    /**
+     * Ring records are counted as frames.
+     */
+    virtual ChannelMetricsSnapshot getMetrics() const { return metrics_.getSnapshot(); }
+
+private:
+    struct Ring {
+        std::uint32_t *writeIndex;
+        std::uint32_t *readIndex;
+        std::uint8_t  *data;
+        std::uint32_t  size;
+    };
+
+    void attach(std::size_t ringSize);
+    void detach();
+    void run();
+    void flush();
+    void drain();
+    bool push(const AvroChunkedOutputStream& record);
+
+private:
+    static const std::string CHANNEL_ID;
+    static const std::map<TransportType, ChannelDirection> SUPPORTED_TYPES;
+
+    const std::string name_;
+    const std::chrono::milliseconds pollPeriod_;
+
+    bool isOwner_ = false;
+    void *segment_ = nullptr;
+    std::size_t segmentSize_ = 0;
+    Ring uplink_;
+    Ring downlink_;
+
+    IKaaDataMultiplexer   *multiplexer_ = nullptr;
+    IKaaDataDemultiplexer *demultiplexer_ = nullptr;
+
+    std::map<TransportType, ChannelDirection> pendingTypes_;
+    AvroChunkedOutputStream pendingRequest_;      // Compiled request which didn't fit into the uplink
+
+    bool isShutdown_ = false;
+    bool isPaused_ = false;
+    std::thread pollThread_;
+    KAA_CONDITION_VARIABLE_DECLARE(pollCondition_);
+    KAA_MUTEX_DECLARE(channelGuard_);
+
+    IKaaClientContext& context_;
+    ChannelMetrics metrics_;
+};
+
+}
+
+#endif /* SHAREDMEMORYDATACHANNEL_HPP_ */
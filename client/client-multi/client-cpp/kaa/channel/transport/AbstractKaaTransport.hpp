@@ -47,7 +47,7 @@ private:
 protected:
     void syncByType(TransportType transportType = Type)
     {
-        getChannel(transportType)->sync(transportType);
+        channelManager_.sync(transportType);
     }
 
     void syncAll()
@@ -19,6 +19,8 @@
 
 #include "kaa/gen/EndpointGen.hpp"
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace kaa {
 
@@ -36,6 +38,14 @@ public:
      */
     virtual std::shared_ptr<LogSyncRequest> createLogSyncRequest() = 0;
 
+    /**
+     * Creates the Log request that consists of current log records, encoded with Avro.
+     *
+     * @return encoded Log request or null if there are no logs to send
+     * @see LogSyncRequest
+     */
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> createEncodedLogSyncRequest() = 0;
+
     /**
      * Updates the state of the Log collector according to the given response.
      *
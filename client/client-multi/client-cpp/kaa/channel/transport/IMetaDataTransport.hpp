@@ -17,6 +17,10 @@
 #ifndef IMETADATATRANSPORT_HPP_
 #define IMETADATATRANSPORT_HPP_
 
+#include <vector>
+#include <memory>
+#include <cstdint>
+
 #include "kaa/gen/EndpointGen.hpp"
 #include <boost/shared_ptr.hpp>
 
@@ -36,6 +40,15 @@ public:
      */
     virtual std::shared_ptr<SyncRequestMetaData> createSyncRequestMetaData() = 0;
 
+    /**
+     * Returns the meta data section of a sync request already encoded, including its union branch.
+     * The bytes are reused by subsequent requests until the meta data changes.
+     *
+     * @return encoded Meta data section.
+     *
+     */
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> createEncodedSyncRequestMetaData() = 0;
+
     virtual ~IMetaDataTransport() {}
 };
 
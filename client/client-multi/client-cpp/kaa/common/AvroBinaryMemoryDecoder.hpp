@@ -0,0 +1,265 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVROBINARYMEMORYDECODER_HPP_
+#define AVROBINARYMEMORYDECODER_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#include <avro/Decoder.hh>
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Avro binary decoder which reads encoded data directly from a memory buffer.
+ *
+ * The counterpart of @c AvroBinaryVectorEncoder: the class is final and all its methods are defined
+ * inline, so @c avro::codec_traits<T>::decode() of a generated record called with an object of this class
+ * has every primitive decoding resolved statically. Accepts the same input as @c avro::binaryDecoder().
+ *
+ * Throws @c KaaException if the data is truncated or malformed.
+ *
+ * NOT Thread safe.
+ */
+class AvroBinaryMemoryDecoder final : public avro::Decoder {
+public:
+    AvroBinaryMemoryDecoder() {}
+
+    AvroBinaryMemoryDecoder(const std::uint8_t *data, std::size_t size)
+    {
+        reset(data, size);
+    }
+
+    /**
+     * @brief Starts reading from the beginning of the given buffer.
+     */
+    void reset(const std::uint8_t *data, std::size_t size)
+    {
+        next_ = data;
+        end_ = data + size;
+    }
+
+    /**
+     * @brief Not supported, the decoder reads only from a buffer set by @c reset().
+     */
+    virtual void init(avro::InputStream& is)
+    {
+        throw KaaException("AvroBinaryMemoryDecoder doesn't support input streams");
+    }
+
+    virtual void decodeNull() {}
+
+    virtual bool decodeBool()
+    {
+        std::uint8_t value = *read(1);
+        if (value > 1) {
+            throw KaaException("Invalid value for bool");
+        }
+
+        return value == 1;
+    }
+
+    virtual std::int32_t decodeInt()
+    {
+        std::int64_t value = decodeVarint();
+        if (value < INT32_MIN || value > INT32_MAX) {
+            throw KaaException("Value out of range for Avro int");
+        }
+
+        return static_cast<std::int32_t>(value);
+    }
+
+    virtual std::int64_t decodeLong()
+    {
+        return decodeVarint();
+    }
+
+    virtual float decodeFloat()
+    {
+        float value;
+        std::memcpy(&value, read(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    virtual double decodeDouble()
+    {
+        double value;
+        std::memcpy(&value, read(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    using avro::Decoder::decodeString;
+    virtual void decodeString(std::string& value)
+    {
+        std::size_t size = decodeSize();
+        const char *data = reinterpret_cast<const char *>(read(size));
+        value.assign(data, data + size);
+    }
+
+    virtual void skipString()
+    {
+        read(decodeSize());
+    }
+
+    using avro::Decoder::decodeBytes;
+    virtual void decodeBytes(std::vector<std::uint8_t>& value)
+    {
+        std::size_t size = decodeSize();
+        const std::uint8_t *data = read(size);
+        value.assign(data, data + size);
+    }
+
+    virtual void skipBytes()
+    {
+        read(decodeSize());
+    }
+
+    using avro::Decoder::decodeFixed;
+    virtual void decodeFixed(std::size_t n, std::vector<std::uint8_t>& value)
+    {
+        const std::uint8_t *data = read(n);
+        value.assign(data, data + n);
+    }
+
+    virtual void skipFixed(std::size_t n)
+    {
+        read(n);
+    }
+
+    virtual std::size_t decodeEnum()
+    {
+        return decodeSize();
+    }
+
+    virtual std::size_t arrayStart()
+    {
+        return decodeBlockSize();
+    }
+
+    virtual std::size_t arrayNext()
+    {
+        return decodeBlockSize();
+    }
+
+    virtual std::size_t skipArray()
+    {
+        return skipBlocks();
+    }
+
+    virtual std::size_t mapStart()
+    {
+        return decodeBlockSize();
+    }
+
+    virtual std::size_t mapNext()
+    {
+        return decodeBlockSize();
+    }
+
+    virtual std::size_t skipMap()
+    {
+        return skipBlocks();
+    }
+
+    virtual std::size_t decodeUnionIndex()
+    {
+        return decodeSize();
+    }
+
+private:
+    const std::uint8_t *read(std::size_t len)
+    {
+        if (static_cast<std::size_t>(end_ - next_) < len) {
+            throw KaaException("Unexpected end of Avro data");
+        }
+
+        const std::uint8_t *data = next_;
+        next_ += len;
+        return data;
+    }
+
+    std::int64_t decodeVarint()
+    {
+        std::uint64_t value = 0;
+        std::size_t shift = 0;
+        std::uint8_t byte;
+
+        do {
+            if (shift >= 64) {
+                throw KaaException("Invalid Avro varint");
+            }
+
+            byte = *read(1);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        return static_cast<std::int64_t>((value >> 1) ^ -(value & 1));
+    }
+
+    std::size_t decodeSize()
+    {
+        std::int64_t value = decodeVarint();
+        if (value < 0) {
+            throw KaaException("Negative Avro length or index");
+        }
+
+        return static_cast<std::size_t>(value);
+    }
+
+    /*
+     * A negative block count is followed by the size of the block in bytes.
+     */
+    std::size_t decodeBlockSize()
+    {
+        std::int64_t count = decodeVarint();
+        if (count < 0) {
+            decodeVarint();
+            count = -count;
+        }
+
+        return static_cast<std::size_t>(count);
+    }
+
+    /*
+     * Skips blocks which have their size in bytes and returns the item count of the first block
+     * that must be skipped item by item.
+     */
+    std::size_t skipBlocks()
+    {
+        for (;;) {
+            std::int64_t count = decodeVarint();
+            if (count >= 0) {
+                return static_cast<std::size_t>(count);
+            }
+
+            read(decodeSize());
+        }
+    }
+
+private:
+    const std::uint8_t   *next_ = nullptr;
+    const std::uint8_t   *end_ = nullptr;
+};
+
+} /* namespace kaa */
+
+#endif /* AVROBINARYMEMORYDECODER_HPP_ */
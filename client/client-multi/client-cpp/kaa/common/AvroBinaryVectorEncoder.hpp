@@ -0,0 +1,188 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVROBINARYVECTORENCODER_HPP_
+#define AVROBINARYVECTORENCODER_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <avro/Encoder.hh>
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Avro binary encoder which writes encoded data directly into a caller-owned vector.
+ *
+ * The class is final and all its methods are defined inline, so when @c avro::codec_traits<T>::encode()
+ * of a generated record is called with an object of this class the compiler resolves every primitive
+ * encoding statically and inlines varint/zigzag encoding and copying of strings, bytes and fixed fields
+ * into the record encoder. Produces the same output as @c avro::binaryEncoder().
+ *
+ * Data is appended after the current end of the vector.
+ *
+ * NOT Thread safe.
+ */
+class AvroBinaryVectorEncoder final : public avro::Encoder {
+public:
+    AvroBinaryVectorEncoder() {}
+
+    explicit AvroBinaryVectorEncoder(std::vector<std::uint8_t>& buffer)
+    {
+        reset(buffer);
+    }
+
+    /**
+     * @brief Starts writing to the end of the given buffer.
+     */
+    void reset(std::vector<std::uint8_t>& buffer)
+    {
+        buffer_ = &buffer;
+    }
+
+    /**
+     * @brief Not supported, the encoder writes only into a vector set by @c reset().
+     */
+    virtual void init(avro::OutputStream& os)
+    {
+        throw KaaException("AvroBinaryVectorEncoder doesn't support output streams");
+    }
+
+    virtual void flush() {}
+
+    virtual void encodeNull() {}
+
+    virtual void encodeBool(bool b)
+    {
+        buffer_->push_back(b ? 1 : 0);
+    }
+
+    virtual void encodeInt(std::int32_t i)
+    {
+        encodeVarint(zigzag(i));
+    }
+
+    virtual void encodeLong(std::int64_t l)
+    {
+        encodeVarint(zigzag(l));
+    }
+
+    virtual void encodeFloat(float f)
+    {
+        encodeRaw(reinterpret_cast<const std::uint8_t *>(&f), sizeof(f));
+    }
+
+    virtual void encodeDouble(double d)
+    {
+        encodeRaw(reinterpret_cast<const std::uint8_t *>(&d), sizeof(d));
+    }
+
+    virtual void encodeString(const std::string& s)
+    {
+        encodeVarint(zigzag(static_cast<std::int64_t>(s.size())));
+        encodeRaw(reinterpret_cast<const std::uint8_t *>(s.data()), s.size());
+    }
+
+    using avro::Encoder::encodeBytes;
+    virtual void encodeBytes(const std::uint8_t *bytes, std::size_t len)
+    {
+        encodeVarint(zigzag(static_cast<std::int64_t>(len)));
+        encodeRaw(bytes, len);
+    }
+
+    using avro::Encoder::encodeFixed;
+    virtual void encodeFixed(const std::uint8_t *bytes, std::size_t len)
+    {
+        encodeRaw(bytes, len);
+    }
+
+    virtual void encodeEnum(std::size_t e)
+    {
+        encodeVarint(zigzag(static_cast<std::int64_t>(e)));
+    }
+
+    virtual void arrayStart() {}
+
+    virtual void arrayEnd()
+    {
+        buffer_->push_back(0);
+    }
+
+    virtual void mapStart() {}
+
+    virtual void mapEnd()
+    {
+        buffer_->push_back(0);
+    }
+
+    virtual void setItemCount(std::size_t count)
+    {
+        if (!count) {
+            throw KaaException("Item count can't be zero");
+        }
+
+        encodeVarint(zigzag(static_cast<std::int64_t>(count)));
+    }
+
+    virtual void startItem() {}
+
+    virtual void encodeUnionIndex(std::size_t e)
+    {
+        encodeVarint(zigzag(static_cast<std::int64_t>(e)));
+    }
+
+private:
+    static std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    void encodeVarint(std::uint64_t value)
+    {
+        if (value < 0x80) {
+            buffer_->push_back(static_cast<std::uint8_t>(value));
+            return;
+        }
+
+        std::uint8_t bytes[MAX_VARINT_SIZE];
+        std::size_t size = 0;
+
+        while (value >= 0x80) {
+            bytes[size++] = static_cast<std::uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        bytes[size++] = static_cast<std::uint8_t>(value);
+
+        encodeRaw(bytes, size);
+    }
+
+    void encodeRaw(const std::uint8_t *bytes, std::size_t len)
+    {
+        buffer_->insert(buffer_->end(), bytes, bytes + len);
+    }
+
+private:
+    static const std::size_t MAX_VARINT_SIZE = 10;
+
+    std::vector<std::uint8_t>   *buffer_ = nullptr;
+};
+
+} /* namespace kaa */
+
+#endif /* AVROBINARYVECTORENCODER_HPP_ */
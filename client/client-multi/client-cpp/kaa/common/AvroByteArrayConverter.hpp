@@ -21,6 +21,7 @@
 #include <memory>
 #include <sstream>
 #include <cstdint>
+#include <vector>
 
 #include <avro/Compiler.hh>
 #include <avro/Specific.hh>
@@ -29,12 +30,18 @@
 #include <avro/Decoder.hh>
 
 #include "kaa/common/EndpointObjectHash.hpp"
+#include "kaa/common/AvroVectorOutputStream.hpp"
+#include "kaa/common/AvroHashingOutputStream.hpp"
+#include "kaa/common/AvroBinaryVectorEncoder.hpp"
+#include "kaa/common/AvroBinaryMemoryDecoder.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
 /**
  * Used to convert predefined avro objects to/from bytes.
+ * In the binary mode objects are encoded and decoded through @c AvroBinaryVectorEncoder and
+ * @c AvroBinaryMemoryDecoder, so the generated codecs of <T> are specialized for them by the compiler.
  * NOT Thread safe.
  * @param <T> predefined avro object.
  */
@@ -78,14 +85,29 @@ public:
      */
     SharedDataBuffer toByteArray(const T& datum);
 
+    /**
+     * Converts object to byte array and calculates the hash of the encoded data along the way
+     * @param datum the encoding avro object
+     * @param hash the hash the encoded data is fed to, it is finalized after the conversion
+     * @return SharedDataBuffer result of a conversion
+     */
+    SharedDataBuffer toByteArray(const T& datum, EndpointObjectHash& hash);
+
     /**
      * Converts object to byte array
+     * Encodes directly into @c dest, so no copy is made and the capacity of @c dest is reused.
      * @param datum the encoding avro object
-     * @param dest the buffer that encoded data will be put in
-     * @return serialized bytes
+     * @param dest the buffer that encoded data will be put in (its previous content is discarded)
      */
     void toByteArray(const T& datum, std::vector<std::uint8_t>& dest);
 
+    /**
+     * Converts object to byte array appending encoded data after the current content of @c dest
+     * @param datum the encoding avro object
+     * @param dest the buffer that encoded data will be appended to
+     */
+    void appendToByteArray(const T& datum, std::vector<std::uint8_t>& dest);
+
     /**
      * Converts object to stream
      * @param datum the encoding avro object
@@ -93,22 +115,45 @@ public:
      */
     void toByteArray(const T& datum, std::ostream& stream);
 
+    /**
+     * Converts object to avro stream
+     * Encoded data is written directly to @c stream, e.g. @c AvroChunkedOutputStream.
+     * @param datum the encoding avro object
+     * @param stream the avro output stream that encoded data will be put in
+     */
+    void toByteArray(const T& datum, avro::OutputStream& stream);
+
     /**
      * Used for debug purpose
      */
     void switchToJson(const avro::ValidSchema &schema) {
         encoder_ = avro::jsonEncoder(schema);
         decoder_ = avro::jsonDecoder(schema);
+        isBinary_ = false;
     }
 
     void switchToBinary() {
         encoder_ = avro::binaryEncoder();
         decoder_ = avro::binaryDecoder();
+        isBinary_ = true;
     }
 
+private:
+    void encode(const T& datum, std::vector<std::uint8_t>& dest, EndpointObjectHash *hash = nullptr);
+    SharedDataBuffer copyEncodeBuffer() const;
+    void decode(const std::uint8_t* data, const std::uint32_t& dataSize, T& datum);
+
 private:
     avro::EncoderPtr   encoder_;
     avro::DecoderPtr   decoder_;
+    bool               isBinary_ = true;
+
+    AvroBinaryVectorEncoder      binaryEncoder_;
+    AvroBinaryMemoryDecoder      binaryDecoder_;
+
+    AvroVectorOutputStream       outputStream_;
+    std::unique_ptr<AvroHashingOutputStream> hashingStream_;
+    std::vector<std::uint8_t>    encodeBuffer_;
 };
 
 template<typename T>
@@ -125,10 +170,7 @@ T AvroByteArrayConverter<T>::fromByteArray(const std::uint8_t* data, const std::
     }
 
     T datum;
-    std::unique_ptr<avro::InputStream> in = avro::memoryInputStream(data, dataSize);
-
-    decoder_->init(*in);
-    avro::decode(*decoder_, datum);
+    decode(data, dataSize, datum);
 
     return datum;
 }
@@ -140,33 +182,35 @@ void AvroByteArrayConverter<T>::fromByteArray(const std::uint8_t* data, const st
         throw KaaException("invalid data to decode");
     }
 
-    std::unique_ptr<avro::InputStream> in = avro::memoryInputStream(data, dataSize);
-
-    decoder_->init(*in);
-    avro::decode(*decoder_, datum);
+    decode(data, dataSize, datum);
 }
 
 template<typename T>
 SharedDataBuffer AvroByteArrayConverter<T>::toByteArray(const T& datum)
 {
-    std::stringstream ostream;
-    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(ostream);
-
-    encoder_->init(*out);
-    avro::encode(*encoder_, datum);
-    encoder_->flush();
+    encodeBuffer_.clear();
+    encode(datum, encodeBuffer_);
 
-    SharedDataBuffer buffer;
+    return copyEncodeBuffer();
+}
 
-    std::streampos beg = ostream.tellg();
-    ostream.seekg(0, std::ios_base::end);
+template<typename T>
+SharedDataBuffer AvroByteArrayConverter<T>::toByteArray(const T& datum, EndpointObjectHash& hash)
+{
+    encodeBuffer_.clear();
+    encode(datum, encodeBuffer_, &hash);
+    hash.finalize();
 
-    std::streampos end = ostream.tellg();
-    ostream.seekg(0, std::ios_base::beg);
+    return copyEncodeBuffer();
+}
 
-    buffer.second = end - beg;
-    buffer.first.reset(new uint8_t[buffer.second]);
-    std::copy(std::istreambuf_iterator<char>(ostream), std::istreambuf_iterator<char>(), buffer.first.get());
+template<typename T>
+SharedDataBuffer AvroByteArrayConverter<T>::copyEncodeBuffer() const
+{
+    SharedDataBuffer buffer;
+    buffer.second = encodeBuffer_.size();
+    buffer.first.reset(new std::uint8_t[buffer.second]);
+    std::copy(encodeBuffer_.begin(), encodeBuffer_.end(), buffer.first.get());
 
     return buffer;
 }
@@ -174,21 +218,63 @@ SharedDataBuffer AvroByteArrayConverter<T>::toByteArray(const T& datum)
 template<typename T>
 void AvroByteArrayConverter<T>::toByteArray(const T& datum, std::vector<std::uint8_t>& dest)
 {
-    std::stringstream ostream;
-    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(ostream);
+    dest.clear();
+    encode(datum, dest);
+}
+
+template<typename T>
+void AvroByteArrayConverter<T>::appendToByteArray(const T& datum, std::vector<std::uint8_t>& dest)
+{
+    encode(datum, dest);
+}
+
+template<typename T>
+void AvroByteArrayConverter<T>::encode(const T& datum, std::vector<std::uint8_t>& dest, EndpointObjectHash *hash)
+{
+    if (isBinary_) {
+        const std::size_t start = dest.size();
+        binaryEncoder_.reset(dest);
+        avro::encode(binaryEncoder_, datum);
+
+        /*
+         * The encoded data is still in cache.
+         */
+        if (hash) {
+            hash->update(dest.data() + start, dest.size() - start);
+        }
+        return;
+    }
+
+    /*
+     * The encoder backs up data left from a failed encoding on init, so the streams are reset after that.
+     */
+    if (hash) {
+        std::unique_ptr<AvroHashingOutputStream> hashingStream(new AvroHashingOutputStream(outputStream_, *hash));
+        encoder_->init(*hashingStream);
+        hashingStream_ = std::move(hashingStream);
+    } else {
+        encoder_->init(outputStream_);
+        hashingStream_.reset();
+    }
+    outputStream_.reset(dest);
 
-    encoder_->init(*out);
     avro::encode(*encoder_, datum);
     encoder_->flush();
+}
 
-    std::streampos beg = ostream.tellg();
-    ostream.seekg(0, std::ios_base::end);
+template<typename T>
+void AvroByteArrayConverter<T>::decode(const std::uint8_t* data, const std::uint32_t& dataSize, T& datum)
+{
+    if (isBinary_) {
+        binaryDecoder_.reset(data, dataSize);
+        avro::decode(binaryDecoder_, datum);
+        return;
+    }
 
-    std::streampos end = ostream.tellg();
-    ostream.seekg(0, std::ios_base::beg);
+    std::unique_ptr<avro::InputStream> in = avro::memoryInputStream(data, dataSize);
 
-    dest.reserve(end - beg);
-    dest.assign(std::istreambuf_iterator<char>(ostream), std::istreambuf_iterator<char>());
+    decoder_->init(*in);
+    avro::decode(*decoder_, datum);
 }
 
 template<typename T>
@@ -201,6 +287,22 @@ void AvroByteArrayConverter<T>::toByteArray(const T& datum, std::ostream& stream
     encoder_->flush();
 }
 
+template<typename T>
+void AvroByteArrayConverter<T>::toByteArray(const T& datum, avro::OutputStream& stream)
+{
+    encoder_->init(stream);
+    try {
+        avro::encode(*encoder_, datum);
+        encoder_->flush();
+    } catch (...) {
+        /*
+         * The data left from the failed encoding is backed up now, while the stream is alive.
+         */
+        encoder_->init(outputStream_);
+        throw;
+    }
+}
+
 } /* namespace kaa */
 
 #endif /* AVROBYTEARRAYCONVERTER_HPP_ */
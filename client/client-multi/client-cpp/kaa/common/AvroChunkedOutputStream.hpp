@@ -0,0 +1,148 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVROCHUNKEDOUTPUTSTREAM_HPP_
+#define AVROCHUNKEDOUTPUTSTREAM_HPP_
+
+#include <vector>
+#include <cstdint>
+
+#include <boost/asio/buffer.hpp>
+
+#include <avro/Stream.hh>
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Process-wide freelist of fixed-size chunks which @c AvroChunkedOutputStream writes encoded data to.
+ *
+ * Released chunks are kept for reuse up to @c MAX_FREE_CHUNKS, so encoding requests of a steady size
+ * doesn't allocate memory.
+ *
+ * Thread safe.
+ */
+class AvroChunkPool {
+public:
+    static const std::size_t CHUNK_SIZE = 4096;
+    static const std::size_t MAX_FREE_CHUNKS = 64;
+
+    ~AvroChunkPool();
+
+    /**
+     * @brief Returns a chunk of @c CHUNK_SIZE bytes, a free one if any.
+     */
+    std::uint8_t *acquire();
+
+    /**
+     * @brief Returns the chunk got from @c acquire() to the pool.
+     */
+    void release(std::uint8_t *chunk);
+
+    std::size_t getFreeChunkCount();
+
+    static AvroChunkPool& getInstance();
+
+private:
+    std::vector<std::uint8_t *>   freeChunks_;
+    KAA_MUTEX_DECLARE(poolGuard_);
+};
+
+/**
+ * @brief Avro output stream which writes encoded data into a list of pooled chunks.
+ *
+ * No contiguous buffer of the encoded size is ever allocated. The data is handed over as a buffer
+ * sequence, so it can be written by a gather write or copied to the destination chunk by chunk.
+ * The chunks are returned to the pool on @c clear() and on destruction.
+ *
+ * NOT Thread safe.
+ */
+class AvroChunkedOutputStream : public avro::OutputStream {
+public:
+    explicit AvroChunkedOutputStream(AvroChunkPool& pool = AvroChunkPool::getInstance())
+        : pool_(pool) {}
+
+    AvroChunkedOutputStream(const AvroChunkedOutputStream&) = delete;
+    AvroChunkedOutputStream& operator=(const AvroChunkedOutputStream&) = delete;
+
+    ~AvroChunkedOutputStream()
+    {
+        clear();
+    }
+
+    virtual bool next(std::uint8_t** data, std::size_t* len)
+    {
+        if (chunks_.empty() || lastChunkUsed_ == AvroChunkPool::CHUNK_SIZE) {
+            chunks_.push_back(pool_.acquire());
+            lastChunkUsed_ = 0;
+        }
+
+        *data = chunks_.back() + lastChunkUsed_;
+        *len = AvroChunkPool::CHUNK_SIZE - lastChunkUsed_;
+        lastChunkUsed_ = AvroChunkPool::CHUNK_SIZE;
+
+        return true;
+    }
+
+    virtual void backup(std::size_t len)
+    {
+        lastChunkUsed_ -= len;
+    }
+
+    virtual std::uint64_t byteCount() const
+    {
+        return chunks_.empty() ? 0 : (chunks_.size() - 1) * AvroChunkPool::CHUNK_SIZE + lastChunkUsed_;
+    }
+
+    virtual void flush() {}
+
+    bool empty() const
+    {
+        return !byteCount();
+    }
+
+    /**
+     * @brief Appends raw data after the current content.
+     */
+    void write(const std::uint8_t *data, std::size_t size);
+
+    /**
+     * @brief Returns the written data as a buffer sequence, one buffer per chunk.
+     *
+     * The buffers are valid until the stream is written to or cleared.
+     */
+    std::vector<boost::asio::const_buffer> getBuffers() const;
+
+    /**
+     * @brief Copies the written data to @c dest, which must have room for @c byteCount() bytes.
+     */
+    void copyTo(std::uint8_t *dest) const;
+
+    /**
+     * @brief Drops the written data, the chunks are returned to the pool.
+     */
+    void clear();
+
+private:
+    AvroChunkPool&                pool_;
+    std::vector<std::uint8_t *>   chunks_;
+    std::size_t                   lastChunkUsed_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* AVROCHUNKEDOUTPUTSTREAM_HPP_ */
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVROHASHINGOUTPUTSTREAM_HPP_
+#define AVROHASHINGOUTPUTSTREAM_HPP_
+
+#include <cstdint>
+
+#include <avro/Stream.hh>
+
+#include "kaa/common/EndpointObjectHash.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Avro output stream which passes the encoded data to another stream and feeds it to a hash.
+ *
+ * A chunk handed out to the encoder is hashed once the encoder asks for the next one or flushes the stream,
+ * so the data backed up by the encoder is never hashed. The hash is completed by the caller with
+ * @link EndpointObjectHash::finalize() @endlink after the stream is flushed.
+ *
+ * NOT Thread safe.
+ */
+class AvroHashingOutputStream : public avro::OutputStream {
+public:
+    AvroHashingOutputStream(avro::OutputStream& out, EndpointObjectHash& hash)
+        : out_(out), hash_(hash) {}
+
+    virtual bool next(std::uint8_t** data, std::size_t* len)
+    {
+        hashChunk();
+
+        if (!out_.next(data, len)) {
+            return false;
+        }
+
+        chunk_ = *data;
+        chunkSize_ = *len;
+        return true;
+    }
+
+    virtual void backup(std::size_t len)
+    {
+        chunkSize_ -= len;
+        out_.backup(len);
+    }
+
+    virtual std::uint64_t byteCount() const
+    {
+        return out_.byteCount();
+    }
+
+    virtual void flush()
+    {
+        hashChunk();
+        out_.flush();
+    }
+
+private:
+    void hashChunk()
+    {
+        if (chunkSize_) {
+            hash_.update(chunk_, chunkSize_);
+        }
+
+        chunk_ = nullptr;
+        chunkSize_ = 0;
+    }
+
+private:
+    avro::OutputStream&   out_;
+    EndpointObjectHash&   hash_;
+
+    std::uint8_t         *chunk_ = nullptr;
+    std::size_t           chunkSize_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* AVROHASHINGOUTPUTSTREAM_HPP_ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVROVECTOROUTPUTSTREAM_HPP_
+#define AVROVECTOROUTPUTSTREAM_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <avro/Stream.hh>
+
+namespace kaa {
+
+/**
+ * @brief Avro output stream which writes encoded data directly into a caller-owned vector.
+ *
+ * Data is appended after the current end of the vector, which grows geometrically, so its capacity
+ * is reused across encodings if the vector is kept between them. The vector is trimmed to the
+ * encoded data on @c flush().
+ *
+ * NOT Thread safe.
+ */
+class AvroVectorOutputStream : public avro::OutputStream {
+public:
+    AvroVectorOutputStream() {}
+
+    explicit AvroVectorOutputStream(std::vector<std::uint8_t>& buffer)
+    {
+        reset(buffer);
+    }
+
+    /**
+     * @brief Starts writing to the end of the given buffer.
+     */
+    void reset(std::vector<std::uint8_t>& buffer)
+    {
+        buffer_ = &buffer;
+        used_ = buffer.size();
+        start_ = used_;
+    }
+
+    virtual bool next(std::uint8_t** data, std::size_t* len)
+    {
+        if (used_ == buffer_->size()) {
+            std::size_t newSize = std::max(buffer_->capacity(), buffer_->size() * 2);
+            if (newSize < MIN_CHUNK_SIZE) {
+                newSize = MIN_CHUNK_SIZE;
+            }
+            buffer_->resize(newSize);
+        }
+
+        *data = buffer_->data() + used_;
+        *len = buffer_->size() - used_;
+        used_ = buffer_->size();
+
+        return true;
+    }
+
+    virtual void backup(std::size_t len)
+    {
+        used_ -= len;
+    }
+
+    virtual std::uint64_t byteCount() const
+    {
+        return used_ - start_;
+    }
+
+    virtual void flush()
+    {
+        buffer_->resize(used_);
+    }
+
+public:
+    static const std::size_t MIN_CHUNK_SIZE = 256;
+
+private:
+    std::vector<std::uint8_t>   *buffer_ = nullptr;
+    std::size_t                  start_ = 0;
+    std::size_t                  used_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* AVROVECTOROUTPUTSTREAM_HPP_ */
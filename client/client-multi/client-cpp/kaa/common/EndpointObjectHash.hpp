@@ -19,11 +19,17 @@
 
 #include <utility>
 #include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <cstdint>
 #include <boost/shared_array.hpp>
 
+namespace Botan {
+class SHA_160;
+}
+
 namespace kaa {
 
 typedef std::pair<boost::shared_array<std::uint8_t>, std::uint32_t> SharedDataBuffer;
@@ -31,11 +37,16 @@ typedef std::vector<std::uint8_t> HashDigest;
 
 /**
  * Used to calculate SHA-1 hash
+ *
+ * The hash is calculated either over a single buffer passed to the constructor or over a sequence of parts
+ * passed to @link update() @endlink and completed by @link finalize() @endlink, so the data doesn't have
+ * to be gathered in one buffer first. Copies carry the digest only, not the pending parts.
  */
 class EndpointObjectHash
 {
 public:
-    EndpointObjectHash() { }
+    EndpointObjectHash();
+    ~EndpointObjectHash();
 
     /*
      * Specific constructors
@@ -59,6 +70,28 @@ public:
      */
     EndpointObjectHash& operator=(EndpointObjectHash&& endpointHash);
 
+    /**
+     * Feeds the next part of the hashed data.
+     * Throws \ref KaaException when invalid data was passed (null buffer of non-zero size)
+     */
+    EndpointObjectHash& update(const std::uint8_t* data, std::size_t dataSize);
+
+    EndpointObjectHash& update(const std::string& str)
+    {
+        return update(reinterpret_cast<const std::uint8_t *>(str.data()), str.size());
+    }
+
+    /**
+     * Completes the digest of the parts passed to @link update() @endlink.
+     * The next @link update() @endlink starts a new hash.
+     */
+    void finalize();
+
+    /**
+     * Creates the hash from the previously calculated digest
+     */
+    static EndpointObjectHash fromDigest(const HashDigest& digest);
+
     /**
      * Retrieves digest
      * @return Buffer with digest or empty one if no data was put
@@ -84,6 +117,7 @@ private:
 
 private:
     std::vector<std::uint8_t> hashDigest_;
+    std::unique_ptr<Botan::SHA_160> hashFunction_;
 };
 
 } /* namespace kaa */
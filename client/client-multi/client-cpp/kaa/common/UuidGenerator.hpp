@@ -20,38 +20,48 @@
 #include "kaa/KaaDefaults.hpp"
 
 #include <string>
-#include <sstream>
+#include <cstdint>
 #include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/name_generator.hpp>
-#include <boost/uuid/random_generator.hpp>
+
+#include "kaa/utils/RandomGenerator.hpp"
 
 namespace kaa {
 
+/**
+ * Generates random (version 4) UUIDs and request ids with the thread's @c RandomGenerator,
+ * so no random engine is set up per call.
+ */
 class UuidGenerator {
 public:
     static std::string generateUuid() {
-        boost::uuids::basic_random_generator<boost::mt19937> gen;
-        boost::uuids::uuid uuid = gen();
-        std::stringstream ss;
-        ss << uuid;
-        return ss.str();
+        std::string uuid_s;
+        generateUuid(uuid_s);
+        return uuid_s;
     }
 
     static std::int32_t generateRandomInt() {
-        boost::uuids::basic_random_generator<boost::mt19937> gen;
-        boost::uuids::uuid uuid = gen();
-		std::int32_t rand = (uuid.data[12] << 24) | (uuid.data[13] << 16)
-				| (uuid.data[14] << 8) | (uuid.data[15]);
-		return rand;
+        return RandomGenerator::generateInt();
     }
 
+    /*
+     * Doesn't allocate memory if the string already has the capacity for a UUID.
+     */
     static void generateUuid(std::string& uuid_s) {
-        boost::uuids::basic_random_generator<boost::mt19937> gen;
-        boost::uuids::uuid uuid = gen();
-        std::stringstream ss;
-        ss << uuid;
-        uuid_s.assign(ss.str());
+        auto& generator = RandomGenerator::getThreadGenerator();
+        const std::uint64_t high = generator();
+        const std::uint64_t low = generator();
+
+        std::uint8_t data[UUID_SIZE];
+        for (std::size_t i = 0; i < 8; ++i) {
+            data[i] = static_cast<std::uint8_t>(high >> (56 - 8 * i));
+            data[i + 8] = static_cast<std::uint8_t>(low >> (56 - 8 * i));
+        }
+
+        data[6] = (data[6] & 0x0F) | 0x40; // Version 4 (random).
+        data[8] = (data[8] & 0x3F) | 0x80; // RFC 4122 variant.
+
+        format(data, uuid_s);
     }
 
     static void generateUuid(std::string& uuid_s, std::string data) {
@@ -60,9 +70,27 @@ public:
         buuids::name_generator generator(seed);
         buuids::uuid uuid = generator(data);
 
-        std::stringstream ss;
-        ss << uuid;
-        uuid_s.assign(ss.str());
+        format(uuid.data, uuid_s);
+    }
+
+private:
+    static const std::size_t UUID_SIZE = 16;
+    static const std::size_t UUID_STRING_LENGTH = 36;
+
+    static void format(const std::uint8_t *data, std::string& uuid_s) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+
+        char buffer[UUID_STRING_LENGTH];
+        std::size_t position = 0;
+        for (std::size_t i = 0; i < UUID_SIZE; ++i) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) {
+                buffer[position++] = '-';
+            }
+            buffer[position++] = HEX_DIGITS[data[i] >> 4];
+            buffer[position++] = HEX_DIGITS[data[i] & 0x0F];
+        }
+
+        uuid_s.assign(buffer, UUID_STRING_LENGTH);
     }
 };
 
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef USERATTACHEXCEPTION_HPP_
+#define USERATTACHEXCEPTION_HPP_
+
+#include "KaaException.hpp"
+#include "kaa/gen/EndpointGen.hpp"
+
+namespace kaa {
+
+/**
+ * @brief The exception is thrown to indicate that the server has declined to attach the endpoint to the user.
+ */
+class UserAttachException: public KaaException {
+public:
+    UserAttachException(UserAttachErrorCode errorCode, const std::string& reason)
+        : KaaException(boost::format("Failed to attach to user (error %d): %s") % static_cast<int>(errorCode) % reason)
+        , errorCode_(errorCode), reason_(reason) {}
+
+    UserAttachErrorCode getErrorCode() const { return errorCode_; }
+
+    const std::string& getReason() const { return reason_; }
+
+private:
+    UserAttachErrorCode    errorCode_;
+    std::string            reason_;
+};
+
+} /* namespace kaa */
+
+#endif /* USERATTACHEXCEPTION_HPP_ */
@@ -17,6 +17,9 @@
 #ifndef CONFIGURATION_MANAGER_HPP_
 #define CONFIGURATION_MANAGER_HPP_
 
+#include <atomic>
+#include <memory>
+
 #include "kaa/observer/KaaObservable.hpp"
 
 #include "kaa/IKaaClientStateStorage.hpp"
@@ -52,6 +55,7 @@ public:
     virtual void addReceiver(IConfigurationReceiver &receiver);
     virtual void removeReceiver(IConfigurationReceiver &receiver);
     virtual const KaaRootConfiguration& getConfiguration();
+    virtual std::shared_ptr<const KaaRootConfiguration> getConfigurationSnapshot();
 
     virtual void setConfigurationStorage(IConfigurationStoragePtr storage);
 
@@ -74,8 +78,9 @@ public:
 
 private:
     void updateConfiguration(const std::uint8_t* data, const std::uint32_t dataSize);
+    void updateConfiguration(const std::uint8_t* data, const std::uint32_t dataSize, EndpointObjectHash&& hash);
     void loadConfiguration();
-    void notifySubscribers(const KaaRootConfiguration& configuration);
+    void notifySubscribers();
 
 private:
     bool isConfigurationLoaded_;
@@ -83,6 +88,17 @@ private:
     IKaaClientContext &context_;
     KaaRootConfiguration configuration_;
 
+    /*
+     * The copy of the configuration which is published by std::atomic_store() on each update.
+     */
+    std::shared_ptr<const KaaRootConfiguration> configurationSnapshot_;
+
+    /*
+     * Set while a notification waits in the callback executor. Updates arriving meanwhile
+     * are delivered by it, so receivers skip stale intermediate configurations.
+     */
+    std::atomic<bool> isNotificationPending_;
+
     IConfigurationStoragePtr storage_;
     EndpointObjectHash configurationHash_;
 
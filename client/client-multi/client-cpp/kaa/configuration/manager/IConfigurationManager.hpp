@@ -57,6 +57,16 @@ public:
      */
     virtual const KaaRootConfiguration& getConfiguration() = 0;
 
+    /**
+     * Returns the immutable copy of the current configuration tree without locking.
+     *
+     * Unlike @link getConfiguration() @endlink, the copy stays unchanged while it is held,
+     * so it may be read concurrently with configuration updates.
+     *
+     * @return The current configuration tree.
+     */
+    virtual std::shared_ptr<const KaaRootConfiguration> getConfigurationSnapshot() = 0;
+
     /**
      * Provide storage object which is able to persist encoded configuration data.
      *
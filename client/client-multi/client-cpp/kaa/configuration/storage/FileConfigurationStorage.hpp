@@ -24,6 +24,13 @@
 
 namespace kaa {
 
+/**
+ * Keeps the configuration in a file with a header holding the configuration hash.
+ *
+ * The file is replaced atomically: data are written to a temporary file which is renamed over
+ * the previous one, so a crash never leaves a partially written configuration. The file is
+ * memory-mapped on load. Files without the header, written by older SDK versions, are loaded as is.
+ */
 class FileConfigurationStorage : public IConfigurationStorage {
 public:
     FileConfigurationStorage(const std::string& filename) : filename_(filename) { }
@@ -31,6 +38,8 @@ public:
 
     virtual void saveConfiguration(const std::vector<std::uint8_t>& bytes);
     virtual std::vector<std::uint8_t> loadConfiguration();
+    virtual void saveConfigurationWithHash(const std::vector<std::uint8_t>& bytes, const HashDigest& hash);
+    virtual std::vector<std::uint8_t> loadConfigurationWithHash(HashDigest& hash);
     virtual void clearConfiguration();
 
 private:
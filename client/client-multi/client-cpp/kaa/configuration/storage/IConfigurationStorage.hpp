@@ -21,6 +21,8 @@
 #include <memory>
 #include <cstdint>
 
+#include "kaa/common/EndpointObjectHash.hpp"
+
 namespace kaa {
 
 /**
@@ -45,6 +47,30 @@ public:
      */
     virtual std::vector<std::uint8_t> loadConfiguration() = 0;
 
+    /**
+     * Persists configuration data along with its SHA-1 hash, so loading it doesn't require hashing.
+     * The default implementation doesn't keep the hash.
+     *
+     * @param bytes Configuration binary data.
+     * @param hash  SHA-1 digest of the data.
+     */
+    virtual void saveConfigurationWithHash(const std::vector<std::uint8_t>& bytes, const HashDigest& hash)
+    {
+        saveConfiguration(bytes);
+    }
+
+    /**
+     * Loads configuration data and the hash saved with it.
+     *
+     * @param[out] hash SHA-1 digest of the data, empty if the storage doesn't keep it.
+     * @return Configuration binary data.
+     */
+    virtual std::vector<std::uint8_t> loadConfigurationWithHash(HashDigest& hash)
+    {
+        hash.clear();
+        return loadConfiguration();
+    }
+
     /**
      * Clear configuration data (file).
      */
@@ -21,10 +21,20 @@
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/utils/ThreadPool.hpp"
+#include "kaa/utils/WorkStealingThreadPool.hpp"
 #include "kaa/context/IExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+/**
+ * @brief Thread pool implementations executors can be created with.
+ */
+enum class ThreadPoolType {
+    SHARED_QUEUE,     ///< @c ThreadPool: all workers take tasks from one queue.
+    WORK_STEALING     ///< @c WorkStealingThreadPool: per-worker queues, less contention with many workers.
+};
+
 class AbstractExecutorContext : public IExecutorContext {
 public:
     AbstractExecutorContext()
@@ -44,14 +54,49 @@ public:
         return awaitTerminationTimeout_;
     }
 
+    /**
+     * @brief Limits the task queue of the callback executor, so bursts of server messages
+     * (e.g. notifications replayed after a reconnect) don't grow it without bound.
+     *
+     * With the @c BLOCK or @c COALESCE policy the thread reading server messages waits for room
+     * in the queue, which throttles reading from the connection.
+     *
+     * @note Takes effect on the next @c init(). Supported by the @c SHARED_QUEUE thread pools only.
+     */
+    void setCallbackQueueSettings(const TaskQueueSettings& settings)
+    {
+        callbackQueueSettings_ = settings;
+    }
+
+    const TaskQueueSettings& getCallbackQueueSettings() const
+    {
+        return callbackQueueSettings_;
+    }
+
 protected:
     virtual void doInit() = 0;
     virtual void doStop() = 0;
 
 protected:
-    IThreadPoolPtr createExecutor(std::size_t threadCount)
+    /**
+     * @throw KaaException The work-stealing pool is requested with a bounded task queue
+     * or the SDK is built without threads.
+     */
+    IThreadPoolPtr createExecutor(std::size_t threadCount, ThreadPoolType type = ThreadPoolType::SHARED_QUEUE,
+                                  const ThreadPoolWorkerInitializer& workerInitializer = ThreadPoolWorkerInitializer(),
+                                  const TaskQueueSettings& queueSettings = TaskQueueSettings())
     {
-        return std::make_shared<ThreadPool>(threadCount);
+#ifdef KAA_USE_SINGLE_THREAD
+        throw KaaException("Thread pools aren't available in the single-threaded build, use PollingExecutorContext");
+#else
+        if (type == ThreadPoolType::WORK_STEALING) {
+            if (queueSettings.capacity_) {
+                throw KaaException("Work-stealing thread pool doesn't support bounded task queues");
+            }
+            return std::make_shared<WorkStealingThreadPool>(threadCount, workerInitializer);
+        }
+        return std::make_shared<ThreadPool>(threadCount, workerInitializer, queueSettings);
+#endif
     }
 
     void shutdownExecutor(IThreadPoolPtr threadPool)
@@ -67,6 +112,8 @@ private:
     KAA_MUTEX_DECLARE(useCountGuard_);
 
     std::size_t awaitTerminationTimeout_; // in seconds
+
+    TaskQueueSettings callbackQueueSettings_;
 };
 
 } /* namespace kaa */
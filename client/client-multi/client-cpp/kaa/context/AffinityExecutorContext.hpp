@@ -0,0 +1,76 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AFFINITYEXECUTORCONTEXT_HPP_
+#define AFFINITYEXECUTORCONTEXT_HPP_
+
+#include <memory>
+
+#include "kaa/utils/ThreadSettings.hpp"
+#include "kaa/context/AbstractExecutorContext.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Executor context whose threads are pinned to CPUs and run with the given scheduling policy.
+ *
+ * Each executor has its own settings, e.g. callbacks may be kept off the CPUs the life cycle executor
+ * runs on, or API threads may be bound to the CPUs of one NUMA node. Threads are also named after
+ * their executors to be told apart in debuggers and profilers.
+ *
+ * @note Affinity, scheduling policies and names are applied on Linux only.
+ */
+class AffinityExecutorContext : public AbstractExecutorContext {
+public:
+    struct PoolSettings {
+        std::size_t       threadCount_ = 1;
+        ThreadSettings    threadSettings_;
+    };
+
+    /**
+     * @throw KaaException Zero thread count or invalid thread settings.
+     */
+    AffinityExecutorContext(const PoolSettings& lifeCycleSettings
+                          , const PoolSettings& apiSettings
+                          , const PoolSettings& callbackSettings
+                          , ThreadPoolType threadPoolType = ThreadPoolType::SHARED_QUEUE);
+
+    virtual IThreadPool& getLifeCycleExecutor() { return *lifeCycleExecutor_; }
+    virtual IThreadPool& getApiExecutor() { return *apiExecutor_; }
+    virtual IThreadPool& getCallbackExecutor() { return *callbackExecutor_; }
+
+protected:
+    virtual void doInit();
+    virtual void doStop();
+
+private:
+    IThreadPoolPtr createPinnedExecutor(const PoolSettings& settings,
+                                        const TaskQueueSettings& queueSettings = TaskQueueSettings());
+
+private:
+    const PoolSettings      apiSettings_;
+    const PoolSettings      callbackSettings_;
+    const PoolSettings      lifeCycleSettings_;
+    const ThreadPoolType    threadPoolType_;
+
+    IThreadPoolPtr    apiExecutor_;
+    IThreadPoolPtr    callbackExecutor_;
+    IThreadPoolPtr    lifeCycleExecutor_;
+};
+
+} /* namespace kaa */
+
+#endif /* AFFINITYEXECUTORCONTEXT_HPP_ */
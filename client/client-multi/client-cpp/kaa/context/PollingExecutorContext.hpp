@@ -0,0 +1,104 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POLLINGEXECUTORCONTEXT_HPP_
+#define POLLINGEXECUTORCONTEXT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <boost/asio.hpp>
+
+#include "kaa/utils/IoServicePool.hpp"
+#include "kaa/context/AbstractExecutorContext.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Executor context without threads: all client work is run by the application calling @c poll(),
+ * e.g. from its own event loop, so callbacks come in a deterministic order on the polling thread.
+ *
+ * Executor tasks, TCP channel I/O (the channel should use @c getIoServicePool()) and timers are
+ * all run by @c poll(). Pass the context to the @link KaaClientPlatformContext @endlink along with
+ * its I/O service pool and call @link IKaaClient::poll() @endlink regularly.
+ *
+ * @note Timers are process-wide, so only one polling context may exist at a time and it should be
+ * created before any timer of the process is started. Callback queue settings don't apply.
+ * HTTP requests (e.g. bootstrap ones) are still blocking and stall @c poll() while they run.
+ */
+class PollingExecutorContext : public AbstractExecutorContext {
+public:
+    /**
+     * @throw KaaException Timers are already run by the timer service thread or by another polling context.
+     */
+    PollingExecutorContext();
+    ~PollingExecutorContext();
+
+    IoServicePoolPtr getIoServicePool() { return ioServicePool_; }
+
+    virtual IThreadPool& getLifeCycleExecutor() { return *lifeCycleExecutor_; }
+    virtual IThreadPool& getApiExecutor() { return *apiExecutor_; }
+    virtual IThreadPool& getCallbackExecutor() { return *callbackExecutor_; }
+
+    /**
+     * @brief Runs expired timers, executor tasks and I/O handlers ready now. If there are none,
+     * waits for them at most for the timeout.
+     *
+     * Call from one thread at a time, not from the client's callbacks.
+     *
+     * @return The number of events handled, zero if the timeout has expired.
+     */
+    std::size_t poll(std::chrono::milliseconds timeout);
+
+protected:
+    virtual void doInit();
+    virtual void doStop();
+
+private:
+    typedef boost::asio::basic_waitable_timer<std::chrono::steady_clock> WakeUpTimer;
+
+    /*
+     * Runs I/O handlers by the given run function, not counting the wake-ups of the polling loop.
+     */
+    template <typename RunFunction>
+    std::size_t runIoHandlers(RunFunction run);
+
+private:
+    IoServicePoolPtr            ioServicePool_;
+    boost::asio::io_service&    io_;
+
+    /*
+     * Interrupts waiting for I/O at the next timer deadline or the poll timeout.
+     */
+    WakeUpTimer    wakeUpTimer_;
+
+    /*
+     * Handlers waking up the polling loop, shared with the handlers that may outlive the context.
+     */
+    std::shared_ptr<std::atomic<std::size_t>>    wakeUpCount_;
+
+    IThreadPoolPtr    apiExecutor_;
+    IThreadPoolPtr    callbackExecutor_;
+    IThreadPoolPtr    lifeCycleExecutor_;
+};
+
+typedef std::shared_ptr<PollingExecutorContext> PollingExecutorContextPtr;
+
+} /* namespace kaa */
+
+#endif /* POLLINGEXECUTORCONTEXT_HPP_ */
@@ -25,9 +25,14 @@ namespace kaa {
 
 class SimpleExecutorContext : public AbstractExecutorContext {
 public:
+    /**
+     * @param[in] threadPoolType    The thread pool implementation of all executors. The work-stealing one
+     *                              pays off when executors (e.g. the callback one) have several threads.
+     */
     SimpleExecutorContext(std::size_t lifeCycleThreadCount = DEFAULT_THREAD_COUNT
                         , std::size_t apiThreadCount = DEFAULT_THREAD_COUNT
-                        , std::size_t callbackThreadCount = DEFAULT_THREAD_COUNT);
+                        , std::size_t callbackThreadCount = DEFAULT_THREAD_COUNT
+                        , ThreadPoolType threadPoolType = ThreadPoolType::SHARED_QUEUE);
 
     virtual IThreadPool& getLifeCycleExecutor() { return *lifeCycleExecutor_; }
     virtual IThreadPool& getApiExecutor() { return *apiExecutor_; }
@@ -44,6 +49,7 @@ private:
     const std::size_t    apiThreadCount_;
     const std::size_t    callbackThreadCount_;
     const std::size_t    lifeCycleThreadCount_;
+    const ThreadPoolType threadPoolType_;
 
     IThreadPoolPtr    apiExecutor_;
     IThreadPoolPtr    callbackExecutor_;
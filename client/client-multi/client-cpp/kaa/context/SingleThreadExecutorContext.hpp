@@ -17,25 +17,60 @@
 #ifndef SINGLETHREADEXECUTORCONTEXT_HPP_
 #define SINGLETHREADEXECUTORCONTEXT_HPP_
 
+#include <memory>
+
 #include "kaa/context/AbstractExecutorContext.hpp"
+#include "kaa/utils/PriorityThreadPool.hpp"
 
 namespace kaa {
 
+/**
+ * @brief Executor context running all client work on one thread.
+ *
+ * Tasks run by priority rather than in the order they were added: life cycle tasks first, then
+ * API calls, then user callbacks, so a long queue of callbacks doesn't delay e.g. failover decisions
+ * of the channel manager. Callbacks waiting long are promoted by aging and run in bounded slices
+ * ahead of the other tasks (see @link PrioritySchedulingSettings @endlink).
+ *
+ * @note Callback queue settings don't apply.
+ */
 class SingleThreadExecutorContext: public AbstractExecutorContext {
 public:
-    SingleThreadExecutorContext()
-        : AbstractExecutorContext() {}
+    explicit SingleThreadExecutorContext(const PrioritySchedulingSettings& settings = PrioritySchedulingSettings())
+        : AbstractExecutorContext(), settings_(settings) {}
 
-    virtual IThreadPool& getLifeCycleExecutor() { return *executor_; }
-    virtual IThreadPool& getApiExecutor() { return *executor_; }
-    virtual IThreadPool& getCallbackExecutor() { return *executor_; }
+    virtual IThreadPool& getLifeCycleExecutor() { return executor_->getExecutor(LIFE_CYCLE_PRIORITY); }
+    virtual IThreadPool& getApiExecutor() { return executor_->getExecutor(API_PRIORITY); }
+    virtual IThreadPool& getCallbackExecutor() { return executor_->getExecutor(CALLBACK_PRIORITY); }
 
 protected:
-    virtual void doInit() { executor_ = createExecutor(1); }
-    virtual void doStop() { shutdownExecutor(executor_); }
+    virtual void doInit()
+    {
+#ifdef KAA_USE_SINGLE_THREAD
+        throw KaaException("Thread pools aren't available in the single-threaded build, use PollingExecutorContext");
+#else
+        executor_.reset(new PriorityThreadPool(PRIORITY_COUNT, settings_));
+#endif
+    }
+
+    virtual void doStop()
+    {
+        if (executor_) {
+            executor_->shutdown();
+            executor_->awaitTermination(getAwaitTerminationTimeout());
+        }
+    }
 
 private:
-    IThreadPoolPtr    executor_;
+    enum {
+        LIFE_CYCLE_PRIORITY,
+        API_PRIORITY,
+        CALLBACK_PRIORITY,
+        PRIORITY_COUNT
+    };
+
+    const PrioritySchedulingSettings       settings_;
+    std::unique_ptr<PriorityThreadPool>    executor_;
 };
 
 } /* namespace kaa */
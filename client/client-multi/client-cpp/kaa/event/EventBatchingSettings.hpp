@@ -0,0 +1,52 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EVENTBATCHINGSETTINGS_HPP_
+#define EVENTBATCHINGSETTINGS_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace kaa {
+
+/**
+ * @brief Controls how outgoing events produced outside transactions are grouped into syncs.
+ *
+ * By default every produced event requests a sync at once.
+ */
+struct EventBatchingSettings {
+    /**
+     * How long the first pending event waits for others before the sync is requested.
+     * Zero disables batching.
+     */
+    std::chrono::milliseconds batchWindow = std::chrono::milliseconds::zero();
+
+    /**
+     * The number of pending events which requests the sync before the window expires.
+     * Zero means no limit.
+     */
+    std::size_t maxBatchSize = 0;
+
+    /**
+     * If set, a new event replaces the pending one with the same FQN and target,
+     * so only the latest of them is sent.
+     */
+    bool coalesceEvents = false;
+};
+
+} /* namespace kaa */
+
+#endif /* EVENTBATCHINGSETTINGS_HPP_ */
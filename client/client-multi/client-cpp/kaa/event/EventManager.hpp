@@ -19,8 +19,14 @@
 
 
 #include <set>
+#include <map>
 #include <list>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 
@@ -31,6 +37,9 @@
 #include "kaa/event/IEventListenersResolver.hpp"
 #include "kaa/event/EventTransport.hpp"
 #include "kaa/event/IEventDataProcessor.hpp"
+#include "kaa/event/EventBatchingSettings.hpp"
+#include "kaa/log/ILogStorage.hpp"
+#include "kaa/utils/KaaTimer.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
 #include "kaa/transact/AbstractTransactable.hpp"
 #include "kaa/IKaaClientContext.hpp"
@@ -46,10 +55,29 @@ class EventManager : public IEventManager
 {
 public:
     EventManager(IKaaClientContext &context)
-        : context_(context), currentEventIndex_(0),eventTransport_(nullptr)
+        : context_(context), pendingEventsVolume_(0), maxResidentEvents_(0), currentEventIndex_(0),eventTransport_(nullptr),
+          eventListenersCacheTtl_(context.getProperties().getEventListenersCacheTtl()), batchTimer_("Event batch timer")
     {
     }
 
+    void setBatchingSettings(const EventBatchingSettings& settings);
+
+    /**
+     * @brief Makes outgoing events wait for the sync in the given storage instead of memory.
+     *
+     * At most @c maxResidentEvents events are kept in memory. Once the limit is reached, next events
+     * are serialized into the storage until it is drained, so the order of events is preserved.
+     * The storage is drained one bucket per sync, and the next bucket is requested after the previous
+     * one is delivered.
+     *
+     * A persistent storage, e.g. @c MMapSegmentLogStorage or @c SQLiteDBLogStorage, keeps stored events
+     * across restarts. With zero @c maxResidentEvents all events are stored.
+     *
+     * @param storage              The storage. @c nullptr keeps all events in memory.
+     * @param maxResidentEvents    The max number of events kept in memory.
+     */
+    void setEventStorage(ILogStoragePtr storage, std::size_t maxResidentEvents = 0);
+
     virtual void registerEventFamily(IEventFamily* eventFamily);
 
     virtual void produceEvent(const std::string& fqn
@@ -57,17 +85,49 @@ public:
                             , const std::string& target
                             , TransactionIdPtr trxId);
 
+    virtual void produceEvent(const std::string& fqn
+                            , std::vector<std::uint8_t>&& data
+                            , const std::string& target
+                            , TransactionIdPtr trxId);
+
+    virtual void produceEvent(boost::string_ref fqn
+                            , const std::uint8_t *data
+                            , std::size_t dataSize
+                            , boost::string_ref target
+                            , TransactionIdPtr trxId);
+
     virtual void onEventsReceived(const EventSyncResponse::events_t& events);
     virtual void onEventListenersReceived(const EventSyncResponse::eventListenersResponses_t& listeners);
 
     virtual std::map<std::int32_t, Event> releasePendingEvents();
     virtual bool hasPendingEvents() const;
+    virtual void onEventsDelivered();
+
+    /**
+     * @return The approximate memory occupied by events waiting for the sync, in bytes.
+     */
+    std::size_t getPendingEventsVolume() const;
 
     virtual std::map<std::int32_t, std::list<std::string> > getPendingListenerRequests();
     virtual bool hasPendingListenerRequests() const;
 
     virtual std::int32_t findEventListeners(const std::list<std::string>& eventFQNs, IFetchEventListenersPtr listener);
 
+    /**
+     * @brief Sets how long found event listeners are reused for the same set of event FQNs.
+     *
+     * A cached result is passed to the listener without a sync. The cache is cleared, so it
+     * takes effect for next requests.
+     *
+     * @param ttl    The time to live. If zero, the listeners are not cached.
+     */
+    void setEventListenersCacheTtl(std::chrono::seconds ttl);
+
+    /**
+     * @brief Drops cached event listeners, e.g. once endpoints are attached to or detached from the user.
+     */
+    void clearEventListenersCache();
+
     virtual void setTransport(EventTransport *transport);
 
     using AbstractTransactable::beginTransaction;
@@ -89,6 +149,11 @@ private:
         IFetchEventListenersPtr listener_;
     };
 
+    struct CachedEventListeners {
+        std::vector<std::string> listeners_;
+        std::chrono::steady_clock::time_point expiresAt_;
+    };
+
     void onEventFromServer(const std::string& eventClassFQN
                          , const std::vector<std::uint8_t>& data
                          , const std::string& source);
@@ -97,11 +162,50 @@ private:
 
     void doSync();
 
+    /*
+     * Takes an event from the pool and fills it in except for the data.
+     */
+    Event createEvent(boost::string_ref fqn, boost::string_ref target, std::size_t dataSize);
+
+    /*
+     * Adds the event to the transaction or to the pending events.
+     */
+    void addEvent(Event&& event, TransactionIdPtr trxId);
+
+    /*
+     * Requests the sync for events produced outside transactions according to the batching settings.
+     */
+    void onEventProduced(const EventBatchingSettings& settings, std::size_t pendingEventCount);
+    void onBatchWindowExpired();
+
+    static std::size_t getEventVolume(const Event& event);
+
+    /*
+     * Called under pendingEventsGuard_.
+     */
+    void addPendingEvent(Event&& event);
+    std::size_t getStoredEventCount() const;
+    void releaseStoredEvents(std::map<std::int32_t, Event>& events);
+
 private:
+    typedef std::pair<std::string/*FQN*/, std::string/*target*/> EventKey;
+
     IKaaClientContext &context_;
 
     std::set<IEventFamily*>   eventFamilies_;
+
+    /*
+     * Incoming events are routed by one lookup instead of scanning FQN lists of all families.
+     * Each family is given the index of the FQN in its list, see IEventFamily::onGenericEvent().
+     */
+    typedef std::pair<IEventFamily*, std::size_t/*event class id*/> EventFamilyRoute;
+    std::unordered_map<std::string/*FQN*/, std::vector<EventFamilyRoute>>    eventFamiliesByFqn_;
     std::map<std::int32_t, Event>          pendingEvents_;
+    std::map<EventKey, std::int32_t>       coalescedEvents_;
+    std::size_t                            pendingEventsVolume_;
+    EventBatchingSettings                  batchingSettings_;
+    ILogStoragePtr                         eventStorage_;
+    std::size_t                            maxResidentEvents_;
     KAA_MUTEX_MUTABLE_DECLARE(pendingEventsGuard_);
 
     std::int32_t currentEventIndex_;
@@ -109,7 +213,18 @@ private:
     EventTransport *          eventTransport_;
 
     std::map<std::int32_t/*request id*/, std::shared_ptr<EventListenersInfo> > eventListenersRequests_;
+
+    /*
+     * Keyed by the set of FQNs, so requests differing only in order or duplicates share the result.
+     */
+    std::map<std::set<std::string>/*FQNs*/, CachedEventListeners> eventListenersCache_;
+    std::chrono::seconds                                           eventListenersCacheTtl_;
     KAA_MUTEX_MUTABLE_DECLARE(eventListenersGuard_);
+
+    /*
+     * Declared last: its destructor waits for the callback, which refers to the members above.
+     */
+    KaaTimer<void ()>    batchTimer_;
 };
 
 } /* namespace kaa */
@@ -29,6 +29,12 @@ class IEventDataProcessor {
 public:
     virtual std::map<std::int32_t, Event> releasePendingEvents() = 0;
     virtual bool hasPendingEvents() const  = 0;
+
+    /**
+     * Called when events of a sync request are delivered to the server.
+     */
+    virtual void onEventsDelivered() {}
+
     virtual std::map<std::int32_t, std::list<std::string> > getPendingListenerRequests() = 0;
     virtual bool hasPendingListenerRequests() const = 0;
 
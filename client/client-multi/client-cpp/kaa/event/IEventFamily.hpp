@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include <cstddef>
 #include <cstdint>
 
 namespace kaa {
@@ -53,6 +54,24 @@ public:
                               , const std::vector<std::uint8_t>& data
                               , const std::string& source) = 0;
 
+    /**
+     * Handler of event received from server, called with the index of the event FQN in
+     * @link getSupportedEventClassFQNs() @endlink, so generated families dispatch events
+     * without comparing strings. Calls the FQN based handler by default.
+     *
+     * @param eventClassId  Index of the event FQN in the supported FQN list
+     * @param eventFQN      Fully qualified name of an event
+     * @param data          Event data
+     * @param source        Event source
+     */
+    virtual void onGenericEvent(std::size_t eventClassId
+                              , const std::string& fqn
+                              , const std::vector<std::uint8_t>& data
+                              , const std::string& source)
+    {
+        onGenericEvent(fqn, data, source);
+    }
+
     virtual ~IEventFamily() {}
 };
 
@@ -30,6 +30,9 @@ public:
     /**
      * Submits an event listeners resolution request
      *
+     * The listeners found for the same set of FQNs may be passed from the cache without a request,
+     * see @link KaaClientProperties::setEventListenersCacheTtl() @endlink.
+     *
      * @param eventFQNs     List of event class FQNs which have to be supported by endpoint.
      * @param listener      Result listener {@link IFetchEventListeners}}
      *
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <boost/utility/string_ref.hpp>
 #include "kaa/gen/EndpointGen.hpp"
 #include "kaa/transact/TransactionId.hpp"
 
@@ -54,6 +55,32 @@ public:
                             , const std::string& target
                             , TransactionIdPtr trxId) = 0;
 
+    /**
+     * Creates an Event taking over the event data, so the data isn't copied.
+     *
+     * @param eventFqn  Fully qualified name of the Event
+     * @param data      Event data, moved into the event
+     * @param target    Event target, null for event broadcasting.
+     */
+    virtual void produceEvent(const std::string& fqn
+                            , std::vector<std::uint8_t>&& data
+                            , const std::string& target
+                            , TransactionIdPtr trxId) = 0;
+
+    /**
+     * Creates an Event from views of the caller's buffers, which are copied into the event once.
+     *
+     * @param eventFqn  Fully qualified name of the Event
+     * @param data      Event data
+     * @param dataSize  Event data size
+     * @param target    Event target, empty for event broadcasting.
+     */
+    virtual void produceEvent(boost::string_ref fqn
+                            , const std::uint8_t *data
+                            , std::size_t dataSize
+                            , boost::string_ref target
+                            , TransactionIdPtr trxId) = 0;
+
     virtual ~IEventManager() {}
 };
 
@@ -21,7 +21,10 @@
 
 #include <atomic>
 #include <string>
+#include <functional>
 #include <memory>
+#include <vector>
+#include <utility>
 #include <unordered_map>
 
 #include "kaa/KaaThread.hpp"
@@ -53,6 +56,12 @@ public:
     virtual void detachEndpoint(const std::string&  endpointKeyHash
                               , IDetachEndpointCallbackPtr listener = IDetachEndpointCallbackPtr());
 
+    virtual void attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                               , IAttachEndpointsCallbackPtr listener = IAttachEndpointsCallbackPtr());
+
+    virtual void detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                               , IDetachEndpointsCallbackPtr listener = IDetachEndpointsCallbackPtr());
+
     virtual void attachUser(const std::string& userExternalId
                           , const std::string& userAccessToken
                           , IUserAttachCallbackPtr listener = IUserAttachCallbackPtr());
@@ -81,8 +90,17 @@ public:
 
     void setTransport(UserTransport * transport) { userTransport_ = transport; }
 
+    /**
+     * @brief Sets the callback invoked once the set of endpoints attached to the user may have changed,
+     * i.e. on a successful user attach, endpoint attach or detach and on attach or detach notifications.
+     *
+     * The callback is invoked on the transport thread, e.g. to drop cached event listeners.
+     */
+    void setUserEndpointsChangeListener(std::function<void ()> listener) { userEndpointsChangeListener_ = listener; }
+
 private:
     void doSync();
+    void notifyUserEndpointsChanged();
 
 private:
 #ifdef KAA_THREADSAFE
@@ -91,6 +109,19 @@ private:
     typedef std::int32_t RequestId;
 #endif
 
+    /*
+     * Results of a bulk request collected until the last of its endpoints is processed.
+     */
+    template<class Result, class CallbackPtr>
+    struct BulkRequest {
+        std::vector<Result> results_;
+        std::size_t         pendingCount_;
+        CallbackPtr         listener_;
+    };
+
+    typedef BulkRequest<EndpointAttachResult, IAttachEndpointsCallbackPtr> BulkAttachRequest;
+    typedef BulkRequest<EndpointDetachResult, IDetachEndpointsCallbackPtr> BulkDetachRequest;
+
 private:
     IKaaClientContext         &context_;
     UserTransport*            userTransport_;
@@ -100,6 +131,7 @@ private:
 
     IUserAttachCallbackPtr      userAttachResponseListener_;
     IAttachStatusListenerPtr    attachStatusListener_;
+    std::function<void ()>      userEndpointsChangeListener_;
 
     RequestId attachRequestId_;
     RequestId detachRequestId_;
@@ -112,6 +144,10 @@ private:
 
     std::unordered_map<std::int32_t, IAttachEndpointCallbackPtr> attachEndpointListeners_;
     std::unordered_map<std::int32_t, IDetachEndpointCallbackPtr> detachEndpointListeners_;
+
+    /* Request id -> bulk request and the index of the request's endpoint in it. */
+    std::unordered_map<std::int32_t, std::pair<std::shared_ptr<BulkAttachRequest>, std::size_t>> bulkAttachRequests_;
+    std::unordered_map<std::int32_t, std::pair<std::shared_ptr<BulkDetachRequest>, std::size_t>> bulkDetachRequests_;
 };
 
 }
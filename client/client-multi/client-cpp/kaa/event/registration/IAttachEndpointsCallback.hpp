@@ -0,0 +1,56 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IATTACHENDPOINTSCALLBACK_HPP_
+#define IATTACHENDPOINTSCALLBACK_HPP_
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace kaa {
+
+/**
+ * @brief The result of attaching one endpoint of a bulk attach request.
+ */
+struct EndpointAttachResult {
+    std::string endpointAccessToken;    ///< The access token the endpoint was requested by.
+    bool isAttached = false;
+    std::string endpointKeyHash;        ///< The key hash of the attached endpoint, empty on failure.
+};
+
+/**
+ * @brief Interface to the listener notified once all endpoints of a bulk attach request are processed.
+ *
+ * @see IEndpointRegistrationManager::attachEndpoints()
+ */
+class IAttachEndpointsCallback {
+public:
+    /**
+     * @brief Callback is used when the server has responded to all endpoints of the request.
+     *
+     * @param[in] results    The per-endpoint results in the order of the requested access tokens.
+     */
+    virtual void onAttachCompleted(const std::vector<EndpointAttachResult>& results) = 0;
+
+    virtual ~IAttachEndpointsCallback() {}
+};
+
+typedef std::shared_ptr<IAttachEndpointsCallback> IAttachEndpointsCallbackPtr;
+
+} /* namespace kaa */
+
+#endif /* IATTACHENDPOINTSCALLBACK_HPP_ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IDETACHENDPOINTSCALLBACK_HPP_
+#define IDETACHENDPOINTSCALLBACK_HPP_
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace kaa {
+
+/**
+ * @brief The result of detaching one endpoint of a bulk detach request.
+ */
+struct EndpointDetachResult {
+    std::string endpointKeyHash;
+    bool isDetached = false;
+};
+
+/**
+ * @brief Interface to the listener notified once all endpoints of a bulk detach request are processed.
+ *
+ * @see IEndpointRegistrationManager::detachEndpoints()
+ */
+class IDetachEndpointsCallback {
+public:
+    /**
+     * @brief Callback is used when the server has responded to all endpoints of the request.
+     *
+     * @param[in] results    The per-endpoint results in the order of the requested key hashes.
+     */
+    virtual void onDetachCompleted(const std::vector<EndpointDetachResult>& results) = 0;
+
+    virtual ~IDetachEndpointsCallback() {}
+};
+
+typedef std::shared_ptr<IDetachEndpointsCallback> IDetachEndpointsCallbackPtr;
+
+} /* namespace kaa */
+
+#endif /* IDETACHENDPOINTSCALLBACK_HPP_ */
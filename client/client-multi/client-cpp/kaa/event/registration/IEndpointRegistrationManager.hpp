@@ -20,11 +20,14 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "kaa/event/registration/IUserAttachCallback.hpp"
 #include "kaa/event/registration/IAttachStatusListener.hpp"
 #include "kaa/event/registration/IAttachEndpointCallback.hpp"
 #include "kaa/event/registration/IDetachEndpointCallback.hpp"
+#include "kaa/event/registration/IAttachEndpointsCallback.hpp"
+#include "kaa/event/registration/IDetachEndpointsCallback.hpp"
 
 namespace kaa {
 
@@ -64,6 +67,36 @@ public:
     virtual void detachEndpoint(const std::string&  endpointKeyHash
                               , IDetachEndpointCallbackPtr listener = IDetachEndpointCallbackPtr()) = 0;
 
+    /**
+     * @brief Attaches the specified endpoints to the user to which the current endpoint is attached.
+     *
+     * All endpoints are sent in one sync request.
+     *
+     * @param[in] endpointAccessTokens    The access tokens of the endpoints to be attached to the user.
+     * @param[in] listener                The optional listener to notify once all endpoints are processed.
+     *
+     * @throw BadCredentials                One of the endpoint access tokens is empty. Nothing is attached then.
+     * @throw TransportNotFoundException    The Kaa SDK isn't fully initialized.
+     * @throw KaaException                  Some other failure has happened.
+     */
+    virtual void attachEndpoints(const std::vector<std::string>& endpointAccessTokens
+                               , IAttachEndpointsCallbackPtr listener = IAttachEndpointsCallbackPtr()) = 0;
+
+    /**
+     * @brief Detaches the specified endpoints from the user to which the current endpoint is attached.
+     *
+     * All endpoints are sent in one sync request.
+     *
+     * @param[in] endpointKeyHashes    The key hashes of the endpoints to be detached from the user.
+     * @param[in] listener             The optional listener to notify once all endpoints are processed.
+     *
+     * @throw BadCredentials                One of the endpoint key hashes is empty. Nothing is detached then.
+     * @throw TransportNotFoundException    The Kaa SDK isn't fully initialized.
+     * @throw KaaException                  Some other failure has happened.
+     */
+    virtual void detachEndpoints(const std::vector<std::string>& endpointKeyHashes
+                               , IDetachEndpointsCallbackPtr listener = IDetachEndpointsCallbackPtr()) = 0;
+
     /**
      * @brief Attaches the current endpoint to the specifier user. The user verification is carried out by the default verifier.
      *
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BACKOFFFAILOVERSTRATEGY_HPP_
+#define BACKOFFFAILOVERSTRATEGY_HPP_
+
+#include <cstddef>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/failover/DefaultFailoverStrategy.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Takes the actions of @c DefaultFailoverStrategy after exponentially growing random delays.
+ *
+ * The delays follow the "decorrelated jitter" scheme: each one is picked at random between
+ * the base period and three times the previous delay, but not above the max period. Endpoints
+ * which lost the same server at once thus reconnect spread in time instead of in lockstep.
+ * The delay falls back to the base period once an Operations server accepts the connection.
+ *
+ * Periods are in seconds.
+ */
+class BackoffFailoverStrategy: public DefaultFailoverStrategy {
+public:
+    BackoffFailoverStrategy(IKaaClientContext& context,
+                            std::size_t basePeriod = DEFAULT_BASE_PERIOD,
+                            std::size_t maxPeriod = DEFAULT_MAX_PERIOD);
+
+    virtual FailoverStrategyDecision onFailover(KaaFailoverReason failover);
+    virtual void onRecover();
+
+public:
+    static const std::size_t DEFAULT_BASE_PERIOD = 1;
+    static const std::size_t DEFAULT_MAX_PERIOD = 300;
+
+private:
+    const std::size_t basePeriod_;
+    const std::size_t maxPeriod_;
+
+    std::size_t lastPeriod_;
+
+    KAA_MUTEX_DECLARE(backoffGuard_);
+};
+
+}
+
+#endif /* BACKOFFFAILOVERSTRATEGY_HPP_ */
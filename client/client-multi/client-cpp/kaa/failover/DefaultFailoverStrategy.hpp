@@ -38,6 +38,12 @@ public:
 public:
     static const std::size_t DEFAULT_RETRY_PERIOD = 5;
 
+protected:
+    /**
+     * Returns the action the default strategy takes on the failover.
+     */
+    static FailoverStrategyAction getDefaultAction(KaaFailoverReason failover);
+
 protected:
     IKaaClientContext &context_;
 
@@ -27,6 +27,11 @@ class IFailoverStrategy {
 public:
     virtual FailoverStrategyDecision onFailover(KaaFailoverReason failover) = 0;
 
+    /**
+     * Called when an Operations server has accepted the connection, e.g. after failovers.
+     */
+    virtual void onRecover() {}
+
     virtual ~IFailoverStrategy() {}
 
 };
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ISERVERSELECTIONSTRATEGY_HPP_
+#define ISERVERSELECTIONSTRATEGY_HPP_
+
+#include <map>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "kaa/channel/ITransportConnectionInfo.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Decides in which order the client tries Operations servers of a transport protocol.
+ *
+ * The bootstrap manager consults the strategy when it receives a server list and, after a server
+ * fails, for the servers which haven't been tried yet. What to do on a failure is still decided
+ * by @link IFailoverStrategy @endlink.
+ *
+ * Servers are identified by their access point ids. Methods may be called from any thread.
+ */
+class IServerSelectionStrategy {
+public:
+    /**
+     * @brief Reorders the servers, the first one is tried first.
+     */
+    virtual void orderServers(std::vector<ITransportConnectionInfoPtr>& servers) = 0;
+
+    /**
+     * @brief Reports the round-trip time measured to the server, e.g. on connect or by PING.
+     */
+    virtual void onServerRttMeasured(const ITransportConnectionInfo& server, std::chrono::microseconds rtt)
+    {
+        static_cast<void>(server);
+        static_cast<void>(rtt);
+    }
+
+    /**
+     * @brief Reports the server the client has failed over from.
+     */
+    virtual void onServerFailed(const ITransportConnectionInfo& server)
+    {
+        static_cast<void>(server);
+    }
+
+    /**
+     * @brief Returns the round-trip times the strategy relies on, by access point id.
+     */
+    virtual std::map<std::int32_t, std::chrono::microseconds> getServerRtts() const
+    {
+        return std::map<std::int32_t, std::chrono::microseconds>();
+    }
+
+    virtual ~IServerSelectionStrategy() {}
+};
+
+typedef std::shared_ptr<IServerSelectionStrategy> IServerSelectionStrategyPtr;
+
+}
+
+#endif /* ISERVERSELECTIONSTRATEGY_HPP_ */
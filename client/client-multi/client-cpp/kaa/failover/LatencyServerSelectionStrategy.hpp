@@ -0,0 +1,76 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATENCYSERVERSELECTIONSTRATEGY_HPP_
+#define LATENCYSERVERSELECTIONSTRATEGY_HPP_
+
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/failover/IServerSelectionStrategy.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Prefers the healthy server with the lowest round-trip time.
+ *
+ * Servers are tried in the following order:
+ * - servers with measured RTT, the fastest first;
+ * - servers never measured, in random order;
+ * - servers failed within the failure timeout, the least recently failed first.
+ *
+ * RTT samples are smoothed like TCP does (7/8 of the previous value and 1/8 of the new sample).
+ * A new sample clears the failure of the server.
+ */
+class LatencyServerSelectionStrategy: public IServerSelectionStrategy {
+public:
+    /**
+     * @param[in] failureTimeout    How long a failed server is tried only after all other servers.
+     */
+    LatencyServerSelectionStrategy(std::chrono::seconds failureTimeout = std::chrono::seconds(DEFAULT_FAILURE_TIMEOUT))
+        : failureTimeout_(failureTimeout)
+    {
+    }
+
+    virtual void orderServers(std::vector<ITransportConnectionInfoPtr>& servers);
+    virtual void onServerRttMeasured(const ITransportConnectionInfo& server, std::chrono::microseconds rtt);
+    virtual void onServerFailed(const ITransportConnectionInfo& server);
+    virtual std::map<std::int32_t, std::chrono::microseconds> getServerRtts() const;
+
+public:
+    static const std::size_t DEFAULT_FAILURE_TIMEOUT = 60; // in seconds
+
+private:
+    struct ServerStats {
+        std::chrono::microseconds smoothedRtt_ = std::chrono::microseconds::zero();
+        bool isMeasured_ = false;
+        bool isFailed_ = false;
+        std::chrono::steady_clock::time_point failedAt_;
+    };
+
+    const std::chrono::seconds failureTimeout_;
+
+    std::map<std::int32_t, ServerStats> stats_;
+
+    KAA_MUTEX_MUTABLE_DECLARE(statsGuard_);
+};
+
+}
+
+#endif /* LATENCYSERVERSELECTIONSTRATEGY_HPP_ */
@@ -19,7 +19,14 @@
 
 #include "kaa/KaaDefaults.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
 #include "kaa/http/IHttpClient.hpp"
+#include "kaa/http/HttpResponseParser.hpp"
 #include <boost/asio.hpp>
 
 #include "kaa/KaaThread.hpp"
@@ -28,23 +35,88 @@
 
 namespace kaa {
 
+/**
+ * @brief HTTP/1.1 client which keeps the connection to the server alive between requests.
+ *
+ * The connection is reused while requests go to the same host and port, the server doesn't close it and it
+ * isn't idle longer than @c KEEP_ALIVE_TIMEOUT. A request failed on a reused connection before any response
+ * byte is received is resent over a new one. Resolved addresses are cached by @link HttpUtils @endlink.
+ *
+ * Requests are sent either synchronously or asynchronously on the I/O service passed to the client.
+ * The client should not be destroyed while an asynchronous request is in progress.
+ */
 class HttpClient : public IHttpClient
 {
 public:
+    /**
+     * Called with either a response or an error of the asynchronous request.
+     */
+    typedef std::function<void (const boost::system::error_code& errorCode,
+                                std::shared_ptr<IHttpResponse> response)> HttpResponseHandler;
+
     HttpClient(IKaaClientContext &context)
-        : io_(), sock_(io_), context_(context)
+        : ownIo_(new boost::asio::io_service), io_(*ownIo_), sock_(io_), resolver_(io_)
+        , port_(0), isAsyncRequestInProgress_(false), context_(context)
+    { }
+
+    /**
+     * @param[in] io    The I/O service asynchronous requests are run on.
+     */
+    HttpClient(IKaaClientContext &context, boost::asio::io_service& io)
+        : io_(io), sock_(io_), resolver_(io_)
+        , port_(0), isAsyncRequestInProgress_(false), context_(context)
     { }
 
     virtual std::shared_ptr<IHttpResponse> sendRequest(const IHttpRequest& request, EndpointConnectionInfo* connection = nullptr);
+
+    /**
+     * @brief Sends the request without blocking the caller.
+     *
+     * The handler is called from a thread running the I/O service of the client. Only one asynchronous
+     * request may be in progress, otherwise the handler gets @c boost::asio::error::in_progress.
+     */
+    void sendRequestAsync(const IHttpRequest& request, const HttpResponseHandler& handler);
+
     virtual void closeConnection();
 
+public:
+    static const std::size_t KEEP_ALIVE_TIMEOUT = 30; /*!< Max idle time (in seconds) of a kept-alive connection. */
+    static const std::size_t READ_BUFFER_SIZE = 4096; /*!< Size of the buffer the response header is read into. */
+
 private:
+    typedef std::chrono::steady_clock Clock;
+
     void checkError(const boost::system::error_code& code);
     void doSocketClose();
 
+    bool isConnectionReusable(const std::string& host, std::uint16_t port) const;
+    void connect(const std::string& host, std::uint16_t port);
+
+    void readResponse(HttpResponseParser& parser, boost::system::error_code& errorCode);
+
+    struct AsyncRequest;
+    typedef std::shared_ptr<AsyncRequest> AsyncRequestPtr;
+
+    void startAsyncRequest(AsyncRequestPtr request);
+    void resolveAsync(AsyncRequestPtr request);
+    void connectAsync(AsyncRequestPtr request);
+    void writeAsync(AsyncRequestPtr request);
+    void readResponseAsync(AsyncRequestPtr request);
+    void onAsyncError(AsyncRequestPtr request, const boost::system::error_code& errorCode);
+    void completeAsyncRequest(AsyncRequestPtr request, const boost::system::error_code& errorCode);
+
 private:
-    boost::asio::io_service io_;
+    std::unique_ptr<boost::asio::io_service> ownIo_;
+    boost::asio::io_service& io_;
     boost::asio::ip::tcp::socket sock_;
+    boost::asio::ip::tcp::resolver resolver_;
+
+    std::string host_;
+    std::uint16_t port_;
+    Clock::time_point lastUsageTime_;
+
+    std::atomic<bool> isAsyncRequestInProgress_;
+    bool isAsyncRequestCancelled_ = false;
 
     KAA_MUTEX_DECLARE(httpClientGuard_);
 
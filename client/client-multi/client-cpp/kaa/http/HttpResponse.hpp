@@ -29,6 +29,8 @@ class HttpResponse : public IHttpResponse {
 public:
     HttpResponse(const char *data, std::size_t len);
     HttpResponse(const std::string& data);
+    HttpResponse(int statusCode, const std::map<std::string, std::string>& header, const SharedBody& body)
+        : body_(body), header_(header), statusCode_(statusCode) { }
     ~HttpResponse() { }
 
     virtual std::string getHeaderField(const std::string& name) const;
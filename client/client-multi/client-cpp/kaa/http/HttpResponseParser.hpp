@@ -0,0 +1,137 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HTTPRESPONSEPARSER_HPP_
+#define HTTPRESPONSEPARSER_HPP_
+
+#include "kaa/KaaDefaults.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "kaa/http/IHttpResponse.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Parses an HTTP response as it arrives from the connection.
+ *
+ * The body size is known once the header is parsed, so the body is allocated in one go and parsing stops
+ * right after it. The body is delimited by either the Content-Length header field, the chunked transfer
+ * encoding or the end of the connection, in which case the connection can't be kept alive.
+ *
+ * The header may not exceed @c MAX_HEADER_SIZE bytes. The same limit applies to chunk size lines and trailers.
+ */
+class HttpResponseParser {
+public:
+    static const std::size_t MAX_HEADER_SIZE = 8192;
+
+    HttpResponseParser() { reset(); }
+
+    /**
+     * @brief Parses the next bytes of the response.
+     *
+     * @param[out] errorCode    Set to @c bad_message if the response is malformed.
+     *
+     * @return The number of bytes consumed. Bytes following the complete response are not consumed.
+     */
+    std::size_t parse(const char *data, std::size_t size, boost::system::error_code& errorCode);
+
+    /**
+     * @brief Returns the space left for the body or the current chunk if the parser expects their bytes,
+     * so that they can be read in place, or an empty buffer otherwise.
+     */
+    boost::asio::mutable_buffer prepareBody();
+
+    /**
+     * @brief Accounts the bytes read into the buffer returned by @link prepareBody() @endlink.
+     */
+    void commitBody(std::size_t size);
+
+    /**
+     * @brief Notifies the parser that the server has closed the connection.
+     *
+     * @param[out] errorCode    Set to @c connection_aborted unless the response is complete or its body
+     *                          is delimited by the end of the connection.
+     */
+    void onEndOfStream(boost::system::error_code& errorCode);
+
+    bool isComplete() const { return state_ == State::COMPLETE; }
+
+    /**
+     * @brief Whether any byte of the response has been parsed.
+     */
+    bool isStarted() const { return isStarted_; }
+
+    /**
+     * @brief Whether the connection may be reused once the response is complete.
+     */
+    bool isKeepAlive() const { return keepAlive_; }
+
+    /**
+     * @brief Returns the complete response. The parser should be reset before the next response.
+     */
+    std::shared_ptr<IHttpResponse> getResponse() const;
+
+    void reset();
+
+private:
+    enum class State {
+        HEADER,
+        BODY,
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILER,
+        COMPLETE
+    };
+
+    /*
+     * Accumulates a CRLF-terminated line or, for the header, an empty line terminated block.
+     * Returns the number of bytes consumed and whether the terminator has been reached.
+     */
+    std::size_t readUntil(const char *data, std::size_t size, const char *terminator, bool& isDone,
+                          boost::system::error_code& errorCode);
+
+    bool parseHeader();
+    bool parseChunkSize();
+
+    void reserveBody(std::size_t size);
+
+private:
+    State state_;
+    bool isStarted_;
+    bool keepAlive_;
+
+    std::string line_;
+    int statusCode_;
+    std::map<std::string, std::string> header_;
+
+    boost::shared_array<std::uint8_t> body_;
+    std::size_t bodySize_;
+    std::size_t bodyCapacity_;
+    std::size_t bytesToRead_;
+};
+
+}
+
+#endif /* HTTPRESPONSEPARSER_HPP_ */
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #ifdef QNX_650_CPP11_TO_STRING_PATCH
 #include <custom/string.h>
@@ -30,24 +31,72 @@ namespace kaa {
 
 class HttpUtils {
 public:
+    /**
+     * @brief Resolves the host and returns its first address.
+     */
     static boost::asio::ip::tcp::endpoint resolveEndpoint(std::string host,
                                                           std::uint16_t port,
                                                           boost::system::error_code& errorCode)
     {
-        boost::asio::io_service io_service;
-        boost::asio::ip::tcp::resolver resolver(io_service);
-        boost::asio::ip::tcp::resolver::query query(host,
-                                                    std::to_string(port),
-                                                    boost::asio::ip::resolver_query_base::numeric_service);
-
-        auto endpointIt = resolver.resolve(query, errorCode);
-
-        if (errorCode) {
+        const auto& endpoints = resolveEndpoints(host, port, errorCode);
+        if (errorCode || endpoints.empty()) {
             return boost::asio::ip::tcp::endpoint();
         }
 
-        return *endpointIt;
+        return endpoints.front();
     }
+
+    /**
+     * @brief Resolves all addresses of the host.
+     *
+     * IPv6 and IPv4 addresses are interleaved as RFC 8305 suggests. Results are cached for @c DNS_CACHE_TTL.
+     */
+    static std::vector<boost::asio::ip::tcp::endpoint> resolveEndpoints(const std::string& host,
+                                                                        std::uint16_t port,
+                                                                        boost::system::error_code& errorCode);
+
+    /**
+     * @brief Looks for cached addresses of the host.
+     *
+     * @return False if the addresses aren't cached or are expired.
+     */
+    static bool findCachedEndpoints(const std::string& host, std::uint16_t port,
+                                    std::vector<boost::asio::ip::tcp::endpoint>& endpoints);
+
+    /**
+     * @brief Caches resolved addresses of the host.
+     *
+     * @return The addresses in the order they should be tried.
+     */
+    static std::vector<boost::asio::ip::tcp::endpoint> cacheEndpoints(const std::string& host, std::uint16_t port,
+                                                                      boost::asio::ip::tcp::resolver::iterator endpointIt);
+
+    /**
+     * @brief Drops cached addresses of the host, e.g. when none of them accepts connections.
+     */
+    static void invalidateEndpoints(const std::string& host, std::uint16_t port);
+
+    /**
+     * @brief Connects the socket to the first of the endpoints which accepts the connection.
+     *
+     * Connection attempts start @c CONNECTION_ATTEMPT_DELAY ms apart without waiting for previous ones
+     * to fail ("Happy Eyeballs", RFC 8305). The first established connection is kept, others are closed.
+     *
+     * @param[in]     io           The I/O service of the socket.
+     * @param[in,out] sock         The closed socket to be connected.
+     * @param[in]     endpoints    Endpoints in the order they should be tried.
+     * @param[out]    errorCode    The error of the last attempt if all of them failed.
+     *
+     * @return The endpoint the socket is connected to.
+     */
+    static boost::asio::ip::tcp::endpoint connect(boost::asio::io_service& io,
+                                                  boost::asio::ip::tcp::socket& sock,
+                                                  const std::vector<boost::asio::ip::tcp::endpoint>& endpoints,
+                                                  boost::system::error_code& errorCode);
+
+public:
+    static const std::size_t DNS_CACHE_TTL = 60; /*!< Time (in seconds) resolved addresses are cached for. */
+    static const std::size_t CONNECTION_ATTEMPT_DELAY = 250; /*!< Delay (in ms) between connection attempts. */
 };
 
 }
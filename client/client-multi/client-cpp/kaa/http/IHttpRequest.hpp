@@ -20,8 +20,11 @@
 #include "kaa/KaaDefaults.hpp"
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
+#include <boost/asio/buffer.hpp>
+
 namespace kaa {
 
 class IHttpRequest {
@@ -29,6 +32,13 @@ public:
     virtual std::string getHost() const = 0;
     virtual std::uint16_t getPort() const = 0;
     virtual std::string getRequestData() const = 0;
+
+    /**
+     * The same data as @link getRequestData() @endlink, split into buffers to be written
+     * with scatter-gather I/O. The buffers refer to the request's own storage, so they
+     * are valid until the request is changed or destroyed.
+     */
+    virtual std::vector<boost::asio::const_buffer> getRequestBuffers() const = 0;
     virtual void setHeaderField(const std::string& name, const std::string& value) = 0;
     virtual void removeHeaderField(const std::string& name) = 0;
     virtual ~IHttpRequest() { }
@@ -36,20 +36,29 @@ public:
     virtual std::string getHost() const;
     virtual std::uint16_t getPort() const;
     virtual std::string getRequestData() const;
+    virtual std::vector<boost::asio::const_buffer> getRequestBuffers() const;
     virtual void setHeaderField(const std::string& name, const std::string& value);
     virtual void removeHeaderField(const std::string& name);
 
     void setBodyField(const std::string& name, const std::vector<std::uint8_t>& value);
+    void setBodyField(const std::string& name, std::vector<std::uint8_t>&& value);
     void removeBodyField(const std::string& name);
 
 private:
     static const std::string BOUNDARY;
+    static const std::string CRLF;
 
 private:
     HttpUrl url_;
     std::map<std::string, std::string> headerFields_;
     std::map<std::string, std::vector<std::uint8_t>> bodyFields_;
 
+    /*
+     * The request line with the headers, the header of each body part and the closing
+     * boundary. The body parts themselves are written straight from bodyFields_.
+     */
+    mutable std::vector<std::string> framing_;
+
     IKaaClientContext &context_;
 };
 
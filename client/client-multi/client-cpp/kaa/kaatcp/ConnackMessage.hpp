@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace kaa {
 
@@ -45,11 +46,24 @@ public:
     std::string getMessage() const;
     ConnackReturnCode getReturnCode() const { return returnCode_; }
 
+    /**
+     * The opaque ticket which resumes the session in the next CONNECT, empty if the server didn't issue it.
+     */
+    const std::vector<std::uint8_t>& getSessionTicket() const { return sessionTicket_; }
+
+    /**
+     * The lifetime of the session ticket in seconds.
+     */
+    std::uint16_t getSessionTicketLifetime() const { return sessionTicketLifetime_; }
+
 private:
     void parseMessage(const char *payload, std::uint16_t size);
 
 private:
     ConnackReturnCode returnCode_;
+
+    std::vector<std::uint8_t> sessionTicket_;
+    std::uint16_t sessionTicketLifetime_ = 0;
 };
 
 }
@@ -38,6 +38,49 @@ public:
             const T& signature,
             const U& sessionKey,
             const V& payload) : message_(0)
+    {
+        build(timer, nextProtocolId,
+              sessionKey.size() > 0 ? KaaTcpCommon::KAA_CONNECT_SESSION_KEY_FLAGS : 0,
+              sessionKey, signature, payload);
+    }
+
+    /**
+     * Creates CONNECT which resumes the session of the ticket received in CONNACK instead of sending
+     * a new session key. The payload must be encrypted with the session key of the ticket.
+     *
+     * The ticket is sent in place of the session key prefixed with its length, there is no signature.
+     */
+    template<class V>
+    static ConnectMessage resumeSession(std::uint16_t timer,
+            std::uint32_t nextProtocolId,
+            const std::vector<std::uint8_t>& sessionTicket,
+            const V& payload)
+    {
+        std::vector<std::uint8_t> ticketField(sizeof(std::uint16_t));
+        std::uint16_t ticketLengthNetworkOrder = htons(sessionTicket.size());
+        std::copy(reinterpret_cast<std::uint8_t *>(&ticketLengthNetworkOrder), reinterpret_cast<std::uint8_t *>(&ticketLengthNetworkOrder) + 2, ticketField.begin());
+        ticketField.insert(ticketField.end(), sessionTicket.begin(), sessionTicket.end());
+
+        ConnectMessage message;
+        message.build(timer, nextProtocolId, KaaTcpCommon::KAA_CONNECT_SESSION_TICKET_FLAGS,
+                      ticketField, std::vector<std::uint8_t>(), payload);
+        return message;
+    }
+
+    ~ConnectMessage() { }
+
+    const std::vector<std::uint8_t>& getRawMessage() const { return message_; }
+
+private:
+    ConnectMessage() : message_(0) { }
+
+    template<class T, class U, class V>
+    void build(std::uint16_t timer,
+            std::uint32_t nextProtocolId,
+            std::uint8_t sessionKeyFlags,
+            const U& sessionKey,
+            const T& signature,
+            const V& payload)
     {
         char header[6];
         std::uint8_t size = KaaTcpCommon::createBasicHeader(
@@ -67,7 +110,7 @@ public:
         std::copy(reinterpret_cast<std::uint8_t *>(&nextProtocolIdNetworkOrder), reinterpret_cast<std::uint8_t *>(&nextProtocolIdNetworkOrder) + 4, messageIt);
         messageIt += sizeof(std::uint32_t);
 
-        *(messageIt++) = sessionKey.size() > 0 ? KaaTcpCommon::KAA_CONNECT_SESSION_KEY_FLAGS : 0;
+        *(messageIt++) = sessionKeyFlags;
         *(messageIt++) = signature.size() > 0 ? KaaTcpCommon::KAA_CONNECT_SIGNATURE_FLAGS : 0;
 
         std::uint16_t timerNetworkOrder = htons(timer);
@@ -82,9 +125,6 @@ public:
 
         std::copy(payload.begin(), payload.end(), messageIt);
     }
-    ~ConnectMessage() { }
-
-    const std::vector<std::uint8_t>& getRawMessage() const { return message_; }
 
 private:
     std::vector<std::uint8_t> message_;
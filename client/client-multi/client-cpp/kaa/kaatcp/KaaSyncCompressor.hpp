@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KAASYNCCOMPRESSOR_HPP_
+#define KAASYNCCOMPRESSOR_HPP_
+
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+
+#include <vector>
+#include <cstdint>
+
+namespace kaa {
+
+/**
+ * @brief Compresses payloads of KaaSync messages, which are sent with the zipped flag set.
+ *
+ * The payload is compressed before the encryption and is in the zlib format (RFC 1950).
+ */
+class KaaSyncCompressor
+{
+public:
+    /**
+     * @brief Payloads smaller than this value (in bytes) are not worth compressing.
+     */
+    static const std::size_t MIN_COMPRESSIBLE_SIZE = 256;
+
+    /**
+     * @brief Compresses data.
+     *
+     * @param[in]  data          The data to compress.
+     * @param[in]  size          The data size.
+     * @param[out] compressed    The compressed data.
+     *
+     * @return @c false if the data is too small or the compressed data is not smaller than the original one.
+     * In this case the data should be sent uncompressed.
+     *
+     * @throw KaaException    The compression failed.
+     */
+    static bool compress(const std::uint8_t *data, std::size_t size, std::vector<std::uint8_t>& compressed);
+
+    /**
+     * @brief Decompresses data, which are compressed by @link compress() @endlink.
+     *
+     * @throw KaaException    The data are corrupted or too large.
+     */
+    static std::vector<std::uint8_t> decompress(const std::uint8_t *data, std::size_t size);
+};
+
+}
+
+#endif
+
+#endif /* KAASYNCCOMPRESSOR_HPP_ */
@@ -17,6 +17,9 @@
 #ifndef KAASYNCREQUEST_HPP_
 #define KAASYNCREQUEST_HPP_
 
+#include <vector>
+#include <cstdint>
+
 #include "kaa/kaatcp/KaaTcpCommon.hpp"
 #include "kaa/kaatcp/IKaaTcpRequest.hpp"
 #ifdef _WIN32
@@ -38,20 +41,34 @@ class KaaSyncRequest : public IKaaTcpRequest
 {
 public:
     template<class T>
-    KaaSyncRequest(bool zipped, bool encrypted, std::uint16_t messageId, const T& payload, KaaSyncMessageType messageType) : message_(0)
+    KaaSyncRequest(bool zipped, bool encrypted, std::uint16_t messageId, const T& payload, KaaSyncMessageType messageType)
+        : message_(createHeader(zipped, encrypted, messageId, payload.size(), messageType))
+    {
+        message_.insert(message_.end(), payload.begin(), payload.end());
+    }
+
+    /**
+     * @brief Creates the KAASYNC header (the fixed and variable ones) of a message with the payload
+     * of the given size.
+     *
+     * The header followed by the payload is the same as @link getRawMessage() @endlink, so they may be
+     * sent as separate buffers without concatenating the payload to the header.
+     */
+    static std::vector<std::uint8_t> createHeader(bool zipped, bool encrypted, std::uint16_t messageId,
+                                                  std::size_t payloadSize, KaaSyncMessageType messageType)
     {
         char header[6];
         std::uint8_t size = KaaTcpCommon::createBasicHeader(
                 (std::uint8_t) KaaTcpMessageType::MESSAGE_KAASYNC,
-                payload.size() + KaaTcpCommon::KAA_SYNC_HEADER_LENGTH, header);
+                payloadSize + KaaTcpCommon::KAA_SYNC_HEADER_LENGTH, header);
 
-        message_.resize(payload.size() + KaaTcpCommon::KAA_SYNC_HEADER_LENGTH + size);
+        std::vector<std::uint8_t> message(KaaTcpCommon::KAA_SYNC_HEADER_LENGTH + size);
 
         std::copy(reinterpret_cast<const std::uint8_t *>(header),
                 reinterpret_cast<const std::uint8_t *>(header + size),
-                message_.begin());
+                message.begin());
 
-        auto messageIt = message_.begin() + size;
+        auto messageIt = message.begin() + size;
 
         std::uint16_t nameLengthNetworkOrder = htons(KaaTcpCommon::KAA_TCP_NAME_LENGTH);
         std::copy(reinterpret_cast<std::uint8_t *>(&nameLengthNetworkOrder), reinterpret_cast<std::uint8_t *>(&nameLengthNetworkOrder) + 2, messageIt);
@@ -76,9 +93,8 @@ public:
         if (encrypted) {
             *messageIt |= KaaTcpCommon::KAA_SYNC_ENCRYPTED_BIT;
         }
-        ++messageIt;
 
-        std::copy(payload.begin(), payload.end(), messageIt);
+        return message;
     }
 
     ~KaaSyncRequest() { }
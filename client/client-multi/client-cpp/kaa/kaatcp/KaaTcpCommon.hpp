@@ -38,6 +38,7 @@ public:
     static const std::uint8_t FIRST_BIT = 0x80;
     static const std::uint8_t MAX_MESSAGE_TYPE_LENGTH = 0x0F;
     static const std::uint32_t MAX_MESSAGE_LENGTH = 0x0FFFFFFF;
+    static const std::uint8_t MAX_LENGTH_BYTES = 4;
     static const std::uint8_t PROTOCOL_VERSION = 0x01;
 
     static const std::uint8_t KAA_SYNC_HEADER_LENGTH = 12;
@@ -48,6 +49,9 @@ public:
     static const std::uint8_t KAA_CONNECT_HEADER_LENGTH = 18;
     static const std::uint8_t KAA_CONNECT_SESSION_KEY_FLAGS = 0x11;
     static const std::uint8_t KAA_CONNECT_SIGNATURE_FLAGS = 0x01;
+    static const std::uint8_t KAA_CONNECT_SESSION_TICKET_FLAGS = 0x12;
+
+    static const std::uint8_t KAA_CONNACK_SESSION_TICKET_FLAG = 0x01;
 
     static const char * const KAA_TCP_NAME;
     static const std::uint16_t KAA_TCP_NAME_LENGTH = 6;
@@ -18,6 +18,8 @@
 #define KAATCPPARSER_HPP_
 
 #include <cstdint>
+#include <functional>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_array.hpp>
 #include "kaa/kaatcp/KaaTcpCommon.hpp"
@@ -29,6 +31,11 @@ namespace kaa {
 typedef std::pair<KaaTcpMessageType, std::pair<boost::shared_array<char>, std::uint32_t>> MessageRecord;
 typedef std::list<MessageRecord> MessageRecordList;
 
+/**
+ * Called for each parsed message. The payload is valid only during the call.
+ */
+typedef std::function<void (KaaTcpMessageType type, const char *payload, std::uint32_t size)> KaaTcpMessageHandler;
+
 enum class KaaTcpParserState : std::uint8_t
 {
     NONE = 0x00,
@@ -44,9 +51,19 @@ public:
           , lenghtMultiplier_(1), messageType_(KaaTcpMessageType::MESSAGE_UNKNOWN), context_(context) { }
     ~KaaTcpParser() { }
 
+    /**
+     * Parses the buffer and keeps parsed messages to be taken by @c releaseMessages().
+     */
     void parseBuffer(const char *buffer, std::uint32_t size);
 
-    boost::shared_array<char> getCurrentPayload() const { return messagePayload_; }
+    /**
+     * Parses the buffer and passes each parsed message to the handler.
+     *
+     * A payload which is fully contained in the buffer is passed without copying. Only a payload
+     * split between buffers is accumulated in the parser.
+     */
+    void parseBuffer(const char *buffer, std::uint32_t size, const KaaTcpMessageHandler& handler);
+
     std::uint32_t getCurrentPayloadLength() const { return messageLength_; }
     KaaTcpMessageType getCurrentMessageType() const { return messageType_; }
 
@@ -55,9 +72,12 @@ public:
     void resetParser();
 
 private:
-    void processByte(char byte);
+    void processByte(char byte, const KaaTcpMessageHandler& handler);
+    std::uint32_t readFixedHeader(const char *buffer, std::uint32_t size, const KaaTcpMessageHandler& handler);
+    void onLengthDone(const KaaTcpMessageHandler& handler);
     void retrieveMessageType(char byte);
-    void onMessageDone();
+    void onMessageDone(const char *payload, const KaaTcpMessageHandler& handler);
+    void resetState();
 
 private:
 
@@ -66,7 +86,7 @@ private:
     std::uint32_t processedPayloadLength_;
     std::uint32_t lenghtMultiplier_;
     KaaTcpMessageType messageType_;
-    boost::shared_array<char> messagePayload_;
+    std::vector<char> splitPayload_;
     MessageRecordList messages_;
     IKaaClientContext &context_;
 };
@@ -44,6 +44,8 @@ public:
     void flush() { parser_.resetParser(); }
 
 private:
+    void processMessage(KaaTcpMessageType type, const char *payload, std::uint32_t size);
+
     std::function<void (const ConnackMessage&)> onConnack_;
     std::function<void (const KaaSyncResponse&)> onKaaSyncResponse_;
     std::function<void (const DisconnectMessage&)> onDisconnect_;
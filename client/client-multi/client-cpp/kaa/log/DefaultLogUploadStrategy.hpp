@@ -68,6 +68,12 @@ public:
     virtual std::size_t getLogUploadCheckPeriod() { return logUploadCheckReriod_;  };
     void setLogUploadCheckPeriod(std::size_t period) { logUploadCheckReriod_ = period; }
 
+    /**
+     * @brief Decisions depend only on the log storage status. A retry after
+     * a failure is scheduled via @link ILogFailoverCommand::retryLogUpload() @endlink.
+     */
+    virtual bool isTimeDependent() { return false; }
+
     virtual std::size_t getMaxParallelUploads() { return maxParallelUploads_; }
     void setMaxParallelUploads(std::size_t count) { maxParallelUploads_ = count; }
 
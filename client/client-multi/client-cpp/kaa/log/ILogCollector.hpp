@@ -21,9 +21,11 @@
 
 #include "kaa/log/gen/LogDefinitions.hpp"
 #include "kaa/log/ILogStorage.hpp"
+#include "kaa/log/LogPriority.hpp"
 #include "kaa/log/ILogUploadStrategy.hpp"
 #include "kaa/log/ILogDeliveryListener.hpp"
 #include "kaa/log/RecordFuture.hpp"
+#include "kaa/log/RecordBatch.hpp"
 
 /**
  * @file ILogCollector.hpp
@@ -66,6 +68,70 @@ public:
      */
     virtual RecordFuture addLogRecord(const KaaUserLogRecord& record) = 0;
 
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage.
+     *
+     * The priority is taken into account only by storages, which support it, e.g. @c PriorityLogStorage.
+     *
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     *
+     * @see LogPriority
+     */
+    virtual RecordFuture addLogRecord(const KaaUserLogRecord& record, LogPriority priority) = 0;
+
+    /**
+     * @brief Adds a new log record to the log storage without tracking its delivery.
+     *
+     * Unlike @link addLogRecord() @endlink, no @c RecordFuture is created for the record. The delivery is
+     * reported only per log bucket via @c ILogDeliveryListener.
+     *
+     * @param[in] record    The log record to be added.
+     *
+     * @throw KaaException    The record cannot be serialized.
+     *
+     * @see setLogDeliveryListener()
+     */
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record) = 0;
+
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage without tracking
+     * its delivery.
+     *
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     *
+     * @throw KaaException    The record cannot be serialized.
+     */
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record, LogPriority priority) = 0;
+
+    /**
+     * @brief Adds a new log record to the log storage and tracks its delivery with the batch.
+     *
+     * No @c RecordFuture is created for the record. Use @link RecordBatch::whenAll() @endlink to wait
+     * for the delivery of all records of the batch at once.
+     *
+     * @param[in] batch     The batch the record belongs to.
+     * @param[in] record    The log record to be added.
+     *
+     * @throw KaaException    The batch is closed.
+     *
+     * @see RecordBatch
+     */
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record) = 0;
+
+    /**
+     * @brief Adds a new log record of the specified priority class to the log storage and tracks its delivery
+     * with the batch.
+     *
+     * @param[in] batch       The batch the record belongs to.
+     * @param[in] record      The log record to be added.
+     * @param[in] priority    The priority class of the record.
+     *
+     * @throw KaaException    The batch is closed.
+     */
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record, LogPriority priority) = 0;
+
     /**
      * @brief Sets the new log storage.
      *
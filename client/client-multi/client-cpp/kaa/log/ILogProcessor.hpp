@@ -17,6 +17,10 @@
 #ifndef ILOGPROCESSOR_HPP_
 #define ILOGPROCESSOR_HPP_
 
+#include <memory>
+#include <vector>
+#include <cstdint>
+
 namespace kaa {
 
 struct LogSyncRequest;
@@ -29,6 +33,13 @@ class ILogProcessor {
 public:
 
     virtual std::shared_ptr<LogSyncRequest> getLogUploadRequest() = 0;
+
+    /**
+     * The same as @link getLogUploadRequest() @endlink, but returns the request Avro-encoded.
+     * A retried request is returned as it was encoded the first time.
+     */
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> getEncodedLogUploadRequest() = 0;
+
     /**
      * Called when log upload response arrived.
      *
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <cstdint>
+#include <functional>
 
 #include "kaa/log/BucketInfo.hpp"
 #include "kaa/log/LogBucket.hpp"
@@ -39,6 +40,14 @@ class ILogStorageStatus;
  */
 class ILogStorage {
 public:
+    /**
+     * @brief The callback which is called for each log record of a log bucket.
+     *
+     * The first parameter is serialized log record data, which is valid only during the call.
+     * The second one is the size of the data.
+     */
+    typedef std::function<void (const std::uint8_t *, std::size_t)> LogRecordVisitor;
+
     /**
      * @brief Persists a log record.
      *
@@ -65,6 +74,26 @@ public:
      */
     virtual LogBucket getNextBucket() = 0;
 
+    /**
+     * @brief Passes log records of a new log bucket to the visitor instead of returning them in @c LogBucket.
+     *
+     * Unlike @link getNextBucket() @endlink, it lets a log storage hand out log records without
+     * intermediate copies. The default implementation is based on @link getNextBucket() @endlink.
+     *
+     * @param visitor The callback which is called for each log record of the bucket in order.
+     * @return The @c BucketInfo object of the bucket. The log count is zero if there is no log bucket.
+     * @see BucketInfo
+     */
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor)
+    {
+        LogBucket bucket = getNextBucket();
+        for (auto& record : bucket.getRecords()) {
+            visitor(record.getData().data(), record.getSize());
+        }
+
+        return BucketInfo(bucket.getBucketId(), bucket.getRecords().size());
+    }
+
     /**
      * @brief Tells a log storage to remove a log bucket.
      *
@@ -84,6 +113,45 @@ public:
      */
     virtual void rollbackBucket(std::int32_t bucketId) = 0;
 
+    /**
+     * @brief Changes limits of log buckets at runtime.
+     *
+     * New limits apply to the bucket being filled and to next buckets. Records, which are already in a bucket,
+     * stay there.
+     * The default implementation does not support changing limits.
+     *
+     * @param bucketSize The max size of a bucket in bytes.
+     * @param bucketRecordCount The max number of records in a bucket.
+     * @return @c true if limits are changed, @c false if the storage does not support it.
+     * @throw KaaException Any of limits is zero.
+     */
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+    {
+        return false;
+    }
+
+    /**
+     * @brief Returns the memory occupied by log records, including records of buckets being uploaded.
+     * The default implementation returns zero, e.g. for storages which keep log records on disk.
+     * @return The occupied memory in bytes.
+     */
+    virtual std::size_t getMemoryUsage()
+    {
+        return 0;
+    }
+
+    /**
+     * @brief Removes elder log records, until the rest of them occupy at most the given volume of memory.
+     * It is called when the memory held by the SDK exceeds its soft limit.
+     * The default implementation does not release anything.
+     * @param allowedVolume The volume in bytes which log records may occupy.
+     * @return @c true if the storage supports it.
+     */
+    virtual bool releaseMemory(std::size_t allowedVolume)
+    {
+        return false;
+    }
+
     virtual ~ILogStorage() {}
 };
 
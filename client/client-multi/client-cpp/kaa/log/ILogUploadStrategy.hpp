@@ -21,6 +21,7 @@
 #include <cstdint>
 
 #include "kaa/gen/EndpointGen.hpp"
+#include "kaa/log/BucketInfo.hpp"
 
 namespace kaa {
 
@@ -69,10 +70,24 @@ public:
      */
     virtual std::size_t getTimeout() = 0;
 
+    /**
+     * @deprecated Delivery timeouts are checked at their deadlines, the period isn't used anymore.
+     */
     virtual std::size_t getTimeoutCheckPeriod() = 0;
 
     virtual std::size_t getLogUploadCheckPeriod() = 0;
 
+    /**
+     * @brief Tells whether upload decisions depend on time besides the log storage status.
+     *
+     * If @c false, the decision is requested only on changes of the log storage, i.e. on adding log records
+     * and on log delivery responses. Otherwise, it is also requested @link getLogUploadCheckPeriod() @endlink
+     * seconds after the first @c NOOP decision made while there are records to upload.
+     *
+     * The default implementation returns @c true.
+     */
+    virtual bool isTimeDependent() { return true; }
+
     /**
      * @brief Max amount of log batches allowed to be uploaded parallel.
      *
@@ -97,6 +112,16 @@ public:
      */
     virtual void onFailure(ILogFailoverCommand& controller, LogDeliveryErrorCode code) = 0;
 
+    /**
+     * @brief Callback is used when the log bucket is successfully delivered.
+     *
+     * The default implementation does nothing.
+     *
+     * @param[in] bucketInfo        The delivered log bucket.
+     * @param[in] deliveryTimeMs    Time in milliseconds between sending the bucket and receiving its delivery status.
+     */
+    virtual void onSuccess(const BucketInfo& bucketInfo, std::size_t deliveryTimeMs) {}
+
     virtual ~ILogUploadStrategy() {}
 };
 
@@ -20,8 +20,10 @@
 
 #include <chrono>
 #include <memory>
-#include <future>
 #include <list>
+#include <map>
+#include <set>
+#include <vector>
 #include <unordered_map>
 #include <cstdint>
 
@@ -33,6 +35,10 @@
 #include "kaa/channel/IKaaChannelManager.hpp"
 #include "kaa/log/ILogFailoverCommand.hpp"
 #include "kaa/utils/KaaTimer.hpp"
+#include "kaa/utils/MpscQueue.hpp"
+#include "kaa/utils/KaaFuture.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/RecordBatch.hpp"
 #include "kaa/IKaaClientContext.hpp"
 
 namespace kaa {
@@ -46,8 +52,9 @@ typedef std::chrono::system_clock clock_t;
 class TimeoutInfo {
 
 public:
-    TimeoutInfo(const std::int32_t& transportAccessPointId, const std::chrono::time_point<clock_t>& timeoutTime)
-        : transportAccessPointId_(transportAccessPointId), timeoutTime_(timeoutTime) {}
+    TimeoutInfo(const std::int32_t& transportAccessPointId, const std::chrono::time_point<clock_t>& timeoutTime,
+                std::size_t sendTimeMs = 0)
+        : transportAccessPointId_(transportAccessPointId), timeoutTime_(timeoutTime), sendTimeMs_(sendTimeMs) {}
 
     std::int32_t getTransportAccessPointId() const {
         return transportAccessPointId_;
@@ -57,19 +64,55 @@ public:
         return timeoutTime_;
     }
 
+    std::size_t getSendTimeMs() const {
+        return sendTimeMs_;
+    }
+
 private:
     std::int32_t transportAccessPointId_;
     std::chrono::time_point<clock_t> timeoutTime_;
+    std::size_t sendTimeMs_;
 };
 
 /**
  * Default @c ILogCollector implementation.
+ *
+ * Log records are encoded on the caller thread and put into a lock-free queue. A single task on the API
+ * executor moves all queued records into the log storage at once, so concurrent callers of
+ * @link addLogRecord() @endlink do not wait for each other on the storage.
+ *
+ * Several log buckets may be in flight at once. Once a bucket is sent, the next one is requested
+ * without waiting for the delivery status, while the number of in-flight buckets is below the upload
+ * window. The window starts at @link ILogUploadStrategy::getMaxParallelUploads() @endlink and adapts
+ * to the observed delivery round trip time: it grows while the round trip time is close to the minimal
+ * one, shrinks when the round trip time grows, and is halved on a delivery failure or timeout.
+ *
+ * The upload decision is requested on adding records and on delivery responses. The log upload check
+ * timer is armed only for time-dependent strategies (see @link ILogUploadStrategy::isTimeDependent() @endlink)
+ * while there are records to upload, and the delivery timeout timer only while there are buckets in flight,
+ * so an idle collector doesn't wake up.
  */
 class LogCollector : public ILogCollector, public ILogProcessor, public ILogFailoverCommand {
 public:
     LogCollector(IKaaChannelManagerPtr manager, IKaaClientContext &context);
 
-    virtual RecordFuture addLogRecord(const KaaUserLogRecord& record);
+    virtual RecordFuture addLogRecord(const KaaUserLogRecord& record) {
+        return addLogRecord(record, LogPriority::NORMAL);
+    }
+
+    virtual RecordFuture addLogRecord(const KaaUserLogRecord& record, LogPriority priority);
+
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record) {
+        addLogRecordWithoutFuture(record, LogPriority::NORMAL);
+    }
+
+    virtual void addLogRecordWithoutFuture(const KaaUserLogRecord& record, LogPriority priority);
+
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record) {
+        addLogRecord(batch, record, LogPriority::NORMAL);
+    }
+
+    virtual void addLogRecord(RecordBatch& batch, const KaaUserLogRecord& record, LogPriority priority);
 
     virtual void setStorage(ILogStoragePtr storage);
     virtual void setUploadStrategy(ILogUploadStrategyPtr strategy);
@@ -79,26 +122,72 @@ public:
     }
 
     virtual std::shared_ptr<LogSyncRequest> getLogUploadRequest();
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> getEncodedLogUploadRequest();
     virtual void onLogUploadResponse(const LogSyncResponse& response, std::size_t deliveryTime);
 
     void setTransport(LoggingTransport* transport) {
         transport_ = transport;
     }
 
+    /**
+     * @return The memory occupied by records in the current log storage.
+     */
+    std::size_t getStorageMemoryUsage() {
+        return storage_->getMemoryUsage();
+    }
+
+    /**
+     * Asks the current log storage to shed records down to the given volume.
+     *
+     * @return @c true if the storage supports releasing memory.
+     */
+    bool releaseStorageMemory(std::size_t allowedVolume) {
+        return storage_->releaseMemory(allowedVolume);
+    }
+
+    /**
+     * Caps the size of log buckets, e.g. to the burst of the logging rate limit, so records are split
+     * into buckets which fit it rather than sent in debt. It applies to storages set later as well,
+     * and the record count limit of buckets becomes the default one.
+     *
+     * @param bucketSize    The max size of a bucket in bytes, 0 - the storage limits are kept.
+     * @return @c true if the storage supports changing bucket limits.
+     */
+    bool setMaxBucketSize(std::size_t bucketSize);
+
 private:
-    typedef std::shared_ptr<std::promise<RecordInfo>> DeliveryFuture;
+    typedef std::shared_ptr<KaaPromise<RecordInfo>> DeliveryFuture;
 
+    /*
+     * The delivery future is empty for records added without a future or to a batch.
+     */
     struct RecordDeliveryInfo {
-        RecordDeliveryInfo(const DeliveryFuture& f, const RecordInfo& info)
-            : deliveryFuture_(f), recordInfo_(info) {}
+        RecordDeliveryInfo(const DeliveryFuture& f, const RecordInfo& info,
+                           const detail::RecordBatchStatePtr& batch = detail::RecordBatchStatePtr())
+            : deliveryFuture_(f), recordInfo_(info), batch_(batch) {}
+
+        DeliveryFuture               deliveryFuture_;
+        RecordInfo                   recordInfo_;
+        detail::RecordBatchStatePtr  batch_;
+    };
+
+    struct PendingLogRecord {
+        PendingLogRecord(LogRecord&& record, const RecordDeliveryInfo& info)
+            : record_(std::move(record)), recordDeliveryInfo_(info) {}
 
-        DeliveryFuture deliveryFuture_;
-        RecordInfo     recordInfo_;
+        LogRecord          record_;
+        RecordDeliveryInfo recordDeliveryInfo_;
     };
 
+    /*
+     * Records of a batch are counted per bucket, so a delivered bucket decrements the batch counter once.
+     */
+    typedef std::vector<std::pair<detail::RecordBatchStatePtr, std::size_t/*record count*/>> BatchRecordCounts;
+
     struct BucketWrapper {
         BucketInfo                    bucketInfo_;
         std::list<RecordDeliveryInfo> recordDeliveryInfoStorage_;
+        BatchRecordCounts             batchRecordCounts_;
     };
 
 private:
@@ -108,20 +197,27 @@ private:
     virtual void switchAccessPoint();
 
     void doSync();
+    void scheduleDrainOfPendingLogRecords();
+    void drainPendingLogRecords();
     void processLogUploadDecision(LogUploadStrategyDecision decision);
 
     bool isDeliveryTimeout();
     void addDeliveryTimeout(std::int32_t requestId);
-    bool removeDeliveryTimeout(std::int32_t requestId);
+    bool removeDeliveryTimeout(std::int32_t requestId, std::size_t& sendTimeMs);
 
     void startTimeoutTimer();
     void startLogUploadCheckTimer();
+    void scheduleLogUploadCheck();
 
     void processTimeout();
 
     void rescheduleTimers();
 
     bool isUploadAllowed();
+    bool hasFreeUploadSlot();
+    std::size_t getUploadWindow();
+    void adaptUploadWindow(std::size_t roundTripTimeMs);
+    void shrinkUploadWindow();
 
 
     void updateBucketInfo(const BucketInfo& bucketInfo, const RecordDeliveryInfo& recordInfo);
@@ -129,15 +225,32 @@ private:
     void notifyDeliveryFuturesOnSuccess(std::int32_t bucketId, std::size_t deliveryTime);
     void removeBucketInfo(std::int32_t);
 
+    void removeEncodedRequest(std::int32_t requestId);
+
 private:
     ILogStoragePtr           storage_;
+    std::size_t              maxBucketSize_ = 0;
     ILogUploadStrategyPtr    uploadStrategy_;
     LoggingTransport*        transport_;
 
     IKaaChannelManagerPtr    channelManager_;
 
     std::unordered_map<std::int32_t, TimeoutInfo> timeouts_;
+
+    /*
+     * Deadlines of timeouts_ in ascending order, so checks only visit expired requests
+     * and the timeout timer is started for the earliest one.
+     */
+    typedef std::pair<std::chrono::time_point<clock_t>, std::int32_t/*request id*/> TimeoutDeadline;
+    std::set<TimeoutDeadline> timeoutDeadlines_;
     std::int32_t timeoutAccessPointId_;
+
+    /*
+     * Guarded by timeoutsGuard_. Zero window means it has not been adapted yet.
+     */
+    std::size_t uploadWindow_ = 0;
+    std::size_t minRoundTripTimeMs_ = 0;
+
     KAA_MUTEX_DECLARE(timeoutsGuard_);
 
     KaaTimer<void ()>        logUploadCheckTimer_;
@@ -146,9 +259,17 @@ private:
 
     ILogDeliveryListenerPtr logDeliverylistener_;
 
+    MpscQueue<PendingLogRecord> pendingLogRecords_;
+
     std::unordered_map<std::int32_t, BucketWrapper> bucketInfoStorage_;
     KAA_MUTEX_DECLARE(bucketInfoStorageGuard_);
 
+    /*
+     * Encoded requests of the buckets which are not delivered yet, by request id.
+     */
+    std::map<std::int32_t, std::shared_ptr<const std::vector<std::uint8_t>>> encodedRequests_;
+    KAA_MUTEX_DECLARE(encodedRequestsGuard_);
+
     IKaaClientContext &context_;
 };
 
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOGPRIORITY_HPP_
+#define LOGPRIORITY_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+namespace kaa {
+
+/**
+ * @brief Priority classes of log records.
+ *
+ * The priority is taken into account by a log storage, which keeps a separate bucket queue per priority,
+ * e.g. @c PriorityLogStorage. Other storages ignore it.
+ */
+enum class LogPriority : std::uint8_t {
+    HIGH = 0,   /*!< Critical records, e.g. alarms. */
+    NORMAL,     /*!< Regular records. Used by default. */
+    LOW         /*!< Records which may wait, e.g. routine telemetry. */
+};
+
+/**
+ * @brief The number of @c LogPriority classes.
+ */
+const std::size_t LOG_PRIORITY_COUNT = 3;
+
+}  // namespace kaa
+
+#endif /* LOGPRIORITY_HPP_ */
@@ -20,17 +20,27 @@
 #include <vector>
 #include <cstdint>
 
+#include "kaa/KaaThread.hpp"
 #include "kaa/log/gen/LogDefinitions.hpp"
+#include "kaa/log/LogPriority.hpp"
 #include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/utils/ObjectPool.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+/**
+ * Serialized log record. Its buffer is taken from and returned to the @link ObjectPool @endlink,
+ * so records added at a steady rate don't allocate.
+ */
 class LogRecord {
 public:
-    LogRecord(const KaaUserLogRecord& record)
+    typedef std::vector<std::uint8_t> Buffer;
+
+    LogRecord(const KaaUserLogRecord& record, LogPriority priority = LogPriority::NORMAL)
+        : encodedRecord_(ObjectPool<Buffer>::acquire()), priority_(priority)
     {
-        AvroByteArrayConverter<KaaUserLogRecord> converter;  // TODO: make converter thread local when it would be possible
+        static kaa_thread_local AvroByteArrayConverter<KaaUserLogRecord> converter;
         converter.toByteArray(record, encodedRecord_);
     }
 
@@ -40,17 +50,39 @@ public:
             throw KaaException("Null serialized log data");
         }
 
+        encodedRecord_ = ObjectPool<Buffer>::acquire();
         encodedRecord_.assign(data, data + size);
     }
 
+    LogRecord(const LogRecord& record)
+        : encodedRecord_(ObjectPool<Buffer>::acquire()), priority_(record.priority_)
+    {
+        encodedRecord_ = record.encodedRecord_;
+    }
+
+    LogRecord(LogRecord&& record) = default;
+
+    LogRecord& operator=(const LogRecord& record) = default;
+    LogRecord& operator=(LogRecord&& record) = default;
+
+    ~LogRecord()
+    {
+        if (encodedRecord_.capacity()) {
+            ObjectPool<Buffer>::release(std::move(encodedRecord_));
+        }
+    }
+
     std::vector<std::uint8_t>& getData() { return encodedRecord_; }
 
     std::vector<std::uint8_t>&& getRvalueData(){ return std::move(encodedRecord_); }
 
     std::size_t getSize() const { return encodedRecord_.size(); }
 
+    LogPriority getPriority() const { return priority_; }
+
 private:
-    std::vector<std::uint8_t> encodedRecord_;
+    Buffer         encodedRecord_;
+    LogPriority    priority_ = LogPriority::NORMAL;
 };
 
 }  // namespace kaa
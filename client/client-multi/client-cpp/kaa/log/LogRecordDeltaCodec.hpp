@@ -0,0 +1,73 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOGRECORDDELTACODEC_HPP_
+#define LOGRECORDDELTACODEC_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kaa {
+
+/**
+ * @brief Encodes a log record as the difference from the previous one.
+ *
+ * Consecutive records of one schema mostly differ in a few fields, e.g. a timestamp and a reading, so a record
+ * is encoded as the size of the tail common with the reference record followed by operations over the rest:
+ * a literal run taken from the delta and a run copied from the reference at the same offset. Sizes are varints.
+ * The encoding is byte-level, it doesn't depend on the schema.
+ */
+class LogRecordDeltaCodec {
+public:
+    /**
+     * @brief Encodes the record against the reference record.
+     *
+     * @param[out] delta    Replaced by the delta.
+     *
+     * @return @c false if the delta isn't smaller than the record, which should be stored as is then.
+     */
+    static bool encode(const std::uint8_t *reference, std::size_t referenceSize,
+                       const std::uint8_t *record, std::size_t recordSize,
+                       std::vector<std::uint8_t>& delta);
+
+    /**
+     * @brief Restores the record from the delta and the reference record it was encoded against.
+     *
+     * @param[out] record    Replaced by the record.
+     *
+     * @throw KaaException The delta is corrupted.
+     */
+    static void decode(const std::uint8_t *reference, std::size_t referenceSize,
+                       const std::uint8_t *delta, std::size_t deltaSize,
+                       std::vector<std::uint8_t>& record);
+
+    /**
+     * @return The size of the record encoded by the delta.
+     *
+     * @throw KaaException The delta is corrupted.
+     */
+    static std::size_t getDecodedSize(const std::uint8_t *delta, std::size_t deltaSize);
+
+    /*
+     * Shorter runs matching the reference are kept in literals, as the operation costs two bytes.
+     */
+    static const std::size_t MIN_COPY_SIZE = 4;
+};
+
+} /* namespace kaa */
+
+#endif /* LOGRECORDDELTACODEC_HPP_ */
@@ -27,6 +27,11 @@ public:
     static const std::size_t DEFAULT_MAX_BUCKET_SIZE         = 16 * 1024;
     static const std::size_t DEFAULT_MAX_BUCKET_RECORD_COUNT = 256;
 
+    static const std::size_t DEFAULT_GROUP_COMMIT_RECORD_COUNT = 1;
+    static const std::size_t DEFAULT_GROUP_COMMIT_TIMEOUT_MS   = 0;
+
+    static const std::size_t DEFAULT_BUCKET_CACHE_SIZE = 2 * DEFAULT_MAX_BUCKET_SIZE;
+
     static const std::string DEFAULT_LOG_DB_STORAGE /* logs.db */;
 };
 
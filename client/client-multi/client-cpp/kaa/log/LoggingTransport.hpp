@@ -34,6 +34,7 @@ public:
     virtual void sync();
 
     virtual std::shared_ptr<LogSyncRequest> createLogSyncRequest();
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> createEncodedLogSyncRequest();
     virtual void onLogSyncResponse(const LogSyncResponse& response, std::size_t deliveryTime);
 
 private:
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MMAPSEGMENTLOGSTORAGE_HPP_
+#define MMAPSEGMENTLOGSTORAGE_HPP_
+
+#include <map>
+#include <string>
+#include <cstdint>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/log/ILogStorage.hpp"
+#include "kaa/log/ILogStorageStatus.hpp"
+#include "kaa/log/LogStorageConstants.hpp"
+
+#define KAA_DEFAULT_LOG_SEGMENT_DIRECTORY    "logs"
+
+namespace kaa {
+
+class IKaaClientContext;
+
+/**
+ * @brief Log storage which keeps each log bucket in its own memory-mapped segment file.
+ *
+ * A segment file consists of a small header followed by length-prefixed log records. Records are appended
+ * to the mapped memory of the current segment, and the header is updated after a record is written,
+ * so the segment never refers to a partially written record. Segments survive restarts: on creation
+ * the storage scans the directory and loads all valid segments as free buckets.
+ *
+ * Removing a bucket unlinks its segment file. Marking a bucket as in-use or free only changes a flag
+ * in the segment header.
+ *
+ * @b NOTE: Segments are written via a shared mapping, so they survive a crash of the process, but the last
+ * written records may be lost on a power loss. The storage is available only on POSIX systems.
+ */
+class MMapSegmentLogStorage : public ILogStorage, public ILogStorageStatus {
+public:
+    /**
+     * @param[in] context              The Kaa client context.
+     * @param[in] directory            The directory for segment files. It is created if it does not exist.
+     * @param[in] bucketSize           The max size of a bucket in bytes.
+     * @param[in] bucketRecordCount    The max number of records in a bucket.
+     *
+     * @throw KaaException    The directory or a segment file cannot be created.
+     */
+    MMapSegmentLogStorage(IKaaClientContext &context,
+                          const std::string& directory = KAA_DEFAULT_LOG_SEGMENT_DIRECTORY,
+                          std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                          std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    ~MMapSegmentLogStorage();
+
+    virtual BucketInfo addLogRecord(LogRecord&& record);
+    virtual ILogStorageStatus& getStatus() { return *this; }
+
+    virtual LogBucket getNextBucket();
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor);
+    virtual void removeBucket(std::int32_t bucketId);
+    virtual void rollbackBucket(std::int32_t bucketId);
+
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount);
+
+    virtual std::size_t getConsumedVolume();
+    virtual std::size_t getRecordsCount();
+
+private:
+    struct SegmentInfo {
+        bool            isInUse_ = false;
+        std::size_t     recordCount_ = 0;
+        std::size_t     sizeInBytes_ = 0;
+    };
+
+    /*
+     * A segment file mapped into memory.
+     */
+    struct MappedSegment {
+        std::int32_t    bucketId_ = 0;
+        int             fd_ = -1;
+        std::uint8_t   *data_ = nullptr;
+        std::size_t     size_ = 0;
+    };
+
+    void loadSegments();
+
+    std::string getSegmentPath(std::int32_t bucketId) const;
+    std::size_t getSegmentFileSize() const;
+
+    void openNewSegment();
+    void mapSegment(std::int32_t bucketId, bool isCreated, MappedSegment& segment);
+    void unmapSegment(MappedSegment& segment);
+    void closeCurrentSegment();
+
+    void setSegmentInUse(std::int32_t bucketId, bool isInUse);
+
+    bool checkBucketOverflow(const LogRecord& record) const {
+        const auto& currentSegment = segments_.at(currentSegment_.bucketId_);
+        return (currentSegment.sizeInBytes_ + record.getSize() > maxBucketSize_) ||
+               (currentSegment.recordCount_ + 1 > maxBucketRecordCount_);
+    }
+
+private:
+    const std::string directory_;
+
+    std::size_t maxBucketSize_;
+    std::size_t maxBucketRecordCount_;
+
+    std::int32_t lastBucketId_ = 0;
+
+    /*
+     * The segment to which new records are appended. Its file descriptor is -1,
+     * if no segment is open.
+     */
+    MappedSegment currentSegment_;
+
+    std::map<std::int32_t/*Bucket id*/, SegmentInfo> segments_;
+
+    std::size_t unmarkedRecordCount_ = 0;
+    std::size_t unmarkedSizeInBytes_ = 0;
+
+    KAA_MUTEX_DECLARE(segmentLogStorageGuard_);
+
+    IKaaClientContext &context_;
+};
+
+} /* namespace kaa */
+
+#endif /* MMAPSEGMENTLOGSTORAGE_HPP_ */
@@ -17,10 +17,16 @@
 #ifndef MEMORYLOGSTORAGE_HPP_
 #define MEMORYLOGSTORAGE_HPP_
 
+#include <map>
 #include <list>
+#include <array>
+#include <deque>
+#include <chrono>
+#include <vector>
 #include <cstdint>
 
 #include "kaa/KaaThread.hpp"
+#include "kaa/log/LogPriority.hpp"
 #include "kaa/log/ILogStorage.hpp"
 #include "kaa/log/ILogStorageStatus.hpp"
 #include "kaa/log/LogStorageConstants.hpp"
@@ -34,6 +40,19 @@ class IKaaClientContext;
  *
  * @b NOTE: Collected logs are stored in a memory. So logs will be lost if the SDK has been restarted earlier than
  * they are delivered to the Operations server.
+ *
+ * Log records of a bucket are kept in one contiguous block as length-prefixed entries, so adding a record
+ * is an append to the block and removing a bucket frees a single block.
+ *
+ * When the size-limited storage is full or the memory is released (see @link releaseMemory() @endlink),
+ * expired records (see @link setRecordTimeToLive() @endlink) are evicted first, then records of the lowest
+ * @c LogPriority, the oldest first. Records are picked from queues per priority and a heap of expiry times,
+ * so an eviction doesn't scan buckets. An evicted record is skipped on the upload, its space in the block is
+ * freed with the bucket.
+ *
+ * Optionally (see @link setDeltaEncoding() @endlink), a record is stored as the difference from the previous
+ * record of its bucket (see @c LogRecordDeltaCodec) and restored when the bucket is uploaded. The occupied
+ * size, hence the storage limit, counts the stored bytes, while the bucket size limit counts the record sizes.
  */
 class MemoryLogStorage : public ILogStorage, public ILogStorageStatus {
 public:
@@ -71,23 +90,50 @@ public:
     virtual ILogStorageStatus& getStatus() { return *this; }
 
     virtual LogBucket getNextBucket();
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor);
     virtual void removeBucket(std::int32_t bucketId);
     virtual void rollbackBucket(std::int32_t bucketId);
 
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount);
+
+    virtual std::size_t getMemoryUsage();
+    virtual bool releaseMemory(std::size_t allowedVolume);
+
     virtual std::size_t getConsumedVolume();
     virtual std::size_t getRecordsCount();
 
+    /**
+     * @brief Sets the time to live of records of the priority class, which are added later.
+     *
+     * Expired records are evicted before they are uploaded, and first when the storage is full.
+     *
+     * @param[in] priority    The priority class.
+     * @param[in] ttl         The time to live. Zero means records don't expire, which is the default.
+     */
+    void setRecordTimeToLive(LogPriority priority, std::chrono::milliseconds ttl);
+
+    /**
+     * @brief Enables or disables the delta encoding of records, which are added later. Disabled by default.
+     *
+     * Pays off for streams of similar records, e.g. periodic readings, at the cost of decoding on the upload.
+     */
+    void setDeltaEncoding(bool isEnabled);
+
 private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::uint64_t RecordSequence;
+
     void shrinkToSize(std::size_t allowedVolume);
 
-    void addNewBucket() {
-        buckets_.emplace_back(++currentBucketId_);
-    }
+    /*
+     * Keeps the last bucket if it is empty and free.
+     */
+    void addNewBucket();
 
     bool checkBucketOverflow(const LogRecord& record) {
         const auto& currentBucket = buckets_.back();
-        return (currentBucket.occupiedSize_ + record.getSize() > maxBucketSize_) ||
-               (currentBucket.logs_.size() + 1 > maxBucketRecordCount_);
+        return (currentBucket.payloadSize_ + record.getSize() > maxBucketSize_) ||
+               (currentBucket.recordCount_ + 1 > maxBucketRecordCount_);
     }
 
     void internalAddLogRecord(LogRecord&& record);
@@ -98,19 +144,112 @@ private:
         IN_USE
     };
 
+    typedef std::uint32_t RecordSizePrefix;
+
+    /*
+     * Set in the size prefix of an evicted record.
+     */
+    static const RecordSizePrefix EVICTED_RECORD_FLAG = 0x80000000;
+
+    /*
+     * Set in the size prefix of a record stored as the delta from the previous record of the bucket.
+     */
+    static const RecordSizePrefix DELTA_RECORD_FLAG = 0x40000000;
+    static const RecordSizePrefix RECORD_SIZE_MASK = ~(EVICTED_RECORD_FLAG | DELTA_RECORD_FLAG);
+
     struct InternalBucket {
-        InternalBucket(std::int32_t bucketId)
-            : bucketId_(bucketId) {}
+        InternalBucket(std::int32_t bucketId, RecordSequence firstRecordSequence)
+            : bucketId_(bucketId), firstRecordSequence_(firstRecordSequence), endRecordSequence_(firstRecordSequence) {}
+
+        /*
+         * Returns the offset of the record. The delta buffer is a scratch space.
+         */
+        std::size_t addRecord(LogRecord& record, bool deltaEncoding, std::vector<std::uint8_t>& delta);
+
+        bool isRecordEvicted(std::size_t offset) const;
+
+        /*
+         * Returns the stored size of the evicted record.
+         */
+        std::size_t evictRecord(std::size_t offset);
+
+        void visitRecords(const LogRecordVisitor& visitor) const;
 
-        BucketState             state_ = BucketState::FREE;
-        std::int32_t            bucketId_ = 0;
-        std::size_t             occupiedSize_ = 0;
-        std::list<LogRecord>    logs_;
+        BucketState                 state_ = BucketState::FREE;
+        std::int32_t                bucketId_ = 0;
+        std::size_t                 occupiedSize_ = 0;
+        std::size_t                 payloadSize_ = 0;
+        std::size_t                 recordCount_ = 0;
+        bool                        hasDeltaRecords_ = false;
+
+        /*
+         * Sequence numbers of records added to the bucket, evicted ones including.
+         */
+        RecordSequence              firstRecordSequence_;
+        RecordSequence              endRecordSequence_;
+
+        /*
+         * Log records one by another, each prefixed by its size.
+         */
+        std::vector<std::uint8_t>   records_;
+
+        /*
+         * The last record added to the bucket, the reference of the next delta. Kept while the bucket is filled.
+         */
+        std::vector<std::uint8_t>   lastRecord_;
+        bool                        hasLastRecord_ = false;
     };
 
+    typedef std::list<InternalBucket>::iterator BucketIterator;
+
+    /*
+     * Entry of the eviction index. It is removed lazily: records which are already removed with their
+     * buckets or evicted are skipped.
+     */
+    struct IndexedRecord {
+        IndexedRecord(RecordSequence sequence, std::size_t offset)
+            : sequence_(sequence), offset_(offset) {}
+
+        RecordSequence    sequence_;
+        std::size_t       offset_;
+    };
+
+    struct ExpiringRecord {
+        ExpiringRecord(Clock::time_point expiryTime, const IndexedRecord& record)
+            : expiryTime_(expiryTime), record_(record) {}
+
+        /*
+         * The heap of expiring records keeps the earliest one on top.
+         */
+        bool operator<(const ExpiringRecord& other) const {
+            return expiryTime_ > other.expiryTime_;
+        }
+
+        Clock::time_point    expiryTime_;
+        IndexedRecord        record_;
+    };
+
+private:
+    void eraseBucket(BucketIterator bucket);
+
+    /*
+     * Returns false if the record is already removed or evicted.
+     */
+    bool findRecord(const IndexedRecord& record, BucketIterator& bucket);
+
+    std::size_t evictRecord(BucketIterator bucket, std::size_t offset);
+
+    /*
+     * Evicts the record which is expired or of the lowest priority. Returns false if there are no records.
+     */
+    bool evictNextRecord();
+    std::size_t evictExpiredRecords();
+
+    void compactEvictionIndex();
+
 private:
-    const std::size_t maxBucketSize_;
-    const std::size_t maxBucketRecordCount_;
+    std::size_t maxBucketSize_;
+    std::size_t maxBucketRecordCount_;
 
     std::int32_t currentBucketId_ = 0;
 
@@ -122,6 +261,24 @@ private:
     std::size_t shrinkedSize_ = 0;
 
     std::list<InternalBucket> buckets_;
+
+    /*
+     * Buckets by the sequence number of their first record, to find a bucket of an indexed record.
+     */
+    std::map<RecordSequence, BucketIterator> bucketsBySequence_;
+    RecordSequence nextRecordSequence_ = 0;
+    std::size_t totalRecordCount_ = 0;
+
+    /*
+     * The eviction index: records in the order of adding per priority and the heap of expiring records.
+     */
+    std::array<std::deque<IndexedRecord>, LOG_PRIORITY_COUNT> recordsByPriority_;
+    std::vector<ExpiringRecord> expiringRecords_;
+    std::array<Clock::duration, LOG_PRIORITY_COUNT> recordTimeToLive_;
+
+    bool isDeltaEncodingEnabled_ = false;
+    std::vector<std::uint8_t> deltaBuffer_;
+
     KAA_MUTEX_DECLARE(memoryLogStorageGuard_);
     IKaaClientContext &context_;
 };
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PRIORITYLOGSTORAGE_HPP_
+#define PRIORITYLOGSTORAGE_HPP_
+
+#include <array>
+#include <cstdint>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/log/LogPriority.hpp"
+#include "kaa/log/ILogStorage.hpp"
+#include "kaa/log/ILogStorageStatus.hpp"
+#include "kaa/log/LogStorageConstants.hpp"
+
+namespace kaa {
+
+class IKaaClientContext;
+
+/**
+ * @brief Log storage which keeps a separate bucket queue (lane) per @c LogPriority.
+ *
+ * Each lane is an @c ILogStorage of its own. A record goes to the lane of its priority, so a backlog
+ * of low priority records does not delay high priority ones.
+ *
+ * The next bucket to upload is chosen by the smooth weighted round-robin across lanes which have
+ * records: a lane with the weight @c W gets @c W buckets out of every @c SUM(weights) ones, and buckets
+ * of different lanes are interleaved. The weights are 4, 2 and 1 for the high, normal and low priority
+ * respectively, and may be changed via @link setLaneWeight() @endlink.
+ */
+class PriorityLogStorage : public ILogStorage, public ILogStorageStatus {
+public:
+    typedef std::array<ILogStoragePtr, LOG_PRIORITY_COUNT> LaneStorages;
+
+    /**
+     * @brief Creates the storage with @c MemoryLogStorage lanes.
+     *
+     * @param[in] bucketSize           The bucket size in bytes.
+     * @param[in] bucketRecordCount    The number of records in a bucket.
+     */
+    PriorityLogStorage(IKaaClientContext &context,
+                       std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    /**
+     * @brief Creates the storage with user-defined lanes.
+     *
+     * @param[in] lanes    Lane storages indexed by @c LogPriority.
+     *
+     * @throw KaaException    Any of lanes is null or lanes are not distinct.
+     */
+    PriorityLogStorage(IKaaClientContext &context, const LaneStorages& lanes);
+
+    virtual BucketInfo addLogRecord(LogRecord&& record);
+    virtual ILogStorageStatus& getStatus() { return *this; }
+
+    virtual LogBucket getNextBucket();
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor);
+    virtual void removeBucket(std::int32_t bucketId);
+    virtual void rollbackBucket(std::int32_t bucketId);
+
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount);
+
+    virtual std::size_t getConsumedVolume();
+    virtual std::size_t getRecordsCount();
+
+    /**
+     * @brief Sets the weight of a lane in the bucket selection.
+     *
+     * @throw KaaException    The weight is zero.
+     */
+    void setLaneWeight(LogPriority priority, std::size_t weight);
+
+    ILogStorageStatus& getLaneStatus(LogPriority priority) {
+        return lanes_[static_cast<std::size_t>(priority)]->getStatus();
+    }
+
+public:
+    static const std::size_t DEFAULT_HIGH_PRIORITY_WEIGHT   = 4;
+    static const std::size_t DEFAULT_NORMAL_PRIORITY_WEIGHT = 2;
+    static const std::size_t DEFAULT_LOW_PRIORITY_WEIGHT    = 1;
+
+private:
+    /*
+     * Ids of lane buckets are mapped to the ids of this storage, so they stay unique across lanes.
+     */
+    static std::int32_t toBucketId(std::size_t lane, std::int32_t laneBucketId) {
+        return laneBucketId * LOG_PRIORITY_COUNT + lane;
+    }
+
+    static std::size_t toLane(std::int32_t bucketId) {
+        return bucketId % LOG_PRIORITY_COUNT;
+    }
+
+    static std::int32_t toLaneBucketId(std::int32_t bucketId) {
+        return bucketId / LOG_PRIORITY_COUNT;
+    }
+
+    /*
+     * Calls the getter on lanes in the weighted round-robin order until it returns a non-empty bucket.
+     */
+    template<class Getter>
+    BucketInfo getNextLaneBucket(const Getter& getter);
+
+private:
+    LaneStorages lanes_;
+
+    std::array<std::size_t, LOG_PRIORITY_COUNT> weights_;
+    std::array<std::int64_t, LOG_PRIORITY_COUNT> currentWeights_;
+
+    KAA_MUTEX_DECLARE(laneSelectionGuard_);
+
+    IKaaClientContext &context_;
+};
+
+} /* namespace kaa */
+
+#endif /* PRIORITYLOGSTORAGE_HPP_ */
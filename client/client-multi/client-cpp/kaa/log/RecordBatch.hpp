@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RECORDBATCH_HPP_
+#define RECORDBATCH_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+#include "kaa/utils/KaaFuture.hpp"
+
+namespace kaa {
+
+namespace detail {
+
+/*
+ * The state shared by copies of a batch and the log collector.
+ *
+ * The pending count holds one extra unit while the batch is open, so it can't drop to zero
+ * before the batch is closed, however fast the records are delivered.
+ */
+class RecordBatchState {
+public:
+    /*
+     * @return @c false if the batch is closed, the record isn't counted then.
+     */
+    bool addRecord();
+
+    void onRecordsDelivered(std::size_t recordCount);
+    void onRecordFailed(std::exception_ptr exception);
+
+    KaaFuture<void> close();
+
+    std::size_t getRecordCount() const { return recordCount_; }
+    std::size_t getPendingRecordCount() const;
+
+private:
+    void complete(std::exception_ptr exception = nullptr);
+
+private:
+    std::atomic<std::size_t>    recordCount_{0};
+    std::atomic<std::size_t>    pendingCount_{1};
+    std::atomic<bool>           isClosed_{false};
+    std::atomic<bool>           isCompleted_{false};
+    KaaPromise<void>            promise_;
+};
+
+typedef std::shared_ptr<RecordBatchState> RecordBatchStatePtr;
+
+} /* namespace detail */
+
+/**
+ * @brief Tracks the delivery of a group of log records with a single future.
+ *
+ * Records are added to a batch by @link ILogCollector::addLogRecord(RecordBatch&, const KaaUserLogRecord&) @endlink,
+ * no @c RecordFuture is created for them. The batch keeps one counter of undelivered records, which is
+ * decremented once per delivered log bucket by the number of batch records in it, so the future returned
+ * by @link whenAll() @endlink is satisfied by the delivery of the last bucket holding records of the batch.
+ *
+ * Copies of a batch share the state.
+ */
+class RecordBatch {
+public:
+    RecordBatch()
+        : state_(std::make_shared<detail::RecordBatchState>()) {}
+
+    /**
+     * @brief Closes the batch, records can't be added to it afterwards.
+     *
+     * @return The future satisfied once all records of the batch are delivered. It fails with the error
+     * of the first record of the batch which can't be serialized or added to the log storage.
+     * Repeated calls return futures sharing the result.
+     */
+    KaaFuture<void> whenAll() { return state_->close(); }
+
+    /**
+     * @return The number of records added to the batch.
+     */
+    std::size_t getRecordCount() const { return state_->getRecordCount(); }
+
+    /**
+     * @return The number of records of the batch which are neither delivered nor failed.
+     */
+    std::size_t getPendingRecordCount() const { return state_->getPendingRecordCount(); }
+
+private:
+    friend class LogCollector;
+
+    const detail::RecordBatchStatePtr& getState() const { return state_; }
+
+private:
+    detail::RecordBatchStatePtr state_;
+};
+
+} /* namespace kaa */
+
+#endif /* RECORDBATCH_HPP_ */
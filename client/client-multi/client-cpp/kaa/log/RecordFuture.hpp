@@ -17,16 +17,16 @@
 #ifndef RECORDFUTURE_HPP_
 #define RECORDFUTURE_HPP_
 
-#include <future>
 #include <atomic>
 
 #include "kaa/log/RecordInfo.hpp"
+#include "kaa/utils/KaaFuture.hpp"
 
 namespace kaa {
 
 class RecordFuture {
 public:
-    RecordFuture(std::future<RecordInfo>&& future)
+    RecordFuture(KaaFuture<RecordInfo>&& future)
         : future_(std::move(future)), recordFutureId_(recordFutureCounter++) {}
 
     RecordFuture(RecordFuture&& recordFuture)
@@ -70,12 +70,35 @@ public:
      * END: Partial future interface.
      */
 
+    /**
+     * @brief Calls the continuation with the record's future once the record is delivered or failed.
+     *
+     * @see KaaFuture::then()
+     */
+    template<typename F>
+    auto then(F&& continuation) -> decltype(std::declval<KaaFuture<RecordInfo>&>().then(std::forward<F>(continuation))) {
+        return future_.then(std::forward<F>(continuation));
+    }
+
+    template<typename F>
+    auto then(IThreadPool& executor, F&& continuation)
+        -> decltype(std::declval<KaaFuture<RecordInfo>&>().then(executor, std::forward<F>(continuation))) {
+        return future_.then(executor, std::forward<F>(continuation));
+    }
+
+    /**
+     * @return The future sharing the result with this one, e.g. to be combined with other Kaa operations.
+     */
+    KaaFuture<RecordInfo> getFuture() const {
+        return future_;
+    }
+
 private:
     typedef std::atomic_size_t RecordFutureCounterType;
     static RecordFutureCounterType recordFutureCounter;
 
 private:
-    std::future<RecordInfo> future_;
+    KaaFuture<RecordInfo> future_;
     std::size_t recordFutureId_;
 };
 
@@ -19,8 +19,11 @@
 
 #include <memory>
 #include <list>
+#include <chrono>
+#include <vector>
 #include <cstdint>
 #include <string>
+#include <map>
 #include <unordered_map>
 
 #include <sqlite3.h>
@@ -47,23 +50,87 @@ enum SQLiteOptimizationOptions
     SQLITE_MEMORY_TEMP_STORE   = 0x4,
     SQLITE_COUNT_CHANGES_OFF   = 0x8,
 
+    SQLITE_WAL_JOURNAL_MODE    = 0x10,
+    SQLITE_SYNCHRONOUS_NORMAL  = 0x20,
+    SQLITE_SYNCHRONOUS_FULL    = 0x40,
+    SQLITE_MEMORY_MAPPED_IO    = 0x80,
+
     SQLITE_ALL_OPTIMIZATIONS   = SQLITE_SYNCHRONOUS_OFF |
                                  SQLITE_MEMORY_JOURNAL_MODE |
                                  SQLITE_MEMORY_TEMP_STORE |
                                  SQLITE_COUNT_CHANGES_OFF
 };
 
+/**
+ * @brief Coherent sets of @c SQLiteOptimizationOptions, which may be passed as an optimization mask.
+ *
+ * If conflicting options are combined, the WAL journal mode takes precedence over the in-memory one
+ * and the strongest synchronous mode is used.
+ */
+enum SQLiteDurabilityProfile
+{
+    /**
+     * No journal on disk and no syncs: the fastest, but the database may be corrupted on a power loss.
+     */
+    SQLITE_FAST_PROFILE        = SQLITE_ALL_OPTIMIZATIONS,
+
+    /**
+     * WAL journal with synchronous=NORMAL: the database survives a power loss, but the last
+     * committed transactions may be rolled back.
+     */
+    SQLITE_BALANCED_PROFILE    = SQLITE_WAL_JOURNAL_MODE |
+                                 SQLITE_SYNCHRONOUS_NORMAL |
+                                 SQLITE_MEMORY_TEMP_STORE |
+                                 SQLITE_MEMORY_MAPPED_IO,
+
+    /**
+     * WAL journal with synchronous=FULL: every committed transaction survives a power loss.
+     */
+    SQLITE_DURABLE_PROFILE     = SQLITE_WAL_JOURNAL_MODE |
+                                 SQLITE_SYNCHRONOUS_FULL
+};
+
+/**
+ * @brief SQLite-based log storage.
+ *
+ * Log records may be committed in groups: instead of writing every record in its own
+ * transaction, records are staged in memory and written in a single transaction once
+ * @c groupCommitRecordCount records are staged or the oldest staged record is older than
+ * @c groupCommitTimeoutMs milliseconds. Staged records are also written before a log bucket
+ * is taken for the upload and on the storage destruction.
+ *
+ * @note Staged records are counted by @link getRecordsCount() @endlink and
+ * @link getConsumedVolume() @endlink, but they are not in the database yet. In case of a crash
+ * or a power loss up to @c groupCommitRecordCount records (or records added within the last
+ * @c groupCommitTimeoutMs milliseconds) are lost. If a group commit fails, the transaction is
+ * rolled back and the staged records are kept to be written at the next attempt.
+ *
+ * By default, @c groupCommitRecordCount is 1, i.e. each record is committed immediately.
+ *
+ * Records of the buckets taken for the upload are kept in an LRU cache of @link setBucketCacheSize() @endlink
+ * bytes until the buckets are removed. A rolled back bucket which is still cached isn't marked as free in
+ * the database and is taken again right from the cache, so retried uploads don't touch the database.
+ * Buckets are marked as free on the database opening anyway.
+ *
+ * The database uses the incremental auto vacuum: pages freed by removed buckets are returned to the
+ * file system in steps of @c KAA_SQLITE_INCREMENTAL_VACUUM_PAGES pages, taken whenever a bucket is removed
+ * and no other bucket is out for the upload. A database created without it is rebuilt once on opening.
+ */
 class SQLiteDBLogStorage : public ILogStorage, public ILogStorageStatus {
 public:
     SQLiteDBLogStorage(IKaaClientContext &context,
                        std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
-                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                       std::size_t groupCommitRecordCount = LogStorageConstants::DEFAULT_GROUP_COMMIT_RECORD_COUNT,
+                       std::size_t groupCommitTimeoutMs = LogStorageConstants::DEFAULT_GROUP_COMMIT_TIMEOUT_MS);
 
     SQLiteDBLogStorage(IKaaClientContext &context,
                        const std::string& dbName,
                        int optimizationMask = (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
                        std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
-                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                       std::size_t groupCommitRecordCount = LogStorageConstants::DEFAULT_GROUP_COMMIT_RECORD_COUNT,
+                       std::size_t groupCommitTimeoutMs = LogStorageConstants::DEFAULT_GROUP_COMMIT_TIMEOUT_MS);
 
     ~SQLiteDBLogStorage();
 
@@ -71,9 +138,25 @@ public:
     virtual ILogStorageStatus& getStatus() { return *this; }
 
     virtual LogBucket getNextBucket();
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor);
     virtual void removeBucket(std::int32_t bucketId);
     virtual void rollbackBucket(std::int32_t bucketId);
 
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount);
+
+    /**
+     * @brief Sets the maximum size of the records of the cached buckets, zero disables the cache.
+     */
+    void setBucketCacheSize(std::size_t size);
+
+    /**
+     * @brief Sets the max size in bytes of the database pages in use, zero (the default) disables the quota.
+     *
+     * The quota is checked whenever a new bucket is started. The oldest buckets not taken for the upload
+     * are dropped whole until the database fits it, then the freed pages are returned to the file system.
+     */
+    void setDiskQuota(std::size_t size);
+
     virtual std::size_t getConsumedVolume();
     virtual std::size_t getRecordsCount();
 
@@ -85,6 +168,15 @@ private:
 
     void initDBTables();
     void applyDBOptimization(int mask);
+    void applyDBOption(const char *option);
+
+    void initAutoVacuum();
+    std::int64_t getPragmaValue(const char *pragma);
+    std::size_t getUsedDiskSpace();
+    void vacuum(const char *vacuumQuery);
+
+    std::size_t deleteBucket(std::int32_t bucketId);
+    void enforceDiskQuota();
 
     bool checkBucketOverflow(const LogRecord& record) {
         return (currentBucketSize_ + record.getSize() > maxBucketSize_) ||
@@ -93,9 +185,26 @@ private:
 
     void addNextBucket();
     void markBucketAsInUse(std::int32_t id);
+    void markBucketAsFree(std::int32_t id);
     void markBucketsAsFree();
     bool retrieveLastBucketInfo();
 
+    sqlite3_stmt *getCachedStatement(sqlite3_stmt *&stmt, const char *sql);
+    void finalizeCachedStatements();
+
+    bool isGroupCommitNeeded() const;
+    void commitStagedRecords();
+    void commitStagedRecordsIfNeeded();
+    void insertStagedRecord(std::int32_t bucketId, LogRecord& record);
+    void updateBucketInfo(std::int32_t bucketId, std::size_t recordCount, std::size_t sizeInBytes);
+
+    BucketInfo visitCachedBucket(const LogRecordVisitor& visitor);
+    void cacheBucket(std::int32_t bucketId, std::size_t sizeInBytes,
+                     std::vector<std::uint8_t>&& data, std::vector<std::size_t>&& recordSizes);
+    void touchCachedBucket(std::int32_t bucketId);
+    void evictCachedBuckets(std::size_t sizeToFit);
+    void removeCachedBucket(std::int32_t bucketId);
+
     void retrieveConsumedSizeAndVolume();
     bool truncateIfBucketSizeIncompatible();
 
@@ -118,13 +227,29 @@ private:
         std::size_t sizeInLogs_ = 0;
     };
 
+    struct StagedRecord {
+        StagedRecord(std::int32_t bucketId, LogRecord&& record)
+            : bucketId_(bucketId), record_(std::move(record)) {}
+
+        std::int32_t bucketId_;
+        LogRecord record_;
+    };
+
+    struct CachedBucket {
+        std::size_t sizeInBytes_ = 0;
+        std::vector<std::uint8_t> data_;        /* Records back to back */
+        std::vector<std::size_t> recordSizes_;
+        bool isRolledBack_ = false;
+        std::list<std::int32_t>::iterator lruPosition_;
+    };
+
 private:
 
     const std::string dbName_;
     sqlite3 *db_ = nullptr;
 
-    const std::size_t maxBucketSize_;
-    const std::size_t maxBucketRecordCount_;
+    std::size_t maxBucketSize_;
+    std::size_t maxBucketRecordCount_;
 
     std::int32_t currentBucketId_ = 0;
     std::size_t currentBucketSize_ = 0;
@@ -136,6 +261,22 @@ private:
     std::size_t consumedMemory_ = 0;
     std::unordered_map<std::int32_t/*Bucket id*/, InnerBucketInfo> consumedMemoryStorage_;
 
+    const std::size_t groupCommitRecordCount_;
+    const std::chrono::milliseconds groupCommitTimeout_;
+
+    std::vector<StagedRecord> stagedRecords_;
+    std::chrono::steady_clock::time_point oldestStagedRecordTime_;
+
+    std::size_t bucketCacheSize_ = LogStorageConstants::DEFAULT_BUCKET_CACHE_SIZE;
+    std::size_t cachedBucketsSize_ = 0;
+    std::map<std::int32_t/*Bucket id*/, CachedBucket> cachedBuckets_;
+    std::list<std::int32_t> cachedBucketsLru_;     /* The most recently used first */
+
+    std::size_t diskQuota_ = 0;
+
+    sqlite3_stmt *insertLogRecordStmt_ = nullptr;
+    sqlite3_stmt *updateBucketInfoStmt_ = nullptr;
+
     KAA_MUTEX_DECLARE(sqliteLogStorageGuard_);
 
     IKaaClientContext &context_;
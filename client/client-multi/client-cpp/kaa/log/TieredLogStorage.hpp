@@ -0,0 +1,148 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TIEREDLOGSTORAGE_HPP_
+#define TIEREDLOGSTORAGE_HPP_
+
+#include <cstdint>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/log/ILogStorage.hpp"
+#include "kaa/log/ILogStorageStatus.hpp"
+#include "kaa/log/LogStorageConstants.hpp"
+
+namespace kaa {
+
+class IKaaClientContext;
+
+/**
+ * @brief Log storage which keeps records in memory and spills them to a persistent storage under a backlog.
+ *
+ * Records are added to the memory tier while the memory it occupies is below the watermark, so steady-state
+ * logging runs at memory speed. Once the watermark is reached, e.g. while the server is unreachable, next
+ * records go to the disk tier (e.g. @c SQLiteDBLogStorage) instead of being dropped, until a bucket of the disk
+ * tier is delivered and no other records are left there. Then records go to the memory tier again.
+ *
+ * Records already in a tier stay there, so buckets reported by @link addLogRecord() @endlink keep their ids.
+ * Buckets of the memory tier are uploaded first: while records spill, they are older than the ones on disk.
+ *
+ * The memory pressure (see @link releaseMemory() @endlink) makes records spill as well, nothing is dropped.
+ * Spilling ends the same way.
+ */
+class TieredLogStorage : public ILogStorage, public ILogStorageStatus {
+public:
+    /**
+     * @brief Creates the storage with the size-unlimited @c MemoryLogStorage memory tier.
+     *
+     * @param[in] diskStorage          The disk tier.
+     * @param[in] memoryWatermark      The memory (in bytes) the memory tier may occupy before records spill.
+     * @param[in] bucketSize           The bucket size in bytes of the memory tier.
+     * @param[in] bucketRecordCount    The number of records in a bucket of the memory tier.
+     *
+     * @throw KaaException    The disk tier is null or the watermark is zero.
+     */
+    TieredLogStorage(IKaaClientContext &context,
+                     ILogStoragePtr diskStorage,
+                     std::size_t memoryWatermark,
+                     std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                     std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    /**
+     * @brief Creates the storage with user-defined tiers.
+     *
+     * @param[in] memoryStorage      The memory tier, its @link ILogStorage::getMemoryUsage() @endlink is
+     *                               compared with the watermark.
+     * @param[in] diskStorage        The disk tier.
+     * @param[in] memoryWatermark    The memory (in bytes) the memory tier may occupy before records spill.
+     *
+     * @throw KaaException    Any of tiers is null, tiers are the same or the watermark is zero.
+     */
+    TieredLogStorage(IKaaClientContext &context,
+                     ILogStoragePtr memoryStorage,
+                     ILogStoragePtr diskStorage,
+                     std::size_t memoryWatermark);
+
+    virtual BucketInfo addLogRecord(LogRecord&& record);
+    virtual ILogStorageStatus& getStatus() { return *this; }
+
+    virtual LogBucket getNextBucket();
+    virtual BucketInfo visitNextBucket(const LogRecordVisitor& visitor);
+    virtual void removeBucket(std::int32_t bucketId);
+    virtual void rollbackBucket(std::int32_t bucketId);
+
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount);
+
+    virtual std::size_t getMemoryUsage();
+    virtual bool releaseMemory(std::size_t allowedVolume);
+
+    virtual std::size_t getConsumedVolume();
+    virtual std::size_t getRecordsCount();
+
+    /**
+     * @return @c true if new records go to the disk tier.
+     */
+    bool isSpilling();
+
+    ILogStorageStatus& getMemoryTierStatus() {
+        return tiers_[MEMORY_TIER]->getStatus();
+    }
+
+    ILogStorageStatus& getDiskTierStatus() {
+        return tiers_[DISK_TIER]->getStatus();
+    }
+
+private:
+    static const std::size_t MEMORY_TIER = 0;
+    static const std::size_t DISK_TIER   = 1;
+    static const std::size_t TIER_COUNT  = 2;
+
+    /*
+     * Ids of tier buckets are mapped to the ids of this storage, so they stay unique across tiers.
+     */
+    static std::int32_t toBucketId(std::size_t tier, std::int32_t tierBucketId) {
+        return tierBucketId * TIER_COUNT + tier;
+    }
+
+    static std::size_t toTier(std::int32_t bucketId) {
+        return bucketId % TIER_COUNT;
+    }
+
+    static std::int32_t toTierBucketId(std::int32_t bucketId) {
+        return bucketId / TIER_COUNT;
+    }
+
+    void checkTiers();
+
+    /*
+     * Calls the getter on the memory tier and then on the disk tier until it returns a non-empty bucket.
+     */
+    template<class Getter>
+    BucketInfo getNextTierBucket(const Getter& getter);
+
+private:
+    ILogStoragePtr tiers_[TIER_COUNT];
+
+    const std::size_t memoryWatermark_;
+    bool isSpilling_ = false;
+
+    KAA_MUTEX_DECLARE(spillGuard_);
+
+    IKaaClientContext &context_;
+};
+
+} /* namespace kaa */
+
+#endif /* TIEREDLOGSTORAGE_HPP_ */
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ADAPTIVEBUCKETSIZELOGUPLOADSTRATEGY_HPP_
+#define ADAPTIVEBUCKETSIZELOGUPLOADSTRATEGY_HPP_
+
+#include <cstdlib>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/logging/Log.hpp"
+#include "kaa/log/ILogStorage.hpp"
+#include "kaa/log/LogStorageConstants.hpp"
+#include "kaa/log/DefaultLogUploadStrategy.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Log upload strategy which tunes the size of log buckets at runtime.
+ *
+ * The strategy measures the delivery time of each log bucket and keeps a moving average of the delivery
+ * failure rate. A bucket is halved if its delivery takes longer than the target delivery time or fails
+ * (the delivery timeout is also treated as a failure). A bucket grows by half if it is delivered faster than
+ * a half of the target delivery time and the failure rate is low. The bucket size is kept within
+ * [@c minBucketSize, @c maxBucketSize] and the max number of records in a bucket is scaled proportionally.
+ *
+ * New limits are passed to the log storage via @link ILogStorage::setBucketLimits() @endlink, so the storage
+ * should be created with the same @c maxBucketSize and @c maxBucketRecordCount limits.
+ *
+ * Upload decisions are made by @c DefaultLogUploadStrategy.
+ */
+class AdaptiveBucketSizeLogUploadStrategy : public DefaultLogUploadStrategy {
+public:
+    AdaptiveBucketSizeLogUploadStrategy(ILogStoragePtr storage, IKaaClientContext &context,
+                                        std::size_t maxBucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                        std::size_t maxBucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                        std::size_t minBucketSize = DEFAULT_MIN_BUCKET_SIZE)
+        : DefaultLogUploadStrategy(context), storage_(storage),
+          minBucketSize_(minBucketSize), maxBucketSize_(maxBucketSize), maxBucketRecordCount_(maxBucketRecordCount),
+          bucketSize_(maxBucketSize), bucketRecordCount_(maxBucketRecordCount)
+    {
+        if (!storage_) {
+            throw KaaException("Log storage is null");
+        }
+
+        if (!minBucketSize_ || minBucketSize_ > maxBucketSize_ || !maxBucketRecordCount_) {
+            throw KaaException("Invalid bucket limits");
+        }
+    }
+
+    virtual void onSuccess(const BucketInfo& bucketInfo, std::size_t deliveryTimeMs) override
+    {
+        KAA_MUTEX_LOCKING("adaptiveGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, adaptiveGuard_);
+        KAA_MUTEX_LOCKED("adaptiveGuard_");
+
+        failureRate_ *= 1.0 - FAILURE_RATE_SMOOTHING_FACTOR;
+
+        auto targetDeliveryTimeMs = getTargetDeliveryTime();
+        if (deliveryTimeMs > targetDeliveryTimeMs) {
+            KAA_LOG_INFO(boost::format("Log bucket (id %1%) delivered in %2% ms, target %3% ms")
+                                        % bucketInfo.getBucketId() % deliveryTimeMs % targetDeliveryTimeMs);
+            setBucketSize(bucketSize_ / 2);
+        } else if (deliveryTimeMs < targetDeliveryTimeMs / 2 && failureRate_ < MAX_FAILURE_RATE_TO_GROW) {
+            setBucketSize(bucketSize_ + bucketSize_ / 2);
+        }
+    }
+
+    virtual void onTimeout(ILogFailoverCommand& controller) override
+    {
+        DefaultLogUploadStrategy::onTimeout(controller);
+        onDeliveryFailure();
+    }
+
+    virtual void onFailure(ILogFailoverCommand& controller, LogDeliveryErrorCode code) override
+    {
+        DefaultLogUploadStrategy::onFailure(controller, code);
+        onDeliveryFailure();
+    }
+
+    /**
+     * @brief Sets the target delivery time of a log bucket.
+     *
+     * @param[in] timeMs    Time in milliseconds. If zero, a quarter of the upload timeout is used.
+     */
+    void setTargetDeliveryTime(std::size_t timeMs) { targetDeliveryTimeMs_ = timeMs; }
+
+    std::size_t getTargetDeliveryTime() const
+    {
+        return targetDeliveryTimeMs_ ? targetDeliveryTimeMs_ : uploadTimeout_ * 1000 / 4;
+    }
+
+    std::size_t getBucketSize()
+    {
+        KAA_MUTEX_LOCKING("adaptiveGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, adaptiveGuard_);
+        KAA_MUTEX_LOCKED("adaptiveGuard_");
+        return bucketSize_;
+    }
+
+    std::size_t getBucketRecordCount()
+    {
+        KAA_MUTEX_LOCKING("adaptiveGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, adaptiveGuard_);
+        KAA_MUTEX_LOCKED("adaptiveGuard_");
+        return bucketRecordCount_;
+    }
+
+    double getFailureRate()
+    {
+        KAA_MUTEX_LOCKING("adaptiveGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, adaptiveGuard_);
+        KAA_MUTEX_LOCKED("adaptiveGuard_");
+        return failureRate_;
+    }
+
+public:
+    static const std::size_t DEFAULT_MIN_BUCKET_SIZE = 1024; /*!< The default value (in bytes) for the min size
+                                                                  of a log bucket. */
+
+    static constexpr double FAILURE_RATE_SMOOTHING_FACTOR = 0.2;
+
+    static constexpr double MAX_FAILURE_RATE_TO_GROW = 0.25; /*!< Buckets do not grow while the failure rate
+                                                                  is greater. */
+
+private:
+    void onDeliveryFailure()
+    {
+        KAA_MUTEX_LOCKING("adaptiveGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, adaptiveGuard_);
+        KAA_MUTEX_LOCKED("adaptiveGuard_");
+
+        failureRate_ = failureRate_ * (1.0 - FAILURE_RATE_SMOOTHING_FACTOR) + FAILURE_RATE_SMOOTHING_FACTOR;
+        setBucketSize(bucketSize_ / 2);
+    }
+
+    void setBucketSize(std::size_t size)
+    {
+        if (size < minBucketSize_) {
+            size = minBucketSize_;
+        } else if (size > maxBucketSize_) {
+            size = maxBucketSize_;
+        }
+
+        if (size == bucketSize_) {
+            return;
+        }
+
+        std::size_t recordCount = (std::size_t)((double)maxBucketRecordCount_ * size / maxBucketSize_);
+        if (!recordCount) {
+            recordCount = 1;
+        }
+
+        if (!storage_->setBucketLimits(size, recordCount)) {
+            KAA_LOG_WARN("Log storage does not support changing bucket limits");
+            return;
+        }
+
+        KAA_LOG_INFO(boost::format("Log bucket limits changed: size %1% -> %2% bytes, record count %3% -> %4%")
+                                        % bucketSize_ % size % bucketRecordCount_ % recordCount);
+
+        bucketSize_ = size;
+        bucketRecordCount_ = recordCount;
+    }
+
+private:
+    ILogStoragePtr storage_;
+
+    const std::size_t minBucketSize_;
+    const std::size_t maxBucketSize_;
+    const std::size_t maxBucketRecordCount_;
+
+    std::size_t bucketSize_;
+    std::size_t bucketRecordCount_;
+
+    std::size_t targetDeliveryTimeMs_ = 0;
+
+    double failureRate_ = 0.0;
+
+    KAA_MUTEX_DECLARE(adaptiveGuard_);
+};
+
+}
+
+#endif /* ADAPTIVEBUCKETSIZELOGUPLOADSTRATEGY_HPP_ */
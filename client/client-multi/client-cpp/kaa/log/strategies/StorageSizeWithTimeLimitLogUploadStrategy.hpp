@@ -51,6 +51,8 @@ public:
         return LogUploadStrategyDecision::NOOP;
     }
 
+    virtual bool isTimeDependent() override { return true; }
+
 private:
     typedef std::chrono::system_clock Clock;
     std::chrono::time_point<Clock> lastUploadTime_;
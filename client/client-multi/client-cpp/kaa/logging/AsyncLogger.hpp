@@ -0,0 +1,104 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ASYNCLOGGER_HPP_
+#define ASYNCLOGGER_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <condition_variable>
+
+#include "kaa/logging/ILogger.hpp"
+#include "kaa/utils/MpscQueue.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Logger which passes messages to another logger on its own thread.
+ *
+ * Logging threads (e.g. the I/O thread of a channel) only put a message into a lock-free queue,
+ * writing it to the console or a file is done by the background thread. Messages are written
+ * in the order they are logged.
+ *
+ * If the queue is full, messages below @c LogLevel::KAA_WARNING are dropped, see @c getDroppedCount().
+ * Warnings and errors are never dropped.
+ */
+class AsyncLogger : public ILogger {
+public:
+    static const std::size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
+    /**
+     * @param[in] logger           The logger messages are written to.
+     * @param[in] queueCapacity    The max number of queued messages.
+     *
+     * @throw KaaException The logger is null or the capacity is zero.
+     */
+    explicit AsyncLogger(LoggerPtr logger, std::size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+    /**
+     * @brief Writes queued messages and stops the background thread.
+     */
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    virtual void log(LogLevel level, const char *message) const;
+
+    virtual bool isEnabled(LogLevel level) const { return logger_->isEnabled(level); }
+
+    /**
+     * @brief Waits until messages logged before the call are written.
+     */
+    void flush() const;
+
+    /**
+     * @return The number of messages dropped because the queue was full.
+     */
+    std::size_t getDroppedCount() const { return droppedCount_; }
+
+private:
+    struct Message {
+        Message(LogLevel level, const char *text) : level_(level), text_(text) {}
+
+        LogLevel       level_;
+        std::string    text_;
+    };
+
+    void run();
+
+private:
+    LoggerPtr            logger_;
+    const std::size_t    queueCapacity_;
+
+    mutable MpscQueue<Message>          queue_;
+    mutable std::atomic<std::size_t>    pendingCount_;
+    mutable std::atomic<std::size_t>    droppedCount_;
+
+    mutable std::mutex                 guard_;
+    mutable std::condition_variable    onMessage_;
+    mutable std::condition_variable    onWritten_;
+    bool                               isStopped_ = false;
+
+    std::thread    thread_;
+};
+
+}  // namespace kaa
+
+#endif /* ASYNCLOGGER_HPP_ */
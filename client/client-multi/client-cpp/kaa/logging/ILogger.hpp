@@ -17,6 +17,7 @@
 #ifndef ILOGGER_HPP_
 #define ILOGGER_HPP_
 
+#include <memory>
 #include <string>
 
 namespace kaa {
@@ -35,6 +36,12 @@ public:
     virtual ~ILogger() {}
 
     virtual void log(LogLevel level, const char *message) const = 0;
+
+    /**
+     * @brief Checks whether messages of the level are logged. Messages of disabled levels
+     * aren't even formatted by the @c KAA_LOG_* macros.
+     */
+    virtual bool isEnabled(LogLevel level) const { return true; }
 };
 
 typedef std::shared_ptr<ILogger> LoggerPtr;
@@ -43,40 +43,51 @@ void kaa_log_message(const ILogger & logger, LogLevel level, const char *message
 void kaa_log_message(const ILogger & logger, LogLevel level, const std::string &message, const char *file, size_t lineno);
 void kaa_log_message(const ILogger & logger, LogLevel level, const boost::format& message, const char *file, size_t lineno);
 
+/*
+ * The message is evaluated only if the level is enabled by the logger at runtime,
+ * so expensive arguments, e.g. LoggingUtils::toString() dumps, cost nothing otherwise.
+ */
+#define KAA_LOG_IF_ENABLED(level, message) \
+    do { \
+        if (context_.getLogger().isEnabled(level)) { \
+            kaa_log_message(context_.getLogger(), level, (message), __LOGFILE, __LINE__); \
+        } \
+    } while (false);
+
 #endif
 
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_FINE_TRACE
-    #define KAA_LOG_FTRACE(message) kaa_log_message(context_.getLogger(), LogLevel::KAA_TRACE,      (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_FTRACE(message) KAA_LOG_IF_ENABLED(LogLevel::KAA_TRACE, message)
 #else
     #define KAA_LOG_FTRACE(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_TRACE
-    #define KAA_LOG_TRACE(message)  kaa_log_message(context_.getLogger(), LogLevel::KAA_TRACE,      (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_TRACE(message)  KAA_LOG_IF_ENABLED(LogLevel::KAA_TRACE, message)
 #else
     #define KAA_LOG_TRACE(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_DEBUG
-    #define KAA_LOG_DEBUG(message)  kaa_log_message(context_.getLogger(), LogLevel::KAA_DEBUG,      (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_DEBUG(message)  KAA_LOG_IF_ENABLED(LogLevel::KAA_DEBUG, message)
 #else
     #define KAA_LOG_DEBUG(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_INFO
-    #define KAA_LOG_INFO(message)   kaa_log_message(context_.getLogger(), LogLevel::KAA_INFO,       (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_INFO(message)   KAA_LOG_IF_ENABLED(LogLevel::KAA_INFO, message)
 #else
     #define KAA_LOG_INFO(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_WARNING
-    #define KAA_LOG_WARN(message)   kaa_log_message(context_.getLogger(), LogLevel::KAA_WARNING,    (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_WARN(message)   KAA_LOG_IF_ENABLED(LogLevel::KAA_WARNING, message)
 #else
     #define KAA_LOG_WARN(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_ERROR
-    #define KAA_LOG_ERROR(message)  kaa_log_message(context_.getLogger(), LogLevel::KAA_ERROR,      (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_ERROR(message)  KAA_LOG_IF_ENABLED(LogLevel::KAA_ERROR, message)
 #else
     #define KAA_LOG_ERROR(message)
 #endif
 #if KAA_LOG_LEVEL >= KAA_LOG_LEVEL_FATAL
-    #define KAA_LOG_FATAL(message)  kaa_log_message(context_.getLogger(), LogLevel::KAA_FATAL,      (message), __LOGFILE, __LINE__);
+    #define KAA_LOG_FATAL(message)  KAA_LOG_IF_ENABLED(LogLevel::KAA_FATAL, message)
 #else
     #define KAA_LOG_FATAL(message)
 #endif
@@ -28,6 +28,7 @@ namespace kaa {
  * Forward declaration.
  */
 class INotificationListener;
+class IRawNotificationListener;
 class INotificationTopicListListener;
 
 /**
@@ -111,6 +112,51 @@ public:
      */
     virtual void removeNotificationListener(std::int64_t topicId, INotificationListener& listener) = 0;
 
+    /**
+     * @brief Adds the listener which receives Avro-encoded notifications on all available topics.
+     *
+     * Raw listeners are notified before typed ones. The notification is decoded at most once per
+     * dispatch and only if a typed listener exists or a raw listener accesses its fields.
+     *
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void addRawNotificationListener(IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Adds the listener which receives Avro-encoded notifications on the specified topic.
+     *
+     * @param[in] topicId     The id of the topic (either mandatory or optional).
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @throw UnavailableTopicException Throws if the unknown topic id is provided.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void addRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Removes the listener which receives Avro-encoded notifications on all available topics.
+     *
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void removeRawNotificationListener(IRawNotificationListener& listener) = 0;
+
+    /**
+     * @brief Removes the listener which receives Avro-encoded notifications on the specified topic.
+     *
+     * @param[in] topicId     The id of topic (either mandatory or optional).
+     * @param[in] listener    The listener which receives notifications.
+     *
+     * @throw UnavailableTopicException Throws if the unknown topic id is provided.
+     *
+     * @see IRawNotificationListener
+     */
+    virtual void removeRawNotificationListener(std::int64_t topicId, IRawNotificationListener& listener) = 0;
+
     /**
      * @brief Subscribes to the specified optional topic to receive notifications on that topic.
      *
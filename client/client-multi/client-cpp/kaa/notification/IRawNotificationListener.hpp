@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IRAWNOTIFICATIONLISTENER_HPP_
+#define IRAWNOTIFICATIONLISTENER_HPP_
+
+#include <cstdint>
+
+#include "kaa/notification/RawNotification.hpp"
+
+namespace kaa {
+
+/**
+ * @brief The listener which receives notifications on the specified topic as Avro-encoded bytes.
+ *
+ * Unlike @link INotificationListener @endlink, notifications are decoded only if the listener
+ * accesses their fields.
+ */
+class IRawNotificationListener {
+public:
+    /**
+     * @brief Callback is used when the new notification on the specified topic is received.
+     *
+     * @param[in] topicId         The id of the topic on which the notification is received.
+     * @param[in] notification    The notification, valid only during the call.
+     *
+     */
+    virtual void onRawNotification(const std::int64_t topicId, const RawNotification& notification) = 0;
+
+    virtual ~IRawNotificationListener() {}
+};
+
+} /* namespace kaa */
+
+#endif /* IRAWNOTIFICATIONLISTENER_HPP_ */
@@ -21,8 +21,11 @@
 
 #include "kaa/KaaThread.hpp"
 
+#include <deque>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <utility>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -31,6 +34,7 @@
 #include "kaa/notification/INotificationManager.hpp"
 #include "kaa/notification/NotificationTransport.hpp"
 #include "kaa/notification/INotificationListener.hpp"
+#include "kaa/notification/IRawNotificationListener.hpp"
 #include "kaa/notification/INotificationProcessor.hpp"
 #include "kaa/notification/INotificationTopicListListener.hpp"
 #include "kaa/IKaaClientContext.hpp"
@@ -54,6 +58,11 @@ public:
     virtual void removeNotificationListener(INotificationListener& listener);
     virtual void removeNotificationListener(std::int64_t topidId, INotificationListener& listener);
 
+    virtual void addRawNotificationListener(IRawNotificationListener& listener);
+    virtual void addRawNotificationListener(std::int64_t topidId, IRawNotificationListener& listener);
+    virtual void removeRawNotificationListener(IRawNotificationListener& listener);
+    virtual void removeRawNotificationListener(std::int64_t topidId, IRawNotificationListener& listener);
+
     virtual void subscribeToTopic(std::int64_t id, bool forceSync = true);
     virtual void subscribeToTopics(const std::list<std::int64_t>& idList, bool forceSync = true);
     virtual void unsubscribeFromTopic(std::int64_t id, bool forceSync = true);
@@ -65,8 +74,31 @@ public:
 
     void setTransport(std::shared_ptr<NotificationTransport> transport);
 
+    /**
+     * @return The approximate memory occupied by notifications waiting for dispatch, in bytes.
+     */
+    std::size_t getPendingNotificationsVolume() const {
+        return pendingNotificationsVolume_;
+    }
+
 private:
-    typedef std::shared_ptr<KaaNotification> KaaNotificationPtr;
+    /*
+     * The notification and the received batch it belongs to.
+     */
+    typedef std::pair<std::shared_ptr<const Notifications>, const Notification *> PendingNotification;
+
+    /*
+     * Notifications of one topic waiting for dispatch. Queues of different topics are dispatched
+     * in parallel by the callback executor, while notifications of a topic are decoded and
+     * dispatched one by one in the order they were received (sorted by sequence numbers).
+     */
+    struct TopicDispatchQueue {
+        std::deque<PendingNotification>    notifications_;
+        bool                               isDispatching_ = false;
+        KAA_MUTEX_DECLARE(queueGuard_);
+    };
+
+    typedef std::shared_ptr<TopicDispatchQueue> TopicDispatchQueuePtr;
 
 private:
     void updateSubscriptionInfo(std::int64_t id, SubscriptionCommandType type);
@@ -75,8 +107,20 @@ private:
     const Topic& findTopic(std::int64_t id);
 
     void notifyTopicUpdateSubscribers(const Topics& topics);
-    void notifyMandatoryNotificationSubscribers(std::int64_t id, KaaNotificationPtr notification);
-    bool notifyOptionalNotificationSubscribers(std::int64_t id, KaaNotificationPtr notification);
+    void enqueueNotification(const std::shared_ptr<const Notifications>& batch, const Notification& notification);
+    void scheduleDispatch(TopicDispatchQueuePtr queue);
+    void dispatchNotifications(TopicDispatchQueuePtr queue);
+    void dispatchNotification(const Notification& notification);
+
+    static std::size_t getNotificationVolume(const Notification& notification) {
+        return sizeof(PendingNotification) + notification.body.size();
+    }
+
+private:
+    /*
+     * The number of notifications a dispatch task handles before it yields the worker to other topics.
+     */
+    static const std::size_t MAX_NOTIFICATIONS_PER_TASK = 16;
 
 private:
     IKaaClientContext &context_;
@@ -91,11 +135,25 @@ private:
                         , INotificationListener*> NotificationObservable;
     typedef std::shared_ptr<NotificationObservable>    NotificationObservablePtr;
 
+    typedef KaaObservable<void(std::int64_t topicId, const RawNotification& notification)
+                        , IRawNotificationListener*> RawNotificationObservable;
+    typedef std::shared_ptr<RawNotificationObservable>    RawNotificationObservablePtr;
+
     KaaObservable<void (const Topics& list), INotificationTopicListListener*>    topicListeners_;
     NotificationObservable                                                       mandatoryListeners_;
     std::unordered_map<std::int64_t/*Topic ID*/, NotificationObservablePtr>       optionalListeners_;
+    RawNotificationObservable                                                    mandatoryRawListeners_;
+    std::unordered_map<std::int64_t/*Topic ID*/, RawNotificationObservablePtr>    optionalRawListeners_;
     KAA_MUTEX_DECLARE(optionalListenersGuard_);
 
+    std::unordered_map<std::int64_t/*Topic ID*/, TopicDispatchQueuePtr>    dispatchQueues_;
+    KAA_MUTEX_DECLARE(dispatchQueuesGuard_);
+
+    /*
+     * The batch a notification belongs to is shared, so only notification bodies are accounted.
+     */
+    std::atomic<std::size_t>    pendingNotificationsVolume_;
+
     SubscriptionCommands    subscriptions_;
     KAA_MUTEX_DECLARE(subscriptionsGuard_);
 };
@@ -61,6 +61,13 @@ private:
     Notifications getMulticastNotifications(const Notifications & notifications);
     std::vector<TopicState> prepareTopicStatesForRequest();
 
+    /*
+     * Return false for a notification that was already received and update the state otherwise.
+     */
+    bool acceptMulticastNotification(std::int64_t topicId, std::int32_t sequenceNumber,
+                                     TopicStates& topicStates, TopicSequenceWindows& windows);
+    bool acceptUnicastNotification(const std::string& uid, UnicastNotificationHashes& hashes);
+
 private:
     INotificationProcessor*                         notificationProcessor_;
 
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RAWNOTIFICATION_HPP_
+#define RAWNOTIFICATION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kaa/notification/gen/NotificationDefinitions.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Avro-encoded notification which is decoded on the first access to its fields.
+ *
+ * The object is a view into the received response: it is valid only during the listener call and
+ * must not be shared with other threads. Listeners which forward notifications as bytes don't pay
+ * for decoding at all.
+ */
+class RawNotification {
+public:
+    RawNotification(const std::uint8_t *data, std::size_t size);
+    ~RawNotification();
+
+    RawNotification(const RawNotification&) = delete;
+    RawNotification& operator=(const RawNotification&) = delete;
+
+    /**
+     * @return The Avro-encoded notification.
+     */
+    const std::uint8_t *getData() const { return data_; }
+    std::size_t getSize() const { return size_; }
+
+    bool isDecoded() const { return isDecoded_; }
+
+    /**
+     * @brief Decodes the notification on the first call.
+     *
+     * @throw KaaException The notification can't be decoded.
+     */
+    const KaaNotification& get() const;
+
+    const KaaNotification& operator*() const { return get(); }
+    const KaaNotification *operator->() const { return &get(); }
+
+private:
+    const std::uint8_t *const    data_;
+    const std::size_t            size_;
+
+    mutable bool               isDecoded_ = false;
+    mutable KaaNotification    notification_;
+};
+
+} /* namespace kaa */
+
+#endif /* RAWNOTIFICATION_HPP_ */
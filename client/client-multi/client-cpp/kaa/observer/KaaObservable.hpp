@@ -17,145 +17,133 @@
 #ifndef KAA_OBSERVER_KAAOBSERVABLE_HPP_
 #define KAA_OBSERVER_KAAOBSERVABLE_HPP_
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
-#include <unordered_set>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/logging/Log.hpp"
 
 namespace kaa {
 
+/**
+ * Set of callbacks notified together.
+ *
+ * Callbacks are kept in a copy-on-write array: adding or removing a callback copies the array,
+ * while notification takes the current array with one atomic load and walks it without locks or
+ * memory allocation. A callback added during notification is called starting from the next one,
+ * a removed callback is not called anymore, even by the notification in progress.
+ *
+ * Notifications from different threads may run concurrently.
+ */
 template<class Signature, class Key, class Function = std::function<Signature>>
 class KaaObservable
 {
 public:
-    KaaObservable() : isNotifying_(false) { }
+    KaaObservable() : slots_(std::make_shared<SlotArray>()) { }
     ~KaaObservable() { }
 
     bool addCallback(const Key& key, const Function& f)
     {
-        if (isNotifying_) {
-            KAA_MUTEX_LOCKING("modificationGuard_");
-            KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
-            KAA_MUTEX_LOCKED("modificationGuard_");
-            auto it = slots_.find(key);
-            if (it != slots_.end() && !it->second.isRemoved()) {
-                return false;
-            }
-            slotsToRemove_.erase(key);
-            slotsToAdd_.insert(std::make_pair(key, CallbackWrapper(f)));
-            return true;
-        } else {
-            KAA_MUTEX_LOCKING("mainGuard_");
-            KAA_MUTEX_UNIQUE_DECLARE(mainGuardLock, mainGuard_);
-            KAA_MUTEX_LOCKED("mainGuard_");
-            return slots_.insert(std::make_pair(key, CallbackWrapper(f))).second;
+        KAA_MUTEX_LOCKING("modificationGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
+        KAA_MUTEX_LOCKED("modificationGuard_");
+
+        auto slots = std::atomic_load(&slots_);
+        if (findSlot(*slots, key) != slots->end()) {
+            return false;
         }
+
+        auto newSlots = std::make_shared<SlotArray>();
+        newSlots->reserve(slots->size() + 1);
+        newSlots->assign(slots->begin(), slots->end());
+        newSlots->emplace_back(key, f);
+
+        std::atomic_store(&slots_, std::shared_ptr<const SlotArray>(std::move(newSlots)));
+        return true;
     }
 
     void removeCallback(const Key& key)
     {
-        if (isNotifying_) {
-            KAA_MUTEX_LOCKING("modificationGuard_");
-            KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
-            KAA_MUTEX_LOCKED("modificationGuard_");
-            slotsToAdd_.erase(key);
-            slotsToRemove_.insert(key);
-
-            auto it = slots_.find(key);
-            if (it != slots_.end()) {
-                it->second.remove();
-            }
-        } else {
-            KAA_MUTEX_LOCKING("mainGuard_");
-            KAA_MUTEX_UNIQUE_DECLARE(mainGuardLock, mainGuard_);
-            KAA_MUTEX_LOCKED("mainGuard_");
-            slots_.erase(key);
+        KAA_MUTEX_LOCKING("modificationGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
+        KAA_MUTEX_LOCKED("modificationGuard_");
+
+        auto slots = std::atomic_load(&slots_);
+        auto it = findSlot(*slots, key);
+        if (it == slots->end()) {
+            return;
         }
+
+        // Notifications in progress still walk the old array.
+        it->remove();
+
+        auto newSlots = std::make_shared<SlotArray>();
+        newSlots->reserve(slots->size() - 1);
+        newSlots->assign(slots->begin(), it);
+        newSlots->insert(newSlots->end(), it + 1, slots->end());
+
+        std::atomic_store(&slots_, std::shared_ptr<const SlotArray>(std::move(newSlots)));
     }
 
     template <typename... Args>
     void operator()(Args&&... args)
     {
-        isNotifying_ = true;
+        auto slots = std::atomic_load(&slots_);
 
-        KAA_MUTEX_LOCKING("mainGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(mainGuardLock, mainGuard_);
-        KAA_MUTEX_LOCKED("mainGuard_");
-
-        for (auto& pair : slots_) {
+        for (const auto& slot : *slots) {
             try {
-                pair.second(std::forward<Args>(args)...);
+                slot(std::forward<Args>(args)...);
             } catch (...) {
             }
         }
-        isNotifying_ = false;
-
-        KAA_MUTEX_LOCKING("modificationGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
-        KAA_MUTEX_LOCKED("modificationGuard_");
-
-        for (auto it = slotsToAdd_.begin(); it != slotsToAdd_.end(); ++it) {
-            slots_[it->first] = it->second;
-        }
-        slotsToAdd_.clear();
-
-        for (auto key : slotsToRemove_) {
-            slots_.erase(key);
-        }
-        slotsToRemove_.clear();
     }
 
     bool isEmpty()
     {
-        KAA_MUTEX_LOCKING("mainGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(mainGuardLock, mainGuard_);
-        KAA_MUTEX_LOCKED("mainGuard_");
-
-        KAA_MUTEX_LOCKING("modificationGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(modificationGuardLock, modificationGuard_);
-        KAA_MUTEX_LOCKED("modificationGuard_");
-
-        return slots_.empty() && slotsToAdd_.empty();
+        return std::atomic_load(&slots_)->empty();
     }
 
 private:
-    class CallbackWrapper
+    class CallbackSlot
     {
     public:
-        CallbackWrapper() : isRemoved_(false) { }
-        CallbackWrapper(const Function& f) : callback_(f), isRemoved_(false) { }
-        CallbackWrapper(const CallbackWrapper& o) : callback_(o.callback_), isRemoved_((bool) o.isRemoved_) { }
-        CallbackWrapper(CallbackWrapper&& o) : callback_(std::move(o.callback_)), isRemoved_((bool) o.isRemoved_) { }
-        CallbackWrapper& operator=(const CallbackWrapper& o)  { callback_ = o.callback_; isRemoved_ = (bool) o.isRemoved_; return *this; }
-        CallbackWrapper& operator=(CallbackWrapper&& o)  { callback_ = std::move(o.callback_); isRemoved_ = (bool) o.isRemoved_; return *this; }
+        CallbackSlot(const Key& key, const Function& f)
+            : key_(key), callback_(f), isRemoved_(std::make_shared<bool_type>(false)) { }
 
         template <typename... Args>
-        void operator()(Args&&... args)
+        void operator()(Args&&... args) const
         {
-            if (!isRemoved_) {
+            if (!*isRemoved_) {
                 callback_(std::forward<Args>(args)...);
             }
         }
 
-        bool isRemoved() const { return isRemoved_; }
-        void remove() { isRemoved_ = true; }
+        const Key& getKey() const { return key_; }
+
+        /*
+         * Copies of the slot share the flag, so the removal is seen by all arrays.
+         */
+        void remove() const { *isRemoved_ = true; }
 
     private:
+        Key key_;
         Function callback_;
-        bool_type isRemoved_;
+        std::shared_ptr<bool_type> isRemoved_;
     };
 
-    std::unordered_map<Key, CallbackWrapper> slots_;
-    std::unordered_map<Key, CallbackWrapper> slotsToAdd_;
-    std::unordered_set<Key> slotsToRemove_;
+    typedef std::vector<CallbackSlot> SlotArray;
+
+    static typename SlotArray::const_iterator findSlot(const SlotArray& slots, const Key& key)
+    {
+        return std::find_if(slots.begin(), slots.end(),
+                            [&key] (const CallbackSlot& slot) { return slot.getKey() == key; });
+    }
 
-    bool_type isNotifying_;
+    std::shared_ptr<const SlotArray> slots_;
 
-    KAA_MUTEX_DECLARE(mainGuard_);
     KAA_MUTEX_DECLARE(modificationGuard_);
 };
 
@@ -17,6 +17,8 @@
 #ifndef DEFAULTPROFILECONTAINER_HPP_
 #define DEFAULTPROFILECONTAINER_HPP_
 
+#include <cstdint>
+
 #include <kaa/profile/IProfileContainer.hpp>
 #include <kaa/profile/gen/ProfileDefinitions.hpp>
 
@@ -24,8 +26,8 @@ namespace kaa {
 
 class DefaultProfileContainer : public IProfileContainer {
 public:
-    DefaultProfileContainer() : profile_(KaaProfile()) { }
-    DefaultProfileContainer(const KaaProfile& profile) : profile_(profile) { }
+    DefaultProfileContainer() : profile_(KaaProfile()), version_(1) { }
+    DefaultProfileContainer(const KaaProfile& profile) : profile_(profile), version_(1) { }
 
     KaaProfile getProfile()
     {
@@ -35,10 +37,17 @@ public:
     void setProfile(const KaaProfile& profile)
     {
         profile_= profile;
+        ++version_;
+    }
+
+    std::uint64_t getProfileVersion()
+    {
+        return version_;
     }
 
 private:
     KaaProfile profile_;
+    std::uint64_t version_;
 };
 
 }
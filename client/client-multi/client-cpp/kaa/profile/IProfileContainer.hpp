@@ -17,6 +17,7 @@
 #ifndef IPROFILECONTAINER_HPP_
 #define IPROFILECONTAINER_HPP_
 
+#include <cstdint>
 #include <memory>
 
 #include "kaa/profile/gen/ProfileDefinitions.hpp"
@@ -37,6 +38,17 @@ public:
      */
     virtual KaaProfile getProfile() = 0;
 
+    /**
+     * @brief Retrieves the version of the profile instance.
+     *
+     * The version must change whenever the profile returned by @link getProfile() @endlink changes.
+     * It allows to serialize the profile only once per change.
+     *
+     * @return profile version, zero if the container doesn't track profile changes.
+     * In that case the profile is serialized on each use.
+     */
+    virtual std::uint64_t getProfileVersion() { return 0; }
+
     virtual ~IProfileContainer() {}
 };
 
@@ -55,6 +55,14 @@ public:
      */
     virtual SharedDataBuffer getSerializedProfile() = 0;
 
+    /**
+     * Returns SHA-1 hash of the serialized profile
+     */
+    virtual HashDigest getSerializedProfileHash()
+    {
+        return EndpointObjectHash(getSerializedProfile()).getHashDigest();
+    }
+
     virtual ~IProfileManager() {}
 };
 
@@ -17,8 +17,11 @@
 #ifndef DEFAULTPROFILEMANAGER_HPP_
 #define DEFAULTPROFILEMANAGER_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
+#include "kaa/KaaThread.hpp"
 #include "kaa/profile/IProfileManager.hpp"
 #include "kaa/profile/IProfileContainer.hpp"
 #include "kaa/profile/DefaultProfileContainer.hpp"
@@ -32,21 +35,19 @@ namespace kaa {
 /**
  * Default profile manager
  * Responsible for the profile container management and ProfileListener creation
+ *
+ * The serialized profile and its hash are cached while the version of the profile container is unchanged,
+ * see @link IProfileContainer::getProfileVersion() @endlink.
  */
 class ProfileManager : public IProfileManager {
 public:
-    ProfileManager(IKaaClientContext &context) : profileContainer_(std::make_shared<DefaultProfileContainer>()), context_(context) { }
+    ProfileManager(IKaaClientContext &context);
 
     /**
      * Sets profile container implemented by the user
      * @param container user-defined container
      */
-    virtual void setProfileContainer(IProfileContainerPtr container)
-    {
-        if (container) {
-            profileContainer_ = container;
-        }
-    }
+    virtual void setProfileContainer(IProfileContainerPtr container);
 
     /**
      * Retrieves serialized profile
@@ -54,33 +55,15 @@ public:
      * @return byte array with serialized profile
      *
      */
-    SharedDataBuffer getSerializedProfile()
-    {
-        static AvroByteArrayConverter<KaaProfile> avroConverter;
-
-        if (profileContainer_) {
-            return avroConverter.toByteArray(profileContainer_->getProfile());
-        }
-#if KAA_PROFILE_SCHEMA_VERSION > 0
-        else {
-            throw KaaException("Profile container is not set!");
-        }
-#endif
+    virtual SharedDataBuffer getSerializedProfile();
 
-        return avroConverter.toByteArray(KaaProfile());
-    }
+    virtual HashDigest getSerializedProfileHash();
 
     /**
      * Notifies server that profile has been updated.
+     * Does nothing if the server already knows the current profile.
      */
-    void updateProfile()
-    {
-        SharedDataBuffer serializedProfile = getSerializedProfile();
-        if ((serializedProfile.first.get() && serializedProfile.second > 0)
-                || context_.getStatus().isProfileResyncNeeded()) {
-            transport_->sync();
-        }
-    }
+    virtual void updateProfile();
 
     virtual bool isInitialized()
     {
@@ -102,10 +85,31 @@ public:
         }
     }
 
+    /**
+     * The number of @link updateProfile() @endlink calls that didn't need a profile sync.
+     */
+    std::uint64_t getSkippedUpdatesCount() const
+    {
+        return skippedUpdatesCount_;
+    }
+
+private:
+    void refreshSerializedProfile();
+
 private:
     IProfileTransportPtr            transport_;
     IProfileContainerPtr     profileContainer_;
     IKaaClientContext                &context_;
+
+    AvroByteArrayConverter<KaaProfile>    avroConverter_;
+
+    SharedDataBuffer                serializedProfile_;
+    HashDigest                      serializedProfileHash_;
+    std::uint64_t                   serializedProfileVersion_ = 0;
+    bool                            isSerializedProfileValid_ = false;
+    KAA_MUTEX_DECLARE(profileGuard_);
+
+    std::atomic<std::uint64_t>      skippedUpdatesCount_;
 };
 
 } /* namespace kaa */
@@ -18,7 +18,10 @@
 #define IENCODERDECODER_HPP_
 
 #include <cstdint>
+#include <vector>
+#include <algorithm>
 #include "kaa/security/SecurityDefinitions.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
@@ -31,6 +34,32 @@ public:
     virtual std::string                         decodeData(const std::uint8_t *data, std::size_t size) = 0;
     virtual Signature                           signData(const std::uint8_t *data, std::size_t size) = 0;
     virtual bool                                verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen) = 0;
+
+    /**
+     * Encodes the data which starts at @c offset of the buffer in place. The buffer may grow by the padding.
+     */
+    virtual void encodeDataInPlace(std::vector<std::uint8_t>& buffer, std::size_t offset = 0)
+    {
+        const std::string& encoded = encodeData(buffer.data() + offset, buffer.size() - offset);
+        buffer.resize(offset);
+        buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    }
+
+    /**
+     * Decodes the data in place.
+     *
+     * @return the size of the decoded data which starts at the beginning of the buffer.
+     */
+    virtual std::size_t decodeDataInPlace(std::uint8_t *data, std::size_t size)
+    {
+        const std::string& decoded = decodeData(data, size);
+        if (decoded.size() > size) {
+            throw KaaException("Decoded data doesn't fit the encoded data buffer");
+        }
+
+        std::copy(decoded.begin(), decoded.end(), data);
+        return decoded.size();
+    }
 };
 
 }  // namespace kaa
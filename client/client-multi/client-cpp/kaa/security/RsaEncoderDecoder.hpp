@@ -18,39 +18,62 @@
 #define RSAENCODERDECODER_HPP_
 
 #include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaKeyCache.hpp"
 #include "kaa/security/IEncoderDecoder.hpp"
 #include "kaa/IKaaClientContext.hpp"
 #include <botan/rsa.h>
-#include <botan/cipher_mode.h>
+#include <botan/block_cipher.h>
 #include <cstdint>
 #include <memory>
 
 namespace kaa {
 
+/**
+ * Encrypts the session payload with AES-128/ECB/PKCS7 and the session key, which is sent to the server
+ * encrypted with its RSA public key.
+ *
+ * RSA keys and their operations are shared through @c RsaKeyCache, so creating an instance per server
+ * doesn't parse the keys again.
+ *
+ * The AES cipher is created and keyed once per session. Botan selects its fastest implementation,
+ * e.g. AES-NI, for the current CPU. The in-place methods encrypt and decrypt without extra buffers.
+ */
 class RsaEncoderDecoder : public IEncoderDecoder {
 public:
     RsaEncoderDecoder(const PublicKey& pubKey,
                       const PrivateKey& privKey,
                       const PublicKey& remoteKey,
                       IKaaClientContext &context);
+
+    /**
+     * Continues the session with the given session key, e.g. one resumed by a session ticket.
+     */
+    RsaEncoderDecoder(const PublicKey& pubKey,
+                      const PrivateKey& privKey,
+                      const PublicKey& remoteKey,
+                      const SessionKey& sessionKey,
+                      IKaaClientContext &context);
     ~RsaEncoderDecoder() { }
 
+    const SessionKey& getSessionKey() const { return sessionKey_; }
+
     virtual EncodedSessionKey getEncodedSessionKey();
     virtual std::string encodeData(const std::uint8_t *data, std::size_t size);
     virtual std::string decodeData(const std::uint8_t *data, std::size_t size);
     virtual Signature signData(const std::uint8_t *data, std::size_t size);
     virtual bool verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen);
 
-private:
-    std::string cipherPipe(const std::uint8_t *data, std::size_t size, Botan::Cipher_Dir dir);
+    virtual void encodeDataInPlace(std::vector<std::uint8_t>& buffer, std::size_t offset = 0);
+    virtual std::size_t decodeDataInPlace(std::uint8_t *data, std::size_t size);
 
 private:
-    Botan::AutoSeeded_RNG rng_;
-    std::unique_ptr<Botan::X509_PublicKey>   pubKey_;
-    std::unique_ptr<Botan::PKCS8_PrivateKey> privKey_;
-    std::unique_ptr<Botan::X509_PublicKey>   remoteKey_;
+    RsaKeyCache::PublicKeyContextPtr    pubKey_;
+    RsaKeyCache::PrivateKeyContextPtr   privKey_;
+    RsaKeyCache::PublicKeyContextPtr    remoteKey_;
 
     SessionKey sessionKey_;
+    EncodedSessionKey encodedSessionKey_;
+    std::unique_ptr<Botan::BlockCipher> sessionCipher_;
 
     IKaaClientContext &context_;
 };
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RSAKEYCACHE_HPP_
+#define RSAKEYCACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#include <botan/botan.h>
+#include <botan/pubkey.h>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/common/EndpointObjectHash.hpp"
+#include "kaa/security/SecurityDefinitions.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Process-wide cache of parsed RSA keys and their public key operations.
+ *
+ * Keys are looked up by the SHA-1 hash of their encoded form, so channels which are created for each
+ * server (e.g. on failover) don't parse the same keys again. Parsed keys keep their encryptor, verifier
+ * and signer, which are expensive to set up for RSA.
+ *
+ * Thread safe.
+ */
+class RsaKeyCache {
+public:
+    /**
+     * @brief Parsed public key with its encryptor and verifier.
+     */
+    class PublicKeyContext {
+    public:
+        explicit PublicKeyContext(const PublicKey& key);
+
+        const Botan::X509_PublicKey& getKey() const { return *key_; }
+
+        EncodedSessionKey encrypt(const std::uint8_t *data, std::size_t size);
+        bool verify(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen);
+
+    private:
+        Botan::AutoSeeded_RNG                           rng_;
+        std::unique_ptr<Botan::X509_PublicKey>          key_;
+        std::unique_ptr<Botan::PK_Encryptor_EME>        encryptor_;
+        std::unique_ptr<Botan::PK_Verifier>             verifier_;
+
+        KAA_MUTEX_DECLARE(operationGuard_);
+    };
+
+    /**
+     * @brief Parsed private key with its signer.
+     */
+    class PrivateKeyContext {
+    public:
+        explicit PrivateKeyContext(const PrivateKey& key);
+
+        const Botan::PKCS8_PrivateKey& getKey() const { return *key_; }
+
+        Signature sign(const std::uint8_t *data, std::size_t size);
+
+    private:
+        Botan::AutoSeeded_RNG                           rng_;
+        std::unique_ptr<Botan::PKCS8_PrivateKey>        key_;
+        std::unique_ptr<Botan::PK_Signer>               signer_;
+
+        KAA_MUTEX_DECLARE(operationGuard_);
+    };
+
+    typedef std::shared_ptr<PublicKeyContext>   PublicKeyContextPtr;
+    typedef std::shared_ptr<PrivateKeyContext>  PrivateKeyContextPtr;
+
+    /**
+     * @brief Returns the parsed public key, parsing it on the first request.
+     *
+     * Throws Botan exceptions if the key can't be parsed.
+     */
+    static PublicKeyContextPtr getPublicKey(const PublicKey& key);
+
+    /**
+     * @brief Returns the parsed private key, parsing it on the first request.
+     *
+     * Throws Botan exceptions if the key can't be parsed.
+     */
+    static PrivateKeyContextPtr getPrivateKey(const PrivateKey& key);
+
+    /**
+     * @brief Drops all cached keys. Keys still used by their owners stay valid.
+     */
+    static void clear();
+
+private:
+    template<typename Context, typename Key>
+    static std::shared_ptr<Context> getContext(std::map<HashDigest, std::shared_ptr<Context>>& contexts, const Key& key);
+
+    static RsaKeyCache& getInstance();
+
+private:
+    std::map<HashDigest, PublicKeyContextPtr>     publicKeys_;
+    std::map<HashDigest, PrivateKeyContextPtr>    privateKeys_;
+
+    KAA_MUTEX_DECLARE(cacheGuard_);
+
+    /*
+     * Keys which aren't used by anyone are dropped once the cache grows above this limit.
+     */
+    static const std::size_t MAX_CACHED_KEYS = 16;
+};
+
+} /* namespace kaa */
+
+#endif /* RSAKEYCACHE_HPP_ */
@@ -60,6 +60,8 @@ private:
     void verifyResponse(const IHttpResponse& response);
 
 private:
+    static const std::size_t MAX_SIGNATURE_SIZE = 512; /*!< RSA-4096 signature size. */
+
     std::shared_ptr<IEncoderDecoder> encDec_;
     IKaaClientContext &context_;
 };
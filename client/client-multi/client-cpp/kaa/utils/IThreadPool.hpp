@@ -18,6 +18,8 @@
 #define ITHREADPOOL_HPP_
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -25,6 +27,41 @@ namespace kaa {
 
 typedef std::function<void()> ThreadPoolTask;
 
+/**
+ * Called by each worker of a thread pool once it has started, before executing any task.
+ * The argument is the index of the worker in range [0, worker count).
+ */
+typedef std::function<void (std::size_t workerIndex)> ThreadPoolWorkerInitializer;
+
+/**
+ * @brief What a thread pool does with a task added to its full task queue.
+ */
+enum class TaskOverflowPolicy {
+    BLOCK,          ///< The adding thread waits until a worker takes a task, which slows the producer down.
+    DROP_OLDEST,    ///< The oldest pending task is dropped to make room.
+    COALESCE        ///< As @c BLOCK, but a task added by @c addCoalescing() replaces the pending task with
+                    ///< the same key at any queue depth, so superseded updates don't take room.
+};
+
+struct TaskQueueSettings {
+    std::size_t           capacity_ = 0;    ///< The maximum count of pending tasks, 0 - unbounded.
+    TaskOverflowPolicy    overflowPolicy_ = TaskOverflowPolicy::BLOCK;
+};
+
+struct TaskQueueMetrics {
+    std::size_t      queueDepth_ = 0;           ///< Tasks pending now.
+    std::size_t      maxQueueDepth_ = 0;        ///< The highest depth since the pool has been created.
+    std::uint64_t    addedTaskCount_ = 0;
+    std::uint64_t    droppedTaskCount_ = 0;
+    std::uint64_t    coalescedTaskCount_ = 0;
+    std::uint64_t    blockedAddCount_ = 0;      ///< Additions which have waited for room in the queue.
+};
+
+/**
+ * The key of tasks superseding each other, usually the address of the object the task notifies of.
+ */
+typedef const void* TaskCoalescingKey;
+
 class IThreadPool {
 public:
 
@@ -38,6 +75,31 @@ public:
      */
     virtual void add(const ThreadPoolTask& task) = 0;
 
+    /**
+     * @brief Adds a task for execution. Pools keeping a task queue move the task into it instead of copying,
+     * so a task whose state fits into @c std::function costs no allocation.
+     *
+     * @throw std::invalid_argument The task object is invalid, i.e. empty.
+     * @throw std::logic_error The thread pool is shut down.
+     */
+    void add(ThreadPoolTask&& task) { addMoved(std::move(task)); }
+
+    /**
+     * @brief Adds a task which supersedes the pending task with the same key, if any.
+     *
+     * Only pools with the @c TaskOverflowPolicy::COALESCE policy replace pending tasks,
+     * the others add the task as @c add() does.
+     *
+     * @throw std::invalid_argument The task object is invalid, i.e. empty.
+     * @throw std::logic_error The thread pool is shut down.
+     */
+    virtual void addCoalescing(TaskCoalescingKey key, const ThreadPoolTask& task) { add(task); }
+
+    /**
+     * @return The task queue metrics. Pools without a task queue return zeros.
+     */
+    virtual TaskQueueMetrics getQueueMetrics() { return TaskQueueMetrics(); }
+
     /**
      * @brief Blocks until all tasks have completed execution after
      * a shutdown request, or the timeout occurs.
@@ -63,6 +125,9 @@ public:
     virtual void shutdownNow() = 0;
 
     virtual ~IThreadPool() {}
+
+protected:
+    virtual void addMoved(ThreadPoolTask&& task) { add(static_cast<const ThreadPoolTask&>(task)); }
 };
 
 typedef std::shared_ptr<IThreadPool>    IThreadPoolPtr;
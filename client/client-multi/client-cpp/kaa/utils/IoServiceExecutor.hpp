@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IOSERVICEEXECUTOR_HPP_
+#define IOSERVICEEXECUTOR_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <boost/asio.hpp>
+
+#include "kaa/utils/IThreadPool.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Executor which runs tasks as handlers of an I/O service, e.g. the one of a polled
+ * @link IoServicePool @endlink, so tasks are run by the thread running the I/O service.
+ *
+ * The I/O service should outlive the executor. Tasks left in the I/O service after the executor
+ * is destroyed or shut down by @c shutdownNow() are skipped.
+ */
+class IoServiceExecutor : public IThreadPool {
+public:
+    explicit IoServiceExecutor(boost::asio::io_service& io);
+    ~IoServiceExecutor();
+
+    virtual void add(const ThreadPoolTask& task);
+
+    /**
+     * @brief Waits for pending tasks running the I/O service on the calling thread, so it works
+     * even if nobody else runs the I/O service.
+     */
+    virtual void awaitTermination(std::size_t seconds);
+
+    virtual void shutdown();
+    virtual void shutdownNow();
+
+private:
+    /*
+     * Shared with the posted handlers, which may outlive the executor.
+     */
+    struct Tasks {
+        std::atomic<std::size_t>    pendingCount_;
+        std::atomic<bool>           isCancelled_;
+
+        Tasks() : pendingCount_(0), isCancelled_(false) {}
+    };
+
+private:
+    boost::asio::io_service&    io_;
+    std::shared_ptr<Tasks>      tasks_;
+    std::atomic<bool>           isShutdown_;
+};
+
+} /* namespace kaa */
+
+#endif /* IOSERVICEEXECUTOR_HPP_ */
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IOSERVICEPOOL_HPP_
+#define IOSERVICEPOOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Pool of I/O services shared by the channels of one or several Kaa clients.
+ *
+ * Each I/O service is run by its own thread, I/O services are handed out in round-robin order.
+ * A polled pool has a single I/O service and no threads: it is run by the application, see @c createPolled().
+ * The pool should outlive all channels that use it.
+ */
+class IoServicePool {
+public:
+    /**
+     * @param[in] size    The number of I/O services (and threads). If zero, the number of hardware threads is used.
+     */
+    explicit IoServicePool(std::size_t size = 0);
+    ~IoServicePool();
+
+    /**
+     * @brief Creates the pool of one I/O service which is run by the application thread,
+     * e.g. by @link PollingExecutorContext::poll() @endlink.
+     */
+    static std::shared_ptr<IoServicePool> createPolled();
+
+    IoServicePool(const IoServicePool&) = delete;
+    IoServicePool& operator=(const IoServicePool&) = delete;
+
+    /**
+     * @brief Returns the next I/O service of the pool.
+     */
+    boost::asio::io_service& getIoService();
+
+    std::size_t getSize() const { return ioServices_.size(); }
+
+    bool isPolled() const { return isPolled_; }
+
+    /**
+     * @brief Stops all I/O services and waits for their threads. Pending handlers are not run.
+     */
+    void stop();
+
+private:
+    struct PolledTag {};
+
+    explicit IoServicePool(PolledTag);
+
+private:
+    bool    isPolled_ = false;
+
+    std::vector<std::unique_ptr<boost::asio::io_service>>          ioServices_;
+    std::vector<std::unique_ptr<boost::asio::io_service::work>>    works_;
+    std::vector<std::thread>                                       threads_;
+
+    std::atomic<std::size_t>    nextIoService_;
+
+    KAA_MUTEX_DECLARE(poolGuard_);
+};
+
+typedef std::shared_ptr<IoServicePool> IoServicePoolPtr;
+
+} /* namespace kaa */
+
+#endif /* IOSERVICEPOOL_HPP_ */
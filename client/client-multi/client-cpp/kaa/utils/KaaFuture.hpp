@@ -0,0 +1,432 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KAAFUTURE_HPP_
+#define KAAFUTURE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "kaa/utils/IThreadPool.hpp"
+
+namespace kaa {
+
+template<typename T> class KaaFuture;
+template<typename T> class KaaPromise;
+
+namespace detail {
+
+template<typename T>
+class FutureValue {
+public:
+    template<typename V>
+    void set(V&& value) { value_.reset(new T(std::forward<V>(value))); }
+    T get() const { return *value_; }
+
+private:
+    std::unique_ptr<T> value_;
+};
+
+template<>
+class FutureValue<void> {
+public:
+    void set() {}
+    void get() const {}
+};
+
+template<typename T>
+class FutureState {
+public:
+    typedef std::function<void ()> Continuation;
+
+    bool isReady() const
+    {
+        std::unique_lock<std::mutex> stateLock(stateGuard_);
+        return isReady_;
+    }
+
+    void wait() const
+    {
+        std::unique_lock<std::mutex> stateLock(stateGuard_);
+        onReady_.wait(stateLock, [this] { return isReady_; });
+    }
+
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        std::unique_lock<std::mutex> stateLock(stateGuard_);
+        return onReady_.wait_for(stateLock, timeout, [this] { return isReady_; });
+    }
+
+    T get() const
+    {
+        wait();
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        return value_.get();
+    }
+
+    template<typename... Args>
+    void setValue(Args&&... args)
+    {
+        std::list<Continuation> continuations;
+
+        {
+            std::unique_lock<std::mutex> stateLock(stateGuard_);
+            if (isReady_) {
+                throw std::logic_error("Future is already satisfied");
+            }
+
+            value_.set(std::forward<Args>(args)...);
+            isReady_ = true;
+            continuations.swap(continuations_);
+        }
+
+        onReady_.notify_all();
+        runContinuations(continuations);
+    }
+
+    /*
+     * Returns false if the state is already satisfied.
+     */
+    bool setException(std::exception_ptr exception)
+    {
+        std::list<Continuation> continuations;
+
+        {
+            std::unique_lock<std::mutex> stateLock(stateGuard_);
+            if (isReady_) {
+                return false;
+            }
+
+            exception_ = exception;
+            isReady_ = true;
+            continuations.swap(continuations_);
+        }
+
+        onReady_.notify_all();
+        runContinuations(continuations);
+        return true;
+    }
+
+    void addContinuation(const Continuation& continuation)
+    {
+        {
+            std::unique_lock<std::mutex> stateLock(stateGuard_);
+            if (!isReady_) {
+                continuations_.push_back(continuation);
+                return;
+            }
+        }
+
+        continuation();
+    }
+
+private:
+    static void runContinuations(std::list<Continuation>& continuations)
+    {
+        for (auto& continuation : continuations) {
+            continuation();
+        }
+    }
+
+private:
+    bool                  isReady_ = false;
+    FutureValue<T>        value_;
+    std::exception_ptr    exception_;
+
+    std::list<Continuation>    continuations_;
+
+    /*
+     * Not the KAA_MUTEX macros: waiting for a result needs real synchronization
+     * even if the SDK is built without thread safety.
+     */
+    mutable std::mutex                 stateGuard_;
+    mutable std::condition_variable    onReady_;
+};
+
+/*
+ * Breaks the promise when the last copy of it is destroyed unsatisfied.
+ */
+template<typename T>
+class PromiseKeeper {
+public:
+    PromiseKeeper() : state_(std::make_shared<FutureState<T>>()) {}
+
+    ~PromiseKeeper()
+    {
+        state_->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+
+    const std::shared_ptr<FutureState<T>>& getState() const { return state_; }
+
+private:
+    std::shared_ptr<FutureState<T>> state_;
+};
+
+/*
+ * Sets the result of a continuation returning R to the promise of the future returned by then().
+ * A continuation returning a future is unwrapped, so asynchronous operations can be chained.
+ */
+template<typename R>
+struct ContinuationResult {
+    typedef R ValueType;
+
+    template<typename P, typename F, typename A>
+    static void invoke(P& promise, F& continuation, A&& argument)
+    {
+        promise.setValue(continuation(std::forward<A>(argument)));
+    }
+};
+
+template<>
+struct ContinuationResult<void> {
+    typedef void ValueType;
+
+    template<typename P, typename F, typename A>
+    static void invoke(P& promise, F& continuation, A&& argument)
+    {
+        continuation(std::forward<A>(argument));
+        promise.setValue();
+    }
+};
+
+template<typename U>
+struct ContinuationResult<KaaFuture<U>> {
+    typedef U ValueType;
+
+    template<typename P, typename F, typename A>
+    static void invoke(P& promise, F& continuation, A&& argument)
+    {
+        KaaFuture<U> inner = continuation(std::forward<A>(argument));
+        inner.then([promise] (KaaFuture<U> result) mutable
+            {
+                promise.setFrom(result);
+            });
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * @brief The result of an asynchronous operation which may be waited for or chained with continuations.
+ *
+ * Unlike @c std::future, the result may be read many times and copies of the future share it.
+ *
+ * @code
+ * attachUserAsync(client, "user", "token")
+ *     .then(executor, [&client] (KaaFuture<void> attached)
+ *         {
+ *             attached.get(); // Rethrows an attach failure.
+ *             return findEventListenersAsync(client, { "org.kaaproject.Event" });
+ *         })
+ *     .then(executor, [] (KaaFuture<std::vector<std::string>> listeners)
+ *         {
+ *             ...
+ *         });
+ * @endcode
+ */
+template<typename T>
+class KaaFuture {
+    template<typename> friend class KaaPromise;
+    template<typename> friend class KaaFuture;
+
+public:
+    /**
+     * @brief Creates a future without a state. Only assignment and @c isValid() may be called on it.
+     */
+    KaaFuture() {}
+
+    bool isValid() const { return static_cast<bool>(state_); }
+
+    bool isReady() const { return state_->isReady(); }
+
+    void wait() const { state_->wait(); }
+
+    /**
+     * @return @c true if the result is ready, @c false on timeout.
+     */
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const { return state_->waitFor(timeout); }
+
+    /**
+     * @brief Blocks until the result is ready and returns it.
+     *
+     * @throw The exception the operation has failed with. @c std::future_error with the
+     * @c broken_promise code if the operation was dropped without a result.
+     */
+    T get() const { return state_->get(); }
+
+    /**
+     * @brief Calls the continuation with this future once it is ready.
+     *
+     * The continuation is called on the thread satisfying the future, or immediately on the calling
+     * thread if the future is already ready, so it must not block.
+     *
+     * @return The future of the result of the continuation. If the continuation returns a future,
+     * the returned future becomes ready when that one does. An exception thrown by the continuation
+     * is passed to the returned future.
+     */
+    template<typename F>
+    KaaFuture<typename detail::ContinuationResult<typename std::result_of<F(KaaFuture<T>)>::type>::ValueType>
+    then(F&& continuation)
+    {
+        typedef typename std::result_of<F(KaaFuture<T>)>::type ResultType;
+        typedef typename detail::ContinuationResult<ResultType>::ValueType ValueType;
+
+        KaaPromise<ValueType> promise;
+        auto future = promise.getFuture();
+        auto state = state_;
+        typename std::decay<F>::type callable(std::forward<F>(continuation));
+
+        state_->addContinuation([state, promise, callable] () mutable
+            {
+                try {
+                    detail::ContinuationResult<ResultType>::invoke(promise, callable, KaaFuture<T>(state));
+                } catch (...) {
+                    promise.setException(std::current_exception());
+                }
+            });
+
+        return future;
+    }
+
+    /**
+     * @brief Same as @c then(), but the continuation is added as a task to the executor,
+     * e.g. the callback executor of the Kaa client's executor context.
+     *
+     * @note The executor must outlive the future. If the executor rejects the task (it is shut down),
+     * the returned future gets the exception of @c IThreadPool::add().
+     */
+    template<typename F>
+    KaaFuture<typename detail::ContinuationResult<typename std::result_of<F(KaaFuture<T>)>::type>::ValueType>
+    then(IThreadPool& executor, F&& continuation)
+    {
+        typedef typename std::result_of<F(KaaFuture<T>)>::type ResultType;
+        typedef typename detail::ContinuationResult<ResultType>::ValueType ValueType;
+
+        KaaPromise<ValueType> promise;
+        auto future = promise.getFuture();
+        auto state = state_;
+        auto executorPtr = &executor;
+        typename std::decay<F>::type callable(std::forward<F>(continuation));
+
+        state_->addContinuation([state, promise, callable, executorPtr] () mutable
+            {
+                try {
+                    executorPtr->add([state, promise, callable] () mutable
+                        {
+                            try {
+                                detail::ContinuationResult<ResultType>::invoke(promise, callable, KaaFuture<T>(state));
+                            } catch (...) {
+                                promise.setException(std::current_exception());
+                            }
+                        });
+                } catch (...) {
+                    promise.setException(std::current_exception());
+                }
+            });
+
+        return future;
+    }
+
+private:
+    explicit KaaFuture(const std::shared_ptr<detail::FutureState<T>>& state)
+        : state_(state) {}
+
+private:
+    std::shared_ptr<detail::FutureState<T>> state_;
+};
+
+/**
+ * @brief The producer side of a @c KaaFuture. Copies of the promise share the state.
+ *
+ * If the last copy is destroyed without a result, the future fails with @c std::future_error
+ * (@c broken_promise).
+ */
+template<typename T>
+class KaaPromise {
+public:
+    KaaPromise()
+        : keeper_(std::make_shared<detail::PromiseKeeper<T>>()) {}
+
+    KaaFuture<T> getFuture() const { return KaaFuture<T>(keeper_->getState()); }
+
+    /**
+     * @throw std::logic_error The promise is already satisfied.
+     */
+    template<typename... Args>
+    void setValue(Args&&... args) { keeper_->getState()->setValue(std::forward<Args>(args)...); }
+
+    /**
+     * @return @c false if the promise is already satisfied, the exception is ignored then.
+     */
+    bool setException(std::exception_ptr exception) { return keeper_->getState()->setException(exception); }
+
+    /**
+     * @brief Satisfies the promise with the result of the ready future.
+     */
+    void setFrom(const KaaFuture<T>& future)
+    {
+        try {
+            setFromValue<T>(future);
+        } catch (...) {
+            setException(std::current_exception());
+        }
+    }
+
+private:
+    template<typename V>
+    typename std::enable_if<!std::is_void<V>::value>::type setFromValue(const KaaFuture<V>& future)
+    {
+        setValue(future.get());
+    }
+
+    template<typename V>
+    typename std::enable_if<std::is_void<V>::value>::type setFromValue(const KaaFuture<V>& future)
+    {
+        future.get();
+        setValue();
+    }
+
+private:
+    std::shared_ptr<detail::PromiseKeeper<T>> keeper_;
+};
+
+/**
+ * @brief Creates a ready future holding the value.
+ */
+template<typename T>
+KaaFuture<typename std::decay<T>::type> makeReadyFuture(T&& value)
+{
+    KaaPromise<typename std::decay<T>::type> promise;
+    promise.setValue(std::forward<T>(value));
+    return promise.getFuture();
+}
+
+} /* namespace kaa */
+
+#endif /* KAAFUTURE_HPP_ */
@@ -18,23 +18,26 @@
 #define KAATIMER_HPP_
 
 #include <chrono>
+#include <cstdint>
 #include <mutex>
-#include <thread>
 #include <functional>
-#include <condition_variable>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/logging/Log.hpp"
+#include "kaa/utils/TimerService.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+/**
+ * One-shot timer. Timers don't own threads, their callbacks are run by the process-wide @c TimerService.
+ */
 template<class Signature, class Function = std::function<Signature>>
 class KaaTimer {
-    typedef std::chrono::system_clock TimerClock;
+    typedef TimerService::Clock TimerClock;
 public:
     KaaTimer(const std::string& timerName) :
-        timerName_(timerName), isThreadRun_(false), isTimerRun_(false), callback_([]{})
+        timerName_(timerName), isTimerRun_(false), isScheduled_(false), callback_([]{})
     {
     }
 
@@ -43,87 +46,85 @@ public:
         /*
          * Do not add the mutex logging it may cause crashes.
          */
-        if (isThreadRun_ && timerThread_.joinable()) {
-            std::unique_lock<std::mutex> timerLock(timerGuard_);
+        KAA_MUTEX_UNIQUE_DECLARE(timerLock, timerGuard_);
 
-            isThreadRun_ = false;
-            condition_.notify_one();
+        if (isScheduled_) {
+            auto handle = timerHandle_;
+            isTimerRun_ = false;
 
             timerLock.unlock();
 
-            timerThread_.join();
+            // The callback may refer to this timer, so wait for it to return.
+            TimerService::getInstance().cancel(handle);
+            TimerService::getInstance().waitForCallbacks(this);
         }
     }
 
     void start(std::size_t seconds, const Function& callback)
+    {
+        start(std::chrono::seconds(seconds), callback);
+    }
+
+    template<class Rep, class Period>
+    void start(const std::chrono::duration<Rep, Period>& delay, const Function& callback)
     {
         if (!callback) {
             throw KaaException("Bad timer callback");
         }
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
-
-        if (!isThreadRun_) {
-            isThreadRun_ = true;
-            timerThread_ = std::thread([&] { run(); });
-        }
+        KAA_MUTEX_UNIQUE_DECLARE(timerLock, timerGuard_);
 
         if (!isTimerRun_) {
-            endTS_ = TimerClock::now() + std::chrono::seconds(seconds);
             isTimerRun_ = true;
+            isScheduled_ = true;
             callback_ = callback;
-            condition_.notify_one();
+
+            std::uint64_t generation = ++generation_;
+            auto deadline = TimerClock::now() + std::chrono::duration_cast<TimerClock::duration>(delay);
+            timerHandle_ = TimerService::getInstance().schedule(deadline,
+                                                                [this, generation] { onExpired(generation); },
+                                                                this);
         }
     }
 
     void stop()
     {
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
+        KAA_MUTEX_UNIQUE_DECLARE(timerLock, timerGuard_);
 
         if (isTimerRun_) {
             isTimerRun_ = false;
-            condition_.notify_one();
+            TimerService::getInstance().cancel(timerHandle_);
         }
     }
 
 private:
-    void run()
+    void onExpired(std::uint64_t generation)
     {
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
+        KAA_MUTEX_UNIQUE_DECLARE(timerLock, timerGuard_);
 
-        while (isThreadRun_) {
-            if (isTimerRun_) {
-                auto now = TimerClock::now();
-                if (now >= endTS_) {
-                    isTimerRun_ = false;
+        // The timer has been stopped or restarted since.
+        if (!isTimerRun_ || generation != generation_) {
+            return;
+        }
 
-                    auto currentCallback = callback_;
+        isTimerRun_ = false;
 
-                    timerLock.unlock();
+        auto currentCallback = callback_;
 
-                    currentCallback();
+        timerLock.unlock();
 
-                    timerLock.lock();
-                } else {
-                    condition_.wait_for(timerLock, (endTS_ - now));
-                }
-            } else {
-                condition_.wait(timerLock);
-            }
-        }
+        currentCallback();
     }
 
 private:
     const std::string timerName_;
 
-    bool isThreadRun_;
     bool isTimerRun_;
+    bool isScheduled_;
 
-    std::thread timerThread_;
-    std::condition_variable condition_;
-
-    std::mutex timerGuard_;
+    std::uint64_t generation_ = 0;
+    TimerService::TimerHandle timerHandle_;
 
-    std::chrono::time_point<TimerClock> endTS_;
+    KAA_MUTEX_DECLARE(timerGuard_);
 
     Function callback_;
 };
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOCKPROFILER_HPP_
+#define LOCKPROFILER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace kaa {
+
+/**
+ * @brief Contention statistics of one named lock, summed over all instances of the lock
+ * (e.g. @c channelGuard_ of all channel managers).
+ */
+struct LockStatistics {
+    std::string      file_;
+    std::string      name_;
+
+    std::uint64_t    acquisitionCount_ = 0;
+    std::uint64_t    contentionCount_ = 0;    ///< Acquisitions which had to wait for another owner.
+
+    std::uint64_t    totalWaitTimeNs_ = 0;
+    std::uint64_t    maxWaitTimeNs_ = 0;
+
+    std::uint64_t    totalHoldTimeNs_ = 0;
+    std::uint64_t    maxHoldTimeNs_ = 0;
+};
+
+/**
+ * @brief Process-wide table of lock statistics filled by @c ProfiledMutex.
+ *
+ * The SDK's mutexes are profiled if it is built with @c KAA_WITH_LOCK_PROFILING,
+ * otherwise the table stays empty.
+ */
+class LockProfiler {
+public:
+    class Entry;
+
+    /**
+     * @brief Returns the entry of the lock, registering it on the first call.
+     *
+     * @param file    The file the lock is declared in. Must be a string literal.
+     * @param name    The lock name. Must be a string literal.
+     */
+    static Entry& getEntry(const char *file, const char *name);
+
+    /**
+     * @return Statistics of all registered locks sorted by total wait time, the most contended first.
+     */
+    static std::vector<LockStatistics> getStatistics();
+
+    /**
+     * @brief Writes the statistics as a table, one lock per line.
+     */
+    static void dump(std::ostream& stream);
+
+    /**
+     * @brief Zeroes the statistics of all registered locks.
+     */
+    static void reset();
+
+public:
+    /*
+     * The table doesn't grow, locks registered after it is full are accounted in the last entry.
+     */
+    static const std::size_t MAX_LOCK_COUNT = 256;
+};
+
+class LockProfiler::Entry {
+public:
+    void onAcquired(bool isContended, std::uint64_t waitTimeNs)
+    {
+        acquisitionCount_.fetch_add(1, std::memory_order_relaxed);
+        if (isContended) {
+            contentionCount_.fetch_add(1, std::memory_order_relaxed);
+            totalWaitTimeNs_.fetch_add(waitTimeNs, std::memory_order_relaxed);
+            updateMax(maxWaitTimeNs_, waitTimeNs);
+        }
+    }
+
+    void onReleased(std::uint64_t holdTimeNs)
+    {
+        totalHoldTimeNs_.fetch_add(holdTimeNs, std::memory_order_relaxed);
+        updateMax(maxHoldTimeNs_, holdTimeNs);
+    }
+
+private:
+    friend class LockProfiler;
+
+    static void updateMax(std::atomic<std::uint64_t>& max, std::uint64_t value)
+    {
+        auto current = max.load(std::memory_order_relaxed);
+        while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+private:
+    enum State { FREE, CLAIMED, READY };
+
+    std::atomic<int>            state_ { FREE };
+    const char                 *file_ = nullptr;
+    const char                 *name_ = nullptr;
+
+    std::atomic<std::uint64_t>  acquisitionCount_ { 0 };
+    std::atomic<std::uint64_t>  contentionCount_ { 0 };
+    std::atomic<std::uint64_t>  totalWaitTimeNs_ { 0 };
+    std::atomic<std::uint64_t>  maxWaitTimeNs_ { 0 };
+    std::atomic<std::uint64_t>  totalHoldTimeNs_ { 0 };
+    std::atomic<std::uint64_t>  maxHoldTimeNs_ { 0 };
+};
+
+/**
+ * @brief Mutex wrapper recording acquisitions, contention, wait and hold times of the wrapped mutex
+ * to its @c LockProfiler entry.
+ *
+ * Meets the Lockable requirements, so it works with @c std::unique_lock and @c std::condition_variable_any.
+ * The clock is read only when the lock is contended and around the outermost hold of the owner.
+ */
+template<typename Mutex>
+class ProfiledMutex {
+public:
+    ProfiledMutex(const char *file, const char *name)
+        : entry_(LockProfiler::getEntry(file, name)) {}
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock()
+    {
+        if (mutex_.try_lock()) {
+            onLocked(false, 0);
+            return;
+        }
+
+        auto waitStart = clock_t::now();
+        mutex_.lock();
+        onLocked(true, toNs(clock_t::now() - waitStart));
+    }
+
+    bool try_lock()
+    {
+        if (mutex_.try_lock()) {
+            onLocked(false, 0);
+            return true;
+        }
+        return false;
+    }
+
+    void unlock()
+    {
+        if (!--holdDepth_) {
+            entry_.onReleased(toNs(clock_t::now() - acquiredAt_));
+        }
+        mutex_.unlock();
+    }
+
+private:
+    typedef std::chrono::steady_clock clock_t;
+
+    static std::uint64_t toNs(clock_t::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    void onLocked(bool isContended, std::uint64_t waitTimeNs)
+    {
+        /*
+         * Only the outermost acquisition of a recursive mutex is accounted.
+         */
+        if (!holdDepth_++) {
+            acquiredAt_ = clock_t::now();
+            entry_.onAcquired(isContended, waitTimeNs);
+        }
+    }
+
+private:
+    Mutex                  mutex_;
+    LockProfiler::Entry&   entry_;
+
+    /*
+     * Accessed by the owner only.
+     */
+    std::size_t            holdDepth_ = 0;
+    clock_t::time_point    acquiredAt_;
+};
+
+} /* namespace kaa */
+
+#endif /* LOCKPROFILER_HPP_ */
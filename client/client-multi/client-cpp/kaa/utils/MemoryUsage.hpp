@@ -0,0 +1,46 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MEMORYUSAGE_HPP_
+#define MEMORYUSAGE_HPP_
+
+#include <cstddef>
+
+namespace kaa {
+
+/**
+ * @brief Memory held by subsystems of a Kaa client, in bytes.
+ *
+ * Subsystems count their data as it is added and removed, so reading the usage is cheap.
+ * Sizes are of payloads plus a fixed per-element overhead, allocator overhead isn't counted.
+ */
+struct MemoryUsage {
+    std::size_t logStorage_ = 0;        ///< Log records kept in memory by the log storage
+    std::size_t pendingEvents_ = 0;     ///< Outgoing events waiting for a sync
+    std::size_t notifications_ = 0;     ///< Received notifications waiting for dispatch to listeners
+    std::size_t channelBuffers_ = 0;    ///< Send and receive buffers of data channels
+    std::size_t executorQueues_ = 0;    ///< Tasks waiting in executor queues, estimated by their count
+
+    std::size_t getTotal() const
+    {
+        return logStorage_ + pendingEvents_ + notifications_ + channelBuffers_ + executorQueues_;
+    }
+};
+
+} /* namespace kaa */
+
+#endif /* MEMORYUSAGE_HPP_ */
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPSCQUEUE_HPP_
+#define MPSCQUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace kaa {
+
+/**
+ * @brief Lock-free multi-producer single-consumer queue.
+ *
+ * Producers add elements with a single atomic operation. The consumer takes all queued elements
+ * at once and processes them in the order they were added.
+ */
+template<class T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(nullptr) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue()
+    {
+        deleteNodes(head_.exchange(nullptr));
+    }
+
+    /**
+     * @brief Adds an element to the queue. May be called from any thread.
+     *
+     * @return @c true if the queue was empty before the element was added.
+     */
+    bool push(T&& value)
+    {
+        Node *node = new Node(std::move(value));
+        node->next_ = head_.load(std::memory_order_relaxed);
+
+        while (!head_.compare_exchange_weak(node->next_, node, std::memory_order_release, std::memory_order_relaxed));
+
+        return !node->next_;
+    }
+
+    /**
+     * @brief Takes all queued elements and passes them one by one to the consumer in the order
+     * they were added. Must not be called concurrently from several threads.
+     *
+     * If the consumer throws, the rest of the taken elements are dropped.
+     *
+     * @return The number of consumed elements.
+     */
+    template<class Consumer>
+    std::size_t consumeAll(Consumer&& consumer)
+    {
+        Node *node = reverse(head_.exchange(nullptr, std::memory_order_acquire));
+
+        std::size_t count = 0;
+        try {
+            while (node) {
+                Node *next = node->next_;
+                consumer(std::move(node->value_));
+                delete node;
+                node = next;
+                ++count;
+            }
+        } catch (...) {
+            deleteNodes(node);
+            throw;
+        }
+
+        return count;
+    }
+
+    bool empty() const
+    {
+        return !head_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Node {
+        Node(T&& value) : value_(std::move(value)) {}
+
+        T     value_;
+        Node *next_ = nullptr;
+    };
+
+    static Node *reverse(Node *node)
+    {
+        Node *reversed = nullptr;
+        while (node) {
+            Node *next = node->next_;
+            node->next_ = reversed;
+            reversed = node;
+            node = next;
+        }
+        return reversed;
+    }
+
+    static void deleteNodes(Node *node)
+    {
+        while (node) {
+            Node *next = node->next_;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    std::atomic<Node *> head_;
+};
+
+} /* namespace kaa */
+
+#endif /* MPSCQUEUE_HPP_ */
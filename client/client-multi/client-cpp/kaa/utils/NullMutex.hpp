@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NULLMUTEX_HPP_
+#define NULLMUTEX_HPP_
+
+#include <atomic>
+#include <thread>
+#include <cassert>
+
+namespace kaa {
+
+/**
+ * @brief Mutex which doesn't lock, the SDK's mutexes in the single-threaded build
+ * (@c KAA_WITH_SINGLE_THREAD). Locking it again from the same thread is allowed,
+ * so it replaces recursive mutexes as well.
+ *
+ * Debug builds assert that the mutex is only locked from the thread which locked it first,
+ * i.e. that the object it guards isn't used from other threads.
+ */
+class NullMutex {
+public:
+    NullMutex() = default;
+
+    NullMutex(const NullMutex&) = delete;
+    NullMutex& operator=(const NullMutex&) = delete;
+
+    void lock()
+    {
+        checkOwnerThread();
+    }
+
+    bool try_lock()
+    {
+        checkOwnerThread();
+        return true;
+    }
+
+    void unlock() {}
+
+private:
+#ifdef NDEBUG
+    void checkOwnerThread() {}
+#else
+    void checkOwnerThread()
+    {
+        const std::thread::id currentThread = std::this_thread::get_id();
+        std::thread::id ownerThread;
+
+        if (!ownerThread_.compare_exchange_strong(ownerThread, currentThread)) {
+            assert(ownerThread == currentThread && "Kaa SDK built without threads is used from several threads");
+        }
+    }
+
+private:
+    std::atomic<std::thread::id>    ownerThread_ { std::thread::id() };
+#endif
+};
+
+} /* namespace kaa */
+
+#endif /* NULLMUTEX_HPP_ */
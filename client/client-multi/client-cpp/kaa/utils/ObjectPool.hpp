@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "kaa/KaaThread.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Process-wide pool of recycled objects of type @c T, so objects built for every message
+ * keep the capacity of their buffers (strings, vectors) and steady-state messaging doesn't allocate.
+ *
+ * Objects are pooled by value: @c acquire() moves a released object out of the pool, @c release()
+ * moves it back. A recycled object keeps its old content, the acquirer should overwrite all fields.
+ *
+ * Each thread has a cache of up to @c THREAD_CACHE_SIZE objects, which is accessed without locks.
+ * Objects move between thread caches in batches through a shared pool of up to @c SHARED_POOL_SIZE
+ * objects, so objects released by a consumer thread are reused by a producer thread. Objects beyond
+ * these limits are destroyed.
+ *
+ * Thread safe.
+ */
+template<class T>
+class ObjectPool {
+public:
+    static const std::size_t THREAD_CACHE_SIZE = 32;
+    static const std::size_t SHARED_POOL_SIZE = 256;
+
+    /**
+     * @return A released object or a default-constructed one if the pool is empty.
+     */
+    static T acquire()
+    {
+        auto& cache = getThreadCache().objects_;
+
+        if (cache.empty()) {
+            getSharedPool().take(cache, THREAD_CACHE_SIZE / 2);
+            if (cache.empty()) {
+                return T();
+            }
+        }
+
+        T object(std::move(cache.back()));
+        cache.pop_back();
+        return object;
+    }
+
+    /**
+     * @brief Returns the object to the pool.
+     */
+    static void release(T&& object)
+    {
+        auto& cache = getThreadCache().objects_;
+
+        if (cache.size() >= THREAD_CACHE_SIZE) {
+            getSharedPool().give(cache, THREAD_CACHE_SIZE / 2);
+        }
+
+        cache.push_back(std::move(object));
+    }
+
+    /**
+     * @return The number of objects cached by the calling thread.
+     */
+    static std::size_t getThreadCacheSize()
+    {
+        return getThreadCache().objects_.size();
+    }
+
+    /**
+     * @return The number of objects in the shared pool.
+     */
+    static std::size_t getSharedPoolSize()
+    {
+        return getSharedPool().getSize();
+    }
+
+private:
+    class SharedPool {
+    public:
+        SharedPool() { objects_.reserve(SHARED_POOL_SIZE); }
+
+        /*
+         * Moves up to @c count objects to the thread cache.
+         */
+        void take(std::vector<T>& cache, std::size_t count)
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+            while (count-- && !objects_.empty()) {
+                cache.push_back(std::move(objects_.back()));
+                objects_.pop_back();
+            }
+        }
+
+        /*
+         * Moves @c count objects from the thread cache, the ones not fitting the pool are destroyed.
+         */
+        void give(std::vector<T>& cache, std::size_t count)
+        {
+            {
+                KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+
+                while (count && !cache.empty() && objects_.size() < SHARED_POOL_SIZE) {
+                    objects_.push_back(std::move(cache.back()));
+                    cache.pop_back();
+                    --count;
+                }
+            }
+
+            while (count-- && !cache.empty()) {
+                cache.pop_back();
+            }
+        }
+
+        std::size_t getSize()
+        {
+            KAA_MUTEX_UNIQUE_DECLARE(poolLock, poolGuard_);
+            return objects_.size();
+        }
+
+    private:
+        std::vector<T>    objects_;
+        KAA_MUTEX_DECLARE(poolGuard_);
+    };
+
+    struct ThreadCache {
+        ThreadCache() { objects_.reserve(THREAD_CACHE_SIZE); }
+
+        /*
+         * Objects cached by an exiting thread are left to other threads.
+         */
+        ~ThreadCache() { getSharedPool().give(objects_, objects_.size()); }
+
+        std::vector<T>    objects_;
+    };
+
+    static SharedPool& getSharedPool()
+    {
+        /*
+         * Never destroyed: thread caches may be flushed after static destructors have run.
+         */
+        static SharedPool *pool = new SharedPool;
+        return *pool;
+    }
+
+    static ThreadCache& getThreadCache()
+    {
+        static kaa_thread_local ThreadCache cache;
+        return cache;
+    }
+};
+
+template<class T> const std::size_t ObjectPool<T>::THREAD_CACHE_SIZE;
+template<class T> const std::size_t ObjectPool<T>::SHARED_POOL_SIZE;
+
+} /* namespace kaa */
+
+#endif /* OBJECTPOOL_HPP_ */
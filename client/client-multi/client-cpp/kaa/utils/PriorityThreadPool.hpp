@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PRIORITYTHREADPOOL_HPP_
+#define PRIORITYTHREADPOOL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/utils/IThreadPool.hpp"
+
+namespace kaa {
+
+struct PrioritySchedulingSettings {
+    /**
+     * A pending task gains one priority for each interval it waits, so tasks of low priorities
+     * aren't starved. Zero disables aging.
+     */
+    std::chrono::milliseconds    agingInterval_ = std::chrono::milliseconds(200);
+
+    /**
+     * The maximum count of tasks run in a row by aging ahead of pending tasks of higher priorities.
+     */
+    std::size_t                  maxAgedSlice_ = 4;
+};
+
+/**
+ * @brief Pool of one worker running tasks by priority, 0 is the highest one.
+ *
+ * Tasks are added through the executor of their priority (see @c getExecutor()). The worker takes the
+ * oldest of the tasks with the highest effective priority, i.e. the priority raised by aging. Tasks of
+ * one priority run in the order they were added.
+ *
+ * Shutting down any of the executors shuts down the whole pool.
+ */
+class PriorityThreadPool {
+public:
+    /**
+     * @throw std::invalid_argument Zero priority count or zero aged slice.
+     */
+    PriorityThreadPool(std::size_t priorityCount,
+                       const PrioritySchedulingSettings& settings = PrioritySchedulingSettings());
+    ~PriorityThreadPool();
+
+    /**
+     * @throw std::out_of_range No such priority.
+     */
+    IThreadPool& getExecutor(std::size_t priority);
+
+    /**
+     * @see IThreadPool::awaitTermination()
+     */
+    void awaitTermination(std::size_t seconds);
+
+    void shutdown();
+    void shutdownNow();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    class Executor;
+
+    struct PendingTask {
+        PendingTask(const ThreadPoolTask& task, Clock::time_point addedTime)
+            : task_(task), addedTime_(addedTime) {}
+
+        ThreadPoolTask       task_;
+        Clock::time_point    addedTime_;
+    };
+
+    struct TaskQueue {
+        std::deque<PendingTask>    tasks_;
+        TaskQueueMetrics           metrics_;
+    };
+
+    enum class State {
+        CREATED,
+        RUNNING,
+        PENDING_SHUTDOWN,
+        STOPPED,
+    };
+
+    void add(std::size_t priority, const ThreadPoolTask& task);
+    TaskQueueMetrics getQueueMetrics(std::size_t priority);
+
+    void start();
+    void run();
+    bool hasTasks() const;
+
+    /*
+     * Call with the pool locked and some task pending.
+     */
+    std::size_t selectQueue(Clock::time_point now);
+
+private:
+    const PrioritySchedulingSettings    settings_;
+
+    std::vector<TaskQueue>                    queues_;
+    std::vector<std::unique_ptr<Executor>>    executors_;
+
+    /* Tasks run in a row ahead of the highest pending priority. */
+    std::size_t    agedSliceCount_ = 0;
+
+    State          state_ = State::CREATED;
+    std::thread    worker_;
+
+    KAA_MUTEX_DECLARE(poolGuard_);
+    KAA_CONDITION_VARIABLE    onPoolEvent_;
+};
+
+} /* namespace kaa */
+
+#endif /* PRIORITYTHREADPOOL_HPP_ */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RANDOMGENERATOR_HPP_
+#define RANDOMGENERATOR_HPP_
+
+#include <cstdint>
+#include <limits>
+
+namespace kaa {
+
+/**
+ * @brief Fast pseudo-random number generator (xoshiro256**) for ids, jitter and shuffling.
+ *
+ * Meets the standard UniformRandomBitGenerator requirements, so it can be passed to @c std::shuffle
+ * and to the standard distributions.
+ *
+ * @link getThreadGenerator() @endlink returns the generator of the calling thread. It is seeded once,
+ * on first use, and then produces numbers without locks and memory allocations.
+ *
+ * Not suitable for cryptographic purposes.
+ */
+class RandomGenerator {
+public:
+    typedef std::uint64_t result_type;
+
+    /**
+     * Creates the generator whose sequence is fully defined by the seed.
+     */
+    explicit RandomGenerator(std::uint64_t seed);
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotateLeft(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotateLeft(state_[3], 45);
+
+        return result;
+    }
+
+    /**
+     * @return The generator owned by the calling thread.
+     */
+    static RandomGenerator& getThreadGenerator();
+
+    /**
+     * @return A random 32-bit integer from the generator of the calling thread.
+     */
+    static std::int32_t generateInt()
+    {
+        return static_cast<std::int32_t>(getThreadGenerator()() >> 32);
+    }
+
+    /**
+     * @return A seed which differs from the previous ones even if @c std::random_device isn't available:
+     * the entropy is mixed with a process-wide counter and the current time.
+     */
+    static std::uint64_t generateSeed();
+
+private:
+    static std::uint64_t rotateLeft(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+private:
+    std::uint64_t state_[4];
+};
+
+} /* namespace kaa */
+
+#endif /* RANDOMGENERATOR_HPP_ */
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RINGQUEUE_HPP_
+#define RINGQUEUE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kaa {
+
+/**
+ * @brief FIFO queue over a ring of preallocated slots.
+ *
+ * Elements are moved into the slots, so adding and taking an element allocate nothing. The ring doubles when
+ * it is full and never shrinks, so a queue which has reached its working depth allocates no more.
+ *
+ * Each element is addressed by its sequence number, which stays valid until the element is taken, the ring
+ * growth including. Not thread-safe. @c T must be default-constructible and move-assignable.
+ */
+template<class T>
+class RingQueue {
+public:
+    typedef std::uint64_t Sequence;
+
+    static const std::size_t DEFAULT_CAPACITY = 64;
+
+    /**
+     * @param[in] capacity    The initial capacity, rounded up to a power of two.
+     */
+    explicit RingQueue(std::size_t capacity = DEFAULT_CAPACITY)
+        : slots_(roundUpCapacity(capacity)) {}
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    /**
+     * @return The sequence number of the element.
+     */
+    Sequence push(T&& value)
+    {
+        if (size() == slots_.size()) {
+            grow();
+        }
+
+        slots_[slotIndex(tail_)] = std::move(value);
+        return tail_++;
+    }
+
+    T& front() { return slots_[slotIndex(head_)]; }
+
+    /**
+     * @brief Removes the first element. Its slot is reset, so resources the element holds are released now.
+     */
+    void pop()
+    {
+        slots_[slotIndex(head_)] = T();
+        ++head_;
+    }
+
+    /**
+     * @return The queued element with the sequence number.
+     */
+    T& at(Sequence sequence) { return slots_[slotIndex(sequence)]; }
+
+    bool contains(Sequence sequence) const { return sequence >= head_ && sequence < tail_; }
+
+    void clear()
+    {
+        while (!empty()) {
+            pop();
+        }
+    }
+
+    std::size_t size() const { return static_cast<std::size_t>(tail_ - head_); }
+    bool empty() const { return head_ == tail_; }
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    static std::size_t roundUpCapacity(std::size_t capacity)
+    {
+        std::size_t roundedCapacity = 1;
+        while (roundedCapacity < capacity) {
+            roundedCapacity <<= 1;
+        }
+        return roundedCapacity;
+    }
+
+    std::size_t slotIndex(Sequence sequence) const
+    {
+        return static_cast<std::size_t>(sequence) & (slots_.size() - 1);
+    }
+
+    /*
+     * An element keeps its sequence number, the slot index is taken with the new mask.
+     */
+    void grow()
+    {
+        std::vector<T> slots(2 * slots_.size());
+        for (Sequence sequence = head_; sequence != tail_; ++sequence) {
+            slots[static_cast<std::size_t>(sequence) & (slots.size() - 1)] = std::move(slots_[slotIndex(sequence)]);
+        }
+        slots_.swap(slots);
+    }
+
+private:
+    std::vector<T>    slots_;
+    Sequence          head_ = 0;
+    Sequence          tail_ = 0;
+};
+
+template<class T>
+const std::size_t RingQueue<T>::DEFAULT_CAPACITY;
+
+} /* namespace kaa */
+
+#endif /* RINGQUEUE_HPP_ */
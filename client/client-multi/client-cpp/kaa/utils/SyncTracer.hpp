@@ -0,0 +1,165 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SYNCTRACER_HPP_
+#define SYNCTRACER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace kaa {
+
+/**
+ * @brief Stages a sync request goes through, in order.
+ */
+enum class SyncTraceStage : std::uint8_t {
+    QUEUE,      ///< Waiting to be compiled, e.g. while the channel's window of in-flight requests is full
+    COMPILE,    ///< Multiplexing of transport sections into the Avro sync request
+    ENCRYPT,    ///< Compression and encryption of the request
+    NETWORK,    ///< From sending the request to receiving its response
+    DECRYPT,    ///< Decryption and decompression of the response
+    PROCESS     ///< Demultiplexing of the response to the transports
+};
+
+/**
+ * @brief Timing of one stage of a sync request.
+ */
+struct SyncTraceSpan {
+    std::int32_t requestId_ = 0;            ///< Id of the sync request, zero if the stage failed before it was known
+    SyncTraceStage stage_ = SyncTraceStage::QUEUE;
+    const char *channelId_ = nullptr;       ///< Null for stages outside channels, valid only during the export
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+/**
+ * @brief Receives spans of sync requests, e.g. to forward them to OpenTelemetry.
+ *
+ * Spans are reported on SDK I/O threads right after each stage, so the exporter should only
+ * queue them.
+ */
+class ISyncTraceExporter {
+public:
+    virtual void onSpan(const SyncTraceSpan& span) = 0;
+
+    virtual ~ISyncTraceExporter() {}
+};
+
+/**
+ * @brief Process-wide hub of sync tracing.
+ *
+ * Spans are recorded only if the SDK is built with @c KAA_WITH_SYNC_TRACING and an exporter is set,
+ * otherwise tracing costs nothing. With an exporter a stage costs two clock reads and the exporter call.
+ */
+class SyncTracer {
+public:
+    /**
+     * @brief Sets the exporter of spans, null stops tracing.
+     *
+     * The exporter isn't owned and must outlive all Kaa clients which may still report spans to it.
+     */
+    static void setExporter(ISyncTraceExporter *exporter);
+
+    static bool isEnabled()
+    {
+        return exporter_.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    static void record(const SyncTraceSpan& span);
+
+    static void record(SyncTraceStage stage, std::int32_t requestId, const char *channelId,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        if (isEnabled()) {
+            SyncTraceSpan span;
+            span.requestId_ = requestId;
+            span.stage_ = stage;
+            span.channelId_ = channelId;
+            span.start_ = start;
+            span.end_ = end;
+            record(span);
+        }
+    }
+
+    /**
+     * @brief Remembers the id of the sync request compiled by the calling thread, so that
+     * the channel which sends it can report the next stages under the same id.
+     */
+    static void setCurrentRequestId(std::int32_t requestId);
+    static std::int32_t getCurrentRequestId();
+
+    static const char *toString(SyncTraceStage stage);
+
+private:
+    static std::atomic<ISyncTraceExporter *> exporter_;
+};
+
+/**
+ * @brief Reports the span of a stage which lasts until the end of the scope.
+ */
+class SyncTraceScope {
+public:
+    SyncTraceScope(SyncTraceStage stage, std::int32_t requestId, const char *channelId)
+        : isEnabled_(SyncTracer::isEnabled())
+    {
+        if (isEnabled_) {
+            span_.requestId_ = requestId;
+            span_.stage_ = stage;
+            span_.channelId_ = channelId;
+            span_.start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~SyncTraceScope()
+    {
+        if (isEnabled_) {
+            span_.end_ = std::chrono::steady_clock::now();
+            SyncTracer::record(span_);
+        }
+    }
+
+    void setRequestId(std::int32_t requestId) { span_.requestId_ = requestId; }
+
+    SyncTraceScope(const SyncTraceScope&) = delete;
+    SyncTraceScope& operator=(const SyncTraceScope&) = delete;
+
+private:
+    const bool isEnabled_;
+    SyncTraceSpan span_;
+};
+
+} /* namespace kaa */
+
+/*
+ * Tracing hooks, they compile to nothing unless the SDK is built with KAA_WITH_SYNC_TRACING.
+ */
+#ifdef KAA_USE_SYNC_TRACING
+#define KAA_SYNC_TRACE_SCOPE(name, stage, requestId, channelId) \
+    kaa::SyncTraceScope name(kaa::SyncTraceStage::stage, requestId, channelId)
+#define KAA_SYNC_TRACE_SET_REQUEST_ID(name, requestId)          name.setRequestId(requestId)
+#define KAA_SYNC_TRACE_SET_CURRENT_REQUEST_ID(requestId)        kaa::SyncTracer::setCurrentRequestId(requestId)
+#define KAA_SYNC_TRACE_RECORD(stage, requestId, channelId, start, end) \
+    kaa::SyncTracer::record(kaa::SyncTraceStage::stage, requestId, channelId, start, end)
+#else
+#define KAA_SYNC_TRACE_SCOPE(name, stage, requestId, channelId)
+#define KAA_SYNC_TRACE_SET_REQUEST_ID(name, requestId)
+#define KAA_SYNC_TRACE_SET_CURRENT_REQUEST_ID(requestId)
+#define KAA_SYNC_TRACE_RECORD(stage, requestId, channelId, start, end)
+#endif
+
+#endif /* SYNCTRACER_HPP_ */
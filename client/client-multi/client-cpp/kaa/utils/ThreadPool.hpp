@@ -19,21 +19,41 @@
 
 #include <atomic>
 #include <cstddef>
+#include <list>
 #include <thread>
+#include <unordered_map>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/utils/IThreadPool.hpp"
+#include "kaa/utils/RingQueue.hpp"
 
 namespace kaa {
 
+/**
+ * @brief Thread pool with a shared task queue.
+ *
+ * Tasks are kept in a ring of preallocated slots, which is sized by the queue limit, if any, and grows when
+ * it is full. A task added as an rvalue is moved into its slot, so passing a task from an I/O thread to
+ * the workers allocates nothing beyond the @c std::function itself.
+ */
 class ThreadPool : public IThreadPool {
     friend class Worker;
 
 public:
-    ThreadPool(std::size_t workerCount = DEFAULT_WORKER_NUMBER);
+    /**
+     * @param[in] queueSettings    The task queue limit. The limit isn't applied to tasks added by the pool's
+     *                             own workers, so a task adding tasks can't block the pool forever.
+     */
+    ThreadPool(std::size_t workerCount = DEFAULT_WORKER_NUMBER,
+               const ThreadPoolWorkerInitializer& workerInitializer = ThreadPoolWorkerInitializer(),
+               const TaskQueueSettings& queueSettings = TaskQueueSettings());
     ~ThreadPool();
 
+    using IThreadPool::add;
     virtual void add(const ThreadPoolTask& task);
+    virtual void addCoalescing(TaskCoalescingKey key, const ThreadPoolTask& task);
+
+    virtual TaskQueueMetrics getQueueMetrics();
 
     virtual void awaitTermination(std::size_t seconds);
 
@@ -48,6 +68,10 @@ private:
     void stop();
     void forceStop();
     void waitForWorkersShutdown();
+    virtual void addMoved(ThreadPoolTask&& task);
+
+    void doAdd(TaskCoalescingKey key, ThreadPoolTask&& task);
+    void makeRoom(KAA_MUTEX_UNIQUE& tasksLock);
 
     enum class State {
         CREATED,
@@ -61,11 +85,26 @@ private:
 
     std::list<std::thread>    workers_;
     std::size_t               workerCount_ = 0;
+    ThreadPoolWorkerInitializer    workerInitializer_;
+
+    struct PendingTask {
+        PendingTask() = default;
+        PendingTask(TaskCoalescingKey key, ThreadPoolTask&& task)
+            : key_(key), task_(std::move(task)) {}
+
+        TaskCoalescingKey    key_ = nullptr;
+        ThreadPoolTask       task_;
+    };
+
+    RingQueue<PendingTask>    tasks_;
 
-    std::list<ThreadPoolTask>    tasks_;
+    const TaskQueueSettings                                                     queueSettings_;
+    std::unordered_map<TaskCoalescingKey, RingQueue<PendingTask>::Sequence>    coalescingTasks_;
+    TaskQueueMetrics                                                            queueMetrics_;
 
     KAA_MUTEX_DECLARE(threadPoolGuard_);
     KAA_CONDITION_VARIABLE    onThreadpoolEvent_;
+    KAA_CONDITION_VARIABLE    onTaskTaken_;
 };
 
 } /* namespace kaa */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THREADSETTINGS_HPP_
+#define THREADSETTINGS_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace kaa {
+
+/**
+ * @brief Scheduling policies of threads, see sched(7).
+ */
+enum class ThreadSchedulingPolicy {
+    INHERIT,        ///< The policy and the priority of the creating thread are kept.
+    OTHER,          ///< SCHED_OTHER, the priority is a nice value.
+    BATCH,          ///< SCHED_BATCH, the priority is a nice value.
+    IDLE,           ///< SCHED_IDLE, the priority is ignored.
+    FIFO,           ///< SCHED_FIFO, the priority is a real-time priority.
+    ROUND_ROBIN     ///< SCHED_RR, the priority is a real-time priority.
+};
+
+/**
+ * @brief Settings applied to each thread of a thread pool.
+ */
+struct ThreadSettings {
+    /**
+     * CPUs the thread may run on. If empty, the affinity of the creating thread is kept.
+     */
+    std::vector<std::size_t> cpus_;
+
+    ThreadSchedulingPolicy policy_ = ThreadSchedulingPolicy::INHERIT;
+
+    /**
+     * The nice value (-20..19) for @c OTHER and @c BATCH policies or the real-time priority
+     * for @c FIFO and @c ROUND_ROBIN ones.
+     */
+    int priority_ = 0;
+
+    /**
+     * Thread name prefix, the index of the worker is appended. If empty, the name isn't changed.
+     * Names are truncated to 15 characters.
+     */
+    std::string name_;
+};
+
+/**
+ * @brief Checks the settings can be applied on this platform.
+ *
+ * @throw KaaException Unknown CPU or priority out of the range of the policy.
+ */
+void validateThreadSettings(const ThreadSettings& settings);
+
+/**
+ * @brief Applies the settings to the calling thread.
+ *
+ * Settings the process isn't permitted to apply (e.g. real-time policies without CAP_SYS_NICE) are skipped.
+ * Supported on Linux only, elsewhere nothing is changed.
+ *
+ * @return @c true if all settings have been applied.
+ */
+bool applyThreadSettings(const ThreadSettings& settings, std::size_t workerIndex);
+
+} /* namespace kaa */
+
+#endif /* THREADSETTINGS_HPP_ */
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TIMERSERVICE_HPP_
+#define TIMERSERVICE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace kaa {
+
+/**
+ * @brief Process-wide service which runs the callbacks of all timers on a single thread.
+ *
+ * Timers are kept ordered by their deadlines on @c std::chrono::steady_clock, so changes of
+ * the wall clock don't affect them. Callbacks are run one by one and should return quickly,
+ * as a blocked callback delays all other timers.
+ *
+ * By default callbacks are run by the service thread started on the first @c schedule().
+ * Once a poller is attached, the service has no thread and callbacks are run by @c runExpired().
+ * The single-threaded build (@c KAA_WITH_SINGLE_THREAD) never starts the thread: timers wait
+ * for a poller to be attached.
+ *
+ * Thread safe.
+ */
+class TimerService {
+public:
+    typedef std::chrono::steady_clock                          Clock;
+    typedef std::pair<Clock::time_point, std::uint64_t>        TimerHandle;
+    typedef std::function<void ()>                             Callback;
+
+    /**
+     * @brief Returns the service shared by all timers of the process.
+     */
+    static TimerService& getInstance();
+
+    /**
+     * @brief Schedules the callback to be run at the deadline.
+     *
+     * @param[in] owner    The object the callback belongs to, see @c waitForCallbacks().
+     *
+     * @return The handle to cancel the timer with.
+     */
+    TimerHandle schedule(Clock::time_point deadline, const Callback& callback, const void *owner = nullptr);
+
+    /**
+     * @brief Cancels the timer if its callback hasn't been run yet.
+     *
+     * @return @c true if the timer was cancelled before its callback was run.
+     */
+    bool cancel(const TimerHandle& handle);
+
+    /**
+     * @brief Waits until a callback of the owner returns if one is being run.
+     * Returns at once if called from a timer callback.
+     */
+    void waitForCallbacks(const void *owner);
+
+    /**
+     * @brief Makes the service run callbacks only from @c runExpired() calls.
+     *
+     * @param[in] onEarliestChanged    Called when a timer with the earliest deadline is scheduled,
+     *                                 so the poller can shorten its wait. May be called from any thread.
+     *
+     * @return @c false if the service thread has already been started or another poller is attached.
+     */
+    bool attachPoller(const Callback& onEarliestChanged);
+
+    /**
+     * @brief Detaches the poller, pending timers are run by the service thread from now on
+     * (by the next poller in the single-threaded build).
+     */
+    void detachPoller();
+
+    /**
+     * @brief Runs callbacks of the timers expired by now on the calling thread.
+     *
+     * @return The number of callbacks run.
+     *
+     * @throw std::logic_error No poller is attached.
+     */
+    std::size_t runExpired();
+
+    /**
+     * @return The earliest deadline of scheduled timers or @c Clock::time_point::max() if there are none.
+     */
+    Clock::time_point getNextDeadline();
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+private:
+    TimerService() = default;
+
+    void run();
+    void startThread();
+
+private:
+    struct Timer {
+        Callback      callback_;
+        const void    *owner_;
+    };
+
+    typedef std::map<TimerHandle, Timer> Timers;
+
+    /*
+     * Runs the callback of the timer and removes the timer. Called with the lock held,
+     * which is released while the callback runs.
+     */
+    void runCallback(std::unique_lock<std::mutex>& serviceLock, Timers::iterator it);
+
+private:
+    Timers           timers_;
+    std::uint64_t    nextTimerId_ = 0;
+
+    /*
+     * The owner of the callback being run, if any.
+     */
+    const void    *runningOwner_ = nullptr;
+    bool          isCallbackRunning_ = false;
+
+    std::thread::id    callbackThreadId_;
+
+    bool        isPolled_ = false;
+    Callback    onEarliestChanged_;
+
+    std::thread::id            serviceThreadId_;
+    std::mutex                 serviceGuard_;
+    std::condition_variable    onTimersChanged_;
+    std::condition_variable    onCallbackFinished_;
+};
+
+} /* namespace kaa */
+
+#endif /* TIMERSERVICE_HPP_ */
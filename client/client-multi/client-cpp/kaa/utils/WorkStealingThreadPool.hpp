@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WORKSTEALINGTHREADPOOL_HPP_
+#define WORKSTEALINGTHREADPOOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/utils/IThreadPool.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Thread pool where each worker has its own task queue and steals tasks from the others when idle.
+ *
+ * Tasks added from outside the pool are spread over the workers in round-robin order, tasks added from
+ * a worker go to its own queue. Queues are ring buffers of task slots reused after the tasks are taken,
+ * so adding a small callable (the one @c std::function stores inline) doesn't allocate memory.
+ *
+ * An idle worker spins for a while looking for tasks before it parks until a task is added.
+ * Tasks of one queue are executed in the order they are added, but there is no order across queues.
+ */
+class WorkStealingThreadPool : public IThreadPool {
+public:
+    WorkStealingThreadPool(std::size_t workerCount = DEFAULT_WORKER_NUMBER,
+                           const ThreadPoolWorkerInitializer& workerInitializer = ThreadPoolWorkerInitializer());
+    ~WorkStealingThreadPool();
+
+    virtual void add(const ThreadPoolTask& task);
+
+    virtual void awaitTermination(std::size_t seconds);
+
+    virtual void shutdown();
+    virtual void shutdownNow();
+
+public:
+    static const std::size_t DEFAULT_WORKER_NUMBER = 1;
+
+private:
+    class TaskQueue;
+
+    void start();
+    void run(std::size_t workerIndex);
+    bool takeTask(std::size_t workerIndex, ThreadPoolTask& task);
+    void park();
+    void onTaskTaken();
+    void waitForWorkersShutdown();
+
+    enum class State {
+        CREATED,
+        RUNNING,
+        PENDING_SHUTDOWN,
+        STOPPED,
+    };
+
+private:
+    std::atomic<State> state_;
+
+    const std::size_t                            workerCount_;
+    const ThreadPoolWorkerInitializer            workerInitializer_;
+    std::vector<std::unique_ptr<TaskQueue>>      queues_;
+    std::vector<std::thread>                     workers_;
+
+    std::atomic<std::size_t>    nextQueue_;
+
+    /*
+     * Tasks added, but not taken by workers yet.
+     */
+    std::atomic<std::size_t>    pendingTaskCount_;
+    std::atomic<std::size_t>    parkedWorkerCount_;
+
+    KAA_MUTEX_DECLARE(threadPoolGuard_);
+    KAA_CONDITION_VARIABLE    onTaskAdded_;
+    KAA_CONDITION_VARIABLE    onTasksTaken_;
+
+    static const std::size_t IDLE_SPIN_COUNT = 64;
+    static const std::size_t INITIAL_QUEUE_CAPACITY = 64;
+};
+
+} /* namespace kaa */
+
+#endif /* WORKSTEALINGTHREADPOOL_HPP_ */
@@ -17,6 +17,124 @@
 #define BOOST_TEST_MODULE "MAIN_KAA_TEST_MODULE"
 #include <boost/test/unit_test.hpp>
 
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <sys/resource.h>
+
+#include "headers/AllocationCounter.hpp"
+
+#ifdef KAA_TEST_ALLOCATION_COUNTING
+/*
+ * Allocations are counted per thread, so the work of background threads (timers, I/O) doesn't
+ * affect the bounds asserted by tests.
+ */
+static thread_local std::size_t threadAllocationCount = 0;
+
+void *operator new(std::size_t size)
+{
+    ++threadAllocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace kaa {
+
+bool AllocationCounter::isEnabled()
+{
+#ifdef KAA_TEST_ALLOCATION_COUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::size_t AllocationCounter::getThreadAllocationCount()
+{
+#ifdef KAA_TEST_ALLOCATION_COUNTING
+    return threadAllocationCount;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Prints allocations, context switches and block I/O operations of every test case.
+ * Context switches stand for blocking system calls, e.g. waiting on a mutex or a socket.
+ */
+class ResourceUsageObserver : public boost::unit_test::test_observer {
+public:
+    virtual void test_unit_start(const boost::unit_test::test_unit& unit)
+    {
+        if (unit.p_type == boost::unit_test::TUT_CASE) {
+            allocationCount_ = AllocationCounter::getThreadAllocationCount();
+            getrusage(RUSAGE_THREAD, &usage_);
+        }
+    }
+
+    virtual void test_unit_finish(const boost::unit_test::test_unit& unit, unsigned long elapsed)
+    {
+        if (unit.p_type != boost::unit_test::TUT_CASE) {
+            return;
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_THREAD, &usage);
+
+        std::cerr << "[resource usage] " << unit.p_name.get()
+                  << ": allocations " << (AllocationCounter::getThreadAllocationCount() - allocationCount_)
+                  << ", voluntary context switches " << (usage.ru_nvcsw - usage_.ru_nvcsw)
+                  << ", involuntary context switches " << (usage.ru_nivcsw - usage_.ru_nivcsw)
+                  << ", block input " << (usage.ru_inblock - usage_.ru_inblock)
+                  << ", block output " << (usage.ru_oublock - usage_.ru_oublock)
+                  << ", elapsed " << elapsed << " us" << std::endl;
+    }
+
+private:
+    std::size_t     allocationCount_ = 0;
+    struct rusage   usage_;
+};
+
+/*
+ * The report is enabled by the KAA_TEST_RESOURCE_USAGE environment variable.
+ * The observer is registered before the framework starts, so it sees every test case.
+ */
+static struct ResourceUsageReport {
+    ResourceUsageReport()
+    {
+        if (std::getenv("KAA_TEST_RESOURCE_USAGE")) {
+            boost::unit_test::framework::register_observer(observer_);
+            isRegistered_ = true;
+        }
+    }
+
+    ~ResourceUsageReport()
+    {
+        if (isRegistered_) {
+            boost::unit_test::framework::deregister_observer(observer_);
+        }
+    }
+
+    ResourceUsageObserver   observer_;
+    bool                    isRegistered_ = false;
+} resourceUsageReport;
+
+}  // namespace kaa
+
 BOOST_AUTO_TEST_SUITE(SimpleSuite)
 
 BOOST_AUTO_TEST_CASE(SimpleCase)
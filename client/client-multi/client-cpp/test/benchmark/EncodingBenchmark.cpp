@@ -0,0 +1,211 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Benchmark of SyncRequest encoding.
+ *
+ * Usage: kaa_encoding_benchmark [encodings_per_run]
+ *
+ * For each number of log records in a request the benchmark encodes the request through:
+ *  - a std::stringstream copied into a new vector, the way AvroByteArrayConverter used to do it;
+ *  - the generic avro::binaryEncoder() into a reused vector;
+ *  - AvroByteArrayConverter into a new vector;
+ *  - AvroByteArrayConverter into a reused vector;
+ * and reports encodings/s, MB/s and heap allocations per encoding.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include <avro/Encoder.hh>
+#include <avro/Specific.hh>
+#include <avro/Stream.hh>
+
+#include "kaa/gen/EndpointGen.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/AvroVectorOutputStream.hpp"
+
+#define DEFAULT_ENCODINGS_PER_RUN   20000
+#define LOG_RECORD_SIZE             128
+
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+/*
+ * Encodes the request and returns the size of encoded data.
+ */
+typedef std::function<std::size_t (const SyncRequest& request)> EncodeFunction;
+
+static SyncRequest createRequest(std::size_t logRecordCount)
+{
+    SyncRequest request;
+    request.requestId = 1;
+
+    SyncRequestMetaData metaData;
+    metaData.sdkToken = "benchmarkSdkToken";
+    metaData.timeout.set_long(60000);
+    request.syncRequestMetaData.set_SyncRequestMetaData(metaData);
+
+    std::vector<LogEntry> logEntries(logRecordCount);
+    for (auto& logEntry : logEntries) {
+        logEntry.data.assign(LOG_RECORD_SIZE, 0x5A);
+    }
+
+    LogSyncRequest logRequest;
+    logRequest.requestId = 1;
+    logRequest.logEntries.set_array(logEntries);
+    request.logSyncRequest.set_LogSyncRequest(logRequest);
+
+    return request;
+}
+
+/*
+ * Encoding path of AvroByteArrayConverter before encoding directly into the destination vector.
+ */
+static void encodeThroughStringStream(avro::Encoder& encoder, const SyncRequest& request,
+                                      std::vector<std::uint8_t>& dest)
+{
+    std::stringstream ostream;
+    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(ostream);
+
+    encoder.init(*out);
+    avro::encode(encoder, request);
+    encoder.flush();
+
+    std::streampos beg = ostream.tellg();
+    ostream.seekg(0, std::ios_base::end);
+
+    std::streampos end = ostream.tellg();
+    ostream.seekg(0, std::ios_base::beg);
+
+    dest.reserve(end - beg);
+    dest.assign(std::istreambuf_iterator<char>(ostream), std::istreambuf_iterator<char>());
+}
+
+static void runBenchmark(const char *target, std::size_t logRecordCount, std::size_t encodingCount,
+                         const EncodeFunction& encode)
+{
+    SyncRequest request = createRequest(logRecordCount);
+
+    std::size_t encodedSize = encode(request);
+    std::size_t allocationsBefore = allocationCount;
+    auto startTime = BenchmarkClock::now();
+
+    for (std::size_t i = 0; i < encodingCount; ++i) {
+        encode(request);
+    }
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+    std::size_t allocations = allocationCount - allocationsBefore;
+
+    std::printf("%-20s %8zu %10zu %12.0f %10.2f %12.2f\n",
+                target, logRecordCount, encodedSize, encodingCount / elapsedSec,
+                encodingCount * encodedSize / elapsedSec / (1024 * 1024), (double)allocations / encodingCount);
+    std::fflush(stdout);
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::size_t encodingsPerRun = DEFAULT_ENCODINGS_PER_RUN;
+    if (argc > 1) {
+        encodingsPerRun = std::strtoul(argv[1], nullptr, 10);
+        if (!encodingsPerRun) {
+            std::fprintf(stderr, "Usage: %s [encodings_per_run]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::size_t logRecordCounts[] = { 0, 16, 256 };
+
+    std::printf("%-20s %8s %10s %12s %10s %12s\n",
+                "target", "records", "bytes", "encodings/s", "MB/s", "allocs/enc");
+
+    for (auto logRecordCount : logRecordCounts) {
+        avro::EncoderPtr encoder = avro::binaryEncoder();
+        runBenchmark("stringstream", logRecordCount, encodingsPerRun,
+                     [&encoder] (const SyncRequest& request)
+                         {
+                             std::vector<std::uint8_t> encodedData;
+                             encodeThroughStringStream(*encoder, request, encodedData);
+                             return encodedData.size();
+                         });
+
+        std::vector<std::uint8_t> genericData;
+        AvroVectorOutputStream genericStream;
+        runBenchmark("generic encoder", logRecordCount, encodingsPerRun,
+                     [&encoder, &genericData, &genericStream] (const SyncRequest& request)
+                         {
+                             genericData.clear();
+                             encoder->init(genericStream);
+                             genericStream.reset(genericData);
+                             avro::encode(*encoder, request);
+                             encoder->flush();
+                             return genericData.size();
+                         });
+
+        AvroByteArrayConverter<SyncRequest> converter;
+        runBenchmark("converter", logRecordCount, encodingsPerRun,
+                     [&converter] (const SyncRequest& request)
+                         {
+                             std::vector<std::uint8_t> encodedData;
+                             converter.toByteArray(request, encodedData);
+                             return encodedData.size();
+                         });
+
+        std::vector<std::uint8_t> reusedData;
+        runBenchmark("converter (reused)", logRecordCount, encodingsPerRun,
+                     [&converter, &reusedData] (const SyncRequest& request)
+                         {
+                             converter.toByteArray(request, reusedData);
+                             return reusedData.size();
+                         });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Benchmark of incoming event routing.
+ *
+ * Usage: kaa_event_benchmark [events_per_run]
+ *
+ * For each number of registered event families and events per sync response the benchmark
+ * delivers events through:
+ *  - a scan of FQN lists of all families, the way EventManager used to route events;
+ *  - EventManager::onEventsReceived();
+ * and reports events/s and heap allocations per event.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "kaa/event/EventManager.hpp"
+#include "kaa/event/IEventFamily.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/ILogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+#define DEFAULT_EVENTS_PER_RUN      1000000
+#define FQNS_PER_FAMILY             8
+#define EVENT_DATA_SIZE             64
+
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+class NullLogger : public ILogger {
+public:
+    virtual void log(LogLevel level, const char *message) const {}
+};
+
+/*
+ * Counts events, so the delivery isn't optimized away.
+ */
+class CountingEventFamily : public IEventFamily {
+public:
+    CountingEventFamily(std::size_t familyIndex)
+    {
+        for (std::size_t i = 0; i < FQNS_PER_FAMILY; ++i) {
+            fqns_.push_back(getEventFqn(familyIndex, i));
+        }
+    }
+
+    virtual const FQNList& getSupportedEventClassFQNs() { return fqns_; }
+
+    virtual void onGenericEvent(const std::string& fqn
+                              , const std::vector<std::uint8_t>& data
+                              , const std::string& source)
+    {
+        eventCount_ += data.size() ? 1 : 0;
+    }
+
+    static std::string getEventFqn(std::size_t familyIndex, std::size_t eventIndex)
+    {
+        return "org.kaaproject.kaa.benchmark.family" + std::to_string(familyIndex)
+                + ".Event" + std::to_string(eventIndex);
+    }
+
+public:
+    std::size_t    eventCount_ = 0;
+
+private:
+    FQNList    fqns_;
+};
+
+typedef std::vector<std::unique_ptr<CountingEventFamily>> EventFamilies;
+
+/*
+ * Events are spread evenly across all FQNs, so the scan hits each family equally often.
+ */
+static EventSyncResponse::events_t createEvents(std::size_t familyCount, std::size_t eventCount)
+{
+    std::vector<Event> events(eventCount);
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        events[i].seqNum = i;
+        events[i].eventClassFQN = CountingEventFamily::getEventFqn(i % familyCount, (i / familyCount) % FQNS_PER_FAMILY);
+        events[i].eventData.assign(EVENT_DATA_SIZE, 0x5A);
+        events[i].source.set_string("lZjEzq4E/D5aWjXYuG1N2sKYt/U=");
+        events[i].target.set_null();
+    }
+
+    EventSyncResponse::events_t result;
+    result.set_array(events);
+    return result;
+}
+
+static void scanFamilies(const EventFamilies& families, const EventSyncResponse::events_t& response)
+{
+    auto events = response.get_array();
+    std::sort(events.begin(), events.end(),
+              [](const Event& l, const Event& r) -> bool {return l.seqNum < r.seqNum;});
+
+    for (const auto& event : events) {
+        std::string source;
+        if (!event.source.is_null()) {
+            source = event.source.get_string();
+        }
+
+        for (const auto& family : families) {
+            const auto& list = family->getSupportedEventClassFQNs();
+            if (std::find(list.begin(), list.end(), event.eventClassFQN) != list.end()) {
+                family->onGenericEvent(event.eventClassFQN, event.eventData, source);
+            }
+        }
+    }
+}
+
+static void runBenchmark(const char *target, std::size_t familyCount, std::size_t eventsPerResponse,
+                         std::size_t eventsPerRun, const std::function<void ()>& deliverResponse)
+{
+    const std::size_t responseCount = std::max<std::size_t>(1, eventsPerRun / eventsPerResponse);
+
+    deliverResponse();
+
+    std::size_t allocationsBefore = allocationCount;
+    auto startTime = BenchmarkClock::now();
+
+    for (std::size_t i = 0; i < responseCount; ++i) {
+        deliverResponse();
+    }
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+    std::size_t allocations = allocationCount - allocationsBefore;
+    std::size_t eventCount = responseCount * eventsPerResponse;
+
+    std::printf("%-16s %8zu %8zu %12.0f %12.2f\n", target, familyCount, eventsPerResponse,
+                eventCount / elapsedSec, (double)allocations / eventCount);
+    std::fflush(stdout);
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::size_t eventsPerRun = DEFAULT_EVENTS_PER_RUN;
+    if (argc > 1) {
+        eventsPerRun = std::strtoul(argv[1], nullptr, 10);
+        if (!eventsPerRun) {
+            std::fprintf(stderr, "Usage: %s [events_per_run]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    KaaClientProperties properties;
+    NullLogger logger;
+    IKaaClientStateStoragePtr state(new MockKaaClientStateStorage);
+    MockExecutorContext executor;
+    KaaClientContext context(properties, logger, executor, state);
+
+    const std::size_t familyCounts[] = { 1, 8, 32 };
+    const std::size_t eventsPerResponses[] = { 16, 256 };
+
+    std::printf("%-16s %8s %8s %12s %12s\n", "target", "families", "events", "events/s", "allocs/evt");
+
+    for (auto familyCount : familyCounts) {
+        EventFamilies families;
+        EventManager eventManager(context);
+        for (std::size_t i = 0; i < familyCount; ++i) {
+            families.emplace_back(new CountingEventFamily(i));
+            eventManager.registerEventFamily(families.back().get());
+        }
+
+        for (auto eventsPerResponse : eventsPerResponses) {
+            auto response = createEvents(familyCount, eventsPerResponse);
+
+            runBenchmark("family scan", familyCount, eventsPerResponse, eventsPerRun,
+                         [&families, &response] { scanFamilies(families, response); });
+            runBenchmark("EventManager", familyCount, eventsPerResponse, eventsPerRun,
+                         [&eventManager, &response] { eventManager.onEventsReceived(response); });
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,422 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Microbenchmarks of SDK hot paths.
+ *
+ * Usage: kaa_hot_path_benchmark [min_time_ms] [output_file]
+ *
+ * Each benchmark repeats one operation until it has run for at least min_time_ms and reports
+ * the time and heap allocations per operation. Results are written as JSON to the output file
+ * or stdout, so they can be compared across SDK versions:
+ *
+ *  {
+ *    "sdk_version": "...",
+ *    "min_time_ms": 500,
+ *    "benchmarks": [
+ *      { "name": "...", "iterations": 1000, "ns_per_op": 10.5, "ops_per_s": 95238095.2,
+ *        "allocs_per_op": 0.00, "bytes_per_op": 0 },
+ *      ...
+ *    ]
+ *  }
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/KaaDefaults.hpp"
+#include "kaa/channel/MetaDataTransport.hpp"
+#include "kaa/channel/SyncDataProcessor.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/EndpointObjectHash.hpp"
+#include "kaa/gen/EndpointGen.hpp"
+#include "kaa/kaatcp/KaaSyncRequest.hpp"
+#include "kaa/kaatcp/KaaTcpParser.hpp"
+#include "kaa/logging/ILogger.hpp"
+#include "kaa/observer/KaaObservable.hpp"
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaEncoderDecoder.hpp"
+#include "kaa/utils/ThreadPool.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+#define DEFAULT_MIN_TIME_MS         500
+#define LOG_RECORD_COUNT            16
+#define LOG_RECORD_SIZE             128
+#define KAATCP_MESSAGE_COUNT        16
+#define PAYLOAD_SIZE                1024
+#define OBSERVER_COUNT              4
+#define THREAD_POOL_CAPACITY        1024
+
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+class NullLogger : public ILogger {
+public:
+    virtual void log(LogLevel level, const char *message) const {}
+};
+
+struct BenchmarkResult {
+    std::string      name_;
+    std::size_t      iterations_;
+    double           nsPerOp_;
+    double           allocationsPerOp_;
+    std::size_t      bytesPerOp_;
+};
+
+/*
+ * Values computed by benchmarked operations are accumulated here, so they aren't optimized away.
+ */
+static volatile std::size_t sink;
+
+/*
+ * Runs the operation in batches of doubling size until a batch lasts at least the minimum time.
+ */
+static BenchmarkResult runBenchmark(const std::string& name, std::size_t bytesPerOp,
+                                    std::chrono::milliseconds minTime, const std::function<void ()>& operation)
+{
+    operation();
+
+    std::size_t iterations = 1;
+    while (true) {
+        std::size_t allocationsBefore = allocationCount;
+        auto startTime = BenchmarkClock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i) {
+            operation();
+        }
+
+        auto elapsed = BenchmarkClock::now() - startTime;
+        std::size_t allocations = allocationCount - allocationsBefore;
+
+        if (elapsed >= minTime) {
+            double elapsedNs = std::chrono::duration<double, std::nano>(elapsed).count();
+            std::fprintf(stderr, "%-36s %12.1f ns/op\n", name.c_str(), elapsedNs / iterations);
+            return { name, iterations, elapsedNs / iterations, (double)allocations / iterations, bytesPerOp };
+        }
+
+        iterations *= 2;
+    }
+}
+
+static SyncRequest createSyncRequest()
+{
+    SyncRequest request;
+    request.requestId = 1;
+
+    SyncRequestMetaData metaData;
+    metaData.sdkToken = "benchmarkSdkToken";
+    metaData.timeout.set_long(60000);
+    request.syncRequestMetaData.set_SyncRequestMetaData(metaData);
+
+    std::vector<LogEntry> logEntries(LOG_RECORD_COUNT);
+    for (auto& logEntry : logEntries) {
+        logEntry.data.assign(LOG_RECORD_SIZE, 0x5A);
+    }
+
+    LogSyncRequest logRequest;
+    logRequest.requestId = 1;
+    logRequest.logEntries.set_array(logEntries);
+    request.logSyncRequest.set_LogSyncRequest(logRequest);
+
+    return request;
+}
+
+static SyncResponse createSyncResponse()
+{
+    SyncResponse response;
+    response.requestId = 1;
+    response.status = SyncResponseResultType::SUCCESS;
+    response.bootstrapSyncResponse.set_null();
+    response.profileSyncResponse.set_null();
+    response.configurationSyncResponse.set_null();
+    response.notificationSyncResponse.set_null();
+    response.userSyncResponse.set_null();
+    response.eventSyncResponse.set_null();
+    response.redirectSyncResponse.set_null();
+    response.logSyncResponse.set_null();
+    response.extensionSyncResponses.set_null();
+    return response;
+}
+
+static void benchmarkAvro(std::chrono::milliseconds minTime, std::vector<BenchmarkResult>& results)
+{
+    const SyncRequest request = createSyncRequest();
+    AvroByteArrayConverter<SyncRequest> converter;
+
+    std::vector<std::uint8_t> encodedRequest;
+    converter.toByteArray(request, encodedRequest);
+
+    results.push_back(runBenchmark("avro_encode_sync_request", encodedRequest.size(), minTime,
+                                   [&converter, &request, &encodedRequest]
+                                   {
+                                       converter.toByteArray(request, encodedRequest);
+                                       sink += encodedRequest.size();
+                                   }));
+
+    SyncRequest decodedRequest;
+    results.push_back(runBenchmark("avro_decode_sync_request", encodedRequest.size(), minTime,
+                                   [&converter, &encodedRequest, &decodedRequest]
+                                   {
+                                       converter.fromByteArray(encodedRequest.data(), encodedRequest.size(),
+                                                               decodedRequest);
+                                       sink += decodedRequest.requestId;
+                                   }));
+}
+
+static void benchmarkKaaTcpParser(IKaaClientContext& context, std::chrono::milliseconds minTime,
+                                  std::vector<BenchmarkResult>& results)
+{
+    const std::vector<std::uint8_t> payload(PAYLOAD_SIZE, 0x5A);
+    std::vector<char> buffer;
+    for (std::size_t i = 0; i < KAATCP_MESSAGE_COUNT; ++i) {
+        KaaSyncRequest message(false, true, i, payload, KaaSyncMessageType::SYNC);
+        const auto& rawMessage = message.getRawMessage();
+        buffer.insert(buffer.end(), rawMessage.begin(), rawMessage.end());
+    }
+
+    KaaTcpParser parser(context);
+    const KaaTcpMessageHandler handler = [] (KaaTcpMessageType type, const char *payload, std::uint32_t size)
+                                             {
+                                                 sink += size;
+                                             };
+
+    results.push_back(runBenchmark("kaatcp_parse_buffer", buffer.size(), minTime,
+                                   [&parser, &buffer, &handler]
+                                   {
+                                       parser.parseBuffer(buffer.data(), buffer.size(), handler);
+                                   }));
+}
+
+static void benchmarkSyncDataProcessor(IKaaClientContext& context, IKaaClientStateStoragePtr state,
+                                       std::chrono::milliseconds minTime, std::vector<BenchmarkResult>& results)
+{
+    EndpointObjectHash publicKeyHash(std::string("publicKey"));
+    auto metaDataTransport = std::make_shared<MetaDataTransport>(state, publicKeyHash, 60);
+    SyncDataProcessor processor(metaDataTransport
+                              , IBootstrapTransportPtr()
+                              , IProfileTransportPtr()
+                              , IConfigurationTransportPtr()
+                              , INotificationTransportPtr()
+                              , IUserTransportPtr()
+                              , IEventTransportPtr()
+                              , ILoggingTransportPtr()
+                              , IRedirectionTransportPtr()
+                              , context);
+
+    const std::map<TransportType, ChannelDirection> transportTypes;
+    IKaaDataMultiplexer& multiplexer = processor;
+    std::vector<std::uint8_t> encodedRequest;
+    multiplexer.compileRequest(transportTypes, encodedRequest);
+
+    results.push_back(runBenchmark("sync_compile_request", encodedRequest.size(), minTime,
+                                   [&multiplexer, &transportTypes, &encodedRequest]
+                                   {
+                                       encodedRequest.clear();
+                                       multiplexer.compileRequest(transportTypes, encodedRequest);
+                                       sink += encodedRequest.size();
+                                   }));
+
+    std::vector<std::uint8_t> encodedResponse;
+    AvroByteArrayConverter<SyncResponse> responseConverter;
+    responseConverter.toByteArray(createSyncResponse(), encodedResponse);
+
+    IKaaDataDemultiplexer& demultiplexer = processor;
+    results.push_back(runBenchmark("sync_process_response", encodedResponse.size(), minTime,
+                                   [&demultiplexer, &encodedResponse]
+                                   {
+                                       sink += static_cast<std::size_t>(
+                                               demultiplexer.processResponse(encodedResponse.data(),
+                                                                             encodedResponse.size()));
+                                   }));
+}
+
+static void benchmarkAes(IKaaClientContext& context, std::chrono::milliseconds minTime,
+                         std::vector<BenchmarkResult>& results)
+{
+    KeyPair keys = KeyUtils().generateKeyPair(2048);
+    RsaEncoderDecoder encDec(keys.getPublicKey(), keys.getPrivateKey(), keys.getPublicKey(), context);
+
+    const std::vector<std::uint8_t> plainData(PAYLOAD_SIZE, 0x5A);
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(PAYLOAD_SIZE + 16);
+
+    results.push_back(runBenchmark("aes_encrypt_in_place", plainData.size(), minTime,
+                                   [&encDec, &plainData, &buffer]
+                                   {
+                                       buffer.assign(plainData.begin(), plainData.end());
+                                       encDec.encodeDataInPlace(buffer);
+                                       sink += buffer.size();
+                                   }));
+
+    buffer.assign(plainData.begin(), plainData.end());
+    encDec.encodeDataInPlace(buffer);
+    const std::vector<std::uint8_t> encryptedData(buffer);
+
+    results.push_back(runBenchmark("aes_decrypt_in_place", plainData.size(), minTime,
+                                   [&encDec, &encryptedData, &buffer]
+                                   {
+                                       buffer.assign(encryptedData.begin(), encryptedData.end());
+                                       sink += encDec.decodeDataInPlace(buffer.data(), buffer.size());
+                                   }));
+}
+
+/*
+ * Includes the handoff to the worker: the queue is bounded, so adding blocks while it is full.
+ */
+static void benchmarkThreadPool(std::chrono::milliseconds minTime, std::vector<BenchmarkResult>& results)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.capacity_ = THREAD_POOL_CAPACITY;
+    queueSettings.overflowPolicy_ = TaskOverflowPolicy::BLOCK;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+    std::atomic<std::size_t> executedTaskCount(0);
+
+    results.push_back(runBenchmark("thread_pool_add", 0, minTime,
+                                   [&threadPool, &executedTaskCount]
+                                   {
+                                       threadPool.add([&executedTaskCount] { ++executedTaskCount; });
+                                   }));
+
+    threadPool.shutdown();
+    threadPool.awaitTermination(60);
+}
+
+static void benchmarkObservable(std::chrono::milliseconds minTime, std::vector<BenchmarkResult>& results)
+{
+    KaaObservable<void (std::size_t), std::size_t> observable;
+    for (std::size_t i = 0; i < OBSERVER_COUNT; ++i) {
+        observable.addCallback(i, [] (std::size_t value) { sink += value; });
+    }
+
+    results.push_back(runBenchmark("observable_notify", 0, minTime, [&observable] { observable(1); }));
+}
+
+static void benchmarkEndpointObjectHash(std::chrono::milliseconds minTime, std::vector<BenchmarkResult>& results)
+{
+    const std::vector<std::uint8_t> data(PAYLOAD_SIZE, 0x5A);
+
+    results.push_back(runBenchmark("endpoint_object_hash", data.size(), minTime,
+                                   [&data]
+                                   {
+                                       EndpointObjectHash hash(data.data(), data.size());
+                                       sink += hash.getHashDigest().size();
+                                   }));
+}
+
+static void writeResults(std::FILE *output, std::chrono::milliseconds minTime,
+                         const std::vector<BenchmarkResult>& results)
+{
+    std::fprintf(output, "{\n");
+    std::fprintf(output, "  \"sdk_version\": \"%s\",\n", BUILD_VERSION);
+    std::fprintf(output, "  \"min_time_ms\": %lld,\n", static_cast<long long>(minTime.count()));
+    std::fprintf(output, "  \"benchmarks\": [\n");
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        std::fprintf(output, "    { \"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.1f, \"ops_per_s\": %.1f,"
+                             " \"allocs_per_op\": %.2f, \"bytes_per_op\": %zu }%s\n",
+                     result.name_.c_str(), result.iterations_, result.nsPerOp_, 1e9 / result.nsPerOp_,
+                     result.allocationsPerOp_, result.bytesPerOp_, (i + 1 < results.size() ? "," : ""));
+    }
+
+    std::fprintf(output, "  ]\n");
+    std::fprintf(output, "}\n");
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::chrono::milliseconds minTime(DEFAULT_MIN_TIME_MS);
+    if (argc > 1) {
+        minTime = std::chrono::milliseconds(std::strtoul(argv[1], nullptr, 10));
+        if (!minTime.count()) {
+            std::fprintf(stderr, "Usage: %s [min_time_ms] [output_file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    KaaClientProperties properties;
+    NullLogger logger;
+    IKaaClientStateStoragePtr state(new MockKaaClientStateStorage);
+    MockExecutorContext executor;
+    KaaClientContext context(properties, logger, executor, state);
+
+    std::vector<BenchmarkResult> results;
+
+    benchmarkAvro(minTime, results);
+    benchmarkKaaTcpParser(context, minTime, results);
+    benchmarkSyncDataProcessor(context, state, minTime, results);
+    benchmarkAes(context, minTime, results);
+    benchmarkThreadPool(minTime, results);
+    benchmarkObservable(minTime, results);
+    benchmarkEndpointObjectHash(minTime, results);
+
+    std::FILE *output = stdout;
+    if (argc > 2) {
+        output = std::fopen(argv[2], "w");
+        if (!output) {
+            std::fprintf(stderr, "Failed to open %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    writeResults(output, minTime, results);
+
+    if (output != stdout) {
+        std::fclose(output);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Throughput and latency benchmark of the logging pipeline.
+ *
+ * Usage: kaa_log_benchmark [records_per_run]
+ *
+ * For each storage (or the log collector), record size, bucket size and number of producer threads
+ * the benchmark adds records and reports:
+ *  - records/s and bytes/s of the whole run;
+ *  - heap allocations per record;
+ *  - p50/p99 latency of a single add call.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/ILogger.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/log/LogCollector.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#ifdef KAA_USE_SQLITE_LOG_STORAGE
+#include "kaa/log/SQLiteDBLogStorage.hpp"
+#endif
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/channel/MockChannelManager.hpp"
+#include "headers/log/MockLogUploadStrategy.hpp"
+
+#define DEFAULT_RECORDS_PER_RUN     20000
+#define MAX_BYTES_PER_RUN           (32 * 1024 * 1024)
+#define BENCHMARK_DB_NAME           "kaa_log_benchmark.db"
+
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+/*
+ * Keeps the SDK log output out of the results.
+ */
+class NullLogger : public ILogger {
+public:
+    virtual void log(LogLevel level, const char *message) const {}
+};
+
+/*
+ * Adds the given record; called concurrently by producer threads.
+ */
+typedef std::function<void (const std::vector<std::uint8_t>& record)> AddRecordFunction;
+
+struct BenchmarkResult {
+    double recordsPerSec = 0;
+    double bytesPerSec = 0;
+    double allocationsPerRecord = 0;
+    std::size_t p50Ns = 0;
+    std::size_t p99Ns = 0;
+};
+
+static BenchmarkResult runBenchmark(const AddRecordFunction& addRecord, const std::function<void ()>& waitCompletion,
+                                    std::size_t recordSize, std::size_t recordCount, std::size_t threadCount)
+{
+    const std::vector<std::uint8_t> record(recordSize, 0x5A);
+    const std::size_t recordsPerThread = recordCount / threadCount;
+
+    std::vector<std::vector<std::size_t>> latencies(threadCount);
+    for (auto& threadLatencies : latencies) {
+        threadLatencies.reserve(recordsPerThread);
+    }
+
+    std::vector<std::thread> producers;
+    producers.reserve(threadCount);
+
+    std::atomic<bool> started(false);
+    std::size_t allocationsBefore = allocationCount;
+
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        producers.emplace_back([&, i] ()
+            {
+                while (!started) {
+                    std::this_thread::yield();
+                }
+
+                auto& threadLatencies = latencies[i];
+                for (std::size_t j = 0; j < recordsPerThread; ++j) {
+                    auto callStartTime = BenchmarkClock::now();
+                    addRecord(record);
+                    threadLatencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    BenchmarkClock::now() - callStartTime).count());
+                }
+            });
+    }
+
+    auto startTime = BenchmarkClock::now();
+    started = true;
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    waitCompletion();
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+    std::size_t allocations = allocationCount - allocationsBefore;
+
+    std::vector<std::size_t> allLatencies;
+    allLatencies.reserve(recordsPerThread * threadCount);
+    for (const auto& threadLatencies : latencies) {
+        allLatencies.insert(allLatencies.end(), threadLatencies.begin(), threadLatencies.end());
+    }
+
+    BenchmarkResult result;
+    std::size_t totalRecords = allLatencies.size();
+    if (!totalRecords) {
+        return result;
+    }
+
+    result.recordsPerSec = totalRecords / elapsedSec;
+    result.bytesPerSec = totalRecords * recordSize / elapsedSec;
+    /*
+     * Thread creation is negligible compared to the number of records.
+     */
+    result.allocationsPerRecord = (double)allocations / totalRecords;
+
+    auto p50 = allLatencies.begin() + totalRecords / 2;
+    std::nth_element(allLatencies.begin(), p50, allLatencies.end());
+    result.p50Ns = *p50;
+
+    auto p99 = allLatencies.begin() + totalRecords * 99 / 100;
+    std::nth_element(allLatencies.begin(), p99, allLatencies.end());
+    result.p99Ns = *p99;
+
+    return result;
+}
+
+static void printHeader()
+{
+    std::printf("%-16s %8s %8s %7s %12s %12s %10s %10s %10s\n",
+                "target", "record", "bucket", "threads", "records/s", "MB/s", "allocs/rec", "p50 ns", "p99 ns");
+}
+
+static void printResult(const char *target, std::size_t recordSize, std::size_t bucketSize,
+                        std::size_t threadCount, const BenchmarkResult& result)
+{
+    std::printf("%-16s %8zu %8zu %7zu %12.0f %12.2f %10.2f %10zu %10zu\n",
+                target, recordSize, bucketSize, threadCount, result.recordsPerSec,
+                result.bytesPerSec / (1024 * 1024), result.allocationsPerRecord, result.p50Ns, result.p99Ns);
+    std::fflush(stdout);
+}
+
+static std::size_t getRecordCount(std::size_t recordsPerRun, std::size_t recordSize)
+{
+    return std::max<std::size_t>(1, std::min<std::size_t>(recordsPerRun, MAX_BYTES_PER_RUN / recordSize));
+}
+
+static void benchmarkMemoryLogStorage(IKaaClientContext& context, std::size_t recordSize, std::size_t bucketSize,
+                                      std::size_t threadCount, std::size_t recordsPerRun)
+{
+    MemoryLogStorage storage(context, bucketSize, LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    auto result = runBenchmark([&storage] (const std::vector<std::uint8_t>& record)
+                                   {
+                                       storage.addLogRecord(LogRecord(record.data(), record.size()));
+                                   },
+                               [] () {},
+                               recordSize, getRecordCount(recordsPerRun, recordSize), threadCount);
+
+    printResult("MemoryLogStorage", recordSize, bucketSize, threadCount, result);
+}
+
+#ifdef KAA_USE_SQLITE_LOG_STORAGE
+static void benchmarkSQLiteDBLogStorage(IKaaClientContext& context, std::size_t recordSize, std::size_t bucketSize,
+                                        std::size_t threadCount, std::size_t recordsPerRun)
+{
+    std::remove(BENCHMARK_DB_NAME);
+
+    {
+        SQLiteDBLogStorage storage(context, BENCHMARK_DB_NAME, SQLITE_BALANCED_PROFILE,
+                                   bucketSize, LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+        /*
+         * Each record is committed in its own transaction, so runs are shorter.
+         */
+        auto result = runBenchmark([&storage] (const std::vector<std::uint8_t>& record)
+                                       {
+                                           storage.addLogRecord(LogRecord(record.data(), record.size()));
+                                       },
+                                   [] () {},
+                                   recordSize, getRecordCount(recordsPerRun / 10, recordSize), threadCount);
+
+        printResult("SQLiteDBStorage", recordSize, bucketSize, threadCount, result);
+    }
+
+    std::remove(BENCHMARK_DB_NAME);
+}
+#endif
+
+static void benchmarkLogCollector(IKaaClientContext& context, std::size_t recordSize, std::size_t bucketSize,
+                                  std::size_t threadCount, std::size_t recordsPerRun)
+{
+    MockChannelManager channelManager;
+    LogCollector collector(&channelManager, context);
+
+    auto storage = std::make_shared<MemoryLogStorage>(context, bucketSize,
+                                                      LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    auto strategy = std::make_shared<MockLogUploadStrategy>();
+    strategy->timeoutCheckPeriod_ = USHRT_MAX;
+    strategy->logUploadCheckPeriod_ = USHRT_MAX;
+    strategy->maxParallelUploads_ = USHRT_MAX;
+    strategy->decision_ = LogUploadStrategyDecision::NOOP;
+    strategy->isTimeDependent_ = false;
+
+    collector.setStorage(storage);
+    collector.setUploadStrategy(strategy);
+
+    /*
+     * Records are serialized by the collector, so the record size is the size of the log data.
+     */
+    std::size_t recordCount = getRecordCount(recordsPerRun, recordSize);
+    KaaUserLogRecord logRecord;
+    logRecord.logdata = std::string(recordSize, 'Z');
+
+    auto result = runBenchmark([&collector, &logRecord] (const std::vector<std::uint8_t>&)
+                                   {
+                                       collector.addLogRecord(logRecord);
+                                   },
+                               [&strategy, recordCount, threadCount] ()
+                                   {
+                                       /*
+                                        * Wait until all records reach the storage.
+                                        */
+                                       while (strategy->onIsUploadNeeded_ < recordCount / threadCount * threadCount) {
+                                           std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                       }
+                                   },
+                               recordSize, recordCount, threadCount);
+
+    printResult("LogCollector", recordSize, bucketSize, threadCount, result);
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::size_t recordsPerRun = DEFAULT_RECORDS_PER_RUN;
+    if (argc > 1) {
+        recordsPerRun = std::strtoul(argv[1], nullptr, 10);
+        if (!recordsPerRun) {
+            std::fprintf(stderr, "Usage: %s [records_per_run]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    KaaClientProperties properties;
+    NullLogger logger;
+    IKaaClientStateStoragePtr state(new MockKaaClientStateStorage);
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext context(properties, logger, executor, state);
+
+    const std::size_t recordSizes[] = { 16, 256, 4096 };
+    const std::size_t bucketSizes[] = { 16 * 1024, 64 * 1024 };
+    const std::size_t threadCounts[] = { 1, 4 };
+
+    printHeader();
+
+    for (auto bucketSize : bucketSizes) {
+        for (auto recordSize : recordSizes) {
+            for (auto threadCount : threadCounts) {
+                benchmarkMemoryLogStorage(context, recordSize, bucketSize, threadCount, recordsPerRun);
+#ifdef KAA_USE_SQLITE_LOG_STORAGE
+                benchmarkSQLiteDBLogStorage(context, recordSize, bucketSize, threadCount, recordsPerRun);
+#endif
+                benchmarkLogCollector(context, recordSize, bucketSize, threadCount, recordsPerRun);
+            }
+        }
+    }
+
+    executor.stop();
+
+    return EXIT_SUCCESS;
+}
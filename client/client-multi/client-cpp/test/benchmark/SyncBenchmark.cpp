@@ -0,0 +1,201 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * End-to-end benchmark of syncs through the Kaa TCP channel.
+ *
+ * Usage: kaa_sync_benchmark [records] [events]
+ *
+ * The endpoint of the real channel manager, DefaultOperationTcpChannel, SyncDataProcessor, log collector
+ * and event manager (see test/headers/channel/LoopbackEndpoint.hpp) syncs with the in-process operations
+ * server on the loopback interface, so the numbers include encoding, AES encryption and TCP round trips.
+ * The benchmark reports:
+ *  - log records/s from the first record added until all are delivered, and the delivery time of records;
+ *  - events/s from the first event produced until the server receives all of them;
+ *  - the sync round trip (request to its response) of the channel.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/channel/ChannelMetrics.hpp"
+#include "kaa/log/strategies/RecordCountLogUploadStrategy.hpp"
+#include "kaa/logging/ILogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/channel/LoopbackEndpoint.hpp"
+#include "headers/channel/MockOperationsServer.hpp"
+
+#define DEFAULT_RECORD_COUNT        100000
+#define DEFAULT_EVENT_COUNT         100000
+#define RECORD_DATA_SIZE            64
+#define EVENT_DATA_SIZE             64
+#define DELIVERY_TIMEOUT_SEC        120
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+class NullLogger : public ILogger {
+public:
+    virtual void log(LogLevel level, const char *message) const {}
+};
+
+static bool waitFor(const std::function<bool ()>& condition)
+{
+    auto deadline = BenchmarkClock::now() + std::chrono::seconds(DELIVERY_TIMEOUT_SEC);
+    while (!condition()) {
+        if (BenchmarkClock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/*
+ * Records are uploaded as soon as they are stored, so the sync rate, not a threshold, bounds the throughput.
+ */
+static bool runLogBenchmark(LoopbackEndpoint& endpoint, std::size_t recordCount)
+{
+    endpoint.getLogCollector().setUploadStrategy(
+            std::make_shared<RecordCountLogUploadStrategy>(1, endpoint.getContext()));
+
+    KaaUserLogRecord record;
+    record.logdata.assign(RECORD_DATA_SIZE, 'x');
+
+    std::vector<RecordFuture> futures;
+    futures.reserve(recordCount);
+
+    auto startTime = BenchmarkClock::now();
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        futures.push_back(endpoint.getLogCollector().addLogRecord(record));
+    }
+
+    std::size_t deliveryTimeSumMs = 0;
+    std::size_t maxDeliveryTimeMs = 0;
+    for (auto& future : futures) {
+        if (!future.getFuture().waitFor(std::chrono::seconds(DELIVERY_TIMEOUT_SEC))) {
+            std::fprintf(stderr, "Log records weren't delivered in %d s\n", DELIVERY_TIMEOUT_SEC);
+            return false;
+        }
+
+        auto deliveryTimeMs = future.get().getRecordDeliveryTimeMs();
+        deliveryTimeSumMs += deliveryTimeMs;
+        maxDeliveryTimeMs = std::max(maxDeliveryTimeMs, deliveryTimeMs);
+    }
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+
+    std::printf("%-10s %10zu %12.0f %14.1f %12zu\n", "logs", recordCount, recordCount / elapsedSec,
+                (double)deliveryTimeSumMs / recordCount, maxDeliveryTimeMs);
+    std::fflush(stdout);
+    return true;
+}
+
+static bool runEventBenchmark(LoopbackEndpoint& endpoint, MockOperationsServer& server, std::size_t eventCount)
+{
+    const std::vector<std::uint8_t> eventData(EVENT_DATA_SIZE, 0x5A);
+    const std::size_t receivedBefore = server.getEventCount();
+
+    auto startTime = BenchmarkClock::now();
+
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        endpoint.getEventManager().produceEvent("org.kaaproject.kaa.benchmark.Event", eventData, "",
+                                                TransactionIdPtr());
+    }
+
+    if (!waitFor([&server, receivedBefore, eventCount] { return server.getEventCount() - receivedBefore >= eventCount; })) {
+        std::fprintf(stderr, "Events weren't received in %d s\n", DELIVERY_TIMEOUT_SEC);
+        return false;
+    }
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+
+    std::printf("%-10s %10zu %12.0f %14s %12s\n", "events", eventCount, eventCount / elapsedSec, "-", "-");
+    std::fflush(stdout);
+    return true;
+}
+
+static void printSyncLatency(const ChannelMetricsSnapshot& metrics, std::size_t serverSyncCount)
+{
+    const auto& latency = metrics.syncLatency_;
+
+    std::printf("\n%-10s %10s %12s %10s %10s %10s\n", "sync rtt", "syncs", "mean, us", "p50, ms", "p99, ms", "max, us");
+    std::printf("%-10s %10llu %12llu %10llu %10llu %10llu\n", "channel",
+                (unsigned long long)latency.count_,
+                (unsigned long long)latency.getMeanUs(),
+                (unsigned long long)latency.getQuantileUpperBoundMs(0.5),
+                (unsigned long long)latency.getQuantileUpperBoundMs(0.99),
+                (unsigned long long)latency.maxUs_);
+
+    std::printf("\nserver syncs: %zu, bytes sent: %llu, bytes received: %llu\n", serverSyncCount,
+                (unsigned long long)metrics.bytesSent_, (unsigned long long)metrics.bytesReceived_);
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::size_t recordCount = DEFAULT_RECORD_COUNT;
+    std::size_t eventCount = DEFAULT_EVENT_COUNT;
+    if (argc > 1) {
+        recordCount = std::strtoul(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        eventCount = std::strtoul(argv[2], nullptr, 10);
+    }
+    if (!recordCount || !eventCount) {
+        std::fprintf(stderr, "Usage: %s [records] [events]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    KaaClientProperties properties;
+    NullLogger logger;
+    IKaaClientStateStoragePtr state(new MockKaaClientStateStorage);
+    MockExecutorContext executor;
+    KaaClientContext serverContext(properties, logger, executor, state);
+
+    MockOperationsServer server(serverContext);
+    LoopbackEndpoint endpoint(server, logger);
+
+    if (!waitFor([&server] { return server.getSyncCount() > 0; })) {
+        std::fprintf(stderr, "Endpoint didn't connect to the server in %d s\n", DELIVERY_TIMEOUT_SEC);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("%-10s %10s %12s %14s %12s\n", "target", "count", "per second", "mean dlvr, ms", "max dlvr, ms");
+
+    if (!runLogBenchmark(endpoint, recordCount) || !runEventBenchmark(endpoint, server, eventCount)) {
+        return EXIT_FAILURE;
+    }
+
+    printSyncLatency(endpoint.getChannel().getMetrics(), server.getSyncCount());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Contention benchmark of thread pools.
+ *
+ * Usage: kaa_thread_pool_benchmark [tasks_per_run]
+ *
+ * For each number of workers the benchmark runs tiny tasks on ThreadPool and WorkStealingThreadPool:
+ *  - "producers" - tasks are added by as many external threads as there are workers;
+ *  - "fan-out"   - a task adds all the others from a worker, the way notification callbacks are fanned out;
+ * and reports tasks/s and heap allocations per task.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/ThreadPool.hpp"
+#include "kaa/utils/WorkStealingThreadPool.hpp"
+
+#define DEFAULT_TASKS_PER_RUN   1000000
+
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace kaa {
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+typedef std::function<IThreadPoolPtr (std::size_t workerCount)> ThreadPoolFactory;
+
+/*
+ * Adds all tasks of the run to the pool.
+ */
+typedef std::function<void (IThreadPool& pool, std::size_t taskCount, const ThreadPoolTask& task)> LoadFunction;
+
+static void addFromProducers(IThreadPool& pool, std::size_t producerCount, std::size_t taskCount,
+                             const ThreadPoolTask& task)
+{
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&pool, &task, producerCount, taskCount]
+            {
+                for (std::size_t j = 0; j < taskCount / producerCount; ++j) {
+                    pool.add(task);
+                }
+            });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
+
+static void addFromWorker(IThreadPool& pool, std::size_t taskCount, const ThreadPoolTask& task)
+{
+    std::atomic<bool> isAdded(false);
+    pool.add([&pool, &task, &isAdded, taskCount]
+        {
+            for (std::size_t i = 0; i < taskCount; ++i) {
+                pool.add(task);
+            }
+            isAdded = true;
+        });
+
+    // The pool mustn't be shut down before all tasks are added.
+    while (!isAdded) {
+        std::this_thread::yield();
+    }
+}
+
+static void runBenchmark(const char *target, const char *load, std::size_t workerCount, std::size_t taskCount,
+                         const ThreadPoolFactory& createPool, const LoadFunction& addTasks)
+{
+    std::atomic<std::size_t> executedTaskCount(0);
+    std::atomic<std::size_t> *counter = &executedTaskCount;
+
+    // Small enough to be stored inside std::function.
+    ThreadPoolTask task = [counter] { counter->fetch_add(1, std::memory_order_relaxed); };
+
+    IThreadPoolPtr pool = createPool(workerCount);
+
+    // Starts the workers.
+    pool->add([] {});
+
+    std::size_t allocationsBefore = allocationCount;
+    auto startTime = BenchmarkClock::now();
+
+    addTasks(*pool, taskCount, task);
+
+    pool->shutdown();
+    pool->awaitTermination(3600);
+
+    double elapsedSec = std::chrono::duration<double>(BenchmarkClock::now() - startTime).count();
+    std::size_t allocations = allocationCount - allocationsBefore;
+
+    std::printf("%-15s %-10s %8zu %10zu %14.0f %12.2f\n",
+                target, load, workerCount, executedTaskCount.load(), executedTaskCount / elapsedSec,
+                (double)allocations / taskCount);
+    std::fflush(stdout);
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    using namespace kaa;
+
+    std::size_t tasksPerRun = DEFAULT_TASKS_PER_RUN;
+    if (argc > 1) {
+        tasksPerRun = std::strtoul(argv[1], nullptr, 10);
+        if (!tasksPerRun) {
+            std::fprintf(stderr, "Usage: %s [tasks_per_run]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::size_t workerCounts[] = { 1, 2, 4, 8 };
+
+    const ThreadPoolFactory sharedQueue = [] (std::size_t workerCount)
+        {
+            return std::make_shared<ThreadPool>(workerCount);
+        };
+    const ThreadPoolFactory workStealing = [] (std::size_t workerCount)
+        {
+            return std::make_shared<WorkStealingThreadPool>(workerCount);
+        };
+
+    std::printf("%-15s %-10s %8s %10s %14s %12s\n", "target", "load", "workers", "tasks", "tasks/s", "allocs/task");
+
+    for (auto workerCount : workerCounts) {
+        const LoadFunction producers = [workerCount] (IThreadPool& pool, std::size_t taskCount,
+                                                      const ThreadPoolTask& task)
+            {
+                addFromProducers(pool, workerCount, taskCount, task);
+            };
+
+        runBenchmark("shared queue", "producers", workerCount, tasksPerRun, sharedQueue, producers);
+        runBenchmark("work stealing", "producers", workerCount, tasksPerRun, workStealing, producers);
+        runBenchmark("shared queue", "fan-out", workerCount, tasksPerRun, sharedQueue, addFromWorker);
+        runBenchmark("work stealing", "fan-out", workerCount, tasksPerRun, workStealing, addFromWorker);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ALLOCATIONCOUNTER_HPP_
+#define ALLOCATIONCOUNTER_HPP_
+
+#include <cstddef>
+
+#include <boost/test/unit_test.hpp>
+
+namespace kaa {
+
+/**
+ * Counts memory allocations made through the global operator new by the current thread.
+ *
+ * Allocations are counted only if the test runner is built with KAA_TEST_ALLOCATION_COUNTING
+ * (see TestRunner.cpp), otherwise the count stays zero.
+ */
+class AllocationCounter {
+public:
+    static bool isEnabled();
+
+    static std::size_t getThreadAllocationCount();
+};
+
+/**
+ * Allocations made by the current thread since the scope was created.
+ */
+class AllocationScope {
+public:
+    AllocationScope() : start_(AllocationCounter::getThreadAllocationCount()) {}
+
+    std::size_t getAllocationCount() const
+    {
+        return AllocationCounter::getThreadAllocationCount() - start_;
+    }
+
+private:
+    std::size_t start_;
+};
+
+} /* namespace kaa */
+
+/*
+ * Fails the test if the code run in the scope allocated more than the given count.
+ * Does nothing if allocations aren't counted.
+ */
+#define KAA_CHECK_MAX_ALLOCATIONS(scope, maxCount) \
+    do { \
+        if (kaa::AllocationCounter::isEnabled()) { \
+            BOOST_CHECK_LE((scope).getAllocationCount(), static_cast<std::size_t>(maxCount)); \
+        } \
+    } while (false)
+
+#endif /* ALLOCATIONCOUNTER_HPP_ */
@@ -83,6 +83,20 @@ public:
     }
     virtual void setTopicStates(const TopicStates& states) {}
 
+    virtual TopicSequenceWindows getTopicSequenceWindows() const {
+        return topicSequenceWindows_;
+    }
+    virtual void setTopicSequenceWindows(const TopicSequenceWindows& windows) {
+        topicSequenceWindows_ = windows;
+    }
+
+    virtual UnicastNotificationHashes getUnicastNotificationHashes() const {
+        return unicastNotificationHashes_;
+    }
+    virtual void setUnicastNotificationHashes(const UnicastNotificationHashes& hashes) {
+        unicastNotificationHashes_ = hashes;
+    }
+
     virtual bool isProfileResyncNeeded() const {
         return isProfileResyncNeeded_;
     }
@@ -91,6 +105,20 @@ public:
         isProfileResyncNeeded_ = isNeeded;
     }
 
+    virtual std::int32_t getKeepAliveInterval() const {
+        return keepAliveInterval_;
+    }
+    virtual void setKeepAliveInterval(std::int32_t interval) {
+        keepAliveInterval_ = interval;
+    }
+
+    virtual std::string getOperationsServers() const {
+        return operationsServers_;
+    }
+    virtual void setOperationsServers(const std::string& servers) {
+        operationsServers_ = servers;
+    }
+
     virtual void read() {}
     virtual void save() {}
 
@@ -106,9 +134,14 @@ public:
     std::string endpointKeyHash_;
     bool isSDKPropertiesUpdated_     = false;
     TopicStates topicStates_;
+    TopicSequenceWindows topicSequenceWindows_;
+    UnicastNotificationHashes unicastNotificationHashes_;
 
     bool isProfileResyncNeeded_      = false;
     std::size_t onSetProfileResyncNeeded_ = 0;
+
+    std::int32_t keepAliveInterval_  = 0;
+    std::string operationsServers_;
 };
 
 }
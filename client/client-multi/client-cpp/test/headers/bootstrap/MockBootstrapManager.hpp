@@ -25,6 +25,12 @@ namespace kaa {
 class MockBootstrapManager: public IBootstrapManager {
     virtual void receiveOperationsServerList() {}
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) {}
+    virtual void setServerSelectionStrategy(IServerSelectionStrategyPtr strategy) {}
+    virtual void onOperationsServerRttMeasured(const ITransportConnectionInfo& server, std::chrono::microseconds rtt) {}
+    virtual std::map<std::int32_t, std::chrono::microseconds> getOperationsServerRtts()
+    {
+        return std::map<std::int32_t, std::chrono::microseconds>();
+    }
     virtual void onOperationsServerFailed(const TransportProtocolId& protocolId,
                                           KaaFailoverReason reason = KaaFailoverReason::NO_CONNECTIVITY) {}
 
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOOPBACKENDPOINT_HPP_
+#define LOOPBACKENDPOINT_HPP_
+
+#include <memory>
+
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/KaaDefaults.hpp"
+#include "kaa/channel/KaaChannelManager.hpp"
+#include "kaa/channel/MetaDataTransport.hpp"
+#include "kaa/channel/SyncDataProcessor.hpp"
+#include "kaa/channel/impl/DefaultOperationTcpChannel.hpp"
+#include "kaa/common/EndpointObjectHash.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/event/EventManager.hpp"
+#include "kaa/event/EventTransport.hpp"
+#include "kaa/event/registration/EndpointRegistrationManager.hpp"
+#include "kaa/event/registration/UserTransport.hpp"
+#include "kaa/failover/DefaultFailoverStrategy.hpp"
+#include "kaa/log/LogCollector.hpp"
+#include "kaa/log/LoggingTransport.hpp"
+#include "kaa/logging/ILogger.hpp"
+
+#include "headers/KaaTestUtils.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/bootstrap/MockBootstrapManager.hpp"
+#include "headers/channel/MockOperationsServer.hpp"
+
+namespace kaa {
+
+/**
+ * Endpoint of the real channel manager, TCP channel, sync data processor, log collector, event and
+ * registration managers, wired the way @c KaaClient does, connected to @c MockOperationsServer.
+ *
+ * There is no bootstrap, profile, configuration or notification feature: the operations server is
+ * set directly and the rest isn't needed to sync logs and events.
+ */
+class LoopbackEndpoint {
+public:
+    LoopbackEndpoint(MockOperationsServer& server, ILogger& logger)
+        : state_(new MockKaaClientStateStorage)
+        , context_(properties_, logger, executorContext_, state_)
+        , keys_(KaaTestUtils::generateKeyPair(MockOperationsServer::KEY_LENGTH))
+        , publicKeyHash_(keys_.getPublicKey().data(), keys_.getPublicKey().size())
+        , channelManager_(bootstrapManager_, BootstrapServers(), context_, nullptr)
+        , logCollector_(&channelManager_, context_)
+        , eventManager_(context_)
+        , registrationManager_(context_)
+        , channel_(channelManager_, keys_, context_)
+    {
+        executorContext_.init();
+
+        channelManager_.setFailoverStrategy(std::make_shared<DefaultFailoverStrategy>(context_));
+
+        auto metaDataTransport = std::make_shared<MetaDataTransport>(state_, publicKeyHash_, 60000L);
+        auto userTransport = std::make_shared<UserTransport>(registrationManager_, channelManager_, context_);
+        auto eventTransport = std::make_shared<EventTransport>(eventManager_, channelManager_, context_);
+        auto loggingTransport = std::make_shared<LoggingTransport>(channelManager_, logCollector_, context_);
+
+        syncProcessor_.reset(new SyncDataProcessor(metaDataTransport, nullptr, nullptr, nullptr, nullptr,
+                                                   userTransport, eventTransport, loggingTransport, nullptr,
+                                                   context_));
+        syncProcessor_->setBandwidthShaper(channelManager_.getBandwidthShaper());
+
+        eventManager_.setTransport(eventTransport.get());
+        registrationManager_.setTransport(userTransport.get());
+        logCollector_.setTransport(loggingTransport.get());
+
+        channel_.setDemultiplexer(syncProcessor_.get());
+        channel_.setMultiplexer(syncProcessor_.get());
+        channelManager_.addChannel(&channel_);
+        channelManager_.onTransportConnectionInfoUpdated(server.getConnectionInfo());
+    }
+
+    ~LoopbackEndpoint()
+    {
+        channelManager_.shutdown();
+        executorContext_.stop();
+    }
+
+    IKaaClientContext& getContext() { return context_; }
+    LogCollector& getLogCollector() { return logCollector_; }
+    EventManager& getEventManager() { return eventManager_; }
+    EndpointRegistrationManager& getRegistrationManager() { return registrationManager_; }
+    DefaultOperationTcpChannel& getChannel() { return channel_; }
+
+private:
+    KaaClientProperties            properties_;
+    SimpleExecutorContext          executorContext_;
+    IKaaClientStateStoragePtr      state_;
+    KaaClientContext               context_;
+
+    KeyPair                        keys_;
+    EndpointObjectHash             publicKeyHash_;
+
+    MockBootstrapManager           bootstrapManager_;
+    KaaChannelManager              channelManager_;
+    LogCollector                   logCollector_;
+    EventManager                   eventManager_;
+    EndpointRegistrationManager    registrationManager_;
+    std::unique_ptr<SyncDataProcessor> syncProcessor_;
+    DefaultOperationTcpChannel     channel_;
+};
+
+} /* namespace kaa */
+
+#endif /* LOOPBACKENDPOINT_HPP_ */
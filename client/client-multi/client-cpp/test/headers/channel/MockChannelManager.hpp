@@ -48,17 +48,35 @@ public:
         return channel;
     }
 
-    virtual void onTransportConnectionInfoUpdated(ITransportConnectionInfoPtr server) override { ++onGetChannelByTransportType_; }
+    virtual void sync(TransportType type) override
+    {
+        ++onSync_;
+        getChannelByTransportType(type)->sync(type);
+    }
+
+    virtual void onTransportConnectionInfoUpdated(ITransportConnectionInfoPtr server) override
+    {
+        ++onGetChannelByTransportType_;
+        ++onTransportConnectionInfoUpdated_;
+        lastServer_ = server;
+    }
     virtual void onServerFailed(ITransportConnectionInfoPtr server,
                                 KaaFailoverReason reason = KaaFailoverReason::NO_CONNECTIVITY)
     {
         ++onServerFailed_;
     }
+    virtual void onServerRttMeasured(ITransportConnectionInfoPtr server, std::chrono::microseconds rtt) override
+    {
+        ++onServerRttMeasured_;
+    }
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) override { ++onFailOverStrategyChange_;}
     virtual void clearChannelList() override { ++onClearChannelList_; }
 
     virtual void setConnectivityChecker(ConnectivityCheckerPtr checker) override { ++onSetConnectivityChecker_; }
 
+    virtual KaaClientMetrics getMetrics() override { return KaaClientMetrics(); }
+    virtual BandwidthShaperPtr getBandwidthShaper() override { return BandwidthShaperPtr(); }
+
     virtual void onConnected(const EndpointConnectionInfo& connection)  override {}
     virtual void shutdown() override { ++onShutdown_; }
     virtual void pause() override { ++onPause_; }
@@ -72,8 +90,11 @@ public:
     std::size_t onGetChannels_ = 0;
     std::size_t onGetChannelByTransportType_ = 0;
     std::size_t onGetChannel_ = 0;
+    std::size_t onSync_ = 0;
     std::size_t onTransportConnectionInfoUpdated_ = 0;
+    ITransportConnectionInfoPtr lastServer_;
     std::size_t onServerFailed_ = 0;
+    std::size_t onServerRttMeasured_ = 0;
     std::size_t onClearChannelList_ = 0;
     std::size_t onSetConnectivityChecker_ = 0;
     std::size_t onShutdown_ = 0;
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCKOPERATIONSSERVER_HPP_
+#define MOCKOPERATIONSSERVER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "kaa/gen/EndpointGen.hpp"
+#include "kaa/IKaaClientContext.hpp"
+#include "kaa/security/RsaKeyCache.hpp"
+#include "kaa/security/SecurityDefinitions.hpp"
+#include "kaa/channel/ITransportConnectionInfo.hpp"
+
+namespace kaa {
+
+/**
+ * In-process Kaa operations server listening on the loopback interface, so the real TCP channel,
+ * the sync data processor and managers are exercised end to end in tests and benchmarks.
+ *
+ * The server speaks KaaTcp: it decrypts the session key of CONNECT with its private key, answers
+ * PINGREQ and decrypts KAASYNC requests with the session key. Each sync request gets a canned
+ * response: log buckets are delivered, the profile is accepted, user and endpoint attaches succeed
+ * and the event sequence number is synchronized. The response hook may amend it.
+ *
+ * CONNECT doesn't carry the length of the signature, so endpoint keys must be 2048-bit ones as
+ * the SDK generates them. Session tickets aren't issued.
+ */
+class MockOperationsServer {
+public:
+    typedef std::function<void (const SyncRequest& request, SyncResponse& response)> ResponseHook;
+
+    static const std::size_t KEY_LENGTH = 2048;
+
+    /**
+     * Generates the server key pair and starts listening on an ephemeral port.
+     */
+    explicit MockOperationsServer(IKaaClientContext& context);
+    ~MockOperationsServer();
+
+    /**
+     * The connection info of the TCP transport to be passed to the channel manager.
+     */
+    ITransportConnectionInfoPtr getConnectionInfo() const;
+
+    std::uint16_t getPort() const { return port_; }
+    const PublicKey& getPublicKey() const { return keys_.getPublicKey(); }
+
+    /**
+     * Must be set before endpoints connect, it is called on the server thread.
+     */
+    void setResponseHook(const ResponseHook& hook) { responseHook_ = hook; }
+
+    std::size_t getConnectCount() const { return connectCount_; }
+    std::size_t getSyncCount() const { return syncCount_; }
+    std::size_t getLogRecordCount() const { return logRecordCount_; }
+    std::size_t getEventCount() const { return eventCount_; }
+
+    /**
+     * Closes all connections and stops the server thread.
+     */
+    void stop();
+
+private:
+    class Session;
+    typedef std::shared_ptr<Session> SessionPtr;
+
+    void accept();
+
+    SessionKey decryptSessionKey(const std::uint8_t *data, std::size_t size);
+    void createResponse(const SyncRequest& request, SyncResponse& response, std::int64_t& lastEventSeqNum);
+
+private:
+    IKaaClientContext& context_;
+
+    KeyPair keys_;
+    RsaKeyCache::PrivateKeyContextPtr privateKey_;
+    std::unique_ptr<Botan::PK_Decryptor_EME> sessionKeyDecryptor_;
+
+    boost::asio::io_service ioService_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::uint16_t port_ = 0;
+    std::thread thread_;
+
+    std::vector<std::weak_ptr<Session>> sessions_;
+    ResponseHook responseHook_;
+
+    std::atomic<std::size_t> connectCount_{0};
+    std::atomic<std::size_t> syncCount_{0};
+    std::atomic<std::size_t> logRecordCount_{0};
+    std::atomic<std::size_t> eventCount_{0};
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKOPERATIONSSERVER_HPP_ */
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCKCONFIGURATIONTRANSPORT_HPP_
+#define MOCKCONFIGURATIONTRANSPORT_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "kaa/channel/transport/IConfigurationTransport.hpp"
+
+namespace kaa {
+
+class MockConfigurationTransport: public IConfigurationTransport {
+public:
+    virtual std::shared_ptr<ConfigurationSyncRequest> createConfigurationRequest() {
+        ++onCreateConfigurationRequest_;
+        std::shared_ptr<ConfigurationSyncRequest> request(new ConfigurationSyncRequest);
+        request->configurationHash = configurationHash_;
+        request->resyncOnly.set_bool(true);
+        return request;
+    }
+
+    virtual void onConfigurationResponse(const ConfigurationSyncResponse &response) {
+        ++onConfigurationResponse_;
+    }
+
+    virtual void setConfigurationHashContainer(IConfigurationHashContainer* container) {}
+    virtual void setConfigurationProcessor(IConfigurationProcessor* processor) {}
+
+public:
+    std::vector<std::uint8_t> configurationHash_;
+
+    std::size_t onCreateConfigurationRequest_ = 0;
+    std::size_t onConfigurationResponse_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKCONFIGURATIONTRANSPORT_HPP_ */
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCKLOGGINGTRANSPORT_HPP_
+#define MOCKLOGGINGTRANSPORT_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "kaa/channel/transport/ILoggingTransport.hpp"
+
+namespace kaa {
+
+class MockLoggingTransport: public ILoggingTransport {
+public:
+    virtual std::shared_ptr<LogSyncRequest> createLogSyncRequest() {
+        ++onCreateLogSyncRequest_;
+        return std::shared_ptr<LogSyncRequest>();
+    }
+
+    virtual std::shared_ptr<const std::vector<std::uint8_t>> createEncodedLogSyncRequest() {
+        ++onCreateEncodedLogSyncRequest_;
+        return encodedLogSyncRequest_;
+    }
+
+    virtual void onLogSyncResponse(const LogSyncResponse& response, std::size_t deliveryTime) {
+        ++onLogSyncResponse_;
+    }
+
+public:
+    std::shared_ptr<const std::vector<std::uint8_t>> encodedLogSyncRequest_;
+
+    std::size_t onCreateLogSyncRequest_ = 0;
+    std::size_t onCreateEncodedLogSyncRequest_ = 0;
+    std::size_t onLogSyncResponse_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKLOGGINGTRANSPORT_HPP_ */
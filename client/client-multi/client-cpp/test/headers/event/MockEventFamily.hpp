@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCKEVENTFAMILY_HPP_
+#define MOCKEVENTFAMILY_HPP_
+
+#include "kaa/event/IEventFamily.hpp"
+
+namespace kaa {
+
+class MockEventFamily : public IEventFamily {
+public:
+    MockEventFamily(const FQNList& fqns) : fqns_(fqns) {}
+
+    virtual const FQNList& getSupportedEventClassFQNs() { return fqns_; }
+
+    virtual void onGenericEvent(const std::string& fqn
+                              , const std::vector<std::uint8_t>& data
+                              , const std::string& source)
+    {
+        ++onGenericEvent_;
+        lastFqn_ = fqn;
+        lastSource_ = source;
+    }
+
+    virtual void onGenericEvent(std::size_t eventClassId
+                              , const std::string& fqn
+                              , const std::vector<std::uint8_t>& data
+                              , const std::string& source)
+    {
+        lastEventClassId_ = eventClassId;
+        onGenericEvent(fqn, data, source);
+    }
+
+public:
+    FQNList        fqns_;
+    std::size_t    onGenericEvent_ = 0;
+    std::string    lastFqn_;
+    std::string    lastSource_;
+    std::size_t    lastEventClassId_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKEVENTFAMILY_HPP_ */
@@ -25,7 +25,7 @@ namespace kaa {
 
 class MockLogDeliveryListener : public ILogDeliveryListener {
 public:
-    virtual void onLogDeliverySuccess(const BucketInfo& bucketInfo) { ++onSuccess_; }
+    virtual void onLogDeliverySuccess(const BucketInfo& bucketInfo) { ++onSuccess_; lastBucketInfo_ = bucketInfo; }
     virtual void onLogDeliveryFailure(const BucketInfo& bucketInfo) { ++onFailure_; }
     virtual void onLogDeliveryTimeout(const BucketInfo& bucketInfo) { ++onTimeout_; }
 
@@ -33,6 +33,8 @@ public:
     std::size_t onSuccess_ = 0;
     std::size_t onFailure_ = 0;
     std::size_t onTimeout_ = 0;
+
+    BucketInfo lastBucketInfo_;
 };
 
 } /* namespace kaa */
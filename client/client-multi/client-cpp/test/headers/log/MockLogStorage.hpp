@@ -27,22 +27,41 @@ namespace kaa {
 
 class MockLogStorage: public ILogStorage {
 public:
-    virtual BucketInfo addLogRecord(LogRecord&& record) { ++onAddLogRecord_;  return bucketInfo_;  }
+    virtual BucketInfo addLogRecord(LogRecord&& record)
+    {
+        ++onAddLogRecord_;
+        lastRecordPriority_ = record.getPriority();
+        return bucketInfo_;
+    }
     virtual ILogStorageStatus& getStatus() { ++onGetStatus_; return storageStatus_; }
     virtual LogBucket getNextBucket() { ++onGetRecordBucket_; return recordPack_; }
     virtual void removeBucket(std::int32_t bucketId) { ++onRemoveBucket_; }
     virtual void rollbackBucket(std::int32_t bucketId) { ++onRollbackBucket_; }
+    virtual bool setBucketLimits(std::size_t bucketSize, std::size_t bucketRecordCount)
+    {
+        ++onSetBucketLimits_;
+        bucketSize_ = bucketSize;
+        bucketRecordCount_ = bucketRecordCount;
+        return isBucketLimitsSupported_;
+    }
 
 public:
     BucketInfo bucketInfo_;
     LogBucket recordPack_;
     MockLogStorageStatus storageStatus_;
 
+    LogPriority lastRecordPriority_ = LogPriority::NORMAL;
+
+    bool isBucketLimitsSupported_ = true;
+    std::size_t bucketSize_ = 0;
+    std::size_t bucketRecordCount_ = 0;
+
     std::size_t onAddLogRecord_ = 0;
     std::size_t onGetStatus_ = 0;
     std::size_t onGetRecordBucket_ = 0;
     std::size_t onRemoveBucket_ = 0;
     std::size_t onRollbackBucket_ = 0;
+    std::size_t onSetBucketLimits_ = 0;
 };
 
 } /* namespace kaa */
@@ -36,8 +36,8 @@ public:
     }
 
 public:
-    std::size_t consumedVolume_;
-    std::size_t recordsCount_;
+    std::size_t consumedVolume_ = 0;
+    std::size_t recordsCount_ = 0;
 
     std::size_t onGetConsumedVolume_ = 0;
     std::size_t onGetRecordsCount_ = 0;
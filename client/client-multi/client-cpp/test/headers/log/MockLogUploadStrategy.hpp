@@ -40,6 +40,7 @@ public:
     virtual std::size_t getTimeoutCheckPeriod() { ++onGetTimeoutCheckPeriod_ ; return timeoutCheckPeriod_; }
     virtual std::size_t getLogUploadCheckPeriod() { ++onGetUploadCheckPeriod_; return logUploadCheckPeriod_; }
     virtual std::size_t getMaxParallelUploads()  { ++onGetMaxParallelUploads_; return maxParallelUploads_; }
+    virtual bool isTimeDependent() { return isTimeDependent_; }
 
 public:
     LogUploadStrategyDecision decision_ = LogUploadStrategyDecision::NOOP;
@@ -48,6 +49,7 @@ public:
     std::size_t logUploadCheckPeriod_ = 0;
     std::size_t retryTimeout_ = 0;
     std::size_t maxParallelUploads_ = 0;
+    bool isTimeDependent_ = true;
 
     std::size_t onIsUploadNeeded_ = 0;
     std::size_t onGetTimeout_ = 0;
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCKRAWNOTIFICATIONLISTENER_HPP_
+#define MOCKRAWNOTIFICATIONLISTENER_HPP_
+
+#include "kaa/notification/IRawNotificationListener.hpp"
+
+namespace kaa {
+
+class MockRawNotificationListener: public IRawNotificationListener {
+public:
+    MockRawNotificationListener(bool decode = false) : decode_(decode) {}
+
+    virtual void onRawNotification(const std::int64_t topicId, const RawNotification& notification)
+    {
+        ++onRawNotification_;
+        bytesReceived_ += notification.getSize();
+
+        if (decode_) {
+            notification.get();
+        }
+
+        if (notification.isDecoded()) {
+            ++decodedNotifications_;
+        }
+    }
+
+public:
+    const bool     decode_;
+    std::size_t    onRawNotification_ = 0;
+    std::size_t    bytesReceived_ = 0;
+    std::size_t    decodedNotifications_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKRAWNOTIFICATIONLISTENER_HPP_ */
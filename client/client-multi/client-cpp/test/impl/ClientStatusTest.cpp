@@ -32,6 +32,11 @@
 #include <utility>
 #include <memory>
 #include <string>
+#include <chrono>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <vector>
 
 #ifdef RESOURCE_DIR
 const char * const directory = RESOURCE_DIR;
@@ -68,6 +73,8 @@ BOOST_AUTO_TEST_CASE(checkDefaults)
     BOOST_CHECK_EQUAL(cs.getEndpointAccessToken().empty(), false);
     BOOST_CHECK_EQUAL(cs.getEndpointAttachStatus(), false);
     BOOST_CHECK_EQUAL(cs.isProfileResyncNeeded(), false);
+    BOOST_CHECK_EQUAL(cs.getKeepAliveInterval(), 0);
+    BOOST_CHECK(cs.getOperationsServers().empty());
 
     cleanfile();
 }
@@ -81,6 +88,7 @@ BOOST_AUTO_TEST_CASE(checkSetAndSaveParameters)
 
     const bool isRegisteredExpected = true;
     const bool isProfileResyncNeededExpected = true;
+    const std::int32_t keepAliveIntervalExpected = 170;
 
     ClientStatus cs(clientContext);
 
@@ -143,6 +151,11 @@ BOOST_AUTO_TEST_CASE(checkSetAndSaveParameters)
     std::string endpointKeyHash = "thisEndpointKeyHash";
     cs.setEndpointKeyHash(endpointKeyHash);
 
+    cs.setKeepAliveInterval(keepAliveIntervalExpected);
+
+    std::string operationsServers = "1:2:3:7f00;4:5:6:ff";
+    cs.setOperationsServers(operationsServers);
+
     cs.save();
 
     ClientStatus cs_restored(clientContext);
@@ -167,6 +180,317 @@ BOOST_AUTO_TEST_CASE(checkSetAndSaveParameters)
 
     BOOST_CHECK_EQUAL(cs_restored.isRegistered(), isRegisteredExpected);
     BOOST_CHECK_EQUAL(cs_restored.isProfileResyncNeeded(), isProfileResyncNeededExpected);
+    BOOST_CHECK_EQUAL(cs_restored.getKeepAliveInterval(), keepAliveIntervalExpected);
+    BOOST_CHECK_EQUAL(cs_restored.getOperationsServers(), operationsServers);
+
+    cleanfile();
+}
+
+static std::size_t getStateFileSize()
+{
+    std::ifstream stateFile(std::string(directory) + "/" + filename, std::ios::binary | std::ios::ate);
+    return stateFile.good() ? static_cast<std::size_t>(stateFile.tellg()) : 0;
+}
+
+static KaaClientProperties createBinaryStateProperties()
+{
+    KaaClientProperties binaryProperties;
+    binaryProperties.setStateFileName(filename);
+    binaryProperties.setWorkingDirectoryPath(directory);
+    binaryProperties.setStateFileFormat(StateFileFormat::BINARY);
+    return binaryProperties;
+}
+
+BOOST_AUTO_TEST_CASE(checkBinaryFormatSaveAndRestore)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext clientContext(binaryProperties, tmp_logger, context, stateMock);
+
+    Topics topics(1);
+    topics[0].id = 7;
+    topics[0].name = std::string("topic\0name", 10);
+    topics[0].subscriptionType = SubscriptionType::OPTIONAL_SUBSCRIPTION;
+
+    AttachedEndpoints attachedEndpoints;
+    attachedEndpoints.insert(std::make_pair("Token1", "hash1"));
+
+    TopicStates topicStates;
+    topicStates[7] = 42;
+
+    const HashDigest profileHash { 0x00, 0x0a, 0xff };
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setRegistered(true);
+        cs.setEventSequenceNumber(12345);
+        cs.setProfileHash(profileHash);
+        cs.setTopicList(topics);
+        cs.setAttachedEndpoints(attachedEndpoints);
+        cs.setEndpointKeyHash("thisEndpointKeyHash");
+        cs.setTopicStates(topicStates);
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK(!cs_restored.isSDKPropertiesUpdated());
+    BOOST_CHECK_EQUAL(cs_restored.isRegistered(), true);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 12345);
+
+    auto restoredProfileHash = cs_restored.getProfileHash();
+    BOOST_CHECK_EQUAL_COLLECTIONS(restoredProfileHash.begin(), restoredProfileHash.end(),
+                                  profileHash.begin(), profileHash.end());
+
+    auto restoredTopics = cs_restored.getTopicList();
+    BOOST_REQUIRE_EQUAL(restoredTopics.size(), 1);
+    BOOST_CHECK_EQUAL(restoredTopics[0].id, topics[0].id);
+    BOOST_CHECK_EQUAL(restoredTopics[0].name, topics[0].name);
+    BOOST_CHECK_EQUAL(restoredTopics[0].subscriptionType, topics[0].subscriptionType);
+
+    BOOST_CHECK(cs_restored.getAttachedEndpoints() == attachedEndpoints);
+    BOOST_CHECK_EQUAL(cs_restored.getEndpointKeyHash(), "thisEndpointKeyHash");
+    BOOST_CHECK(cs_restored.getTopicStates() == topicStates);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkBinaryFormatAppendsOnlyChanges)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext clientContext(binaryProperties, tmp_logger, context, stateMock);
+
+    TopicStates topicStates;
+    topicStates[1] = 1;
+    topicStates[2] = 2;
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setTopicStates(topicStates);
+        cs.save();
+
+        std::size_t snapshotSize = getStateFileSize();
+        BOOST_CHECK(snapshotSize > 0);
+
+        /* Nothing changed - nothing written. */
+        cs.save();
+        BOOST_CHECK_EQUAL(getStateFileSize(), snapshotSize);
+
+        /* Key, payload size, 4-byte payload, checksum. */
+        cs.setEventSequenceNumber(100);
+        cs.save();
+        BOOST_CHECK_EQUAL(getStateFileSize(), snapshotSize + 1 + 4 + 4 + 4);
+
+        TopicStates changedStates = cs.getTopicStates();
+        changedStates[2] = 20;
+        changedStates.erase(1);
+        cs.setTopicStates(changedStates);
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 100);
+    BOOST_CHECK_EQUAL(cs_restored.getTopicStates().size(), 1);
+    BOOST_CHECK_EQUAL(cs_restored.getTopicStates()[2], 20);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkBinaryFormatDiscardsBrokenTail)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext clientContext(binaryProperties, tmp_logger, context, stateMock);
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setEventSequenceNumber(1);
+        cs.save();
+        cs.setEventSequenceNumber(2);
+        cs.save();
+    }
+
+    /* Simulate a save interrupted in the middle of the last record. */
+    const std::string stateFileName = std::string(directory) + "/" + filename;
+    std::string content;
+    {
+        std::ifstream stateFile(stateFileName, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(stateFile), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream stateFile(stateFileName, std::ios::binary | std::ios::trunc);
+        stateFile.write(content.data(), content.size() - 2);
+    }
+
+    {
+        ClientStatus cs(clientContext);
+        BOOST_CHECK_EQUAL(cs.getEventSequenceNumber(), 1);
+        cs.setEventSequenceNumber(3);
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 3);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkTextStateMigratedToBinary)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties textProperties;
+    textProperties.setStateFileName(filename);
+    textProperties.setWorkingDirectoryPath(directory);
+    KaaClientContext textContext(textProperties, tmp_logger, context, stateMock);
+
+    {
+        ClientStatus cs(textContext);
+        cs.setEndpointKeyHash("thisEndpointKeyHash");
+        cs.save();
+    }
+
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext binaryContext(binaryProperties, tmp_logger, context, stateMock);
+
+    {
+        ClientStatus cs(binaryContext);
+        BOOST_CHECK_EQUAL(cs.getEndpointKeyHash(), "thisEndpointKeyHash");
+        cs.save();
+    }
+
+    std::ifstream stateFile(std::string(directory) + "/" + filename, std::ios::binary);
+    char magic[4] = {};
+    stateFile.read(magic, sizeof(magic));
+    BOOST_CHECK_EQUAL(std::string(magic, sizeof(magic)), "KAAS");
+    stateFile.close();
+
+    ClientStatus cs_restored(binaryContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEndpointKeyHash(), "thisEndpointKeyHash");
+
+    cleanfile();
+}
+
+static void checkNotificationDedupStateRestored(KaaClientContext& clientContext)
+{
+    TopicSequenceWindows windows;
+    windows[7] = 0x8000000000000005ULL;
+    windows[-1] = 1;
+
+    UnicastNotificationHashes hashes { 1, 0xFFFFFFFFFFFFFFFFULL, 42 };
+
+    {
+        ClientStatus cs(clientContext);
+        BOOST_CHECK(cs.getTopicSequenceWindows().empty());
+        BOOST_CHECK(cs.getUnicastNotificationHashes().empty());
+
+        cs.setTopicSequenceWindows(windows);
+        cs.setUnicastNotificationHashes(hashes);
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK(cs_restored.getTopicSequenceWindows() == windows);
+
+    auto restoredHashes = cs_restored.getUnicastNotificationHashes();
+    BOOST_CHECK_EQUAL_COLLECTIONS(restoredHashes.begin(), restoredHashes.end(), hashes.begin(), hashes.end());
+}
+
+BOOST_AUTO_TEST_CASE(checkNotificationDedupStateSaveAndRestore)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties textProperties;
+    textProperties.setStateFileName(filename);
+    textProperties.setWorkingDirectoryPath(directory);
+    KaaClientContext textContext(textProperties, tmp_logger, context, stateMock);
+
+    checkNotificationDedupStateRestored(textContext);
+    cleanfile();
+
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext binaryContext(binaryProperties, tmp_logger, context, stateMock);
+
+    checkNotificationDedupStateRestored(binaryContext);
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkDeferredSave)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties deferredProperties = createBinaryStateProperties();
+    deferredProperties.setStateSaveDelay(std::chrono::hours(1));
+    KaaClientContext clientContext(deferredProperties, tmp_logger, context, stateMock);
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setEventSequenceNumber(5);
+        cs.save();
+        BOOST_CHECK_EQUAL(getStateFileSize(), 0);
+
+        cs.flush();
+        BOOST_CHECK(getStateFileSize() > 0);
+
+        /* The pending state is written on destruction. */
+        cs.setEventSequenceNumber(6);
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 6);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkConcurrentEventSequenceNumberReservation)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties binaryProperties = createBinaryStateProperties();
+    KaaClientContext clientContext(binaryProperties, tmp_logger, context, stateMock);
+
+    const std::int32_t threadCount = 4;
+    const std::int32_t reservationCount = 1000;
+    const std::int32_t reservationSize = 3;
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setEventSequenceNumber(10);
+        cs.setEndpointAttachStatus(true);
+
+        std::vector<std::vector<std::int32_t>> reserved(threadCount);
+        std::vector<std::thread> threads;
+        for (std::int32_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&cs, &reserved, i] {
+                for (std::int32_t j = 0; j < reservationCount; ++j) {
+                    reserved[i].push_back(cs.reserveEventSequenceNumbers(reservationSize));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::set<std::int32_t> firstNumbers;
+        for (const auto& numbers : reserved) {
+            firstNumbers.insert(numbers.begin(), numbers.end());
+        }
+
+        /* The ranges don't overlap and follow each other. */
+        BOOST_CHECK_EQUAL(firstNumbers.size(), static_cast<std::size_t>(threadCount * reservationCount));
+        BOOST_CHECK_EQUAL(*firstNumbers.begin(), 10);
+        BOOST_CHECK_EQUAL(*firstNumbers.rbegin(), 10 + (threadCount * reservationCount - 1) * reservationSize);
+
+        cs.save();
+    }
+
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 10 + threadCount * reservationCount * reservationSize);
+    BOOST_CHECK(cs_restored.getEndpointAttachStatus());
 
     cleanfile();
 }
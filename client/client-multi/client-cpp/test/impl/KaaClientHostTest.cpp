@@ -0,0 +1,87 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "kaa/KaaClientHost.hpp"
+#include "kaa/IKaaClientContext.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(KaaClientHostSuite)
+
+BOOST_AUTO_TEST_CASE(EndpointsShareExecutorAndKeepWorkingDirectoriesApartTest)
+{
+    auto executorContext = std::make_shared<SimpleExecutorContext>();
+    KaaClientHost host(KaaClientProperties(), executorContext);
+
+    auto client1 = host.addEndpoint("host_test_endpoint1");
+    auto client2 = host.addEndpoint("host_test_endpoint2");
+
+    BOOST_CHECK_EQUAL(host.getEndpointCount(), 2);
+    BOOST_CHECK_EQUAL(host.getClient("host_test_endpoint1"), client1);
+    BOOST_CHECK(!host.getClient("unknown"));
+
+    BOOST_CHECK_EQUAL(&client1->getKaaClientContext().getExecutorContext(), executorContext.get());
+    BOOST_CHECK_EQUAL(&client2->getKaaClientContext().getExecutorContext(), executorContext.get());
+
+    BOOST_CHECK_EQUAL(client1->getKaaClientContext().getProperties().getWorkingDirectoryPath(),
+                      "./host_test_endpoint1/");
+    BOOST_CHECK_EQUAL(client2->getKaaClientContext().getProperties().getWorkingDirectoryPath(),
+                      "./host_test_endpoint2/");
+    BOOST_CHECK_NE(client1->getEndpointKeyHash(), client2->getEndpointKeyHash());
+
+    BOOST_CHECK(host.removeEndpoint("host_test_endpoint1"));
+    BOOST_CHECK(!host.removeEndpoint("host_test_endpoint1"));
+    BOOST_CHECK_EQUAL(host.getEndpointCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidEndpointNameTest)
+{
+    KaaClientHost host;
+
+    BOOST_CHECK_THROW(host.addEndpoint(""), KaaException);
+    BOOST_CHECK_THROW(host.addEndpoint(".."), KaaException);
+    BOOST_CHECK_THROW(host.addEndpoint("a/b"), KaaException);
+
+    host.addEndpoint("host_test_endpoint3");
+    BOOST_CHECK_THROW(host.addEndpoint("host_test_endpoint3"), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(LogStorageFactoryTest)
+{
+    KaaClientHost host;
+
+    std::string factoryEndpointName;
+    host.setLogStorageFactory([&factoryEndpointName] (const std::string& endpointName, IKaaClient& client)
+        {
+            factoryEndpointName = endpointName;
+            return std::make_shared<MemoryLogStorage>(client.getKaaClientContext());
+        });
+
+    host.addEndpoint("host_test_endpoint4");
+
+    BOOST_CHECK_EQUAL(factoryEndpointName, "host_test_endpoint4");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
@@ -109,6 +109,146 @@ BOOST_AUTO_TEST_CASE(SetConfigurationFileNameTest)
     BOOST_CHECK_EQUAL(properties.getConfigurationFileName(), properties.getWorkingDirectoryPath() + newConfigurationFileName);
 }
 
+BOOST_AUTO_TEST_CASE(SetFastStartTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK(!properties.isFastStart());
+
+    properties.setFastStart(true);
+    BOOST_CHECK(properties.isFastStart());
+
+    properties.setFastStart(false);
+    BOOST_CHECK(!properties.isFastStart());
+}
+
+BOOST_AUTO_TEST_CASE(SetWarmPauseTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK(!properties.isWarmPause());
+
+    properties.setWarmPause(true);
+    BOOST_CHECK(properties.isWarmPause());
+
+    properties.setWarmPause(false);
+    BOOST_CHECK(!properties.isWarmPause());
+}
+
+BOOST_AUTO_TEST_CASE(SetOperationsServersTtlTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK_EQUAL(properties.getOperationsServersTtl().count(), 86400);
+
+    properties.setOperationsServersTtl(std::chrono::seconds(600));
+    BOOST_CHECK_EQUAL(properties.getOperationsServersTtl().count(), 600);
+
+    properties.setOperationsServersTtl(std::chrono::seconds(-1));
+    BOOST_CHECK_EQUAL(properties.getOperationsServersTtl().count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SetEventListenersCacheTtlTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK_EQUAL(properties.getEventListenersCacheTtl().count(), 0);
+
+    properties.setEventListenersCacheTtl(std::chrono::seconds(30));
+    BOOST_CHECK_EQUAL(properties.getEventListenersCacheTtl().count(), 30);
+
+    properties.setEventListenersCacheTtl(std::chrono::seconds(-1));
+    BOOST_CHECK_EQUAL(properties.getEventListenersCacheTtl().count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SetFailoverBackoffTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK(!properties.isFailoverBackoff());
+    BOOST_CHECK_EQUAL(properties.getFailoverBackoffBase().count(), 1);
+    BOOST_CHECK_EQUAL(properties.getFailoverBackoffMax().count(), 300);
+
+    properties.setFailoverBackoff(true);
+    properties.setFailoverBackoffBase(std::chrono::seconds(10));
+    properties.setFailoverBackoffMax(std::chrono::seconds(5));
+    BOOST_CHECK(properties.isFailoverBackoff());
+    BOOST_CHECK_EQUAL(properties.getFailoverBackoffBase().count(), 10);
+    BOOST_CHECK_EQUAL(properties.getFailoverBackoffMax().count(), 10);
+
+    properties.setFailoverBackoffBase(std::chrono::seconds::zero());
+    BOOST_CHECK_EQUAL(properties.getFailoverBackoffBase().count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SetMemorySoftLimitTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK_EQUAL(properties.getMemorySoftLimit(), 0);
+    BOOST_CHECK_EQUAL(properties.getMemoryCheckPeriod().count(), 5);
+
+    properties.setMemorySoftLimit(1024 * 1024);
+    properties.setMemoryCheckPeriod(std::chrono::seconds(30));
+    BOOST_CHECK_EQUAL(properties.getMemorySoftLimit(), 1024 * 1024);
+    BOOST_CHECK_EQUAL(properties.getMemoryCheckPeriod().count(), 30);
+
+    properties.setMemoryCheckPeriod(std::chrono::seconds::zero());
+    BOOST_CHECK_EQUAL(properties.getMemoryCheckPeriod().count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SetTcpSocketOptionsTest)
+{
+    KaaClientProperties properties;
+
+    auto options = properties.getTcpSocketOptions();
+    BOOST_CHECK(options.noDelay);
+    BOOST_CHECK_EQUAL(options.keepAliveIdle.count(), 0);
+    BOOST_CHECK_EQUAL(options.sendBufferSize, 0);
+
+    options.noDelay = false;
+    options.keepAliveIdle = std::chrono::seconds(60);
+    options.keepAliveInterval = std::chrono::seconds(10);
+    options.keepAliveCount = 3;
+    options.sendBufferSize = 16 * 1024;
+    options.receiveBufferSize = 32 * 1024;
+    properties.setTcpSocketOptions(options);
+
+    auto stored = properties.getTcpSocketOptions();
+    BOOST_CHECK(!stored.noDelay);
+    BOOST_CHECK_EQUAL(stored.keepAliveIdle.count(), 60);
+    BOOST_CHECK_EQUAL(stored.keepAliveInterval.count(), 10);
+    BOOST_CHECK_EQUAL(stored.keepAliveCount, 3);
+    BOOST_CHECK_EQUAL(stored.sendBufferSize, 16 * 1024);
+    BOOST_CHECK_EQUAL(stored.receiveBufferSize, 32 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(SetLogLevelTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK(properties.getLogLevel() == LogLevel::KAA_TRACE);
+
+    properties.setLogLevel(LogLevel::KAA_WARNING);
+    BOOST_CHECK(properties.getLogLevel() == LogLevel::KAA_WARNING);
+
+    properties.setProperty(KaaClientProperties::PROP_LOG_LEVEL, "error");
+    BOOST_CHECK(properties.getLogLevel() == LogLevel::KAA_ERROR);
+
+    properties.setProperty(KaaClientProperties::PROP_LOG_LEVEL, "unknown");
+    BOOST_CHECK(properties.getLogLevel() == LogLevel::KAA_TRACE);
+}
+
+BOOST_AUTO_TEST_CASE(SetAsyncLogQueueCapacityTest)
+{
+    KaaClientProperties properties;
+
+    BOOST_CHECK_EQUAL(properties.getAsyncLogQueueCapacity(), 0);
+
+    properties.setAsyncLogQueueCapacity(1024);
+
+    BOOST_CHECK_EQUAL(properties.getAsyncLogQueueCapacity(), 1024);
+}
+
 BOOST_AUTO_TEST_CASE(SetArbitraryPropertyTest)
 {
     KaaClientProperties properties;
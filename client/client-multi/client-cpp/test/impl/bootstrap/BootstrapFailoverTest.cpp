@@ -24,6 +24,7 @@
 #include "kaa/KaaDefaults.hpp"
 #include "kaa/bootstrap/BootstrapManager.hpp"
 #include "kaa/failover/DefaultFailoverStrategy.hpp"
+#include "kaa/failover/LatencyServerSelectionStrategy.hpp"
 #include "kaa/KaaClientContext.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
 #include "test/headers/channel/MockChannelManager.hpp"
@@ -58,6 +59,92 @@ BOOST_AUTO_TEST_CASE(BootstrapEmptyOperationalServersListTest)
     BOOST_CHECK(channelManager.onServerFailed_);
 }
 
+BOOST_AUTO_TEST_CASE(SavedOperationsServersTest)
+{
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+
+    SimpleExecutorContext exeContext;
+    IKaaClientStateStoragePtr status (new MockKaaClientStateStorage);
+    KaaClientContext context(properties, tmp_logger, exeContext, status);
+
+    ProtocolMetaData server;
+    server.accessPointId = 0x1F2E3D;
+    server.protocolVersionInfo.id = -0x56C8FF92;
+    server.protocolVersionInfo.version = 1;
+    server.connectionInfo = { 0x00, 0x7F, 0x80, 0xFF };
+
+    BootstrapManager noSavedServersManager(context, nullptr);
+    BOOST_CHECK(!noSavedServersManager.useSavedOperationsServers());
+
+    {
+        BootstrapManager bootstrapManager(context, nullptr);
+        MockChannelManager channelManager;
+        bootstrapManager.setChannelManager(&channelManager);
+
+        bootstrapManager.onServerListUpdated({ server });
+    }
+
+    BOOST_CHECK(!status->getOperationsServers().empty());
+
+    BootstrapManager restartedManager(context, nullptr);
+    MockChannelManager channelManager;
+    restartedManager.setChannelManager(&channelManager);
+
+    BOOST_CHECK(restartedManager.useSavedOperationsServers());
+    BOOST_CHECK_EQUAL(channelManager.onTransportConnectionInfoUpdated_, 1);
+    BOOST_REQUIRE(channelManager.lastServer_);
+    BOOST_CHECK_EQUAL(channelManager.lastServer_->getAccessPointId(), server.accessPointId);
+    BOOST_CHECK(channelManager.lastServer_->getConnectionInfo() == server.connectionInfo);
+
+    status->setOperationsServers("corrupted");
+    BOOST_CHECK(!restartedManager.useSavedOperationsServers());
+
+    status->setOperationsServers("1000@1:2:3:ff");
+    BOOST_CHECK(!restartedManager.useSavedOperationsServers());
+
+    context.getProperties().setOperationsServersTtl(std::chrono::seconds::zero());
+    BOOST_CHECK(restartedManager.useSavedOperationsServers());
+}
+
+BOOST_AUTO_TEST_CASE(LatencyServerSelectionTest)
+{
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+
+    SimpleExecutorContext exeContext;
+    IKaaClientStateStoragePtr status (new MockKaaClientStateStorage);
+    KaaClientContext context(properties, tmp_logger, exeContext, status);
+
+    BootstrapManager bootstrapManager(context, nullptr);
+    MockChannelManager channelManager;
+    bootstrapManager.setChannelManager(&channelManager);
+    bootstrapManager.setFailoverStrategy(std::make_shared<DefaultFailoverStrategy>(context));
+    bootstrapManager.setServerSelectionStrategy(std::make_shared<LatencyServerSelectionStrategy>());
+
+    std::vector<ProtocolMetaData> servers(3);
+    const std::int32_t rttsMs[] = { 90, 10, 40 };
+    for (std::size_t i = 0; i < servers.size(); ++i) {
+        servers[i].accessPointId = i + 1;
+        servers[i].protocolVersionInfo.id = 1;
+        servers[i].protocolVersionInfo.version = 1;
+        servers[i].connectionInfo = { 0x01 };
+
+        bootstrapManager.onOperationsServerRttMeasured(GenericTransportInfo(ServerType::OPERATIONS, servers[i]),
+                                                       std::chrono::milliseconds(rttsMs[i]));
+    }
+
+    BOOST_CHECK_EQUAL(bootstrapManager.getOperationsServerRtts().size(), servers.size());
+
+    bootstrapManager.onServerListUpdated(servers);
+    BOOST_REQUIRE(channelManager.lastServer_);
+    BOOST_CHECK_EQUAL(channelManager.lastServer_->getAccessPointId(), 2);
+
+    bootstrapManager.onOperationsServerFailed(TransportProtocolId(servers[0].protocolVersionInfo),
+                                              KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA);
+    BOOST_CHECK_EQUAL(channelManager.lastServer_->getAccessPointId(), 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
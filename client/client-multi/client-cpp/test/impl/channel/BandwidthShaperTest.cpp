@@ -0,0 +1,157 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "kaa/channel/BandwidthShaper.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static MockExecutorContext executorContext;
+
+class BandwidthShaperFixture {
+public:
+    BandwidthShaperFixture()
+        : status_(new MockKaaClientStateStorage), context_(properties, tmp_logger, executorContext, status_),
+          shaper(context_)
+    {
+    }
+
+protected:
+    IKaaClientStateStoragePtr    status_;
+    KaaClientContext             context_;
+    BandwidthShaper              shaper;
+};
+
+static TransportRateLimit makeLimit(std::size_t bytesPerSecond, std::size_t burstBytes = 0)
+{
+    TransportRateLimit limit;
+    limit.bytesPerSecond_ = bytesPerSecond;
+    limit.burstBytes_ = burstBytes;
+    return limit;
+}
+
+BOOST_FIXTURE_TEST_SUITE(BandwidthShaperTestSuite, BandwidthShaperFixture)
+
+BOOST_AUTO_TEST_CASE(UnlimitedTransportTest)
+{
+
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK(shaper.tryAcquire(TransportType::LOGGING));
+        shaper.consume(TransportType::LOGGING, 1024 * 1024);
+    }
+
+    BOOST_CHECK_EQUAL(shaper.getBurstBytes(TransportType::LOGGING), 0);
+    BOOST_CHECK(shaper.getSnapshot().empty());
+}
+
+BOOST_AUTO_TEST_CASE(DebtDefersTransportTest)
+{
+    shaper.setRateLimit(TransportType::LOGGING, makeLimit(1000, 100));
+    BOOST_CHECK_EQUAL(shaper.getBurstBytes(TransportType::LOGGING), 100);
+
+    /*
+     * A section bigger than the burst isn't blocked, but the next one waits for the debt to be repaid.
+     */
+    BOOST_CHECK(shaper.tryAcquire(TransportType::LOGGING));
+    shaper.consume(TransportType::LOGGING, 300);
+    BOOST_CHECK(!shaper.tryAcquire(TransportType::LOGGING));
+
+    /*
+     * The other transport has its own budget.
+     */
+    shaper.setRateLimit(TransportType::EVENT, makeLimit(1000));
+    BOOST_CHECK(shaper.tryAcquire(TransportType::EVENT));
+
+    auto snapshot = shaper.getSnapshot();
+    BOOST_REQUIRE_EQUAL(snapshot.size(), 2);
+
+    const auto& logging = snapshot[TransportType::LOGGING];
+    BOOST_CHECK_EQUAL(logging.bytesPerSecond_, 1000);
+    BOOST_CHECK_EQUAL(logging.sentBytes_, 300);
+    BOOST_CHECK_EQUAL(logging.deferredSections_, 1);
+    BOOST_CHECK(logging.isThrottled_);
+    BOOST_CHECK_LT(logging.availableBytes_, 0);
+
+    BOOST_CHECK(!snapshot[TransportType::EVENT].isThrottled_);
+    BOOST_CHECK_EQUAL(snapshot[TransportType::EVENT].availableBytes_, 1000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    BOOST_CHECK(shaper.tryAcquire(TransportType::LOGGING));
+}
+
+BOOST_AUTO_TEST_CASE(ResumeCallbackTest)
+{
+    std::atomic<std::size_t> resumeCount(0);
+    std::atomic<bool> isLoggingResumed(false);
+
+    shaper.setResumeCallback([&resumeCount, &isLoggingResumed] (TransportType type)
+        {
+            isLoggingResumed = (type == TransportType::LOGGING);
+            ++resumeCount;
+        });
+
+    shaper.setRateLimit(TransportType::LOGGING, makeLimit(10000, 100));
+    shaper.consume(TransportType::LOGGING, 200);
+
+    /*
+     * Repeated deferrals schedule one resume.
+     */
+    BOOST_CHECK(!shaper.tryAcquire(TransportType::LOGGING));
+    BOOST_CHECK(!shaper.tryAcquire(TransportType::LOGGING));
+
+    for (int i = 0; i < 500 && !resumeCount; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    BOOST_CHECK_EQUAL(resumeCount, 1);
+    BOOST_CHECK(isLoggingResumed);
+    BOOST_CHECK(!shaper.getSnapshot()[TransportType::LOGGING].isThrottled_);
+    BOOST_CHECK(shaper.tryAcquire(TransportType::LOGGING));
+
+    /*
+     * Removing the limit resumes deferred sections at once.
+     */
+    shaper.consume(TransportType::LOGGING, 1000000);
+    BOOST_CHECK(!shaper.tryAcquire(TransportType::LOGGING));
+    shaper.setRateLimit(TransportType::LOGGING, TransportRateLimit());
+
+    for (int i = 0; i < 500 && resumeCount < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BOOST_CHECK_EQUAL(resumeCount, 2);
+    BOOST_CHECK(shaper.tryAcquire(TransportType::LOGGING));
+    BOOST_CHECK(shaper.getSnapshot().empty());
+
+    shaper.setResumeCallback(BandwidthShaper::ResumeCallback());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "kaa/channel/ChannelMetrics.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(ChannelMetricsTestSuite)
+
+BOOST_AUTO_TEST_CASE(LatencyHistogramBucketsTest)
+{
+    LatencyHistogram histogram;
+    histogram.record(std::chrono::microseconds(500));
+    histogram.record(std::chrono::milliseconds(1));
+    histogram.record(std::chrono::milliseconds(3));
+    histogram.record(std::chrono::milliseconds(3));
+    histogram.record(std::chrono::hours(1));
+
+    const auto& snapshot = histogram.getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.count_, 5);
+    BOOST_CHECK_EQUAL(snapshot.buckets_[0], 1);
+    BOOST_CHECK_EQUAL(snapshot.buckets_[1], 1);
+    BOOST_CHECK_EQUAL(snapshot.buckets_[2], 2);
+    BOOST_CHECK_EQUAL(snapshot.buckets_[LatencyHistogramSnapshot::BUCKET_COUNT - 1], 1);
+    BOOST_CHECK_EQUAL(snapshot.maxUs_, 3600000000ULL);
+
+    BOOST_CHECK_EQUAL(snapshot.getQuantileUpperBoundMs(0.5), 4);
+    BOOST_CHECK_EQUAL(snapshot.getQuantileUpperBoundMs(0.0), 1);
+    BOOST_CHECK_EQUAL(snapshot.getQuantileUpperBoundMs(1.0), 1ULL << (LatencyHistogramSnapshot::BUCKET_COUNT - 1));
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentUpdatesTest)
+{
+    const std::size_t THREAD_COUNT = 4;
+    const std::size_t UPDATES_PER_THREAD = 10000;
+
+    ChannelMetrics metrics;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&metrics, UPDATES_PER_THREAD]
+            {
+                for (std::size_t j = 0; j < UPDATES_PER_THREAD; ++j) {
+                    metrics.onBytesSent(2);
+                    metrics.onFrameReceived();
+                    metrics.getSyncLatency().record(std::chrono::microseconds(j));
+                }
+            });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto& snapshot = metrics.getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.bytesSent_, 2 * THREAD_COUNT * UPDATES_PER_THREAD);
+    BOOST_CHECK_EQUAL(snapshot.framesReceived_, THREAD_COUNT * UPDATES_PER_THREAD);
+    BOOST_CHECK_EQUAL(snapshot.syncLatency_.count_, THREAD_COUNT * UPDATES_PER_THREAD);
+    BOOST_CHECK_EQUAL(snapshot.syncLatency_.maxUs_, UPDATES_PER_THREAD - 1);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotAggregationTest)
+{
+    ChannelMetrics first;
+    first.onBytesReceived(10);
+    first.onConnected();
+    first.getPingRtt().record(std::chrono::milliseconds(5));
+
+    ChannelMetrics second;
+    second.onBytesReceived(20);
+    second.onServerFailed();
+    second.getPingRtt().record(std::chrono::milliseconds(7));
+
+    ChannelMetricsSnapshot total;
+    total += first.getSnapshot();
+    total += second.getSnapshot();
+
+    BOOST_CHECK_EQUAL(total.bytesReceived_, 30);
+    BOOST_CHECK_EQUAL(total.connects_, 1);
+    BOOST_CHECK_EQUAL(total.serverFailures_, 1);
+    BOOST_CHECK_EQUAL(total.pingRtt_.count_, 2);
+    BOOST_CHECK_EQUAL(total.pingRtt_.getMeanUs(), 6000);
+    BOOST_CHECK_EQUAL(total.pingRtt_.maxUs_, 7000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+#include "kaa/channel/connectivity/ConnectivityMonitor.hpp"
+
+namespace kaa {
+
+class MockConnectivityProbe : public IConnectivityChecker {
+public:
+    virtual bool checkConnectivity()
+    {
+        ++probeCount_;
+        return isConnected_;
+    }
+
+    std::atomic<bool> isConnected_ { true };
+    std::atomic<std::size_t> probeCount_ { 0 };
+};
+
+template<typename Predicate>
+static bool waitFor(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(ConnectivityMonitorTestSuite)
+
+BOOST_AUTO_TEST_CASE(CachedStateTest)
+{
+    auto probe = std::make_shared<MockConnectivityProbe>();
+    ConnectivityMonitor monitor(probe, std::chrono::hours(1));
+
+    BOOST_CHECK(monitor.checkConnectivity());
+    BOOST_REQUIRE(waitFor([&probe] { return probe->probeCount_ > 0; }));
+
+    /*
+     * The state changes only with the probe triggered by the check.
+     */
+    probe->isConnected_ = false;
+    BOOST_CHECK(monitor.checkConnectivity());
+    BOOST_CHECK(waitFor([&monitor] { return !monitor.checkConnectivity(); }));
+}
+
+BOOST_AUTO_TEST_CASE(ListenerTest)
+{
+    auto probe = std::make_shared<MockConnectivityProbe>();
+    ConnectivityMonitor monitor(probe, std::chrono::hours(1));
+    BOOST_REQUIRE(waitFor([&probe] { return probe->probeCount_ > 0; }));
+
+    std::mutex guard;
+    std::vector<bool> transitions;
+    BOOST_CHECK(monitor.addConnectivityListener(this, [&guard, &transitions] (bool isConnected)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            transitions.push_back(isConnected);
+        }));
+
+    auto transitionCount = [&guard, &transitions]
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            return transitions.size();
+        };
+
+    probe->isConnected_ = false;
+    monitor.onNetworkChanged();
+    BOOST_REQUIRE(waitFor([&transitionCount] { return transitionCount() == 1; }));
+
+    probe->isConnected_ = true;
+    monitor.onNetworkChanged();
+    BOOST_REQUIRE(waitFor([&transitionCount] { return transitionCount() == 2; }));
+
+    BOOST_CHECK(!transitions[0]);
+    BOOST_CHECK(transitions[1]);
+
+    monitor.removeConnectivityListener(this);
+
+    const std::size_t probeCount = probe->probeCount_;
+    probe->isConnected_ = false;
+    monitor.onNetworkChanged();
+    BOOST_REQUIRE(waitFor([&probe, probeCount] { return probe->probeCount_ > probeCount; }));
+    BOOST_CHECK(waitFor([&monitor] { return !monitor.checkConnectivity(); }));
+    BOOST_CHECK_EQUAL(transitionCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(PeriodicProbeTest)
+{
+    auto probe = std::make_shared<MockConnectivityProbe>();
+    {
+        ConnectivityMonitor monitor(probe, std::chrono::milliseconds(10));
+        BOOST_CHECK(waitFor([&probe] { return probe->probeCount_ >= 2; }));
+    }
+
+    /*
+     * The stopped monitor doesn't probe anymore.
+     */
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const std::size_t probeCount = probe->probeCount_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    BOOST_CHECK_EQUAL(probe->probeCount_, probeCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -17,6 +17,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/asio/detail/socket_ops.hpp>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "kaa/KaaDefaults.hpp"
 #include "kaa/channel/KaaChannelManager.hpp"
 #include "kaa/common/exception/KaaException.hpp"
@@ -24,6 +28,7 @@
 #include "kaa/KaaClientContext.hpp"
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
 
 #include "headers/channel/MockDataChannel.hpp"
@@ -591,6 +596,116 @@ BOOST_AUTO_TEST_CASE(ResumetTest)
 }
 
 
+BOOST_AUTO_TEST_CASE(LookupDuringChannelChangesTest)
+{
+    MockBootstrapManager BootstrapManager;
+    KaaClientContext clientContext(properties, tmp_logger, context, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext, nullptr);
+
+    UserDataChannel channel1;
+    channel1.id_ = "id1";
+    channel1.protocolId_ = TransportProtocolIdConstants::HTTP_TRANSPORT_ID;
+    channel1.transportType_ = TransportType::LOGGING;
+    channel1.serverType_ = ServerType::OPERATIONS;
+
+    UserDataChannel channel2;
+    channel2.id_ = "id2";
+    channel2.protocolId_ = TransportProtocolIdConstants::TCP_TRANSPORT_ID;
+    channel2.transportType_ = TransportType::LOGGING;
+    channel2.serverType_ = ServerType::OPERATIONS;
+
+    channelManager.addChannel(&channel1);
+
+    std::atomic_bool isStopped(false);
+    std::atomic_size_t unexpectedChannelCount(0);
+
+    std::thread reader([&]
+        {
+            while (!isStopped) {
+                auto channel = channelManager.getChannelByTransportType(TransportType::LOGGING);
+                if (channel && channel != &channel1 && channel != &channel2) {
+                    ++unexpectedChannelCount;
+                }
+                channelManager.getChannel("id2");
+            }
+        });
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+        channelManager.addChannel(&channel2);
+        channelManager.removeChannel(&channel2);
+    }
+
+    isStopped = true;
+    reader.join();
+
+    BOOST_CHECK_EQUAL(unexpectedChannelCount, 0);
+    BOOST_CHECK(channelManager.getChannelByTransportType(TransportType::LOGGING) == &channel1);
+}
+
+class SyncRecordingChannel : public ConfLogDataChannel {
+public:
+    SyncRecordingChannel(std::vector<std::string>& syncLog, const std::string& id)
+        : syncLog_(syncLog)
+    {
+        id_ = id;
+        protocolId_ = TransportProtocolIdConstants::HTTP_TRANSPORT_ID;
+        serverType_ = ServerType::OPERATIONS;
+    }
+
+    virtual const std::map<TransportType, ChannelDirection>& getSupportedTransportTypes() const {
+        return id_ == "events" ? EVENT_TYPES : ConfLogDataChannel::getSupportedTransportTypes();
+    }
+
+    virtual void sync(TransportType type) { syncLog_.push_back(id_ + ":" + LoggingUtils::toString(type)); }
+    virtual void syncAll() { syncLog_.push_back(id_ + ":all"); }
+
+private:
+    std::vector<std::string>& syncLog_;
+
+    static const std::map<TransportType, ChannelDirection> EVENT_TYPES;
+};
+
+const std::map<TransportType, ChannelDirection> SyncRecordingChannel::EVENT_TYPES =
+{
+        { TransportType::EVENT, ChannelDirection::BIDIRECTIONAL }
+};
+
+BOOST_AUTO_TEST_CASE(MergedSyncTest)
+{
+    MockBootstrapManager BootstrapManager;
+    KaaClientContext clientContext(properties, tmp_logger, context, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext, nullptr);
+
+    std::vector<std::string> syncLog;
+    SyncRecordingChannel confLogChannel(syncLog, "conflog");
+    SyncRecordingChannel eventChannel(syncLog, "events");
+
+    channelManager.setChannel(TransportType::CONFIGURATION, &confLogChannel);
+    channelManager.setChannel(TransportType::LOGGING, &confLogChannel);
+    channelManager.setChannel(TransportType::EVENT, &eventChannel);
+
+    channelManager.sync(TransportType::LOGGING);
+    channelManager.sync(TransportType::CONFIGURATION);
+    channelManager.sync(TransportType::LOGGING);
+    channelManager.sync(TransportType::EVENT);
+    BOOST_CHECK(syncLog.empty());
+
+    std::this_thread::sleep_for(KaaChannelManager::DEFAULT_SYNC_WINDOW * 10);
+
+    // Events go first, the configuration and logs are merged into one sync.
+    const std::vector<std::string> expectedLog = { "events:" + LoggingUtils::toString(TransportType::EVENT),
+                                                   "conflog:all" };
+    BOOST_CHECK_EQUAL_COLLECTIONS(syncLog.begin(), syncLog.end(), expectedLog.begin(), expectedLog.end());
+
+    syncLog.clear();
+    channelManager.setSyncWindow(std::chrono::milliseconds::zero());
+    channelManager.sync(TransportType::LOGGING);
+    BOOST_REQUIRE_EQUAL(syncLog.size(), 1);
+    BOOST_CHECK_EQUAL(syncLog.front(), "conflog:" + LoggingUtils::toString(TransportType::LOGGING));
+
+    BOOST_CHECK_THROW(channelManager.sync(TransportType::PROFILE), KaaException);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
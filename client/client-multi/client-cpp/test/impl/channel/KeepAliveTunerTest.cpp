@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "kaa/channel/KeepAliveTuner.hpp"
+
+namespace kaa {
+
+static const std::chrono::seconds MIN_INTERVAL(30);
+static const std::chrono::seconds MAX_INTERVAL(180);
+
+BOOST_AUTO_TEST_SUITE(KeepAliveTunerTestSuite)
+
+BOOST_AUTO_TEST_CASE(ProbeUpToMaxIntervalTest)
+{
+    KeepAliveTuner tuner(MIN_INTERVAL, MAX_INTERVAL);
+    BOOST_CHECK_EQUAL(tuner.getInterval().count(), 30);
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 0);
+
+    const std::int64_t expectedIntervals[] = { 45, 67, 100, 150, 180 };
+    for (auto expected : expectedIntervals) {
+        BOOST_CHECK(!tuner.onKeepAliveSucceeded(tuner.getInterval()));
+        BOOST_CHECK_EQUAL(tuner.getInterval().count(), expected);
+    }
+
+    BOOST_CHECK(tuner.onKeepAliveSucceeded(tuner.getInterval()));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 180);
+}
+
+BOOST_AUTO_TEST_CASE(ShortIdleTimeIsIgnoredTest)
+{
+    KeepAliveTuner tuner(MIN_INTERVAL, MAX_INTERVAL);
+    BOOST_CHECK(!tuner.onKeepAliveSucceeded(std::chrono::seconds(10)));
+    BOOST_CHECK_EQUAL(tuner.getInterval().count(), 30);
+}
+
+BOOST_AUTO_TEST_CASE(SettleBelowLimitTest)
+{
+    KeepAliveTuner tuner(MIN_INTERVAL, MAX_INTERVAL);
+    tuner.onKeepAliveSucceeded(std::chrono::seconds(30));
+    tuner.onKeepAliveSucceeded(std::chrono::seconds(45));
+    tuner.onKeepAliveSucceeded(std::chrono::seconds(67));
+    BOOST_CHECK_EQUAL(tuner.getInterval().count(), 100);
+
+    BOOST_CHECK(tuner.onKeepAliveFailed(std::chrono::seconds(100)));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 90);
+
+    // The settled interval fails too: settle lower, but not below the interval known to be safe.
+    BOOST_CHECK(tuner.onKeepAliveFailed(std::chrono::seconds(90)));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 81);
+
+    BOOST_CHECK(!tuner.onKeepAliveSucceeded(std::chrono::seconds(81)));
+    BOOST_CHECK(!tuner.onKeepAliveFailed(std::chrono::seconds(75)));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 81);
+}
+
+BOOST_AUTO_TEST_CASE(RestoreTest)
+{
+    KeepAliveTuner tuner(MIN_INTERVAL, MAX_INTERVAL);
+    tuner.restore(std::chrono::seconds(0));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 0);
+
+    tuner.restore(std::chrono::seconds(500));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 0);
+
+    tuner.restore(std::chrono::seconds(120));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 120);
+    BOOST_CHECK_EQUAL(tuner.getInterval().count(), 120);
+}
+
+BOOST_AUTO_TEST_CASE(ReprobeAfterRepeatedFailuresTest)
+{
+    KeepAliveTuner tuner(MIN_INTERVAL, MAX_INTERVAL);
+    tuner.restore(std::chrono::seconds(120));
+
+    BOOST_CHECK(!tuner.onKeepAliveFailed(std::chrono::seconds(120)));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 120);
+
+    BOOST_CHECK(!tuner.onKeepAliveFailed(std::chrono::seconds(120)));
+    BOOST_CHECK_EQUAL(tuner.getSettledInterval().count(), 0);
+    BOOST_CHECK_EQUAL(tuner.getInterval().count(), 30);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
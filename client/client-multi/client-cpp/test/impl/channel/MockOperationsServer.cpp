@@ -0,0 +1,485 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "headers/channel/MockOperationsServer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <vector>
+
+#include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/kaatcp/ConnackMessage.hpp"
+#include "kaa/kaatcp/KaaSyncRequest.hpp"
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaEncoderDecoder.hpp"
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+#endif
+
+#include "headers/KaaTestUtils.hpp"
+
+namespace kaa {
+
+static const std::int32_t ACCESS_POINT_ID = 0x10CA1;
+
+/*
+ * Offsets of fields in the variable header of CONNECT and KAASYNC.
+ */
+static const std::size_t CONNECT_SESSION_KEY_FLAGS_OFFSET = 14;
+static const std::size_t CONNECT_SIGNATURE_FLAGS_OFFSET   = 15;
+static const std::size_t KAASYNC_MESSAGE_ID_OFFSET        = 9;
+static const std::size_t KAASYNC_FLAGS_OFFSET             = 11;
+
+/*
+ * A connection of an endpoint. All its methods are called on the server thread.
+ */
+class MockOperationsServer::Session : public std::enable_shared_from_this<Session> {
+public:
+    explicit Session(MockOperationsServer& server)
+        : server_(server), socket_(server.ioService_) {}
+
+    boost::asio::ip::tcp::socket& getSocket() { return socket_; }
+
+    void start()
+    {
+        boost::system::error_code errorCode;
+        socket_.set_option(boost::asio::ip::tcp::no_delay(true), errorCode);
+        read();
+    }
+
+    void close()
+    {
+        boost::system::error_code errorCode;
+        socket_.close(errorCode);
+    }
+
+private:
+    void read()
+    {
+        auto self(shared_from_this());
+        socket_.async_read_some(boost::asio::buffer(readBuffer_),
+                [this, self] (const boost::system::error_code& err, std::size_t bytesRead)
+                {
+                    if (err) {
+                        close();
+                        return;
+                    }
+
+                    input_.insert(input_.end(), readBuffer_.begin(), readBuffer_.begin() + bytesRead);
+
+                    try {
+                        processFrames();
+                    } catch (const std::exception&) {
+                        close();
+                    }
+
+                    if (socket_.is_open()) {
+                        read();
+                    }
+                });
+    }
+
+    /*
+     * Processes all complete KaaTcp frames of the input, the incomplete one is kept until more data is read.
+     */
+    void processFrames()
+    {
+        std::size_t offset = 0;
+        while (input_.size() - offset >= 2 && socket_.is_open()) {
+            std::uint32_t length = 0;
+            std::size_t lengthBytes = 0;
+            bool isLengthComplete = false;
+
+            for (std::size_t i = offset + 1; i < input_.size() && lengthBytes < KaaTcpCommon::MAX_LENGTH_BYTES; ++i) {
+                length |= static_cast<std::uint32_t>(input_[i] & ~KaaTcpCommon::FIRST_BIT) << (7 * lengthBytes++);
+                if (!(input_[i] & KaaTcpCommon::FIRST_BIT)) {
+                    isLengthComplete = true;
+                    break;
+                }
+            }
+
+            if (!isLengthComplete) {
+                if (lengthBytes == KaaTcpCommon::MAX_LENGTH_BYTES) {
+                    throw KaaException("Bad KaaTcp message length");
+                }
+                break;
+            }
+
+            const std::size_t headerSize = 1 + lengthBytes;
+            if (input_.size() - offset < headerSize + length) {
+                break;
+            }
+
+            auto messageType = static_cast<KaaTcpMessageType>(input_[offset] >> 4);
+            const std::uint8_t *payload = input_.data() + offset + headerSize;
+            offset += headerSize + length;
+
+            switch (messageType) {
+                case KaaTcpMessageType::MESSAGE_CONNECT:
+                    onConnect(payload, length);
+                    break;
+                case KaaTcpMessageType::MESSAGE_KAASYNC:
+                    onKaaSync(payload, length);
+                    break;
+                case KaaTcpMessageType::MESSAGE_PINGREQ:
+                    send({ static_cast<std::uint8_t>(static_cast<std::uint8_t>(KaaTcpMessageType::MESSAGE_PINGRESP) << 4), 0 });
+                    break;
+                case KaaTcpMessageType::MESSAGE_DISCONNECT:
+                    close();
+                    break;
+                default:
+                    throw KaaException("Unexpected KaaTcp message");
+            }
+        }
+
+        input_.erase(input_.begin(), input_.begin() + offset);
+    }
+
+    void onConnect(const std::uint8_t *payload, std::size_t size)
+    {
+        if (size < KaaTcpCommon::KAA_CONNECT_HEADER_LENGTH) {
+            throw KaaException("Bad CONNECT message");
+        }
+
+        /*
+         * Session tickets aren't issued, so endpoints always send the session key.
+         */
+        if (payload[CONNECT_SESSION_KEY_FLAGS_OFFSET] != KaaTcpCommon::KAA_CONNECT_SESSION_KEY_FLAGS) {
+            sendConnack(ConnackReturnCode::REFUSE_BAD_CREDENTIALS);
+            return;
+        }
+
+        const std::size_t sessionKeyLength = KEY_LENGTH / 8;
+        const std::size_t signatureLength =
+                payload[CONNECT_SIGNATURE_FLAGS_OFFSET] == KaaTcpCommon::KAA_CONNECT_SIGNATURE_FLAGS ? KEY_LENGTH / 8 : 0;
+
+        std::size_t offset = KaaTcpCommon::KAA_CONNECT_HEADER_LENGTH;
+        if (size < offset + sessionKeyLength + signatureLength) {
+            throw KaaException("Bad CONNECT message");
+        }
+
+        auto sessionKey = server_.decryptSessionKey(payload + offset, sessionKeyLength);
+        offset += sessionKeyLength + signatureLength;
+
+        encDec_.reset(new RsaEncoderDecoder(PublicKey(), PrivateKey(), PublicKey(), sessionKey, server_.context_));
+        ++server_.connectCount_;
+
+        sendConnack(ConnackReturnCode::ACCEPTED);
+
+        /*
+         * The response to the sync request of CONNECT has zero message id.
+         */
+        onSyncRequest(std::vector<std::uint8_t>(payload + offset, payload + size), 0, false, true);
+    }
+
+    void onKaaSync(const std::uint8_t *payload, std::size_t size)
+    {
+        if (!encDec_ || size < KaaTcpCommon::KAA_SYNC_HEADER_LENGTH) {
+            throw KaaException("Unexpected KAASYNC message");
+        }
+
+        const std::uint16_t messageId = (payload[KAASYNC_MESSAGE_ID_OFFSET] << 8) | payload[KAASYNC_MESSAGE_ID_OFFSET + 1];
+        const std::uint8_t flags = payload[KAASYNC_FLAGS_OFFSET];
+
+        onSyncRequest(std::vector<std::uint8_t>(payload + KaaTcpCommon::KAA_SYNC_HEADER_LENGTH, payload + size),
+                      messageId, flags & KaaTcpCommon::KAA_SYNC_ZIPPED_BIT, flags & KaaTcpCommon::KAA_SYNC_ENCRYPTED_BIT);
+    }
+
+    void onSyncRequest(std::vector<std::uint8_t>&& body, std::uint16_t messageId, bool zipped, bool encrypted)
+    {
+        if (encrypted) {
+            body.resize(encDec_->decodeDataInPlace(body.data(), body.size()));
+        }
+
+        if (zipped) {
+#ifdef KAA_USE_KAASYNC_COMPRESSION
+            body = KaaSyncCompressor::decompress(body.data(), body.size());
+#else
+            throw KaaException("Compressed KAASYNC is not supported");
+#endif
+        }
+
+        SyncRequest request;
+        AvroByteArrayConverter<SyncRequest>().fromByteArray(body.data(), body.size(), request);
+
+        SyncResponse response;
+        server_.createResponse(request, response, lastEventSeqNum_);
+
+        std::vector<std::uint8_t> encodedResponse;
+        AvroByteArrayConverter<SyncResponse>().toByteArray(response, encodedResponse);
+        encDec_->encodeDataInPlace(encodedResponse);
+
+        auto frame = KaaSyncRequest::createHeader(false, true, messageId, encodedResponse.size(), KaaSyncMessageType::SYNC);
+        frame.back() &= ~KaaTcpCommon::KAA_SYNC_REQUEST_BIT;
+        frame.insert(frame.end(), encodedResponse.begin(), encodedResponse.end());
+        send(std::move(frame));
+    }
+
+    void sendConnack(ConnackReturnCode code)
+    {
+        send({ static_cast<std::uint8_t>(static_cast<std::uint8_t>(KaaTcpMessageType::MESSAGE_CONNACK) << 4), 2,
+               0, static_cast<std::uint8_t>(code) });
+    }
+
+    void send(std::vector<std::uint8_t>&& frame)
+    {
+        output_.push_back(std::move(frame));
+        if (output_.size() == 1) {
+            write();
+        }
+    }
+
+    void write()
+    {
+        auto self(shared_from_this());
+        boost::asio::async_write(socket_, boost::asio::buffer(output_.front()),
+                [this, self] (const boost::system::error_code& err, std::size_t bytesWritten)
+                {
+                    if (err) {
+                        close();
+                        return;
+                    }
+
+                    output_.pop_front();
+                    if (!output_.empty()) {
+                        write();
+                    }
+                });
+    }
+
+private:
+    MockOperationsServer& server_;
+    boost::asio::ip::tcp::socket socket_;
+
+    std::array<std::uint8_t, 16 * 1024> readBuffer_;
+    std::vector<std::uint8_t> input_;
+    std::deque<std::vector<std::uint8_t>> output_;
+
+    std::unique_ptr<RsaEncoderDecoder> encDec_;
+    std::int64_t lastEventSeqNum_ = -1;
+};
+
+MockOperationsServer::MockOperationsServer(IKaaClientContext& context)
+    : context_(context)
+    , keys_(KeyUtils().generateKeyPair(KEY_LENGTH))
+    , privateKey_(RsaKeyCache::getPrivateKey(keys_.getPrivateKey()))
+    , sessionKeyDecryptor_(new Botan::PK_Decryptor_EME(privateKey_->getKey(), "EME-PKCS1-v1_5"))
+    , acceptor_(ioService_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+{
+    port_ = acceptor_.local_endpoint().port();
+    accept();
+    thread_ = std::thread([this] { ioService_.run(); });
+}
+
+MockOperationsServer::~MockOperationsServer()
+{
+    stop();
+}
+
+ITransportConnectionInfoPtr MockOperationsServer::getConnectionInfo() const
+{
+    return KaaTestUtils::createTransportConnectionInfo(ServerType::OPERATIONS, ACCESS_POINT_ID,
+                                                       TransportProtocolIdConstants::TCP_TRANSPORT_ID,
+                                                       KaaTestUtils::serializeConnectionInfo("127.0.0.1", port_,
+                                                                                             keys_.getPublicKey()));
+}
+
+void MockOperationsServer::stop()
+{
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    ioService_.post([this]
+        {
+            boost::system::error_code errorCode;
+            acceptor_.close(errorCode);
+
+            for (auto& session : sessions_) {
+                if (auto sessionPtr = session.lock()) {
+                    sessionPtr->close();
+                }
+            }
+            sessions_.clear();
+        });
+
+    thread_.join();
+}
+
+void MockOperationsServer::accept()
+{
+    auto session = std::make_shared<Session>(*this);
+    acceptor_.async_accept(session->getSocket(), [this, session] (const boost::system::error_code& err)
+        {
+            if (err) {
+                return;
+            }
+
+            sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(),
+                                           [] (const std::weak_ptr<Session>& s) { return s.expired(); }),
+                            sessions_.end());
+            sessions_.push_back(session);
+
+            session->start();
+            accept();
+        });
+}
+
+SessionKey MockOperationsServer::decryptSessionKey(const std::uint8_t *data, std::size_t size)
+{
+    const auto& bits = sessionKeyDecryptor_->decrypt(data, size);
+    return SessionKey(bits.data(), bits.size());
+}
+
+void MockOperationsServer::createResponse(const SyncRequest& request, SyncResponse& response,
+                                          std::int64_t& lastEventSeqNum)
+{
+    ++syncCount_;
+
+    response.requestId = request.requestId;
+    response.status = SyncResponseResultType::SUCCESS;
+    response.bootstrapSyncResponse.set_null();
+    response.profileSyncResponse.set_null();
+    response.configurationSyncResponse.set_null();
+    response.notificationSyncResponse.set_null();
+    response.userSyncResponse.set_null();
+    response.eventSyncResponse.set_null();
+    response.redirectSyncResponse.set_null();
+    response.logSyncResponse.set_null();
+    response.extensionSyncResponses.set_null();
+
+    if (!request.profileSyncRequest.is_null()) {
+        ProfileSyncResponse profileResponse;
+        profileResponse.responseStatus = SyncResponseStatus::DELTA;
+        response.profileSyncResponse.set_ProfileSyncResponse(profileResponse);
+    }
+
+    if (!request.logSyncRequest.is_null()) {
+        const auto& logRequest = request.logSyncRequest.get_LogSyncRequest();
+
+        LogSyncResponse logResponse;
+        logResponse.deliveryStatuses.set_null();
+
+        if (!logRequest.logEntries.is_null()) {
+            logRecordCount_ += logRequest.logEntries.get_array().size();
+
+            LogDeliveryStatus status;
+            status.requestId = logRequest.requestId;
+            status.result = SyncResponseResultType::SUCCESS;
+            status.errorCode.set_null();
+            logResponse.deliveryStatuses.set_array({ status });
+        }
+
+        response.logSyncResponse.set_LogSyncResponse(logResponse);
+    }
+
+    if (!request.eventSyncRequest.is_null()) {
+        const auto& eventRequest = request.eventSyncRequest.get_EventSyncRequest();
+
+        EventSyncResponse eventResponse;
+        eventResponse.eventSequenceNumberResponse.set_null();
+        eventResponse.eventListenersResponses.set_null();
+        eventResponse.events.set_null();
+
+        /*
+         * Events are resent until their sync response is received, so only ones with new sequence numbers count.
+         */
+        if (!eventRequest.events.is_null()) {
+            for (const auto& event : eventRequest.events.get_array()) {
+                if (event.seqNum > lastEventSeqNum) {
+                    lastEventSeqNum = event.seqNum;
+                    ++eventCount_;
+                }
+            }
+        }
+
+        if (!eventRequest.eventSequenceNumberRequest.is_null()) {
+            EventSequenceNumberResponse sequenceNumberResponse;
+            sequenceNumberResponse.seqNum = std::max<std::int64_t>(lastEventSeqNum, 0);
+            eventResponse.eventSequenceNumberResponse.set_EventSequenceNumberResponse(sequenceNumberResponse);
+        }
+
+        if (!eventRequest.eventListenersRequests.is_null()) {
+            std::vector<EventListenersResponse> listenersResponses;
+            for (const auto& listenersRequest : eventRequest.eventListenersRequests.get_array()) {
+                EventListenersResponse listenersResponse;
+                listenersResponse.requestId = listenersRequest.requestId;
+                listenersResponse.listeners.set_array(std::vector<std::string>());
+                listenersResponse.result = SyncResponseResultType::SUCCESS;
+                listenersResponses.push_back(listenersResponse);
+            }
+            eventResponse.eventListenersResponses.set_array(listenersResponses);
+        }
+
+        response.eventSyncResponse.set_EventSyncResponse(eventResponse);
+    }
+
+    if (!request.userSyncRequest.is_null()) {
+        const auto& userRequest = request.userSyncRequest.get_UserSyncRequest();
+
+        UserSyncResponse userResponse;
+        userResponse.userAttachResponse.set_null();
+        userResponse.userAttachNotification.set_null();
+        userResponse.userDetachNotification.set_null();
+        userResponse.endpointAttachResponses.set_null();
+        userResponse.endpointDetachResponses.set_null();
+
+        if (!userRequest.userAttachRequest.is_null()) {
+            UserAttachResponse attachResponse;
+            attachResponse.result = SyncResponseResultType::SUCCESS;
+            attachResponse.errorCode.set_null();
+            attachResponse.errorReason.set_null();
+            userResponse.userAttachResponse.set_UserAttachResponse(attachResponse);
+        }
+
+        /*
+         * Access tokens stand for key hashes of attached endpoints.
+         */
+        if (!userRequest.endpointAttachRequests.is_null()) {
+            std::vector<EndpointAttachResponse> attachResponses;
+            for (const auto& attachRequest : userRequest.endpointAttachRequests.get_array()) {
+                EndpointAttachResponse attachResponse;
+                attachResponse.requestId = attachRequest.requestId;
+                attachResponse.endpointKeyHash.set_string(attachRequest.endpointAccessToken);
+                attachResponse.result = SyncResponseResultType::SUCCESS;
+                attachResponses.push_back(attachResponse);
+            }
+            userResponse.endpointAttachResponses.set_array(attachResponses);
+        }
+
+        if (!userRequest.endpointDetachRequests.is_null()) {
+            std::vector<EndpointDetachResponse> detachResponses;
+            for (const auto& detachRequest : userRequest.endpointDetachRequests.get_array()) {
+                EndpointDetachResponse detachResponse;
+                detachResponse.requestId = detachRequest.requestId;
+                detachResponse.result = SyncResponseResultType::SUCCESS;
+                detachResponses.push_back(detachResponse);
+            }
+            userResponse.endpointDetachResponses.set_array(detachResponses);
+        }
+
+        response.userSyncResponse.set_UserSyncResponse(userResponse);
+    }
+
+    if (responseHook_) {
+        responseHook_(request, response);
+    }
+}
+
+} /* namespace kaa */
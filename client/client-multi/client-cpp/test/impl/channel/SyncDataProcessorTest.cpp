@@ -19,8 +19,11 @@
 #include <memory>
 
 #include <kaa/channel/SyncDataProcessor.hpp>
+#include <kaa/channel/MetaDataTransport.hpp>
 
 #include "headers/channel/transport/MockProfileTransport.hpp"
+#include "headers/channel/transport/MockConfigurationTransport.hpp"
+#include "headers/channel/transport/MockLoggingTransport.hpp"
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/KaaClientContext.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
@@ -87,6 +90,294 @@ BOOST_AUTO_TEST_CASE(GlobalProfileResyncTest)
     BOOST_CHECK(statePtr->isProfileResyncNeeded_);
 }
 
+BOOST_AUTO_TEST_CASE(InPlaceResponseProcessingTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+
+    auto profileTransportMock = std::make_shared<MockProfileTransport>();
+
+    SyncDataProcessor syncDataProcessor(IMetaDataTransportPtr()
+                                      , IBootstrapTransportPtr()
+                                      , profileTransportMock
+                                      , IConfigurationTransportPtr()
+                                      , INotificationTransportPtr()
+                                      , IUserTransportPtr()
+                                      , IEventTransportPtr()
+                                      , ILoggingTransportPtr()
+                                      , IRedirectionTransportPtr()
+                                      , clientContext);
+
+    auto syncResponse = createEmptySuccessSyncResponse();
+    syncResponse.status = SyncResponseResultType::PROFILE_RESYNC;
+
+    /*
+     * The response is decoded from the middle of a larger buffer, as channels do.
+     */
+    const std::vector<std::uint8_t> header = { 0xAA, 0xBB };
+    std::vector<std::uint8_t> buffer(header);
+    AvroByteArrayConverter<SyncResponse> responseConverter;
+    responseConverter.appendToByteArray(syncResponse, buffer);
+    buffer.push_back(0xCC);
+
+    IKaaDataDemultiplexer& demultiplexer = syncDataProcessor;
+    BOOST_CHECK(demultiplexer.processResponse(buffer.data() + header.size(), buffer.size() - header.size() - 1)
+                    == DemultiplexerReturnCode::SUCCESS);
+
+    BOOST_CHECK_EQUAL(profileTransportMock->onSync_, 1);
+    BOOST_CHECK_EQUAL(statePtr->onSetProfileResyncNeeded_, 1);
+
+    BOOST_CHECK(demultiplexer.processResponse(nullptr, 0) == DemultiplexerReturnCode::FAILURE);
+}
+
+BOOST_AUTO_TEST_CASE(CompileRequestIntoBufferTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+
+    EndpointObjectHash publicKeyHash(std::string("publicKey"));
+    auto metaDataTransport = std::make_shared<MetaDataTransport>(statePtr, publicKeyHash, 60);
+    SyncDataProcessor syncDataProcessor(metaDataTransport
+                                      , IBootstrapTransportPtr()
+                                      , IProfileTransportPtr()
+                                      , IConfigurationTransportPtr()
+                                      , INotificationTransportPtr()
+                                      , IUserTransportPtr()
+                                      , IEventTransportPtr()
+                                      , ILoggingTransportPtr()
+                                      , IRedirectionTransportPtr()
+                                      , clientContext);
+
+    const std::map<TransportType, ChannelDirection> transportTypes;
+    AvroByteArrayConverter<SyncRequest> requestConverter;
+
+    auto encodedRequest = syncDataProcessor.compileRequest(transportTypes);
+    BOOST_CHECK_EQUAL(requestConverter.fromByteArray(encodedRequest.data(), encodedRequest.size()).requestId, 1);
+
+    /*
+     * The request is appended after the header room reserved by a channel.
+     */
+    const std::vector<std::uint8_t> header = { 0xAA, 0xBB, 0xCC };
+    std::vector<std::uint8_t> buffer(header);
+    IKaaDataMultiplexer& multiplexer = syncDataProcessor;
+    multiplexer.compileRequest(transportTypes, buffer);
+
+    BOOST_REQUIRE(buffer.size() > header.size());
+    BOOST_CHECK(std::equal(header.begin(), header.end(), buffer.begin()));
+    BOOST_CHECK_EQUAL(requestConverter.fromByteArray(buffer.data() + header.size(),
+                                                     buffer.size() - header.size()).requestId, 2);
+
+    AvroChunkedOutputStream stream;
+    multiplexer.compileRequest(transportTypes, stream);
+
+    std::vector<std::uint8_t> chunkedRequest(stream.byteCount());
+    stream.copyTo(chunkedRequest.data());
+    BOOST_CHECK_EQUAL(requestConverter.fromByteArray(chunkedRequest.data(), chunkedRequest.size()).requestId, 3);
+}
+
+BOOST_AUTO_TEST_CASE(EncodedMetaDataIsReusedTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+
+    statePtr->profileHash_ = { 1, 2, 3 };
+
+    EndpointObjectHash publicKeyHash(std::string("publicKey"));
+    auto metaDataTransport = std::make_shared<MetaDataTransport>(statePtr, publicKeyHash, 60);
+
+    auto encodedMetaData = metaDataTransport->createEncodedSyncRequestMetaData();
+    BOOST_CHECK(encodedMetaData == metaDataTransport->createEncodedSyncRequestMetaData());
+
+    statePtr->profileHash_ = { 4, 5, 6 };
+    BOOST_CHECK(encodedMetaData != metaDataTransport->createEncodedSyncRequestMetaData());
+
+    SyncDataProcessor syncDataProcessor(metaDataTransport
+                                      , IBootstrapTransportPtr()
+                                      , IProfileTransportPtr()
+                                      , IConfigurationTransportPtr()
+                                      , INotificationTransportPtr()
+                                      , IUserTransportPtr()
+                                      , IEventTransportPtr()
+                                      , ILoggingTransportPtr()
+                                      , IRedirectionTransportPtr()
+                                      , clientContext);
+
+    AvroByteArrayConverter<SyncRequest> requestConverter;
+    auto encodedRequest = syncDataProcessor.compileRequest(std::map<TransportType, ChannelDirection>());
+    auto request = requestConverter.fromByteArray(encodedRequest.data(), encodedRequest.size());
+
+    const auto& metaData = request.syncRequestMetaData.get_SyncRequestMetaData();
+    const auto expectedMetaData = metaDataTransport->createSyncRequestMetaData();
+
+    BOOST_CHECK_EQUAL(metaData.sdkToken, expectedMetaData->sdkToken);
+    BOOST_CHECK(metaData.endpointPublicKeyHash.get_bytes() == expectedMetaData->endpointPublicKeyHash.get_bytes());
+    BOOST_CHECK(metaData.profileHash.get_bytes() == statePtr->profileHash_);
+    BOOST_CHECK_EQUAL(metaData.timeout.get_long(), 60);
+}
+
+#ifdef KAA_USE_CONFIGURATION
+BOOST_AUTO_TEST_CASE(DeltaRequestSkipsAcknowledgedSectionsTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+
+    EndpointObjectHash publicKeyHash(std::string("publicKey"));
+    auto metaDataTransport = std::make_shared<MetaDataTransport>(statePtr, publicKeyHash, 60);
+    auto configurationTransport = std::make_shared<MockConfigurationTransport>();
+    configurationTransport->configurationHash_ = { 1, 2, 3 };
+
+    SyncDataProcessor syncDataProcessor(metaDataTransport
+                                      , IBootstrapTransportPtr()
+                                      , std::make_shared<MockProfileTransport>()
+                                      , configurationTransport
+                                      , INotificationTransportPtr()
+                                      , IUserTransportPtr()
+                                      , IEventTransportPtr()
+                                      , ILoggingTransportPtr()
+                                      , IRedirectionTransportPtr()
+                                      , clientContext);
+
+    const std::map<TransportType, ChannelDirection> allTypes = {
+            { TransportType::PROFILE, ChannelDirection::UP },
+            { TransportType::CONFIGURATION, ChannelDirection::BIDIRECTIONAL } };
+    const std::map<TransportType, ChannelDirection> configurationType = {
+            { TransportType::CONFIGURATION, ChannelDirection::BIDIRECTIONAL } };
+
+    AvroByteArrayConverter<SyncRequest> requestConverter;
+    AvroByteArrayConverter<SyncResponse> responseConverter;
+
+    auto compileDeltaRequest = [&] (const std::map<TransportType, ChannelDirection>& types)
+        {
+            std::vector<std::uint8_t> buffer;
+            syncDataProcessor.compileDeltaRequest(types, buffer);
+            return requestConverter.fromByteArray(buffer.data(), buffer.size());
+        };
+
+    auto acknowledgeRequest = [&] (std::int32_t requestId)
+        {
+            auto syncResponse = createEmptySuccessSyncResponse(requestId);
+            ConfigurationSyncResponse configurationResponse;
+            configurationResponse.responseStatus = SyncResponseStatus::NO_DELTA;
+            configurationResponse.confSchemaBody.set_null();
+            configurationResponse.confDeltaBody.set_null();
+            syncResponse.configurationSyncResponse.set_ConfigurationSyncResponse(configurationResponse);
+
+            std::vector<std::uint8_t> serializedResponse;
+            responseConverter.toByteArray(syncResponse, serializedResponse);
+            syncDataProcessor.processResponse(serializedResponse);
+        };
+
+    /*
+     * Nothing is acknowledged yet.
+     */
+    auto request = compileDeltaRequest(allTypes);
+    BOOST_CHECK(!request.configurationSyncRequest.is_null());
+
+    acknowledgeRequest(request.requestId);
+
+    request = compileDeltaRequest(allTypes);
+    BOOST_CHECK(request.configurationSyncRequest.is_null());
+    BOOST_CHECK(!request.syncRequestMetaData.is_null());
+
+    /*
+     * A single requested type and a full request are never skipped.
+     */
+    request = compileDeltaRequest(configurationType);
+    BOOST_CHECK(!request.configurationSyncRequest.is_null());
+
+    auto encodedRequest = syncDataProcessor.compileRequest(allTypes);
+    request = requestConverter.fromByteArray(encodedRequest.data(), encodedRequest.size());
+    BOOST_CHECK(!request.configurationSyncRequest.is_null());
+
+    /*
+     * Changed sections are sent.
+     */
+    configurationTransport->configurationHash_ = { 4, 5, 6 };
+    request = compileDeltaRequest(allTypes);
+    BOOST_CHECK(!request.configurationSyncRequest.is_null());
+
+    acknowledgeRequest(request.requestId);
+    BOOST_CHECK(compileDeltaRequest(allTypes).configurationSyncRequest.is_null());
+
+    /*
+     * A new session forgets acknowledgements.
+     */
+    syncDataProcessor.resetDeltaState();
+    BOOST_CHECK(!compileDeltaRequest(allTypes).configurationSyncRequest.is_null());
+}
+#endif
+
+#ifdef KAA_USE_LOGGING
+BOOST_AUTO_TEST_CASE(EncodedLogSectionTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+
+    EndpointObjectHash publicKeyHash(std::string("publicKey"));
+    auto metaDataTransport = std::make_shared<MetaDataTransport>(statePtr, publicKeyHash, 60);
+    auto loggingTransport = std::make_shared<MockLoggingTransport>();
+
+    SyncDataProcessor syncDataProcessor(metaDataTransport
+                                      , IBootstrapTransportPtr()
+                                      , IProfileTransportPtr()
+                                      , IConfigurationTransportPtr()
+                                      , INotificationTransportPtr()
+                                      , IUserTransportPtr()
+                                      , IEventTransportPtr()
+                                      , loggingTransport
+                                      , IRedirectionTransportPtr()
+                                      , clientContext);
+
+    LogEntry logEntry;
+    logEntry.data = { 1, 2, 3 };
+
+    LogSyncRequest logSyncRequest;
+    logSyncRequest.requestId = 42;
+    logSyncRequest.logEntries.set_array({ logEntry, logEntry });
+
+    auto encodedLogSyncRequest = std::make_shared<std::vector<std::uint8_t>>();
+    AvroByteArrayConverter<LogSyncRequest>().toByteArray(logSyncRequest, *encodedLogSyncRequest);
+    loggingTransport->encodedLogSyncRequest_ = encodedLogSyncRequest;
+
+    const std::map<TransportType, ChannelDirection> loggingType = {
+            { TransportType::LOGGING, ChannelDirection::UP } };
+    AvroByteArrayConverter<SyncRequest> requestConverter;
+
+    auto encodedRequest = syncDataProcessor.compileRequest(loggingType);
+    auto request = requestConverter.fromByteArray(encodedRequest.data(), encodedRequest.size());
+
+    BOOST_CHECK_EQUAL(loggingTransport->onCreateEncodedLogSyncRequest_, 1);
+    BOOST_CHECK_EQUAL(request.requestId, 1);
+    BOOST_REQUIRE(!request.logSyncRequest.is_null());
+    BOOST_CHECK_EQUAL(request.logSyncRequest.get_LogSyncRequest().requestId, 42);
+    BOOST_REQUIRE_EQUAL(request.logSyncRequest.get_LogSyncRequest().logEntries.get_array().size(), 2);
+    BOOST_CHECK(request.logSyncRequest.get_LogSyncRequest().logEntries.get_array()[1].data == logEntry.data);
+
+    /*
+     * No logs to send.
+     */
+    loggingTransport->encodedLogSyncRequest_.reset();
+    encodedRequest = syncDataProcessor.compileRequest(loggingType);
+    request = requestConverter.fromByteArray(encodedRequest.data(), encodedRequest.size());
+    BOOST_CHECK(request.logSyncRequest.is_null());
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
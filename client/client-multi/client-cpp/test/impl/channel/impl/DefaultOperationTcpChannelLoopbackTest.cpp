@@ -0,0 +1,164 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/strategies/RecordCountLogUploadStrategy.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/channel/LoopbackEndpoint.hpp"
+#include "headers/channel/MockOperationsServer.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::chrono::seconds DELIVERY_TIMEOUT(30);
+
+static bool waitFor(const std::function<bool ()>& condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + DELIVERY_TIMEOUT;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(DefaultOperationTcpChannelLoopbackTestSuite)
+
+BOOST_AUTO_TEST_CASE(LogRecordsAreDeliveredTest)
+{
+    const std::size_t RECORD_COUNT = 500;
+
+    MockOperationsServer server(clientContext);
+    LoopbackEndpoint endpoint(server, tmp_logger);
+    endpoint.getLogCollector().setUploadStrategy(
+            std::make_shared<RecordCountLogUploadStrategy>(1, endpoint.getContext()));
+
+    std::vector<RecordFuture> futures;
+    for (std::size_t i = 0; i < RECORD_COUNT; ++i) {
+        KaaUserLogRecord record;
+        record.logdata = "loopback record " + std::to_string(i);
+        futures.push_back(endpoint.getLogCollector().addLogRecord(record));
+    }
+
+    for (auto& future : futures) {
+        BOOST_REQUIRE(future.getFuture().waitFor(DELIVERY_TIMEOUT));
+        BOOST_CHECK_NO_THROW(future.get());
+    }
+
+    BOOST_CHECK_EQUAL(server.getLogRecordCount(), RECORD_COUNT);
+    BOOST_CHECK_EQUAL(server.getConnectCount(), 1);
+
+    auto metrics = endpoint.getChannel().getMetrics();
+    BOOST_CHECK_EQUAL(metrics.connects_, 1);
+    BOOST_CHECK(metrics.syncLatency_.count_ > 0);
+}
+
+BOOST_AUTO_TEST_CASE(EventsReachServerTest)
+{
+    const std::size_t EVENT_COUNT = 500;
+
+    MockOperationsServer server(clientContext);
+    LoopbackEndpoint endpoint(server, tmp_logger);
+
+    const std::vector<std::uint8_t> eventData(32, 0x5A);
+    for (std::size_t i = 0; i < EVENT_COUNT; ++i) {
+        endpoint.getEventManager().produceEvent("org.kaaproject.kaa.loopback.Event", eventData, "",
+                                                TransactionIdPtr());
+    }
+
+    BOOST_CHECK(waitFor([&server, EVENT_COUNT] { return server.getEventCount() >= EVENT_COUNT; }));
+    BOOST_CHECK_EQUAL(server.getEventCount(), EVENT_COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(WarmPauseKeepsConnectionTest)
+{
+    MockOperationsServer server(clientContext);
+    LoopbackEndpoint endpoint(server, tmp_logger);
+    endpoint.getContext().getProperties().setWarmPause(true);
+    endpoint.getLogCollector().setUploadStrategy(
+            std::make_shared<RecordCountLogUploadStrategy>(1, endpoint.getContext()));
+
+    KaaUserLogRecord record;
+    record.logdata = "record before pause";
+    BOOST_REQUIRE(endpoint.getLogCollector().addLogRecord(record).getFuture().waitFor(DELIVERY_TIMEOUT));
+
+    endpoint.getChannel().pause();
+
+    record.logdata = "record during pause";
+    auto future = endpoint.getLogCollector().addLogRecord(record);
+    BOOST_CHECK(!future.getFuture().waitFor(std::chrono::milliseconds(200)));
+    BOOST_CHECK_EQUAL(server.getLogRecordCount(), 1);
+
+    endpoint.getChannel().resume();
+
+    BOOST_REQUIRE(future.getFuture().waitFor(DELIVERY_TIMEOUT));
+    BOOST_CHECK_EQUAL(server.getLogRecordCount(), 2);
+    BOOST_CHECK_EQUAL(server.getConnectCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ResponseHookAmendsResponseTest)
+{
+    MockOperationsServer server(clientContext);
+    server.setResponseHook([] (const SyncRequest& request, SyncResponse& response)
+        {
+            if (!response.logSyncResponse.is_null()) {
+                auto logResponse = response.logSyncResponse.get_LogSyncResponse();
+                if (!logResponse.deliveryStatuses.is_null()) {
+                    auto statuses = logResponse.deliveryStatuses.get_array();
+                    for (auto& status : statuses) {
+                        status.result = SyncResponseResultType::FAILURE;
+                        status.errorCode.set_LogDeliveryErrorCode(LogDeliveryErrorCode::NO_APPENDERS_CONFIGURED);
+                    }
+                    logResponse.deliveryStatuses.set_array(statuses);
+                    response.logSyncResponse.set_LogSyncResponse(logResponse);
+                }
+            }
+        });
+
+    LoopbackEndpoint endpoint(server, tmp_logger);
+    endpoint.getLogCollector().setUploadStrategy(
+            std::make_shared<RecordCountLogUploadStrategy>(1, endpoint.getContext()));
+
+    KaaUserLogRecord record;
+    record.logdata = "rejected record";
+    auto future = endpoint.getLogCollector().addLogRecord(record);
+
+    BOOST_CHECK(waitFor([&server] { return server.getLogRecordCount() > 0; }));
+    BOOST_CHECK(!future.getFuture().waitFor(std::chrono::milliseconds(100)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "kaa/channel/impl/SharedMemoryDataChannel.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/KaaClientProperties.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/channel/MockKaaDataMultiplexer.hpp"
+
+namespace kaa {
+
+static const char *testSegmentName = "/kaa-test-shm-data-channel";
+static const std::size_t testRingSize = 256;
+static const std::size_t testHeaderSize = 320;
+
+// Offsets of the indexes, see kaa_shm_channel.h in the C SDK
+static const std::size_t uplinkWrite = 64;
+static const std::size_t uplinkRead = 128;
+static const std::size_t downlinkWrite = 192;
+static const std::size_t downlinkRead = 256;
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+class MockKaaDataDemultiplexer : public IKaaDataDemultiplexer {
+public:
+    virtual DemultiplexerReturnCode processResponse(const std::vector<std::uint8_t> &response) {
+        responses_.push_back(response);
+        return DemultiplexerReturnCode::SUCCESS;
+    }
+
+    std::vector<std::vector<std::uint8_t>> responses_;
+};
+
+// Plays the proxy: attaches to the segment the channel has created
+class TestProxy {
+public:
+    TestProxy() {
+        int fd = shm_open(testSegmentName, O_RDWR, 0);
+        BOOST_REQUIRE(fd >= 0);
+        segment_ = static_cast<std::uint8_t *>(mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        close(fd);
+        BOOST_REQUIRE(segment_ != MAP_FAILED);
+    }
+
+    ~TestProxy() { munmap(segment_, size_); }
+
+    volatile std::uint32_t& index(std::size_t offset) {
+        return *reinterpret_cast<volatile std::uint32_t *>(segment_ + offset);
+    }
+
+    std::uint8_t *uplink() { return segment_ + testHeaderSize; }
+    std::uint8_t *downlink() { return segment_ + testHeaderSize + testRingSize; }
+
+private:
+    const std::size_t size_ = testHeaderSize + 2 * testRingSize;
+    std::uint8_t *segment_ = nullptr;
+};
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate)
+{
+    for (std::size_t i = 0; i < 1000 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+BOOST_AUTO_TEST_SUITE(SharedMemoryDataChannelTestSuite)
+
+BOOST_AUTO_TEST_CASE(SegmentLayoutTest)
+{
+    shm_unlink(testSegmentName);
+    SharedMemoryDataChannel channel(clientContext, testSegmentName, testRingSize);
+    TestProxy proxy;
+
+    BOOST_CHECK_EQUAL(proxy.index(0), 0x4D48534Bu);
+    BOOST_CHECK_EQUAL(proxy.index(4), 1u);
+    BOOST_CHECK_EQUAL(proxy.index(8), testRingSize);
+    BOOST_CHECK_EQUAL(proxy.index(12), 0xf291f2d4u);
+
+    BOOST_CHECK_THROW(SharedMemoryDataChannel(clientContext, testSegmentName, testRingSize * 2), KaaException);
+    BOOST_CHECK_THROW(SharedMemoryDataChannel(clientContext, "/kaa-test-shm-bad-size", 100), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(UplinkTest)
+{
+    shm_unlink(testSegmentName);
+    MockKaaDataMultiplexer multiplexer;
+    multiplexer.compiledData_ = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25 };
+
+    SharedMemoryDataChannel channel(clientContext, testSegmentName, testRingSize, std::chrono::milliseconds(1));
+    channel.setMultiplexer(&multiplexer);
+    TestProxy proxy;
+
+    channel.sync(TransportType::PROFILE);
+    BOOST_CHECK_EQUAL(multiplexer.onCompileRequest_, 1u);
+    BOOST_CHECK_EQUAL(proxy.index(uplinkWrite), sizeof(std::uint32_t) + 28);
+    BOOST_CHECK_EQUAL(*reinterpret_cast<std::uint32_t *>(proxy.uplink()), multiplexer.compiledData_.size());
+    BOOST_CHECK(!std::memcmp(proxy.uplink() + sizeof(std::uint32_t), multiplexer.compiledData_.data(),
+                             multiplexer.compiledData_.size()));
+
+    // The proxy doesn't read, the requests pile up until the ring is full
+    std::uint32_t lastWriteIndex;
+    do {
+        lastWriteIndex = proxy.index(uplinkWrite);
+        channel.syncAll();
+    } while (proxy.index(uplinkWrite) != lastWriteIndex);
+    BOOST_CHECK(proxy.index(uplinkWrite) - proxy.index(uplinkRead) <= testRingSize);
+
+    // The postponed request is written by the poll thread once the proxy frees the space
+    proxy.index(uplinkRead) = lastWriteIndex;
+    BOOST_CHECK(waitFor([&] { return proxy.index(uplinkWrite) != lastWriteIndex; }));
+}
+
+BOOST_AUTO_TEST_CASE(DownlinkTest)
+{
+    shm_unlink(testSegmentName);
+    MockKaaDataDemultiplexer demultiplexer;
+    std::vector<std::uint8_t> response = { 0xAA, 0xBB, 0xCC, 0xDD, 0xEE };
+
+    SharedMemoryDataChannel channel(clientContext, testSegmentName, testRingSize, std::chrono::milliseconds(1));
+    channel.setDemultiplexer(&demultiplexer);
+    TestProxy proxy;
+
+    // The second record doesn't fit before the ring end and follows a padding marker
+    channel.pause();
+    std::uint32_t writeIndex = testRingSize - 16;
+    proxy.index(downlinkRead) = writeIndex;
+    proxy.index(downlinkWrite) = writeIndex;
+
+    *reinterpret_cast<std::uint32_t *>(proxy.downlink() + writeIndex) = response.size();
+    std::memcpy(proxy.downlink() + writeIndex + sizeof(std::uint32_t), response.data(), response.size());
+    *reinterpret_cast<std::uint32_t *>(proxy.downlink() + writeIndex + 12) = 0xFFFFFFFF;
+    *reinterpret_cast<std::uint32_t *>(proxy.downlink()) = response.size();
+    std::memcpy(proxy.downlink() + sizeof(std::uint32_t), response.data(), response.size());
+    proxy.index(downlinkWrite) = testRingSize + 12;
+    channel.resume();
+
+    BOOST_CHECK(waitFor([&] { return proxy.index(downlinkRead) == testRingSize + 12; }));
+    BOOST_REQUIRE_EQUAL(demultiplexer.responses_.size(), 2u);
+    BOOST_CHECK(demultiplexer.responses_[0] == response);
+    BOOST_CHECK(demultiplexer.responses_[1] == response);
+    BOOST_CHECK_EQUAL(channel.getMetrics().framesReceived_, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownTest)
+{
+    shm_unlink(testSegmentName);
+    {
+        SharedMemoryDataChannel channel(clientContext, testSegmentName, testRingSize);
+        channel.shutdown();
+    }
+
+    int fd = shm_open(testSegmentName, O_RDWR, 0);
+    BOOST_CHECK(fd < 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
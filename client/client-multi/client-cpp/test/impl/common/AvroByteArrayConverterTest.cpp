@@ -29,8 +29,11 @@
 #include <avro/Compiler.hh>
 
 #include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/AvroBinaryVectorEncoder.hpp"
+#include "kaa/common/AvroBinaryMemoryDecoder.hpp"
 
 #include "headers/gen/EndpointGen.hpp"
+#include "headers/AllocationCounter.hpp"
 
 namespace kaa {
 
@@ -119,6 +122,157 @@ BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToStream)
     BOOST_CHECK_MESSAGE (res == 0, "Encoded datas aren't equal");
 }
 
+BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToVector)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = std::string(1024, 'B');
+
+    std::ostringstream stream;
+    binaryEncodeDataTo(stream, encodingProfile);
+    const std::string& encodedString = stream.str();
+    const std::vector<std::uint8_t> expectedData(encodedString.begin(), encodedString.end());
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+    std::vector<std::uint8_t> encodedData(16, 0xFF);
+
+    /*
+     * The previous content is replaced, the buffer is reused by subsequent encodings.
+     */
+    for (int i = 0; i < 2; ++i) {
+        converter.toByteArray(encodingProfile, encodedData);
+        BOOST_REQUIRE_EQUAL(encodedData.size(), expectedData.size());
+        BOOST_CHECK(encodedData == expectedData);
+    }
+
+    const std::vector<std::uint8_t> header = { 1, 2, 3 };
+    std::vector<std::uint8_t> appendedData(header);
+    converter.appendToByteArray(encodingProfile, appendedData);
+
+    BOOST_REQUIRE_EQUAL(appendedData.size(), header.size() + expectedData.size());
+    BOOST_CHECK(std::equal(header.begin(), header.end(), appendedData.begin()));
+    BOOST_CHECK(std::equal(appendedData.begin() + header.size(), appendedData.end(), expectedData.begin()));
+}
+
+static void encodePrimitives(avro::Encoder& e)
+{
+    const std::vector<std::uint8_t> bytes = { 0, 1, 0xFF };
+
+    e.encodeNull();
+    e.encodeBool(true);
+    e.encodeInt(0);
+    e.encodeInt(-1);
+    e.encodeInt(INT32_MAX);
+    e.encodeInt(INT32_MIN);
+    e.encodeLong(INT64_MAX);
+    e.encodeLong(INT64_MIN);
+    e.encodeFloat(1.5f);
+    e.encodeDouble(-2.25);
+    e.encodeString("");
+    e.encodeString(std::string(200, 'S'));
+    e.encodeBytes(bytes);
+    e.encodeFixed(bytes);
+    e.encodeEnum(3);
+    e.encodeUnionIndex(1);
+    e.arrayStart();
+    e.setItemCount(2);
+    e.startItem();
+    e.encodeInt(1);
+    e.startItem();
+    e.encodeInt(2);
+    e.arrayEnd();
+    e.mapStart();
+    e.mapEnd();
+    e.flush();
+}
+
+BOOST_AUTO_TEST_CASE(AvroBinaryVectorEncoderCompatibility)
+{
+    std::ostringstream stream;
+    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(stream);
+    avro::EncoderPtr avroEncoder = avro::binaryEncoder();
+    avroEncoder->init(*out);
+    encodePrimitives(*avroEncoder);
+    out->flush();
+
+    const std::string& encodedString = stream.str();
+    const std::vector<std::uint8_t> expectedData(encodedString.begin(), encodedString.end());
+
+    std::vector<std::uint8_t> encodedData;
+    AvroBinaryVectorEncoder encoder(encodedData);
+    encodePrimitives(encoder);
+
+    BOOST_CHECK(encodedData == expectedData);
+
+    AvroBinaryMemoryDecoder decoder(encodedData.data(), encodedData.size());
+    decoder.decodeNull();
+    BOOST_CHECK(decoder.decodeBool());
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), 0);
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), -1);
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), INT32_MAX);
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), INT32_MIN);
+    BOOST_CHECK_EQUAL(decoder.decodeLong(), INT64_MAX);
+    BOOST_CHECK_EQUAL(decoder.decodeLong(), INT64_MIN);
+    BOOST_CHECK_EQUAL(decoder.decodeFloat(), 1.5f);
+    BOOST_CHECK_EQUAL(decoder.decodeDouble(), -2.25);
+    BOOST_CHECK(decoder.decodeString().empty());
+    BOOST_CHECK_EQUAL(decoder.decodeString(), std::string(200, 'S'));
+    BOOST_CHECK(decoder.decodeBytes() == std::vector<std::uint8_t>({ 0, 1, 0xFF }));
+    BOOST_CHECK(decoder.decodeFixed(3) == std::vector<std::uint8_t>({ 0, 1, 0xFF }));
+    BOOST_CHECK_EQUAL(decoder.decodeEnum(), 3);
+    BOOST_CHECK_EQUAL(decoder.decodeUnionIndex(), 1);
+    BOOST_CHECK_EQUAL(decoder.arrayStart(), 2);
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), 1);
+    BOOST_CHECK_EQUAL(decoder.decodeInt(), 2);
+    BOOST_CHECK_EQUAL(decoder.arrayNext(), 0);
+    BOOST_CHECK_EQUAL(decoder.mapStart(), 0);
+
+    BOOST_CHECK_THROW(decoder.decodeInt(), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(AvroEncodingWithHash)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = std::string(1024, 'H');
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+    EndpointObjectHash hash;
+    SharedDataBuffer encodedData = converter.toByteArray(encodingProfile, hash);
+
+    BOOST_CHECK(hash == EndpointObjectHash(encodedData));
+
+    /*
+     * The hashing stream drops the data backed up by the encoder.
+     */
+    std::vector<std::uint8_t> streamData;
+    EndpointObjectHash streamHash;
+    AvroVectorOutputStream out(streamData);
+    AvroHashingOutputStream hashingOut(out, streamHash);
+
+    avro::EncoderPtr encoder = avro::binaryEncoder();
+    encoder->init(hashingOut);
+    encodePrimitives(*encoder);
+    streamHash.finalize();
+
+    BOOST_CHECK(streamHash == EndpointObjectHash(streamData.data(), streamData.size()));
+}
+
+BOOST_AUTO_TEST_CASE(AvroBinaryRecordDecoding)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = std::string(300, 'P');
+
+    std::ostringstream stream;
+    binaryEncodeDataTo(stream, encodingProfile);
+    const std::string& encodedString = stream.str();
+    const std::vector<std::uint8_t> encodedData(encodedString.begin(), encodedString.end());
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+    BOOST_CHECK_EQUAL(converter.fromByteArray(encodedData.data(), encodedData.size()).profileBody,
+                      encodingProfile.profileBody);
+
+    BOOST_CHECK_THROW(converter.fromByteArray(encodedData.data(), encodedData.size() - 1), KaaException);
+}
+
 BOOST_AUTO_TEST_CASE(SimpleAvroBinaryDecoding)
 {
     BasicEndpointProfile encodingProfile;
@@ -187,6 +341,23 @@ BOOST_AUTO_TEST_CASE(AvroJSONEncoding)
     }
 }
 
+BOOST_AUTO_TEST_CASE(EncodingIntoKeptBufferAllocationsTest)
+{
+    const std::string value(1024, 'a');
+    AvroByteArrayConverter<std::string> converter;
+    std::vector<std::uint8_t> buffer;
+    converter.toByteArray(value, buffer);
+
+    /*
+     * The capacity of the buffer is reused, so encoding again doesn't allocate.
+     */
+    AllocationScope scope;
+    converter.toByteArray(value, buffer);
+    KAA_CHECK_MAX_ALLOCATIONS(scope, 0);
+
+    BOOST_CHECK_EQUAL(converter.fromByteArray(buffer.data(), buffer.size()), value);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 };
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "kaa/common/AvroChunkedOutputStream.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
+
+#include "headers/AllocationCounter.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(AvroChunkedOutputStreamSuite)
+
+BOOST_AUTO_TEST_CASE(WriteAcrossChunksTest)
+{
+    AvroChunkPool pool;
+    AvroChunkedOutputStream stream(pool);
+    BOOST_CHECK(stream.empty());
+
+    std::vector<std::uint8_t> data(2 * AvroChunkPool::CHUNK_SIZE + 100);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i);
+    }
+
+    stream.write(data.data(), 10);
+    stream.write(data.data() + 10, data.size() - 10);
+    BOOST_CHECK_EQUAL(stream.byteCount(), data.size());
+
+    const auto& buffers = stream.getBuffers();
+    BOOST_REQUIRE_EQUAL(buffers.size(), 3);
+    BOOST_CHECK_EQUAL(boost::asio::buffer_size(buffers), data.size());
+    BOOST_CHECK_EQUAL(boost::asio::buffer_size(buffers[2]), 100);
+
+    std::vector<std::uint8_t> copied(stream.byteCount());
+    stream.copyTo(copied.data());
+    BOOST_CHECK(copied == data);
+}
+
+BOOST_AUTO_TEST_CASE(ChunkReuseTest)
+{
+    AvroChunkPool pool;
+    const std::vector<std::uint8_t> data(AvroChunkPool::CHUNK_SIZE + 1, 0xAB);
+
+    {
+        AvroChunkedOutputStream stream(pool);
+        stream.write(data.data(), data.size());
+        BOOST_CHECK_EQUAL(pool.getFreeChunkCount(), 0);
+
+        stream.clear();
+        BOOST_CHECK(stream.empty());
+        BOOST_CHECK_EQUAL(pool.getFreeChunkCount(), 2);
+
+        AllocationScope scope;
+        stream.write(data.data(), data.size());
+        KAA_CHECK_MAX_ALLOCATIONS(scope, 0);
+        BOOST_CHECK_EQUAL(pool.getFreeChunkCount(), 0);
+    }
+
+    BOOST_CHECK_EQUAL(pool.getFreeChunkCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(AvroEncodingTest)
+{
+    const std::string value(3 * AvroChunkPool::CHUNK_SIZE, 'a');
+    AvroByteArrayConverter<std::string> converter;
+
+    AvroChunkedOutputStream stream;
+    converter.toByteArray(value, stream);
+
+    std::vector<std::uint8_t> expected;
+    converter.toByteArray(value, expected);
+    BOOST_REQUIRE_EQUAL(stream.byteCount(), expected.size());
+
+    std::vector<std::uint8_t> encoded(stream.byteCount());
+    stream.copyTo(encoded.data());
+    BOOST_CHECK(encoded == expected);
+    BOOST_CHECK_EQUAL(converter.fromByteArray(encoded.data(), encoded.size()), value);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
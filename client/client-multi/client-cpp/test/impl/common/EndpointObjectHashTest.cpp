@@ -110,6 +110,31 @@ BOOST_AUTO_TEST_CASE(CompareCalculationWithSample)
     BOOST_CHECK(sampleBuffer == calculatedHash);
 }
 
+BOOST_AUTO_TEST_CASE(IncrementalHash)
+{
+    /*
+     * Hash of the data passed in parts is the same as of the whole data.
+     */
+    std::string str("Test EndpointObjectHash");
+
+    EndpointObjectHash hash(str);
+    EndpointObjectHash incremental;
+    incremental.update(str.substr(0, 4)).update(str.substr(4));
+    incremental.finalize();
+
+    BOOST_CHECK_EQUAL(incremental.getHashDigest().size(), SHA1_SIZE);
+    BOOST_CHECK(incremental == hash);
+
+    /*
+     * The next hash doesn't depend on the previous one.
+     */
+    incremental.update(str);
+    incremental.finalize();
+    BOOST_CHECK(incremental == hash);
+
+    BOOST_CHECK_THROW(incremental.update(nullptr, 1), KaaException);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } /* namespace kaa */
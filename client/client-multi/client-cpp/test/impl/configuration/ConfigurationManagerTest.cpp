@@ -35,6 +35,7 @@
 #include "kaa/logging/DefaultLogger.hpp"
 
 #include "headers/context/MockExecutorContext.hpp"
+#include "headers/utils/MockThreadPool.hpp"
 #include "headers/MockKaaClientStateStorage.hpp"
 
 namespace kaa {
@@ -63,6 +64,45 @@ private:
 };
 
 
+class QueuedThreadPool : public MockThreadPool {
+public:
+    virtual void add(const ThreadPoolTask& task) { tasks_.push_back(task); }
+
+    void runAll()
+    {
+        auto tasks = std::move(tasks_);
+        tasks_.clear();
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+public:
+    std::vector<ThreadPoolTask> tasks_;
+};
+
+class ConfigurationRecorderMock : public IConfigurationReceiver
+{
+public:
+    virtual void onConfigurationUpdated(const KaaRootConfiguration &configuration)
+    {
+        received_.push_back(configuration.data);
+    }
+
+public:
+    std::vector<std::string> received_;
+};
+
+static std::vector<std::uint8_t> encodeConfiguration(const std::string& data)
+{
+    KaaRootConfiguration configuration;
+    configuration.data = data;
+
+    std::vector<std::uint8_t> encoded;
+    AvroByteArrayConverter<KaaRootConfiguration>().toByteArray(configuration, encoded);
+    return encoded;
+}
+
 BOOST_AUTO_TEST_SUITE(ConfigurationManagerSuite)
 
 BOOST_AUTO_TEST_CASE(configurationUpdated)
@@ -97,6 +137,73 @@ BOOST_AUTO_TEST_CASE(configurationUpdated)
     BOOST_CHECK(checkConfiguration.data == (*rootConfig).data);
 }
 
+BOOST_AUTO_TEST_CASE(unchangedConfigurationIgnored)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    SimpleExecutorContext context;
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+    context.init();
+    ConfigurationManager manager(clientContext);
+    ConfigurationReceiverMock receiver;
+
+    manager.addReceiver(receiver);
+
+    std::vector<std::uint8_t> configuration(getDefaultConfigData().begin(), getDefaultConfigData().end());
+
+    manager.processConfigurationData(configuration, true);
+    testSleep(1);
+    BOOST_CHECK(receiver.isConfigurationReceived());
+
+    receiver.reset();
+    manager.processConfigurationData(configuration, true);
+    testSleep(1);
+    BOOST_CHECK(!receiver.isConfigurationReceived());
+
+    BOOST_CHECK(manager.getConfigurationHash() == EndpointObjectHash(configuration.data(), configuration.size()));
+
+    context.stop();
+}
+
+BOOST_AUTO_TEST_CASE(onlyLatestConfigurationDelivered)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext context;
+    auto threadPool = std::make_shared<QueuedThreadPool>();
+    context.threadPool_ = threadPool;
+    KaaClientProperties properties;
+    DefaultLogger logger(properties.getClientId());
+    KaaClientContext clientContext(properties, logger, context, stateMock);
+    ConfigurationManager manager(clientContext);
+    ConfigurationRecorderMock receiver;
+
+    manager.addReceiver(receiver);
+
+    for (const std::string data : { "first", "second", "third" }) {
+        manager.processConfigurationData(encodeConfiguration(data), true);
+    }
+
+    BOOST_CHECK_EQUAL(threadPool->tasks_.size(), 1);
+    BOOST_CHECK_EQUAL(manager.getConfigurationSnapshot()->data, "third");
+
+    threadPool->runAll();
+    BOOST_REQUIRE_EQUAL(receiver.received_.size(), 1);
+    BOOST_CHECK_EQUAL(receiver.received_.back(), "third");
+
+    /*
+     * A held snapshot isn't affected by updates.
+     */
+    auto snapshot = manager.getConfigurationSnapshot();
+    manager.processConfigurationData(encodeConfiguration("fourth"), true);
+    BOOST_CHECK_EQUAL(snapshot->data, "third");
+    BOOST_CHECK_EQUAL(manager.getConfigurationSnapshot()->data, "fourth");
+
+    threadPool->runAll();
+    BOOST_REQUIRE_EQUAL(receiver.received_.size(), 2);
+    BOOST_CHECK_EQUAL(receiver.received_.back(), "fourth");
+}
+
 BOOST_AUTO_TEST_CASE(configurationPartialUpdated)
 {
     IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
@@ -17,6 +17,10 @@
 
 #include "kaa/configuration/storage/FileConfigurationStorage.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
 #include <boost/test/unit_test.hpp>
 
 namespace kaa {
@@ -36,6 +40,73 @@ BOOST_AUTO_TEST_CASE(fileStorageTest)
     BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), testData, testData + 4);
 }
 
+BOOST_AUTO_TEST_CASE(fileStorageWithHashTest)
+{
+    const std::vector<std::uint8_t> testData = { 't', 'e', 's', 't' };
+    const HashDigest testHash(20, 0xAB);
+    FileConfigurationStorage storage("configuration.bin");
+
+    storage.saveConfigurationWithHash(testData, testHash);
+
+    HashDigest hash;
+    auto result = storage.loadConfigurationWithHash(hash);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), testData.begin(), testData.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(hash.begin(), hash.end(), testHash.begin(), testHash.end());
+
+    /*
+     * The temporary file is renamed over the configuration one.
+     */
+    BOOST_CHECK(!std::ifstream("configuration.bin.tmp").good());
+
+    storage.saveConfiguration(testData);
+    result = storage.loadConfigurationWithHash(hash);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), testData.begin(), testData.end());
+    BOOST_CHECK(hash.empty());
+
+    storage.clearConfiguration();
+}
+
+BOOST_AUTO_TEST_CASE(loadLegacyFileTest)
+{
+    const std::uint8_t testData[] = { 'l', 'e', 'g', 'a', 'c', 'y' };
+    {
+        std::ofstream file("configuration.bin", std::ofstream::binary);
+        file.write(reinterpret_cast<const char *>(testData), sizeof(testData));
+    }
+
+    FileConfigurationStorage storage("configuration.bin");
+
+    HashDigest hash;
+    auto result = storage.loadConfigurationWithHash(hash);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), testData, testData + sizeof(testData));
+    BOOST_CHECK(hash.empty());
+
+    storage.clearConfiguration();
+}
+
+BOOST_AUTO_TEST_CASE(loadMissingOrTruncatedFileTest)
+{
+    FileConfigurationStorage storage("configuration.bin");
+    storage.clearConfiguration();
+
+    BOOST_CHECK(storage.loadConfiguration().empty());
+
+    storage.saveConfiguration(std::vector<std::uint8_t>(100, 'x'));
+    {
+        std::ifstream in("configuration.bin", std::ifstream::binary);
+        std::vector<char> content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out("configuration.bin", std::ofstream::binary | std::ofstream::trunc);
+        out.write(content.data(), content.size() / 2);
+    }
+
+    BOOST_CHECK(storage.loadConfiguration().empty());
+
+    storage.clearConfiguration();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace kaa
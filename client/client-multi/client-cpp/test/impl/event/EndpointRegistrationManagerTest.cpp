@@ -430,6 +430,152 @@ BOOST_AUTO_TEST_CASE(DetachAnotherEndpointTest)
     BOOST_CHECK_EQUAL(detachEndpointCallback2->on_detach_failed_count, 1);
 }
 
+class PersistAttachEndpointsCallback : public IAttachEndpointsCallback {
+public:
+    virtual void onAttachCompleted(const std::vector<EndpointAttachResult>& results)
+    {
+        ++on_attach_completed_count;
+        results_ = results;
+    }
+
+public:
+    std::size_t on_attach_completed_count = 0;
+    std::vector<EndpointAttachResult> results_;
+};
+
+class PersistDetachEndpointsCallback : public IDetachEndpointsCallback {
+public:
+    virtual void onDetachCompleted(const std::vector<EndpointDetachResult>& results)
+    {
+        ++on_detach_completed_count;
+        results_ = results;
+    }
+
+public:
+    std::size_t on_detach_completed_count = 0;
+    std::vector<EndpointDetachResult> results_;
+};
+
+BOOST_AUTO_TEST_CASE(BadCredentialsOfBulkAttachEndpointsTest)
+{
+    IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
+    MockExecutorContext context;
+    KaaClientContext clientContext(tmp_properties, tmp_logger, context, status);
+    EndpointRegistrationManager registrationManager(clientContext);
+
+    MockChannelManager channelManager;
+    UserTransport userTransport(registrationManager, channelManager, clientContext);
+    registrationManager.setTransport(&userTransport);
+
+    BOOST_CHECK_THROW(registrationManager.attachEndpoints({ "some id", "" }), BadCredentials);
+    BOOST_CHECK(registrationManager.getEndpointsToAttach().empty());
+
+    BOOST_CHECK_THROW(registrationManager.detachEndpoints({ "", "some key hash" }), BadCredentials);
+    BOOST_CHECK(registrationManager.getEndpointsToDetach().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BulkAttachEndpointsTest)
+{
+    IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
+    SimpleExecutorContext context;
+    context.init();
+    KaaClientContext clientContext(tmp_properties, tmp_logger, context, status);
+    EndpointRegistrationManager registrationManager(clientContext);
+
+    MockChannelManager channelManager;
+    UserTransport userTransport(registrationManager, channelManager, clientContext);
+    registrationManager.setTransport(&userTransport);
+
+    auto attachEndpointsCallback = std::make_shared<PersistAttachEndpointsCallback>();
+
+    std::vector<std::string> targetEndpointAccessTokens = { "some id 1", "some id 2", "some id 3" };
+    std::string targetEndpointKeyHash1 = "some key hash 1";
+    std::string targetEndpointKeyHash3 = "some key hash 3";
+
+    registrationManager.attachEndpoints(targetEndpointAccessTokens, attachEndpointsCallback);
+
+    /* One sync for all endpoints. */
+    BOOST_CHECK_EQUAL(channelManager.onGetChannelByTransportType_, 1);
+
+    auto attachRequests = registrationManager.getEndpointsToAttach();
+    BOOST_CHECK_EQUAL(attachRequests.size(), targetEndpointAccessTokens.size());
+
+    registrationManager.onEndpointsAttach({
+            constructEndpointAttachResponse(SyncResponseResultType::SUCCESS
+                                          , getRequestId(targetEndpointAccessTokens[2], attachRequests)
+                                          , targetEndpointKeyHash3),
+            constructEndpointAttachResponse(SyncResponseResultType::FAILURE
+                                          , getRequestId(targetEndpointAccessTokens[1], attachRequests))});
+    testSleep(1);
+
+    BOOST_CHECK_EQUAL(attachEndpointsCallback->on_attach_completed_count, 0);
+
+    registrationManager.onEndpointsAttach({
+            constructEndpointAttachResponse(SyncResponseResultType::SUCCESS
+                                          , getRequestId(targetEndpointAccessTokens[0], attachRequests)
+                                          , targetEndpointKeyHash1)});
+    testSleep(1);
+
+    BOOST_CHECK(registrationManager.getEndpointsToAttach().empty());
+    BOOST_REQUIRE_EQUAL(attachEndpointsCallback->on_attach_completed_count, 1);
+
+    const auto& results = attachEndpointsCallback->results_;
+    BOOST_REQUIRE_EQUAL(results.size(), targetEndpointAccessTokens.size());
+
+    BOOST_CHECK_EQUAL(results[0].endpointAccessToken, targetEndpointAccessTokens[0]);
+    BOOST_CHECK(results[0].isAttached);
+    BOOST_CHECK_EQUAL(results[0].endpointKeyHash, targetEndpointKeyHash1);
+
+    BOOST_CHECK_EQUAL(results[1].endpointAccessToken, targetEndpointAccessTokens[1]);
+    BOOST_CHECK(!results[1].isAttached);
+    BOOST_CHECK(results[1].endpointKeyHash.empty());
+
+    BOOST_CHECK_EQUAL(results[2].endpointAccessToken, targetEndpointAccessTokens[2]);
+    BOOST_CHECK(results[2].isAttached);
+    BOOST_CHECK_EQUAL(results[2].endpointKeyHash, targetEndpointKeyHash3);
+}
+
+BOOST_AUTO_TEST_CASE(BulkDetachEndpointsTest)
+{
+    IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
+    SimpleExecutorContext context;
+    context.init();
+    KaaClientContext clientContext(tmp_properties, tmp_logger, context, status);
+    EndpointRegistrationManager registrationManager(clientContext);
+
+    MockChannelManager channelManager;
+    UserTransport userTransport(registrationManager, channelManager, clientContext);
+    registrationManager.setTransport(&userTransport);
+
+    auto detachEndpointsCallback = std::make_shared<PersistDetachEndpointsCallback>();
+
+    std::vector<std::string> targetEndpointKeyHashes = { "some key hash 1", "some key hash 2" };
+
+    registrationManager.detachEndpoints(targetEndpointKeyHashes, detachEndpointsCallback);
+    BOOST_CHECK_EQUAL(channelManager.onGetChannelByTransportType_, 1);
+
+    auto detachRequests = registrationManager.getEndpointsToDetach();
+    BOOST_CHECK_EQUAL(detachRequests.size(), targetEndpointKeyHashes.size());
+
+    registrationManager.onEndpointsDetach({
+            constructEndpointDetachResponse(SyncResponseResultType::FAILURE
+                                          , getRequestId(targetEndpointKeyHashes[0], detachRequests)),
+            constructEndpointDetachResponse(SyncResponseResultType::SUCCESS
+                                          , getRequestId(targetEndpointKeyHashes[1], detachRequests))});
+    testSleep(1);
+
+    BOOST_REQUIRE_EQUAL(detachEndpointsCallback->on_detach_completed_count, 1);
+
+    const auto& results = detachEndpointsCallback->results_;
+    BOOST_REQUIRE_EQUAL(results.size(), targetEndpointKeyHashes.size());
+
+    BOOST_CHECK_EQUAL(results[0].endpointKeyHash, targetEndpointKeyHashes[0]);
+    BOOST_CHECK(!results[0].isDetached);
+
+    BOOST_CHECK_EQUAL(results[1].endpointKeyHash, targetEndpointKeyHashes[1]);
+    BOOST_CHECK(results[1].isDetached);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
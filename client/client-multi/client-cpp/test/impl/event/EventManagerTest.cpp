@@ -0,0 +1,355 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "kaa/event/EventManager.hpp"
+#include "kaa/event/EventTransport.hpp"
+#include "kaa/event/IFetchEventListeners.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+
+#include "headers/channel/MockChannelManager.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/event/MockEventFamily.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static MockExecutorContext executorContext;
+
+class SyncCountingDataChannel : public MockDataChannel {
+public:
+    virtual void sync(TransportType type) { ++onSync_; }
+
+public:
+    std::atomic<std::size_t> onSync_{0};
+};
+
+class SyncCountingChannelManager : public MockChannelManager {
+public:
+    virtual IDataChannelPtr getChannelByTransportType(TransportType type) override { return channel_; }
+
+public:
+    std::shared_ptr<SyncCountingDataChannel> channel_ = std::make_shared<SyncCountingDataChannel>();
+};
+
+class EventManagerFixture {
+public:
+    EventManagerFixture()
+        : status_(new MockKaaClientStateStorage), context_(properties, tmp_logger, executorContext, status_),
+          eventManager_(context_), eventTransport_(eventManager_, channelManager_, context_)
+    {
+        eventManager_.setTransport(&eventTransport_);
+    }
+
+    std::size_t getSyncCount() const { return channelManager_.channel_->onSync_; }
+
+protected:
+    IKaaClientStateStoragePtr     status_;
+    KaaClientContext              context_;
+    SyncCountingChannelManager    channelManager_;
+    EventManager                  eventManager_;
+    EventTransport                eventTransport_;
+};
+
+static const std::vector<std::uint8_t> EVENT_DATA = { 1, 2, 3 };
+
+class MockFetchEventListeners : public IFetchEventListeners {
+public:
+    virtual void onEventListenersReceived(const std::vector<std::string>& eventListeners) {}
+    virtual void onRequestFailed() {}
+};
+
+static EventSyncResponse::eventListenersResponses_t createListenersResponse(std::int32_t requestId,
+                                                                            const std::vector<std::string>& listeners)
+{
+    EventListenersResponse response;
+    response.requestId = requestId;
+    response.result = SyncResponseResultType::SUCCESS;
+    response.listeners.set_array(listeners);
+
+    EventSyncResponse::eventListenersResponses_t responses;
+    responses.set_array(std::vector<EventListenersResponse>{ response });
+    return responses;
+}
+
+BOOST_FIXTURE_TEST_SUITE(EventManagerTestSuite, EventManagerFixture)
+
+BOOST_AUTO_TEST_CASE(SyncPerEventWithoutBatchingTest)
+{
+    const std::size_t eventCount = 5;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        eventManager_.produceEvent("org.kaaproject.Event", EVENT_DATA, "", TransactionIdPtr());
+    }
+
+    BOOST_CHECK_EQUAL(getSyncCount(), eventCount);
+    BOOST_CHECK_EQUAL(eventManager_.releasePendingEvents().size(), eventCount);
+}
+
+BOOST_AUTO_TEST_CASE(BatchWindowTest)
+{
+    EventBatchingSettings settings;
+    settings.batchWindow = std::chrono::milliseconds(50);
+    eventManager_.setBatchingSettings(settings);
+
+    const std::size_t eventCount = 200;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        eventManager_.produceEvent("org.kaaproject.Event", EVENT_DATA, "", TransactionIdPtr());
+    }
+
+    BOOST_CHECK_EQUAL(getSyncCount(), 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    BOOST_CHECK_EQUAL(getSyncCount(), 1);
+    BOOST_CHECK_EQUAL(eventManager_.releasePendingEvents().size(), eventCount);
+}
+
+BOOST_AUTO_TEST_CASE(MaxBatchSizeTest)
+{
+    EventBatchingSettings settings;
+    settings.batchWindow = std::chrono::hours(1);
+    settings.maxBatchSize = 10;
+    eventManager_.setBatchingSettings(settings);
+
+    for (std::size_t i = 0; i < settings.maxBatchSize - 1; ++i) {
+        eventManager_.produceEvent("org.kaaproject.Event", EVENT_DATA, "", TransactionIdPtr());
+    }
+
+    BOOST_CHECK_EQUAL(getSyncCount(), 0);
+
+    eventManager_.produceEvent("org.kaaproject.Event", EVENT_DATA, "", TransactionIdPtr());
+
+    BOOST_CHECK_EQUAL(getSyncCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(DisableBatchingFlushesEventsTest)
+{
+    EventBatchingSettings settings;
+    settings.batchWindow = std::chrono::hours(1);
+    eventManager_.setBatchingSettings(settings);
+
+    eventManager_.produceEvent("org.kaaproject.Event", EVENT_DATA, "", TransactionIdPtr());
+    BOOST_CHECK_EQUAL(getSyncCount(), 0);
+
+    eventManager_.setBatchingSettings(EventBatchingSettings());
+    BOOST_CHECK_EQUAL(getSyncCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(CoalesceEventsTest)
+{
+    EventBatchingSettings settings;
+    settings.batchWindow = std::chrono::hours(1);
+    settings.coalesceEvents = true;
+    eventManager_.setBatchingSettings(settings);
+
+    const std::size_t updateCount = 10;
+    for (std::size_t i = 0; i < updateCount; ++i) {
+        std::vector<std::uint8_t> data(1, static_cast<std::uint8_t>(i));
+        eventManager_.produceEvent("org.kaaproject.Position", data, "", TransactionIdPtr());
+        eventManager_.produceEvent("org.kaaproject.Position", data, "target", TransactionIdPtr());
+        eventManager_.produceEvent("org.kaaproject.Alarm", data, "", TransactionIdPtr());
+    }
+
+    auto events = eventManager_.releasePendingEvents();
+    BOOST_REQUIRE_EQUAL(events.size(), 3);
+
+    /*
+     * Only the latest event of each FQN and target is kept, in the order they were produced.
+     */
+    auto it = events.begin();
+    BOOST_CHECK_EQUAL(it->second.eventClassFQN, "org.kaaproject.Position");
+    BOOST_CHECK(it->second.target.is_null());
+    BOOST_CHECK_EQUAL(it->second.eventData[0], updateCount - 1);
+
+    ++it;
+    BOOST_CHECK_EQUAL(it->second.eventClassFQN, "org.kaaproject.Position");
+    BOOST_CHECK_EQUAL(it->second.target.get_string(), "target");
+
+    ++it;
+    BOOST_CHECK_EQUAL(it->second.eventClassFQN, "org.kaaproject.Alarm");
+}
+
+BOOST_AUTO_TEST_CASE(ProduceEventOverloadsTest)
+{
+    /*
+     * A producer sitting on its own buffers passes views of them.
+     */
+    const char fqnBuffer[] = "org.kaaproject.Position.target";
+    const std::uint8_t dataBuffer[] = { 4, 5, 6, 7 };
+
+    eventManager_.produceEvent(boost::string_ref(fqnBuffer, 23), dataBuffer, 2,
+                               boost::string_ref(fqnBuffer + 24), TransactionIdPtr());
+
+    std::vector<std::uint8_t> data(EVENT_DATA);
+    const std::uint8_t *dataPointer = data.data();
+    eventManager_.produceEvent("org.kaaproject.Alarm", std::move(data), "", TransactionIdPtr());
+
+    eventManager_.produceEvent(boost::string_ref(), dataBuffer, 1, boost::string_ref(), TransactionIdPtr());
+    eventManager_.produceEvent("org.kaaproject.Alarm", nullptr, 1, boost::string_ref(), TransactionIdPtr());
+
+    auto events = eventManager_.releasePendingEvents();
+    BOOST_REQUIRE_EQUAL(events.size(), 2);
+
+    auto it = events.begin();
+    BOOST_CHECK_EQUAL(it->second.eventClassFQN, "org.kaaproject.Position");
+    BOOST_CHECK_EQUAL(it->second.target.get_string(), "target");
+    BOOST_CHECK(it->second.eventData == std::vector<std::uint8_t>(dataBuffer, dataBuffer + 2));
+
+    /*
+     * The moved data is taken over without a copy.
+     */
+    ++it;
+    BOOST_CHECK_EQUAL(it->second.eventClassFQN, "org.kaaproject.Alarm");
+    BOOST_CHECK(it->second.target.is_null());
+    BOOST_CHECK(it->second.eventData == EVENT_DATA);
+    BOOST_CHECK(it->second.eventData.data() == dataPointer);
+}
+
+BOOST_AUTO_TEST_CASE(EventStorageTest)
+{
+    EventBatchingSettings settings;
+    settings.batchWindow = std::chrono::hours(1);
+    eventManager_.setBatchingSettings(settings);
+
+    const std::size_t maxResidentEvents = 5;
+    const std::size_t bucketRecordCount = 10;
+    eventManager_.setEventStorage(std::make_shared<MemoryLogStorage>(context_,
+                                                                     LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                                                     bucketRecordCount),
+                                  maxResidentEvents);
+
+    const std::size_t eventCount = 25;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        std::vector<std::uint8_t> data(1, static_cast<std::uint8_t>(i));
+        eventManager_.produceEvent("org.kaaproject.Event", data, "", TransactionIdPtr());
+    }
+
+    auto transaction = eventManager_.beginTransaction();
+    eventManager_.produceEvent("org.kaaproject.Event", std::vector<std::uint8_t>(1, eventCount), "", transaction);
+    eventManager_.commit(transaction, context_);
+
+    /*
+     * Only resident events occupy memory.
+     */
+    BOOST_CHECK_LE(eventManager_.getPendingEventsVolume(), maxResidentEvents * (sizeof(Event) + 64));
+
+    /*
+     * Resident events go first, then the storage is drained one bucket per sync in the produced order.
+     */
+    std::size_t expectedData = 0;
+    for (std::size_t batchSize : { maxResidentEvents + bucketRecordCount, bucketRecordCount, std::size_t(1) }) {
+        BOOST_REQUIRE(eventManager_.hasPendingEvents());
+
+        auto events = eventManager_.releasePendingEvents();
+        BOOST_REQUIRE_EQUAL(events.size(), batchSize);
+        for (const auto& pair : events) {
+            BOOST_CHECK_EQUAL(pair.second.eventClassFQN, "org.kaaproject.Event");
+            BOOST_CHECK_EQUAL(pair.second.eventData[0], expectedData++);
+        }
+
+        const std::size_t syncCount = getSyncCount();
+        eventManager_.onEventsDelivered();
+        BOOST_CHECK_EQUAL(getSyncCount(), syncCount + (eventManager_.hasPendingEvents() ? 1 : 0));
+    }
+
+    BOOST_CHECK(!eventManager_.hasPendingEvents());
+}
+
+BOOST_AUTO_TEST_CASE(RouteIncomingEventsTest)
+{
+    MockEventFamily family1({ "org.kaaproject.Position", "org.kaaproject.Alarm" });
+    MockEventFamily family2({ "org.kaaproject.Alarm" });
+
+    eventManager_.registerEventFamily(&family1);
+    eventManager_.registerEventFamily(&family2);
+    eventManager_.registerEventFamily(&family2);
+
+    std::vector<Event> events(3);
+    events[0].seqNum = 2;
+    events[0].eventClassFQN = "org.kaaproject.Alarm";
+    events[0].source.set_null();
+    events[1].seqNum = 1;
+    events[1].eventClassFQN = "org.kaaproject.Position";
+    events[1].source.set_string("source");
+    events[2].seqNum = 3;
+    events[2].eventClassFQN = "org.kaaproject.Unknown";
+    events[2].source.set_null();
+
+    EventSyncResponse::events_t response;
+    response.set_array(events);
+    eventManager_.onEventsReceived(response);
+
+    BOOST_CHECK_EQUAL(family1.onGenericEvent_, 2);
+    BOOST_CHECK_EQUAL(family1.lastFqn_, "org.kaaproject.Alarm");
+    BOOST_CHECK_EQUAL(family1.lastEventClassId_, 1);
+    BOOST_CHECK(family1.lastSource_.empty());
+
+    BOOST_CHECK_EQUAL(family2.onGenericEvent_, 1);
+    BOOST_CHECK_EQUAL(family2.lastFqn_, "org.kaaproject.Alarm");
+    BOOST_CHECK_EQUAL(family2.lastEventClassId_, 0);
+}
+
+BOOST_AUTO_TEST_CASE(EventListenersCacheTest)
+{
+    auto listener = std::make_shared<MockFetchEventListeners>();
+    eventManager_.setEventListenersCacheTtl(std::chrono::hours(1));
+
+    std::int32_t requestId = eventManager_.findEventListeners({ "org.kaaproject.A", "org.kaaproject.B" }, listener);
+    BOOST_CHECK_EQUAL(getSyncCount(), 1);
+
+    eventManager_.onEventListenersReceived(createListenersResponse(requestId, { "endpoint1", "endpoint2" }));
+    BOOST_CHECK(!eventManager_.hasPendingListenerRequests());
+
+    /*
+     * The same FQNs in another order are resolved from the cache.
+     */
+    eventManager_.findEventListeners({ "org.kaaproject.B", "org.kaaproject.A" }, listener);
+    BOOST_CHECK_EQUAL(getSyncCount(), 1);
+    BOOST_CHECK(!eventManager_.hasPendingListenerRequests());
+
+    eventManager_.findEventListeners({ "org.kaaproject.A" }, listener);
+    BOOST_CHECK_EQUAL(getSyncCount(), 2);
+    BOOST_CHECK(eventManager_.hasPendingListenerRequests());
+
+    eventManager_.clearEventListenersCache();
+    eventManager_.findEventListeners({ "org.kaaproject.A", "org.kaaproject.B" }, listener);
+    BOOST_CHECK_EQUAL(getSyncCount(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(EventListenersCacheDisabledTest)
+{
+    auto listener = std::make_shared<MockFetchEventListeners>();
+
+    std::int32_t requestId = eventManager_.findEventListeners({ "org.kaaproject.A" }, listener);
+    eventManager_.onEventListenersReceived(createListenersResponse(requestId, { "endpoint1" }));
+
+    eventManager_.findEventListeners({ "org.kaaproject.A" }, listener);
+    BOOST_CHECK_EQUAL(getSyncCount(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "kaa/failover/BackoffFailoverStrategy.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+
+#include "test/headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+class BackoffFailoverStrategyFixture {
+public:
+    BackoffFailoverStrategyFixture()
+        : logger_(properties_.getClientId()),
+          status_(new MockKaaClientStateStorage),
+          context_(properties_, logger_, executorContext_, status_)
+    {
+    }
+
+protected:
+    KaaClientProperties properties_;
+    DefaultLogger logger_;
+    SimpleExecutorContext executorContext_;
+    IKaaClientStateStoragePtr status_;
+    KaaClientContext context_;
+};
+
+BOOST_FIXTURE_TEST_SUITE(BackoffFailoverStrategyTestSuite, BackoffFailoverStrategyFixture)
+
+BOOST_AUTO_TEST_CASE(DefaultActionsTest)
+{
+    BackoffFailoverStrategy strategy(context_);
+
+    BOOST_CHECK(strategy.onFailover(KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA).getAction() ==
+                FailoverStrategyAction::USE_NEXT_OPERATIONS_SERVER);
+    BOOST_CHECK(strategy.onFailover(KaaFailoverReason::ALL_OPERATIONS_SERVERS_NA).getAction() ==
+                FailoverStrategyAction::USE_NEXT_BOOTSTRAP_SERVER);
+    BOOST_CHECK(strategy.onFailover(KaaFailoverReason::NO_CONNECTIVITY).getAction() ==
+                FailoverStrategyAction::RETRY_CURRENT_SERVER);
+
+    auto stopDecision = strategy.onFailover(KaaFailoverReason::CREDENTIALS_REVOKED);
+    BOOST_CHECK(stopDecision.getAction() == FailoverStrategyAction::STOP_CLIENT);
+    BOOST_CHECK_EQUAL(stopDecision.getRetryPeriod(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DelayGrowsWithinBoundsTest)
+{
+    const std::size_t basePeriod = 2;
+    const std::size_t maxPeriod = 60;
+
+    BackoffFailoverStrategy strategy(context_, basePeriod, maxPeriod);
+
+    std::size_t previousPeriod = basePeriod;
+    std::size_t longestPeriod = 0;
+    for (int i = 0; i < 100; ++i) {
+        auto period = strategy.onFailover(KaaFailoverReason::CURRENT_OPERATIONS_SERVER_NA).getRetryPeriod();
+
+        BOOST_CHECK_GE(period, basePeriod);
+        BOOST_CHECK_LE(period, std::min(maxPeriod, previousPeriod * 3));
+
+        longestPeriod = std::max(longestPeriod, period);
+        previousPeriod = period;
+    }
+
+    BOOST_CHECK_GT(longestPeriod, basePeriod * 3);
+}
+
+BOOST_AUTO_TEST_CASE(RecoverResetsDelayTest)
+{
+    const std::size_t basePeriod = 1;
+
+    BackoffFailoverStrategy strategy(context_, basePeriod, 1000);
+    for (int i = 0; i < 20; ++i) {
+        strategy.onFailover(KaaFailoverReason::NO_CONNECTIVITY);
+    }
+
+    strategy.onRecover();
+
+    BOOST_CHECK_LE(strategy.onFailover(KaaFailoverReason::NO_CONNECTIVITY).getRetryPeriod(), basePeriod * 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
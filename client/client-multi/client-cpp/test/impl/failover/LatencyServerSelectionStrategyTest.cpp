@@ -0,0 +1,117 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "kaa/channel/GenericTransportInfo.hpp"
+#include "kaa/failover/LatencyServerSelectionStrategy.hpp"
+
+namespace kaa {
+
+static ITransportConnectionInfoPtr createServer(std::int32_t accessPointId)
+{
+    return std::make_shared<GenericTransportInfo>(ServerType::OPERATIONS, accessPointId,
+                                                  TransportProtocolId(1, 1), std::vector<std::uint8_t>(1, 0));
+}
+
+static std::vector<std::int32_t> getAccessPointIds(const std::vector<ITransportConnectionInfoPtr>& servers)
+{
+    std::vector<std::int32_t> ids;
+    for (const auto& server : servers) {
+        ids.push_back(server->getAccessPointId());
+    }
+    return ids;
+}
+
+BOOST_AUTO_TEST_SUITE(LatencyServerSelectionStrategyTestSuite)
+
+BOOST_AUTO_TEST_CASE(FastestServerFirstTest)
+{
+    LatencyServerSelectionStrategy strategy;
+
+    std::vector<ITransportConnectionInfoPtr> servers = { createServer(1), createServer(2), createServer(3) };
+    strategy.onServerRttMeasured(*servers[0], std::chrono::milliseconds(80));
+    strategy.onServerRttMeasured(*servers[1], std::chrono::milliseconds(20));
+    strategy.onServerRttMeasured(*servers[2], std::chrono::milliseconds(50));
+
+    strategy.orderServers(servers);
+
+    std::vector<std::int32_t> expected = { 2, 3, 1 };
+    auto actual = getAccessPointIds(servers);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(UnknownAndFailedServersLastTest)
+{
+    LatencyServerSelectionStrategy strategy;
+
+    std::vector<ITransportConnectionInfoPtr> servers = { createServer(1), createServer(2), createServer(3) };
+    strategy.onServerRttMeasured(*servers[0], std::chrono::milliseconds(10));
+    strategy.onServerFailed(*servers[0]);
+    strategy.onServerRttMeasured(*servers[2], std::chrono::milliseconds(500));
+
+    strategy.orderServers(servers);
+
+    std::vector<std::int32_t> expected = { 3, 2, 1 };
+    auto actual = getAccessPointIds(servers);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(FailureTimeoutTest)
+{
+    LatencyServerSelectionStrategy strategy(std::chrono::seconds::zero());
+
+    std::vector<ITransportConnectionInfoPtr> servers = { createServer(1), createServer(2) };
+    strategy.onServerRttMeasured(*servers[0], std::chrono::milliseconds(10));
+    strategy.onServerRttMeasured(*servers[1], std::chrono::milliseconds(20));
+    strategy.onServerFailed(*servers[0]);
+
+    strategy.orderServers(servers);
+
+    BOOST_CHECK_EQUAL(servers.front()->getAccessPointId(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(NewSampleClearsFailureTest)
+{
+    LatencyServerSelectionStrategy strategy;
+
+    std::vector<ITransportConnectionInfoPtr> servers = { createServer(1), createServer(2) };
+    strategy.onServerRttMeasured(*servers[1], std::chrono::milliseconds(20));
+    strategy.onServerFailed(*servers[0]);
+    strategy.onServerRttMeasured(*servers[0], std::chrono::milliseconds(10));
+
+    strategy.orderServers(servers);
+
+    BOOST_CHECK_EQUAL(servers.front()->getAccessPointId(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SmoothedRttTest)
+{
+    LatencyServerSelectionStrategy strategy;
+
+    auto server = createServer(7);
+    strategy.onServerRttMeasured(*server, std::chrono::microseconds(8000));
+    strategy.onServerRttMeasured(*server, std::chrono::microseconds(16000));
+
+    auto rtts = strategy.getServerRtts();
+    BOOST_REQUIRE_EQUAL(rtts.size(), 1);
+    BOOST_CHECK_EQUAL(rtts[7].count(), 9000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "kaa/http/HttpClient.hpp"
+#include "kaa/http/HttpUrl.hpp"
+#include "kaa/http/MultipartPostHttpRequest.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static MockExecutorContext tmpExecContext;
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::string RESPONSE_BODY = "0123456789";
+
+/*
+ * Loopback HTTP server which answers each request with the given response.
+ */
+class TestHttpServer {
+public:
+    TestHttpServer(const std::string& response)
+        : acceptor_(io_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+          response_(response), acceptedConnections_(0), processedRequests_(0)
+    {
+        serverThread_ = std::thread([this] { run(); });
+    }
+
+    ~TestHttpServer()
+    {
+        boost::system::error_code errorCode;
+        acceptor_.close(errorCode);
+        serverThread_.join();
+    }
+
+    std::uint16_t getPort() const { return acceptor_.local_endpoint().port(); }
+
+    std::size_t getAcceptedConnections() const { return acceptedConnections_; }
+
+    std::size_t getProcessedRequests() const { return processedRequests_; }
+
+    /*
+     * Connections are closed after the given number of requests.
+     */
+    std::size_t requestsPerConnection_ = 0;
+
+    std::size_t expectedRequests_ = 0;
+
+private:
+    void run()
+    {
+        while (processedRequests_ < expectedRequests_) {
+            boost::asio::ip::tcp::socket sock(io_);
+            boost::system::error_code errorCode;
+            acceptor_.accept(sock, errorCode);
+            if (errorCode) {
+                return;
+            }
+
+            ++acceptedConnections_;
+
+            std::size_t connectionRequests = 0;
+            boost::asio::streambuf requestBuf;
+            while (processedRequests_ < expectedRequests_) {
+                if (!readRequest(sock, requestBuf)) {
+                    break;
+                }
+
+                boost::asio::write(sock, boost::asio::buffer(response_), errorCode);
+                ++processedRequests_;
+
+                if (requestsPerConnection_ && ++connectionRequests == requestsPerConnection_) {
+                    break;
+                }
+            }
+        }
+    }
+
+    static bool readRequest(boost::asio::ip::tcp::socket& sock, boost::asio::streambuf& requestBuf)
+    {
+        boost::system::error_code errorCode;
+        std::size_t headerSize = boost::asio::read_until(sock, requestBuf, "\r\n\r\n", errorCode);
+        if (errorCode) {
+            return false;
+        }
+
+        std::string header(boost::asio::buffers_begin(requestBuf.data()),
+                           boost::asio::buffers_begin(requestBuf.data()) + headerSize);
+        requestBuf.consume(headerSize);
+
+        const std::string contentLengthField = "Content-Length: ";
+        auto contentLengthPos = header.find(contentLengthField);
+        std::size_t bodySize = std::stoul(header.substr(contentLengthPos + contentLengthField.size()));
+
+        /*
+         * The request body is followed by an extra empty line.
+         */
+        bodySize += 4;
+
+        if (requestBuf.size() < bodySize) {
+            boost::asio::read(sock, requestBuf, boost::asio::transfer_exactly(bodySize - requestBuf.size()), errorCode);
+            if (errorCode) {
+                return false;
+            }
+        }
+
+        requestBuf.consume(bodySize);
+        return true;
+    }
+
+private:
+    boost::asio::io_service io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    const std::string response_;
+    std::atomic<std::size_t> acceptedConnections_;
+    std::atomic<std::size_t> processedRequests_;
+    std::thread serverThread_;
+};
+
+static std::string createResponse(const std::string& connectionHeader)
+{
+    return "HTTP/1.1 200 OK\r\n"
+           "Content-Type: text/plain\r\n"
+           + connectionHeader +
+           "Content-Length: " + std::to_string(RESPONSE_BODY.size()) + "\r\n\r\n"
+           + RESPONSE_BODY;
+}
+
+static void sendRequests(HttpClient& client, std::uint16_t port, std::size_t requestCount)
+{
+    HttpUrl url("http://127.0.0.1:" + std::to_string(port) + "/EP/Sync");
+
+    for (std::size_t i = 0; i < requestCount; ++i) {
+        MultipartPostHttpRequest request(url, clientContext);
+        request.setHeaderField("Connection", "Keep-Alive");
+        request.setBodyField("requestData", std::vector<std::uint8_t>(RESPONSE_BODY.begin(), RESPONSE_BODY.end()));
+
+        auto response = client.sendRequest(request);
+
+        BOOST_REQUIRE(response);
+        BOOST_CHECK_EQUAL(response->getStatusCode(), 200);
+
+        auto body = response->getBody();
+        BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(body.first.get()), body.second), RESPONSE_BODY);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(HttpClientSuite)
+
+BOOST_AUTO_TEST_CASE(KeepAliveConnectionReuseTest)
+{
+    const std::size_t requestCount = 3;
+
+    TestHttpServer server(createResponse(""));
+    server.expectedRequests_ = requestCount;
+
+    HttpClient client(clientContext);
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+    BOOST_CHECK_EQUAL(server.getProcessedRequests(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectionCloseResponseTest)
+{
+    const std::size_t requestCount = 2;
+
+    TestHttpServer server(createResponse("Connection: close\r\n"));
+    server.expectedRequests_ = requestCount;
+    server.requestsPerConnection_ = 1;
+
+    HttpClient client(clientContext);
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(ReconnectOnClosedKeptAliveConnectionTest)
+{
+    const std::size_t requestCount = 2;
+
+    /*
+     * The server closes the connection it has promised to keep alive.
+     */
+    TestHttpServer server(createResponse(""));
+    server.expectedRequests_ = requestCount;
+    server.requestsPerConnection_ = 1;
+
+    HttpClient client(clientContext);
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), requestCount);
+    BOOST_CHECK_EQUAL(server.getProcessedRequests(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedResponseConnectionReuseTest)
+{
+    const std::size_t requestCount = 2;
+
+    TestHttpServer server("HTTP/1.1 200 OK\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n"
+                          "4\r\n" + RESPONSE_BODY.substr(0, 4) + "\r\n"
+                          "6;ext=1\r\n" + RESPONSE_BODY.substr(4) + "\r\n"
+                          "0\r\n\r\n");
+    server.expectedRequests_ = requestCount;
+
+    HttpClient client(clientContext);
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+}
+
+static std::shared_ptr<IHttpResponse> sendRequestAsync(HttpClient& client, boost::asio::io_service& io,
+                                                      std::uint16_t port, boost::system::error_code& resultCode)
+{
+    HttpUrl url("http://127.0.0.1:" + std::to_string(port) + "/EP/Sync");
+    MultipartPostHttpRequest request(url, clientContext);
+    request.setHeaderField("Connection", "Keep-Alive");
+
+    std::shared_ptr<IHttpResponse> result;
+    client.sendRequestAsync(request,
+            [&result, &resultCode] (const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response)
+            {
+                resultCode = errorCode;
+                result = response;
+            });
+
+    io.reset();
+    io.run();
+
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(AsyncRequestTest)
+{
+    const std::size_t requestCount = 2;
+
+    TestHttpServer server(createResponse(""));
+    server.expectedRequests_ = requestCount;
+
+    boost::asio::io_service io;
+    HttpClient client(clientContext, io);
+
+    for (std::size_t i = 0; i < requestCount; ++i) {
+        boost::system::error_code errorCode;
+        auto response = sendRequestAsync(client, io, server.getPort(), errorCode);
+
+        BOOST_CHECK(!errorCode);
+        BOOST_REQUIRE(response);
+        BOOST_CHECK_EQUAL(response->getStatusCode(), 200);
+
+        auto body = response->getBody();
+        BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(body.first.get()), body.second), RESPONSE_BODY);
+    }
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncRequestFailureTest)
+{
+    std::uint16_t port = 0;
+    {
+        /*
+         * Nobody listens on the port once the server is destroyed.
+         */
+        TestHttpServer server(createResponse(""));
+        port = server.getPort();
+    }
+
+    boost::asio::io_service io;
+    HttpClient client(clientContext, io);
+
+    boost::system::error_code errorCode;
+    auto response = sendRequestAsync(client, io, port, errorCode);
+
+    BOOST_CHECK(errorCode);
+    BOOST_CHECK(!response);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentAsyncRequestTest)
+{
+    TestHttpServer server(createResponse(""));
+    server.expectedRequests_ = 1;
+
+    boost::asio::io_service io;
+    HttpClient client(clientContext, io);
+
+    HttpUrl url("http://127.0.0.1:" + std::to_string(server.getPort()) + "/EP/Sync");
+    MultipartPostHttpRequest request(url, clientContext);
+
+    std::size_t succeededRequests = 0;
+    std::size_t rejectedRequests = 0;
+    auto handler = [&succeededRequests, &rejectedRequests]
+                        (const boost::system::error_code& errorCode, std::shared_ptr<IHttpResponse> response)
+                        {
+                            if (errorCode == boost::asio::error::in_progress) {
+                                ++rejectedRequests;
+                            } else if (!errorCode && response) {
+                                ++succeededRequests;
+                            }
+                        };
+
+    client.sendRequestAsync(request, handler);
+    client.sendRequestAsync(request, handler);
+
+    io.run();
+
+    BOOST_CHECK_EQUAL(succeededRequests, 1);
+    BOOST_CHECK_EQUAL(rejectedRequests, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
@@ -102,6 +102,56 @@ BOOST_AUTO_TEST_CASE(httpMultipartRequestTest)
     BOOST_CHECK_EQUAL(req.getRequestData(), request_body_wo_body);
 }
 
+BOOST_AUTO_TEST_CASE(httpMultipartRequestBuffersTest)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext context;
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    HttpUrl url(test_url0);
+    MultipartPostHttpRequest req(url, clientContext);
+
+    std::vector<std::uint8_t> body(body_data);
+    const std::uint8_t *bodyStorage = body.data();
+
+    req.setHeaderField(header_name, header_value);
+    req.setBodyField(body_name, std::move(body));
+
+    const auto& buffers = req.getRequestBuffers();
+    BOOST_CHECK_EQUAL(boost::asio::buffer_size(buffers), request_body.size());
+
+    std::string data;
+    bool isBodyShared = false;
+    for (const auto& buffer : buffers) {
+        data.append(boost::asio::buffer_cast<const char *>(buffer), boost::asio::buffer_size(buffer));
+        isBodyShared = isBodyShared || boost::asio::buffer_cast<const std::uint8_t *>(buffer) == bodyStorage;
+    }
+
+    BOOST_CHECK_EQUAL(data, request_body);
+    BOOST_CHECK(isBodyShared);
+    BOOST_CHECK_EQUAL(req.getRequestData(), request_body);
+}
+
+BOOST_AUTO_TEST_CASE(httpKeepAliveRequestTest)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext context;
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    HttpUrl url(test_url0);
+    MultipartPostHttpRequest req(url, clientContext);
+
+    req.setHeaderField("Connection", "Keep-Alive");
+
+    const auto& requestData = req.getRequestData();
+    BOOST_CHECK(requestData.find("Connection: Keep-Alive\r\n") != std::string::npos);
+    BOOST_CHECK(requestData.find("Connection: Close\r\n") == std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace kaa
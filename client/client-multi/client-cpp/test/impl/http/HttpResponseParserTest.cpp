@@ -0,0 +1,197 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+
+#include <boost/asio/error.hpp>
+
+#include "kaa/http/HttpResponseParser.hpp"
+
+namespace kaa {
+
+static std::string getBody(const HttpResponseParser& parser)
+{
+    auto body = parser.getResponse()->getBody();
+    return std::string(reinterpret_cast<const char *>(body.first.get()), body.second);
+}
+
+/*
+ * Feeds the response byte by byte to cover the header and chunk lines split between the reads.
+ */
+static std::size_t parseByByte(HttpResponseParser& parser, const std::string& response,
+                               boost::system::error_code& errorCode)
+{
+    std::size_t consumed = 0;
+    for (std::size_t i = 0; i < response.size() && !errorCode && !parser.isComplete(); ++i) {
+        consumed += parser.parse(response.data() + i, 1, errorCode);
+    }
+    return consumed;
+}
+
+BOOST_AUTO_TEST_SUITE(HttpResponseParserSuite)
+
+BOOST_AUTO_TEST_CASE(ContentLengthTest)
+{
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "X-SIGNATURE:  abc \r\n"
+                                 "Content-Length: 10\r\n\r\n"
+                                 "0123456789";
+    const std::string nextResponse = "HTTP/1.1 200 OK\r\n";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+
+    std::size_t consumed = parser.parse((response + nextResponse).data(), response.size() + nextResponse.size(), errorCode);
+
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK(parser.isKeepAlive());
+    BOOST_CHECK_EQUAL(consumed, response.size());
+    BOOST_CHECK_EQUAL(parser.getResponse()->getStatusCode(), 200);
+    BOOST_CHECK_EQUAL(parser.getResponse()->getHeaderField("X-SIGNATURE"), "abc");
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+
+    parser.reset();
+    BOOST_CHECK_EQUAL(parseByByte(parser, response, errorCode), response.size());
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+}
+
+BOOST_AUTO_TEST_CASE(BodyReadInPlaceTest)
+{
+    const std::string header = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+    parser.parse(header.data(), header.size(), errorCode);
+
+    auto buffer = parser.prepareBody();
+    BOOST_REQUIRE_EQUAL(boost::asio::buffer_size(buffer), 10);
+
+    std::memcpy(boost::asio::buffer_cast<char *>(buffer), "0123456789", 10);
+    parser.commitBody(10);
+
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK_EQUAL(boost::asio::buffer_size(parser.prepareBody()), 0);
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedTest)
+{
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "Transfer-Encoding: chunked\r\n\r\n"
+                                 "4\r\n0123\r\n"
+                                 "6;name=value\r\n456789\r\n"
+                                 "0\r\n"
+                                 "X-Trailer: value\r\n\r\n";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+
+    BOOST_CHECK_EQUAL(parser.parse(response.data(), response.size(), errorCode), response.size());
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK(parser.isKeepAlive());
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+
+    parser.reset();
+    BOOST_CHECK_EQUAL(parseByByte(parser, response, errorCode), response.size());
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+}
+
+BOOST_AUTO_TEST_CASE(BodyUntilCloseTest)
+{
+    const std::string response = "HTTP/1.1 200 OK\r\n\r\n0123456789";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+
+    parser.parse(response.data(), response.size(), errorCode);
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(!parser.isComplete());
+
+    parser.onEndOfStream(errorCode);
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK(!parser.isKeepAlive());
+    BOOST_CHECK_EQUAL(getBody(parser), "0123456789");
+}
+
+BOOST_AUTO_TEST_CASE(ConnectionHeaderTest)
+{
+    const std::string closeResponse = "HTTP/1.1 200 OK\r\nConnection: Close\r\nContent-Length: 0\r\n\r\n";
+    const std::string keepAliveResponse = "HTTP/1.0 200 OK\r\nConnection: keep-alive\r\nContent-Length: 0\r\n\r\n";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+
+    parser.parse(closeResponse.data(), closeResponse.size(), errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK(!parser.isKeepAlive());
+    BOOST_CHECK_EQUAL(parser.getResponse()->getBody().second, 0);
+
+    parser.reset();
+    parser.parse(keepAliveResponse.data(), keepAliveResponse.size(), errorCode);
+    BOOST_CHECK(parser.isComplete());
+    BOOST_CHECK(parser.isKeepAlive());
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedResponseTest)
+{
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n01234";
+
+    HttpResponseParser parser;
+    boost::system::error_code errorCode;
+
+    BOOST_CHECK(!parser.isStarted());
+    parser.onEndOfStream(errorCode);
+    BOOST_CHECK_EQUAL(errorCode, boost::asio::error::connection_aborted);
+
+    errorCode.clear();
+    parser.reset();
+    parser.parse(response.data(), response.size(), errorCode);
+    BOOST_CHECK(parser.isStarted());
+    parser.onEndOfStream(errorCode);
+    BOOST_CHECK_EQUAL(errorCode, boost::asio::error::connection_aborted);
+}
+
+BOOST_AUTO_TEST_CASE(MalformedResponseTest)
+{
+    const std::string badStatusLine = "SIP/2.0 200 OK\r\n\r\n";
+    const std::string badContentLength = "HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n";
+    const std::string badChunkSize = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n";
+    const std::string oversizedHeader = "HTTP/1.1 200 OK\r\nX-Field: " +
+                                        std::string(HttpResponseParser::MAX_HEADER_SIZE, 'a');
+
+    for (const auto& response : { badStatusLine, badContentLength, badChunkSize, oversizedHeader }) {
+        HttpResponseParser parser;
+        boost::system::error_code errorCode;
+
+        parser.parse(response.data(), response.size(), errorCode);
+        BOOST_CHECK_EQUAL(errorCode, boost::system::errc::make_error_code(boost::system::errc::bad_message));
+        BOOST_CHECK(!parser.isComplete());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "kaa/http/HttpUtils.hpp"
+
+namespace kaa {
+
+static std::uint16_t getClosedPort(boost::asio::io_service& io)
+{
+    boost::asio::ip::tcp::acceptor acceptor(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+BOOST_AUTO_TEST_SUITE(HttpUtilsSuite)
+
+BOOST_AUTO_TEST_CASE(ResolveEndpointsCacheTest)
+{
+    const std::string host = "127.0.0.1";
+    const std::uint16_t port = 9889;
+
+    HttpUtils::invalidateEndpoints(host, port);
+
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+    BOOST_CHECK(!HttpUtils::findCachedEndpoints(host, port, endpoints));
+
+    boost::system::error_code errorCode;
+    auto resolvedEndpoints = HttpUtils::resolveEndpoints(host, port, errorCode);
+
+    BOOST_CHECK(!errorCode);
+    BOOST_REQUIRE_EQUAL(resolvedEndpoints.size(), 1);
+    BOOST_CHECK_EQUAL(resolvedEndpoints.front().address().to_string(), host);
+    BOOST_CHECK_EQUAL(resolvedEndpoints.front().port(), port);
+
+    BOOST_CHECK(HttpUtils::findCachedEndpoints(host, port, endpoints));
+    BOOST_CHECK(endpoints == resolvedEndpoints);
+
+    HttpUtils::invalidateEndpoints(host, port);
+    BOOST_CHECK(!HttpUtils::findCachedEndpoints(host, port, endpoints));
+}
+
+BOOST_AUTO_TEST_CASE(ConnectToAcceptingEndpointTest)
+{
+    boost::asio::io_service io;
+
+    boost::asio::ip::tcp::endpoint closedEndpoint(boost::asio::ip::address_v4::loopback(), getClosedPort(io));
+
+    boost::asio::ip::tcp::acceptor acceptor(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    boost::asio::ip::tcp::endpoint acceptingEndpoint = acceptor.local_endpoint();
+
+    boost::asio::ip::tcp::socket sock(io);
+    boost::system::error_code errorCode;
+    auto ep = HttpUtils::connect(io, sock, { closedEndpoint, acceptingEndpoint }, errorCode);
+
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK(ep == acceptingEndpoint);
+    BOOST_CHECK(sock.is_open());
+    BOOST_CHECK(sock.remote_endpoint(errorCode) == acceptingEndpoint);
+
+    boost::asio::ip::tcp::socket peer(io);
+    acceptor.accept(peer, errorCode);
+    BOOST_CHECK(!errorCode);
+
+    const std::string data = "data";
+    boost::asio::write(sock, boost::asio::buffer(data), errorCode);
+    BOOST_CHECK(!errorCode);
+
+    std::string received(data.size(), '\0');
+    boost::asio::read(peer, boost::asio::buffer(&received[0], received.size()), errorCode);
+    BOOST_CHECK(!errorCode);
+    BOOST_CHECK_EQUAL(received, data);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectFailureTest)
+{
+    boost::asio::io_service io;
+
+    boost::asio::ip::tcp::endpoint firstEndpoint(boost::asio::ip::address_v4::loopback(), getClosedPort(io));
+    boost::asio::ip::tcp::endpoint secondEndpoint(boost::asio::ip::address_v4::loopback(), getClosedPort(io));
+
+    boost::asio::ip::tcp::socket sock(io);
+    boost::system::error_code errorCode;
+    HttpUtils::connect(io, sock, { firstEndpoint, secondEndpoint }, errorCode);
+
+    BOOST_CHECK(errorCode);
+    BOOST_CHECK(!sock.is_open());
+
+    HttpUtils::connect(io, sock, {}, errorCode);
+    BOOST_CHECK(errorCode);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa
+{
+
+static std::vector<std::uint8_t> createRepetitiveData(std::size_t size)
+{
+    const std::string pattern = "{\"level\":\"INFO\",\"tag\":\"telemetry\",\"message\":\"temperature 21\"}";
+
+    std::vector<std::uint8_t> data;
+    while (data.size() < size) {
+        data.insert(data.end(), pattern.begin(), pattern.end());
+    }
+    data.resize(size);
+    return data;
+}
+
+BOOST_AUTO_TEST_SUITE(KaaSyncCompressorTestSuite)
+
+BOOST_AUTO_TEST_CASE(CompressAndDecompressTest)
+{
+    auto data = createRepetitiveData(64 * 1024);
+
+    std::vector<std::uint8_t> compressed;
+    BOOST_REQUIRE(KaaSyncCompressor::compress(data.data(), data.size(), compressed));
+    BOOST_CHECK(compressed.size() < data.size() / 5);
+
+    auto decompressed = KaaSyncCompressor::decompress(compressed.data(), compressed.size());
+    BOOST_CHECK(decompressed == data);
+}
+
+BOOST_AUTO_TEST_CASE(SmallDataIsNotCompressedTest)
+{
+    auto data = createRepetitiveData(KaaSyncCompressor::MIN_COMPRESSIBLE_SIZE - 1);
+
+    std::vector<std::uint8_t> compressed;
+    BOOST_CHECK(!KaaSyncCompressor::compress(data.data(), data.size(), compressed));
+}
+
+BOOST_AUTO_TEST_CASE(IncompressibleDataIsNotCompressedTest)
+{
+    std::vector<std::uint8_t> data(4096);
+    for (auto& byte : data) {
+        byte = std::rand() % 256;
+    }
+
+    std::vector<std::uint8_t> compressed;
+    BOOST_CHECK(!KaaSyncCompressor::compress(data.data(), data.size(), compressed));
+}
+
+BOOST_AUTO_TEST_CASE(DecompressCorruptedDataTest)
+{
+    auto data = createRepetitiveData(16 * 1024);
+
+    std::vector<std::uint8_t> compressed;
+    BOOST_REQUIRE(KaaSyncCompressor::compress(data.data(), data.size(), compressed));
+
+    BOOST_CHECK_THROW(KaaSyncCompressor::decompress(compressed.data(), compressed.size() / 2), KaaException);
+    BOOST_CHECK_THROW(KaaSyncCompressor::decompress(data.data(), data.size()), KaaException);
+    BOOST_CHECK_THROW(KaaSyncCompressor::decompress(nullptr, 0), KaaException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
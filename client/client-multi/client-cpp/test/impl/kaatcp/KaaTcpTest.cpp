@@ -20,8 +20,10 @@
 #include "kaa/kaatcp/KaaTcpResponseProcessor.hpp"
 #include "kaa/kaatcp/KaaSyncRequest.hpp"
 #include "kaa/kaatcp/ConnectMessage.hpp"
+#include "kaa/kaatcp/ConnackMessage.hpp"
 #include "kaa/kaatcp/PingRequest.hpp"
 #include "kaa/kaatcp/DisconnectMessage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
@@ -106,6 +108,69 @@ BOOST_AUTO_TEST_CASE(testTcpParser)
     BOOST_CHECK_EQUAL(0x02, message4.begin()->second.first[1]);
 }
 
+BOOST_AUTO_TEST_CASE(testTcpParserHandler)
+{
+    KaaTcpParser parser(clientContext);
+
+    std::vector<std::pair<const char *, std::uint32_t>> payloads;
+    std::vector<std::vector<char>> payloadCopies;
+    auto handler = [&payloads, &payloadCopies] (KaaTcpMessageType type, const char *payload, std::uint32_t size)
+        {
+            BOOST_CHECK_EQUAL((std::uint8_t) KaaTcpMessageType::MESSAGE_DISCONNECT, (std::uint8_t) type);
+            payloads.push_back(std::make_pair(payload, size));
+            payloadCopies.push_back(std::vector<char>(payload, payload + size));
+        };
+
+    /*
+     * Two DISCONNECT messages in one buffer and the third one split between two buffers.
+     */
+    char buffer[] = { (char) 0xE0, 0x02, 0x00, 0x01, (char) 0xE0, 0x02, 0x00, 0x02, (char) 0xE0, 0x02, 0x00 };
+    parser.parseBuffer(buffer, sizeof(buffer), handler);
+
+    BOOST_REQUIRE_EQUAL(2, payloads.size());
+    BOOST_CHECK(payloads[0].first == buffer + 2);
+    BOOST_CHECK(payloads[1].first == buffer + 6);
+    BOOST_CHECK_EQUAL(0x01, payloadCopies[0][1]);
+    BOOST_CHECK_EQUAL(0x02, payloadCopies[1][1]);
+
+    char buffer2[] = { 0x03 };
+    parser.parseBuffer(buffer2, sizeof(buffer2), handler);
+
+    BOOST_REQUIRE_EQUAL(3, payloads.size());
+    BOOST_CHECK_EQUAL(2, payloads[2].second);
+    BOOST_CHECK_EQUAL(0x00, payloadCopies[2][0]);
+    BOOST_CHECK_EQUAL(0x03, payloadCopies[2][1]);
+    BOOST_CHECK(parser.releaseMessages().empty());
+}
+
+BOOST_AUTO_TEST_CASE(testTcpParserLength)
+{
+    KaaTcpParser parser(clientContext);
+
+    /*
+     * A two-byte length decoded at once and split between buffers.
+     */
+    unsigned char buffer[] = { 0xE0, 0x82, 0x00, 0x00, 0x01 };
+    for (std::uint32_t split = 1; split <= 3; ++split) {
+        parser.parseBuffer((const char *) buffer, split);
+        parser.parseBuffer((const char *) buffer + split, sizeof(buffer) - split);
+        const auto& messages = parser.releaseMessages();
+        BOOST_REQUIRE_EQUAL(1, messages.size());
+        BOOST_CHECK_EQUAL(2, messages.begin()->second.second);
+        BOOST_CHECK_EQUAL(0x01, messages.begin()->second.first[1]);
+    }
+
+    /*
+     * The length takes at most four bytes.
+     */
+    unsigned char buffer2[] = { 0x20, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    BOOST_CHECK_THROW(parser.parseBuffer((const char *) buffer2, sizeof(buffer2)), KaaException);
+
+    parser.resetParser();
+    parser.parseBuffer((const char *) buffer2, 4);
+    BOOST_CHECK_THROW(parser.parseBuffer((const char *) buffer2 + 4, 1), KaaException);
+}
+
 class ResponseChecker
 {
 public:
@@ -202,6 +267,18 @@ BOOST_AUTO_TEST_CASE(testKaaSyncRequest)
 
 }
 
+BOOST_AUTO_TEST_CASE(testKaaSyncRequestHeader)
+{
+    std::vector<std::uint8_t> payload(200, 0xAB);
+    KaaSyncRequest request(true, true, 0x07, payload, KaaSyncMessageType::SYNC);
+
+    auto header = KaaSyncRequest::createHeader(true, true, 0x07, payload.size(), KaaSyncMessageType::SYNC);
+    header.insert(header.end(), payload.begin(), payload.end());
+
+    const auto& rawMessage = request.getRawMessage();
+    BOOST_CHECK_EQUAL_COLLECTIONS(header.begin(), header.end(), rawMessage.begin(), rawMessage.end());
+}
+
 BOOST_AUTO_TEST_CASE(testConnectMessage)
 {
     Botan::secure_vector<std::uint8_t> signature(32);
@@ -250,6 +327,38 @@ BOOST_AUTO_TEST_CASE(testConnectMessageWithoutKey)
             rawMessage.end());
 }
 
+BOOST_AUTO_TEST_CASE(testResumeSessionConnectMessage)
+{
+    std::vector<std::uint8_t> ticket = { 0xAA, 0xBB, 0xCC };
+    std::string payload = { (char) 0xFF, 0x01, 0x02, 0x03 };
+
+    ConnectMessage message = ConnectMessage::resumeSession(200, 0xf291f2d4, ticket, payload);
+
+    unsigned char checkConnectMessage[] = { 0x10, 0x1B, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x02, 0xF2, 0x91, 0xF2, 0xD4, 0x12, 0x00, 0x00, 0xC8,
+                                            0x00, 0x03, 0xAA, 0xBB, 0xCC, 0xFF, 0x01, 0x02, 0x03 };
+
+    const auto& rawMessage = message.getRawMessage();
+    BOOST_CHECK_EQUAL_COLLECTIONS(checkConnectMessage, checkConnectMessage + sizeof(checkConnectMessage),
+                                  rawMessage.begin(), rawMessage.end());
+}
+
+BOOST_AUTO_TEST_CASE(testConnackSessionTicket)
+{
+    const char withoutTicket[] = { 0x00, 0x01 };
+    ConnackMessage connack(withoutTicket, sizeof(withoutTicket));
+    BOOST_CHECK_EQUAL((std::uint8_t)ConnackReturnCode::ACCEPTED, (std::uint8_t)connack.getReturnCode());
+    BOOST_CHECK(connack.getSessionTicket().empty());
+
+    const char withTicket[] = { 0x01, 0x01, 0x01, 0x2C, (char) 0xAA, (char) 0xBB };
+    ConnackMessage ticketConnack(withTicket, sizeof(withTicket));
+    BOOST_CHECK_EQUAL((std::uint8_t)ConnackReturnCode::ACCEPTED, (std::uint8_t)ticketConnack.getReturnCode());
+    BOOST_CHECK_EQUAL(300, ticketConnack.getSessionTicketLifetime());
+    BOOST_CHECK(ticketConnack.getSessionTicket() == std::vector<std::uint8_t>({ 0xAA, 0xBB }));
+
+    const char truncatedTicket[] = { 0x01, 0x01, 0x01, 0x2C };
+    BOOST_CHECK_THROW(ConnackMessage(truncatedTicket, sizeof(truncatedTicket)), KaaException);
+}
+
 BOOST_AUTO_TEST_CASE(testPingRequest)
 {
     PingRequest request;
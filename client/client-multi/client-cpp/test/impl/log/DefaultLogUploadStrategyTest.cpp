@@ -69,6 +69,12 @@ BOOST_AUTO_TEST_CASE(GetSetMaxParallelUploads)
     BOOST_CHECK_EQUAL(strategy.getMaxParallelUploads(), count);
 }
 
+BOOST_AUTO_TEST_CASE(TimeIndependentTest)
+{
+    DefaultLogUploadStrategy strategy(clientContext);
+    BOOST_CHECK(!strategy.isTimeDependent());
+}
+
 BOOST_AUTO_TEST_CASE(UploadByOccupiedSizeTest)
 {
     const std::size_t THRESHOLD_SIZE = 35;
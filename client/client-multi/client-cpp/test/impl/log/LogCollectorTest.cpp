@@ -30,6 +30,8 @@
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/KaaClientContext.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/utils/TimeUtils.hpp"
+#include "kaa/common/AvroByteArrayConverter.hpp"
 
 #include "headers/MockKaaClientStateStorage.hpp"
 
@@ -325,6 +327,71 @@ BOOST_AUTO_TEST_CASE(FailedDeliveryTest)
     BOOST_CHECK_EQUAL(logDeliveryListener->onFailure_, 1);
 }
 
+BOOST_AUTO_TEST_CASE(EncodedRequestReuseTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::list<LogRecord> logs{ createSerializedLogRecord(),
+                                    createSerializedLogRecord()
+                                  };
+
+    LogBucket bucket(1, std::move(logs));
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = bucket;
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    auto encodedRequest = logCollector.getEncodedLogUploadRequest();
+    BOOST_REQUIRE(encodedRequest);
+
+    auto request = AvroByteArrayConverter<LogSyncRequest>().fromByteArray(encodedRequest->data(), encodedRequest->size());
+    BOOST_CHECK_EQUAL(request.requestId, 1);
+    BOOST_CHECK_EQUAL(request.logEntries.get_array().size(), 2);
+
+    LogSyncResponse response;
+    LogDeliveryStatus deliveryStatus;
+    deliveryStatus.requestId = request.requestId;
+    deliveryStatus.result = SyncResponseResultType::FAILURE;
+    deliveryStatus.errorCode.set_LogDeliveryErrorCode(LogDeliveryErrorCode::APPENDER_INTERNAL_ERROR);
+    response.deliveryStatuses.set_array({ deliveryStatus });
+
+    logCollector.onLogUploadResponse(response, mockLogDeliveryTime);
+
+    /*
+     * The retried bucket isn't encoded again.
+     */
+    BOOST_CHECK(logCollector.getEncodedLogUploadRequest() == encodedRequest);
+
+    deliveryStatus.result = SyncResponseResultType::SUCCESS;
+    deliveryStatus.errorCode.set_null();
+    response.deliveryStatuses.set_array({ deliveryStatus });
+
+    logCollector.onLogUploadResponse(response, mockLogDeliveryTime);
+
+    auto nextEncodedRequest = logCollector.getEncodedLogUploadRequest();
+    BOOST_REQUIRE(nextEncodedRequest);
+    BOOST_CHECK(nextEncodedRequest != encodedRequest);
+    BOOST_CHECK(*nextEncodedRequest == *encodedRequest);
+
+    testSleep(1);
+}
+
 BOOST_AUTO_TEST_CASE(TimeoutDetectionTest)
 {
     const size_t DELIVERY_TIMEOUT = 2;
@@ -385,6 +452,42 @@ BOOST_AUTO_TEST_CASE(TimeoutDetectionTest)
     BOOST_CHECK_EQUAL(logDeliveryListener->onTimeout_, 1);
 }
 
+BOOST_AUTO_TEST_CASE(TimeoutCheckedAtDeadlineTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = LogBucket(1, { createSerializedLogRecord() });
+
+    /*
+     * The check period doesn't delay the detection.
+     */
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = 1;
+    uploadStrategy->timeoutCheckPeriod_ = 3600;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    logCollector.getLogUploadRequest();
+    BOOST_CHECK_EQUAL(uploadStrategy->onTimeout_, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+    BOOST_CHECK_EQUAL(uploadStrategy->onTimeout_, 1);
+    BOOST_CHECK_EQUAL(logStorage->onRollbackBucket_, 1);
+}
+
 class RetryLogUploadStrategy : public MockLogUploadStrategy {
 public:
     virtual void onFailure(ILogFailoverCommand& controller, LogDeliveryErrorCode code)
@@ -586,6 +689,125 @@ BOOST_AUTO_TEST_CASE(MaxLogUploadLimitWithSyncLogging)
     joinThreadsSync(executor);
 }
 
+BOOST_AUTO_TEST_CASE(PipelinedUploadTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = LogBucket(1, { createSerializedLogRecord() });
+    logStorage->storageStatus_.recordsCount_ = 1;
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = 2;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::UPLOAD;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    /*
+     * The next bucket is requested without waiting for the delivery status.
+     */
+    BOOST_CHECK(logCollector.getLogUploadRequest());
+    testSleep(1);
+    BOOST_CHECK_EQUAL(transport.onSync_, 1);
+
+    /*
+     * No free upload slots are left.
+     */
+    logStorage->recordPack_ = LogBucket(2, { createSerializedLogRecord() });
+    BOOST_CHECK(logCollector.getLogUploadRequest());
+    testSleep(1);
+    BOOST_CHECK_EQUAL(transport.onSync_, 1);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveUploadWindowTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = 4;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    std::int32_t bucketId = 0;
+    auto sendBuckets = [&] (std::size_t expectedCount)
+            {
+                std::list<std::int32_t> requestIds;
+                for (std::size_t i = 0; i < expectedCount; ++i) {
+                    logStorage->recordPack_ = LogBucket(++bucketId, { createSerializedLogRecord() });
+                    auto request = logCollector.getLogUploadRequest();
+                    BOOST_REQUIRE(request);
+                    requestIds.push_back(request->requestId);
+                }
+
+                logStorage->recordPack_ = LogBucket(bucketId + 1, { createSerializedLogRecord() });
+                BOOST_CHECK(!logCollector.getLogUploadRequest());
+
+                return requestIds;
+            };
+
+    auto respond = [&] (std::int32_t requestId, SyncResponseResultType result)
+            {
+                LogSyncResponse response;
+                LogDeliveryStatus status;
+                status.requestId = requestId;
+                status.result = result;
+                response.deliveryStatuses.set_array({ status });
+                logCollector.onLogUploadResponse(response, TimeUtils::getCurrentTimeInMs());
+            };
+
+    auto requestIds = sendBuckets(4);
+
+    /*
+     * A delivery failure halves the window.
+     */
+    respond(requestIds.front(), SyncResponseResultType::FAILURE);
+    requestIds.pop_front();
+
+    for (auto requestId : requestIds) {
+        respond(requestId, SyncResponseResultType::SUCCESS);
+    }
+
+    requestIds = sendBuckets(4);
+    for (auto requestId : requestIds) {
+        respond(requestId, SyncResponseResultType::FAILURE);
+    }
+
+    requestIds = sendBuckets(1);
+
+    /*
+     * A fast delivery grows the window.
+     */
+    respond(requestIds.front(), SyncResponseResultType::SUCCESS);
+    sendBuckets(2);
+}
+
 BOOST_AUTO_TEST_CASE(RecordFuturesResult)
 {
     std::srand(std::time(nullptr));
@@ -649,6 +871,305 @@ BOOST_AUTO_TEST_CASE(RecordFuturesResult)
     joinThreadsSync(executor);
 }
 
+BOOST_AUTO_TEST_CASE(AddLogRecordWithPriorityTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    logCollector.addLogRecord(createLogRecord(), LogPriority::HIGH);
+    while (uploadStrategy->onIsUploadNeeded_ < 1) {
+        testSleep(1);
+    }
+    BOOST_CHECK(logStorage->lastRecordPriority_ == LogPriority::HIGH);
+
+    logCollector.addLogRecordWithoutFuture(createLogRecord(), LogPriority::LOW);
+    while (uploadStrategy->onIsUploadNeeded_ < 2) {
+        testSleep(1);
+    }
+    BOOST_CHECK(logStorage->lastRecordPriority_ == LogPriority::LOW);
+
+    logCollector.addLogRecord(createLogRecord());
+    while (uploadStrategy->onIsUploadNeeded_ < 3) {
+        testSleep(1);
+    }
+    BOOST_CHECK(logStorage->lastRecordPriority_ == LogPriority::NORMAL);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(AddLogRecordWithoutFutureTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::int32_t bucketId = 7;
+    std::size_t recordCount = 5;
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = LogBucket(bucketId, { createSerializedLogRecord() });
+    logStorage->bucketInfo_ = BucketInfo(bucketId, recordCount);
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    auto logDeliveryListener = std::make_shared<MockLogDeliveryListener>();
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+    logCollector.setLogDeliveryListener(logDeliveryListener);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logCollector.addLogRecordWithoutFuture(createLogRecord());
+    }
+
+    while (uploadStrategy->onIsUploadNeeded_ < recordCount) {
+        testSleep(1);
+    }
+
+    BOOST_CHECK_EQUAL(logStorage->onAddLogRecord_, recordCount);
+
+    auto request = logCollector.getLogUploadRequest();
+    BOOST_REQUIRE(request);
+
+    LogSyncResponse response;
+    LogDeliveryStatus status;
+    status.requestId = request->requestId;
+    status.result = SyncResponseResultType::SUCCESS;
+    response.deliveryStatuses.set_array({ status });
+    logCollector.onLogUploadResponse(response, mockLogDeliveryTime);
+    testSleep(1);
+
+    BOOST_CHECK_EQUAL(logStorage->onRemoveBucket_, 1);
+    BOOST_CHECK_EQUAL(logDeliveryListener->onSuccess_, 1);
+    BOOST_CHECK_EQUAL(logDeliveryListener->lastBucketInfo_.getBucketId(), bucketId);
+    BOOST_CHECK_EQUAL(logDeliveryListener->lastBucketInfo_.getLogCount(), recordCount);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(RecordBatchTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::int32_t bucketId = 9;
+    std::size_t recordCount = 5;
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = LogBucket(bucketId, { createSerializedLogRecord() });
+    logStorage->bucketInfo_ = BucketInfo(bucketId, recordCount);
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    RecordBatch batch;
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logCollector.addLogRecord(batch, createLogRecord());
+    }
+
+    auto batchFuture = batch.whenAll();
+    BOOST_CHECK_THROW(logCollector.addLogRecord(batch, createLogRecord()), KaaException);
+    BOOST_CHECK_EQUAL(batch.getRecordCount(), recordCount);
+
+    while (uploadStrategy->onIsUploadNeeded_ < recordCount) {
+        testSleep(1);
+    }
+
+    auto request = logCollector.getLogUploadRequest();
+    BOOST_REQUIRE(request);
+
+    LogSyncResponse response;
+    LogDeliveryStatus status;
+    status.requestId = request->requestId;
+    status.result = SyncResponseResultType::FAILURE;
+    response.deliveryStatuses.set_array({ status });
+    logCollector.onLogUploadResponse(response, mockLogDeliveryTime);
+    testSleep(1);
+
+    /*
+     * The failed bucket is retried, the batch keeps waiting for it.
+     */
+    BOOST_CHECK(!batchFuture.waitFor(std::chrono::milliseconds::zero()));
+    BOOST_CHECK_EQUAL(batch.getPendingRecordCount(), recordCount);
+
+    request = logCollector.getLogUploadRequest();
+    BOOST_REQUIRE(request);
+
+    status.requestId = request->requestId;
+    status.result = SyncResponseResultType::SUCCESS;
+    response.deliveryStatuses.set_array({ status });
+    logCollector.onLogUploadResponse(response, mockLogDeliveryTime);
+
+    BOOST_CHECK(batchFuture.waitFor(std::chrono::seconds(5)));
+    BOOST_CHECK_NO_THROW(batchFuture.get());
+    BOOST_CHECK_EQUAL(batch.getPendingRecordCount(), 0);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentAddLogRecordTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    const std::size_t producerCount = 8;
+    const std::size_t recordsPerProducer = 100;
+
+    std::list<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&logCollector, recordsPerProducer] ()
+                {
+                    for (std::size_t j = 0; j < recordsPerProducer; ++j) {
+                        logCollector.addLogRecord(createLogRecord());
+                    }
+                });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    while (uploadStrategy->onIsUploadNeeded_ < producerCount * recordsPerProducer) {
+        testSleep(1);
+    }
+
+    BOOST_CHECK_EQUAL(logStorage->onAddLogRecord_, producerCount * recordsPerProducer);
+    BOOST_CHECK_EQUAL(uploadStrategy->onIsUploadNeeded_, producerCount * recordsPerProducer);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(LogUploadCheckDeadlineTest)
+{
+    const std::size_t LOG_UPLOAD_CHECK_PERIOD = 2;
+    const std::size_t RECORD_COUNT = 6;
+
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->storageStatus_.recordsCount_ = 1;
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = LOG_UPLOAD_CHECK_PERIOD;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    /*
+     * Records are added more often than the check period, but they don't postpone the check.
+     */
+    for (std::size_t i = 0; i < RECORD_COUNT; ++i) {
+        logCollector.addLogRecord(createLogRecord());
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    BOOST_CHECK(uploadStrategy->onIsUploadNeeded_ > RECORD_COUNT);
+
+    joinThreadsSync(executor);
+}
+
+BOOST_AUTO_TEST_CASE(NoLogUploadCheckForTimeIndependentStrategyTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->storageStatus_.recordsCount_ = 1;
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeoutCheckPeriod_ = 1;
+    uploadStrategy->logUploadCheckPeriod_ = 1;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+    uploadStrategy->isTimeDependent_ = false;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    logCollector.addLogRecord(createLogRecord());
+    testSleep(3);
+
+    BOOST_CHECK_EQUAL(uploadStrategy->onIsUploadNeeded_, 1);
+    BOOST_CHECK_EQUAL(transport.onSync_, 0);
+
+    joinThreadsSync(executor);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <cstdio>
+#include <fstream>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "kaa/log/MMapSegmentLogStorage.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/KaaClientProperties.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+namespace kaa {
+
+static std::string testLogData("segment test data");
+static std::string testSegmentDirectory("test_log_segments");
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static void removeSegments(const std::string& directory)
+{
+    DIR *dir = opendir(directory.c_str());
+    if (dir) {
+        while (struct dirent *entry = readdir(dir)) {
+            std::string name(entry->d_name);
+            if (name != "." && name != "..") {
+                std::remove((directory + "/" + name).c_str());
+            }
+        }
+        closedir(dir);
+        rmdir(directory.c_str());
+    }
+}
+
+static std::size_t countSegments(const std::string& directory)
+{
+    std::size_t count = 0;
+    DIR *dir = opendir(directory.c_str());
+    if (dir) {
+        while (struct dirent *entry = readdir(dir)) {
+            std::string name(entry->d_name);
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".seg") == 0) {
+                ++count;
+            }
+        }
+        closedir(dir);
+    }
+    return count;
+}
+
+static LogRecord createSerializedLogRecord(const std::string& data = testLogData)
+{
+    KaaUserLogRecord logRecord;
+    logRecord.logdata = data;
+
+    return LogRecord(logRecord);
+}
+
+BOOST_AUTO_TEST_SUITE(MMapSegmentLogStorageTestSuite)
+
+BOOST_AUTO_TEST_CASE(TooBigLogRecordTest)
+{
+    removeSegments(testSegmentDirectory);
+
+    auto record = createSerializedLogRecord();
+    MMapSegmentLogStorage storage(clientContext, testSegmentDirectory, record.getSize() - 1);
+
+    BOOST_CHECK_THROW(storage.addLogRecord(std::move(record)), KaaException);
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), 0);
+
+    removeSegments(testSegmentDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(AddRecordsAndBucketizeTest)
+{
+    removeSegments(testSegmentDirectory);
+
+    std::size_t bucketRecordCount = 3;
+    std::size_t recordCount = 7;
+    std::size_t recordSize = createSerializedLogRecord().getSize();
+
+    MMapSegmentLogStorage storage(clientContext, testSegmentDirectory,
+                                  LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, bucketRecordCount);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        storage.addLogRecord(createSerializedLogRecord());
+    }
+
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), recordCount);
+    BOOST_CHECK_EQUAL(storage.getStatus().getConsumedVolume(), recordCount * recordSize);
+    BOOST_CHECK_EQUAL(countSegments(testSegmentDirectory), 3);
+
+    auto bucket = storage.getNextBucket();
+    BOOST_CHECK_EQUAL(bucket.getRecords().size(), bucketRecordCount);
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), recordCount - bucketRecordCount);
+
+    storage.removeBucket(bucket.getBucketId());
+    BOOST_CHECK_EQUAL(countSegments(testSegmentDirectory), 2);
+
+    bucket = storage.getNextBucket();
+    BOOST_CHECK_EQUAL(bucket.getRecords().size(), bucketRecordCount);
+
+    /*
+     * The last segment is not full, but it is taken too.
+     */
+    auto lastBucket = storage.getNextBucket();
+    BOOST_CHECK_EQUAL(lastBucket.getRecords().size(), recordCount - 2 * bucketRecordCount);
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), 0);
+    BOOST_CHECK_EQUAL(storage.getNextBucket().getRecords().size(), 0);
+
+    storage.rollbackBucket(bucket.getBucketId());
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), bucketRecordCount);
+    BOOST_CHECK_EQUAL(storage.getNextBucket().getBucketId(), bucket.getBucketId());
+
+    /*
+     * New records go to a new segment.
+     */
+    auto bucketInfo = storage.addLogRecord(createSerializedLogRecord());
+    BOOST_CHECK(bucketInfo.getBucketId() > lastBucket.getBucketId());
+    BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), 1);
+
+    removeSegments(testSegmentDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(RecordsContentTest)
+{
+    removeSegments(testSegmentDirectory);
+
+    std::size_t recordCount = 10;
+    MMapSegmentLogStorage storage(clientContext, testSegmentDirectory);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        storage.addLogRecord(createSerializedLogRecord(std::string(i + 1, 'a' + i)));
+    }
+
+    std::size_t recordIndex = 0;
+    auto bucketInfo = storage.visitNextBucket([&recordIndex] (const std::uint8_t *data, std::size_t size)
+            {
+                auto expectedRecord = createSerializedLogRecord(std::string(recordIndex + 1, 'a' + recordIndex));
+                auto& expectedData = expectedRecord.getData();
+                BOOST_CHECK_EQUAL_COLLECTIONS(data, data + size, expectedData.begin(), expectedData.end());
+                ++recordIndex;
+            });
+
+    BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), recordCount);
+    BOOST_CHECK_EQUAL(recordIndex, recordCount);
+
+    removeSegments(testSegmentDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(RestoreAfterRestartTest)
+{
+    removeSegments(testSegmentDirectory);
+
+    std::size_t bucketRecordCount = 2;
+    std::size_t recordCount = 5;
+    std::size_t recordSize = createSerializedLogRecord().getSize();
+    std::int32_t inUseBucketId = 0;
+
+    {
+        MMapSegmentLogStorage storage(clientContext, testSegmentDirectory,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, bucketRecordCount);
+        for (std::size_t i = 0; i < recordCount; ++i) {
+            storage.addLogRecord(createSerializedLogRecord());
+        }
+
+        /*
+         * The bucket is in use, but not delivered.
+         */
+        inUseBucketId = storage.getNextBucket().getBucketId();
+    }
+
+    {
+        MMapSegmentLogStorage storage(clientContext, testSegmentDirectory,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, bucketRecordCount);
+
+        BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), recordCount);
+        BOOST_CHECK_EQUAL(storage.getStatus().getConsumedVolume(), recordCount * recordSize);
+
+        auto bucket = storage.getNextBucket();
+        BOOST_CHECK_EQUAL(bucket.getBucketId(), inUseBucketId);
+        BOOST_CHECK_EQUAL(bucket.getRecords().size(), bucketRecordCount);
+        storage.removeBucket(bucket.getBucketId());
+
+        auto bucketInfo = storage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK(bucketInfo.getBucketId() > inUseBucketId + 2);
+    }
+
+    {
+        MMapSegmentLogStorage storage(clientContext, testSegmentDirectory,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, bucketRecordCount);
+        BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), recordCount - bucketRecordCount + 1);
+    }
+
+    removeSegments(testSegmentDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSegmentIsRemovedTest)
+{
+    removeSegments(testSegmentDirectory);
+
+    {
+        MMapSegmentLogStorage storage(clientContext, testSegmentDirectory);
+        storage.addLogRecord(createSerializedLogRecord());
+    }
+
+    {
+        std::ofstream invalidSegment(testSegmentDirectory + "/100.seg");
+        invalidSegment << "not a segment";
+    }
+
+    BOOST_CHECK_EQUAL(countSegments(testSegmentDirectory), 2);
+
+    MMapSegmentLogStorage storage(clientContext, testSegmentDirectory);
+    BOOST_CHECK_EQUAL(storage.getStatus().getRecordsCount(), 1);
+    BOOST_CHECK_EQUAL(countSegments(testSegmentDirectory), 1);
+
+    removeSegments(testSegmentDirectory);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
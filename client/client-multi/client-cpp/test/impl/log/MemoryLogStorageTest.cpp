@@ -18,6 +18,9 @@
 
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "kaa/log/LogRecord.hpp"
 #include "kaa/log/MemoryLogStorage.hpp"
@@ -28,6 +31,7 @@
 #include "kaa/KaaClientProperties.hpp"
 #include "kaa/logging/DefaultLogger.hpp"
 
+#include "headers/AllocationCounter.hpp"
 #include "headers/MockKaaClientStateStorage.hpp"
 #include "headers/context/MockExecutorContext.hpp"
 
@@ -51,6 +55,25 @@ static LogRecord createSerializedLogRecord()
     return LogRecord(logRecord);
 }
 
+static LogRecord createLogRecord(const std::string& data, LogPriority priority)
+{
+    KaaUserLogRecord logRecord;
+    logRecord.logdata = data;
+
+    return LogRecord(logRecord, priority);
+}
+
+static std::vector<std::vector<std::uint8_t>> visitNextBucket(MemoryLogStorage& logStorage)
+{
+    std::vector<std::vector<std::uint8_t>> records;
+    logStorage.visitNextBucket([&records] (const std::uint8_t *data, std::size_t size)
+            {
+                records.emplace_back(data, data + size);
+            });
+
+    return records;
+}
+
 BOOST_AUTO_TEST_SUITE(MemoryLogStorageTestSuite)
 
 BOOST_AUTO_TEST_CASE(BadInitializationParamsTest)
@@ -144,6 +167,38 @@ BOOST_AUTO_TEST_CASE(BucketSizeInBytesConstraint)
     BOOST_CHECK(bucket.getRecords().empty());
 }
 
+BOOST_AUTO_TEST_CASE(SetBucketLimitsTest)
+{
+    MemoryLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+
+    BOOST_CHECK_THROW(logStorage.setBucketLimits(0, 1), KaaException);
+    BOOST_CHECK_THROW(logStorage.setBucketLimits(1, 0), KaaException);
+
+    logStorage.addLogRecord(createSerializedLogRecord());
+
+    std::size_t serializedLogSize = createSerializedLogRecord().getSize();
+    BOOST_CHECK(logStorage.setBucketLimits(serializedLogSize * 2, 2));
+
+    /*
+     * The record count limit applies to the current bucket too.
+     */
+    const std::size_t logRecordCount = 5;
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    std::size_t bucketCount = 0;
+    while (!logStorage.getNextBucket().getRecords().empty()) {
+        ++bucketCount;
+    }
+
+    BOOST_CHECK_EQUAL(bucketCount, 3);
+
+    BOOST_CHECK(logStorage.setBucketLimits(serializedLogSize - 1, 2));
+    BOOST_CHECK_THROW(logStorage.addLogRecord(createSerializedLogRecord()), KaaException);
+}
+
 BOOST_AUTO_TEST_CASE(GetStatusAfterLogBlockTest)
 {
     /*
@@ -270,6 +325,340 @@ BOOST_AUTO_TEST_CASE(ForceRemovalOfSpecifiedPercentOfLogsTest)
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), sizeAfterRemoval);
 }
 
+BOOST_AUTO_TEST_CASE(AddRecordAllocationsTest)
+{
+    /*
+     * Trace messages are formatted on the heap, so they are disabled here.
+     */
+    DefaultLogger logger(properties.getClientId());
+    logger.setLevel(LogLevel::KAA_INFO);
+    KaaClientContext context(properties, logger, tmpExecContext, tmp_state);
+    MemoryLogStorage logStorage(context);
+
+    const std::size_t recordCount = 4 * LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT;
+    std::vector<LogRecord> records;
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        records.push_back(createSerializedLogRecord());
+    }
+
+    /*
+     * Records are copied into the storage of their bucket, which grows geometrically.
+     */
+    AllocationScope scope;
+    for (auto& record : records) {
+        logStorage.addLogRecord(std::move(record));
+    }
+    KAA_CHECK_MAX_ALLOCATIONS(scope, recordCount / 8);
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+}
+
+BOOST_AUTO_TEST_CASE(ReleaseMemoryTest)
+{
+    std::size_t logRecordCount = 10;
+    std::size_t serializedLogSize = createSerializedLogRecord().getSize();
+
+    MemoryLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, logRecordCount / 2);
+    ILogStorage& storage = logStorage;
+
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    /*
+     * Records of the bucket being uploaded occupy memory too.
+     */
+    logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(storage.getMemoryUsage(), logRecordCount * serializedLogSize);
+
+    BOOST_CHECK(storage.releaseMemory(logRecordCount * serializedLogSize));
+    BOOST_CHECK_EQUAL(storage.getMemoryUsage(), logRecordCount * serializedLogSize);
+
+    BOOST_CHECK(storage.releaseMemory(3 * serializedLogSize));
+    BOOST_CHECK_EQUAL(storage.getMemoryUsage(), 3 * serializedLogSize);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 3);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), 3 * serializedLogSize);
+
+    BOOST_CHECK(storage.releaseMemory(0));
+    BOOST_CHECK_EQUAL(storage.getMemoryUsage(), 0);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(RecordsContentAfterPartialRemovalTest)
+{
+    std::size_t logRecordCount = 10;
+    std::size_t recordsToRemove = 3;
+
+    std::vector<LogRecord> expectedRecords;
+    std::size_t maxLogStorageSize = 0;
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        KaaUserLogRecord logRecord;
+        logRecord.logdata = std::string(i + 1, 'a' + i);
+
+        expectedRecords.emplace_back(logRecord);
+        maxLogStorageSize += expectedRecords.back().getSize();
+    }
+
+    std::size_t removedSize = 0;
+    for (std::size_t i = 0; i < recordsToRemove; ++i) {
+        removedSize += expectedRecords[i].getSize();
+    }
+
+    /*
+     * Half a byte less, so the float rounding does not cause removal of one more record
+     */
+    float percentToDelete = 100.0 * (removedSize - 0.5) / maxLogStorageSize;
+
+    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete);
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        LogRecord record(expectedRecords[i].getData().data(), expectedRecords[i].getSize());
+        logStorage.addLogRecord(std::move(record));
+    }
+
+    KaaUserLogRecord lastLogRecord;
+    lastLogRecord.logdata = "last";
+    expectedRecords.emplace_back(lastLogRecord);
+
+    /*
+     * Should cause removal of the oldest records from the only bucket
+     */
+    LogRecord lastRecord(expectedRecords.back().getData().data(), expectedRecords.back().getSize());
+    logStorage.addLogRecord(std::move(lastRecord));
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), logRecordCount + 1 - recordsToRemove);
+
+    std::size_t recordIndex = recordsToRemove;
+    auto bucketInfo = logStorage.visitNextBucket([&] (const std::uint8_t *data, std::size_t size)
+            {
+                BOOST_REQUIRE(recordIndex < expectedRecords.size());
+
+                auto& expectedData = expectedRecords[recordIndex++].getData();
+                BOOST_CHECK_EQUAL_COLLECTIONS(data, data + size, expectedData.begin(), expectedData.end());
+            });
+
+    BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), logRecordCount + 1 - recordsToRemove);
+    BOOST_CHECK_EQUAL(recordIndex, expectedRecords.size());
+
+    logStorage.rollbackBucket(bucketInfo.getBucketId());
+
+    auto logBucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(logBucket.getBucketId(), bucketInfo.getBucketId());
+
+    recordIndex = recordsToRemove;
+    for (auto& record : logBucket.getRecords()) {
+        auto& expectedData = expectedRecords[recordIndex++].getData();
+        BOOST_CHECK_EQUAL_COLLECTIONS(record.getData().begin(), record.getData().end(),
+                                      expectedData.begin(), expectedData.end());
+    }
+
+    BOOST_CHECK_EQUAL(recordIndex, expectedRecords.size());
+}
+
+BOOST_AUTO_TEST_CASE(LowPriorityRecordsAreEvictedFirstTest)
+{
+    std::size_t serializedLogSize = createLogRecord("a", LogPriority::NORMAL).getSize();
+    std::size_t maxLogStorageSize = 4 * serializedLogSize;
+    float percentToDelete = 50.0;
+
+    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete);
+    logStorage.addLogRecord(createLogRecord("a", LogPriority::HIGH));
+    logStorage.addLogRecord(createLogRecord("b", LogPriority::LOW));
+    logStorage.addLogRecord(createLogRecord("c", LogPriority::NORMAL));
+    logStorage.addLogRecord(createLogRecord("d", LogPriority::LOW));
+
+    /*
+     * Should cause removal of both low priority records
+     */
+    logStorage.addLogRecord(createLogRecord("e", LogPriority::NORMAL));
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 3);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), 3 * serializedLogSize);
+
+    auto records = visitNextBucket(logStorage);
+    BOOST_REQUIRE_EQUAL(records.size(), 3);
+    BOOST_CHECK(records[0] == createLogRecord("a", LogPriority::HIGH).getData());
+    BOOST_CHECK(records[1] == createLogRecord("c", LogPriority::NORMAL).getData());
+    BOOST_CHECK(records[2] == createLogRecord("e", LogPriority::NORMAL).getData());
+}
+
+BOOST_AUTO_TEST_CASE(ExpiredRecordsAreEvictedFirstTest)
+{
+    std::size_t serializedLogSize = createLogRecord("a", LogPriority::NORMAL).getSize();
+    std::size_t maxLogStorageSize = 4 * serializedLogSize;
+    float percentToDelete = 50.0;
+
+    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete);
+    logStorage.setRecordTimeToLive(LogPriority::HIGH, std::chrono::milliseconds(1));
+
+    logStorage.addLogRecord(createLogRecord("a", LogPriority::LOW));
+    logStorage.addLogRecord(createLogRecord("b", LogPriority::HIGH));
+    logStorage.addLogRecord(createLogRecord("c", LogPriority::LOW));
+    logStorage.addLogRecord(createLogRecord("d", LogPriority::LOW));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    /*
+     * Should cause removal of the expired record and then of the oldest low priority one
+     */
+    logStorage.addLogRecord(createLogRecord("e", LogPriority::LOW));
+
+    auto records = visitNextBucket(logStorage);
+    BOOST_REQUIRE_EQUAL(records.size(), 3);
+    BOOST_CHECK(records[0] == createLogRecord("c", LogPriority::LOW).getData());
+    BOOST_CHECK(records[1] == createLogRecord("d", LogPriority::LOW).getData());
+    BOOST_CHECK(records[2] == createLogRecord("e", LogPriority::LOW).getData());
+}
+
+BOOST_AUTO_TEST_CASE(ExpiredRecordsAreNotUploadedTest)
+{
+    MemoryLogStorage logStorage(clientContext);
+    logStorage.setRecordTimeToLive(LogPriority::LOW, std::chrono::milliseconds(1));
+
+    logStorage.addLogRecord(createLogRecord("a", LogPriority::LOW));
+    logStorage.addLogRecord(createLogRecord("b", LogPriority::NORMAL));
+    logStorage.addLogRecord(createLogRecord("c", LogPriority::LOW));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    auto records = visitNextBucket(logStorage);
+    BOOST_REQUIRE_EQUAL(records.size(), 1);
+    BOOST_CHECK(records[0] == createLogRecord("b", LogPriority::NORMAL).getData());
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+    BOOST_CHECK_EQUAL(logStorage.getMemoryUsage(), records[0].size());
+}
+
+BOOST_AUTO_TEST_CASE(EvictionAfterRemovalOfBucketsTest)
+{
+    std::size_t bucketRecordCount = 3;
+    std::size_t serializedLogSize = createLogRecord("a", LogPriority::NORMAL).getSize();
+    std::size_t maxLogStorageSize = 10 * serializedLogSize;
+    float percentToDelete = 50.0;
+
+    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete,
+                                LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, bucketRecordCount);
+    logStorage.setRecordTimeToLive(LogPriority::NORMAL, std::chrono::hours(1));
+
+    /*
+     * Entries of removed records are dropped from the eviction index.
+     */
+    for (std::size_t i = 0; i < 1000; ++i) {
+        logStorage.addLogRecord(createLogRecord("a", i % 2 ? LogPriority::NORMAL : LogPriority::LOW));
+        if (i % bucketRecordCount == bucketRecordCount - 1) {
+            logStorage.removeBucket(logStorage.getNextBucket().getBucketId());
+        }
+    }
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 1);
+
+    for (std::size_t i = 0; i < 9; ++i) {
+        logStorage.addLogRecord(createLogRecord("b", LogPriority::HIGH));
+    }
+
+    /*
+     * Should cause removal of the normal priority record and of the oldest high priority ones
+     */
+    logStorage.addLogRecord(createLogRecord("c", LogPriority::NORMAL));
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 6);
+    BOOST_CHECK_EQUAL(logStorage.getMemoryUsage(), 6 * serializedLogSize);
+
+    std::size_t recordCount = 0;
+    while (logStorage.getStatus().getRecordsCount()) {
+        recordCount += visitNextBucket(logStorage).size();
+    }
+
+    BOOST_CHECK_EQUAL(recordCount, 6);
+}
+
+static std::string createReading(std::size_t index)
+{
+    return "sensor=kitchen-thermometer-0001;unit=celsius;value=" + std::to_string(200 + index % 7)
+            + ";battery=ok;firmware=1.4.2";
+}
+
+BOOST_AUTO_TEST_CASE(DeltaEncodingTest)
+{
+    std::size_t recordCount = 50;
+
+    MemoryLogStorage logStorage(clientContext);
+    logStorage.setDeltaEncoding(true);
+
+    std::vector<std::vector<std::uint8_t>> expectedRecords;
+    std::size_t serializedLogsSize = 0;
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        auto record = createLogRecord(createReading(i), LogPriority::NORMAL);
+        expectedRecords.push_back(record.getData());
+        serializedLogsSize += record.getSize();
+        logStorage.addLogRecord(std::move(record));
+    }
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+    BOOST_CHECK_LT(logStorage.getMemoryUsage(), serializedLogsSize / 4);
+
+    auto records = visitNextBucket(logStorage);
+    BOOST_CHECK(records == expectedRecords);
+}
+
+BOOST_AUTO_TEST_CASE(DeltaEncodingBucketSizeTest)
+{
+    std::size_t serializedLogSize = createLogRecord(createReading(0), LogPriority::NORMAL).getSize();
+    std::size_t bucketRecordCount = 5;
+
+    /*
+     * The bucket size limit counts decoded records.
+     */
+    MemoryLogStorage logStorage(clientContext, bucketRecordCount * serializedLogSize,
+                                LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+    logStorage.setDeltaEncoding(true);
+
+    for (std::size_t i = 0; i < 2 * bucketRecordCount; ++i) {
+        logStorage.addLogRecord(createLogRecord(createReading(i), LogPriority::NORMAL));
+    }
+
+    BOOST_CHECK_EQUAL(visitNextBucket(logStorage).size(), bucketRecordCount);
+    BOOST_CHECK_EQUAL(visitNextBucket(logStorage).size(), bucketRecordCount);
+}
+
+BOOST_AUTO_TEST_CASE(DeltaEncodingEvictionTest)
+{
+    MemoryLogStorage logStorage(clientContext);
+    logStorage.setDeltaEncoding(true);
+    logStorage.setRecordTimeToLive(LogPriority::LOW, std::chrono::milliseconds(1));
+
+    /*
+     * Records following an evicted record are restored against it.
+     */
+    std::vector<std::vector<std::uint8_t>> expectedRecords;
+    for (std::size_t i = 0; i < 10; ++i) {
+        auto priority = i % 3 ? LogPriority::NORMAL : LogPriority::LOW;
+        auto record = createLogRecord(createReading(i), priority);
+        if (priority != LogPriority::LOW) {
+            expectedRecords.push_back(record.getData());
+        }
+        logStorage.addLogRecord(std::move(record));
+    }
+
+    /*
+     * Records added with delta encoding disabled are stored as is.
+     */
+    logStorage.setDeltaEncoding(false);
+    auto record = createLogRecord(createReading(10), LogPriority::NORMAL);
+    expectedRecords.push_back(record.getData());
+    logStorage.addLogRecord(std::move(record));
+
+    logStorage.setDeltaEncoding(true);
+    record = createLogRecord(createReading(11), LogPriority::NORMAL);
+    expectedRecords.push_back(record.getData());
+    logStorage.addLogRecord(std::move(record));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    auto records = visitNextBucket(logStorage);
+    BOOST_CHECK(records == expectedRecords);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/PriorityLogStorage.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static LogRecord createLogRecord(LogPriority priority)
+{
+    KaaUserLogRecord record;
+    record.logdata = "test data";
+    return LogRecord(record, priority);
+}
+
+static std::size_t getRecordSize()
+{
+    return createLogRecord(LogPriority::NORMAL).getSize();
+}
+
+static LogPriority getBucketPriority(std::int32_t bucketId, const std::map<std::int32_t, LogPriority>& bucketPriorities)
+{
+    auto it = bucketPriorities.find(bucketId);
+    BOOST_REQUIRE(it != bucketPriorities.end());
+    return it->second;
+}
+
+BOOST_AUTO_TEST_SUITE(PriorityLogStorageTestSuite)
+
+BOOST_AUTO_TEST_CASE(BadInitializationParamsTest)
+{
+    PriorityLogStorage::LaneStorages lanes;
+    BOOST_CHECK_THROW(PriorityLogStorage(clientContext, lanes), KaaException);
+
+    auto storage = std::make_shared<MemoryLogStorage>(clientContext);
+    lanes = {{ storage, std::make_shared<MemoryLogStorage>(clientContext), storage }};
+    BOOST_CHECK_THROW(PriorityLogStorage(clientContext, lanes), KaaException);
+
+    PriorityLogStorage logStorage(clientContext);
+    BOOST_CHECK_THROW(logStorage.setLaneWeight(LogPriority::HIGH, 0), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(RecordsGoToLaneOfTheirPriorityTest)
+{
+    PriorityLogStorage logStorage(clientContext);
+
+    logStorage.addLogRecord(createLogRecord(LogPriority::HIGH));
+    logStorage.addLogRecord(createLogRecord(LogPriority::LOW));
+    logStorage.addLogRecord(createLogRecord(LogPriority::LOW));
+
+    BOOST_CHECK_EQUAL(logStorage.getLaneStatus(LogPriority::HIGH).getRecordsCount(), 1);
+    BOOST_CHECK_EQUAL(logStorage.getLaneStatus(LogPriority::NORMAL).getRecordsCount(), 0);
+    BOOST_CHECK_EQUAL(logStorage.getLaneStatus(LogPriority::LOW).getRecordsCount(), 2);
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 3);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), 3 * getRecordSize());
+}
+
+BOOST_AUTO_TEST_CASE(BucketIdsAreUniqueAcrossLanesTest)
+{
+    PriorityLogStorage logStorage(clientContext);
+
+    std::set<std::int32_t> bucketIds;
+    bucketIds.insert(logStorage.addLogRecord(createLogRecord(LogPriority::HIGH)).getBucketId());
+    bucketIds.insert(logStorage.addLogRecord(createLogRecord(LogPriority::NORMAL)).getBucketId());
+    bucketIds.insert(logStorage.addLogRecord(createLogRecord(LogPriority::LOW)).getBucketId());
+
+    BOOST_CHECK_EQUAL(bucketIds.size(), LOG_PRIORITY_COUNT);
+
+    for (std::size_t i = 0; i < LOG_PRIORITY_COUNT; ++i) {
+        auto bucket = logStorage.getNextBucket();
+        BOOST_CHECK_EQUAL(bucket.getRecords().size(), 1);
+        BOOST_CHECK_EQUAL(bucketIds.erase(bucket.getBucketId()), 1);
+    }
+
+    BOOST_CHECK(logStorage.getNextBucket().getRecords().empty());
+}
+
+BOOST_AUTO_TEST_CASE(RemoveAndRollbackBucketTest)
+{
+    PriorityLogStorage logStorage(clientContext);
+
+    logStorage.addLogRecord(createLogRecord(LogPriority::HIGH));
+    logStorage.addLogRecord(createLogRecord(LogPriority::LOW));
+
+    auto highBucket = logStorage.getNextBucket();
+    auto lowBucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+
+    logStorage.rollbackBucket(lowBucket.getBucketId());
+    BOOST_CHECK_EQUAL(logStorage.getLaneStatus(LogPriority::LOW).getRecordsCount(), 1);
+
+    logStorage.removeBucket(highBucket.getBucketId());
+    BOOST_CHECK_EQUAL(logStorage.getLaneStatus(LogPriority::HIGH).getRecordsCount(), 0);
+
+    auto bucketInfo = logStorage.visitNextBucket([] (const std::uint8_t *data, std::size_t size) {});
+    BOOST_CHECK_EQUAL(bucketInfo.getBucketId(), lowBucket.getBucketId());
+    BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(WeightedLaneSelectionTest)
+{
+    /*
+     * One record per bucket.
+     */
+    PriorityLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, 1);
+
+    const std::size_t recordCount = 70;
+    std::map<std::int32_t, LogPriority> bucketPriorities;
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        for (auto priority : { LogPriority::HIGH, LogPriority::NORMAL, LogPriority::LOW }) {
+            auto bucketInfo = logStorage.addLogRecord(createLogRecord(priority));
+            bucketPriorities[bucketInfo.getBucketId()] = priority;
+        }
+    }
+
+    /*
+     * The weights are 4:2:1, so first 70 buckets are 40 high, 20 normal and 10 low priority ones.
+     */
+    std::map<LogPriority, std::size_t> selectedCount;
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        auto bucketInfo = logStorage.visitNextBucket([] (const std::uint8_t *data, std::size_t size) {});
+        BOOST_REQUIRE_EQUAL(bucketInfo.getLogCount(), 1);
+        ++selectedCount[getBucketPriority(bucketInfo.getBucketId(), bucketPriorities)];
+    }
+
+    BOOST_CHECK_EQUAL(selectedCount[LogPriority::HIGH], 40);
+    BOOST_CHECK_EQUAL(selectedCount[LogPriority::NORMAL], 20);
+    BOOST_CHECK_EQUAL(selectedCount[LogPriority::LOW], 10);
+
+    /*
+     * Lanes without records are skipped.
+     */
+    std::size_t remainingBucketCount = 0;
+    while (logStorage.visitNextBucket([] (const std::uint8_t *data, std::size_t size) {}).getLogCount()) {
+        ++remainingBucketCount;
+    }
+
+    BOOST_CHECK_EQUAL(remainingBucketCount, 2 * recordCount);
+}
+
+BOOST_AUTO_TEST_CASE(HighPriorityIsNotDelayedByBacklogTest)
+{
+    PriorityLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, 1);
+    logStorage.setLaneWeight(LogPriority::HIGH, 1);
+    logStorage.setLaneWeight(LogPriority::LOW, 1);
+
+    std::map<std::int32_t, LogPriority> bucketPriorities;
+    for (std::size_t i = 0; i < 100; ++i) {
+        auto bucketInfo = logStorage.addLogRecord(createLogRecord(LogPriority::LOW));
+        bucketPriorities[bucketInfo.getBucketId()] = LogPriority::LOW;
+    }
+
+    auto bucketInfo = logStorage.addLogRecord(createLogRecord(LogPriority::HIGH));
+    bucketPriorities[bucketInfo.getBucketId()] = LogPriority::HIGH;
+
+    bool isHighPrioritySelected = false;
+    for (std::size_t i = 0; i < 2 && !isHighPrioritySelected; ++i) {
+        auto bucketInfo = logStorage.visitNextBucket([] (const std::uint8_t *data, std::size_t size) {});
+        isHighPrioritySelected = (getBucketPriority(bucketInfo.getBucketId(), bucketPriorities) == LogPriority::HIGH);
+    }
+
+    BOOST_CHECK(isHighPrioritySelected);
+}
+
+BOOST_AUTO_TEST_CASE(SetBucketLimitsTest)
+{
+    PriorityLogStorage logStorage(clientContext);
+    BOOST_CHECK(logStorage.setBucketLimits(getRecordSize(), 1));
+
+    logStorage.addLogRecord(createLogRecord(LogPriority::NORMAL));
+    logStorage.addLogRecord(createLogRecord(LogPriority::NORMAL));
+
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getRecords().size(), 1);
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getRecords().size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
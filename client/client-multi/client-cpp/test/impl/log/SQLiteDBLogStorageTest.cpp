@@ -19,6 +19,10 @@
 #include <string>
 #include <cstdio>
 #include <fstream>
+#include <thread>
+#include <chrono>
+
+#include <sqlite3.h>
 
 #include "kaa/log/SQLiteDBLogStorage.hpp"
 #include "kaa/log/LogRecord.hpp"
@@ -54,6 +58,60 @@ void removeDatabase(const std::string& dbFullPath)
     std::remove(dbFullPath.c_str());
 }
 
+static std::size_t countCommittedRecords(const std::string& dbName)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    std::size_t count = 0;
+
+    sqlite3_open(dbName.c_str(), &db);
+    if (SQLITE_OK == sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM KAA_LOGS;", -1, &stmt, nullptr) &&
+            SQLITE_ROW == sqlite3_step(stmt)) {
+        count = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    return count;
+}
+
+static std::string getJournalMode(const std::string& dbName)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    std::string journalMode;
+
+    sqlite3_open(dbName.c_str(), &db);
+    if (SQLITE_OK == sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, nullptr) &&
+            SQLITE_ROW == sqlite3_step(stmt)) {
+        journalMode = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    return journalMode;
+}
+
+static std::int64_t getPragmaValue(const std::string& dbName, const std::string& pragma)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    std::int64_t value = -1;
+
+    sqlite3_open(dbName.c_str(), &db);
+    if (SQLITE_OK == sqlite3_prepare_v2(db, ("PRAGMA " + pragma + ";").c_str(), -1, &stmt, nullptr) &&
+            SQLITE_ROW == sqlite3_step(stmt)) {
+        value = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    return value;
+}
+
 static LogRecord createSerializedLogRecord()
 {
     KaaUserLogRecord logRecord;
@@ -446,6 +504,358 @@ BOOST_AUTO_TEST_CASE(AddNewBucketAfterRestart)
     removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
 }
 
+BOOST_AUTO_TEST_CASE(GroupCommitByRecordCountTest)
+{
+    std::size_t groupCommitRecordCount = 5;
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                 groupCommitRecordCount);
+
+    for (std::size_t i = 0; i < groupCommitRecordCount - 1; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), groupCommitRecordCount - 1);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), (groupCommitRecordCount - 1) * sizeOfOneRecord);
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+
+    logStorage.addLogRecord(createSerializedLogRecord());
+
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), groupCommitRecordCount);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(GroupCommitByTimeoutTest)
+{
+    std::size_t recordCount = 3;
+    std::size_t groupCommitTimeoutMs = 100;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                 recordCount * 10,
+                                 groupCommitTimeoutMs);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * groupCommitTimeoutMs));
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), recordCount);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(GroupCommitOnGetNextBucketTest)
+{
+    std::size_t recordInBucket = 3;
+    std::size_t recordCount = recordInBucket * 2;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket,
+                                 recordCount * 10);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto bucket1 = logStorage.getNextBucket();
+    auto bucket2 = logStorage.getNextBucket();
+
+    BOOST_CHECK_EQUAL(bucket1.getRecords().size(), recordInBucket);
+    BOOST_CHECK_EQUAL(bucket2.getRecords().size(), recordInBucket);
+    BOOST_CHECK(bucket1.getBucketId() != bucket2.getBucketId());
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(GroupCommitOnDestructionTest)
+{
+    std::size_t recordCount = 4;
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        SQLiteDBLogStorage logStorage1(clientContext, testLogStorageName,
+                                     (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                     LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                     LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                     recordCount * 10);
+
+        for (std::size_t i = 0; i < recordCount; ++i) {
+            logStorage1.addLogRecord(createSerializedLogRecord());
+        }
+    }
+
+    SQLiteDBLogStorage logStorage2(clientContext, testLogStorageName);
+
+    BOOST_CHECK_EQUAL(logStorage2.getStatus().getRecordsCount(), recordCount);
+    BOOST_CHECK_EQUAL(logStorage2.getStatus().getConsumedVolume(), recordCount * sizeOfOneRecord);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(DurabilityProfilesTest)
+{
+    std::size_t recordCount = 5;
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+
+    const int profiles[] = { (int)SQLiteDurabilityProfile::SQLITE_FAST_PROFILE,
+                             (int)SQLiteDurabilityProfile::SQLITE_BALANCED_PROFILE,
+                             (int)SQLiteDurabilityProfile::SQLITE_DURABLE_PROFILE };
+
+    auto clientContext = getClientContext();
+
+    for (int profile : profiles) {
+        removeDatabase(testLogStorageName);
+
+        {
+            SQLiteDBLogStorage logStorage1(clientContext, testLogStorageName, profile);
+            for (std::size_t i = 0; i < recordCount; ++i) {
+                logStorage1.addLogRecord(createSerializedLogRecord());
+            }
+
+            if (profile & SQLiteOptimizationOptions::SQLITE_WAL_JOURNAL_MODE) {
+                BOOST_CHECK_EQUAL(getJournalMode(testLogStorageName), "wal");
+            }
+        }
+
+        SQLiteDBLogStorage logStorage2(clientContext, testLogStorageName, profile);
+
+        BOOST_CHECK_EQUAL(logStorage2.getStatus().getRecordsCount(), recordCount);
+        BOOST_CHECK_EQUAL(logStorage2.getStatus().getConsumedVolume(), recordCount * sizeOfOneRecord);
+        BOOST_CHECK_EQUAL(logStorage2.getNextBucket().getRecords().size(), recordCount);
+    }
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(VisitNextBucketTest)
+{
+    std::size_t recordInBucket = 3;
+    std::size_t recordCount = recordInBucket + 1;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    std::size_t visitedRecordCount = 0;
+    auto bucketInfo = logStorage.visitNextBucket([&visitedRecordCount] (const std::uint8_t *data, std::size_t size)
+            {
+                AvroByteArrayConverter<KaaUserLogRecord> decoder;
+                KaaUserLogRecord decodedLog;
+                decoder.fromByteArray(data, size, decodedLog);
+
+                BOOST_CHECK_EQUAL(decodedLog.logdata, testLogData);
+                ++visitedRecordCount;
+            });
+
+    BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), recordInBucket);
+    BOOST_CHECK_EQUAL(visitedRecordCount, recordInBucket);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount - recordInBucket);
+
+    auto bucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(bucket.getRecords().size(), recordCount - recordInBucket);
+    BOOST_CHECK(bucket.getBucketId() != bucketInfo.getBucketId());
+
+    BOOST_CHECK_EQUAL(logStorage.visitNextBucket([] (const std::uint8_t *, std::size_t) {}).getLogCount(), 0);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+static void deleteCommittedRecords(const std::string& dbName)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_open(dbName.c_str(), &db);
+    sqlite3_exec(db, "DELETE FROM KAA_LOGS;", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+}
+
+BOOST_AUTO_TEST_CASE(RollbackFromBucketCacheTest)
+{
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+    std::size_t recordInBucket = 3;
+    std::size_t recordCount = recordInBucket * 2;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto bucket1 = logStorage.getNextBucket();
+    logStorage.rollbackBucket(bucket1.getBucketId());
+
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), recordCount * sizeOfOneRecord);
+
+    // The retried bucket doesn't come from the database
+    deleteCommittedRecords(testLogStorageName);
+
+    auto retriedBucket1 = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(retriedBucket1.getBucketId(), bucket1.getBucketId());
+    BOOST_CHECK_EQUAL(retriedBucket1.getRecords().size(), recordInBucket);
+    BOOST_CHECK(retriedBucket1.getRecords().front().getData() == bucket1.getRecords().front().getData());
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount - recordInBucket);
+
+    logStorage.removeBucket(retriedBucket1.getBucketId());
+
+    // The next bucket isn't cached, so it is read from the database
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getRecords().size(), 0);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(RollbackWithDisabledBucketCacheTest)
+{
+    std::size_t recordInBucket = 3;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket);
+    logStorage.setBucketCacheSize(0);
+
+    for (std::size_t i = 0; i < recordInBucket; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto bucket = logStorage.getNextBucket();
+    logStorage.rollbackBucket(bucket.getBucketId());
+
+    auto retriedBucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(retriedBucket.getBucketId(), bucket.getBucketId());
+    BOOST_CHECK_EQUAL(retriedBucket.getRecords().size(), recordInBucket);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalVacuumTest)
+{
+    std::size_t recordInBucket = 100;
+    std::size_t recordCount = recordInBucket * 20;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        // A database created without the incremental auto vacuum
+        sqlite3 *db = nullptr;
+        sqlite3_open(testLogStorageName.c_str(), &db);
+        sqlite3_exec(db, "CREATE TABLE LEGACY (DATA BLOB);", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+    }
+    BOOST_CHECK_EQUAL(getPragmaValue(testLogStorageName, "auto_vacuum"), 0);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket);
+    BOOST_CHECK_EQUAL(getPragmaValue(testLogStorageName, "auto_vacuum"), 2);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto pageCount = getPragmaValue(testLogStorageName, "page_count");
+
+    for (std::size_t i = 0; i < recordCount / recordInBucket; ++i) {
+        logStorage.removeBucket(logStorage.getNextBucket().getBucketId());
+    }
+
+    BOOST_CHECK_LT(getPragmaValue(testLogStorageName, "page_count"), pageCount);
+    BOOST_CHECK_EQUAL(getPragmaValue(testLogStorageName, "freelist_count"), 0);
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
+BOOST_AUTO_TEST_CASE(DiskQuotaTest)
+{
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+    std::size_t recordInBucket = 100;
+    std::size_t recordCount = recordInBucket * 20;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                 (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                 LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                 recordInBucket);
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto uploadedBucket = logStorage.getNextBucket();
+
+    auto pageSize = getPragmaValue(testLogStorageName, "page_size");
+    std::size_t quota = getPragmaValue(testLogStorageName, "page_count") * pageSize / 2;
+    logStorage.setDiskQuota(quota);
+
+    // Whole buckets are dropped, the oldest first
+    std::size_t recordsLeft = logStorage.getStatus().getRecordsCount();
+    BOOST_CHECK_LT(recordsLeft, recordCount - recordInBucket);
+    BOOST_CHECK_EQUAL(recordsLeft % recordInBucket, 0);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), recordsLeft * sizeOfOneRecord);
+    BOOST_CHECK_LE(static_cast<std::size_t>(getPragmaValue(testLogStorageName, "page_count") * pageSize), quota);
+
+    // The quota is kept as records are added
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+    BOOST_CHECK_LE(static_cast<std::size_t>(getPragmaValue(testLogStorageName, "page_count") * pageSize),
+                   quota + LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE + pageSize);
+
+    // The bucket taken for the upload isn't dropped
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName),
+                      logStorage.getStatus().getRecordsCount() + uploadedBucket.getRecords().size());
+    logStorage.removeBucket(uploadedBucket.getBucketId());
+
+    removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
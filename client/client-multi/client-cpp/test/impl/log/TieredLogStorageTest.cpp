@@ -0,0 +1,194 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <memory>
+
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/log/TieredLogStorage.hpp"
+#include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static LogRecord createLogRecord()
+{
+    KaaUserLogRecord record;
+    record.logdata = "test data";
+    return LogRecord(record);
+}
+
+/*
+ * Tiers put each record into a bucket of its own.
+ */
+static std::shared_ptr<MemoryLogStorage> createTier()
+{
+    const std::size_t BUCKET_RECORD_COUNT = 1;
+    return std::make_shared<MemoryLogStorage>(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                              BUCKET_RECORD_COUNT);
+}
+
+/*
+ * The watermark which the memory tier reaches with the given number of records.
+ */
+static std::size_t getWatermark(std::size_t recordCount)
+{
+    auto tier = createTier();
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        tier->addLogRecord(createLogRecord());
+    }
+
+    return tier->getMemoryUsage();
+}
+
+BOOST_AUTO_TEST_SUITE(TieredLogStorageTestSuite)
+
+BOOST_AUTO_TEST_CASE(BadInitializationParamsTest)
+{
+    auto tier = createTier();
+
+    BOOST_CHECK_THROW(TieredLogStorage(clientContext, ILogStoragePtr(), 1), KaaException);
+    BOOST_CHECK_THROW(TieredLogStorage(clientContext, tier, 0), KaaException);
+    BOOST_CHECK_THROW(TieredLogStorage(clientContext, ILogStoragePtr(), tier, 1), KaaException);
+    BOOST_CHECK_THROW(TieredLogStorage(clientContext, tier, tier, 1), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(RecordsSpillOverWatermarkTest)
+{
+    const std::size_t MEMORY_RECORD_COUNT = 2;
+    const std::size_t DISK_RECORD_COUNT = 3;
+
+    TieredLogStorage logStorage(clientContext, createTier(), createTier(), getWatermark(MEMORY_RECORD_COUNT));
+
+    std::set<std::int32_t> bucketIds;
+    for (std::size_t i = 0; i < MEMORY_RECORD_COUNT + DISK_RECORD_COUNT; ++i) {
+        bucketIds.insert(logStorage.addLogRecord(createLogRecord()).getBucketId());
+        BOOST_CHECK_EQUAL(logStorage.isSpilling(), i >= MEMORY_RECORD_COUNT);
+    }
+
+    BOOST_CHECK(logStorage.isSpilling());
+    BOOST_CHECK_EQUAL(bucketIds.size(), MEMORY_RECORD_COUNT + DISK_RECORD_COUNT);
+
+    BOOST_CHECK_EQUAL(logStorage.getMemoryTierStatus().getRecordsCount(), MEMORY_RECORD_COUNT);
+    BOOST_CHECK_EQUAL(logStorage.getDiskTierStatus().getRecordsCount(), DISK_RECORD_COUNT);
+    BOOST_CHECK_EQUAL(logStorage.getRecordsCount(), MEMORY_RECORD_COUNT + DISK_RECORD_COUNT);
+    BOOST_CHECK_EQUAL(logStorage.getConsumedVolume(), logStorage.getMemoryTierStatus().getConsumedVolume() +
+                                                      logStorage.getDiskTierStatus().getConsumedVolume());
+}
+
+BOOST_AUTO_TEST_CASE(MemoryTierIsUploadedFirstTest)
+{
+    const std::size_t MEMORY_RECORD_COUNT = 2;
+    const std::size_t DISK_RECORD_COUNT = 2;
+
+    TieredLogStorage logStorage(clientContext, createTier(), createTier(), getWatermark(MEMORY_RECORD_COUNT));
+
+    std::set<std::int32_t> addedBucketIds;
+    for (std::size_t i = 0; i < MEMORY_RECORD_COUNT + DISK_RECORD_COUNT; ++i) {
+        addedBucketIds.insert(logStorage.addLogRecord(createLogRecord()).getBucketId());
+    }
+
+    for (std::size_t i = 0; i < MEMORY_RECORD_COUNT + DISK_RECORD_COUNT; ++i) {
+        auto bucket = logStorage.getNextBucket();
+        BOOST_REQUIRE_EQUAL(bucket.getRecords().size(), 1);
+        BOOST_CHECK(addedBucketIds.count(bucket.getBucketId()));
+
+        const std::size_t expectedMemoryRecordCount = i < MEMORY_RECORD_COUNT ? MEMORY_RECORD_COUNT - i - 1 : 0;
+        const std::size_t expectedDiskRecordCount =
+                i < MEMORY_RECORD_COUNT ? DISK_RECORD_COUNT : MEMORY_RECORD_COUNT + DISK_RECORD_COUNT - i - 1;
+
+        BOOST_CHECK_EQUAL(logStorage.getMemoryTierStatus().getRecordsCount(), expectedMemoryRecordCount);
+        BOOST_CHECK_EQUAL(logStorage.getDiskTierStatus().getRecordsCount(), expectedDiskRecordCount);
+    }
+
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getRecords().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SpillingStopsAfterDiskTierIsDrainedTest)
+{
+    auto memoryTier = createTier();
+    auto diskTier = createTier();
+    TieredLogStorage logStorage(clientContext, memoryTier, diskTier, getWatermark(1));
+
+    auto memoryBucketId = logStorage.addLogRecord(createLogRecord()).getBucketId();
+    auto diskBucketId = logStorage.addLogRecord(createLogRecord()).getBucketId();
+
+    /*
+     * The memory tier is drained, but the disk one is not, so records still spill.
+     */
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getBucketId(), memoryBucketId);
+    logStorage.removeBucket(memoryBucketId);
+
+    logStorage.addLogRecord(createLogRecord());
+    BOOST_CHECK(logStorage.isSpilling());
+    BOOST_CHECK_EQUAL(diskTier->getRecordsCount(), 2);
+
+    BOOST_CHECK_EQUAL(logStorage.getNextBucket().getBucketId(), diskBucketId);
+    logStorage.removeBucket(diskBucketId);
+
+    BOOST_CHECK(logStorage.isSpilling());
+
+    auto lastDiskBucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(lastDiskBucket.getRecords().size(), 1);
+
+    /*
+     * A rolled back bucket is uploaded again from its tier.
+     */
+    logStorage.rollbackBucket(lastDiskBucket.getBucketId());
+    BOOST_CHECK_EQUAL(diskTier->getRecordsCount(), 1);
+
+    lastDiskBucket = logStorage.getNextBucket();
+    logStorage.removeBucket(lastDiskBucket.getBucketId());
+    BOOST_CHECK(!logStorage.isSpilling());
+
+    logStorage.addLogRecord(createLogRecord());
+    BOOST_CHECK_EQUAL(memoryTier->getRecordsCount(), 1);
+    BOOST_CHECK_EQUAL(diskTier->getRecordsCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ReleaseMemoryStartsSpillingTest)
+{
+    auto memoryTier = createTier();
+    TieredLogStorage logStorage(clientContext, memoryTier, createTier(), getWatermark(10));
+
+    logStorage.addLogRecord(createLogRecord());
+    auto memoryUsage = logStorage.getMemoryUsage();
+
+    BOOST_CHECK(logStorage.releaseMemory(0));
+    BOOST_CHECK(logStorage.isSpilling());
+
+    logStorage.addLogRecord(createLogRecord());
+    BOOST_CHECK_EQUAL(memoryTier->getMemoryUsage(), memoryUsage);
+    BOOST_CHECK_EQUAL(logStorage.getDiskTierStatus().getRecordsCount(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
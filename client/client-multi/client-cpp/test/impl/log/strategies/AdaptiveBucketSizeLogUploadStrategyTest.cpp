@@ -0,0 +1,184 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+#include "kaa/log/strategies/AdaptiveBucketSizeLogUploadStrategy.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+#include "headers/log/MockLogStorage.hpp"
+#include "headers/log/MockLogFailoverCommand.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static MockExecutorContext tmpExecContext;
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::size_t MAX_BUCKET_SIZE = 16 * 1024;
+static const std::size_t MAX_BUCKET_RECORD_COUNT = 256;
+static const std::size_t MIN_BUCKET_SIZE = 1024;
+static const std::size_t TARGET_DELIVERY_TIME_MS = 1000;
+
+static std::shared_ptr<MockLogStorage> createStorage()
+{
+    return std::make_shared<MockLogStorage>();
+}
+
+BOOST_AUTO_TEST_SUITE(AdaptiveBucketSizeLogUploadStrategySuite)
+
+BOOST_AUTO_TEST_CASE(BadInitializationParamsTest)
+{
+    BOOST_CHECK_THROW(AdaptiveBucketSizeLogUploadStrategy(ILogStoragePtr(), clientContext), KaaException);
+    BOOST_CHECK_THROW(AdaptiveBucketSizeLogUploadStrategy(createStorage(), clientContext,
+                                                          MIN_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MAX_BUCKET_SIZE),
+                      KaaException);
+    BOOST_CHECK_THROW(AdaptiveBucketSizeLogUploadStrategy(createStorage(), clientContext,
+                                                          MAX_BUCKET_SIZE, 0, MIN_BUCKET_SIZE),
+                      KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(SlowDeliveryShrinksBucketTest)
+{
+    auto storage = createStorage();
+    AdaptiveBucketSizeLogUploadStrategy strategy(storage, clientContext,
+                                                 MAX_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MIN_BUCKET_SIZE);
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+
+    strategy.onSuccess(BucketInfo(1, 1), TARGET_DELIVERY_TIME_MS + 1);
+
+    BOOST_CHECK_EQUAL(storage->onSetBucketLimits_, 1);
+    BOOST_CHECK_EQUAL(storage->bucketSize_, MAX_BUCKET_SIZE / 2);
+    BOOST_CHECK_EQUAL(storage->bucketRecordCount_, MAX_BUCKET_RECORD_COUNT / 2);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 2);
+    BOOST_CHECK_EQUAL(strategy.getBucketRecordCount(), MAX_BUCKET_RECORD_COUNT / 2);
+
+    /*
+     * In-target delivery changes nothing.
+     */
+    strategy.onSuccess(BucketInfo(2, 1), TARGET_DELIVERY_TIME_MS);
+    BOOST_CHECK_EQUAL(storage->onSetBucketLimits_, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BucketSizeNotBelowMinTest)
+{
+    auto storage = createStorage();
+    AdaptiveBucketSizeLogUploadStrategy strategy(storage, clientContext,
+                                                 MAX_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MIN_BUCKET_SIZE);
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+
+    for (std::int32_t i = 0; i < 10; ++i) {
+        strategy.onSuccess(BucketInfo(i, 1), TARGET_DELIVERY_TIME_MS * 2);
+    }
+
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MIN_BUCKET_SIZE);
+    BOOST_CHECK_EQUAL(strategy.getBucketRecordCount(), MAX_BUCKET_RECORD_COUNT * MIN_BUCKET_SIZE / MAX_BUCKET_SIZE);
+    BOOST_CHECK_EQUAL(storage->bucketSize_, MIN_BUCKET_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(FastDeliveryGrowsBucketUpToMaxTest)
+{
+    auto storage = createStorage();
+    AdaptiveBucketSizeLogUploadStrategy strategy(storage, clientContext,
+                                                 MAX_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MIN_BUCKET_SIZE);
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+
+    strategy.onSuccess(BucketInfo(1, 1), TARGET_DELIVERY_TIME_MS * 2);
+    strategy.onSuccess(BucketInfo(2, 1), TARGET_DELIVERY_TIME_MS * 2);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 4);
+
+    strategy.onSuccess(BucketInfo(3, 1), TARGET_DELIVERY_TIME_MS / 4);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 4 + MAX_BUCKET_SIZE / 8);
+
+    for (std::int32_t i = 4; i < 20; ++i) {
+        strategy.onSuccess(BucketInfo(i, 1), TARGET_DELIVERY_TIME_MS / 4);
+    }
+
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE);
+    BOOST_CHECK_EQUAL(strategy.getBucketRecordCount(), MAX_BUCKET_RECORD_COUNT);
+    BOOST_CHECK_EQUAL(storage->bucketSize_, MAX_BUCKET_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(FailureShrinksBucketAndBlocksGrowthTest)
+{
+    auto storage = createStorage();
+    MockLogFailoverCommand controller;
+    AdaptiveBucketSizeLogUploadStrategy strategy(storage, clientContext,
+                                                 MAX_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MIN_BUCKET_SIZE);
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+
+    strategy.onFailure(controller, LogDeliveryErrorCode::REMOTE_CONNECTION_ERROR);
+    BOOST_CHECK_EQUAL(controller.onRetryLogUploadWithDelay_, 1);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 2);
+
+    strategy.onTimeout(controller);
+    BOOST_CHECK_EQUAL(controller.onSwitchAccessPoint_, 1);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 4);
+    BOOST_CHECK(strategy.getFailureRate() > AdaptiveBucketSizeLogUploadStrategy::MAX_FAILURE_RATE_TO_GROW);
+
+    /*
+     * The failure rate is too high to grow, although the delivery is fast.
+     */
+    strategy.onSuccess(BucketInfo(1, 1), TARGET_DELIVERY_TIME_MS / 4);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE / 4);
+
+    for (std::int32_t i = 2; i < 10; ++i) {
+        strategy.onSuccess(BucketInfo(i, 1), TARGET_DELIVERY_TIME_MS / 4);
+    }
+
+    BOOST_CHECK(strategy.getFailureRate() < AdaptiveBucketSizeLogUploadStrategy::MAX_FAILURE_RATE_TO_GROW);
+    BOOST_CHECK(strategy.getBucketSize() > MAX_BUCKET_SIZE / 4);
+}
+
+BOOST_AUTO_TEST_CASE(UnsupportedStorageTest)
+{
+    auto storage = createStorage();
+    storage->isBucketLimitsSupported_ = false;
+
+    AdaptiveBucketSizeLogUploadStrategy strategy(storage, clientContext,
+                                                 MAX_BUCKET_SIZE, MAX_BUCKET_RECORD_COUNT, MIN_BUCKET_SIZE);
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+
+    strategy.onSuccess(BucketInfo(1, 1), TARGET_DELIVERY_TIME_MS * 2);
+
+    BOOST_CHECK_EQUAL(storage->onSetBucketLimits_, 1);
+    BOOST_CHECK_EQUAL(strategy.getBucketSize(), MAX_BUCKET_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(DefaultTargetDeliveryTimeTest)
+{
+    AdaptiveBucketSizeLogUploadStrategy strategy(createStorage(), clientContext);
+
+    strategy.setUploadTimeout(8);
+    BOOST_CHECK_EQUAL(strategy.getTargetDeliveryTime(), 2000);
+
+    strategy.setTargetDeliveryTime(TARGET_DELIVERY_TIME_MS);
+    BOOST_CHECK_EQUAL(strategy.getTargetDeliveryTime(), TARGET_DELIVERY_TIME_MS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -75,6 +75,12 @@ BOOST_AUTO_TEST_CASE(CheckAfterSomeTime)
     BOOST_CHECK(strategy.isUploadNeeded(storageStatus) == LogUploadStrategyDecision::UPLOAD);
 }
 
+BOOST_AUTO_TEST_CASE(TimeDependentTest)
+{
+    PeriodicLogUploadStrategy strategy(1, clientContext);
+    BOOST_CHECK(strategy.isTimeDependent());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <condition_variable>
+
+#include "kaa/logging/AsyncLogger.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+class CapturingLogger : public ILogger {
+public:
+    virtual void log(LogLevel level, const char *message) const
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        onBlocked_.wait(lock, [this] { return !isBlocked_; });
+        messages_.emplace_back(message);
+        levels_.push_back(level);
+    }
+
+    void setBlocked(bool isBlocked)
+    {
+        {
+            std::lock_guard<std::mutex> lock(guard_);
+            isBlocked_ = isBlocked;
+        }
+        onBlocked_.notify_all();
+    }
+
+    virtual bool isEnabled(LogLevel level) const { return level >= LogLevel::KAA_INFO; }
+
+    mutable std::vector<std::string>    messages_;
+    mutable std::vector<LogLevel>       levels_;
+
+private:
+    mutable std::mutex                 guard_;
+    mutable std::condition_variable    onBlocked_;
+    bool                               isBlocked_ = false;
+};
+
+BOOST_AUTO_TEST_SUITE(AsyncLoggerSuite)
+
+BOOST_AUTO_TEST_CASE(BadParametersTest)
+{
+    BOOST_CHECK_THROW(AsyncLogger(nullptr), KaaException);
+    BOOST_CHECK_THROW(AsyncLogger(std::make_shared<CapturingLogger>(), 0), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(MessagesAreWrittenInOrderTest)
+{
+    auto capturingLogger = std::make_shared<CapturingLogger>();
+    AsyncLogger logger(capturingLogger);
+
+    const std::size_t messageCount = 100;
+    for (std::size_t i = 0; i < messageCount; ++i) {
+        logger.log(LogLevel::KAA_DEBUG, std::to_string(i).c_str());
+    }
+
+    logger.flush();
+
+    BOOST_REQUIRE_EQUAL(capturingLogger->messages_.size(), messageCount);
+    for (std::size_t i = 0; i < messageCount; ++i) {
+        BOOST_CHECK_EQUAL(capturingLogger->messages_[i], std::to_string(i));
+    }
+    BOOST_CHECK_EQUAL(logger.getDroppedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(QueuedMessagesAreWrittenOnDestructionTest)
+{
+    auto capturingLogger = std::make_shared<CapturingLogger>();
+
+    {
+        AsyncLogger logger(capturingLogger);
+        logger.log(LogLevel::KAA_INFO, "first");
+        logger.log(LogLevel::KAA_INFO, "second");
+    }
+
+    BOOST_REQUIRE_EQUAL(capturingLogger->messages_.size(), 2);
+    BOOST_CHECK_EQUAL(capturingLogger->messages_[1], "second");
+}
+
+BOOST_AUTO_TEST_CASE(OnlyLowLevelMessagesAreDroppedTest)
+{
+    auto capturingLogger = std::make_shared<CapturingLogger>();
+    AsyncLogger logger(capturingLogger, 2);
+
+    capturingLogger->setBlocked(true);
+
+    logger.log(LogLevel::KAA_DEBUG, "kept1");
+    logger.log(LogLevel::KAA_DEBUG, "kept2");
+    logger.log(LogLevel::KAA_DEBUG, "dropped");
+    logger.log(LogLevel::KAA_ERROR, "error");
+
+    capturingLogger->setBlocked(false);
+    logger.flush();
+
+    BOOST_CHECK_EQUAL(logger.getDroppedCount(), 1);
+    BOOST_REQUIRE_EQUAL(capturingLogger->messages_.size(), 3);
+    BOOST_CHECK_EQUAL(capturingLogger->messages_[2], "error");
+    BOOST_CHECK(capturingLogger->levels_[2] == LogLevel::KAA_ERROR);
+}
+
+BOOST_AUTO_TEST_CASE(EnabledLevelsOfWrappedLoggerTest)
+{
+    AsyncLogger logger(std::make_shared<CapturingLogger>());
+
+    BOOST_CHECK(!logger.isEnabled(LogLevel::KAA_DEBUG));
+    BOOST_CHECK(logger.isEnabled(LogLevel::KAA_INFO));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
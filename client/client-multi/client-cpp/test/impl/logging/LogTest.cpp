@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "kaa/logging/Log.hpp"
+
+namespace kaa {
+
+class LevelFilteringLogger : public ILogger {
+public:
+    explicit LevelFilteringLogger(LogLevel level) : level_(level) {}
+
+    virtual void log(LogLevel level, const char *message) const
+    {
+        messages_.emplace_back(message);
+    }
+
+    virtual bool isEnabled(LogLevel level) const { return level >= level_; }
+
+    mutable std::vector<std::string> messages_;
+
+private:
+    LogLevel level_;
+};
+
+struct TestLogContext {
+    explicit TestLogContext(LogLevel level) : logger_(level) {}
+
+    ILogger& getLogger() { return logger_; }
+
+    LevelFilteringLogger logger_;
+};
+
+static std::string makeMessage(std::size_t& evaluationCount)
+{
+    ++evaluationCount;
+    return "message";
+}
+
+BOOST_AUTO_TEST_SUITE(LogSuite)
+
+BOOST_AUTO_TEST_CASE(DisabledLevelMessageIsNotEvaluatedTest)
+{
+    TestLogContext context_(LogLevel::KAA_WARNING);
+    std::size_t evaluationCount = 0;
+
+    KAA_LOG_DEBUG(makeMessage(evaluationCount));
+    KAA_LOG_INFO(boost::format("%1%") % makeMessage(evaluationCount));
+
+    BOOST_CHECK_EQUAL(evaluationCount, 0);
+    BOOST_CHECK(context_.logger_.messages_.empty());
+
+    KAA_LOG_ERROR(makeMessage(evaluationCount));
+
+    BOOST_CHECK_EQUAL(evaluationCount, 1);
+    BOOST_REQUIRE_EQUAL(context_.logger_.messages_.size(), 1);
+    BOOST_CHECK(context_.logger_.messages_[0].find("message") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
@@ -22,6 +22,8 @@
 #include <memory>
 #include <utility>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "kaa/ClientStatus.hpp"
 #include "kaa/notification/NotificationTransport.hpp"
@@ -37,6 +39,7 @@
 #include "headers/MockKaaClientStateStorage.hpp"
 #include "headers/channel/MockChannelManager.hpp"
 #include "headers/notification/MockNotificationListener.hpp"
+#include "headers/notification/MockRawNotificationListener.hpp"
 #include "headers/notification/MockNotificationTopicListListener.hpp"
 #include "headers/context/MockExecutorContext.hpp"
 
@@ -369,6 +372,62 @@ BOOST_AUTO_TEST_CASE(AddRemoveTopicSpecificNotificationListenerTest)
     BOOST_CHECK_EQUAL(topicSpecificNotificationListener.onNotification_, topic2NotificationCount1);
 }
 
+BOOST_AUTO_TEST_CASE(RawNotificationListenerTest)
+{
+    IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
+    SimpleExecutorContext executorContext;
+    executorContext.init();
+    KaaClientContext clientContext(properties, tmp_logger, executorContext, status);
+    NotificationManager notificationManager(clientContext);
+
+    auto topics = createTopics(2);
+    notificationManager.topicsListUpdated(topics);
+
+    MockRawNotificationListener globalRawListener;
+    MockRawNotificationListener topicSpecificRawListener(true);
+    MockNotificationListener globalListener;
+
+    notificationManager.addRawNotificationListener(globalRawListener);
+    notificationManager.addRawNotificationListener(topics[1].id, topicSpecificRawListener);
+
+    std::size_t notificationCount = 1 + rand() % 10;
+    auto topic1Notifications = createNotifications(notificationCount, topics[0].id);
+    auto topic2Notifications = createNotifications(notificationCount, topics[1].id);
+
+    std::size_t topic1Bytes = 0;
+    for (const auto& notification : topic1Notifications) {
+        topic1Bytes += notification.body.size();
+    }
+
+    notificationManager.notificationReceived(topic1Notifications);
+    notificationManager.notificationReceived(topic2Notifications);
+    testSleep(1);
+
+    /*
+     * Nobody asks for fields of the first topic's notifications, so they are never decoded.
+     */
+    BOOST_CHECK_EQUAL(globalRawListener.onRawNotification_, notificationCount);
+    BOOST_CHECK_EQUAL(globalRawListener.bytesReceived_, topic1Bytes);
+    BOOST_CHECK_EQUAL(globalRawListener.decodedNotifications_, 0);
+    BOOST_CHECK_EQUAL(topicSpecificRawListener.onRawNotification_, notificationCount);
+    BOOST_CHECK_EQUAL(topicSpecificRawListener.decodedNotifications_, notificationCount);
+
+    notificationManager.addNotificationListener(globalListener);
+    notificationManager.removeRawNotificationListener(topics[1].id, topicSpecificRawListener);
+
+    notificationManager.notificationReceived(topic2Notifications);
+    testSleep(1);
+
+    BOOST_CHECK_EQUAL(globalRawListener.onRawNotification_, 2 * notificationCount);
+    BOOST_CHECK_EQUAL(globalListener.onNotification_, notificationCount);
+    BOOST_CHECK_EQUAL(topicSpecificRawListener.onRawNotification_, notificationCount);
+
+    BOOST_CHECK_THROW(notificationManager.addRawNotificationListener(UNKNOWNTOPIC, topicSpecificRawListener)
+                    , UnavailableTopicException);
+
+    executorContext.stop();
+}
+
 BOOST_AUTO_TEST_CASE(SubscribeToUnknownTopicTest)
 {
     IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
@@ -485,6 +544,79 @@ BOOST_AUTO_TEST_CASE(SubscribeToOptionalTopicTest)
     BOOST_CHECK_NO_THROW(notificationManager.subscribeToTopic(topics.front().id));
 }
 
+class BlockingNotificationListener : public INotificationListener {
+public:
+    virtual void onNotification(const std::int64_t topicId, const KaaNotification& notification)
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        ++onNotification_;
+        onReleased_.wait(lock, [this] { return isReleased_; });
+    }
+
+    void release()
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        isReleased_ = true;
+        onReleased_.notify_all();
+    }
+
+    std::size_t getNotificationCount()
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        return onNotification_;
+    }
+
+private:
+    std::mutex                 guard_;
+    std::condition_variable    onReleased_;
+    bool                       isReleased_ = false;
+    std::size_t                onNotification_ = 0;
+};
+
+BOOST_AUTO_TEST_CASE(SlowTopicListenerTest)
+{
+    IKaaClientStateStoragePtr status(new MockKaaClientStateStorage);
+    SimpleExecutorContext executorContext(1, 1, 2);
+    executorContext.init();
+    KaaClientContext clientContext(properties, tmp_logger, executorContext, status);
+    NotificationManager notificationManager(clientContext);
+
+    auto topics = createTopics(2);
+    notificationManager.topicsListUpdated(topics);
+
+    BlockingNotificationListener slowListener;
+    MockNotificationListener fastListener;
+    notificationManager.addNotificationListener(topics[0].id, slowListener);
+    notificationManager.addNotificationListener(topics[1].id, fastListener);
+
+    const std::size_t slowTopicNotificationCount = 3;
+    const std::size_t fastTopicNotificationCount = 5;
+
+    Notifications notifications;
+    for (std::size_t i = 0; i < fastTopicNotificationCount; ++i) {
+        if (i < slowTopicNotificationCount) {
+            notifications.push_back(createNotification(topics[0].id));
+        }
+        notifications.push_back(createNotification(topics[1].id));
+    }
+
+    notificationManager.notificationReceived(notifications);
+    testSleep(1);
+
+    /*
+     * The slow listener holds back only the notifications of its topic.
+     */
+    BOOST_CHECK_EQUAL(slowListener.getNotificationCount(), 1);
+    BOOST_CHECK_EQUAL(fastListener.onNotification_, fastTopicNotificationCount);
+
+    slowListener.release();
+    testSleep(1);
+
+    BOOST_CHECK_EQUAL(slowListener.getNotificationCount(), slowTopicNotificationCount);
+
+    executorContext.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -16,6 +16,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cstdio>
+
 #include "kaa/ClientStatus.hpp"
 #include "kaa/notification/NotificationTransport.hpp"
 #include "kaa/KaaClientContext.hpp"
@@ -34,11 +36,48 @@ static SimpleExecutorContext context;
 static MockKaaClientStateStorage tmp_state;
 //static KaaClientContext clientContext(properties, tmp_logger, tmp_state, context);
 
+class TopicListCounter : public INotificationProcessor {
+public:
+    virtual void topicsListUpdated(const Topics& topics) { ++topicListUpdateCount_; }
+    virtual void notificationReceived(const Notifications& notifications) {}
+
+    std::size_t topicListUpdateCount_ = 0;
+};
+
+class NotificationCollector : public INotificationProcessor {
+public:
+    virtual void topicsListUpdated(const Topics& topics) {}
+    virtual void notificationReceived(const Notifications& notifications)
+    {
+        received_.insert(received_.end(), notifications.begin(), notifications.end());
+    }
+
+    Notifications received_;
+};
+
+static const char * const STATE_FILE_NAME = "fakePath";
+
+/* Received notifications are persisted, so start each test with the default state. */
+static void removeStateFile()
+{
+    std::remove(STATE_FILE_NAME);
+}
+
+static Notification createMulticastNotification(std::int64_t topicId, std::int32_t seqNumber)
+{
+    Notification notification;
+    notification.topicId = topicId;
+    notification.seqNumber.set_int(seqNumber);
+    notification.uid.set_null();
+    return notification;
+}
+
 BOOST_AUTO_TEST_SUITE(NotificationTransportTestSuite)
 
 BOOST_AUTO_TEST_CASE(EmptyRequestTest)
 {
-    properties.setStateFileName("fakePath");
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
     KaaClientContext clientContext(properties, tmp_logger, context);
     IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
     clientContext.setStatus(status);
@@ -54,7 +93,8 @@ BOOST_AUTO_TEST_CASE(EmptyRequestTest)
 
 BOOST_AUTO_TEST_CASE(SubscriptionInfoTest)
 {
-    properties.setStateFileName("fakePath");
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
     KaaClientContext clientContext(properties, tmp_logger, context);
     IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
     clientContext.setStatus(status);
@@ -102,7 +142,8 @@ BOOST_AUTO_TEST_CASE(SubscriptionInfoTest)
 
 BOOST_AUTO_TEST_CASE(AcceptedUnicastNotificationsTest)
 {
-    properties.setStateFileName("fakePath");
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
     KaaClientContext clientContext(properties, tmp_logger, context);
     IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
     clientContext.setStatus(status);
@@ -142,7 +183,8 @@ BOOST_AUTO_TEST_CASE(AcceptedUnicastNotificationsTest)
 
 BOOST_AUTO_TEST_CASE(DetailedTopicStateTest)
 {
-    properties.setStateFileName("fakePath");
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
     KaaClientContext clientContext(properties, tmp_logger, context);
     IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
     clientContext.setStatus(status);
@@ -227,6 +269,154 @@ BOOST_AUTO_TEST_CASE(DetailedTopicStateTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(UnchangedTopicListTest)
+{
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
+    KaaClientContext clientContext(properties, tmp_logger, context);
+    IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
+    clientContext.setStatus(status);
+    MockChannelManager channelManager;
+    NotificationTransport transport(channelManager, clientContext);
+
+    TopicListCounter processor;
+    transport.setNotificationProcessor(&processor);
+
+    Topic topic1;
+    topic1.id = 1;
+    topic1.subscriptionType = OPTIONAL_SUBSCRIPTION;
+
+    Topic topic2;
+    topic2.id = 2;
+    topic2.subscriptionType = MANDATORY_SUBSCRIPTION;
+
+    NotificationSyncResponse response;
+    response.responseStatus = SyncResponseStatus::DELTA;
+    response.availableTopics.set_array(std::vector<Topic>({topic1, topic2}));
+    transport.onNotificationResponse(response);
+
+    auto topicListHash = status->getTopicListHash();
+    BOOST_CHECK_EQUAL(processor.topicListUpdateCount_, 1);
+    BOOST_CHECK_EQUAL(transport.createNotificationRequest()->topicListHash, topicListHash);
+
+    /* The same topics in another order */
+    response.availableTopics.set_array(std::vector<Topic>({topic2, topic1}));
+    transport.onNotificationResponse(response);
+
+    BOOST_CHECK_EQUAL(processor.topicListUpdateCount_, 1);
+    BOOST_CHECK_EQUAL(status->getTopicListHash(), topicListHash);
+
+    response.availableTopics.set_array(std::vector<Topic>({topic1}));
+    transport.onNotificationResponse(response);
+
+    BOOST_CHECK_EQUAL(processor.topicListUpdateCount_, 2);
+    BOOST_CHECK(status->getTopicListHash() != topicListHash);
+    BOOST_CHECK_EQUAL(status->getTopicList().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateMulticastNotificationsTest)
+{
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
+    KaaClientContext clientContext(properties, tmp_logger, context);
+    IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
+    clientContext.setStatus(status);
+    MockChannelManager channelManager;
+    NotificationTransport transport(channelManager, clientContext);
+
+    NotificationCollector processor;
+    transport.setNotificationProcessor(&processor);
+
+    const std::int64_t topicId = 1;
+
+    NotificationSyncResponse response;
+    response.notifications.set_array(std::vector<Notification>({createMulticastNotification(topicId, 3)}));
+    transport.onNotificationResponse(response);
+
+    BOOST_CHECK_EQUAL(processor.received_.size(), 1);
+    BOOST_CHECK_EQUAL(status->getTopicStates()[topicId], 3);
+
+    /* 1 and 2 are late, but weren't received yet. */
+    response.notifications.set_array(std::vector<Notification>({createMulticastNotification(topicId, 3),
+                                                                createMulticastNotification(topicId, 1),
+                                                                createMulticastNotification(topicId, 2),
+                                                                createMulticastNotification(topicId, 1)}));
+    transport.onNotificationResponse(response);
+
+    BOOST_REQUIRE_EQUAL(processor.received_.size(), 3);
+    BOOST_CHECK_EQUAL(processor.received_[1].seqNumber.get_int(), 1);
+    BOOST_CHECK_EQUAL(processor.received_[2].seqNumber.get_int(), 2);
+    BOOST_CHECK_EQUAL(status->getTopicStates()[topicId], 3);
+
+    /* Too old to be told from the received ones. */
+    response.notifications.set_array(std::vector<Notification>({createMulticastNotification(topicId, 100)}));
+    transport.onNotificationResponse(response);
+    response.notifications.set_array(std::vector<Notification>({createMulticastNotification(topicId, 4)}));
+    transport.onNotificationResponse(response);
+
+    BOOST_CHECK_EQUAL(processor.received_.size(), 4);
+
+    /* Received notifications are known after a restart. */
+    IKaaClientStateStoragePtr restoredStatus(new ClientStatus(clientContext));
+    clientContext.setStatus(restoredStatus);
+    NotificationTransport restoredTransport(channelManager, clientContext);
+    restoredTransport.setNotificationProcessor(&processor);
+
+    response.notifications.set_array(std::vector<Notification>({createMulticastNotification(topicId, 99),
+                                                                createMulticastNotification(topicId, 100),
+                                                                createMulticastNotification(topicId, 98)}));
+    restoredTransport.onNotificationResponse(response);
+
+    BOOST_REQUIRE_EQUAL(processor.received_.size(), 6);
+    BOOST_CHECK_EQUAL(processor.received_[4].seqNumber.get_int(), 98);
+    BOOST_CHECK_EQUAL(processor.received_[5].seqNumber.get_int(), 99);
+
+    removeStateFile();
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateUnicastNotificationsAfterRestartTest)
+{
+    removeStateFile();
+    properties.setStateFileName(STATE_FILE_NAME);
+    KaaClientContext clientContext(properties, tmp_logger, context);
+    IKaaClientStateStoragePtr status(new ClientStatus(clientContext));
+    clientContext.setStatus(status);
+    MockChannelManager channelManager;
+
+    NotificationCollector processor;
+
+    const std::string unicastNfUid("uid1");
+    Notification nf;
+    nf.topicId = 1;
+    nf.uid.set_string(unicastNfUid);
+
+    NotificationSyncResponse response;
+    response.notifications.set_array(std::vector<Notification>({nf}));
+
+    {
+        NotificationTransport transport(channelManager, clientContext);
+        transport.setNotificationProcessor(&processor);
+        transport.onNotificationResponse(response);
+    }
+
+    BOOST_CHECK_EQUAL(processor.received_.size(), 1);
+
+    /* The endpoint restarted before the ack reached the server, so the notification is resent. */
+    IKaaClientStateStoragePtr restoredStatus(new ClientStatus(clientContext));
+    clientContext.setStatus(restoredStatus);
+    NotificationTransport transport(channelManager, clientContext);
+    transport.setNotificationProcessor(&processor);
+    transport.onNotificationResponse(response);
+
+    BOOST_CHECK_EQUAL(processor.received_.size(), 1);
+
+    auto request = transport.createNotificationRequest();
+    BOOST_REQUIRE(!request->acceptedUnicastNotifications.is_null());
+    BOOST_CHECK_EQUAL(request->acceptedUnicastNotifications.get_array().front(), unicastNfUid);
+
+    removeStateFile();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "kaa/observer/KaaObservable.hpp"
+
+namespace kaa {
+
+typedef KaaObservable<void (int), int> TestObservable;
+
+BOOST_AUTO_TEST_SUITE(KaaObservableTestSuite)
+
+BOOST_AUTO_TEST_CASE(AddRemoveCallbackTest)
+{
+    TestObservable observable;
+    BOOST_CHECK(observable.isEmpty());
+
+    int sum = 0;
+    BOOST_CHECK(observable.addCallback(1, [&sum] (int value) { sum += value; }));
+    BOOST_CHECK(observable.addCallback(2, [&sum] (int value) { sum += 10 * value; }));
+    BOOST_CHECK(!observable.addCallback(1, [&sum] (int value) { sum += 100 * value; }));
+    BOOST_CHECK(!observable.isEmpty());
+
+    observable(1);
+    BOOST_CHECK_EQUAL(sum, 11);
+
+    observable.removeCallback(2);
+    observable.removeCallback(3);
+
+    observable(1);
+    BOOST_CHECK_EQUAL(sum, 12);
+
+    observable.removeCallback(1);
+    BOOST_CHECK(observable.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(CallbackThrowsTest)
+{
+    TestObservable observable;
+
+    int calls = 0;
+    observable.addCallback(1, [&calls] (int) { ++calls; throw std::runtime_error("test exception"); });
+    observable.addCallback(2, [&calls] (int) { ++calls; });
+
+    BOOST_CHECK_NO_THROW(observable(0));
+    BOOST_CHECK_EQUAL(calls, 2);
+}
+
+BOOST_AUTO_TEST_CASE(ModifyDuringNotificationTest)
+{
+    TestObservable observable;
+
+    int firstCalls = 0;
+    int secondCalls = 0;
+    int addedCalls = 0;
+
+    observable.addCallback(1, [&] (int)
+        {
+            ++firstCalls;
+            observable.removeCallback(1);
+            observable.removeCallback(2);
+            observable.addCallback(3, [&addedCalls] (int) { ++addedCalls; });
+        });
+    observable.addCallback(2, [&secondCalls] (int) { ++secondCalls; });
+
+    observable(0);
+
+    // The removed callback isn't called by the notification in progress, the added one is called by the next.
+    BOOST_CHECK_EQUAL(firstCalls, 1);
+    BOOST_CHECK_EQUAL(secondCalls, 0);
+    BOOST_CHECK_EQUAL(addedCalls, 0);
+
+    observable(0);
+
+    BOOST_CHECK_EQUAL(firstCalls, 1);
+    BOOST_CHECK_EQUAL(addedCalls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentNotifyAndSubscribeTest)
+{
+    const int notificationCount = 10000;
+
+    TestObservable observable;
+    std::atomic_int calls(0);
+    observable.addCallback(0, [&calls] (int) { ++calls; });
+
+    std::vector<std::thread> notifiers;
+    for (int i = 0; i < 2; ++i) {
+        notifiers.emplace_back([&observable, notificationCount]
+            {
+                for (int j = 0; j < notificationCount; ++j) {
+                    observable(j);
+                }
+            });
+    }
+
+    for (int key = 1; key < 100; ++key) {
+        observable.addCallback(key, [] (int) {});
+        observable.removeCallback(key);
+    }
+
+    for (auto& notifier : notifiers) {
+        notifier.join();
+    }
+
+    BOOST_CHECK_EQUAL(calls.load(), 2 * notificationCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -28,9 +28,22 @@
 #include "headers/channel/MockChannelManager.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
 #include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/channel/transport/MockProfileTransport.hpp"
 
 namespace kaa {
 
+class CountingProfileContainer : public DefaultProfileContainer {
+public:
+    KaaProfile getProfile()
+    {
+        ++onGetProfile_;
+        return DefaultProfileContainer::getProfile();
+    }
+
+public:
+    std::size_t onGetProfile_ = 0;
+};
+
 BOOST_AUTO_TEST_SUITE(ProfileManagerTestSuite)
 
 BOOST_AUTO_TEST_CASE(ProfileManagerIsInitializedTest)
@@ -56,6 +69,61 @@ BOOST_AUTO_TEST_CASE(ProfileManagerIsInitializedTest)
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(SerializedProfileCacheTest)
+{
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+    SimpleExecutorContext executor;
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+
+    auto container = std::make_shared<CountingProfileContainer>();
+    ProfileManager profileManager(clientContext);
+    profileManager.setProfileContainer(container);
+
+    auto serializedProfile = profileManager.getSerializedProfile();
+    auto profileHash = profileManager.getSerializedProfileHash();
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 1);
+    BOOST_CHECK(profileHash == EndpointObjectHash(serializedProfile).getHashDigest());
+
+    container->setProfile(KaaProfile());
+    profileManager.getSerializedProfile();
+    profileManager.getSerializedProfile();
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 2);
+
+    /* A new container invalidates the cache even if its version is the same. */
+    auto otherContainer = std::make_shared<CountingProfileContainer>();
+    profileManager.setProfileContainer(otherContainer);
+    profileManager.getSerializedProfile();
+    BOOST_CHECK_EQUAL(otherContainer->onGetProfile_, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SkipUnchangedProfileUpdateTest)
+{
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    auto state = std::make_shared<MockKaaClientStateStorage>();
+    SimpleExecutorContext executor;
+    KaaClientContext clientContext(properties, tmp_logger, executor, state);
+
+    auto transport = std::make_shared<MockProfileTransport>();
+    ProfileManager profileManager(clientContext);
+    profileManager.setTransport(transport);
+
+    state->isRegistered_ = true;
+    state->profileHash_ = profileManager.getSerializedProfileHash();
+
+    profileManager.updateProfile();
+    profileManager.updateProfile();
+    BOOST_CHECK_EQUAL(transport->onSync_, 0);
+    BOOST_CHECK_EQUAL(profileManager.getSkippedUpdatesCount(), 2);
+
+    state->isProfileResyncNeeded_ = true;
+    profileManager.updateProfile();
+    BOOST_CHECK_EQUAL(transport->onSync_, 1);
+    BOOST_CHECK_EQUAL(profileManager.getSkippedUpdatesCount(), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
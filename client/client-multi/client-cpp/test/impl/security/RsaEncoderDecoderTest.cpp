@@ -0,0 +1,115 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <botan/pubkey.h>
+#include <botan/pkcs8.h>
+#include <botan/pipe.h>
+#include <botan/key_filt.h>
+#include <botan/lookup.h>
+
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaEncoderDecoder.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static SimpleExecutorContext executorContext;
+
+struct RsaEncoderDecoderFixture
+{
+    RsaEncoderDecoderFixture()
+        : keys(KeyUtils().generateKeyPair(2048))
+        , clientContext(properties, tmp_logger, executorContext)
+        , encDec(keys.getPublicKey(), keys.getPrivateKey(), keys.getPublicKey(), clientContext)
+    {
+
+    }
+
+    /*
+     * The remote key is the client key itself, so the session key can be decrypted with the client private key.
+     */
+    SessionKey decryptSessionKey()
+    {
+        Botan::AutoSeeded_RNG rng;
+        Botan::DataSource_Memory privMem(keys.getPrivateKey());
+        std::unique_ptr<Botan::Private_Key> privKey(Botan::PKCS8::load_key(privMem, rng));
+
+        const auto& encodedSessionKey = encDec.getEncodedSessionKey();
+        Botan::PK_Decryptor_EME decryptor(*privKey, "EME-PKCS1-v1_5");
+        return SessionKey(decryptor.decrypt(encodedSessionKey.data(), encodedSessionKey.size()));
+    }
+
+    KeyPair keys;
+    KaaClientContext clientContext;
+    RsaEncoderDecoder encDec;
+};
+
+BOOST_AUTO_TEST_SUITE(RsaEncoderDecoderTestSuite)
+
+BOOST_FIXTURE_TEST_CASE(InPlaceEncodingMatchesAesPipe, RsaEncoderDecoderFixture)
+{
+    const std::string header = "header";
+    const SessionKey sessionKey = decryptSessionKey();
+
+    for (std::size_t size : { 0, 1, 15, 16, 17, 1000 }) {
+        const std::vector<std::uint8_t> data(size, 0xAB);
+
+        Botan::Pipe pipe(Botan::get_cipher("AES-128/ECB/PKCS7", sessionKey, Botan::ENCRYPTION));
+        pipe.process_msg(data.data(), data.size());
+        const std::string expected = pipe.read_all_as_string();
+
+        std::vector<std::uint8_t> buffer(header.begin(), header.end());
+        buffer.insert(buffer.end(), data.begin(), data.end());
+        encDec.encodeDataInPlace(buffer, header.size());
+
+        BOOST_CHECK(std::equal(header.begin(), header.end(), buffer.begin()));
+        BOOST_CHECK_EQUAL(std::string(buffer.begin() + header.size(), buffer.end()), expected);
+        BOOST_CHECK_EQUAL(encDec.encodeData(data.data(), data.size()), expected);
+
+        std::size_t decodedSize = encDec.decodeDataInPlace(buffer.data() + header.size(), buffer.size() - header.size());
+        BOOST_CHECK_EQUAL(decodedSize, size);
+        BOOST_CHECK(std::equal(data.begin(), data.end(), buffer.begin() + header.size()));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(DecodingRejectsInvalidData, RsaEncoderDecoderFixture)
+{
+    std::vector<std::uint8_t> buffer(15, 0);
+    BOOST_CHECK_THROW(encDec.decodeDataInPlace(buffer.data(), buffer.size()), KaaException);
+
+    /*
+     * The first block of the encrypted data is decrypted to zeros, which aren't valid padding.
+     */
+    buffer.assign(16, 0);
+    encDec.encodeDataInPlace(buffer);
+    BOOST_CHECK_THROW(encDec.decodeDataInPlace(buffer.data(), 16), KaaException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaKeyCache.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(RsaKeyCacheTestSuite)
+
+BOOST_AUTO_TEST_CASE(SameKeysAreParsedOnce)
+{
+    RsaKeyCache::clear();
+
+    KeyPair keys = KeyUtils().generateKeyPair(2048);
+    KeyPair otherKeys = KeyUtils().generateKeyPair(2048);
+
+    auto publicKey = RsaKeyCache::getPublicKey(keys.getPublicKey());
+    BOOST_CHECK(publicKey == RsaKeyCache::getPublicKey(PublicKey(keys.getPublicKey())));
+    BOOST_CHECK(publicKey != RsaKeyCache::getPublicKey(otherKeys.getPublicKey()));
+
+    auto privateKey = RsaKeyCache::getPrivateKey(keys.getPrivateKey());
+    BOOST_CHECK(privateKey == RsaKeyCache::getPrivateKey(keys.getPrivateKey()));
+    BOOST_CHECK(privateKey != RsaKeyCache::getPrivateKey(otherKeys.getPrivateKey()));
+
+    RsaKeyCache::clear();
+    BOOST_CHECK(publicKey != RsaKeyCache::getPublicKey(keys.getPublicKey()));
+}
+
+BOOST_AUTO_TEST_CASE(CachedOperationsAreReusable)
+{
+    KeyPair keys = KeyUtils().generateKeyPair(2048);
+    auto publicKey = RsaKeyCache::getPublicKey(keys.getPublicKey());
+    auto privateKey = RsaKeyCache::getPrivateKey(keys.getPrivateKey());
+
+    for (const std::string data : { "first", "second" }) {
+        const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(data.data());
+        const Signature& signature = privateKey->sign(bytes, data.size());
+        BOOST_CHECK(publicKey->verify(bytes, data.size(), signature.data(), signature.size()));
+        BOOST_CHECK(!publicKey->verify(bytes, data.size() - 1, signature.data(), signature.size()));
+        BOOST_CHECK(!publicKey->encrypt(bytes, data.size()).empty());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
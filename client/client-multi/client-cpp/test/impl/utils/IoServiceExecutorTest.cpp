@@ -0,0 +1,101 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "kaa/utils/IoServicePool.hpp"
+#include "kaa/utils/IoServiceExecutor.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(IoServiceExecutorTestSuite)
+
+BOOST_AUTO_TEST_CASE(TasksRunByPollTest)
+{
+    auto pool = IoServicePool::createPolled();
+    IoServiceExecutor executor(pool->getIoService());
+
+    std::size_t executedTasks = 0;
+    executor.add([&executedTasks] { ++executedTasks; });
+    executor.add([] { throw std::runtime_error("task failure"); });
+    executor.add([&executedTasks] { ++executedTasks; });
+
+    BOOST_CHECK_EQUAL(executedTasks, 0);
+    BOOST_CHECK_EQUAL(pool->getIoService().poll(), 3);
+    BOOST_CHECK_EQUAL(executedTasks, 2);
+}
+
+BOOST_AUTO_TEST_CASE(BadTaskTest)
+{
+    auto pool = IoServicePool::createPolled();
+    IoServiceExecutor executor(pool->getIoService());
+
+    BOOST_CHECK_THROW(executor.add(ThreadPoolTask()), std::invalid_argument);
+    BOOST_CHECK_THROW(executor.awaitTermination(1), std::logic_error);
+
+    executor.shutdown();
+    BOOST_CHECK_THROW(executor.add([] {}), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(AwaitTerminationRunsTasksTest)
+{
+    auto pool = IoServicePool::createPolled();
+    IoServiceExecutor executor(pool->getIoService());
+
+    bool isStopped = false;
+    executor.add([&executor, &isStopped]
+        {
+            /*
+             * The task being run doesn't keep the executor from terminating.
+             */
+            executor.shutdown();
+            executor.awaitTermination(5);
+            isStopped = true;
+        });
+
+    std::size_t executedTasks = 0;
+    executor.add([&executedTasks] { ++executedTasks; });
+
+    executor.shutdown();
+    executor.awaitTermination(5);
+
+    BOOST_CHECK(isStopped);
+    BOOST_CHECK_EQUAL(executedTasks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownNowTest)
+{
+    auto pool = IoServicePool::createPolled();
+
+    std::size_t executedTasks = 0;
+    {
+        IoServiceExecutor executor(pool->getIoService());
+        executor.add([&executedTasks] { ++executedTasks; });
+        executor.shutdownNow();
+
+        IoServiceExecutor destroyedExecutor(pool->getIoService());
+        destroyedExecutor.add([&executedTasks] { ++executedTasks; });
+    }
+
+    pool->getIoService().poll();
+    BOOST_CHECK_EQUAL(executedTasks, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+
+#include "kaa/utils/IoServicePool.hpp"
+#include "kaa/KaaClientPlatformContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(IoServicePoolTestSuite)
+
+BOOST_AUTO_TEST_CASE(PoolSizeTest)
+{
+    IoServicePool defaultPool;
+    BOOST_CHECK(defaultPool.getSize() > 0);
+
+    IoServicePool pool(3);
+    BOOST_CHECK_EQUAL(pool.getSize(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(RoundRobinTest)
+{
+    IoServicePool pool(2);
+
+    auto *first = &pool.getIoService();
+    auto *second = &pool.getIoService();
+
+    BOOST_CHECK(first != second);
+    BOOST_CHECK(first == &pool.getIoService());
+    BOOST_CHECK(second == &pool.getIoService());
+}
+
+BOOST_AUTO_TEST_CASE(HandlersRunTest)
+{
+    const std::size_t handlerCount = 100;
+    std::atomic<std::size_t> executedHandlers(0);
+
+    IoServicePool pool(2);
+    for (std::size_t i = 0; i < handlerCount; ++i) {
+        pool.getIoService().post([&executedHandlers] { ++executedHandlers; });
+    }
+
+    for (std::size_t i = 0; i < 100 && executedHandlers != handlerCount; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    BOOST_CHECK_EQUAL(executedHandlers, handlerCount);
+}
+
+BOOST_AUTO_TEST_CASE(HandlerExceptionTest)
+{
+    std::atomic<bool> isExecuted(false);
+
+    IoServicePool pool(1);
+    pool.getIoService().post([] { throw 1; });
+    pool.getIoService().post([&isExecuted] { isExecuted = true; });
+
+    for (std::size_t i = 0; i < 100 && !isExecuted; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    BOOST_CHECK(isExecuted);
+}
+
+BOOST_AUTO_TEST_CASE(StopTest)
+{
+    IoServicePool pool(2);
+
+    pool.stop();
+    BOOST_CHECK_NO_THROW(pool.stop());
+}
+
+BOOST_AUTO_TEST_CASE(PolledPoolTest)
+{
+    auto pool = IoServicePool::createPolled();
+    BOOST_CHECK(pool->isPolled());
+    BOOST_CHECK_EQUAL(pool->getSize(), 1);
+    BOOST_CHECK(!IoServicePool(1).isPolled());
+
+    bool isExecuted = false;
+    pool->getIoService().post([&isExecuted] { isExecuted = true; });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    BOOST_CHECK(!isExecuted);
+
+    BOOST_CHECK_EQUAL(pool->getIoService().poll(), 1);
+    BOOST_CHECK(isExecuted);
+
+    pool->stop();
+    BOOST_CHECK(pool->getIoService().stopped());
+}
+
+BOOST_AUTO_TEST_CASE(PlatformContextTest)
+{
+    KaaClientPlatformContext defaultContext;
+    BOOST_CHECK(!defaultContext.getIoServicePool());
+
+    auto pool = std::make_shared<IoServicePool>(1);
+    KaaClientPlatformContext context(KaaClientProperties(), std::make_shared<SimpleExecutorContext>(), pool);
+    BOOST_CHECK(context.getIoServicePool() == pool);
+
+    BOOST_CHECK_THROW(KaaClientPlatformContext(KaaClientProperties(), std::make_shared<SimpleExecutorContext>(),
+                                               IoServicePoolPtr()), KaaException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
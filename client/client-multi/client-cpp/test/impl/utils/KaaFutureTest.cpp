@@ -0,0 +1,153 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "kaa/utils/KaaFuture.hpp"
+#include "kaa/utils/ThreadPool.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(KaaFutureTestSuite)
+
+BOOST_AUTO_TEST_CASE(ValueTest)
+{
+    KaaPromise<int> promise;
+    auto future = promise.getFuture();
+
+    BOOST_CHECK(future.isValid());
+    BOOST_CHECK(!future.isReady());
+    BOOST_CHECK(!future.waitFor(std::chrono::milliseconds(10)));
+
+    std::thread producer([promise] () mutable { promise.setValue(42); });
+
+    BOOST_CHECK_EQUAL(future.get(), 42);
+    BOOST_CHECK_EQUAL(future.get(), 42);
+    BOOST_CHECK(future.isReady());
+
+    producer.join();
+
+    BOOST_CHECK_THROW(promise.setValue(1), std::logic_error);
+    BOOST_CHECK(!promise.setException(std::make_exception_ptr(std::runtime_error("test"))));
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionTest)
+{
+    KaaPromise<void> promise;
+    auto future = promise.getFuture();
+
+    promise.setException(std::make_exception_ptr(std::runtime_error("test")));
+
+    BOOST_CHECK(future.isReady());
+    BOOST_CHECK_THROW(future.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(BrokenPromiseTest)
+{
+    KaaFuture<std::string> future;
+    BOOST_CHECK(!future.isValid());
+
+    {
+        KaaPromise<std::string> promise;
+        future = promise.getFuture();
+    }
+
+    BOOST_CHECK(future.isReady());
+    BOOST_CHECK_THROW(future.get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_CASE(ThenTest)
+{
+    KaaPromise<int> promise;
+
+    auto future = promise.getFuture()
+            .then([] (KaaFuture<int> f) { return f.get() * 2; })
+            .then([] (KaaFuture<int> f) { return std::to_string(f.get()); });
+
+    BOOST_CHECK(!future.isReady());
+
+    promise.setValue(21);
+
+    BOOST_CHECK(future.isReady());
+    BOOST_CHECK_EQUAL(future.get(), "42");
+
+    bool isCalled = false;
+    makeReadyFuture(1).then([&isCalled] (KaaFuture<int>) { isCalled = true; });
+    BOOST_CHECK(isCalled);
+}
+
+BOOST_AUTO_TEST_CASE(ThenExceptionTest)
+{
+    KaaPromise<int> promise;
+
+    auto future = promise.getFuture()
+            .then([] (KaaFuture<int> f) -> int { throw std::runtime_error("test"); })
+            .then([] (KaaFuture<int> f) { return f.get() + 1; });
+
+    promise.setValue(1);
+
+    BOOST_CHECK_THROW(future.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ThenUnwrapTest)
+{
+    KaaPromise<void> first;
+    KaaPromise<int> second;
+
+    auto future = first.getFuture().then([second] (KaaFuture<void> f) { f.get(); return second.getFuture(); });
+
+    first.setValue();
+    BOOST_CHECK(!future.isReady());
+
+    second.setValue(7);
+    BOOST_CHECK_EQUAL(future.get(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(ThenOnExecutorTest)
+{
+    ThreadPool executor;
+    KaaPromise<int> promise;
+
+    auto callerThreadId = std::this_thread::get_id();
+    std::atomic_bool isOnCallerThread(true);
+
+    auto future = promise.getFuture().then(executor, [callerThreadId, &isOnCallerThread] (KaaFuture<int> f)
+        {
+            isOnCallerThread = (std::this_thread::get_id() == callerThreadId);
+            return f.get() + 1;
+        });
+
+    promise.setValue(1);
+
+    BOOST_CHECK_EQUAL(future.get(), 2);
+    BOOST_CHECK(!isOnCallerThread);
+
+    executor.shutdown();
+    executor.awaitTermination(5);
+
+    auto rejected = makeReadyFuture(1).then(executor, [] (KaaFuture<int> f) { return f.get(); });
+    BOOST_CHECK_THROW(rejected.get(), std::logic_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -16,6 +16,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <functional>
 #include <thread>
 
 #include "kaa/utils/KaaTimer.hpp"
@@ -63,6 +65,48 @@ BOOST_AUTO_TEST_CASE(StopTimerTest)
     resetCounter();
 }
 
+BOOST_AUTO_TEST_CASE(RestartFromCallbackTest)
+{
+    std::atomic_int firedCount(0);
+    KaaTimer<void (void)> timer { "Kaa Timer" };
+
+    std::function<void ()> callback = [&timer, &firedCount, &callback]
+        {
+            if (++firedCount < 3) {
+                timer.start(0, callback);
+            }
+        };
+    timer.start(0, callback);
+
+    for (std::size_t i = 0; i < 50 && firedCount < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    BOOST_CHECK_EQUAL(firedCount.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(DestroyWaitsForCallbackTest)
+{
+    std::atomic_bool isStarted(false);
+    std::atomic_bool isFinished(false);
+
+    {
+        KaaTimer<void (void)> timer { "Kaa Timer" };
+        timer.start(0, [&isStarted, &isFinished]
+            {
+                isStarted = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                isFinished = true;
+            });
+
+        while (!isStarted) {
+            std::this_thread::yield();
+        }
+    }
+
+    BOOST_CHECK(isFinished);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
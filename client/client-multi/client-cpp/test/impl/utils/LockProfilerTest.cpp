@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "kaa/utils/LockProfiler.hpp"
+
+namespace kaa {
+
+static LockStatistics getLockStatistics(const std::string& name)
+{
+    for (const auto& lock : LockProfiler::getStatistics()) {
+        if (lock.name_ == name) {
+            return lock;
+        }
+    }
+
+    BOOST_FAIL("Lock " + name + " isn't registered");
+    return LockStatistics();
+}
+
+BOOST_AUTO_TEST_SUITE(LockProfilerTestSuite)
+
+BOOST_AUTO_TEST_CASE(UncontendedLockTest)
+{
+    ProfiledMutex<std::mutex> mutex(__FILE__, "uncontendedGuard_");
+
+    for (std::size_t i = 0; i < 10; ++i) {
+        std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+    }
+
+    auto statistics = getLockStatistics("uncontendedGuard_");
+    BOOST_CHECK_EQUAL(statistics.file_, "LockProfilerTest.cpp");
+    BOOST_CHECK_EQUAL(statistics.acquisitionCount_, 10);
+    BOOST_CHECK_EQUAL(statistics.contentionCount_, 0);
+    BOOST_CHECK_EQUAL(statistics.totalWaitTimeNs_, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ContendedLockTest)
+{
+    const auto holdTime = std::chrono::milliseconds(50);
+
+    ProfiledMutex<std::mutex> mutex(__FILE__, "contendedGuard_");
+    std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+
+    std::thread waiter([&mutex]
+        {
+            std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+        });
+
+    std::this_thread::sleep_for(holdTime);
+    lock.unlock();
+    waiter.join();
+
+    auto statistics = getLockStatistics("contendedGuard_");
+    BOOST_CHECK_EQUAL(statistics.acquisitionCount_, 2);
+    BOOST_CHECK_EQUAL(statistics.contentionCount_, 1);
+    BOOST_CHECK(statistics.maxWaitTimeNs_ > 0);
+    BOOST_CHECK(statistics.maxHoldTimeNs_ >= static_cast<std::uint64_t>(std::chrono::nanoseconds(holdTime).count()));
+}
+
+BOOST_AUTO_TEST_CASE(RecursiveLockTest)
+{
+    ProfiledMutex<std::recursive_mutex> mutex(__FILE__, "recursiveGuard_");
+
+    {
+        std::unique_lock<ProfiledMutex<std::recursive_mutex>> lock(mutex);
+        std::unique_lock<ProfiledMutex<std::recursive_mutex>> nestedLock(mutex);
+    }
+
+    BOOST_CHECK_EQUAL(getLockStatistics("recursiveGuard_").acquisitionCount_, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SameNameTest)
+{
+    ProfiledMutex<std::mutex> mutex1(__FILE__, "sharedNameGuard_");
+    ProfiledMutex<std::mutex> mutex2(__FILE__, "sharedNameGuard_");
+
+    { std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex1); }
+    { std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex2); }
+
+    BOOST_CHECK_EQUAL(getLockStatistics("sharedNameGuard_").acquisitionCount_, 2);
+}
+
+BOOST_AUTO_TEST_CASE(ConditionVariableTest)
+{
+    ProfiledMutex<std::mutex> mutex(__FILE__, "conditionGuard_");
+    std::condition_variable_any condition;
+    bool isReady = false;
+
+    std::thread notifier([&]
+        {
+            std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+            isReady = true;
+            condition.notify_one();
+        });
+
+    {
+        std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+        condition.wait(lock, [&isReady] { return isReady; });
+    }
+
+    notifier.join();
+
+    BOOST_CHECK(getLockStatistics("conditionGuard_").acquisitionCount_ >= 2);
+}
+
+BOOST_AUTO_TEST_CASE(DumpAndResetTest)
+{
+    ProfiledMutex<std::mutex> mutex(__FILE__, "dumpedGuard_");
+    { std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex); }
+
+    std::ostringstream stream;
+    LockProfiler::dump(stream);
+    BOOST_CHECK(stream.str().find("LockProfilerTest.cpp:dumpedGuard_") != std::string::npos);
+
+    LockProfiler::reset();
+    BOOST_CHECK_EQUAL(getLockStatistics("dumpedGuard_").acquisitionCount_, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
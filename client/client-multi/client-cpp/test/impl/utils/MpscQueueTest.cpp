@@ -0,0 +1,120 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "kaa/utils/MpscQueue.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(MpscQueueTestSuite)
+
+BOOST_AUTO_TEST_CASE(PushAndConsumeInOrderTest)
+{
+    MpscQueue<int> queue;
+    BOOST_CHECK(queue.empty());
+
+    BOOST_CHECK(queue.push(1));
+    BOOST_CHECK(!queue.push(2));
+    BOOST_CHECK(!queue.push(3));
+    BOOST_CHECK(!queue.empty());
+
+    std::vector<int> consumed;
+    BOOST_CHECK_EQUAL(queue.consumeAll([&consumed] (int&& value) { consumed.push_back(value); }), 3);
+
+    std::vector<int> expected{ 1, 2, 3 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(consumed.begin(), consumed.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(queue.consumeAll([] (int&&) { BOOST_CHECK(false); }), 0);
+    BOOST_CHECK(queue.push(4));
+}
+
+BOOST_AUTO_TEST_CASE(ConsumerExceptionTest)
+{
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::unique_ptr<int>(new int(1)));
+    queue.push(std::unique_ptr<int>(new int(2)));
+
+    BOOST_CHECK_THROW(queue.consumeAll([] (std::unique_ptr<int>&&) { throw std::runtime_error("test"); }),
+                      std::runtime_error);
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentProducersTest)
+{
+    const std::size_t producerCount = 8;
+    const std::size_t valuesPerProducer = 10000;
+
+    MpscQueue<std::size_t> queue;
+    std::atomic_bool isStarted(false);
+
+    std::vector<std::thread> producers;
+    for (std::size_t producer = 0; producer < producerCount; ++producer) {
+        producers.emplace_back([&queue, &isStarted, producer, valuesPerProducer] ()
+                {
+                    while (!isStarted) {
+                        std::this_thread::yield();
+                    }
+
+                    for (std::size_t i = 0; i < valuesPerProducer; ++i) {
+                        queue.push(producer * valuesPerProducer + i);
+                    }
+                });
+    }
+
+    isStarted = true;
+
+    std::size_t consumedCount = 0;
+    std::vector<std::size_t> lastValues(producerCount, 0);
+    std::vector<bool> hasValues(producerCount, false);
+
+    auto consumer = [&] (std::size_t&& value)
+            {
+                auto producer = value / valuesPerProducer;
+
+                /*
+                 * Values of each producer must come in the order they were pushed.
+                 */
+                BOOST_REQUIRE(!hasValues[producer] || lastValues[producer] < value);
+                lastValues[producer] = value;
+                hasValues[producer] = true;
+                ++consumedCount;
+            };
+
+    while (consumedCount < producerCount * valuesPerProducer) {
+        if (!queue.consumeAll(consumer)) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    BOOST_CHECK_EQUAL(consumedCount, producerCount * valuesPerProducer);
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <mutex>
+#include <thread>
+
+#include "kaa/utils/NullMutex.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(NullMutexTestSuite)
+
+BOOST_AUTO_TEST_CASE(RecursiveLockTest)
+{
+    NullMutex mutex;
+
+    std::unique_lock<NullMutex> outerLock(mutex);
+    BOOST_CHECK(outerLock.owns_lock());
+
+    {
+        std::lock_guard<NullMutex> innerLock(mutex);
+        BOOST_CHECK(mutex.try_lock());
+        mutex.unlock();
+    }
+
+    outerLock.unlock();
+    BOOST_CHECK(!outerLock.owns_lock());
+}
+
+BOOST_AUTO_TEST_CASE(OwnerThreadTest)
+{
+    /*
+     * The mutex is owned by the thread which locks it first, not by the one which creates it.
+     */
+    NullMutex mutex;
+
+    std::thread thread([&mutex]
+        {
+            for (int i = 0; i < 10; ++i) {
+                std::lock_guard<NullMutex> lock(mutex);
+            }
+        });
+    thread.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/ObjectPool.hpp"
+
+namespace kaa {
+
+/*
+ * Pools are process-wide, so each test case uses its own type.
+ */
+template<int Id>
+struct PooledObject {
+    std::vector<std::uint8_t> data_;
+};
+
+BOOST_AUTO_TEST_SUITE(ObjectPoolTestSuite)
+
+BOOST_AUTO_TEST_CASE(EmptyPoolTest)
+{
+    typedef ObjectPool<PooledObject<0>> Pool;
+
+    auto object = Pool::acquire();
+    BOOST_CHECK(object.data_.empty());
+    BOOST_CHECK_EQUAL(object.data_.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CapacityKeptTest)
+{
+    typedef ObjectPool<PooledObject<1>> Pool;
+
+    PooledObject<1> object;
+    object.data_.assign(100, 0xFF);
+    const auto *buffer = object.data_.data();
+
+    Pool::release(std::move(object));
+    BOOST_CHECK_EQUAL(Pool::getThreadCacheSize(), 1);
+
+    auto recycled = Pool::acquire();
+    BOOST_CHECK_EQUAL(Pool::getThreadCacheSize(), 0);
+    BOOST_CHECK(recycled.data_.data() == buffer);
+    BOOST_CHECK(recycled.data_.capacity() >= 100);
+}
+
+BOOST_AUTO_TEST_CASE(ProducerConsumerThreadsTest)
+{
+    typedef ObjectPool<PooledObject<2>> Pool;
+
+    const std::size_t objectCount = Pool::THREAD_CACHE_SIZE * 2;
+
+    std::thread consumer([objectCount]
+        {
+            for (std::size_t i = 0; i < objectCount; ++i) {
+                PooledObject<2> object;
+                object.data_.resize(10);
+                Pool::release(std::move(object));
+            }
+        });
+    consumer.join();
+
+    /*
+     * Objects released by the consumer are passed to the shared pool, partly when its cache overflows
+     * and the rest when it exits.
+     */
+    BOOST_CHECK_EQUAL(Pool::getSharedPoolSize(), objectCount);
+
+    std::size_t recycledCount = 0;
+    for (std::size_t i = 0; i < objectCount; ++i) {
+        if (Pool::acquire().data_.capacity()) {
+            ++recycledCount;
+        }
+    }
+
+    BOOST_CHECK_EQUAL(recycledCount, objectCount);
+    BOOST_CHECK_EQUAL(Pool::getSharedPoolSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PoolLimitTest)
+{
+    typedef ObjectPool<PooledObject<3>> Pool;
+
+    const std::size_t objectCount = Pool::SHARED_POOL_SIZE + Pool::THREAD_CACHE_SIZE * 4;
+
+    for (std::size_t i = 0; i < objectCount; ++i) {
+        Pool::release(PooledObject<3>());
+    }
+
+    BOOST_CHECK(Pool::getThreadCacheSize() <= Pool::THREAD_CACHE_SIZE);
+    BOOST_CHECK_EQUAL(Pool::getSharedPoolSize(), Pool::SHARED_POOL_SIZE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
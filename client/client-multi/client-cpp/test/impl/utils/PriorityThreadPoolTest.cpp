@@ -0,0 +1,179 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/PriorityThreadPool.hpp"
+
+namespace kaa {
+
+/*
+ * Holds the worker of the pool until released, so tasks added meanwhile are queued.
+ */
+class WorkerBlocker {
+public:
+    explicit WorkerBlocker(PriorityThreadPool& pool)
+    {
+        std::shared_future<void> released = release_.get_future().share();
+        std::promise<void> *started = &started_;
+        pool.getExecutor(0).add([released, started] { started->set_value(); released.wait(); });
+        started_.get_future().wait();
+    }
+
+    void release() { release_.set_value(); }
+
+private:
+    std::promise<void>    started_;
+    std::promise<void>    release_;
+};
+
+class ExecutionOrder {
+public:
+    ThreadPoolTask createTask(std::size_t id)
+    {
+        return [this, id] { std::lock_guard<std::mutex> lock(guard_); order_.push_back(id); };
+    }
+
+    std::vector<std::size_t> get()
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        return order_;
+    }
+
+private:
+    std::mutex                  guard_;
+    std::vector<std::size_t>    order_;
+};
+
+static void awaitTasks(PriorityThreadPool& pool)
+{
+    pool.shutdown();
+    pool.awaitTermination(5);
+}
+
+BOOST_AUTO_TEST_SUITE(PriorityThreadPoolTestSuite)
+
+BOOST_AUTO_TEST_CASE(CreationTest)
+{
+    BOOST_CHECK_THROW({ PriorityThreadPool pool(0); }, std::invalid_argument);
+
+    PrioritySchedulingSettings settings;
+    settings.maxAgedSlice_ = 0;
+    BOOST_CHECK_THROW({ PriorityThreadPool pool(3, settings); }, std::invalid_argument);
+
+    PriorityThreadPool pool(3);
+    BOOST_CHECK_NO_THROW(pool.getExecutor(2));
+    BOOST_CHECK_THROW(pool.getExecutor(3), std::out_of_range);
+    BOOST_CHECK_THROW(pool.getExecutor(0).add(ThreadPoolTask()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(HigherPriorityFirstTest)
+{
+    PrioritySchedulingSettings settings;
+    settings.agingInterval_ = std::chrono::milliseconds::zero();
+    PriorityThreadPool pool(3, settings);
+    ExecutionOrder order;
+
+    WorkerBlocker blocker(pool);
+    pool.getExecutor(2).add(order.createTask(20));
+    pool.getExecutor(1).add(order.createTask(10));
+    pool.getExecutor(2).add(order.createTask(21));
+    pool.getExecutor(0).add(order.createTask(0));
+    pool.getExecutor(1).add(order.createTask(11));
+
+    BOOST_CHECK_EQUAL(pool.getExecutor(2).getQueueMetrics().queueDepth_, 2);
+    blocker.release();
+    awaitTasks(pool);
+
+    std::vector<std::size_t> expected { 0, 10, 11, 20, 21 };
+    auto actual = order.get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(AgedTaskIsNotStarvedTest)
+{
+    PrioritySchedulingSettings settings;
+    settings.agingInterval_ = std::chrono::milliseconds(5);
+    PriorityThreadPool pool(3, settings);
+    ExecutionOrder order;
+
+    WorkerBlocker blocker(pool);
+    pool.getExecutor(2).add(order.createTask(20));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    pool.getExecutor(0).add(order.createTask(0));
+    pool.getExecutor(1).add(order.createTask(10));
+
+    blocker.release();
+    awaitTasks(pool);
+
+    std::vector<std::size_t> expected { 20, 0, 10 };
+    auto actual = order.get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(AgedSliceIsBoundedTest)
+{
+    PrioritySchedulingSettings settings;
+    settings.agingInterval_ = std::chrono::milliseconds(1);
+    settings.maxAgedSlice_ = 2;
+    PriorityThreadPool pool(2, settings);
+    ExecutionOrder order;
+
+    WorkerBlocker blocker(pool);
+    for (std::size_t i = 0; i < 5; ++i) {
+        pool.getExecutor(1).add(order.createTask(10 + i));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (std::size_t i = 0; i < 3; ++i) {
+        pool.getExecutor(0).add(order.createTask(i));
+    }
+
+    blocker.release();
+    awaitTasks(pool);
+
+    std::vector<std::size_t> expected { 10, 11, 0, 12, 13, 1, 14, 2 };
+    auto actual = order.get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownTest)
+{
+    PriorityThreadPool pool(2);
+    ExecutionOrder order;
+
+    WorkerBlocker blocker(pool);
+    pool.getExecutor(1).add(order.createTask(10));
+
+    /* Shutting down any executor shuts down the pool. */
+    pool.getExecutor(1).shutdown();
+    BOOST_CHECK_THROW(pool.getExecutor(0).add(order.createTask(0)), std::logic_error);
+
+    blocker.release();
+    pool.getExecutor(0).awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(order.get().size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+#include "kaa/utils/RandomGenerator.hpp"
+#include "kaa/common/UuidGenerator.hpp"
+
+#include "headers/AllocationCounter.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(RandomGeneratorTestSuite)
+
+BOOST_AUTO_TEST_CASE(SameSeedTest)
+{
+    RandomGenerator first(42);
+    RandomGenerator second(42);
+    RandomGenerator other(43);
+
+    bool isOtherSequence = false;
+    for (int i = 0; i < 100; ++i) {
+        auto value = first();
+        BOOST_CHECK_EQUAL(value, second());
+        isOtherSequence = isOtherSequence || (value != other());
+    }
+
+    BOOST_CHECK(isOtherSequence);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadGeneratorTest)
+{
+    std::uint64_t mainValue = RandomGenerator::getThreadGenerator()();
+    std::uint64_t threadValue = mainValue;
+
+    std::thread thread([&threadValue] { threadValue = RandomGenerator::getThreadGenerator()(); });
+    thread.join();
+
+    BOOST_CHECK_NE(mainValue, threadValue);
+    BOOST_CHECK_NE(RandomGenerator::generateSeed(), RandomGenerator::generateSeed());
+}
+
+BOOST_AUTO_TEST_CASE(NoAllocationTest)
+{
+    std::string uuid;
+    UuidGenerator::generateUuid(uuid);
+
+    AllocationScope scope;
+    for (int i = 0; i < 100; ++i) {
+        RandomGenerator::generateInt();
+        UuidGenerator::generateRandomInt();
+        UuidGenerator::generateUuid(uuid);
+    }
+    KAA_CHECK_MAX_ALLOCATIONS(scope, 0);
+}
+
+BOOST_AUTO_TEST_CASE(UuidFormatTest)
+{
+    std::set<std::string> uuids;
+    for (int i = 0; i < 1000; ++i) {
+        std::string uuid = UuidGenerator::generateUuid();
+
+        BOOST_REQUIRE_EQUAL(uuid.size(), 36);
+        BOOST_CHECK_EQUAL(uuid[8], '-');
+        BOOST_CHECK_EQUAL(uuid[13], '-');
+        BOOST_CHECK_EQUAL(uuid[18], '-');
+        BOOST_CHECK_EQUAL(uuid[23], '-');
+        BOOST_CHECK_EQUAL(uuid[14], '4');
+        BOOST_CHECK(std::string("89ab").find(uuid[19]) != std::string::npos);
+
+        uuids.insert(uuid);
+    }
+
+    BOOST_CHECK_EQUAL(uuids.size(), 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "kaa/utils/RingQueue.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(RingQueueTestSuite)
+
+BOOST_AUTO_TEST_CASE(PushAndPopInOrderTest)
+{
+    RingQueue<int> queue(3);
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(queue.capacity(), 4);
+
+    std::vector<int> popped;
+    for (int round = 0; round < 10; ++round) {
+        queue.push(2 * round);
+        queue.push(2 * round + 1);
+
+        popped.push_back(queue.front());
+        queue.pop();
+    }
+
+    while (!queue.empty()) {
+        popped.push_back(queue.front());
+        queue.pop();
+    }
+
+    BOOST_CHECK_EQUAL(popped.size(), 20);
+    for (std::size_t i = 0; i < popped.size(); ++i) {
+        BOOST_CHECK_EQUAL(popped[i], static_cast<int>(i));
+    }
+
+    /*
+     * The queue never held more than 10 elements.
+     */
+    BOOST_CHECK_EQUAL(queue.capacity(), 16);
+}
+
+BOOST_AUTO_TEST_CASE(SequenceSurvivesGrowthTest)
+{
+    RingQueue<int> queue(2);
+
+    queue.push(0);
+    queue.pop();
+
+    auto sequence = queue.push(1);
+    BOOST_CHECK(queue.contains(sequence));
+
+    for (int value = 2; value < 10; ++value) {
+        queue.push(int(value));
+    }
+
+    BOOST_CHECK_EQUAL(queue.at(sequence), 1);
+    queue.at(sequence) = 100;
+    BOOST_CHECK_EQUAL(queue.front(), 100);
+
+    queue.pop();
+    BOOST_CHECK(!queue.contains(sequence));
+}
+
+BOOST_AUTO_TEST_CASE(PopReleasesElementTest)
+{
+    RingQueue<std::shared_ptr<int>> queue;
+
+    auto value = std::make_shared<int>(1);
+    queue.push(std::shared_ptr<int>(value));
+    queue.push(std::shared_ptr<int>(value));
+    BOOST_CHECK_EQUAL(value.use_count(), 3);
+
+    queue.pop();
+    BOOST_CHECK_EQUAL(value.use_count(), 2);
+
+    queue.clear();
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(value.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/SyncTracer.hpp"
+
+namespace kaa {
+
+class RecordingSyncTraceExporter : public ISyncTraceExporter {
+public:
+    virtual void onSpan(const SyncTraceSpan& span)
+    {
+        spans_.push_back(span);
+        channelIds_.push_back(span.channelId_ ? span.channelId_ : "");
+    }
+
+public:
+    std::vector<SyncTraceSpan> spans_;
+    std::vector<std::string> channelIds_;
+};
+
+class SyncTracerFixture {
+public:
+    ~SyncTracerFixture()
+    {
+        SyncTracer::setExporter(nullptr);
+        SyncTracer::setCurrentRequestId(0);
+    }
+
+public:
+    RecordingSyncTraceExporter exporter_;
+};
+
+BOOST_FIXTURE_TEST_SUITE(SyncTracerTestSuite, SyncTracerFixture)
+
+BOOST_AUTO_TEST_CASE(NoSpansWithoutExporterTest)
+{
+    BOOST_CHECK(!SyncTracer::isEnabled());
+
+    {
+        SyncTraceScope scope(SyncTraceStage::COMPILE, 1, nullptr);
+    }
+
+    SyncTracer::setExporter(&exporter_);
+    BOOST_CHECK(SyncTracer::isEnabled());
+
+    {
+        SyncTraceScope scope(SyncTraceStage::COMPILE, 2, nullptr);
+        SyncTracer::setExporter(nullptr);
+    }
+
+    BOOST_CHECK(!SyncTracer::isEnabled());
+
+    SyncTracer::record(SyncTraceStage::NETWORK, 3, "channel", std::chrono::steady_clock::now(),
+                       std::chrono::steady_clock::now());
+
+    BOOST_CHECK(exporter_.spans_.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ScopeSpanTest)
+{
+    SyncTracer::setExporter(&exporter_);
+
+    {
+        SyncTraceScope scope(SyncTraceStage::PROCESS, 0, "tcp.operations");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        scope.setRequestId(7);
+    }
+
+    BOOST_REQUIRE_EQUAL(exporter_.spans_.size(), 1);
+
+    const auto& span = exporter_.spans_[0];
+    BOOST_CHECK_EQUAL(span.requestId_, 7);
+    BOOST_CHECK(span.stage_ == SyncTraceStage::PROCESS);
+    BOOST_CHECK_EQUAL(exporter_.channelIds_[0], "tcp.operations");
+    BOOST_CHECK(span.end_ - span.start_ >= std::chrono::milliseconds(5));
+}
+
+BOOST_AUTO_TEST_CASE(RecordSpanTest)
+{
+    SyncTracer::setExporter(&exporter_);
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(10);
+    SyncTracer::record(SyncTraceStage::NETWORK, 5, "http.bootstrap", start, end);
+
+    BOOST_REQUIRE_EQUAL(exporter_.spans_.size(), 1);
+
+    const auto& span = exporter_.spans_[0];
+    BOOST_CHECK_EQUAL(span.requestId_, 5);
+    BOOST_CHECK(span.stage_ == SyncTraceStage::NETWORK);
+    BOOST_CHECK_EQUAL(exporter_.channelIds_[0], "http.bootstrap");
+    BOOST_CHECK(span.start_ == start);
+    BOOST_CHECK(span.end_ == end);
+}
+
+BOOST_AUTO_TEST_CASE(CurrentRequestIdTest)
+{
+    SyncTracer::setCurrentRequestId(42);
+    BOOST_CHECK_EQUAL(SyncTracer::getCurrentRequestId(), 42);
+
+    std::int32_t otherThreadRequestId = -1;
+    std::thread thread([&otherThreadRequestId] { otherThreadRequestId = SyncTracer::getCurrentRequestId(); });
+    thread.join();
+
+    BOOST_CHECK_EQUAL(otherThreadRequestId, 0);
+    BOOST_CHECK_EQUAL(SyncTracer::getCurrentRequestId(), 42);
+}
+
+BOOST_AUTO_TEST_CASE(StageNameTest)
+{
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::QUEUE), "queue");
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::COMPILE), "compile");
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::ENCRYPT), "encrypt");
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::NETWORK), "network");
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::DECRYPT), "decrypt");
+    BOOST_CHECK_EQUAL(SyncTracer::toString(SyncTraceStage::PROCESS), "process");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -21,6 +21,9 @@
 #include <thread>
 #include <functional>
 #include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "kaa/utils/ThreadPool.hpp"
 
@@ -337,6 +340,229 @@ BOOST_AUTO_TEST_CASE(AwaitTerminationTimeoutTest)
     BOOST_CHECK_LE(actualTaskCount.load(), totalTaskCount);
 }
 
+/*
+ * Occupies the worker of a single-threaded pool until released.
+ */
+class WorkerBlocker {
+public:
+    void block(ThreadPool& pool)
+    {
+        pool.add([this]
+            {
+                isStarted_ = true;
+                while (!isReleased_) {
+                    std::this_thread::yield();
+                }
+            });
+
+        while (!isStarted_) {
+            std::this_thread::yield();
+        }
+    }
+
+    void release() { isReleased_ = true; }
+
+private:
+    std::atomic_bool isStarted_ { false };
+    std::atomic_bool isReleased_ { false };
+};
+
+BOOST_AUTO_TEST_CASE(DropOldestTaskTest)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.capacity_ = 2;
+    queueSettings.overflowPolicy_ = TaskOverflowPolicy::DROP_OLDEST;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+
+    WorkerBlocker blocker;
+    blocker.block(threadPool);
+
+    std::mutex executedGuard;
+    std::vector<int> executedTasks;
+    for (int i = 0; i < 3; ++i) {
+        threadPool.add([i, &executedGuard, &executedTasks]
+            {
+                std::lock_guard<std::mutex> lock(executedGuard);
+                executedTasks.push_back(i);
+            });
+    }
+
+    auto metrics = threadPool.getQueueMetrics();
+    BOOST_CHECK_EQUAL(metrics.queueDepth_, 2);
+    BOOST_CHECK_EQUAL(metrics.maxQueueDepth_, 2);
+    BOOST_CHECK_EQUAL(metrics.droppedTaskCount_, 1);
+
+    blocker.release();
+    threadPool.shutdown();
+    threadPool.awaitTermination(5);
+
+    BOOST_CHECK(executedTasks == std::vector<int>({ 1, 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(BlockOnFullQueueTest)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.capacity_ = 1;
+    queueSettings.overflowPolicy_ = TaskOverflowPolicy::BLOCK;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+
+    WorkerBlocker blocker;
+    blocker.block(threadPool);
+
+    std::atomic_uint executedTaskCount(0);
+    threadPool.add([&executedTaskCount] { ++executedTaskCount; });
+
+    std::atomic_bool isAdded(false);
+    std::thread producer([&]
+        {
+            threadPool.add([&executedTaskCount] { ++executedTaskCount; });
+            isAdded = true;
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK(!isAdded);
+
+    blocker.release();
+    producer.join();
+
+    threadPool.shutdown();
+    threadPool.awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(executedTaskCount, 2);
+    BOOST_CHECK_EQUAL(threadPool.getQueueMetrics().blockedAddCount_, 1);
+}
+
+BOOST_AUTO_TEST_CASE(UnblockOnShutdownTest)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.capacity_ = 1;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+
+    WorkerBlocker blocker;
+    blocker.block(threadPool);
+    threadPool.add([] {});
+
+    std::atomic_bool isRejected(false);
+    std::thread producer([&]
+        {
+            try {
+                threadPool.add([] {});
+            } catch (const std::logic_error&) {
+                isRejected = true;
+            }
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    threadPool.shutdown();
+    producer.join();
+
+    BOOST_CHECK(isRejected);
+
+    blocker.release();
+    threadPool.awaitTermination(5);
+}
+
+BOOST_AUTO_TEST_CASE(CoalesceTaskTest)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.overflowPolicy_ = TaskOverflowPolicy::COALESCE;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+
+    WorkerBlocker blocker;
+    blocker.block(threadPool);
+
+    int key = 0;
+    std::atomic_int lastValue(0);
+    std::atomic_uint executedTaskCount(0);
+
+    for (int value = 1; value <= 3; ++value) {
+        threadPool.addCoalescing(&key, [value, &lastValue, &executedTaskCount]
+            {
+                lastValue = value;
+                ++executedTaskCount;
+            });
+    }
+    threadPool.add([&executedTaskCount] { ++executedTaskCount; });
+
+    BOOST_CHECK_EQUAL(threadPool.getQueueMetrics().coalescedTaskCount_, 2);
+    BOOST_CHECK_EQUAL(threadPool.getQueueMetrics().queueDepth_, 2);
+
+    blocker.release();
+    threadPool.shutdown();
+    threadPool.awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(lastValue, 3);
+    BOOST_CHECK_EQUAL(executedTaskCount, 2);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerAddsOverCapacityTest)
+{
+    TaskQueueSettings queueSettings;
+    queueSettings.capacity_ = 1;
+
+    ThreadPool threadPool(1, ThreadPoolWorkerInitializer(), queueSettings);
+
+    const std::size_t addedTaskCount = 5;
+    std::atomic_uint executedTaskCount(0);
+
+    threadPool.add([&threadPool, &executedTaskCount, addedTaskCount]
+        {
+            for (std::size_t i = 0; i < addedTaskCount; ++i) {
+                threadPool.add([&executedTaskCount] { ++executedTaskCount; });
+            }
+        });
+
+    while (executedTaskCount < addedTaskCount) {
+        std::this_thread::yield();
+    }
+
+    threadPool.shutdown();
+    threadPool.awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(executedTaskCount, addedTaskCount);
+}
+
+BOOST_AUTO_TEST_CASE(MovedTaskTest)
+{
+    ThreadPool threadPool(1);
+    IThreadPool& pool = threadPool;
+
+    WorkerBlocker blocker;
+    blocker.block(threadPool);
+
+    auto counter = std::make_shared<std::atomic_uint>(0);
+    ThreadPoolTask task = [counter] { ++*counter; };
+
+    /*
+     * The task is moved into the queue rather than copied.
+     */
+    pool.add(std::move(task));
+    BOOST_CHECK_EQUAL(counter.use_count(), 2);
+
+    /*
+     * Many more tasks than the initial ring capacity.
+     */
+    const std::size_t addedTaskCount = 3 * RingQueue<int>::DEFAULT_CAPACITY;
+    for (std::size_t i = 0; i < addedTaskCount; ++i) {
+        pool.add([counter] { ++*counter; });
+    }
+    BOOST_CHECK_EQUAL(counter.use_count(), static_cast<long>(addedTaskCount + 2));
+
+    blocker.release();
+    threadPool.shutdown();
+    threadPool.awaitTermination(5);
+
+    /*
+     * Slots of executed tasks don't keep their state.
+     */
+    BOOST_CHECK_EQUAL(*counter, addedTaskCount + 1);
+    BOOST_CHECK_EQUAL(counter.use_count(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
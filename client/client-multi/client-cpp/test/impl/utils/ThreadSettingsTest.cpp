@@ -0,0 +1,146 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "kaa/utils/ThreadSettings.hpp"
+#include "kaa/utils/ThreadPool.hpp"
+#include "kaa/context/AffinityExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(ThreadSettingsTestSuite)
+
+BOOST_AUTO_TEST_CASE(ValidationTest)
+{
+    ThreadSettings settings;
+    BOOST_CHECK_NO_THROW(validateThreadSettings(settings));
+
+    settings.policy_ = ThreadSchedulingPolicy::OTHER;
+    settings.priority_ = 100;
+    BOOST_CHECK_THROW(validateThreadSettings(settings), KaaException);
+
+    settings.priority_ = 10;
+    BOOST_CHECK_NO_THROW(validateThreadSettings(settings));
+
+#ifdef __linux__
+    settings.cpus_.push_back(CPU_SETSIZE);
+    BOOST_CHECK_THROW(validateThreadSettings(settings), KaaException);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(WorkerInitializerTest)
+{
+    std::atomic_uint initializedWorkerMask(0);
+    std::atomic_uint executedTaskCount(0);
+
+    ThreadPool pool(2, [&initializedWorkerMask] (std::size_t workerIndex)
+                           {
+                               initializedWorkerMask |= (1u << workerIndex);
+                           });
+    pool.add([&executedTaskCount] { ++executedTaskCount; });
+
+    pool.shutdown();
+    pool.awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(initializedWorkerMask, 3u);
+    BOOST_CHECK_EQUAL(executedTaskCount, 1u);
+}
+
+#ifdef __linux__
+
+BOOST_AUTO_TEST_CASE(ApplyNameAndAffinityTest)
+{
+    std::thread thread([]
+        {
+            ThreadSettings settings;
+            settings.name_ = "kaa-test-";
+            settings.cpus_.push_back(0);
+
+            BOOST_CHECK(applyThreadSettings(settings, 7));
+
+            char name[16] = { 0 };
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            BOOST_CHECK_EQUAL(std::string(name), "kaa-test-7");
+
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+            BOOST_CHECK_EQUAL(CPU_COUNT(&cpuSet), 1);
+            BOOST_CHECK(CPU_ISSET(0, &cpuSet));
+        });
+    thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(LongNameTest)
+{
+    std::thread thread([]
+        {
+            ThreadSettings settings;
+            settings.name_ = "very-long-thread-name-";
+
+            BOOST_CHECK(applyThreadSettings(settings, 12));
+
+            char name[16] = { 0 };
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            BOOST_CHECK_EQUAL(std::string(name), "very-long-thr12");
+        });
+    thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(PinnedExecutorContextTest)
+{
+    AffinityExecutorContext::PoolSettings settings;
+    settings.threadSettings_.cpus_.push_back(0);
+    settings.threadSettings_.name_ = "kaa-cb-";
+
+    AffinityExecutorContext context({}, {}, settings);
+    context.init();
+
+    std::atomic_int cpu(-1);
+    context.getCallbackExecutor().add([&cpu] { cpu = sched_getcpu(); });
+
+    context.stop();
+
+    BOOST_CHECK_EQUAL(cpu, 0);
+}
+
+#endif
+
+BOOST_AUTO_TEST_CASE(BadExecutorContextSettingsTest)
+{
+    AffinityExecutorContext::PoolSettings settings;
+    settings.threadCount_ = 0;
+    BOOST_CHECK_THROW(AffinityExecutorContext({}, {}, settings), KaaException);
+
+    settings.threadCount_ = 1;
+    settings.threadSettings_.policy_ = ThreadSchedulingPolicy::BATCH;
+    settings.threadSettings_.priority_ = -100;
+    BOOST_CHECK_THROW(AffinityExecutorContext(settings, {}, {}), KaaException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace kaa */
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/TimerService.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(TimerServiceTestSuite)
+
+BOOST_AUTO_TEST_CASE(DeadlineOrderTest)
+{
+    auto& service = TimerService::getInstance();
+    auto now = TimerService::Clock::now();
+
+    std::mutex mutex;
+    std::condition_variable onFired;
+    std::vector<int> firedTimers;
+
+    auto makeCallback = [&mutex, &onFired, &firedTimers] (int timer)
+        {
+            return [&mutex, &onFired, &firedTimers, timer]
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    firedTimers.push_back(timer);
+                    onFired.notify_one();
+                };
+        };
+
+    service.schedule(now + std::chrono::milliseconds(300), makeCallback(3));
+    service.schedule(now + std::chrono::milliseconds(100), makeCallback(1));
+    service.schedule(now + std::chrono::milliseconds(200), makeCallback(2));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    BOOST_REQUIRE(onFired.wait_for(lock, std::chrono::seconds(5), [&firedTimers] { return firedTimers.size() == 3; }));
+
+    BOOST_CHECK_EQUAL(firedTimers[0], 1);
+    BOOST_CHECK_EQUAL(firedTimers[1], 2);
+    BOOST_CHECK_EQUAL(firedTimers[2], 3);
+}
+
+BOOST_AUTO_TEST_CASE(CancelTest)
+{
+    auto& service = TimerService::getInstance();
+    std::atomic_int counter(0);
+
+    auto handle = service.schedule(TimerService::Clock::now() + std::chrono::milliseconds(100),
+                                   [&counter] { ++counter; });
+    BOOST_CHECK(service.cancel(handle));
+    BOOST_CHECK(!service.cancel(handle));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_CHECK_EQUAL(counter.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(WaitForRunningCallbackTest)
+{
+    auto& service = TimerService::getInstance();
+    std::atomic_bool isStarted(false);
+    std::atomic_bool isFinished(false);
+    int owner = 0;
+
+    auto handle = service.schedule(TimerService::Clock::now(), [&isStarted, &isFinished]
+        {
+            isStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            isFinished = true;
+        }, &owner);
+
+    while (!isStarted) {
+        std::this_thread::yield();
+    }
+
+    BOOST_CHECK(!service.cancel(handle));
+    service.waitForCallbacks(&owner);
+    BOOST_CHECK(isFinished);
+}
+
+BOOST_AUTO_TEST_CASE(ManyTimersTest)
+{
+    const int timerCount = 1000;
+
+    auto& service = TimerService::getInstance();
+    auto now = TimerService::Clock::now();
+
+    std::atomic_int counter(0);
+    for (int i = 0; i < timerCount; ++i) {
+        service.schedule(now + std::chrono::milliseconds(i % 100), [&counter] { ++counter; });
+    }
+
+    auto deadline = now + std::chrono::seconds(5);
+    while (counter < timerCount && TimerService::Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    BOOST_CHECK_EQUAL(counter.load(), timerCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/WorkStealingThreadPool.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(WorkStealingThreadPoolTestSuite)
+
+BOOST_AUTO_TEST_CASE(CreationTest)
+{
+    BOOST_CHECK_NO_THROW({ WorkStealingThreadPool pool; });
+    BOOST_CHECK_NO_THROW({ WorkStealingThreadPool pool(10); });
+
+    BOOST_CHECK_THROW({ WorkStealingThreadPool pool(0); }, std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(BadTaskTest)
+{
+    WorkStealingThreadPool pool;
+    ThreadPoolTask task;
+
+    BOOST_CHECK_THROW(pool.add(task), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TaskWithExceptionTest)
+{
+    std::atomic_uint executedTaskCount(0);
+
+    WorkStealingThreadPool pool;
+    pool.add([&executedTaskCount] { ++executedTaskCount; throw 1; });
+    pool.add([&executedTaskCount] { ++executedTaskCount; throw std::runtime_error("this is a test exception"); });
+    pool.add([&executedTaskCount] { ++executedTaskCount; });
+
+    pool.shutdown();
+    pool.awaitTermination(5);
+
+    BOOST_CHECK_EQUAL(executedTaskCount.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ManyProducersTest)
+{
+    const std::size_t workerCount = 4;
+    const std::size_t producerCount = 2 * workerCount;
+    const std::size_t tasksPerProducer = 10000;
+
+    std::atomic_uint executedTaskCount(0);
+
+    WorkStealingThreadPool pool(workerCount);
+
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&pool, &executedTaskCount, tasksPerProducer]
+            {
+                for (std::size_t j = 0; j < tasksPerProducer; ++j) {
+                    pool.add([&executedTaskCount] { ++executedTaskCount; });
+                }
+            });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    pool.shutdown();
+    pool.awaitTermination(60);
+
+    BOOST_CHECK_EQUAL(executedTaskCount.load(), producerCount * tasksPerProducer);
+}
+
+BOOST_AUTO_TEST_CASE(TasksAddedByTasksTest)
+{
+    const std::size_t fanOut = 1000;
+
+    std::mutex mutex;
+    std::condition_variable onComplete;
+    std::atomic_uint executedTaskCount(0);
+
+    WorkStealingThreadPool pool(3);
+
+    pool.add([&]
+        {
+            for (std::size_t i = 0; i < fanOut; ++i) {
+                pool.add([&]
+                    {
+                        if (++executedTaskCount == fanOut) {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            onComplete.notify_one();
+                        }
+                    });
+            }
+        });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    BOOST_CHECK(onComplete.wait_for(lock, std::chrono::seconds(30),
+                                    [&executedTaskCount, fanOut] { return executedTaskCount == fanOut; }));
+}
+
+BOOST_AUTO_TEST_CASE(SingleWorkerKeepsOrderTest)
+{
+    const std::size_t taskCount = 500;
+
+    std::vector<std::size_t> executionOrder;
+
+    WorkStealingThreadPool pool;
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        pool.add([&executionOrder, i] { executionOrder.push_back(i); });
+    }
+
+    pool.shutdown();
+    pool.awaitTermination(30);
+
+    BOOST_REQUIRE_EQUAL(executionOrder.size(), taskCount);
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        BOOST_CHECK_EQUAL(executionOrder[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownNowTest)
+{
+    std::atomic_uint executedTaskCount(0);
+    std::atomic_bool isStarted(false);
+
+    WorkStealingThreadPool pool;
+    pool.add([&executedTaskCount, &isStarted]
+        {
+            isStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            ++executedTaskCount;
+        });
+    pool.add([&executedTaskCount] { ++executedTaskCount; });
+
+    while (!isStarted) {
+        std::this_thread::yield();
+    }
+
+    pool.shutdownNow();
+
+    BOOST_CHECK_EQUAL(executedTaskCount.load(), 1);
+    BOOST_CHECK_THROW(pool.add([] {}), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(AwaitTerminationWithoutShutdownTest)
+{
+    WorkStealingThreadPool pool;
+    pool.add([] {});
+
+    BOOST_CHECK_THROW(pool.awaitTermination(5), std::logic_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,527 @@
+/*
+ * Copyright 2014-2016 CyberVision, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Fleet simulator: load-tests a Kaa server with many endpoints hosted by a single process.
+ *
+ * Usage: kaa-swarm [options]
+ *
+ *  --endpoints N          Number of simulated endpoints (default 100).
+ *  --threads N            I/O and callback threads shared by all endpoints. 0 runs every endpoint
+ *                         in poll mode on the main thread (default 0, the only mode of the single-threaded build).
+ *  --duration S           Seconds of load (default 60).
+ *  --drain S              Seconds to wait for records in flight after the load stops (default 5).
+ *  --log-rate R           Log records per second per endpoint (default 1).
+ *  --log-size B           Bytes of the log record data (default 128).
+ *  --event-rate R         Events per second per endpoint (default 0).
+ *  --event-fqn FQN        Fully qualified name of the sent events.
+ *  --event-size B         Bytes of the event data (default 64).
+ *  --user EXT_ID:TOKEN    User endpoints are attached to, events are sent only by attached endpoints.
+ *  --profile-rate R       Profile updates per second per endpoint (default 0).
+ *  --working-dir DIR      Base working directory, each endpoint gets a subdirectory (default "kaa_swarm").
+ *  --report-interval S    Seconds between progress lines on stderr, 0 disables them (default 10).
+ *
+ * The SDK is configured by the KaaDefaults of the build. Endpoints start with random phases, so their
+ * requests are spread over the interval. When the run ends, a line per endpoint is printed to stdout:
+ * sent, delivered and failed log records, the latency from adding a record to its delivery
+ * (mean, p50, p99 upper bound, max), delivered records per second, sent events, profile updates,
+ * p99 upper bound of the sync latency, bytes sent/received, connects and server failures.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+#include "kaa/KaaClientHost.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/channel/ChannelMetrics.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#include "kaa/context/PollingExecutorContext.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/profile/DefaultProfileContainer.hpp"
+#include "kaa/utils/IoServicePool.hpp"
+#ifdef KAA_USE_LOGGING
+#include "kaa/log/gen/LogDefinitions.hpp"
+#endif
+#ifdef KAA_USE_EVENTS
+#include "kaa/event/IEventManager.hpp"
+#include "kaa/event/registration/IUserAttachCallback.hpp"
+#endif
+
+#define DEFAULT_ENDPOINT_COUNT      100
+#define DEFAULT_DURATION_S          60
+#define DEFAULT_DRAIN_S             5
+#define DEFAULT_LOG_RATE            1.0
+#define DEFAULT_LOG_SIZE            128
+#define DEFAULT_EVENT_SIZE          64
+#define DEFAULT_WORKING_DIR         "kaa_swarm"
+#define DEFAULT_REPORT_INTERVAL_S   10
+
+namespace kaa {
+
+typedef std::chrono::steady_clock SwarmClock;
+
+static volatile std::sig_atomic_t isStopRequested = 0;
+
+/*
+ * The first interrupt ends the load, records in flight are still waited for. The second one ends the run.
+ */
+static void onSignal(int)
+{
+    if (isStopRequested < 2) {
+        isStopRequested = isStopRequested + 1;
+    }
+}
+
+struct SwarmOptions {
+    std::size_t endpointCount = DEFAULT_ENDPOINT_COUNT;
+    std::size_t threadCount = 0;
+    double durationS = DEFAULT_DURATION_S;
+    double drainS = DEFAULT_DRAIN_S;
+    double logRate = DEFAULT_LOG_RATE;
+    std::size_t logSize = DEFAULT_LOG_SIZE;
+    double eventRate = 0;
+    std::string eventFqn;
+    std::size_t eventSize = DEFAULT_EVENT_SIZE;
+    std::string userExternalId;
+    std::string userAccessToken;
+    double profileRate = 0;
+    std::string workingDirectory = DEFAULT_WORKING_DIR;
+    double reportIntervalS = DEFAULT_REPORT_INTERVAL_S;
+};
+
+/*
+ * Updated by the SDK threads (or the polling one) and read by the reporter.
+ */
+struct EndpointStats {
+    std::atomic<std::uint64_t> logsSent{0};
+    std::atomic<std::uint64_t> logsDelivered{0};
+    std::atomic<std::uint64_t> logsFailed{0};
+    std::atomic<std::uint64_t> eventsSent{0};
+    std::atomic<std::uint64_t> profileUpdates{0};
+    std::atomic<bool> isAttached{false};
+    LatencyHistogram logLatency;
+};
+
+struct Endpoint {
+    std::string name;
+    std::shared_ptr<IKaaClient> client;
+    std::shared_ptr<EndpointStats> stats;
+};
+
+enum class ActionType {
+    LOG,
+    EVENT,
+    PROFILE
+};
+
+struct Action {
+    SwarmClock::time_point due;
+    std::size_t endpoint;
+    ActionType type;
+
+    bool operator>(const Action& other) const { return due > other.due; }
+};
+
+typedef std::priority_queue<Action, std::vector<Action>, std::greater<Action>> ActionQueue;
+
+#ifdef KAA_USE_EVENTS
+class SwarmAttachCallback : public IUserAttachCallback {
+public:
+    SwarmAttachCallback(const std::string& endpointName, std::shared_ptr<EndpointStats> stats)
+        : endpointName_(endpointName), stats_(stats) {}
+
+    virtual void onAttachSuccess()
+    {
+        stats_->isAttached = true;
+    }
+
+    virtual void onAttachFailed(UserAttachErrorCode errorCode, const std::string& reason)
+    {
+        std::fprintf(stderr, "%s: failed to attach user (%d): %s\n",
+                     endpointName_.c_str(), static_cast<int>(errorCode), reason.c_str());
+    }
+
+private:
+    const std::string endpointName_;
+    std::shared_ptr<EndpointStats> stats_;
+};
+#endif
+
+static SwarmClock::duration toInterval(double rate)
+{
+    return std::chrono::duration_cast<SwarmClock::duration>(std::chrono::duration<double>(1.0 / rate));
+}
+
+static bool parseOptions(int argc, char *argv[], SwarmOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (i + 1 == argc) {
+            std::fprintf(stderr, "Missing value of %s\n", option.c_str());
+            return false;
+        }
+
+        const char *value = argv[++i];
+        if (option == "--endpoints") {
+            options.endpointCount = std::strtoul(value, nullptr, 10);
+        } else if (option == "--threads") {
+            options.threadCount = std::strtoul(value, nullptr, 10);
+        } else if (option == "--duration") {
+            options.durationS = std::strtod(value, nullptr);
+        } else if (option == "--drain") {
+            options.drainS = std::strtod(value, nullptr);
+        } else if (option == "--log-rate") {
+            options.logRate = std::strtod(value, nullptr);
+        } else if (option == "--log-size") {
+            options.logSize = std::strtoul(value, nullptr, 10);
+        } else if (option == "--event-rate") {
+            options.eventRate = std::strtod(value, nullptr);
+        } else if (option == "--event-fqn") {
+            options.eventFqn = value;
+        } else if (option == "--event-size") {
+            options.eventSize = std::strtoul(value, nullptr, 10);
+        } else if (option == "--user") {
+            const char *separator = std::strchr(value, ':');
+            if (!separator) {
+                std::fprintf(stderr, "Expected EXT_ID:TOKEN for --user\n");
+                return false;
+            }
+            options.userExternalId.assign(value, separator);
+            options.userAccessToken = separator + 1;
+        } else if (option == "--profile-rate") {
+            options.profileRate = std::strtod(value, nullptr);
+        } else if (option == "--working-dir") {
+            options.workingDirectory = value;
+        } else if (option == "--report-interval") {
+            options.reportIntervalS = std::strtod(value, nullptr);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return false;
+        }
+    }
+
+    if (!options.endpointCount) {
+        std::fprintf(stderr, "At least one endpoint is needed\n");
+        return false;
+    }
+
+#ifdef KAA_USE_SINGLE_THREAD
+    if (options.threadCount) {
+        std::fprintf(stderr, "Threads aren't available in the single-threaded build, use --threads 0\n");
+        return false;
+    }
+#endif
+
+#ifndef KAA_USE_LOGGING
+    options.logRate = 0;
+#endif
+
+#ifdef KAA_USE_EVENTS
+    if (options.eventRate > 0 && (options.eventFqn.empty() || options.userExternalId.empty())) {
+        std::fprintf(stderr, "Events need --event-fqn and --user\n");
+        return false;
+    }
+#else
+    if (options.eventRate > 0) {
+        std::fprintf(stderr, "Events are disabled in this build\n");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+static void runAction(const SwarmOptions& options, Endpoint& endpoint, ActionType type,
+                      const std::string& logData, const std::vector<std::uint8_t>& eventData)
+{
+    switch (type) {
+    case ActionType::LOG: {
+#ifdef KAA_USE_LOGGING
+        KaaUserLogRecord record;
+        record.logdata = logData;
+
+        auto stats = endpoint.stats;
+        auto added = SwarmClock::now();
+        endpoint.client->addLogRecord(record).then([stats, added] (KaaFuture<RecordInfo> delivered)
+                {
+                    try {
+                        delivered.get();
+                        stats->logLatency.record(SwarmClock::now() - added);
+                        ++stats->logsDelivered;
+                    } catch (...) {
+                        ++stats->logsFailed;
+                    }
+                });
+        ++endpoint.stats->logsSent;
+#endif
+        break;
+    }
+    case ActionType::EVENT:
+#ifdef KAA_USE_EVENTS
+        if (endpoint.stats->isAttached) {
+            endpoint.client->getEventManager().produceEvent(options.eventFqn, eventData.data(), eventData.size(),
+                                                            boost::string_ref(), TransactionIdPtr());
+            ++endpoint.stats->eventsSent;
+        }
+#endif
+        break;
+    case ActionType::PROFILE:
+        endpoint.client->updateProfile();
+        ++endpoint.stats->profileUpdates;
+        break;
+    }
+}
+
+static void printProgress(const std::vector<Endpoint>& endpoints, double elapsedS)
+{
+    std::uint64_t logsSent = 0;
+    std::uint64_t logsDelivered = 0;
+    std::uint64_t logsFailed = 0;
+    std::uint64_t eventsSent = 0;
+    std::size_t attachedCount = 0;
+
+    for (const auto& endpoint : endpoints) {
+        logsSent += endpoint.stats->logsSent;
+        logsDelivered += endpoint.stats->logsDelivered;
+        logsFailed += endpoint.stats->logsFailed;
+        eventsSent += endpoint.stats->eventsSent;
+        attachedCount += endpoint.stats->isAttached ? 1 : 0;
+    }
+
+    std::fprintf(stderr, "[%8.1fs] logs sent %llu, delivered %llu (%.1f/s), failed %llu; events %llu; attached %zu/%zu\n",
+                 elapsedS, (unsigned long long)logsSent, (unsigned long long)logsDelivered,
+                 elapsedS > 0 ? logsDelivered / elapsedS : 0.0, (unsigned long long)logsFailed,
+                 (unsigned long long)eventsSent, attachedCount, endpoints.size());
+}
+
+static void printReport(const std::vector<Endpoint>& endpoints, double loadS)
+{
+    std::printf("%-12s %10s %10s %8s %10s %8s %8s %10s %10s %8s %8s %8s %12s %12s %8s %8s\n",
+                "endpoint", "logs_sent", "delivered", "failed", "lat_mean_us", "p50_ms", "p99_ms", "max_us",
+                "logs/s", "events", "profile", "sync_p99", "bytes_sent", "bytes_recv", "connects", "failures");
+
+    LatencyHistogramSnapshot totalLatency;
+    ChannelMetricsSnapshot totalChannels;
+    std::uint64_t totalDelivered = 0;
+
+    for (const auto& endpoint : endpoints) {
+        const auto& stats = *endpoint.stats;
+        auto latency = stats.logLatency.getSnapshot();
+        auto channels = endpoint.client->getMetrics().total_;
+
+        totalLatency += latency;
+        totalChannels += channels;
+        totalDelivered += stats.logsDelivered;
+
+        std::printf("%-12s %10llu %10llu %8llu %10llu %8llu %8llu %10llu %10.2f %8llu %8llu %8llu %12llu %12llu %8llu %8llu\n",
+                    endpoint.name.c_str(),
+                    (unsigned long long)stats.logsSent, (unsigned long long)stats.logsDelivered,
+                    (unsigned long long)stats.logsFailed, (unsigned long long)latency.getMeanUs(),
+                    (unsigned long long)latency.getQuantileUpperBoundMs(0.5),
+                    (unsigned long long)latency.getQuantileUpperBoundMs(0.99), (unsigned long long)latency.maxUs_,
+                    loadS > 0 ? stats.logsDelivered / loadS : 0.0,
+                    (unsigned long long)stats.eventsSent, (unsigned long long)stats.profileUpdates,
+                    (unsigned long long)channels.syncLatency_.getQuantileUpperBoundMs(0.99),
+                    (unsigned long long)channels.bytesSent_, (unsigned long long)channels.bytesReceived_,
+                    (unsigned long long)channels.connects_, (unsigned long long)channels.serverFailures_);
+    }
+
+    std::printf("\ntotal: %zu endpoints, %llu records delivered (%.1f/s), latency mean %llu us, p50 <= %llu ms, "
+                "p99 <= %llu ms, max %llu us; sync p99 <= %llu ms; %llu bytes sent, %llu received\n",
+                endpoints.size(), (unsigned long long)totalDelivered, loadS > 0 ? totalDelivered / loadS : 0.0,
+                (unsigned long long)totalLatency.getMeanUs(),
+                (unsigned long long)totalLatency.getQuantileUpperBoundMs(0.5),
+                (unsigned long long)totalLatency.getQuantileUpperBoundMs(0.99),
+                (unsigned long long)totalLatency.maxUs_,
+                (unsigned long long)totalChannels.syncLatency_.getQuantileUpperBoundMs(0.99),
+                (unsigned long long)totalChannels.bytesSent_, (unsigned long long)totalChannels.bytesReceived_);
+}
+
+static int runSwarm(const SwarmOptions& options)
+{
+    if (mkdir(options.workingDirectory.c_str(), 0755) && errno != EEXIST) {
+        std::fprintf(stderr, "Failed to create working directory '%s': %s\n",
+                     options.workingDirectory.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    KaaClientProperties properties;
+    properties.setWorkingDirectoryPath(options.workingDirectory);
+
+    /*
+     * In poll mode the executors and I/O of all endpoints are run by the loop below.
+     */
+    std::shared_ptr<PollingExecutorContext> pollingContext;
+    IExecutorContextPtr executorContext;
+    IoServicePoolPtr ioServicePool;
+
+    if (!options.threadCount) {
+        pollingContext = std::make_shared<PollingExecutorContext>();
+        executorContext = pollingContext;
+        ioServicePool = pollingContext->getIoServicePool();
+    } else {
+        executorContext = std::make_shared<SimpleExecutorContext>(1, 1, options.threadCount);
+        ioServicePool = std::make_shared<IoServicePool>(options.threadCount);
+    }
+
+    KaaClientHost host(properties, executorContext, ioServicePool);
+
+    std::vector<Endpoint> endpoints;
+    endpoints.reserve(options.endpointCount);
+    for (std::size_t i = 0; i < options.endpointCount; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "ep%06zu", i);
+
+        Endpoint endpoint;
+        endpoint.name = name;
+        endpoint.client = host.addEndpoint(name);
+        endpoint.stats = std::make_shared<EndpointStats>();
+        if (options.profileRate > 0) {
+            endpoint.client->setProfileContainer(std::make_shared<DefaultProfileContainer>());
+        }
+        endpoints.push_back(std::move(endpoint));
+    }
+
+    host.startAll();
+
+#ifdef KAA_USE_EVENTS
+    if (options.eventRate > 0) {
+        for (auto& endpoint : endpoints) {
+            endpoint.client->attachUser(options.userExternalId, options.userAccessToken,
+                                        std::make_shared<SwarmAttachCallback>(endpoint.name, endpoint.stats));
+        }
+    }
+#endif
+
+    const std::string logData(options.logSize, 'x');
+    const std::vector<std::uint8_t> eventData(options.eventSize, 0x5A);
+
+    const std::pair<ActionType, double> rates[] = {
+        { ActionType::LOG, options.logRate },
+        { ActionType::EVENT, options.eventRate },
+        { ActionType::PROFILE, options.profileRate }
+    };
+
+    const auto start = SwarmClock::now();
+    const auto loadEnd = start + std::chrono::duration_cast<SwarmClock::duration>(
+                                                std::chrono::duration<double>(options.durationS));
+    const auto drainEnd = loadEnd + std::chrono::duration_cast<SwarmClock::duration>(
+                                                std::chrono::duration<double>(options.drainS));
+    const auto reportInterval = std::chrono::duration_cast<SwarmClock::duration>(
+                                                std::chrono::duration<double>(options.reportIntervalS));
+
+    std::mt19937 random(std::random_device{}());
+    std::uniform_real_distribution<double> phase(0.0, 1.0);
+
+    ActionQueue actions;
+    for (std::size_t i = 0; i < endpoints.size(); ++i) {
+        for (const auto& rate : rates) {
+            if (rate.second > 0) {
+                auto offset = std::chrono::duration_cast<SwarmClock::duration>(toInterval(rate.second) * phase(random));
+                actions.push({ start + offset, i, rate.first });
+            }
+        }
+    }
+
+    auto nextReport = start + reportInterval;
+    auto loadStop = loadEnd;
+
+    for (auto now = start; now < drainEnd && isStopRequested < 2; now = SwarmClock::now()) {
+        if (isStopRequested && loadStop > now) {
+            loadStop = now;
+        }
+
+        const bool isLoading = now < loadStop;
+        while (isLoading && !actions.empty() && actions.top().due <= now) {
+            Action action = actions.top();
+            actions.pop();
+
+            try {
+                runAction(options, endpoints[action.endpoint], action.type, logData, eventData);
+            } catch (std::exception& e) {
+                std::fprintf(stderr, "%s: %s\n", endpoints[action.endpoint].name.c_str(), e.what());
+            }
+
+            for (const auto& rate : rates) {
+                if (rate.first == action.type) {
+                    action.due += toInterval(rate.second);
+                }
+            }
+            actions.push(action);
+        }
+
+        if (reportInterval.count() > 0 && now >= nextReport) {
+            printProgress(endpoints, std::chrono::duration<double>(now - start).count());
+            nextReport += reportInterval;
+        }
+
+        auto wakeUp = isLoading ? std::min(loadStop, drainEnd) : drainEnd;
+        if (isLoading && !actions.empty()) {
+            wakeUp = std::min(wakeUp, actions.top().due);
+        }
+        if (reportInterval.count() > 0) {
+            wakeUp = std::min(wakeUp, nextReport);
+        }
+
+        auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(wakeUp - SwarmClock::now());
+        timeout = std::max(timeout, std::chrono::milliseconds::zero());
+        if (pollingContext) {
+            pollingContext->poll(timeout);
+        } else {
+            std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(100)));
+        }
+    }
+
+    printReport(endpoints, std::chrono::duration<double>(std::min(loadStop, loadEnd) - start).count());
+    return 0;
+}
+
+} /* namespace kaa */
+
+int main(int argc, char *argv[])
+{
+    kaa::SwarmOptions options;
+    if (!kaa::parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s [--endpoints N] [--threads N] [--duration S] [--drain S] "
+                     "[--log-rate R] [--log-size B] [--event-rate R --event-fqn FQN --user EXT_ID:TOKEN] "
+                     "[--event-size B] [--profile-rate R] [--working-dir DIR] [--report-interval S]\n", argv[0]);
+        return 1;
+    }
+
+    std::signal(SIGINT, kaa::onSignal);
+    std::signal(SIGTERM, kaa::onSignal);
+
+    try {
+        return kaa::runSwarm(options);
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "kaa-swarm failed: %s\n", e.what());
+        return 1;
+    }
+}
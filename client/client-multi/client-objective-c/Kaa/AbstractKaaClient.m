@@ -293,6 +293,10 @@
     [self.notificationManager removeNotificationDelegate:delegate forTopicId:topicId];
 }
 
+- (void)setNotificationDelegateQueue:(dispatch_queue_t)queue {
+    [self.notificationManager setNotificationDelegateQueue:queue];
+}
+
 - (void)subscribeToTopicWithId:(int64_t)topicId {
     [self subscribeToTopicWithId:topicId forceSync:FORSE_SYNC];
 }
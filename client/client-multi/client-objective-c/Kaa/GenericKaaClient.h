@@ -130,6 +130,14 @@
  */
 - (void)removeNotificationDelegate:(id<NotificationDelegate>)delegate forTopicId:(int64_t)topicId;
 
+/**
+ * Set the queue notification and topic list delegates are called on.<br>
+ * Notifications of the same topic are delivered in the order they were received.
+ *
+ * @param queue Queue to call delegates on, nil to restore the default one.
+ */
+- (void)setNotificationDelegateQueue:(dispatch_queue_t)queue;
+
 /**
  * Subscribe to notifications relating to the specified optional topic.
  * @param topicId ID of a optional topic.
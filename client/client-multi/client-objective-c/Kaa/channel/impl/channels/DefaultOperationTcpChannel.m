@@ -32,7 +32,9 @@ typedef enum {
 #define TAG                 @"DefaultOperationTcpChannel >>>"
 #define CHANNEL_TIMEOUT     200
 #define PING_TIMEOUT_SEC    (CHANNEL_TIMEOUT / 2)
+#define PING_LEEWAY_SEC     (PING_TIMEOUT_SEC / 10)
 #define MAX_THREADS_COUNT   2
+#define READ_BUFFER_SIZE    4096
 #define CHANNEL_ID          @"default_operation_tcp_channel"
 
 @interface OpenConnectionTask : NSOperation
@@ -57,8 +59,9 @@ typedef enum {
 @property (nonatomic, strong) volatile ConnectivityChecker *checker;
 @property (nonatomic, strong) KAAMessageFactory *messageFactory;
 @property (nonatomic) volatile BOOL isOpenConnectionScheduled;
-@property (nonatomic) volatile BOOL isPingTaskCancelled;
+@property (nonatomic, strong) dispatch_source_t pingTimer;
 @property (nonatomic, strong) NSOperationQueue *executor;
+@property (nonatomic, strong) dispatch_queue_t ioQueue; //socket events, reads and writes are serialized on it
 @property (nonatomic, strong) KAASocket *socket;//volatile
 @property (nonatomic, weak) id<FailureDelegate> failureDelegate;
 
@@ -73,6 +76,7 @@ typedef enum {
 - (void)openConnection;
 - (void)scheduleOpenConnectionTaskWithRetryPeriod:(int64_t)retryPeriod;
 - (void)schedulePingTask;
+- (void)cancelPingTask;
 - (void)destroyExecutor;
 
 @end
@@ -93,6 +97,7 @@ typedef enum {
                                 @(TRANSPORT_TYPE_LOGGING)       : @(CHANNEL_DIRECTION_BIDIRECTIONAL)
                                 };
         self.channelState = CHANNEL_STATE_CLOSED;
+        self.ioQueue = dispatch_queue_create("org.kaaproject.kaa.channel.tcp.io", DISPATCH_QUEUE_SERIAL);
         self.messageFactory = [[KAAMessageFactory alloc] init];
         self.state = state;
         self.failoverManager = failoverMgr;
@@ -178,11 +183,23 @@ typedef enum {
 }
 
 - (void)sendFrame:(KAAMqttFrame *)frame {
-    if (self.socket) {
-        @synchronized(self.socket) {
-            [self.socket.output write:[[frame getFrame] bytes] maxLength:[frame getFrame].length];
-        }
+    KAASocket *socket = self.socket;
+    if (!socket) {
+        return;
     }
+    NSData *data = [frame getFrame];
+    dispatch_async(self.ioQueue, ^{
+        const uint8_t *bytes = [data bytes];
+        NSUInteger written = 0;
+        while (written < data.length) {
+            NSInteger result = [socket.output write:bytes + written maxLength:data.length - written];
+            if (result <= 0) {
+                DDLogWarn(@"%@ Failed to write %li bytes to output stream", TAG, (long)(data.length - written));
+                break;
+            }
+            written += result;
+        }
+    });
 }
 
 - (void)sendPingRequest {
@@ -217,9 +234,7 @@ typedef enum {
 
 - (void)closeConnection {
     @synchronized(self) {
-        if (!self.isPingTaskCancelled) {
-            self.isPingTaskCancelled = YES;
-        }
+        [self cancelPingTask];
         if (!self.socket) {
             return;
         }
@@ -231,20 +246,25 @@ typedef enum {
             DDLogError(@"%@ Failed to send Disconnect to server: %@. Reason: %@", TAG, ex.name, ex.reason);
         }
         @finally {
-            @try {
-                [self.socket.input removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
-                [self.socket close];
-            }
-            @catch (NSException *exception) {
-                DDLogError(@"%@ Failed to close socket: %@. Reason: %@", TAG, exception.name, exception.reason);
+            KAASocket *socket = self.socket;
+            KAAFramer *framer = self.messageFactory.framer;
+            self.socket = nil;
+            if (self.channelState != CHANNEL_STATE_SHUTDOWN) {
+                self.channelState = CHANNEL_STATE_CLOSED;
             }
-            @finally {
-                self.socket = nil;
-                [self.messageFactory.framer flush];
-                if (self.channelState != CHANNEL_STATE_SHUTDOWN) {
-                    self.channelState = CHANNEL_STATE_CLOSED;
+            // Closing after the pending writes, Disconnect included, are done
+            dispatch_async(self.ioQueue, ^{
+                @try {
+                    CFReadStreamSetDispatchQueue((__bridge CFReadStreamRef)socket.input, NULL);
+                    [socket close];
                 }
-            }
+                @catch (NSException *exception) {
+                    DDLogError(@"%@ Failed to close socket: %@. Reason: %@", TAG, exception.name, exception.reason);
+                }
+                @finally {
+                    [framer flush];
+                }
+            });
         }
     }
 }
@@ -261,7 +281,7 @@ typedef enum {
         self.socket = [self createSocket];
         
         [self.socket.input setDelegate:self];
-        [self.socket.input scheduleInRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
+        CFReadStreamSetDispatchQueue((__bridge CFReadStreamRef)self.socket.input, self.ioQueue);
         
         [self.socket open];
     }
@@ -271,8 +291,6 @@ typedef enum {
     switch (eventCode) {
         case NSStreamEventOpenCompleted:
         {
-            self.isPingTaskCancelled = NO;
-            
             __weak typeof(self) weakSelf = self;
             [self.executor addOperationWithBlock:^{
                 [weakSelf sendConnect];
@@ -289,26 +307,27 @@ typedef enum {
             break;
         case NSStreamEventHasBytesAvailable:
         {
-            __weak typeof(self) weakSelf = self;
+            // Stream events are delivered on the I/O queue, so the data is read and framed right here
+            if (aStream != self.socket.input) {
+                DDLogWarn(@"%@ Found outdated ref to socket stream", TAG);
+                return;
+            }
             
-            [self.executor addOperationWithBlock:^{
-                
-                if (aStream != weakSelf.socket.input) {
-                    DDLogWarn(@"%@ Found outdated ref to socket stream", TAG);
-                    return;
-                }
-                
-                uint8_t buffer[1024];
-                while ([weakSelf.socket.input hasBytesAvailable]) {
-                    long read = [weakSelf.socket.input read:buffer maxLength:sizeof(buffer)];
-                    if (read > 0) {
-                        DDLogVerbose(@"%@ Read %li bytes from input stream", TAG, read);
-                        [weakSelf.messageFactory.framer pushBytes:[NSMutableData dataWithBytes:buffer length:read]];
-                    } else if (read == -1) {
-                        DDLogInfo(@"%@ Channel [%@] received end of stream", TAG, [weakSelf getId]);
+            NSInputStream *input = (NSInputStream *)aStream;
+            uint8_t buffer[READ_BUFFER_SIZE];
+            while ([input hasBytesAvailable]) {
+                long read = [input read:buffer maxLength:sizeof(buffer)];
+                if (read > 0) {
+                    DDLogVerbose(@"%@ Read %li bytes from input stream", TAG, read);
+                    // Frames copy the bytes they consume, so the stack buffer is wrapped without copying
+                    [self.messageFactory.framer pushBytes:[NSMutableData dataWithBytesNoCopy:buffer length:read freeWhenDone:NO]];
+                } else {
+                    if (read == -1) {
+                        DDLogInfo(@"%@ Channel [%@] received end of stream", TAG, [self getId]);
                     }
+                    break;
                 }
-            }];
+            }
         }
             break;
         default:
@@ -372,29 +391,37 @@ typedef enum {
 }
 
 - (void)schedulePingTask {
-    self.isPingTaskCancelled = NO;
-    if (self.executor) {
-        [self.executor addOperationWithBlock:^{
-            dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)PING_TIMEOUT_SEC * NSEC_PER_SEC);
-            dispatch_after(time, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
-                @try {
-                    DDLogInfo(@"%@ Executing ping task for channel [%@]", TAG, [self getId]);
-                    if (self.isPingTaskCancelled)   {
-                        DDLogInfo(@"%@ Can't schedule new ping task for channel [%@]. Task was cancelled.", TAG, [self getId]);
-                    } else {
-                        [self sendPingRequest];
-                        [self schedulePingTask];
-                    }
-                }
-                @catch (NSException *ex) {
-                    DDLogError(@"%@ Failed to send ping request for channel [%@]: %@. Reason: %@", TAG, [self getId], ex.name, ex.reason);
-                    [self onServerFailed];
-                }
-            });
-        }];
+    @synchronized(self) {
+        [self cancelPingTask];
+        
+        // Leeway lets the system coalesce the ping wakeup with other timers
+        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.ioQueue);
+        dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)PING_TIMEOUT_SEC * NSEC_PER_SEC),
+                                  (uint64_t)PING_TIMEOUT_SEC * NSEC_PER_SEC, (uint64_t)PING_LEEWAY_SEC * NSEC_PER_SEC);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(timer, ^{
+            @try {
+                DDLogInfo(@"%@ Executing ping task for channel [%@]", TAG, [weakSelf getId]);
+                [weakSelf sendPingRequest];
+            }
+            @catch (NSException *ex) {
+                DDLogError(@"%@ Failed to send ping request for channel [%@]: %@. Reason: %@", TAG, [weakSelf getId], ex.name, ex.reason);
+                [weakSelf onServerFailed];
+            }
+        });
+        self.pingTimer = timer;
+        dispatch_resume(timer);
         DDLogDebug(@"%@ Submitting a ping task for channel [%@]", TAG, [self getId]);
-    } else {
-        DDLogWarn(@"%@ Executor is nil, can't schedule ping connection task", TAG);
+    }
+}
+
+- (void)cancelPingTask {
+    @synchronized(self) {
+        if (self.pingTimer) {
+            DDLogDebug(@"%@ Cancelling ping task for channel [%@]", TAG, [self getId]);
+            dispatch_source_cancel(self.pingTimer);
+            self.pingTimer = nil;
+        }
     }
 }
 
@@ -124,7 +124,7 @@
     while (pos < bytes.length && !self.frameDecodeComplete) {
         if (self.currentState == FRAME_PARSING_STATE_PROCESSING_PAYLOAD) {
             int32_t bytesToCopy = (int32_t)((self.remainingLength > bytes.length - pos) ? bytes.length - pos : self.remainingLength);
-            [self.buffer appendData:[bytes subdataWithRange:NSMakeRange(pos, bytesToCopy)]];
+            [self.buffer appendBytes:rawBytes + pos length:bytesToCopy];
             self.bufferPosition += bytesToCopy;
             pos += bytesToCopy;
             self.remainingLength -= bytesToCopy;
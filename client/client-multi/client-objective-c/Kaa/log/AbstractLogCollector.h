@@ -23,6 +23,10 @@
 
 /**
  * Designed to be abstraction layer for LogCollector.
+ *
+ * While the application is in background, logs aren't uploaded on strategy decisions and no upload checks
+ * are scheduled. Instead, buffered logs are flushed at once when the application enters background,
+ * for as long as the system grants background execution time.
  */
 @interface AbstractLogCollector : NSObject <LogProcessor,LogCollector>
 
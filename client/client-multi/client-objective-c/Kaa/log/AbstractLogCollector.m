@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#import <UIKit/UIKit.h>
 #import "AbstractLogCollector.h"
 #import "DefaultLogUploadStrategy.h"
 #import "MemLogStorage.h"
@@ -41,9 +42,16 @@
 @property (nonatomic, strong) NSObject *uploadCheckGuard;   //variable to sync
 @property (nonatomic, weak) id<LogDeliveryDelegate> logDeliveryDelegate;
 @property (nonatomic, strong) NSMutableDictionary *deliveryRunnerDictionary; //<NSNumber<int32_t>, NSArray<BucketRunner>> as key-value
+@property (atomic) BOOL isInBackground;
+@property (nonatomic) UIBackgroundTaskIdentifier backgroundUploadTask;
 
 - (void)checkDeliveryTimeoutForBucketId:(int32_t)bucketId;
 - (void)processUploadDecision:(LogUploadStrategyDecision)decision;
+- (void)processBackgroundUpload;
+- (void)beginBackgroundUpload;
+- (void)endBackgroundUpload;
+- (void)applicationDidEnterBackground:(NSNotification *)notification;
+- (void)applicationWillEnterForeground:(NSNotification *)notification;
 
 @end
 
@@ -78,10 +86,26 @@
         self.logDeliveryDelegate = nil;
         self.bucketInfoDictionary = [NSMutableDictionary dictionary];
         self.deliveryRunnerDictionary = [NSMutableDictionary dictionary];
+        self.isInBackground = NO;
+        self.backgroundUploadTask = UIBackgroundTaskInvalid;
+        
+        NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+        [notificationCenter addObserver:self
+                               selector:@selector(applicationDidEnterBackground:)
+                                   name:UIApplicationDidEnterBackgroundNotification
+                                 object:nil];
+        [notificationCenter addObserver:self
+                               selector:@selector(applicationWillEnterForeground:)
+                                   name:UIApplicationWillEnterForegroundNotification
+                                 object:nil];
     }
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)setLogDeliveryDelegate:(id<LogDeliveryDelegate>)logDeliveryDelegate {
     _logDeliveryDelegate = logDeliveryDelegate;
 }
@@ -204,6 +228,7 @@
 }
 
 - (void)stop {
+    [self endBackgroundUpload];
     [self.storage close];
     DDLogDebug(@"%@ Clearing timeouts map", TAG);
     for (NSOperation *timeout in self.timeouts.allValues) {
@@ -213,6 +238,10 @@
 }
 
 - (void)processUploadDecision:(LogUploadStrategyDecision)decision {
+    if (self.isInBackground) {
+        [self processBackgroundUpload];
+        return;
+    }
     switch (decision) {
         case LOG_UPLOAD_STRATEGY_DECISION_UPLOAD:
             if ([self isUploadAllowed]) {
@@ -331,6 +360,75 @@
     });
 }
 
+- (void)processBackgroundUpload {
+    @synchronized(self) {
+        if (self.backgroundUploadTask == UIBackgroundTaskInvalid) {
+            DDLogVerbose(@"%@ Application is in background, log upload is postponed", TAG);
+            return;
+        }
+        if ([[self.storage getStatus] getRecordCount] > 0) {
+            if ([self isUploadAllowed]) {
+                DDLogVerbose(@"%@ Uploading buffered logs in background", TAG);
+                [self.transport sync];
+            }
+        } else if (self.timeouts.count == 0) {
+            DDLogInfo(@"%@ All buffered logs were uploaded in background", TAG);
+            [self endBackgroundUpload];
+        }
+    }
+}
+
+- (void)beginBackgroundUpload {
+    @synchronized(self) {
+        if (self.backgroundUploadTask != UIBackgroundTaskInvalid) {
+            return;
+        }
+        __weak typeof(self) weakSelf = self;
+        self.backgroundUploadTask = [[UIApplication sharedApplication] beginBackgroundTaskWithName:@"KaaLogUpload" expirationHandler:^{
+            DDLogWarn(@"%@ Background time expired, remaining logs will be uploaded in foreground", TAG);
+            [weakSelf endBackgroundUpload];
+        }];
+        if (self.backgroundUploadTask == UIBackgroundTaskInvalid) {
+            DDLogWarn(@"%@ Background time isn't granted, log upload is postponed", TAG);
+            return;
+        }
+        DDLogInfo(@"%@ Flushing buffered logs in background", TAG);
+    }
+    [self processBackgroundUpload];
+}
+
+- (void)endBackgroundUpload {
+    @synchronized(self) {
+        if (self.backgroundUploadTask != UIBackgroundTaskInvalid) {
+            [[UIApplication sharedApplication] endBackgroundTask:self.backgroundUploadTask];
+            self.backgroundUploadTask = UIBackgroundTaskInvalid;
+        }
+    }
+}
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification {
+#pragma unused(notification)
+    DDLogDebug(@"%@ Application did enter background", TAG);
+    self.isInBackground = YES;
+    __weak typeof(self) weakSelf = self;
+    [[self.executorContext getApiExecutor] addOperationWithBlock:^{
+        if ([[weakSelf.storage getStatus] getRecordCount] > 0) {
+            [weakSelf beginBackgroundUpload];
+        }
+    }];
+}
+
+- (void)applicationWillEnterForeground:(NSNotification *)notification {
+#pragma unused(notification)
+    DDLogDebug(@"%@ Application will enter foreground", TAG);
+    self.isInBackground = NO;
+    [self endBackgroundUpload];
+    __weak typeof(self) weakSelf = self;
+    [[self.executorContext getApiExecutor] addOperationWithBlock:^{
+        [weakSelf uploadIfNeeded];
+    }];
+}
+
 - (BOOL)isUploadAllowed {
     if (self.timeouts.count >= [self.strategy getMaxParallelUploads]) {
         DDLogDebug(@"%@ Ignore log upload: too much pending requests. Max allowed: %lld", TAG, [self.strategy getMaxParallelUploads]);
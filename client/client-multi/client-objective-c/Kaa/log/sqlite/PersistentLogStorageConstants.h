@@ -34,6 +34,13 @@
 #define STORAGE_BUCKET_SIZE         @"bucket_size"
 #define STORAGE_RECORD_COUNT        @"record_count"
 
+#define KAA_ENABLE_WAL_JOURNAL_MODE     @"PRAGMA journal_mode = WAL"
+#define KAA_SET_NORMAL_SYNCHRONOUS_MODE @"PRAGMA synchronous = NORMAL"
+
+#define KAA_BEGIN_TRANSACTION       @"BEGIN TRANSACTION"
+#define KAA_COMMIT_TRANSACTION      @"COMMIT TRANSACTION"
+#define KAA_ROLLBACK_TRANSACTION    @"ROLLBACK TRANSACTION"
+
 #define KAA_CREATE_LOG_TABLE_IF_NOT_EXISTS \
 [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@ (\
 %@ INTEGER PRIMARY KEY AUTOINCREMENT, \
@@ -45,9 +45,35 @@
  */
 @property (nonatomic, strong) NSMutableDictionary *consumedMemoryMap;
 
+/**
+ * All database access after opening goes through this serial queue. Added records are
+ * queued in memory and inserted in batches, one transaction per batch, so the caller
+ * of addLogRecord: doesn't wait for SQLite.
+ */
+@property (nonatomic, strong) dispatch_queue_t writeQueue;
+
+/**
+ * Format: NSArray of <bucket id wrapped with NSNumber, record data>.
+ */
+@property (nonatomic, strong) NSMutableArray *pendingRecords;
+@property (nonatomic) BOOL flushScheduled;
+
+/**
+ * Format: <NSString, sqlite3_stmt *> as key-value, the statement is wrapped with NSValue;
+ * key:     query;
+ * value:   prepared statement, reset after each use.
+ */
+@property (nonatomic, strong) NSMutableDictionary *cachedStatements;
+
 - (void)openDBAtPath:(NSString *)path;
 - (void)executeQuery:(NSString *)query;
+- (BOOL)tryExecuteQuery:(NSString *)query;
 - (sqlite3_stmt *)statementForQuery:(NSString *)query;
+- (sqlite3_stmt *)cachedStatementForQuery:(NSString *)query;
+- (void)releaseCachedStatement:(sqlite3_stmt *)statement;
+
+- (void)flushPendingRecords;
+- (int32_t)selectMinBucketId;
 
 - (void)truncateIfBucketSizeIncompatible;
 - (void)retrieveConsumedSizeAndVolume;
@@ -74,6 +100,9 @@
     if (self) {
         
         self.consumedMemoryMap = [NSMutableDictionary dictionary];
+        self.pendingRecords = [NSMutableArray array];
+        self.cachedStatements = [NSMutableDictionary dictionary];
+        self.writeQueue = dispatch_queue_create("org.kaaproject.kaa.log.sqlite", DISPATCH_QUEUE_SERIAL);
         self.maxBucketSize = bucketSize;
         self.maxBucketRecordCount = bucketRecordCount;
         self.currentBucketId = 1;
@@ -101,11 +130,12 @@
 }
 
 -(BucketInfo *)addLogRecord:(LogRecord *)record {
+    BucketInfo *bucketInfo = nil;
+    BOOL scheduleFlush = NO;
+    
     @synchronized(self) {
         DDLogVerbose(@"%@ Adding new log record", TAG);
         
-        sqlite3_stmt *statement = [self statementForQuery:KAA_INSERT_NEW_RECORD];
-        
         int64_t remainingSize = self.maxBucketSize - self.currentBucketSize;
         int64_t remainingRecordCount = self.maxBucketRecordCount - self.currentRecordCount;
         
@@ -113,55 +143,60 @@
             [self moveToNextBucket];
         }
         
-        sqlite3_bind_int64(statement, 1, self.currentBucketId);
-        sqlite3_bind_blob(statement, 2, [record.data bytes], (int32_t)record.data.length, SQLITE_TRANSIENT);
+        [self.pendingRecords addObject:@[@(self.currentBucketId), [record.data copy]]];
         
-        if (sqlite3_step(statement) == SQLITE_DONE) {
-            
-            int64_t insertedRowId = sqlite3_last_insert_rowid(self.database);
-            if (insertedRowId >= 0) {
-                self.currentBucketSize += [record getSize];
-                self.currentRecordCount++;
-                
-                self.unmarkedConsumedSize += [record getSize];
-                self.totalRecordCount++;
-                self.unmarkedRecordCount++;
-                
-                DDLogInfo(@"%@ Added a new log record, total record count: %lld unmarked record count: %lld",
-                          TAG, self.totalRecordCount, self.unmarkedRecordCount);
-            } else {
-                DDLogWarn(@"%@ No log record was added: %lld", TAG, insertedRowId);
-            }
-            
-        } else {
-            DDLogError(@"%@ Can't add new log record", TAG);
-        }
+        self.currentBucketSize += [record getSize];
+        self.currentRecordCount++;
         
-        sqlite3_finalize(statement);
+        self.unmarkedConsumedSize += [record getSize];
+        self.totalRecordCount++;
+        self.unmarkedRecordCount++;
+        
+        DDLogInfo(@"%@ Added a new log record, total record count: %lld unmarked record count: %lld",
+                  TAG, self.totalRecordCount, self.unmarkedRecordCount);
         
-        return [[BucketInfo alloc] initWithBucketId:self.currentBucketId logCount:self.currentRecordCount];
+        scheduleFlush = !self.flushScheduled;
+        self.flushScheduled = YES;
+        bucketInfo = [[BucketInfo alloc] initWithBucketId:self.currentBucketId logCount:self.currentRecordCount];
     }
+    
+    /*
+     * Records added while a batch is being written are written by the next one.
+     */
+    if (scheduleFlush) {
+        dispatch_async(self.writeQueue, ^{
+            [self flushPendingRecords];
+        });
+    }
+    
+    return bucketInfo;
 }
 
 - (LogBucket *)getNextBucket {
-    @synchronized(self) {
+    __block LogBucket *logBucket = nil;
+    
+    dispatch_sync(self.writeQueue, ^{
         DDLogDebug(@"%@ Creating new log bucket", TAG);
         
-        LogBucket *logBucket = nil;
         NSMutableArray *logRecords = [NSMutableArray array];
         int32_t bucketId = 0;
         
-        sqlite3_stmt *statement = [self statementForQuery:KAA_SELECT_MIN_BUCKET_ID];
-        
-        if (sqlite3_step(statement) == SQLITE_ROW) {
-            bucketId = sqlite3_column_int(statement, 0);
+        /*
+         * The current bucket is closed in the same critical section, in which its queued records
+         * are written, so no more records are added to it after it is read.
+         */
+        @synchronized(self) {
+            [self flushPendingRecords];
+            
+            bucketId = [self selectMinBucketId];
+            if (bucketId > 0 && self.currentBucketId == bucketId) {
+                [self moveToNextBucket];
+            }
         }
         
-        sqlite3_finalize(statement);
-        
         int64_t leftBucketSize = self.maxBucketSize;
         if (bucketId > 0) {
-            statement = [self statementForQuery:KAA_SELECT_LOG_RECORDS_BY_BUCKET_ID];
+            sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_SELECT_LOG_RECORDS_BY_BUCKET_ID];
             
             sqlite3_bind_int(statement, 1, bucketId);
             
@@ -173,7 +208,7 @@
                 
                 leftBucketSize -= blobLength;
             }
-            sqlite3_finalize(statement);
+            [self releaseCachedStatement:statement];
             
             if ([logRecords count] > 0) {
                 
@@ -181,12 +216,10 @@
                 logBucket = [[LogBucket alloc] initWithBucketId:bucketId records:logRecords];
                 
                 int64_t logBucketSize = self.maxBucketSize - leftBucketSize;
-                self.unmarkedConsumedSize -= logBucketSize;
-                self.unmarkedRecordCount -= [logRecords count];
-                self.consumedMemoryMap[@(logBucket.bucketId)] = @(logBucketSize);
-                
-                if (self.currentBucketId == bucketId) {
-                    [self moveToNextBucket];
+                @synchronized(self) {
+                    self.unmarkedConsumedSize -= logBucketSize;
+                    self.unmarkedRecordCount -= [logRecords count];
+                    self.consumedMemoryMap[@(logBucket.bucketId)] = @(logBucketSize);
                 }
                 
                 DDLogDebug(@"%@ Created log block with id [%i], size [%lld], record count [%lld]",
@@ -198,14 +231,14 @@
         } else {
             DDLogWarn(@"%@ Min bucket id < 0 [%i]", TAG, bucketId);
         }
-        
-        return logBucket;
-    }
+    });
+    
+    return logBucket;
 }
 
 - (void)removeBucketWithId:(int32_t)bucketId {
-    @synchronized(self) {
-        sqlite3_stmt *statement = [self statementForQuery:KAA_DELETE_BY_BUCKET_ID];
+    dispatch_sync(self.writeQueue, ^{
+        sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_DELETE_BY_BUCKET_ID];
         
         sqlite3_bind_int64(statement, 1, bucketId);
         
@@ -216,22 +249,24 @@
         int removedRecordsCount = sqlite3_changes(self.database);
         
         if (removedRecordsCount > 0) {
-            self.totalRecordCount -= removedRecordsCount;
+            @synchronized(self) {
+                self.totalRecordCount -= removedRecordsCount;
+            }
             DDLogDebug(@"%@ Removed %i records from storage. Total log record count: %lld",
                        TAG, removedRecordsCount, self.totalRecordCount);
         } else {
             DDLogDebug(@"%@ No records were removed from storage", TAG);
         }
         
-        sqlite3_finalize(statement);
-    }
+        [self releaseCachedStatement:statement];
+    });
 }
 
 - (void)rollbackBucketWithId:(int32_t)bucketId {
-    @synchronized(self) {
+    dispatch_sync(self.writeQueue, ^{
         DDLogDebug(@"%@ Rollback bucket with id [%i]", TAG, bucketId);
         
-        sqlite3_stmt *statement = [self statementForQuery:KAA_RESET_BY_BUCKET_ID];
+        sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_RESET_BY_BUCKET_ID];
         
         sqlite3_bind_int64(statement, 1, bucketId);
         
@@ -244,18 +279,20 @@
         if (resetRecordsCount > 0) {
             DDLogDebug(@"%@ Reset %i records for bucket with id [%i]", TAG, resetRecordsCount, bucketId);
             
-            int64_t previouslyConsumedSize = [self.consumedMemoryMap[@(bucketId)] longLongValue];
-            [self.consumedMemoryMap removeObjectForKey:@(bucketId)];
-            
-            self.unmarkedConsumedSize += previouslyConsumedSize;
-            self.unmarkedRecordCount += resetRecordsCount;
+            @synchronized(self) {
+                int64_t previouslyConsumedSize = [self.consumedMemoryMap[@(bucketId)] longLongValue];
+                [self.consumedMemoryMap removeObjectForKey:@(bucketId)];
+                
+                self.unmarkedConsumedSize += previouslyConsumedSize;
+                self.unmarkedRecordCount += resetRecordsCount;
+            }
             
         } else {
             DDLogDebug(@"%@ No records were reset for bucket with id [%i]", TAG, bucketId);
         }
         
-        sqlite3_finalize(statement);
-    }
+        [self releaseCachedStatement:statement];
+    });
 }
 
 - (id<LogStorageStatus>)getStatus {
@@ -271,14 +308,27 @@
 }
 
 - (void)close {
-    if (self.database == NULL) {
-        return;
-    }
-    
-    int result = sqlite3_close(self.database);
-    if (result != SQLITE_OK) {
-        DDLogWarn(@"%@ Failed to close database", TAG);
-    }
+    dispatch_sync(self.writeQueue, ^{
+        if (self.database == NULL) {
+            return;
+        }
+        
+        [self flushPendingRecords];
+        
+        /*
+         * The database isn't closed while it has unfinalized statements.
+         */
+        for (NSValue *statement in [self.cachedStatements allValues]) {
+            sqlite3_finalize([statement pointerValue]);
+        }
+        [self.cachedStatements removeAllObjects];
+        
+        int result = sqlite3_close(self.database);
+        if (result != SQLITE_OK) {
+            DDLogWarn(@"%@ Failed to close database", TAG);
+        }
+        self.database = NULL;
+    });
 }
 
 - (void)openDBAtPath:(NSString *)path {
@@ -289,6 +339,13 @@
         return;
     }
     
+    /*
+     * Records are appended to the write-ahead log on commit, which doesn't wait for readers
+     * and syncs the disk on checkpoints only.
+     */
+    [self tryExecuteQuery:KAA_ENABLE_WAL_JOURNAL_MODE];
+    [self tryExecuteQuery:KAA_SET_NORMAL_SYNCHRONOUS_MODE];
+    
     [self executeQuery:KAA_CREATE_LOG_TABLE_IF_NOT_EXISTS];
     [self executeQuery:KAA_CREATE_INFO_TABLE_IF_NOT_EXISTS];
     [self executeQuery:KAA_CREATE_BUCKET_ID_INDEX_IF_NOT_EXISTS];
@@ -310,6 +367,15 @@
     }
 }
 
+- (BOOL)tryExecuteQuery:(NSString *)query {
+    int resultCode = sqlite3_exec(self.database, [query UTF8String], NULL, NULL, nil);
+    if (resultCode != SQLITE_OK) {
+        DDLogWarn(@"%@ Unable to execute query: %@ error code [%i]", TAG, query, resultCode);
+        return NO;
+    }
+    return YES;
+}
+
 - (sqlite3_stmt *)statementForQuery:(NSString *)query {
     sqlite3_stmt *statement;
     int resultCode = sqlite3_prepare(self.database, [query UTF8String], LENGTH_UNLIMITED, &statement, NULL);
@@ -320,6 +386,93 @@
     return statement;
 }
 
+- (sqlite3_stmt *)cachedStatementForQuery:(NSString *)query {
+    NSValue *cachedStatement = self.cachedStatements[query];
+    if (cachedStatement) {
+        return [cachedStatement pointerValue];
+    }
+    
+    sqlite3_stmt *statement = [self statementForQuery:query];
+    self.cachedStatements[query] = [NSValue valueWithPointer:statement];
+    return statement;
+}
+
+- (void)releaseCachedStatement:(sqlite3_stmt *)statement {
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+}
+
+- (void)flushPendingRecords {
+    NSArray *records = nil;
+    @synchronized(self) {
+        records = self.pendingRecords;
+        self.pendingRecords = [NSMutableArray array];
+        self.flushScheduled = NO;
+    }
+    
+    if ([records count] == 0) {
+        return;
+    }
+    
+    int64_t failedRecordCount = 0;
+    int64_t failedRecordSize = 0;
+    
+    if (self.database == NULL || ![self tryExecuteQuery:KAA_BEGIN_TRANSACTION]) {
+        failedRecordCount = [records count];
+        for (NSArray *record in records) {
+            failedRecordSize += [record[1] length];
+        }
+    } else {
+        sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_INSERT_NEW_RECORD];
+        
+        for (NSArray *record in records) {
+            NSData *data = record[1];
+            
+            sqlite3_bind_int64(statement, 1, [record[0] intValue]);
+            sqlite3_bind_blob(statement, 2, [data bytes], (int32_t)data.length, SQLITE_STATIC);
+            
+            if (sqlite3_step(statement) != SQLITE_DONE) {
+                failedRecordCount++;
+                failedRecordSize += data.length;
+            }
+            sqlite3_reset(statement);
+        }
+        sqlite3_clear_bindings(statement);
+        
+        if (![self tryExecuteQuery:KAA_COMMIT_TRANSACTION]) {
+            [self tryExecuteQuery:KAA_ROLLBACK_TRANSACTION];
+            failedRecordCount = [records count];
+            failedRecordSize = 0;
+            for (NSArray *record in records) {
+                failedRecordSize += [record[1] length];
+            }
+        }
+    }
+    
+    if (failedRecordCount > 0) {
+        DDLogError(@"%@ Can't add %lld of %lld log records", TAG, failedRecordCount, (int64_t)[records count]);
+        @synchronized(self) {
+            self.unmarkedConsumedSize -= failedRecordSize;
+            self.totalRecordCount -= failedRecordCount;
+            self.unmarkedRecordCount -= failedRecordCount;
+        }
+    } else {
+        DDLogVerbose(@"%@ Committed a batch of %lld log records", TAG, (int64_t)[records count]);
+    }
+}
+
+- (int32_t)selectMinBucketId {
+    int32_t bucketId = 0;
+    
+    sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_SELECT_MIN_BUCKET_ID];
+    if (sqlite3_step(statement) == SQLITE_ROW) {
+        bucketId = sqlite3_column_int(statement, 0);
+    }
+    [self releaseCachedStatement:statement];
+    
+    return bucketId;
+}
+
 - (void)truncateIfBucketSizeIncompatible {
     int lastSavedBucketSize = 0;
     int lastSavedRecordCount = 0;
@@ -410,27 +563,25 @@
 }
 
 - (void)updateStateForBucketWithId:(int32_t)bucketId {
-    @synchronized(self) {
-        DDLogVerbose(@"%@ Updating state for bucket with id [%i]", TAG, bucketId);
-        
-        sqlite3_stmt *statement = [self statementForQuery:KAA_UPDATE_BUCKET_ID];
-        
-        sqlite3_bind_text(statement, 1, [BUCKET_STATE_COLUMN UTF8String], LENGTH_UNLIMITED, SQLITE_TRANSIENT);
-        sqlite3_bind_int64(statement, 2, bucketId);
-        
-        if (sqlite3_step(statement) == SQLITE_DONE) {
-            int affectedRows = sqlite3_changes(self.database);
-            if (affectedRows > 0) {
-                DDLogInfo(@"%@ Successfully updated state for bucket with id [%i] for %i records", TAG, bucketId, affectedRows);
-            } else {
-                DDLogWarn(@"%@ No log records were updated", TAG);
-            }
+    DDLogVerbose(@"%@ Updating state for bucket with id [%i]", TAG, bucketId);
+    
+    sqlite3_stmt *statement = [self cachedStatementForQuery:KAA_UPDATE_BUCKET_ID];
+    
+    sqlite3_bind_text(statement, 1, [BUCKET_STATE_COLUMN UTF8String], LENGTH_UNLIMITED, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(statement, 2, bucketId);
+    
+    if (sqlite3_step(statement) == SQLITE_DONE) {
+        int affectedRows = sqlite3_changes(self.database);
+        if (affectedRows > 0) {
+            DDLogInfo(@"%@ Successfully updated state for bucket with id [%i] for %i records", TAG, bucketId, affectedRows);
         } else {
-            DDLogWarn(@"%@ Can't update state for bucket id [%i]", TAG, bucketId);
+            DDLogWarn(@"%@ No log records were updated", TAG);
         }
-        
-        sqlite3_finalize(statement);
+    } else {
+        DDLogWarn(@"%@ Can't update state for bucket id [%i]", TAG, bucketId);
     }
+    
+    [self releaseCachedStatement:statement];
 }
 
 @end
@@ -28,17 +28,28 @@
 @property (nonatomic, strong) id<ExecutorContext> context;
 @property (nonatomic, strong) volatile id<NotificationTransport> transport;
 
-@property (nonatomic, strong) NSMutableDictionary *topics;               //<int64_t,Topic> as key-value
-@property (nonatomic, strong) NSMutableSet *mandatoryListeners;          //<NotificationDelegate>
-@property (nonatomic, strong) NSMutableDictionary *optionalListeners;    //<int64_t,NSArray<NotificationDelegate>> as key-value
-@property (nonatomic, strong) NSMutableSet *topicsListeners;             //<NotificationTopicListDelegate>
+/*
+ * Topics and delegates are kept in immutable snapshots which are replaced as a whole on update
+ * (under updateGuard), so notifications are dispatched without holding any lock.
+ */
+@property (atomic, strong) NSDictionary *topics;               //<int64_t,Topic> as key-value
+@property (atomic, strong) NSSet *mandatoryListeners;          //<NotificationDelegate>
+@property (atomic, strong) NSDictionary *optionalListeners;    //<int64_t,NSArray<NotificationDelegate>> as key-value
+@property (atomic, strong) NSSet *topicsListeners;             //<NotificationTopicListDelegate>
+@property (nonatomic, strong) NSObject *updateGuard;
 @property (nonatomic, strong) NSMutableArray *subscriptionInfo;          //<SubscriptionCommand>
 @property (nonatomic, strong) NotificationDeserializer *deserializer;
 
+@property (atomic, strong) dispatch_queue_t delegateQueue;
+@property (nonatomic, strong) NSMutableDictionary *topicQueues;          //<int64_t,dispatch_queue_t> as key-value
+@property (nonatomic, strong) dispatch_queue_t topicListQueue;
+
 - (Topic *)findTopicById:(int64_t)topicId;
 - (void)updateSubscriptionInfoForTopicId:(int64_t)topicId commandType:(SubscriptionCommandType)commandType;
 - (void)updateSubscriptions:(NSArray *)subscriptionUpdate;
 - (void)notifyDelegates:(NSArray *)delegates forTopic:(Topic *)topic notification:(Notification *)notification;
+- (dispatch_queue_t)queueForTopicId:(int64_t)topicId;
+- (dispatch_queue_t)defaultDelegateQueue;
 - (void)performSync;
 
 @end
@@ -54,31 +65,48 @@
         self.context = context;
         self.transport = transport;
         
-        self.topics = [NSMutableDictionary dictionary];
-        self.mandatoryListeners = [NSMutableSet set];
-        self.optionalListeners = [NSMutableDictionary dictionary];
-        self.topicsListeners = [NSMutableSet set];
+        self.mandatoryListeners = [NSSet set];
+        self.optionalListeners = [NSDictionary dictionary];
+        self.topicsListeners = [NSSet set];
+        self.updateGuard = [[NSObject alloc] init];
         self.subscriptionInfo = [NSMutableArray array];
         self.deserializer = [[NotificationDeserializer alloc] initWithExecutorContext:context];
         
+        self.delegateQueue = [self defaultDelegateQueue];
+        self.topicQueues = [NSMutableDictionary dictionary];
+        self.topicListQueue = dispatch_queue_create("org.kaaproject.kaa.notification.topics", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(self.topicListQueue, self.delegateQueue);
+        
+        NSMutableDictionary *topics = [NSMutableDictionary dictionary];
         NSArray *topicList = [state getTopics];
         if (topicList) {
             for (Topic *topic in topicList) {
-                self.topics[@(topic.id)] = topic;
+                topics[@(topic.id)] = topic;
             }
         }
+        self.topics = [topics copy];
     }
     return self;
 }
 
+- (void)setNotificationDelegateQueue:(dispatch_queue_t)queue {
+    @synchronized (self.topicQueues) {
+        self.delegateQueue = queue ? queue : [self defaultDelegateQueue];
+        dispatch_set_target_queue(self.topicListQueue, self.delegateQueue);
+        for (dispatch_queue_t topicQueue in self.topicQueues.allValues) {
+            dispatch_set_target_queue(topicQueue, self.delegateQueue);
+        }
+    }
+}
+
 - (void)addNotificationDelegate:(id<NotificationDelegate>)delegate {
     if (!delegate) {
         DDLogWarn(@"%@ Failed to add notification delegate: nil", TAG);
         [NSException raise:NSInvalidArgumentException format:@"Nil notification delegate"];
     }
     
-    @synchronized (self.mandatoryListeners) {
-        [self.mandatoryListeners addObject:delegate];
+    @synchronized (self.updateGuard) {
+        self.mandatoryListeners = [self.mandatoryListeners setByAddingObject:delegate];
     }
 }
 
@@ -87,8 +115,10 @@
         DDLogWarn(@"%@ Failed to remove notification delegate: nil", TAG);
         [NSException raise:NSInvalidArgumentException format:@"Nil notification delegate"];
     }
-    @synchronized (self.mandatoryListeners) {
-        [self.mandatoryListeners removeObject:delegate];
+    @synchronized (self.updateGuard) {
+        NSMutableSet *listeners = [self.mandatoryListeners mutableCopy];
+        [listeners removeObject:delegate];
+        self.mandatoryListeners = [listeners copy];
     }
 }
 
@@ -97,8 +127,8 @@
         DDLogWarn(@"%@ Failed to add topic list delegate: nil", TAG);
         [NSException raise:NSInvalidArgumentException format:@"Nil topic list delegate"];
     }
-    @synchronized (self.topicsListeners) {
-        [self.topicsListeners addObject:delegate];
+    @synchronized (self.updateGuard) {
+        self.topicsListeners = [self.topicsListeners setByAddingObject:delegate];
     }
 }
 
@@ -107,15 +137,15 @@
         DDLogWarn(@"%@ Failed to remove topic list delegate: nil", TAG);
         [NSException raise:NSInvalidArgumentException format:@"Nil topic list delegate"];
     }
-    @synchronized (self.topicsListeners) {
-        [self.topicsListeners removeObject:delegate];
+    @synchronized (self.updateGuard) {
+        NSMutableSet *listeners = [self.topicsListeners mutableCopy];
+        [listeners removeObject:delegate];
+        self.topicsListeners = [listeners copy];
     }
 }
 
 - (NSArray *)getTopics {
-    @synchronized (self.topics) {
-        return self.topics.allValues;
-    }
+    return self.topics.allValues;
 }
 
 - (void)subscribeToTopicWithId:(int64_t)topicId forceSync:(BOOL)forceSync {
@@ -196,14 +226,11 @@
     
     [self findTopicById:topicId];
     
-    @synchronized (self.optionalListeners) {
-        NSMutableArray *delegates = self.optionalListeners[@(topicId)];
-        if (!delegates) {
-            delegates = [NSMutableArray array];
-            self.optionalListeners[@(topicId)] = delegates;
-        }
-        
-        [delegates addObject:delegate];
+    @synchronized (self.updateGuard) {
+        NSMutableDictionary *listeners = [self.optionalListeners mutableCopy];
+        NSArray *delegates = listeners[@(topicId)];
+        listeners[@(topicId)] = delegates ? [delegates arrayByAddingObject:delegate] : @[delegate];
+        self.optionalListeners = [listeners copy];
     }
 }
 
@@ -215,10 +242,14 @@
     
     [self findTopicById:topicId];
     
-    @synchronized (self.optionalListeners) {
-        NSMutableArray *delegates = self.optionalListeners[@(topicId)];
+    @synchronized (self.updateGuard) {
+        NSArray *delegates = self.optionalListeners[@(topicId)];
         if (delegates) {
-            [delegates removeObject:delegate];
+            NSMutableArray *newDelegates = [delegates mutableCopy];
+            [newDelegates removeObject:delegate];
+            NSMutableDictionary *listeners = [self.optionalListeners mutableCopy];
+            listeners[@(topicId)] = [newDelegates copy];
+            self.optionalListeners = [listeners copy];
         }
     }
 }
@@ -230,30 +261,32 @@
 - (void)topicsListUpdated:(NSArray *)topics {
     NSMutableDictionary *newTopics = [NSMutableDictionary dictionary];
     
-    @synchronized (self.topics) {
+    @synchronized (self.updateGuard) {
+        NSMutableDictionary *oldTopics = [self.topics mutableCopy];
         for (Topic *topic in topics) {
             newTopics[@(topic.id)] = topic;
-            if (self.topics[@(topic.id)]) {
-                [self.topics removeObjectForKey:@(topic.id)];
+            if (oldTopics[@(topic.id)]) {
+                [oldTopics removeObjectForKey:@(topic.id)];
             } else {
                 [self.state addTopic:topic];
             }
         }
-        @synchronized (self.optionalListeners) {
-            for (Topic *topic in self.topics.allValues) {
-                [self.optionalListeners removeObjectForKey:@(topic.id)];
-                [self.state removeTopicId:topic.id];
-            }
+        NSMutableDictionary *listeners = [self.optionalListeners mutableCopy];
+        for (Topic *topic in oldTopics.allValues) {
+            [listeners removeObjectForKey:@(topic.id)];
+            [self.state removeTopicId:topic.id];
         }
-        self.topics = newTopics;
+        self.optionalListeners = [listeners copy];
+        self.topics = [newTopics copy];
     }
     
-    @synchronized (self.topicsListeners) {
-        for (id<NotificationTopicListDelegate> delegate in self.topicsListeners) {
-            [[self.context getCallbackExecutor] addOperationWithBlock:^{
+    NSSet *delegates = self.topicsListeners;
+    if ([delegates count] > 0) {
+        dispatch_async(self.topicListQueue, ^{
+            for (id<NotificationTopicListDelegate> delegate in delegates) {
                 [delegate onListUpdated:topics];
-            }];
-        }
+            }
+        });
     }
 }
 
@@ -261,21 +294,11 @@
     for (Notification *notification in notifications) {
         @try {
             Topic *topic = [self findTopicById:notification.topicId];
-            BOOL hasOwner = NO;
-            
-            @synchronized (self.optionalListeners) {
-                NSArray *delegates = self.optionalListeners[@(topic.id)];
-                if (delegates && [delegates count] > 0) {
-                    hasOwner = YES;
-                    [self notifyDelegates:delegates forTopic:topic notification:notification];
-                }
-            }
-            
-            if (!hasOwner) {
-                @synchronized (self.mandatoryListeners) {
-                    [self notifyDelegates:[self.mandatoryListeners allObjects] forTopic:topic notification:notification];
-                }
+            NSArray *delegates = self.optionalListeners[@(topic.id)];
+            if ([delegates count] == 0) {
+                delegates = [self.mandatoryListeners allObjects];
             }
+            [self notifyDelegates:delegates forTopic:topic notification:notification];
         }
         @catch (NSException *exception) {
             DDLogWarn(@"%@ Caught exception: %@ reason: %@", TAG, exception.name, exception.reason);
@@ -285,21 +308,37 @@
 }
 
 - (void)notifyDelegates:(NSArray *)delegates forTopic:(Topic *)topic notification:(Notification *)notification {
-    if (notification.body) {
+    if (notification.body && [delegates count] > 0) {
         __weak typeof(self)weakSelf = self;
-        NSArray *blockDelegates = [delegates copy];
-        [[self.context getCallbackExecutor] addOperationWithBlock:^{
+        dispatch_async([self queueForTopicId:topic.id], ^{
             @try {
-                [weakSelf.deserializer notifyDelegates:blockDelegates withTopic:topic data:notification.body];
+                [weakSelf.deserializer notifyDelegates:delegates withTopic:topic data:notification.body];
             }
             @catch (NSException *exception) {
                 DDLogError(@"%@ Failed to process notification for topic %lld. Error: %@ reason: %@",
                            TAG, topic.id, exception.name, exception.reason);
             }
-        }];
+        });
     }
 }
 
+- (dispatch_queue_t)queueForTopicId:(int64_t)topicId {
+    @synchronized (self.topicQueues) {
+        dispatch_queue_t queue = self.topicQueues[@(topicId)];
+        if (!queue) {
+            queue = dispatch_queue_create("org.kaaproject.kaa.notification.topic", DISPATCH_QUEUE_SERIAL);
+            dispatch_set_target_queue(queue, self.delegateQueue);
+            self.topicQueues[@(topicId)] = queue;
+        }
+        return queue;
+    }
+}
+
+- (dispatch_queue_t)defaultDelegateQueue {
+    dispatch_queue_t queue = [[self.context getCallbackExecutor] underlyingQueue];
+    return queue ? queue : dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+}
+
 - (void)updateSubscriptionInfoForTopicId:(int64_t)topicId commandType:(SubscriptionCommandType)commandType {
     @synchronized (self.subscriptionInfo) {
         SubscriptionCommand *subscriptionCommand = [[SubscriptionCommand alloc] init];
@@ -316,14 +355,12 @@
 }
 
 - (Topic *)findTopicById:(int64_t)topicId {
-    @synchronized (self.topics) {
-        Topic *topic = self.topics[@(topicId)];
-        if (!topic) {
-            DDLogWarn(@"%@ Failed to find topic: [id:%lld] is unknown", TAG, topicId);
-            [NSException raise:KaaUnavailableTopic format:@"Topic id [%lld] is unknown", topicId];
-        }
-        return topic;
+    Topic *topic = self.topics[@(topicId)];
+    if (!topic) {
+        DDLogWarn(@"%@ Failed to find topic: [id:%lld] is unknown", TAG, topicId);
+        [NSException raise:KaaUnavailableTopic format:@"Topic id [%lld] is unknown", topicId];
     }
+    return topic;
 }
 
 - (void)performSync {
@@ -40,6 +40,8 @@
 
 /**
  * delegates - array of delegates to be notified <NotificationDelegate>
+ *
+ * Delegates are notified on the calling thread, one after another.
  */
 - (void)notifyDelegates:(NSArray *)delegates withTopic:(Topic *)topic data:(NSData *)notificationData;
 
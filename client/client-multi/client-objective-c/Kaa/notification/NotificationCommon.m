@@ -38,9 +38,7 @@
 - (void)notifyDelegates:(NSArray *)delegates withTopic:(Topic *)topic data:(NSData *)notificationData {
     KAADummyNotification *notification = [self.converter fromBytes:notificationData object:[KAADummyNotification new]];
     for (id<NotificationDelegate> delegate in delegates) {
-        [[self.executorContext getCallbackExecutor] addOperationWithBlock:^{
-            [delegate onNotification:notification withTopicId:topic.id];
-        }];
+        [delegate onNotification:notification withTopicId:topic.id];
     }
 }
 
@@ -146,6 +146,17 @@
  */
 - (void)sync;
 
+/**
+ * Set the queue notification and topic list delegates are called on.
+ *
+ * Notifications of the same topic are delivered one by one in the order they were received,
+ * regardless of the queue. By default, the delegates are called on the underlying queue of the callback
+ * executor, or on a global concurrent queue if the executor has none.
+ *
+ * @param queue Queue to call delegates on, nil to restore the default one.
+ */
+- (void)setNotificationDelegateQueue:(dispatch_queue_t)queue;
+
 @end
 
 #endif
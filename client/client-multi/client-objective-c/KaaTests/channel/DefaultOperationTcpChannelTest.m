@@ -148,6 +148,23 @@
     [tcpChannel shutdown];
 }
 
+- (void)testShutdownClosesSocket {
+    KeyPair *clientKeys = [KeyUtils generateKeyPair];
+    id<KaaClientState> clientState = mockProtocol(@protocol(KaaClientState));
+    id<FailoverManager> failoverManager = mockProtocol(@protocol(FailoverManager));
+    MockedOperationTcpChannel *tcpChannel = [[MockedOperationTcpChannel alloc] initWithClientState:clientState failoverManager:failoverManager];
+    
+    id<TransportConnectionInfo> server = [self createTestServerInfoWithServerType:SERVER_OPERATIONS transportProtocolId:[TransportProtocolIdHolder TCPTransportID] host:@"localhost" port:9009 publicKey:[KeyUtils getPublicKey]];
+    [tcpChannel setServer:server withKeyPair:clientKeys];
+    
+    [NSThread sleepForTimeInterval:1]; // sleep a bit to let the connection be opened
+    [verify(tcpChannel.socketMock) open];
+    
+    [tcpChannel shutdown];
+    [NSThread sleepForTimeInterval:1]; // socket is closed on the I/O queue after the Disconnect is written
+    [verify(tcpChannel.socketMock) close];
+}
+
 - (void)testConnectivity {
     KeyPair *clientKeys = [KeyUtils generateKeyPair];
     id<KaaClientState> clientState = mockProtocol(@protocol(KaaClientState));
@@ -15,6 +15,7 @@
  */
 
 #import <XCTest/XCTest.h>
+#import <UIKit/UIKit.h>
 
 #define HC_SHORTHAND
 #import <OCHamcrest/OCHamcrest.h>
@@ -67,4 +68,34 @@
     XCTAssertEqual(logCollector.bucketInfoDictionary.count, 1);
 }
 
+- (void)testUploadPostponedInBackground {
+    id<ExecutorContext> executorContext = mockProtocol(@protocol(ExecutorContext));
+    id<LogTransport> logTransport = mockProtocol(@protocol(LogTransport));
+    id<KaaChannelManager> channelManager = mockProtocol(@protocol(KaaChannelManager));
+    id<FailoverManager> failoverManager = mockProtocol(@protocol(FailoverManager));
+    id<LogUploadStrategy> strategy = mockProtocol(@protocol(LogUploadStrategy));
+    [given([strategy isUploadNeededForStorageStatus:anything()]) willReturnInt:LOG_UPLOAD_STRATEGY_DECISION_UPLOAD];
+    [given([strategy getMaxParallelUploads]) willReturnLongLong:1];
+    
+    AbstractLogCollector *logCollector = [[AbstractLogCollector alloc] initWithTransport:logTransport
+                                                                         executorContext:executorContext
+                                                                          channelManager:channelManager
+                                                                         failoverManager:failoverManager];
+    [logCollector setValue:strategy forKey:@"strategy"];
+    
+    NSOperationQueue *executor = [[NSOperationQueue alloc] init];
+    [given([executorContext getApiExecutor]) willReturn:executor];
+    
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidEnterBackgroundNotification object:nil];
+    [executor waitUntilAllOperationsAreFinished];
+    
+    [logCollector uploadIfNeeded];
+    [verifyCount(logTransport, never()) sync];
+    
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationWillEnterForegroundNotification object:nil];
+    [executor waitUntilAllOperationsAreFinished];
+    
+    [verify(logTransport) sync];
+}
+
 @end
@@ -87,6 +87,36 @@
     [storage close];
 }
 
+- (void)testQueuedRecordsWrittenOnClose {
+    int64_t bucketSize = 8192;
+    int32_t recordCount = 1000;
+    
+    id<LogStorage> storage = [self logStorageWithBucketSize:bucketSize recordCount:recordCount];
+    
+    LogRecord *logRecord = [LogTestHelper defaultLogRecord];
+    
+    /*
+     * Records are written to the database in batches on a background queue.
+     */
+    int32_t insertionCount = 500;
+    for (int32_t i = 0; i < insertionCount; i++) {
+        [storage addLogRecord:logRecord];
+    }
+    
+    XCTAssertEqual(insertionCount, [[storage getStatus] getRecordCount]);
+    [storage close];
+    
+    storage = [self logStorageWithBucketSize:bucketSize recordCount:recordCount];
+    
+    XCTAssertEqual(insertionCount, [[storage getStatus] getRecordCount]);
+    XCTAssertEqual(insertionCount * RECORD_PAYLOAD_SIZE, [[storage getStatus] getConsumedVolume]);
+    
+    LogBucket *bucket = [storage getNextBucket];
+    XCTAssertEqual(insertionCount, [bucket.logRecords count]);
+    
+    [storage close];
+}
+
 - (id<LogStorage>)logStorageWithBucketSize:(int64_t)bucketSize recordCount:(int32_t)recordCount {
     return [[SQLiteLogStorage alloc] initWithDatabaseName:DEFAULT_TEST_DB_NAME bucketSize:bucketSize bucketRecordCount:recordCount];
 }
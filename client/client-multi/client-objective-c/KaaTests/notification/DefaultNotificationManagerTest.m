@@ -624,4 +624,39 @@
     [verifyCount(transport, times(3)) sync];
 }
 
+- (void)testNotificationDelegateQueue {
+    KaaClientPropertiesState *state = [[KaaClientPropertiesState alloc] initWithBase64:[CommonBase64 new] clientProperties:[TestsHelper getProperties]];
+    id<NotificationTransport> transport = mockProtocol(@protocol(NotificationTransport));
+    
+    DefaultNotificationManager *notificationManager = [[DefaultNotificationManager alloc] initWithState:state executorContext:self.executorContext notificationTransport:transport];
+    
+    Topic *topic1 = [[Topic alloc] init];
+    topic1.id = 1;
+    topic1.name = @"topic_name1";
+    topic1.subscriptionType = SUBSCRIPTION_TYPE_MANDATORY_SUBSCRIPTION;
+    [notificationManager topicsListUpdated:@[topic1]];
+    
+    Notification *notification1 = [[Notification alloc] init];
+    notification1.topicId = 1;
+    notification1.type = NOTIFICATION_TYPE_CUSTOM;
+    notification1.seqNumber = [KAAUnion unionWithBranch:KAA_UNION_INT_OR_NULL_BRANCH_0 data:@(1)];
+    notification1.body = [self.converter toBytes:[[KAADummyNotification alloc] init]];
+    
+    id<NotificationDelegate> delegate = mockProtocol(@protocol(NotificationDelegate));
+    [notificationManager addNotificationDelegate:delegate];
+    
+    dispatch_queue_t delegateQueue = dispatch_queue_create("test.notification.delegates", DISPATCH_QUEUE_SERIAL);
+    [notificationManager setNotificationDelegateQueue:delegateQueue];
+    dispatch_suspend(delegateQueue);
+    
+    [notificationManager notificationsReceived:@[notification1, notification1]];
+    [NSThread sleepForTimeInterval:0.5f];
+    [verifyCount(delegate, never()) onNotification:anything() withTopicId:1];
+    
+    dispatch_resume(delegateQueue);
+    dispatch_sync(delegateQueue, ^{});
+    [NSThread sleepForTimeInterval:0.5f];
+    [verifyCount(delegate, times(2)) onNotification:anything() withTopicId:1];
+}
+
 @end
@@ -28,9 +28,13 @@ extern "C" {
 #define FIRST_BIT                0x80
 #define MAX_MESSAGE_TYPE_LENGTH  0x0F
 #define MAX_MESSAGE_LENGTH       0x0FFFFFFF
+#define KAATCP_MAX_LENGTH_BYTES  4
 #define PROTOCOL_VERSION         0x01
 
+#define BASIC_HEADER_MAX_LENGTH  5
+
 #define KAA_SYNC_HEADER_LENGTH 12
+#define KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH (BASIC_HEADER_MAX_LENGTH + KAA_SYNC_HEADER_LENGTH)
 #define KAA_SYNC_ZIPPED_BIT    0x02
 #define KAA_SYNC_ENCRYPTED_BIT 0x04
 #define KAA_SYNC_REQUEST_BIT   0x01
@@ -44,6 +48,7 @@ extern "C" {
 
 #define KAA_CONNECT_FLAGS          0x02
 #define KAA_CONNECT_HEADER_LENGTH  18
+#define KAA_CONNECT_MESSAGE_HEADER_MAX_LENGTH (BASIC_HEADER_MAX_LENGTH + KAA_CONNECT_HEADER_LENGTH)
 
 #define KAA_CONNECT_KEY_AES_RSA    0x11
 #define KAA_CONNECT_SIGNATURE_SHA1 0x01
@@ -206,6 +206,18 @@ static void kaatcp_parser_retrieve_message_type(kaatcp_parser_t *parser, uint8_t
     parser->message_type = ((byte & 0xFF) >> 4);
 }
 
+static kaatcp_error_t kaatcp_parser_length_done(kaatcp_parser_t *parser)
+{
+    if (parser->message_length > KAATCP_PARSER_MAX_MESSAGE_LENGTH) {
+        return KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    }
+    if (parser->message_length) {
+        parser->state = KAATCP_PARSER_STATE_PROCESSING_PAYLOAD;
+        return KAATCP_ERR_NONE;
+    }
+    return kaatcp_parser_message_done(parser);
+}
+
 static kaatcp_error_t kaatcp_parser_process_byte(kaatcp_parser_t *parser, uint8_t byte)
 {
     switch (parser->state) {
@@ -214,14 +226,13 @@ static kaatcp_error_t kaatcp_parser_process_byte(kaatcp_parser_t *parser, uint8_
             parser->state = KAATCP_PARSER_STATE_PROCESSING_LENGTH;
             break;
         case KAATCP_PARSER_STATE_PROCESSING_LENGTH:
+            if ((byte & FIRST_BIT) && parser->length_multiplier >= FIRST_BIT * FIRST_BIT * FIRST_BIT) {
+                return KAATCP_ERR_INVALID_PROTOCOL;
+            }
             parser->message_length += ((byte & ~FIRST_BIT) * parser->length_multiplier);
             parser->length_multiplier *= FIRST_BIT;
             if (!(byte & FIRST_BIT)) {
-                if (parser->message_length) {
-                    parser->state = KAATCP_PARSER_STATE_PROCESSING_PAYLOAD;
-                } else {
-                    return kaatcp_parser_message_done(parser);
-                }
+                return kaatcp_parser_length_done(parser);
             }
             break;
         default:
@@ -230,6 +241,28 @@ static kaatcp_error_t kaatcp_parser_process_byte(kaatcp_parser_t *parser, uint8_
     return KAATCP_ERR_NONE;
 }
 
+/*
+ * Decodes the message type and the whole length at once if the fixed header
+ * is complete in buf, 0 bytes are consumed otherwise.
+ */
+static kaatcp_error_t kaatcp_parser_read_fixed_header(kaatcp_parser_t *parser, const uint8_t *buf, uint32_t size, uint32_t *consumed)
+{
+    *consumed = 0;
+
+    uint32_t length = 0;
+    uint32_t length_bytes = (size - 1 < KAATCP_MAX_LENGTH_BYTES) ? size - 1 : KAATCP_MAX_LENGTH_BYTES;
+    for (uint32_t i = 0; i < length_bytes; ++i) {
+        length |= (uint32_t) (buf[i + 1] & ~FIRST_BIT) << (7 * i);
+        if (!(buf[i + 1] & FIRST_BIT)) {
+            kaatcp_parser_retrieve_message_type(parser, buf[0]);
+            parser->message_length = length;
+            *consumed = i + 2;
+            return kaatcp_parser_length_done(parser);
+        }
+    }
+    return (length_bytes == KAATCP_MAX_LENGTH_BYTES) ? KAATCP_ERR_INVALID_PROTOCOL : KAATCP_ERR_NONE;
+}
+
 kaatcp_error_t kaatcp_parser_reset(kaatcp_parser_t *parser)
 {
     if (!parser) {
@@ -274,9 +307,20 @@ kaatcp_error_t kaatcp_parser_process_buffer(kaatcp_parser_t *parser, const char
                 }
             }
         } else {
-            rval = kaatcp_parser_process_byte(parser, *(buf_cursor++));
-            if (rval) {
-                return rval;
+            uint32_t consumed = 0;
+            if (parser->state == KAATCP_PARSER_STATE_NONE) {
+                rval = kaatcp_parser_read_fixed_header(parser, (const uint8_t *) buf_cursor, buf + buf_size - buf_cursor, &consumed);
+                if (rval) {
+                    return rval;
+                }
+            }
+            if (consumed) {
+                buf_cursor += consumed;
+            } else {
+                rval = kaatcp_parser_process_byte(parser, *(buf_cursor++));
+                if (rval) {
+                    return rval;
+                }
             }
         }
     }
@@ -17,7 +17,20 @@
 #include "kaatcp_request.h"
 
 #include <string.h>
-#include <arpa/inet.h>
+
+/* Big-endian writers, so that the library does not depend on the socket headers */
+static char *put_uint16(char *cursor, uint16_t value)
+{
+    *(cursor++) = (char) (value >> 8);
+    *(cursor++) = (char) value;
+    return cursor;
+}
+
+static char *put_uint32(char *cursor, uint32_t value)
+{
+    cursor = put_uint16(cursor, (uint16_t) (value >> 16));
+    return put_uint16(cursor, (uint16_t) value);
+}
 
 static uint8_t create_basic_header(uint8_t message_type, uint32_t length, char *message)
 {
@@ -77,16 +90,47 @@ kaatcp_error_t kaatcp_fill_connect_message(uint16_t keepalive, uint32_t next_pro
     return KAATCP_ERR_NONE;
 }
 
+static uint32_t kaatcp_get_connect_payload_size(const kaatcp_connect_t *message)
+{
+    return message->sync_request_size + message->session_key_size + message->signature_size + KAA_CONNECT_HEADER_LENGTH;
+}
+
+/*
+ * Writes the basic header and the fixed CONNECT fields, at most
+ * KAA_CONNECT_MESSAGE_HEADER_MAX_LENGTH bytes. Returns 0 if the message is too large.
+ */
+static uint8_t kaatcp_get_connect_header(const kaatcp_connect_t *message, char *buf)
+{
+    uint8_t header_size = create_basic_header(KAATCP_MESSAGE_CONNECT, kaatcp_get_connect_payload_size(message), buf);
+    if (!header_size) {
+        return 0;
+    }
+
+    char *cursor = put_uint16(buf + header_size, KAA_TCP_NAME_LENGTH);
+    memcpy(cursor, KAA_TCP_NAME, KAA_TCP_NAME_LENGTH);
+    cursor += KAA_TCP_NAME_LENGTH;
+
+    *(cursor++) = PROTOCOL_VERSION;
+    *(cursor++) = message->connect_flags;
+
+    cursor = put_uint32(cursor, message->next_ptorocol_id);
+
+    *(cursor++) = message->session_key_flags;
+    *(cursor++) = message->signature_flags;
+
+    cursor = put_uint16(cursor, message->keep_alive);
+    return cursor - buf;
+}
+
 kaatcp_error_t kaatcp_get_request_connect(const kaatcp_connect_t *message, char *buf, uint32_t *buf_size)
 {
     if (!message || !buf || !buf_size) {
         return KAATCP_ERR_BAD_PARAM;
     }
-    char header[6];
-    uint32_t payload_size = message->sync_request_size + message->session_key_size + message->signature_size + KAA_CONNECT_HEADER_LENGTH;
-    uint8_t header_size = create_basic_header(KAATCP_MESSAGE_CONNECT, payload_size, header);
+    char header[KAA_CONNECT_MESSAGE_HEADER_MAX_LENGTH];
+    uint8_t header_size = kaatcp_get_connect_header(message, header);
 
-    if ((*buf_size) < payload_size + header_size) {
+    if (!header_size || (*buf_size) < kaatcp_get_connect_payload_size(message) - KAA_CONNECT_HEADER_LENGTH + header_size) {
         return KAATCP_ERR_BUFFER_NOT_ENOUGH;
     }
 
@@ -95,27 +139,6 @@ kaatcp_error_t kaatcp_get_request_connect(const kaatcp_connect_t *message, char
     memcpy(cursor, header, header_size);
     cursor += header_size;
 
-    uint16_t name_length = htons(message->protocol_name_length);
-    memcpy(cursor, &name_length, sizeof(uint16_t));
-    cursor += sizeof(uint16_t);
-
-    memcpy(cursor, message->protocol_name, message->protocol_name_length);
-    cursor += message->protocol_name_length;
-
-    *(cursor++) = PROTOCOL_VERSION;
-    *(cursor++) = message->connect_flags;
-
-    uint32_t next_protocol_id = htonl(message->next_ptorocol_id);
-    memcpy(cursor, &next_protocol_id, sizeof(uint32_t));
-    cursor += sizeof(uint32_t);
-
-    *(cursor++) = message->session_key_flags;
-    *(cursor++) = message->signature_flags;
-
-    uint16_t keep_alive = htons(message->keep_alive);
-    memcpy(cursor, &keep_alive, sizeof(uint16_t));
-    cursor += sizeof(uint16_t);
-
     if (message->session_key && message->session_key_flags) {
         memcpy(cursor, message->session_key, message->session_key_size);
         cursor += message->session_key_size;
@@ -179,36 +202,40 @@ static void kaatcp_fill_kaasync_header(uint16_t message_id, uint8_t zipped, uint
     }
 }
 
-static kaatcp_error_t kaatcp_get_kaasync_header(const kaatcp_kaasync_header_t *sync_header, uint32_t payload_length, char *buf, uint32_t *buf_size, char **end)
+/*
+ * Writes the basic header and the KAASYNC header, at most
+ * KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH bytes. Returns 0 if the message is too large.
+ */
+static uint8_t kaatcp_write_kaasync_header(const kaatcp_kaasync_header_t *sync_header, uint32_t payload_length, char *buf)
 {
-    char header[6];
-    uint32_t payload_size = payload_length + KAA_SYNC_HEADER_LENGTH;
-    uint8_t header_size = create_basic_header(KAATCP_MESSAGE_KAASYNC, payload_size, header);
-
-    if ((*buf_size) < payload_size + header_size) {
-        return KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    uint8_t header_size = create_basic_header(KAATCP_MESSAGE_KAASYNC, payload_length + KAA_SYNC_HEADER_LENGTH, buf);
+    if (!header_size) {
+        return 0;
     }
 
-    char *cursor = buf;
+    char *cursor = put_uint16(buf + header_size, KAA_TCP_NAME_LENGTH);
+    memcpy(cursor, KAA_TCP_NAME, KAA_TCP_NAME_LENGTH);
+    cursor += KAA_TCP_NAME_LENGTH;
 
-    memcpy(cursor, header, header_size);
-    cursor += header_size;
+    *(cursor++) = PROTOCOL_VERSION;
 
-    uint16_t name_length = htons(sync_header->protocol_name_length);
-    memcpy(cursor, &name_length, sizeof(uint16_t));
-    cursor += sizeof(uint16_t);
+    cursor = put_uint16(cursor, sync_header->message_id);
 
-    memcpy(cursor, sync_header->protocol_name, sync_header->protocol_name_length);
-    cursor += sync_header->protocol_name_length;
+    *(cursor++) = sync_header->flags;
+    return cursor - buf;
+}
 
-    *(cursor++) = PROTOCOL_VERSION;
+static kaatcp_error_t kaatcp_get_kaasync_header(const kaatcp_kaasync_header_t *sync_header, uint32_t payload_length, char *buf, uint32_t *buf_size, char **end)
+{
+    char header[KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH];
+    uint8_t header_size = kaatcp_write_kaasync_header(sync_header, payload_length, header);
 
-    uint16_t message_id = htons(sync_header->message_id);
-    memcpy(cursor, &message_id, sizeof(uint16_t));
-    cursor += sizeof(uint16_t);
+    if (!header_size || (*buf_size) < payload_length + header_size) {
+        return KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    }
 
-    *(cursor++) = sync_header->flags;
-    *end = cursor;
+    memcpy(buf, header, header_size);
+    *end = buf + header_size;
     return KAATCP_ERR_NONE;
 }
 
@@ -289,3 +316,128 @@ kaatcp_error_t kaatcp_get_request_ping(char *buf, uint32_t *buf_size)
 }
 
 
+
+kaatcp_error_t kaatcp_get_request_kaasync_header(const kaatcp_kaasync_t *message, char *buf, uint32_t *buf_size)
+{
+    if (!message || !buf || !buf_size) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    if (*buf_size < KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH) {
+        return KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    }
+    uint8_t header_size = kaatcp_write_kaasync_header(&message->sync_header, message->sync_request_size, buf);
+    if (!header_size) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    *buf_size = header_size;
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_init(kaatcp_encoder_t *encoder, kaatcp_write_fn write, void *context)
+{
+    if (!encoder || !write) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    encoder->write = write;
+    encoder->context = context;
+    encoder->remaining = 0;
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_begin_connect(kaatcp_encoder_t *encoder, const kaatcp_connect_t *message)
+{
+    if (!encoder || !message) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    if (encoder->remaining) {
+        return KAATCP_ERR_INVALID_STATE;
+    }
+    char header[KAA_CONNECT_MESSAGE_HEADER_MAX_LENGTH];
+    uint8_t header_size = kaatcp_get_connect_header(message, header);
+    if (!header_size) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+
+    kaatcp_error_t code = encoder->write(encoder->context, header, header_size);
+    if (!code && message->session_key && message->session_key_flags) {
+        code = encoder->write(encoder->context, message->session_key, message->session_key_size);
+    }
+    if (!code && message->signature && message->signature_flags) {
+        code = encoder->write(encoder->context, message->signature, message->signature_size);
+    }
+    if (code) {
+        return code;
+    }
+    encoder->remaining = message->sync_request_size;
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_begin_kaasync(kaatcp_encoder_t *encoder, const kaatcp_kaasync_t *message)
+{
+    if (!encoder || !message) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    if (encoder->remaining) {
+        return KAATCP_ERR_INVALID_STATE;
+    }
+    char header[KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH];
+    uint8_t header_size = kaatcp_write_kaasync_header(&message->sync_header, message->sync_request_size, header);
+    if (!header_size) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+
+    kaatcp_error_t code = encoder->write(encoder->context, header, header_size);
+    if (code) {
+        return code;
+    }
+    encoder->remaining = message->sync_request_size;
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_write(kaatcp_encoder_t *encoder, const char *data, uint32_t size)
+{
+    if (!encoder || (size && !data)) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    if (size > encoder->remaining) {
+        return KAATCP_ERR_INVALID_STATE;
+    }
+    if (!size) {
+        return KAATCP_ERR_NONE;
+    }
+    kaatcp_error_t code = encoder->write(encoder->context, data, size);
+    if (code) {
+        return code;
+    }
+    encoder->remaining -= size;
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_writev(kaatcp_encoder_t *encoder, const kaatcp_iovec_t *iov, uint32_t iov_count)
+{
+    if (!encoder || (iov_count && !iov)) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < iov_count; ++i) {
+        if (iov[i].size > encoder->remaining - size) {
+            return KAATCP_ERR_INVALID_STATE;
+        }
+        size += iov[i].size;
+    }
+    for (uint32_t i = 0; i < iov_count; ++i) {
+        kaatcp_error_t code = kaatcp_encoder_write(encoder, iov[i].data, iov[i].size);
+        if (code) {
+            return code;
+        }
+    }
+    return KAATCP_ERR_NONE;
+}
+
+kaatcp_error_t kaatcp_encoder_end(kaatcp_encoder_t *encoder)
+{
+    if (!encoder) {
+        return KAATCP_ERR_BAD_PARAM;
+    }
+    return encoder->remaining ? KAATCP_ERR_INVALID_STATE : KAATCP_ERR_NONE;
+}
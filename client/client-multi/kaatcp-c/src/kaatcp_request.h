@@ -43,6 +43,50 @@ kaatcp_error_t kaatcp_get_request_bootstrap(const kaatcp_bootstrap_request_t *me
 
 kaatcp_error_t kaatcp_get_request_ping(char *buf, uint32_t *buf_size);
 
+/*
+ * Serializes the headers of the KAASYNC message without the sync request, which follows
+ * them on the wire, e.g. to send both with writev(). Requires at least
+ * KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH bytes in @buf.
+ */
+kaatcp_error_t kaatcp_get_request_kaasync_header(const kaatcp_kaasync_t *message, char *buf, uint32_t *buf_size);
+
+/*
+ * Streaming encoder. Messages are handed to the write callback piece by piece,
+ * in wire order, so that a payload never has to be staged in one contiguous
+ * buffer. The encoder does not allocate: headers are built on the stack.
+ *
+ * A message is started with kaatcp_encoder_begin_*(), which writes everything
+ * but the sync request and announces sync_request_size bytes of it (the
+ * sync_request pointer itself is ignored). The sync request is then written with
+ * kaatcp_encoder_write() or kaatcp_encoder_writev() in as many pieces as needed,
+ * and kaatcp_encoder_end() checks that exactly the announced size was written.
+ */
+typedef kaatcp_error_t (*kaatcp_write_fn)(void *context, const char *data, uint32_t size);
+
+typedef struct kaatcp_iovec_t
+{
+    const char *data;
+    uint32_t size;
+} kaatcp_iovec_t;
+
+typedef struct kaatcp_encoder_t
+{
+    kaatcp_write_fn write;
+    void *context;
+    uint32_t remaining;     /* Bytes of the sync request still expected */
+} kaatcp_encoder_t;
+
+kaatcp_error_t kaatcp_encoder_init(kaatcp_encoder_t *encoder, kaatcp_write_fn write, void *context);
+
+kaatcp_error_t kaatcp_encoder_begin_connect(kaatcp_encoder_t *encoder, const kaatcp_connect_t *message);
+kaatcp_error_t kaatcp_encoder_begin_kaasync(kaatcp_encoder_t *encoder, const kaatcp_kaasync_t *message);
+
+/* Fails with KAATCP_ERR_INVALID_STATE, writing nothing, if more than announced is written */
+kaatcp_error_t kaatcp_encoder_write(kaatcp_encoder_t *encoder, const char *data, uint32_t size);
+kaatcp_error_t kaatcp_encoder_writev(kaatcp_encoder_t *encoder, const kaatcp_iovec_t *iov, uint32_t iov_count);
+
+kaatcp_error_t kaatcp_encoder_end(kaatcp_encoder_t *encoder);
+
 #ifdef __cplusplus
 }      /* extern "C" */
 #endif
@@ -165,9 +165,40 @@ void test_kaatcp_parser()
     assert(bootstrap_received);
 }
 
+void test_kaatcp_parser_split_length()
+{
+    kaatcp_parser_handlers_t handlers = { NULL, NULL, &kaasync_listener, NULL, &ping_listener };
+    kaatcp_parser_t parser;
+    assert(kaatcp_parser_init(&parser, &handlers) == 0);
+
+    /* The length is encoded in two bytes that arrive in separate buffers. */
+    unsigned char kaa_sync_message[] = { 0xF0, 0x8D, 0x00, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x14, 0xFF };
+    kaasync_received = 0;
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) kaa_sync_message, 2) == KAATCP_ERR_NONE);
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) kaa_sync_message + 2, sizeof(kaa_sync_message) - 2) == KAATCP_ERR_NONE);
+    assert(kaasync_received);
+
+    /* A single byte at a time goes through the state machine only. */
+    unsigned char ping_message[] = { 0xD0, 0x00 };
+    ping_received = 0;
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) ping_message, 1) == KAATCP_ERR_NONE);
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) ping_message + 1, 1) == KAATCP_ERR_NONE);
+    assert(ping_received);
+
+    /* The length takes at most four bytes, whichever path decodes it. */
+    unsigned char bad_length[] = { 0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) bad_length, sizeof(bad_length)) == KAATCP_ERR_INVALID_PROTOCOL);
+    assert(kaatcp_parser_reset(&parser) == KAATCP_ERR_NONE);
+    for (uint32_t i = 0; i < 4; ++i) {
+        assert(kaatcp_parser_process_buffer(&parser, (const char *) bad_length + i, 1) == KAATCP_ERR_NONE);
+    }
+    assert(kaatcp_parser_process_buffer(&parser, (const char *) bad_length + 4, 1) == KAATCP_ERR_INVALID_PROTOCOL);
+}
+
 void kaatcp_parser_test_suite()
 {
     test_kaatcp_parser();
+    test_kaatcp_parser_split_length();
 }
 
 
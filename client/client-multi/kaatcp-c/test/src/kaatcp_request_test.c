@@ -120,6 +120,81 @@ void test_kaatcp_bootstrap_request()
     assert(memcmp(bootstrap_buf + 14, app_token, 9) == 0);
 }
 
+typedef struct {
+    char data[128];
+    uint32_t size;
+    uint32_t writes;
+} test_stream_t;
+
+static kaatcp_error_t test_stream_write(void *context, const char *data, uint32_t size)
+{
+    test_stream_t *stream = context;
+    if (stream->size + size > sizeof(stream->data)) {
+        return KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    }
+    memcpy(stream->data + stream->size, data, size);
+    stream->size += size;
+    ++stream->writes;
+    return KAATCP_ERR_NONE;
+}
+
+void test_kaatcp_stream_kaasync()
+{
+    kaatcp_kaasync_t kaasync;
+    char *payload = "payload";
+    assert(kaatcp_fill_kaasync_message(payload, strlen(payload), 5, 0, 1, &kaasync) == KAATCP_ERR_NONE);
+
+    char kaasync_buf[128];
+    uint32_t kaasync_buf_size = 128;
+    assert(kaatcp_get_request_kaasync(&kaasync, kaasync_buf, &kaasync_buf_size) == KAATCP_ERR_NONE);
+
+    test_stream_t stream = { .size = 0, .writes = 0 };
+    kaatcp_encoder_t encoder;
+    assert(kaatcp_encoder_init(&encoder, &test_stream_write, &stream) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_begin_kaasync(&encoder, &kaasync) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_end(&encoder) == KAATCP_ERR_INVALID_STATE);
+
+    assert(kaatcp_encoder_write(&encoder, payload, 3) == KAATCP_ERR_NONE);
+    kaatcp_iovec_t iov[] = { { payload + 3, 2 }, { payload + 5, 2 } };
+    assert(kaatcp_encoder_writev(&encoder, iov, 2) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_write(&encoder, payload, 1) == KAATCP_ERR_INVALID_STATE);
+    assert(kaatcp_encoder_end(&encoder) == KAATCP_ERR_NONE);
+
+    assert(stream.writes == 4);
+    assert(stream.size == kaasync_buf_size);
+    assert(memcmp(stream.data, kaasync_buf, kaasync_buf_size) == 0);
+
+    char header_buf[KAA_SYNC_MESSAGE_HEADER_MAX_LENGTH];
+    uint32_t header_buf_size = sizeof(header_buf);
+    assert(kaatcp_get_request_kaasync_header(&kaasync, header_buf, &header_buf_size) == KAATCP_ERR_NONE);
+    assert(header_buf_size == 14);
+    assert(memcmp(header_buf, kaasync_buf, header_buf_size) == 0);
+}
+
+void test_kaatcp_stream_connect()
+{
+    kaatcp_connect_t connect;
+    char *session_key = "session_key";
+    char *signature = "signature";
+    char *payload = "payload";
+    assert(kaatcp_fill_connect_message(200, 0x3553c66f, payload, strlen(payload), session_key, strlen(session_key), signature, strlen(signature), &connect) == KAATCP_ERR_NONE);
+
+    char connect_buf[1024];
+    uint32_t connect_buf_size = 1024;
+    assert(kaatcp_get_request_connect(&connect, connect_buf, &connect_buf_size) == KAATCP_ERR_NONE);
+
+    test_stream_t stream = { .size = 0, .writes = 0 };
+    kaatcp_encoder_t encoder;
+    assert(kaatcp_encoder_init(&encoder, &test_stream_write, &stream) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_begin_connect(&encoder, &connect) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_begin_connect(&encoder, &connect) == KAATCP_ERR_INVALID_STATE);
+    assert(kaatcp_encoder_write(&encoder, payload, strlen(payload)) == KAATCP_ERR_NONE);
+    assert(kaatcp_encoder_end(&encoder) == KAATCP_ERR_NONE);
+
+    assert(stream.size == connect_buf_size);
+    assert(memcmp(stream.data, connect_buf, connect_buf_size) == 0);
+}
+
 void kaatcp_request_test_suite()
 {
     test_kaatcp_connect();
@@ -128,4 +203,6 @@ void kaatcp_request_test_suite()
     test_kaatcp_kaasync();
     test_kaatcp_ping();
     test_kaatcp_bootstrap_request();
+    test_kaatcp_stream_kaasync();
+    test_kaatcp_stream_connect();
 }
@@ -90,11 +90,11 @@ public class CEventSourcesGenerator {
 
     VelocityContext context = new VelocityContext();
     context.put("eventFamilies", eventFamilies);
+    context.put("StyleUtils", StyleUtils.class);
     StringWriter commonWriter = new StringWriter();
     velocityEngine.getTemplate(EVENT_FQN_PATTERN).merge(context, commonWriter);
 
     for (EventFamilyMetadata eventFamily : eventFamilies) {
-      context.put("StyleUtils", StyleUtils.class);
       String name = StyleUtils.toLowerUnderScore(eventFamily.getEcfClassName());
       String nameUpperCase = StyleUtils.toUpperUnderScore(eventFamily.getEcfClassName());
       context.put("event_family_name", name);
@@ -54,6 +54,10 @@ public class CppEventSourcesGenerator {
       "sdk/cpp/event/eventFamilyNotifyListener.template";
 
 
+  private static final String EVENT_FAMILY_EVENT_CLASS_ID_TEMPLATE =
+      "sdk/cpp/event/eventFamilyEventClassId.template";
+
+
   private static final String EVENT_FAMILY_SEND_EVENT_METHODS_TEMPLATE =
       "sdk/cpp/event/eventFamilySendEventMethods.template";
 
@@ -96,11 +100,15 @@ public class CppEventSourcesGenerator {
   private static final String EVENT_FAMILY_LISTENERS_NOTIFY_LISTENER_VAR =
       "\\$\\{event_family_listeners_notify_listener\\}";
 
+  private static final String EVENT_FAMILY_EVENT_CLASS_IDS_VAR =
+      "\\$\\{event_family_event_class_ids\\}";
+
   private static final String EVENT_FAMILY_SEND_EVENT_METHODS_VAR =
       "\\$\\{event_family_send_event_methods\\}";
 
   private static final String EVENT_CLASS_FQN_VAR = "\\$\\{event_class_fqn\\}";
   private static final String EVENT_CLASS_NAME_VAR = "\\$\\{event_class_name\\}";
+  private static final String EVENT_CLASS_ID_VAR = "\\$\\{event_class_id\\}";
 
   private static final String INCLUDE_EVENT_FAMILY_HEADERS_VAR =
       "\\$\\{include_event_family_headers\\}";
@@ -132,6 +140,7 @@ public class CppEventSourcesGenerator {
   private static String eventFamilyAddSupportedFqn;
   private static String eventFamilyOnGenericEvent;
   private static String eventFamilyNotifyListener;
+  private static String eventFamilyEventClassId;
   private static String eventFamilySendEventMethod;
   private static String eventFamilyListenerMethod;
   private static String eventFamilyFactoryHpp;
@@ -150,6 +159,7 @@ public class CppEventSourcesGenerator {
 
       eventFamilyOnGenericEvent = SdkGenerator.readResource(EVENT_FAMILY_ON_GENERIC_EVENT_TEMPLATE);
       eventFamilyNotifyListener = SdkGenerator.readResource(EVENT_FAMILY_NOTIFY_LISTENER_TEMPLATE);
+      eventFamilyEventClassId = SdkGenerator.readResource(EVENT_FAMILY_EVENT_CLASS_ID_TEMPLATE);
 
       eventFamilySendEventMethod = SdkGenerator
           .readResource(EVENT_FAMILY_SEND_EVENT_METHODS_TEMPLATE);
@@ -211,6 +221,10 @@ public class CppEventSourcesGenerator {
       String eventFamilyListenersNotifyListener = "";
       String eventFamilySendEventMethods = "";
       String eventFamilyListenerMethods = "";
+      String eventFamilyEventClassIds = "";
+
+      // Incoming event classes are identified by the index of their FQN in the supported FQN list.
+      int eventClassId = 0;
 
       for (ApplicationEventMapDto eventMap : efm.getEventMaps()) {
 
@@ -224,12 +238,11 @@ public class CppEventSourcesGenerator {
             supportedFqnsList += ",";
           }
           supportedFqnsList += "\"" + eventMap.getFqn() + "\"";
-          if (eventFamilyListenersOnGenericEvent.length() > 0) {
-            eventFamilyListenersOnGenericEvent += "else ";
-          }
-          if (eventFamilyListenersNotifyListener.length() > 0) {
-            eventFamilyListenersNotifyListener += "else ";
-          }
+
+          eventFamilyEventClassIds += eventFamilyEventClassId
+              .replaceAll(EVENT_CLASS_NAME_VAR, eventClassName)
+              .replaceAll(EVENT_CLASS_ID_VAR, Integer.toString(eventClassId++)) + "\n";
+
           eventFamilyListenersOnGenericEvent += eventFamilyOnGenericEvent
               .replaceAll(EVENT_FAMILY_CLASS_NAME_VAR, efm.getEcfClassName())
               .replaceAll(EVENT_CLASS_FQN_VAR, eventMap.getFqn())
@@ -271,7 +284,8 @@ public class CppEventSourcesGenerator {
           .replaceAll(EVENT_FAMILY_LISTENERS_NOTIFY_LISTENER_VAR,
               eventFamilyListenersNotifyListener)
           .replaceAll(EVENT_FAMILY_SEND_EVENT_METHODS_VAR, eventFamilySendEventMethods)
-          .replaceAll(EVENT_FAMILY_LISTENER_METHODS_VAR, eventFamilyListenerMethods);
+          .replaceAll(EVENT_FAMILY_LISTENER_METHODS_VAR, eventFamilyListenerMethods)
+          .replaceAll(EVENT_FAMILY_EVENT_CLASS_IDS_VAR, eventFamilyEventClassIds);
 
       String eventFamilyPath = EVENT_FAMILY_PATH_TEMPLATE
           .replaceAll(EVENT_FAMILY_CLASS_NAME_VAR, efm.getEcfClassName());